@@ -18,6 +18,7 @@
 
 #include "mir/dispatch/multiplexing_dispatchable.h"
 
+#include <atomic>
 #include <iostream>
 #include <vector>
 #include <memory>
@@ -56,8 +57,7 @@ public:
     }
     bool dispatch(md::FdEvents) override
     {
-        ++dispatch_count;
-        return (dispatch_count < dispatch_limit);
+        return (++dispatch_count < dispatch_limit);
     }
     md::FdEvents relevant_events() const override
     {
@@ -65,13 +65,11 @@ public:
     }
 
 private:
-    static thread_local uint64_t dispatch_count;
+    std::atomic<uint64_t> dispatch_count{0};
     uint64_t const dispatch_limit;
     mir::Fd read_fd, write_fd;
 };
 
-thread_local uint64_t TestDispatchable::dispatch_count = 0;
-
 bool fd_is_readable(int fd)
 {
     struct pollfd poller {
@@ -84,28 +82,37 @@ bool fd_is_readable(int fd)
 
 int main(int argc, char** argv)
 {
-    if (argc != 3)
+    if (argc != 3 && argc != 4)
     {
-        std::cout<<"Usage: "<<argv[0]<<" <number of threads> <dispatch count>"<<std::endl;
+        std::cout<<"Usage: "<<argv[0]<<" <number of threads> <dispatch count> [<number of sources>]"<<std::endl;
         exit(1);
     }
 
     int const thread_count = std::atoi(argv[1]);
     uint64_t const dispatch_count = std::atoll(argv[2]);
+    int const source_count = argc == 4 ? std::atoi(argv[3]) : 1;
 
+    // With several sources ready at once, each outer dispatch() can handle more than one of them
     auto dispatcher = std::make_shared<md::MultiplexingDispatchable>();
-    dispatcher->add_watch(std::make_shared<TestDispatchable>(dispatch_count / thread_count), md::DispatchReentrancy::reentrant);
+    for (int i = 0; i < source_count; ++i)
+    {
+        dispatcher->add_watch(
+            std::make_shared<TestDispatchable>(dispatch_count / source_count),
+            md::DispatchReentrancy::reentrant);
+    }
 
+    std::atomic<uint64_t> outer_dispatch_count{0};
     auto start = std::chrono::steady_clock::now();
 
     std::vector<std::thread> thread_loops;
     for (int i = 0; i < thread_count; ++i)
     {
-        thread_loops.emplace_back([](md::Dispatchable& dispatch)
+        thread_loops.emplace_back([&outer_dispatch_count](md::Dispatchable& dispatch)
         {
             while(fd_is_readable(dispatch.watch_fd()))
             {
                 dispatch.dispatch(md::FdEvent::readable);
+                ++outer_dispatch_count;
             }
         }, std::ref(*dispatcher));
     }
@@ -116,6 +123,8 @@ int main(int argc, char** argv)
     }
 
     auto duration = std::chrono::steady_clock::now() - start;
-    std::cout<<"Dispatching "<<dispatch_count<<" times took "<<std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()<<"ns"<<std::endl;
+    std::cout<<"Dispatching "<<dispatch_count<<" times from "<<source_count<<" sources took "
+             <<std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()<<"ns in "
+             <<outer_dispatch_count<<" calls to dispatch()"<<std::endl;
     exit(0);
 }
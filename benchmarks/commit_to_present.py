@@ -7,19 +7,26 @@ from text_histogram import histogram
 howto = """
 Process a LTTNG trace for per-client commit-to-present latencies.
 
-This works on an lttng trace with the mir_server_wayland:sw_buffer_committed
-and mir_server_compositor:buffers_in_frame tracepoints enabled. To generate
-such a trace you need to run a Mir server with the --compositor-report=lttng
-option. For example:
+This follows each buffer a client commits, by buffer ID, through the frame
+pipeline: into a scene snapshot (mir_server_frame:scene_snapshot numbers the
+frame for each display), composited by the renderer or scanned out from a
+hardware plane, and presented (mir_server_frame:presented) when the frame is
+posted. Buffers that were occluded, or replaced before being shown, are
+counted separately. To generate such a trace you need a Mir server built with
+LTTNG support, for example:
 
-> miral-app --compositor-report=lttng
+> miral-app
 
 Once you have your compositor active, you can get an LTTNG trace like so:
 > lttng create mir-trace
-> lttng enable-event -u "mir_server_wayland:sw_buffer_committed"
-> lttng enable-event -u "mir_server_compositor:buffers_in_frame"
+> lttng enable-event -u "mir_server_wayland:*_buffer_committed"
+> lttng enable-event -u "mir_server_wayland:frame_callbacks_sent"
+> lttng enable-event -u "mir_server_frame:*"
 > lttng start
 
+(Adding "mir_renderer_gl:texture_bound" records the time taken to upload or
+import each buffer's texture, which this script doesn't use.)
+
 At this point you can interact with applications in your Mir session;
 LTTNG will be recording the necessary events. When you're done…
 
@@ -44,22 +51,98 @@ except:
 
 class ClientStats:
     def __init__(self):
-        self.buffers_in_flight = dict()
-        self.buffer_delays = []
+        self.commit_to_present = []
+        self.commit_to_snapshot = []
+        self.commit_to_frame_callback = []
+        self.occluded = 0
+        self.not_presented = 0
+
+class Commit:
+    def __init__(self, client, surface, timestamp):
+        self.client = client
+        self.surface = surface
+        self.timestamp = timestamp
+        self.snapshot = None
+        self.presented = None
+        self.occluded = False
+
+class Display:
+    def __init__(self):
+        self.frame = None
+        self.shown = set()      # Buffers composited or scanned out in self.frame
 
 clients = dict()
+commits = dict()        # buffer_id -> the surface's latest Commit of it
+surfaces = dict()       # surface -> buffer_id last committed
+displays = dict()
+
+def retire(buffer):
+    commit = commits.pop(buffer)
+    if commit.occluded:
+        clients[commit.client].occluded += 1
+    elif commit.presented is None:
+        clients[commit.client].not_presented += 1
+
 for event in trace_collection.events:
-    if event.name == 'mir_server_wayland:sw_buffer_committed':
+    name = event.name
+    if name in ('mir_server_wayland:sw_buffer_committed', 'mir_server_wayland:hw_buffer_committed'):
         if event['client'] not in clients:
             clients[event['client']] = ClientStats()
-        clients[event['client']].buffers_in_flight[event['buffer_id']] = event.timestamp
-    if event.name == 'mir_server_compositor:buffers_in_frame':
+        previous = surfaces.get(event['surface'])
+        if previous in commits:
+            retire(previous)
+        buffer = event['buffer_id']
+        if buffer in commits:
+            retire(buffer)
+        commits[buffer] = Commit(event['client'], event['surface'], event.timestamp)
+        surfaces[event['surface']] = buffer
+    elif name == 'mir_server_wayland:frame_callbacks_sent':
+        commit = commits.get(event['buffer_id'])
+        if commit is not None:
+            clients[commit.client].commit_to_frame_callback.append(event.timestamp - commit.timestamp)
+    elif name == 'mir_server_frame:scene_snapshot':
+        display = displays.setdefault(event['display'], Display())
+        display.frame = event['frame']
+        display.shown = set()
         for buffer in event['buffer_ids']:
-            for client in clients.values():
-                if buffer in client.buffers_in_flight.keys():
-                    client.buffer_delays.append(event.timestamp - client.buffers_in_flight[buffer])
-                    del client.buffers_in_flight[buffer]
+            commit = commits.get(buffer)
+            if commit is not None and commit.snapshot is None:
+                commit.snapshot = event.timestamp
+                clients[commit.client].commit_to_snapshot.append(event.timestamp - commit.timestamp)
+    elif name == 'mir_server_frame:occluded':
+        for buffer in event['buffer_ids']:
+            commit = commits.get(buffer)
+            if commit is not None and commit.presented is None:
+                commit.occluded = True
+    elif name in ('mir_server_frame:composited', 'mir_server_frame:scanned_out'):
+        # These come between the display's scene_snapshot and its post_started
+        if event['display'] in displays:
+            displays[event['display']].shown.update(event['buffer_ids'])
+    elif name == 'mir_server_frame:presented':
+        display = displays.get(event['display'])
+        if display is None or display.frame != event['frame']:
+            continue
+        for buffer in display.shown:
+            commit = commits.get(buffer)
+            if commit is not None and commit.presented is None:
+                commit.presented = event.timestamp
+                commit.occluded = False
+                clients[commit.client].commit_to_present.append(event.timestamp - commit.timestamp)
+        display.shown = set()
+
+def report(title, delays):
+    print(title + " (ms):")
+    delays_ms = [delay // 1000000 for delay in delays]
+    if len(set(delays_ms)) > 1:
+        histogram(delays_ms)
+    else:
+        # The histogram needs a range of values to bin
+        print(delays_ms)
 
-for (id, client)  in clients.items():
+for (id, client) in clients.items():
     print("Client: ", id)
-    histogram([delay // 1000000 for delay in client.buffer_delays])
+    report("Commit to present", client.commit_to_present)
+    report("Commit to scene snapshot", client.commit_to_snapshot)
+    report("Commit to frame callback", client.commit_to_frame_callback)
+    print("Occluded buffers: ", client.occluded)
+    print("Buffers replaced before being presented: ", client.not_presented)
@@ -0,0 +1,251 @@
+#!/usr/bin/python3
+
+"""Headless compositor throughput benchmark.
+
+Runs a Mir server on the offscreen platform with N synthetic Wayland clients
+(mir_load_client) committing frames, and records the compositor's frame times,
+its CPU time per frame and memory use, and the frames the clients missed.
+
+  compositor_throughput.py run --clients 16 --buffers mixed --output 16.json
+  compositor_throughput.py compare before.json after.json
+"""
+
+import argparse
+import json
+import os
+import re
+import shutil
+import signal
+import statistics
+import subprocess
+import sys
+import threading
+import time
+
+REPORT = re.compile(
+    r"averaged (?P<fps>[\d.]+) FPS, (?P<frame_time>[\d.]+) ms/frame, "
+    r"latency (?P<latency>[\d.]+) ms, (?P<frames>\d+) frames over (?P<seconds>[\d.]+) sec")
+
+CLOCK_TICKS = os.sysconf("SC_CLK_TCK")
+
+
+def cpu_seconds(pid):
+    """User and system time of a process, in seconds"""
+    with open("/proc/%d/stat" % pid) as stat:
+        # The command may contain spaces, but is the only field in parentheses
+        fields = stat.read().rsplit(")", 1)[1].split()
+    return (int(fields[11]) + int(fields[12])) / CLOCK_TICKS
+
+
+def rss_kib(pid):
+    with open("/proc/%d/status" % pid) as status:
+        for line in status:
+            if line.startswith("VmRSS:"):
+                return int(line.split()[1])
+    return 0
+
+
+def percentile(samples, fraction):
+    if not samples:
+        return 0.0
+    ordered = sorted(samples)
+    return ordered[min(len(ordered) - 1, int(fraction * len(ordered)))]
+
+
+class Server:
+    def __init__(self, executable, options, socket_name):
+        env = os.environ.copy()
+        env["WAYLAND_DISPLAY"] = socket_name
+        self.socket = os.path.join(os.environ["XDG_RUNTIME_DIR"], socket_name)
+        self.process = subprocess.Popen(
+            [executable, "--compositor-report=log"] + options,
+            env=env, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+        self.lines = []
+        self.reader = threading.Thread(target=self._read, daemon=True)
+        self.reader.start()
+
+    def _read(self):
+        for line in self.process.stdout:
+            self.lines.append(line)
+
+    def wait_for_socket(self, timeout):
+        deadline = time.monotonic() + timeout
+        while not os.path.exists(self.socket):
+            if self.process.poll() is not None or time.monotonic() > deadline:
+                sys.exit("Server failed to start:\n" + "".join(self.lines))
+            time.sleep(0.05)
+
+    def stop(self):
+        self.process.terminate()
+        self.process.wait(timeout=10)
+        self.reader.join(timeout=1)
+
+
+def start_client(executable, socket_name, buffers, args):
+    env = os.environ.copy()
+    env["WAYLAND_DISPLAY"] = socket_name
+    if buffers == "gbm":
+        # mir_dmabuf_client only has the one kind of buffer
+        cmdline = [executable, "--size", args.size, "--rate", str(args.rate)]
+    else:
+        cmdline = [executable, "--buffers", buffers, "--size", args.size, "--rate", str(args.rate)]
+    if args.overlap == "fullscreen":
+        cmdline.append("--fullscreen")
+    return subprocess.Popen(cmdline, env=env, stdout=subprocess.PIPE, universal_newlines=True)
+
+
+def stop_client(client):
+    client.send_signal(signal.SIGTERM)
+    output, _ = client.communicate(timeout=10)
+    try:
+        return json.loads(output.strip().splitlines()[-1])
+    except (IndexError, ValueError):
+        return None
+
+
+def run(args):
+    default_client = "mir_dmabuf_client" if args.buffers == "gbm" else "mir_load_client"
+    client_executable = args.client or os.path.join(os.path.dirname(args.server), default_client)
+    socket_name = "mir_throughput_%d" % os.getpid()
+
+    server = Server(args.server, args.server_option or ["--offscreen"], socket_name)
+    server.wait_for_socket(10)
+
+    clients = []
+    for i in range(args.clients):
+        buffers = args.buffers if args.buffers != "mixed" else ("shm", "dmabuf")[i % 2]
+        clients.append(start_client(client_executable, socket_name, buffers, args))
+
+    time.sleep(args.warmup)
+
+    first_report = len(server.lines)
+    start_cpu = cpu_seconds(server.process.pid)
+    start_rss = peak_rss = rss_kib(server.process.pid)
+    start_time = time.monotonic()
+
+    while time.monotonic() - start_time < args.duration:
+        time.sleep(0.25)
+        peak_rss = max(peak_rss, rss_kib(server.process.pid))
+
+    elapsed = time.monotonic() - start_time
+    cpu = cpu_seconds(server.process.pid) - start_cpu
+    end_rss = rss_kib(server.process.pid)
+    reports = [m.groupdict() for m in map(REPORT.search, server.lines[first_report:]) if m]
+
+    client_stats = [stop_client(client) for client in clients]
+    server.stop()
+
+    failed = sum(1 for stats in client_stats if stats is None)
+    if failed:
+        print("%d of %d clients failed" % (failed, len(clients)), file=sys.stderr)
+    client_stats = [stats for stats in client_stats if stats is not None]
+
+    # Each report averages the frames of about a second, so percentiles are of those averages
+    frames = sum(int(r["frames"]) for r in reports)
+    frame_times = [float(r["frame_time"]) for r in reports]
+    commits = sum(s["commits"] for s in client_stats)
+    missed = sum(s["missed"] for s in client_stats)
+
+    return {
+        "label": args.label,
+        "config": {
+            "clients": args.clients,
+            "buffers": args.buffers,
+            "size": args.size,
+            "rate": args.rate,
+            "overlap": args.overlap,
+            "duration": args.duration,
+            "server_options": args.server_option or ["--offscreen"],
+        },
+        "compositor": {
+            "frames": frames,
+            "fps": frames / elapsed,
+            "frame_time_ms": {
+                "mean": statistics.mean(frame_times) if frame_times else 0.0,
+                "p50": percentile(frame_times, 0.5),
+                "p95": percentile(frame_times, 0.95),
+                "max": max(frame_times, default=0.0),
+            },
+            "latency_ms": statistics.mean(float(r["latency"]) for r in reports) if reports else 0.0,
+            "cpu_ms_per_frame": 1000 * cpu / frames if frames else 0.0,
+            "cpu_percent": 100 * cpu / elapsed,
+            "rss_kib": {"start": start_rss, "peak": peak_rss, "end": end_rss},
+        },
+        "clients": {
+            "running": len(client_stats),
+            "commits": commits,
+            "frames": sum(s["frames"] for s in client_stats),
+            "missed": missed,
+            "missed_percent": 100 * missed / (commits + missed) if commits + missed else 0.0,
+        },
+    }
+
+
+def flatten(results, prefix=""):
+    for key, value in results.items():
+        if isinstance(value, dict):
+            yield from flatten(value, prefix + key + ".")
+        elif isinstance(value, (int, float)) and not isinstance(value, bool):
+            yield prefix + key, value
+
+
+def compare(args):
+    with open(args.before) as before_file, open(args.after) as after_file:
+        before = dict(flatten(json.load(before_file)))
+        after = dict(flatten(json.load(after_file)))
+
+    width = max(len(key) for key in before)
+    print("%-*s %12s %12s %9s" % (width, "metric", "before", "after", "change"))
+    for key, old in before.items():
+        if key not in after:
+            continue
+        new = after[key]
+        change = "%+8.1f%%" % (100 * (new - old) / old) if old else ""
+        print("%-*s %12.3f %12.3f %9s" % (width, key, old, new, change))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    run_parser = commands.add_parser("run", help="Measure a configuration")
+    run_parser.add_argument("--server", default=shutil.which("mir_demo_server"))
+    run_parser.add_argument("--server-option", action="append",
+                            help="Pass an option to the server (default: --offscreen)")
+    run_parser.add_argument("--client", help="The load client (default: mir_load_client, or mir_dmabuf_client for "
+                                             "--buffers gbm, beside the server)")
+    run_parser.add_argument("--clients", type=int, default=4)
+    run_parser.add_argument("--buffers", choices=["shm", "dmabuf", "mixed", "gbm"], default="shm")
+    run_parser.add_argument("--size", default="640x480", help="Each window's size, as WIDTHxHEIGHT")
+    run_parser.add_argument("--rate", type=float, default=60,
+                            help="Commits per second by each client; 0 to commit on each frame callback")
+    run_parser.add_argument("--overlap", choices=["placed", "fullscreen"], default="placed",
+                            help="Let the window manager place windows, or stack them all fullscreen")
+    run_parser.add_argument("--duration", type=float, default=10, help="Seconds to measure for")
+    run_parser.add_argument("--warmup", type=float, default=2, help="Seconds to settle before measuring")
+    run_parser.add_argument("--label", default="")
+    run_parser.add_argument("--output", help="Write the results to a file, rather than stdout")
+
+    compare_parser = commands.add_parser("compare", help="Compare the results of two runs")
+    compare_parser.add_argument("before")
+    compare_parser.add_argument("after")
+
+    args = parser.parse_args()
+
+    if args.command == "compare":
+        compare(args)
+        return
+
+    if not args.server:
+        sys.exit("No mir_demo_server found; use --server")
+
+    results = json.dumps(run(args), indent=2)
+    if args.output:
+        with open(args.output, "w") as output:
+            output.write(results + "\n")
+    else:
+        print(results)
+
+
+if __name__ == "__main__":
+    main()
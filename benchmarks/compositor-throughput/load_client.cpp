@@ -0,0 +1,468 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * A synthetic Wayland client for compositor_throughput.py
+ *
+ * It commits a window's worth of new content at a fixed rate, until it receives SIGTERM
+ * or SIGINT, and then prints what it saw as a line of JSON:
+ *
+ *   commits  frames committed
+ *   frames   frame callbacks received (frames the compositor drew)
+ *   missed   ticks at which the previous frame hadn't been drawn yet, so nothing was committed
+ */
+
+#include <EGL/egl.h>
+#include <GLES2/gl2.h>
+#include <wayland-client.h>
+#include <wayland-egl.h>
+
+#include <poll.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+struct Options
+{
+    bool dmabuf{false};
+    int width{640};
+    int height{480};
+    double rate{60};          ///< Commits per second; 0 to commit as soon as the last frame is drawn
+    bool fullscreen{false};
+};
+
+auto parse(int argc, char* argv[]) -> Options
+{
+    Options options;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string const arg{argv[i]};
+        auto const value = [&]() -> char const*
+            {
+                if (++i == argc)
+                    throw std::runtime_error{"Missing value for " + arg};
+                return argv[i];
+            };
+
+        if (arg == "--buffers")
+        {
+            std::string const buffers{value()};
+            if (buffers != "shm" && buffers != "dmabuf")
+                throw std::runtime_error{"--buffers must be shm or dmabuf"};
+            options.dmabuf = buffers == "dmabuf";
+        }
+        else if (arg == "--size")
+        {
+            if (sscanf(value(), "%dx%d", &options.width, &options.height) != 2 ||
+                options.width <= 0 || options.height <= 0)
+                throw std::runtime_error{"--size must be WIDTHxHEIGHT"};
+        }
+        else if (arg == "--rate")
+        {
+            options.rate = strtod(value(), nullptr);
+        }
+        else if (arg == "--fullscreen")
+        {
+            options.fullscreen = true;
+        }
+        else
+        {
+            throw std::runtime_error{"Unknown option " + arg};
+        }
+    }
+
+    return options;
+}
+
+struct Globals
+{
+    wl_compositor* compositor{nullptr};
+    wl_shm* shm{nullptr};
+    wl_shell* shell{nullptr};
+
+    static void add(void* data, wl_registry* registry, uint32_t id, char const* interface, uint32_t /*version*/)
+    {
+        auto const self = static_cast<Globals*>(data);
+
+        if (strcmp(interface, wl_compositor_interface.name) == 0)
+            self->compositor = static_cast<wl_compositor*>(wl_registry_bind(registry, id, &wl_compositor_interface, 3));
+        else if (strcmp(interface, wl_shm_interface.name) == 0)
+            self->shm = static_cast<wl_shm*>(wl_registry_bind(registry, id, &wl_shm_interface, 1));
+        else if (strcmp(interface, wl_shell_interface.name) == 0)
+            self->shell = static_cast<wl_shell*>(wl_registry_bind(registry, id, &wl_shell_interface, 1));
+    }
+
+    static void remove(void*, wl_registry*, uint32_t) {}
+};
+
+wl_registry_listener const registry_listener{&Globals::add, &Globals::remove};
+
+void handle_ping(void*, wl_shell_surface* shell_surface, uint32_t serial)
+{
+    wl_shell_surface_pong(shell_surface, serial);
+}
+
+void handle_configure(void*, wl_shell_surface*, uint32_t, int32_t, int32_t) {}
+void handle_popup_done(void*, wl_shell_surface*) {}
+
+wl_shell_surface_listener const shell_surface_listener{&handle_ping, &handle_configure, &handle_popup_done};
+
+/// Draws a frame into the surface's next buffer, and attaches it
+class Painter
+{
+public:
+    virtual ~Painter() = default;
+    virtual void paint(uint32_t frame) = 0;
+    /// Commits the surface (EGL does this itself when it swaps)
+    virtual void commit() = 0;
+};
+
+/// Triple-buffered wl_shm, written by the CPU as a software-rendering client would
+class ShmPainter : public Painter
+{
+public:
+    ShmPainter(wl_shm* shm, wl_surface* surface, int width, int height) :
+        surface{surface},
+        width{width},
+        height{height},
+        stride{width * 4},
+        buffer_size{static_cast<size_t>(stride) * height}
+    {
+        auto const pool_size = buffer_size * buffers.size();
+        auto const fd = memfd_create("mir-load-client", MFD_CLOEXEC);
+        if (fd < 0 || ftruncate(fd, pool_size) < 0)
+            throw std::runtime_error{"Failed to allocate shm buffers"};
+
+        pixels = static_cast<char*>(mmap(nullptr, pool_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+        if (pixels == MAP_FAILED)
+            throw std::runtime_error{"Failed to map shm buffers"};
+
+        auto const pool = wl_shm_create_pool(shm, fd, pool_size);
+        for (auto i = 0u; i != buffers.size(); ++i)
+        {
+            buffers[i].buffer = wl_shm_pool_create_buffer(
+                pool, i * buffer_size, width, height, stride, WL_SHM_FORMAT_XRGB8888);
+            wl_buffer_add_listener(buffers[i].buffer, &buffer_listener, &buffers[i]);
+        }
+        wl_shm_pool_destroy(pool);
+        close(fd);
+    }
+
+    ~ShmPainter()
+    {
+        for (auto const& b : buffers)
+            wl_buffer_destroy(b.buffer);
+        munmap(pixels, buffer_size * buffers.size());
+    }
+
+    void paint(uint32_t frame) override
+    {
+        auto const free = std::find_if(buffers.begin(), buffers.end(), [](auto const& b) { return !b.busy; });
+        if (free == buffers.end())
+            return;     // The compositor holds every buffer; commit the same content again
+
+        auto const data = pixels + (free - buffers.begin()) * buffer_size;
+        memset(data, frame & 0xff, buffer_size);
+
+        free->busy = true;
+        wl_surface_attach(surface, free->buffer, 0, 0);
+        wl_surface_damage(surface, 0, 0, width, height);
+    }
+
+    void commit() override
+    {
+        wl_surface_commit(surface);
+    }
+
+private:
+    struct Buffer
+    {
+        wl_buffer* buffer{nullptr};
+        bool busy{false};
+    };
+
+    static void release(void* data, wl_buffer*)
+    {
+        static_cast<Buffer*>(data)->busy = false;
+    }
+
+    static constexpr wl_buffer_listener buffer_listener{&release};
+
+    wl_surface* const surface;
+    int const width;
+    int const height;
+    int const stride;
+    size_t const buffer_size;
+    char* pixels{nullptr};
+    std::array<Buffer, 3> buffers;
+};
+
+/// GLES2 through wayland-egl; Mesa hands its buffers to the compositor as DMA-bufs
+class DMABufPainter : public Painter
+{
+public:
+    DMABufPainter(wl_display* connection, wl_surface* surface, int width, int height) :
+        window{wl_egl_window_create(surface, width, height)},
+        display{eglGetDisplay(reinterpret_cast<EGLNativeDisplayType>(connection))}
+    {
+        if (!window || !eglInitialize(display, nullptr, nullptr))
+            throw std::runtime_error{"Failed to initialise EGL"};
+
+        EGLint const config_attribs[] = {
+            EGL_SURFACE_TYPE, EGL_WINDOW_BIT,
+            EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8,
+            EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT,
+            EGL_NONE};
+        EGLConfig config;
+        EGLint configs{0};
+        if (!eglChooseConfig(display, config_attribs, &config, 1, &configs) || configs != 1)
+            throw std::runtime_error{"No EGL config for a GLES2 window"};
+
+        eglBindAPI(EGL_OPENGL_ES_API);
+        EGLint const context_attribs[] = {EGL_CONTEXT_CLIENT_VERSION, 2, EGL_NONE};
+        context = eglCreateContext(display, config, EGL_NO_CONTEXT, context_attribs);
+        egl_surface = eglCreateWindowSurface(display, config, reinterpret_cast<EGLNativeWindowType>(window), nullptr);
+        if (context == EGL_NO_CONTEXT || egl_surface == EGL_NO_SURFACE ||
+            !eglMakeCurrent(display, egl_surface, egl_surface, context))
+            throw std::runtime_error{"Failed to create an EGL window surface"};
+
+        // We pace commits ourselves, and count the frame callbacks
+        eglSwapInterval(display, 0);
+    }
+
+    ~DMABufPainter()
+    {
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroySurface(display, egl_surface);
+        eglDestroyContext(display, context);
+        eglTerminate(display);
+        wl_egl_window_destroy(window);
+    }
+
+    void paint(uint32_t frame) override
+    {
+        glClearColor((frame & 0xff) / 255.0f, 0.5f, 0.5f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+    }
+
+    void commit() override
+    {
+        eglSwapBuffers(display, egl_surface);
+    }
+
+private:
+    wl_egl_window* const window;
+    EGLDisplay const display;
+    EGLContext context;
+    EGLSurface egl_surface;
+};
+
+struct Stats
+{
+    unsigned long commits{0};
+    unsigned long frames{0};
+    unsigned long missed{0};
+};
+
+class LoadClient
+{
+public:
+    LoadClient(wl_display* display, Globals const& globals, Options const& options) :
+        surface{wl_compositor_create_surface(globals.compositor)},
+        shell_surface{wl_shell_get_shell_surface(globals.shell, surface)}
+    {
+        wl_shell_surface_add_listener(shell_surface, &shell_surface_listener, this);
+        if (options.fullscreen)
+            wl_shell_surface_set_fullscreen(shell_surface, WL_SHELL_SURFACE_FULLSCREEN_METHOD_DEFAULT, 0, nullptr);
+        else
+            wl_shell_surface_set_toplevel(shell_surface);
+
+        if (options.dmabuf)
+            painter = std::make_unique<DMABufPainter>(display, surface, options.width, options.height);
+        else
+            painter = std::make_unique<ShmPainter>(globals.shm, surface, options.width, options.height);
+    }
+
+    ~LoadClient()
+    {
+        if (frame_callback)
+            wl_callback_destroy(frame_callback);
+        painter.reset();
+        wl_shell_surface_destroy(shell_surface);
+        wl_surface_destroy(surface);
+    }
+
+    /// Commits a frame, unless the last hasn't been drawn yet
+    void tick()
+    {
+        if (frame_callback)
+        {
+            ++stats.missed;
+            return;
+        }
+
+        frame_callback = wl_surface_frame(surface);
+        wl_callback_add_listener(frame_callback, &frame_listener, this);
+
+        painter->paint(stats.commits);
+        painter->commit();
+        ++stats.commits;
+    }
+
+    bool waiting_for_frame() const { return frame_callback != nullptr; }
+
+    Stats stats;
+
+private:
+    static void frame_done(void* data, wl_callback* callback, uint32_t)
+    {
+        auto const self = static_cast<LoadClient*>(data);
+        wl_callback_destroy(callback);
+        self->frame_callback = nullptr;
+        ++self->stats.frames;
+    }
+
+    static constexpr wl_callback_listener frame_listener{&frame_done};
+
+    wl_surface* const surface;
+    wl_shell_surface* const shell_surface;
+    std::unique_ptr<Painter> painter;
+    wl_callback* frame_callback{nullptr};
+};
+
+auto timer_for(double rate) -> int
+{
+    auto const fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    auto const period_ns = static_cast<long>(1e9 / rate);
+    itimerspec const period{{period_ns / 1000000000, period_ns % 1000000000}, {period_ns / 1000000000, period_ns % 1000000000}};
+    if (fd < 0 || timerfd_settime(fd, 0, &period, nullptr) < 0)
+        throw std::runtime_error{"Failed to create the commit timer"};
+    return fd;
+}
+
+auto termination_signals() -> int
+{
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGINT);
+    sigprocmask(SIG_BLOCK, &signals, nullptr);
+    return signalfd(-1, &signals, SFD_CLOEXEC);
+}
+}
+
+int main(int argc, char* argv[])
+try
+{
+    auto const options = parse(argc, argv);
+    auto const signals = termination_signals();
+
+    auto const display = wl_display_connect(nullptr);
+    if (!display)
+        throw std::runtime_error{"Failed to connect to the Wayland compositor"};
+
+    Globals globals;
+    auto const registry = wl_display_get_registry(display);
+    wl_registry_add_listener(registry, &registry_listener, &globals);
+    wl_display_roundtrip(display);
+    if (!globals.compositor || !globals.shm || !globals.shell)
+        throw std::runtime_error{"The compositor lacks wl_compositor, wl_shm or wl_shell"};
+
+    Stats stats;
+    {
+        LoadClient client{display, globals, options};
+        auto const timer = options.rate > 0 ? timer_for(options.rate) : -1;
+
+        client.tick();
+
+        for (bool running = true; running;)
+        {
+            while (wl_display_prepare_read(display) != 0)
+                wl_display_dispatch_pending(display);
+            wl_display_flush(display);
+
+            pollfd fds[] = {
+                {wl_display_get_fd(display), POLLIN, 0},
+                {signals, POLLIN, 0},
+                {timer, POLLIN, 0}};
+
+            if (poll(fds, timer < 0 ? 2 : 3, -1) < 0)
+            {
+                wl_display_cancel_read(display);
+                continue;
+            }
+
+            if (fds[0].revents & POLLIN)
+            {
+                if (wl_display_read_events(display) < 0)
+                    throw std::runtime_error{"Lost the connection to the compositor"};
+            }
+            else
+            {
+                wl_display_cancel_read(display);
+            }
+            wl_display_dispatch_pending(display);
+
+            if (fds[1].revents & POLLIN)
+                running = false;
+
+            if (timer >= 0 && (fds[2].revents & POLLIN))
+            {
+                uint64_t expirations{0};
+                if (read(timer, &expirations, sizeof expirations) == sizeof expirations)
+                {
+                    // Ticks we slept through count as missed, as well as any tick we can't commit on
+                    client.stats.missed += expirations - 1;
+                    client.tick();
+                }
+            }
+            else if (timer < 0 && !client.waiting_for_frame())
+            {
+                client.tick();
+            }
+        }
+
+        stats = client.stats;
+        if (timer >= 0)
+            close(timer);
+    }
+
+    printf("{\"pid\": %d, \"buffers\": \"%s\", \"commits\": %lu, \"frames\": %lu, \"missed\": %lu}\n",
+           getpid(), options.dmabuf ? "dmabuf" : "shm", stats.commits, stats.frames, stats.missed);
+
+    wl_registry_destroy(registry);
+    wl_display_disconnect(display);
+    return EXIT_SUCCESS;
+}
+catch (std::exception const& error)
+{
+    fprintf(stderr, "mir_load_client: %s\n", error.what());
+    return EXIT_FAILURE;
+}
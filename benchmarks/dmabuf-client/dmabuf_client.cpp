@@ -0,0 +1,892 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * A Wayland client that renders the way a real GPU application does: into GBM buffer objects it allocates itself
+ * (with the modifiers the compositor advertises), drawn with GLES through EGLImages and shared with the compositor
+ * through zwp_linux_dmabuf_v1. Nothing is copied on the way, so what a benchmark measures is the compositor's
+ * zero-copy path: EGLImage import and caching, composition, and direct scanout.
+ *
+ * Optionally it fences its frames with zwp_linux_explicit_synchronization_v1 rather than relying on implicit sync,
+ * and follows each commit with wp_presentation feedback.
+ *
+ * It commits at a fixed rate until it receives SIGTERM or SIGINT, and then prints what it saw as a line of JSON:
+ *
+ *   commits     frames committed
+ *   frames      frame callbacks received (frames the compositor drew)
+ *   missed      ticks at which the previous frame hadn't been drawn yet, so nothing was committed
+ *   presented   commits presentation feedback said were shown (with --presentation), and of those:
+ *   zero_copy   shown straight from our buffer, without the compositor copying it
+ *   discarded   commits presentation feedback said were never shown
+ *   latency_ms  commit to presentation
+ */
+
+#include "xdg-shell-client-protocol.h"
+#include "linux-dmabuf-unstable-v1-client-protocol.h"
+#include "linux-explicit-synchronization-unstable-v1-client-protocol.h"
+#include "presentation-time-client-protocol.h"
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+#include <drm_fourcc.h>
+#include <gbm.h>
+#include <wayland-client.h>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+struct Options
+{
+    std::string device{"/dev/dri/renderD128"};
+    uint32_t format{DRM_FORMAT_XRGB8888};
+    bool modifiers{true};
+    bool explicit_sync{false};
+    bool presentation{false};
+    int width{640};
+    int height{480};
+    int buffers{3};
+    double rate{60};          ///< Commits per second; 0 to commit as soon as the last frame is drawn
+    bool fullscreen{false};
+};
+
+auto parse(int argc, char* argv[]) -> Options
+{
+    Options options;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string const arg{argv[i]};
+        auto const value = [&]() -> char const*
+            {
+                if (++i == argc)
+                    throw std::runtime_error{"Missing value for " + arg};
+                return argv[i];
+            };
+
+        if (arg == "--device")
+        {
+            options.device = value();
+        }
+        else if (arg == "--format")
+        {
+            std::string const format{value()};
+            if (format == "xrgb8888")
+                options.format = DRM_FORMAT_XRGB8888;
+            else if (format == "argb8888")
+                options.format = DRM_FORMAT_ARGB8888;
+            else
+                throw std::runtime_error{"--format must be xrgb8888 or argb8888"};
+        }
+        else if (arg == "--no-modifiers")
+        {
+            options.modifiers = false;
+        }
+        else if (arg == "--explicit-sync")
+        {
+            options.explicit_sync = true;
+        }
+        else if (arg == "--presentation")
+        {
+            options.presentation = true;
+        }
+        else if (arg == "--size")
+        {
+            if (sscanf(value(), "%dx%d", &options.width, &options.height) != 2 ||
+                options.width <= 0 || options.height <= 0)
+                throw std::runtime_error{"--size must be WIDTHxHEIGHT"};
+        }
+        else if (arg == "--buffers")
+        {
+            options.buffers = atoi(value());
+            if (options.buffers < 1)
+                throw std::runtime_error{"--buffers must be at least 1"};
+        }
+        else if (arg == "--rate")
+        {
+            options.rate = strtod(value(), nullptr);
+        }
+        else if (arg == "--fullscreen")
+        {
+            options.fullscreen = true;
+        }
+        else
+        {
+            throw std::runtime_error{"Unknown option " + arg};
+        }
+    }
+
+    return options;
+}
+
+auto now_ns(clockid_t clock) -> int64_t
+{
+    timespec ts;
+    clock_gettime(clock, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+struct Globals
+{
+    explicit Globals(uint32_t format) :
+        format{format}
+    {
+    }
+
+    uint32_t const format;
+
+    wl_compositor* compositor{nullptr};
+    xdg_wm_base* wm_base{nullptr};
+    zwp_linux_dmabuf_v1* dmabuf{nullptr};
+    zwp_linux_explicit_synchronization_v1* explicit_sync{nullptr};
+    wp_presentation* presentation{nullptr};
+    clockid_t presentation_clock{CLOCK_MONOTONIC};
+
+    /// The modifiers the compositor takes our format with
+    std::vector<uint64_t> modifiers;
+    bool format_supported{false};
+
+    static void add(void* data, wl_registry* registry, uint32_t id, char const* interface, uint32_t version)
+    {
+        auto const self = static_cast<Globals*>(data);
+
+        if (strcmp(interface, wl_compositor_interface.name) == 0)
+            self->compositor = static_cast<wl_compositor*>(wl_registry_bind(registry, id, &wl_compositor_interface, 3));
+        else if (strcmp(interface, xdg_wm_base_interface.name) == 0)
+        {
+            self->wm_base = static_cast<xdg_wm_base*>(wl_registry_bind(registry, id, &xdg_wm_base_interface, 1));
+            xdg_wm_base_add_listener(self->wm_base, &wm_base_listener, self);
+        }
+        else if (strcmp(interface, zwp_linux_dmabuf_v1_interface.name) == 0 && version >= 3)
+        {
+            // Version 3 lists the modifiers; version 4's feedback would only tell us more than we use
+            self->dmabuf = static_cast<zwp_linux_dmabuf_v1*>(
+                wl_registry_bind(registry, id, &zwp_linux_dmabuf_v1_interface, 3));
+            zwp_linux_dmabuf_v1_add_listener(self->dmabuf, &dmabuf_listener, self);
+        }
+        else if (strcmp(interface, zwp_linux_explicit_synchronization_v1_interface.name) == 0)
+            self->explicit_sync = static_cast<zwp_linux_explicit_synchronization_v1*>(
+                wl_registry_bind(registry, id, &zwp_linux_explicit_synchronization_v1_interface, 1));
+        else if (strcmp(interface, wp_presentation_interface.name) == 0)
+        {
+            self->presentation = static_cast<wp_presentation*>(
+                wl_registry_bind(registry, id, &wp_presentation_interface, 1));
+            wp_presentation_add_listener(self->presentation, &presentation_listener, self);
+        }
+    }
+
+    static void remove(void*, wl_registry*, uint32_t) {}
+
+    static void ping(void*, xdg_wm_base* wm_base, uint32_t serial)
+    {
+        xdg_wm_base_pong(wm_base, serial);
+    }
+
+    static void format_advertised(void*, zwp_linux_dmabuf_v1*, uint32_t) {}
+
+    static void modifier_advertised(void* data, zwp_linux_dmabuf_v1*, uint32_t format, uint32_t hi, uint32_t lo)
+    {
+        auto const self = static_cast<Globals*>(data);
+        if (format != self->format)
+            return;
+
+        self->format_supported = true;
+        auto const modifier = (static_cast<uint64_t>(hi) << 32) | lo;
+        // DRM_FORMAT_MOD_INVALID means "whatever the driver picks", which is how we allocate without modifiers
+        if (modifier != DRM_FORMAT_MOD_INVALID)
+            self->modifiers.push_back(modifier);
+    }
+
+    static void clock_id(void* data, wp_presentation*, uint32_t clock)
+    {
+        static_cast<Globals*>(data)->presentation_clock = static_cast<clockid_t>(clock);
+    }
+
+    static xdg_wm_base_listener const wm_base_listener;
+    static zwp_linux_dmabuf_v1_listener const dmabuf_listener;
+    static wp_presentation_listener const presentation_listener;
+};
+
+xdg_wm_base_listener const Globals::wm_base_listener{&Globals::ping};
+zwp_linux_dmabuf_v1_listener const Globals::dmabuf_listener{&Globals::format_advertised, &Globals::modifier_advertised};
+wp_presentation_listener const Globals::presentation_listener{&Globals::clock_id};
+wl_registry_listener const registry_listener{&Globals::add, &Globals::remove};
+
+auto has_extension(char const* extensions, char const* name) -> bool
+{
+    return extensions && strstr(extensions, name);
+}
+
+/// A surfaceless GLES2 context on the render node, for drawing into buffer objects
+class Renderer
+{
+public:
+    explicit Renderer(gbm_device* device)
+    {
+        auto const get_platform_display = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+            eglGetProcAddress("eglGetPlatformDisplayEXT"));
+        if (!get_platform_display)
+            throw std::runtime_error{"EGL lacks eglGetPlatformDisplayEXT"};
+
+        display = get_platform_display(EGL_PLATFORM_GBM_KHR, device, nullptr);
+        if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr))
+            throw std::runtime_error{"Failed to initialise EGL on the GBM device"};
+
+        auto const extensions = eglQueryString(display, EGL_EXTENSIONS);
+        if (!has_extension(extensions, "EGL_KHR_surfaceless_context") ||
+            !has_extension(extensions, "EGL_EXT_image_dma_buf_import"))
+            throw std::runtime_error{"EGL lacks EGL_KHR_surfaceless_context or EGL_EXT_image_dma_buf_import"};
+        modifiers_supported = has_extension(extensions, "EGL_EXT_image_dma_buf_import_modifiers");
+        native_fences_supported = has_extension(extensions, "EGL_ANDROID_native_fence_sync");
+
+        EGLint const config_attribs[] = {EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT, EGL_SURFACE_TYPE, 0, EGL_NONE};
+        EGLConfig config;
+        EGLint configs{0};
+        if (!eglChooseConfig(display, config_attribs, &config, 1, &configs) || configs != 1)
+            throw std::runtime_error{"No EGL config for a GLES2 context"};
+
+        eglBindAPI(EGL_OPENGL_ES_API);
+        EGLint const context_attribs[] = {EGL_CONTEXT_CLIENT_VERSION, 2, EGL_NONE};
+        context = eglCreateContext(display, config, EGL_NO_CONTEXT, context_attribs);
+        if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+            throw std::runtime_error{"Failed to make a surfaceless GLES2 context current"};
+
+        create_image = reinterpret_cast<PFNEGLCREATEIMAGEKHRPROC>(eglGetProcAddress("eglCreateImageKHR"));
+        destroy_image = reinterpret_cast<PFNEGLDESTROYIMAGEKHRPROC>(eglGetProcAddress("eglDestroyImageKHR"));
+        image_target_renderbuffer = reinterpret_cast<PFNGLEGLIMAGETARGETRENDERBUFFERSTORAGEOESPROC>(
+            eglGetProcAddress("glEGLImageTargetRenderbufferStorageOES"));
+        create_sync = reinterpret_cast<PFNEGLCREATESYNCKHRPROC>(eglGetProcAddress("eglCreateSyncKHR"));
+        destroy_sync = reinterpret_cast<PFNEGLDESTROYSYNCKHRPROC>(eglGetProcAddress("eglDestroySyncKHR"));
+        wait_sync = reinterpret_cast<PFNEGLWAITSYNCKHRPROC>(eglGetProcAddress("eglWaitSyncKHR"));
+        dup_fence_fd = reinterpret_cast<PFNEGLDUPNATIVEFENCEFDANDROIDPROC>(
+            eglGetProcAddress("eglDupNativeFenceFDANDROID"));
+        if (!create_image || !destroy_image || !image_target_renderbuffer)
+            throw std::runtime_error{"EGL lacks EGLImage support for renderbuffers"};
+    }
+
+    ~Renderer()
+    {
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(display, context);
+        eglTerminate(display);
+    }
+
+    Renderer(Renderer const&) = delete;
+    Renderer& operator=(Renderer const&) = delete;
+
+    /// Submits the GL commands so far, returning a sync file that signals when they complete
+    auto fence() -> int
+    {
+        if (!native_fences_supported || !create_sync || !dup_fence_fd)
+            throw std::runtime_error{"EGL lacks EGL_ANDROID_native_fence_sync, needed for --explicit-sync"};
+
+        auto const sync = create_sync(display, EGL_SYNC_NATIVE_FENCE_ANDROID, nullptr);
+        glFlush();
+        auto const fd = dup_fence_fd(display, sync);
+        destroy_sync(display, sync);
+        return fd;
+    }
+
+    /// Has the GPU wait (not us) for a sync file to signal before running later GL commands; takes the fd
+    void wait_for(int fence_fd)
+    {
+        EGLint const attribs[] = {EGL_SYNC_NATIVE_FENCE_FD_ANDROID, fence_fd, EGL_NONE};
+        auto const sync = create_sync(display, EGL_SYNC_NATIVE_FENCE_ANDROID, attribs);
+        if (sync == EGL_NO_SYNC_KHR)
+        {
+            close(fence_fd);
+            glFinish();
+            return;
+        }
+        wait_sync(display, sync, 0);
+        destroy_sync(display, sync);
+    }
+
+    EGLDisplay display;
+    EGLContext context;
+    bool modifiers_supported{false};
+    bool native_fences_supported{false};
+
+    PFNEGLCREATEIMAGEKHRPROC create_image;
+    PFNEGLDESTROYIMAGEKHRPROC destroy_image;
+    PFNGLEGLIMAGETARGETRENDERBUFFERSTORAGEOESPROC image_target_renderbuffer;
+    PFNEGLCREATESYNCKHRPROC create_sync;
+    PFNEGLDESTROYSYNCKHRPROC destroy_sync;
+    PFNEGLWAITSYNCKHRPROC wait_sync;
+    PFNEGLDUPNATIVEFENCEFDANDROIDPROC dup_fence_fd;
+};
+
+/// A GBM buffer object, rendered to through an EGLImage and shown through a wl_buffer of the same DMA-buf
+class Buffer
+{
+public:
+    Buffer(
+        gbm_device* device,
+        Renderer& renderer,
+        zwp_linux_dmabuf_v1* dmabuf,
+        Options const& options,
+        std::vector<uint64_t> const& modifiers) :
+        renderer{renderer},
+        width{options.width},
+        height{options.height}
+    {
+        if (!modifiers.empty())
+        {
+            bo = gbm_bo_create_with_modifiers(
+                device, width, height, options.format, modifiers.data(), modifiers.size());
+        }
+        if (!bo)
+        {
+            bo = gbm_bo_create(device, width, height, options.format, GBM_BO_USE_RENDERING);
+        }
+        if (!bo)
+            throw std::runtime_error{"Failed to allocate a GBM buffer object"};
+
+        modifier = gbm_bo_get_modifier(bo);
+        auto const planes = gbm_bo_get_plane_count(bo);
+
+        static EGLint const plane_fd[] = {
+            EGL_DMA_BUF_PLANE0_FD_EXT, EGL_DMA_BUF_PLANE1_FD_EXT,
+            EGL_DMA_BUF_PLANE2_FD_EXT, EGL_DMA_BUF_PLANE3_FD_EXT};
+        static EGLint const plane_offset[] = {
+            EGL_DMA_BUF_PLANE0_OFFSET_EXT, EGL_DMA_BUF_PLANE1_OFFSET_EXT,
+            EGL_DMA_BUF_PLANE2_OFFSET_EXT, EGL_DMA_BUF_PLANE3_OFFSET_EXT};
+        static EGLint const plane_pitch[] = {
+            EGL_DMA_BUF_PLANE0_PITCH_EXT, EGL_DMA_BUF_PLANE1_PITCH_EXT,
+            EGL_DMA_BUF_PLANE2_PITCH_EXT, EGL_DMA_BUF_PLANE3_PITCH_EXT};
+        static EGLint const plane_modifier_lo[] = {
+            EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT, EGL_DMA_BUF_PLANE1_MODIFIER_LO_EXT,
+            EGL_DMA_BUF_PLANE2_MODIFIER_LO_EXT, EGL_DMA_BUF_PLANE3_MODIFIER_LO_EXT};
+        static EGLint const plane_modifier_hi[] = {
+            EGL_DMA_BUF_PLANE0_MODIFIER_HI_EXT, EGL_DMA_BUF_PLANE1_MODIFIER_HI_EXT,
+            EGL_DMA_BUF_PLANE2_MODIFIER_HI_EXT, EGL_DMA_BUF_PLANE3_MODIFIER_HI_EXT};
+
+        std::vector<EGLint> attribs{
+            EGL_WIDTH, width,
+            EGL_HEIGHT, height,
+            EGL_LINUX_DRM_FOURCC_EXT, static_cast<EGLint>(options.format)};
+
+        auto const params = zwp_linux_dmabuf_v1_create_params(dmabuf);
+        std::vector<int> fds;
+
+        for (int plane = 0; plane != planes && plane != 4; ++plane)
+        {
+            auto const fd = gbm_bo_get_fd(bo);
+            if (fd < 0)
+                throw std::runtime_error{"Failed to export a GBM buffer object"};
+            fds.push_back(fd);
+
+            auto const offset = gbm_bo_get_offset(bo, plane);
+            auto const stride = gbm_bo_get_stride_for_plane(bo, plane);
+
+            attribs.insert(attribs.end(), {
+                plane_fd[plane], fd,
+                plane_offset[plane], static_cast<EGLint>(offset),
+                plane_pitch[plane], static_cast<EGLint>(stride)});
+            if (modifier != DRM_FORMAT_MOD_INVALID && renderer.modifiers_supported)
+            {
+                attribs.insert(attribs.end(), {
+                    plane_modifier_lo[plane], static_cast<EGLint>(modifier & 0xffffffff),
+                    plane_modifier_hi[plane], static_cast<EGLint>(modifier >> 32)});
+            }
+
+            zwp_linux_buffer_params_v1_add(
+                params, fd, plane, offset, stride, modifier >> 32, modifier & 0xffffffff);
+        }
+        attribs.push_back(EGL_NONE);
+
+        buffer = zwp_linux_buffer_params_v1_create_immed(params, width, height, options.format, 0);
+        zwp_linux_buffer_params_v1_destroy(params);
+        wl_buffer_add_listener(buffer, &buffer_listener, this);
+
+        image = renderer.create_image(
+            renderer.display, EGL_NO_CONTEXT, EGL_LINUX_DMA_BUF_EXT, nullptr, attribs.data());
+        // The request has been marshalled (with copies of the fds) and EGL has its own references
+        for (auto const fd : fds)
+            close(fd);
+        if (image == EGL_NO_IMAGE_KHR)
+            throw std::runtime_error{"Failed to import a GBM buffer object as an EGLImage"};
+
+        glGenRenderbuffers(1, &renderbuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer);
+        renderer.image_target_renderbuffer(GL_RENDERBUFFER, image);
+
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffer);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            throw std::runtime_error{"A GBM buffer object can't be rendered to"};
+    }
+
+    ~Buffer()
+    {
+        if (release)
+            zwp_linux_buffer_release_v1_destroy(release);
+        if (release_fence >= 0)
+            close(release_fence);
+        glDeleteFramebuffers(1, &framebuffer);
+        glDeleteRenderbuffers(1, &renderbuffer);
+        renderer.destroy_image(renderer.display, image);
+        wl_buffer_destroy(buffer);
+        gbm_bo_destroy(bo);
+    }
+
+    Buffer(Buffer const&) = delete;
+    Buffer& operator=(Buffer const&) = delete;
+
+    /// Draws a frame: a background that changes colour, and a bar that moves across it
+    void paint(uint32_t frame)
+    {
+        if (release_fence >= 0)
+        {
+            renderer.wait_for(release_fence);
+            release_fence = -1;
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glViewport(0, 0, width, height);
+
+        glDisable(GL_SCISSOR_TEST);
+        glClearColor((frame & 0xff) / 255.0f, 0.5f, 0.5f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        auto const bar_width = std::max(width / 16, 1);
+        glEnable(GL_SCISSOR_TEST);
+        glScissor((frame * 4) % width, 0, bar_width, height);
+        glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        glDisable(GL_SCISSOR_TEST);
+    }
+
+    /// Has the compositor tell us through \a sync when it's done with this commit of the buffer
+    void release_through(zwp_linux_surface_synchronization_v1* sync)
+    {
+        if (release)
+            zwp_linux_buffer_release_v1_destroy(release);
+        release = zwp_linux_surface_synchronization_v1_get_release(sync);
+        zwp_linux_buffer_release_v1_add_listener(release, &release_listener, this);
+    }
+
+    wl_buffer* buffer{nullptr};
+    uint64_t modifier{DRM_FORMAT_MOD_INVALID};
+    bool busy{false};
+
+private:
+    static void released(void* data, wl_buffer*)
+    {
+        auto const self = static_cast<Buffer*>(data);
+        // With explicit sync, we wait for the release fence
+        if (!self->release)
+            self->busy = false;
+    }
+
+    static void fenced_release(void* data, zwp_linux_buffer_release_v1* release, int32_t fence)
+    {
+        auto const self = static_cast<Buffer*>(data);
+        zwp_linux_buffer_release_v1_destroy(release);
+        self->release = nullptr;
+        if (self->release_fence >= 0)
+            close(self->release_fence);
+        self->release_fence = fence;
+        self->busy = false;
+    }
+
+    static void immediate_release(void* data, zwp_linux_buffer_release_v1* release)
+    {
+        auto const self = static_cast<Buffer*>(data);
+        zwp_linux_buffer_release_v1_destroy(release);
+        self->release = nullptr;
+        self->busy = false;
+    }
+
+    static wl_buffer_listener const buffer_listener;
+    static zwp_linux_buffer_release_v1_listener const release_listener;
+
+    Renderer& renderer;
+    int const width;
+    int const height;
+    gbm_bo* bo{nullptr};
+    EGLImageKHR image{EGL_NO_IMAGE_KHR};
+    GLuint renderbuffer{0};
+    GLuint framebuffer{0};
+    zwp_linux_buffer_release_v1* release{nullptr};
+    int release_fence{-1};
+};
+
+wl_buffer_listener const Buffer::buffer_listener{&Buffer::released};
+zwp_linux_buffer_release_v1_listener const Buffer::release_listener{&Buffer::fenced_release, &Buffer::immediate_release};
+
+struct Stats
+{
+    unsigned long commits{0};
+    unsigned long frames{0};
+    unsigned long missed{0};
+    unsigned long presented{0};
+    unsigned long zero_copy{0};
+    unsigned long discarded{0};
+    std::vector<int64_t> latencies_ns;
+};
+
+/// Follows one commit to its presentation (or not)
+class Feedback
+{
+public:
+    Feedback(wp_presentation* presentation, wl_surface* surface, clockid_t clock, Stats& stats) :
+        feedback{wp_presentation_feedback(presentation, surface)},
+        committed_ns{now_ns(clock)},
+        stats{stats}
+    {
+        wp_presentation_feedback_add_listener(feedback, &listener, this);
+    }
+
+private:
+    static void sync_output(void*, wp_presentation_feedback*, wl_output*) {}
+
+    static void presented(
+        void* data, wp_presentation_feedback* feedback,
+        uint32_t tv_sec_hi, uint32_t tv_sec_lo, uint32_t tv_nsec,
+        uint32_t, uint32_t, uint32_t, uint32_t flags)
+    {
+        auto const self = static_cast<Feedback*>(data);
+        auto const presented_ns = ((static_cast<int64_t>(tv_sec_hi) << 32) | tv_sec_lo) * 1000000000LL + tv_nsec;
+
+        ++self->stats.presented;
+        if (flags & WP_PRESENTATION_FEEDBACK_KIND_ZERO_COPY)
+            ++self->stats.zero_copy;
+        self->stats.latencies_ns.push_back(presented_ns - self->committed_ns);
+
+        wp_presentation_feedback_destroy(feedback);
+        delete self;
+    }
+
+    static void discarded(void* data, wp_presentation_feedback* feedback)
+    {
+        auto const self = static_cast<Feedback*>(data);
+        ++self->stats.discarded;
+        wp_presentation_feedback_destroy(feedback);
+        delete self;
+    }
+
+    static wp_presentation_feedback_listener const listener;
+
+    wp_presentation_feedback* const feedback;
+    int64_t const committed_ns;
+    Stats& stats;
+};
+
+wp_presentation_feedback_listener const Feedback::listener{&Feedback::sync_output, &Feedback::presented, &Feedback::discarded};
+
+class DMABufClient
+{
+public:
+    DMABufClient(wl_display* display, Globals const& globals, gbm_device* device, Options const& options) :
+        globals{globals},
+        options{options},
+        renderer{device},
+        surface{wl_compositor_create_surface(globals.compositor)},
+        xdg_surface_{xdg_wm_base_get_xdg_surface(globals.wm_base, surface)},
+        toplevel{xdg_surface_get_toplevel(xdg_surface_)}
+    {
+        xdg_surface_add_listener(xdg_surface_, &surface_listener, this);
+        xdg_toplevel_set_title(toplevel, "mir_dmabuf_client");
+        if (options.fullscreen)
+            xdg_toplevel_set_fullscreen(toplevel, nullptr);
+        wl_surface_commit(surface);
+
+        if (options.explicit_sync)
+        {
+            if (!globals.explicit_sync)
+                throw std::runtime_error{"The compositor lacks zwp_linux_explicit_synchronization_v1"};
+            sync = zwp_linux_explicit_synchronization_v1_get_synchronization(globals.explicit_sync, surface);
+        }
+        if (options.presentation && !globals.presentation)
+            throw std::runtime_error{"The compositor lacks wp_presentation"};
+
+        std::vector<uint64_t> const no_modifiers;
+        for (int i = 0; i != options.buffers; ++i)
+        {
+            buffers.push_back(std::make_unique<Buffer>(
+                device, renderer, globals.dmabuf, options, options.modifiers ? globals.modifiers : no_modifiers));
+        }
+
+        while (!configured)
+        {
+            if (wl_display_dispatch(display) < 0)
+                throw std::runtime_error{"Lost the connection to the compositor"};
+        }
+    }
+
+    ~DMABufClient()
+    {
+        if (frame_callback)
+            wl_callback_destroy(frame_callback);
+        buffers.clear();
+        if (sync)
+            zwp_linux_surface_synchronization_v1_destroy(sync);
+        xdg_toplevel_destroy(toplevel);
+        xdg_surface_destroy(xdg_surface_);
+        wl_surface_destroy(surface);
+    }
+
+    /// Commits a frame, unless the last hasn't been drawn yet
+    void tick()
+    {
+        if (frame_callback)
+        {
+            ++stats.missed;
+            return;
+        }
+
+        auto const free = std::find_if(buffers.begin(), buffers.end(), [](auto const& b) { return !b->busy; });
+        if (free == buffers.end())
+        {
+            // The compositor holds every buffer
+            ++stats.missed;
+            return;
+        }
+        auto& buffer = **free;
+
+        buffer.paint(stats.commits);
+
+        if (sync)
+        {
+            auto const fence = renderer.fence();
+            zwp_linux_surface_synchronization_v1_set_acquire_fence(sync, fence);
+            close(fence);
+            buffer.release_through(sync);
+        }
+        else
+        {
+            // The DMA-buf's implicit fence covers the rendering once it's submitted
+            glFlush();
+        }
+
+        frame_callback = wl_surface_frame(surface);
+        wl_callback_add_listener(frame_callback, &frame_listener, this);
+
+        buffer.busy = true;
+        wl_surface_attach(surface, buffer.buffer, 0, 0);
+        wl_surface_damage(surface, 0, 0, options.width, options.height);
+        if (options.presentation)
+            new Feedback{globals.presentation, surface, globals.presentation_clock, stats};
+        wl_surface_commit(surface);
+        ++stats.commits;
+    }
+
+    bool waiting_for_frame() const { return frame_callback != nullptr; }
+
+    auto modifier() const -> uint64_t { return buffers.front()->modifier; }
+
+    Stats stats;
+
+private:
+    static void configure(void* data, xdg_surface* xdg_surface, uint32_t serial)
+    {
+        auto const self = static_cast<DMABufClient*>(data);
+        xdg_surface_ack_configure(xdg_surface, serial);
+        self->configured = true;
+    }
+
+    static void frame_done(void* data, wl_callback* callback, uint32_t)
+    {
+        auto const self = static_cast<DMABufClient*>(data);
+        wl_callback_destroy(callback);
+        self->frame_callback = nullptr;
+        ++self->stats.frames;
+    }
+
+    static xdg_surface_listener const surface_listener;
+    static wl_callback_listener const frame_listener;
+
+    Globals const& globals;
+    Options const& options;
+    Renderer renderer;
+    wl_surface* const surface;
+    xdg_surface* const xdg_surface_;
+    xdg_toplevel* const toplevel;
+    zwp_linux_surface_synchronization_v1* sync{nullptr};
+    std::vector<std::unique_ptr<Buffer>> buffers;
+    wl_callback* frame_callback{nullptr};
+    bool configured{false};
+};
+
+xdg_surface_listener const DMABufClient::surface_listener{&DMABufClient::configure};
+wl_callback_listener const DMABufClient::frame_listener{&DMABufClient::frame_done};
+
+auto percentiles_ms(std::vector<int64_t> samples_ns) -> std::string
+{
+    if (samples_ns.empty())
+        return "{\"p50\": 0, \"p99\": 0, \"max\": 0}";
+
+    std::sort(samples_ns.begin(), samples_ns.end());
+    auto const at = [&](double fraction)
+        {
+            return samples_ns[static_cast<size_t>(fraction * (samples_ns.size() - 1))] / 1e6;
+        };
+
+    char buffer[128];
+    snprintf(buffer, sizeof buffer, "{\"p50\": %.3f, \"p99\": %.3f, \"max\": %.3f}", at(0.5), at(0.99), at(1.0));
+    return buffer;
+}
+
+auto timer_for(double rate) -> int
+{
+    auto const fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    auto const period_ns = static_cast<long>(1e9 / rate);
+    itimerspec const period{{period_ns / 1000000000, period_ns % 1000000000}, {period_ns / 1000000000, period_ns % 1000000000}};
+    if (fd < 0 || timerfd_settime(fd, 0, &period, nullptr) < 0)
+        throw std::runtime_error{"Failed to create the commit timer"};
+    return fd;
+}
+
+auto termination_signals() -> int
+{
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGINT);
+    sigprocmask(SIG_BLOCK, &signals, nullptr);
+    return signalfd(-1, &signals, SFD_CLOEXEC);
+}
+}
+
+int main(int argc, char* argv[])
+try
+{
+    auto const options = parse(argc, argv);
+    auto const signals = termination_signals();
+
+    auto const drm_fd = open(options.device.c_str(), O_RDWR | O_CLOEXEC);
+    if (drm_fd < 0)
+        throw std::runtime_error{"Failed to open " + options.device};
+    auto const device = gbm_create_device(drm_fd);
+    if (!device)
+        throw std::runtime_error{"Failed to create a GBM device on " + options.device};
+
+    auto const display = wl_display_connect(nullptr);
+    if (!display)
+        throw std::runtime_error{"Failed to connect to the Wayland compositor"};
+
+    Globals globals{options.format};
+    auto const registry = wl_display_get_registry(display);
+    wl_registry_add_listener(registry, &registry_listener, &globals);
+    wl_display_roundtrip(display);
+    if (!globals.compositor || !globals.wm_base || !globals.dmabuf)
+        throw std::runtime_error{"The compositor lacks wl_compositor, xdg_wm_base or zwp_linux_dmabuf_v1 (v3)"};
+    // The formats and modifiers, and the presentation clock, follow the binds
+    wl_display_roundtrip(display);
+    if (!globals.format_supported)
+        throw std::runtime_error{"The compositor doesn't take DMA-bufs in the requested --format"};
+
+    Stats stats;
+    uint64_t modifier;
+    {
+        DMABufClient client{display, globals, device, options};
+        auto const timer = options.rate > 0 ? timer_for(options.rate) : -1;
+        modifier = client.modifier();
+
+        client.tick();
+
+        for (bool running = true; running;)
+        {
+            while (wl_display_prepare_read(display) != 0)
+                wl_display_dispatch_pending(display);
+            wl_display_flush(display);
+
+            pollfd fds[] = {
+                {wl_display_get_fd(display), POLLIN, 0},
+                {signals, POLLIN, 0},
+                {timer, POLLIN, 0}};
+
+            if (poll(fds, timer < 0 ? 2 : 3, -1) < 0)
+            {
+                wl_display_cancel_read(display);
+                continue;
+            }
+
+            if (fds[0].revents & POLLIN)
+            {
+                if (wl_display_read_events(display) < 0)
+                    throw std::runtime_error{"Lost the connection to the compositor"};
+            }
+            else
+            {
+                wl_display_cancel_read(display);
+            }
+            wl_display_dispatch_pending(display);
+
+            if (fds[1].revents & POLLIN)
+                running = false;
+
+            if (timer >= 0 && (fds[2].revents & POLLIN))
+            {
+                uint64_t expirations{0};
+                if (read(timer, &expirations, sizeof expirations) == sizeof expirations)
+                {
+                    // Ticks we slept through count as missed, as well as any tick we can't commit on
+                    client.stats.missed += expirations - 1;
+                    client.tick();
+                }
+            }
+            else if (timer < 0 && !client.waiting_for_frame())
+            {
+                client.tick();
+            }
+        }
+
+        // Collect the feedback still on its way
+        wl_display_roundtrip(display);
+        stats = client.stats;
+        if (timer >= 0)
+            close(timer);
+    }
+
+    printf("{\"pid\": %d, \"buffers\": \"gbm\", \"modifier\": \"0x%llx\", \"explicit_sync\": %s, "
+           "\"commits\": %lu, \"frames\": %lu, \"missed\": %lu, "
+           "\"presented\": %lu, \"zero_copy\": %lu, \"discarded\": %lu, \"latency_ms\": %s}\n",
+           getpid(), static_cast<unsigned long long>(modifier), options.explicit_sync ? "true" : "false",
+           stats.commits, stats.frames, stats.missed,
+           stats.presented, stats.zero_copy, stats.discarded, percentiles_ms(stats.latencies_ns).c_str());
+
+    wl_registry_destroy(registry);
+    wl_display_disconnect(display);
+    gbm_device_destroy(device);
+    close(drm_fd);
+    return EXIT_SUCCESS;
+}
+catch (std::exception const& error)
+{
+    fprintf(stderr, "mir_dmabuf_client: %s\n", error.what());
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,149 @@
+#!/usr/bin/env python3
+
+import babeltrace
+import statistics
+import sys
+from text_histogram import histogram
+
+howto = """
+Process a LTTNG trace for frame pacing: how evenly each output's frames were
+presented, and which clients' frames never made it to the screen.
+
+For each output (the "display" of the mir_server_frame events) this reports
+the interval between presented frames and its jitter, vblanks missed (the
+display's counter advancing by more than one between frames) or duplicated
+(not advancing at all), and how many frames were scanned out directly from a
+client's buffer rather than composited. For each client it reports how many
+of the buffers it committed were dropped by a frame-dropping stream
+(mir_server_frame:buffer_dropped) before any compositor took them.
+
+To generate such a trace you need a Mir server built with LTTNG support, for
+example:
+
+> miral-app
+
+Once you have your compositor active, you can get an LTTNG trace like so:
+> lttng create mir-trace
+> lttng enable-event -u "mir_server_wayland:*_buffer_committed"
+> lttng enable-event -u "mir_server_frame:*"
+> lttng start
+
+Reproduce the stutter, then:
+
+> lttng stop
+> lttng destroy
+
+This will (by default) leave you with a trace in
+~/lttng-traces/mir-trace-DIGITS-MORE_DIGITS/ust/uid/$YOUR_UID/64-bit
+
+This trace can then be processed with
+> python3 frame_pacing.py ~/lttng-traces/mir-trace-$DIGITS-$MORE_DIGITS/ust/uid/$YOUR_UID/64-bit
+"""
+
+try:
+    trace_path = sys.argv[1]
+
+    trace_collection = babeltrace.TraceCollection()
+    trace_collection.add_trace(trace_path, 'ctf')
+except:
+    print(howto)
+    raise
+
+class OutputStats:
+    def __init__(self):
+        self.intervals = []     # ns between successive presented frames
+        self.last_presented = None
+        self.last_msc = None
+        self.missed_vblanks = 0
+        self.duplicated_vblanks = 0
+        self.composited = 0
+        self.bypassed = 0
+        self.empty = 0
+        # What the frame being drawn has done so far
+        self.frame_composited = False
+        self.frame_scanned_out = False
+
+class ClientStats:
+    def __init__(self):
+        self.committed = 0
+        self.dropped = 0
+
+outputs = dict()
+clients = dict()
+buffer_clients = dict()     # buffer_id -> client that last committed it
+
+for event in trace_collection.events:
+    name = event.name
+    if name in ('mir_server_wayland:sw_buffer_committed', 'mir_server_wayland:hw_buffer_committed'):
+        client = clients.setdefault(event['client'], ClientStats())
+        client.committed += 1
+        buffer_clients[event['buffer_id']] = event['client']
+    elif name == 'mir_server_frame:buffer_dropped':
+        client = buffer_clients.get(event['buffer_id'])
+        if client is not None:
+            clients[client].dropped += 1
+    elif name == 'mir_server_frame:scene_snapshot':
+        output = outputs.setdefault(event['display'], OutputStats())
+        output.frame_composited = False
+        output.frame_scanned_out = False
+    elif name == 'mir_server_frame:composited':
+        if event['display'] in outputs:
+            outputs[event['display']].frame_composited = True
+    elif name == 'mir_server_frame:scanned_out':
+        if event['display'] in outputs:
+            outputs[event['display']].frame_scanned_out = True
+    elif name == 'mir_server_frame:post_started':
+        output = outputs.get(event['display'])
+        if output is None:
+            continue
+        if output.frame_composited:
+            output.composited += 1
+        elif output.frame_scanned_out:
+            output.bypassed += 1
+        else:
+            output.empty += 1
+    elif name == 'mir_server_frame:presented':
+        output = outputs.setdefault(event['display'], OutputStats())
+        # ust_ns is when the display showed the frame; fall back to when we heard of it
+        presented = event['ust_ns'] if event['ust_ns'] > 0 else event.timestamp
+        if output.last_presented is not None:
+            output.intervals.append(presented - output.last_presented)
+        output.last_presented = presented
+
+        msc = event['msc']
+        if msc > 0 and output.last_msc is not None:
+            if msc == output.last_msc:
+                output.duplicated_vblanks += 1
+            elif msc > output.last_msc + 1:
+                output.missed_vblanks += msc - output.last_msc - 1
+        if msc > 0:
+            output.last_msc = msc
+
+def report(title, intervals):
+    print(title + " (ms):")
+    intervals_ms = [interval / 1000000 for interval in intervals]
+    if len(set(intervals_ms)) > 1:
+        histogram(intervals_ms)
+        print("Mean: {:.3f}  Jitter (standard deviation): {:.3f}  Worst: {:.3f}".format(
+            statistics.mean(intervals_ms), statistics.stdev(intervals_ms), max(intervals_ms)))
+    else:
+        # The histogram needs a range of values to bin
+        print(intervals_ms)
+
+for (id, output) in outputs.items():
+    print("Output: ", hex(id))
+    report("Presentation interval", output.intervals)
+    print("Missed vblanks: ", output.missed_vblanks)
+    print("Duplicated vblanks: ", output.duplicated_vblanks)
+    drawn = output.composited + output.bypassed
+    if drawn > 0:
+        print("Frames composited: {}  scanned out (bypass): {} ({:.1f}%)".format(
+            output.composited, output.bypassed, 100 * output.bypassed / drawn))
+    if output.empty > 0:
+        print("Frames with nothing to draw: ", output.empty)
+
+for (id, client) in clients.items():
+    print("Client: ", id)
+    rate = 100 * client.dropped / client.committed if client.committed else 0
+    print("Buffers committed: {}  dropped before being composited: {} ({:.1f}%)".format(
+        client.committed, client.dropped, rate))
@@ -0,0 +1,317 @@
+#!/usr/bin/python3
+
+"""End-to-end input-to-photon latency.
+
+Injects key presses through uinput, and times each until the frame in which a
+reference client (mir_latency_reference_client) shows its response reaches the
+screen, as reported by presentation feedback. Reports distributions for each
+stage of the way:
+
+  input      kernel to the server's seat         (server's --input-report=log)
+  dispatch   seat to the event being sent        (server's --input-report=log)
+  delivery   injection to the client receiving the event
+  client     the client receiving the event to committing its response
+  present    commit to the frame being presented (composite and scanout)
+  composite  the compositor's render time per frame (server's --compositor-report=log)
+  total      injection to presentation
+
+  input_latency.py run --server bin/mir_demo_server --output before.json
+  input_latency.py compare before.json after.json
+"""
+
+import argparse
+import json
+import os
+import queue
+import random
+import re
+import shutil
+import statistics
+import subprocess
+import sys
+import threading
+import time
+
+import evdev
+
+INPUT_REPORT = re.compile(
+    r"Input latency from kernel \(p50/p95/p99 us\): "
+    r"seat=(?P<seat>\d+/\d+/\d+) \((?P<seat_events>\d+) events, \d+ dropped\) "
+    r"dispatcher=(?P<dispatcher>\d+/\d+/\d+) \(\d+ events, \d+ dropped\) "
+    r"client=(?P<client>\d+/\d+/\d+) \((?P<client_events>\d+) events, (?P<client_dropped>\d+) dropped\)")
+
+COMPOSITOR_REPORT = re.compile(r"averaged [\d.]+ FPS, (?P<frame_time>[\d.]+) ms/frame")
+
+# The server's input report logs at most every ten seconds
+INPUT_REPORT_PERIOD = 10
+
+
+def now_ns():
+    return time.clock_gettime_ns(time.CLOCK_MONOTONIC)
+
+
+def percentile(samples, fraction):
+    if not samples:
+        return 0.0
+    ordered = sorted(samples)
+    return ordered[min(len(ordered) - 1, int(fraction * len(ordered)))]
+
+
+def distribution(samples):
+    return {
+        "mean": statistics.mean(samples) if samples else 0.0,
+        "p50": percentile(samples, 0.5),
+        "p95": percentile(samples, 0.95),
+        "p99": percentile(samples, 0.99),
+        "max": max(samples, default=0.0),
+    }
+
+
+class Keyboard:
+    def __init__(self):
+        self.ui = evdev.UInput(
+            events={evdev.ecodes.EV_KEY: [evdev.ecodes.KEY_SPACE]},
+            name="mir-input-latency-keyboard")
+
+    def press(self):
+        """Presses the key, returning when it did so (CLOCK_MONOTONIC ns)"""
+        injected = now_ns()
+        self.ui.write(evdev.ecodes.EV_KEY, evdev.ecodes.KEY_SPACE, 1)
+        self.ui.syn()
+        return injected
+
+    def release(self):
+        self.ui.write(evdev.ecodes.EV_KEY, evdev.ecodes.KEY_SPACE, 0)
+        self.ui.syn()
+
+    def close(self):
+        self.ui.close()
+
+
+class Server:
+    def __init__(self, executable, options, socket_name):
+        env = os.environ.copy()
+        env["WAYLAND_DISPLAY"] = socket_name
+        self.socket = os.path.join(os.environ["XDG_RUNTIME_DIR"], socket_name)
+        self.process = subprocess.Popen(
+            [executable, "--input-report=log", "--compositor-report=log"] + options,
+            env=env, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+        self.lines = []
+        self.reader = threading.Thread(target=self._read, daemon=True)
+        self.reader.start()
+
+    def _read(self):
+        for line in self.process.stdout:
+            self.lines.append(line)
+
+    def wait_for_socket(self, timeout):
+        deadline = time.monotonic() + timeout
+        while not os.path.exists(self.socket):
+            if self.process.poll() is not None or time.monotonic() > deadline:
+                sys.exit("Server failed to start:\n" + "".join(self.lines))
+            time.sleep(0.05)
+
+    def stop(self):
+        self.process.terminate()
+        self.process.wait(timeout=10)
+        self.reader.join(timeout=1)
+
+
+class Client:
+    def __init__(self, executable, socket_name):
+        env = os.environ.copy()
+        env["WAYLAND_DISPLAY"] = socket_name
+        self.process = subprocess.Popen(
+            [executable], env=env, stdout=subprocess.PIPE, universal_newlines=True)
+        self.records = queue.Queue()
+        self.reader = threading.Thread(target=self._read, daemon=True)
+        self.reader.start()
+
+    def _read(self):
+        for line in self.process.stdout:
+            try:
+                self.records.put(json.loads(line))
+            except ValueError:
+                pass
+
+    def next_record(self, timeout, since=0):
+        """The next record of an event received after since (CLOCK_MONOTONIC ns)
+
+        Skips records of earlier presses whose frames were presented too late to be matched.
+        """
+        deadline = time.monotonic() + timeout
+        while True:
+            try:
+                record = self.records.get(timeout=max(0, deadline - time.monotonic()))
+            except queue.Empty:
+                return None
+            if record.get("received", since) >= since:
+                return record
+
+    def stop(self):
+        self.process.terminate()
+        self.process.wait(timeout=10)
+
+
+def server_input_stages(lines):
+    """Per-stage latencies from the server's input report, in ms
+
+    The report gives percentiles of latency from the kernel to each stage, over
+    each period it covers. Those are combined weighted by the events in each
+    period, and dispatch is the difference between successive stages, so these
+    approximate the distributions rather than measure them.
+    """
+    reports = [m.groupdict() for m in map(INPUT_REPORT.search, lines) if m]
+    reports = [r for r in reports if int(r["seat_events"])]
+    if not reports:
+        return None
+
+    def weighted(stage, index):
+        events = sum(int(r["seat_events"]) for r in reports)
+        return sum(int(r[stage].split("/")[index]) * int(r["seat_events"]) for r in reports) / events / 1000
+
+    quantiles = ("p50", "p95", "p99")
+    return {
+        "input": {q: weighted("seat", i) for i, q in enumerate(quantiles)},
+        "dispatch": {q: weighted("client", i) - weighted("seat", i) for i, q in enumerate(quantiles)},
+        "events": sum(int(r["client_events"]) for r in reports),
+        "dropped": sum(int(r["client_dropped"]) for r in reports),
+    }
+
+
+def run(args):
+    client_executable = args.client or os.path.join(os.path.dirname(args.server), "mir_latency_reference_client")
+    socket_name = "mir_input_latency_%d" % os.getpid()
+
+    # Created first, so the server finds it at startup rather than by hotplug
+    keyboard = Keyboard()
+    server = Server(args.server, args.server_option or [], socket_name)
+    server.wait_for_socket(10)
+
+    client = Client(client_executable, socket_name)
+    ready = client.next_record(10)
+    if not ready or not ready.get("ready"):
+        client.stop()
+        server.stop()
+        keyboard.close()
+        sys.exit("The reference client failed to start:\n" + "".join(server.lines))
+
+    time.sleep(args.warmup)
+    first_report = len(server.lines)
+    start_time = time.monotonic()
+
+    samples = []
+    lost = 0
+    while len(samples) < args.samples or time.monotonic() - start_time < INPUT_REPORT_PERIOD:
+        injected = keyboard.press()
+        record = client.next_record(1, since=injected)
+        keyboard.release()
+
+        if record is None:
+            lost += 1
+        else:
+            record["injected"] = injected
+            samples.append(record)
+
+        # Spread presses across the refresh cycle, rather than locking to it
+        time.sleep(args.interval * random.uniform(0.75, 1.25))
+
+    # Let the server's input report cover the last presses
+    time.sleep(1)
+    client.stop()
+    server.stop()
+    keyboard.close()
+
+    presented = [s for s in samples if not s.get("discarded")]
+
+    def stage(start, end):
+        return distribution([(s[end] - s[start]) / 1e6 for s in presented])
+
+    frame_times = [float(m.group("frame_time"))
+                   for m in map(COMPOSITOR_REPORT.search, server.lines[first_report:]) if m]
+
+    return {
+        "label": args.label,
+        "config": {
+            "samples": args.samples,
+            "interval": args.interval,
+            "server_options": args.server_option or [],
+        },
+        "presses": len(samples) + lost,
+        "presented": len(presented),
+        "discarded": len(samples) - len(presented),
+        "lost": lost,
+        "hw_clock_percent": 100 * sum(1 for s in presented if s["hw_clock"]) / len(presented) if presented else 0.0,
+        "refresh_ms": presented[-1]["refresh"] / 1e6 if presented else 0.0,
+        "latency_ms": {
+            "server": server_input_stages(server.lines[first_report:]),
+            "delivery": stage("injected", "received"),
+            "client": stage("received", "committed"),
+            "present": stage("committed", "presented"),
+            "composite": distribution(frame_times),
+            "total": stage("injected", "presented"),
+        },
+    }
+
+
+def flatten(results, prefix=""):
+    for key, value in results.items():
+        if isinstance(value, dict):
+            yield from flatten(value, prefix + key + ".")
+        elif isinstance(value, (int, float)) and not isinstance(value, bool):
+            yield prefix + key, value
+
+
+def compare(args):
+    with open(args.before) as before_file, open(args.after) as after_file:
+        before = dict(flatten(json.load(before_file)))
+        after = dict(flatten(json.load(after_file)))
+
+    width = max(len(key) for key in before)
+    print("%-*s %12s %12s %9s" % (width, "metric", "before", "after", "change"))
+    for key, old in before.items():
+        if key not in after:
+            continue
+        new = after[key]
+        change = "%+8.1f%%" % (100 * (new - old) / old) if old else ""
+        print("%-*s %12.3f %12.3f %9s" % (width, key, old, new, change))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    run_parser = commands.add_parser("run", help="Measure the latency of a server")
+    run_parser.add_argument("--server", default=shutil.which("mir_demo_server"))
+    run_parser.add_argument("--server-option", action="append", help="Pass an option to the server")
+    run_parser.add_argument("--client",
+                            help="The reference client (default: mir_latency_reference_client beside the server)")
+    run_parser.add_argument("--samples", type=int, default=500, help="Key presses to time")
+    run_parser.add_argument("--interval", type=float, default=0.05, help="Mean seconds between presses")
+    run_parser.add_argument("--warmup", type=float, default=1, help="Seconds to settle before measuring")
+    run_parser.add_argument("--label", default="")
+    run_parser.add_argument("--output", help="Write the results to a file, rather than stdout")
+
+    compare_parser = commands.add_parser("compare", help="Compare the results of two runs")
+    compare_parser.add_argument("before")
+    compare_parser.add_argument("after")
+
+    args = parser.parse_args()
+
+    if args.command == "compare":
+        compare(args)
+        return
+
+    if not args.server:
+        sys.exit("No mir_demo_server found; use --server")
+
+    results = json.dumps(run(args), indent=2)
+    if args.output:
+        with open(args.output, "w") as output:
+            output.write(results + "\n")
+    else:
+        print(results)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,303 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The reference client for input_latency.py
+ *
+ * A fullscreen window that changes colour on each key press, and prints (as a line of
+ * JSON) when it received the press, when it committed the new content, and when the
+ * compositor's presentation feedback says that content reached the screen. All times
+ * are CLOCK_MONOTONIC nanoseconds, the clock Mir reports presentation in.
+ */
+
+#include "presentation-time-client-protocol.h"
+
+#include <wayland-client.h>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <stdexcept>
+
+namespace
+{
+auto now_ns() -> int64_t
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+class ReferenceClient
+{
+public:
+    ReferenceClient() :
+        display{wl_display_connect(nullptr)}
+    {
+        if (!display)
+            throw std::runtime_error{"Failed to connect to the Wayland compositor"};
+
+        auto const registry = wl_display_get_registry(display);
+        wl_registry_add_listener(registry, &registry_listener, this);
+        wl_display_roundtrip(display);
+        wl_registry_destroy(registry);
+
+        if (!compositor || !shm || !shell || !seat || !presentation)
+            throw std::runtime_error{"The compositor lacks wl_compositor, wl_shm, wl_shell, wl_seat or wp_presentation"};
+
+        if (clock_id != CLOCK_MONOTONIC)
+            throw std::runtime_error{"The compositor reports presentation in a clock other than CLOCK_MONOTONIC"};
+
+        surface = wl_compositor_create_surface(compositor);
+        shell_surface = wl_shell_get_shell_surface(shell, surface);
+        wl_shell_surface_add_listener(shell_surface, &shell_surface_listener, this);
+        wl_shell_surface_set_fullscreen(shell_surface, WL_SHELL_SURFACE_FULLSCREEN_METHOD_DEFAULT, 0, nullptr);
+
+        // The fullscreen size arrives as a configure event
+        while (width == 0)
+        {
+            if (wl_display_dispatch(display) < 0)
+                throw std::runtime_error{"Lost the connection to the compositor"};
+        }
+
+        create_buffers();
+        show(0, -1);
+    }
+
+    void run()
+    {
+        while (wl_display_dispatch(display) >= 0)
+        {
+        }
+    }
+
+private:
+    static void add_global(void* data, wl_registry* registry, uint32_t id, char const* interface, uint32_t)
+    {
+        auto const self = static_cast<ReferenceClient*>(data);
+
+        if (strcmp(interface, wl_compositor_interface.name) == 0)
+            self->compositor = static_cast<wl_compositor*>(wl_registry_bind(registry, id, &wl_compositor_interface, 3));
+        else if (strcmp(interface, wl_shm_interface.name) == 0)
+            self->shm = static_cast<wl_shm*>(wl_registry_bind(registry, id, &wl_shm_interface, 1));
+        else if (strcmp(interface, wl_shell_interface.name) == 0)
+            self->shell = static_cast<wl_shell*>(wl_registry_bind(registry, id, &wl_shell_interface, 1));
+        else if (strcmp(interface, wl_seat_interface.name) == 0 && !self->seat)
+        {
+            self->seat = static_cast<wl_seat*>(wl_registry_bind(registry, id, &wl_seat_interface, 1));
+            wl_seat_add_listener(self->seat, &seat_listener, self);
+        }
+        else if (strcmp(interface, wp_presentation_interface.name) == 0)
+        {
+            self->presentation = static_cast<wp_presentation*>(wl_registry_bind(registry, id, &wp_presentation_interface, 1));
+            wp_presentation_add_listener(self->presentation, &presentation_listener, self);
+        }
+    }
+
+    static void remove_global(void*, wl_registry*, uint32_t) {}
+
+    static void clock(void* data, wp_presentation*, uint32_t clk_id)
+    {
+        static_cast<ReferenceClient*>(data)->clock_id = clk_id;
+    }
+
+    static void ping(void*, wl_shell_surface* shell_surface, uint32_t serial)
+    {
+        wl_shell_surface_pong(shell_surface, serial);
+    }
+
+    static void configure(void* data, wl_shell_surface*, uint32_t, int32_t width, int32_t height)
+    {
+        auto const self = static_cast<ReferenceClient*>(data);
+        if (self->width == 0 && width > 0 && height > 0)
+        {
+            self->width = width;
+            self->height = height;
+        }
+    }
+
+    static void popup_done(void*, wl_shell_surface*) {}
+
+    static void capabilities(void* data, wl_seat* seat, uint32_t caps)
+    {
+        auto const self = static_cast<ReferenceClient*>(data);
+        if ((caps & WL_SEAT_CAPABILITY_KEYBOARD) && !self->keyboard)
+        {
+            self->keyboard = wl_seat_get_keyboard(seat);
+            wl_keyboard_add_listener(self->keyboard, &keyboard_listener, self);
+        }
+    }
+
+    static void keymap(void*, wl_keyboard*, uint32_t, int32_t fd, uint32_t)
+    {
+        close(fd);
+    }
+
+    static void enter(void*, wl_keyboard*, uint32_t, wl_surface*, wl_array*) {}
+    static void leave(void*, wl_keyboard*, uint32_t, wl_surface*) {}
+    static void modifiers(void*, wl_keyboard*, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t) {}
+
+    static void key(void* data, wl_keyboard*, uint32_t, uint32_t time, uint32_t, uint32_t state)
+    {
+        auto const received = now_ns();
+        if (state == WL_KEYBOARD_KEY_STATE_PRESSED)
+            static_cast<ReferenceClient*>(data)->on_press(time, received);
+    }
+
+    void on_press(uint32_t event_time_ms, int64_t received)
+    {
+        ++presses;
+        auto const committed = show(presses, received);
+        pending = {event_time_ms, received, committed};
+    }
+
+    /// Shows frame \a n, asking for its presentation feedback; returns when it was committed
+    auto show(uint32_t n, int64_t received) -> int64_t
+    {
+        auto& buffer = buffers[n % 2];
+        auto const colour = (n % 2) ? 0xffffffffu : 0xff000000u;
+        for (auto p = buffer.pixels; p != buffer.pixels + width * height; ++p)
+            *p = colour;
+
+        wl_surface_attach(surface, buffer.buffer, 0, 0);
+        wl_surface_damage(surface, 0, 0, width, height);
+
+        if (received >= 0)
+        {
+            auto const feedback = wp_presentation_feedback(presentation, surface);
+            wp_presentation_feedback_add_listener(feedback, &feedback_listener, this);
+        }
+
+        wl_surface_commit(surface);
+        wl_display_flush(display);
+        return now_ns();
+    }
+
+    static void sync_output(void*, wp_presentation_feedback*, wl_output*) {}
+
+    static void presented(
+        void* data, wp_presentation_feedback* feedback,
+        uint32_t tv_sec_hi, uint32_t tv_sec_lo, uint32_t tv_nsec,
+        uint32_t refresh, uint32_t, uint32_t, uint32_t flags)
+    {
+        auto const self = static_cast<ReferenceClient*>(data);
+        int64_t const seconds = (static_cast<int64_t>(tv_sec_hi) << 32) | tv_sec_lo;
+
+        printf("{\"event_time_ms\": %u, \"received\": %lld, \"committed\": %lld, \"presented\": %lld, "
+               "\"refresh\": %u, \"hw_clock\": %s}\n",
+               self->pending.event_time_ms,
+               static_cast<long long>(self->pending.received),
+               static_cast<long long>(self->pending.committed),
+               static_cast<long long>(seconds * 1000000000LL + tv_nsec),
+               refresh,
+               (flags & WP_PRESENTATION_FEEDBACK_KIND_HW_CLOCK) ? "true" : "false");
+        fflush(stdout);
+        wp_presentation_feedback_destroy(feedback);
+    }
+
+    static void discarded(void* data, wp_presentation_feedback* feedback)
+    {
+        auto const self = static_cast<ReferenceClient*>(data);
+        printf("{\"event_time_ms\": %u, \"received\": %lld, \"committed\": %lld, \"discarded\": true}\n",
+               self->pending.event_time_ms,
+               static_cast<long long>(self->pending.received),
+               static_cast<long long>(self->pending.committed));
+        fflush(stdout);
+        wp_presentation_feedback_destroy(feedback);
+    }
+
+    void create_buffers()
+    {
+        auto const stride = width * 4;
+        auto const buffer_size = static_cast<size_t>(stride) * height;
+        auto const fd = memfd_create("mir-latency-client", MFD_CLOEXEC);
+        if (fd < 0 || ftruncate(fd, 2 * buffer_size) < 0)
+            throw std::runtime_error{"Failed to allocate shm buffers"};
+
+        auto const pixels = static_cast<char*>(mmap(nullptr, 2 * buffer_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+        if (pixels == MAP_FAILED)
+            throw std::runtime_error{"Failed to map shm buffers"};
+
+        auto const pool = wl_shm_create_pool(shm, fd, 2 * buffer_size);
+        for (auto i = 0; i != 2; ++i)
+        {
+            buffers[i].buffer = wl_shm_pool_create_buffer(
+                pool, i * buffer_size, width, height, stride, WL_SHM_FORMAT_XRGB8888);
+            buffers[i].pixels = reinterpret_cast<uint32_t*>(pixels + i * buffer_size);
+        }
+        wl_shm_pool_destroy(pool);
+        close(fd);
+    }
+
+    static constexpr wl_registry_listener registry_listener{&add_global, &remove_global};
+    static constexpr wp_presentation_listener presentation_listener{&clock};
+    static constexpr wl_shell_surface_listener shell_surface_listener{&ping, &configure, &popup_done};
+    static constexpr wl_seat_listener seat_listener{&capabilities, nullptr};
+    static constexpr wl_keyboard_listener keyboard_listener{&keymap, &enter, &leave, &key, &modifiers, nullptr};
+    static constexpr wp_presentation_feedback_listener feedback_listener{&sync_output, &presented, &discarded};
+
+    wl_display* const display;
+    wl_compositor* compositor{nullptr};
+    wl_shm* shm{nullptr};
+    wl_shell* shell{nullptr};
+    wl_seat* seat{nullptr};
+    wl_keyboard* keyboard{nullptr};
+    wp_presentation* presentation{nullptr};
+    uint32_t clock_id{CLOCK_MONOTONIC};
+
+    wl_surface* surface{nullptr};
+    wl_shell_surface* shell_surface{nullptr};
+    int32_t width{0};
+    int32_t height{0};
+
+    struct Buffer
+    {
+        wl_buffer* buffer{nullptr};
+        uint32_t* pixels{nullptr};
+    } buffers[2];
+
+    /// The press whose frame is awaiting presentation. Presses arrive more slowly than frames,
+    /// so there is only ever one.
+    struct
+    {
+        uint32_t event_time_ms{0};
+        int64_t received{0};
+        int64_t committed{0};
+    } pending;
+
+    uint32_t presses{0};
+};
+}
+
+int main()
+try
+{
+    ReferenceClient client;
+    printf("{\"ready\": true}\n");
+    fflush(stdout);
+    client.run();
+    return EXIT_SUCCESS;
+}
+catch (std::exception const& error)
+{
+    fprintf(stderr, "mir_latency_reference_client: %s\n", error.what());
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,266 @@
+#!/usr/bin/python3
+
+"""Per-subsystem memory accounting, and its growth per connected client.
+
+Runs a Mir server with --memory-report=log, which attributes the server's memory
+to the subsystems holding it (client buffers by type, textures, the scene,
+decorations, cursors, keymaps, Xwayland and protocol objects), and connects
+synthetic Wayland clients (mir_load_client) in steps. Each account's objects and
+bytes are sampled at each step alongside the server's resident set, and fitted
+against the number of clients to give the cost of each extra client. Once every
+client has gone, anything still held beyond the first sample is reported as
+residual: a leak, or a cache that never shrinks.
+
+  memory_accounting.py run --steps 0,50,100,200 --output before.json
+  memory_accounting.py compare before.json after.json
+"""
+
+import argparse
+import json
+import os
+import re
+import shutil
+import signal
+import subprocess
+import sys
+import threading
+import time
+
+SUMMARY = re.compile(
+    r"Memory: (?P<resident>\d+) bytes resident, (?P<accounted>\d+) bytes accounted, (?P<clients>\d+) clients")
+ACCOUNT = re.compile(
+    r"Memory: (?P<subsystem>[^/:]+)/(?P<kind>[^:]+): (?P<objects>-?\d+) objects, (?P<bytes>-?\d+) bytes")
+
+
+def rss_bytes(pid):
+    with open("/proc/%d/status" % pid) as status:
+        for line in status:
+            if line.startswith("VmRSS:"):
+                return int(line.split()[1]) * 1024
+    return 0
+
+
+def slope(points):
+    """The least-squares slope of (x, y) points"""
+    if len(points) < 2:
+        return 0.0
+    n = len(points)
+    mean_x = sum(x for x, _ in points) / n
+    mean_y = sum(y for _, y in points) / n
+    variance = sum((x - mean_x) ** 2 for x, _ in points)
+    if not variance:
+        return 0.0
+    return sum((x - mean_x) * (y - mean_y) for x, y in points) / variance
+
+
+class Server:
+    def __init__(self, executable, options, socket_name, interval):
+        env = os.environ.copy()
+        env["WAYLAND_DISPLAY"] = socket_name
+        self.socket = os.path.join(os.environ["XDG_RUNTIME_DIR"], socket_name)
+        self.interval = interval
+        self.process = subprocess.Popen(
+            [executable, "--memory-report=log", "--memory-report-interval=%d" % interval] + options,
+            env=env, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+        self.lines = []
+        self.reader = threading.Thread(target=self._read, daemon=True)
+        self.reader.start()
+
+    def _read(self):
+        for line in self.process.stdout:
+            self.lines.append(line)
+
+    def wait_for_socket(self, timeout):
+        deadline = time.monotonic() + timeout
+        while not os.path.exists(self.socket):
+            if self.process.poll() is not None or time.monotonic() > deadline:
+                sys.exit("Server failed to start:\n" + "".join(self.lines))
+            time.sleep(0.05)
+
+    def sample(self):
+        """The first complete memory report after now, as {"subsystem/kind": {objects, bytes}}"""
+        start = len(self.lines)
+        deadline = time.monotonic() + 3 * self.interval + 5
+        while time.monotonic() < deadline:
+            summaries = [i for i in range(start, len(self.lines)) if SUMMARY.search(self.lines[i])]
+            # A report is complete once the next has begun
+            if len(summaries) >= 2:
+                first, second = summaries[0], summaries[1]
+                summary = SUMMARY.search(self.lines[first])
+                accounts = {}
+                for line in self.lines[first + 1:second]:
+                    match = ACCOUNT.search(line)
+                    if match:
+                        accounts[match.group("subsystem") + "/" + match.group("kind")] = {
+                            "objects": int(match.group("objects")),
+                            "bytes": int(match.group("bytes")),
+                        }
+                return {
+                    "clients": int(summary.group("clients")),
+                    "accounted": int(summary.group("accounted")),
+                    "accounts": accounts,
+                }
+            if self.process.poll() is not None:
+                break
+            time.sleep(0.1)
+        sys.exit("No memory report from the server (is --memory-report supported?):\n" + "".join(self.lines[-50:]))
+
+    def stop(self):
+        self.process.terminate()
+        self.process.wait(timeout=10)
+        self.reader.join(timeout=1)
+
+
+def start_client(executable, socket_name, buffers, args):
+    env = os.environ.copy()
+    env["WAYLAND_DISPLAY"] = socket_name
+    cmdline = [executable, "--buffers", buffers, "--size", args.size, "--rate", str(args.rate)]
+    return subprocess.Popen(cmdline, env=env, stdout=subprocess.DEVNULL)
+
+
+def stop_client(client):
+    client.send_signal(signal.SIGTERM)
+    try:
+        client.wait(timeout=10)
+    except subprocess.TimeoutExpired:
+        client.kill()
+
+
+def run(args):
+    client_executable = args.client or os.path.join(os.path.dirname(args.server), "mir_load_client")
+    socket_name = "mir_memory_%d" % os.getpid()
+    steps = sorted(int(step) for step in args.steps.split(","))
+
+    server = Server(args.server, args.server_option or ["--offscreen"], socket_name, args.interval)
+    server.wait_for_socket(10)
+    time.sleep(args.settle)
+
+    clients = []
+    samples = []
+    for step in steps:
+        while len(clients) < step:
+            buffers = args.buffers if args.buffers != "mixed" else ("shm", "dmabuf")[len(clients) % 2]
+            clients.append(start_client(client_executable, socket_name, buffers, args))
+        time.sleep(args.settle)
+
+        running = sum(1 for client in clients if client.poll() is None)
+        if running < len(clients):
+            print("%d of %d clients failed" % (len(clients) - running, len(clients)), file=sys.stderr)
+
+        sample = server.sample()
+        sample["step"] = step
+        sample["rss"] = rss_bytes(server.process.pid)
+        samples.append(sample)
+
+    for client in clients:
+        stop_client(client)
+    time.sleep(args.settle)
+    after = server.sample()
+    after["rss"] = rss_bytes(server.process.pid)
+    server.stop()
+
+    # Fitted against the clients the server saw, so clients that failed to connect don't skew the cost
+    names = sorted(set(name for sample in samples + [after] for name in sample["accounts"]))
+
+    def value(sample, name, field):
+        return sample["accounts"].get(name, {}).get(field, 0)
+
+    baseline = samples[0]
+    accounts = {}
+    for name in names:
+        accounts[name] = {
+            "objects": {str(s["step"]): value(s, name, "objects") for s in samples},
+            "bytes": {str(s["step"]): value(s, name, "bytes") for s in samples},
+            "objects_per_client": slope([(s["clients"], value(s, name, "objects")) for s in samples]),
+            "bytes_per_client": slope([(s["clients"], value(s, name, "bytes")) for s in samples]),
+            "residual_objects": value(after, name, "objects") - value(baseline, name, "objects"),
+            "residual_bytes": value(after, name, "bytes") - value(baseline, name, "bytes"),
+        }
+
+    return {
+        "label": args.label,
+        "config": {
+            "steps": steps,
+            "buffers": args.buffers,
+            "size": args.size,
+            "rate": args.rate,
+            "server_options": args.server_option or ["--offscreen"],
+        },
+        "clients": {str(s["step"]): s["clients"] for s in samples},
+        "process": {
+            "rss_bytes": {str(s["step"]): s["rss"] for s in samples},
+            "rss_bytes_per_client": slope([(s["clients"], s["rss"]) for s in samples]),
+            "accounted_bytes_per_client": slope([(s["clients"], s["accounted"]) for s in samples]),
+            "unaccounted_bytes_per_client": slope([(s["clients"], s["rss"] - s["accounted"]) for s in samples]),
+            "residual_rss_bytes": after["rss"] - baseline["rss"],
+        },
+        "accounts": accounts,
+    }
+
+
+def flatten(results, prefix=""):
+    for key, value in results.items():
+        if isinstance(value, dict):
+            yield from flatten(value, prefix + key + ".")
+        elif isinstance(value, (int, float)) and not isinstance(value, bool):
+            yield prefix + key, value
+
+
+def compare(args):
+    with open(args.before) as before_file, open(args.after) as after_file:
+        before = dict(flatten(json.load(before_file)))
+        after = dict(flatten(json.load(after_file)))
+
+    width = max(len(key) for key in before)
+    print("%-*s %14s %14s %9s" % (width, "metric", "before", "after", "change"))
+    for key, old in before.items():
+        if key not in after:
+            continue
+        new = after[key]
+        change = "%+8.1f%%" % (100 * (new - old) / old) if old else ""
+        print("%-*s %14.1f %14.1f %9s" % (width, key, old, new, change))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    run_parser = commands.add_parser("run", help="Measure a configuration")
+    run_parser.add_argument("--server", default=shutil.which("mir_demo_server"))
+    run_parser.add_argument("--server-option", action="append",
+                            help="Pass an option to the server (default: --offscreen)")
+    run_parser.add_argument("--client", help="The load client (default: mir_load_client beside the server)")
+    run_parser.add_argument("--steps", default="0,10,50,100",
+                            help="Comma-separated numbers of clients to sample at; the first is the baseline")
+    run_parser.add_argument("--buffers", choices=["shm", "dmabuf", "mixed"], default="mixed")
+    run_parser.add_argument("--size", default="640x480", help="Each window's size, as WIDTHxHEIGHT")
+    run_parser.add_argument("--rate", type=float, default=10, help="Commits per second by each client")
+    run_parser.add_argument("--interval", type=int, default=1, help="Seconds between the server's memory reports")
+    run_parser.add_argument("--settle", type=float, default=3,
+                            help="Seconds to let the server settle after clients come or go")
+    run_parser.add_argument("--label", default="")
+    run_parser.add_argument("--output", help="Write the results to a file, rather than stdout")
+
+    compare_parser = commands.add_parser("compare", help="Compare the results of two runs")
+    compare_parser.add_argument("before")
+    compare_parser.add_argument("after")
+
+    args = parser.parse_args()
+
+    if args.command == "compare":
+        compare(args)
+        return
+
+    if not args.server:
+        sys.exit("No mir_demo_server found; use --server")
+
+    results = json.dumps(run(args), indent=2)
+    if args.output:
+        with open(args.output, "w") as output:
+            output.write(results + "\n")
+    else:
+        print(results)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,78 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_BENCHMARKS_CASCADED_SCENE_H_
+#define MIR_BENCHMARKS_CASCADED_SCENE_H_
+
+#include "src/server/scene/surface_stack.h"
+#include "src/server/scene/basic_surface.h"
+#include "src/server/report/null_report_factory.h"
+#include "mir/input/input_reception_mode.h"
+#include "mir/geometry/rectangle.h"
+
+#include "mir/test/doubles/stub_buffer_stream.h"
+
+#include <memory>
+#include <vector>
+
+namespace mir
+{
+namespace benchmarks
+{
+/**
+ * A SurfaceStack of \a count real surfaces, cascaded down an output the way a
+ * busy desktop's windows are: each overlaps most of the one below it.
+ */
+struct CascadedScene
+{
+    static constexpr int const step = 24;
+
+    CascadedScene(int count, geometry::Rectangle const& output) :
+        output{output}
+    {
+        geometry::Size const size{output.size.width.as_int() / 2, output.size.height.as_int() / 2};
+        auto const positions_x = (output.size.width.as_int() - size.width.as_int()) / step;
+        auto const positions_y = (output.size.height.as_int() - size.height.as_int()) / step;
+
+        for (int i = 0; i != count; ++i)
+        {
+            geometry::Point const top_left{
+                output.top_left.x.as_int() + step * (i % positions_x),
+                output.top_left.y.as_int() + step * (i % positions_y)};
+
+            auto const surface = std::make_shared<scene::BasicSurface>(
+                nullptr /* session */,
+                "benchmark",
+                geometry::Rectangle{top_left, size},
+                mir_pointer_unconfined,
+                std::list<scene::StreamInfo>{{std::make_shared<test::doubles::StubBufferStream>(), {}, {}}},
+                std::shared_ptr<graphics::CursorImage>(),
+                report);
+
+            stack.add_surface(surface, input::InputReceptionMode::normal);
+            surfaces.push_back(surface);
+        }
+    }
+
+    geometry::Rectangle const output;
+    std::shared_ptr<scene::SceneReport> const report = report::null_scene_report();
+    scene::SurfaceStack stack{report};
+    std::vector<std::shared_ptr<scene::BasicSurface>> surfaces;
+};
+}
+}
+
+#endif /* MIR_BENCHMARKS_CASCADED_SCENE_H_ */
@@ -0,0 +1,112 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/events/event_builders.h"
+#include "mir/events/event_private.h"
+#include "mir/events/contact_state.h"
+
+#include <benchmark/benchmark.h>
+
+#include <linux/input.h>
+#include <vector>
+
+namespace mev = mir::events;
+
+namespace
+{
+MirInputDeviceId const device_id{1};
+
+/// The size of a real input cookie, so that copying one costs what it does in the server
+std::vector<uint8_t> const cookie(41, 0xc0);
+
+void make_key_event(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        auto event = mev::make_event(
+            device_id, std::chrono::nanoseconds{0}, cookie,
+            mir_keyboard_action_down, 0, KEY_A, mir_input_event_modifier_none);
+        benchmark::DoNotOptimize(event.get());
+    }
+}
+
+void make_pointer_event(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        auto event = mev::make_event(
+            device_id, std::chrono::nanoseconds{0}, cookie,
+            mir_input_event_modifier_none, mir_pointer_action_button_down, mir_pointer_button_primary,
+            100, 200, 0, 0, 0, 0);
+        benchmark::DoNotOptimize(event.get());
+    }
+}
+
+void make_touch_event(benchmark::State& state)
+{
+    std::vector<mev::ContactState> contacts;
+    for (auto i = 0; i != state.range(0); ++i)
+    {
+        contacts.push_back({i, mir_touch_action_change, mir_touch_tooltype_finger,
+                            100.0f * i, 200.0f, 1.0f, 5.0f, 5.0f, 5.0f});
+    }
+
+    for (auto _ : state)
+    {
+        auto event = mev::make_event(device_id, std::chrono::nanoseconds{0}, cookie,
+            mir_input_event_modifier_none, contacts);
+        benchmark::DoNotOptimize(event.get());
+    }
+}
+
+void clone_pointer_event(benchmark::State& state)
+{
+    auto const original = mev::make_event(
+        device_id, std::chrono::nanoseconds{0}, cookie,
+        mir_input_event_modifier_none, mir_pointer_action_motion, 0,
+        100, 200, 0, 0, 3, 4);
+
+    for (auto _ : state)
+    {
+        auto copy = mev::clone_event(*original);
+        benchmark::DoNotOptimize(copy.get());
+    }
+}
+
+void clone_touch_event(benchmark::State& state)
+{
+    std::vector<mev::ContactState> contacts;
+    for (auto i = 0; i != state.range(0); ++i)
+    {
+        contacts.push_back({i, mir_touch_action_change, mir_touch_tooltype_finger,
+                            100.0f * i, 200.0f, 1.0f, 5.0f, 5.0f, 5.0f});
+    }
+    auto const original = mev::make_event(device_id, std::chrono::nanoseconds{0}, cookie,
+        mir_input_event_modifier_none, contacts);
+
+    for (auto _ : state)
+    {
+        auto copy = mev::clone_event(*original);
+        benchmark::DoNotOptimize(copy.get());
+    }
+}
+}
+
+BENCHMARK(make_key_event);
+BENCHMARK(make_pointer_event);
+BENCHMARK(make_touch_event)->DenseRange(1, 10, 3);
+BENCHMARK(clone_pointer_event);
+BENCHMARK(clone_touch_event)->DenseRange(1, 10, 3);
@@ -0,0 +1,249 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/renderers/gl/renderer.h"
+
+#include "mir/graphics/buffer_basic.h"
+#include "mir/graphics/display_buffer.h"
+#include "mir/graphics/program_factory.h"
+#include "mir/graphics/solid_color_buffer.h"
+#include "mir/graphics/texture.h"
+#include "mir/renderer/gl/render_target.h"
+
+#include "mir/test/doubles/stub_renderable.h"
+
+#include <benchmark/benchmark.h>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GLES2/gl2.h>
+
+#include <functional>
+#include <memory>
+#include <stdexcept>
+
+namespace mg = mir::graphics;
+namespace mrg = mir::renderer::gl;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+
+namespace
+{
+geom::Rectangle const output{{0, 0}, {1920, 1080}};
+geom::Size const window_size{960, 540};
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+/// A GLES2 context with no window system, rendering into a texture-backed framebuffer
+class OffscreenDisplayBuffer : public mg::DisplayBuffer, public mg::NativeDisplayBuffer, public mrg::RenderTarget
+{
+public:
+    OffscreenDisplayBuffer() :
+        display{surfaceless_display()}
+    {
+        if (!eglInitialize(display, nullptr, nullptr))
+            throw std::runtime_error{"Failed to initialise EGL"};
+
+        EGLint const config_attribs[] = {
+            EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT,
+            EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+            EGL_NONE};
+        EGLConfig config;
+        EGLint configs{0};
+        if (!eglChooseConfig(display, config_attribs, &config, 1, &configs) || configs != 1)
+            throw std::runtime_error{"No EGL config for offscreen GLES2 rendering"};
+
+        eglBindAPI(EGL_OPENGL_ES_API);
+        EGLint const context_attribs[] = {EGL_CONTEXT_CLIENT_VERSION, 2, EGL_NONE};
+        context = eglCreateContext(display, config, EGL_NO_CONTEXT, context_attribs);
+        if (context == EGL_NO_CONTEXT)
+            throw std::runtime_error{"Failed to create a GLES2 context"};
+
+        make_current();
+        glGenTextures(1, &colour);
+        glBindTexture(GL_TEXTURE_2D, colour);
+        glTexImage2D(
+            GL_TEXTURE_2D, 0, GL_RGBA, output.size.width.as_int(), output.size.height.as_int(), 0,
+            GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colour, 0);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            throw std::runtime_error{"Offscreen framebuffer is incomplete"};
+    }
+
+    ~OffscreenDisplayBuffer()
+    {
+        make_current();
+        glDeleteFramebuffers(1, &framebuffer);
+        glDeleteTextures(1, &colour);
+        release_current();
+        eglDestroyContext(display, context);
+        eglTerminate(display);
+    }
+
+    auto view_area() const -> geom::Rectangle override { return output; }
+    bool overlay(mg::RenderableList&) override { return false; }
+    auto transformation() const -> glm::mat2 override { return glm::mat2{1}; }
+    auto native_display_buffer() -> mg::NativeDisplayBuffer* override { return this; }
+
+    void make_current() override
+    {
+        if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+            throw std::runtime_error{"Failed to make the offscreen context current"};
+    }
+
+    void release_current() override
+    {
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    }
+
+    /// Waits for the frame to complete, so that a run measures whole frames rather than queueing them
+    void swap_buffers() override { glFinish(); }
+    void swap_buffers_with_damage(geom::Rectangles const&) override { glFinish(); }
+
+    void bind() override { glBindFramebuffer(GL_FRAMEBUFFER, framebuffer); }
+
+private:
+    static auto surfaceless_display() -> EGLDisplay
+    {
+        auto const get_platform_display = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+            eglGetProcAddress("eglGetPlatformDisplayEXT"));
+
+        if (get_platform_display)
+        {
+            auto const display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+            if (display != EGL_NO_DISPLAY)
+                return display;
+        }
+
+        return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    EGLDisplay const display;
+    EGLContext context;
+    GLuint colour{0};
+    GLuint framebuffer{0};
+};
+
+struct SolidColorBuffer : mg::BufferBasic, mg::SolidColorBuffer
+{
+    auto native_buffer_handle() const -> std::shared_ptr<mg::NativeBuffer> override { return nullptr; }
+    auto size() const -> geom::Size override { return {1, 1}; }
+    auto pixel_format() const -> MirPixelFormat override { return mir_pixel_format_argb_8888; }
+    auto native_buffer_base() -> mg::NativeBufferBase* override { return this; }
+    auto color() const -> std::array<float, 4> override { return {0.25f, 0.5f, 0.75f, 1.0f}; }
+};
+
+/// A window-sized texture, drawn the way a client's shm buffer is
+class TextureBuffer : public mg::BufferBasic, public mg::NativeBufferBase, public mg::gl::Texture
+{
+public:
+    explicit TextureBuffer(geom::Size const& size) :
+        size_{size}
+    {
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(
+            GL_TEXTURE_2D, 0, GL_RGBA, size.width.as_int(), size.height.as_int(), 0,
+            GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    }
+
+    ~TextureBuffer()
+    {
+        glDeleteTextures(1, &texture);
+    }
+
+    auto native_buffer_handle() const -> std::shared_ptr<mg::NativeBuffer> override { return nullptr; }
+    auto size() const -> geom::Size override { return size_; }
+    auto pixel_format() const -> MirPixelFormat override { return mir_pixel_format_abgr_8888; }
+    auto native_buffer_base() -> mg::NativeBufferBase* override { return this; }
+
+    auto shader(mg::gl::ProgramFactory& factory) const -> mg::gl::Program const& override
+    {
+        static int rgba_shader{0};
+        return factory.compile_fragment_shader(
+            &rgba_shader,
+            "",
+            "uniform sampler2D tex;\n"
+            "vec4 sample_to_rgba(in vec2 texcoord)\n"
+            "{\n"
+            "    return texture2D(tex, texcoord);\n"
+            "}\n");
+    }
+
+    auto layout() const -> Layout override { return Layout::GL; }
+    void bind() override { glBindTexture(GL_TEXTURE_2D, texture); }
+    void add_syncpoint() override {}
+
+private:
+    geom::Size const size_;
+    GLuint texture{0};
+};
+
+/// Windows cascaded as in CascadedScene, all showing one buffer
+void render_windows(benchmark::State& state, std::function<std::shared_ptr<mg::Buffer>()> const& make_buffer)
+{
+    std::unique_ptr<OffscreenDisplayBuffer> display_buffer;
+    try
+    {
+        display_buffer = std::make_unique<OffscreenDisplayBuffer>();
+    }
+    catch (std::exception const& error)
+    {
+        state.SkipWithError(error.what());
+        return;
+    }
+
+    // Declared before the buffer, so that it keeps the context current while that's destroyed
+    mrg::Renderer renderer{*display_buffer};
+    renderer.set_viewport(output);
+
+    auto const buffer = make_buffer();
+    mg::RenderableList renderables;
+    for (auto i = 0; i != state.range(0); ++i)
+    {
+        geom::Point const top_left{24 * (i % 40), 24 * (i % 22)};
+        renderables.push_back(std::make_shared<mtd::StubRenderable>(buffer, geom::Rectangle{top_left, window_size}));
+    }
+
+    for (auto _ : state)
+    {
+        renderer.render(renderables);
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void render_solid_colour_windows(benchmark::State& state)
+{
+    render_windows(state, [] { return std::make_shared<SolidColorBuffer>(); });
+}
+
+void render_textured_windows(benchmark::State& state)
+{
+    render_windows(state, [] { return std::make_shared<TextureBuffer>(window_size); });
+}
+}
+
+BENCHMARK(render_solid_colour_windows)->RangeMultiplier(4)->Range(1, 256)->Unit(benchmark::kMicrosecond);
+BENCHMARK(render_textured_windows)->RangeMultiplier(4)->Range(1, 256)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,105 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cascaded_scene.h"
+
+#include "src/server/input/surface_input_dispatcher.h"
+#include "mir/events/event_builders.h"
+#include "mir/events/event_private.h"
+
+#include "mir/test/fake_shared.h"
+
+#include <benchmark/benchmark.h>
+
+#include <linux/input.h>
+#include <vector>
+
+namespace mev = mir::events;
+namespace mi = mir::input;
+namespace geom = mir::geometry;
+
+namespace
+{
+geom::Rectangle const output{{0, 0}, {1920, 1080}};
+MirInputDeviceId const device_id{1};
+
+/// Motion sweeping back and forth across the output, entering and leaving surfaces as it goes
+auto pointer_sweep() -> std::vector<std::shared_ptr<MirEvent const>>
+{
+    std::vector<std::shared_ptr<MirEvent const>> events;
+
+    for (int x = 0; x < output.size.width.as_int(); x += 7)
+    {
+        auto const y = (x * output.size.height.as_int()) / output.size.width.as_int();
+        events.push_back(mev::make_event(
+            device_id, std::chrono::nanoseconds{x}, std::vector<uint8_t>{},
+            mir_input_event_modifier_none, mir_pointer_action_motion, 0,
+            x, y, 0, 0, 7, 7));
+    }
+
+    return events;
+}
+
+void dispatch_pointer_motion(benchmark::State& state)
+{
+    mir::benchmarks::CascadedScene scene{static_cast<int>(state.range(0)), output};
+    mi::SurfaceInputDispatcher dispatcher{mir::test::fake_shared(scene.stack)};
+    dispatcher.start();
+
+    auto const events = pointer_sweep();
+    auto next = events.begin();
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(dispatcher.dispatch(*next));
+
+        if (++next == events.end())
+            next = events.begin();
+    }
+
+    dispatcher.stop();
+    state.SetItemsProcessed(state.iterations());
+}
+
+void dispatch_key(benchmark::State& state)
+{
+    mir::benchmarks::CascadedScene scene{static_cast<int>(state.range(0)), output};
+    mi::SurfaceInputDispatcher dispatcher{mir::test::fake_shared(scene.stack)};
+    dispatcher.start();
+    dispatcher.set_focus(scene.surfaces.back());
+
+    std::shared_ptr<MirEvent const> const events[] = {
+        mev::make_event(
+            device_id, std::chrono::nanoseconds{0}, std::vector<uint8_t>{},
+            mir_keyboard_action_down, 0, KEY_A, mir_input_event_modifier_none),
+        mev::make_event(
+            device_id, std::chrono::nanoseconds{0}, std::vector<uint8_t>{},
+            mir_keyboard_action_up, 0, KEY_A, mir_input_event_modifier_none)};
+    size_t next{0};
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(dispatcher.dispatch(events[next]));
+        next ^= 1;
+    }
+
+    dispatcher.stop();
+    state.SetItemsProcessed(state.iterations());
+}
+}
+
+BENCHMARK(dispatch_pointer_motion)->RangeMultiplier(4)->Range(1, 1024);
+BENCHMARK(dispatch_key)->RangeMultiplier(4)->Range(1, 1024);
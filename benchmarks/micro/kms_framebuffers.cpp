@@ -0,0 +1,161 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "kms/real_kms_output.h"
+#include "kms-utils/drm_mode_resources.h"
+#include "mir/fd.h"
+
+#include <benchmark/benchmark.h>
+
+#include <gbm.h>
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+#include <fcntl.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mg = mir::graphics;
+namespace mgg = mir::graphics::gbm;
+namespace mgk = mir::graphics::kms;
+
+namespace
+{
+/**
+ * The first KMS device with a connector, opened without becoming DRM master
+ *
+ * That's enough to create framebuffers, which is all RealKMSOutput::fb_for() does.
+ */
+struct KMSDevice
+{
+    KMSDevice()
+    {
+        for (auto i = 0; i != 8 && !output; ++i)
+        {
+            auto const node = "/dev/dri/card" + std::to_string(i);
+            mir::Fd candidate{open(node.c_str(), O_RDWR | O_CLOEXEC)};
+            if (candidate < 0)
+                continue;
+
+            try
+            {
+                mgk::DRMModeResources const resources{candidate};
+                for (auto& connector : resources.connectors())
+                {
+                    fd = candidate;
+                    output = std::make_unique<mgg::RealKMSOutput>(fd, std::move(connector), nullptr);
+                    break;
+                }
+            }
+            catch (std::exception const&)
+            {
+                // Not a KMS device; try the next
+            }
+        }
+
+        if (output)
+            device = gbm_create_device(fd);
+    }
+
+    ~KMSDevice()
+    {
+        output.reset();
+        if (device)
+            gbm_device_destroy(device);
+    }
+
+    auto create_bo() -> gbm_bo*
+    {
+        return gbm_bo_create(device, 1920, 1080, GBM_FORMAT_XRGB8888, GBM_BO_USE_SCANOUT | GBM_BO_USE_RENDERING);
+    }
+
+    mir::Fd fd;
+    std::unique_ptr<mgg::RealKMSOutput> output;
+    gbm_device* device{nullptr};
+};
+
+/// Looking up the framebuffers of a swapchain of \a range(0) buffers, each already seen
+void fb_for_known_buffer(benchmark::State& state)
+{
+    KMSDevice kms;
+    if (!kms.device)
+    {
+        state.SkipWithError("No KMS device");
+        return;
+    }
+
+    std::vector<gbm_bo*> bos;
+    for (auto i = 0; i != state.range(0); ++i)
+    {
+        if (auto const bo = kms.create_bo())
+        {
+            bos.push_back(bo);
+            kms.output->fb_for(bo);
+        }
+    }
+
+    if (bos.empty())
+    {
+        state.SkipWithError("Failed to allocate scanout buffers");
+        return;
+    }
+
+    auto next = bos.begin();
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(kms.output->fb_for(*next));
+
+        if (++next == bos.end())
+            next = bos.begin();
+    }
+
+    for (auto const bo : bos)
+        gbm_bo_destroy(bo);
+}
+
+/// Creating the framebuffer for a buffer seen for the first time
+void fb_for_new_buffer(benchmark::State& state)
+{
+    KMSDevice kms;
+    if (!kms.device)
+    {
+        state.SkipWithError("No KMS device");
+        return;
+    }
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto const bo = kms.create_bo();
+        if (!bo)
+        {
+            state.SkipWithError("Failed to allocate a scanout buffer");
+            break;
+        }
+        state.ResumeTiming();
+
+        benchmark::DoNotOptimize(kms.output->fb_for(bo));
+
+        state.PauseTiming();
+        gbm_bo_destroy(bo);
+        state.ResumeTiming();
+    }
+}
+}
+
+BENCHMARK(fb_for_known_buffer)->Arg(2)->Arg(3)->Arg(4);
+BENCHMARK(fb_for_new_buffer)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,69 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cascaded_scene.h"
+
+#include "src/server/compositor/occlusion.h"
+#include "mir/compositor/scene_element.h"
+
+#include <benchmark/benchmark.h>
+
+namespace mc = mir::compositor;
+namespace geom = mir::geometry;
+
+namespace
+{
+geom::Rectangle const output{{0, 0}, {1920, 1080}};
+
+void scene_elements_for(benchmark::State& state)
+{
+    mir::benchmarks::CascadedScene scene{static_cast<int>(state.range(0)), output};
+    int const compositor_id{0};
+    scene.stack.register_compositor(&compositor_id);
+
+    for (auto _ : state)
+    {
+        auto elements = scene.stack.scene_elements_for(&compositor_id);
+        benchmark::DoNotOptimize(elements.data());
+    }
+
+    scene.stack.unregister_compositor(&compositor_id);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void filter_occlusions_from(benchmark::State& state)
+{
+    mir::benchmarks::CascadedScene scene{static_cast<int>(state.range(0)), output};
+    int const compositor_id{0};
+    auto const elements = scene.stack.scene_elements_for(&compositor_id);
+
+    for (auto _ : state)
+    {
+        // Filtering removes the occluded elements, so each frame starts from a fresh list
+        state.PauseTiming();
+        auto visible = elements;
+        state.ResumeTiming();
+
+        auto occluded = mc::filter_occlusions_from(visible, output);
+        benchmark::DoNotOptimize(occluded.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+}
+
+BENCHMARK(scene_elements_for)->RangeMultiplier(4)->Range(1, 1024);
+BENCHMARK(filter_occlusions_from)->RangeMultiplier(4)->Range(1, 1024);
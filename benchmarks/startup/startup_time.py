@@ -0,0 +1,206 @@
+#!/usr/bin/python3
+
+"""Server startup time, phase by phase.
+
+Starts a Mir server repeatedly with --startup-report=log, and records how long
+after the process started each phase of startup completed: the graphics
+platform probed, the display configured, the renderer created, the Wayland
+(and X11) sockets ready, everything started, the first frame composited and,
+given an X11 client to run, Xwayland running.
+
+  startup_time.py run --server bin/mir_demo_server --runs 20 --output before.json
+  startup_time.py compare before.json after.json
+"""
+
+import argparse
+import json
+import os
+import re
+import shutil
+import statistics
+import subprocess
+import sys
+import threading
+import time
+
+PHASE = re.compile(r"Startup: (?P<phase>\w+) after (?P<ms>[\d.]+) ms")
+
+# The last phases, once the server has reached which a run is complete
+FINAL_PHASES = {"started", "first_frame"}
+
+
+def percentile(samples, fraction):
+    if not samples:
+        return 0.0
+    ordered = sorted(samples)
+    return ordered[min(len(ordered) - 1, int(fraction * len(ordered)))]
+
+
+def drop_caches():
+    """Evicts the page cache, so the next start loads its libraries, shaders and themes from disk"""
+    subprocess.run(["sync"], check=True)
+    with open("/proc/sys/vm/drop_caches", "w") as caches:
+        caches.write("3\n")
+
+
+class Server:
+    def __init__(self, executable, options, socket_name):
+        env = os.environ.copy()
+        env["WAYLAND_DISPLAY"] = socket_name
+        self.process = subprocess.Popen(
+            [executable, "--startup-report=log"] + options,
+            env=env, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+        self.lines = []
+        self.phases = {}
+        self.changed = threading.Condition()
+        self.reader = threading.Thread(target=self._read, daemon=True)
+        self.reader.start()
+
+    def _read(self):
+        for line in self.process.stdout:
+            with self.changed:
+                self.lines.append(line)
+                match = PHASE.search(line)
+                if match:
+                    self.phases[match.group("phase")] = float(match.group("ms"))
+                self.changed.notify_all()
+
+    def wait_for(self, phases, timeout):
+        deadline = time.monotonic() + timeout
+        with self.changed:
+            while not phases <= self.phases.keys():
+                remaining = deadline - time.monotonic()
+                if self.process.poll() is not None or remaining <= 0:
+                    return False
+                self.changed.wait(min(remaining, 0.1))
+        return True
+
+    def stop(self):
+        self.process.terminate()
+        self.process.wait(timeout=10)
+        self.reader.join(timeout=1)
+
+
+def run_once(args, run):
+    socket_name = "mir_startup_%d_%d" % (os.getpid(), run)
+    if args.drop_caches:
+        drop_caches()
+
+    server = Server(args.server, args.server_option or [], socket_name)
+    expected = set(FINAL_PHASES)
+    try:
+        if not server.wait_for(expected, args.timeout):
+            sys.exit("Server didn't finish starting (reached %s):\n%s" % (sorted(server.phases), "".join(server.lines)))
+
+        if args.x11_client:
+            # Xwayland is spawned for the first X11 client
+            expected.add("xwayland_running")
+            env = os.environ.copy()
+            env["DISPLAY"] = x11_display(server.lines)
+            client = subprocess.Popen(args.x11_client, shell=True, env=env,
+                                      stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+            server.wait_for(expected, args.timeout)
+            client.kill()
+            client.wait()
+    finally:
+        server.stop()
+
+    return dict(server.phases)
+
+
+def x11_display(lines):
+    for line in lines:
+        match = re.search(r"XWayland started on X11 display (\S+)", line)
+        if match:
+            return match.group(1)
+    sys.exit("--x11-client needs a server started with --enable-x11")
+
+
+def run(args):
+    runs = [run_once(args, i) for i in range(args.runs)]
+
+    phases = {}
+    for phase in runs[0]:
+        times = [r[phase] for r in runs if phase in r]
+        phases[phase] = {
+            "mean": statistics.mean(times),
+            "p50": percentile(times, 0.5),
+            "p95": percentile(times, 0.95),
+            "max": max(times),
+        }
+
+    return {
+        "label": args.label,
+        "config": {
+            "runs": args.runs,
+            "drop_caches": args.drop_caches,
+            "x11_client": args.x11_client,
+            "server_options": args.server_option or [],
+        },
+        # In order of completion, as ms after the process started
+        "phases_ms": dict(sorted(phases.items(), key=lambda item: item[1]["p50"])),
+    }
+
+
+def flatten(results, prefix=""):
+    for key, value in results.items():
+        if isinstance(value, dict):
+            yield from flatten(value, prefix + key + ".")
+        elif isinstance(value, (int, float)) and not isinstance(value, bool):
+            yield prefix + key, value
+
+
+def compare(args):
+    with open(args.before) as before_file, open(args.after) as after_file:
+        before = dict(flatten(json.load(before_file)))
+        after = dict(flatten(json.load(after_file)))
+
+    width = max(len(key) for key in before)
+    print("%-*s %12s %12s %9s" % (width, "metric", "before", "after", "change"))
+    for key, old in before.items():
+        if key not in after:
+            continue
+        new = after[key]
+        change = "%+8.1f%%" % (100 * (new - old) / old) if old else ""
+        print("%-*s %12.3f %12.3f %9s" % (width, key, old, new, change))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    run_parser = commands.add_parser("run", help="Measure the startup of a server")
+    run_parser.add_argument("--server", default=shutil.which("mir_demo_server"))
+    run_parser.add_argument("--server-option", action="append", help="Pass an option to the server")
+    run_parser.add_argument("--runs", type=int, default=10)
+    run_parser.add_argument("--drop-caches", action="store_true",
+                            help="Drop the page cache before each run, to approximate a cold boot (needs root)")
+    run_parser.add_argument("--x11-client",
+                            help="An X11 client to start, to time Xwayland (needs --server-option=--enable-x11)")
+    run_parser.add_argument("--timeout", type=float, default=30, help="Seconds to wait for each run to start")
+    run_parser.add_argument("--label", default="")
+    run_parser.add_argument("--output", help="Write the results to a file, rather than stdout")
+
+    compare_parser = commands.add_parser("compare", help="Compare the results of two runs")
+    compare_parser.add_argument("before")
+    compare_parser.add_argument("after")
+
+    args = parser.parse_args()
+
+    if args.command == "compare":
+        compare(args)
+        return
+
+    if not args.server:
+        sys.exit("No mir_demo_server found; use --server")
+
+    results = json.dumps(run(args), indent=2)
+    if args.output:
+        with open(args.output, "w") as output:
+            output.write(results + "\n")
+    else:
+        print(results)
+
+
+if __name__ == "__main__":
+    main()
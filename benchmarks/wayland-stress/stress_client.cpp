@@ -0,0 +1,747 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * A Wayland client that stresses the compositor's protocol handling, for wayland_stress.py
+ *
+ * It maps a window, then repeats one scenario's requests at a fixed rate (or as fast as the
+ * compositor keeps up), ending each iteration with a wl_display.sync, until it receives
+ * SIGTERM or SIGINT. Then it prints what it saw as a line of JSON:
+ *
+ *   iterations    iterations run
+ *   missed        ticks at which the previous iteration's sync hadn't come back, so nothing was sent
+ *   roundtrip_us  the time from sending an iteration to its sync coming back (p50, p99 and max)
+ *   configure_us  for the configure scenario, the time from asking for a state to its configure arriving
+ *   motion_events for the pointer scenario, the pointer motion events received
+ *
+ * The scenarios:
+ *
+ *   surfaces     create a toplevel, map it once configured, and destroy the previous one
+ *   commits      commit the window with --damage damage rectangles
+ *   subsurfaces  move one of --subsurfaces subsurfaces above or below another, and commit the parent
+ *   data-device  offer a new selection, replacing the last
+ *   configure    toggle the window's maximized state, acking each configure with a new buffer
+ *   pointer      nothing but the sync, while something else (wayland_stress.py) floods pointer motion
+ */
+
+#include "xdg-shell-client-protocol.h"
+
+#include <wayland-client.h>
+
+#include <poll.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+auto now_ns() -> int64_t
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+enum class Scenario
+{
+    surfaces,
+    commits,
+    subsurfaces,
+    data_device,
+    configure,
+    pointer
+};
+
+struct ScenarioName
+{
+    Scenario scenario;
+    char const* name;
+};
+
+ScenarioName const scenario_names[] = {
+    {Scenario::surfaces, "surfaces"},
+    {Scenario::commits, "commits"},
+    {Scenario::subsurfaces, "subsurfaces"},
+    {Scenario::data_device, "data-device"},
+    {Scenario::configure, "configure"},
+    {Scenario::pointer, "pointer"}};
+
+struct Options
+{
+    Scenario scenario{Scenario::commits};
+    double rate{0};             ///< Iterations per second; 0 to start each as soon as the last one's sync returns
+    int width{320};
+    int height{240};
+    int damage{16};             ///< Damage rectangles per commit, for the commits scenario
+    int subsurfaces{8};         ///< For the subsurfaces scenario
+};
+
+auto name_of(Scenario scenario) -> char const*
+{
+    for (auto const& s : scenario_names)
+    {
+        if (s.scenario == scenario)
+            return s.name;
+    }
+    return "unknown";
+}
+
+auto parse(int argc, char* argv[]) -> Options
+{
+    Options options;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string const arg{argv[i]};
+        auto const value = [&]() -> char const*
+            {
+                if (++i == argc)
+                    throw std::runtime_error{"Missing value for " + arg};
+                return argv[i];
+            };
+
+        if (arg == "--scenario")
+        {
+            std::string const name{value()};
+            auto const s = std::find_if(
+                std::begin(scenario_names), std::end(scenario_names),
+                [&](auto const& s) { return name == s.name; });
+            if (s == std::end(scenario_names))
+                throw std::runtime_error{"Unknown scenario " + name};
+            options.scenario = s->scenario;
+        }
+        else if (arg == "--rate")
+        {
+            options.rate = strtod(value(), nullptr);
+        }
+        else if (arg == "--size")
+        {
+            if (sscanf(value(), "%dx%d", &options.width, &options.height) != 2 ||
+                options.width <= 0 || options.height <= 0)
+                throw std::runtime_error{"--size must be WIDTHxHEIGHT"};
+        }
+        else if (arg == "--damage")
+        {
+            options.damage = std::max(1, atoi(value()));
+        }
+        else if (arg == "--subsurfaces")
+        {
+            options.subsurfaces = std::max(2, atoi(value()));
+        }
+        else
+        {
+            throw std::runtime_error{"Unknown option " + arg};
+        }
+    }
+
+    return options;
+}
+
+struct Globals
+{
+    wl_compositor* compositor{nullptr};
+    wl_subcompositor* subcompositor{nullptr};
+    wl_shm* shm{nullptr};
+    wl_seat* seat{nullptr};
+    wl_data_device_manager* data_device_manager{nullptr};
+    xdg_wm_base* wm_base{nullptr};
+
+    static void add(void* data, wl_registry* registry, uint32_t id, char const* interface, uint32_t /*version*/)
+    {
+        auto const self = static_cast<Globals*>(data);
+
+        if (strcmp(interface, wl_compositor_interface.name) == 0)
+            self->compositor = static_cast<wl_compositor*>(wl_registry_bind(registry, id, &wl_compositor_interface, 3));
+        else if (strcmp(interface, wl_subcompositor_interface.name) == 0)
+            self->subcompositor = static_cast<wl_subcompositor*>(
+                wl_registry_bind(registry, id, &wl_subcompositor_interface, 1));
+        else if (strcmp(interface, wl_shm_interface.name) == 0)
+            self->shm = static_cast<wl_shm*>(wl_registry_bind(registry, id, &wl_shm_interface, 1));
+        else if (strcmp(interface, wl_seat_interface.name) == 0 && !self->seat)
+            self->seat = static_cast<wl_seat*>(wl_registry_bind(registry, id, &wl_seat_interface, 1));
+        else if (strcmp(interface, wl_data_device_manager_interface.name) == 0)
+            self->data_device_manager = static_cast<wl_data_device_manager*>(
+                wl_registry_bind(registry, id, &wl_data_device_manager_interface, 1));
+        else if (strcmp(interface, xdg_wm_base_interface.name) == 0)
+        {
+            self->wm_base = static_cast<xdg_wm_base*>(wl_registry_bind(registry, id, &xdg_wm_base_interface, 1));
+            xdg_wm_base_add_listener(self->wm_base, &wm_base_listener, self);
+        }
+    }
+
+    static void remove(void*, wl_registry*, uint32_t) {}
+
+    static void ping(void*, xdg_wm_base* wm_base, uint32_t serial)
+    {
+        xdg_wm_base_pong(wm_base, serial);
+    }
+
+    static xdg_wm_base_listener const wm_base_listener;
+};
+
+xdg_wm_base_listener const Globals::wm_base_listener{&Globals::ping};
+wl_registry_listener const registry_listener{&Globals::add, &Globals::remove};
+
+/// A wl_shm buffer of one colour; the compositor may hold it as long as it likes, as we never change it
+class Buffer
+{
+public:
+    Buffer(wl_shm* shm, int width, int height, uint32_t colour) :
+        size{static_cast<size_t>(width) * height * 4}
+    {
+        auto const fd = memfd_create("mir-wayland-stress", MFD_CLOEXEC);
+        if (fd < 0 || ftruncate(fd, size) < 0)
+            throw std::runtime_error{"Failed to allocate an shm buffer"};
+
+        auto const pixels = static_cast<uint32_t*>(mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+        if (pixels == MAP_FAILED)
+            throw std::runtime_error{"Failed to map an shm buffer"};
+        std::fill(pixels, pixels + size / 4, colour);
+        munmap(pixels, size);
+
+        auto const pool = wl_shm_create_pool(shm, fd, size);
+        buffer = wl_shm_pool_create_buffer(pool, 0, width, height, width * 4, WL_SHM_FORMAT_XRGB8888);
+        wl_shm_pool_destroy(pool);
+        close(fd);
+    }
+
+    ~Buffer()
+    {
+        wl_buffer_destroy(buffer);
+    }
+
+    Buffer(Buffer const&) = delete;
+    Buffer& operator=(Buffer const&) = delete;
+
+    wl_buffer* buffer;
+
+private:
+    size_t const size;
+};
+
+/// An xdg toplevel, mapped with the first buffer once the first configure is acked
+class Window
+{
+public:
+    Window(Globals const& globals, Buffer& content) :
+        content{&content},
+        surface{wl_compositor_create_surface(globals.compositor)},
+        xdg_surface_{xdg_wm_base_get_xdg_surface(globals.wm_base, surface)},
+        toplevel{xdg_surface_get_toplevel(xdg_surface_)}
+    {
+        xdg_surface_add_listener(xdg_surface_, &surface_listener, this);
+        xdg_toplevel_add_listener(toplevel, &toplevel_listener, this);
+        xdg_toplevel_set_title(toplevel, "mir_wayland_stress_client");
+        wl_surface_commit(surface);
+    }
+
+    ~Window()
+    {
+        xdg_toplevel_destroy(toplevel);
+        xdg_surface_destroy(xdg_surface_);
+        wl_surface_destroy(surface);
+    }
+
+    Window(Window const&) = delete;
+    Window& operator=(Window const&) = delete;
+
+    /// Called with each configure, after it's acked and before the surface is committed
+    std::function<void(Window&)> on_configure;
+
+    Buffer* content;
+    wl_surface* const surface;
+    bool maximized{false};
+    int64_t configures{0};
+
+private:
+    static void configure(void* data, xdg_surface* xdg_surface, uint32_t serial)
+    {
+        auto const self = static_cast<Window*>(data);
+        xdg_surface_ack_configure(xdg_surface, serial);
+        ++self->configures;
+        if (self->on_configure)
+            self->on_configure(*self);
+        wl_surface_attach(self->surface, self->content->buffer, 0, 0);
+        wl_surface_damage(self->surface, 0, 0, INT32_MAX, INT32_MAX);
+        wl_surface_commit(self->surface);
+    }
+
+    static void toplevel_configure(void* data, xdg_toplevel*, int32_t, int32_t, wl_array* states)
+    {
+        auto const self = static_cast<Window*>(data);
+        self->maximized = false;
+        for (auto state = static_cast<uint32_t const*>(states->data);
+             reinterpret_cast<char const*>(state) < static_cast<char const*>(states->data) + states->size;
+             ++state)
+        {
+            if (*state == XDG_TOPLEVEL_STATE_MAXIMIZED)
+                self->maximized = true;
+        }
+    }
+
+    static void close(void*, xdg_toplevel*) {}
+
+    static xdg_surface_listener const surface_listener;
+    static xdg_toplevel_listener const toplevel_listener;
+
+    xdg_surface* const xdg_surface_;
+    xdg_toplevel* const toplevel;
+
+    friend class StressClient;
+};
+
+xdg_surface_listener const Window::surface_listener{&Window::configure};
+xdg_toplevel_listener const Window::toplevel_listener{&Window::toplevel_configure, &Window::close};
+
+auto percentiles(std::vector<int64_t> samples_ns) -> std::string
+{
+    if (samples_ns.empty())
+        return "{\"p50\": 0, \"p99\": 0, \"max\": 0}";
+
+    std::sort(samples_ns.begin(), samples_ns.end());
+    auto const at = [&](double fraction)
+        {
+            auto const i = std::min(samples_ns.size() - 1, static_cast<size_t>(fraction * samples_ns.size()));
+            return samples_ns[i] / 1000.0;
+        };
+
+    char result[128];
+    snprintf(result, sizeof result, "{\"p50\": %.1f, \"p99\": %.1f, \"max\": %.1f}",
+             at(0.5), at(0.99), samples_ns.back() / 1000.0);
+    return result;
+}
+
+class StressClient
+{
+public:
+    StressClient(wl_display* display, Globals const& globals, Options const& options) :
+        display{display},
+        globals{globals},
+        options{options},
+        content{globals.shm, options.width, options.height, 0xff808080},
+        small_content{globals.shm, std::max(1, options.width / 4), std::max(1, options.height / 4), 0xff404040},
+        window{globals, content}
+    {
+        wl_seat_add_listener(globals.seat, &seat_listener, this);
+
+        if (options.scenario == Scenario::data_device)
+        {
+            if (!globals.data_device_manager)
+                throw std::runtime_error{"The compositor lacks wl_data_device_manager"};
+            data_device = wl_data_device_manager_get_data_device(globals.data_device_manager, globals.seat);
+        }
+
+        if (options.scenario == Scenario::configure)
+        {
+            window.on_configure = [this](Window& window)
+                {
+                    if (configure_requested >= 0)
+                    {
+                        configure_ns.push_back(now_ns() - configure_requested);
+                        configure_requested = -1;
+                    }
+                    // Ack each state with a new buffer, as a real client would
+                    window.content = window.maximized ? &content : &small_content;
+                };
+        }
+
+        // Map the window before we begin
+        while (window.configures == 0)
+        {
+            if (wl_display_dispatch(display) < 0)
+                throw std::runtime_error{"Lost the connection to the compositor"};
+        }
+
+        if (options.scenario == Scenario::subsurfaces)
+        {
+            if (!globals.subcompositor)
+                throw std::runtime_error{"The compositor lacks wl_subcompositor"};
+
+            for (int i = 0; i != options.subsurfaces; ++i)
+            {
+                auto const surface = wl_compositor_create_surface(globals.compositor);
+                auto const subsurface = wl_subcompositor_get_subsurface(globals.subcompositor, surface, window.surface);
+                wl_subsurface_set_position(subsurface, i * 8, i * 8);
+                wl_surface_attach(surface, small_content.buffer, 0, 0);
+                wl_surface_commit(surface);
+                children.push_back({surface, subsurface});
+            }
+            wl_surface_commit(window.surface);
+        }
+
+        wl_display_roundtrip(display);
+    }
+
+    ~StressClient()
+    {
+        if (sync)
+            wl_callback_destroy(sync);
+        churned_window.reset();
+        for (auto const& child : children)
+        {
+            wl_subsurface_destroy(child.subsurface);
+            wl_surface_destroy(child.surface);
+        }
+        if (data_source)
+            wl_data_source_destroy(data_source);
+        if (data_device)
+            wl_data_device_destroy(data_device);
+        if (pointer)
+            wl_pointer_destroy(pointer);
+        if (keyboard)
+            wl_keyboard_destroy(keyboard);
+    }
+
+    auto waiting_for_sync() const -> bool
+    {
+        return sync != nullptr;
+    }
+
+    /// Runs one iteration, unless the last one's still in flight
+    void tick()
+    {
+        if (sync)
+        {
+            ++missed;
+            return;
+        }
+
+        switch (options.scenario)
+        {
+        case Scenario::surfaces:
+            churned_window = std::make_unique<Window>(globals, small_content);
+            break;
+
+        case Scenario::commits:
+            commit_with_damage();
+            break;
+
+        case Scenario::subsurfaces:
+            reorder_subsurfaces();
+            break;
+
+        case Scenario::data_device:
+            offer_selection();
+            break;
+
+        case Scenario::configure:
+            configure_requested = now_ns();
+            if (window.maximized)
+                xdg_toplevel_unset_maximized(window.toplevel);
+            else
+                xdg_toplevel_set_maximized(window.toplevel);
+            break;
+
+        case Scenario::pointer:
+            break;
+        }
+
+        ++iterations;
+        sync_sent = now_ns();
+        sync = wl_display_sync(display);
+        wl_callback_add_listener(sync, &sync_listener, this);
+        wl_display_flush(display);
+    }
+
+    void print_stats() const
+    {
+        printf("{\"pid\": %d, \"scenario\": \"%s\", \"iterations\": %lu, \"missed\": %lu, "
+               "\"roundtrip_us\": %s, \"configure_us\": %s, \"motion_events\": %lu}\n",
+               getpid(), name_of(options.scenario), iterations, missed,
+               percentiles(roundtrip_ns).c_str(), percentiles(configure_ns).c_str(), motion_events);
+    }
+
+private:
+    struct Child
+    {
+        wl_surface* surface;
+        wl_subsurface* subsurface;
+    };
+
+    void commit_with_damage()
+    {
+        // Scatter the damage, so the compositor can't coalesce it into a single rectangle
+        auto const columns = std::max(1, options.width / 16);
+        wl_surface_attach(window.surface, content.buffer, 0, 0);
+        for (int i = 0; i != options.damage; ++i)
+        {
+            auto const cell = (iterations * options.damage + i) * 7;
+            wl_surface_damage(
+                window.surface,
+                (cell % columns) * 16,
+                ((cell / columns) * 16) % options.height,
+                16, 16);
+        }
+        wl_surface_commit(window.surface);
+    }
+
+    void reorder_subsurfaces()
+    {
+        auto const count = children.size();
+        auto const moved = iterations % count;
+        auto const sibling = (moved + 1 + (iterations / count) % (count - 1)) % count;
+        if (iterations % 2)
+            wl_subsurface_place_above(children[moved].subsurface, children[sibling].surface);
+        else
+            wl_subsurface_place_below(children[moved].subsurface, children[sibling].surface);
+        // Subsurfaces are synchronized, so it takes the parent's commit to apply the new order
+        wl_surface_commit(window.surface);
+    }
+
+    void offer_selection()
+    {
+        auto const previous = data_source;
+        data_source = wl_data_device_manager_create_data_source(globals.data_device_manager);
+        wl_data_source_add_listener(data_source, &data_source_listener, this);
+        wl_data_source_offer(data_source, "text/plain");
+        wl_data_source_offer(data_source, "text/plain;charset=utf-8");
+        wl_data_source_offer(data_source, "UTF8_STRING");
+        wl_data_device_set_selection(data_device, data_source, keyboard_serial);
+        if (previous)
+            wl_data_source_destroy(previous);
+    }
+
+    static void sync_done(void* data, wl_callback* callback, uint32_t)
+    {
+        auto const self = static_cast<StressClient*>(data);
+        self->roundtrip_ns.push_back(now_ns() - self->sync_sent);
+        wl_callback_destroy(callback);
+        self->sync = nullptr;
+    }
+
+    static void capabilities(void* data, wl_seat* seat, uint32_t caps)
+    {
+        auto const self = static_cast<StressClient*>(data);
+        if ((caps & WL_SEAT_CAPABILITY_POINTER) && !self->pointer)
+        {
+            self->pointer = wl_seat_get_pointer(seat);
+            wl_pointer_add_listener(self->pointer, &pointer_listener, self);
+        }
+        if ((caps & WL_SEAT_CAPABILITY_KEYBOARD) && !self->keyboard)
+        {
+            self->keyboard = wl_seat_get_keyboard(seat);
+            wl_keyboard_add_listener(self->keyboard, &keyboard_listener, self);
+        }
+    }
+
+    static void motion(void* data, wl_pointer*, uint32_t, wl_fixed_t, wl_fixed_t)
+    {
+        ++static_cast<StressClient*>(data)->motion_events;
+    }
+
+    static void pointer_enter(void*, wl_pointer*, uint32_t, wl_surface*, wl_fixed_t, wl_fixed_t) {}
+    static void pointer_leave(void*, wl_pointer*, uint32_t, wl_surface*) {}
+    static void button(void*, wl_pointer*, uint32_t, uint32_t, uint32_t, uint32_t) {}
+    static void axis(void*, wl_pointer*, uint32_t, uint32_t, wl_fixed_t) {}
+
+    static void keymap(void*, wl_keyboard*, uint32_t, int32_t fd, uint32_t)
+    {
+        ::close(fd);
+    }
+
+    static void keyboard_enter(void* data, wl_keyboard*, uint32_t serial, wl_surface*, wl_array*)
+    {
+        // A selection needs the serial of an input event, or the compositor can ignore it
+        static_cast<StressClient*>(data)->keyboard_serial = serial;
+    }
+
+    static void keyboard_leave(void*, wl_keyboard*, uint32_t, wl_surface*) {}
+    static void key(void*, wl_keyboard*, uint32_t, uint32_t, uint32_t, uint32_t) {}
+    static void modifiers(void*, wl_keyboard*, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t) {}
+
+    static void target(void*, wl_data_source*, char const*) {}
+
+    static void send(void*, wl_data_source*, char const*, int32_t fd)
+    {
+        static char const payload[] = "mir_wayland_stress_client";
+        if (write(fd, payload, sizeof payload - 1) < 0)
+        {
+            // The receiver went away; nothing to do
+        }
+        ::close(fd);
+    }
+
+    static void cancelled(void*, wl_data_source*) {}
+
+    static wl_callback_listener const sync_listener;
+    static wl_seat_listener const seat_listener;
+    static wl_pointer_listener const pointer_listener;
+    static wl_keyboard_listener const keyboard_listener;
+    static wl_data_source_listener const data_source_listener;
+
+    wl_display* const display;
+    Globals const& globals;
+    Options const options;
+    Buffer content;
+    Buffer small_content;
+    Window window;
+    std::unique_ptr<Window> churned_window;
+    std::vector<Child> children;
+    wl_pointer* pointer{nullptr};
+    wl_keyboard* keyboard{nullptr};
+    uint32_t keyboard_serial{0};
+    wl_data_device* data_device{nullptr};
+    wl_data_source* data_source{nullptr};
+
+    wl_callback* sync{nullptr};
+    int64_t sync_sent{0};
+    int64_t configure_requested{-1};
+
+    unsigned long iterations{0};
+    unsigned long missed{0};
+    unsigned long motion_events{0};
+    std::vector<int64_t> roundtrip_ns;
+    std::vector<int64_t> configure_ns;
+};
+
+wl_callback_listener const StressClient::sync_listener{&StressClient::sync_done};
+wl_seat_listener const StressClient::seat_listener{&StressClient::capabilities, nullptr};
+wl_pointer_listener const StressClient::pointer_listener{
+    &StressClient::pointer_enter,
+    &StressClient::pointer_leave,
+    &StressClient::motion,
+    &StressClient::button,
+    &StressClient::axis};
+wl_keyboard_listener const StressClient::keyboard_listener{
+    &StressClient::keymap,
+    &StressClient::keyboard_enter,
+    &StressClient::keyboard_leave,
+    &StressClient::key,
+    &StressClient::modifiers};
+wl_data_source_listener const StressClient::data_source_listener{
+    &StressClient::target,
+    &StressClient::send,
+    &StressClient::cancelled};
+
+auto timer_for(double rate) -> int
+{
+    auto const period_ns = static_cast<long>(1e9 / rate);
+    itimerspec period{};
+    period.it_interval.tv_sec = period_ns / 1000000000;
+    period.it_interval.tv_nsec = period_ns % 1000000000;
+    period.it_value = period.it_interval;
+
+    auto const fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (fd < 0 || timerfd_settime(fd, 0, &period, nullptr) < 0)
+        throw std::runtime_error{"Failed to create the iteration timer"};
+    return fd;
+}
+
+auto termination_signals() -> int
+{
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGINT);
+    sigprocmask(SIG_BLOCK, &signals, nullptr);
+    return signalfd(-1, &signals, SFD_CLOEXEC);
+}
+}
+
+int main(int argc, char* argv[])
+try
+{
+    auto const options = parse(argc, argv);
+    auto const signals = termination_signals();
+
+    auto const display = wl_display_connect(nullptr);
+    if (!display)
+        throw std::runtime_error{"Failed to connect to the Wayland compositor"};
+
+    Globals globals;
+    auto const registry = wl_display_get_registry(display);
+    wl_registry_add_listener(registry, &registry_listener, &globals);
+    wl_display_roundtrip(display);
+    if (!globals.compositor || !globals.shm || !globals.seat || !globals.wm_base)
+        throw std::runtime_error{"The compositor lacks wl_compositor, wl_shm, wl_seat or xdg_wm_base"};
+
+    {
+        StressClient client{display, globals, options};
+        auto const timer = options.rate > 0 ? timer_for(options.rate) : -1;
+
+        client.tick();
+
+        for (bool running = true; running;)
+        {
+            while (wl_display_prepare_read(display) != 0)
+                wl_display_dispatch_pending(display);
+            wl_display_flush(display);
+
+            pollfd fds[] = {
+                {wl_display_get_fd(display), POLLIN, 0},
+                {signals, POLLIN, 0},
+                {timer, POLLIN, 0}};
+
+            if (poll(fds, timer < 0 ? 2 : 3, -1) < 0)
+            {
+                wl_display_cancel_read(display);
+                continue;
+            }
+
+            if (fds[0].revents & POLLIN)
+            {
+                if (wl_display_read_events(display) < 0)
+                    throw std::runtime_error{"Lost the connection to the compositor"};
+            }
+            else
+            {
+                wl_display_cancel_read(display);
+            }
+            wl_display_dispatch_pending(display);
+
+            if (fds[1].revents & POLLIN)
+                running = false;
+
+            if (timer >= 0 && (fds[2].revents & POLLIN))
+            {
+                uint64_t expirations{0};
+                if (read(timer, &expirations, sizeof expirations) == sizeof expirations)
+                    client.tick();
+            }
+            else if (timer < 0 && !client.waiting_for_sync())
+            {
+                client.tick();
+            }
+        }
+
+        client.print_stats();
+        if (timer >= 0)
+            close(timer);
+    }
+
+    wl_registry_destroy(registry);
+    wl_display_disconnect(display);
+    return EXIT_SUCCESS;
+}
+catch (std::exception const& error)
+{
+    fprintf(stderr, "mir_wayland_stress_client: %s\n", error.what());
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,331 @@
+#!/usr/bin/python3
+
+"""Wayland protocol stress and throughput benchmark.
+
+Runs a Mir server with --wayland-request-report=log --wayland-request-report-interval=1
+and, for each scenario in turn, N Wayland clients (mir_wayland_stress_client)
+repeating that scenario's requests: surface create/destroy churn, commit storms with scattered damage,
+subsurface reordering, wl_data_device selection offers, xdg configure/ack cycles,
+and (with --scenario pointer, which needs python3-evdev and /dev/uinput) a
+pointer-motion flood. Records how busy the Wayland thread was, the handler time of
+requests, the WaylandExecutor's queue depth and wait, and the round-trip latency
+the clients saw.
+
+  wayland_stress.py run --clients 16 --output before.json
+  wayland_stress.py compare before.json after.json
+"""
+
+import argparse
+import json
+import os
+import re
+import shutil
+import signal
+import statistics
+import subprocess
+import sys
+import threading
+import time
+
+SCENARIOS = ["surfaces", "commits", "subsurfaces", "data-device", "configure", "pointer"]
+
+REQUESTS = re.compile(r"Wayland: (?P<rate>\d+) requests/s")
+THREAD = re.compile(
+    r"thread (?P<busy>\d+)% busy \(requests (?P<requests>\d+)%, executor (?P<executor>\d+)%\)")
+REQUEST_TIME = re.compile(r"request time: p50 <(?P<p50>\d+)us p99 <(?P<p99>\d+)us max (?P<max>\d+)us")
+EXECUTOR = re.compile(
+    r"executor: (?P<wakeups>\d+) wakeups, mean (?P<mean_items>\d+) max (?P<max_items>\d+) work items, "
+    r"mean wait (?P<mean_wait>\d+)us max wait (?P<max_wait>\d+)us, mean run (?P<mean_run>\d+)us")
+
+CLOCK_TICKS = os.sysconf("SC_CLK_TCK")
+
+
+def cpu_seconds(pid):
+    """User and system time of a process, in seconds"""
+    with open("/proc/%d/stat" % pid) as stat:
+        # The command may contain spaces, but is the only field in parentheses
+        fields = stat.read().rsplit(")", 1)[1].split()
+    return (int(fields[11]) + int(fields[12])) / CLOCK_TICKS
+
+
+def parse_report(line):
+    """A "Wayland: " report line as a dict, or None"""
+    requests = REQUESTS.search(line)
+    if not requests:
+        return None
+    report = {"requests_per_s": int(requests.group("rate"))}
+    for pattern in (THREAD, REQUEST_TIME, EXECUTOR):
+        match = pattern.search(line)
+        if match:
+            report.update({key: int(value) for key, value in match.groupdict().items()})
+    return report
+
+
+def mean(values):
+    values = list(values)
+    return statistics.mean(values) if values else 0.0
+
+
+class Server:
+    def __init__(self, executable, options, socket_name):
+        env = os.environ.copy()
+        env["WAYLAND_DISPLAY"] = socket_name
+        self.socket = os.path.join(os.environ["XDG_RUNTIME_DIR"], socket_name)
+        self.process = subprocess.Popen(
+            [executable, "--wayland-request-report=log", "--wayland-request-report-interval=1"] + options,
+            env=env, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+        self.lines = []
+        self.reader = threading.Thread(target=self._read, daemon=True)
+        self.reader.start()
+
+    def _read(self):
+        for line in self.process.stdout:
+            self.lines.append(line)
+
+    def wait_for_socket(self, timeout):
+        deadline = time.monotonic() + timeout
+        while not os.path.exists(self.socket):
+            if self.process.poll() is not None or time.monotonic() > deadline:
+                sys.exit("Server failed to start:\n" + "".join(self.lines))
+            time.sleep(0.05)
+
+    def stop(self):
+        self.process.terminate()
+        self.process.wait(timeout=10)
+        self.reader.join(timeout=1)
+
+
+class PointerFlood:
+    """A uinput mouse, jiggling at a fixed rate until stopped"""
+
+    def __init__(self, rate):
+        import evdev
+        self.evdev = evdev
+        self.ui = evdev.UInput(
+            events={
+                evdev.ecodes.EV_REL: [evdev.ecodes.REL_X, evdev.ecodes.REL_Y],
+                evdev.ecodes.EV_KEY: [evdev.ecodes.BTN_LEFT],
+            },
+            name="mir-wayland-stress-pointer")
+        self.period = 1.0 / rate
+        self.events = 0
+        self.running = True
+        self.thread = threading.Thread(target=self._run, daemon=True)
+        self.thread.start()
+
+    def _run(self):
+        ecodes = self.evdev.ecodes
+        step = 1
+        next_event = time.monotonic()
+        while self.running:
+            self.ui.write(ecodes.EV_REL, ecodes.REL_X, step)
+            self.ui.syn()
+            self.events += 1
+            step = -step
+            next_event += self.period
+            delay = next_event - time.monotonic()
+            if delay > 0:
+                time.sleep(delay)
+
+    def stop(self):
+        self.running = False
+        self.thread.join(timeout=1)
+        self.ui.close()
+
+
+def start_client(executable, socket_name, scenario, args):
+    env = os.environ.copy()
+    env["WAYLAND_DISPLAY"] = socket_name
+    cmdline = [executable, "--scenario", scenario, "--rate", str(args.rate), "--size", args.size,
+               "--damage", str(args.damage), "--subsurfaces", str(args.subsurfaces)]
+    return subprocess.Popen(cmdline, env=env, stdout=subprocess.PIPE, universal_newlines=True)
+
+
+def stop_client(client):
+    client.send_signal(signal.SIGTERM)
+    try:
+        output, _ = client.communicate(timeout=10)
+        return json.loads(output.strip().splitlines()[-1])
+    except (subprocess.TimeoutExpired, IndexError, ValueError):
+        client.kill()
+        return None
+
+
+def run_scenario(scenario, args):
+    client_executable = args.client or os.path.join(os.path.dirname(args.server), "mir_wayland_stress_client")
+    socket_name = "mir_wayland_stress_%d" % os.getpid()
+
+    server = Server(args.server, args.server_option or ["--offscreen"], socket_name)
+    server.wait_for_socket(10)
+
+    flood = PointerFlood(args.motion_rate) if scenario == "pointer" else None
+    clients = [start_client(client_executable, socket_name, scenario, args) for _ in range(args.clients)]
+
+    time.sleep(args.warmup)
+
+    first_report = len(server.lines)
+    start_cpu = cpu_seconds(server.process.pid)
+    start_motion = flood.events if flood else 0
+    start_time = time.monotonic()
+
+    time.sleep(args.duration)
+
+    elapsed = time.monotonic() - start_time
+    cpu = cpu_seconds(server.process.pid) - start_cpu
+    injected = (flood.events - start_motion) if flood else 0
+    reports = [r for r in map(parse_report, server.lines[first_report:]) if r]
+
+    # Stopping the clients ends their measurements too, so theirs cover the warmup as well
+    client_stats = [stop_client(client) for client in clients]
+    if flood:
+        flood.stop()
+    server.stop()
+
+    failed = sum(1 for stats in client_stats if stats is None)
+    if failed:
+        print("%s: %d of %d clients failed" % (scenario, failed, len(clients)), file=sys.stderr)
+    client_stats = [stats for stats in client_stats if stats is not None]
+    client_time = elapsed + args.warmup
+
+    wakeups = sum(r.get("wakeups", 0) for r in reports)
+
+    return {
+        "server": {
+            "requests_per_s": mean(r["requests_per_s"] for r in reports),
+            "cpu_percent": 100 * cpu / elapsed,
+            "thread_busy_percent": {
+                "mean": mean(r.get("busy", 0) for r in reports),
+                "max": max((r.get("busy", 0) for r in reports), default=0),
+                "requests": mean(r.get("requests", 0) for r in reports),
+                "executor": mean(r.get("executor", 0) for r in reports),
+            },
+            # Each report's percentiles are power-of-two bounds; these are their median and worst
+            "request_time_us": {
+                "p50": statistics.median([r["p50"] for r in reports if "p50" in r] or [0]),
+                "p99": max((r["p99"] for r in reports if "p99" in r), default=0),
+                "max": max((r["max"] for r in reports if "max" in r), default=0),
+            },
+            "executor": {
+                "wakeups_per_s": wakeups / elapsed,
+                "queue_depth": {
+                    "mean": sum(r.get("wakeups", 0) * r.get("mean_items", 0) for r in reports) / wakeups
+                    if wakeups else 0.0,
+                    "max": max((r.get("max_items", 0) for r in reports), default=0),
+                },
+                "wait_us": {
+                    "mean": sum(r.get("wakeups", 0) * r.get("mean_wait", 0) for r in reports) / wakeups
+                    if wakeups else 0.0,
+                    "max": max((r.get("max_wait", 0) for r in reports), default=0),
+                },
+                "run_us_mean": sum(r.get("wakeups", 0) * r.get("mean_run", 0) for r in reports) / wakeups
+                if wakeups else 0.0,
+            },
+        },
+        "clients": {
+            "running": len(client_stats),
+            "iterations_per_s": sum(s["iterations"] for s in client_stats) / client_time,
+            "missed": sum(s["missed"] for s in client_stats),
+            "roundtrip_us": {
+                "p50": statistics.median([s["roundtrip_us"]["p50"] for s in client_stats] or [0]),
+                "p99": max((s["roundtrip_us"]["p99"] for s in client_stats), default=0),
+                "max": max((s["roundtrip_us"]["max"] for s in client_stats), default=0),
+            },
+            "configure_us": {
+                "p50": statistics.median([s["configure_us"]["p50"] for s in client_stats] or [0]),
+                "p99": max((s["configure_us"]["p99"] for s in client_stats), default=0),
+            },
+            "motion_events_per_s": sum(s["motion_events"] for s in client_stats) / client_time,
+        },
+        "injected_motion_per_s": injected / elapsed,
+    }
+
+
+def run(args):
+    scenarios = args.scenario or [s for s in SCENARIOS if s != "pointer"]
+    return {
+        "label": args.label,
+        "config": {
+            "clients": args.clients,
+            "rate": args.rate,
+            "size": args.size,
+            "damage": args.damage,
+            "subsurfaces": args.subsurfaces,
+            "motion_rate": args.motion_rate,
+            "duration": args.duration,
+            "server_options": args.server_option or ["--offscreen"],
+        },
+        "scenarios": {scenario: run_scenario(scenario, args) for scenario in scenarios},
+    }
+
+
+def flatten(results, prefix=""):
+    for key, value in results.items():
+        if isinstance(value, dict):
+            yield from flatten(value, prefix + key + ".")
+        elif isinstance(value, (int, float)) and not isinstance(value, bool):
+            yield prefix + key, value
+
+
+def compare(args):
+    with open(args.before) as before_file, open(args.after) as after_file:
+        before = dict(flatten(json.load(before_file)))
+        after = dict(flatten(json.load(after_file)))
+
+    width = max(len(key) for key in before)
+    print("%-*s %12s %12s %9s" % (width, "metric", "before", "after", "change"))
+    for key, old in before.items():
+        if key not in after:
+            continue
+        new = after[key]
+        change = "%+8.1f%%" % (100 * (new - old) / old) if old else ""
+        print("%-*s %12.3f %12.3f %9s" % (width, key, old, new, change))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    run_parser = commands.add_parser("run", help="Measure a configuration")
+    run_parser.add_argument("--server", default=shutil.which("mir_demo_server"))
+    run_parser.add_argument("--server-option", action="append",
+                            help="Pass an option to the server (default: --offscreen)")
+    run_parser.add_argument("--client",
+                            help="The stress client (default: mir_wayland_stress_client beside the server)")
+    run_parser.add_argument("--scenario", action="append", choices=SCENARIOS,
+                            help="A scenario to run; repeat for several (default: all but pointer)")
+    run_parser.add_argument("--clients", type=int, default=8, help="Clients per scenario")
+    run_parser.add_argument("--rate", type=float, default=0,
+                            help="Iterations per second by each client; 0 for as fast as the server replies")
+    run_parser.add_argument("--size", default="320x240", help="Each window's size, as WIDTHxHEIGHT")
+    run_parser.add_argument("--damage", type=int, default=16, help="Damage rectangles per commit")
+    run_parser.add_argument("--subsurfaces", type=int, default=8, help="Subsurfaces per window to reorder")
+    run_parser.add_argument("--motion-rate", type=float, default=1000,
+                            help="Pointer motion events per second injected in the pointer scenario")
+    run_parser.add_argument("--duration", type=float, default=10, help="Seconds to measure each scenario for")
+    run_parser.add_argument("--warmup", type=float, default=2, help="Seconds to settle before measuring")
+    run_parser.add_argument("--label", default="")
+    run_parser.add_argument("--output", help="Write the results to a file, rather than stdout")
+
+    compare_parser = commands.add_parser("compare", help="Compare the results of two runs")
+    compare_parser.add_argument("before")
+    compare_parser.add_argument("after")
+
+    args = parser.parse_args()
+
+    if args.command == "compare":
+        compare(args)
+        return
+
+    if not args.server:
+        sys.exit("No mir_demo_server found; use --server")
+
+    results = json.dumps(run(args), indent=2)
+    if args.output:
+        with open(args.output, "w") as output:
+            output.write(results + "\n")
+    else:
+        print(results)
+
+
+if __name__ == "__main__":
+    main()
@@ -552,60 +552,64 @@ void FloatingWindowManagerPolicy::switch_workspace_to(
     if (workspace == active_workspace)
         return;
 
-    auto const old_active = active_workspace;
-    active_workspace = workspace;
+    // Show the new workspace and hide the old in one go, rather than window by window
+    tools.apply_atomically([&]
+        {
+            auto const old_active = active_workspace;
+            active_workspace = workspace;
 
-    auto const old_active_window = tools.active_window();
+            auto const old_active_window = tools.active_window();
 
-    if (!old_active_window)
-    {
-        // If there's no active window, the first shown grabs focus: get the right one
-        if (auto const ww = workspace_to_active[workspace])
-        {
-            tools.for_each_workspace_containing(ww, [&](std::shared_ptr<miral::Workspace> const& ws)
+            if (!old_active_window)
+            {
+                // If there's no active window, the first shown grabs focus: get the right one
+                if (auto const ww = workspace_to_active[workspace])
                 {
-                    if (ws == workspace)
-                    {
-                        apply_workspace_visible_to(ww);
-                    }
-                });
-        }
-    }
+                    tools.for_each_workspace_containing(ww, [&](std::shared_ptr<miral::Workspace> const& ws)
+                        {
+                            if (ws == workspace)
+                            {
+                                apply_workspace_visible_to(ww);
+                            }
+                        });
+                }
+            }
 
-    tools.remove_tree_from_workspace(window, old_active);
-    tools.add_tree_to_workspace(window, active_workspace);
+            tools.remove_tree_from_workspace(window, old_active);
+            tools.add_tree_to_workspace(window, active_workspace);
 
-    tools.for_each_window_in_workspace(active_workspace, [&](Window const& window)
-        {
-            if (decoration_provider->is_decoration(window))
-                return; // decorations are taken care of automatically
+            tools.for_each_window_in_workspace(active_workspace, [&](Window const& window)
+                {
+                    if (decoration_provider->is_decoration(window))
+                        return; // decorations are taken care of automatically
 
-            apply_workspace_visible_to(window);
-        });
+                    apply_workspace_visible_to(window);
+                });
 
-    bool hide_old_active = false;
-    tools.for_each_window_in_workspace(old_active, [&](Window const& window)
-        {
-            if (decoration_provider->is_decoration(window))
-                return; // decorations are taken care of automatically
+            bool hide_old_active = false;
+            tools.for_each_window_in_workspace(old_active, [&](Window const& window)
+                {
+                    if (decoration_provider->is_decoration(window))
+                        return; // decorations are taken care of automatically
 
-            if (window == old_active_window)
-            {
-                // If we hide the active window focus will shift: do that last
-                hide_old_active = true;
-                return;
-            }
+                    if (window == old_active_window)
+                    {
+                        // If we hide the active window focus will shift: do that last
+                        hide_old_active = true;
+                        return;
+                    }
 
-            apply_workspace_hidden_to(window);
-        });
+                    apply_workspace_hidden_to(window);
+                });
 
-    if (hide_old_active)
-    {
-        apply_workspace_hidden_to(old_active_window);
+            if (hide_old_active)
+            {
+                apply_workspace_hidden_to(old_active_window);
 
-        // Remember the old active_window when we switch away
-        workspace_to_active[old_active] = old_active_window;
-    }
+                // Remember the old active_window when we switch away
+                workspace_to_active[old_active] = old_active_window;
+            }
+        });
 }
 
 void FloatingWindowManagerPolicy::apply_workspace_hidden_to(Window const& window)
@@ -22,8 +22,7 @@
 #include "mir/fd.h"
 #include "mir/dispatch/dispatchable.h"
 
-#include <list>
-#include <mutex>
+#include <atomic>
 #include <functional>
 
 namespace mir
@@ -31,10 +30,17 @@ namespace mir
 namespace dispatch
 {
 
+/**
+ * Runs actions enqueued from any thread when dispatched.
+ *
+ * Enqueueing doesn't lock, and only wakes the dispatcher if the queue was empty. Each dispatch
+ * runs everything that was queued when it started, in order.
+ */
 class ActionQueue : public Dispatchable
 {
 public:
     ActionQueue();
+    ~ActionQueue();
     Fd watch_fd() const override;
 
     void enqueue(std::function<void()> const& action);
@@ -42,11 +48,19 @@ public:
     bool dispatch(FdEvents events) override;
     FdEvents relevant_events() const override;
 private:
+    struct Node
+    {
+        std::function<void()> action;
+        Node* next;
+    };
+
     bool consume();
     void wake();
+    /// Pushes the (newest first) chain from first to last, returning whether the queue was empty
+    bool push(Node* first, Node* last);
     mir::Fd event_fd;
-    std::mutex list_lock;
-    std::list<std::function<void()>> actions;
+    /// The queued actions, newest first
+    std::atomic<Node*> newest{nullptr};
 };
 }
 }
@@ -22,6 +22,8 @@
 #include "mir/dispatch/dispatchable.h"
 #include "mir/posix_rw_mutex.h"
 
+#include <cstdint>
+#include <deque>
 #include <functional>
 #include <initializer_list>
 #include <list>
@@ -95,10 +97,27 @@ public:
      */
     void remove_watch(Fd const& fd);
 private:
+    struct ReadySource
+    {
+        std::shared_ptr<Dispatchable> source;
+        bool rearm;
+        void* holder;       ///< The dispatchee_holder entry, for rearming
+        uint32_t events;    ///< As reported by epoll
+    };
+
+    bool fetch_ready_sources(ReadySource& ready);
+    bool take_ready_source(ReadySource& ready);
+
     PosixRWMutex lifetime_mutex;
     std::list<std::pair<std::shared_ptr<Dispatchable>, bool>> dispatchee_holder;
 
     Fd epoll_fd;
+
+    /// Sources epoll has reported ready that no thread has taken yet
+    std::mutex ready_mutex;
+    std::deque<ReadySource> ready_sources;
+    /// In the epoll set, and readable while ready_sources is not empty, so idle threads help to drain it
+    Fd ready_fd;
 };
 }
 }
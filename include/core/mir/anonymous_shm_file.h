@@ -33,12 +33,34 @@ namespace detail
 class AnonymousShmFile : public ShmFile
 {
 public:
+    /// Optional ways to create the file
+    struct Options
+    {
+        /// Ask for transparent huge pages, sparing large files many TLB misses (where the system allows them)
+        bool huge_pages = false;
+        /// Fault every page in now, rather than on first touch
+        bool prefault = false;
+        /// Allow seal() (which needs memfd support)
+        bool sealable = false;
+    };
+
     AnonymousShmFile(size_t size);
+    AnonymousShmFile(size_t size, Options const& options);
     ~AnonymousShmFile() noexcept;
 
     void* base_ptr() const override;
     int fd() const override;
 
+    /**
+     * Seal the file against any change of content or size
+     *
+     * Clients can then map the file, rather than copy it, knowing no one else can change it.
+     * Our own mapping becomes read-only, and may move, so base_ptr() must be asked again.
+     *
+     * \return whether the file is now sealed (it can't be unless Options::sealable was given)
+     */
+    auto seal() -> bool;
+
 private:
     Fd const fd_;
     class MapHandle;
@@ -0,0 +1,106 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef MIR_GEOMETRY_REGION_H_
+#define MIR_GEOMETRY_REGION_H_
+
+#include "mir/geometry/displacement.h"
+#include "mir/geometry/point.h"
+#include "mir/geometry/rectangle.h"
+#include "mir/geometry/rectangles.h"
+
+#include <initializer_list>
+#include <iosfwd>
+#include <vector>
+
+namespace mir
+{
+namespace geometry
+{
+/**
+ * An area of the plane: a set of points, rather than a list of rectangles.
+ *
+ * The area is held as non-overlapping boxes kept "banded", as pixman's and X11's regions are:
+ * sorted into horizontal bands of boxes sharing a top and bottom, left to right within a band,
+ * with no two boxes of a band touching and no two adjacent bands alike. An area has only the one
+ * such representation, and union, intersection and subtraction are each a single pass over the
+ * bands of both operands, linear in their numbers of boxes.
+ */
+class Region
+{
+public:
+    /// The storage: plain ints, [x1, x2) across and [y1, y2) down, for tight loops over them
+    struct Box
+    {
+        int x1, y1, x2, y2;
+    };
+
+    Region();
+    Region(Rectangle const& rect);
+    Region(std::initializer_list<Rectangle> const& rects);
+    explicit Region(std::vector<Rectangle> const& rects);
+    explicit Region(Rectangles const& rects);
+    /* We want to keep implicit copy and move methods */
+
+    bool empty() const;
+    /// The smallest rectangle containing the whole area (an empty one if the area's empty)
+    Rectangle bounding_rectangle() const;
+    bool contains(Point const& point) const;
+    /// Whether every point of rect is in the area
+    bool contains(Rectangle const& rect) const;
+    /// Whether any point of rect is in the area
+    bool overlaps(Rectangle const& rect) const;
+
+    Region& operator|=(Region const& other);
+    Region& operator&=(Region const& other);
+    Region& operator-=(Region const& other);
+    void translate(Displacement const& offset);
+
+    /// The area as non-overlapping rectangles, top to bottom then left to right
+    auto rectangles() const -> std::vector<Rectangle>;
+    auto boxes() const -> std::vector<Box> const& { return boxes_; }
+
+    bool operator==(Region const& other) const;
+    bool operator!=(Region const& other) const;
+
+private:
+    void update_extents();
+
+    std::vector<Box> boxes_;
+    Box extents;
+};
+
+inline Region operator|(Region lhs, Region const& rhs)
+{
+    return lhs |= rhs;
+}
+
+inline Region operator&(Region lhs, Region const& rhs)
+{
+    return lhs &= rhs;
+}
+
+inline Region operator-(Region lhs, Region const& rhs)
+{
+    return lhs -= rhs;
+}
+
+std::ostream& operator<<(std::ostream& out, Region const& value);
+}
+}
+
+#endif /* MIR_GEOMETRY_REGION_H_ */
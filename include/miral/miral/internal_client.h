@@ -19,13 +19,21 @@
 #ifndef MIRAL_INTERNAL_CLIENT_H
 #define MIRAL_INTERNAL_CLIENT_H
 
+#include "miral/window.h"
+#include "miral/window_specification.h"
+
+#include <mir/geometry/dimensions.h>
+#include <mir_toolkit/common.h>
+
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <string>
 
-namespace mir { class Server; namespace scene { class Session; }}
+namespace mir { class Server; namespace scene { class Session; } namespace compositor { struct Presentation; }}
 
 struct wl_display;
+typedef struct MirEvent MirEvent;
 
 namespace miral
 {
@@ -56,6 +64,72 @@ private:
     std::shared_ptr<Self> internal_client;
 };
 
+/** The session of an in-process client: it opens a session with the shell directly, rather
+ *  than connecting to the Wayland socket
+ *  \note wait_for() is for the client thread; the rest may be called on any thread
+ *  \remark Since MirAL 3.2
+ */
+class InProcessClient
+{
+public:
+    InProcessClient(mir::Server& server, std::string const& name);
+    ~InProcessClient();
+
+    auto session() const -> std::shared_ptr<mir::scene::Session>;
+
+    /// Wait up to \p timeout, returning false early once stop() is called
+    auto wait_for(std::chrono::milliseconds timeout) const -> bool;
+
+    /// Make wait_for() return false (the launcher does this when the server stops)
+    void stop();
+
+private:
+    friend class InProcessSurface;
+    struct Self;
+    std::shared_ptr<Self> const self;
+};
+
+/** A window of an in-process client, drawn straight into buffers the server allocates and
+ *  submitted to the compositor without any protocol, copying or import in between
+ *  \note Must be destroyed before the client that created it
+ *  \remark Since MirAL 3.2
+ */
+class InProcessSurface
+{
+public:
+    /// A CPU mapping of the buffer being drawn
+    struct Pixels
+    {
+        unsigned char* data;
+        mir::geometry::Size size;
+        mir::geometry::Stride stride;
+        MirPixelFormat format;
+    };
+
+    /// \param spec  the window to create, which must include a size
+    InProcessSurface(InProcessClient const& client, WindowSpecification const& spec, MirPixelFormat format);
+    ~InProcessSurface();
+
+    auto window() const -> Window;
+
+    /** Draw the next frame of the given size and hand it to the compositor. The window is
+     *  resized if the size differs from the last frame's.
+     *  \note Buffers are recycled, so \p paint starts with undefined content and must draw
+     *  every pixel
+     */
+    void draw(mir::geometry::Size const& size, std::function<void(Pixels const& pixels)> const& paint);
+
+    /// Called on the compositor thread once each frame has reached the screen; must not block
+    void on_presented(std::function<void(mir::compositor::Presentation const& presentation)> const& callback);
+
+    /// Called on the input thread with each event delivered to the window; must not block
+    void on_input(std::function<void(MirEvent const& event)> const& callback);
+
+private:
+    struct Self;
+    std::shared_ptr<Self> const self;
+};
+
 class InternalClientLauncher
 {
 public:
@@ -76,6 +150,14 @@ public:
             [&](std::weak_ptr<mir::scene::Session> const session) { client_object(session); });
     }
 
+    /** Run an in-process client: client_code runs on its own thread, and must return
+     *  once client.wait_for() returns false
+     *  \remark Since MirAL 3.2
+     */
+    void run_in_process(
+        std::string const& name,
+        std::function<void(InProcessClient& client)> const& client_code) const;
+
 private:
     struct Self;
     std::shared_ptr<Self> self;
@@ -120,6 +120,11 @@ public:
     /// Could allow a client to extract information about other programs the user is running
     /// \remark Since MirAL 3.1
     static char const* const zwlr_foreign_toplevel_manager_v1;
+
+    /// Allows a client to copy the contents of outputs, for screenshots and screencasts
+    /// Could allow a client to see everything that the user is running
+    /// \remark Since MirAL 3.2
+    static char const* const zwlr_screencopy_manager_v1;
     /** @} */
 
     /// Add a bespoke Wayland extension both to "supported" and "enabled by default".
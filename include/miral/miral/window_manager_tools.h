@@ -23,6 +23,8 @@
 #include "window_info.h"
 
 #include <mir/geometry/displacement.h>
+#include <mir/geometry/dimensions.h>
+#include <mir/geometry/size.h>
 
 #include <functional>
 #include <memory>
@@ -241,6 +243,31 @@ public:
         std::shared_ptr<Workspace> const& workspace,
         std::function<void(Window const& window)> const& callback);
 
+    /**
+     * Make the changes to windows that changes makes appear on screen all at once
+     * \remark Since MirAL 3.2
+     * @param changes   makes the changes (using these tools)
+     */
+    void apply_atomically(std::function<void()> const& changes);
+
+    /// Receives a thumbnail: pixels are 0xAARRGGBB, and only valid during the call.
+    /// size is empty if the window has no content.
+    using ThumbnailCallback = std::function<void(
+        mir::geometry::Size const& size, mir::geometry::Stride stride, void const* pixels)>;
+
+    /**
+     * Take a thumbnail of the window's current content, scaled down (on the GPU,
+     * preserving aspect ratio) to fit within max_size.
+     *
+     * The thumbnail is reused until the window's client commits new content, so
+     * this can be called every frame for several windows (e.g. an overview).
+     * \remark Since MirAL 3.2
+     * @param window    the window
+     * @param max_size  the size to fit the thumbnail within
+     * @param callback  receives the thumbnail (on the snapshot thread)
+     */
+    void take_thumbnail(Window const& window, mir::geometry::Size const& max_size, ThumbnailCallback const& callback);
+
 /** @} */
 
     /** Multi-thread support
@@ -251,6 +278,16 @@ public:
      */
     void invoke_under_lock(std::function<void()> const& callback);
 
+    /** Multi-thread support for queries
+     *  Allows threads that don't hold a lock on the model to call the "Query Model" member functions
+     *  that don't change it (such as info_for(), window_at() and active_window()). Such queries run
+     *  alongside one another and don't call WindowManagementPolicy::advise_begin()/advise_end(); they
+     *  still wait for any update that is in progress.
+     *  The callback must NOT update the model, and this should NOT be used by a thread that has called
+     *  the WindowManagementPolicy methods (and already holds the lock).
+     */
+    void invoke_under_shared_lock(std::function<void()> const& callback);
+
 private:
     WindowManagerToolsImplementation* tools;
 };
@@ -165,6 +165,22 @@ public:
     auto server_side_decorated() -> mir::optional_value<bool>&;
     ///@}
 
+    /// If the window's buffers may be shown without waiting for vblank (so may tear) when it is fullscreen
+    /// Clients ask for this; a policy that doesn't want it should reset it in handle_modify_window()
+    ///@{
+    auto tearing_allowed() const -> mir::optional_value<bool> const&;
+    auto tearing_allowed() -> mir::optional_value<bool>&;
+    ///@}
+
+    /// The most frames a second the window's client is asked to draw; zero lifts the limit
+    /// This is for the policy to set, for example to slow down windows without focus in
+    /// advise_focus_lost() and restore them in advise_focus_gained(). It paces the frame
+    /// callbacks the client waits on, and never asks for more than the outputs show.
+    ///@{
+    auto max_frame_rate() const -> mir::optional_value<float> const&;
+    auto max_frame_rate() -> mir::optional_value<float>&;
+    ///@}
+
 private:
     struct Self;
     std::unique_ptr<Self> self;
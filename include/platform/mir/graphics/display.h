@@ -73,11 +73,21 @@ public:
      * rendering is fast or skipped altogether (bypass/overlays). But sampling
      * too late and we might miss the deadline. If unsure just return zero.
      *
+     * The compositor asks just before it samples the scene, so the delay is
+     * measured from the time of the call rather than from the last post().
+     *
      * This is equivalent to:
      * https://www.opengl.org/registry/specs/NV/glx_delay_before_swap.txt
      */
     virtual std::chrono::milliseconds recommended_sleep() const = 0;
 
+    /**
+     * Timing of the frame the last post() put on screen, or a default Frame
+     * if the platform can't tell. For a group of several outputs this is the
+     * first output's timing.
+     */
+    virtual Frame last_frame() const = 0;
+
     virtual ~DisplaySyncGroup() = default;
 protected:
     DisplaySyncGroup() = default;
@@ -124,6 +134,44 @@ public:
      */
     virtual void configure(DisplayConfiguration const& conf) = 0;
 
+    /**
+     * Sets a new output configuration, keeping the DisplaySyncGroups whose outputs it leaves
+     * unchanged.
+     *
+     * Each DisplaySyncGroup that is to be replaced is passed to \p release before it is
+     * destroyed, so that whatever is using it can let it go. References to the groups that
+     * aren't passed to \p release remain valid; for_each_display_sync_group() afterwards also
+     * shows the new groups.
+     *
+     * \param conf    [in] Configuration to apply.
+     * \param release [in] Called with each group that is about to be destroyed.
+     */
+    virtual void configure_incrementally(
+        DisplayConfiguration const& conf,
+        std::function<void(DisplaySyncGroup&)> const& release) = 0;
+
+    /**
+     * Applies a configuration that differs from the current one only in the power modes of
+     * its outputs, keeping the DisplaySyncGroups of the outputs it powers off for when they
+     * are powered on again.
+     *
+     * Each group whose outputs are powered off is passed to \p suspend before they are, and
+     * each group whose outputs are powered on again is passed to \p resume once they are.
+     * Meanwhile for_each_display_sync_group() doesn't show the suspended groups, but references
+     * to them remain valid until they are resumed or passed to the \c release of a later
+     * configure_incrementally().
+     *
+     * \param conf    [in] Configuration to possibly apply.
+     * \param suspend [in] Called with each group that is about to be powered off.
+     * \param resume  [in] Called with each group that has been powered on again.
+     * \return        \c true if \p conf has been applied; \c false, having changed nothing, if
+     *                it differs in more than power modes or the groups can't be kept.
+     */
+    virtual bool apply_if_configuration_only_changes_power_modes(
+        DisplayConfiguration const& conf,
+        std::function<void(DisplaySyncGroup&)> const& suspend,
+        std::function<void(DisplaySyncGroup&)> const& resume) = 0;
+
     /**
      * Registers a handler for display configuration changes.
      *
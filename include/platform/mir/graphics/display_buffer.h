@@ -55,18 +55,21 @@ public:
 
     /** This will render renderlist to the screen and post the result to the 
      *  screen if there is a hardware optimization that can be done.
-     *  \param [in] renderlist 
+     *  \param [in,out] renderlist 
      *      The renderables that should appear on the screen if the hardware
      *      is capable of optmizing that list somehow. If what you want
      *      displayed on the screen cannot be represented by a RenderableList,
      *      then you should render using a graphics library like OpenGL.
+     *      Renderables the hardware will show itself (on overlay planes, say)
+     *      are removed from the list, even if it can't show them all.
      *  \returns
      *      True if the hardware can (and has) fully composite/overlay the list;
      *      False if the hardware platform cannot composite the list, and the
-     *      caller should then render the list another way using a graphics
-     *      library such as OpenGL.
+     *      caller should then render what remains of the list another way
+     *      using a graphics library such as OpenGL. It will appear beneath
+     *      any renderables the hardware took.
     **/
-    virtual bool overlay(RenderableList const& renderlist) = 0;
+    virtual bool overlay(RenderableList& renderlist) = 0;
 
     /**
      * Returns a transformation that the renderer must apply to all rendering.
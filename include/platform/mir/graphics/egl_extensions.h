@@ -48,6 +48,8 @@
 #include <mutex>
 #include <atomic>
 
+#include "mir/geometry/rectangles.h"
+
 #include <boost/throw_exception.hpp>
 
 #define EGL_EGLEXT_PROTOTYPES
@@ -185,6 +187,16 @@ typedef EGLBoolean (EGLAPIENTRYP PFNEGLQUERYDMABUFFORMATSEXTPROC) (EGLDisplay dp
 typedef EGLBoolean (EGLAPIENTRYP PFNEGLQUERYDMABUFMODIFIERSEXTPROC) (EGLDisplay dpy, EGLint format, EGLint max_modifiers, EGLuint64KHR *modifiers, EGLBoolean *external_only, EGLint *num_modifiers);
 #endif /* EGL_EXT_image_dma_buf_import_modifiers */
 
+#ifndef EGL_KHR_swap_buffers_with_damage
+#define EGL_KHR_swap_buffers_with_damage 1
+typedef EGLBoolean (EGLAPIENTRYP PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC) (EGLDisplay dpy, EGLSurface surface, const EGLint *rects, EGLint n_rects);
+#endif /* EGL_KHR_swap_buffers_with_damage */
+
+#ifndef EGL_EXT_buffer_age
+#define EGL_EXT_buffer_age 1
+#define EGL_BUFFER_AGE_EXT                0x313D
+#endif /* EGL_EXT_buffer_age */
+
 /*
  * Just enough polyfill for rawhide headers...
  */
@@ -214,10 +226,14 @@ EGLAPI EGLBoolean EGLAPIENTRY eglQueryWaylandBufferWL (EGLDisplay dpy, struct wl
 #endif /* EGL_WL_bind_wayland_display */
 }
 
+struct wl_buffer;
+
 namespace mir
 {
 namespace graphics
 {
+class DMABufBuffer;
+
 struct EGLExtensions
 {
     template<typename Ext>
@@ -317,6 +333,44 @@ struct EGLExtensions
         PFNEGLQUERYDMABUFFORMATSEXTPROC const eglQueryDmaBufFormatsExt;
         PFNEGLQUERYDMABUFMODIFIERSEXTPROC const eglQueryDmaBufModifiersExt;
     };
+
+    /// EGL_KHR_swap_buffers_with_damage or, failing that, EGL_EXT_swap_buffers_with_damage
+    struct SwapBuffersWithDamage
+    {
+        SwapBuffersWithDamage(EGLDisplay dpy);
+
+        static auto maybe_swap_buffers_with_damage(EGLDisplay dpy) -> std::optional<SwapBuffersWithDamage>;
+
+        /**
+         * Swap \a surface, hinting that only \a damage (in surface pixels,
+         * with the origin at the top-left) has changed since the last swap.
+         */
+        auto operator()(EGLDisplay dpy, EGLSurface surface, geometry::Rectangles const& damage) const -> EGLBoolean;
+
+        PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC const eglSwapBuffersWithDamage;
+    };
+
+    /// EGL_WL_create_wayland_buffer_from_image, with the EGL_EXT_image_dma_buf_import it needs here
+    struct WaylandBufferFromImage
+    {
+        // Mesa and Khronos headers disagree on the name of this typedef, so we have our own
+        using CreateWaylandBufferFromImageProc = struct wl_buffer* (EGLAPIENTRYP)(EGLDisplay dpy, EGLImageKHR image);
+
+        WaylandBufferFromImage(EGLDisplay dpy);
+
+        static auto maybe_wayland_buffer_from_image(EGLDisplay dpy) -> std::optional<WaylandBufferFromImage>;
+
+        /**
+         * Create a wl_buffer, for the Wayland connection \a dpy was created on, sharing
+         * the dma-bufs of \a buffer.
+         * \return null if \a dpy can't import the buffer
+         */
+        auto operator()(EGLDisplay dpy, DMABufBuffer const& buffer) const -> struct wl_buffer*;
+
+        PFNEGLCREATEIMAGEKHRPROC const eglCreateImageKHR;
+        PFNEGLDESTROYIMAGEKHRPROC const eglDestroyImageKHR;
+        CreateWaylandBufferFromImageProc const eglCreateWaylandBufferFromImageWL;
+    };
 };
 
 }
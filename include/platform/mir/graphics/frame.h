@@ -40,6 +40,7 @@ struct Frame
 
     int64_t msc = 0;   /**< Media Stream Counter */
     Timestamp ust;     /**< Unadjusted System Time */
+    bool hardware = false; /**< msc and ust were reported by the display hardware, not estimated */
 };
 
 }} // namespace mir::graphics
@@ -20,7 +20,9 @@
 #define MIR_GRAPHICS_GRAPHIC_BUFFER_ALLOCATOR_H_
 
 #include "mir/graphics/buffer.h"
+#include "mir/geometry/rectangles.h"
 
+#include <experimental/optional>
 #include <vector>
 #include <memory>
 #include <functional>
@@ -37,6 +39,15 @@ namespace graphics
 
 struct BufferProperties;
 
+/// Where a client surface sits on screen, as far as scanning its buffers out goes
+struct ScanoutPlacement
+{
+    /// The view area of the output the surface is shown on
+    geometry::Rectangle output_area;
+    /// Whether the surface covers the whole output, rather than fitting somewhere inside it
+    bool fullscreen;
+};
+
 /**
  * Interface to graphic buffer allocation.
  */
@@ -85,10 +96,40 @@ public:
         std::function<void()>&& on_consumed,
         std::function<void()>&& on_release) = 0;
 
+    /**
+     * Import a wl_shm buffer
+     *
+     * \param buffer [in]           The wl_shm buffer to import
+     * \param wayland_executor [in] An Executor that spawns tasks on the Wayland event loop
+     * \param on_consumed [in]      Called when the compositor has consumed the buffer
+     * \param previous [in]         The buffer this replaces on the same surface (may be null).
+     *                              Implementations can reuse its resources, such as a texture.
+     * \param damage [in]           The area changed since \a previous, in buffer coordinates
+     *                              (nullopt if unknown)
+     */
     virtual auto buffer_from_shm(
         wl_resource* buffer,
         std::shared_ptr<mir::Executor> wayland_executor,
-        std::function<void()>&& on_consumed) -> std::shared_ptr<Buffer> = 0;
+        std::function<void()>&& on_consumed,
+        std::shared_ptr<Buffer> const& previous,
+        std::experimental::optional<geometry::Rectangles> const& damage) -> std::shared_ptr<Buffer> = 0;
+
+    /**
+     * Tell the allocator where a client surface now is, so it can suggest buffers the output
+     * could scan out directly (through linux-dmabuf feedback, for instance)
+     *
+     * Platforms that can't scan out client buffers can ignore this.
+     *
+     * \param surface [in]     The wl_surface
+     * \param placement [in]   The output the surface is on, or nullopt if it doesn't fit on any
+     *                         single output and so is always composited
+     * \note   Called on the Wayland event loop.
+     */
+    virtual void surface_placed(
+        wl_resource* /*surface*/,
+        std::experimental::optional<ScanoutPlacement> const& /*placement*/)
+    {
+    }
 
 protected:
     GraphicBufferAllocator() = default;
@@ -26,6 +26,11 @@
 #include "mir/graphics/buffer.h"
 #include "mir/graphics/egl_extensions.h"
 
+#include <experimental/optional>
+#include <functional>
+#include <vector>
+#include <sys/types.h>
+
 
 namespace mir
 {
@@ -51,7 +56,8 @@ public:
         wl_display* display,
         EGLDisplay dpy,
         std::shared_ptr<EGLExtensions> egl_extensions,
-        EGLExtensions::EXTImageDmaBufImportModifiers const& dmabuf_ext);
+        EGLExtensions::EXTImageDmaBufImportModifiers const& dmabuf_ext,
+        std::shared_ptr<Executor> wayland_executor);
 
     std::shared_ptr<Buffer> buffer_from_resource(
         wl_resource* buffer,
@@ -60,13 +66,39 @@ public:
         std::function<void()>&& on_release,
         std::shared_ptr<Executor> wayland_executor);
 
+    /// Buffers a device could scan out, preferred over those that can only be composited
+    struct ScanoutTranche
+    {
+        /// The device doing the scanout
+        dev_t device;
+        /// The modifiers the device can scan out buffers of DRM format with
+        std::function<std::vector<uint64_t>(uint32_t format)> modifiers;
+    };
+
+    /**
+     * Offer \a surface's feedback objects buffers that \a tranche could scan out, or
+     * stop offering them if \a tranche is nullopt
+     *
+     * Only formats and modifiers clients can already import are offered. Feedback is
+     * resent only when what is offered changes.
+     *
+     * \note   Must be called on the Wayland event loop
+     */
+    void set_scanout_tranche(wl_resource* surface, std::experimental::optional<ScanoutTranche> const& tranche);
+
 private:
     class Instance;
+    class Feedback;
+    class Feedbacks;
     void bind(wl_resource* new_resource) override;
 
     EGLDisplay const dpy;
     std::shared_ptr<EGLExtensions> const egl_extensions;
     std::shared_ptr<DmaBufFormatDescriptors> const formats;
+    std::shared_ptr<Feedbacks> const feedbacks;
+    /// Imports the dmabufs of asynchronously created buffers, off the Wayland thread
+    std::shared_ptr<Executor> const importer;
+    std::shared_ptr<Executor> const wayland_executor;
 };
 
 }
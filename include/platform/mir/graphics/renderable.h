@@ -21,6 +21,8 @@
 
 #include <experimental/optional>
 #include <mir/geometry/rectangle.h>
+#include <mir/geometry/rectangle_f.h>
+#include <mir/geometry/rectangles.h>
 #include <glm/glm.hpp>
 #include <memory>
 #include <vector>
@@ -50,6 +52,13 @@ public:
     virtual std::shared_ptr<Buffer> buffer() const = 0;
 
     virtual geometry::Rectangle screen_position() const = 0;
+
+    /**
+     * The area of buffer() (in buffer pixels) that is shown, scaled to fill
+     * screen_position(). Usually the whole buffer, but a client may crop it.
+     */
+    virtual geometry::RectangleF src_bounds() const = 0;
+
     virtual std::experimental::optional<geometry::Rectangle> clip_area() const = 0;
 
     // These are from the old CompositingCriteria. There is a little bit
@@ -73,6 +82,27 @@ public:
     virtual bool shaped() const = 0;  // meaning the pixel format has alpha
 
     virtual unsigned int swap_interval() const = 0;
+
+    /**
+     * Whether the client would rather buffer() were shown as soon as possible,
+     * even if that tears, than wait for vblank.
+     */
+    virtual bool tearing_allowed() const = 0;
+
+    /**
+     * The area (in screen coordinates) in which buffer() differs from the
+     * buffer this renderable's content was last composited with.
+     *
+     * \returns nullopt if the damage is unknown, in which case the whole
+     *          screen_position() must be assumed to have changed.
+     */
+    virtual std::experimental::optional<geometry::Rectangles> damage() const = 0;
+
+    /**
+     * The area (in screen coordinates) in which buffer() is known to be fully
+     * opaque, even though shaped() says its pixel format has alpha.
+     */
+    virtual geometry::Rectangles opaque_region() const = 0;
 protected:
     Renderable() = default;
     Renderable(Renderable const&) = delete;
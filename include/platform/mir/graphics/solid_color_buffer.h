@@ -0,0 +1,46 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_SOLID_COLOR_BUFFER_H_
+#define MIR_GRAPHICS_SOLID_COLOR_BUFFER_H_
+
+#include "mir/graphics/buffer.h"
+
+#include <array>
+
+namespace mir
+{
+namespace graphics
+{
+/**
+ * A buffer that is one color throughout, so has no pixels to upload or sample.
+ *
+ * Renderers can fill its screen_position() with color() directly.
+ */
+class SolidColorBuffer : public NativeBufferBase
+{
+public:
+    virtual ~SolidColorBuffer() = default;
+
+    /**
+     * The color as premultiplied RGBA, each component in [0, 1]
+     */
+    virtual auto color() const -> std::array<float, 4> = 0;
+};
+}
+}
+
+#endif //MIR_GRAPHICS_SOLID_COLOR_BUFFER_H_
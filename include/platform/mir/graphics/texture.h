@@ -79,6 +79,29 @@ public:
      */
     virtual void add_syncpoint() = 0;
 };
+
+/**
+ * A texture whose GPU memory can be released while it isn't being drawn
+ *
+ * The texture is recreated, from the buffer's content, the next time it's bound.
+ */
+class ReleasableTexture
+{
+public:
+    /**
+     * Release the texture's GPU memory, if the platform is short of it
+     *
+     * Called when the buffer's surface is hidden, minimized or occluded, so
+     * the texture isn't expected to be drawn for a while.
+     */
+    virtual void release_texture() = 0;
+
+protected:
+    ReleasableTexture() = default;
+    virtual ~ReleasableTexture() = default;
+    ReleasableTexture(ReleasableTexture const&) = delete;
+    ReleasableTexture& operator=(ReleasableTexture const&) = delete;
+};
 }
 }
 }
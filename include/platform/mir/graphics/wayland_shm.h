@@ -0,0 +1,110 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_WAYLAND_SHM_H_
+#define MIR_GRAPHICS_WAYLAND_SHM_H_
+
+#include "mir/geometry/size.h"
+#include "mir/geometry/dimensions.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+struct wl_display;
+struct wl_resource;
+
+namespace mir
+{
+namespace graphics
+{
+/**
+ * The pixels of a wl_buffer created from Mir's wl_shm
+ *
+ * Each wl_shm_pool is mapped once (writable, unless the client passed a file we
+ * can only read) and shared by every buffer carved from it. This keeps the mapping
+ * alive, so the content can be read from any thread (even once the wl_buffer itself
+ * has been destroyed) without locking.
+ */
+class WlShmBufferContent
+{
+public:
+    class Mapping;
+
+    WlShmBufferContent(
+        std::shared_ptr<Mapping const> mapping,
+        size_t offset,
+        geometry::Size size,
+        geometry::Stride stride,
+        uint32_t format);
+
+    auto size() const -> geometry::Size { return size_; }
+    auto stride() const -> geometry::Stride { return stride_; }
+    /// One of the WL_SHM_FORMAT_* values
+    auto format() const -> uint32_t { return format_; }
+
+    /**
+     * Calls do_with_pixels with the content
+     *
+     * If the client has sealed its pool against shrinking this is a plain memory
+     * read. Otherwise it's protected against the client truncating the pool under
+     * us; if that happens the pool reads as zeros from then on.
+     */
+    void read(std::function<void(unsigned char const*)> const& do_with_pixels) const;
+
+    /// Whether the client's pool can be written to (for protocols where we fill its buffers)
+    auto writable() const -> bool;
+
+    /**
+     * Calls do_with_pixels with the content, to write to
+     *
+     * This has the same protection as read(): writes to a pool the client has truncated
+     * go nowhere.
+     *
+     * \throws std::logic_error if the content isn't writable()
+     */
+    void write(std::function<void(unsigned char*)> const& do_with_pixels) const;
+
+private:
+    /// Runs use_pixels, recovering from the client truncating the pool under it
+    void guard(std::function<void()> const& use_pixels) const;
+
+    std::shared_ptr<Mapping const> const mapping;
+    size_t const offset;
+    geometry::Size const size_;
+    geometry::Stride const stride_;
+    uint32_t const format_;
+};
+
+/**
+ * Creates Mir's wl_shm global, in place of libwayland's wl_display_init_shm()
+ *
+ * \param client_limit The most bytes of wl_shm_pool each client may have mapped (0 for no limit). A client that
+ *                     tries to exceed it is disconnected.
+ */
+auto create_wl_shm(wl_display* display, size_t client_limit) -> std::shared_ptr<void>;
+
+/**
+ * The content of \a buffer, or nullptr if it isn't from wl_shm
+ *
+ * \note This must be called on the Wayland thread
+ */
+auto wl_shm_buffer_content(wl_resource* buffer) -> std::shared_ptr<WlShmBufferContent const>;
+}
+}
+
+#endif // MIR_GRAPHICS_WAYLAND_SHM_H_
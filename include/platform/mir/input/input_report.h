@@ -41,6 +41,24 @@ public:
     virtual void opened_input_device(char const* device_name, char const* input_platform) = 0;
     virtual void failed_to_open_input_device(char const* device_name, char const* input_platform) = 0;
 
+    /// The stages of an input event's way through the server, after received_event_from_kernel()
+    enum class Stage
+    {
+        seat,       ///< Accepted by the seat, from the input platform via the device hub
+        dispatcher, ///< Taken by the input dispatcher (a filter, or the surface it was sent to)
+        client      ///< Sent to the client, to be flushed by the frontend's event loop
+    };
+
+    /**
+     * An input event reached \a stage
+     *
+     * \param event_time The event's timestamp from the kernel, which identifies it at every stage
+     */
+    virtual void event_reached_stage(Stage stage, int64_t event_time) = 0;
+
+    /// An input event went no further than \a stage (it was filtered out, or had nowhere to go)
+    virtual void event_dropped(Stage stage, int64_t event_time) = 0;
+
 protected:
     InputReport() = default;
     InputReport(InputReport const&) = delete;
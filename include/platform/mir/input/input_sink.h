@@ -26,6 +26,7 @@
 
 #include <vector>
 #include <array>
+#include <memory>
 
 namespace mir
 {
@@ -94,6 +95,18 @@ public:
     /**
      * \}
      */
+
+    /**
+     * Handles events that the device produced together, in order.
+     *
+     * The default just passes them to handle_input() one at a time; sinks that can take their locks once for the
+     * whole batch should override it.
+     */
+    virtual void handle_input_batch(std::vector<std::shared_ptr<MirEvent>> const& events)
+    {
+        for (auto const& event : events)
+            handle_input(event);
+    }
 private:
     InputSink(InputSink const&) = delete;
     InputSink& operator=(InputSink const&) = delete;
@@ -43,26 +43,54 @@ extern char const* const connector_report_opt;
 extern char const* const scene_report_opt;
 extern char const* const input_report_opt;
 extern char const* const seat_report_opt;
+extern char const* const startup_report_opt;
+extern char const* const memory_report_opt;
+extern char const* const memory_report_interval_opt;
+extern char const* const lock_report_opt;
+extern char const* const lock_report_interval_opt;
+extern char const* const scene_record_opt;
+extern char const* const scene_replay_opt;
+extern char const* const performance_hud_opt;
 extern char const* const touchspots_opt;
 extern char const* const cursor_opt;
 extern char const* const fatal_except_opt;
 extern char const* const debug_opt;
 extern char const* const composite_delay_opt;
+extern char const* const opaque_front_to_back_opt;
+extern char const* const renderer_opt;
 extern char const* const enable_key_repeat_opt;
 extern char const* const x11_display_opt;
 extern char const* const x11_scale_opt;
 extern char const* const wayland_extensions_opt;
 extern char const* const add_wayland_extensions_opt;
 extern char const* const drop_wayland_extensions_opt;
+extern char const* const wayland_pointer_motion_rate_opt;
+extern char const* const wayland_shm_client_limit_opt;
+extern char const* const wayland_request_report_opt;
+extern char const* const wayland_request_report_interval_opt;
+extern char const* const input_thread_priority_opt;
+extern char const* const input_thread_cpus_opt;
+extern char const* const compositor_thread_priority_opt;
+extern char const* const compositor_thread_cpus_opt;
+extern char const* const thread_scheduling_opt;
+extern char const* const app_scheduling_opt;
+extern char const* const lock_memory_opt;
+extern char const* const async_logging_opt;
+extern char const* const log_rate_limit_opt;
+extern char const* const metrics_socket_opt;
+extern char const* const timer_slack_opt;
+extern char const* const input_resample_rate_opt;
 extern char const* const enable_mirclient_opt;
 
 extern char const* const offscreen_opt;
+extern char const* const offscreen_refresh_rate_opt;
 
 extern char const* const enable_key_repeat_opt;
 
 extern char const* const off_opt_value;
 extern char const* const log_opt_value;
 extern char const* const lttng_opt_value;
+extern char const* const metrics_opt_value;
 
 extern char const* const platform_graphics_lib;
 extern char const* const platform_input_lib;
@@ -75,6 +103,11 @@ extern char const* const null_console;
 extern char const* const auto_console;
 
 extern char const* const vt_option_name;
+extern char const* const seat_opt;
+
+extern char const* const main_loop_opt;
+extern char const* const glib_main_loop;
+extern char const* const epoll_main_loop;
 
 class Configuration
 {
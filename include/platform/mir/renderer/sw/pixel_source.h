@@ -147,6 +147,15 @@ public:
 auto as_read_mappable_buffer(
     std::shared_ptr<graphics::Buffer> const& buffer) -> std::shared_ptr<ReadMappableBuffer>;
 
+/**
+ * A CPU-writeable view of a buffer, such as one from GraphicBufferAllocator::alloc_software_buffer()
+ *
+ * Buffers that can't be mapped directly are written through a copy when the mapping is destroyed.
+ * \throws std::runtime_error if the buffer doesn't support CPU access
+ */
+auto as_write_mappable_buffer(
+    std::shared_ptr<graphics::Buffer> const& buffer) -> std::shared_ptr<WriteMappableBuffer>;
+
 auto alloc_buffer_with_content(
     graphics::GraphicBufferAllocator& allocator,
     unsigned char const* content,
@@ -0,0 +1,67 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_RENDERER_SW_RENDER_TARGET_H_
+#define MIR_RENDERER_SW_RENDER_TARGET_H_
+
+#include "mir/renderer/sw/pixel_source.h"
+#include "mir/geometry/rectangles.h"
+
+#include <memory>
+
+namespace mir
+{
+namespace renderer
+{
+namespace software
+{
+
+/**
+ * A display buffer that can be composited into by the CPU.
+ *
+ * Display buffers offer this through graphics::DisplayBuffer::native_display_buffer().
+ */
+class RenderTarget
+{
+public:
+    virtual ~RenderTarget() = default;
+
+    /**
+     * Map the framebuffer for drawing the next frame.
+     *
+     * The mapping holds the most recently posted frame, so only pixels that
+     * changed need to be redrawn.
+     */
+    virtual auto map_framebuffer() -> std::unique_ptr<Mapping<unsigned char>> = 0;
+
+    /**
+     * Present the framebuffer, hinting that only \a damage (in framebuffer
+     * pixels, with the origin at the top-left) differs from the previous frame.
+     * Must be called once the mapping from map_framebuffer() is released.
+     */
+    virtual void post(geometry::Rectangles const& damage) = 0;
+
+protected:
+    RenderTarget() = default;
+    RenderTarget(RenderTarget const&) = delete;
+    RenderTarget& operator=(RenderTarget const&) = delete;
+};
+
+}
+}
+}
+
+#endif // MIR_RENDERER_SW_RENDER_TARGET_H_
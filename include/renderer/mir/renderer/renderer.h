@@ -20,10 +20,16 @@
 #define MIR_RENDERER_RENDERER_H_
 
 #include "mir/geometry/rectangle.h"
+#include "mir/geometry/rectangles.h"
+#include "mir/geometry/dimensions.h"
 #include "mir/graphics/renderable.h"
 #include "mir_toolkit/common.h"
 #include <glm/glm.hpp>
 
+#include <chrono>
+#include <experimental/optional>
+#include <functional>
+
 namespace mir
 {
 namespace renderer
@@ -36,9 +42,33 @@ public:
 
     virtual void set_viewport(geometry::Rectangle const& rect) = 0;
     virtual void set_output_transform(glm::mat2 const&) = 0;
+    /**
+     * Declare that only \a damage (in screen coordinates) has changed since
+     * the previous render(). This applies to the next render() only; without
+     * it the whole viewport is assumed to have changed.
+     */
+    virtual void set_damage(geometry::Rectangles const& damage) = 0;
     virtual void render(graphics::RenderableList const&) const = 0;
     virtual void suspend() = 0; // called when render() is skipped
 
+    /**
+     * How long the GPU spent executing a recent render(), if the renderer can
+     * measure it. Measurements arrive a frame or more after their render(),
+     * and each is returned only once.
+     */
+    virtual auto gpu_render_time() -> std::experimental::optional<std::chrono::nanoseconds> = 0;
+
+    /// Receives pixels read back from a frame: rows of 0xAARRGGBB pixels, top row first.
+    /// An empty size means the area couldn't be read.
+    using FrameReader = std::function<void(geometry::Size const& size, geometry::Stride stride, void const* pixels)>;
+
+    /**
+     * Read \a area (in screen coordinates) of the next render() back, just
+     * before it goes to the screen, and pass it to \a reader during that
+     * render(). This applies to the next render() only.
+     */
+    virtual void read_next_frame(geometry::Rectangle const& area, FrameReader const& reader) = 0;
+
 protected:
     Renderer() = default;
     Renderer(const Renderer&) = delete;
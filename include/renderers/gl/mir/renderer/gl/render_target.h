@@ -19,6 +19,8 @@
 #ifndef MIR_RENDERER_GL_RENDER_TARGET_H_
 #define MIR_RENDERER_GL_RENDER_TARGET_H_
 
+#include "mir/geometry/rectangles.h"
+
 namespace mir
 {
 namespace renderer
@@ -41,6 +43,12 @@ public:
      * free GL-related resources such as textures and buffers.
      */
     virtual void swap_buffers() = 0;
+    /**
+     * As swap_buffers(), but hinting that only \a damage (in render target
+     * pixels, with the origin at the top-left) differs from the previously
+     * swapped frame. Implementations are free to present the whole frame.
+     */
+    virtual void swap_buffers_with_damage(geometry::Rectangles const& damage) = 0;
     /** Binds any necessary resources (fbos, textures if any)
      * in preparation for drawing.
      */
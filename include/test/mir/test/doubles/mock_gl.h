@@ -51,6 +51,7 @@ public:
     MOCK_METHOD1(glCheckFramebufferStatus, GLenum(GLenum));
     MOCK_METHOD1(glClear, void(GLbitfield));
     MOCK_METHOD4(glClearColor, void(GLclampf, GLclampf, GLclampf, GLclampf));
+    MOCK_METHOD1(glClearDepthf, void(GLclampf));
     MOCK_METHOD4(glColorMask, void(GLboolean, GLboolean, GLboolean, GLboolean));
     MOCK_METHOD1(glCompileShader, void(GLuint));
     MOCK_METHOD0(glCreateProgram, GLuint());
@@ -61,12 +62,16 @@ public:
     MOCK_METHOD1(glDeleteProgram, void(GLuint));
     MOCK_METHOD1(glDeleteShader, void(GLuint));
     MOCK_METHOD2(glDeleteTextures, void(GLsizei, const GLuint *));
+    MOCK_METHOD1(glDepthFunc, void(GLenum));
+    MOCK_METHOD1(glDepthMask, void(GLboolean));
+    MOCK_METHOD2(glDepthRangef, void(GLclampf, GLclampf));
     MOCK_METHOD1(glDisable, void(GLenum));
     MOCK_METHOD1(glDisableVertexAttribArray, void(GLuint));
     MOCK_METHOD3(glDrawArrays, void(GLenum, GLint, GLsizei));
     MOCK_METHOD1(glEnable, void(GLenum));
     MOCK_METHOD1(glEnableVertexAttribArray, void(GLuint));
     MOCK_METHOD0(glFinish, void());
+    MOCK_METHOD0(glFlush, void());
     MOCK_METHOD4(glFramebufferRenderbuffer,
                  void(GLenum, GLenum, GLenum, GLuint));
     MOCK_METHOD5(glFramebufferTexture2D,
@@ -98,9 +103,13 @@ public:
     MOCK_METHOD9(glTexImage2D,
                  void(GLenum, GLint, GLint, GLsizei, GLsizei, GLint, GLenum,
                       GLenum,const GLvoid*));
+    MOCK_METHOD9(glTexSubImage2D,
+                 void(GLenum, GLint, GLint, GLint, GLsizei, GLsizei, GLenum,
+                      GLenum, const GLvoid*));
     MOCK_METHOD3(glTexParameteri, void(GLenum, GLenum, GLenum));
     MOCK_METHOD2(glUniform1f, void(GLint, GLfloat));
     MOCK_METHOD3(glUniform2f, void(GLint, GLfloat, GLfloat));
+    MOCK_METHOD5(glUniform4f, void(GLint, GLfloat, GLfloat, GLfloat, GLfloat));
     MOCK_METHOD2(glUniform1i, void(GLint, GLint));
     MOCK_METHOD4(glUniformMatrix4fv,
                  void(GLuint, GLsizei, GLboolean, const GLfloat *));
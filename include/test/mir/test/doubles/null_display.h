@@ -51,6 +51,20 @@ class NullDisplay : public graphics::Display
         return false;
     }
     void configure(graphics::DisplayConfiguration const&)  override{}
+    void configure_incrementally(
+        graphics::DisplayConfiguration const& conf,
+        std::function<void(graphics::DisplaySyncGroup&)> const& release) override
+    {
+        for_each_display_sync_group(release);
+        configure(conf);
+    }
+    bool apply_if_configuration_only_changes_power_modes(
+        graphics::DisplayConfiguration const&,
+        std::function<void(graphics::DisplaySyncGroup&)> const&,
+        std::function<void(graphics::DisplaySyncGroup&)> const&) override
+    {
+        return false;
+    }
     void register_configuration_change_handler(
         graphics::EventHandlerRegister&,
         graphics::DisplayConfigurationChangeHandler const&) override
@@ -38,6 +38,11 @@ struct StubSession : scene::Session
 
     void take_snapshot(scene::SnapshotCallback const& snapshot_taken) override;
 
+    void take_thumbnail_of(
+        std::shared_ptr<scene::Surface> const& surface,
+        geometry::Size const& max_size,
+        scene::SnapshotCallback const& thumbnail_taken) override;
+
     std::shared_ptr<scene::Surface> default_surface() const override;
 
     void set_lifecycle_state(MirLifecycleState state) override;
@@ -64,11 +64,18 @@ struct StubSurface : scene::Surface
     std::shared_ptr<Surface> parent() const override { return nullptr; }
     void add_observer(std::shared_ptr<scene::SurfaceObserver> const&) override {}
     void remove_observer(std::weak_ptr<scene::SurfaceObserver> const&) override {}
+    void begin_batched_changes() override {}
+    void end_batched_changes() override {}
     void set_keymap(MirInputDeviceId, std::string const&, std::string const&, std::string const&,
                     std::string const&) override {}
     void rename(std::string const&) override {}
     void set_confine_pointer_state(MirPointerConfinementState) override {}
     MirPointerConfinementState confine_pointer_state() const override { return mir_pointer_unconfined; }
+    void set_tearing_allowed(bool) override {}
+    bool tearing_allowed() const override { return false; }
+    void set_max_frame_rate(float) override {}
+    float max_frame_rate() const override { return 0; }
+    void presented(graphics::Renderable::ID, compositor::Presentation const&) override {}
     void placed_relative(geometry::Rectangle const&) override {}
     void start_drag_and_drop(std::vector<uint8_t> const&) override {}
     MirDepthLayer depth_layer() const override { return mir_depth_layer_application; }
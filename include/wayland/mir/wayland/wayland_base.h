@@ -107,6 +107,7 @@ public:
     };
 
     Resource();
+    ~Resource();
 };
 
 /// A weak handle to a Wayland resource (or any Destroyable)
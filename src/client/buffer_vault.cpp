@@ -45,6 +45,11 @@ enum class mcl::BufferVault::Owner
 
 namespace
 {
+/// Once every withdraw() in this many has left a buffer spare, that buffer is freed
+unsigned int const spare_withdrawals_before_shrinking{120};
+/// Triple-buffering is enough for any client that can keep up at all
+size_t const max_adaptive_buffer_count{3};
+
 void ignore_buffer(MirBuffer*, void*)
 {
 }
@@ -192,6 +197,12 @@ mcl::BufferVault::BufferMap::iterator mcl::BufferVault::available_buffer()
     return it;
 }
 
+mcl::BufferVault::BufferMap::iterator mcl::BufferVault::spare_buffer()
+{
+    return std::find_if(buffers.begin(), buffers.end(),
+        [](std::pair<int, Owner> const& entry) { return entry.second == Owner::Self; });
+}
+
 mcl::NoTLSFuture<std::shared_ptr<mcl::MirBuffer>> mcl::BufferVault::withdraw()
 {
     std::vector<int> free_ids;
@@ -222,12 +233,35 @@ mcl::NoTLSFuture<std::shared_ptr<mcl::MirBuffer>> mcl::BufferVault::withdraw()
     {
         it->second = Owner::ContentProducer;
         promise.set_value(checked_buffer_from_map(it->first));
+
+        auto const spare = spare_buffer();
+        if (spare != buffers.end() && interval != 0 && needed_buffer_count > initial_buffer_count)
+        {
+            if (++spare_withdrawals >= spare_withdrawals_before_shrinking)
+            {
+                // The client keeps up without the extra buffer: give its memory back
+                spare_withdrawals = 0;
+                needed_buffer_count--;
+                current_buffer_count--;
+                free_ids.push_back(spare->first);
+                buffers.erase(spare);
+            }
+        }
+        else
+        {
+            spare_withdrawals = 0;
+        }
         lk.unlock();
     }
     else
     {
         promises.emplace_back(std::move(promise));
 
+        // The client is missing a frame waiting for the server to return a buffer
+        spare_withdrawals = 0;
+        if (interval != 0 && needed_buffer_count < std::max(initial_buffer_count, max_adaptive_buffer_count))
+            needed_buffer_count++;
+
         auto s = size;
         bool allocate_buffer = (current_buffer_count <  needed_buffer_count);
         if (allocate_buffer)
@@ -382,6 +416,7 @@ void mcl::BufferVault::set_interval(int i)
     if (i == interval)
         return;
     interval = i;
+    spare_withdrawals = 0;
 
     if (i == 0)
     {
@@ -53,6 +53,13 @@ protected:
 
 class ClientBufferFactory;
 
+/**
+ * Tracks the buffers of a client's stream
+ *
+ * The vault starts with the requested number of buffers, growing by one (up to triple-buffering) when
+ * the client has to wait for the server to return one, and shrinking back once the extra buffer has
+ * gone unused for a while.
+ */
 class BufferVault
 {
 public:
@@ -79,6 +86,8 @@ private:
     enum class Owner;
     typedef std::map<int, Owner> BufferMap;
     BufferMap::iterator available_buffer();
+    /// A buffer nothing is using, if there is one
+    BufferMap::iterator spare_buffer();
     void trigger_callback(std::unique_lock<std::mutex> lk);
 
     void alloc_buffer(geometry::Size size, MirPixelFormat format, int usage);
@@ -105,6 +114,7 @@ private:
     size_t needed_buffer_count;
     size_t const initial_buffer_count;
     int last_received_id = 0;
+    unsigned int spare_withdrawals = 0;
     int interval = 1;
     MirWaitHandle swap_buffers_wait_handle;
     std::function<void()> deferred_cb;
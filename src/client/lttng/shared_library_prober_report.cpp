@@ -48,3 +48,9 @@ void mcl::lttng::SharedLibraryProberReport::loading_failed(boost::filesystem::pa
     mir_tracepoint(mir_client_shared_library_prober, loading_failed,
                    filename.string().c_str(), error.what());
 }
+
+void mcl::lttng::SharedLibraryProberReport::library_skipped(boost::filesystem::path const& filename, std::string const& requirement)
+{
+    mir_tracepoint(mir_client_shared_library_prober, library_skipped,
+                   filename.string().c_str(), requirement.c_str());
+}
@@ -76,6 +76,16 @@ TRACEPOINT_EVENT(
     )
 )
 
+TRACEPOINT_EVENT(
+    mir_client_shared_library_prober,
+    library_skipped,
+    TP_ARGS(const char*, path, const char*, requirement),
+    TP_FIELDS(
+        ctf_string(path, path)
+        ctf_string(requirement, requirement)
+    )
+)
+
 #ifdef __clang__
 #pragma clang diagnostic pop
 #endif
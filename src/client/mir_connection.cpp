@@ -98,12 +98,19 @@ make_perf_report(std::shared_ptr<ml::Logger> const& logger)
 
 size_t get_nbuffers_from_env()
 {
-    //TODO: (kdub) cannot set nbuffers == 2 in production until we have client-side
-    //      timeout-based overallocation for timeout-based framedropping.
+    // Streams start double-buffered, and BufferVault adds a third buffer for clients that miss
+    // frames without one. MIR_CLIENT_NBUFFERS=3 keeps every stream triple-buffered.
     const char* nbuffers_opt = getenv("MIR_CLIENT_NBUFFERS");
-    if (nbuffers_opt && !strcmp(nbuffers_opt, "2"))
-        return 2u;
-    return 3u;
+    if (nbuffers_opt && !strcmp(nbuffers_opt, "3"))
+        return 3u;
+    return 2u;
+}
+
+bool event_ring_from_env()
+{
+    // Input events come through a ring shared with the server unless MIR_CLIENT_EVENT_RING=0
+    const char* event_ring_opt = getenv("MIR_CLIENT_EVENT_RING");
+    return !event_ring_opt || strcmp(event_ring_opt, "0");
 }
 
 struct OnScopeExit
@@ -654,6 +661,7 @@ MirWaitHandle* MirConnection::connect(
         std::lock_guard<decltype(mutex)> lock(mutex);
 
         connect_parameters->set_application_name(app_name);
+        connect_parameters->set_event_ring(event_ring_from_env());
         connect_wait_handle.expect_result();
     }
 
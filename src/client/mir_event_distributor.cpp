@@ -19,38 +19,55 @@
 #include "mir_event_distributor.h"
 
 MirEventDistributor::MirEventDistributor() :
+    event_handlers{std::make_shared<Handlers const>()},
     next_fn_id{0}
 {
 }
 
 int MirEventDistributor::register_event_handler(std::function<void(MirEvent const&)> const& fn)
 {
-    std::unique_lock<decltype(mutex)> lock(mutex);
+    std::lock_guard<decltype(mutex)> lock(mutex);
 
     int id = ++next_fn_id;
-    event_handlers[id] = fn;
+    auto updated = *std::atomic_load(&event_handlers);
+    updated[id] = std::make_shared<Handler>(fn);
+    std::atomic_store(&event_handlers, std::make_shared<Handlers const>(std::move(updated)));
     return id;
 }
 
 void MirEventDistributor::unregister_event_handler(int id)
 {
-    std::unique_lock<decltype(mutex)> lock(mutex);
+    std::shared_ptr<Handler> handler;
+    {
+        std::lock_guard<decltype(mutex)> lock(mutex);
+
+        auto updated = *std::atomic_load(&event_handlers);
+        auto const i = updated.find(id);
+        if (i == updated.end())
+            return;
+
+        handler = i->second;
+        updated.erase(i);
+        std::atomic_store(&event_handlers, std::make_shared<Handlers const>(std::move(updated)));
+    }
 
-    event_handlers.erase(id);
+    // Events dispatched from an older copy of the handlers may still reach it
+    std::lock_guard<decltype(handler->mutex)> lock(handler->mutex);
+    handler->registered = false;
 }
 
 void MirEventDistributor::handle_event(MirEvent const& event)
 {
-    std::unique_lock<decltype(mutex)> lock(mutex);
-
-    auto const event_handlers_copy(event_handlers);
+    auto const current = std::atomic_load(&event_handlers);
 
-    for (auto const& handler : event_handlers_copy)
+    for (auto const& handler : *current)
     {
-        // Ensure handler wasn't unregistered since making copy
-        if (event_handlers.find(handler.first) != event_handlers.end())
+        std::lock_guard<decltype(handler.second->mutex)> lock(handler.second->mutex);
+
+        // Ensure handler wasn't unregistered since taking the copy
+        if (handler.second->registered)
         {
-            handler.second(event);
+            handler.second->fn(event);
         }
     }
 }
@@ -20,6 +20,7 @@
 
 #include "event_distributor.h"
 
+#include <memory>
 #include <mutex>
 #include <map>
 
@@ -35,8 +36,23 @@ public:
     void handle_event(MirEvent const& event) override;
 
 private:
-    mutable std::recursive_mutex mutex;
-    std::map<int, std::function<void(MirEvent const&)>> event_handlers;
+    struct Handler
+    {
+        explicit Handler(std::function<void(MirEvent const&)> const& fn) : fn{fn} {}
+
+        std::function<void(MirEvent const&)> const fn;
+
+        /// Held while handling an event, so that unregistering waits for a call in progress on another thread
+        std::recursive_mutex mutex;
+        bool registered{true};
+    };
+    using Handlers = std::map<int, std::shared_ptr<Handler>>;
+
+    /// Serialises changes to the handlers
+    std::mutex mutex;
+
+    /// Only accessed through std::atomic_load() and std::atomic_store(), so events never wait on changes
+    std::shared_ptr<Handlers const> event_handlers;
     int next_fn_id;
 };
 
@@ -51,6 +51,83 @@ namespace md = mir::dispatch;
 
 using mir::client::FrameClock;
 
+/**
+ * Keeps a window's FrameClock in phase with the server's vsync on the window's output
+ *
+ * The server only reports frame timing when asked, so that idle clients are not woken by it. We ask when
+ * the window moves to an output, and again each time the FrameClock resyncs (which it does when the client
+ * starts drawing, or falls behind), so the next resync has a recent vsync to work from.
+ */
+class mcl::ServerVsync : public std::enable_shared_from_this<ServerVsync>
+{
+public:
+    ServerVsync(mclr::DisplayServer& server, std::weak_ptr<FrameClock> const& frame_clock) :
+        server{server},
+        frame_clock{frame_clock}
+    {
+    }
+
+    void track_output(uint32_t id)
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            output_id = id;
+        }
+        request_timing();
+    }
+
+private:
+    void request_timing()
+    {
+        mp::FrameTimingRequest request;
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            request.set_output_id(output_id);
+        }
+
+        auto const timing = std::make_shared<mp::FrameTiming>();
+        server.frame_timing(&request, timing.get(), gp::NewCallback(&ServerVsync::timing_received, shared_from_this(), timing));
+    }
+
+    static void timing_received(std::shared_ptr<ServerVsync> self, std::shared_ptr<mp::FrameTiming> timing)
+    {
+        // Nothing has been presented on the output yet, or it has gone
+        if (timing->has_error() || timing->ust() == 0)
+            return;
+
+        bool first_vsync;
+        {
+            std::lock_guard<std::mutex> lock{self->mutex};
+            self->last_vsync = mir::time::PosixTimestamp{timing->clock_id(), std::chrono::nanoseconds{timing->ust()}};
+            first_vsync = !self->have_vsync;
+            self->have_vsync = true;
+        }
+
+        // Until now the FrameClock guesses the phase; this also makes it resync on the next frame
+        if (first_vsync)
+        {
+            if (auto const clock = self->frame_clock.lock())
+                clock->set_resync_callback([self] { return self->resync(); });
+        }
+    }
+
+    mir::time::PosixTimestamp resync()
+    {
+        request_timing();
+
+        std::lock_guard<std::mutex> lock{mutex};
+        return last_vsync;
+    }
+
+    mclr::DisplayServer& server;
+    std::weak_ptr<FrameClock> const frame_clock;
+
+    std::mutex mutex;
+    uint32_t output_id{0};
+    bool have_vsync{false};
+    mir::time::PosixTimestamp last_vsync;
+};
+
 namespace
 {
 std::mutex handle_mutex;
@@ -140,6 +217,7 @@ MirSurface::MirSurface(
       keymapper(std::make_shared<mircv::XKBMapper>()),
       configure_result{mcl::make_protobuf_object<mir::protobuf::SurfaceSetting>()},
       frame_clock(std::make_shared<FrameClock>()),
+      server_vsync(std::make_shared<mcl::ServerVsync>(the_server, frame_clock)),
       creation_handle(handle),
       size({surface_proto.width(), surface_proto.height()}),
       format(static_cast<MirPixelFormat>(surface_proto.pixel_format())),
@@ -172,11 +250,11 @@ MirSurface::MirSurface(
 
     if (spec.event_handler.is_set())
     {
-        handle_event_callback = std::bind(
+        handle_event_callback = std::make_shared<EventCallback const>(std::bind(
             spec.event_handler.value().callback,
             this,
             std::placeholders::_1,
-            spec.event_handler.value().context);
+            spec.event_handler.value().context));
     }
 
     std::lock_guard<decltype(handle_mutex)> lock(handle_mutex);
@@ -214,12 +292,10 @@ MirSurface::~MirSurface()
 void MirSurface::configure_frame_clock()
 {
     /*
-     * TODO: Implement frame_clock->set_resync_callback(...) when IPC to get
-     *       timestamps from the server exists.
-     *       Until we do, client-side vsync will perform suboptimally (it is
-     *       randomly up to one frame out of phase with the real display).
-     *       However even while it's suboptimal it's dramatically lower latency
-     *       than the old approach and still totally eliminates nesting lag.
+     * The resync callback is set by server_vsync once the server has reported
+     * a vsync on the window's output. Until then client-side vsync is up to
+     * one frame out of phase with the real display, but it's still much
+     * lower latency than the old approach and totally eliminates nesting lag.
      */
 }
 
@@ -445,19 +521,49 @@ void MirSurface::set_event_handler(MirWindowEventCallback callback,
     std::lock_guard<decltype(mutex)> lock(mutex);
 
     input_thread.reset();
-    handle_event_callback = [](auto){};
+    std::shared_ptr<EventCallback const> updated;
 
     if (callback)
     {
-        handle_event_callback = std::bind(callback, this,
-                                          std::placeholders::_1,
-                                          context);
+        updated = std::make_shared<EventCallback const>(std::bind(callback, this,
+                                                                  std::placeholders::_1,
+                                                                  context));
     }
+    std::atomic_store(&handle_event_callback, updated);
 }
 
 void MirSurface::handle_event(MirEvent& e)
 {
-    std::unique_lock<decltype(mutex)> lock(mutex);
+    switch (mir_event_get_type(&e))
+    {
+    // The keymapper has a lock of its own, so input doesn't wait for anything holding the surface's
+    case mir_event_type_input:
+        keymapper->map_event(e);
+        break;
+    case mir_event_type_input_device_state:
+        apply_device_state(e, *keymapper);
+        break;
+    case mir_event_type_keymap:
+    {
+        char const* buffer = nullptr;
+        size_t length = 0;
+        auto keymap_event = mir_event_get_keymap_event(&e);
+        mir_keymap_event_get_keymap_buffer(keymap_event, &buffer, &length);
+        keymapper->set_keymap_for_all_devices(buffer, length);
+        break;
+    }
+    default:
+        if (!update_from(e))
+            return;
+    }
+
+    if (auto const callback = std::atomic_load(&handle_event_callback))
+        (*callback)(&e);
+}
+
+bool MirSurface::update_from(MirEvent& e)
+{
+    std::lock_guard<decltype(mutex)> lock(mutex);
 
     switch (mir_event_get_type(&e))
     {
@@ -472,28 +578,13 @@ void MirSurface::handle_event(MirEvent& e)
         else
         {
             handle_drag_and_drop_start_callback(sev);
-            return;
+            return false;
         }
         break;
     }
-    case mir_event_type_input:
-        keymapper->map_event(e);
-        break;
-    case mir_event_type_input_device_state:
-        apply_device_state(e, *keymapper);
-        break;
     case mir_event_type_orientation:
         orientation = mir_orientation_event_get_direction(mir_event_get_orientation_event(&e));
         break;
-    case mir_event_type_keymap:
-    {
-        char const* buffer = nullptr;
-        size_t length = 0;
-        auto keymap_event = mir_event_get_keymap_event(&e);
-        mir_keymap_event_get_keymap_buffer(keymap_event, &buffer, &length);
-        keymapper->set_keymap_for_all_devices(buffer, length);
-        break;
-    }
     case mir_event_type_resize:
     {
         auto resize_event = mir_event_get_resize_event(&e);
@@ -523,6 +614,9 @@ void MirSurface::handle_event(MirEvent& e)
                 static_cast<long>(1000000000L / rate));
             frame_clock->set_period(ns);
         }
+
+        if (server_vsync)
+            server_vsync->track_output(mir_window_output_event_get_output_id(soevent));
         /* else: The graphics driver has not provided valid timing so we will
          *       default to swap interval 0 behaviour.
          *       Or would people prefer some different fallback?
@@ -536,12 +630,7 @@ void MirSurface::handle_event(MirEvent& e)
         break;
     };
 
-    if (handle_event_callback)
-    {
-        auto callback = handle_event_callback;
-        lock.unlock();
-        callback(&e);
-    }
+    return true;
 }
 
 void MirSurface::request_and_wait_for_configure(MirWindowAttrib a, int value)
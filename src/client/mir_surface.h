@@ -71,6 +71,7 @@ class DisplayServerDebug;
 
 class ClientBuffer;
 class MirBufferStreamFactory;
+class ServerVsync;
 
 struct MemoryRegion;
 }
@@ -227,6 +228,8 @@ private:
     std::mutex mutable mutex; // Protects all members of *this
 
     void configure_frame_clock();
+    /// Applies a (non-input) event to the surface's state; false if the event goes no further
+    bool update_from(MirEvent& e);
     void on_configured();
     void on_cursor_configured();
     void acquired_persistent_id(MirWindowIdCallback callback, void* context);
@@ -264,8 +267,11 @@ private:
     MirOrientation orientation = mir_orientation_normal;
 
     std::shared_ptr<mir::client::FrameClock> const frame_clock;
+    std::shared_ptr<mir::client::ServerVsync> const server_vsync;
 
-    std::function<void(MirEvent const*)> handle_event_callback;
+    using EventCallback = std::function<void(MirEvent const*)>;
+    /// Only accessed through std::atomic_load() and std::atomic_store(), so input needn't take the surface's lock
+    std::shared_ptr<EventCallback const> handle_event_callback;
     std::function<void(MirWindowEvent const*)> handle_drag_and_drop_start_callback = [](auto){};
 
     std::shared_ptr<mir::dispatch::ThreadedDispatcher> input_thread;
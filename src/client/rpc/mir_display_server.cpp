@@ -210,6 +210,20 @@ void mclr::DisplayServer::release_buffers(
 {
     channel->call_method(std::string(__func__), request, response, done);
 }
+void mclr::DisplayServer::exchange_buffers(
+    mir::protobuf::BufferExchange const* request,
+    mir::protobuf::Void* response,
+    google::protobuf::Closure* done)
+{
+    channel->call_method(std::string(__func__), request, response, done);
+}
+void mclr::DisplayServer::frame_timing(
+    mir::protobuf::FrameTimingRequest const* request,
+    mir::protobuf::FrameTiming* response,
+    google::protobuf::Closure* done)
+{
+    channel->call_method(std::string(__func__), request, response, done);
+}
 void mclr::DisplayServer::request_persistent_surface_id(
     mir::protobuf::SurfaceId const* request,
     mir::protobuf::PersistentSurfaceId* response,
@@ -139,6 +139,14 @@ public:
         mir::protobuf::BufferRelease const* request,
         mir::protobuf::Void* response,
         google::protobuf::Closure* done) override;
+    void exchange_buffers(
+        mir::protobuf::BufferExchange const* request,
+        mir::protobuf::Void* response,
+        google::protobuf::Closure* done) override;
+    void frame_timing(
+        mir::protobuf::FrameTimingRequest const* request,
+        mir::protobuf::FrameTiming* response,
+        google::protobuf::Closure* done) override;
     void request_persistent_surface_id(
         mir::protobuf::SurfaceId const* request,
         mir::protobuf::PersistentSurfaceId* response,
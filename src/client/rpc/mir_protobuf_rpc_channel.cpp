@@ -33,6 +33,7 @@
 #include "../mir_error.h"
 #include "mir/input/input_devices.h"
 #include "mir/variable_length_array.h"
+#include "mir/event_ring.h"
 #include "mir/events/event_builders.h"
 #include "mir/events/event_private.h"
 #include "mir/events/surface_placement_event.h"
@@ -296,10 +297,27 @@ void mclr::MirProtobufRpcChannel::send_message(
 
 void mclr::MirProtobufRpcChannel::process_event_sequence(std::string const& event)
 {
+    // Input events the server put in the ring before sending this come first
+    read_event_ring();
+
     mp::EventSequence seq;
 
     seq.ParseFromString(event);
 
+    if (seq.has_event_ring())
+    {
+        std::array<char, 1> dummy;
+        std::vector<mir::Fd> fds(seq.event_ring().fds_on_side_channel());
+        transport->receive_data(dummy.data(), dummy.size(), fds);
+
+        if (fds.size() == 2)
+        {
+            std::lock_guard<decltype(event_ring_mutex)> lock(event_ring_mutex);
+            event_ring = std::make_unique<EventRing>(fds[0], fds[1]);
+            multiplexer.add_watch(fds[1], [this] { read_event_ring(); });
+        }
+    }
+
     if (seq.has_display_configuration())
     {
         display_configuration->update_configuration(seq.display_configuration());
@@ -414,60 +432,88 @@ void mclr::MirProtobufRpcChannel::process_event_sequence(std::string const& even
                 if (e)
                 {
                     rpc_report->event_parsing_succeeded(*e);
+                    process_event(*e);
+                }
+            }
+            catch(...)
+            {
+                rpc_report->event_parsing_failed(event);
+            }
+        }
+    }
+}
 
-                    int window_id = 0;
-                    bool is_window_event = true;
+void mclr::MirProtobufRpcChannel::process_event(MirEvent& e)
+{
+    int window_id = 0;
+    bool is_window_event = true;
 
-                    switch (e->type())
-                    {
-                    case mir_event_type_window:
-                        window_id = e->to_surface()->id();
-                        break;
-                    case mir_event_type_resize:
-                        window_id = e->to_resize()->surface_id();
-                        break;
-                    case mir_event_type_orientation:
-                        window_id = e->to_orientation()->surface_id();
-                        break;
-                    case mir_event_type_close_window:
-                        window_id = e->to_close_window()->surface_id();
-                        break;
-                    case mir_event_type_keymap:
-                        input_report->received_event(*e);
-                        window_id = e->to_keymap()->surface_id();
-                        break;
-                    case mir_event_type_window_output:
-                        window_id = e->to_window_output()->surface_id();
-                        break;
-                    case mir_event_type_window_placement:
-                        window_id = e->to_window_placement()->id();
-                        break;
-                    case mir_event_type_input:
-                        input_report->received_event(*e);
-                        window_id = e->to_input()->window_id();
-                        break;
-                    case mir_event_type_input_device_state:
-                        input_report->received_event(*e);
-                        window_id = e->to_input_device_state()->window_id();
-                        break;
-                    default:
-                        is_window_event = false;
-                        event_sink->handle_event(*e);
-                    }
+    switch (e.type())
+    {
+    case mir_event_type_window:
+        window_id = e.to_surface()->id();
+        break;
+    case mir_event_type_resize:
+        window_id = e.to_resize()->surface_id();
+        break;
+    case mir_event_type_orientation:
+        window_id = e.to_orientation()->surface_id();
+        break;
+    case mir_event_type_close_window:
+        window_id = e.to_close_window()->surface_id();
+        break;
+    case mir_event_type_keymap:
+        input_report->received_event(e);
+        window_id = e.to_keymap()->surface_id();
+        break;
+    case mir_event_type_window_output:
+        window_id = e.to_window_output()->surface_id();
+        break;
+    case mir_event_type_window_placement:
+        window_id = e.to_window_placement()->id();
+        break;
+    case mir_event_type_input:
+        input_report->received_event(e);
+        window_id = e.to_input()->window_id();
+        break;
+    case mir_event_type_input_device_state:
+        input_report->received_event(e);
+        window_id = e.to_input_device_state()->window_id();
+        break;
+    default:
+        is_window_event = false;
+        event_sink->handle_event(e);
+    }
+
+    if (is_window_event)
+        if (auto map = surface_map.lock())
+            if (auto surf = map->surface(mf::SurfaceId(window_id)))
+                surf->handle_event(e);
+}
 
-                    if (is_window_event)
-                        if (auto map = surface_map.lock())
-                            if (auto surf = map->surface(mf::SurfaceId(window_id)))
-                                surf->handle_event(*e);
+void mclr::MirProtobufRpcChannel::read_event_ring()
+{
+    std::lock_guard<decltype(event_ring_mutex)> lock(event_ring_mutex);
+    if (!event_ring)
+        return;
 
+    event_ring->read([this](void const* data, size_t size)
+        {
+            try
+            {
+                if (auto const e = MirEvent::deserialize(data, size))
+                {
+                    rpc_report->event_parsing_succeeded(*e);
+                    process_event(*e);
                 }
             }
-            catch(...)
+            catch (...)
             {
+                mp::Event event;
+                event.set_raw(data, size);
                 rpc_report->event_parsing_failed(event);
             }
-        }
-    }
+        });
 }
 
 void mclr::MirProtobufRpcChannel::on_data_available()
@@ -29,12 +29,15 @@
 #include "../ping_handler.h"
 #include "../error_handler.h"
 
+#include "mir_toolkit/event.h"
+
 #include <thread>
 #include <atomic>
 #include <experimental/optional>
 
 namespace mir
 {
+class EventRing;
 
 namespace input
 {
@@ -131,6 +134,8 @@ private:
 
     void read_message();
     void process_event_sequence(std::string const& event);
+    void process_event(MirEvent& event);
+    void read_event_ring();
 
     void notify_disconnected();
 
@@ -146,6 +151,10 @@ private:
     std::mutex read_mutex;
     std::mutex write_mutex;
 
+    /// Input events, if the server sends them through a shared ring rather than the socket
+    std::mutex event_ring_mutex;
+    std::unique_ptr<EventRing> event_ring;
+
     bool prioritise_next_request{false};
     std::experimental::optional<uint32_t> id_to_wait_for;
 
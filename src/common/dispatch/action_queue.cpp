@@ -17,12 +17,15 @@
  */
 
 #include "mir/dispatch/action_queue.h"
+#include "mir/unwind_helpers.h"
 
 #include <boost/throw_exception.hpp>
 #include <sys/eventfd.h>
 
+#include <memory>
+
 mir::dispatch::ActionQueue::ActionQueue()
-    : event_fd{eventfd(0, EFD_CLOEXEC|EFD_NONBLOCK|EFD_SEMAPHORE)}
+    : event_fd{eventfd(0, EFD_CLOEXEC|EFD_NONBLOCK)}
 {
     if (event_fd < 0)
         BOOST_THROW_EXCEPTION((std::system_error{errno,
@@ -30,6 +33,16 @@ mir::dispatch::ActionQueue::ActionQueue()
                                                  "Failed to create event fd for action queue"}));
 }
 
+mir::dispatch::ActionQueue::~ActionQueue()
+{
+    for (auto node = newest.load(); node;)
+    {
+        auto const next = node->next;
+        delete node;
+        node = next;
+    }
+}
+
 mir::Fd mir::dispatch::ActionQueue::watch_fd() const
 {
     return event_fd;
@@ -37,9 +50,23 @@ mir::Fd mir::dispatch::ActionQueue::watch_fd() const
 
 void mir::dispatch::ActionQueue::enqueue(std::function<void()> const& action)
 {
-    std::unique_lock<std::mutex> lock(list_lock);
-    actions.push_back(action);
-    wake();
+    auto const node = new Node{action, nullptr};
+
+    // Until the queue is dispatched, whoever made it non-empty has already woken the dispatcher
+    if (push(node, node))
+        wake();
+}
+
+bool mir::dispatch::ActionQueue::push(Node* first, Node* last)
+{
+    auto expected = newest.load();
+    do
+    {
+        last->next = expected;
+    }
+    while (!newest.compare_exchange_weak(expected, first));
+
+    return !expected;
 }
 
 bool mir::dispatch::ActionQueue::dispatch(FdEvents events)
@@ -54,15 +81,54 @@ bool mir::dispatch::ActionQueue::dispatch(FdEvents events)
         return true;
     }
 
-    std::function<void()> action_to_process;
-
+    // Take everything queued so far, oldest first. Anything the actions enqueue waits for the next dispatch.
+    Node* oldest{nullptr};
+    for (auto node = newest.exchange(nullptr); node;)
     {
-        std::unique_lock<std::mutex> lock(list_lock);
-        action_to_process = actions.front();
-        actions.pop_front();
+        auto const next = node->next;
+        node->next = oldest;
+        oldest = node;
+        node = next;
     }
 
-    action_to_process();
+    auto requeue_the_rest = on_unwind([&]
+        {
+            if (!oldest)
+                return;
+
+            // Back to newest first, for push()
+            auto const last = oldest;
+            Node* first{nullptr};
+            for (auto node = oldest; node;)
+            {
+                auto const next = node->next;
+                node->next = first;
+                first = node;
+                node = next;
+            }
+
+            // The rest are older than anything queued since we took them, so they go behind it
+            auto const queued_since = newest.exchange(nullptr);
+            if (queued_since)
+            {
+                auto tail = queued_since;
+                while (tail->next)
+                    tail = tail->next;
+                tail->next = first;
+                first = queued_since;
+            }
+
+            // Whoever queued anything since has already woken the dispatcher
+            if (push(first, last) && !queued_since)
+                wake();
+        });
+
+    while (oldest)
+    {
+        std::unique_ptr<Node> const node{oldest};
+        oldest = node->next;
+        node->action();
+    }
 
     return true;
 }
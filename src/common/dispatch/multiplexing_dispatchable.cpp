@@ -25,17 +25,22 @@
 #include <shared_mutex>
 
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <poll.h>
 #include <limits.h>
 #include <unistd.h>
 #include <string.h>
 #include <system_error>
 #include <algorithm>
+#include <array>
 
 namespace md = mir::dispatch;
 
 namespace
 {
+/// How many ready sources a single dispatch() handles, saving an epoll_wait() (and the caller's poll()) for each
+int const max_events_per_dispatch = 16;
+
 class DispatchableAdaptor : public md::Dispatchable
 {
 public:
@@ -73,7 +78,8 @@ private:
 
 md::MultiplexingDispatchable::MultiplexingDispatchable()
     : lifetime_mutex{PosixRWMutex::Type::PreferWriterNonRecursive},
-      epoll_fd{mir::Fd{::epoll_create1(EPOLL_CLOEXEC)}}
+      epoll_fd{mir::Fd{::epoll_create1(EPOLL_CLOEXEC)}},
+      ready_fd{mir::Fd{::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)}}
 {
     if (epoll_fd == mir::Fd::invalid)
     {
@@ -81,6 +87,24 @@ md::MultiplexingDispatchable::MultiplexingDispatchable()
                                                  std::system_category(),
                                                  "Failed to create epoll monitor"}));
     }
+
+    if (ready_fd == mir::Fd::invalid)
+    {
+        BOOST_THROW_EXCEPTION((std::system_error{errno,
+                                                 std::system_category(),
+                                                 "Failed to create ready source notifier"}));
+    }
+
+    epoll_event e;
+    ::memset(&e, 0, sizeof(e));
+    e.events = EPOLLIN;
+    e.data.ptr = nullptr;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, ready_fd, &e) < 0)
+    {
+        BOOST_THROW_EXCEPTION((std::system_error{errno,
+                                                 std::system_category(),
+                                                 "Failed to monitor ready source notifier"}));
+    }
 }
 
 md::MultiplexingDispatchable::~MultiplexingDispatchable() noexcept
@@ -108,43 +132,98 @@ bool md::MultiplexingDispatchable::dispatch(md::FdEvents events)
         return false;
     }
 
-    std::shared_ptr<md::Dispatchable> source;
-    bool rearm_source{false};
-    epoll_event event;
+    // If there's nothing ready some other thread must have stolen the events
+    // we were woken for; that's ok, just return.
+    ReadySource ready;
+    auto have_source = fetch_ready_sources(ready) || take_ready_source(ready);
 
+    for (int dispatched = 0; have_source; have_source = ++dispatched < max_events_per_dispatch && take_ready_source(ready))
     {
-        std::shared_lock<decltype(lifetime_mutex)> lock{lifetime_mutex};
+        epoll_event event;
+        ::memset(&event, 0, sizeof(event));
+        event.events = ready.events;
+        event.data.ptr = ready.holder;
 
-        auto result = epoll_wait(epoll_fd, &event, 1, 0);
-
-        if (result < 0)
+        if (!ready.source->dispatch(epoll_to_fd_event(event)))
+        {
+            remove_watch(ready.source);
+        }
+        else if (ready.rearm)
         {
-            BOOST_THROW_EXCEPTION((std::system_error{errno,
-                                                     std::system_category(),
-                                                     "Failed to wait on fds"}));
+            event.events = fd_event_to_epoll(ready.source->relevant_events()) | EPOLLONESHOT;
+            epoll_ctl(epoll_fd, EPOLL_CTL_MOD, ready.source->watch_fd(), &event);
         }
+    }
+
+    return true;
+}
+
+bool md::MultiplexingDispatchable::fetch_ready_sources(ReadySource& ready)
+{
+    std::array<epoll_event, max_events_per_dispatch> events;
 
-        if (result == 0)
+    std::shared_lock<decltype(lifetime_mutex)> lock{lifetime_mutex};
+
+    auto const result = epoll_wait(epoll_fd, events.data(), events.size(), 0);
+
+    if (result < 0)
+    {
+        BOOST_THROW_EXCEPTION((std::system_error{errno,
+                                                 std::system_category(),
+                                                 "Failed to wait on fds"}));
+    }
+
+    std::lock_guard<std::mutex> ready_lock{ready_mutex};
+    auto const was_empty = ready_sources.empty();
+    auto took_one = false;
+
+    for (auto event = events.begin(); event != events.begin() + result; ++event)
+    {
+        // ready_fd just tells us ready_sources is not empty
+        if (!event->data.ptr)
         {
-            // Some other thread must have stolen the event we were woken for;
-            // that's ok, just return.
-            return true;
+            continue;
         }
 
-        auto event_source = reinterpret_cast<decltype(dispatchee_holder)::pointer>(event.data.ptr);
+        auto event_source = reinterpret_cast<decltype(dispatchee_holder)::pointer>(event->data.ptr);
+        ReadySource source{event_source->first, event_source->second, event->data.ptr, event->events};
+
+        // Unless others are already waiting, the first goes straight to this thread
+        if (was_empty && !took_one)
+        {
+            ready = std::move(source);
+            took_one = true;
+        }
+        else
+        {
+            ready_sources.push_back(std::move(source));
+        }
+    }
 
-        source = event_source->first;
-        rearm_source = event_source->second;
+    if (was_empty && !ready_sources.empty())
+    {
+        eventfd_write(ready_fd, 1);
     }
 
-    if (!source->dispatch(epoll_to_fd_event(event)))
+    return took_one;
+}
+
+bool md::MultiplexingDispatchable::take_ready_source(ReadySource& ready)
+{
+    std::lock_guard<std::mutex> lock{ready_mutex};
+
+    if (ready_sources.empty())
     {
-        remove_watch(source);
+        return false;
     }
-    else if (rearm_source)
+
+    ready = std::move(ready_sources.front());
+    ready_sources.pop_front();
+
+    if (ready_sources.empty())
     {
-        event.events = fd_event_to_epoll(source->relevant_events()) | EPOLLONESHOT;
-        epoll_ctl(epoll_fd, EPOLL_CTL_MOD, source->watch_fd(), &event);
+        eventfd_t count;
+        eventfd_read(ready_fd, &count);
     }
 
     return true;
@@ -227,4 +306,18 @@ void md::MultiplexingDispatchable::remove_watch(Fd const& fd)
     {
         return candidate.first->watch_fd() == fd;
     });
+
+    // Don't dispatch (or keep alive) a source that was ready before it was removed
+    std::lock_guard<std::mutex> ready_lock{ready_mutex};
+    auto const was_empty = ready_sources.empty();
+    ready_sources.erase(
+        std::remove_if(ready_sources.begin(), ready_sources.end(),
+            [&fd](ReadySource const& candidate) { return candidate.source->watch_fd() == fd; }),
+        ready_sources.end());
+
+    if (!was_empty && ready_sources.empty())
+    {
+        eventfd_t count;
+        eventfd_read(ready_fd, &count);
+    }
 }
@@ -0,0 +1,194 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/event_ring.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <atomic>
+#include <cstring>
+#include <new>
+#include <system_error>
+
+#include <linux/memfd.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/// The positions are free-running byte counts, so the writer's and reader's cache lines are kept apart
+struct mir::EventRing::Header
+{
+    alignas(64) std::atomic<uint64_t> head;     ///< Written by the writer
+    alignas(64) std::atomic<uint64_t> tail;     ///< Written by the reader
+};
+
+namespace
+{
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "EventRing needs lock-free positions to share them");
+
+/// Each record starts with its size, padded so that the record's data is aligned
+struct alignas(uint64_t) RecordHeader
+{
+    uint32_t size;
+    uint32_t padding;
+};
+
+/// Marks the unused space at the end of the ring, when the next record wouldn't fit there
+uint32_t const wrap_marker = UINT32_MAX;
+
+auto aligned(size_t size) -> size_t
+{
+    return (size + alignof(RecordHeader) - 1) & ~(alignof(RecordHeader) - 1);
+}
+
+auto create_memory(size_t size) -> mir::Fd
+{
+    mir::Fd fd{static_cast<int>(syscall(SYS_memfd_create, "mir-event-ring", MFD_CLOEXEC))};
+    if (fd < 0)
+        BOOST_THROW_EXCEPTION(std::system_error(errno, std::system_category(), "Failed to create event ring"));
+
+    if (ftruncate(fd, size) < 0)
+        BOOST_THROW_EXCEPTION(std::system_error(errno, std::system_category(), "Failed to size event ring"));
+
+    return fd;
+}
+
+auto create_doorbell() -> mir::Fd
+{
+    mir::Fd fd{eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)};
+    if (fd < 0)
+        BOOST_THROW_EXCEPTION(std::system_error(errno, std::system_category(), "Failed to create event ring doorbell"));
+    return fd;
+}
+
+auto size_of(mir::Fd const& memory, size_t header_size) -> size_t
+{
+    struct stat info;
+    if (fstat(memory, &info) < 0)
+        BOOST_THROW_EXCEPTION(std::system_error(errno, std::system_category(), "Failed to query event ring"));
+
+    if (static_cast<size_t>(info.st_size) <= header_size + sizeof(RecordHeader))
+        BOOST_THROW_EXCEPTION(std::runtime_error("Event ring is too small"));
+
+    return info.st_size;
+}
+
+auto map(mir::Fd const& memory, size_t size) -> void*
+{
+    auto const mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, memory, 0);
+    if (mapping == MAP_FAILED)
+        BOOST_THROW_EXCEPTION(std::system_error(errno, std::system_category(), "Failed to map event ring"));
+    return mapping;
+}
+}
+
+mir::EventRing::EventRing(size_t size) :
+    memory_fd{create_memory(sizeof(Header) + aligned(size))},
+    doorbell_fd{create_doorbell()},
+    mapped_size{sizeof(Header) + aligned(size)},
+    mapping{map(memory_fd, mapped_size)},
+    header{new (mapping) Header{}},
+    records{static_cast<char*>(mapping) + sizeof(Header)},
+    capacity{aligned(size)}
+{
+}
+
+mir::EventRing::EventRing(Fd const& memory, Fd const& doorbell) :
+    memory_fd{memory},
+    doorbell_fd{doorbell},
+    mapped_size{size_of(memory, sizeof(Header))},
+    mapping{map(memory_fd, mapped_size)},
+    header{static_cast<Header*>(mapping)},
+    records{static_cast<char*>(mapping) + sizeof(Header)},
+    capacity{(mapped_size - sizeof(Header)) & ~(alignof(RecordHeader) - 1)},
+    position{header->tail.load()}
+{
+}
+
+mir::EventRing::~EventRing()
+{
+    munmap(mapping, mapped_size);
+}
+
+bool mir::EventRing::write(void const* data, size_t size)
+{
+    auto const record_size = sizeof(RecordHeader) + aligned(size);
+    auto const used = position - header->tail.load();
+
+    if (size >= wrap_marker || used > capacity)
+        return false;
+
+    auto const offset = position % capacity;
+    auto const skipped = offset + record_size > capacity ? capacity - offset : 0;
+
+    if (skipped + record_size > capacity - used)
+        return false;
+
+    if (skipped)
+        reinterpret_cast<RecordHeader*>(records + offset)->size = wrap_marker;
+
+    auto const record = records + (position + skipped) % capacity;
+    reinterpret_cast<RecordHeader*>(record)->size = size;
+    memcpy(record + sizeof(RecordHeader), data, size);
+
+    auto const previous = position;
+    position += skipped + record_size;
+    header->head.store(position);
+
+    // If the reader had caught up it may be about to wait, and needs waking. Otherwise
+    // it will see the new head before it next checks whether the ring is empty.
+    if (header->tail.load() == previous)
+    {
+        uint64_t const one = 1;
+        if (::write(doorbell_fd, &one, sizeof one) != sizeof one)
+        {
+            // The only failure is an overflowing count, and then the doorbell is already ringing
+        }
+    }
+
+    return true;
+}
+
+void mir::EventRing::read(std::function<void(void const* data, size_t size)> const& handler)
+{
+    uint64_t rings;
+    if (::read(doorbell_fd, &rings, sizeof rings) != sizeof rings)
+    {
+        // Nothing to clear: we've been asked to read without the doorbell ringing
+    }
+
+    for (auto head = header->head.load(); position != head; head = header->head.load())
+    {
+        while (position != head)
+        {
+            auto const offset = position % capacity;
+            auto const record = reinterpret_cast<RecordHeader const*>(records + offset);
+
+            if (record->size == wrap_marker)
+            {
+                position += capacity - offset;
+                continue;
+            }
+
+            handler(records + offset + sizeof(RecordHeader), record->size);
+
+            position += sizeof(RecordHeader) + aligned(record->size);
+            header->tail.store(position);
+        }
+    }
+}
@@ -55,10 +55,15 @@ MirEvent& MirEvent::operator=(MirEvent const& e)
 
 // TODO Look at replacing the surface event serializer with a capnproto layer
 mir::EventUPtr MirEvent::deserialize(std::string const& bytes)
+{
+    return deserialize(bytes.data(), bytes.size());
+}
+
+mir::EventUPtr MirEvent::deserialize(void const* bytes, size_t size)
 {
     auto e = mir::EventUPtr(new MirEvent, [](MirEvent* ev) { delete ev; });
     kj::ArrayPtr<::capnp::word const> words(reinterpret_cast<::capnp::word const*>(
-        bytes.data()), bytes.size() / sizeof(::capnp::word));
+        bytes), size / sizeof(::capnp::word));
 
     initMessageBuilderFromFlatArrayCopy(words, e->message);
     e->event = e->message.getRoot<mir::capnp::Event>();
@@ -0,0 +1,81 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "mir/lock_profile.h"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+struct Profiles
+{
+    std::mutex mutex;
+    std::vector<mir::LockProfile const*> profiles;
+};
+
+/// Profiles are static objects in several libraries, so the list is created on first use
+auto profiles() -> Profiles&
+{
+    static Profiles instance;
+    return instance;
+}
+}
+
+std::atomic<bool> mir::LockProfile::profiling{false};
+
+mir::LockProfile::LockProfile(char const* name)
+    : name{name}
+{
+    auto& list = profiles();
+    std::lock_guard<std::mutex> lock{list.mutex};
+    list.profiles.push_back(this);
+}
+
+mir::LockProfile::~LockProfile()
+{
+    auto& list = profiles();
+    std::lock_guard<std::mutex> lock{list.mutex};
+    list.profiles.erase(std::remove(list.profiles.begin(), list.profiles.end(), this), list.profiles.end());
+}
+
+void mir::LockProfile::enable(bool enabled)
+{
+    profiling.store(enabled, std::memory_order_relaxed);
+}
+
+auto mir::LockProfile::totals() const -> Totals
+{
+    return {
+        acquisitions.load(std::memory_order_relaxed),
+        contended.load(std::memory_order_relaxed),
+        std::chrono::nanoseconds{waited_ns.load(std::memory_order_relaxed)},
+        std::chrono::nanoseconds{longest_wait_ns.load(std::memory_order_relaxed)},
+        std::chrono::nanoseconds{held_ns.load(std::memory_order_relaxed)},
+        std::chrono::nanoseconds{longest_hold_ns.load(std::memory_order_relaxed)}};
+}
+
+void mir::for_each_lock_profile(std::function<void(LockProfile const&)> const& f)
+{
+    auto& list = profiles();
+    std::lock_guard<std::mutex> lock{list.mutex};
+    for (auto const profile : list.profiles)
+    {
+        f(*profile);
+    }
+}
@@ -57,3 +57,11 @@ void ml::SharedLibraryProberReport::loading_failed(boost::filesystem::path const
                 " (error was:" + error.what() + ")",
                 MIR_LOG_COMPONENT);
 }
+
+void ml::SharedLibraryProberReport::library_skipped(boost::filesystem::path const& filename, std::string const& requirement)
+{
+    logger->log(ml::Severity::informational,
+                std::string("Skipping module: ") + filename.string() +
+                " (requirement not met: " + requirement + ")",
+                MIR_LOG_COMPONENT);
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/memory_account.h"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+struct Accounts
+{
+    std::mutex mutex;
+    std::vector<mir::MemoryAccount const*> accounts;
+};
+
+/// Accounts are static objects in several libraries, so the list is created on first use
+auto accounts() -> Accounts&
+{
+    static Accounts instance;
+    return instance;
+}
+}
+
+mir::MemoryAccount::MemoryAccount(char const* subsystem, char const* kind)
+    : subsystem{subsystem},
+      kind{kind}
+{
+    auto& list = accounts();
+    std::lock_guard<std::mutex> lock{list.mutex};
+    list.accounts.push_back(this);
+}
+
+mir::MemoryAccount::~MemoryAccount()
+{
+    auto& list = accounts();
+    std::lock_guard<std::mutex> lock{list.mutex};
+    list.accounts.erase(std::remove(list.accounts.begin(), list.accounts.end(), this), list.accounts.end());
+}
+
+void mir::for_each_memory_account(std::function<void(MemoryAccount const&)> const& f)
+{
+    auto& list = accounts();
+    std::lock_guard<std::mutex> lock{list.mutex};
+    for (auto const account : list.accounts)
+    {
+        f(*account);
+    }
+}
@@ -21,8 +21,13 @@
 
 #include <boost/filesystem.hpp>
 
+#include <experimental/optional>
+#include <fstream>
+#include <sstream>
 #include <system_error>
 #include <cstring>
+#include <cstdlib>
+#include <glob.h>
 
 namespace
 {
@@ -61,6 +66,60 @@ bool greater_soname_version(boost::filesystem::path const& lhs, boost::filesyste
 
     return strtol(++lhbuf, 0, 0) > strtol(++rhbuf, 0, 0);
 }
+
+// A module "name.so(.X.Y)" may have a "name.manifest" beside it, listing what it needs to be of any use:
+//   device <glob>...   some path matching one of the globs exists
+//   env <variable>...  one of the variables is set (and not empty)
+// Checking these is much cheaper than loading the module and everything it links against,
+// only for its probe to reject the system. Lines we don't understand are ignored.
+auto manifest_for(boost::filesystem::path const& library) -> boost::filesystem::path
+{
+    auto const& filename = library.filename().string();
+    return library.parent_path() / (filename.substr(0, filename.find(".so")) + ".manifest");
+}
+
+bool any_path_matches(std::string const& pattern)
+{
+    glob_t matches;
+    auto const result = glob(pattern.c_str(), GLOB_NOSORT, nullptr, &matches);
+    globfree(&matches);
+    return result == 0;
+}
+
+bool any_variable_set(std::string const& name)
+{
+    auto const value = getenv(name.c_str());
+    return value && *value;
+}
+
+auto unmet_requirement(boost::filesystem::path const& library) -> std::experimental::optional<std::string>
+{
+    std::ifstream manifest{manifest_for(library).string()};
+
+    for (std::string line; std::getline(manifest, line);)
+    {
+        std::istringstream words{line};
+        std::string kind;
+        words >> kind;
+
+        bool (*met)(std::string const&){nullptr};
+        if (kind == "device")
+            met = &any_path_matches;
+        else if (kind == "env")
+            met = &any_variable_set;
+        else
+            continue;
+
+        bool satisfied{false};
+        for (std::string alternative; !satisfied && words >> alternative;)
+            satisfied = met(alternative);
+
+        if (!satisfied)
+            return line;
+    }
+
+    return {};
+}
 }
 
 void mir::select_libraries_for_path(
@@ -91,6 +150,12 @@ void mir::select_libraries_for_path(
 
     for(auto& lib : libraries)
     {
+        if (auto const requirement = unmet_requirement(lib))
+        {
+            report.library_skipped(lib, requirement.value());
+            continue;
+        }
+
         try
         {
             report.loading_library(lib);
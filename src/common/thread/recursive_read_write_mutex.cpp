@@ -17,71 +17,179 @@
  */
 
 #include "mir/recursive_read_write_mutex.h"
+#include "mir/lock_profile.h"
 
-#include <algorithm>
+#include <vector>
 
-void mir::RecursiveReadWriteMutex::read_lock()
+namespace
 {
-    auto const my_id = std::this_thread::get_id();
+/// Set in RecursiveReadWriteMutex::state while a writer waits for, or holds, the lock
+unsigned const write_pending{1u << 31};
 
-    std::unique_lock<decltype(mutex)> lock{mutex};
-    cv.wait(lock, [&]{
-        return !write_locking_thread.count ||
-            write_locking_thread.id == my_id; });
+struct ReadLockCount
+{
+    std::uint64_t mutex;
+    unsigned count;
+};
+
+/// This thread's read locks. Threads rarely hold more than a couple, so a vector beats a map
+thread_local std::vector<ReadLockCount> read_lock_counts;
+
+auto read_lock_count(std::uint64_t mutex) -> ReadLockCount*
+{
+    for (auto& entry : read_lock_counts)
+    {
+        if (entry.mutex == mutex)
+            return &entry;
+    }
+    return nullptr;
+}
+
+void record_uncontended(mir::LockProfile* profile)
+{
+    if (profile && mir::LockProfile::enabled())
+        profile->acquired_uncontended();
+}
+
+/// Waits on \a cv until \a ready, recording in \a profile (if any) whether, and how long, that took
+template<typename Predicate>
+void wait_until_ready(
+    std::condition_variable& cv,
+    std::unique_lock<std::mutex>& lock,
+    mir::LockProfile* profile,
+    Predicate ready)
+{
+    if (!profile || !mir::LockProfile::enabled())
+    {
+        cv.wait(lock, ready);
+    }
+    else if (ready())
+    {
+        profile->acquired_uncontended();
+    }
+    else
+    {
+        auto const start = mir::LockProfile::Clock::now();
+        cv.wait(lock, ready);
+        profile->acquired_after(mir::LockProfile::Clock::now() - start);
+    }
+}
+}
+
+mir::RecursiveReadWriteMutex::RecursiveReadWriteMutex(LockProfile& profile)
+    : profile{&profile}
+{
+}
 
-    auto const my_count = std::find_if(
-        read_locking_threads.begin(),
-        read_locking_threads.end(),
-        [my_id](ThreadLockCount const& candidate) { return my_id == candidate.id; });
+auto mir::RecursiveReadWriteMutex::next_id() -> std::uint64_t
+{
+    static std::atomic<std::uint64_t> next{0};
+    return next++;
+}
+
+void mir::RecursiveReadWriteMutex::read_lock()
+{
+    if (auto const held = read_lock_count(id))
+    {
+        ++held->count;
+        record_uncontended(profile);
+        return;
+    }
 
-    if (my_count == read_locking_threads.end())
+    if (!(state.fetch_add(1) & write_pending) || write_locking_thread.load() == std::this_thread::get_id())
     {
-        read_locking_threads.push_back(ThreadLockCount(my_id, 1U));
+        record_uncontended(profile);
     }
     else
     {
-        ++(my_count->count);
+        // A writer is waiting or has the lock: let it go first
+        release_read();
+
+        std::unique_lock<decltype(mutex)> lock{mutex};
+        wait_until_ready(cv, lock, profile, [this]
+            {
+                // Writers only set write_pending with mutex locked, so it can't be set before we count ourselves
+                if (state.load() & write_pending)
+                    return false;
+
+                state.fetch_add(1);
+                return true;
+            });
     }
+
+    read_lock_counts.push_back({id, 1});
 }
 
 void mir::RecursiveReadWriteMutex::read_unlock()
 {
-    auto const my_id = std::this_thread::get_id();
+    auto const held = read_lock_count(id);
 
-    std::lock_guard<decltype(mutex)> lock{mutex};
-    auto const my_count = std::find_if(
-        read_locking_threads.begin(),
-        read_locking_threads.end(),
-        [my_id](ThreadLockCount const& candidate) { return my_id == candidate.id; });
+    if (--held->count)
+        return;
 
-    --(my_count->count);
+    *held = read_lock_counts.back();
+    read_lock_counts.pop_back();
 
-    cv.notify_all();
+    release_read();
+}
+
+void mir::RecursiveReadWriteMutex::release_read()
+{
+    if (state.fetch_sub(1) & write_pending)
+    {
+        // A writer may be waiting for us to go
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        cv.notify_all();
+    }
 }
 
 void mir::RecursiveReadWriteMutex::write_lock()
 {
     auto const my_id = std::this_thread::get_id();
 
+    if (write_locking_thread.load() == my_id)
+    {
+        // Only this thread could have made that true, so we already hold the write lock
+        ++write_count;
+        record_uncontended(profile);
+        return;
+    }
+
+    unsigned const my_reads = read_lock_count(id) ? 1 : 0;
+
     std::unique_lock<decltype(mutex)> lock{mutex};
-    cv.wait(lock, [&]
+    wait_until_ready(cv, lock, profile, [&]
         {
-            if (write_locking_thread.count &&
-                write_locking_thread.id != my_id) return false;
-            for (auto const& candidate : read_locking_threads)
+            // A thread with a read lock takes over a claim not yet granted, as the claimant would
+            // otherwise wait for it to release its read lock, while it waits for the claimant.
+            if (write_locking_thread.load() == std::thread::id{} || (!write_acquired && my_reads))
             {
-                if (candidate.id != my_id && candidate.count != 0) return false;
+                write_locking_thread = my_id;
+                state.fetch_or(write_pending);
             }
-            return true;
+
+            return write_locking_thread.load() == my_id && (state.load() & ~write_pending) == my_reads;
         });
 
-    ++write_locking_thread.count;
-    write_locking_thread.id = my_id;
+    write_acquired = true;
+    write_count = 1;
+    if (profile && LockProfile::enabled())
+        write_locked = LockProfile::Clock::now();
 }
 
 void mir::RecursiveReadWriteMutex::write_unlock()
 {
+    if (--write_count)
+        return;
+
     std::lock_guard<decltype(mutex)> lock{mutex};
-    --write_locking_thread.count;
+    if (write_locked != LockProfile::Clock::time_point{})
+    {
+        profile->held_for(LockProfile::Clock::now() - write_locked);
+        write_locked = {};
+    }
+    write_acquired = false;
+    write_locking_thread = std::thread::id{};
+    state.fetch_and(~write_pending);
     cv.notify_all();
 }
@@ -18,12 +18,36 @@
 
 #include "mir/thread_name.h"
 
+#include <memory>
+#include <mutex>
+
 #include <pthread.h>
 
+namespace
+{
+std::mutex hook_mutex;
+std::shared_ptr<std::function<void(std::string const&)>> hook;
+}
+
 void mir::set_thread_name(std::string const& name)
 {
     static size_t const max_name_len = 15;
     auto const proper_name = name.substr(0, max_name_len);
 
     pthread_setname_np(pthread_self(), proper_name.c_str());
+
+    decltype(hook) current_hook;
+    {
+        std::lock_guard<std::mutex> lock{hook_mutex};
+        current_hook = hook;
+    }
+
+    if (current_hook)
+        (*current_hook)(name);
+}
+
+void mir::set_thread_name_hook(std::function<void(std::string const& name)> const& new_hook)
+{
+    std::lock_guard<std::mutex> lock{hook_mutex};
+    hook = new_hook ? std::make_shared<std::function<void(std::string const&)>>(new_hook) : nullptr;
 }
@@ -41,8 +41,6 @@
 
 namespace
 {
-uint32_t const mac_byte_size{32};
-
 size_t cookie_size_from_format(mir::cookie::Format const& format)
 {
     switch (format)
@@ -84,13 +82,9 @@ mir::cookie::SecurityCheckError::SecurityCheckError() :
 class AuthorityNettle : public mir::cookie::Authority
 {
 public:
-    AuthorityNettle(mir::cookie::Secret const& secret)
+    AuthorityNettle(mir::cookie::Secret const& secret) :
+        key_schedule(schedule_for(secret))
     {
-        if (secret.size() < minimum_secret_size)
-            BOOST_THROW_EXCEPTION(std::logic_error("Secret size " + std::to_string(secret.size()) + " is to small, require " +
-                                                   std::to_string(minimum_secret_size) + " or greater."));
-
-        hmac_sha256_set_key(&ctx, secret.size(), secret.data());
     }
 
     virtual ~AuthorityNettle() noexcept = default;
@@ -98,18 +92,13 @@ public:
 
     std::unique_ptr<mir::cookie::Cookie> make_cookie(uint64_t const& timestamp) override
     {
-        return std::make_unique<mir::cookie::HMACCookie>(timestamp, calculate_cookie(timestamp), mir::cookie::Format::hmac_sha_256);
+        mir::cookie::Blob serialized;
+        serialize(timestamp, serialized.data());
+        return std::make_unique<mir::cookie::HMACCookie>(serialized);
     }
 
     std::unique_ptr<mir::cookie::Cookie> make_cookie(std::vector<uint8_t> const& raw_cookie) override
     {
-        /*
-        SHA_256 Format:
-        1  byte  = FORMAT
-        8  bytes = TIMESTAMP
-        32 bytes = MAC
-        */
-
         if (raw_cookie.size() != cookie_size_from_format(mir::cookie::Format::hmac_sha_256))
         {
            BOOST_THROW_EXCEPTION(mir::cookie::SecurityCheckError());
@@ -122,49 +111,50 @@ public:
         }
 
         uint64_t timestamp = 0;
+        memcpy(&timestamp, raw_cookie.data() + mir::cookie::HMACCookie::timestamp_offset, sizeof(timestamp));
 
-        auto ptr = raw_cookie.data();
-        ptr++;
-
-        memcpy(&timestamp, ptr, sizeof(uint64_t));
-        ptr += sizeof(timestamp);
-
-        std::vector<uint8_t> mac(mac_byte_size);
-        memcpy(mac.data(), ptr, mac.size());
-
-        std::unique_ptr<mir::cookie::Cookie> cookie =
-            std::make_unique<mir::cookie::HMACCookie>(timestamp, mac, mir::cookie::Format::hmac_sha_256);
+        uint8_t mac[mir::cookie::HMACCookie::mac_size];
+        calculate_mac(timestamp, mac);
 
-        if (!verify_cookie(timestamp, cookie))
+        if (mir::cookie::const_memcmp(mac, raw_cookie.data() + mir::cookie::HMACCookie::mac_offset, sizeof(mac)) != 0)
         {
             BOOST_THROW_EXCEPTION(mir::cookie::SecurityCheckError());
         }
 
-        return cookie;
+        mir::cookie::Blob serialized;
+        std::copy(raw_cookie.begin(), raw_cookie.end(), serialized.begin());
+        return std::make_unique<mir::cookie::HMACCookie>(serialized);
     }
 
 private:
-    std::vector<uint8_t> calculate_cookie(uint64_t const& timestamp)
+    static struct hmac_sha256_ctx schedule_for(mir::cookie::Secret const& secret)
     {
-        std::vector<uint8_t> mac(mac_byte_size);
-        hmac_sha256_update(&ctx, sizeof(timestamp), reinterpret_cast<uint8_t const*>(&timestamp));
-        hmac_sha256_digest(&ctx, mac.size(), mac.data());
+        if (secret.size() < minimum_secret_size)
+            BOOST_THROW_EXCEPTION(std::logic_error("Secret size " + std::to_string(secret.size()) + " is to small, require " +
+                                                   std::to_string(minimum_secret_size) + " or greater."));
 
-        return mac;
+        struct hmac_sha256_ctx ctx;
+        hmac_sha256_set_key(&ctx, secret.size(), secret.data());
+        return ctx;
     }
 
-    bool verify_cookie(uint64_t const& timestamp, std::unique_ptr<mir::cookie::Cookie> const& cookie)
+    void serialize(uint64_t timestamp, uint8_t* raw_cookie) const
     {
-        auto const calculated_cookie = make_cookie(timestamp);
-
-        auto const this_stream  = cookie->serialize();
-        auto const other_stream = calculated_cookie->serialize();
+        raw_cookie[0] = static_cast<uint8_t>(mir::cookie::Format::hmac_sha_256);
+        memcpy(raw_cookie + mir::cookie::HMACCookie::timestamp_offset, &timestamp, sizeof(timestamp));
+        calculate_mac(timestamp, raw_cookie + mir::cookie::HMACCookie::mac_offset);
+    }
 
-        return this_stream.size() == other_stream.size() &&
-               mir::cookie::const_memcmp(this_stream.data(), other_stream.data(), this_stream.size()) == 0;
+    void calculate_mac(uint64_t timestamp, uint8_t* mac) const
+    {
+        // Starting from a copy of the keyed state skips re-keying, and leaves the
+        // authority safe to use from the input thread and the frontend at once
+        auto ctx = key_schedule;
+        hmac_sha256_update(&ctx, sizeof(timestamp), reinterpret_cast<uint8_t const*>(&timestamp));
+        hmac_sha256_digest(&ctx, mir::cookie::HMACCookie::mac_size, mac);
     }
 
-    struct hmac_sha256_ctx ctx;
+    struct hmac_sha256_ctx const key_schedule;
 };
 
 size_t mir::cookie::Authority::optimal_secret_size()
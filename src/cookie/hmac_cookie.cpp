@@ -20,34 +20,19 @@
 
 #include <string.h>
 
-mir::cookie::HMACCookie::HMACCookie(uint64_t const& timestamp,
-                                    std::vector<uint8_t> const& mac,
-                                    mir::cookie::Format const& format) :
-    timestamp_(timestamp),
-    mac_(mac),
-    format_(format)
+mir::cookie::HMACCookie::HMACCookie(Blob const& serialized) :
+    serialized(serialized)
 {
 }
 
 uint64_t mir::cookie::HMACCookie::timestamp() const
 {
-    return timestamp_;
+    uint64_t timestamp;
+    memcpy(&timestamp, serialized.data() + timestamp_offset, sizeof(timestamp));
+    return timestamp;
 }
 
 std::vector<uint8_t> mir::cookie::HMACCookie::serialize() const
 {
-    std::vector<uint8_t> serialized_cookie(sizeof(format_) + sizeof(timestamp_) + mac_.size());
-
-    auto cookie_ptr = serialized_cookie.data();
-
-    cookie_ptr[0] = static_cast<uint8_t>(format_);
-    cookie_ptr += sizeof(format_);
-
-    auto timestamp_ptr = reinterpret_cast<uint8_t const*>(&timestamp_);
-    memcpy(cookie_ptr, timestamp_ptr, sizeof(timestamp_));
-    cookie_ptr += sizeof(timestamp_);
-
-    memcpy(cookie_ptr, mac_.data(), mac_.size());
-    
-    return serialized_cookie;
+    return {serialized.begin(), serialized.end()};
 }
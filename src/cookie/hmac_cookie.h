@@ -20,6 +20,7 @@
 #define MIR_COOKIE_HMAC_COOKIE_H_
 
 #include "mir/cookie/cookie.h"
+#include "mir/cookie/blob.h"
 #include "format.h"
 
 namespace mir
@@ -27,24 +28,31 @@ namespace mir
 namespace cookie
 {
 
+/**
+ * A cookie in the hmac_sha_256 format:
+ *   1  byte  = FORMAT
+ *   8  bytes = TIMESTAMP
+ *   32 bytes = MAC
+ */
 class HMACCookie : public mir::cookie::Cookie
 {
 public:
+    static size_t const timestamp_offset = 1;
+    static size_t const mac_offset = timestamp_offset + sizeof(uint64_t);
+    static size_t const mac_size = 32;
+
     HMACCookie() = delete;
 
-    explicit HMACCookie(uint64_t const& timestamp,
-                        std::vector<uint8_t> const& mac,
-                        mir::cookie::Format const& format);
+    explicit HMACCookie(Blob const& serialized);
 
     uint64_t timestamp() const override;
     std::vector<uint8_t> serialize() const override;
 
 private:
-    uint64_t timestamp_;
-    std::vector<uint8_t> mac_;
-    mir::cookie::Format format_;
+    Blob const serialized;
 };
 
+static_assert(HMACCookie::mac_offset + HMACCookie::mac_size == default_blob_size, "HMACCookie doesn't fill a Blob");
 }
 }
 
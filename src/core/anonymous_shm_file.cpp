@@ -31,6 +31,7 @@
 #include <fcntl.h>
 #include <linux/memfd.h>
 #include <sys/syscall.h>
+#include <unistd.h>
 
 
 namespace
@@ -51,9 +52,12 @@ int memfd_create(char const* name, unsigned int flags)
     return static_cast<int>(syscall(SYS_memfd_create, name, flags));
 }
 
-mir::Fd create_anonymous_file(size_t size)
+/// Below this, a file can't fill a (2MiB, on most architectures) huge page
+size_t const huge_page_threshold{2 * 1024 * 1024};
+
+mir::Fd create_anonymous_file(size_t size, bool sealable)
 {
-    auto raw_fd = memfd_create("mir-buffer", MFD_CLOEXEC);
+    auto raw_fd = memfd_create("mir-buffer", MFD_CLOEXEC | (sealable ? MFD_ALLOW_SEALING : 0));
     if (raw_fd == -1 && errno == ENOSYS)
     {
         raw_fd = open("/dev/shm", O_TMPFILE | O_RDWR | O_EXCL | O_CLOEXEC, S_IRWXU);
@@ -99,18 +103,50 @@ mir::Fd create_anonymous_file(size_t size)
 class mir::AnonymousShmFile::MapHandle
 {
 public:
-    MapHandle(int fd, size_t size)
-        : size{size},
-          mapping{mmap(nullptr, size, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0)}
+    MapHandle(int fd, size_t size, int protection)
+        : size{size}
     {
-        if (mapping == MAP_FAILED)
-            BOOST_THROW_EXCEPTION(
-                std::system_error(errno, std::system_category(), "Failed to map file"));
+        map(fd, protection);
     }
 
-    ~MapHandle() noexcept
+    /// Has the kernel back the file with transparent huge pages, as far as shmem_enabled allows
+    void advise_huge_pages()
+    {
+#ifdef MADV_HUGEPAGE
+        madvise(mapping, size, MADV_HUGEPAGE);
+#endif
+    }
+
+    void prefault()
     {
+#ifdef MADV_POPULATE_WRITE
+        if (madvise(mapping, size, MADV_POPULATE_WRITE) == 0)
+            return;
+#endif
+        // Older kernels need each page touched (which leaves the zeroes it holds as they were)
+        auto const page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        auto const pages = static_cast<unsigned char volatile*>(mapping);
+        for (size_t offset = 0; offset < size; offset += page_size)
+            pages[offset] = pages[offset];
+    }
+
+    /// Seals the file, leaving it mapped read-only if that works and as it was if not
+    auto seal(int fd) -> bool
+    {
+        // The file can't be write-sealed while it has a writeable shared mapping
         munmap(mapping, size);
+        mapping = MAP_FAILED;
+
+        auto const sealed = fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) == 0;
+
+        map(fd, sealed ? PROT_READ : PROT_READ|PROT_WRITE);
+        return sealed;
+    }
+
+    ~MapHandle() noexcept
+    {
+        if (mapping != MAP_FAILED)
+            munmap(mapping, size);
     }
 
     operator void*() const
@@ -121,8 +157,17 @@ public:
 private:
     MapHandle(MapHandle const&) = delete;
     MapHandle& operator=(MapHandle const&) = delete;
+
+    void map(int fd, int protection)
+    {
+        mapping = mmap(nullptr, size, protection, MAP_SHARED, fd, 0);
+        if (mapping == MAP_FAILED)
+            BOOST_THROW_EXCEPTION(
+                std::system_error(errno, std::system_category(), "Failed to map file"));
+    }
+
     size_t const size;
-    void* const mapping;
+    void* mapping;
 };
 
 /********************
@@ -130,11 +175,22 @@ private:
  ********************/
 
 mir::AnonymousShmFile::AnonymousShmFile(size_t size)
-    : fd_{create_anonymous_file(size)},
-      mapping{new MapHandle(fd_, size)}
+    : AnonymousShmFile(size, Options{})
 {
 }
 
+mir::AnonymousShmFile::AnonymousShmFile(size_t size, Options const& options)
+    : fd_{create_anonymous_file(size, options.sealable)},
+      mapping{new MapHandle(fd_, size, PROT_READ|PROT_WRITE)}
+{
+    // The advice has to come before the pages are faulted in
+    if (options.huge_pages && size >= huge_page_threshold)
+        mapping->advise_huge_pages();
+
+    if (options.prefault)
+        mapping->prefault();
+}
+
 mir::AnonymousShmFile::~AnonymousShmFile() noexcept = default;
 
 void* mir::AnonymousShmFile::base_ptr() const
@@ -146,3 +202,8 @@ int mir::AnonymousShmFile::fd() const
 {
     return fd_;
 }
+
+auto mir::AnonymousShmFile::seal() -> bool
+{
+    return mapping->seal(fd_);
+}
@@ -0,0 +1,398 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "mir/geometry/region.h"
+
+#include <algorithm>
+#include <limits>
+#include <ostream>
+#include <utility>
+
+namespace geom = mir::geometry;
+
+using Box = geom::Region::Box;
+using Boxes = std::vector<Box>;
+
+namespace
+{
+int const unbounded = std::numeric_limits<int>::max();
+auto const no_band = std::numeric_limits<size_t>::max();
+
+enum class Op
+{
+    unite,
+    intersect,
+    subtract
+};
+
+bool keeps(Op op, bool in_a, bool in_b)
+{
+    switch (op)
+    {
+    case Op::unite:
+        return in_a || in_b;
+    case Op::intersect:
+        return in_a && in_b;
+    case Op::subtract:
+        return in_a && !in_b;
+    }
+    return false;
+}
+
+/// Index one past the last box of the band starting at \a start
+auto end_of_band(Boxes const& boxes, size_t start) -> size_t
+{
+    auto end = start;
+    while (end < boxes.size() && boxes[end].y1 == boxes[start].y1)
+        ++end;
+    return end;
+}
+
+/// Combines the spans of two bands (either may be empty), as a sweep across their edges
+void combine_spans(
+    Box const* a, Box const* a_end,
+    Box const* b, Box const* b_end,
+    Op op,
+    std::vector<std::pair<int, int>>& spans)
+{
+    spans.clear();
+    bool in_a{false}, in_b{false}, inside{false};
+    int start{0};
+
+    while (a != a_end || b != b_end)
+    {
+        auto const xa = a != a_end ? (in_a ? a->x2 : a->x1) : unbounded;
+        auto const xb = b != b_end ? (in_b ? b->x2 : b->x1) : unbounded;
+        auto const x = std::min(xa, xb);
+
+        if (xa == x)
+        {
+            if (in_a)
+                ++a;
+            in_a = !in_a;
+        }
+        if (xb == x)
+        {
+            if (in_b)
+                ++b;
+            in_b = !in_b;
+        }
+
+        auto const now_inside = keeps(op, in_a, in_b);
+        if (now_inside != inside)
+        {
+            if (now_inside)
+                start = x;
+            else
+                spans.emplace_back(start, x);
+            inside = now_inside;
+        }
+    }
+}
+
+/// Appends a band, or stretches the one above down instead if it touches and is alike
+void append_band(
+    Boxes& out, size_t& last_band,
+    int top, int bottom,
+    std::vector<std::pair<int, int>> const& spans)
+{
+    if (spans.empty())
+        return;
+
+    auto const band = out.size();
+    if (last_band != no_band && out[last_band].y2 == top && band - last_band == spans.size() &&
+        std::equal(
+            spans.begin(), spans.end(), out.begin() + last_band,
+            [](auto const& span, Box const& box) { return span.first == box.x1 && span.second == box.x2; }))
+    {
+        for (auto i = last_band; i != band; ++i)
+            out[i].y2 = bottom;
+        return;
+    }
+
+    for (auto const& span : spans)
+        out.push_back({span.first, top, span.second, bottom});
+    last_band = band;
+}
+
+/// Walks down both regions a band at a time, splitting bands where the other region's start or end
+auto combine(Boxes const& a, Boxes const& b, Op op) -> Boxes
+{
+    Boxes out;
+    out.reserve(a.size() + b.size());
+    std::vector<std::pair<int, int>> spans;
+    auto last_band = no_band;
+
+    size_t ia{0}, ib{0};
+    auto ea = end_of_band(a, ia);
+    auto eb = end_of_band(b, ib);
+    auto y = std::numeric_limits<int>::min();
+
+    while (ia < a.size() || ib < b.size())
+    {
+        // Once the first region runs out, only a union has anything left to add
+        if (ia == a.size() && op != Op::unite)
+            break;
+        // ...and once the second does, intersecting does neither
+        if (ib == b.size() && op == Op::intersect)
+            break;
+
+        auto const a_here = ia < a.size() && a[ia].y1 <= y;
+        auto const b_here = ib < b.size() && b[ib].y1 <= y;
+
+        if (!a_here && !b_here)
+        {
+            y = std::min(ia < a.size() ? a[ia].y1 : unbounded, ib < b.size() ? b[ib].y1 : unbounded);
+            continue;
+        }
+
+        auto bottom = unbounded;
+        if (ia < a.size())
+            bottom = std::min(bottom, a_here ? a[ia].y2 : a[ia].y1);
+        if (ib < b.size())
+            bottom = std::min(bottom, b_here ? b[ib].y2 : b[ib].y1);
+
+        combine_spans(
+            a.data() + ia, a.data() + (a_here ? ea : ia),
+            b.data() + ib, b.data() + (b_here ? eb : ib),
+            op, spans);
+        append_band(out, last_band, y, bottom, spans);
+
+        y = bottom;
+        if (a_here && a[ia].y2 <= y)
+        {
+            ia = ea;
+            ea = end_of_band(a, ia);
+        }
+        if (b_here && b[ib].y2 <= y)
+        {
+            ib = eb;
+            eb = end_of_band(b, ib);
+        }
+    }
+
+    return out;
+}
+
+bool disjoint(Box const& a, Box const& b)
+{
+    return a.x2 <= b.x1 || b.x2 <= a.x1 || a.y2 <= b.y1 || b.y2 <= a.y1;
+}
+
+auto as_rectangle(Box const& box) -> geom::Rectangle
+{
+    return {{box.x1, box.y1}, {box.x2 - box.x1, box.y2 - box.y1}};
+}
+}
+
+geom::Region::Region()
+    : extents{0, 0, 0, 0}
+{
+}
+
+geom::Region::Region(Rectangle const& rect)
+    : Region()
+{
+    if (rect.size.width.as_int() > 0 && rect.size.height.as_int() > 0)
+    {
+        boxes_.push_back({rect.left().as_int(), rect.top().as_int(), rect.right().as_int(), rect.bottom().as_int()});
+        extents = boxes_.front();
+    }
+}
+
+geom::Region::Region(std::initializer_list<Rectangle> const& rects)
+    : Region(std::vector<Rectangle>{rects})
+{
+}
+
+geom::Region::Region(std::vector<Rectangle> const& rects)
+    : Region()
+{
+    // Uniting pairwise, then pairs of those and so on, keeps it O(n log n) rather than O(n²)
+    std::vector<Region> parts(rects.begin(), rects.end());
+    while (parts.size() > 1)
+    {
+        std::vector<Region> united;
+        united.reserve((parts.size() + 1) / 2);
+        for (size_t i = 0; i + 1 < parts.size(); i += 2)
+            united.push_back(parts[i] | parts[i + 1]);
+        if (parts.size() % 2)
+            united.push_back(std::move(parts.back()));
+        parts = std::move(united);
+    }
+
+    if (!parts.empty())
+        *this = std::move(parts.front());
+}
+
+geom::Region::Region(Rectangles const& rects)
+    : Region(std::vector<Rectangle>{rects.begin(), rects.end()})
+{
+}
+
+bool geom::Region::empty() const
+{
+    return boxes_.empty();
+}
+
+auto geom::Region::bounding_rectangle() const -> Rectangle
+{
+    if (empty())
+        return {};
+
+    return as_rectangle(extents);
+}
+
+bool geom::Region::contains(Point const& point) const
+{
+    auto const x = point.x.as_int();
+    auto const y = point.y.as_int();
+
+    if (empty() || x < extents.x1 || x >= extents.x2 || y < extents.y1 || y >= extents.y2)
+        return false;
+
+    // Bands are in order down the plane, so the first box ending below y starts the only band that can hold it
+    auto box = std::upper_bound(
+        boxes_.begin(), boxes_.end(), y, [](int y, Box const& box) { return y < box.y2; });
+    if (box == boxes_.end() || box->y1 > y)
+        return false;
+
+    for (auto const band_top = box->y1; box != boxes_.end() && box->y1 == band_top && box->x1 <= x; ++box)
+    {
+        if (x < box->x2)
+            return true;
+    }
+    return false;
+}
+
+bool geom::Region::contains(Rectangle const& rect) const
+{
+    Region const area{rect};
+    if (area.empty())
+        return true;
+    if (empty() || disjoint(area.extents, extents))
+        return false;
+
+    return combine(area.boxes_, boxes_, Op::subtract).empty();
+}
+
+bool geom::Region::overlaps(Rectangle const& rect) const
+{
+    Region const area{rect};
+    if (area.empty() || empty() || disjoint(area.extents, extents))
+        return false;
+
+    return !combine(boxes_, area.boxes_, Op::intersect).empty();
+}
+
+auto geom::Region::operator|=(Region const& other) -> Region&
+{
+    if (other.empty())
+        return *this;
+    if (empty())
+        return *this = other;
+
+    boxes_ = combine(boxes_, other.boxes_, Op::unite);
+    update_extents();
+    return *this;
+}
+
+auto geom::Region::operator&=(Region const& other) -> Region&
+{
+    if (empty() || other.empty() || disjoint(extents, other.extents))
+    {
+        boxes_.clear();
+    }
+    else
+    {
+        boxes_ = combine(boxes_, other.boxes_, Op::intersect);
+    }
+    update_extents();
+    return *this;
+}
+
+auto geom::Region::operator-=(Region const& other) -> Region&
+{
+    if (empty() || other.empty() || disjoint(extents, other.extents))
+        return *this;
+
+    boxes_ = combine(boxes_, other.boxes_, Op::subtract);
+    update_extents();
+    return *this;
+}
+
+void geom::Region::translate(Displacement const& offset)
+{
+    auto const dx = offset.dx.as_int();
+    auto const dy = offset.dy.as_int();
+
+    for (auto& box : boxes_)
+    {
+        box.x1 += dx;
+        box.y1 += dy;
+        box.x2 += dx;
+        box.y2 += dy;
+    }
+    update_extents();
+}
+
+auto geom::Region::rectangles() const -> std::vector<Rectangle>
+{
+    std::vector<Rectangle> result;
+    result.reserve(boxes_.size());
+    for (auto const& box : boxes_)
+        result.push_back(as_rectangle(box));
+    return result;
+}
+
+bool geom::Region::operator==(Region const& other) const
+{
+    // Banding leaves an area just the one representation, so equal areas have equal boxes
+    return std::equal(
+        boxes_.begin(), boxes_.end(), other.boxes_.begin(), other.boxes_.end(),
+        [](Box const& a, Box const& b) { return a.x1 == b.x1 && a.y1 == b.y1 && a.x2 == b.x2 && a.y2 == b.y2; });
+}
+
+bool geom::Region::operator!=(Region const& other) const
+{
+    return !(*this == other);
+}
+
+void geom::Region::update_extents()
+{
+    if (boxes_.empty())
+    {
+        extents = {0, 0, 0, 0};
+        return;
+    }
+
+    extents = {boxes_.front().x1, boxes_.front().y1, boxes_.front().x2, boxes_.back().y2};
+    for (auto const& box : boxes_)
+    {
+        extents.x1 = std::min(extents.x1, box.x1);
+        extents.x2 = std::max(extents.x2, box.x2);
+    }
+}
+
+std::ostream& geom::operator<<(std::ostream& out, Region const& value)
+{
+    out << '[';
+    for (auto const& rect : value.rectangles())
+        out << rect << ", ";
+    out << ']';
+    return out;
+}
@@ -36,13 +36,29 @@ mgl::Primitive mgl::tessellate_renderable_into_rectangle(
     mgl::Primitive rectangle;
     rectangle.type = GL_TRIANGLE_STRIP;
 
-    GLfloat const tex_right = 1.0f;
-    GLfloat const tex_bottom = 1.0f;
+    // Only the src_bounds() of the buffer is shown, so the texture
+    // coordinates (normalised to the whole buffer) span just that part.
+    GLfloat tex_left = 0.0f;
+    GLfloat tex_top = 0.0f;
+    GLfloat tex_right = 1.0f;
+    GLfloat tex_bottom = 1.0f;
+
+    auto const buffer_size = renderable.buffer()->size();
+    if (buffer_size.width.as_int() > 0 && buffer_size.height.as_int() > 0)
+    {
+        auto const src = renderable.src_bounds();
+        GLfloat const width = buffer_size.width.as_int();
+        GLfloat const height = buffer_size.height.as_int();
+        tex_left = src.top_left.x.as_value() / width;
+        tex_top = src.top_left.y.as_value() / height;
+        tex_right = (src.top_left.x.as_value() + src.size.width.as_value()) / width;
+        tex_bottom = (src.top_left.y.as_value() + src.size.height.as_value()) / height;
+    }
 
     auto& vertices = rectangle.vertices;
-    vertices[0] = {{left,  top,    0.0f}, {0.0f,      0.0f}};
-    vertices[1] = {{left,  bottom, 0.0f}, {0.0f,      tex_bottom}};
-    vertices[2] = {{right, top,    0.0f}, {tex_right, 0.0f}};
+    vertices[0] = {{left,  top,    0.0f}, {tex_left,  tex_top}};
+    vertices[1] = {{left,  bottom, 0.0f}, {tex_left,  tex_bottom}};
+    vertices[2] = {{right, top,    0.0f}, {tex_right, tex_top}};
     vertices[3] = {{right, bottom, 0.0f}, {tex_right, tex_bottom}};
     return rectangle;
 }
@@ -0,0 +1,83 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_EVENT_RING_H_
+#define MIR_EVENT_RING_H_
+
+#include "mir/fd.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace mir
+{
+/**
+ * A ring of serialized events in memory shared between the server and a client
+ *
+ * There is one writer (the server) and one reader (the client); callers serialize access
+ * on each side. The writer rings the doorbell (an eventfd) only when the reader may have
+ * found the ring empty, so a burst of events costs a single wake-up.
+ *
+ * The reader trusts the writer. The writer doesn't trust the reader, and stops writing
+ * if the reader's position in the ring is nonsense.
+ */
+class EventRing
+{
+public:
+    /// Creates a ring of (a little over) \a size bytes, with its own memory and doorbell
+    explicit EventRing(size_t size);
+
+    /// Maps a ring created by another process
+    EventRing(Fd const& memory, Fd const& doorbell);
+
+    ~EventRing();
+
+    auto memory() const -> Fd { return memory_fd; }
+    auto doorbell() const -> Fd { return doorbell_fd; }
+
+    /**
+     * Appends a record, ringing the doorbell if the reader may be idle
+     *
+     * \return false, having written nothing, if the record doesn't fit
+     */
+    bool write(void const* data, size_t size);
+
+    /**
+     * Clears the doorbell, then calls \a handler for each record in the ring
+     *
+     * The data passed to \a handler is 8-byte aligned and valid only for the duration of the call.
+     */
+    void read(std::function<void(void const* data, size_t size)> const& handler);
+
+private:
+    EventRing(EventRing const&) = delete;
+    EventRing& operator=(EventRing const&) = delete;
+
+    struct Header;
+
+    Fd const memory_fd;
+    Fd const doorbell_fd;
+    size_t const mapped_size;
+    void* const mapping;
+    Header* const header;
+    char* const records;
+    size_t const capacity;
+    uint64_t position{0};   ///< The writer's head, or the reader's tail
+};
+}
+
+#endif // MIR_EVENT_RING_H_
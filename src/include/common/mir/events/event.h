@@ -65,12 +65,19 @@ struct MirEvent
     MirWindowPlacementEvent const* to_window_placement() const;
 
     static mir::EventUPtr deserialize(std::string const& bytes);
+    /// \param bytes   must be 8-byte aligned
+    static mir::EventUPtr deserialize(void const* bytes, size_t size);
     static std::string serialize(MirEvent const* event);
 
 protected:
     MirEvent() = default;
 
-    ::capnp::MallocMessageBuilder message;
+    /// The message's first segment, big enough for any input event (even a touch with every contact)
+    /// MallocMessageBuilder would otherwise make a separate 8KiB allocation for each event, and for each copy
+    static size_t constexpr inline_segment_words{128};
+    ::capnp::word inline_segment[inline_segment_words]{};
+
+    ::capnp::MallocMessageBuilder message{kj::arrayPtr(inline_segment, inline_segment_words)};
     mir::capnp::Event::Builder event{message.initRoot<mir::capnp::Event>()};
 };
 
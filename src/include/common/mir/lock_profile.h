@@ -0,0 +1,114 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef MIR_LOCK_PROFILE_H_
+#define MIR_LOCK_PROFILE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+namespace mir
+{
+/**
+ * How often the locks of one name are taken, waited for and held
+ *
+ * Profiles are meant to be static, one per kind of lock: every BasicSurface's mutex counts towards the one
+ * "BasicSurface" profile. Like MemoryAccounts they list themselves for for_each_lock_profile() while they exist.
+ *
+ * Nothing is recorded until profiling is enabled (by --lock-report), and then only for locks that opt in by being a
+ * ProfiledMutex, a ProfiledSharedMutex, or a RecursiveReadWriteMutex given a profile. While disabled, a profiled
+ * lock costs a relaxed load more than the lock it wraps.
+ */
+class LockProfile
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Totals
+    {
+        uint64_t acquisitions;
+        uint64_t contended;                 ///< Acquisitions that had to wait
+        std::chrono::nanoseconds waited;
+        std::chrono::nanoseconds longest_wait;
+        std::chrono::nanoseconds held;      ///< Exclusively: shared holds overlap, so aren't summed
+        std::chrono::nanoseconds longest_hold;
+    };
+
+    /// \a name must outlive the profile (a string literal, in practice)
+    explicit LockProfile(char const* name);
+    ~LockProfile();
+
+    static void enable(bool enabled);
+
+    static bool enabled()
+    {
+        return profiling.load(std::memory_order_relaxed);
+    }
+
+    void acquired_uncontended()
+    {
+        acquisitions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void acquired_after(std::chrono::nanoseconds wait)
+    {
+        acquisitions.fetch_add(1, std::memory_order_relaxed);
+        contended.fetch_add(1, std::memory_order_relaxed);
+        waited_ns.fetch_add(wait.count(), std::memory_order_relaxed);
+        raise(longest_wait_ns, wait.count());
+    }
+
+    void held_for(std::chrono::nanoseconds hold)
+    {
+        held_ns.fetch_add(hold.count(), std::memory_order_relaxed);
+        raise(longest_hold_ns, hold.count());
+    }
+
+    /// Everything since the server started (or since profiling was enabled)
+    auto totals() const -> Totals;
+
+    char const* const name;
+
+private:
+    LockProfile(LockProfile const&) = delete;
+    LockProfile& operator=(LockProfile const&) = delete;
+
+    static void raise(std::atomic<int64_t>& maximum, int64_t value)
+    {
+        auto current = maximum.load(std::memory_order_relaxed);
+        while (value > current && !maximum.compare_exchange_weak(current, value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    static std::atomic<bool> profiling;
+
+    std::atomic<uint64_t> acquisitions{0};
+    std::atomic<uint64_t> contended{0};
+    std::atomic<int64_t> waited_ns{0};
+    std::atomic<int64_t> longest_wait_ns{0};
+    std::atomic<int64_t> held_ns{0};
+    std::atomic<int64_t> longest_hold_ns{0};
+};
+
+/// Calls \a f for each profile in existence, in no particular order
+void for_each_lock_profile(std::function<void(LockProfile const&)> const& f);
+}
+
+#endif // MIR_LOCK_PROFILE_H_
@@ -41,6 +41,9 @@ public:
     void loading_failed(boost::filesystem::path const& /*filename*/, std::exception const& /*error*/) override
     {
     }
+    void library_skipped(boost::filesystem::path const& /*filename*/, std::string const& /*requirement*/) override
+    {
+    }
 };
 
 }
@@ -37,6 +37,7 @@ public:
     void probing_failed(boost::filesystem::path const& path, std::exception const& error) override;
     void loading_library(boost::filesystem::path const& filename) override;
     void loading_failed(boost::filesystem::path const& filename, std::exception const& error) override;
+    void library_skipped(boost::filesystem::path const& filename, std::string const& requirement) override;
 
 private:
     std::shared_ptr<Logger> const logger;
@@ -0,0 +1,112 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_MEMORY_ACCOUNT_H_
+#define MIR_MEMORY_ACCOUNT_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace mir
+{
+/**
+ * The objects of one kind, and the memory they hold, in one subsystem
+ *
+ * Accounts are cheap enough to keep in release builds: each is a pair of counters,
+ * charged when an object is created and refunded when it's destroyed. They're meant
+ * to be static, and list themselves for for_each_memory_account() while they exist.
+ *
+ * Bytes are what the object holds or pins beyond its own size, so accounts that only
+ * count objects (protocol objects, say) charge nothing.
+ */
+class MemoryAccount
+{
+public:
+    /// \a subsystem and \a kind must outlive the account (string literals, in practice)
+    MemoryAccount(char const* subsystem, char const* kind);
+    ~MemoryAccount();
+
+    void allocated(size_t bytes)
+    {
+        objects_.fetch_add(1, std::memory_order_relaxed);
+        bytes_.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    void freed(size_t bytes)
+    {
+        objects_.fetch_sub(1, std::memory_order_relaxed);
+        bytes_.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    void resized(size_t from, size_t to)
+    {
+        bytes_.fetch_add(static_cast<int64_t>(to) - static_cast<int64_t>(from), std::memory_order_relaxed);
+    }
+
+    auto objects() const -> int64_t { return objects_.load(std::memory_order_relaxed); }
+    auto bytes() const -> int64_t { return bytes_.load(std::memory_order_relaxed); }
+
+    char const* const subsystem;
+    char const* const kind;
+
+private:
+    MemoryAccount(MemoryAccount const&) = delete;
+    MemoryAccount& operator=(MemoryAccount const&) = delete;
+
+    std::atomic<int64_t> objects_{0};
+    std::atomic<int64_t> bytes_{0};
+};
+
+/// Calls \a f for each account in existence, in no particular order
+void for_each_memory_account(std::function<void(MemoryAccount const&)> const& f);
+
+/// Charges an account for the lifetime of the object it's a member of
+class MemoryCharge
+{
+public:
+    explicit MemoryCharge(MemoryAccount& account, size_t bytes = 0)
+        : account{account},
+          bytes_{bytes}
+    {
+        account.allocated(bytes_);
+    }
+
+    ~MemoryCharge()
+    {
+        account.freed(bytes_);
+    }
+
+    /// For objects whose holdings change size
+    void resize(size_t bytes)
+    {
+        account.resized(bytes_, bytes);
+        bytes_ = bytes;
+    }
+
+    auto bytes() const -> size_t { return bytes_; }
+
+private:
+    MemoryCharge(MemoryCharge const&) = delete;
+    MemoryCharge& operator=(MemoryCharge const&) = delete;
+
+    MemoryAccount& account;
+    size_t bytes_;
+};
+}
+
+#endif // MIR_MEMORY_ACCOUNT_H_
@@ -0,0 +1,139 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef MIR_PROFILED_MUTEX_H_
+#define MIR_PROFILED_MUTEX_H_
+
+#include "mir/lock_profile.h"
+
+#include <mutex>
+#include <shared_mutex>
+
+namespace mir
+{
+/**
+ * A mutex that records, in a LockProfile, how long it's waited for and held
+ *
+ * A drop-in for the Mutex it wraps (with std::lock_guard, std::unique_lock, std::shared_lock or Synchronised),
+ * except for std::condition_variable, which needs a std::mutex: use std::condition_variable_any with it.
+ *
+ * Exclusive holds are timed; shared holds overlap, so only the wait for them is recorded.
+ */
+template<typename Mutex>
+class BasicProfiledMutex
+{
+public:
+    explicit BasicProfiledMutex(LockProfile& profile)
+        : profile{profile}
+    {
+    }
+
+    void lock()
+    {
+        if (!LockProfile::enabled())
+        {
+            mutex.lock();
+            return;
+        }
+
+        if (mutex.try_lock())
+        {
+            profile.acquired_uncontended();
+        }
+        else
+        {
+            auto const start = LockProfile::Clock::now();
+            mutex.lock();
+            profile.acquired_after(LockProfile::Clock::now() - start);
+        }
+        acquired = LockProfile::Clock::now();
+    }
+
+    bool try_lock()
+    {
+        if (!mutex.try_lock())
+            return false;
+
+        if (LockProfile::enabled())
+        {
+            profile.acquired_uncontended();
+            acquired = LockProfile::Clock::now();
+        }
+        return true;
+    }
+
+    void unlock()
+    {
+        // Not timed if profiling was enabled while we held the lock
+        if (acquired != LockProfile::Clock::time_point{})
+        {
+            profile.held_for(LockProfile::Clock::now() - acquired);
+            acquired = {};
+        }
+        mutex.unlock();
+    }
+
+    void lock_shared()
+    {
+        if (!LockProfile::enabled())
+        {
+            mutex.lock_shared();
+            return;
+        }
+
+        if (mutex.try_lock_shared())
+        {
+            profile.acquired_uncontended();
+        }
+        else
+        {
+            auto const start = LockProfile::Clock::now();
+            mutex.lock_shared();
+            profile.acquired_after(LockProfile::Clock::now() - start);
+        }
+    }
+
+    bool try_lock_shared()
+    {
+        if (!mutex.try_lock_shared())
+            return false;
+
+        if (LockProfile::enabled())
+            profile.acquired_uncontended();
+        return true;
+    }
+
+    void unlock_shared()
+    {
+        mutex.unlock_shared();
+    }
+
+private:
+    BasicProfiledMutex(BasicProfiledMutex const&) = delete;
+    BasicProfiledMutex& operator=(BasicProfiledMutex const&) = delete;
+
+    Mutex mutex;
+    LockProfile& profile;
+    /// Only touched by the thread holding the lock exclusively
+    LockProfile::Clock::time_point acquired;
+};
+
+using ProfiledMutex = BasicProfiledMutex<std::mutex>;
+using ProfiledSharedMutex = BasicProfiledMutex<std::shared_mutex>;
+}
+
+#endif // MIR_PROFILED_MUTEX_H_
@@ -19,18 +19,30 @@
 #ifndef MIR_RECURSIVE_READ_WRITE_MUTEX_H_
 #define MIR_RECURSIVE_READ_WRITE_MUTEX_H_
 
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <cstdint>
+#include <mutex>
 #include <thread>
-#include <vector>
 
 namespace mir
 {
+class LockProfile;
+
 /** a recursive read-write mutex.
  * Note that a write lock can be acquired if no other threads have a read lock.
+ * Each thread keeps its own count of read locks, so an uncontended read lock is a single atomic
+ * operation. A thread waiting for the write lock holds off new (but not recursive) read locks, so
+ * that a stream of readers can't starve it.
  */
 class RecursiveReadWriteMutex
 {
 public:
+    RecursiveReadWriteMutex() = default;
+    /// Records waits for either lock, and how long the (outermost) write lock is held, in \a profile
+    explicit RecursiveReadWriteMutex(LockProfile& profile);
+
     void read_lock();
 
     void read_unlock();
@@ -40,17 +52,23 @@ public:
     void write_unlock();
 
 private:
+    static auto next_id() -> std::uint64_t;
+    void release_read();
+
+    /// The number of threads holding a read lock, plus write_pending while a writer waits or holds the lock
+    std::atomic<unsigned> state{0};
+    /// Identifies this mutex in each thread's read lock counts; unlike its address, it's never reused
+    std::uint64_t const id{next_id()};
+
     std::mutex mutex;
     std::condition_variable cv;
-    struct ThreadLockCount
-    {
-        ThreadLockCount() : id(), count(0) {}
-        ThreadLockCount(std::thread::id id, unsigned int count) : id(id), count(count) {}
-        std::thread::id id;
-        unsigned int count;
-    };
-    std::vector<ThreadLockCount> read_locking_threads;
-    ThreadLockCount write_locking_thread;
+    /// The thread waiting for, or holding, the write lock. Only changed with mutex locked
+    std::atomic<std::thread::id> write_locking_thread{};
+    bool write_acquired{false};     ///< Guarded by mutex
+    unsigned write_count{0};        ///< Only touched by the thread holding the write lock
+
+    LockProfile* const profile{nullptr};
+    std::chrono::steady_clock::time_point write_locked;    ///< When profiled
 };
 
 class RecursiveReadLock
@@ -20,6 +20,7 @@
 #define MIR_SHARED_LIBRARY_PROBER_REPORT_H_
 
 #include <boost/filesystem.hpp>
+#include <string>
 
 namespace mir
 {
@@ -32,6 +33,8 @@ public:
     virtual void probing_failed(boost::filesystem::path const& path, std::exception const& error) = 0;
     virtual void loading_library(boost::filesystem::path const& filename) = 0;
     virtual void loading_failed(boost::filesystem::path const& filename, std::exception const& error) = 0;
+    /// The library wasn't loaded, as its manifest has a requirement the system doesn't meet
+    virtual void library_skipped(boost::filesystem::path const& filename, std::string const& requirement) = 0;
 
 protected:
     SharedLibraryProberReport() = default;
@@ -19,11 +19,16 @@
 #ifndef MIR_THREAD_NAME_H_
 #define MIR_THREAD_NAME_H_
 
+#include <functional>
 #include <string>
 
 namespace mir
 {
 void set_thread_name(std::string const& name);
+
+/// Calls hook on each thread set_thread_name() names, with the full (untruncated) name.
+/// Replaces any previous hook; an empty hook removes it.
+void set_thread_name_hook(std::function<void(std::string const& name)> const& hook);
 }
 
 #endif /* MIR_THREAD_NAME_H_ */
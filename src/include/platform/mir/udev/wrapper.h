@@ -21,6 +21,7 @@
 
 #include <functional>
 #include <memory>
+#include <string>
 #include <libudev.h>
 
 namespace mir
@@ -73,6 +74,9 @@ protected:
 bool operator==(Device const& lhs, Device const& rhs);
 bool operator!=(Device const& lhs, Device const& rhs);
 
+/// The seat udev assigns the device to (its ID_SEAT), "seat0" if none
+auto seat_of(Device const& device) -> std::string;
+
 class Enumerator
 {
 public:
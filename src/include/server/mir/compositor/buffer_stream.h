@@ -24,7 +24,9 @@
 #include "mir/frontend/buffer_stream.h"
 #include "mir_toolkit/common.h"
 #include "mir/graphics/buffer_id.h"
+#include "mir/geometry/rectangles.h"
 
+#include <experimental/optional>
 #include <memory>
 
 namespace mir
@@ -36,6 +38,7 @@ class Buffer;
 
 namespace compositor
 {
+struct Presentation;
 
 class BufferStream : public frontend::BufferStream
 {
@@ -45,10 +48,26 @@ public:
     virtual auto lock_compositor_buffer(void const* user_id) -> std::shared_ptr<graphics::Buffer> = 0;
     /// Logical size of the stream (may be different than buffer sizes if scaled)
     virtual auto stream_size() -> geometry::Size = 0;
+    /// The area (in buffer coordinates) of a buffer of buffer_size that is shown, given set_viewport()
+    virtual auto source_bounds(geometry::Size const& buffer_size) const -> geometry::RectangleF = 0;
     virtual auto buffers_ready_for_compositor(void const* user_id) const -> int = 0;
     virtual void drop_old_buffers() = 0;
     virtual auto has_submitted_buffer() const -> bool = 0;
     virtual auto framedropping() const -> bool = 0;
+    /**
+     * The area (in buffer coordinates) in which the buffer most recently
+     * returned by lock_compositor_buffer(user_id) differs from the one
+     * returned to user_id before it.
+     *
+     * \returns nullopt if the damage is unknown and the whole buffer must be
+     *          assumed to have changed.
+     */
+    virtual auto buffer_damage(void const* user_id) const
+        -> std::experimental::optional<geometry::Rectangles> = 0;
+    /// The area most recently given to set_opaque_region() (in logical stream coordinates)
+    virtual auto opaque_region() const -> geometry::Rectangles = 0;
+    /// Passes the presentation of a buffer from this stream to the frame presented callback
+    virtual void frame_presented(Presentation const& presentation) = 0;
 };
 
 }
@@ -21,6 +21,10 @@
 
 namespace mir
 {
+namespace graphics
+{
+class DisplaySyncGroup;
+}
 namespace compositor
 {
 
@@ -32,6 +36,20 @@ public:
     virtual void start() = 0;
     virtual void stop() = 0;
 
+    /// Stops compositing for a while (e.g. a VT switch), keeping what compositing has built up
+    virtual void pause() = 0;
+    /// Carries on compositing after pause(), starting with a full repaint
+    virtual void resume() = 0;
+
+    /// Stops compositing to \a group, so the display can destroy it
+    virtual void stop_compositing(graphics::DisplaySyncGroup& group) = 0;
+    /// Starts compositing to the display's sync groups that aren't being composited, if started
+    virtual void start_compositing_new_groups() = 0;
+    /// Stops compositing to \a group while its outputs are powered off, keeping its renderers
+    virtual void suspend_compositing(graphics::DisplaySyncGroup& group) = 0;
+    /// Carries on compositing to \a group after suspend_compositing(), starting with a fresh frame
+    virtual void resume_compositing(graphics::DisplaySyncGroup& group) = 0;
+
 protected:
     Compositor() = default;
     Compositor(Compositor const&) = delete;
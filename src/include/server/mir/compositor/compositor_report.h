@@ -21,6 +21,8 @@
 
 #include "mir/graphics/renderable.h"
 
+#include <chrono>
+
 namespace mir
 {
 namespace compositor
@@ -34,6 +36,8 @@ public:
     virtual void began_frame(SubCompositorId id) = 0;
     virtual void renderables_in_frame(SubCompositorId id, graphics::RenderableList const& renderables) = 0;
     virtual void rendered_frame(SubCompositorId id) = 0;
+    /// How long the GPU took to render a recent frame (measured frames are reported a frame or more late)
+    virtual void measured_gpu_render_time(SubCompositorId id, std::chrono::nanoseconds gpu_time) = 0;
     virtual void finished_frame(SubCompositorId id) = 0;
     virtual void started() = 0;
     virtual void stopped() = 0;
@@ -0,0 +1,44 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_COMPOSITOR_PRESENTATION_H_
+#define MIR_COMPOSITOR_PRESENTATION_H_
+
+#include "mir/graphics/buffer_id.h"
+#include "mir/graphics/frame.h"
+#include "mir/geometry/rectangle.h"
+
+namespace mir
+{
+namespace compositor
+{
+/// How a buffer reached the screen
+struct Presentation
+{
+    graphics::BufferID buffer;
+    /// A default Frame if the platform can't tell when the flip happened
+    graphics::Frame frame;
+    /// The view area of the output it was shown on
+    geometry::Rectangle output_area;
+    /// Whether the buffer was scanned out directly, rather than composited
+    bool zero_copy;
+    /// Where the buffer was shown, in the same coordinates as output_area
+    geometry::Rectangle placement;
+};
+}
+}
+
+#endif // MIR_COMPOSITOR_PRESENTATION_H_
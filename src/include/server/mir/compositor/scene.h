@@ -54,10 +54,12 @@ public:
      *                     a new (different) sequence to that user each time. For
      *                     consistency, all callers need to determine their id
      *                     in the same way (e.g. always use "this" pointer).
+     * \param [in] area    The part of the scene the compositor shows. Elements
+     *                     that can't appear in it may be left out.
      * \returns a sequence of SceneElements for the compositor id. The
      *          sequence is in stacking order from back to front.
      */
-    virtual SceneElementSequence scene_elements_for(CompositorID id) = 0;
+    virtual SceneElementSequence scene_elements_for(CompositorID id, geometry::Rectangle const& area) = 0;
 
     /**
      * Return the number of additional frames that you need to render to get
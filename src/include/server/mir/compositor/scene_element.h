@@ -19,13 +19,19 @@
 #ifndef MIR_COMPOSITOR_SCENE_ELEMENT_H_
 #define MIR_COMPOSITOR_SCENE_ELEMENT_H_
 
+#include <functional>
 #include <memory>
 
 namespace mir
 {
+namespace geometry
+{
+struct Rectangle;
+}
 namespace graphics
 {
 class Renderable;
+struct Frame;
 }
 namespace compositor
 {
@@ -33,11 +39,22 @@ class Decoration;
 class SceneElement
 {
 public:
+    using PresentationCallback =
+        std::function<void(graphics::Frame const& frame, geometry::Rectangle const& output_area)>;
+
     virtual ~SceneElement() = default;
 
     virtual std::shared_ptr<graphics::Renderable> renderable() const = 0;
     virtual void rendered() = 0;
     virtual void occluded() = 0;
+    /// The display took the renderable onto a hardware plane, so it is on screen without being composited
+    virtual void scanned_out() = 0;
+    /**
+     * Something to call once the frame the element is rendered into reaches the output showing
+     * output_area, or an empty function if nothing is interested. Unlike the element, it doesn't
+     * keep the renderable's buffer from its client.
+     */
+    virtual auto presentation_callback() -> PresentationCallback = 0;
 
 protected:
     SceneElement() = default;
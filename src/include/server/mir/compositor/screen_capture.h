@@ -0,0 +1,115 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_COMPOSITOR_SCREEN_CAPTURE_H_
+#define MIR_COMPOSITOR_SCREEN_CAPTURE_H_
+
+#include "mir/geometry/rectangle.h"
+#include "mir/geometry/rectangles.h"
+#include "mir/geometry/dimensions.h"
+
+#include <chrono>
+#include <experimental/optional>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace mir
+{
+namespace renderer
+{
+class Renderer;
+}
+namespace compositor
+{
+/**
+ * Copies of what the compositor renders, for screencasting
+ *
+ * Captures are read back from the frames the compositor renders anyway, just
+ * before they go to the screen, so capturing adds no composition of its own.
+ * A capture that waits for damage is only taken from a frame that changes
+ * something it shows.
+ */
+class ScreenCapture
+{
+public:
+    /// A captured frame: valid only during the callback
+    struct Frame
+    {
+        /// Empty if the frame couldn't be captured
+        geometry::Size size;
+        geometry::Stride stride;
+        /// 0xAARRGGBB pixels, top row first
+        void const* pixels;
+        /// What changed since the capture was requested, relative to the captured area
+        geometry::Rectangles damage;
+        /// When the frame was rendered, on CLOCK_MONOTONIC
+        std::chrono::nanoseconds time;
+    };
+
+    using Callback = std::function<void(Frame const& frame)>;
+
+    /// A pending capture. Destroying it cancels the capture (waiting for the callback if that's in progress).
+    class Request
+    {
+    public:
+        virtual ~Request() = default;
+
+    protected:
+        Request() = default;
+        Request(Request const&) = delete;
+        Request& operator=(Request const&) = delete;
+    };
+
+    /// \param schedule_frame   asks the compositor for a frame, even if the scene hasn't changed
+    explicit ScreenCapture(std::function<void()> const& schedule_frame);
+    ~ScreenCapture();
+
+    /**
+     * Captures \a area (in screen coordinates) from the next frame rendered of
+     * an output that shows all of it. With \a with_damage, frames that don't
+     * change \a area are skipped. \a callback is called once, on a compositor
+     * thread.
+     */
+    auto capture(geometry::Rectangle const& area, bool with_damage, Callback const& callback)
+        -> std::unique_ptr<Request>;
+
+    /// Whether a capture wants a frame of view_area rendered (rather than, say, scanned out directly)
+    auto wants_frame_of(geometry::Rectangle const& view_area) const -> bool;
+
+    /**
+     * Called by the compositor before it renders view_area: notes the damage
+     * (nullopt meaning all of it) and asks the renderer to read back the
+     * captures that the frame completes.
+     */
+    void prepare_frame(
+        geometry::Rectangle const& view_area,
+        std::experimental::optional<geometry::Rectangles> const& damage,
+        renderer::Renderer& renderer);
+
+private:
+    struct Pending;
+    class PendingRequest;
+
+    std::function<void()> const schedule_frame;
+    std::mutex mutable mutex;
+    std::vector<std::shared_ptr<Pending>> pending;
+};
+}
+}
+
+#endif // MIR_COMPOSITOR_SCREEN_CAPTURE_H_
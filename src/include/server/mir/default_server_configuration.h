@@ -30,6 +30,7 @@ namespace mir
 class ServerActionQueue;
 class SharedLibrary;
 class SharedLibraryProberReport;
+class StartupReport;
 
 template<class Observer>
 class ObserverRegistrar;
@@ -55,6 +56,7 @@ class Drawer;
 class DisplayBufferCompositorFactory;
 class Compositor;
 class CompositorReport;
+class ScreenCapture;
 }
 namespace frontend
 {
@@ -90,6 +92,7 @@ namespace detail { class FrontendShell; }
 namespace time
 {
 class Clock;
+class AlarmFactory;
 }
 namespace scene
 {
@@ -117,6 +120,7 @@ class Display;
 class DisplayReport;
 class DisplayConfigurationObserver;
 class GraphicBufferAllocator;
+class BufferPool;
 class Cursor;
 class CursorImage;
 class GLConfig;
@@ -159,6 +163,8 @@ class Configuration;
 namespace report
 {
 class ReportFactory;
+namespace metrics { class Registry; }
+class PerformanceHud;
 }
 
 namespace renderer
@@ -251,12 +257,15 @@ public:
     virtual std::shared_ptr<compositor::DisplayBufferCompositorFactory> the_display_buffer_compositor_factory();
     virtual std::shared_ptr<compositor::DisplayBufferCompositorFactory> wrap_display_buffer_compositor_factory(
         std::shared_ptr<compositor::DisplayBufferCompositorFactory> const& wrapped);
+    virtual std::shared_ptr<compositor::ScreenCapture> the_screen_capture();
     /** @} */
 
     /** @name compositor configuration - dependencies
      * dependencies of compositor on the rest of the Mir
      *  @{ */
     virtual std::shared_ptr<graphics::GraphicBufferAllocator> the_buffer_allocator();
+    /// Recycles the buffers drawn in-process (decorations, software cursors and in-process clients) through the_buffer_allocator()
+    virtual std::shared_ptr<graphics::BufferPool>             the_buffer_pool();
     virtual std::shared_ptr<compositor::Scene>                  the_scene();
     /** @} */
 
@@ -346,6 +355,8 @@ public:
 
     // new input reading related parts:
     virtual std::shared_ptr<dispatch::MultiplexingDispatchable> the_input_reading_multiplexer();
+    /// Alarms that fire on the input thread (such as key repeat)
+    virtual std::shared_ptr<time::AlarmFactory> the_input_alarm_factory();
     virtual std::shared_ptr<input::InputDeviceRegistry> the_input_device_registry();
     virtual std::shared_ptr<input::InputDeviceHub> the_input_device_hub();
     virtual std::shared_ptr<input::SurfaceInputDispatcher> the_surface_input_dispatcher();
@@ -363,6 +374,16 @@ public:
 
     virtual std::shared_ptr<ConsoleServices> the_console_services();
     auto default_reports() -> std::shared_ptr<void>;
+    /// Records the scene to --scene-record, and replays --scene-replay into it, for as long as it's held
+    auto scene_recording() -> std::shared_ptr<void>;
+    /// Moves client processes between the --app-scheduling cgroups, for as long as it's held
+    auto application_scheduling() -> std::shared_ptr<void>;
+    /// Draws the --performance-hud over the scene (and toggles it on Ctrl+Alt+Shift+H), for as long as it's held
+    auto performance_hud_overlay() -> std::shared_ptr<void>;
+    /// The metrics maintained by reports set to "metrics", served on --metrics-socket while any exist
+    auto the_metrics_registry() -> std::shared_ptr<report::metrics::Registry>;
+    /// Marks the phases of startup, as set by --startup-report
+    auto the_startup_report() -> std::shared_ptr<StartupReport>;
 
 private:
     // We need to ensure the platform library is destroyed last as the
@@ -408,6 +429,7 @@ protected:
     CachedPtr<input::DefaultInputDeviceHub>    default_input_device_hub;
     CachedPtr<input::InputDeviceHub>    input_device_hub;
     CachedPtr<dispatch::MultiplexingDispatchable> input_reading_multiplexer;
+    CachedPtr<time::AlarmFactory> input_alarm_factory;
     CachedPtr<input::InputDispatcher> input_dispatcher;
     CachedPtr<shell::InputTargeter> input_targeter;
     CachedPtr<input::CursorListener> cursor_listener;
@@ -415,6 +437,7 @@ protected:
     CachedPtr<input::Seat> seat;
     CachedPtr<graphics::Platform>     graphics_platform;
     CachedPtr<graphics::GraphicBufferAllocator> buffer_allocator;
+    CachedPtr<graphics::BufferPool>   buffer_pool;
     CachedPtr<graphics::Display>      display;
     CachedPtr<graphics::Cursor>       cursor;
     CachedPtr<graphics::CursorImage>  default_cursor_image;
@@ -443,6 +466,7 @@ protected:
     CachedPtr<compositor::DisplayBufferCompositorFactory> display_buffer_compositor_factory;
     CachedPtr<compositor::Compositor> compositor;
     CachedPtr<compositor::CompositorReport> compositor_report;
+    CachedPtr<compositor::ScreenCapture> screen_capture;
     CachedPtr<logging::Logger> logger;
     CachedPtr<graphics::DisplayReport> display_report;
     CachedPtr<time::Clock> clock;
@@ -462,6 +486,7 @@ protected:
     CachedPtr<SharedLibraryProberReport> shared_library_prober_report;
     CachedPtr<shell::Shell> shell;
     CachedPtr<shell::ShellReport> shell_report;
+    CachedPtr<StartupReport> startup_report;
     CachedPtr<shell::decoration::Manager> decoration_manager;
     CachedPtr<scene::ApplicationNotRespondingDetector> application_not_responding_detector;
     CachedPtr<cookie::Authority> cookie_authority;
@@ -487,6 +512,11 @@ private:
     std::shared_ptr<scene::BroadcastingSessionEventSink> the_broadcasting_session_event_sink();
 
     auto report_factory(char const* report_opt) -> std::unique_ptr<report::ReportFactory>;
+    CachedPtr<report::metrics::Registry> metrics_registry;
+
+    /// The metrics gathered for the --performance-hud, or null if it's off
+    auto the_performance_hud() -> std::shared_ptr<report::PerformanceHud>;
+    CachedPtr<report::PerformanceHud> performance_hud;
 
     CachedPtr<shell::detail::FrontendShell> frontend_shell;
     std::vector<WaylandExtensionHook> wayland_extension_hooks;
@@ -0,0 +1,132 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_EPOLL_MAIN_LOOP_H_
+#define MIR_EPOLL_MAIN_LOOP_H_
+
+#include "mir/main_loop.h"
+#include "mir/signal_sources.h"
+#include "mir/time/timer_wheel.h"
+#include "mir/fd.h"
+
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace mir
+{
+/**
+ * A MainLoop built directly on epoll, without GLib
+ *
+ * Fd handlers, signals (through a self-pipe, as GLibMainLoop does), alarms (on a TimerWheel's timerfd) and
+ * queued actions are all dispatched from a single epoll_wait(). The semantics match GLibMainLoop's, except
+ * that alarms are timed by std::chrono::steady_clock rather than a time::Clock, and that there is no
+ * GMainContext for GLib based code (such as LogindConsoleServices) to use.
+ */
+class EpollMainLoop : public MainLoop
+{
+public:
+    EpollMainLoop();
+    ~EpollMainLoop();
+
+    void run() override;
+    void stop() override;
+    bool running() const override;
+
+    void register_signal_handler(
+        std::initializer_list<int> signals,
+        std::function<void(int)> const& handler) override;
+
+    void register_signal_handler(
+        std::initializer_list<int> signals,
+        mir::UniqueModulePtr<std::function<void(int)>> handler) override;
+
+    void register_fd_handler(
+        std::initializer_list<int> fds,
+        void const* owner,
+        std::function<void(int)> const& handler) override;
+
+    void register_fd_handler(
+        std::initializer_list<int> fds,
+        void const* owner,
+        mir::UniqueModulePtr<std::function<void(int)>> handler) override;
+
+    void unregister_fd_handler(void const* owner) override;
+
+    void enqueue(void const* owner, ServerAction const& action) override;
+    void enqueue_with_guaranteed_execution(ServerAction const& action) override;
+
+    void pause_processing_for(void const* owner) override;
+    void resume_processing_for(void const* owner) override;
+
+    std::unique_ptr<mir::time::Alarm> create_alarm(
+        std::function<void()> const& callback) override;
+
+    std::unique_ptr<mir::time::Alarm> create_alarm(
+        std::unique_ptr<LockableCallback> callback) override;
+
+    void spawn(std::function<void()>&& work) override;
+
+private:
+    struct FdHandler;
+    struct FdRegistration
+    {
+        uint32_t generation;    ///< Distinguishes events for an fd from those for an earlier fd with the same number
+        std::vector<std::shared_ptr<FdHandler>> handlers;
+    };
+    struct Action
+    {
+        void const* owner;
+        bool conditional;   ///< Whether the action is held back while its owner is paused
+        ServerAction action;
+    };
+
+    void add_fd_handler(int fd, void const* owner, std::function<void(int)> const& handler);
+    void dispatch_fd(int fd, uint32_t generation);
+    void queue_action(void const* owner, bool conditional, ServerAction const& action);
+    void dispatch_actions();
+    void halt();
+    void wake();
+    bool should_process_actions_for(void const* owner);
+    void handle_exception(std::exception_ptr const& e);
+
+    mir::Fd const epoll_fd;
+    mir::Fd const wake_fd;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> stop_requested{false};
+
+    std::mutex fd_handlers_mutex;
+    std::unordered_map<int, FdRegistration> fd_handlers;
+    uint32_t next_generation{1};
+
+    std::mutex actions_mutex;
+    std::deque<Action> actions;
+    std::vector<void const*> do_not_process;
+
+    std::mutex run_on_halt_mutex;
+    std::deque<ServerAction> run_on_halt_queue;
+
+    std::exception_ptr main_loop_exception;
+
+    time::TimerWheel alarms;
+    detail::SignalSources signal_sources;
+};
+}
+
+#endif /* MIR_EPOLL_MAIN_LOOP_H_ */
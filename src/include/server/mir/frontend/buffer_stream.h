@@ -22,6 +22,9 @@
 #include <mir_toolkit/common.h>
 #include "mir/graphics/buffer_id.h"
 #include "mir/geometry/size.h"
+#include "mir/geometry/rectangles.h"
+#include "mir/geometry/rectangle_f.h"
+#include <experimental/optional>
 #include <functional>
 #include <memory>
 
@@ -32,6 +35,10 @@ namespace graphics
 class Buffer;
 struct BufferProperties;
 }
+namespace compositor
+{
+struct Presentation;
+}
 
 namespace frontend
 {
@@ -43,9 +50,39 @@ public:
 
     virtual void submit_buffer(std::shared_ptr<graphics::Buffer> const& buffer) = 0;
 
+    /**
+     * Record the area (in buffer coordinates) in which the next submitted
+     * buffer differs from its predecessor.
+     *
+     * Damage accumulates until the next submit_buffer(). A buffer that is
+     * submitted without any damage having been added is treated as fully
+     * damaged.
+     */
+    virtual void add_damage(geometry::Rectangles const& buffer_damage) = 0;
+
+    /**
+     * The damage (in buffer coordinates) submitted with the most recent
+     * buffer, relative to the one before it.
+     *
+     * \returns nullopt if no buffer has been submitted, or the last was
+     *          submitted without damage (so is fully damaged).
+     */
+    virtual auto submitted_damage() const -> std::experimental::optional<geometry::Rectangles> = 0;
+
+    /**
+     * Set the area (in logical coordinates, so unaffected by set_scale()) in
+     * which the stream's content is known to be opaque, even if its pixel
+     * format has an alpha channel. Replaces any previous opaque region.
+     */
+    virtual void set_opaque_region(geometry::Rectangles const& region) = 0;
+
     virtual void set_frame_posted_callback(
         std::function<void(geometry::Size const&)> const& callback) = 0;
 
+    /// Called (on the compositor thread) when a submitted buffer has reached the screen
+    virtual void set_frame_presented_callback(
+        std::function<void(compositor::Presentation const&)> const& callback) = 0;
+
     virtual void with_most_recent_buffer_do(
         std::function<void(graphics::Buffer&)> const& exec) = 0;
 
@@ -55,6 +92,15 @@ public:
     //      side once we only support the NBS system.
     virtual void allow_framedropping(bool) = 0;
     virtual void set_scale(float scale) = 0;
+
+    /**
+     * Show only the source area of each buffer (in logical coordinates, so
+     * after set_scale(); nullopt for the whole buffer), stretched to the
+     * destination size (nullopt for the source's own size).
+     */
+    virtual void set_viewport(
+        std::experimental::optional<geometry::RectangleF> const& source,
+        std::experimental::optional<geometry::Size> const& destination) = 0;
 protected:
     BufferStream() = default;
     BufferStream(BufferStream const&) = delete;
@@ -19,6 +19,8 @@
 #ifndef MIR_FRONTEND_DISPLAY_CHANGER_H_
 #define MIR_FRONTEND_DISPLAY_CHANGER_H_
 
+#include "mir/graphics/frame.h"
+
 #include <memory>
 #include <future>
 
@@ -53,6 +55,9 @@ public:
         std::shared_ptr<graphics::DisplayConfiguration> const& confirmed_configuration) = 0;
     virtual void cancel_base_configuration_preview(std::shared_ptr<scene::Session> const& session) = 0;
 
+    /// The most recent frame presented on the output (see graphics::Display::last_frame_on())
+    virtual graphics::Frame last_frame_on(unsigned output_id) = 0;
+
 protected:
     DisplayChanger() = default;
     DisplayChanger(DisplayChanger const&) = delete;
@@ -52,7 +52,12 @@ private:
 class GLibMainLoop : public MainLoop
 {
 public:
-    GLibMainLoop(std::shared_ptr<time::Clock> const& clock);
+    /**
+     * \param [in] timer_slack How late an alarm may fire to share a wakeup with others; see add_timer_gsource()
+     */
+    GLibMainLoop(
+        std::shared_ptr<time::Clock> const& clock,
+        std::chrono::milliseconds timer_slack = std::chrono::milliseconds::zero());
 
     void run() override;
     void stop() override;
@@ -159,16 +164,16 @@ public:
 private:
     void execute_with_context_as_thread_default(std::function<void()> code);
 
-    bool should_process_actions_for(void const* owner);
     void handle_exception(std::exception_ptr const& e);
 
     std::shared_ptr<time::Clock> const clock;
+    std::chrono::milliseconds const timer_slack;
     detail::GMainContextHandle const main_context;
     std::atomic<bool> running_;
     detail::FdSources fd_sources;
     detail::SignalSources signal_sources;
-    std::mutex do_not_process_mutex;
-    std::vector<void const*> do_not_process;
+    /// Actions queued by enqueue(), enqueue_with_guaranteed_execution() and spawn(), dispatched in order
+    detail::ServerActionQueue server_actions;
     std::mutex run_on_halt_mutex;
     std::deque<ServerAction> run_on_halt_queue;
     std::function<void()> before_iteration_hook;
@@ -20,7 +20,7 @@
 #define MIR_GLIB_MAIN_LOOP_SOURCES_H_
 
 #include "mir/time/clock.h"
-#include "mir/thread_safe_list.h"
+#include "mir/signal_sources.h"
 #include "mir/fd.h"
 
 #include <functional>
@@ -67,18 +67,49 @@ private:
 void add_idle_gsource(
     GMainContext* main_context, int priority, std::function<void()> const& callback);
 
-void add_server_action_gsource(
-    GMainContext* main_context,
-    void const* owner,
-    std::function<void()> const& action,
-    std::function<bool(void const*)> const& should_dispatch);
+/// A single, persistent source dispatching queued actions in the order they were queued.
+/// Each dispatch runs all the actions ready at the time, so queuing an action costs no more
+/// than taking a lock (and, if the context hasn't already been woken, waking it).
+/// The number of ready actions is kept up to date, so checking for them doesn't scan the queue.
+class ServerActionQueue
+{
+public:
+    explicit ServerActionQueue(GMainContext* main_context);
+    ~ServerActionQueue();
+
+    /// Queues an action that is held back while its owner is paused
+    void enqueue(void const* owner, std::function<void()> const& action);
+    /// Queues an action that is dispatched regardless of any owner
+    void enqueue_unconditionally(std::function<void()> const& action);
+
+    /// Holds back owner's actions (queued and to be queued) until it is resumed
+    void pause(void const* owner);
+    void resume(void const* owner);
+
+private:
+    ServerActionQueue(ServerActionQueue const&) = delete;
+    ServerActionQueue& operator=(ServerActionQueue const&) = delete;
+
+    void enqueue(void const* owner, bool conditional, std::function<void()> const& action);
+
+    GSourceHandle gsource;
+};
 
+/**
+ * Adds a source dispatching handler once target_time has passed
+ *
+ * With a non-zero slack the source wakes the main loop at the end of the slack-sized window
+ * containing target_time, so that timers due in the same window wake it just once. The slack
+ * isn't used when it could delay the timer by more than a quarter of the time until it's due,
+ * and a timer always dispatches once it's due if the loop wakes for anything else.
+ */
 GSourceHandle add_timer_gsource(
     GMainContext* main_context,
     std::shared_ptr<time::Clock> const& clock,
     std::shared_ptr<LockableCallback> const& handler,
     std::function<void()> const& exception_handler,
-    time::Timestamp target_time);
+    time::Timestamp target_time,
+    std::chrono::milliseconds slack);
 
 class FdSources
 {
@@ -98,38 +129,6 @@ private:
     std::vector<std::unique_ptr<FdSource>> sources;
 };
 
-class SignalSources
-{
-public:
-    SignalSources(FdSources& fd_sources);
-    ~SignalSources();
-
-    void add(std::vector<int> const& sigs, std::function<void(int)> const& handler);
-
-private:
-    class SourceRegistration;
-    struct HandlerElement
-    {
-        operator bool() const { return !!handler; }
-        std::vector<int> sigs;
-        std::function<void(int)> handler;
-    };
-    struct SignalPid { int sig; pid_t pid; };
-
-    void dispatch_pending_signal();
-    void ensure_signal_is_handled(int sig);
-    SignalPid read_pending_signal();
-    void dispatch_signal(int sig);
-
-    FdSources& fd_sources;
-    mir::Fd signal_read_fd;
-    mir::Fd signal_write_fd;
-    mir::ThreadSafeList<HandlerElement> handlers;
-    std::mutex handled_signals_mutex;
-    std::unordered_map<int, struct sigaction> handled_signals;
-    std::unique_ptr<SourceRegistration> source_registration;
-};
-
 }
 }
 
@@ -0,0 +1,86 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_BUFFER_POOL_H_
+#define MIR_GRAPHICS_BUFFER_POOL_H_
+
+#include "mir/graphics/graphic_buffer_allocator.h"
+#include "mir/time/types.h"
+
+#include <memory>
+
+namespace mir
+{
+namespace time
+{
+class Clock;
+}
+namespace graphics
+{
+/**
+ * Recycles the software buffers drawn in-process: decorations, software cursors and in-process clients
+ *
+ * A buffer from alloc_software_buffer() returns to the pool when the last reference to it
+ * goes, and is given out again for the next request of the same size and format. It comes
+ * back as a buffer with a new ID, so that nothing mistakes it for the one it was before;
+ * its content is whatever was last drawn into it.
+ *
+ * Idle buffers are dropped, oldest first, once there are more than max_idle_buffers of
+ * them. Those idle for longer than max_idle_time are dropped whenever buffers come or go,
+ * so a resize leaves few of the old size behind for long.
+ *
+ * Everything other than software allocation passes through to the wrapped allocator.
+ */
+class BufferPool : public GraphicBufferAllocator
+{
+public:
+    static int const max_idle_buffers = 16;
+    static time::Duration const max_idle_time;
+
+    BufferPool(std::shared_ptr<GraphicBufferAllocator> const& wrapped, std::shared_ptr<time::Clock> const& clock);
+    ~BufferPool();
+
+    auto supported_pixel_formats() -> std::vector<MirPixelFormat> override;
+    auto alloc_software_buffer(geometry::Size size, MirPixelFormat format) -> std::shared_ptr<Buffer> override;
+    void bind_display(wl_display* display, std::shared_ptr<Executor> wayland_executor) override;
+    void unbind_display(wl_display* display) override;
+    auto buffer_from_resource(
+        wl_resource* buffer,
+        std::function<void()>&& on_consumed,
+        std::function<void()>&& on_release) -> std::shared_ptr<Buffer> override;
+    auto buffer_from_shm(
+        wl_resource* buffer,
+        std::shared_ptr<Executor> wayland_executor,
+        std::function<void()>&& on_consumed,
+        std::shared_ptr<Buffer> const& previous,
+        std::experimental::optional<geometry::Rectangles> const& damage) -> std::shared_ptr<Buffer> override;
+    void surface_placed(wl_resource* surface, std::experimental::optional<ScanoutPlacement> const& placement) override;
+
+    /// The number of buffers waiting to be given out again
+    auto idle_buffers() const -> int;
+
+private:
+    class Idle;
+    class PooledBuffer;
+
+    std::shared_ptr<GraphicBufferAllocator> const wrapped;
+    /// Shared with the buffers given out, which may outlive the pool
+    std::shared_ptr<Idle> const idle;
+};
+}
+}
+
+#endif /* MIR_GRAPHICS_BUFFER_POOL_H_ */
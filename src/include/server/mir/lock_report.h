@@ -0,0 +1,48 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_LOCK_REPORT_H_
+#define MIR_LOCK_REPORT_H_
+
+#include "mir/lock_profile.h"
+
+#include <vector>
+
+namespace mir
+{
+/// Periodic samples of the server's LockProfiles, showing which locks are fought over
+class LockReport
+{
+public:
+    struct Lock
+    {
+        char const* name;
+        LockProfile::Totals totals;
+    };
+
+    virtual ~LockReport() = default;
+
+    /// Every profiled lock's totals, since profiling was enabled, at one moment
+    virtual void locks_sampled(std::vector<Lock> const& locks) = 0;
+
+protected:
+    LockReport() = default;
+    LockReport(LockReport const&) = delete;
+    LockReport& operator=(LockReport const&) = delete;
+};
+}
+
+#endif /* MIR_LOCK_REPORT_H_ */
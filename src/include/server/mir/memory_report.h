@@ -0,0 +1,54 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_MEMORY_REPORT_H_
+#define MIR_MEMORY_REPORT_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace mir
+{
+/// Periodic samples of the server's MemoryAccounts, attributing its memory to subsystems
+class MemoryReport
+{
+public:
+    struct Account
+    {
+        char const* subsystem;
+        char const* kind;
+        int64_t objects;
+        int64_t bytes;
+    };
+
+    virtual ~MemoryReport() = default;
+
+    /**
+     * Every account's totals at one moment, with the process's resident set for comparison
+     *
+     * Accounts cover what the server holds for its clients; the difference from the resident
+     * set is code, libraries, driver allocations and anything not (yet) accounted.
+     */
+    virtual void memory_sampled(std::vector<Account> const& accounts, int64_t resident_bytes) = 0;
+
+protected:
+    MemoryReport() = default;
+    MemoryReport(MemoryReport const&) = delete;
+    MemoryReport& operator=(MemoryReport const&) = delete;
+};
+}
+
+#endif /* MIR_MEMORY_REPORT_H_ */
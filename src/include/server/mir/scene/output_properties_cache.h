@@ -23,9 +23,7 @@
 #include "mir/geometry/rectangle.h"
 #include "mir/graphics/display_configuration.h"
 
-#include <vector>
 #include <memory>
-#include <mutex>
 
 namespace mir
 {
@@ -42,19 +40,32 @@ struct OutputProperties
     graphics::DisplayConfigurationOutputId id;
 };
 
+/**
+ * The properties of the outputs, as an immutable snapshot that is replaced (atomically) on each
+ * display configuration change, so that lookups take no lock.
+ */
 class OutputPropertiesCache
 {
 public:
 
     void update_from(graphics::DisplayConfiguration const& config);
 
+    /// The output of greatest scale that \p extents overlaps, or null if none
     std::shared_ptr<OutputProperties const> properties_for(geometry::Rectangle const& extents) const;
 
+    /**
+     * As properties_for(extents), but without a search if \p previous (the result of an earlier
+     * lookup for the same surface) is still current, overlaps no other output and contains
+     * \p extents. A surface moving within an output then costs no more than a comparison.
+     */
+    std::shared_ptr<OutputProperties const> properties_for(
+        geometry::Rectangle const& extents,
+        std::shared_ptr<OutputProperties const> const& previous) const;
+
 private:
-    std::shared_ptr<std::vector<OutputProperties>> get_cache() const;
+    struct Snapshot;
 
-    std::mutex mutable mutex;
-    std::shared_ptr<std::vector<OutputProperties>> cache;
+    std::shared_ptr<Snapshot const> snapshot;
 };
 
 }
@@ -72,6 +72,12 @@ public:
     virtual void send_input_config(MirInputConfig const& config) = 0;
 
     virtual void take_snapshot(SnapshotCallback const& snapshot_taken) = 0;
+    /// Takes a snapshot of surface's content, scaled down to fit within max_size.
+    /// The Snapshot is only valid during the callback (which is on the snapshot thread).
+    virtual void take_thumbnail_of(
+        std::shared_ptr<Surface> const& surface,
+        geometry::Size const& max_size,
+        SnapshotCallback const& thumbnail_taken) = 0;
     virtual auto default_surface() const -> std::shared_ptr<Surface> = 0;
     virtual void set_lifecycle_state(MirLifecycleState state) = 0;
 
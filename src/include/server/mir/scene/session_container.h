@@ -23,6 +23,7 @@
 #include <vector>
 #include <memory>
 #include <mutex>
+#include <unordered_map>
 
 namespace mir
 {
@@ -39,6 +40,8 @@ public:
     void insert_session(std::shared_ptr<Session> const& session);
     void remove_session(std::shared_ptr<Session> const& session);
 
+    /// Calls f for each session there was when for_each() was called, without holding any lock, so
+    /// f may change the container (but won't see the change)
     void for_each(std::function<void(std::shared_ptr<Session> const&)> f) const;
 
     // For convenience the successor of the null session is defined as the last session
@@ -50,8 +53,19 @@ public:
     SessionContainer& operator=(const SessionContainer&) = delete;
 
 private:
-    std::vector<std::shared_ptr<Session>> apps;
-    mutable std::mutex guard;
+    /// Never changed once published: changes publish a new one, so readers needn't lock
+    struct Snapshot
+    {
+        std::vector<std::shared_ptr<Session>> apps;
+        std::unordered_map<Session const*, std::size_t> index;  ///< Of each session in apps
+    };
+
+    auto current_snapshot() const -> std::shared_ptr<Snapshot const>;
+    /// The position of session in snapshot; throws if it isn't there
+    static auto index_of(Snapshot const& snapshot, std::shared_ptr<Session> const& session) -> std::size_t;
+
+    std::shared_ptr<Snapshot const> snapshot;
+    std::mutex guard;   ///< Serialises changes
 };
 
 }
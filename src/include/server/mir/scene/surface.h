@@ -33,7 +33,7 @@ namespace mir
 namespace shell { class InputTargeter; }
 namespace geometry { struct Rectangle; }
 namespace graphics { class CursorImage; }
-namespace compositor { class BufferStream; }
+namespace compositor { class BufferStream; struct Presentation; }
 namespace scene
 {
 struct StreamInfo
@@ -99,6 +99,13 @@ public:
     virtual void add_observer(std::shared_ptr<SurfaceObserver> const& observer) = 0;
     virtual void remove_observer(std::weak_ptr<SurfaceObserver> const& observer) = 0;
 
+    /// Hold back observer notifications of changes made on this thread until the matching end_batched_changes(),
+    /// then deliver only the latest of each (so a shell changing several properties wakes observers once)
+    ///@{
+    virtual void begin_batched_changes() = 0;
+    virtual void end_batched_changes() = 0;
+    ///@}
+
     virtual void set_reception_mode(input::InputReceptionMode mode) = 0;
 
     virtual void request_client_surface_close() = 0;
@@ -117,6 +124,17 @@ public:
     virtual void set_confine_pointer_state(MirPointerConfinementState state) = 0;
     virtual MirPointerConfinementState confine_pointer_state() const = 0;
 
+    /// Whether the surface's buffers may be shown without waiting for vblank, if they're scanned out directly
+    virtual void set_tearing_allowed(bool allowed) = 0;
+    virtual bool tearing_allowed() const = 0;
+
+    /// The most frames a second the client is asked to draw (by pacing its frame callbacks); zero for no limit
+    virtual void set_max_frame_rate(float frames_per_second) = 0;
+    virtual float max_frame_rate() const = 0;
+
+    /// One of the renderables generate_renderables() gave has reached the screen
+    virtual void presented(graphics::Renderable::ID renderable, compositor::Presentation const& presentation) = 0;
+
     virtual void placed_relative(geometry::Rectangle const& placement) = 0;
     virtual void start_drag_and_drop(std::vector<uint8_t> const& handle) = 0;
 
@@ -22,6 +22,12 @@
 #include "mir/basic_observers.h"
 #include "mir/scene/surface_observer.h"
 
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 namespace mir
 {
 namespace scene
@@ -60,6 +66,27 @@ public:
     void start_drag_and_drop(Surface const* surf, std::vector<uint8_t> const& handle) override;
     void depth_layer_set_to(Surface const* surf, MirDepthLayer depth_layer) override;
     void application_id_set_to(Surface const* surf, std::string const& application_id) override;
+
+    /**
+     * Hold back property change notifications made on this thread until the matching end_batch()
+     *
+     * Only the latest notification of each property is delivered, in the order the properties first changed.
+     * Notifications that aren't a property's latest value (frames, cursor images, input, close requests,
+     * drag and drop) and depth layer changes (which restack the scene) are still delivered immediately.
+     * Batches nest; notifications from other threads are not held back.
+     */
+    void begin_batch();
+    void end_batch();
+
+private:
+    template<typename Notify>
+    void notify_change(int key, Notify const& notify);
+
+    std::atomic<bool> batching{false};
+    std::mutex batch_mutex;
+    std::thread::id batch_thread;
+    int batch_depth{0};
+    std::vector<std::pair<int, std::function<void()>>> pending;
 };
 
 }
@@ -35,7 +35,7 @@ template<class Observer>
 class ObserverRegistrar;
 
 namespace compositor { class Compositor; class DisplayBufferCompositorFactory; class CompositorReport; }
-namespace graphics { class Cursor; class Platform; class Display; class GLConfig; class DisplayConfigurationPolicy; class DisplayConfigurationObserver; }
+namespace graphics { class BufferPool; class Cursor; class Platform; class Display; class GLConfig; class DisplayConfigurationPolicy; class DisplayConfigurationObserver; }
 namespace input { class CompositeEventFilter; class InputDispatcher; class CursorListener; class CursorImages; class TouchVisualizer; class InputDeviceHub;}
 namespace logging { class Logger; }
 namespace options { class Option; }
@@ -407,6 +407,9 @@ public:
     /// \return the buffer stream factory
     auto the_buffer_stream_factory() const -> std::shared_ptr<scene::BufferStreamFactory>;
 
+    /// \return the pool recycling the software buffers drawn in-process
+    auto the_buffer_pool() const -> std::shared_ptr<graphics::BufferPool>;
+
     /// \return the surface factory
     auto the_surface_factory() const -> std::shared_ptr<scene::SurfaceFactory>;
 
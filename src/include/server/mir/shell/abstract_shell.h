@@ -142,6 +142,10 @@ public:
     auto surface_at(geometry::Point cursor) const -> std::shared_ptr<scene::Surface> override;
 
     void raise(SurfaceSet const& surfaces) override;
+
+    void begin_transaction() override;
+
+    void end_transaction() override;
 /** @} */
 
     void add_display(geometry::Rectangle const& area) override;
@@ -53,6 +53,12 @@ public:
 
     virtual void raise(SurfaceSet const& surfaces) = 0;
 
+    /// Changes made to the scene (on this thread) between these are seen by compositors all at once
+    ///@{
+    virtual void begin_transaction() = 0;
+    virtual void end_transaction() = 0;
+    ///@}
+
     virtual void set_drag_and_drop_handle(std::vector<uint8_t> const& handle) = 0;
     virtual void clear_drag_and_drop_handle() = 0;
 
@@ -45,6 +45,10 @@ public:
 
     void raise(SurfaceSet const& surfaces) override;
 
+    void begin_transaction() override;
+
+    void end_transaction() override;
+
     auto open_session(
         pid_t client_pid,
         std::string const& name,
@@ -114,6 +114,10 @@ struct SurfaceSpecification
     optional_value<MirPlacementGravity> attached_edges;
     optional_value<optional_value<geometry::Rectangle>> exclusive_rect;
     optional_value<std::string> application_id;
+    /// The client would rather tear than wait for vblank; the window manager decides whether it may
+    optional_value<bool> tearing_allowed;
+    /// Frames a second the client's frame callbacks are paced to; zero for no limit. Only the window manager sets this
+    optional_value<float> max_frame_rate;
 };
 }
 }
@@ -53,6 +53,13 @@ public:
 
     virtual auto surface_at(geometry::Point) const -> std::shared_ptr<scene::Surface> = 0;
 
+    /// Changes made to the stack and its surfaces (on this thread) between these are seen by compositors
+    /// all at once, and cause a single recomposite. Transactions nest.
+    ///@{
+    virtual void begin_transaction() = 0;
+    virtual void end_transaction() = 0;
+    ///@}
+
 protected:
     SurfaceStack() = default;
     virtual ~SurfaceStack() = default;
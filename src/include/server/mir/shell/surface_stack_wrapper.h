@@ -42,6 +42,10 @@ public:
 
     auto surface_at(geometry::Point) const -> std::shared_ptr<scene::Surface> override;
 
+    void begin_transaction() override;
+
+    void end_transaction() override;
+
 protected:
     std::shared_ptr<SurfaceStack> const wrapped;
 };
@@ -0,0 +1,70 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_SIGNAL_SOURCES_H_
+#define MIR_SIGNAL_SOURCES_H_
+
+#include "mir/graphics/event_handler_register.h"
+#include "mir/thread_safe_list.h"
+#include "mir/fd.h"
+
+#include <csignal>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace mir
+{
+namespace detail
+{
+/// Dispatches signals to their handlers from the fd handlers of an EventHandlerRegister (usually a MainLoop)
+class SignalSources
+{
+public:
+    SignalSources(graphics::EventHandlerRegister& fd_register);
+    ~SignalSources();
+
+    void add(std::vector<int> const& sigs, std::function<void(int)> const& handler);
+
+private:
+    class SourceRegistration;
+    struct HandlerElement
+    {
+        operator bool() const { return !!handler; }
+        std::vector<int> sigs;
+        std::function<void(int)> handler;
+    };
+    struct SignalPid { int sig; pid_t pid; };
+
+    void dispatch_pending_signal();
+    void ensure_signal_is_handled(int sig);
+    SignalPid read_pending_signal();
+    void dispatch_signal(int sig);
+
+    graphics::EventHandlerRegister& fd_register;
+    mir::Fd signal_read_fd;
+    mir::Fd signal_write_fd;
+    mir::ThreadSafeList<HandlerElement> handlers;
+    std::mutex handled_signals_mutex;
+    std::unordered_map<int, struct sigaction> handled_signals;
+    std::unique_ptr<SourceRegistration> source_registration;
+};
+}
+}
+
+#endif /* MIR_SIGNAL_SOURCES_H_ */
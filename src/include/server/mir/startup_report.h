@@ -0,0 +1,66 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_STARTUP_REPORT_H_
+#define MIR_STARTUP_REPORT_H_
+
+namespace mir
+{
+/// Marks the phases of bringing up the server, to time how long after the process started each completes
+class StartupReport
+{
+public:
+    enum class Phase
+    {
+        platform_probed,        ///< The graphics platform is selected and created
+        display_configured,     ///< The display is created, with its initial configuration applied
+        renderer_created,       ///< A compositing thread has created its renderer
+        wayland_socket_ready,   ///< The Wayland socket accepts connections
+        xwayland_socket_ready,  ///< The X11 display's sockets accept connections
+        started,                ///< Everything has started, and the main loop is running
+        first_frame,            ///< The first frame is composited
+        xwayland_running,       ///< Xwayland has been spawned, for the first X11 client
+    };
+
+    virtual ~StartupReport() = default;
+
+    /// Phases can recur (when Xwayland restarts, or another display is composited); only the first counts
+    virtual void phase_completed(Phase phase) = 0;
+
+protected:
+    StartupReport() = default;
+    StartupReport(StartupReport const&) = delete;
+    StartupReport& operator=(StartupReport const&) = delete;
+};
+
+inline auto name_of(StartupReport::Phase phase) -> char const*
+{
+    switch (phase)
+    {
+    case StartupReport::Phase::platform_probed: return "platform_probed";
+    case StartupReport::Phase::display_configured: return "display_configured";
+    case StartupReport::Phase::renderer_created: return "renderer_created";
+    case StartupReport::Phase::wayland_socket_ready: return "wayland_socket_ready";
+    case StartupReport::Phase::xwayland_socket_ready: return "xwayland_socket_ready";
+    case StartupReport::Phase::started: return "started";
+    case StartupReport::Phase::first_frame: return "first_frame";
+    case StartupReport::Phase::xwayland_running: return "xwayland_running";
+    }
+    return "unknown";
+}
+}
+
+#endif /* MIR_STARTUP_REPORT_H_ */
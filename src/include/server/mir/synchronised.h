@@ -21,6 +21,7 @@
 
 #include <mutex>
 #include <condition_variable>
+#include <utility>
 #include <boost/throw_exception.hpp>
 
 namespace mir
@@ -32,8 +33,9 @@ namespace mir
  * smart-pointer-esque lock to lock and access it.
  *
  * \tparam Guarded  The type of data guarded by the mutex
+ * \tparam Mutex    The mutex guarding it: a ProfiledMutex, say, to find out how contended it is
  */
-template<typename Guarded>
+template<typename Guarded, typename Mutex = std::mutex>
 class Synchronised
 {
 public:
@@ -43,6 +45,14 @@ public:
     {
     }
 
+    /// For a Mutex that needs constructing with arguments (a ProfiledMutex's LockProfile)
+    template<typename... MutexArgs>
+    Synchronised(Guarded&& initial_value, MutexArgs&&... mutex_args)
+        : mutex{std::forward<MutexArgs>(mutex_args)...},
+          value{std::move(initial_value)}
+    {
+    }
+
     /**
      * RAII wrapper for access to the data owned by a Synchronised type.
      *
@@ -52,7 +62,7 @@ public:
     class Locked
     {
     public:
-        friend class Synchronised<Guarded>;
+        friend class Synchronised<Guarded, Mutex>;
 
         Locked(Locked&& from) = default;
         ~Locked() noexcept(false)
@@ -73,14 +83,14 @@ public:
         }
 
     private:
-        Locked(std::unique_lock<std::mutex>&& lock, Guarded& value)
+        Locked(std::unique_lock<Mutex>&& lock, Guarded& value)
             : value{value},
               lock{std::move(lock)}
         {
         }
 
         Guarded& value;
-        std::unique_lock<std::mutex> lock;
+        std::unique_lock<Mutex> lock;
     };
 
     /**
@@ -92,11 +102,11 @@ public:
      */
     Locked lock()
     {
-        return Locked{std::unique_lock<std::mutex>{mutex}, value};
+        return Locked{std::unique_lock<Mutex>{mutex}, value};
     }
 
 protected:
-    std::mutex mutex;
+    Mutex mutex;
     Guarded value;
 
 private:
@@ -0,0 +1,56 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_THREAD_EXECUTOR_BATCH_H_
+#define MIR_THREAD_EXECUTOR_BATCH_H_
+
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace mir
+{
+class Executor;
+
+namespace thread
+{
+/**
+ * Collects the work spawn()ed on this thread while it is alive, and hands it
+ * to each executor as a single work item when it is destroyed.
+ *
+ * Batches nest; only the outermost batch on a thread collects work.
+ */
+class ExecutorBatch
+{
+public:
+    ExecutorBatch();
+    ~ExecutorBatch();
+
+    /// Spawns work on executor, or defers it to the batch open on this thread
+    static void spawn(std::shared_ptr<Executor> const& executor, std::function<void()>&& work);
+
+private:
+    ExecutorBatch(ExecutorBatch const&) = delete;
+    ExecutorBatch& operator=(ExecutorBatch const&) = delete;
+
+    bool const outermost;
+    std::vector<std::pair<std::shared_ptr<Executor>, std::vector<std::function<void()>>>> pending;
+};
+}
+}
+
+#endif // MIR_THREAD_EXECUTOR_BATCH_H_
@@ -0,0 +1,125 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_THREAD_MPSC_QUEUE_H_
+#define MIR_THREAD_MPSC_QUEUE_H_
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+namespace mir
+{
+namespace thread
+{
+/**
+ * A lock-free multi-producer, single-consumer queue, after Dmitry Vyukov's "Non-intrusive MPSC node-based queue"
+ *
+ * Any thread may push(); only one thread at a time may pop(). Neither blocks, so a consumer that wants to sleep
+ * while the queue is empty needs a wakeup of its own.
+ */
+template<typename T>
+class MPSCQueue
+{
+public:
+    MPSCQueue()
+        : head{&stub},
+          tail{&stub}
+    {
+    }
+
+    ~MPSCQueue()
+    {
+        T discarded;
+        while (pop(discarded))
+        {
+        }
+    }
+
+    void push(T&& item)
+    {
+        auto const node = new Node{std::move(item)};
+        auto const prev = head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    /// Moves the oldest item into item, or returns false if there's nothing (yet) to take
+    auto pop(T& item) -> bool
+    {
+        auto current = tail;
+        auto next = current->next.load(std::memory_order_acquire);
+
+        if (current == &stub)
+        {
+            if (!next)
+            {
+                return false;
+            }
+            tail = next;
+            current = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+
+        if (!next)
+        {
+            if (current != head.load(std::memory_order_acquire))
+            {
+                // A producer is part-way through push(); the consumer needs to try again once it has finished
+                return false;
+            }
+
+            // current is the last node; put the stub behind it so we can take it
+            stub.next.store(nullptr, std::memory_order_relaxed);
+            auto const prev = head.exchange(&stub, std::memory_order_acq_rel);
+            prev->next.store(&stub, std::memory_order_release);
+
+            next = current->next.load(std::memory_order_acquire);
+            if (!next)
+            {
+                return false;
+            }
+        }
+
+        tail = next;
+        std::unique_ptr<Node> const taken{current};
+        item = std::move(taken->item);
+        return true;
+    }
+
+private:
+    MPSCQueue(MPSCQueue const&) = delete;
+    MPSCQueue& operator=(MPSCQueue const&) = delete;
+
+    struct Node
+    {
+        Node() = default;
+        explicit Node(T&& item)
+            : item{std::move(item)}
+        {
+        }
+
+        T item;
+        std::atomic<Node*> next{nullptr};
+    };
+
+    Node stub;
+    std::atomic<Node*> head;    ///< Last pushed node; shared by the producers
+    Node* tail;                 ///< Next node to pop; owned by the consumer
+};
+}
+}
+
+#endif // MIR_THREAD_MPSC_QUEUE_H_
@@ -0,0 +1,94 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_THREAD_SCHEDULING_H_
+#define MIR_THREAD_SCHEDULING_H_
+
+#include "mir/optional_value.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace mir
+{
+namespace options { class Option; }
+
+/// How one of Mir's latency sensitive threads should be scheduled
+struct ThreadScheduling
+{
+    /// 0 to leave the thread under the normal scheduler, otherwise its SCHED_FIFO priority (1-99)
+    int realtime_priority{0};
+    /// The CPUs the thread may run on, or empty for any
+    std::vector<int> cpus;
+    /// The nice value (-20 to 19) for a normally scheduled thread, if it should change
+    optional_value<int> nice;
+    /// A cgroup directory to move the thread into (such as "/sys/fs/cgroup/mir"), or empty to leave it
+    std::string cgroup;
+    /// How many bytes of the thread's stack to fault in up front, so it doesn't page fault mid-frame
+    std::size_t prefault_stack{0};
+};
+
+/// The scheduling for threads whose names match a pattern
+struct ThreadSchedulingRule
+{
+    /// A thread name, or a prefix of thread names followed by "*"
+    std::string name_pattern;
+    ThreadScheduling scheduling;
+};
+
+/// Parses a list of CPUs such as "0,2-3"
+/// \throws std::invalid_argument if the list is malformed
+auto parse_cpu_list(std::string const& list) -> std::vector<int>;
+
+/**
+ * Parses rules such as "Mir/Comp:cpus=4-7 rt=10;Mir/Input*:nice=-5;*:cgroup=/sys/fs/cgroup/mir"
+ *
+ * Each rule is a name pattern, ":", and whitespace separated settings: "cpus" (a CPU list), "rt" (a SCHED_FIFO
+ * priority), "nice", "cgroup" and "stack" (KiB of stack to prefault).
+ * \throws std::invalid_argument if the rules are malformed
+ */
+auto parse_thread_scheduling_rules(std::string const& rules) -> std::vector<ThreadSchedulingRule>;
+
+/// Reads the scheduling configured by a pair of priority (int) and CPU list (string) options, prefaulting the
+/// stacks of these (latency critical) threads if memory is to be locked
+/// \throws std::invalid_argument if the CPU list is malformed
+auto thread_scheduling_from(
+    options::Option const& options,
+    char const* priority_opt,
+    char const* cpus_opt) -> ThreadScheduling;
+
+/**
+ * Applies scheduling to the calling thread
+ *
+ * If the process may not use realtime scheduling itself, RealtimeKit is asked to do it. Failures are logged rather
+ * than thrown: the thread still works, just without the requested treatment.
+ */
+void apply_thread_scheduling(ThreadScheduling const& scheduling, std::string const& thread_name);
+
+/// Applies the first of rules matching thread_name (if any) to the calling thread
+void apply_thread_scheduling(std::vector<ThreadSchedulingRule> const& rules, std::string const& thread_name);
+
+/**
+ * Locks the process's memory, present and future, into RAM
+ *
+ * The heap is also kept from returning memory to the system (and faulting it back in later). Failure (typically
+ * RLIMIT_MEMLOCK) is logged rather than thrown.
+ */
+void lock_process_memory();
+}
+
+#endif /* MIR_THREAD_SCHEDULING_H_ */
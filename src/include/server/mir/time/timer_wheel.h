@@ -0,0 +1,64 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_TIME_TIMER_WHEEL_H_
+#define MIR_TIME_TIMER_WHEEL_H_
+
+#include "mir/time/alarm_factory.h"
+#include "mir/dispatch/dispatchable.h"
+
+#include <memory>
+
+namespace mir
+{
+namespace time
+{
+namespace detail
+{
+class TimerWheelState;
+}
+
+/**
+ * An AlarmFactory whose alarms fire on whichever thread dispatches it
+ *
+ * Alarms are kept in a hierarchical timer wheel (millisecond ticks, four levels of 64 slots), so scheduling
+ * and cancelling are constant time, and a single timerfd is armed for the next slot due. Adding the wheel to
+ * a thread's MultiplexingDispatchable lets that thread's alarms fire without waiting on the main loop.
+ *
+ * Alarms are timed by std::chrono::steady_clock, which is what the timerfd uses.
+ */
+class TimerWheel : public AlarmFactory, public dispatch::Dispatchable
+{
+public:
+    TimerWheel();
+    ~TimerWheel();
+
+    // AlarmFactory
+    std::unique_ptr<Alarm> create_alarm(std::function<void()> const& callback) override;
+    std::unique_ptr<Alarm> create_alarm(std::unique_ptr<LockableCallback> callback) override;
+
+    // Dispatchable
+    Fd watch_fd() const override;
+    bool dispatch(dispatch::FdEvents events) override;
+    dispatch::FdEvents relevant_events() const override;
+
+private:
+    std::shared_ptr<detail::TimerWheelState> const state;
+};
+}
+}
+
+#endif // MIR_TIME_TIMER_WHEEL_H_
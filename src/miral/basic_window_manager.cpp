@@ -36,6 +36,55 @@
 using namespace mir;
 using namespace mir::geometry;
 
+namespace
+{
+LockProfile window_manager_lock_profile{"BasicWindowManager"};
+
+/// Delivers the surface's observer notifications once the changes are all made
+class BatchedSurfaceChanges
+{
+public:
+    explicit BatchedSurfaceChanges(std::shared_ptr<scene::Surface> const& surface) :
+        surface{surface}
+    {
+        surface->begin_batched_changes();
+    }
+
+    ~BatchedSurfaceChanges()
+    {
+        surface->end_batched_changes();
+    }
+
+    BatchedSurfaceChanges(BatchedSurfaceChanges const&) = delete;
+    BatchedSurfaceChanges& operator=(BatchedSurfaceChanges const&) = delete;
+
+private:
+    std::shared_ptr<scene::Surface> const surface;
+};
+
+/// Makes the scene changes made in its lifetime appear to compositors all at once
+class SceneTransaction
+{
+public:
+    explicit SceneTransaction(mir::shell::FocusController* focus_controller) :
+        focus_controller{focus_controller}
+    {
+        focus_controller->begin_transaction();
+    }
+
+    ~SceneTransaction()
+    {
+        focus_controller->end_transaction();
+    }
+
+    SceneTransaction(SceneTransaction const&) = delete;
+    SceneTransaction& operator=(SceneTransaction const&) = delete;
+
+private:
+    mir::shell::FocusController* const focus_controller;
+};
+}
+
 auto miral::BasicWindowManager::DisplayArea::bounding_rectangle_of_contained_outputs() const -> Rectangle
 {
     Rectangles box;
@@ -60,7 +109,7 @@ struct miral::BasicWindowManager::Locker
         policy->advise_end();
     }
 
-    std::lock_guard<std::mutex> const lock;
+    std::lock_guard<ProfiledSharedMutex> const lock;
     WindowManagementPolicy* const policy;
 };
 
@@ -89,6 +138,7 @@ miral::BasicWindowManager::BasicWindowManager(
     display_layout(display_layout),
     persistent_surface_store{persistent_surface_store},
     policy(build(WindowManagerTools{this})),
+    mutex{window_manager_lock_profile},
     display_config_monitor{std::make_shared<DisplayConfigurationListeners>()}
 {
     display_config_monitor->add_listener(this);
@@ -254,7 +304,10 @@ void miral::BasicWindowManager::remove_window(Application const& application, mi
     mru_active_windows.erase(info.window());
     fullscreen_surfaces.erase(info.window());
     for (auto& area : display_areas)
-        area->attached_windows.erase(info.window());
+    {
+        if (area->attached_windows.erase(info.window()))
+            area->layout_needed = true;
+    }
     if (info.state() == mir_window_state_attached &&
         info.exclusive_rect().is_set())
     {
@@ -386,6 +439,10 @@ void miral::BasicWindowManager::handle_raise_surface(
     std::shared_ptr<scene::Surface> const& surface,
     uint64_t timestamp)
 {
+    // A request from before the latest input can be dropped without waiting for the policy
+    if (timestamp < last_input_event_timestamp)
+        return;
+
     Locker lock{this};
 
     if (!surface_known(surface, "raise"))
@@ -400,6 +457,9 @@ void miral::BasicWindowManager::handle_request_drag_and_drop(
     std::shared_ptr<mir::scene::Surface> const& surface,
     uint64_t timestamp)
 {
+    if (timestamp < last_input_event_timestamp)
+        return;
+
     Locker lock{this};
 
     if (!surface_known(surface, "drag-and-drop"))
@@ -414,6 +474,9 @@ void miral::BasicWindowManager::handle_request_move(
     std::shared_ptr<mir::scene::Surface> const& surface,
     uint64_t timestamp)
 {
+    if (timestamp < last_input_event_timestamp)
+        return;
+
     std::lock_guard<decltype(mutex)> lock(mutex);
 
     if (!surface_known(surface, "move"))
@@ -431,6 +494,9 @@ void miral::BasicWindowManager::handle_request_resize(
     uint64_t timestamp,
     MirResizeEdge edge)
 {
+    if (timestamp < last_input_event_timestamp)
+        return;
+
     std::lock_guard<decltype(mutex)> lock(mutex);
 
     if (!surface_known(surface, "resize"))
@@ -921,6 +987,7 @@ auto miral::BasicWindowManager::active_application_zone() -> Zone
 
 void miral::BasicWindowManager::raise_tree(Window const& root)
 {
+    SceneTransaction const transaction{focus_controller};
     auto const& info = info_for(root);
 
     if (auto parent = info.parent())
@@ -961,6 +1028,7 @@ void miral::BasicWindowManager::move_tree(miral::WindowInfo& root, mir::geometry
     if (movement == mir::geometry::Displacement{})
         return;
 
+    SceneTransaction const transaction{focus_controller};
     auto const top_left = root.window().top_left() + movement;
 
     policy->advise_move_to(root, top_left);
@@ -978,6 +1046,7 @@ void miral::BasicWindowManager::set_tree_depth_layer(miral::WindowInfo& root, Mi
     std::shared_ptr<scene::Surface> surface = root.window();
     if (surface->depth_layer() != new_layer || root.depth_layer() != new_layer)
     {
+        SceneTransaction const transaction{focus_controller};
         surface->set_depth_layer(new_layer);
         root.depth_layer(new_layer);
         for (auto& window : root.children())
@@ -1070,6 +1139,7 @@ void miral::BasicWindowManager::modify_window(WindowInfo& window_info, WindowSpe
     std::swap(window_info_tmp, window_info);
 
     auto& window = window_info.window();
+    BatchedSurfaceChanges const batch{window};
 
     if (modifications.depth_layer().is_set())
         set_tree_depth_layer(window_info, modifications.depth_layer().value());
@@ -1176,11 +1246,18 @@ void miral::BasicWindowManager::modify_window(WindowInfo& window_info, WindowSpe
 
     if (application_zones_need_update)
     {
+        display_area_for(window_info)->layout_needed = true;
         update_application_zones_and_attached_windows();
     }
 
     if (modifications.confine_pointer().is_set())
         std::shared_ptr<scene::Surface>(window)->set_confine_pointer_state(modifications.confine_pointer().value());
+
+    if (modifications.tearing_allowed().is_set())
+        std::shared_ptr<scene::Surface>(window)->set_tearing_allowed(modifications.tearing_allowed().value());
+
+    if (modifications.max_frame_rate().is_set())
+        std::shared_ptr<scene::Surface>(window)->set_max_frame_rate(modifications.max_frame_rate().value());
 }
 
 auto miral::BasicWindowManager::info_for_window_id(std::string const& id) const -> WindowInfo&
@@ -1407,7 +1484,10 @@ void miral::BasicWindowManager::update_attached_and_fullscreen_sets(WindowInfo c
     }
 
     for (auto& area : display_areas)
-        area->attached_windows.erase(window);
+    {
+        if (area->attached_windows.erase(window))
+            area->layout_needed = true;
+    }
 
     switch (state)
     {
@@ -1418,6 +1498,7 @@ void miral::BasicWindowManager::update_attached_and_fullscreen_sets(WindowInfo c
     {
         auto area = display_area_for(window_info);
         area->attached_windows.insert(window);
+        area->layout_needed = true;
         break;
     }
 
@@ -1563,6 +1644,13 @@ void miral::BasicWindowManager::invoke_under_lock(std::function<void()> const& c
     callback();
 }
 
+void miral::BasicWindowManager::invoke_under_shared_lock(std::function<void()> const& callback)
+{
+    // Nothing changes, so the policy isn't advised and other queries needn't wait
+    std::shared_lock<ProfiledSharedMutex> lock{mutex};
+    callback();
+}
+
 auto miral::BasicWindowManager::select_active_window(Window const& hint) -> miral::Window
 {
     auto const prev_window = active_window();
@@ -2412,6 +2500,8 @@ void miral::BasicWindowManager::remove_tree_from_workspace(
 void miral::BasicWindowManager::move_workspace_content_to_workspace(
     std::shared_ptr<Workspace> const& to_workspace, std::shared_ptr<Workspace> const& from_workspace)
 {
+    // The policy typically hides and shows windows in response
+    SceneTransaction const transaction{focus_controller};
     std::vector<Window> windows_removed;
 
     auto const iter_pair_from = workspaces_to_windows.left.equal_range(from_workspace);
@@ -2461,6 +2551,32 @@ void miral::BasicWindowManager::for_each_window_in_workspace(
         callback(kv->second);
 }
 
+void miral::BasicWindowManager::apply_atomically(std::function<void()> const& changes)
+{
+    SceneTransaction const transaction{focus_controller};
+    changes();
+}
+
+void miral::BasicWindowManager::take_thumbnail(
+    Window const& window,
+    mir::geometry::Size const& max_size,
+    WindowManagerTools::ThumbnailCallback const& callback)
+{
+    std::shared_ptr<scene::Session> const session{window.application()};
+    std::shared_ptr<scene::Surface> const surface{window};
+
+    if (!session || !surface)
+    {
+        callback({}, {}, nullptr);
+        return;
+    }
+
+    session->take_thumbnail_of(surface, max_size, [callback](mir::scene::Snapshot const& thumbnail)
+        {
+            callback(thumbnail.size, thumbnail.stride, thumbnail.pixels);
+        });
+}
+
 auto miral::BasicWindowManager::apply_exclusive_rect_to_application_zone(
     Rectangle const& original_zone,
     Rectangle const& exclusive_rect,
@@ -2532,6 +2648,7 @@ auto miral::BasicWindowManager::add_output_to_display_areas(Locker const&, Outpu
     {
         existing_area->contained_outputs.push_back(output);
         existing_area->area = existing_area->bounding_rectangle_of_contained_outputs();
+        existing_area->layout_needed = true;
     }
     else
     {
@@ -2562,6 +2679,7 @@ auto miral::BasicWindowManager::remove_output_from_display_areas(Locker const&,
         if (output_removed)
         {
             area->area = area->bounding_rectangle_of_contained_outputs();
+            area->layout_needed = true;
         }
     }
 }
@@ -2599,7 +2717,12 @@ void miral::BasicWindowManager::advise_output_update(miral::Output const& update
             }
             if (update_extents)
             {
-                area->area = area->bounding_rectangle_of_contained_outputs();
+                auto const extents = area->bounding_rectangle_of_contained_outputs();
+                if (extents != area->area)
+                {
+                    area->area = extents;
+                    area->layout_needed = true;
+                }
             }
         }
     }
@@ -2637,6 +2760,18 @@ void miral::BasicWindowManager::advise_output_end()
 
 void miral::BasicWindowManager::update_application_zones_and_attached_windows()
 {
+    // Fullscreen windows are re-placed if their area is changing or going (or they are not where it is)
+    std::vector<Window> fullscreen_to_place;
+    for (auto const& window : fullscreen_surfaces)
+    {
+        if (window)
+        {
+            auto const area = display_area_for(info_for(window));
+            if (area->layout_needed || !area->is_alive() || !area->area.contains(Rectangle{window.top_left(), window.size()}))
+                fullscreen_to_place.push_back(window);
+        }
+    }
+
     // Move all live areas to before the split and areas that should be removed to after
     auto split = std::stable_partition(
         display_areas.begin(),
@@ -2670,19 +2805,22 @@ void miral::BasicWindowManager::update_application_zones_and_attached_windows()
     }
 
     // Fullscreen surface should fill the whole area (does not depend on what the zones end up being)
-    for (auto const& window : fullscreen_surfaces)
+    for (auto const& window : fullscreen_to_place)
     {
-        if (window)
-        {
-            auto& info = info_for(window);
-            auto const rect =
-                policy->confirm_placement_on_display(info, mir_window_state_fullscreen, display_area_for(info)->area);
-            place_and_size(info, rect.top_left, rect.size);
-        }
+        auto& info = info_for(window);
+        auto const rect =
+            policy->confirm_placement_on_display(info, mir_window_state_fullscreen, display_area_for(info)->area);
+        place_and_size(info, rect.top_left, rect.size);
     }
 
+    // Only areas that have changed (or had attached windows change) need their windows laying out again
     for (auto& area : display_areas)
     {
+        if (!area->layout_needed)
+            continue;
+
+        area->layout_needed = false;
+
         Rectangle zone_rect = area->area;
 
         /// The first pass will modify the application zone as it goes
@@ -29,9 +29,11 @@
 #include "miral/zone.h"
 #include "miral/output.h"
 #include "mru_window_list.h"
+#include "weak_ptr_map.h"
 
 #include <mir/geometry/rectangles.h>
 #include <mir/observer_registrar.h>
+#include <mir/profiled_mutex.h>
 #include <mir/shell/abstract_shell.h>
 #include <mir/shell/window_manager.h>
 
@@ -39,8 +41,10 @@
 #include <boost/bimap/multiset_of.hpp>
 #include <optional>
 
+#include <atomic>
 #include <map>
 #include <mutex>
+#include <shared_mutex>
 
 namespace mir
 {
@@ -147,6 +151,13 @@ public:
     void for_each_window_in_workspace(
         std::shared_ptr<Workspace> const& workspace, std::function<void(Window const&)> const& callback) override;
 
+    void apply_atomically(std::function<void()> const& changes) override;
+
+    void take_thumbnail(
+        Window const& window,
+        mir::geometry::Size const& max_size,
+        WindowManagerTools::ThumbnailCallback const& callback) override;
+
     auto count_applications() const -> unsigned int override;
 
     void for_each_application(std::function<void(ApplicationInfo& info)> const& functor) override;
@@ -193,6 +204,7 @@ public:
     void place_and_size_for_state(WindowSpecification& modifications, WindowInfo const& window_info) const override;
 
     void invoke_under_lock(std::function<void()> const& callback) override;
+    void invoke_under_shared_lock(std::function<void()> const& callback) override;
 
 private:
     /// An area for windows to be placed in
@@ -229,10 +241,12 @@ private:
         /// Only set if this display area represents a logical group of multiple outputs
         std::optional<int> logical_output_group_id;
         std::set<Window> attached_windows; ///< Maximized/anchored/etc windows attached to this area
+        /// If the area, or the windows attached to it, have changed since its application zone was last laid out
+        bool layout_needed{true};
     };
 
-    using SurfaceInfoMap = std::map<std::weak_ptr<mir::scene::Surface>, WindowInfo, std::owner_less<std::weak_ptr<mir::scene::Surface>>>;
-    using SessionInfoMap = std::map<std::weak_ptr<mir::scene::Session>, ApplicationInfo, std::owner_less<std::weak_ptr<mir::scene::Session>>>;
+    using SurfaceInfoMap = WeakPtrMap<mir::scene::Surface, WindowInfo>;
+    using SessionInfoMap = WeakPtrMap<mir::scene::Session, ApplicationInfo>;
 
     mir::shell::FocusController* const focus_controller;
     std::shared_ptr<mir::shell::DisplayLayout> const display_layout;
@@ -249,12 +263,14 @@ private:
 
     std::unique_ptr<WindowManagementPolicy> const policy;
 
-    std::mutex mutex;
+    /// Held exclusively (by Locker) to update the model and call the policy, and shared by queries
+    mir::ProfiledSharedMutex mutex;
     SessionInfoMap app_info;
     SurfaceInfoMap window_info;
     mir::geometry::Rectangles outputs;
     mir::geometry::Point cursor;
-    uint64_t last_input_event_timestamp{0};
+    /// Written under the mutex, but read without it to drop stale requests
+    std::atomic<uint64_t> last_input_event_timestamp{0};
     MirEvent const* last_input_event{nullptr};
     miral::MRUWindowList mru_active_windows;
     bool allow_active_window = true;
@@ -324,7 +340,7 @@ private:
     void advise_output_update(Output const& updated, Output const& original) override;
     void advise_output_delete(Output const& output) override;
     void advise_output_end() override;
-    /// Updates the application zones of all display areas and moves attached windows as needed
+    /// Updates the application zones of the display areas needing layout and moves their attached windows as needed
     void update_application_zones_and_attached_windows();
 };
 }
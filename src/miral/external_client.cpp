@@ -36,6 +36,21 @@ struct miral::ExternalClientLauncher::Self
 
     AppEnvironment env;
     AppEnvironment x11_env;
+
+    /// Set (before the server is initialized) if apps are to be launched from a helper process
+    std::shared_ptr<LaunchHelper> launch_helper;
+
+    auto launch(
+        std::vector<std::string> const& command_line,
+        mir::optional_value<std::string> const& wayland_display,
+        mir::optional_value<std::string> const& x11_display,
+        AppEnvironment const& app_env) -> pid_t
+    {
+        if (launch_helper)
+            return launch_helper->launch_app_env(command_line, wayland_display, x11_display, app_env);
+
+        return launch_app_env(command_line, wayland_display, x11_display, app_env);
+    }
 };
 
 namespace
@@ -78,6 +93,7 @@ void miral::ExternalClientLauncher::operator()(mir::Server& server)
     static auto const default_x11_env = "GDK_BACKEND=x11:QT_QPA_PLATFORM=xcb:SDL_VIDEODRIVER=x11";
     static auto const app_env_amend = "app-env-amend";
     static auto const default_env_amend = "";
+    static auto const app_launch_helper = "app-launch-helper";
 
     server.add_configuration_option(
         app_env,
@@ -94,6 +110,20 @@ void miral::ExternalClientLauncher::operator()(mir::Server& server)
         "X11 changes to --app-env for launched apps",
         default_x11_env);
 
+    server.add_configuration_option(
+        app_launch_helper,
+        "Launch apps from a helper process started with the server, rather than forking the server each time",
+        false);
+
+    // The helper has to be forked before the server is initialized, as it is to stay small
+    server.add_pre_init_callback([self=self, &server]
+         {
+             if (server.get_options()->get<bool>(app_launch_helper))
+             {
+                 self->launch_helper = std::make_shared<LaunchHelper>();
+             }
+         });
+
     server.add_init_callback([self=self, &server]
          {
              auto const options = server.get_options();
@@ -116,7 +146,7 @@ auto miral::ExternalClientLauncher::launch(std::vector<std::string> const& comma
     auto const wayland_display = self->server->wayland_display();
     auto const x11_display = self->server->x11_display();
 
-    return launch_app_env(command_line, wayland_display, x11_display, self->env);
+    return self->launch(command_line, wayland_display, x11_display, self->env);
 }
 
 miral::ExternalClientLauncher::ExternalClientLauncher() : self{std::make_shared<Self>()} {}
@@ -131,7 +161,7 @@ auto  miral::ExternalClientLauncher::launch_using_x11(std::vector<std::string> c
     if (auto const x11_display = self->server->x11_display())
     {
         auto const wayland_display = self->server->wayland_display();
-        return launch_app_env(command_line, wayland_display, x11_display, self->x11_env);
+        return self->launch(command_line, wayland_display, x11_display, self->x11_env);
     }
 
     return -1;
@@ -19,10 +19,20 @@
 #include "miral/internal_client.h"
 #include "join_client_threads.h"
 
+#include <mir/compositor/buffer_stream.h>
 #include <mir/fd.h>
+#include <mir/frontend/event_sink.h>
+#include <mir/graphics/buffer_pool.h>
+#include <mir/graphics/buffer_properties.h>
 #include <mir/main_loop.h>
+#include <mir/renderer/sw/pixel_source.h>
 #include <mir/server.h>
+#include <mir/scene/null_surface_observer.h>
 #include <mir/scene/session.h>
+#include <mir/scene/surface.h>
+#include <mir/scene/surface_creation_parameters.h>
+#include <mir/shell/shell.h>
+#include <mir/shell/surface_specification.h>
 #include <mir/raii.h>
 
 #define MIR_LOG_COMPONENT "miral::Internal Client"
@@ -35,6 +45,7 @@
 #include <mutex>
 #include <thread>
 #include <map>
+#include <unistd.h>
 
 namespace
 {
@@ -155,6 +166,260 @@ void WlInternalClientRunner<Base>::join_client_thread()
     }
 }
 
+namespace
+{
+// Events reach an in-process client through its surfaces' observers, so there's nothing
+// for the session to send
+class InProcessEventSink : public mir::frontend::EventSink
+{
+public:
+    void handle_event(mir::EventUPtr&&) override {}
+    void handle_lifecycle_event(MirLifecycleState) override {}
+    void handle_display_config_change(mir::graphics::DisplayConfiguration const&) override {}
+    void send_ping(int32_t) override {}
+    void handle_input_config_change(MirInputConfig const&) override {}
+    void handle_error(mir::ClientVisibleError const&) override {}
+    void send_buffer(mir::frontend::BufferStreamId, mir::graphics::Buffer&, mir::graphics::BufferIpcMsgType) override {}
+    void add_buffer(mir::graphics::Buffer&) override {}
+    void error_buffer(mir::geometry::Size, MirPixelFormat, std::string const&) override {}
+    void update_buffer(mir::graphics::Buffer&) override {}
+};
+}
+
+struct miral::InProcessClient::Self
+{
+    Self(mir::Server& server, std::string const& name) :
+        shell{server.the_shell()},
+        allocator{server.the_buffer_pool()},
+        session{shell->open_session(getpid(), name, std::make_shared<InProcessEventSink>())}
+    {
+    }
+
+    ~Self()
+    {
+        shell->close_session(session);
+    }
+
+    std::shared_ptr<mir::shell::Shell> const shell;
+    std::shared_ptr<mir::graphics::GraphicBufferAllocator> const allocator;
+    std::shared_ptr<mir::scene::Session> const session;
+
+    std::mutex mutable mutex;
+    std::condition_variable mutable stopped;
+    bool stopping = false;
+};
+
+miral::InProcessClient::InProcessClient(mir::Server& server, std::string const& name) :
+    self{std::make_shared<Self>(server, name)}
+{
+}
+
+miral::InProcessClient::~InProcessClient() = default;
+
+auto miral::InProcessClient::session() const -> std::shared_ptr<mir::scene::Session>
+{
+    return self->session;
+}
+
+auto miral::InProcessClient::wait_for(std::chrono::milliseconds timeout) const -> bool
+{
+    std::unique_lock<std::mutex> lock{self->mutex};
+    return !self->stopped.wait_for(lock, timeout, [this] { return self->stopping; });
+}
+
+void miral::InProcessClient::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock{self->mutex};
+        self->stopping = true;
+    }
+    self->stopped.notify_all();
+}
+
+struct miral::InProcessSurface::Self : mir::scene::NullSurfaceObserver
+{
+    Self(std::shared_ptr<InProcessClient::Self> const& client, mir::geometry::Size size, MirPixelFormat format) :
+        client{client},
+        format{format},
+        size{size},
+        stream{client->session->create_buffer_stream(
+            mir::graphics::BufferProperties{size, format, mir::graphics::BufferUsage::software})}
+    {
+    }
+
+    void input_consumed(mir::scene::Surface const*, MirEvent const* event) override
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        if (input_callback)
+            input_callback(*event);
+    }
+
+    void presented(mir::compositor::Presentation const& presentation)
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        if (presented_callback)
+            presented_callback(presentation);
+    }
+
+    std::weak_ptr<InProcessClient::Self> const client;
+    MirPixelFormat const format;
+    mir::geometry::Size size;
+    std::shared_ptr<mir::compositor::BufferStream> const stream;
+    std::shared_ptr<mir::scene::Surface> surface;
+
+    std::mutex mutex;
+    std::function<void(mir::compositor::Presentation const&)> presented_callback;
+    std::function<void(MirEvent const&)> input_callback;
+};
+
+miral::InProcessSurface::InProcessSurface(
+    InProcessClient const& client,
+    WindowSpecification const& spec,
+    MirPixelFormat format) :
+    self{std::make_shared<Self>(client.self, spec.size().value(), format)}
+{
+    std::weak_ptr<Self> const weak_self{self};
+    self->stream->set_frame_presented_callback([weak_self](mir::compositor::Presentation const& presentation)
+        {
+            if (auto const self = weak_self.lock())
+                self->presented(presentation);
+        });
+
+    mir::scene::SurfaceCreationParameters params;
+    spec.update(params);
+    params.content = self->stream;
+    self->surface = client.self->shell->create_surface(client.self->session, params, self);
+}
+
+miral::InProcessSurface::~InProcessSurface()
+{
+    // The surface holds self as its observer, so it must go for self to
+    auto const surface = std::move(self->surface);
+    if (auto const client = self->client.lock())
+    {
+        client->shell->destroy_surface(client->session, surface);
+        client->session->destroy_buffer_stream(self->stream);
+    }
+}
+
+auto miral::InProcessSurface::window() const -> Window
+{
+    if (auto const client = self->client.lock())
+        return Window{client->session, self->surface};
+
+    return Window{};
+}
+
+void miral::InProcessSurface::draw(
+    mir::geometry::Size const& size,
+    std::function<void(Pixels const& pixels)> const& paint)
+{
+    auto const client = self->client.lock();
+    if (!client)
+        throw std::logic_error{"In-process surface drawn after its client has closed"};
+
+    auto const buffer = client->allocator->alloc_software_buffer(size, self->format);
+    {
+        // Unmapping makes the drawing visible to the GPU
+        auto const mapping = mir::renderer::software::as_write_mappable_buffer(buffer)->map_writeable();
+        paint(Pixels{mapping->data(), mapping->size(), mapping->stride(), mapping->format()});
+    }
+
+    if (size != self->size)
+    {
+        mir::shell::SurfaceSpecification resize;
+        resize.width = size.width;
+        resize.height = size.height;
+        client->shell->modify_surface(client->session, self->surface, resize);
+        self->size = size;
+    }
+
+    self->stream->submit_buffer(buffer);
+}
+
+void miral::InProcessSurface::on_presented(
+    std::function<void(mir::compositor::Presentation const& presentation)> const& callback)
+{
+    std::lock_guard<std::mutex> lock{self->mutex};
+    self->presented_callback = callback;
+}
+
+void miral::InProcessSurface::on_input(std::function<void(MirEvent const& event)> const& callback)
+{
+    std::lock_guard<std::mutex> lock{self->mutex};
+    self->input_callback = callback;
+}
+
+// Like WlInternalClientRunner, but client_code is given an InProcessClient rather than a
+// Wayland connection
+template<typename Base>
+class InProcessClientRunner : public Base, public virtual InternalClientRunner
+{
+public:
+    InProcessClientRunner(std::string name, std::function<void(miral::InProcessClient& client)> client_code);
+
+    void run(mir::Server& server) override;
+    void join_client_thread() override;
+
+    ~InProcessClientRunner() override;
+
+private:
+    std::string const name;
+    std::function<void(miral::InProcessClient& client)> const client_code;
+    std::unique_ptr<miral::InProcessClient> client;
+    std::thread thread;
+};
+
+template<typename Base>
+InProcessClientRunner<Base>::InProcessClientRunner(
+    std::string name,
+    std::function<void(miral::InProcessClient& client)> client_code) :
+    name(std::move(name)),
+    client_code(std::move(client_code))
+{
+}
+
+template<typename Base>
+void InProcessClientRunner<Base>::run(mir::Server& server)
+{
+    client = std::make_unique<miral::InProcessClient>(server, name);
+
+    thread = std::thread{[this]
+        {
+            try
+            {
+                client_code(*client);
+            }
+            catch (std::exception const& e)
+            {
+                mir::log(mir::logging::Severity::informational, MIR_LOG_COMPONENT,
+                         std::make_exception_ptr(e), e.what());
+            }
+        }};
+}
+
+template<typename Base>
+InProcessClientRunner<Base>::~InProcessClientRunner()
+{
+    join_client_thread();
+}
+
+template<typename Base>
+void InProcessClientRunner<Base>::join_client_thread()
+{
+    if (client)
+    {
+        client->stop();
+    }
+
+    if (thread.joinable())
+    {
+        thread.join();
+    }
+
+    client.reset();
+}
+
 miral::StartupInternalClient::StartupInternalClient(
     std::function<void(struct ::wl_display* display)> client_code,
     std::function<void(std::weak_ptr<mir::scene::Session> const session)> connect_notification) :
@@ -197,6 +462,15 @@ void miral::InternalClientLauncher::launch(
     register_runner(self->server, self->runner);
 }
 
+void miral::InternalClientLauncher::run_in_process(
+    std::string const& name,
+    std::function<void(InProcessClient& client)> const& client_code) const
+{
+    self->runner = std::make_shared<InProcessClientRunner<Self>>(name, client_code);
+    self->server->the_main_loop()->enqueue(this, [this] { self->runner->run(*self->server); });
+    register_runner(self->server, self->runner);
+}
+
 miral::InternalClientLauncher::InternalClientLauncher() : self{std::make_shared<Self>()} {}
 miral::InternalClientLauncher::~InternalClientLauncher() = default;
 
@@ -23,7 +23,10 @@
 
 #include <unistd.h>
 #include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
 
+#include <algorithm>
 #include <cstring>
 #include <stdexcept>
 #include <system_error>
@@ -58,67 +61,255 @@ void strip_mir_env_variables()
         unsetenv(var.c_str());
     }
 }
-}  // namespace
 
-auto miral::launch_app_env(
+[[noreturn]] void exec_app(
     std::vector<std::string> const& app,
     mir::optional_value<std::string> const& wayland_display,
     mir::optional_value<std::string> const& x11_display,
-    miral::AppEnvironment const& app_env) -> pid_t
+    miral::AppEnvironment const& app_env)
 {
-    pid_t pid = fork();
+    strip_mir_env_variables();
 
-    if (pid < 0)
+    if (x11_display)
     {
-        BOOST_THROW_EXCEPTION((std::system_error{errno, std::system_category(), "Failed to fork process"}));
+        setenv("DISPLAY", x11_display.value().c_str(),  true);   // configure X11 socket
+    }
+    else
+    {
+        unsetenv("DISPLAY");
     }
 
-    if (pid == 0)
+    if (wayland_display)
+    {
+        setenv("WAYLAND_DISPLAY", wayland_display.value().c_str(),  true);   // configure Wayland socket
+    }
+    else
     {
-        strip_mir_env_variables();
+        unsetenv("WAYLAND_DISPLAY");
+    }
 
-        if (x11_display)
+    for (auto const& env : app_env)
+    {
+        if (env.second)
         {
-            setenv("DISPLAY", x11_display.value().c_str(),  true);   // configure X11 socket
+            setenv(env.first.c_str(), env.second.value().c_str(), true);
         }
         else
         {
-            unsetenv("DISPLAY");
+            unsetenv(env.first.c_str());
         }
+    }
 
-        if (wayland_display)
+    std::vector<char const*> exec_args;
+
+    for (auto const& arg : app)
+        exec_args.push_back(arg.c_str());
+
+    exec_args.push_back(nullptr);
+
+    execvp(exec_args[0], const_cast<char*const*>(exec_args.data()));
+
+    mir::log_warning("Failed to execute client (\"%s\") error: %s", exec_args[0], strerror(errno));
+    exit(EXIT_FAILURE);
+}
+
+// A launch request is a sequence of NUL terminated strings, each tagged by its first character
+char const tag_wayland_display = 'W';
+char const tag_x11_display = 'X';
+char const tag_set_env = 'E';
+char const tag_unset_env = 'U';
+char const tag_arg = 'A';
+
+struct LaunchReply
+{
+    pid_t pid;
+    int error;
+};
+
+auto encode_request(
+    std::vector<std::string> const& app,
+    mir::optional_value<std::string> const& wayland_display,
+    mir::optional_value<std::string> const& x11_display,
+    miral::AppEnvironment const& app_env) -> std::string
+{
+    std::string request;
+    auto const append = [&](char tag, std::string const& value)
         {
-            setenv("WAYLAND_DISPLAY", wayland_display.value().c_str(),  true);   // configure Wayland socket
-        }
+            request += tag;
+            request += value;
+            request += '\0';
+        };
+
+    if (wayland_display)
+        append(tag_wayland_display, wayland_display.value());
+
+    if (x11_display)
+        append(tag_x11_display, x11_display.value());
+
+    for (auto const& env : app_env)
+    {
+        if (env.second)
+            append(tag_set_env, env.first + '=' + env.second.value());
         else
-        {
-            unsetenv("WAYLAND_DISPLAY");
-        }
+            append(tag_unset_env, env.first);
+    }
+
+    for (auto const& arg : app)
+        append(tag_arg, arg);
+
+    return request;
+}
+
+/// Serves launch requests until the server closes its end of the socket
+[[noreturn]] void run_helper(int socket)
+{
+    // Let our children be reaped without our waiting for them
+    signal(SIGCHLD, SIG_IGN);
 
-        for (auto const& env : app_env)
+    for (;;)
+    {
+        auto const size = recv(socket, nullptr, 0, MSG_PEEK | MSG_TRUNC);
+        if (size < 0 && errno == EINTR)
+            continue;
+        if (size <= 0)
+            _exit(EXIT_SUCCESS);
+
+        std::vector<char> buffer(size);
+        if (recv(socket, buffer.data(), buffer.size(), 0) != size)
+            _exit(EXIT_FAILURE);
+
+        std::vector<std::string> app;
+        mir::optional_value<std::string> wayland_display;
+        mir::optional_value<std::string> x11_display;
+        miral::AppEnvironment app_env;
+
+        for (auto i = buffer.begin(); i != buffer.end();)
         {
-            if (env.second)
+            auto const end = std::find(i, buffer.end(), '\0');
+            auto const tag = *i;
+            std::string const value{i + 1, end};
+
+            switch (tag)
             {
-                setenv(env.first.c_str(), env.second.value().c_str(), true);
-            }
-            else
+            case tag_wayland_display: wayland_display = value; break;
+            case tag_x11_display: x11_display = value; break;
+            case tag_unset_env: app_env[value] = std::experimental::nullopt; break;
+            case tag_arg: app.push_back(value); break;
+            case tag_set_env:
             {
-                unsetenv(env.first.c_str());
+                auto const equals = value.find('=');
+                app_env[value.substr(0, equals)] = value.substr(equals + 1);
+                break;
             }
+            }
+
+            i = end == buffer.end() ? end : end + 1;
         }
 
-        std::vector<char const*> exec_args;
+        LaunchReply reply{-1, EINVAL};
+        if (!app.empty())
+        {
+            reply.pid = fork();
+            reply.error = reply.pid < 0 ? errno : 0;
+
+            if (reply.pid == 0)
+            {
+                close(socket);
+                signal(SIGCHLD, SIG_DFL);   // An ignored SIGCHLD would survive the exec
+                exec_app(app, wayland_display, x11_display, app_env);
+            }
+        }
 
-        for (auto const& arg : app)
-            exec_args.push_back(arg.c_str());
+        send(socket, &reply, sizeof reply, MSG_NOSIGNAL);
+    }
+}
+}  // namespace
 
-        exec_args.push_back(nullptr);
+auto miral::launch_app_env(
+    std::vector<std::string> const& app,
+    mir::optional_value<std::string> const& wayland_display,
+    mir::optional_value<std::string> const& x11_display,
+    miral::AppEnvironment const& app_env) -> pid_t
+{
+    pid_t pid = fork();
 
-        execvp(exec_args[0], const_cast<char*const*>(exec_args.data()));
+    if (pid < 0)
+    {
+        BOOST_THROW_EXCEPTION((std::system_error{errno, std::system_category(), "Failed to fork process"}));
+    }
 
-        mir::log_warning("Failed to execute client (\"%s\") error: %s", exec_args[0], strerror(errno));
-        exit(EXIT_FAILURE);
+    if (pid == 0)
+    {
+        exec_app(app, wayland_display, x11_display, app_env);
     }
 
     return pid;
 }
+
+miral::LaunchHelper::LaunchHelper()
+{
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, fds) < 0)
+    {
+        BOOST_THROW_EXCEPTION((std::system_error{errno, std::system_category(), "Failed to create launch helper socket"}));
+    }
+
+    mir::Fd server_end{fds[0]};
+    mir::Fd helper_end{fds[1]};
+
+    helper_pid = fork();
+
+    if (helper_pid < 0)
+    {
+        BOOST_THROW_EXCEPTION((std::system_error{errno, std::system_category(), "Failed to fork launch helper"}));
+    }
+
+    if (helper_pid == 0)
+    {
+        close(server_end);
+        run_helper(helper_end);
+    }
+
+    socket = std::move(server_end);
+}
+
+miral::LaunchHelper::~LaunchHelper()
+{
+    // The helper exits when it sees the socket close
+    socket = mir::Fd{};
+    while (waitpid(helper_pid, nullptr, 0) < 0 && errno == EINTR)
+        ;
+}
+
+auto miral::LaunchHelper::launch_app_env(
+    std::vector<std::string> const& app,
+    mir::optional_value<std::string> const& wayland_display,
+    mir::optional_value<std::string> const& x11_display,
+    miral::AppEnvironment const& app_env) -> pid_t
+{
+    auto const request = encode_request(app, wayland_display, x11_display, app_env);
+
+    std::lock_guard<std::mutex> lock{mutex};
+
+    if (send(socket, request.data(), request.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(request.size()))
+    {
+        BOOST_THROW_EXCEPTION((std::system_error{errno, std::system_category(), "Failed to send to launch helper"}));
+    }
+
+    LaunchReply reply;
+    ssize_t received;
+    while ((received = recv(socket, &reply, sizeof reply, 0)) < 0 && errno == EINTR)
+        ;
+
+    if (received != sizeof reply)
+    {
+        BOOST_THROW_EXCEPTION(std::runtime_error("Launch helper did not reply"));
+    }
+
+    if (reply.pid < 0)
+    {
+        BOOST_THROW_EXCEPTION((std::system_error{reply.error, std::system_category(), "Launch helper failed to start app"}));
+    }
+
+    return reply.pid;
+}
@@ -33,25 +33,40 @@ bool visible(miral::Window const& window)
 
 void miral::MRUWindowList::push(Window const& window)
 {
-    windows.erase(remove(begin(windows), end(windows), window), end(windows));
-    windows.push_back(window);
+    auto const existing = positions.find(window);
+    if (existing != positions.end())
+    {
+        windows.splice(windows.begin(), windows, existing->second);
+        return;
+    }
+
+    positions.emplace(window, windows.insert(windows.begin(), window));
 }
 
 void miral::MRUWindowList::erase(Window const& window)
 {
-    windows.erase(remove(begin(windows), end(windows), window), end(windows));
+    auto const existing = positions.find(window);
+    if (existing == positions.end())
+        return;
+
+    windows.erase(existing->second);
+    positions.erase(window);
 }
 
 auto miral::MRUWindowList::top() const -> Window
 {
-    auto const& found = std::find_if(rbegin(windows), rend(windows), visible);
-    return (found != rend(windows)) ? *found: Window{};
+    auto const& found = std::find_if(begin(windows), end(windows), visible);
+    return (found != end(windows)) ? *found: Window{};
 }
 
 void miral::MRUWindowList::enumerate(Enumerator const& enumerator) const
 {
-    for (auto i = windows.rbegin(); i != windows.rend(); ++i)
-        if (visible(*i))
-            if (!enumerator(const_cast<Window&>(*i)))
+    for (auto i = windows.begin(); i != windows.end();)
+    {
+        // The enumerator may push the window it is given (moving it to the front)
+        auto const current = i++;
+        if (visible(*current))
+            if (!enumerator(const_cast<Window&>(*current)))
                 break;
+    }
 }
@@ -19,13 +19,17 @@
 #ifndef MIRAL_MRU_WINDOW_LIST_H
 #define MIRAL_MRU_WINDOW_LIST_H
 
+#include "weak_ptr_map.h"
+
 #include <miral/window.h>
 
 #include <functional>
-#include <vector>
+#include <list>
 
 namespace miral
 {
+/// Windows in most recently used order. Windows are identified by their surface, so pushing and erasing are
+/// constant time.
 class MRUWindowList
 {
 public:
@@ -39,7 +43,9 @@ public:
     void enumerate(Enumerator const& enumerator) const;
 
 private:
-    std::vector<Window> windows;
+    /// Most recently used first
+    std::list<Window> windows;
+    WeakPtrMap<mir::scene::Surface, std::list<Window>::iterator> positions;
 };
 }
 
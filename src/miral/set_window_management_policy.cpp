@@ -39,7 +39,8 @@ miral::SetWindowManagementPolicy::~SetWindowManagementPolicy() = default;
 
 void miral::SetWindowManagementPolicy::operator()(mir::Server& server) const
 {
-    server.add_configuration_option(trace_option, "log trace message", mir::OptionType::null);
+    server.add_configuration_option(
+        trace_option, "trace window management (logged on SIGUSR2, or on error)", mir::OptionType::null);
 
     server.override_the_window_manager_builder([this, &server](msh::FocusController* focus_controller)
         -> std::shared_ptr<msh::WindowManager>
@@ -50,17 +51,12 @@ void miral::SetWindowManagementPolicy::operator()(mir::Server& server) const
 
             if (server.get_options()->is_set(trace_option))
             {
-                auto trace_builder = [this](WindowManagerTools const& tools) -> std::unique_ptr<miral::WindowManagementPolicy>
-                    {
-                        return std::make_unique<WindowManagementTrace>(tools, builder);
-                    };
-
                 return std::make_shared<BasicWindowManager>(
                     focus_controller,
                     display_layout,
                     persistent_surface_store,
                     *server.the_display_configuration_observer_registrar(),
-                    trace_builder);
+                    WindowManagementTrace::builder(server, builder));
             }
 
             return std::make_shared<BasicWindowManager>(
@@ -0,0 +1,57 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "trace_buffer.h"
+
+#include <algorithm>
+#include <cstdio>
+
+miral::TraceBuffer::TraceBuffer(size_t capacity) :
+    entries(std::max<size_t>(capacity, 1))
+{
+}
+
+void miral::TraceBuffer::record(Format format)
+{
+    Entry entry{std::chrono::steady_clock::now(), std::move(format)};
+
+    std::lock_guard<std::mutex> lock{mutex};
+    // The entry replaced is destroyed (along with whatever it captured) after the lock is released
+    std::swap(entries[next], entry);
+    next = (next + 1) % entries.size();
+    count = std::min(count + 1, entries.size());
+}
+
+void miral::TraceBuffer::dump(Sink const& sink)
+{
+    std::vector<Entry> recorded;
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        recorded.reserve(count);
+        for (auto i = (next + entries.size() - count) % entries.size(); recorded.size() != count; i = (i + 1) % entries.size())
+            recorded.push_back(std::move(entries[i]));
+        count = 0;
+    }
+
+    auto const now = std::chrono::steady_clock::now();
+    for (auto const& entry : recorded)
+    {
+        std::chrono::duration<double, std::milli> const age = now - entry.time;
+        char prefix[32];
+        snprintf(prefix, sizeof prefix, "[-%.3fms] ", age.count());
+        sink(prefix + entry.format());
+    }
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIRAL_TRACE_BUFFER_H
+#define MIRAL_TRACE_BUFFER_H
+
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace miral
+{
+/// The most recent entries of a trace, kept in memory until they are dumped.
+///
+/// An entry is recorded as a function that formats it, which is only called if the entry is dumped: recording
+/// costs a copy of whatever the entry describes, not the formatting. Once the buffer is full each entry recorded
+/// replaces the oldest.
+class TraceBuffer
+{
+public:
+    using Format = std::function<std::string()>;
+    using Sink = std::function<void(std::string const& line)>;
+
+    explicit TraceBuffer(size_t capacity);
+
+    void record(Format format);
+
+    /// Formats the entries recorded (oldest first, each with its age) to sink, and forgets them.
+    /// Formatting happens without holding up record().
+    void dump(Sink const& sink);
+
+private:
+    struct Entry
+    {
+        std::chrono::steady_clock::time_point time;
+        Format format;
+    };
+
+    std::mutex mutex;
+    std::vector<Entry> entries;
+    size_t next{0};     ///< Where the next entry goes
+    size_t count{0};    ///< How many entries are recorded (up to the capacity)
+};
+}
+
+#endif //MIRAL_TRACE_BUFFER_H
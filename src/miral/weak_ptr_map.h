@@ -0,0 +1,165 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIRAL_WEAK_PTR_MAP_H
+#define MIRAL_WEAK_PTR_MAP_H
+
+#include <boost/throw_exception.hpp>
+
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+namespace miral
+{
+/// A map keyed by the identity of weak_ptrs (as std::owner_less), with constant time lookup.
+///
+/// Entries are indexed by the address of the object the key pointed to when it was added, so keys still alive are
+/// found by hashing. Keys that have expired (or a key that was never set) are found by searching, as with nothing to
+/// hash that is all there is. Entries are allocated separately so, as with std::map, references to them remain valid
+/// until they are erased.
+template<typename Key, typename Value>
+class WeakPtrMap
+{
+    using Index = std::unordered_multimap<Key const*, std::pair<std::weak_ptr<Key> const, Value>>;
+
+    template<typename IndexIterator, typename Reference>
+    class Iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::pair<std::weak_ptr<Key> const, Value>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::remove_reference_t<Reference>*;
+        using reference = Reference;
+
+        Iterator() = default;
+        explicit Iterator(IndexIterator i) : i{i} {}
+        template<typename I, typename R>
+        Iterator(Iterator<I, R> const& other) : i{other.i} {}
+
+        auto operator*() const -> reference { return i->second; }
+        auto operator->() const -> pointer { return &i->second; }
+        auto operator++() -> Iterator& { ++i; return *this; }
+        auto operator++(int) -> Iterator { auto const result = *this; ++i; return result; }
+        auto operator==(Iterator const& other) const -> bool { return i == other.i; }
+        auto operator!=(Iterator const& other) const -> bool { return i != other.i; }
+
+    private:
+        template<typename, typename> friend class Iterator;
+        friend class WeakPtrMap;
+        IndexIterator i;
+    };
+
+public:
+    using value_type = std::pair<std::weak_ptr<Key> const, Value>;
+    using iterator = Iterator<typename Index::iterator, value_type&>;
+    using const_iterator = Iterator<typename Index::const_iterator, value_type const&>;
+
+    auto begin() -> iterator { return iterator{index.begin()}; }
+    auto end() -> iterator { return iterator{index.end()}; }
+    auto begin() const -> const_iterator { return const_iterator{index.begin()}; }
+    auto end() const -> const_iterator { return const_iterator{index.end()}; }
+
+    auto size() const -> size_t { return index.size(); }
+    auto empty() const -> bool { return index.empty(); }
+
+    auto find(std::weak_ptr<Key> const& key) -> iterator
+    {
+        return iterator{find_in_index(key)};
+    }
+
+    auto find(std::weak_ptr<Key> const& key) const -> const_iterator
+    {
+        return const_iterator{const_cast<WeakPtrMap*>(this)->find_in_index(key)};
+    }
+
+    auto at(std::weak_ptr<Key> const& key) -> Value&
+    {
+        auto const i = find_in_index(key);
+        if (i == index.end())
+            BOOST_THROW_EXCEPTION(std::out_of_range{"WeakPtrMap::at"});
+        return i->second.second;
+    }
+
+    auto at(std::weak_ptr<Key> const& key) const -> Value const&
+    {
+        return const_cast<WeakPtrMap*>(this)->at(key);
+    }
+
+    /// Adds an entry for key, which must be alive, if there isn't one already
+    auto emplace(std::weak_ptr<Key> const& key, Value value) -> std::pair<iterator, bool>
+    {
+        auto const existing = find_in_index(key);
+        if (existing != index.end())
+            return {iterator{existing}, false};
+
+        return {iterator{index.emplace(key.lock().get(), value_type{key, std::move(value)})}, true};
+    }
+
+    auto operator[](std::weak_ptr<Key> const& key) -> Value&
+    {
+        return emplace(key, Value{}).first->second;
+    }
+
+    auto erase(std::weak_ptr<Key> const& key) -> size_t
+    {
+        auto const i = find_in_index(key);
+        if (i == index.end())
+            return 0;
+
+        index.erase(i);
+        return 1;
+    }
+
+private:
+    static auto same_owner(std::weak_ptr<Key> const& lhs, std::weak_ptr<Key> const& rhs) -> bool
+    {
+        return !lhs.owner_before(rhs) && !rhs.owner_before(lhs);
+    }
+
+    auto find_in_index(std::weak_ptr<Key> const& key) -> typename Index::iterator
+    {
+        if (auto const live = key.lock())
+        {
+            // The address may have been used before by an object that has since gone (without being erased)
+            auto const range = index.equal_range(live.get());
+            for (auto i = range.first; i != range.second; ++i)
+            {
+                if (same_owner(i->second.first, key))
+                    return i;
+            }
+            return index.end();
+        }
+
+        if (same_owner(key, std::weak_ptr<Key>{}))
+            return index.end();
+
+        for (auto i = index.begin(); i != index.end(); ++i)
+        {
+            if (same_owner(i->second.first, key))
+                return i;
+        }
+        return index.end();
+    }
+
+    Index index;
+};
+}
+
+#endif //MIRAL_WEAK_PTR_MAP_H
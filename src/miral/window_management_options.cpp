@@ -51,7 +51,8 @@ void miral::WindowManagerOptions::operator()(mir::Server& server) const
     description += "}]";
 
     server.add_configuration_option(wm_option, description, policies.begin()->name);
-    server.add_configuration_option(trace_option, "log trace message", mir::OptionType::null);
+    server.add_configuration_option(
+        trace_option, "trace window management (logged on SIGUSR2, or on error)", mir::OptionType::null);
 
     server.override_the_window_manager_builder([this, &server](msh::FocusController* focus_controller)
         -> std::shared_ptr<msh::WindowManager>
@@ -68,17 +69,12 @@ void miral::WindowManagerOptions::operator()(mir::Server& server) const
                 {
                     if (server.get_options()->is_set(trace_option))
                     {
-                        auto trace_builder = [&option](WindowManagerTools const& tools) -> std::unique_ptr<miral::WindowManagementPolicy>
-                            {
-                                return std::make_unique<WindowManagementTrace>(tools, option.build);
-                            };
-
                         return std::make_shared<BasicWindowManager>(
                             focus_controller,
                             display_layout,
                             persistent_surface_store,
                             *server.the_display_configuration_observer_registrar(),
-                            trace_builder);
+                            WindowManagementTrace::builder(server, option.build));
                     }
 
                     return std::make_shared<BasicWindowManager>
@@ -28,8 +28,14 @@
 #include <mir/scene/surface.h>
 #include <mir/event_printer.h>
 
+#include <mir/main_loop.h>
+#include <mir/server.h>
+
+#include <csignal>
+#include <cstdio>
 #include <iomanip>
 #include <sstream>
+#include <tuple>
 
 #define MIR_LOG_COMPONENT "miral::Window Management"
 #include <mir/log.h>
@@ -43,6 +49,7 @@ catch (std::exception const& x)\
     std::stringstream out;\
     mir::report_exception(out);\
     mir::log_warning("%s throws %s", __func__, out.str().c_str());\
+    buffer->dump([](std::string const& line) { mir::log_warning("%s", line.c_str()); });\
     throw;\
 }
 
@@ -124,10 +131,20 @@ inline auto operator!=(miral::WindowInfo::AspectRatio const& lhs, miral::WindowI
     return lhs.width != rhs.width || lhs.height != rhs.height;
 }
 
-auto dump_of(miral::WindowInfo const& info) -> std::string
+/// A copy of a WindowInfo, along with its window's placement, at the time it was traced
+struct TracedWindowInfo
+{
+    miral::WindowInfo info;
+    mir::geometry::Point top_left;
+    mir::geometry::Size size;
+};
+
+auto dump_of(TracedWindowInfo const& traced) -> std::string
 {
     using namespace mir::geometry;
 
+    auto const& info = traced.info;
+
     std::stringstream out;
     {
         BracedItemStream bout{out};
@@ -136,8 +153,8 @@ auto dump_of(miral::WindowInfo const& info) -> std::string
         APPEND(name);
         APPEND(type);
         APPEND(state);
-        bout.append("top_left", info.window().top_left());
-        bout.append("size", info.window().size());
+        bout.append("top_left", traced.top_left);
+        bout.append("size", traced.size);
         if (info.state() != mir_window_state_restored) APPEND(restore_rect);
         if (std::shared_ptr<mir::scene::Surface> parent = info.parent())
             bout.append("parent", parent->name());
@@ -203,6 +220,8 @@ auto dump_of(miral::WindowSpecification const& specification) -> std::string
         APPEND_IF_SET(depth_layer);
         APPEND_IF_SET(attached_edges);
         APPEND_IF_SET(exclusive_rect);
+        APPEND_IF_SET(tearing_allowed);
+        APPEND_IF_SET(max_frame_rate);
 #undef  APPEND_IF_SET
     }
 
@@ -356,13 +375,193 @@ auto dump_of(miral::Zone const& zone) -> std::string
 {
     return dump_of(zone.extents());
 }
+
+auto dump_of(mir::geometry::Displacement displacement) -> std::string
+{
+    std::stringstream out;
+    out << displacement;
+    return out.str();
+}
+
+auto dump_of(std::vector<std::string> const& names) -> std::string
+{
+    std::stringstream out;
+
+    {
+        BracedItemStream bout{out};
+
+        for (auto const& name: names)
+            bout.append(name);
+    }
+
+    return out.str();
+}
+
+auto dump_of(std::string const& string) -> std::string
+{
+    return string;
+}
+
+auto dump_of(unsigned int value) -> std::string
+{
+    return std::to_string(value);
+}
+
+auto dump_of(void const* pointer) -> std::string
+{
+    std::stringstream out;
+    out << pointer;
+    return out.str();
+}
+
+auto dump_of(MirResizeEdge edge) -> std::string
+{
+    std::stringstream out;
+    out << "0x" << std::hex << edge;
+    return out.str();
+}
+
+auto dump_of(std::shared_ptr<MirEvent const> const& event) -> std::string
+{
+    auto const input_event = mir_event_get_input_event(event.get());
+
+    switch (mir_input_event_get_type(input_event))
+    {
+    case mir_input_event_type_key:
+        return dump_of(mir_input_event_get_keyboard_event(input_event));
+
+    case mir_input_event_type_touch:
+        return dump_of(mir_input_event_get_touch_event(input_event));
+
+    case mir_input_event_type_pointer:
+        return dump_of(mir_input_event_get_pointer_event(input_event));
+
+    default:
+        return "{}";
+    }
+}
+
+// What is recorded of each thing traced: a copy of it, or what we need of it, that can be formatted later (by
+// dump_of()). Anything that would keep an application alive is described at once instead.
+template<typename Type>
+auto traced(Type const& value) -> Type
+{
+    return value;
+}
+
+auto traced(miral::WindowInfo const& info) -> TracedWindowInfo
+{
+    return TracedWindowInfo{miral::WindowInfo{info}, info.window().top_left(), info.window().size()};
+}
+
+auto traced(miral::Window const& window) -> std::string
+{
+    return dump_of(window);
+}
+
+auto traced(std::vector<miral::Window> const& windows) -> std::vector<std::string>
+{
+    std::vector<std::string> result;
+    result.reserve(windows.size());
+    for (auto const& window : windows)
+        result.push_back(dump_of(window));
+    return result;
+}
+
+auto traced(miral::Application const& application) -> std::string
+{
+    return dump_of(application);
+}
+
+auto traced(miral::ApplicationInfo const& app_info) -> std::string
+{
+    return dump_of(app_info);
+}
+
+auto traced(std::shared_ptr<miral::Workspace> const& workspace) -> void const*
+{
+    return workspace.get();
+}
+
+auto traced(miral::Output const& output) -> mir::geometry::Rectangle
+{
+    return output.extents();
+}
+
+auto traced(miral::Zone const& zone) -> mir::geometry::Rectangle
+{
+    return zone.extents();
+}
+
+auto traced(MirInputEvent const* event) -> std::shared_ptr<MirEvent const>
+{
+    return {mir_event_ref(mir_input_event_get_event(event)), &mir_event_unref};
+}
+
+auto traced(MirKeyboardEvent const* event) -> std::shared_ptr<MirEvent const>
+{
+    return traced(mir_keyboard_event_input_event(event));
+}
+
+auto traced(MirTouchEvent const* event) -> std::shared_ptr<MirEvent const>
+{
+    return traced(mir_touch_event_input_event(event));
+}
+
+auto traced(MirPointerEvent const* event) -> std::shared_ptr<MirEvent const>
+{
+    return traced(mir_pointer_event_input_event(event));
+}
+
+template<typename... Strings>
+auto format(char const* format, Strings const&... strings) -> std::string
+{
+    auto const length = snprintf(nullptr, 0, format, strings.c_str()...);
+    std::string result(std::max(length, 0), '\0');
+    snprintf(result.data(), result.size() + 1, format, strings.c_str()...);
+    return result;
+}
+
+/// Records an entry of format (in which each %s is the function, then one of values) to be formatted if dumped
+template<typename... Values>
+void record(miral::TraceBuffer& buffer, char const* function, char const* format, Values const&... values)
+{
+    buffer.record([function, format, recorded = std::make_tuple(traced(values)...)]
+        {
+            return std::apply(
+                [&](auto const&... values) { return ::format(format, std::string{function}, dump_of(values)...); },
+                recorded);
+        });
+}
+
+/// How many entries are kept for dumping
+size_t const trace_capacity = 4096;
+}
+
+auto miral::WindowManagementTrace::builder(mir::Server& server, WindowManagementPolicyBuilder const& builder)
+-> WindowManagementPolicyBuilder
+{
+    auto const buffer = std::make_shared<TraceBuffer>(trace_capacity);
+
+    server.the_main_loop()->register_signal_handler({SIGUSR2}, [buffer](int)
+        {
+            mir::log_info("Window management trace (on SIGUSR2):");
+            buffer->dump([](std::string const& line) { mir::log_info("%s", line.c_str()); });
+        });
+
+    return [buffer, builder](WindowManagerTools const& tools) -> std::unique_ptr<WindowManagementPolicy>
+        {
+            return std::make_unique<WindowManagementTrace>(tools, builder, buffer);
+        };
 }
 
 miral::WindowManagementTrace::WindowManagementTrace(
     WindowManagerTools const& wrapped,
-    WindowManagementPolicyBuilder const& builder) :
+    WindowManagementPolicyBuilder const& builder,
+    std::shared_ptr<TraceBuffer> const& buffer) :
     wrapped{wrapped},
-    policy(builder(WindowManagerTools{this}))
+    policy(builder(WindowManagerTools{this})),
+    buffer{buffer}
 {
 }
 
@@ -370,7 +569,7 @@ auto miral::WindowManagementTrace::count_applications() const -> unsigned int
 try {
     log_input();
     auto const result = wrapped.count_applications();
-    mir::log_info("%s -> %d", __func__, result);
+    record(*buffer, __func__, "%s -> %s", result);
     trace_count++;
     return result;
 }
@@ -379,7 +578,7 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::for_each_application(std::function<void(miral::ApplicationInfo&)> const& functor)
 try {
     log_input();
-    mir::log_info("%s", __func__);
+    record(*buffer, __func__, "%s");
     trace_count++;
     wrapped.for_each_application(functor);
 }
@@ -390,7 +589,7 @@ auto miral::WindowManagementTrace::find_application(std::function<bool(Applicati
 try {
     log_input();
     auto result = wrapped.find_application(predicate);
-    mir::log_info("%s -> %s", __func__, dump_of(result).c_str());
+    record(*buffer, __func__, "%s -> %s", result);
     trace_count++;
     return result;
 }
@@ -400,7 +599,7 @@ auto miral::WindowManagementTrace::info_for(std::weak_ptr<mir::scene::Session> c
 try {
     log_input();
     auto& result = wrapped.info_for(session);
-    mir::log_info("%s -> %s", __func__, result.application()->name().c_str());
+    record(*buffer, __func__, "%s -> %s", result.application()->name());
     trace_count++;
     return result;
 }
@@ -410,7 +609,7 @@ auto miral::WindowManagementTrace::info_for(std::weak_ptr<mir::scene::Surface> c
 try {
     log_input();
     auto& result = wrapped.info_for(surface);
-    mir::log_info("%s -> %s", __func__, result.name().c_str());
+    record(*buffer, __func__, "%s -> %s", result.name());
     trace_count++;
     return result;
 }
@@ -420,7 +619,7 @@ auto miral::WindowManagementTrace::info_for(Window const& window) const -> Windo
 try {
     log_input();
     auto& result = wrapped.info_for(window);
-    mir::log_info("%s -> %s", __func__, result.name().c_str());
+    record(*buffer, __func__, "%s -> %s", result.name());
     trace_count++;
     return result;
 }
@@ -429,7 +628,7 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::ask_client_to_close(miral::Window const& window)
 try {
     log_input();
-    mir::log_info("%s -> %s", __func__, dump_of(window).c_str());
+    record(*buffer, __func__, "%s -> %s", window);
     trace_count++;
     wrapped.ask_client_to_close(window);
 }
@@ -439,7 +638,7 @@ auto miral::WindowManagementTrace::active_window() const -> Window
 try {
     log_input();
     auto result = wrapped.active_window();
-    mir::log_info("%s -> %s", __func__, dump_of(result).c_str());
+    record(*buffer, __func__, "%s -> %s", result);
     trace_count++;
     return result;
 }
@@ -449,7 +648,7 @@ auto miral::WindowManagementTrace::select_active_window(Window const& hint) -> W
 try {
     log_input();
     auto result = wrapped.select_active_window(hint);
-    mir::log_info("%s hint=%s -> %s", __func__, dump_of(hint).c_str(), dump_of(result).c_str());
+    record(*buffer, __func__, "%s hint=%s -> %s", hint, result);
     trace_count++;
     return result;
 }
@@ -459,9 +658,7 @@ auto miral::WindowManagementTrace::window_at(mir::geometry::Point cursor) const
 try {
     log_input();
     auto result = wrapped.window_at(cursor);
-    std::stringstream out;
-    out << cursor << " -> " << dump_of(result);
-    mir::log_info("%s cursor=%s", __func__, out.str().c_str());
+    record(*buffer, __func__, "%s cursor=%s -> %s", cursor, result);
     trace_count++;
     return result;
 }
@@ -471,9 +668,7 @@ auto miral::WindowManagementTrace::active_output() -> mir::geometry::Rectangle c
 try {
     log_input();
     auto result = wrapped.active_output();
-    std::stringstream out;
-    out << result;
-    mir::log_info("%s -> %s", __func__, out.str().c_str());
+    record(*buffer, __func__, "%s -> %s", result);
     trace_count++;
     return result;
 }
@@ -483,9 +678,7 @@ auto miral::WindowManagementTrace::active_application_zone() -> Zone
 try {
     log_input();
     auto result = wrapped.active_application_zone();
-    std::stringstream out;
-    out << result.extents();
-    mir::log_info("%s -> %s", __func__, out.str().c_str());
+    record(*buffer, __func__, "%s -> %s", result);
     trace_count++;
     return result;
 }
@@ -495,7 +688,7 @@ auto miral::WindowManagementTrace::info_for_window_id(std::string const& id) con
 try {
     log_input();
     auto& result = wrapped.info_for_window_id(id);
-    mir::log_info("%s id=%s -> %s", __func__, id.c_str(), dump_of(result).c_str());
+    record(*buffer, __func__, "%s id=%s -> %s", id, result);
     trace_count++;
     return result;
 }
@@ -505,7 +698,7 @@ auto miral::WindowManagementTrace::id_for_window(Window const& window) const ->
 try {
     log_input();
     auto result = wrapped.id_for_window(window);
-    mir::log_info("%s window=%s -> %s", __func__, dump_of(window).c_str(), result.c_str());
+    record(*buffer, __func__, "%s window=%s -> %s", window, result);
     trace_count++;
     return result;
 }
@@ -515,7 +708,7 @@ void miral::WindowManagementTrace::place_and_size_for_state(
     WindowSpecification& modifications, WindowInfo const& window_info) const
 try {
     log_input();
-    mir::log_info("%s modifications=%s window_info=%s", __func__, dump_of(modifications).c_str(), dump_of(window_info).c_str());
+    record(*buffer, __func__, "%s modifications=%s window_info=%s", modifications, window_info);
     wrapped.place_and_size_for_state(modifications, window_info);
 }
 MIRAL_TRACE_EXCEPTION
@@ -523,9 +716,7 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::drag_active_window(mir::geometry::Displacement movement)
 try {
     log_input();
-    std::stringstream out;
-    out << movement;
-    mir::log_info("%s movement=%s", __func__, out.str().c_str());
+    record(*buffer, __func__, "%s movement=%s", movement);
     trace_count++;
     wrapped.drag_active_window(movement);
 }
@@ -534,9 +725,7 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::drag_window(Window const& window, mir::geometry::Displacement& movement)
 try {
     log_input();
-    std::stringstream out;
-    out << movement;
-    mir::log_info("%s window=%s -> %s", __func__, dump_of(window).c_str(), out.str().c_str());
+    record(*buffer, __func__, "%s window=%s -> %s", window, movement);
     trace_count++;
     wrapped.drag_window(window, movement);
 }
@@ -545,7 +734,7 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::focus_next_application()
 try {
     log_input();
-    mir::log_info("%s", __func__);
+    record(*buffer, __func__, "%s");
     trace_count++;
     wrapped.focus_next_application();
 }
@@ -554,7 +743,7 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::focus_prev_application()
 try {
     log_input();
-    mir::log_info("%s", __func__);
+    record(*buffer, __func__, "%s");
     trace_count++;
     wrapped.focus_next_application();
 }
@@ -563,7 +752,7 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::focus_next_within_application()
 try {
     log_input();
-    mir::log_info("%s", __func__);
+    record(*buffer, __func__, "%s");
     trace_count++;
     wrapped.focus_next_within_application();
 }
@@ -572,7 +761,7 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::focus_prev_within_application()
 try {
     log_input();
-    mir::log_info("%s", __func__);
+    record(*buffer, __func__, "%s");
     trace_count++;
     wrapped.focus_prev_within_application();
 }
@@ -581,7 +770,7 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::raise_tree(miral::Window const& root)
 try {
     log_input();
-    mir::log_info("%s root=%s", __func__, dump_of(root).c_str());
+    record(*buffer, __func__, "%s root=%s", root);
     trace_count++;
     wrapped.raise_tree(root);
 }
@@ -590,7 +779,7 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::start_drag_and_drop(miral::WindowInfo& window_info, std::vector<uint8_t> const& handle)
 try {
     log_input();
-    mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    record(*buffer, __func__, "%s window_info=%s", window_info);
     trace_count++;
     wrapped.start_drag_and_drop(window_info, handle);
 }
@@ -599,7 +788,7 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::end_drag_and_drop()
 try {
     log_input();
-    mir::log_info("%s", __func__);
+    record(*buffer, __func__, "%s");
     trace_count++;
     wrapped.end_drag_and_drop();
 }
@@ -609,8 +798,7 @@ void miral::WindowManagementTrace::modify_window(
     miral::WindowInfo& window_info, miral::WindowSpecification const& modifications)
 try {
     log_input();
-    mir::log_info("%s window_info=%s, modifications=%s",
-                  __func__, dump_of(window_info).c_str(), dump_of(modifications).c_str());
+    record(*buffer, __func__, "%s window_info=%s, modifications=%s", window_info, modifications);
     trace_count++;
     wrapped.modify_window(window_info, modifications);
 }
@@ -618,14 +806,21 @@ MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::invoke_under_lock(std::function<void()> const& callback)
 try {
-    mir::log_info("%s", __func__);
+    record(*buffer, __func__, "%s");
     wrapped.invoke_under_lock(callback);
 }
 MIRAL_TRACE_EXCEPTION
 
+void miral::WindowManagementTrace::invoke_under_shared_lock(std::function<void()> const& callback)
+try {
+    record(*buffer, __func__, "%s");
+    wrapped.invoke_under_shared_lock(callback);
+}
+MIRAL_TRACE_EXCEPTION
+
 auto miral::WindowManagementTrace::create_workspace() -> std::shared_ptr<Workspace>
 try {
-    mir::log_info("%s", __func__);
+    record(*buffer, __func__, "%s");
     return wrapped.create_workspace();
 }
 MIRAL_TRACE_EXCEPTION
@@ -633,7 +828,7 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::add_tree_to_workspace(
     miral::Window const& window, std::shared_ptr<miral::Workspace> const& workspace)
 try {
-    mir::log_info("%s window=%s, workspace =%p", __func__, dump_of(window).c_str(), static_cast<void*>(workspace.get()));
+    record(*buffer, __func__, "%s window=%s, workspace =%s", window, workspace);
     wrapped.add_tree_to_workspace(window, workspace);
 }
 MIRAL_TRACE_EXCEPTION
@@ -641,7 +836,7 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::remove_tree_from_workspace(
     miral::Window const& window, std::shared_ptr<miral::Workspace> const& workspace)
 try {
-    mir::log_info("%s window=%s, workspace =%p", __func__, dump_of(window).c_str(), static_cast<void*>(workspace.get()));
+    record(*buffer, __func__, "%s window=%s, workspace =%s", window, workspace);
     wrapped.remove_tree_from_workspace(window, workspace);
 }
 MIRAL_TRACE_EXCEPTION
@@ -649,7 +844,7 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::move_workspace_content_to_workspace(
     std::shared_ptr<Workspace> const& to_workspace, std::shared_ptr<Workspace> const& from_workspace)
 try {
-    mir::log_info("%s to_workspace=%p, from_workspace=%p", __func__, static_cast<void*>(to_workspace.get()), static_cast<void*>(from_workspace.get()));
+    record(*buffer, __func__, "%s to_workspace=%s, from_workspace=%s", to_workspace, from_workspace);
     wrapped.move_workspace_content_to_workspace(to_workspace, from_workspace);
 }
 MIRAL_TRACE_EXCEPTION
@@ -657,7 +852,7 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::for_each_workspace_containing(
     miral::Window const& window, std::function<void(std::shared_ptr<miral::Workspace> const&)> const& callback)
 try {
-    mir::log_info("%s window=%s", __func__, dump_of(window).c_str());
+    record(*buffer, __func__, "%s window=%s", window);
     wrapped.for_each_workspace_containing(window, callback);
 }
 MIRAL_TRACE_EXCEPTION
@@ -665,25 +860,41 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::for_each_window_in_workspace(
     std::shared_ptr<miral::Workspace> const& workspace, std::function<void(miral::Window const&)> const& callback)
 try {
-    mir::log_info("%s workspace =%p", __func__, static_cast<void*>(workspace.get()));
+    record(*buffer, __func__, "%s workspace =%s", workspace);
     wrapped.for_each_window_in_workspace(workspace, callback);
 }
 MIRAL_TRACE_EXCEPTION
 
+void miral::WindowManagementTrace::apply_atomically(std::function<void()> const& changes)
+try {
+    record(*buffer, __func__, "%s");
+    wrapped.apply_atomically(changes);
+}
+MIRAL_TRACE_EXCEPTION
+
+void miral::WindowManagementTrace::take_thumbnail(
+    Window const& window,
+    mir::geometry::Size const& max_size,
+    WindowManagerTools::ThumbnailCallback const& callback)
+try {
+    record(*buffer, __func__, "%s window=%s, max_size=%s", window, max_size);
+    wrapped.take_thumbnail(window, max_size, callback);
+}
+MIRAL_TRACE_EXCEPTION
+
 auto miral::WindowManagementTrace::place_new_window(
     ApplicationInfo const& app_info,
     WindowSpecification const& requested_specification) -> WindowSpecification
 try {
     auto const result = policy->place_new_window(app_info, requested_specification);
-    mir::log_info("%s app_info=%s, requested_specification=%s -> %s",
-              __func__, dump_of(app_info).c_str(), dump_of(requested_specification).c_str(), dump_of(result).c_str());
+    record(*buffer, __func__, "%s app_info=%s, requested_specification=%s -> %s", app_info, requested_specification, result);
     return result;
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::handle_window_ready(miral::WindowInfo& window_info)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    record(*buffer, __func__, "%s window_info=%s", window_info);
     policy->handle_window_ready(window_info);
 }
 MIRAL_TRACE_EXCEPTION
@@ -691,15 +902,14 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::handle_modify_window(
     miral::WindowInfo& window_info, miral::WindowSpecification const& modifications)
 try {
-    mir::log_info("%s window_info=%s, modifications=%s",
-                  __func__, dump_of(window_info).c_str(), dump_of(modifications).c_str());
+    record(*buffer, __func__, "%s window_info=%s, modifications=%s", window_info, modifications);
     policy->handle_modify_window(window_info, modifications);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::handle_raise_window(miral::WindowInfo& window_info)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    record(*buffer, __func__, "%s window_info=%s", window_info);
     policy->handle_raise_window(window_info);
 }
 MIRAL_TRACE_EXCEPTION
@@ -708,7 +918,7 @@ bool miral::WindowManagementTrace::handle_keyboard_event(MirKeyboardEvent const*
 try {
     log_input = [event, this]
         {
-            mir::log_info("handle_keyboard_event event=%s", dump_of(event).c_str());
+            record(*buffer, "handle_keyboard_event", "%s event=%s", event);
             log_input = []{};
         };
 
@@ -720,7 +930,7 @@ bool miral::WindowManagementTrace::handle_touch_event(MirTouchEvent const* event
 try {
     log_input = [event, this]
         {
-            mir::log_info("handle_touch_event event=%s", dump_of(event).c_str());
+            record(*buffer, "handle_touch_event", "%s event=%s", event);
             log_input = []{};
         };
 
@@ -732,7 +942,7 @@ bool miral::WindowManagementTrace::handle_pointer_event(MirPointerEvent const* e
 try {
     log_input = [event, this]
         {
-            mir::log_info("handle_pointer_event event=%s", dump_of(event).c_str());
+            record(*buffer, "handle_pointer_event", "%s event=%s", event);
             log_input = []{};
         };
 
@@ -743,9 +953,7 @@ MIRAL_TRACE_EXCEPTION
 auto miral::WindowManagementTrace::confirm_inherited_move(WindowInfo const& window_info, Displacement movement)
 -> Rectangle
 try {
-    std::stringstream out;
-    out << movement;
-    mir::log_info("%s window_info=%s, movement=%s", __func__, dump_of(window_info).c_str(), out.str().c_str());
+    record(*buffer, __func__, "%s window_info=%s, movement=%s", window_info, movement);
 
     return policy->confirm_inherited_move(window_info, movement);
 }
@@ -762,91 +970,91 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::advise_end()
 try {
     if (trace_count.load() > 0)
-        mir::log_info("====");
+        buffer->record([]{ return std::string{"===="}; });
     policy->advise_end();
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_new_app(miral::ApplicationInfo& application)
 try {
-    mir::log_info("%s application=%s", __func__, dump_of(application).c_str());
+    record(*buffer, __func__, "%s application=%s", application);
     policy->advise_new_app(application);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_delete_app(miral::ApplicationInfo const& application)
 try {
-    mir::log_info("%s application=%s", __func__, dump_of(application).c_str());
+    record(*buffer, __func__, "%s application=%s", application);
     policy->advise_delete_app(application);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_new_window(miral::WindowInfo const& window_info)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    record(*buffer, __func__, "%s window_info=%s", window_info);
     policy->advise_new_window(window_info);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_focus_lost(miral::WindowInfo const& window_info)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    record(*buffer, __func__, "%s window_info=%s", window_info);
     policy->advise_focus_lost(window_info);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_focus_gained(miral::WindowInfo const& window_info)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    record(*buffer, __func__, "%s window_info=%s", window_info);
     policy->advise_focus_gained(window_info);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_state_change(miral::WindowInfo const& window_info, MirWindowState state)
 try {
-    mir::log_info("%s window_info=%s, state=%s", __func__, dump_of(window_info).c_str(), dump_of(state).c_str());
+    record(*buffer, __func__, "%s window_info=%s, state=%s", window_info, state);
     policy->advise_state_change(window_info, state);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_move_to(miral::WindowInfo const& window_info, mir::geometry::Point top_left)
 try {
-    mir::log_info("%s window_info=%s, top_left=%s", __func__, dump_of(window_info).c_str(), dump_of(top_left).c_str());
+    record(*buffer, __func__, "%s window_info=%s, top_left=%s", window_info, top_left);
     policy->advise_move_to(window_info, top_left);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_resize(miral::WindowInfo const& window_info, mir::geometry::Size const& new_size)
 try {
-    mir::log_info("%s window_info=%s, new_size=%s", __func__, dump_of(window_info).c_str(), dump_of(new_size).c_str());
+    record(*buffer, __func__, "%s window_info=%s, new_size=%s", window_info, new_size);
     policy->advise_resize(window_info, new_size);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_delete_window(miral::WindowInfo const& window_info)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    record(*buffer, __func__, "%s window_info=%s", window_info);
     policy->advise_delete_window(window_info);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_raise(std::vector<miral::Window> const& windows)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(windows).c_str());
+    record(*buffer, __func__, "%s window_info=%s", windows);
     policy->advise_raise(windows);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::handle_request_drag_and_drop(miral::WindowInfo& window_info)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    record(*buffer, __func__, "%s window_info=%s", window_info);
     policy->handle_request_drag_and_drop(window_info);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::handle_request_move(miral::WindowInfo& window_info, MirInputEvent const* input_event)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    record(*buffer, __func__, "%s window_info=%s", window_info);
     policy->handle_request_move(window_info, input_event);
 }
 MIRAL_TRACE_EXCEPTION
@@ -854,7 +1062,7 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::handle_request_resize(
     miral::WindowInfo& window_info, MirInputEvent const* input_event, MirResizeEdge edge)
 try {
-    mir::log_info("%s window_info=%s, edge=0x%1x", __func__, dump_of(window_info).c_str(), edge);
+    record(*buffer, __func__, "%s window_info=%s, edge=%s", window_info, edge);
     policy->handle_request_resize(window_info, input_event, edge);
 }
 MIRAL_TRACE_EXCEPTION
@@ -862,7 +1070,7 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::advise_adding_to_workspace(
     std::shared_ptr<miral::Workspace> const& workspace, std::vector<miral::Window> const& windows)
 try {
-    mir::log_info("%s workspace=%p, windows=%s", __func__, static_cast<void*>(workspace.get()), dump_of(windows).c_str());
+    record(*buffer, __func__, "%s workspace=%s, windows=%s", workspace, windows);
     policy->advise_adding_to_workspace(workspace, windows);
 }
 MIRAL_TRACE_EXCEPTION
@@ -870,7 +1078,7 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::advise_removing_from_workspace(
     std::shared_ptr<miral::Workspace> const& workspace, std::vector<miral::Window> const& windows)
 try {
-    mir::log_info("%s workspace=%p, windows=%s", __func__, static_cast<void*>(workspace.get()), dump_of(windows).c_str());
+    record(*buffer, __func__, "%s workspace=%s, windows=%s", workspace, windows);
     policy->advise_removing_from_workspace(workspace, windows);
 }
 MIRAL_TRACE_EXCEPTION
@@ -882,50 +1090,49 @@ auto miral::WindowManagementTrace::confirm_placement_on_display(
     Rectangle const& new_placement) -> Rectangle
 try {
     auto const& result = policy->confirm_placement_on_display(window_info, new_state, new_placement);
-    mir::log_info("%s window_info=%s, new_state= %s, new_placement= %s -> %s", __func__,
-        dump_of(window_info).c_str(), dump_of(new_state).c_str(), dump_of(new_placement).c_str(), dump_of(result).c_str());
+    record(*buffer, __func__, "%s window_info=%s, new_state= %s, new_placement= %s -> %s", window_info, new_state, new_placement, result);
     return result;
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_output_create(Output const& output)
 try {
-    mir::log_info("%s output=%s", __func__, dump_of(output).c_str());
+    record(*buffer, __func__, "%s output=%s", output);
     return policy->advise_output_create(output);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_output_update(Output const& updated, Output const& original)
 try {
-    mir::log_info("%s updated=%s, original=%s", __func__, dump_of(updated).c_str(), dump_of(original).c_str());
+    record(*buffer, __func__, "%s updated=%s, original=%s", updated, original);
     return policy->advise_output_update(updated, original);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_output_delete(Output const& output)
 try {
-    mir::log_info("%s output=%s", __func__, dump_of(output).c_str());
+    record(*buffer, __func__, "%s output=%s", output);
     return policy->advise_output_delete(output);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_application_zone_create(Zone const& application_zone)
 try {
-    mir::log_info("%s application_zone=%s", __func__, dump_of(application_zone).c_str());
+    record(*buffer, __func__, "%s application_zone=%s", application_zone);
     return policy->advise_application_zone_create(application_zone);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_application_zone_update(Zone const& updated, Zone const& original)
 try {
-    mir::log_info("%s updated=%s, original=%s", __func__, dump_of(updated).c_str(), dump_of(original).c_str());
+    record(*buffer, __func__, "%s updated=%s, original=%s", updated, original);
     return policy->advise_application_zone_update(updated, original);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_application_zone_delete(Zone const& application_zone)
 try {
-    mir::log_info("%s application_zone=%s", __func__, dump_of(application_zone).c_str());
+    record(*buffer, __func__, "%s application_zone=%s", application_zone);
     return policy->advise_application_zone_delete(application_zone);
 }
 MIRAL_TRACE_EXCEPTION
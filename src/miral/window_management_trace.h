@@ -20,6 +20,7 @@
 #define MIRAL_WINDOW_MANAGEMENT_TRACE_H
 
 #include "window_manager_tools_implementation.h"
+#include "trace_buffer.h"
 
 #include "miral/window_manager_tools.h"
 #include "miral/window_management_options.h"
@@ -27,14 +28,25 @@
 
 #include <atomic>
 
+namespace mir { class Server; }
+
 namespace miral
 {
+/// Traces the calls between a policy and the window manager to a TraceBuffer.
+/// The trace is logged on SIGUSR2, and when a call throws.
 class WindowManagementTrace
     : public WindowManagementPolicy,
       WindowManagerToolsImplementation
 {
 public:
-    WindowManagementTrace(WindowManagerTools const& wrapped, WindowManagementPolicyBuilder const& builder);
+    WindowManagementTrace(
+        WindowManagerTools const& wrapped,
+        WindowManagementPolicyBuilder const& builder,
+        std::shared_ptr<TraceBuffer> const& buffer);
+
+    /// Builds the policy (from builder) wrapped in a trace, and arranges for the trace to be logged on SIGUSR2
+    static auto builder(mir::Server& server, WindowManagementPolicyBuilder const& builder)
+        -> WindowManagementPolicyBuilder;
 
 private:
     virtual auto count_applications() const -> unsigned int override;
@@ -78,6 +90,7 @@ private:
     virtual void modify_window(WindowInfo& window_info, WindowSpecification const& modifications) override;
 
     virtual void invoke_under_lock(std::function<void()> const& callback) override;
+    virtual void invoke_under_shared_lock(std::function<void()> const& callback) override;
 
     virtual auto place_new_window(
         ApplicationInfo const& app_info,
@@ -113,6 +126,13 @@ private:
     void for_each_window_in_workspace(
         std::shared_ptr<Workspace> const& workspace, std::function<void(Window const&)> const& callback) override;
 
+    void apply_atomically(std::function<void()> const& changes) override;
+
+    void take_thumbnail(
+        Window const& window,
+        mir::geometry::Size const& max_size,
+        WindowManagerTools::ThumbnailCallback const& callback) override;
+
     void handle_request_drag_and_drop(WindowInfo& window_info) override;
 
     void handle_request_move(WindowInfo& window_info, MirInputEvent const* input_event) override;
@@ -170,6 +190,7 @@ public:
 private:
     WindowManagerTools wrapped;
     std::unique_ptr<miral::WindowManagementPolicy> const policy;
+    std::shared_ptr<TraceBuffer> const buffer;
     std::atomic<unsigned> mutable trace_count;
     std::function<void()> log_input;
 };
@@ -108,6 +108,9 @@ auto miral::WindowManagerTools::id_for_window(Window const& window) const -> std
 void miral::WindowManagerTools::invoke_under_lock(std::function<void()> const& callback)
 { tools->invoke_under_lock(callback); }
 
+void miral::WindowManagerTools::invoke_under_shared_lock(std::function<void()> const& callback)
+{ tools->invoke_under_shared_lock(callback); }
+
 void miral::WindowManagerTools::place_and_size_for_state(
     WindowSpecification& modifications, WindowInfo const& window_info) const
 { tools->place_and_size_for_state(modifications, window_info); }
@@ -139,3 +142,10 @@ void miral::WindowManagerTools::for_each_window_in_workspace(
     std::shared_ptr<miral::Workspace> const& workspace,
     std::function<void(miral::Window const&)> const& callback)
 { tools->for_each_window_in_workspace(workspace, callback); }
+
+void miral::WindowManagerTools::apply_atomically(std::function<void()> const& changes)
+{ tools->apply_atomically(changes); }
+
+void miral::WindowManagerTools::take_thumbnail(
+    Window const& window, mir::geometry::Size const& max_size, ThumbnailCallback const& callback)
+{ tools->take_thumbnail(window, max_size, callback); }
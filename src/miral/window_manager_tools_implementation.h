@@ -20,6 +20,7 @@
 #define MIRAL_WINDOW_MANAGER_TOOLS_IMPLEMENTATION_H
 
 #include "miral/application.h"
+#include "miral/window_manager_tools.h"
 
 #include <mir/geometry/displacement.h>
 #include <mir/geometry/rectangle.h>
@@ -88,6 +89,11 @@ public:
     virtual void for_each_window_in_workspace(
         std::shared_ptr<Workspace> const& workspace,
         std::function<void(Window const& window)> const& callback) = 0;
+    virtual void apply_atomically(std::function<void()> const& changes) = 0;
+    virtual void take_thumbnail(
+        Window const& window,
+        mir::geometry::Size const& max_size,
+        WindowManagerTools::ThumbnailCallback const& callback) = 0;
 
 /** @} */
 
@@ -98,6 +104,7 @@ public:
  *  already holds the lock).
  *  @{ */
     virtual void invoke_under_lock(std::function<void()> const& callback) = 0;
+    virtual void invoke_under_shared_lock(std::function<void()> const& callback) = 0;
 /** @} */
 
     virtual ~WindowManagerToolsImplementation() = default;
@@ -73,6 +73,8 @@ struct miral::WindowSpecification::Self
     mir::optional_value<mir::optional_value<mir::geometry::Rectangle>> exclusive_rect;
     mir::optional_value<std::string> application_id;
     mir::optional_value<bool> server_side_decorated;
+    mir::optional_value<bool> tearing_allowed;
+    mir::optional_value<float> max_frame_rate;
     mir::optional_value<std::shared_ptr<void>> userdata;
 };
 
@@ -108,7 +110,9 @@ miral::WindowSpecification::Self::Self(mir::shell::SurfaceSpecification const& s
     attached_edges(spec.attached_edges),
     exclusive_rect(spec.exclusive_rect),
     application_id(spec.application_id),
-    server_side_decorated() // Not currently on SurfaceSpecification
+    server_side_decorated(), // Not currently on SurfaceSpecification
+    tearing_allowed(spec.tearing_allowed),
+    max_frame_rate(spec.max_frame_rate)
 {
     if (spec.aux_rect_placement_offset_x.is_set() && spec.aux_rect_placement_offset_y.is_set())
         aux_rect_placement_offset = Displacement{spec.aux_rect_placement_offset_x.value(), spec.aux_rect_placement_offset_y.value()};
@@ -665,6 +669,26 @@ auto miral::WindowSpecification::server_side_decorated() -> mir::optional_value<
     return self->server_side_decorated;
 }
 
+auto miral::WindowSpecification::tearing_allowed() const -> mir::optional_value<bool> const&
+{
+    return self->tearing_allowed;
+}
+
+auto miral::WindowSpecification::tearing_allowed() -> mir::optional_value<bool>&
+{
+    return self->tearing_allowed;
+}
+
+auto miral::WindowSpecification::max_frame_rate() const -> mir::optional_value<float> const&
+{
+    return self->max_frame_rate;
+}
+
+auto miral::WindowSpecification::max_frame_rate() -> mir::optional_value<float>&
+{
+    return self->max_frame_rate;
+}
+
 auto miral::WindowSpecification::userdata() -> mir::optional_value<std::shared_ptr<void>>&
 {
     return self->userdata;
@@ -25,6 +25,10 @@
 #include <stdlib.h>
 #include <string.h>
 #include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 /*
  * From libXcursor/include/X11/extensions/Xcursor.h
@@ -284,6 +288,20 @@ _XcursorReadUInt (XcursorFile *file, XcursorUInt *u)
     return XcursorTrue;
 }
 
+/*
+ * Whether the next len bytes are within the file, so that sizes read from a
+ * malformed file are caught before anything is allocated for them
+ */
+static XcursorBool
+_XcursorFileHasBytes (XcursorFile *file, long len)
+{
+    if ((*file->seek) (file, len, SEEK_CUR) == EOF)
+	return XcursorFalse;
+    if ((*file->seek) (file, -len, SEEK_CUR) == EOF)
+	return XcursorFalse;
+    return XcursorTrue;
+}
+
 static void
 _XcursorFileHeaderDestroy (XcursorFileHeader *fileHeader)
 {
@@ -329,10 +347,14 @@ _XcursorReadFileHeader (XcursorFile *file)
 	return NULL;
     if (!_XcursorReadUInt (file, &head.ntoc))
 	return NULL;
+    if (head.header < XCURSOR_FILE_HEADER_LEN)
+	return NULL;
     skip = head.header - XCURSOR_FILE_HEADER_LEN;
     if (skip)
 	if ((*file->seek) (file, skip, SEEK_CUR) == EOF)
 	    return NULL;
+    if (!_XcursorFileHasBytes (file, (long) head.ntoc * 3 * 4))
+	return NULL;
     fileHeader = _XcursorFileHeaderCreate (head.ntoc);
     if (!fileHeader)
 	return NULL;
@@ -485,6 +507,8 @@ _XcursorReadImage (XcursorFile		*file,
 	return NULL;
     if (head.xhot > head.width || head.yhot > head.height)
 	return NULL;
+    if (!_XcursorFileHasBytes (file, (long) head.width * head.height * 4))
+	return NULL;
 
     /* Create the image and initialize it */
     image = XcursorImageCreate (head.width, head.height);
@@ -599,6 +623,125 @@ XcursorFileLoadImages (FILE *file, int size)
     return XcursorXcFileLoadImages (&f, size);
 }
 
+/*
+ * Reads a cursor file with pread(), so that only the chunks for the size
+ * asked for are ever read. Nothing past the size the file had when it was
+ * opened is read, and a file truncated (or rewritten) under us just reads
+ * short; a mapping of it would fault instead.
+ */
+
+#define XCURSOR_FD_FILE_BUFFER_LEN 4096
+
+typedef struct _XcursorFdFile {
+    int			fd;
+    long		size;
+    long		position;
+    long		buffer_start;
+    int			buffer_len;
+    unsigned char	buffer[XCURSOR_FD_FILE_BUFFER_LEN];
+} XcursorFdFile;
+
+static int
+_XcursorFdFileRead (XcursorFile *file, unsigned char *buf, int len)
+{
+    XcursorFdFile	*f = file->closure;
+    long		available = f->size - f->position;
+    int			done = 0;
+
+    if (len > available)
+	len = available;
+    while (done < len)
+    {
+	long	offset = f->position - f->buffer_start;
+	int	chunk;
+
+	if (offset < 0 || offset >= f->buffer_len)
+	{
+	    ssize_t got = pread (f->fd, f->buffer, sizeof f->buffer, f->position);
+	    if (got < 0 && errno == EINTR)
+		continue;
+	    if (got <= 0)
+		break;
+	    f->buffer_start = f->position;
+	    f->buffer_len = got;
+	    offset = 0;
+	}
+	chunk = f->buffer_len - offset;
+	if (chunk > len - done)
+	    chunk = len - done;
+	memcpy (buf + done, f->buffer + offset, chunk);
+	done += chunk;
+	f->position += chunk;
+    }
+    return done;
+}
+
+static int
+_XcursorFdFileWrite (XcursorFile *file, unsigned char *buf, int len)
+{
+    (void) file; (void) buf; (void) len;
+    return 0;
+}
+
+static int
+_XcursorFdFileSeek (XcursorFile *file, long offset, int whence)
+{
+    XcursorFdFile	*f = file->closure;
+    long		position;
+
+    switch (whence)
+    {
+    case SEEK_SET: position = offset; break;
+    case SEEK_CUR: position = f->position + offset; break;
+    case SEEK_END: position = f->size + offset; break;
+    default: return EOF;
+    }
+    if (position < 0 || position > f->size)
+	return EOF;
+    f->position = position;
+    return 0;
+}
+
+static XcursorImages *
+XcursorFdFilenameLoadImages (const char *filename, int size)
+{
+    XcursorFdFile	*fd_file;
+    XcursorFile		f;
+    XcursorImages	*images;
+    struct stat		st;
+    int			fd;
+
+    fd = open (filename, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+	return NULL;
+    if (fstat (fd, &st) < 0 || !S_ISREG (st.st_mode) || st.st_size == 0)
+    {
+	close (fd);
+	return NULL;
+    }
+    fd_file = malloc (sizeof (XcursorFdFile));
+    if (!fd_file)
+    {
+	close (fd);
+	return NULL;
+    }
+
+    fd_file->fd = fd;
+    fd_file->size = st.st_size;
+    fd_file->position = 0;
+    fd_file->buffer_start = 0;
+    fd_file->buffer_len = 0;
+    f.closure = fd_file;
+    f.read = _XcursorFdFileRead;
+    f.write = _XcursorFdFileWrite;
+    f.seek = _XcursorFdFileSeek;
+    images = XcursorXcFileLoadImages (&f, size);
+
+    free (fd_file);
+    close (fd);
+    return images;
+}
+
 /*
  * From libXcursor/src/library.c
  */
@@ -897,3 +1040,91 @@ xcursor_load_theme(const char *theme, int size,
 	if (inherits)
 		free(inherits);
 }
+
+/** Load the images of a single cursor file
+ *
+ * Only the images of the nominal size nearest to size are decoded. A file
+ * that is malformed, or that is truncated while it is read, loads nothing.
+ * The caller is expected to destroy the result with XcursorImagesDestroy().
+ *
+ * \param filename The path of the cursor file
+ * \param size The desired size of the cursor images
+ * \return The cursor images, or NULL if the file can't be loaded
+ */
+XcursorImages *
+xcursor_load_file(const char *filename, int size)
+{
+	return XcursorFdFilenameLoadImages(filename, size);
+}
+
+/* Guards against themes that (directly or indirectly) inherit themselves */
+#define XCURSOR_MAX_INHERIT_DEPTH 16
+
+static XcursorImages *
+xcursor_load_cursor_depth(const char *theme, const char *name, int size,
+			  int depth)
+{
+	char *full, *dir;
+	char *inherits = NULL;
+	const char *path, *i;
+	XcursorImages *images = NULL;
+
+	if (!theme)
+		theme = "default";
+
+	if (!name || strchr(name, '/') || depth > XCURSOR_MAX_INHERIT_DEPTH)
+		return NULL;
+
+	for (path = XcursorLibraryPath();
+	     path && !images;
+	     path = _XcursorNextPath(path)) {
+		dir = _XcursorBuildThemeDir(path, theme);
+		if (!dir)
+			continue;
+
+		full = _XcursorBuildFullname(dir, "cursors", name);
+		if (full) {
+			images = XcursorFdFilenameLoadImages(full, size);
+			free(full);
+		}
+
+		if (!images && !inherits) {
+			full = _XcursorBuildFullname(dir, "", "index.theme");
+			if (full) {
+				inherits = _XcursorThemeInherits(full);
+				free(full);
+			}
+		}
+
+		free(dir);
+	}
+
+	for (i = inherits; i && !images; i = _XcursorNextPath(i))
+		images = xcursor_load_cursor_depth(i, name, size, depth + 1);
+
+	if (inherits)
+		free(inherits);
+
+	if (images)
+		XcursorImagesSetName(images, name);
+
+	return images;
+}
+
+/** Load a single cursor of a theme
+ *
+ * This looks for the named cursor in the given theme and then in the
+ * themes it inherits from, returning the first found. Only the images
+ * of the nominal size nearest to size are decoded. The caller is expected
+ * to destroy the result with XcursorImagesDestroy().
+ *
+ * \param theme The name of theme to look in
+ * \param name The name of the cursor
+ * \param size The desired size of the cursor images
+ * \return The cursor images, or NULL if the theme has no such cursor
+ */
+XcursorImages *
+xcursor_load_cursor(const char *theme, const char *name, int size)
+{
+	return xcursor_load_cursor_depth(theme, name, size, 0);
+}
@@ -55,6 +55,12 @@ typedef struct _XcursorImages {
 void
 XcursorImagesDestroy (XcursorImages *images);
 
+XcursorImages *
+xcursor_load_file(const char *filename, int size);
+
+XcursorImages *
+xcursor_load_cursor(const char *theme, const char *name, int size);
+
 void
 xcursor_load_theme(const char *theme, int size,
 		    void (*load_callback)(XcursorImages *, void *),
@@ -20,10 +20,7 @@
 
 #include <mir/graphics/cursor_image.h>
 
-#include <boost/throw_exception.hpp>
-#include <stdexcept>
-
-#include <string.h>
+#include <algorithm>
 
 #include <mir_toolkit/cursors.h>
 
@@ -142,74 +139,62 @@ xcursor_name_for_mir_cursor(std::string const& mir_cursor_name)
 }
 }
 
-miral::XCursorLoader::XCursorLoader()
+miral::XCursorLoader::XCursorLoader() :
+    XCursorLoader{"default"}
 {
-    load_cursor_theme("default");
 }
 
-miral::XCursorLoader::XCursorLoader(std::string const& theme)
+miral::XCursorLoader::XCursorLoader(std::string const& theme) :
+    theme{theme}
 {
-    load_cursor_theme(theme);
 }
 
-// Each XcursorImages represents images for the different sizes of a given symbolic cursor.
-void miral::XCursorLoader::load_appropriately_sized_image(_XcursorImages *images)
+auto miral::XCursorLoader::image_locked(std::string const& xcursor_name, uint32_t nominal_size)
+    -> std::shared_ptr<mg::CursorImage>
 {
-    // We would rather take this lock in load_cursor_theme but the Xcursor lib style
-    // makes it difficult to use our standard 'pass the lg around to _locked members' pattern
-    std::lock_guard<std::mutex> lg(guard);
+    auto const key = std::make_pair(xcursor_name, nominal_size);
+
+    auto const cached = loaded_images.find(key);
+    if (cached != loaded_images.end())
+        return cached->second;
 
-    // We have to save all the images as XCursor expects us to free them.
-    // This contains the actual image data though, so we need to ensure they stay alive
-    // with the lifetime of the mg::CursorImage instance which refers to them.
-    auto saved_xcursor_library_resource = std::shared_ptr<_XcursorImages>(images, [](_XcursorImages *images)
-        {
-            XcursorImagesDestroy(images);
-        });
+    // Only the images nearest the nominal size are decoded, and only their chunks of the file are read
+    auto const images = xcursor_load_cursor(theme.c_str(), xcursor_name.c_str(), nominal_size);
 
-    for (int i = 0; i < images->nimage; i++)
+    std::shared_ptr<mg::CursorImage> result;
+    if (images && images->nimage > 0)
     {
-        _XcursorImage *candidate = images->images[i];
-        if (candidate->width == mi::default_cursor_size.width.as_uint32_t() &&
-            candidate->height == mi::default_cursor_size.height.as_uint32_t())
-        {
-            loaded_images[std::string(images->name)] = std::make_shared<XCursorImage>(candidate, saved_xcursor_library_resource);
-            return;
-        }
-    }
+        // The image data belongs to the XcursorImages, so we need to ensure they stay alive
+        // with the lifetime of the mg::CursorImage instance which refers to them.
+        std::shared_ptr<_XcursorImages> const saved_xcursor_library_resource{images, &XcursorImagesDestroy};
 
-    loaded_images[std::string(images->name)] = std::make_shared<XCursorImage>(images->images[0], saved_xcursor_library_resource);
-}
+        // Animated cursors have several images of the same nominal size, we only use the first
+        result = std::make_shared<XCursorImage>(images->images[0], saved_xcursor_library_resource);
+    }
+    else if (images)
+    {
+        XcursorImagesDestroy(images);
+    }
 
-void miral::XCursorLoader::load_cursor_theme(std::string const& theme_name)
-{
-    // Cursors are named by their square dimension...called the nominal size in XCursor terminology, so we just look up by width.
-    // Later we verify the actual size.
-    xcursor_load_theme(theme_name.c_str(), mi::default_cursor_size.width.as_uint32_t(),
-        [](XcursorImages* images, void *this_ptr)  -> void
-        {
-            // Can't use lambda capture as this lambda is thunked to a C function ptr
-            auto p = static_cast<miral::XCursorLoader*>(this_ptr);
-            p->load_appropriately_sized_image(images);
-        }, this);
+    loaded_images[key] = result;
+    return result;
 }
 
 std::shared_ptr<mg::CursorImage> miral::XCursorLoader::image(
     std::string const& cursor_name,
-    geom::Size const& /*size*/)
+    geom::Size const& size)
 {
-    auto xcursor_name = xcursor_name_for_mir_cursor(cursor_name);
+    auto const xcursor_name = xcursor_name_for_mir_cursor(cursor_name);
+
+    // Cursors are named by their square dimension...called the nominal size in XCursor terminology
+    auto const requested_size = std::max(size.width.as_uint32_t(), size.height.as_uint32_t());
+    auto const nominal_size = requested_size ? requested_size : mi::default_cursor_size.width.as_uint32_t();
 
     std::lock_guard<std::mutex> lg(guard);
 
-    auto it = loaded_images.find(xcursor_name);
-    if (it != loaded_images.end())
-        return it->second;
+    if (auto const image = image_locked(xcursor_name, nominal_size))
+        return image;
 
     // Fall back
-    it = loaded_images.find("arrow");
-    if (it != loaded_images.end())
-        return it->second;
-
-    return nullptr;
+    return image_locked("arrow", nominal_size);
 }
@@ -26,12 +26,7 @@
 #include <string>
 #include <map>
 #include <mutex>
-
-// Unfortunately this library does not compile as C++ so we can not namespace it.
-extern "C"
-{
-struct _XcursorImages;
-}
+#include <utility>
 
 namespace mir { namespace graphics { class CursorImage; } }
 
@@ -53,12 +48,16 @@ protected:
     XCursorLoader& operator=(XCursorLoader const&) = delete;
 
 private:
+    std::string const theme;
+
     std::mutex guard;
 
-    std::map<std::string, std::shared_ptr<mir::graphics::CursorImage>> loaded_images;
+    /// Cursors are loaded the first time they are asked for, keyed by xcursor name and nominal size.
+    /// Cursors the theme lacks are remembered (as null) so that we don't search for them again.
+    std::map<std::pair<std::string, uint32_t>, std::shared_ptr<mir::graphics::CursorImage>> loaded_images;
 
-    void load_cursor_theme(std::string const& theme_name);
-    void load_appropriately_sized_image(_XcursorImages *images);
+    auto image_locked(std::string const& xcursor_name, uint32_t nominal_size)
+        -> std::shared_ptr<mir::graphics::CursorImage>;
 };
 }
 
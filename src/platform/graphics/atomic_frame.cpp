@@ -38,6 +38,7 @@ void AtomicFrame::increment_now()
     std::lock_guard<decltype(mutex)> lock(mutex);
     frame.ust = Frame::Timestamp::now(frame.ust.clock_id);
     frame.msc++;
+    frame.hardware = false;
 }
 
 void AtomicFrame::increment_with_timestamp(Frame::Timestamp t)
@@ -45,6 +46,7 @@ void AtomicFrame::increment_with_timestamp(Frame::Timestamp t)
     std::lock_guard<decltype(mutex)> lock(mutex);
     frame.ust = t;
     frame.msc++;
+    frame.hardware = false;
 }
 
 }} // namespace mir::graphics
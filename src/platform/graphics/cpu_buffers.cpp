@@ -184,10 +184,8 @@ auto mrs::as_read_mappable_buffer(
     BOOST_THROW_EXCEPTION((std::runtime_error{"Buffer does not support CPU access"}));
 }
 
-namespace
-{
-auto as_write_mappable_buffer(
-    std::shared_ptr<mg::Buffer> const& buffer) -> std::shared_ptr<mrs::WriteMappableBuffer>
+auto mrs::as_write_mappable_buffer(
+    std::shared_ptr<mg::Buffer> const& buffer) -> std::shared_ptr<WriteMappableBuffer>
 {
     class CopyingWrapper : public mrs::WriteMappableBuffer
     {
@@ -265,7 +263,6 @@ auto as_write_mappable_buffer(
 
     BOOST_THROW_EXCEPTION((std::runtime_error{"Buffer does not support CPU access"}));
 }
-}
 
 auto mrs::alloc_buffer_with_content(
     mg::GraphicBufferAllocator& allocator,
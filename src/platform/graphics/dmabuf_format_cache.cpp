@@ -0,0 +1,157 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "dmabuf_format_cache.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace mg = mir::graphics;
+
+namespace
+{
+char const format_cache_magic[] = "mir-dmabuf-formats-1";
+
+auto path_in(std::string const& directory, std::string const& identity) -> std::string
+{
+    char name[17];
+    snprintf(name, sizeof name, "%016zx", std::hash<std::string>{}(identity));
+    return directory + "/dmabuf-formats-" + name;
+}
+}
+
+mg::DmaBufFormatCache::DmaBufFormatCache(std::string const& directory, std::string driver_identity)
+    : identity{std::move(driver_identity)},
+      path_{path_in(directory, identity)}
+{
+}
+
+auto mg::DmaBufFormatCache::default_directory() -> std::string
+{
+    if (getenv("MIR_DMABUF_DISABLE_FORMAT_CACHE"))
+        return {};
+
+    if (auto const cache_home = getenv("XDG_CACHE_HOME"); cache_home && *cache_home)
+        return std::string{cache_home} + "/mir";
+    if (auto const home = getenv("HOME"); home && *home)
+        return std::string{home} + "/.cache/mir";
+    return {};
+}
+
+auto mg::DmaBufFormatCache::load() const -> std::optional<DmaBufFormatTable>
+{
+    std::ifstream in{path_, std::ios::binary};
+    if (!in)
+        return std::nullopt;
+
+    auto const read = [&in](auto& value) { in.read(reinterpret_cast<char*>(&value), sizeof value); };
+    auto const read_string = [&in, &read](std::string& value)
+        {
+            uint32_t size{0};
+            read(size);
+            if (!in || size > (1u << 20))
+                return false;
+            value.resize(size);
+            in.read(value.data(), size);
+            return bool(in);
+        };
+
+    std::string magic, cached_identity;
+    if (!read_string(magic) || magic != format_cache_magic ||
+        !read_string(cached_identity) || cached_identity != identity)
+    {
+        return std::nullopt;
+    }
+
+    uint32_t count{0};
+    read(count);
+    if (!in || count < 1 || count > (1u << 16))
+        return std::nullopt;
+
+    DmaBufFormatTable table;
+    table.formats.resize(count);
+    table.modifiers_for_format.resize(count);
+    table.external_only_for_format.resize(count);
+    for (auto i = 0u; i < count; ++i)
+    {
+        uint32_t num_modifiers{0};
+        read(table.formats[i]);
+        read(num_modifiers);
+        if (!in || num_modifiers > (1u << 16))
+            return std::nullopt;
+
+        auto& modifiers = table.modifiers_for_format[i];
+        auto& external_only = table.external_only_for_format[i];
+        modifiers.resize(num_modifiers);
+        external_only.resize(num_modifiers);
+        in.read(reinterpret_cast<char*>(modifiers.data()), num_modifiers * sizeof(EGLuint64KHR));
+        in.read(reinterpret_cast<char*>(external_only.data()), num_modifiers * sizeof(EGLBoolean));
+    }
+    if (!in)
+        return std::nullopt;
+
+    return table;
+}
+
+auto mg::DmaBufFormatCache::store(DmaBufFormatTable const& table) const -> bool
+{
+    auto const dir = path_.substr(0, path_.rfind('/'));
+    mkdir(dir.substr(0, dir.rfind('/')).c_str(), 0700);
+    mkdir(dir.c_str(), 0700);
+
+    // Written aside and renamed into place, so a server starting alongside never reads half a cache
+    auto const temporary = path_ + ".tmp-" + std::to_string(getpid());
+    {
+        std::ofstream out{temporary, std::ios::binary | std::ios::trunc};
+        auto const write = [&out](auto const& value)
+            {
+                out.write(reinterpret_cast<char const*>(&value), sizeof value);
+            };
+        auto const write_string = [&out, &write](std::string const& value)
+            {
+                write(static_cast<uint32_t>(value.size()));
+                out.write(value.data(), value.size());
+            };
+
+        write_string(format_cache_magic);
+        write_string(identity);
+        write(static_cast<uint32_t>(table.formats.size()));
+        for (auto i = 0u; i < table.formats.size(); ++i)
+        {
+            auto const& modifiers = table.modifiers_for_format[i];
+            auto const& external_only = table.external_only_for_format[i];
+            write(table.formats[i]);
+            write(static_cast<uint32_t>(modifiers.size()));
+            out.write(reinterpret_cast<char const*>(modifiers.data()), modifiers.size() * sizeof(EGLuint64KHR));
+            out.write(reinterpret_cast<char const*>(external_only.data()), external_only.size() * sizeof(EGLBoolean));
+        }
+
+        if (out.flush())
+        {
+            out.close();
+            if (rename(temporary.c_str(), path_.c_str()) == 0)
+                return true;
+        }
+    }
+    unlink(temporary.c_str());
+    return false;
+}
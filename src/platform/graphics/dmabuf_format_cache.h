@@ -0,0 +1,73 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_DMABUF_FORMAT_CACHE_H_
+#define MIR_GRAPHICS_DMABUF_FORMAT_CACHE_H_
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace mir
+{
+namespace graphics
+{
+/// The dma-buf formats a driver imports, with each one's modifiers and whether each is external-only
+struct DmaBufFormatTable
+{
+    std::vector<EGLint> formats;
+    std::vector<std::vector<EGLuint64KHR>> modifiers_for_format;
+    std::vector<std::vector<EGLBoolean>> external_only_for_format;
+};
+
+/**
+ * Keeps the dma-buf formats of a driver on disk, so a later run needn't query EGL for them.
+ *
+ * Each driver has a file of its own, named for a hash of its identity. The full identity is
+ * stored too, and compared on load, so a hash collision is just a miss. A missing, stale or
+ * corrupt cache loads nothing.
+ */
+class DmaBufFormatCache
+{
+public:
+    /**
+     * \param [in] directory        Where to keep the cache; created when first needed
+     * \param [in] driver_identity  What distinguishes this driver (and version of it) from others
+     */
+    DmaBufFormatCache(std::string const& directory, std::string driver_identity);
+
+    /// $XDG_CACHE_HOME/mir (or under $HOME/.cache), or "" if neither is set or MIR_DMABUF_DISABLE_FORMAT_CACHE is
+    static auto default_directory() -> std::string;
+
+    /// \return  nullopt if there's no usable cache for this driver
+    auto load() const -> std::optional<DmaBufFormatTable>;
+
+    /// \return  false if the table couldn't be cached
+    auto store(DmaBufFormatTable const& table) const -> bool;
+
+    auto path() const -> std::string const& { return path_; }
+
+private:
+    std::string const identity;
+    std::string const path_;
+};
+}
+}
+
+#endif // MIR_GRAPHICS_DMABUF_FORMAT_CACHE_H_
@@ -18,9 +18,12 @@
  */
 
 #include "mir/graphics/egl_extensions.h"
+#include "mir/graphics/dmabuf_buffer.h"
 #include <boost/throw_exception.hpp>
+#include <array>
 #include <stdexcept>
 #include <cstring>
+#include <vector>
 
 #define MIR_LOG_COMPONENT "EGL extensions"
 #include "mir/log.h"
@@ -207,3 +210,192 @@ mg::EGLExtensions::EXTImageDmaBufImportModifiers::EXTImageDmaBufImportModifiers(
             std::runtime_error{"EGL_EXT_image_dma_buf_import_modifiers not supported"}));
     }
 }
+
+namespace
+{
+auto swap_buffers_with_damage_proc(EGLDisplay dpy) -> PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC
+{
+    auto const egl_extensions = eglQueryString(dpy, EGL_EXTENSIONS);
+    if (!egl_extensions)
+        return nullptr;
+
+    if (strstr(egl_extensions, "EGL_KHR_swap_buffers_with_damage"))
+    {
+        return reinterpret_cast<PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC>(
+            eglGetProcAddress("eglSwapBuffersWithDamageKHR"));
+    }
+
+    // The EXT entrypoint differs only in the constness of rects
+    if (strstr(egl_extensions, "EGL_EXT_swap_buffers_with_damage"))
+    {
+        return reinterpret_cast<PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC>(
+            eglGetProcAddress("eglSwapBuffersWithDamageEXT"));
+    }
+
+    return nullptr;
+}
+}
+
+mg::EGLExtensions::SwapBuffersWithDamage::SwapBuffersWithDamage(EGLDisplay dpy)
+    : eglSwapBuffersWithDamage{swap_buffers_with_damage_proc(dpy)}
+{
+    if (!eglSwapBuffersWithDamage)
+    {
+        BOOST_THROW_EXCEPTION((std::runtime_error{"EGL display doesn't support swapping buffers with damage"}));
+    }
+}
+
+auto mg::EGLExtensions::SwapBuffersWithDamage::maybe_swap_buffers_with_damage(EGLDisplay dpy)
+    -> std::optional<SwapBuffersWithDamage>
+{
+    try
+    {
+        return mg::EGLExtensions::SwapBuffersWithDamage{dpy};
+    }
+    catch (std::runtime_error const&)
+    {
+        return {};
+    }
+}
+
+auto mg::EGLExtensions::SwapBuffersWithDamage::operator()(
+    EGLDisplay dpy,
+    EGLSurface surface,
+    geometry::Rectangles const& damage) const -> EGLBoolean
+{
+    EGLint surface_height{0};
+    if (!eglQuerySurface(dpy, surface, EGL_HEIGHT, &surface_height))
+        return eglSwapBuffers(dpy, surface);
+
+    // EGL wants {x, y, width, height} with the origin at the bottom-left
+    std::vector<EGLint> rects;
+    rects.reserve(4 * damage.size());
+    for (auto const& rect : damage)
+    {
+        rects.push_back(rect.left().as_int());
+        rects.push_back(surface_height - rect.bottom().as_int());
+        rects.push_back(rect.size.width.as_int());
+        rects.push_back(rect.size.height.as_int());
+    }
+
+    return eglSwapBuffersWithDamage(dpy, surface, rects.data(), static_cast<EGLint>(damage.size()));
+}
+
+mg::EGLExtensions::WaylandBufferFromImage::WaylandBufferFromImage(EGLDisplay dpy) :
+    eglCreateImageKHR{
+        reinterpret_cast<PFNEGLCREATEIMAGEKHRPROC>(eglGetProcAddress("eglCreateImageKHR"))},
+    eglDestroyImageKHR{
+        reinterpret_cast<PFNEGLDESTROYIMAGEKHRPROC>(eglGetProcAddress("eglDestroyImageKHR"))},
+    eglCreateWaylandBufferFromImageWL{
+        reinterpret_cast<CreateWaylandBufferFromImageProc>(eglGetProcAddress("eglCreateWaylandBufferFromImageWL"))}
+{
+    auto const egl_extensions = eglQueryString(dpy, EGL_EXTENSIONS);
+    if (!egl_extensions ||
+        !strstr(egl_extensions, "EGL_WL_create_wayland_buffer_from_image") ||
+        !strstr(egl_extensions, "EGL_EXT_image_dma_buf_import"))
+    {
+        BOOST_THROW_EXCEPTION((
+            std::runtime_error{"EGL display doesn't support creating wl_buffers from dma-bufs"}));
+    }
+
+    if (!eglCreateImageKHR || !eglDestroyImageKHR || !eglCreateWaylandBufferFromImageWL)
+    {
+        BOOST_THROW_EXCEPTION((std::runtime_error{"EGL_WL_create_wayland_buffer_from_image functions are null"}));
+    }
+}
+
+auto mg::EGLExtensions::WaylandBufferFromImage::maybe_wayland_buffer_from_image(EGLDisplay dpy)
+    -> std::optional<WaylandBufferFromImage>
+{
+    try
+    {
+        return mg::EGLExtensions::WaylandBufferFromImage{dpy};
+    }
+    catch (std::runtime_error const&)
+    {
+        return {};
+    }
+}
+
+namespace
+{
+struct EGLPlaneAttribs
+{
+    EGLint fd;
+    EGLint offset;
+    EGLint pitch;
+    EGLint modifier_lo;
+    EGLint modifier_hi;
+};
+
+std::array<EGLPlaneAttribs, 4> const egl_plane_attribs = {{
+    {
+        EGL_DMA_BUF_PLANE0_FD_EXT,
+        EGL_DMA_BUF_PLANE0_OFFSET_EXT,
+        EGL_DMA_BUF_PLANE0_PITCH_EXT,
+        EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT,
+        EGL_DMA_BUF_PLANE0_MODIFIER_HI_EXT
+    },
+    {
+        EGL_DMA_BUF_PLANE1_FD_EXT,
+        EGL_DMA_BUF_PLANE1_OFFSET_EXT,
+        EGL_DMA_BUF_PLANE1_PITCH_EXT,
+        EGL_DMA_BUF_PLANE1_MODIFIER_LO_EXT,
+        EGL_DMA_BUF_PLANE1_MODIFIER_HI_EXT
+    },
+    {
+        EGL_DMA_BUF_PLANE2_FD_EXT,
+        EGL_DMA_BUF_PLANE2_OFFSET_EXT,
+        EGL_DMA_BUF_PLANE2_PITCH_EXT,
+        EGL_DMA_BUF_PLANE2_MODIFIER_LO_EXT,
+        EGL_DMA_BUF_PLANE2_MODIFIER_HI_EXT
+    },
+    {
+        EGL_DMA_BUF_PLANE3_FD_EXT,
+        EGL_DMA_BUF_PLANE3_OFFSET_EXT,
+        EGL_DMA_BUF_PLANE3_PITCH_EXT,
+        EGL_DMA_BUF_PLANE3_MODIFIER_LO_EXT,
+        EGL_DMA_BUF_PLANE3_MODIFIER_HI_EXT
+    }
+}};
+}
+
+auto mg::EGLExtensions::WaylandBufferFromImage::operator()(
+    EGLDisplay dpy,
+    DMABufBuffer const& buffer) const -> struct wl_buffer*
+{
+    auto const& planes = buffer.planes();
+    if (planes.size() > egl_plane_attribs.size())
+        return nullptr;
+
+    std::vector<EGLint> attribs{
+        EGL_WIDTH, buffer.size().width.as_int(),
+        EGL_HEIGHT, buffer.size().height.as_int(),
+        EGL_LINUX_DRM_FOURCC_EXT, static_cast<EGLint>(buffer.drm_fourcc())};
+
+    for (auto i = 0u; i != planes.size(); ++i)
+    {
+        auto const& names = egl_plane_attribs[i];
+        attribs.insert(attribs.end(), {
+            names.fd, static_cast<int>(planes[i].dma_buf),
+            names.offset, static_cast<EGLint>(planes[i].offset),
+            names.pitch, static_cast<EGLint>(planes[i].stride)});
+
+        if (auto const modifier = buffer.modifier())
+        {
+            attribs.insert(attribs.end(), {
+                names.modifier_lo, static_cast<EGLint>(*modifier & 0xFFFFFFFF),
+                names.modifier_hi, static_cast<EGLint>(*modifier >> 32)});
+        }
+    }
+    attribs.push_back(EGL_NONE);
+
+    auto const image = eglCreateImageKHR(dpy, EGL_NO_CONTEXT, EGL_LINUX_DMA_BUF_EXT, nullptr, attribs.data());
+    if (image == EGL_NO_IMAGE_KHR)
+        return nullptr;
+
+    // The wl_buffer holds its own reference to the underlying storage
+    auto const result = eglCreateWaylandBufferFromImageWL(dpy, image);
+    eglDestroyImageKHR(dpy, image);
+    return result;
+}
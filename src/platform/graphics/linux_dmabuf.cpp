@@ -21,6 +21,7 @@
 
 
 #include "wayland_wrapper.h"
+#include "dmabuf_format_cache.h"
 #include "mir/graphics/egl_extensions.h"
 #include "mir/graphics/egl_error.h"
 #include "mir/renderer/gl/context.h"
@@ -30,6 +31,10 @@
 #include "mir/graphics/buffer_basic.h"
 #include "mir/graphics/dmabuf_buffer.h"
 #include "mir/executor.h"
+#include "mir/anonymous_shm_file.h"
+#include "mir/fd.h"
+#include "mir/thread_name.h"
+#include "mir/memory_account.h"
 
 #define MIR_LOG_COMPONENT "linux-dmabuf-import"
 #include "mir/log.h"
@@ -38,10 +43,20 @@
 #include <EGL/egl.h>
 #include <EGL/eglext.h>
 
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
 #include <mutex>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 #include <optional>
 #include <drm_fourcc.h>
+#include <fcntl.h>
+#include <link.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <wayland-server.h>
 
 namespace mg = mir::graphics;
@@ -190,6 +205,42 @@ constexpr auto drm_modifier_to_string(uint64_t modifier) -> char const*
 #undef STRINGIFY
 }
 
+auto main_device_of(EGLDisplay dpy) -> std::optional<dev_t>;
+
+/**
+ * What distinguishes the driver EGL on \a dpy uses from others, for caching its dma-buf formats
+ *
+ * That's what EGL says of itself, the device it renders on and every library loaded into the
+ * process (which includes the driver), so upgrading or switching driver misses the cache.
+ */
+auto driver_identity(EGLDisplay dpy) -> std::string
+{
+    std::string identity;
+    for (auto const name : {EGL_VENDOR, EGL_VERSION, EGL_EXTENSIONS})
+    {
+        auto const value = eglQueryString(dpy, name);
+        identity += value ? value : "";
+        identity += '\n';
+    }
+    if (auto const device = main_device_of(dpy))
+        identity += "device " + std::to_string(*device) + '\n';
+
+    dl_iterate_phdr(
+        [](dl_phdr_info* info, size_t, void* data)
+        {
+            struct stat library;
+            if (info->dlpi_name && *info->dlpi_name && stat(info->dlpi_name, &library) == 0)
+            {
+                *static_cast<std::string*>(data) +=
+                    std::string{info->dlpi_name} + ' ' + std::to_string(library.st_size) + ' ' +
+                    std::to_string(library.st_mtim.tv_sec) + '.' + std::to_string(library.st_mtim.tv_nsec) + '\n';
+            }
+            return 0;
+        },
+        &identity);
+
+    return identity;
+}
 }
 
 class mg::DmaBufFormatDescriptors
@@ -198,6 +249,87 @@ public:
     DmaBufFormatDescriptors(
         EGLDisplay dpy,
         mg::EGLExtensions::EXTImageDmaBufImportModifiers const& dmabuf_ext)
+    {
+        std::optional<mg::DmaBufFormatCache> cache;
+        if (auto const directory = mg::DmaBufFormatCache::default_directory(); !directory.empty())
+            cache.emplace(directory, driver_identity(dpy));
+
+        if (auto cached = cache ? cache->load() : std::nullopt)
+        {
+            mir::log_debug("Using the dma-buf formats cached in %s", cache->path().c_str());
+            formats = std::move(cached->formats);
+            modifiers_for_format = std::move(cached->modifiers_for_format);
+            external_only_for_format = std::move(cached->external_only_for_format);
+        }
+        else
+        {
+            query(dpy, dmabuf_ext);
+
+            // Caching is only an optimisation, so failing to is logged rather than thrown
+            if (cache && !cache->store({formats, modifiers_for_format, external_only_for_format}))
+                mir::log_info("Failed to cache dma-buf formats in %s", cache->path().c_str());
+        }
+
+        for (auto i = 0u; i < formats.size(); ++i)
+        {
+            for (auto const modifier : modifiers_for_format[i])
+            {
+                modifier_events_.push_back(
+                    {static_cast<uint32_t>(formats[i]),
+                     static_cast<uint32_t>(modifier >> 32),
+                     static_cast<uint32_t>(modifier & 0xFFFFFFFF)});
+            }
+        }
+    }
+
+    struct FormatDescriptor
+    {
+        EGLint format;
+        std::vector<EGLuint64KHR> const& modifiers;
+        std::vector<EGLBoolean> const& external_only;
+    };
+
+    /// The modifier events clients binding at version 3 are sent, built once rather than on every bind
+    struct ModifierEvent
+    {
+        uint32_t format;
+        uint32_t modifier_hi;
+        uint32_t modifier_lo;
+    };
+
+    auto num_formats() const -> size_t
+    {
+        return formats.size();
+    }
+
+    auto format_events() const -> std::vector<EGLint> const&
+    {
+        return formats;
+    }
+
+    auto modifier_events() const -> std::vector<ModifierEvent> const&
+    {
+        return modifier_events_;
+    }
+
+    auto operator[](size_t idx) const -> FormatDescriptor
+    {
+        if (idx >= formats.size())
+        {
+            BOOST_THROW_EXCEPTION((std::out_of_range{
+                std::string("Index ") + std::to_string(idx) + " out of bounds (num formats: " +
+                std::to_string(formats.size()) + ")"}));
+        }
+
+        return FormatDescriptor{
+            formats[idx],
+            modifiers_for_format[idx],
+            external_only_for_format[idx]};
+    }
+
+
+private:
+    void query(EGLDisplay dpy, mg::EGLExtensions::EXTImageDmaBufImportModifiers const& dmabuf_ext)
     {
         EGLint num_formats;
         if (dmabuf_ext.eglQueryDmaBufFormatsExt(dpy, 0, nullptr, &num_formats) != EGL_TRUE)
@@ -280,35 +412,6 @@ public:
         }
     }
 
-    struct FormatDescriptor
-    {
-        EGLint format;
-        std::vector<EGLuint64KHR> const& modifiers;
-        std::vector<EGLBoolean> const& external_only;
-    };
-
-    auto num_formats() const -> size_t
-    {
-        return formats.size();
-    }
-
-    auto operator[](size_t idx) const -> FormatDescriptor
-    {
-        if (idx >= formats.size())
-        {
-            BOOST_THROW_EXCEPTION((std::out_of_range{
-                std::string("Index ") + std::to_string(idx) + " out of bounds (num formats: " +
-                std::to_string(formats.size()) + ")"}));
-        }
-
-        return FormatDescriptor{
-            formats[idx],
-            modifiers_for_format[idx],
-            external_only_for_format[idx]};
-    }
-
-
-private:
     void resize(size_t size)
     {
         formats.resize(size);
@@ -334,6 +437,7 @@ private:
     std::vector<EGLint> formats;
     std::vector<std::vector<EGLuint64KHR>> modifiers_for_format;
     std::vector<std::vector<EGLBoolean>> external_only_for_format;
+    std::vector<ModifierEvent> modifier_events_;
 };
 
 namespace
@@ -369,6 +473,136 @@ BufferGLDescription const ExternalOES = {
     "}\n"
 };
 
+/**
+ * A GL texture bound to a dmabuf's EGLImage
+ *
+ * Shared between the WlDmaBufBuffer it was imported from and every Mir buffer
+ * created for it, so the texture outlives whichever of them is released last.
+ */
+class DmabufTexture
+{
+public:
+    DmabufTexture(
+        std::shared_ptr<mir::renderer::gl::Context> ctx,
+        std::shared_ptr<mir::Executor> wayland_executor)
+        : ctx{std::move(ctx)},
+          wayland_executor{std::move(wayland_executor)}
+    {
+        glGenTextures(1, &tex);
+    }
+
+    ~DmabufTexture()
+    {
+        wayland_executor->spawn(
+            [context = ctx, tex = tex]()
+            {
+              context->make_current();
+
+              glDeleteTextures(1, &tex);
+
+              context->release_current();
+            });
+    }
+
+    DmabufTexture(DmabufTexture const&) = delete;
+    DmabufTexture& operator=(DmabufTexture const&) = delete;
+
+    auto id() const -> GLuint
+    {
+        return tex;
+    }
+
+    auto context() const -> std::shared_ptr<mir::renderer::gl::Context> const&
+    {
+        return ctx;
+    }
+
+private:
+    std::shared_ptr<mir::renderer::gl::Context> const ctx;
+    std::shared_ptr<mir::Executor> const wayland_executor;
+    GLuint tex;
+};
+
+/**
+ * Imports dmabufs into EGL off the Wayland thread
+ *
+ * Creating the EGLImage for a large multi-planar buffer can take a while, and every
+ * other client's requests would wait behind it. Imports are done in the order they
+ * are requested.
+ */
+class DmabufImporter : public mir::Executor
+{
+public:
+    DmabufImporter()
+        : worker{[this]() { run(); }}
+    {
+    }
+
+    ~DmabufImporter()
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            shutdown = true;
+        }
+        work_available.notify_all();
+        worker.join();
+    }
+
+    void spawn(std::function<void()>&& work) override
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            queue.push_back(std::move(work));
+        }
+        work_available.notify_one();
+    }
+
+private:
+    void run()
+    {
+        mir::set_thread_name("Mir/dmabuf import");
+
+        std::unique_lock<std::mutex> lock{mutex};
+        for (;;)
+        {
+            work_available.wait(lock, [this]() { return shutdown || !queue.empty(); });
+            if (shutdown)
+            {
+                // Nothing is waiting on unfinished imports once we're shut down
+                return;
+            }
+
+            auto work = std::move(queue.front());
+            queue.pop_front();
+
+            lock.unlock();
+            work();
+            // Destroy anything the work captured outside the lock
+            work = nullptr;
+            lock.lock();
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable work_available;
+    std::deque<std::function<void()>> queue;
+    bool shutdown{false};
+    std::thread worker;
+};
+
+mir::MemoryAccount dmabuf_buffers{"buffers", "dmabuf"};
+
+/// What the dmabufs of a buffer come to, assuming (as is usual) each plane is full height
+auto plane_bytes(std::vector<PlaneInfo> const& planes, int32_t height) -> size_t
+{
+    size_t bytes{0};
+    for (auto const& plane : planes)
+    {
+        bytes += static_cast<size_t>(plane.stride) * height;
+    }
+    return bytes;
+}
+
 /**
  * Holds on to all imported dmabuf buffers, and allows looking up by wl_buffer
  *
@@ -387,7 +621,8 @@ public:
         uint32_t format,
         uint32_t flags,
         uint64_t modifier,
-        std::vector<PlaneInfo> plane_params)
+        std::vector<PlaneInfo> plane_params,
+        EGLImageKHR imported_image = EGL_NO_IMAGE_KHR)
             : Buffer(wl_buffer, Version<1>{}),
               dpy{dpy},
               egl_extensions{std::move(egl_extensions)},
@@ -398,9 +633,13 @@ public:
               flags{flags},
               modifier_{modifier},
               planes_{std::move(plane_params)},
-              image{EGL_NO_IMAGE_KHR}
+              image{imported_image},
+              charge{dmabuf_buffers, plane_bytes(planes_, height)}
     {
-        reimport_egl_image();
+        if (image == EGL_NO_IMAGE_KHR)
+        {
+            reimport_egl_image();
+        }
     }
 
     ~WlDmaBufBuffer()
@@ -443,15 +682,75 @@ public:
         return desc;
     }
     /**
-     * Reimport dmabufs into EGL
+     * The GL texture of the imported dmabufs, in the given context
      *
-     * This is necessary to call each time the buffer is re-submitted by the client,
-     * to ensure any state is properly synchronised.
+     * The wl_buffer's dmabufs, format and modifier are fixed at creation, so the
+     * EGLImage and its texture are kept across commits rather than reimported each
+     * time the client cycles back to this buffer; implicit dmabuf fencing keeps the
+     * contents synchronised.
+     *
+     * \note   Must be called with \a ctx current
+     * \throws A std::system_error containing the EGL error on failure.
+     */
+    auto texture(
+        mg::EGLExtensions const& extensions,
+        std::shared_ptr<mir::renderer::gl::Context> const& ctx,
+        std::shared_ptr<mir::Executor> const& wayland_executor) -> std::shared_ptr<DmabufTexture>
+    {
+        if (cached_texture && cached_texture->context() == ctx)
+        {
+            return cached_texture;
+        }
+
+        eglBindAPI(EGL_OPENGL_ES_API);
+
+        auto imported = std::make_shared<DmabufTexture>(ctx, wayland_executor);
+
+        auto const target = desc.target;
+        glBindTexture(target, imported->id());
+        extensions.base(dpy).glEGLImageTargetTexture2DOES(target, image);
+
+        glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        cached_texture = imported;
+        return imported;
+    }
+
+    /**
+     * Import dmabufs into EGL, replacing any previously imported EGLImage
      *
      * \return  An EGLImageKHR handle to the imported
      * \throws  A std::system_error containing the EGL error on failure.
      */
     auto reimport_egl_image() -> EGLImageKHR
+    {
+        auto const new_image = import_egl_image(dpy, *egl_extensions, width, height, format_, modifier_, planes_);
+        if (image != EGL_NO_IMAGE_KHR)
+        {
+            egl_extensions->base(dpy).eglDestroyImageKHR(dpy, image);
+        }
+        image = new_image;
+        return image;
+    }
+
+    /**
+     * Import dmabufs into a new EGLImage
+     *
+     * This doesn't need a current context, so may be called on any thread.
+     *
+     * \throws  A std::system_error containing the EGL error on failure.
+     */
+    static auto import_egl_image(
+        EGLDisplay dpy,
+        mg::EGLExtensions const& egl_extensions,
+        int32_t width,
+        int32_t height,
+        uint32_t format,
+        uint64_t modifier,
+        std::vector<PlaneInfo> const& planes) -> EGLImageKHR
     {
         std::vector<EGLint> attributes;
 
@@ -460,12 +759,12 @@ public:
         attributes.push_back(EGL_HEIGHT);
         attributes.push_back(height);
         attributes.push_back(EGL_LINUX_DRM_FOURCC_EXT);
-        attributes.push_back(format());
+        attributes.push_back(format);
 
-        for(auto i = 0u; i < planes_.size(); ++i)
+        for(auto i = 0u; i < planes.size(); ++i)
         {
             auto const& attrib_names = egl_attribs[i];
-            auto const& plane = planes()[i];
+            auto const& plane = planes[i];
 
             attributes.push_back(attrib_names.fd);
             attributes.push_back(static_cast<int>(plane.dma_buf));
@@ -473,20 +772,16 @@ public:
             attributes.push_back(plane.offset);
             attributes.push_back(attrib_names.pitch);
             attributes.push_back(plane.stride);
-            if (modifier() != DRM_FORMAT_MOD_INVALID)
+            if (modifier != DRM_FORMAT_MOD_INVALID)
             {
                 attributes.push_back(attrib_names.modifier_lo);
-                attributes.push_back(modifier() & 0xFFFFFFFF);
+                attributes.push_back(modifier & 0xFFFFFFFF);
                 attributes.push_back(attrib_names.modifier_hi);
-                attributes.push_back(modifier() >> 32);
+                attributes.push_back(modifier >> 32);
             }
         }
         attributes.push_back(EGL_NONE);
-        if (image != EGL_NO_IMAGE_KHR)
-        {
-            egl_extensions->base(dpy).eglDestroyImageKHR(dpy, image);
-        }
-        image = egl_extensions->base(dpy).eglCreateImageKHR(
+        auto const image = egl_extensions.base(dpy).eglCreateImageKHR(
             dpy,
             EGL_NO_CONTEXT,
             EGL_LINUX_DMA_BUF_EXT,
@@ -495,7 +790,7 @@ public:
 
         if (image == EGL_NO_IMAGE_KHR)
         {
-            auto const msg = planes_.size() > 1 ?
+            auto const msg = planes.size() > 1 ?
                 "Failed to import supplied dmabufs" :
                 "Failed to import supplied dmabuf";
             BOOST_THROW_EXCEPTION((mg::egl_error(msg)));
@@ -528,6 +823,8 @@ private:
     uint64_t const modifier_;
     std::vector<PlaneInfo> const planes_;
     EGLImageKHR image;
+    std::shared_ptr<DmabufTexture> cached_texture;
+    mir::MemoryCharge const charge;
 
     struct EGLPlaneAttribs
     {
@@ -576,12 +873,16 @@ public:
         wl_resource* new_resource,
         EGLDisplay dpy,
         std::shared_ptr<mg::EGLExtensions> egl_extensions,
-        std::shared_ptr<mg::DmaBufFormatDescriptors const> formats)
-        : mir::wayland::LinuxBufferParamsV1(new_resource, Version<3>{}),
+        std::shared_ptr<mg::DmaBufFormatDescriptors const> formats,
+        std::shared_ptr<mir::Executor> importer,
+        std::shared_ptr<mir::Executor> wayland_executor)
+        : mir::wayland::LinuxBufferParamsV1(new_resource, Version<4>{}),
           consumed{false},
           dpy{dpy},
           egl_extensions{std::move(egl_extensions)},
-          formats{std::move(formats)}
+          formats{std::move(formats)},
+          importer{std::move(importer)},
+          wayland_executor{std::move(wayland_executor)}
     {
     }
 
@@ -595,6 +896,19 @@ private:
     EGLDisplay dpy;
     std::shared_ptr<mg::EGLExtensions> egl_extensions;
     std::shared_ptr<mg::DmaBufFormatDescriptors const> const formats;
+    std::shared_ptr<mir::Executor> const importer;
+    std::shared_ptr<mir::Executor> const wayland_executor;
+
+    /// A buffer being created by the asynchronous create request
+    struct PendingBuffer
+    {
+        BufferGLDescription const& desc;
+        int32_t const width, height;
+        uint32_t const format, flags;
+        uint64_t const modifier;
+        std::vector<PlaneInfo> const planes;
+        EGLImageKHR image{EGL_NO_IMAGE_KHR}; ///< Set by the importer if it succeeds
+    };
 
     void destroy() override
     {
@@ -764,42 +1078,87 @@ private:
     {
         validate_params(width, height, format, flags);
 
-        try
-        {
-            auto const buffer_resource = wl_resource_create(client, &wl_buffer_interface, 1, 0);
-            if (!buffer_resource)
+        auto const last_valid_plane = validate_and_count_planes();
+        auto const pending = std::make_shared<PendingBuffer>(PendingBuffer{
+            descriptor_for_format_and_modifiers(format),
+            width,
+            height,
+            format,
+            flags,
+            modifier.value(),
+            {planes.cbegin(), last_valid_plane}});
+        consumed = true;
+
+        // The result of this request is sent as an event, so the import can happen off the Wayland thread
+        importer->spawn(
+            [pending, dpy = dpy, egl_extensions = egl_extensions, wayland_executor = wayland_executor,
+             params = mw::make_weak(this)]()
             {
-                wl_client_post_no_memory(client);
-                return;
-            }
+                try
+                {
+                    pending->image = WlDmaBufBuffer::import_egl_image(
+                        dpy,
+                        *egl_extensions,
+                        pending->width,
+                        pending->height,
+                        pending->format,
+                        pending->modifier,
+                        pending->planes);
+                }
+                catch (std::exception const& err)
+                {
+                    /* The client should handle this fine, but let's make sure we can see
+                     * any failures that might happen.
+                     */
+                    mir::log_debug("Failed to import client dmabufs: %s", err.what());
+                }
 
-            auto const last_valid_plane = validate_and_count_planes();
-            new WlDmaBufBuffer{
-                dpy,
-                egl_extensions,
-                descriptor_for_format_and_modifiers(format),
-                buffer_resource,
-                width,
-                height,
-                format,
-                flags,
-                modifier.value(),
-                {planes.cbegin(), last_valid_plane}};
-            send_created_event(buffer_resource);
-        }
-        catch (std::system_error const& err)
+                wayland_executor->spawn(
+                    [pending, dpy, egl_extensions, params]()
+                    {
+                        if (params)
+                        {
+                            params.value().complete_create(*pending);
+                        }
+                        else if (pending->image != EGL_NO_IMAGE_KHR)
+                        {
+                            // The client has lost interest
+                            egl_extensions->base(dpy).eglDestroyImageKHR(dpy, pending->image);
+                        }
+                    });
+            });
+    }
+
+    /// Called on the Wayland thread once the importer is done with \a pending
+    void complete_create(PendingBuffer const& pending)
+    {
+        if (pending.image == EGL_NO_IMAGE_KHR)
         {
-            if (err.code().category() != mg::egl_category())
-            {
-                throw;
-            }
-            /* The client should handle this fine, but let's make sure we can see
-             * any failures that might happen.
-             */
-            mir::log_debug("Failed to import client dmabufs: %s", err.what());
             send_failed_event();
+            return;
         }
-        consumed = true;
+
+        auto const buffer_resource = wl_resource_create(client, &wl_buffer_interface, 1, 0);
+        if (!buffer_resource)
+        {
+            egl_extensions->base(dpy).eglDestroyImageKHR(dpy, pending.image);
+            wl_client_post_no_memory(client);
+            return;
+        }
+
+        new WlDmaBufBuffer{
+            dpy,
+            egl_extensions,
+            pending.desc,
+            buffer_resource,
+            pending.width,
+            pending.height,
+            pending.format,
+            pending.flags,
+            pending.modifier,
+            pending.planes,
+            pending.image};
+        send_created_event(buffer_resource);
     }
 
     void
@@ -851,13 +1210,6 @@ private:
     }
 };
 
-GLuint get_tex_id()
-{
-    GLuint tex;
-    glGenTextures(1, &tex);
-    return tex;
-}
-
 bool drm_format_has_alpha(uint32_t format)
 {
     /* TODO: We should really have something like libweston/pixel-formats.h
@@ -894,13 +1246,12 @@ public:
     WaylandDmabufTexBuffer(
         WlDmaBufBuffer& source,
         mg::EGLExtensions const& extensions,
-        std::shared_ptr<mir::renderer::gl::Context> ctx,
-        EGLDisplay dpy,
+        std::shared_ptr<mir::renderer::gl::Context> const& ctx,
         std::function<void()>&& on_consumed,
         std::function<void()>&& on_release,
-        std::shared_ptr<mir::Executor> wayland_executor)
-        : ctx{std::move(ctx)},
-          tex{get_tex_id()},
+        std::shared_ptr<mir::Executor> const& wayland_executor)
+        : texture{source.texture(extensions, ctx, wayland_executor)},
+          tex{texture->id()},
           desc{source.descriptor()},
           on_consumed{std::move(on_consumed)},
           on_release{std::move(on_release)},
@@ -909,36 +1260,12 @@ public:
           has_alpha{drm_format_has_alpha(source.format())},
           planes_{source.planes()},
           modifier_{source.modifier()},
-          fourcc{source.format()},
-          wayland_executor{std::move(wayland_executor)}
+          fourcc{source.format()}
     {
-        eglBindAPI(EGL_OPENGL_ES_API);
-
-        auto const target = source.descriptor().target;
-
-        glBindTexture(target, tex);
-        extensions.base(dpy).glEGLImageTargetTexture2DOES(target, source.reimport_egl_image());
-        // tex is now an EGLImage sibling, so we can free the EGLImage without
-        // freeing the backing data.
-
-        glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     }
 
     ~WaylandDmabufTexBuffer() override
     {
-        wayland_executor->spawn(
-            [context = ctx, tex = tex]()
-            {
-              context->make_current();
-
-              glDeleteTextures(1, &tex);
-
-              context->release_current();
-            });
-
         on_release();
     }
 
@@ -1016,7 +1343,7 @@ public:
     }
 
 private:
-    std::shared_ptr<mir::renderer::gl::Context> const ctx;
+    std::shared_ptr<DmabufTexture> const texture;
     GLuint const tex;
     BufferGLDescription const& desc;
 
@@ -1031,11 +1358,391 @@ private:
     std::vector<mg::DMABufBuffer::PlaneDescriptor> const planes_;
     std::optional<uint64_t> const modifier_;
     uint32_t const fourcc;
+};
 
-    std::shared_ptr<mir::Executor> const wayland_executor;
+
+
+#ifndef EGL_DRM_RENDER_NODE_FILE_EXT
+#define EGL_DRM_RENDER_NODE_FILE_EXT 0x3377
+#endif
+
+/**
+ * The DRM device \a dpy renders on, by its render node if EGL knows it
+ *
+ * \return  nullopt if EGL can't say (without EGL_EXT_device_query, say)
+ */
+auto main_device_of(EGLDisplay dpy) -> std::optional<dev_t>
+{
+    auto const client_extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (!client_extensions ||
+        (!strstr(client_extensions, "EGL_EXT_device_query") && !strstr(client_extensions, "EGL_EXT_device_base")))
+    {
+        return std::nullopt;
+    }
+
+    auto const query_display_attrib =
+        reinterpret_cast<PFNEGLQUERYDISPLAYATTRIBEXTPROC>(eglGetProcAddress("eglQueryDisplayAttribEXT"));
+    auto const query_device_string =
+        reinterpret_cast<PFNEGLQUERYDEVICESTRINGEXTPROC>(eglGetProcAddress("eglQueryDeviceStringEXT"));
+    EGLAttrib attrib;
+    if (!query_display_attrib || !query_device_string ||
+        query_display_attrib(dpy, EGL_DEVICE_EXT, &attrib) != EGL_TRUE)
+    {
+        return std::nullopt;
+    }
+
+    auto const device = reinterpret_cast<EGLDeviceEXT>(attrib);
+    auto const device_extensions = query_device_string(device, EGL_EXTENSIONS);
+    if (!device_extensions)
+        return std::nullopt;
+
+    char const* path{nullptr};
+    if (strstr(device_extensions, "EGL_EXT_device_drm_render_node"))
+        path = query_device_string(device, EGL_DRM_RENDER_NODE_FILE_EXT);
+    if (!path && strstr(device_extensions, "EGL_EXT_device_drm"))
+        path = query_device_string(device, EGL_DRM_DEVICE_FILE_EXT);
+
+    struct stat info;
+    if (!path || stat(path, &info) != 0)
+        return std::nullopt;
+
+    return info.st_rdev;
+}
+
+/// A wl_array holding \a values, for the events that send one
+template<typename T>
+class WlArray
+{
+public:
+    explicit WlArray(std::vector<T> const& values)
+    {
+        wl_array_init(&array);
+        auto const size = values.size() * sizeof(T);
+        if (auto const data = wl_array_add(&array, size))
+            memcpy(data, values.data(), size);
+    }
+
+    ~WlArray()
+    {
+        wl_array_release(&array);
+    }
+
+    WlArray(WlArray const&) = delete;
+    WlArray& operator=(WlArray const&) = delete;
+
+    operator wl_array*()
+    {
+        return &array;
+    }
+
+private:
+    wl_array array;
+};
+
+/**
+ * Every format and modifier pair clients can import, laid out in shared memory as
+ * linux-dmabuf feedback expects; tranches refer to pairs by their index here
+ */
+class FormatTable
+{
+public:
+    explicit FormatTable(mg::DmaBufFormatDescriptors const& formats)
+    {
+        bool truncated{false};
+        for (auto i = 0u; i < formats.num_formats(); ++i)
+        {
+            auto const [format, modifiers, external_only] = formats[i];
+            for (auto const modifier : modifiers)
+            {
+                if (entries.size() < max_entries)
+                    entries.push_back({static_cast<uint32_t>(format), 0, modifier});
+                else
+                    truncated = true;
+            }
+        }
+        if (truncated)
+        {
+            mir::log_warning(
+                "More than %zu dma-buf format/modifier pairs; feedback will leave the rest out",
+                max_entries);
+        }
+
+        mir::AnonymousShmFile::Options options;
+        options.sealable = true;
+        file = std::make_unique<mir::AnonymousShmFile>(size(), options);
+        memcpy(file->base_ptr(), entries.data(), size());
+        sealed = file->seal();
+    }
+
+    auto size() const -> uint32_t
+    {
+        return entries.size() * sizeof(Entry);
+    }
+
+    /// A descriptor of the table no client can change what the others see through
+    auto fd() const -> mir::Fd
+    {
+        if (sealed)
+            return mir::Fd{mir::IntOwnedFd{file->fd()}};
+
+        auto const path = "/proc/self/fd/" + std::to_string(file->fd());
+        mir::Fd read_only{open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+        if (read_only >= 0)
+            return read_only;
+
+        // The shared file is writable, so a client that can't have it read-only gets a copy of its own
+        mir::AnonymousShmFile copy{size()};
+        memcpy(copy.base_ptr(), entries.data(), size());
+        return mir::Fd{dup(copy.fd())};
+    }
+
+    auto all_indices() const -> std::vector<uint16_t>
+    {
+        std::vector<uint16_t> indices(entries.size());
+        for (auto i = 0u; i < entries.size(); ++i)
+            indices[i] = i;
+        return indices;
+    }
+
+    /// The indices of the pairs whose modifier is one of modifiers_for(their format)
+    auto indices_of(std::function<std::vector<uint64_t>(uint32_t format)> const& modifiers_for) const
+        -> std::vector<uint16_t>
+    {
+        std::vector<uint16_t> indices;
+        std::optional<uint32_t> format;
+        std::vector<uint64_t> modifiers;
+        for (auto i = 0u; i < entries.size(); ++i)
+        {
+            // Pairs are grouped by format, so this asks once per format
+            if (entries[i].format != format)
+            {
+                format = entries[i].format;
+                modifiers = modifiers_for(entries[i].format);
+            }
+            if (std::find(modifiers.begin(), modifiers.end(), entries[i].modifier) != modifiers.end())
+                indices.push_back(i);
+        }
+        return indices;
+    }
+
+private:
+    struct Entry
+    {
+        uint32_t format;
+        uint32_t padding;
+        uint64_t modifier;
+    };
+    static_assert(sizeof(Entry) == 16, "linux-dmabuf format table entries are 16 bytes");
+
+    /// Tranches index the table with 16 bits
+    static constexpr size_t max_entries{65536};
+
+    std::vector<Entry> entries;
+    std::unique_ptr<mir::AnonymousShmFile> file;
+    /// Whether the file itself is read-only, or each client needs a read-only descriptor of it
+    bool sealed{false};
+};
+}
+
+class mg::LinuxDmaBufUnstable::Feedback : public mir::wayland::LinuxDmabufFeedbackV1
+{
+public:
+    Feedback(wl_resource* new_resource, std::shared_ptr<Feedbacks> const& feedbacks, wl_resource* surface);
+    ~Feedback();
+
+    /// Null for default feedback, or once the surface has gone
+    wl_resource* surface;
+
+private:
+    void destroy() override
+    {
+        destroy_wayland_object();
+    }
+
+    std::shared_ptr<Feedbacks> const feedbacks;
 };
 
+/**
+ * The parameters every feedback object sends, and those surface feedback adds
+ *
+ * Default feedback offers the same tranche for as long as it lives, so only surface
+ * feedback is tracked.
+ */
+class mg::LinuxDmaBufUnstable::Feedbacks : public std::enable_shared_from_this<Feedbacks>
+{
+public:
+    /// Preferred over the defaults, for scanout
+    struct Tranche
+    {
+        dev_t device;
+        std::vector<uint16_t> indices;
 
+        auto operator==(Tranche const& other) const -> bool
+        {
+            return device == other.device && indices == other.indices;
+        }
+    };
+
+    Feedbacks(DmaBufFormatDescriptors const& formats, std::optional<dev_t> main_device)
+        : table{formats},
+          all_indices{table.all_indices()},
+          main_device{main_device}
+    {
+        if (!main_device)
+        {
+            mir::log_info("Can't tell which DRM device EGL renders on; dma-buf feedback won't offer tranches");
+        }
+    }
+
+    auto indices_of(std::function<std::vector<uint64_t>(uint32_t format)> const& modifiers_for) const
+        -> std::vector<uint16_t>
+    {
+        return table.indices_of(modifiers_for);
+    }
+
+    void add(Feedback& feedback)
+    {
+        if (!feedback.surface)
+        {
+            send(feedback, std::nullopt);
+            return;
+        }
+
+        auto& entry = track(feedback.surface);
+        entry.feedbacks.push_back(&feedback);
+        send(feedback, entry.scanout);
+    }
+
+    void remove(Feedback& feedback)
+    {
+        auto const entry = surfaces.find(feedback.surface);
+        if (!feedback.surface || entry == surfaces.end())
+            return;
+
+        auto& list = entry->second.feedbacks;
+        list.erase(std::remove(list.begin(), list.end(), &feedback), list.end());
+        forget_if_unused(entry);
+    }
+
+    void set_scanout(wl_resource* surface, std::optional<Tranche> tranche)
+    {
+        if (tranche && tranche->indices.empty())
+            tranche = std::nullopt;
+
+        auto entry = surfaces.find(surface);
+        if (entry == surfaces.end())
+        {
+            if (!tranche)
+                return;
+            track(surface);
+            entry = surfaces.find(surface);
+        }
+
+        if (entry->second.scanout == tranche)
+            return;
+
+        entry->second.scanout = std::move(tranche);
+        for (auto const feedback : entry->second.feedbacks)
+            send(*feedback, entry->second.scanout);
+        forget_if_unused(entry);
+    }
+
+private:
+    struct Surface
+    {
+        std::vector<Feedback*> feedbacks;
+        std::optional<Tranche> scanout;
+        mw::DestroyListenerId destroy_listener;
+    };
+
+    auto track(wl_resource* surface) -> Surface&
+    {
+        auto const existing = surfaces.find(surface);
+        if (existing != surfaces.end())
+            return existing->second;
+
+        auto& entry = surfaces[surface];
+        if (auto const wayland_surface = mw::Surface::from(surface))
+        {
+            entry.destroy_listener = wayland_surface->add_destroy_listener(
+                [weak_self = weak_from_this(), surface]()
+                {
+                    if (auto const self = weak_self.lock())
+                        self->surface_destroyed(surface);
+                });
+        }
+        return entry;
+    }
+
+    void surface_destroyed(wl_resource* surface)
+    {
+        auto const entry = surfaces.find(surface);
+        if (entry == surfaces.end())
+            return;
+
+        // The protocol leaves the surface's feedback objects inert
+        for (auto const feedback : entry->second.feedbacks)
+            feedback->surface = nullptr;
+        surfaces.erase(entry);
+    }
+
+    void forget_if_unused(std::unordered_map<wl_resource*, Surface>::iterator entry)
+    {
+        if (!entry->second.feedbacks.empty() || entry->second.scanout)
+            return;
+
+        if (auto const wayland_surface = mw::Surface::from(entry->first))
+            wayland_surface->remove_destroy_listener(entry->second.destroy_listener);
+        surfaces.erase(entry);
+    }
+
+    void send(Feedback& feedback, std::optional<Tranche> const& scanout) const
+    {
+        feedback.send_format_table_event(table.fd(), table.size());
+        if (main_device)
+        {
+            feedback.send_main_device_event(WlArray<dev_t>{{*main_device}});
+            if (scanout)
+            {
+                send_tranche(feedback, scanout->device, scanout->indices, Feedback::TrancheFlags::scanout);
+            }
+            send_tranche(feedback, *main_device, all_indices, 0);
+        }
+        feedback.send_done_event();
+    }
+
+    static void send_tranche(
+        Feedback& feedback,
+        dev_t device,
+        std::vector<uint16_t> const& indices,
+        uint32_t flags)
+    {
+        feedback.send_tranche_target_device_event(WlArray<dev_t>{{device}});
+        feedback.send_tranche_flags_event(flags);
+        feedback.send_tranche_formats_event(WlArray<uint16_t>{indices});
+        feedback.send_tranche_done_event();
+    }
+
+    FormatTable const table;
+    std::vector<uint16_t> const all_indices;
+    std::optional<dev_t> const main_device;
+    std::unordered_map<wl_resource*, Surface> surfaces;
+};
+
+mg::LinuxDmaBufUnstable::Feedback::Feedback(
+    wl_resource* new_resource,
+    std::shared_ptr<Feedbacks> const& feedbacks,
+    wl_resource* surface)
+    : mir::wayland::LinuxDmabufFeedbackV1(new_resource, Version<4>{}),
+      surface{surface},
+      feedbacks{feedbacks}
+{
+    this->feedbacks->add(*this);
+}
+
+mg::LinuxDmaBufUnstable::Feedback::~Feedback()
+{
+    feedbacks->remove(*this);
 }
 
 class mg::LinuxDmaBufUnstable::Instance : public mir::wayland::LinuxDmabufV1
@@ -1045,28 +1752,29 @@ public:
         wl_resource* new_resource,
         EGLDisplay dpy,
         std::shared_ptr<EGLExtensions> egl_extensions,
-        std::shared_ptr<DmaBufFormatDescriptors const> formats)
-        : mir::wayland::LinuxDmabufV1(new_resource, Version<3>{}),
+        std::shared_ptr<DmaBufFormatDescriptors const> formats,
+        std::shared_ptr<Feedbacks> feedbacks,
+        std::shared_ptr<Executor> importer,
+        std::shared_ptr<Executor> wayland_executor)
+        : mir::wayland::LinuxDmabufV1(new_resource, Version<4>{}),
           dpy{dpy},
           egl_extensions{std::move(egl_extensions)},
-          formats{std::move(formats)}
+          formats{std::move(formats)},
+          feedbacks{std::move(feedbacks)},
+          importer{std::move(importer)},
+          wayland_executor{std::move(wayland_executor)}
     {
-        for (auto i = 0u; i < this->formats->num_formats(); ++i)
-        {
-            auto [format, modifiers, external_only] = (*(this->formats))[i];
+        // From version 4 clients get formats from feedback instead
+        if (wl_resource_get_version(resource) >= 4)
+            return;
 
+        for (auto const format : this->formats->format_events())
             send_format_event(format);
-            if (version_supports_modifier())
-            {
-                for (auto j = 0u; j < modifiers.size(); ++j)
-                {
-                    auto const modifier = modifiers[j];
-                    send_modifier_event(
-                        format,
-                        modifier >> 32,
-                        modifier & 0xFFFFFFFF);
-                }
-            }
+
+        if (version_supports_modifier())
+        {
+            for (auto const& event : this->formats->modifier_events())
+                send_modifier_event(event.format, event.modifier_hi, event.modifier_lo);
         }
     }
 private:
@@ -1077,23 +1785,40 @@ private:
 
     void create_params(struct wl_resource* params_id) override
     {
-        new LinuxDmaBufParams{params_id, dpy, egl_extensions, formats};
+        new LinuxDmaBufParams{params_id, dpy, egl_extensions, formats, importer, wayland_executor};
+    }
+
+    void get_default_feedback(struct wl_resource* id) override
+    {
+        new Feedback{id, feedbacks, nullptr};
+    }
+
+    void get_surface_feedback(struct wl_resource* id, struct wl_resource* surface) override
+    {
+        new Feedback{id, feedbacks, surface};
     }
 
     EGLDisplay const dpy;
     std::shared_ptr<EGLExtensions> const egl_extensions;
     std::shared_ptr<DmaBufFormatDescriptors const> const formats;
+    std::shared_ptr<Feedbacks> const feedbacks;
+    std::shared_ptr<Executor> const importer;
+    std::shared_ptr<Executor> const wayland_executor;
 };
 
 mg::LinuxDmaBufUnstable::LinuxDmaBufUnstable(
     wl_display* display,
     EGLDisplay dpy,
     std::shared_ptr<EGLExtensions> egl_extensions,
-    EGLExtensions::EXTImageDmaBufImportModifiers const& dmabuf_ext)
-    : mir::wayland::LinuxDmabufV1::Global(display, Version<3>{}),
+    EGLExtensions::EXTImageDmaBufImportModifiers const& dmabuf_ext,
+    std::shared_ptr<Executor> wayland_executor)
+    : mir::wayland::LinuxDmabufV1::Global(display, Version<4>{}),
       dpy{dpy},
       egl_extensions{std::move(egl_extensions)},
-      formats{std::make_shared<DmaBufFormatDescriptors>(dpy, dmabuf_ext)}
+      formats{std::make_shared<DmaBufFormatDescriptors>(dpy, dmabuf_ext)},
+      feedbacks{std::make_shared<Feedbacks>(*formats, main_device_of(dpy))},
+      importer{std::make_shared<DmabufImporter>()},
+      wayland_executor{std::move(wayland_executor)}
 {
 }
 
@@ -1110,16 +1835,29 @@ auto mg::LinuxDmaBufUnstable::buffer_from_resource(
         return std::make_shared<WaylandDmabufTexBuffer>(
             *dmabuf,
             *egl_extensions,
-            std::move(ctx),
-            dpy,
+            ctx,
             std::move(on_consumed),
             std::move(on_release),
-            std::move(wayland_executor));
+            wayland_executor);
     }
     return nullptr;
 }
 
+void mg::LinuxDmaBufUnstable::set_scanout_tranche(
+    wl_resource* surface,
+    std::experimental::optional<ScanoutTranche> const& tranche)
+{
+    if (tranche)
+    {
+        feedbacks->set_scanout(surface, Feedbacks::Tranche{tranche->device, feedbacks->indices_of(tranche->modifiers)});
+    }
+    else
+    {
+        feedbacks->set_scanout(surface, std::nullopt);
+    }
+}
+
 void mg::LinuxDmaBufUnstable::bind(wl_resource* new_resource)
 {
-    new LinuxDmaBufUnstable::Instance{new_resource, dpy, egl_extensions, formats};
+    new LinuxDmaBufUnstable::Instance{new_resource, dpy, egl_extensions, formats, feedbacks, importer, wayland_executor};
 }
@@ -0,0 +1,562 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/graphics/wayland_shm.h"
+
+#include "wayland_wrapper.h"
+#include "mir/fd.h"
+#include "mir/log.h"
+#include "mir/memory_account.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <atomic>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace mg = mir::graphics;
+namespace mw = mir::wayland;
+namespace geom = mir::geometry;
+
+namespace
+{
+/// How much a client has mapped through wl_shm, shared by all of the client's wl_shm objects
+class ClientShmUsage
+{
+public:
+    ClientShmUsage(size_t limit)
+        : limit{limit}
+    {
+    }
+
+    /// Returns false (and charges nothing) if this would take the client over its limit
+    auto try_charge(size_t bytes) -> bool
+    {
+        auto const total = mapped_.fetch_add(bytes) + bytes;
+        if (limit && total > limit)
+        {
+            mapped_.fetch_sub(bytes);
+            return false;
+        }
+        return true;
+    }
+
+    void release(size_t bytes)
+    {
+        mapped_.fetch_sub(bytes);
+    }
+
+    auto mapped() const -> size_t { return mapped_; }
+
+    size_t const limit; ///< 0 means no limit
+
+private:
+    std::atomic<size_t> mapped_{0};
+};
+
+struct ClientShmUsageCtx
+{
+    wl_listener destroy_listener;
+    std::shared_ptr<ClientShmUsage> usage;
+};
+
+static_assert(
+    std::is_standard_layout<ClientShmUsageCtx>::value,
+    "ClientShmUsageCtx must be standard layout for wl_container_of to be defined behaviour");
+
+void cleanup_client_shm_usage(wl_listener* listener, void*)
+{
+    ClientShmUsageCtx* ctx;
+    ctx = wl_container_of(listener, ctx, destroy_listener);
+    wl_list_remove(&ctx->destroy_listener.link);
+    delete ctx;
+}
+
+auto usage_for_client(wl_client* client, size_t limit) -> std::shared_ptr<ClientShmUsage>
+{
+    if (auto const listener = wl_client_get_destroy_listener(client, &cleanup_client_shm_usage))
+    {
+        ClientShmUsageCtx* ctx;
+        ctx = wl_container_of(listener, ctx, destroy_listener);
+        return ctx->usage;
+    }
+
+    auto const ctx = new ClientShmUsageCtx{{}, std::make_shared<ClientShmUsage>(limit)};
+    ctx->destroy_listener.notify = &cleanup_client_shm_usage;
+    wl_client_add_destroy_listener(client, &ctx->destroy_listener);
+    return ctx->usage;
+}
+
+/// What a wl_shm_pool accounts to its client. It's shared by every mapping of the pool, so the memory stays accounted
+/// until the last buffer using it has gone.
+class PoolCharge
+{
+public:
+    PoolCharge(std::shared_ptr<ClientShmUsage> usage)
+        : usage{std::move(usage)}
+    {
+    }
+
+    ~PoolCharge()
+    {
+        usage->release(bytes);
+    }
+
+    PoolCharge(PoolCharge const&) = delete;
+    PoolCharge& operator=(PoolCharge const&) = delete;
+
+    /// Returns false if the client can't afford to grow the pool to size
+    auto grow_to(size_t size) -> bool
+    {
+        if (size > bytes)
+        {
+            if (!usage->try_charge(size - bytes))
+            {
+                return false;
+            }
+            bytes = size;
+        }
+        return true;
+    }
+
+    std::shared_ptr<ClientShmUsage> const usage;
+
+private:
+    size_t bytes{0};
+};
+
+[[noreturn]] void throw_over_limit(wl_resource* resource, ClientShmUsage const& usage, size_t requested)
+{
+    pid_t pid;
+    wl_client_get_credentials(wl_resource_get_client(resource), &pid, nullptr, nullptr);
+    mir::log_warning(
+        "Disconnecting client (pid %d): a wl_shm pool of %zu bytes would exceed its limit (%zu bytes, %zu in use)",
+        pid, requested, usage.limit, usage.mapped());
+
+    BOOST_THROW_EXCEPTION((mw::ProtocolError{
+        resource,
+        mw::Shm::Error::invalid_fd,
+        "wl_shm_pool of %zu bytes would exceed the client's limit of %zu bytes", requested, usage.limit}));
+}
+}
+
+/// A wl_shm_pool's file, mapped writable if the client allows it (as libwayland's wl_shm does) and read-only if not
+class mg::WlShmBufferContent::Mapping
+{
+public:
+    Mapping(mir::Fd const& fd, size_t size, std::shared_ptr<void> charge)
+        : charge{std::move(charge)},
+          size{size},
+          data{map(fd, size, PROT_READ | PROT_WRITE)},
+          writable{data != MAP_FAILED},
+          sealed{is_sealed_against_shrinking(fd, size)}
+    {
+        if (!writable)
+        {
+            data = map(fd, size, PROT_READ);
+        }
+
+        if (data == MAP_FAILED)
+        {
+            BOOST_THROW_EXCEPTION((std::system_error{errno, std::system_category(), "Failed to map wl_shm_pool"}));
+        }
+    }
+
+    ~Mapping()
+    {
+        munmap(data, size);
+    }
+
+    Mapping(Mapping const&) = delete;
+    Mapping& operator=(Mapping const&) = delete;
+
+    auto contains(void const* address) const -> bool
+    {
+        auto const byte = static_cast<unsigned char const*>(address);
+        return data <= byte && byte < data + size;
+    }
+
+    /// Keeps the pool's memory accounted to the client while this is mapped
+    std::shared_ptr<void> const charge;
+    size_t const size;
+    unsigned char* data;
+    /// The client gave us a file we can write to (and hasn't sealed against writes)
+    bool const writable;
+    /// The client can't truncate the file under us, so reads can't fault
+    bool const sealed;
+    /// The client truncated the file under us, and we've replaced the mapping with zeros
+    std::atomic<bool> mutable truncated{false};
+
+private:
+    static auto map(mir::Fd const& fd, size_t size, int protection) -> unsigned char*
+    {
+        return static_cast<unsigned char*>(mmap(nullptr, size, protection, MAP_SHARED, fd, 0));
+    }
+
+    static auto is_sealed_against_shrinking(mir::Fd const& fd, size_t size) -> bool
+    {
+        auto const seals = fcntl(fd, F_GET_SEALS);
+        if (seals < 0 || !(seals & F_SEAL_SHRINK))
+            return false;
+
+        struct stat file_info;
+        return fstat(fd, &file_info) == 0 && static_cast<size_t>(file_info.st_size) >= size;
+    }
+};
+
+namespace
+{
+/// What this thread is reading, so the SIGBUS handler can tell whether a fault is one of ours
+struct Access
+{
+    mg::WlShmBufferContent::Mapping const* const mapping;
+    Access const* const previous;
+};
+
+thread_local Access const* current_access{nullptr};
+
+struct sigaction previous_sigbus_action;
+std::once_flag sigbus_handler_installed;
+
+void handle_sigbus(int signal, siginfo_t* info, void* context)
+{
+    for (auto access = current_access; access; access = access->previous)
+    {
+        auto const mapping = access->mapping;
+        if (mapping->contains(info->si_addr))
+        {
+            // The client has truncated its pool; carry on with zeros rather than crashing
+            auto const protection = mapping->writable ? PROT_READ | PROT_WRITE : PROT_READ;
+            if (mmap(mapping->data, mapping->size, protection, MAP_FIXED | MAP_PRIVATE | MAP_ANONYMOUS, -1, 0) !=
+                MAP_FAILED)
+            {
+                mapping->truncated = true;
+                return;
+            }
+            break;
+        }
+    }
+
+    // Not our fault (or one we can't recover from), so do whatever would have happened without us
+    if (previous_sigbus_action.sa_flags & SA_SIGINFO)
+    {
+        previous_sigbus_action.sa_sigaction(signal, info, context);
+    }
+    else if (previous_sigbus_action.sa_handler != SIG_DFL && previous_sigbus_action.sa_handler != SIG_IGN)
+    {
+        previous_sigbus_action.sa_handler(signal);
+    }
+    else
+    {
+        sigaction(SIGBUS, &previous_sigbus_action, nullptr);
+        raise(signal);
+    }
+}
+
+void install_sigbus_handler()
+{
+    struct sigaction action;
+    memset(&action, 0, sizeof action);
+    action.sa_sigaction = &handle_sigbus;
+    action.sa_flags = SA_SIGINFO | SA_NODEFER;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGBUS, &action, &previous_sigbus_action);
+}
+
+mir::MemoryAccount shm_buffers{"buffers", "shm"};
+
+class ShmBuffer : public mw::Buffer
+{
+public:
+    ShmBuffer(wl_resource* id, std::shared_ptr<mg::WlShmBufferContent const> content)
+        : mw::Buffer{id, Version<1>{}},
+          content{std::move(content)},
+          charge{
+              shm_buffers,
+              static_cast<size_t>(this->content->stride().as_int()) * this->content->size().height.as_int()}
+    {
+    }
+
+    std::shared_ptr<mg::WlShmBufferContent const> const content;
+
+private:
+    void destroy() override
+    {
+        destroy_wayland_object();
+    }
+
+    mir::MemoryCharge const charge;
+};
+
+class ShmPool : public mw::ShmPool
+{
+public:
+    ShmPool(
+        wl_resource* id,
+        mir::Fd fd,
+        std::shared_ptr<PoolCharge> charge,
+        std::shared_ptr<mg::WlShmBufferContent::Mapping const> mapping)
+        : mw::ShmPool{id, Version<1>{}},
+          fd{std::move(fd)},
+          charge{std::move(charge)},
+          mapping{std::move(mapping)}
+    {
+    }
+
+private:
+    void create_buffer(
+        wl_resource* id,
+        int32_t offset,
+        int32_t width,
+        int32_t height,
+        int32_t stride,
+        uint32_t format) override
+    {
+        throw_if_truncated();
+
+        if (format != mw::Shm::Format::argb8888 && format != mw::Shm::Format::xrgb8888)
+        {
+            BOOST_THROW_EXCEPTION((mw::ProtocolError{
+                resource,
+                mw::Shm::Error::invalid_format,
+                "Invalid wl_shm format 0x%x", format}));
+        }
+
+        // Both formats we offer have four bytes to a pixel
+        auto const pool_size = static_cast<int64_t>(mapping->size);
+        if (offset < 0 || width <= 0 || height <= 0 || std::numeric_limits<int32_t>::max() / 4 < width ||
+            stride < width * 4 ||
+            std::numeric_limits<int32_t>::max() / stride <= height ||
+            offset > pool_size - static_cast<int64_t>(stride) * height)
+        {
+            BOOST_THROW_EXCEPTION((mw::ProtocolError{
+                resource,
+                mw::Shm::Error::invalid_stride,
+                "Invalid width (%d), height (%d), stride (%d) or offset (%d) for a pool of %zu bytes",
+                width, height, stride, offset, mapping->size}));
+        }
+
+        new ShmBuffer{
+            id,
+            std::make_shared<mg::WlShmBufferContent>(
+                mapping,
+                offset,
+                geom::Size{width, height},
+                geom::Stride{stride},
+                format)};
+    }
+
+    void destroy() override
+    {
+        destroy_wayland_object();
+    }
+
+    void resize(int32_t size) override
+    {
+        throw_if_truncated();
+
+        if (size < 0 || static_cast<size_t>(size) < mapping->size)
+        {
+            BOOST_THROW_EXCEPTION((mw::ProtocolError{
+                resource,
+                mw::Shm::Error::invalid_fd,
+                "Shrinking a wl_shm_pool (from %zu to %d bytes) is invalid", mapping->size, size}));
+        }
+
+        if (!charge->grow_to(size))
+        {
+            throw_over_limit(resource, *charge->usage, size);
+        }
+
+        // Buffers already created keep the old mapping, so there's nothing to synchronise with
+        try
+        {
+            mapping = std::make_shared<mg::WlShmBufferContent::Mapping>(fd, size, charge);
+        }
+        catch (std::system_error const& error)
+        {
+            BOOST_THROW_EXCEPTION((mw::ProtocolError{
+                resource,
+                mw::Shm::Error::invalid_fd,
+                "Failed to map resized wl_shm_pool: %s", error.what()}));
+        }
+    }
+
+    void throw_if_truncated() const
+    {
+        if (mapping->truncated)
+        {
+            BOOST_THROW_EXCEPTION((mw::ProtocolError{
+                resource,
+                mw::Shm::Error::invalid_fd,
+                "wl_shm_pool file was truncated while in use"}));
+        }
+    }
+
+    mir::Fd const fd;
+    std::shared_ptr<PoolCharge> const charge;
+    std::shared_ptr<mg::WlShmBufferContent::Mapping const> mapping;
+};
+
+class Shm : public mw::Shm
+{
+public:
+    Shm(wl_resource* resource, size_t client_limit)
+        : mw::Shm{resource, Version<1>{}},
+          usage{usage_for_client(client, client_limit)}
+    {
+        send_format_event(Format::argb8888);
+        send_format_event(Format::xrgb8888);
+    }
+
+private:
+    void create_pool(wl_resource* id, mir::Fd fd, int32_t size) override
+    {
+        if (size <= 0)
+        {
+            BOOST_THROW_EXCEPTION((mw::ProtocolError{
+                resource,
+                Error::invalid_stride,
+                "Invalid wl_shm_pool size (%d)", size}));
+        }
+
+        auto const charge = std::make_shared<PoolCharge>(usage);
+        if (!charge->grow_to(size))
+        {
+            throw_over_limit(resource, *usage, size);
+        }
+
+        std::shared_ptr<mg::WlShmBufferContent::Mapping const> mapping;
+        try
+        {
+            mapping = std::make_shared<mg::WlShmBufferContent::Mapping>(fd, size, charge);
+        }
+        catch (std::system_error const& error)
+        {
+            BOOST_THROW_EXCEPTION((mw::ProtocolError{
+                resource,
+                Error::invalid_fd,
+                "Failed to map wl_shm_pool: %s", error.what()}));
+        }
+
+        new ShmPool{id, std::move(fd), charge, std::move(mapping)};
+    }
+
+    std::shared_ptr<ClientShmUsage> const usage;
+};
+
+class ShmGlobal : public mw::Shm::Global
+{
+public:
+    ShmGlobal(wl_display* display, size_t client_limit)
+        : Global{display, Version<1>{}},
+          client_limit{client_limit}
+    {
+    }
+
+private:
+    void bind(wl_resource* new_wl_shm) override
+    {
+        new Shm{new_wl_shm, client_limit};
+    }
+
+    size_t const client_limit;
+};
+}
+
+mg::WlShmBufferContent::WlShmBufferContent(
+    std::shared_ptr<Mapping const> mapping,
+    size_t offset,
+    geometry::Size size,
+    geometry::Stride stride,
+    uint32_t format)
+    : mapping{std::move(mapping)},
+      offset{offset},
+      size_{size},
+      stride_{stride},
+      format_{format}
+{
+}
+
+void mg::WlShmBufferContent::read(std::function<void(unsigned char const*)> const& do_with_pixels) const
+{
+    guard([&] { do_with_pixels(mapping->data + offset); });
+}
+
+auto mg::WlShmBufferContent::writable() const -> bool
+{
+    return mapping->writable;
+}
+
+void mg::WlShmBufferContent::write(std::function<void(unsigned char*)> const& do_with_pixels) const
+{
+    if (!mapping->writable)
+    {
+        BOOST_THROW_EXCEPTION((std::logic_error{"Writing to a wl_shm buffer that is not writable"}));
+    }
+
+    guard([&] { do_with_pixels(mapping->data + offset); });
+}
+
+void mg::WlShmBufferContent::guard(std::function<void()> const& use_pixels) const
+{
+    if (mapping->sealed)
+    {
+        use_pixels();
+        return;
+    }
+
+    std::call_once(sigbus_handler_installed, &install_sigbus_handler);
+
+    Access const access{mapping.get(), current_access};
+    current_access = &access;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    try
+    {
+        use_pixels();
+    }
+    catch (...)
+    {
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        current_access = access.previous;
+        throw;
+    }
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    current_access = access.previous;
+}
+
+auto mg::create_wl_shm(wl_display* display, size_t client_limit) -> std::shared_ptr<void>
+{
+    return std::make_shared<ShmGlobal>(display, client_limit);
+}
+
+auto mg::wl_shm_buffer_content(wl_resource* buffer) -> std::shared_ptr<WlShmBufferContent const>
+{
+    if (auto const shm_buffer = dynamic_cast<ShmBuffer*>(mw::Buffer::from(buffer)))
+    {
+        return shm_buffer->content;
+    }
+    return nullptr;
+}
@@ -24,6 +24,8 @@
 #include "mir/shared_library_prober.h"
 #include "mir/logging/null_shared_library_prober_report.h"
 
+#include <cstdlib>
+
 namespace mo = mir::options;
 
 char const* const mo::server_socket_opt           = "file,f";
@@ -40,25 +42,53 @@ char const* const mo::connector_report_opt        = "connector-report";
 char const* const mo::scene_report_opt            = "scene-report";
 char const* const mo::input_report_opt            = "input-report";
 char const* const mo::seat_report_opt            = "seat-report";
+char const* const mo::startup_report_opt         = "startup-report";
+char const* const mo::memory_report_opt          = "memory-report";
+char const* const mo::memory_report_interval_opt = "memory-report-interval";
+char const* const mo::lock_report_opt            = "lock-report";
+char const* const mo::lock_report_interval_opt   = "lock-report-interval";
+char const* const mo::scene_record_opt           = "scene-record";
+char const* const mo::scene_replay_opt           = "scene-replay";
+char const* const mo::performance_hud_opt        = "performance-hud";
 char const* const mo::shared_library_prober_report_opt = "shared-library-prober-report";
 char const* const mo::shell_report_opt            = "shell-report";
 char const* const mo::offscreen_opt               = "offscreen";
+char const* const mo::offscreen_refresh_rate_opt  = "offscreen-refresh-rate";
 char const* const mo::touchspots_opt              = "enable-touchspots";
 char const* const mo::cursor_opt                  = "cursor";
 char const* const mo::fatal_except_opt            = "on-fatal-error-except";
 char const* const mo::debug_opt                   = "debug";
 char const* const mo::composite_delay_opt         = "composite-delay";
+char const* const mo::opaque_front_to_back_opt    = "opaque-front-to-back";
+char const* const mo::renderer_opt                = "renderer";
 char const* const mo::enable_key_repeat_opt       = "enable-key-repeat";
 char const* const mo::x11_display_opt             = "enable-x11";
 char const* const mo::x11_scale_opt               = "x11-scale";
 char const* const mo::wayland_extensions_opt      = "wayland-extensions";
 char const* const mo::add_wayland_extensions_opt  = "add-wayland-extensions";
 char const* const mo::drop_wayland_extensions_opt = "drop-wayland-extensions";
+char const* const mo::wayland_pointer_motion_rate_opt = "wayland-pointer-motion-rate";
+char const* const mo::wayland_shm_client_limit_opt = "wayland-shm-client-limit";
+char const* const mo::wayland_request_report_opt = "wayland-request-report";
+char const* const mo::wayland_request_report_interval_opt = "wayland-request-report-interval";
+char const* const mo::input_thread_priority_opt   = "input-thread-priority";
+char const* const mo::input_thread_cpus_opt       = "input-thread-cpus";
+char const* const mo::compositor_thread_priority_opt = "compositor-thread-priority";
+char const* const mo::compositor_thread_cpus_opt  = "compositor-thread-cpus";
+char const* const mo::thread_scheduling_opt       = "thread-scheduling";
+char const* const mo::app_scheduling_opt          = "app-scheduling";
+char const* const mo::lock_memory_opt             = "lock-memory";
+char const* const mo::async_logging_opt           = "async-logging";
+char const* const mo::log_rate_limit_opt          = "log-rate-limit";
+char const* const mo::metrics_socket_opt          = "metrics-socket";
+char const* const mo::timer_slack_opt             = "timer-slack";
+char const* const mo::input_resample_rate_opt     = "input-resample-rate";
 char const* const mo::enable_mirclient_opt        = "enable-mirclient";
 
 char const* const mo::off_opt_value = "off";
 char const* const mo::log_opt_value = "log";
 char const* const mo::lttng_opt_value = "lttng";
+char const* const mo::metrics_opt_value = "metrics";
 
 char const* const mo::platform_graphics_lib = "platform-graphics-lib";
 char const* const mo::platform_input_lib = "platform-input-lib";
@@ -71,6 +101,11 @@ char const* const mo::null_console = "none";
 char const* const mo::auto_console = "auto";
 
 char const* const mo::vt_option_name = "vt";
+char const* const mo::seat_opt = "seat";
+
+char const* const mo::main_loop_opt = "main-loop";
+char const* const mo::glib_main_loop = "glib";
+char const* const mo::epoll_main_loop = "epoll";
 
 
 namespace
@@ -159,19 +194,19 @@ mo::DefaultConfiguration::DefaultConfiguration(
         (enable_input_opt, po::value<bool>()->default_value(enable_input_default),
             "Enable input.")
         (compositor_report_opt, po::value<std::string>()->default_value(off_opt_value),
-            "Compositor reporting [{log,lttng,off}]")
+            "Compositor reporting [{log,lttng,metrics,stats,off}]")
         (connector_report_opt, po::value<std::string>()->default_value(off_opt_value),
             "How to handle the Connector report. [{log,lttng,off}]")
         (display_report_opt, po::value<std::string>()->default_value(off_opt_value),
-            "How to handle the Display report. [{log,lttng,off}]")
+            "How to handle the Display report. [{log,lttng,metrics,off}]")
         (input_report_opt, po::value<std::string>()->default_value(off_opt_value),
-            "How to handle to Input report. [{log,lttng,off}]")
+            "How to handle to Input report. [{log,lttng,metrics,off}]")
         (legacy_input_report_opt, po::value<std::string>()->default_value(off_opt_value),
             "How to handle the Legacy Input report. [{log,off}]")
         (seat_report_opt, po::value<std::string>()->default_value(off_opt_value),
-            "How to handle to Seat report. [{log,off}]")
+            "How to handle to Seat report. [{log,metrics,off}]")
         (session_mediator_report_opt, po::value<std::string>()->default_value(off_opt_value),
-            "How to handle the SessionMediator report. [{log,lttng,off}]")
+            "How to handle the SessionMediator report. [{log,lttng,metrics,off}]")
         (msg_processor_report_opt, po::value<std::string>()->default_value(off_opt_value),
             "How to handle the MessageProcessor report. [{log,lttng,off}]")
         (scene_report_opt, po::value<std::string>()->default_value(off_opt_value),
@@ -179,14 +214,40 @@ mo::DefaultConfiguration::DefaultConfiguration(
         (shared_library_prober_report_opt, po::value<std::string>()->default_value(log_opt_value),
             "How to handle the SharedLibraryProber report. [{log,lttng,off}]")
         (shell_report_opt, po::value<std::string>()->default_value(off_opt_value),
-         "How to handle the Shell report. [{log,off}]")
+         "How to handle the Shell report. [{log,metrics,off}]")
+        (startup_report_opt, po::value<std::string>()->default_value(off_opt_value),
+         "How to handle the Startup report, which times each phase of starting the server. [{log,metrics,off}]")
+        (memory_report_opt, po::value<std::string>()->default_value(off_opt_value),
+         "How to handle the Memory report, which attributes the server's memory to its subsystems. [{log,metrics,off}]")
+        (memory_report_interval_opt, po::value<int>()->default_value(10),
+         "Seconds between samples of the Memory report.")
+        (lock_report_opt, po::value<std::string>()->default_value(off_opt_value),
+         "How to handle the Lock report, which profiles waits for and holds of the server's busiest locks. [{log,metrics,off}]")
+        (lock_report_interval_opt, po::value<int>()->default_value(10),
+         "Seconds between samples of the Lock report.")
+        (scene_record_opt, po::value<std::string>()->default_value(""),
+         "Record the scene's workload (surface geometry, stacking and frame damage) to this file.")
+        (scene_replay_opt, po::value<std::string>()->default_value(""),
+         "Replay a workload recorded with --scene-record, over and over, as surfaces of the server's own.")
+        (performance_hud_opt, po::value<std::string>()->default_value(off_opt_value),
+         "Gather compositor metrics for an on-screen HUD showing each display's frame rate and frame times, "
+         "missed vblanks and the busiest clients. Ctrl+Alt+Shift+H shows or hides it. [{off,hidden,shown}]")
         (composite_delay_opt, po::value<int>()->default_value(0),
             "Compositor frame delay in milliseconds (how long to wait for new "
             "frames from clients before compositing). Higher values result in "
             "lower latency but risk causing frame skipping. "
             "Default: A negative value means decide automatically.")
+        (opaque_front_to_back_opt, po::value<bool>()->default_value(false),
+            "Draw opaque surfaces front to back with depth testing, so hidden "
+            "parts of windows are not shaded. Needs a depth buffer.")
+        (renderer_opt, po::value<std::string>()->default_value("gl"),
+            "Renderer used to composite outputs. \"software\" needs outputs "
+            "the CPU can draw into, such as on GPU-less hosts [{gl,software}]")
         (offscreen_opt,
             "Render to offscreen buffers instead of the real outputs.")
+        (offscreen_refresh_rate_opt, po::value<double>()->default_value(0),
+            "Virtual refresh rate, in Hz, of --offscreen outputs. "
+            "0 composites as fast as possible.")
         (touchspots_opt,
             "Display visualization of touchspots (e.g. for screencasting).")
         (cursor_opt,
@@ -194,6 +255,69 @@ mo::DefaultConfiguration::DefaultConfiguration(
             "Cursor (mouse pointer) to use [{auto,null,software}]")
         (enable_key_repeat_opt, po::value<bool>()->default_value(true),
              "Enable server generated key repeat")
+        (wayland_pointer_motion_rate_opt, po::value<double>()->default_value(0),
+            "Rate, in Hz, at which Wayland clients are sent pointer motion and "
+            "scroll events, coalescing any in between (typically the display's "
+            "refresh rate). Relative motion is held back along with the motion "
+            "it goes with. "
+            "0 sends every event as it arrives.")
+        (wayland_shm_client_limit_opt, po::value<int>()->default_value(0),
+            "Maximum size, in MiB, of the wl_shm pools each Wayland client may "
+            "have mapped. Clients exceeding it are disconnected. 0 means no limit.")
+        (wayland_request_report_opt, po::value<std::string>()->default_value(off_opt_value),
+            "How to handle the Wayland request report, which accounts for the "
+            "Wayland thread's time by client and request. [{log,lttng,off}]")
+        (wayland_request_report_interval_opt, po::value<int>()->default_value(10),
+            "Seconds between logs of the Wayland request report.")
+        (input_thread_priority_opt, po::value<int>()->default_value(0),
+            "SCHED_FIFO priority (1-99) for the input thread, using RealtimeKit "
+            "if Mir may not set it itself. 0 leaves it normally scheduled.")
+        (input_thread_cpus_opt, po::value<std::string>()->default_value(""),
+            "CPUs the input thread may run on, such as \"0,2-3\". Empty for any.")
+        (compositor_thread_priority_opt, po::value<int>()->default_value(0),
+            "SCHED_FIFO priority (1-99) for the compositor threads, using "
+            "RealtimeKit if Mir may not set it itself. 0 leaves them normally scheduled.")
+        (compositor_thread_cpus_opt, po::value<std::string>()->default_value(""),
+            "CPUs the compositor threads may run on, such as \"0,2-3\". Empty for any.")
+        (thread_scheduling_opt, po::value<std::string>()->default_value(""),
+            "Scheduling for Mir's threads by name, as \"<name>:<settings>;...\". "
+            "A name ending in \"*\" is a prefix, and a thread takes the first rule "
+            "it matches. Settings are cpus=<CPU list>, rt=<SCHED_FIFO priority>, "
+            "nice=<nice value>, cgroup=<cgroup directory> and stack=<KiB to "
+            "prefault>. For example "
+            "\"Mir/Comp:cpus=4-7 rt=10;*:cgroup=/sys/fs/cgroup/mir\". The "
+            "--compositor-thread-* and --input-thread-* options take precedence.")
+        (lock_memory_opt, po::value<bool>()->default_value(false),
+            "Lock the server's memory into RAM, keep the heap from shrinking and "
+            "prefault the compositor and input threads' stacks, so that they don't "
+            "page fault under memory pressure. Needs a large enough RLIMIT_MEMLOCK "
+            "(or CAP_IPC_LOCK). Other threads' stacks can be prefaulted with "
+            "--thread-scheduling's stack=<KiB> setting.")
+        (app_scheduling_opt, po::value<std::string>()->default_value(""),
+            "Cgroups to move client processes into as the focus and what is on "
+            "screen change, as \"focused=<cgroup directory> visible=<cgroup "
+            "directory> hidden=<cgroup directory>\". Clients of a kind without a "
+            "cgroup are left where they are. How each cgroup is scheduled "
+            "(cpu.weight, cpu.uclamp.min...) is configured on the cgroup itself.")
+        (async_logging_opt, po::value<bool>()->default_value(false),
+            "Write log messages from a thread of their own, so that logging "
+            "(for example, reports set to \"log\") barely affects the timing of the threads doing it.")
+        (log_rate_limit_opt, po::value<int>()->default_value(0),
+            "With --async-logging, the log messages per second each thread may write "
+            "before further messages are dropped. 0 for no limit.")
+        (metrics_socket_opt, po::value<std::string>()->default_value(""),
+            "Socket on which reports set to \"metrics\" serve their counters, in OpenMetrics "
+            "format, readable only by the server's user. Empty for $XDG_RUNTIME_DIR/mir-metrics-<pid> "
+            "(or /tmp/mir-metrics-<pid> without $XDG_RUNTIME_DIR).")
+        (timer_slack_opt, po::value<int>()->default_value(0),
+            "How late, in milliseconds, the main loop may fire an alarm (such as "
+            "a client ping timeout) so that alarms due close together wake it once. "
+            "An alarm is never delayed by more than a quarter of its timeout. 0 fires "
+            "alarms on time. Only the glib main loop supports this.")
+        (input_resample_rate_opt, po::value<int>()->default_value(0),
+            "Rate, in Hz, at which touch and pointer motion is resampled for "
+            "clients (usually the display's refresh rate). 0 delivers motion "
+            "as it arrives.")
         (fatal_except_opt, "On \"fatal error\" conditions [e.g. drivers behaving "
             "in unexpected ways] throw an exception (instead of a core dump)")
         (debug_opt, "Enable extra development debugging. "
@@ -210,7 +334,17 @@ mo::DefaultConfiguration::DefaultConfiguration(
             "auto: detect the appropriate provider.")
         (vt_option_name,
             boost::program_options::value<int>()->default_value(0),
-            "[requires --console-provider=vt] VT to run on or 0 to use current.");
+            "[requires --console-provider=vt] VT to run on or 0 to use current.")
+        (seat_opt,
+            po::value<std::string>()->default_value(getenv("XDG_SEAT") ? getenv("XDG_SEAT") : "seat0"),
+            "The seat (as assigned by udev's ID_SEAT) whose input devices and "
+            "displays to use. Run one server per seat to drive several.")
+        (main_loop_opt,
+            po::value<std::string>()->default_value(glib_main_loop),
+            "Main loop implementation\n"
+            "Options:\n"
+            "glib: a GLib main loop. Required for --console-provider=logind\n"
+            "epoll: a main loop using epoll directly, without GLib");
 
         add_platform_options();
 }
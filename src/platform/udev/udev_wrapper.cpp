@@ -131,6 +131,12 @@ bool mu::operator!=(mu::Device const& lhs, mu::Device const& rhs)
     return !(lhs == rhs);
 }
 
+auto mu::seat_of(mu::Device const& device) -> std::string
+{
+    auto const seat = device.property("ID_SEAT");
+    return seat && *seat ? seat : "seat0";
+}
+
 
 
 ////////////////////////
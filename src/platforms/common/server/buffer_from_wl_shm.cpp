@@ -19,14 +19,13 @@
 
 #include "buffer_from_wl_shm.h"
 #include "shm_buffer.h"
+#include "egl_context_executor.h"
 
+#include "mir/graphics/wayland_shm.h"
 #include "mir/renderer/sw/pixel_source.h"
 #include "mir/executor.h"
 #include "mir/renderer/gl/context.h"
 
-#define MIR_LOG_COMPONENT "wayland-gfx-helpers"
-#include "mir/log.h"
-
 #include <boost/throw_exception.hpp>
 #include <mutex>
 #include <atomic>
@@ -79,17 +78,17 @@ MirPixelFormat wl_format_to_mir_format(uint32_t format)
 /**
  * A shared-pointer-like handle to a wl_buffer
  *
- * We need three things from a wl_buffer:
+ * We need two things from a wl_buffer:
  * 1. we need to keep some handle around for Mir objects, which might possibly
  *    outlive the Wayland resource.
  * 2. we need to send a WL_BUFFER_RELEASE when the *last* MirBuffer referencing
  *    the wl_buffer goes away. `wl_buffers` *can* be submitted to different
  *    `wl_surface`s; these want to be represented as different MirBuffers, because
  *    they're going in different BufferStreams, have distinct frame callbacks, and so on.
- * 3. we need a way to prevent the wl_buffer being destroyed while a different thread
- *    is operating on it.
  *
- * SharedWlBuffer provides this behaviour.
+ * SharedWlBuffer provides this behaviour. (The pixels themselves are read through
+ * a WlShmBufferContent, which keeps the pool mapped, so reading them doesn't need
+ * the wl_buffer to still exist.)
  *
  * Theory of operation:
  * In standard fashion we hang a WlResource struct off the destruction listener
@@ -134,63 +133,6 @@ public:
         from.resource = nullptr;
     }
 
-    class LockedHandle
-    {
-    public:
-        LockedHandle(LockedHandle&& from) noexcept
-            : lock{std::move(from.lock)},
-              locked_buffer{from.locked_buffer}
-        {
-            /* We could technically use the default move constructor,
-             * but that would leave us with a moved-from object which
-             * is not locked but evaluates to a (maybe!) valid wl_resource*.
-             *
-             * It doesn't hurt to explicitly kill the moved-from handle.
-             */
-            from.locked_buffer = nullptr;
-        }
-
-        ~LockedHandle()
-        {
-            if (lock.owns_lock())
-                lock.unlock();
-        }
-
-        operator wl_resource*() const
-        {
-            return locked_buffer;
-        }
-
-        operator bool() const
-        {
-            return locked_buffer;
-        }
-
-    private:
-        std::unique_lock<std::mutex> lock;
-        wl_resource* locked_buffer;
-
-        friend class SharedWlBuffer;
-        LockedHandle(wl_resource* buffer, std::unique_lock<std::mutex>&& lock)
-            : lock{std::move(lock)},
-              locked_buffer{buffer}
-        {
-        }
-        LockedHandle()
-            : locked_buffer{nullptr}
-        {
-        }
-    };
-
-    LockedHandle lock() const
-    {
-        std::unique_lock<std::mutex> lock{resource->mutex};
-        if (resource->buffer)
-        {
-            return LockedHandle{resource->buffer, std::move(lock)};
-        }
-        return LockedHandle{};
-    }
 private:
     struct WlResource
     {
@@ -253,7 +195,6 @@ private:
         }
 
         std::atomic<int> use_count;
-        std::mutex mutex;
         wl_resource* buffer;
         std::shared_ptr<mir::Executor> const wayland_executor;
         wl_listener destruction_listener;
@@ -266,10 +207,7 @@ private:
         WlResource* resource;
         resource = wl_container_of(listener, resource, destruction_listener);
 
-        {
-            std::lock_guard<std::mutex> lock{resource->mutex};
-            resource->buffer = nullptr;
-        }
+        resource->buffer = nullptr;
         // Release the wl_resource's ownership
         resource->put();
     }
@@ -309,15 +247,22 @@ class WlShmBuffer :
 public:
     WlShmBuffer(
         SharedWlBuffer buffer,
+        std::shared_ptr<mg::WlShmBufferContent const> content,
         std::shared_ptr<mgc::EGLContextExecutor> egl_delegate,
-        mir::geometry::Size const& size,
-        mir::geometry::Stride stride,
-        MirPixelFormat format,
-        std::function<void()>&& on_consumed)
-        : ShmBuffer(size, format, std::move(egl_delegate)),
+        std::shared_ptr<mir::Executor> wayland_executor,
+        std::function<void()>&& on_consumed,
+        std::shared_ptr<mg::Buffer> const& previous,
+        std::experimental::optional<mir::geometry::Rectangles> const& damage)
+        : ShmBuffer(
+              content->size(),
+              wl_format_to_mir_format(content->format()),
+              std::move(egl_delegate),
+              previous,
+              damage),
+          wayland_executor{std::move(wayland_executor)},
           on_consumed{std::move(on_consumed)},
           buffer{std::move(buffer)},
-          stride_{stride}
+          content{std::move(content)}
     {
     }
 
@@ -328,16 +273,42 @@ public:
 
     void bind() override
     {
+        // Bound under the lock, so another output's compositor binding as we upload waits for the upload
+        std::lock_guard<std::mutex> lock{consumption_mutex};
         ShmBuffer::bind();
+        // Once uploaded, only a released texture needs our content again (which the pool still holds)
+        if (!uploaded || texture_needs_upload())
+        {
+            read_internal(
+                [this](unsigned char const* pixels)
+                {
+                    upload_damage_to_texture(pixels, stride());
+                });
+            on_consumed();
+            on_consumed = [](){};
+            uploaded = true;
+        }
+    }
+
+    /**
+     * Upload the content on the EGLContextExecutor's thread, so the compositor
+     * normally finds it already uploaded. Does nothing if bind() got there first.
+     */
+    void upload_on_shared_context()
+    {
+        if (!shared_context_uploads_supported())
+            return;
+
         std::lock_guard<std::mutex> lock{consumption_mutex};
         if (!uploaded)
         {
             read_internal(
                 [this](unsigned char const* pixels)
                 {
-                    upload_to_texture(pixels, stride());
+                    upload_damage_from_shared_context(pixels, stride());
                 });
-            on_consumed();
+            // We're on the EGL thread, but the client must hear about it on the Wayland thread
+            wayland_executor->spawn(std::move(on_consumed));
             on_consumed = [](){};
             uploaded = true;
         }
@@ -361,52 +332,53 @@ public:
 
     mir::geometry::Stride stride() const override
     {
-        return stride_;
+        return content->stride();
     }
 
 private:
     void read_internal(std::function<void(unsigned char const*)> const& do_with_pixels)
     {
-        if (auto const locked_buffer = buffer.lock())
-        {
-            auto const shm_buffer = wl_shm_buffer_get(locked_buffer);
-            wl_shm_buffer_begin_access(shm_buffer);
-            do_with_pixels(
-                static_cast<unsigned char*>(wl_shm_buffer_get_data(shm_buffer)));
-            wl_shm_buffer_end_access(shm_buffer);
-        }
-        else
-        {
-            mir::log_debug("Wayland buffer destroyed before use; rendering will be incomplete");
-        }
+        // The pool stays mapped for as long as we hold content, even if the client destroys the wl_buffer
+        content->read(do_with_pixels);
     }
 
+    std::shared_ptr<mir::Executor> const wayland_executor;
     std::mutex consumption_mutex;
     bool uploaded{false};
     std::function<void()> on_consumed;
     SharedWlBuffer const buffer;
-    mir::geometry::Stride const stride_;
+    std::shared_ptr<mg::WlShmBufferContent const> const content;
 };
 
 auto mg::wayland::buffer_from_wl_shm(
     wl_resource* buffer,
     std::shared_ptr<Executor> executor,
     std::shared_ptr<common::EGLContextExecutor> egl_delegate,
-    std::function<void()>&& on_consumed) -> std::shared_ptr<Buffer>
+    std::function<void()>&& on_consumed,
+    std::shared_ptr<Buffer> const& previous,
+    std::experimental::optional<geometry::Rectangles> const& damage) -> std::shared_ptr<Buffer>
 {
-    auto const shm_buffer = wl_shm_buffer_get(buffer);
-    if (!shm_buffer)
+    auto content = mg::wl_shm_buffer_content(buffer);
+    if (!content)
     {
         BOOST_THROW_EXCEPTION((std::logic_error{"Attempt to import a non-SHM buffer as a SHM buffer"}));
     }
-    return std::make_shared<WlShmBuffer>(
-        SharedWlBuffer{buffer, std::move(executor)},
-        std::move(egl_delegate),
-        mir::geometry::Size{
-            wl_shm_buffer_get_width(shm_buffer),
-            wl_shm_buffer_get_height(shm_buffer)
-        },
-        mir::geometry::Stride{wl_shm_buffer_get_stride(shm_buffer)},
-        wl_format_to_mir_format(wl_shm_buffer_get_format(shm_buffer)),
-        std::move(on_consumed));
+    auto const result = std::make_shared<WlShmBuffer>(
+        SharedWlBuffer{buffer, executor},
+        std::move(content),
+        egl_delegate,
+        executor,
+        std::move(on_consumed),
+        previous,
+        damage);
+
+    // Start uploading now, rather than when the compositor first needs the texture
+    egl_delegate->spawn(
+        [weak_buffer = std::weak_ptr<WlShmBuffer>{result}]()
+        {
+            if (auto const buffer = weak_buffer.lock())
+                buffer->upload_on_shared_context();
+        });
+
+    return result;
 }
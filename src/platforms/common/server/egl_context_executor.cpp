@@ -52,25 +52,36 @@ void mgc::EGLContextExecutor::process_loop(mgc::EGLContextExecutor* const me)
 {
     me->ctx->make_current();
 
+    std::vector<std::function<void()>> current_work;
     std::unique_lock<std::mutex> lock{me->mutex};
     while (!me->shutdown_requested)
     {
-        for (auto& work : me->work_queue)
+        // Run the work unlocked, so it can spawn() more and callers needn't wait for it
+        swap(current_work, me->work_queue);
+        lock.unlock();
+        for (auto& work : current_work)
         {
             work();
         }
-        me->work_queue.clear();
+        current_work.clear();
+        lock.lock();
 
-        me->new_work.wait(lock);
+        me->new_work.wait(lock, [me]() { return me->shutdown_requested || !me->work_queue.empty(); });
     }
 
-    // Drain the work-queue
-    for (auto& work : me->work_queue)
+    // Drain the work-queue, including whatever that work spawns
+    while (!me->work_queue.empty())
     {
-        work();
+        swap(current_work, me->work_queue);
+        lock.unlock();
+        for (auto& work : current_work)
+        {
+            work();
+        }
+        // …and ensure any functor cleanup happens with the EGL context current, too.
+        current_work.clear();
+        lock.lock();
     }
-    // …and ensure any functor cleanup happens with the EGL context current, too.
-    me->work_queue.clear();
 
     me->ctx->release_current();
 }
@@ -49,7 +49,9 @@ public:
     ~EGLContextExecutor() noexcept;
 
     /**
-     * Run a run a function on a thread with a current EGL context
+     * Run a function on a thread with a current EGL context
+     *
+     * Functions may themselves spawn() more work.
      */
     void spawn(std::function<void()>&& functor) override;
 private:
@@ -0,0 +1,104 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "frame_scheduler.h"
+
+#include <algorithm>
+#include <optional>
+
+namespace mgc = mir::graphics::common;
+
+using namespace std::chrono_literals;
+
+namespace
+{
+// We plan for the slowest of the recent frames, so one quick frame doesn't make us miss the next vblank
+size_t const render_time_history{16};
+}
+
+mgc::FrameScheduler::FrameScheduler(std::chrono::nanoseconds safety_margin)
+    : safety_margin{safety_margin}
+{
+}
+
+void mgc::FrameScheduler::record_render_time(std::chrono::nanoseconds render_time)
+{
+    render_times.push_back(render_time);
+    if (render_times.size() > render_time_history)
+        render_times.pop_front();
+}
+
+auto mgc::FrameScheduler::predicted_render_time() const -> std::chrono::nanoseconds
+{
+    if (render_times.empty())
+        return 0ns;
+
+    return *std::max_element(render_times.begin(), render_times.end());
+}
+
+auto mgc::FrameScheduler::delay_before_next_frame(
+    time::PosixTimestamp const& now,
+    std::vector<OutputTiming> const& outputs,
+    bool flips_pending,
+    bool composited) const -> std::chrono::milliseconds
+{
+    // Until we know how long rendering takes, start as soon as possible
+    if (composited && render_times.empty())
+        return 0ms;
+
+    // Composited frames stay vblank-paced, as a varying refresh rate makes some panels flicker
+    if (!composited && !outputs.empty() &&
+        std::all_of(outputs.begin(), outputs.end(), [](auto const& output) { return output.adaptive_sync; }))
+    {
+        return 0ms;
+    }
+
+    std::optional<time::PosixTimestamp> deadline;
+    for (auto const& output : outputs)
+    {
+        auto const interval = output.frame_interval;
+        if (interval <= 0ns)
+            continue;
+
+        // Without a usable timestamp, assume the page flip we last waited for has just happened
+        auto next_vblank = now + interval;
+
+        auto const& last_vblank = output.last_frame.ust;
+        if (last_vblank.nanoseconds > 0ns && last_vblank.clock_id == now.clock_id && last_vblank <= now)
+        {
+            auto const frames_since = (now - last_vblank) / interval;
+            next_vblank = last_vblank + (frames_since + 1) * interval;
+        }
+
+        // A pending flip takes the next vblank, so we can only make the one after
+        if (flips_pending)
+            next_vblank = next_vblank + interval;
+
+        if (!deadline || next_vblank < *deadline)
+            deadline = next_vblank;
+    }
+
+    if (!deadline)
+        return 0ms;
+
+    auto const render_time = composited ? predicted_render_time() : 0ns;
+    auto const start = *deadline - render_time - safety_margin;
+    if (start <= now)
+        return 0ms;
+
+    // Rounding down only starts us a little earlier than necessary
+    return std::chrono::duration_cast<std::chrono::milliseconds>(start - now);
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_PLATFORMS_COMMON_FRAME_SCHEDULER_H_
+#define MIR_PLATFORMS_COMMON_FRAME_SCHEDULER_H_
+
+#include "mir/graphics/frame.h"
+
+#include <chrono>
+#include <deque>
+#include <vector>
+
+namespace mir
+{
+namespace graphics
+{
+namespace common
+{
+
+/**
+ * Decides when the compositor should start a frame so that it is finished
+ * as late as possible, but still in time for the next vblank.
+ */
+class FrameScheduler
+{
+public:
+    struct OutputTiming
+    {
+        Frame last_frame;                       ///< The last page flip completed on the output
+        std::chrono::nanoseconds frame_interval;   ///< At the maximum refresh rate
+        bool adaptive_sync;                         ///< Whether the output refreshes when we flip
+    };
+
+    /// \param [in] safety_margin   Time to leave between finishing a frame and the vblank it's for
+    explicit FrameScheduler(std::chrono::nanoseconds safety_margin);
+
+    /// Record how long the last frame took from starting to render until the GPU finished it
+    void record_render_time(std::chrono::nanoseconds render_time);
+
+    /**
+     * How long to wait from \a now before starting the next frame.
+     *
+     * The next frame is due at the earliest upcoming vblank of any of the
+     * outputs, or the one after that if a page flip is still pending for it.
+     * When every output has adaptive sync, bypassed frames are due as soon as
+     * they're ready: the panel waits for them, within its range.
+     *
+     * \param [in] composited   Whether the next frame is expected to need
+     *                          rendering (rather than being bypassed)
+     */
+    auto delay_before_next_frame(
+        time::PosixTimestamp const& now,
+        std::vector<OutputTiming> const& outputs,
+        bool flips_pending,
+        bool composited) const -> std::chrono::milliseconds;
+
+private:
+    auto predicted_render_time() const -> std::chrono::nanoseconds;
+
+    std::chrono::nanoseconds const safety_margin;
+    std::deque<std::chrono::nanoseconds> render_times;
+};
+
+}
+}
+}
+
+#endif // MIR_PLATFORMS_COMMON_FRAME_SCHEDULER_H_
@@ -205,3 +205,92 @@ auto mgk::find_crtc_with_primary_plane(
 
     BOOST_THROW_EXCEPTION(std::runtime_error{"Could not find primary plane for CRTC"});
 }
+
+auto mgk::find_planes_for_crtc(int drm_fd, uint32_t crtc_id) -> CrtcPlanes
+{
+    DRMModeResources resources{drm_fd};
+
+    int crtc_index{-1};
+    int index{0};
+    for (auto const& crtc : resources.crtcs())
+    {
+        if (crtc->crtc_id == crtc_id)
+        {
+            crtc_index = index;
+            break;
+        }
+        ++index;
+    }
+    if (crtc_index < 0)
+    {
+        BOOST_THROW_EXCEPTION(std::runtime_error{"Failed to find index of CRTC " + std::to_string(crtc_id)});
+    }
+
+    CrtcPlanes result;
+    mgk::PlaneResources plane_res{drm_fd};
+
+    for (auto& plane : plane_res.planes())
+    {
+        if (!(plane->possible_crtcs & (1 << crtc_index)))
+            continue;
+
+        ObjectProperties plane_props{drm_fd, plane->plane_id, DRM_MODE_OBJECT_PLANE};
+        switch (plane_props["type"])
+        {
+        case DRM_PLANE_TYPE_PRIMARY:
+            if (!result.primary)
+                result.primary = std::move(plane);
+            break;
+
+        case DRM_PLANE_TYPE_CURSOR:
+            if (!result.cursor)
+                result.cursor = std::move(plane);
+            break;
+
+        case DRM_PLANE_TYPE_OVERLAY:
+            result.overlays.push_back(std::move(plane));
+            break;
+        }
+    }
+
+    return result;
+}
+
+auto mgk::plane_format_modifiers(int drm_fd, DRMModePlaneUPtr const& plane, uint32_t format)
+    -> std::vector<uint64_t>
+{
+    ObjectProperties const plane_props{drm_fd, plane};
+    if (!plane_props.has_property("IN_FORMATS"))
+        return {};
+
+    std::unique_ptr<drmModePropertyBlobRes, void(*)(drmModePropertyBlobPtr)> const blob{
+        drmModeGetPropertyBlob(drm_fd, plane_props["IN_FORMATS"]),
+        &drmModeFreePropertyBlob};
+    if (!blob || blob->length < sizeof(drm_format_modifier_blob))
+        return {};
+
+    auto const data = static_cast<char const*>(blob->data);
+    auto const header = reinterpret_cast<drm_format_modifier_blob const*>(data);
+    auto const formats = reinterpret_cast<uint32_t const*>(data + header->formats_offset);
+    auto const modifiers = reinterpret_cast<drm_format_modifier const*>(data + header->modifiers_offset);
+
+    auto const format_end = formats + header->count_formats;
+    auto const format_entry = std::find(formats, format_end, format);
+    if (format_entry == format_end)
+        return {};
+    auto const format_index = static_cast<uint32_t>(format_entry - formats);
+
+    // Each modifier applies to a 64-format window of the format list, as a bitmask
+    std::vector<uint64_t> result;
+    for (auto i = 0u; i < header->count_modifiers; ++i)
+    {
+        auto const& modifier = modifiers[i];
+        if (format_index >= modifier.offset &&
+            format_index < modifier.offset + 64 &&
+            (modifier.formats & (uint64_t{1} << (format_index - modifier.offset))))
+        {
+            result.push_back(modifier.modifier);
+        }
+    }
+    return result;
+}
@@ -53,6 +53,31 @@ DRMModeCrtcUPtr find_crtc_for_connector(
 std::pair<DRMModeCrtcUPtr, DRMModePlaneUPtr> find_crtc_with_primary_plane(
     int drm_fd,
     DRMModeConnectorUPtr const& connector);
+
+struct CrtcPlanes
+{
+    DRMModePlaneUPtr primary;                   ///< May be null
+    DRMModePlaneUPtr cursor;                    ///< May be null
+    std::vector<DRMModePlaneUPtr> overlays;
+};
+
+/**
+ * Finds the planes which can be used with a CRTC, by type
+ *
+ * \note    Planes (typically overlays) may be usable with several CRTCs, so
+ *          may also be in use by another CRTC.
+ * \throws  A std::runtime_error if there is no CRTC with ID \a crtc_id.
+ */
+auto find_planes_for_crtc(int drm_fd, uint32_t crtc_id) -> CrtcPlanes;
+
+/**
+ * The format modifiers with which \a plane can scan out buffers of DRM \a format
+ *
+ * \note    Empty if the driver doesn't advertise them (no IN_FORMATS property),
+ *          in which case only buffers allocated without modifiers are safe.
+ */
+auto plane_format_modifiers(int drm_fd, DRMModePlaneUPtr const& plane, uint32_t format)
+    -> std::vector<uint64_t>;
 }
 }
 }
@@ -25,13 +25,22 @@
 
 #define MIR_LOG_COMPONENT "gfx-common"
 #include "mir/log.h"
+#include "mir/memory_account.h"
 
 #include <GLES2/gl2.h>
 #include <GLES2/gl2ext.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
 
 #include <boost/throw_exception.hpp>
 
+#include <cstring>
+#include <deque>
+#include <list>
 #include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <string.h>
 #include <endian.h>
@@ -39,6 +48,7 @@
 namespace mg=mir::graphics;
 namespace mgc = mir::graphics::common;
 namespace geom = mir::geometry;
+namespace mrs = mir::renderer::software;
 
 bool mg::get_gl_pixel_format(MirPixelFormat mir_format,
                          GLenum& gl_format, GLenum& gl_type)
@@ -88,19 +98,441 @@ bool mg::get_gl_pixel_format(MirPixelFormat mir_format,
     return gl_format != GL_INVALID_ENUM && gl_type != GL_INVALID_ENUM;
 }
 
+namespace
+{
+/// The EGL_KHR_fence_sync entry points (and EGL_KHR_wait_sync's, if available)
+class FenceSync
+{
+public:
+    /// The entry points for \a dpy, or null if it doesn't support fences
+    static auto for_display(EGLDisplay dpy) -> FenceSync const*
+    {
+        // Displays differ in their extensions, and there may be several (one per GPU, say)
+        static std::mutex mutex;
+        static std::unordered_map<EGLDisplay, std::unique_ptr<FenceSync>> displays;
+
+        std::lock_guard<std::mutex> lock{mutex};
+        auto const existing = displays.find(dpy);
+        if (existing != displays.end())
+            return existing->second.get();
+
+        return displays.emplace(dpy, load(dpy)).first->second.get();
+    }
+
+    /// A fence after the current context's commands so far (flushed, so other contexts can wait for it)
+    auto fence(EGLDisplay dpy) const -> EGLSyncKHR
+    {
+        auto const sync = create(dpy, EGL_SYNC_FENCE_KHR, nullptr);
+        glFlush();
+        return sync;
+    }
+
+    /// Make the current context wait for \a sync, on the GPU if possible
+    void wait_for(EGLDisplay dpy, EGLSyncKHR sync) const
+    {
+        if (wait)
+            wait(dpy, sync, 0);
+        else
+            client_wait(dpy, sync, EGL_SYNC_FLUSH_COMMANDS_BIT_KHR, EGL_FOREVER_KHR);
+    }
+
+    PFNEGLCREATESYNCKHRPROC create{nullptr};
+    PFNEGLDESTROYSYNCKHRPROC destroy{nullptr};
+    PFNEGLCLIENTWAITSYNCKHRPROC client_wait{nullptr};
+    PFNEGLWAITSYNCKHRPROC wait{nullptr};
+
+private:
+    static auto load(EGLDisplay dpy) -> std::unique_ptr<FenceSync>
+    {
+        auto const extensions = dpy != EGL_NO_DISPLAY ? eglQueryString(dpy, EGL_EXTENSIONS) : nullptr;
+        if (!extensions || !strstr(extensions, "EGL_KHR_fence_sync"))
+            return nullptr;
+
+        auto result = std::make_unique<FenceSync>();
+        result->create = reinterpret_cast<PFNEGLCREATESYNCKHRPROC>(eglGetProcAddress("eglCreateSyncKHR"));
+        result->destroy = reinterpret_cast<PFNEGLDESTROYSYNCKHRPROC>(eglGetProcAddress("eglDestroySyncKHR"));
+        result->client_wait =
+            reinterpret_cast<PFNEGLCLIENTWAITSYNCKHRPROC>(eglGetProcAddress("eglClientWaitSyncKHR"));
+        if (strstr(extensions, "EGL_KHR_wait_sync"))
+            result->wait = reinterpret_cast<PFNEGLWAITSYNCKHRPROC>(eglGetProcAddress("eglWaitSyncKHR"));
+
+        if (!result->create || !result->destroy || !result->client_wait)
+            return nullptr;
+        return result;
+    }
+};
+
+mir::MemoryAccount shm_textures{"textures", "shm"};
+mir::MemoryAccount memory_buffers{"buffers", "memory"};
+
+auto bytes_of(geom::Size const& size, MirPixelFormat format) -> size_t
+{
+    return static_cast<size_t>(MIR_BYTES_PER_PIXEL(format)) * size.width.as_int() * size.height.as_int();
+}
+
+/// A mapping of a MemoryBackedShmBuffer's own pixels, rather than of a copy
+template<typename Data>
+class DirectMapping : public mrs::Mapping<Data>
+{
+public:
+    DirectMapping(
+        Data* pixels,
+        MirPixelFormat format,
+        geom::Stride stride,
+        geom::Size size,
+        std::function<void()> on_unmap)
+        : pixels{pixels},
+          format_{format},
+          stride_{stride},
+          size_{size},
+          on_unmap{std::move(on_unmap)}
+    {
+    }
+
+    ~DirectMapping()
+    {
+        on_unmap();
+    }
+
+    auto format() const -> MirPixelFormat override { return format_; }
+    auto stride() const -> geom::Stride override { return stride_; }
+    auto size() const -> geom::Size override { return size_; }
+    auto data() -> Data* override { return pixels; }
+    auto len() const -> size_t override { return stride_.as_uint32_t() * size_.height.as_uint32_t(); }
+
+private:
+    Data* const pixels;
+    MirPixelFormat const format_;
+    geom::Stride const stride_;
+    geom::Size const size_;
+    std::function<void()> const on_unmap;
+};
+}
+
 bool mgc::ShmBuffer::supports(MirPixelFormat mir_format)
 {
     GLenum gl_format, gl_type;
     return mg::get_gl_pixel_format(mir_format, gl_format, gl_type);
 }
 
+/// A texture shared by a sequence of ShmBuffers, each replacing the content of the one before
+class mgc::ShmBuffer::SharedTexture : public std::enable_shared_from_this<SharedTexture>
+{
+public:
+    /// The texture is charged for its full size from the start, though it's uploaded on first use
+    SharedTexture(std::shared_ptr<EGLContextExecutor> egl_delegate, size_t bytes)
+        : egl_delegate{std::move(egl_delegate)},
+          bytes{bytes},
+          charge{shm_textures, bytes}
+    {
+    }
+
+    ~SharedTexture()
+    {
+        {
+            auto& budget = the_budget();
+            std::lock_guard<std::mutex> lock{budget.mutex};
+            if (budgeted)
+            {
+                budget.lru.erase(lru_position);
+                budget.held -= bytes;
+            }
+        }
+
+        destroy_fences();
+        delete_texture();
+    }
+
+    /// The GPU memory held by all textures, and the order they were last used in
+    struct Budget
+    {
+        std::mutex mutex;
+        /// 0 for no limit
+        size_t limit{0};
+        size_t held{0};
+        /// The textures holding GPU memory, least recently bound first
+        std::list<std::weak_ptr<SharedTexture>> lru;
+    };
+
+    static auto the_budget() -> Budget&
+    {
+        static Budget budget;
+        return budget;
+    }
+
+    /// Notes the texture as the most recently used, and as holding GPU memory if it was released
+    void used(std::lock_guard<std::mutex> const&)
+    {
+        auto& budget = the_budget();
+        std::lock_guard<std::mutex> lock{budget.mutex};
+        if (budgeted)
+        {
+            budget.lru.splice(budget.lru.end(), budget.lru, lru_position);
+        }
+        else
+        {
+            lru_position = budget.lru.insert(budget.lru.end(), shared_from_this());
+            budgeted = true;
+            budget.held += bytes;
+        }
+    }
+
+    /**
+     * Releases the least recently used textures (other than \a keep) until the rest fit the budget
+     *
+     * \note This must not be called with any texture's mutex locked, as it locks those it releases
+     */
+    static void enforce_budget(SharedTexture const* keep)
+    {
+        std::vector<std::shared_ptr<SharedTexture>> over_budget;
+        {
+            auto& budget = the_budget();
+            std::lock_guard<std::mutex> lock{budget.mutex};
+            if (!budget.limit)
+                return;
+
+            auto held = budget.held;
+            for (auto const& weak_texture : budget.lru)
+            {
+                if (held <= budget.limit)
+                    break;
+
+                // Textures being destroyed remove themselves (and keep's owner holds it, so
+                // dropping our reference to it here can't destroy it under the lock)
+                auto const texture = weak_texture.lock();
+                if (texture && texture.get() != keep)
+                {
+                    held -= texture->bytes;
+                    over_budget.push_back(texture);
+                }
+            }
+        }
+
+        for (auto const& texture : over_budget)
+        {
+            std::lock_guard<std::mutex> lock{texture->mutex};
+            texture->release(lock);
+        }
+    }
+
+    /// Frees the texture's GPU memory; bind_texture() creates it afresh, and it's uploaded in full
+    void release(std::lock_guard<std::mutex> const&)
+    {
+        {
+            auto& budget = the_budget();
+            std::lock_guard<std::mutex> lock{budget.mutex};
+            if (!budgeted)
+                return;
+
+            budget.lru.erase(lru_position);
+            budget.held -= bytes;
+            budgeted = false;
+        }
+
+        destroy_fences();
+        delete_texture();
+        id = 0;
+        content_generation = 0;
+        released = true;
+        charge.resize(0);
+    }
+
+    /// Notes that bind_texture() has (re)created the texture
+    void created(std::lock_guard<std::mutex> const&)
+    {
+        released = false;
+        charge.resize(bytes);
+    }
+
+    auto add_generation(std::experimental::optional<geom::Rectangles> const& damage) -> uint64_t
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        damage_history.push_back({++latest_generation, damage});
+        if (damage_history.size() > max_damage_history)
+            damage_history.pop_front();
+        return latest_generation;
+    }
+
+    /// The area that differs between the content of two generations, if known
+    auto damage_between(uint64_t from, uint64_t to, std::lock_guard<std::mutex> const&) const
+        -> std::experimental::optional<geom::Rectangles>
+    {
+        if (!from || damage_history.empty() || damage_history.front().generation > from + 1)
+            return std::experimental::nullopt;
+
+        geom::Rectangles result;
+        for (auto const& entry : damage_history)
+        {
+            if (entry.generation <= from || entry.generation > to)
+                continue;
+
+            if (!entry.damage)
+                return std::experimental::nullopt;
+
+            for (auto const& rect : entry.damage.value())
+                result.add(rect);
+        }
+        return result;
+    }
+
+    /// Notes a bind from the current context, which may be one of several outputs' compositors
+    void add_reader(std::lock_guard<std::mutex> const&)
+    {
+        auto const context = eglGetCurrentContext();
+        if (last_reader != EGL_NO_CONTEXT && last_reader != context)
+        {
+            multiple_readers = true;
+            fence_display = eglGetCurrentDisplay();
+        }
+        last_reader = context;
+    }
+
+    /// Whether uploads and reads need fences, as the texture is used from more than one context
+    auto needs_fences(std::lock_guard<std::mutex> const&) const -> bool
+    {
+        return shared_context_uploads || multiple_readers;
+    }
+
+    /// Replaces the current context's read fence with one after its commands so far
+    void add_read_fence(FenceSync const& sync, std::lock_guard<std::mutex> const&)
+    {
+        auto const context = eglGetCurrentContext();
+        // Flushed, so an upload from another context can wait for it on the GPU
+        auto const fence = sync.fence(fence_display);
+        for (auto& reader : read_fences)
+        {
+            if (reader.first == context)
+            {
+                sync.destroy(fence_display, reader.second);
+                reader.second = fence;
+                return;
+            }
+        }
+        read_fences.emplace_back(context, fence);
+    }
+
+    /// Makes the current context wait (on the GPU if possible) for others to finish drawing from the texture
+    void wait_for_readers(FenceSync const& sync, std::lock_guard<std::mutex> const&)
+    {
+        auto const context = eglGetCurrentContext();
+        for (auto const& reader : read_fences)
+        {
+            if (reader.first != context)
+                sync.wait_for(fence_display, reader.second);
+            sync.destroy(fence_display, reader.second);
+        }
+        read_fences.clear();
+    }
+
+    /// Fences the upload just made from the current context, for others' bind()s to wait for
+    void add_upload_fence(FenceSync const& sync, std::lock_guard<std::mutex> const&)
+    {
+        if (upload_fence != EGL_NO_SYNC_KHR)
+            sync.destroy(fence_display, upload_fence);
+        upload_fence = sync.fence(fence_display);
+    }
+
+    std::shared_ptr<EGLContextExecutor> const egl_delegate;
+    size_t const bytes;
+
+    std::mutex mutex;
+    GLuint id{0};
+    /// The generation whose content the texture holds (0 for none)
+    uint64_t content_generation{0};
+    /// Whether release() has freed the texture since bind_texture() last created it
+    bool released{false};
+
+    /// Whether the texture is uploaded from a context other than the compositor's
+    bool shared_context_uploads{false};
+    /// Whether the compositors of several outputs (with a context each, sharing textures) draw from it
+    bool multiple_readers{false};
+    EGLContext last_reader{EGL_NO_CONTEXT};
+    EGLDisplay fence_display{EGL_NO_DISPLAY};
+    /// The most recent upload, for bind()s from other contexts to wait for until it's signalled
+    EGLSyncKHR upload_fence{EGL_NO_SYNC_KHR};
+    /// Each context's most recent use of the texture, for uploads to wait for
+    std::vector<std::pair<EGLContext, EGLSyncKHR>> read_fences;
+
+private:
+    static size_t const max_damage_history = 8;
+
+    void destroy_fences()
+    {
+        if (upload_fence == EGL_NO_SYNC_KHR && read_fences.empty())
+            return;
+
+        // Fences only exist if fence_display supports them
+        auto const sync = FenceSync::for_display(fence_display);
+        if (upload_fence != EGL_NO_SYNC_KHR)
+            sync->destroy(fence_display, upload_fence);
+        upload_fence = EGL_NO_SYNC_KHR;
+        for (auto const& reader : read_fences)
+            sync->destroy(fence_display, reader.second);
+        read_fences.clear();
+    }
+
+    /// The texture may still be bound, or be drawn from, in another context, so it's deleted from the shared one
+    void delete_texture()
+    {
+        if (id != 0)
+        {
+            egl_delegate->spawn(
+                [id = id]()
+                {
+                    glDeleteTextures(1, &id);
+                });
+        }
+    }
+
+    struct Damage
+    {
+        uint64_t generation;
+        std::experimental::optional<geom::Rectangles> damage;
+    };
+
+    uint64_t latest_generation{0};
+    std::deque<Damage> damage_history;
+    /// Only charged while the texture holds GPU memory (or is yet to be created)
+    mir::MemoryCharge charge;
+
+    /// Guarded by the budget's mutex
+    bool budgeted{false};
+    std::list<std::weak_ptr<SharedTexture>>::iterator lru_position;
+};
+
+void mgc::ShmBuffer::set_texture_budget(size_t bytes)
+{
+    auto& budget = SharedTexture::the_budget();
+    std::lock_guard<std::mutex> lock{budget.mutex};
+    budget.limit = bytes;
+}
+
 mgc::ShmBuffer::ShmBuffer(
     geom::Size const& size,
     MirPixelFormat const& format,
     std::shared_ptr<EGLContextExecutor> egl_delegate)
+    : ShmBuffer(size, format, std::move(egl_delegate), nullptr, std::experimental::nullopt)
+{
+}
+
+mgc::ShmBuffer::ShmBuffer(
+    geom::Size const& size,
+    MirPixelFormat const& format,
+    std::shared_ptr<EGLContextExecutor> egl_delegate,
+    std::shared_ptr<Buffer> const& previous,
+    std::experimental::optional<geom::Rectangles> const& damage)
     : size_{size},
       pixel_format_{format},
-      egl_delegate{std::move(egl_delegate)}
+      texture{
+          [&]() -> std::shared_ptr<SharedTexture>
+          {
+              auto const previous_shm = dynamic_cast<ShmBuffer const*>(previous.get());
+              if (previous_shm && previous_shm->size_ == size && previous_shm->pixel_format_ == format)
+                  return previous_shm->texture;
+
+              return std::make_shared<SharedTexture>(std::move(egl_delegate), bytes_of(size, format));
+          }()},
+      generation{texture->add_generation(damage)}
 {
 }
 
@@ -110,21 +542,12 @@ mgc::MemoryBackedShmBuffer::MemoryBackedShmBuffer(
     std::shared_ptr<EGLContextExecutor> egl_delegate)
     : ShmBuffer(size, pixel_format, std::move(egl_delegate)),
       stride_{MIR_BYTES_PER_PIXEL(pixel_format) * size.width.as_uint32_t()},
-      pixels{new unsigned char[stride_.as_int() * size.height.as_int()]}
+      pixels{new unsigned char[stride_.as_int() * size.height.as_int()]},
+      charge{memory_buffers, bytes_of(size, pixel_format)}
 {
 }
 
-mgc::ShmBuffer::~ShmBuffer() noexcept
-{
-    if (tex_id != 0)
-    {
-        egl_delegate->spawn(
-            [id = tex_id]()
-            {
-                glDeleteTextures(1, &id);
-            });
-    }
-}
+mgc::ShmBuffer::~ShmBuffer() noexcept = default;
 
 geom::Size mgc::ShmBuffer::size() const
 {
@@ -141,14 +564,115 @@ MirPixelFormat mgc::ShmBuffer::pixel_format() const
     return pixel_format_;
 }
 
+auto mgc::ShmBuffer::texture_needs_upload() const -> bool
+{
+    std::lock_guard<decltype(texture->mutex)> lock{texture->mutex};
+    return texture->content_generation < generation;
+}
+
 void mgc::ShmBuffer::upload_to_texture(void const* pixels, geom::Stride const& stride)
+{
+    std::lock_guard<decltype(texture->mutex)> lock{texture->mutex};
+    // In case the texture was released since bind()
+    if (texture->released)
+        bind_texture(lock);
+
+    auto const sync = texture->needs_fences(lock) ? FenceSync::for_display(texture->fence_display) : nullptr;
+    if (sync)
+        texture->wait_for_readers(*sync, lock);
+
+    upload_area(pixels, stride, std::experimental::nullopt);
+    texture->content_generation = generation;
+
+    if (sync)
+        texture->add_upload_fence(*sync, lock);
+}
+
+void mgc::ShmBuffer::upload_damage_to_texture(void const* pixels, geom::Stride const& stride)
+{
+    std::lock_guard<decltype(texture->mutex)> lock{texture->mutex};
+
+    // The texture already holds this content or, if a later buffer got there first, newer content
+    if (texture->content_generation >= generation)
+        return;
+
+    // In case the texture was released since bind()
+    if (texture->released)
+        bind_texture(lock);
+
+    // Other outputs' compositors may be drawing from the texture, and will draw from it again
+    auto const sync = texture->needs_fences(lock) ? FenceSync::for_display(texture->fence_display) : nullptr;
+    if (sync)
+        texture->wait_for_readers(*sync, lock);
+
+    upload_damage(pixels, stride, lock);
+
+    if (sync)
+        texture->add_upload_fence(*sync, lock);
+}
+
+void mgc::ShmBuffer::upload_damage(
+    void const* pixels,
+    geom::Stride const& stride,
+    std::lock_guard<std::mutex> const& lock)
+{
+    if (auto const damage = texture->damage_between(texture->content_generation, generation, lock))
+    {
+        geom::Rectangle const buffer_area{{0, 0}, size()};
+        for (auto const& rect : damage.value())
+        {
+            auto const area = rect.intersection_with(buffer_area);
+            if (area.size.width.as_int() > 0 && area.size.height.as_int() > 0)
+                upload_area(pixels, stride, area);
+        }
+    }
+    else
+    {
+        upload_area(pixels, stride, std::experimental::nullopt);
+    }
+
+    texture->content_generation = generation;
+}
+
+bool mgc::ShmBuffer::shared_context_uploads_supported()
+{
+    return FenceSync::for_display(eglGetCurrentDisplay());
+}
+
+void mgc::ShmBuffer::upload_damage_from_shared_context(void const* pixels, geom::Stride const& stride)
+{
+    auto const dpy = eglGetCurrentDisplay();
+    auto const sync = FenceSync::for_display(dpy);
+    if (!sync)
+        BOOST_THROW_EXCEPTION((std::logic_error{"Shared context uploads need EGL_KHR_fence_sync"}));
+
+    std::lock_guard<decltype(texture->mutex)> lock{texture->mutex};
+    if (texture->content_generation >= generation)
+        return;
+
+    texture->shared_context_uploads = true;
+    texture->fence_display = dpy;
+
+    // Don't overwrite the texture while a compositor may still be drawing from it
+    texture->wait_for_readers(*sync, lock);
+
+    bind_texture(lock);
+    upload_damage(pixels, stride, lock);
+
+    texture->add_upload_fence(*sync, lock);
+}
+
+void mgc::ShmBuffer::upload_area(
+    void const* pixels,
+    geom::Stride const& stride,
+    std::experimental::optional<geom::Rectangle> const& area)
 {
     GLenum format, type;
 
     if (mg::get_gl_pixel_format(pixel_format_, format, type))
     {
-        auto const stride_in_px =
-            stride.as_int() / MIR_BYTES_PER_PIXEL(pixel_format());
+        auto const bytes_per_pixel = MIR_BYTES_PER_PIXEL(pixel_format());
+        auto const stride_in_px = stride.as_int() / bytes_per_pixel;
         /*
          * We assume (as does Weston, AFAICT) that stride is
          * a multiple of whole pixels, but it need not be.
@@ -161,15 +685,35 @@ void mgc::ShmBuffer::upload_to_texture(void const* pixels, geom::Stride const& s
         glPixelStorei(GL_UNPACK_ROW_LENGTH_EXT, stride_in_px);
         glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
-        glTexImage2D(
-            GL_TEXTURE_2D,
-            0,
-            format,
-            size().width.as_int(), size().height.as_int(),
-            0,
-            format,
-            type,
-            pixels);
+        if (area)
+        {
+            // GL_UNPACK_ROW_LENGTH lets us start the upload part way into the buffer
+            auto const first_pixel =
+                static_cast<unsigned char const*>(pixels) +
+                area.value().top().as_int() * stride.as_int() +
+                area.value().left().as_int() * bytes_per_pixel;
+
+            glTexSubImage2D(
+                GL_TEXTURE_2D,
+                0,
+                area.value().left().as_int(), area.value().top().as_int(),
+                area.value().size.width.as_int(), area.value().size.height.as_int(),
+                format,
+                type,
+                first_pixel);
+        }
+        else
+        {
+            glTexImage2D(
+                GL_TEXTURE_2D,
+                0,
+                format,
+                size().width.as_int(), size().height.as_int(),
+                0,
+                format,
+                type,
+                pixels);
+        }
 
         // Be nice to other users of the GL context by reverting our changes to shared state
         glPixelStorei(GL_UNPACK_ROW_LENGTH_EXT, 0);     // 0 is default, meaning “use width”
@@ -189,6 +733,7 @@ void mgc::MemoryBackedShmBuffer::write(unsigned char const* data, size_t data_si
     if (data_size != stride_.as_uint32_t()*size().height.as_uint32_t())
         BOOST_THROW_EXCEPTION(std::logic_error("Size is not equal to number of pixels in buffer"));
     memcpy(pixels.get(), data, data_size);
+    content_written();
 }
 
 void mgc::MemoryBackedShmBuffer::read(std::function<void(unsigned char const*)> const& do_with_pixels)
@@ -196,6 +741,29 @@ void mgc::MemoryBackedShmBuffer::read(std::function<void(unsigned char const*)>
     do_with_pixels(static_cast<unsigned char const*>(pixels.get()));
 }
 
+auto mgc::MemoryBackedShmBuffer::map_readable() -> std::unique_ptr<mrs::Mapping<unsigned char const>>
+{
+    return std::make_unique<DirectMapping<unsigned char const>>(
+        pixels.get(), pixel_format(), stride_, size(), [](){});
+}
+
+auto mgc::MemoryBackedShmBuffer::map_writeable() -> std::unique_ptr<mrs::Mapping<unsigned char>>
+{
+    return std::make_unique<DirectMapping<unsigned char>>(
+        pixels.get(), pixel_format(), stride_, size(), [this]() { content_written(); });
+}
+
+auto mgc::MemoryBackedShmBuffer::map_rw() -> std::unique_ptr<mrs::Mapping<unsigned char>>
+{
+    return map_writeable();
+}
+
+void mgc::MemoryBackedShmBuffer::content_written()
+{
+    std::lock_guard<decltype(uploaded_mutex)> lock{uploaded_mutex};
+    content_changed = true;
+}
+
 mg::NativeBufferBase* mgc::ShmBuffer::native_buffer_base()
 {
     return this;
@@ -203,16 +771,45 @@ mg::NativeBufferBase* mgc::ShmBuffer::native_buffer_base()
 
 void mgc::ShmBuffer::bind()
 {
-    std::lock_guard<decltype(tex_id_mutex)> lock{tex_id_mutex};
-    bool const needs_initialisation = tex_id == 0;
+    // Before locking ours, as this locks the textures it releases
+    SharedTexture::enforce_budget(texture.get());
+
+    std::lock_guard<decltype(texture->mutex)> lock{texture->mutex};
+    texture->add_reader(lock);
+
+    if (texture->upload_fence != EGL_NO_SYNC_KHR)
+    {
+        auto const sync = FenceSync::for_display(texture->fence_display);
+        if (sync->client_wait(texture->fence_display, texture->upload_fence, 0, 0) == EGL_CONDITION_SATISFIED_KHR)
+        {
+            // Done on the GPU, so no context need wait for it now
+            sync->destroy(texture->fence_display, texture->upload_fence);
+            texture->upload_fence = EGL_NO_SYNC_KHR;
+        }
+        else
+        {
+            // The upload was flushed by its context, so (unlike uploads) we can wait on the GPU.
+            // It's kept for any other context that draws from the texture before it's done.
+            sync->wait_for(texture->fence_display, texture->upload_fence);
+        }
+    }
+
+    bind_texture(lock);
+}
+
+void mgc::ShmBuffer::bind_texture(std::lock_guard<std::mutex> const& lock)
+{
+    bool const needs_initialisation = texture->id == 0;
     if (needs_initialisation)
     {
-        glGenTextures(1, &tex_id);
+        glGenTextures(1, &texture->id);
+        texture->created(lock);
     }
-    glBindTexture(GL_TEXTURE_2D, tex_id);
+    texture->used(lock);
+    glBindTexture(GL_TEXTURE_2D, texture->id);
     if (needs_initialisation)
     {
-        // The ShmBuffer *should* be immutable, so we can just upload once.
+        // Each ShmBuffer *should* be immutable, so we only upload each once.
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
@@ -222,12 +819,13 @@ void mgc::ShmBuffer::bind()
 
 void mgc::MemoryBackedShmBuffer::bind()
 {
-    mgc::ShmBuffer::bind();
+    // Bound under the lock, so another output's compositor binding as we upload waits for the upload
     std::lock_guard<decltype(uploaded_mutex)> lock{uploaded_mutex};
-    if (!uploaded)
+    mgc::ShmBuffer::bind();
+    if (texture_needs_upload() || content_changed)
     {
         upload_to_texture(pixels.get(), stride_);
-        uploaded = true;
+        content_changed = false;
     }
 }
 
@@ -256,5 +854,27 @@ auto mgc::ShmBuffer::layout() const -> Layout
 
 void mgc::ShmBuffer::add_syncpoint()
 {
+    std::lock_guard<decltype(texture->mutex)> lock{texture->mutex};
+
+    // Only uploads from other contexts need to know when we're done with the texture
+    if (!texture->needs_fences(lock))
+        return;
+
+    if (auto const sync = FenceSync::for_display(texture->fence_display))
+        texture->add_read_fence(*sync, lock);
+}
+
+void mgc::ShmBuffer::release_texture()
+{
+    {
+        // Without a budget re-uploading on every exposure would cost more than keeping the texture
+        auto& budget = SharedTexture::the_budget();
+        std::lock_guard<std::mutex> lock{budget.mutex};
+        if (!budget.limit)
+            return;
+    }
+
+    std::lock_guard<decltype(texture->mutex)> lock{texture->mutex};
+    texture->release(lock);
 }
 
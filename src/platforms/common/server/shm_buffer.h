@@ -23,14 +23,19 @@
 #include "mir/graphics/buffer_basic.h"
 #include "mir/geometry/dimensions.h"
 #include "mir/geometry/size.h"
+#include "mir/geometry/rectangles.h"
 #include "mir_toolkit/common.h"
 #include "mir/renderer/gl/texture_target.h"
 #include "mir_toolkit/mir_native_buffer.h"
 #include "mir/renderer/sw/pixel_source.h"
 #include "mir/graphics/texture.h"
+#include "mir/memory_account.h"
 
 #include <GLES2/gl2.h>
 
+#include <cstdint>
+#include <experimental/optional>
+#include <memory>
 #include <mutex>
 
 namespace mir
@@ -46,13 +51,22 @@ class EGLContextExecutor;
 class ShmBuffer :
     public BufferBasic,
     public NativeBufferBase,
-    public graphics::gl::Texture
+    public graphics::gl::Texture,
+    public graphics::gl::ReleasableTexture
 {
 public:
     ~ShmBuffer() noexcept override;
 
     static bool supports(MirPixelFormat);
 
+    /**
+     * Limit the GPU memory held by the textures of all ShmBuffers to \a bytes (0, the default, for no limit)
+     *
+     * Past the budget the least recently drawn textures are released, to be
+     * uploaded again (in full) if they are drawn again.
+     */
+    static void set_texture_budget(size_t bytes);
+
     geometry::Size size() const override;
     MirPixelFormat pixel_format() const override;
     NativeBufferBase* native_buffer_base() override;
@@ -61,25 +75,85 @@ public:
     gl::Program const& shader(gl::ProgramFactory& cache) const override;
     Layout layout() const override;
     void add_syncpoint() override;
+    /// Releases the texture if there's a texture budget; without one, textures are kept until their buffers go
+    void release_texture() override;
 protected:
     ShmBuffer(
         geometry::Size const& size,
         MirPixelFormat const& format,
         std::shared_ptr<EGLContextExecutor> egl_delegate);
 
-    /// \note This must be called with a current GL context
+    /**
+     * Construct a buffer replacing the content of \a previous
+     *
+     * If \a previous is a ShmBuffer of the same size and format its texture is
+     * reused, and upload_damage_to_texture() only needs to upload \a damage
+     * (in buffer coordinates, relative to \a previous; nullopt for everything).
+     */
+    ShmBuffer(
+        geometry::Size const& size,
+        MirPixelFormat const& format,
+        std::shared_ptr<EGLContextExecutor> egl_delegate,
+        std::shared_ptr<Buffer> const& previous,
+        std::experimental::optional<geometry::Rectangles> const& damage);
+
+    /// Whether the texture lacks this buffer's content (and anything newer), as it's new or has been released
+    auto texture_needs_upload() const -> bool;
+
+    /// \note This must be called with a current GL context, after bind()
     void upload_to_texture(void const* pixels, geometry::Stride const& stride);
+
+    /// Like upload_to_texture(), but skips whatever the (shared) texture already holds
+    /// \note This must be called with a current GL context, after bind()
+    void upload_damage_to_texture(void const* pixels, geometry::Stride const& stride);
+
+    /// Whether upload_damage_from_shared_context() can be used (it needs EGL_KHR_fence_sync)
+    /// \note This must be called with a current GL context
+    static bool shared_context_uploads_supported();
+
+    /**
+     * Like upload_damage_to_texture(), but from a context other than the
+     * compositor's that shares its textures (such as the EGLContextExecutor's),
+     * so the compositor needn't wait for the upload.
+     *
+     * The upload waits until the compositor has finished with the texture, and
+     * is fenced so that bind() waits (on the GPU where possible) for it.
+     *
+     * \note This must be called with a current GL context, instead of bind()
+     */
+    void upload_damage_from_shared_context(void const* pixels, geometry::Stride const& stride);
 private:
+    class SharedTexture;
+
+    void bind_texture(std::lock_guard<std::mutex> const&);
+    /// Uploads the area that differs between the texture's content and ours
+    void upload_damage(
+        void const* pixels,
+        geometry::Stride const& stride,
+        std::lock_guard<std::mutex> const&);
+
+    void upload_area(
+        void const* pixels,
+        geometry::Stride const& stride,
+        std::experimental::optional<geometry::Rectangle> const& area);
+
     geometry::Size const size_;
     MirPixelFormat const pixel_format_;
-    std::shared_ptr<EGLContextExecutor> const egl_delegate;
-    std::mutex tex_id_mutex;
-    GLuint tex_id{0};
+    std::shared_ptr<SharedTexture> const texture;
+    /// Identifies this buffer's content within the history of the shared texture
+    uint64_t const generation;
 };
 
+/**
+ * An ShmBuffer holding its pixels in server memory
+ *
+ * It maps those pixels directly, so drawing into it (as decorations and cursors
+ * do) needs no copy beyond the upload.
+ */
 class MemoryBackedShmBuffer :
     public ShmBuffer,
-    public renderer::software::PixelSource
+    public renderer::software::PixelSource,
+    public renderer::software::RWMappableBuffer
 {
 public:
     MemoryBackedShmBuffer(
@@ -93,15 +167,24 @@ public:
 
     std::shared_ptr<NativeBuffer> native_buffer_handle() const override;
 
+    /// \note Mappings must not outlive the buffer
+    auto map_readable() -> std::unique_ptr<renderer::software::Mapping<unsigned char const>> override;
+    auto map_writeable() -> std::unique_ptr<renderer::software::Mapping<unsigned char>> override;
+    auto map_rw() -> std::unique_ptr<renderer::software::Mapping<unsigned char>> override;
+
     void bind() override;
 
     MemoryBackedShmBuffer(MemoryBackedShmBuffer const&) = delete;
     MemoryBackedShmBuffer& operator=(MemoryBackedShmBuffer const&) = delete;
 private:
+    /// Notes that the pixels have changed since they were last uploaded
+    void content_written();
+
     geometry::Stride const stride_;
     std::unique_ptr<unsigned char[]> const pixels;
+    MemoryCharge const charge;
     std::mutex uploaded_mutex;
-    bool uploaded{false};
+    bool content_changed{false};
 };
 
 }
@@ -23,7 +23,9 @@
 
 #include "kms-utils/drm_mode_resources.h"
 #include "threaded_drm_event_handler.h"
+#include "frame_scheduler.h"
 
+#include "mir/graphics/atomic_frame.h"
 #include "mir/graphics/display_configuration.h"
 #include "mir/graphics/display_configuration_policy.h"
 #include "mir/graphics/overlapping_output_grouping.h"
@@ -44,6 +46,7 @@
 #include "mir/log.h"
 
 #include <xf86drmMode.h>
+#include <optional>
 #include <sys/ioctl.h>
 #include <system_error>
 #include <poll.h>
@@ -52,6 +55,9 @@
 namespace mg = mir::graphics;
 namespace mge = mir::graphics::eglstream;
 namespace mgk = mir::graphics::kms;
+namespace mgc = mir::graphics::common;
+
+using namespace std::chrono_literals;
 
 #ifndef EGL_NV_output_drm_flip_event
 #define EGL_NV_output_drm_flip_event 1
@@ -60,6 +66,9 @@ namespace mgk = mir::graphics::kms;
 
 namespace
 {
+// Time to allow between finishing a frame and its vblank, as gbm-kms's frame-deadline-margin defaults to
+std::chrono::milliseconds const frame_deadline_margin{3};
+
 EGLConfig choose_config(EGLDisplay display, mg::GLConfig const& requested_config)
 {
     EGLint const config_attr[] = {
@@ -138,15 +147,21 @@ public:
         EGLConfig config,
         std::shared_ptr<mge::DRMEventHandler> event_handler,
         mge::kms::EGLOutput const& output,
+        std::shared_ptr<mg::AtomicFrame> last_frame,
         std::shared_ptr<mg::DisplayReport> display_report)
         : dpy{dpy},
           ctx{create_context(dpy, config, ctx)},
           layer{output.output_layer()},
           crtc_id{output.crtc_id()},
+          output_id{static_cast<unsigned>(output.id.as_value())},
+          frame_interval{
+              output.max_refresh_rate() > 0 ? std::chrono::nanoseconds{1s} / output.max_refresh_rate() : 0ns},
           view_area_{output.extents()},
           transform{output.transformation()},
           drm_node{std::move(drm_node)},
           event_handler{std::move(event_handler)},
+          last_frame_{std::move(last_frame)},
+          scheduler{frame_deadline_margin},
           display_report{std::move(display_report)}
     {
         EGLint const stream_attribs[] = {
@@ -200,6 +215,10 @@ public:
     /* gl::RenderTarget */
     void make_current() override
     {
+        // The compositor makes us current to start rendering (and maybe again later in the frame)
+        if (!render_start)
+            render_start = mir::time::PosixTimestamp::now(CLOCK_MONOTONIC);
+
         if (eglMakeCurrent(dpy, surface, surface, ctx) != EGL_TRUE)
         {
             BOOST_THROW_EXCEPTION(mg::egl_error("Failed to make context current"));
@@ -222,13 +241,23 @@ public:
         }
     }
 
+    void swap_buffers_with_damage(mir::geometry::Rectangles const&) override
+    {
+        // The stream consumer is the scanout engine, which doesn't care about damage
+        swap_buffers();
+    }
+
     mir::geometry::Rectangle view_area() const override
     {
         return view_area_;
     }
 
-    bool overlay(const mir::graphics::RenderableList& /*renderlist*/) override
+    bool overlay(mir::graphics::RenderableList& /*renderlist*/) override
     {
+        /* Client EGLStreams get a GL texture consumer when they're created (see
+         * BoundEGLStream), and a stream can't change its consumer, so there's
+         * nothing we could attach to our output layer in place of output_stream.
+         */
         return false;
     }
 
@@ -249,19 +278,24 @@ public:
 
     void post() override
     {
+        if (render_start)
+        {
+            // The frame has been swapped into output_stream, so this is the CPU's part of rendering it
+            scheduler.record_render_time(mir::time::PosixTimestamp::now(CLOCK_MONOTONIC) - *render_start);
+            render_start = std::nullopt;
+        }
+
         // Wait for the last flip to finish, if it hasn't already.
         pending_flip.get();
 
         pending_flip = event_handler->expect_flip_event(
             crtc_id,
-            [this](unsigned frame_count, std::chrono::milliseconds frame_time)
+            [this](unsigned frame_count, std::chrono::nanoseconds frame_time)
             {
                 // TODO: Um, why does NVIDIA always call this with 0, 0ms?
-                display_report->report_vsync(
-                    crtc_id,
-                    mg::Frame {
-                        frame_count,
-                        mir::time::PosixTimestamp(CLOCK_MONOTONIC, frame_time)});
+                mg::Frame const frame{frame_count, mir::time::PosixTimestamp(CLOCK_MONOTONIC, frame_time), true};
+                last_frame_->store(frame);
+                display_report->report_vsync(output_id, frame);
             });
 
         EGLAttrib const acquire_attribs[] = {
@@ -280,7 +314,21 @@ public:
 
     std::chrono::milliseconds recommended_sleep() const override
     {
-        return std::chrono::milliseconds{0};
+        /*
+         * Start the next frame as late as we can while still finishing it for the
+         * next vblank we can make; a flip still pending takes the next one.
+         */
+        bool const flip_pending = pending_flip.wait_for(0ns) != std::future_status::ready;
+        std::vector<mgc::FrameScheduler::OutputTiming> timings;
+        if (frame_interval > 0ns)
+            timings.push_back({last_frame_->load(), frame_interval, false});
+        return scheduler.delay_before_next_frame(
+            mir::time::PosixTimestamp::now(CLOCK_MONOTONIC), timings, flip_pending, true);
+    }
+
+    mg::Frame last_frame() const override
+    {
+        return last_frame_->load();
     }
 
 private:
@@ -289,6 +337,8 @@ private:
     EGLContext ctx;
     EGLOutputLayerEXT layer;
     uint32_t crtc_id;
+    unsigned const output_id;
+    std::chrono::nanoseconds const frame_interval;
     mir::geometry::Rectangle const view_area_;
     glm::mat2 const transform;
     EGLStreamKHR output_stream;
@@ -296,6 +346,9 @@ private:
     mir::Fd const drm_node;
     std::shared_ptr<mge::DRMEventHandler> const event_handler;
     std::future<void> pending_flip;
+    std::shared_ptr<mg::AtomicFrame> const last_frame_;
+    mgc::FrameScheduler scheduler;
+    std::optional<mir::time::PosixTimestamp> render_start;
     mg::EGLExtensions::LazyDisplayExtensions<mg::EGLExtensions::NVStreamAttribExtensions> nv_stream;
     std::shared_ptr<mg::DisplayReport> const display_report;
 };
@@ -368,6 +421,16 @@ void mge::Display::configure(DisplayConfiguration const& conf)
              if (output.used)
              {
                  const_cast<kms::EGLOutput&>(output).configure(output.current_mode_index);
+
+                 std::shared_ptr<AtomicFrame> last_frame;
+                 {
+                     std::lock_guard<std::mutex> lock{frames_mutex};
+                     auto& frame = last_frames[output.id.as_value()];
+                     if (!frame)
+                         frame = std::make_shared<AtomicFrame>();
+                     last_frame = frame;
+                 }
+
                  active_sync_groups.emplace_back(
                      std::make_unique<::DisplayBuffer>(
                          drm_node,
@@ -376,11 +439,30 @@ void mge::Display::configure(DisplayConfiguration const& conf)
                          config,
                          event_handler,
                          output,
+                         std::move(last_frame),
                          display_report));
              }
          });
 }
 
+void mge::Display::configure_incrementally(
+    DisplayConfiguration const& conf,
+    std::function<void(mg::DisplaySyncGroup&)> const& release)
+{
+    // Configuring replaces all the display buffers
+    for_each_display_sync_group(release);
+    configure(conf);
+}
+
+bool mge::Display::apply_if_configuration_only_changes_power_modes(
+    DisplayConfiguration const& /*conf*/,
+    std::function<void(mg::DisplaySyncGroup&)> const& /*suspend*/,
+    std::function<void(mg::DisplaySyncGroup&)> const& /*resume*/)
+{
+    // Power modes are set by configure(), which replaces all the display buffers
+    return false;
+}
+
 namespace
 {
 std::unique_ptr<mir::udev::Monitor> create_drm_monitor()
@@ -520,12 +602,9 @@ bool mge::Display::apply_if_configuration_preserves_display_buffers(
     return false;
 }
 
-mg::Frame mge::Display::last_frame_on(unsigned) const
+mg::Frame mge::Display::last_frame_on(unsigned output_id) const
 {
-    /*
-     * TODO: Implement this later when we have the hardware + driver to test on.
-     *       If no proper hardware counters are available, just call
-     *       AtomicFrame.increment_now() in post() above.
-     */
-    return {};
+    std::lock_guard<std::mutex> lock{frames_mutex};
+    auto const frame = last_frames.find(output_id);
+    return frame != last_frames.end() ? frame->second->load() : Frame{};
 }
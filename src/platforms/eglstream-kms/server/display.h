@@ -25,11 +25,13 @@
 #include "mir/renderer/gl/context_source.h"
 
 #include <mutex>
+#include <unordered_map>
 
 namespace mir
 {
 namespace graphics
 {
+class AtomicFrame;
 class DisplayConfigurationPolicy;
 class GLConfig;
 class DisplayReport;
@@ -55,6 +57,14 @@ public:
     bool apply_if_configuration_preserves_display_buffers(DisplayConfiguration const& conf) override;
 
     void configure(DisplayConfiguration const& conf) override;
+    void configure_incrementally(
+        DisplayConfiguration const& conf,
+        std::function<void(DisplaySyncGroup&)> const& release) override;
+
+    bool apply_if_configuration_only_changes_power_modes(
+        DisplayConfiguration const& conf,
+        std::function<void(DisplaySyncGroup&)> const& suspend,
+        std::function<void(DisplaySyncGroup&)> const& resume) override;
 
     void register_configuration_change_handler(EventHandlerRegister& handlers,
         DisplayConfigurationChangeHandler const& conf_change_handler) override;
@@ -84,6 +94,10 @@ private:
 
     std::shared_ptr<DRMEventHandler> const event_handler;
     std::vector<std::unique_ptr<DisplaySyncGroup>> active_sync_groups;
+
+    std::mutex mutable frames_mutex;
+    /// The last frame on each output id, kept across reconfiguration
+    std::unordered_map<unsigned, std::shared_ptr<AtomicFrame>> last_frames;
     std::shared_ptr<DisplayConfigurationPolicy> const configuration_policy;
     std::shared_ptr<DisplayReport> const display_report;
 };
@@ -19,6 +19,8 @@
 #ifndef MIR_PLATFORM_EGLSTREAM_DRM_EVENT_HANDLER_H_
 #define MIR_PLATFORM_EGLSTREAM_DRM_EVENT_HANDLER_H_
 
+#include <chrono>
+#include <functional>
 #include <future>
 
 namespace mir
@@ -39,9 +41,13 @@ public:
     virtual void const* drm_event_data() const = 0;
 
     using KMSCrtcId = uint32_t;
+    /**
+     * \param on_flip  Called from the event thread with the frame's sequence number and
+     *                  its vblank's CLOCK_MONOTONIC timestamp
+     */
     virtual std::future<void> expect_flip_event(
         KMSCrtcId id,
-        std::function<void(unsigned int frame_number, std::chrono::milliseconds frame_time)> on_flip) = 0;
+        std::function<void(unsigned int frame_number, std::chrono::nanoseconds frame_time)> on_flip) = 0;
 };
 }
 }
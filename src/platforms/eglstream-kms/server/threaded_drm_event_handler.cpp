@@ -80,7 +80,7 @@ private:
 
 std::future<void> mge::ThreadedDRMEventHandler::expect_flip_event(
     DRMEventHandler::KMSCrtcId id,
-    std::function<void(unsigned int frame_number, std::chrono::milliseconds frame_time)> on_flip)
+    std::function<void(unsigned int frame_number, std::chrono::nanoseconds frame_time)> on_flip)
 {
     NotifyOnScopeExit notifier{expectations_changed};
     std::lock_guard<std::mutex> lock{expectation_mutex};
@@ -197,7 +197,7 @@ void mge::ThreadedDRMEventHandler::flip_handler(
         {
             slot->callback(
                 frame_number,
-                std::chrono::seconds{sec} + std::chrono::milliseconds{usec});
+                std::chrono::seconds{sec} + std::chrono::microseconds{usec});
             slot->completion.set_value();
             slot = {};
             return;
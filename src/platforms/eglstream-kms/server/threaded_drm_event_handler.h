@@ -45,7 +45,7 @@ public:
 
     std::future<void> expect_flip_event(
         KMSCrtcId id,
-        std::function<void(unsigned int, std::chrono::milliseconds)> on_flip) override;
+        std::function<void(unsigned int, std::chrono::nanoseconds)> on_flip) override;
 
 private:
     void event_loop() noexcept;
@@ -63,7 +63,7 @@ private:
     struct FlipEventData
     {
         KMSCrtcId id;
-        std::function<void(unsigned int, std::chrono::milliseconds)> callback;
+        std::function<void(unsigned int, std::chrono::nanoseconds)> callback;
         std::promise<void> completion;
     };
     // We *could* do something fancy and lock-free, but a basic mutex will suffice for now
@@ -146,19 +146,19 @@ void mie::LibInputDevice::process_event(libinput_event* event)
         switch(libinput_event_get_type(event))
         {
         case LIBINPUT_EVENT_KEYBOARD_KEY:
-            sink->handle_input(convert_event(libinput_event_get_keyboard_event(event)));
+            deliver(convert_event(libinput_event_get_keyboard_event(event)));
             break;
         case LIBINPUT_EVENT_POINTER_MOTION:
-            sink->handle_input(convert_motion_event(libinput_event_get_pointer_event(event)));
+            deliver(convert_motion_event(libinput_event_get_pointer_event(event)));
             break;
         case LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE:
-            sink->handle_input(convert_absolute_motion_event(libinput_event_get_pointer_event(event)));
+            deliver(convert_absolute_motion_event(libinput_event_get_pointer_event(event)));
             break;
         case LIBINPUT_EVENT_POINTER_BUTTON:
-            sink->handle_input(convert_button_event(libinput_event_get_pointer_event(event)));
+            deliver(convert_button_event(libinput_event_get_pointer_event(event)));
             break;
         case LIBINPUT_EVENT_POINTER_AXIS:
-            sink->handle_input(convert_axis_event(libinput_event_get_pointer_event(event)));
+            deliver(convert_axis_event(libinput_event_get_pointer_event(event)));
             break;
         // touch events are processed as a batch of changes over all touch pointts
         case LIBINPUT_EVENT_TOUCH_DOWN:
@@ -176,7 +176,7 @@ void mie::LibInputDevice::process_event(libinput_event* event)
         case LIBINPUT_EVENT_TOUCH_FRAME:
             if (is_output_active())
             {
-                sink->handle_input(convert_touch_frame(libinput_event_get_touch_event(event)));
+                deliver(convert_touch_frame(libinput_event_get_touch_event(event)));
             }
             break;
         default:
@@ -189,6 +189,41 @@ void mie::LibInputDevice::process_event(libinput_event* event)
     }
 }
 
+void mie::LibInputDevice::process_events(std::vector<libinput_event*> const& events)
+{
+    if (!sink)
+        return;
+
+    batching = true;
+    batch.reserve(events.size());
+    for (auto const event : events)
+        process_event(event);
+    batching = false;
+
+    if (!batch.empty())
+    {
+        auto const delivering = std::move(batch);
+        batch.clear();
+
+        try
+        {
+            sink->handle_input_batch(delivering);
+        }
+        catch(std::exception const& error)
+        {
+            mir::log_error("Failure processing input events received from libinput: " + boost::diagnostic_information(error));
+        }
+    }
+}
+
+void mie::LibInputDevice::deliver(EventUPtr event)
+{
+    if (batching)
+        batch.push_back(std::move(event));
+    else
+        sink->handle_input(std::move(event));
+}
+
 mir::EventUPtr mie::LibInputDevice::convert_event(libinput_event_keyboard* keyboard)
 {
     std::chrono::nanoseconds const time = std::chrono::microseconds(libinput_event_keyboard_get_time_usec(keyboard));
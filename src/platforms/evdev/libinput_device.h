@@ -64,10 +64,13 @@ public:
     void apply_settings(TouchscreenSettings const&) override;
 
     void process_event(libinput_event* event);
+    /// Processes consecutive events for this device, handing the results to the sink as a single batch
+    void process_events(std::vector<libinput_event*> const& events);
     ::libinput_device* device() const;
     ::libinput_device_group* group();
     void add_device_of_group(LibInputDevicePtr ptr);
 private:
+    void deliver(EventUPtr event);
     EventUPtr convert_event(libinput_event_keyboard* keyboard);
     EventUPtr convert_button_event(libinput_event_pointer* pointer);
     EventUPtr convert_motion_event(libinput_event_pointer* pointer);
@@ -89,6 +92,9 @@ private:
 
     InputSink* sink{nullptr};
     EventBuilder* builder{nullptr};
+    /// Collects the events converted by process_events(), which then delivers them together
+    std::vector<std::shared_ptr<MirEvent>> batch;
+    bool batching{false};
 
     InputDeviceInfo info;
     mir::geometry::Point pointer_pos;
@@ -130,11 +130,13 @@ mie::Platform::Platform(
         std::shared_ptr<InputDeviceRegistry> const& registry,
         std::shared_ptr<InputReport> const& report,
         std::unique_ptr<udev::Context>&& udev_context,
-        std::shared_ptr<ConsoleServices> const& console) :
+        std::shared_ptr<ConsoleServices> const& console,
+        std::string const& seat) :
     report(report),
     udev_context(std::move(udev_context)),
     input_device_registry(registry),
     console{console},
+    seat{seat},
     platform_dispatchable{std::make_shared<md::MultiplexingDispatchable>()}
 {
 }
@@ -316,6 +318,11 @@ void mie::Platform::start()
                         {
                             return;
                         }
+                        // Devices udev assigned to other seats are for other servers
+                        if (mu::seat_of(*workaround_device) != seat)
+                        {
+                            return;
+                        }
                         if (pending_devices.count(workaround_device->devnum()) > 0 ||
                             device_watchers.count(workaround_device->devnum()) > 0)
                         {
@@ -380,6 +387,25 @@ void mie::Platform::process_input_events()
         return EventType(libinput_get_event(lilib), libinput_event_destroy);
     };
 
+    // Consecutive events for the same device (such as the contacts of a busy touchscreen) are handed over together,
+    // so the seat takes its locks once per run instead of once per event.
+    std::shared_ptr<LibInputDevice> run_device;
+    std::vector<EventType> run;
+    std::vector<libinput_event*> run_events;
+    auto const process_run = [&]
+        {
+            if (run_device && !run.empty())
+            {
+                run_events.clear();
+                for (auto const& event : run)
+                    run_events.push_back(event.get());
+
+                run_device->process_events(run_events);
+            }
+            run.clear();
+            run_device.reset();
+        };
+
     while(auto ev = next_event())
     {
         auto type = libinput_event_get_type(ev.get());
@@ -387,19 +413,30 @@ void mie::Platform::process_input_events()
 
         if (type == LIBINPUT_EVENT_DEVICE_ADDED)
         {
+            process_run();
             device_added(device);
         }
         else if(type == LIBINPUT_EVENT_DEVICE_REMOVED)
         {
+            process_run();
             device_removed(device);
         }
         else
         {
             auto dev = find_device(device);
             if (dev != end(devices))
-                (*dev)->process_event(ev.get());
+            {
+                if (*dev != run_device)
+                {
+                    process_run();
+                    run_device = *dev;
+                }
+                run.push_back(std::move(ev));
+            }
         }
     }
+
+    process_run();
 }
 
 void mie::Platform::pause_for_config()
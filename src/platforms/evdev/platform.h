@@ -28,6 +28,7 @@
 
 #include <sys/stat.h>
 
+#include <string>
 #include <vector>
 #include <unordered_map>
 #include <future>
@@ -63,7 +64,8 @@ public:
         std::shared_ptr<InputDeviceRegistry> const& registry,
         std::shared_ptr<InputReport> const& report,
         std::unique_ptr<udev::Context>&& udev_context,
-        std::shared_ptr<ConsoleServices> const& console);
+        std::shared_ptr<ConsoleServices> const& console,
+        std::string const& seat = "seat0");
     std::shared_ptr<mir::dispatch::Dispatchable> dispatchable() override;
     void start() override;
     void stop() override;
@@ -81,6 +83,8 @@ private:
     std::shared_ptr<udev::Context> const udev_context;
     std::shared_ptr<InputDeviceRegistry> const input_device_registry;
     std::shared_ptr<ConsoleServices> const console;
+    /// The seat whose devices we use
+    std::string const seat;
     std::shared_ptr<dispatch::MultiplexingDispatchable> const platform_dispatchable;
     std::shared_ptr<::libinput> lib;
     std::shared_ptr<dispatch::ReadableFd> libinput_dispatchable;
@@ -21,6 +21,8 @@
 #include "mir/fd.h"
 #include "mir/assert_module_entry_point.h"
 #include "mir/libname.h"
+#include "mir/options/configuration.h"
+#include "mir/options/option.h"
 
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -104,7 +106,7 @@ bool can_open_input_devices(mir::ConsoleServices& console)
 }
 
 mir::UniqueModulePtr<mi::Platform> create_input_platform(
-    mo::Option const& /*options*/,
+    mo::Option const& options,
     std::shared_ptr<mir::EmergencyCleanupRegistry> const& /*emergency_cleanup_registry*/,
     std::shared_ptr<mi::InputDeviceRegistry> const& input_device_registry,
     std::shared_ptr<mir::ConsoleServices> const& console,
@@ -115,7 +117,8 @@ mir::UniqueModulePtr<mi::Platform> create_input_platform(
         input_device_registry,
         report,
         std::make_unique<mu::Context>(),
-        console);
+        console,
+        options.get<std::string>(mir::options::seat_opt));
 }
 
 void add_input_platform_options(
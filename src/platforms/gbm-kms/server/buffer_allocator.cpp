@@ -239,6 +239,7 @@ mgg::BufferAllocator::BufferAllocator(
     BypassOption bypass_option,
     mgg::BufferImportMethod const buffer_import_method)
     : ctx{context_for_output(output)},
+      scanout_targets{dynamic_cast<ScanoutTargets const*>(&output)},
       egl_delegate{
           std::make_shared<mgc::EGLContextExecutor>(context_for_output(output))},
       device(device),
@@ -320,6 +321,7 @@ void mgg::BufferAllocator::bind_display(wl_display* display, std::shared_ptr<Exe
                     dpy,
                     egl_extensions,
                     modifier_ext,
+                    wayland_executor,
                 },
                 [wayland_executor](LinuxDmaBufUnstable* global)
                 {
@@ -390,14 +392,32 @@ std::shared_ptr<mg::Buffer> mgg::BufferAllocator::buffer_from_resource(
         wayland_executor);
 }
 
+void mgg::BufferAllocator::surface_placed(
+    wl_resource* surface,
+    std::experimental::optional<ScanoutPlacement> const& placement)
+{
+    if (!dmabuf_extension)
+        return;
+
+    std::experimental::optional<LinuxDmaBufUnstable::ScanoutTranche> tranche;
+    if (placement && scanout_targets && bypass_option == BypassOption::allowed)
+        tranche = scanout_targets->scanout_tranche(placement->output_area, placement->fullscreen);
+
+    dmabuf_extension->set_scanout_tranche(surface, tranche);
+}
+
 auto mgg::BufferAllocator::buffer_from_shm(
     wl_resource* buffer,
     std::shared_ptr<Executor> wayland_executor,
-    std::function<void()>&& on_consumed) -> std::shared_ptr<Buffer>
+    std::function<void()>&& on_consumed,
+    std::shared_ptr<Buffer> const& previous,
+    std::experimental::optional<geom::Rectangles> const& damage) -> std::shared_ptr<Buffer>
 {
     return mg::wayland::buffer_from_wl_shm(
         buffer,
         std::move(wayland_executor),
         egl_delegate,
-        std::move(on_consumed));
+        std::move(on_consumed),
+        previous,
+        damage);
 }
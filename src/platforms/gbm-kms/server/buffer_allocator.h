@@ -63,6 +63,27 @@ enum class BufferImportMethod
     dma_buf
 };
 
+/// Something, such as the Display, that knows which buffers its outputs can scan out
+class ScanoutTargets
+{
+public:
+    virtual ~ScanoutTargets() = default;
+
+    /**
+     * The buffers the output showing exactly \a output_area could scan out a surface
+     * placed on it from: on its primary plane if \a fullscreen, otherwise on an overlay plane
+     *
+     * \return  nullopt if no output shows \a output_area
+     */
+    virtual auto scanout_tranche(geometry::Rectangle const& output_area, bool fullscreen) const
+        -> std::experimental::optional<LinuxDmaBufUnstable::ScanoutTranche> = 0;
+
+protected:
+    ScanoutTargets() = default;
+    ScanoutTargets(ScanoutTargets const&) = delete;
+    ScanoutTargets& operator=(ScanoutTargets const&) = delete;
+};
+
 class BufferAllocator:
     public graphics::GraphicBufferAllocator
 {
@@ -85,12 +106,19 @@ public:
     auto buffer_from_shm(
         wl_resource* buffer,
         std::shared_ptr<Executor> wayland_executor,
-        std::function<void()>&& on_consumed) -> std::shared_ptr<Buffer> override;
+        std::function<void()>&& on_consumed,
+        std::shared_ptr<Buffer> const& previous,
+        std::experimental::optional<geometry::Rectangles> const& damage) -> std::shared_ptr<Buffer> override;
+    void surface_placed(
+        wl_resource* surface,
+        std::experimental::optional<ScanoutPlacement> const& placement) override;
 private:
     std::shared_ptr<Buffer> alloc_hardware_buffer(
         graphics::BufferProperties const& buffer_properties);
 
     std::shared_ptr<renderer::gl::Context> const ctx;
+    /// Null if the display isn't ours
+    ScanoutTargets const* const scanout_targets;
     std::shared_ptr<common::EGLContextExecutor> const egl_delegate;
     std::shared_ptr<Executor> wayland_executor;
     std::unique_ptr<LinuxDmaBufUnstable, std::function<void(LinuxDmaBufUnstable*)>> dmabuf_extension;
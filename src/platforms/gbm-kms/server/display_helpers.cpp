@@ -54,7 +54,8 @@ namespace mgmh = mir::graphics::gbm::helpers;
 std::vector<std::shared_ptr<mgmh::DRMHelper>>
 mgmh::DRMHelper::open_all_devices(
     std::shared_ptr<mir::udev::Context> const& udev,
-    mir::ConsoleServices& console)
+    mir::ConsoleServices& console,
+    std::string const& seat)
 {
     int error = ENODEV; //Default error is "there are no DRM devices"
 
@@ -68,6 +69,12 @@ mgmh::DRMHelper::open_all_devices(
 
     for(auto& device : devices)
     {
+        // Other seats' GPUs are for the servers running on those seats
+        if (mir::udev::seat_of(device) != seat)
+        {
+            continue;
+        }
+
         mir::Fd tmp_fd;
         std::unique_ptr<mir::Device> device_handle;
         try
@@ -348,8 +355,33 @@ mgmh::GBMHelper::GBMHelper(mir::Fd const& drm_fd)
 mgg::GBMSurfaceUPtr mgmh::GBMHelper::create_scanout_surface(
     uint32_t width,
     uint32_t height,
-    bool sharable) const
+    bool sharable,
+    std::vector<uint64_t> const& modifiers) const
 {
+    auto gbm_surface_deleter = [](gbm_surface *p) { if (p) gbm_surface_destroy(p); };
+
+#ifndef MIR_NO_GBM_MODIFIERS
+    /*
+     * Let the driver pick the best layout the outputs can scan out of, such as
+     * a tiled or compressed one. That saves a lot of memory bandwidth over the
+     * linear layouts we would otherwise be likely to get.
+     */
+    if (!sharable && !modifiers.empty())
+    {
+        GBMSurfaceUPtr surface{
+            gbm_surface_create_with_modifiers(
+                device, width, height, GBM_FORMAT_XRGB8888, modifiers.data(), modifiers.size()),
+            gbm_surface_deleter};
+
+        if (surface)
+            return surface;
+
+        mir::log_info("Failed to create GBM scanout surface with modifiers; falling back to implicit layout");
+    }
+#else
+    (void)modifiers;
+#endif
+
     auto format_flags = GBM_BO_USE_RENDERING | GBM_BO_USE_SCANOUT;
 
     if (sharable)
@@ -369,7 +401,6 @@ mgg::GBMSurfaceUPtr mgmh::GBMHelper::create_scanout_surface(
                                           GBM_FORMAT_XRGB8888,
                                           format_flags);
 
-    auto gbm_surface_deleter = [](gbm_surface *p) { if (p) gbm_surface_destroy(p); };
     GBMSurfaceUPtr surface{surface_raw, gbm_surface_deleter};
 
     if (!surface)
@@ -64,7 +64,8 @@ public:
 
     static std::vector<std::shared_ptr<DRMHelper>> open_all_devices(
         std::shared_ptr<mir::udev::Context> const& udev,
-        mir::ConsoleServices& console);
+        mir::ConsoleServices& console,
+        std::string const& seat = "seat0");
 
     static std::unique_ptr<DRMHelper> open_any_render_node(
         std::shared_ptr<mir::udev::Context> const& udev);
@@ -92,7 +93,15 @@ public:
     GBMHelper(const GBMHelper&) = delete;
     GBMHelper& operator=(const GBMHelper&) = delete;
 
-    GBMSurfaceUPtr create_scanout_surface(uint32_t width, uint32_t height, bool sharable) const;
+    /**
+     * \param [in] modifiers   The layouts the outputs can scan out of, best first. If empty
+     *                          (or \a sharable) the driver chooses without being told.
+     */
+    GBMSurfaceUPtr create_scanout_surface(
+        uint32_t width,
+        uint32_t height,
+        bool sharable,
+        std::vector<uint64_t> const& modifiers) const;
 
     gbm_device* const device;
 };
@@ -40,6 +40,11 @@ namespace mgg=mir::graphics::gbm;
 namespace mgc = mir::graphics::common;
 namespace geom=mir::geometry;
 
+namespace
+{
+mir::MemoryAccount gbm_buffers{"buffers", "gbm"};
+}
+
 void mgg::BindResolverTex::bind()
 {
     tex_bind();
@@ -55,7 +60,8 @@ mgg::GBMBuffer::GBMBuffer(std::shared_ptr<gbm_bo> const& handle,
                           std::unique_ptr<mgc::BufferTextureBinder> texture_binder)
     : gbm_handle{handle},
       texture_binder{std::move(texture_binder)},
-      prime_fd{-1}
+      prime_fd{-1},
+      charge{gbm_buffers, static_cast<size_t>(gbm_bo_get_stride(handle.get())) * gbm_bo_get_height(handle.get())}
 {
     auto device = gbm_bo_get_device(gbm_handle.get());
     auto gem_handle = gbm_bo_get_handle(gbm_handle.get()).u32;
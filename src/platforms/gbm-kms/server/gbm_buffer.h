@@ -24,6 +24,7 @@
 #include "mir/renderer/gl/texture_source.h"
 #include "mir/renderer/gl/texture_target.h"
 #include "mir/graphics/texture.h"
+#include "mir/memory_account.h"
 
 #include <gbm.h>
 #include <GLES2/gl2.h>
@@ -113,6 +114,7 @@ private:
     std::shared_ptr<gbm_bo> const gbm_handle;
     std::unique_ptr<common::BufferTextureBinder> const texture_binder;
     int prime_fd;
+    MemoryCharge const charge;
 
     std::mutex tex_id_mutex;
     GLuint tex_id{0};
@@ -0,0 +1,739 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "atomic_kms_output.h"
+#include "page_flipper.h"
+#include "mir/fatal.h"
+#include "mir/log.h"
+
+#include <boost/throw_exception.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include <xf86drm.h>
+
+namespace mg = mir::graphics;
+namespace mgg = mg::gbm;
+namespace mgk = mg::kms;
+namespace geom = mir::geometry;
+
+class mgg::AtomicKMSOutput::Request
+{
+public:
+    Request()
+        : request{drmModeAtomicAlloc(), &drmModeAtomicFree}
+    {
+        if (!request)
+            BOOST_THROW_EXCEPTION(std::runtime_error{"Failed to allocate atomic KMS request"});
+    }
+
+    void add(uint32_t object_id, mgk::ObjectProperties const& props, char const* property, uint64_t value)
+    {
+        if (drmModeAtomicAddProperty(request.get(), object_id, props.id_for(property), value) < 0)
+            BOOST_THROW_EXCEPTION(std::runtime_error{std::string{"Failed to add "} + property + " to atomic KMS request"});
+    }
+
+    auto commit(int drm_fd, uint32_t flags) -> int
+    {
+        return drmModeAtomicCommit(drm_fd, request.get(), flags, nullptr);
+    }
+
+    auto get() const -> drmModeAtomicReq*
+    {
+        return request.get();
+    }
+
+private:
+    std::unique_ptr<drmModeAtomicReq, void(*)(drmModeAtomicReqPtr)> const request;
+};
+
+namespace
+{
+/// KMS plane SRC_* properties are 16.16 fixed point
+auto to_fixed_16_16(float value) -> uint64_t
+{
+    return static_cast<uint64_t>(value * 65536.0f);
+}
+
+bool same_overlays(std::vector<mgg::Overlay> const& a, std::vector<mgg::Overlay> const& b)
+{
+    return std::equal(
+        a.begin(), a.end(), b.begin(), b.end(),
+        [](mgg::Overlay const& x, mgg::Overlay const& y)
+        {
+            return x.fb == y.fb && x.source == y.source && x.destination == y.destination &&
+                x.rotation == y.rotation;
+        });
+}
+
+bool supports_async_atomic_flips(int drm_fd)
+{
+#ifdef DRM_CAP_ATOMIC_ASYNC_PAGE_FLIP
+    uint64_t supported{0};
+    return drmGetCap(drm_fd, DRM_CAP_ATOMIC_ASYNC_PAGE_FLIP, &supported) == 0 && supported;
+#else
+    (void)drm_fd;
+    return false;
+#endif
+}
+}
+
+mgg::AtomicKMSOutput::AtomicKMSOutput(
+    int drm_fd,
+    kms::DRMModeConnectorUPtr&& connector,
+    std::shared_ptr<PageFlipper> const& page_flipper)
+    : RealKMSOutput(drm_fd, std::move(connector), page_flipper),
+      connector_props{drm_fd, id(), DRM_MODE_OBJECT_CONNECTOR},
+      async_atomic_flips{supports_async_atomic_flips(drm_fd)}
+{
+}
+
+mgg::AtomicKMSOutput::~AtomicKMSOutput()
+{
+    uint32_t cursor_update_crtc;
+    {
+        // So a callback already on its way won't schedule another update
+        std::lock_guard<std::mutex> lock{plane_mutex};
+        cursor_dirty = false;
+        cursor_update_crtc = cursor_update_crtc_id;
+    }
+    // Without plane_mutex, which the cursor update's callback needs
+    if (cursor_update_crtc)
+        page_flipper->cancel_cursor_update(cursor_update_crtc);
+
+    if (mode_blob_id)
+        drmModeDestroyPropertyBlob(drm_fd_, mode_blob_id);
+}
+
+void mgg::AtomicKMSOutput::update_planes()
+{
+    if (!current_crtc || planes_crtc_id == current_crtc->crtc_id)
+        return;
+
+    auto const crtc_id = current_crtc->crtc_id;
+    planes = mgk::find_planes_for_crtc(drm_fd_, crtc_id);
+    crtc_props = std::make_unique<mgk::ObjectProperties>(drm_fd_, crtc_id, DRM_MODE_OBJECT_CRTC);
+    primary_props = planes.primary ? std::make_unique<mgk::ObjectProperties>(drm_fd_, planes.primary) : nullptr;
+    cursor_props = planes.cursor ? std::make_unique<mgk::ObjectProperties>(drm_fd_, planes.cursor) : nullptr;
+    planes_crtc_id = crtc_id;
+
+    auto const zpos = [](mgk::ObjectProperties const& props) -> uint64_t
+        {
+            return props.has_property("zpos") ? props["zpos"] : 0;
+        };
+
+    overlay_planes.clear();
+    for (auto const& plane : planes.overlays)
+    {
+        OverlayPlane overlay{plane->plane_id, std::make_unique<mgk::ObjectProperties>(drm_fd_, plane)};
+
+        // Some hardware stacks its "overlays" beneath the primary plane, where we would hide them
+        if (primary_props && primary_props->has_property("zpos") && overlay.props->has_property("zpos") &&
+            zpos(*overlay.props) <= zpos(*primary_props))
+        {
+            continue;
+        }
+        overlay_planes.push_back(std::move(overlay));
+    }
+    std::stable_sort(
+        overlay_planes.begin(), overlay_planes.end(),
+        [&zpos](OverlayPlane const& a, OverlayPlane const& b) { return zpos(*a.props) < zpos(*b.props); });
+
+    // The new CRTC's planes have none of our state yet
+    cursor_dirty = true;
+    overlays.clear();
+    overlays_dirty = true;
+    primary_rotation = DRM_MODE_ROTATE_0;
+    primary_rotation_dirty = true;
+}
+
+void mgg::AtomicKMSOutput::add_primary_plane(Request& request, FBHandle const& fb) const
+{
+    auto const plane_id = planes.primary->plane_id;
+    auto const& mode = connector->modes[mode_index];
+    // A quarter turn scans out the buffer's columns as the mode's rows
+    auto const quarter_turn = (primary_rotation & (DRM_MODE_ROTATE_90 | DRM_MODE_ROTATE_270)) != 0;
+    uint64_t const src_width = quarter_turn ? mode.vdisplay : mode.hdisplay;
+    uint64_t const src_height = quarter_turn ? mode.hdisplay : mode.vdisplay;
+
+    request.add(plane_id, *primary_props, "FB_ID", drm_fb_id(fb));
+    request.add(plane_id, *primary_props, "CRTC_ID", current_crtc->crtc_id);
+    if (primary_props->has_property("rotation"))
+        request.add(plane_id, *primary_props, "rotation", primary_rotation);
+
+    /* Source viewport. Coordinates are 16.16 fixed point format */
+    request.add(plane_id, *primary_props, "SRC_X", static_cast<uint64_t>(fb_offset.dx.as_int()) << 16);
+    request.add(plane_id, *primary_props, "SRC_Y", static_cast<uint64_t>(fb_offset.dy.as_int()) << 16);
+    request.add(plane_id, *primary_props, "SRC_W", src_width << 16);
+    request.add(plane_id, *primary_props, "SRC_H", src_height << 16);
+
+    /* Destination viewport. Coordinates are *not* 16.16 */
+    request.add(plane_id, *primary_props, "CRTC_X", 0);
+    request.add(plane_id, *primary_props, "CRTC_Y", 0);
+    request.add(plane_id, *primary_props, "CRTC_W", mode.hdisplay);
+    request.add(plane_id, *primary_props, "CRTC_H", mode.vdisplay);
+}
+
+void mgg::AtomicKMSOutput::add_cursor_plane(Request& request) const
+{
+    auto const plane_id = planes.cursor->plane_id;
+
+    if (!cursor_fb)
+    {
+        request.add(plane_id, *cursor_props, "FB_ID", 0);
+        request.add(plane_id, *cursor_props, "CRTC_ID", 0);
+        return;
+    }
+
+    auto const width = cursor_size.width.as_uint32_t();
+    auto const height = cursor_size.height.as_uint32_t();
+
+    request.add(plane_id, *cursor_props, "FB_ID", drm_fb_id(*cursor_fb));
+    request.add(plane_id, *cursor_props, "CRTC_ID", current_crtc->crtc_id);
+    request.add(plane_id, *cursor_props, "SRC_X", 0);
+    request.add(plane_id, *cursor_props, "SRC_Y", 0);
+    request.add(plane_id, *cursor_props, "SRC_W", static_cast<uint64_t>(width) << 16);
+    request.add(plane_id, *cursor_props, "SRC_H", static_cast<uint64_t>(height) << 16);
+
+    // CRTC_X and CRTC_Y are signed, and may well be negative for a cursor
+    request.add(plane_id, *cursor_props, "CRTC_X", static_cast<uint64_t>(int64_t{cursor_position.x.as_int()}));
+    request.add(plane_id, *cursor_props, "CRTC_Y", static_cast<uint64_t>(int64_t{cursor_position.y.as_int()}));
+    request.add(plane_id, *cursor_props, "CRTC_W", width);
+    request.add(plane_id, *cursor_props, "CRTC_H", height);
+}
+
+void mgg::AtomicKMSOutput::add_overlay_planes(Request& request, std::vector<Overlay> const& to_show) const
+{
+    for (auto i = 0u; i != overlay_planes.size(); ++i)
+    {
+        auto const& plane = overlay_planes[i];
+
+        if (i >= to_show.size())
+        {
+            request.add(plane.id, *plane.props, "FB_ID", 0);
+            request.add(plane.id, *plane.props, "CRTC_ID", 0);
+            continue;
+        }
+
+        auto const& overlay = to_show[i];
+        auto const& src = overlay.source;
+        auto const& dest = overlay.destination;
+
+        request.add(plane.id, *plane.props, "FB_ID", drm_fb_id(*overlay.fb));
+        request.add(plane.id, *plane.props, "CRTC_ID", current_crtc->crtc_id);
+        if (plane.props->has_property("rotation"))
+            request.add(plane.id, *plane.props, "rotation", overlay.rotation);
+        request.add(plane.id, *plane.props, "SRC_X", to_fixed_16_16(src.top_left.x.as_value()));
+        request.add(plane.id, *plane.props, "SRC_Y", to_fixed_16_16(src.top_left.y.as_value()));
+        request.add(plane.id, *plane.props, "SRC_W", to_fixed_16_16(src.size.width.as_value()));
+        request.add(plane.id, *plane.props, "SRC_H", to_fixed_16_16(src.size.height.as_value()));
+        request.add(plane.id, *plane.props, "CRTC_X", static_cast<uint64_t>(int64_t{dest.top_left.x.as_int()}));
+        request.add(plane.id, *plane.props, "CRTC_Y", static_cast<uint64_t>(int64_t{dest.top_left.y.as_int()}));
+        request.add(plane.id, *plane.props, "CRTC_W", dest.size.width.as_uint32_t());
+        request.add(plane.id, *plane.props, "CRTC_H", dest.size.height.as_uint32_t());
+    }
+}
+
+void mgg::AtomicKMSOutput::add_adaptive_sync(Request& request) const
+{
+    if (crtc_props->has_property("VRR_ENABLED"))
+        request.add(current_crtc->crtc_id, *crtc_props, "VRR_ENABLED", adaptive_sync_ ? 1 : 0);
+}
+
+bool mgg::AtomicKMSOutput::set_crtc(FBHandle const& fb)
+{
+    if (!ensure_crtc())
+    {
+        mir::log_error("Output %s has no associated CRTC to set a framebuffer on",
+                       mgk::connector_name(connector).c_str());
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock{plane_mutex};
+    update_planes();
+    if (!planes.primary)
+    {
+        mir::log_error("CRTC of output %s has no primary plane to set a framebuffer on",
+                       mgk::connector_name(connector).c_str());
+        current_crtc = nullptr;
+        return false;
+    }
+
+    auto const crtc_id = current_crtc->crtc_id;
+
+    auto const& mode = connector->modes[crtc_mode_index()];
+    uint32_t mode_blob{0};
+    if (auto const ret = drmModeCreatePropertyBlob(drm_fd_, &mode, sizeof(mode), &mode_blob))
+    {
+        mir::log_error("Failed to create DRM mode property blob: %s", strerror(-ret));
+        current_crtc = nullptr;
+        return false;
+    }
+
+    Request request;
+    request.add(crtc_id, *crtc_props, "MODE_ID", mode_blob);
+    request.add(crtc_id, *crtc_props, "ACTIVE", 1);
+    request.add(id(), connector_props, "CRTC_ID", crtc_id);
+    add_adaptive_sync(request);
+    add_primary_plane(request, fb);
+    if (cursor_props)
+        add_cursor_plane(request);
+    // Overlays were only tested against the old configuration; the next frame can reassign them
+    add_overlay_planes(request, {});
+
+    // Check the hardware can do it first, so a failure leaves the current configuration intact
+    auto ret = request.commit(drm_fd_, DRM_MODE_ATOMIC_TEST_ONLY | DRM_MODE_ATOMIC_ALLOW_MODESET);
+    if (!ret)
+        ret = request.commit(drm_fd_, DRM_MODE_ATOMIC_ALLOW_MODESET);
+
+    if (ret)
+    {
+        mir::log_warning("Atomic modeset of output %s failed: %s",
+                         mgk::connector_name(connector).c_str(), strerror(-ret));
+        drmModeDestroyPropertyBlob(drm_fd_, mode_blob);
+        current_crtc = nullptr;
+        return false;
+    }
+
+    if (mode_blob_id)
+        drmModeDestroyPropertyBlob(drm_fd_, mode_blob_id);
+    mode_blob_id = mode_blob;
+
+    cursor_dirty = false;
+    overlays.clear();
+    overlays_dirty = false;
+    primary_rotation_dirty = false;
+    adaptive_sync_dirty = false;
+    using_saved_crtc = false;
+    return true;
+}
+
+void mgg::AtomicKMSOutput::clear_crtc()
+{
+    try
+    {
+        ensure_crtc();
+    }
+    catch (...)
+    {
+        // As for RealKMSOutput, with no CRTC the output can't be displaying anything anyway
+        return;
+    }
+
+    if (!current_crtc)
+        return;
+
+    std::lock_guard<std::mutex> lock{plane_mutex};
+    update_planes();
+    if (!planes.primary)
+    {
+        RealKMSOutput::clear_crtc();
+        return;
+    }
+
+    auto const crtc_id = current_crtc->crtc_id;
+
+    Request request;
+    request.add(crtc_id, *crtc_props, "MODE_ID", 0);
+    request.add(crtc_id, *crtc_props, "ACTIVE", 0);
+    request.add(id(), connector_props, "CRTC_ID", 0);
+    request.add(planes.primary->plane_id, *primary_props, "FB_ID", 0);
+    request.add(planes.primary->plane_id, *primary_props, "CRTC_ID", 0);
+    if (cursor_props)
+    {
+        request.add(planes.cursor->plane_id, *cursor_props, "FB_ID", 0);
+        request.add(planes.cursor->plane_id, *cursor_props, "CRTC_ID", 0);
+    }
+    add_overlay_planes(request, {});
+
+    auto const result = request.commit(drm_fd_, DRM_MODE_ATOMIC_ALLOW_MODESET);
+    if (result)
+    {
+        if (result == -EACCES || result == -EPERM)
+        {
+            /* We don't have modesetting rights; see RealKMSOutput::clear_crtc() */
+            mir::log_info("Couldn't clear output %s (drmModeAtomicCommit: %s (%i))",
+                mgk::connector_name(connector).c_str(),
+                strerror(-result),
+                -result);
+        }
+        else
+        {
+            fatal_error("Couldn't clear output %s (drmModeAtomicCommit = %d)",
+                        mgk::connector_name(connector).c_str(), result);
+        }
+    }
+
+    current_crtc = nullptr;
+    planes_crtc_id = 0;
+    overlays.clear();
+}
+
+bool mgg::AtomicKMSOutput::schedule_page_flip(FBHandle const& fb)
+{
+    std::unique_lock<std::mutex> lg(power_mutex);
+    if (power_mode != mir_power_mode_on)
+        return true;
+    if (!current_crtc)
+    {
+        mir::log_error("Output %s has no associated CRTC to schedule page flips on",
+                       mgk::connector_name(connector).c_str());
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock{plane_mutex};
+    update_planes();
+    if (!planes.primary)
+        return false;
+
+    Request request;
+    // A new rotation changes the source viewport too
+    if (primary_rotation_dirty)
+        add_primary_plane(request, fb);
+    else
+        request.add(planes.primary->plane_id, *primary_props, "FB_ID", drm_fb_id(fb));
+    if (cursor_props && cursor_dirty)
+        add_cursor_plane(request);
+    if (overlays_dirty)
+        add_overlay_planes(request, overlays);
+    if (adaptive_sync_dirty)
+        add_adaptive_sync(request);
+
+    if (!page_flipper->schedule_atomic_flip(request.get(), current_crtc->crtc_id, id()))
+        return false;
+
+    cursor_dirty = false;
+    overlays_dirty = false;
+    primary_rotation_dirty = false;
+    adaptive_sync_dirty = false;
+    flip_pending = true;
+    return true;
+}
+
+bool mgg::AtomicKMSOutput::schedule_async_page_flip(FBHandle const& fb)
+{
+    std::unique_lock<std::mutex> lg(power_mutex);
+    if (power_mode != mir_power_mode_on)
+        return true;
+    if (!async_atomic_flips || !current_crtc)
+        return false;
+
+    std::lock_guard<std::mutex> lock{plane_mutex};
+    update_planes();
+    // An async commit may change nothing but framebuffers; anything else waits for a vblank flip
+    if (!planes.primary || cursor_dirty || overlays_dirty || primary_rotation_dirty || adaptive_sync_dirty)
+        return false;
+
+    Request request;
+    request.add(planes.primary->plane_id, *primary_props, "FB_ID", drm_fb_id(fb));
+
+    if (!page_flipper->schedule_async_atomic_flip(request.get(), current_crtc->crtc_id, id()))
+        return false;
+
+    flip_pending = true;
+    return true;
+}
+
+void mgg::AtomicKMSOutput::wait_for_page_flip()
+{
+    RealKMSOutput::wait_for_page_flip();
+
+    // Cursor changes made while the flip was pending were left for it to carry, but it has gone
+    std::lock_guard<std::mutex> lock{plane_mutex};
+    flip_pending = false;
+    if (cursor_dirty)
+        commit_cursor();
+}
+
+bool mgg::AtomicKMSOutput::assign_overlays(std::vector<Overlay> const& new_overlays)
+{
+    std::lock_guard<std::mutex> lock{plane_mutex};
+    update_planes();
+
+    if (new_overlays.empty())
+    {
+        if (!overlays.empty())
+        {
+            overlays.clear();
+            overlays_dirty = true;
+        }
+        return true;
+    }
+
+    if (!current_crtc || new_overlays.size() > overlay_planes.size())
+        return false;
+
+    if (same_overlays(new_overlays, overlays))
+        return true;
+
+    for (auto i = 0u; i != new_overlays.size(); ++i)
+    {
+        if (new_overlays[i].rotation != DRM_MODE_ROTATE_0 && !overlay_planes[i].props->has_property("rotation"))
+            return false;
+    }
+
+    // Only the overlay planes change, so this tests them against the rest of the current state
+    Request request;
+    add_overlay_planes(request, new_overlays);
+    if (request.commit(drm_fd_, DRM_MODE_ATOMIC_TEST_ONLY))
+        return false;
+
+    overlays = new_overlays;
+    overlays_dirty = true;
+    return true;
+}
+
+bool mgg::AtomicKMSOutput::rotate_scanout(FBHandle const& fb, uint32_t rotation)
+{
+    std::lock_guard<std::mutex> lock{plane_mutex};
+    update_planes();
+
+    if (rotation == DRM_MODE_ROTATE_0)
+    {
+        if (primary_rotation != rotation)
+        {
+            primary_rotation = rotation;
+            primary_rotation_dirty = true;
+        }
+        return true;
+    }
+
+    if (!current_crtc || !planes.primary || !primary_props->has_property("rotation"))
+        return false;
+
+    // Tested with every buffer, as whether it can be rotated depends on its format and layout
+    auto const previous_rotation = primary_rotation;
+    primary_rotation = rotation;
+
+    Request request;
+    add_primary_plane(request, fb);
+    if (request.commit(drm_fd_, DRM_MODE_ATOMIC_TEST_ONLY))
+    {
+        primary_rotation = previous_rotation;
+        return false;
+    }
+
+    primary_rotation_dirty |= (previous_rotation != rotation);
+    return true;
+}
+
+auto mgg::AtomicKMSOutput::scanout_modifiers(uint32_t format) -> std::vector<uint64_t>
+{
+    // Called off the compositor thread, so we only look at the planes it found; current_crtc is its own
+    std::lock_guard<std::mutex> lock{plane_mutex};
+    if (!planes.primary)
+        return {};
+
+    return mgk::plane_format_modifiers(drm_fd_, planes.primary, format);
+}
+
+auto mgg::AtomicKMSOutput::overlay_modifiers(uint32_t format) -> std::vector<uint64_t>
+{
+    // As for scanout_modifiers(), only the planes the compositor thread found
+    std::lock_guard<std::mutex> lock{plane_mutex};
+
+    // A buffer could be given any overlay plane assign_overlays() can use (those above the
+    // primary), whether or not anything is on them yet, so only what they all accept will do
+    std::vector<uint64_t> common;
+    bool first{true};
+    for (auto const& plane : planes.overlays)
+    {
+        auto const usable = std::any_of(
+            overlay_planes.begin(), overlay_planes.end(),
+            [&](OverlayPlane const& overlay) { return overlay.id == plane->plane_id; });
+        if (!usable)
+            continue;
+
+        auto const modifiers = mgk::plane_format_modifiers(drm_fd_, plane, format);
+        if (first)
+        {
+            common = modifiers;
+            first = false;
+            continue;
+        }
+
+        common.erase(
+            std::remove_if(
+                common.begin(), common.end(),
+                [&](uint64_t modifier)
+                {
+                    return std::find(modifiers.begin(), modifiers.end(), modifier) == modifiers.end();
+                }),
+            common.end());
+    }
+    return common;
+}
+
+bool mgg::AtomicKMSOutput::commit_cursor()
+{
+    // Whatever is in flight picks up our changes once it completes; committing now would fail with EBUSY
+    if (flip_pending || cursor_update_crtc_id || !current_crtc)
+        return true;
+
+    Request request;
+    add_cursor_plane(request);
+
+    auto const crtc_id = current_crtc->crtc_id;
+    if (page_flipper->schedule_atomic_cursor_update(
+            request.get(), crtc_id, [this]() { cursor_update_completed(); }))
+    {
+        cursor_update_crtc_id = crtc_id;
+        cursor_dirty = false;
+        return true;
+    }
+
+    // Something else is being committed to the CRTC, such as a cancelled update from an earlier output
+    if (auto const ret = request.commit(drm_fd_, 0))
+    {
+        mir::log_warning("Updating the cursor plane of output %s failed (%s)",
+                         mgk::connector_name(connector).c_str(), strerror(-ret));
+        return false;
+    }
+
+    cursor_dirty = false;
+    return true;
+}
+
+void mgg::AtomicKMSOutput::cursor_update_completed()
+{
+    std::lock_guard<std::mutex> lock{plane_mutex};
+    cursor_update_crtc_id = 0;
+    if (cursor_dirty)
+        commit_cursor();
+}
+
+bool mgg::AtomicKMSOutput::set_cursor(gbm_bo* buffer)
+{
+    std::lock_guard<std::mutex> lock{plane_mutex};
+    update_planes();
+    if (!current_crtc)
+        return true;
+    if (!cursor_props)
+        return RealKMSOutput::set_cursor(buffer);
+
+    auto fb = fb_for(buffer);
+    if (!fb)
+    {
+        mir::log_warning("set_cursor: failed to create a DRM framebuffer for the cursor");
+        has_cursor_ = false;
+        return false;
+    }
+
+    cursor_fb = std::move(fb);
+    cursor_size = {gbm_bo_get_width(buffer), gbm_bo_get_height(buffer)};
+    cursor_dirty = true;
+    has_cursor_ = commit_cursor();
+    if (!has_cursor_)
+        cursor_fb = nullptr;
+    return has_cursor_;
+}
+
+void mgg::AtomicKMSOutput::move_cursor(geometry::Point destination)
+{
+    std::lock_guard<std::mutex> lock{plane_mutex};
+    update_planes();
+    if (!current_crtc)
+        return;
+    if (!cursor_props)
+        return RealKMSOutput::move_cursor(destination);
+
+    cursor_position = destination;
+    cursor_dirty = true;
+    commit_cursor();
+}
+
+bool mgg::AtomicKMSOutput::clear_cursor()
+{
+    std::lock_guard<std::mutex> lock{plane_mutex};
+    update_planes();
+    if (!current_crtc)
+        return true;
+    if (!cursor_props)
+        return RealKMSOutput::clear_cursor();
+
+    cursor_fb = nullptr;
+    cursor_dirty = true;
+    has_cursor_ = false;
+    return commit_cursor();
+}
+
+void mgg::AtomicKMSOutput::set_gamma(mg::GammaCurves const& gamma)
+{
+    if (!ensure_crtc())
+    {
+        mir::log_warning("Output %s has no associated CRTC to set gamma on",
+                         mgk::connector_name(connector).c_str());
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock{plane_mutex};
+    update_planes();
+
+    // The legacy LUT drivers convert for us needn't be the size of GAMMA_LUT
+    if (!crtc_props->has_property("GAMMA_LUT") ||
+        !crtc_props->has_property("GAMMA_LUT_SIZE") ||
+        gamma.red.size() != (*crtc_props)["GAMMA_LUT_SIZE"] ||
+        gamma.green.size() != gamma.red.size() ||
+        gamma.blue.size() != gamma.red.size())
+    {
+        RealKMSOutput::set_gamma(gamma);
+        return;
+    }
+
+    std::vector<drm_color_lut> lut(gamma.red.size());
+    for (auto i = 0u; i != lut.size(); ++i)
+        lut[i] = drm_color_lut{gamma.red[i], gamma.green[i], gamma.blue[i], 0};
+
+    uint32_t lut_blob{0};
+    if (auto const ret = drmModeCreatePropertyBlob(
+            drm_fd_, lut.data(), lut.size() * sizeof(lut[0]), &lut_blob))
+    {
+        mir::log_warning("Failed to create gamma LUT property blob: %s", strerror(-ret));
+        return;
+    }
+
+    // A blocking commit waits for any flip in flight rather than failing with EBUSY
+    Request request;
+    request.add(current_crtc->crtc_id, *crtc_props, "GAMMA_LUT", lut_blob);
+    if (auto const ret = request.commit(drm_fd_, 0))
+        mir::log_warning("Setting GAMMA_LUT failed: %s", strerror(-ret));
+
+    // The CRTC holds its own reference to the blob
+    drmModeDestroyPropertyBlob(drm_fd_, lut_blob);
+}
+
+bool mgg::AtomicKMSOutput::set_adaptive_sync(bool enabled)
+{
+    // Drivers that can vary the refresh rate say so on connectors where the panel supports it
+    mgk::ObjectProperties const props{drm_fd_, id(), DRM_MODE_OBJECT_CONNECTOR};
+    auto const capable = props.has_property("vrr_capable") && props["vrr_capable"];
+
+    std::lock_guard<std::mutex> lock{plane_mutex};
+    auto const active = enabled && capable;
+    if (active != adaptive_sync_)
+    {
+        adaptive_sync_ = active;
+        adaptive_sync_dirty = true;
+    }
+    return active;
+}
+
+bool mgg::AtomicKMSOutput::adaptive_sync() const
+{
+    return adaptive_sync_;
+}
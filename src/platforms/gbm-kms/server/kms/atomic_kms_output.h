@@ -0,0 +1,122 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_GBM_ATOMIC_KMS_OUTPUT_H_
+#define MIR_GRAPHICS_GBM_ATOMIC_KMS_OUTPUT_H_
+
+#include "real_kms_output.h"
+#include "kms-utils/kms_connector.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace mir
+{
+namespace graphics
+{
+namespace gbm
+{
+
+/**
+ * A KMSOutput programmed with atomic modesetting.
+ *
+ * Each page flip is a single atomic commit of the primary plane, carrying
+ * any cursor plane changes made since the last one, so the cursor can't
+ * race the flip. Between flips, cursor updates are their own non-blocking
+ * commits. Mode sets, overlay assignments and scanout rotations are
+ * validated with a TEST_ONLY commit before being applied.
+ */
+class AtomicKMSOutput : public RealKMSOutput
+{
+public:
+    AtomicKMSOutput(
+        int drm_fd,
+        kms::DRMModeConnectorUPtr&& connector,
+        std::shared_ptr<PageFlipper> const& page_flipper);
+    ~AtomicKMSOutput();
+
+    bool set_crtc(FBHandle const& fb) override;
+    void clear_crtc() override;
+    bool schedule_page_flip(FBHandle const& fb) override;
+    bool schedule_async_page_flip(FBHandle const& fb) override;
+    void wait_for_page_flip() override;
+    bool assign_overlays(std::vector<Overlay> const& overlays) override;
+    bool rotate_scanout(FBHandle const& fb, uint32_t rotation) override;
+    auto scanout_modifiers(uint32_t format) -> std::vector<uint64_t> override;
+    auto overlay_modifiers(uint32_t format) -> std::vector<uint64_t> override;
+    bool set_adaptive_sync(bool enabled) override;
+    bool adaptive_sync() const override;
+
+    bool set_cursor(gbm_bo* buffer) override;
+    void move_cursor(geometry::Point destination) override;
+    bool clear_cursor() override;
+
+    void set_gamma(GammaCurves const& gamma) override;
+
+private:
+    class Request;
+
+    /// Finds the planes of current_crtc, if they aren't already known
+    void update_planes();
+    void add_primary_plane(Request& request, FBHandle const& fb) const;
+    void add_cursor_plane(Request& request) const;
+    void add_overlay_planes(Request& request, std::vector<Overlay> const& overlays) const;
+    void add_adaptive_sync(Request& request) const;
+    /**
+     * Commits pending cursor changes now, unless a commit in flight will carry them (needs
+     * plane_mutex). At most one cursor update is in flight, so rapid moves coalesce into
+     * one commit per vblank.
+     */
+    bool commit_cursor();
+    void cursor_update_completed();
+
+    kms::ObjectProperties const connector_props;
+    bool const async_atomic_flips;
+    uint32_t planes_crtc_id{0};
+    kms::CrtcPlanes planes;
+    std::unique_ptr<kms::ObjectProperties> crtc_props;
+    std::unique_ptr<kms::ObjectProperties> primary_props;
+    std::unique_ptr<kms::ObjectProperties> cursor_props;
+    struct OverlayPlane
+    {
+        uint32_t id;
+        std::unique_ptr<kms::ObjectProperties> props;
+    };
+    std::vector<OverlayPlane> overlay_planes;       ///< Those above the primary plane, bottom first
+    uint32_t mode_blob_id{0};
+
+    std::mutex plane_mutex;
+    std::shared_ptr<FBHandle const> cursor_fb;      ///< Null when the cursor is hidden
+    geometry::Size cursor_size;
+    geometry::Point cursor_position;
+    bool cursor_dirty{false};
+    uint32_t cursor_update_crtc_id{0};                ///< Of the cursor update in flight, if any
+    std::vector<Overlay> overlays;
+    bool overlays_dirty{false};
+    uint32_t primary_rotation{DRM_MODE_ROTATE_0};
+    bool primary_rotation_dirty{false};
+    bool flip_pending{false};
+    std::atomic<bool> adaptive_sync_{false};
+    bool adaptive_sync_dirty{false};
+};
+
+}
+}
+}
+
+#endif /* MIR_GRAPHICS_GBM_ATOMIC_KMS_OUTPUT_H_ */
@@ -18,8 +18,12 @@
 
 #include "mir/graphics/renderable.h"
 #include "mir/graphics/display_buffer.h"
+#include "mir/graphics/dmabuf_buffer.h"
+#include "mir/graphics/buffer.h"
 #include "bypass.h"
 
+#include <algorithm>
+
 using namespace mir;
 namespace mgg = mir::graphics::gbm;
 
@@ -40,9 +44,35 @@ bool mgg::BypassMatch::operator()(std::shared_ptr<graphics::Renderable> const& r
     if (!view_area.overlaps(renderable->screen_position()))
         return false;
 
-    auto const is_opaque = !((renderable->alpha() != 1.0f) || renderable->shaped());
+    // A buffer with an alpha channel is still opaque if the client says so (as Xwayland does for its 24-bit windows)
+    auto const opaque_region = renderable->opaque_region();
+    auto const declared_opaque = std::any_of(opaque_region.begin(), opaque_region.end(),
+        [&](auto const& rect) { return rect.contains(renderable->screen_position()); });
+    auto const is_opaque = (renderable->alpha() == 1.0f) && (!renderable->shaped() || declared_opaque);
     auto const fits = (renderable->screen_position() == view_area);
     auto const is_orthogonal = (renderable->transformation() == identity);
-    bypass_is_feasible = (is_opaque && fits && is_orthogonal);
+    // Bypass scans out the whole buffer, so it can't show a cropped one
+    auto const is_uncropped =
+        (renderable->src_bounds() == geometry::RectangleF{{}, geometry::SizeF{renderable->buffer()->size()}});
+    bypass_is_feasible = (is_opaque && fits && is_orthogonal && is_uncropped);
     return bypass_is_feasible;
 }
+
+bool mgg::can_overlay(geometry::Rectangle const& view_area, graphics::Renderable const& renderable)
+{
+    auto const position = renderable.screen_position();
+    if (position == view_area || !view_area.contains(position))
+        return false;
+
+    // Overlay planes can't clip or transform, and we don't use their alpha property
+    if (auto const clip = renderable.clip_area())
+    {
+        if (!clip.value().contains(position))
+            return false;
+    }
+    if (renderable.alpha() != 1.0f || renderable.transformation() != glm::mat4(1))
+        return false;
+
+    // Per-pixel alpha is fine: planes blend the (premultiplied) buffer over what's beneath
+    return dynamic_cast<graphics::DMABufBuffer*>(renderable.buffer()->native_buffer_base()) != nullptr;
+}
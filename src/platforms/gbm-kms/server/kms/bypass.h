@@ -39,6 +39,13 @@ private:
     glm::mat4 const identity;
 };
 
+/**
+ * Whether renderable could be scanned out on an overlay plane of view_area, as is.
+ *
+ * Renderables covering all of view_area are left to BypassMatch.
+ */
+bool can_overlay(geometry::Rectangle const& view_area, graphics::Renderable const& renderable);
+
 } // namespace gbm-kms
 } // namespace graphics
 } // namespace mir
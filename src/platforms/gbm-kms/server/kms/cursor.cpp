@@ -28,7 +28,10 @@
 
 #include <boost/exception/errinfo_errno.hpp>
 
+#include <algorithm>
+#include <cstring>
 #include <stdexcept>
+#include <string_view>
 #include <vector>
 
 namespace mg = mir::graphics;
@@ -38,6 +41,8 @@ namespace geom = mir::geometry;
 namespace
 {
 const uint64_t fallback_cursor_size = 64;
+/// Enough for the frames of most animated cursors. Each output has up to this many cursor BOs.
+size_t const max_cached_frames = 8;
 char const* const mir_drm_cursor_64x64 = "MIR_DRM_CURSOR_64x64";
 
 // Transforms a relative position within the display bounds described by \a rect which is rotated with \a orientation
@@ -99,16 +104,15 @@ gbm_device* gbm_create_device_checked(int fd)
 }
 }
 
-mgg::Cursor::GBMBOWrapper::GBMBOWrapper(int fd, MirOrientation orientation) :
-    device{gbm_create_device_checked(fd)},
+mgg::Cursor::GBMBOWrapper::GBMBOWrapper(std::shared_ptr<gbm_device> const& device, int fd) :
+    device{device},
     buffer{
         gbm_bo_create(
-            device,
+            device.get(),
             get_drm_cursor_width(fd),
             get_drm_cursor_height(fd),
             GBM_FORMAT_ARGB8888,
-            GBM_BO_USE_CURSOR | GBM_BO_USE_WRITE)},
-    current_orientation{orientation}
+            GBM_BO_USE_CURSOR | GBM_BO_USE_WRITE)}
 {
     if (!buffer) BOOST_THROW_EXCEPTION(std::runtime_error("failed to create gbm-kms buffer"));
 }
@@ -120,28 +124,18 @@ inline mgg::Cursor::GBMBOWrapper::operator gbm_bo*()
 
 inline mgg::Cursor::GBMBOWrapper::~GBMBOWrapper()
 {
-    if (device)
-        gbm_device_destroy(device);
     if (buffer)
         gbm_bo_destroy(buffer);
 }
 
 mgg::Cursor::GBMBOWrapper::GBMBOWrapper(GBMBOWrapper&& from)
-    : device{from.device},
-      buffer{from.buffer},
-      current_orientation{from.current_orientation}
+    : frame{from.frame},
+      orientation{from.orientation},
+      last_used{from.last_used},
+      device{std::move(from.device)},
+      buffer{from.buffer}
 {
     from.buffer = nullptr;
-    from.device = nullptr;
-}
-
-auto mir::graphics::gbm::Cursor::GBMBOWrapper::change_orientation(MirOrientation new_orientation) -> bool
-{
-    if (current_orientation == new_orientation)
-        return false;
-
-    current_orientation = new_orientation;
-    return true;
 }
 
 mgg::Cursor::Cursor(
@@ -162,7 +156,7 @@ mgg::Cursor::Cursor(
                 [this, &kms_conf](auto const& output)
                 {
                     // I'm not sure why g++ needs the explicit "this->" but it does - alan_g
-                    this->buffer_for_output(*kms_conf.get_output_for(output.id));
+                    this->buffers_for_output(*kms_conf.get_output_for(output.id));
                 });
         });
 
@@ -192,9 +186,11 @@ void mgg::Cursor::write_buffer_data_locked(
 
 void mgg::Cursor::pad_and_write_image_data_locked(
     std::lock_guard<std::mutex> const& lg,
-    GBMBOWrapper& buffer)
+    GBMBOWrapper& buffer,
+    Frame const& frame)
 {
-    auto const orientation = buffer.orientation();
+    auto const orientation = buffer.orientation;
+    auto const& size = frame.size;
     bool const sideways = orientation == mir_orientation_left || orientation == mir_orientation_right;
 
     auto const min_width  = sideways ? min_buffer_width : min_buffer_height;
@@ -212,7 +208,7 @@ void mgg::Cursor::pad_and_write_image_data_locked(
     size_t rhs_padding = buffer_stride - 4*image_width;
 
     auto const filler = 0; // 0x3f; is useful to make buffer visible for debugging
-    uint8_t const* src = argb8888.data();
+    uint8_t const* src = frame.argb8888.data();
     uint8_t* dest = &padded[0];
 
     switch (orientation)
@@ -279,24 +275,41 @@ void mgg::Cursor::show(CursorImage const& cursor_image)
 {
     std::lock_guard<std::mutex> lg(guard);
 
-    size = cursor_image.size();
+    auto const size = cursor_image.size();
+    auto const pixels = static_cast<uint8_t const*>(cursor_image.as_argb_8888());
+    size_t const length = size.width.as_uint32_t() * size.height.as_uint32_t() * 4;
+    auto const hash = std::hash<std::string_view>{}({reinterpret_cast<char const*>(pixels), length});
 
-    argb8888.resize(size.width.as_uint32_t() * size.height.as_uint32_t() * 4);
-    memcpy(argb8888.data(), cursor_image.as_argb_8888(), argb8888.size());
+    auto const cached = std::find_if(frames.begin(), frames.end(), [&](Frame const& frame)
+        {
+            return frame.hash == hash && frame.size == size && memcmp(frame.argb8888.data(), pixels, length) == 0;
+        });
 
-    hotspot = cursor_image.hotspot();
+    if (cached != frames.end())
     {
-        auto locked_buffers = buffers.lock();
-        for (auto& tuple : *locked_buffers)
-        {
-            pad_and_write_image_data_locked(lg, std::get<2>(tuple));
-        }
+        frames.splice(frames.begin(), frames, cached);
+    }
+    else
+    {
+        frames.push_front(Frame{next_frame_serial++, hash, size, {pixels, pixels + length}});
+        if (frames.size() > max_cached_frames)
+            frames.pop_back();
     }
 
-    // Writing the data could throw an exception so lets
-    // hold off on setting visible until after we have succeeded.
+    hotspot = cursor_image.hotspot();
+
     visible = true;
-    place_cursor_at_locked(lg, current_position, ForceState);
+    try
+    {
+        place_cursor_at_locked(lg, current_position, ForceState);
+    }
+    catch (...)
+    {
+        // Writing the image failed, so don't leave a stale one showing
+        visible = false;
+        clear(lg);
+        throw;
+    }
 }
 
 void mgg::Cursor::move_to(geometry::Point position)
@@ -312,6 +325,9 @@ void mir::graphics::gbm::Cursor::suspend()
 
 void mir::graphics::gbm::Cursor::clear(std::lock_guard<std::mutex> const&)
 {
+    for (auto& output_buffers : *buffers.lock())
+        output_buffers.shown = nullptr;
+
     last_set_failed = false;
     output_container.for_each_output([&](std::shared_ptr<KMSOutput> const& output)
         {
@@ -398,22 +414,19 @@ void mgg::Cursor::place_cursor_at_locked(
 
             auto const position_on_output = geom::Point{roundf(output_space_vec.x), roundf(output_space_vec.y)};
 
-            auto const hotspot_displacement = transform(geom::Rectangle{{}, size}, hotspot, orientation);
+            auto const hotspot_displacement = transform(geom::Rectangle{{}, frames.front().size}, hotspot, orientation);
 
             // It's a little strange that we implement hotspot this way as there is
             // drmModeSetCursor2 with hotspot support. However it appears to not actually
             // work on radeon and intel. There also seems to be precedent in weston for
             // implementing hotspot in this fashion.
             output.move_cursor(position_on_output - hotspot_displacement);
-            auto& buffer = buffer_for_output(output);
-
-            auto const changed_orientation = buffer.change_orientation(orientation);
-
-            if (changed_orientation)
-                pad_and_write_image_data_locked(lg, buffer);
+            auto& output_buffers = buffers_for_output(output);
+            auto& buffer = buffer_for_frame_locked(lg, output_buffers, orientation);
 
-            if (force_state || !output.has_cursor() || changed_orientation)
+            if (force_state || !output.has_cursor() || output_buffers.shown != &buffer)
             {
+                output_buffers.shown = &buffer;
                 if (!output.set_cursor(buffer) || !output.has_cursor())
                     set_on_all_outputs = false;
             }
@@ -430,22 +443,24 @@ void mgg::Cursor::place_cursor_at_locked(
     last_set_failed = !set_on_all_outputs;
 }
 
-mgg::Cursor::GBMBOWrapper& mgg::Cursor::buffer_for_output(KMSOutput const& output)
+auto mgg::Cursor::buffers_for_output(KMSOutput const& output) -> OutputBuffers&
 {
     auto const drm_fd = output.drm_fd();
     auto const id = output.id();
     auto locked_buffers = buffers.lock();
 
-    for (auto& bo : *locked_buffers)
+    for (auto& output_buffers : *locked_buffers)
     {
         // We use both id and drm_fd as identifier as we're not sure of the uniqueness of either
-        if (std::get<0>(bo) == id && std::get<1>(bo) == drm_fd)
-            return std::get<2>(bo);
+        if (output_buffers.id == id && output_buffers.drm_fd == drm_fd)
+            return output_buffers;
     }
 
-    locked_buffers->push_back(image_buffer{id, drm_fd, GBMBOWrapper{drm_fd, mir_orientation_normal}});
+    std::shared_ptr<gbm_device> const device{gbm_create_device_checked(drm_fd), &gbm_device_destroy};
+    locked_buffers->push_back(OutputBuffers{id, drm_fd, device, {}, nullptr});
 
-    GBMBOWrapper& bo = std::get<2>(locked_buffers->back());
+    auto& output_buffers = locked_buffers->back();
+    GBMBOWrapper& bo = output_buffers.bos.emplace_back(device, drm_fd);
     if (gbm_bo_get_width(bo) < min_buffer_width)
     {
         min_buffer_width = gbm_bo_get_width(bo);
@@ -455,5 +470,54 @@ mgg::Cursor::GBMBOWrapper& mgg::Cursor::buffer_for_output(KMSOutput const& outpu
         min_buffer_height = gbm_bo_get_height(bo);
     }
 
-    return bo;
+    return output_buffers;
+}
+
+auto mgg::Cursor::buffer_for_frame_locked(
+    std::lock_guard<std::mutex> const& lg,
+    OutputBuffers& output_buffers,
+    MirOrientation orientation) -> GBMBOWrapper&
+{
+    auto const& frame = frames.front();
+    auto& bos = output_buffers.bos;
+
+    auto found = std::find_if(bos.begin(), bos.end(), [&](GBMBOWrapper const& bo)
+        {
+            return bo.frame == frame.serial && bo.orientation == orientation;
+        });
+
+    if (found == bos.end())
+    {
+        auto const unused = std::find_if(bos.begin(), bos.end(), [](GBMBOWrapper const& bo) { return bo.frame == 0; });
+
+        if (unused != bos.end())
+        {
+            found = unused;
+        }
+        else if (bos.size() < max_cached_frames)
+        {
+            bos.emplace_back(output_buffers.device, output_buffers.drm_fd);
+            found = bos.end() - 1;
+        }
+        else
+        {
+            found = std::min_element(bos.begin(), bos.end(), [](GBMBOWrapper const& lhs, GBMBOWrapper const& rhs)
+                {
+                    return lhs.last_used < rhs.last_used;
+                });
+        }
+
+        // Until it is written, the BO holds no frame
+        found->frame = 0;
+        found->orientation = orientation;
+        pad_and_write_image_data_locked(lg, *found, frame);
+        found->frame = frame.serial;
+
+        // Rewriting the BO on screen, so set it again
+        if (output_buffers.shown == &*found)
+            output_buffers.shown = nullptr;
+    }
+
+    found->last_used = next_use++;
+    return *found;
 }
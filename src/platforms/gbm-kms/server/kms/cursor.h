@@ -29,7 +29,9 @@
 
 #include <gbm.h>
 
+#include <deque>
 #include <functional>
+#include <list>
 #include <memory>
 #include <mutex>
 #include <vector>
@@ -86,6 +88,8 @@ public:
 private:
     enum ForceCursorState { UpdateState, ForceState };
     struct GBMBOWrapper;
+    struct OutputBuffers;
+    struct Frame;
     void for_each_used_output(std::function<void(KMSOutput& output, DisplayConfigurationOutput const& conf)> const& f);
     void place_cursor_at(geometry::Point position, ForceCursorState force_state);
     void place_cursor_at_locked(std::lock_guard<std::mutex> const&, geometry::Point position, ForceCursorState force_state);
@@ -96,43 +100,72 @@ private:
         size_t count);
     void pad_and_write_image_data_locked(
         std::lock_guard<std::mutex> const&,
-        GBMBOWrapper& buffer);
+        GBMBOWrapper& buffer,
+        Frame const& frame);
     void clear(std::lock_guard<std::mutex> const&);
 
-    GBMBOWrapper& buffer_for_output(KMSOutput const& output);
-    
+    OutputBuffers& buffers_for_output(KMSOutput const& output);
+    GBMBOWrapper& buffer_for_frame_locked(
+        std::lock_guard<std::mutex> const&,
+        OutputBuffers& output_buffers,
+        MirOrientation orientation);
+
     std::mutex guard;
 
     KMSOutputContainer& output_container;
     geometry::Point current_position;
     geometry::Displacement hotspot;
-    geometry::Size size;
-    std::vector<uint8_t> argb8888;
 
     bool visible;
     bool last_set_failed;
 
+    struct Frame
+    {
+        uint64_t serial;
+        size_t hash;
+        geometry::Size size;
+        std::vector<uint8_t> argb8888;
+    };
+
+    /// The images shown most recently, the current one first, so that cycling through an animated cursor's
+    /// frames writes each of them to the cursor BOs only once
+    std::list<Frame> frames;
+    uint64_t next_frame_serial{1};
+    uint64_t next_use{1};
+
     struct GBMBOWrapper
     {
-        GBMBOWrapper(int fd, MirOrientation orientation);
+        GBMBOWrapper(std::shared_ptr<gbm_device> const& device, int fd);
         operator gbm_bo*();
 
-        auto orientation() const -> MirOrientation { return current_orientation; }
-        auto change_orientation(MirOrientation new_orientation) -> bool;
+        /// The frame last written to the BO, and in which orientation
+        uint64_t frame{0};
+        MirOrientation orientation{mir_orientation_normal};
+        /// When the BO was last placed, so the least recently used is rewritten once an output has enough
+        uint64_t last_used{0};
 
         ~GBMBOWrapper();
 
         GBMBOWrapper(GBMBOWrapper&& from);
     private:
-        gbm_device* device;
+        std::shared_ptr<gbm_device> device;
         gbm_bo* buffer;
-        MirOrientation current_orientation;
         GBMBOWrapper(GBMBOWrapper const&) = delete;
         GBMBOWrapper& operator=(GBMBOWrapper const&) = delete;
     };
 
-    using image_buffer = std::tuple<uint32_t, int, GBMBOWrapper>;
-    Mutex<std::vector<image_buffer>> buffers;
+    struct OutputBuffers
+    {
+        uint32_t id;
+        int drm_fd;
+        std::shared_ptr<gbm_device> device;
+        /// A deque, so that shown stays valid as BOs are added
+        std::deque<GBMBOWrapper> bos;
+        /// The BO last set on the output, or null if it has to be set again
+        GBMBOWrapper const* shown{nullptr};
+    };
+
+    Mutex<std::vector<OutputBuffers>> buffers;
 
     uint32_t min_buffer_width;
     uint32_t min_buffer_height;
@@ -45,7 +45,13 @@
 
 #include <stdexcept>
 #include <algorithm>
+#include <string.h> // strcmp
+#include <xf86drm.h>
 #include <unordered_map>
+#include <system_error>
+#include <sys/stat.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
 
 namespace mgg = mir::graphics::gbm;
 namespace mg = mir::graphics;
@@ -53,6 +59,16 @@ namespace geom = mir::geometry;
 
 namespace
 {
+/// How long the udev events of a hotplug must stop arriving before we reconfigure for it
+std::chrono::milliseconds const hotplug_settle_delay{100};
+
+auto timespec_from(std::chrono::nanoseconds duration) -> timespec
+{
+    auto const seconds = std::chrono::duration_cast<std::chrono::seconds>(duration);
+    return {
+        static_cast<time_t>(seconds.count()),
+        static_cast<long>(std::chrono::nanoseconds{duration - seconds}.count())};
+}
 
 class GBMGLContext : public mir::renderer::gl::Context
 {
@@ -79,6 +95,43 @@ private:
     mgg::helpers::EGLHelper egl;
 };
 
+/// The modifiers every output in \a outputs can scan out of, in the first output's order
+auto common_scanout_modifiers(std::vector<std::shared_ptr<mgg::KMSOutput>> const& outputs, uint32_t format)
+    -> std::vector<uint64_t>
+{
+    std::vector<uint64_t> common;
+    for (auto const& output : outputs)
+    {
+        auto const modifiers = output->scanout_modifiers(format);
+        if (&output == &outputs.front())
+        {
+            common = modifiers;
+            continue;
+        }
+
+        common.erase(
+            std::remove_if(
+                common.begin(), common.end(),
+                [&](uint64_t modifier)
+                {
+                    return std::find(modifiers.begin(), modifiers.end(), modifier) == modifiers.end();
+                }),
+            common.end());
+    }
+    return common;
+}
+
+/// Whether the outputs on \a drm_fd are driven by the GPU we render with
+bool renders_on(mgg::helpers::GBMHelper const& gbm, int drm_fd)
+{
+    using DeviceNode = std::unique_ptr<char, decltype(&free)>;
+    DeviceNode const gbm_node{drmGetPrimaryDeviceNameFromFd(gbm_device_get_fd(gbm.device)), &free};
+    DeviceNode const drm_node{drmGetPrimaryDeviceNameFromFd(drm_fd), &free};
+
+    // If we can't tell, assume the worst
+    return gbm_node && drm_node && strcmp(gbm_node.get(), drm_node.get()) == 0;
+}
+
 std::vector<int> drm_fds_from_drm_helpers(
     std::vector<std::shared_ptr<mgg::helpers::DRMHelper>> const& helpers)
 {
@@ -176,6 +229,10 @@ mgg::Display::Display(std::vector<std::shared_ptr<helpers::DRMHelper>> const& dr
                       std::shared_ptr<helpers::GBMHelper> const& gbm,
                       std::shared_ptr<ConsoleServices> const& vt,
                       mgg::BypassOption bypass_option,
+                      std::chrono::milliseconds frame_deadline_margin,
+                      FramePipelining frame_pipelining,
+                      AdaptiveSync adaptive_sync,
+                      std::chrono::milliseconds idle_refresh_timeout,
                       std::shared_ptr<DisplayConfigurationPolicy> const& initial_conf_policy,
                       std::shared_ptr<GLConfig> const& gl_config,
                       std::shared_ptr<DisplayReport> const& listener)
@@ -203,6 +260,10 @@ mgg::Display::Display(std::vector<std::shared_ptr<helpers::DRMHelper>> const& dr
       current_display_configuration{output_container},
       dirty_configuration{false},
       bypass_option(bypass_option),
+      frame_deadline_margin{frame_deadline_margin},
+      frame_pipelining{frame_pipelining},
+      adaptive_sync{adaptive_sync},
+      idle_refresh_timeout{idle_refresh_timeout},
       gl_config{gl_config}
 {
     shared_egl.setup(*gbm);
@@ -260,7 +321,25 @@ void mgg::Display::configure(mg::DisplayConfiguration const& conf)
 
     {
         std::lock_guard<decltype(configuration_mutex)> lock{configuration_mutex};
-        configure_locked(dynamic_cast<RealKMSDisplayConfiguration const&>(conf), lock);
+        configure_locked(dynamic_cast<RealKMSDisplayConfiguration const&>(conf), {}, lock);
+    }
+
+    if (auto c = cursor.lock()) c->resume();
+}
+
+void mgg::Display::configure_incrementally(
+    mg::DisplayConfiguration const& conf,
+    std::function<void(mg::DisplaySyncGroup&)> const& release)
+{
+    if (!conf.valid())
+    {
+        BOOST_THROW_EXCEPTION(
+            std::logic_error("Invalid or inconsistent display configuration"));
+    }
+
+    {
+        std::lock_guard<decltype(configuration_mutex)> lock{configuration_mutex};
+        configure_locked(dynamic_cast<RealKMSDisplayConfiguration const&>(conf), release, lock);
     }
 
     if (auto c = cursor.lock()) c->resume();
@@ -270,18 +349,85 @@ void mgg::Display::register_configuration_change_handler(
     EventHandlerRegister& handlers,
     DisplayConfigurationChangeHandler const& conf_change_handler)
 {
+    hotplug_timer = mir::Fd{timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK)};
+    if (hotplug_timer < 0)
+    {
+        BOOST_THROW_EXCEPTION(
+            std::system_error(errno, std::system_category(), "Failed to create hotplug timer"));
+    }
+
     handlers.register_fd_handler(
         {monitor.fd()},
         this,
         make_module_ptr<std::function<void(int)>>(
-            [conf_change_handler, this](int)
+            [this](int)
             {
-                monitor.process_events([conf_change_handler, this]
-                                       (mir::udev::Monitor::EventType, mir::udev::Device const&)
+                auto hotplugged = false;
+                monitor.process_events([&hotplugged](mir::udev::Monitor::EventType, mir::udev::Device const&)
                                        {
-                                            dirty_configuration = true;
-                                            conf_change_handler();
+                                            hotplugged = true;
                                        });
+
+                if (!hotplugged)
+                    return;
+
+                // A dock brings its outputs up one udev event at a time; each reconfiguration blanks
+                // the screens, so (re)start the wait for the burst to settle rather than reacting now
+                dirty_configuration = true;
+                itimerspec const timer{{0, 0}, timespec_from(hotplug_settle_delay)};
+                if (timerfd_settime(hotplug_timer, 0, &timer, nullptr) < 0)
+                {
+                    BOOST_THROW_EXCEPTION(
+                        std::system_error(errno, std::system_category(), "Failed to arm hotplug timer"));
+                }
+            }));
+
+    handlers.register_fd_handler(
+        {hotplug_timer},
+        this,
+        make_module_ptr<std::function<void(int)>>(
+            [conf_change_handler](int fd)
+            {
+                uint64_t expirations;
+                if (read(fd, &expirations, sizeof(expirations)) < 0)
+                    return;
+
+                conf_change_handler();
+            }));
+
+    if (idle_refresh_timeout == std::chrono::milliseconds::zero())
+        return;
+
+    // The compositor only wakes for changes, so noticing that there haven't been any is up to us
+    idle_timer = mir::Fd{timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK)};
+    if (idle_timer < 0)
+    {
+        BOOST_THROW_EXCEPTION(
+            std::system_error(errno, std::system_category(), "Failed to create idle refresh timer"));
+    }
+
+    auto const period = timespec_from(idle_refresh_timeout);
+    itimerspec const timer{period, period};
+    if (timerfd_settime(idle_timer, 0, &timer, nullptr) < 0)
+    {
+        BOOST_THROW_EXCEPTION(
+            std::system_error(errno, std::system_category(), "Failed to arm idle refresh timer"));
+    }
+
+    handlers.register_fd_handler(
+        {idle_timer},
+        this,
+        make_module_ptr<std::function<void(int)>>(
+            [this](int fd)
+            {
+                uint64_t expirations;
+                if (read(fd, &expirations, sizeof(expirations)) < 0)
+                    return;
+
+                auto const cutoff = std::chrono::steady_clock::now() - idle_refresh_timeout;
+                std::lock_guard<std::mutex> lock{configuration_mutex};
+                for (auto& db : display_buffers)
+                    db->drop_refresh_if_idle_since(cutoff);
             }));
 }
 
@@ -305,11 +451,12 @@ void mgg::Display::resume()
 
         /*
          * After resuming (e.g. because we switched back to the display server VT)
-         * we need to reset the CRTCs. For active displays we schedule a CRTC reset
-         * on the next swap. For connected but unused outputs we clear the CRTC.
+         * we need to reset the CRTCs. Active displays go straight back to showing
+         * what they were, ahead of the compositor's next frame. For connected but
+         * unused outputs we clear the CRTC.
          */
         for (auto& db_ptr : display_buffers)
-            db_ptr->schedule_set_crtc();
+            db_ptr->restore_crtc();
 
         clear_connected_unused_outputs();
     }
@@ -402,7 +549,7 @@ bool mgg::Display::apply_if_configuration_preserves_display_buffers(
         std::lock_guard<decltype(configuration_mutex)> lock{configuration_mutex};
         if (compatible(current_display_configuration, new_kms_conf))
         {
-            configure_locked(new_kms_conf, lock);
+            configure_locked(new_kms_conf, {}, lock);
             result = true;
         }
     }
@@ -418,6 +565,36 @@ mg::Frame mgg::Display::last_frame_on(unsigned output_id) const
     return output->last_frame();
 }
 
+auto mgg::Display::scanout_tranche(geometry::Rectangle const& output_area, bool fullscreen) const
+    -> std::experimental::optional<LinuxDmaBufUnstable::ScanoutTranche>
+{
+    std::shared_ptr<KMSOutput> showing;
+    {
+        std::lock_guard<decltype(configuration_mutex)> lock{configuration_mutex};
+        current_display_configuration.for_each_output(
+            [&](DisplayConfigurationOutput const& conf_output)
+            {
+                // DisplayBuffer::overlay() composites everything on transformed outputs
+                if (!showing && conf_output.used && conf_output.connected &&
+                    conf_output.extents() == output_area && conf_output.transformation() == glm::mat2(1))
+                {
+                    showing = current_display_configuration.get_output_for(conf_output.id);
+                }
+            });
+    }
+
+    struct stat device;
+    if (!showing || fstat(showing->drm_fd(), &device) != 0)
+        return {};
+
+    return LinuxDmaBufUnstable::ScanoutTranche{
+        device.st_rdev,
+        [showing, fullscreen](uint32_t format)
+        {
+            return fullscreen ? showing->scanout_modifiers(format) : showing->overlay_modifiers(format);
+        }};
+}
+
 namespace
 {
 /*
@@ -445,10 +622,262 @@ void add_to_drm_device_group(
         grouping.push_back(std::vector<std::shared_ptr<mgg::KMSOutput>>{std::move(output)});
     }
 }
+
+/// Whether \a conf_output is configured just as it is in \a current
+bool unchanged_in(mgg::RealKMSDisplayConfiguration const& current, mg::DisplayConfigurationOutput const& conf_output)
+{
+    bool unchanged{false};
+    current.for_each_output(
+        [&](mg::DisplayConfigurationOutput const& output)
+        {
+            if (output.id == conf_output.id)
+                unchanged = (output == conf_output);
+        });
+    return unchanged;
+}
+
+/// Whether \a conf differs from \a current in the power modes of its outputs, and in nothing else
+bool only_power_modes_differ(mgg::RealKMSDisplayConfiguration const& current, mgg::RealKMSDisplayConfiguration const& conf)
+{
+    size_t current_outputs{0};
+    size_t matched_outputs{0};
+    size_t outputs{0};
+    bool power_differs{false};
+    bool others_differ{false};
+
+    current.for_each_output([&](mg::DisplayConfigurationOutput const&) { ++current_outputs; });
+    conf.for_each_output(
+        [&](mg::DisplayConfigurationOutput const& conf_output)
+        {
+            ++outputs;
+            current.for_each_output(
+                [&](mg::DisplayConfigurationOutput const& output)
+                {
+                    if (output.id != conf_output.id)
+                        return;
+
+                    ++matched_outputs;
+                    auto repowered = conf_output;
+                    repowered.power_mode = output.power_mode;
+                    power_differs |= (conf_output.power_mode != output.power_mode);
+                    others_differ |= !(repowered == output);
+                });
+        });
+
+    return outputs == current_outputs && matched_outputs == outputs && power_differs && !others_differ;
+}
+
+auto power_mode_in(mgg::RealKMSDisplayConfiguration const& conf, mg::DisplayConfigurationOutputId id) -> MirPowerMode
+{
+    auto power_mode = mir_power_mode_off;
+    conf.for_each_output(
+        [&](mg::DisplayConfigurationOutput const& output)
+        {
+            if (output.id == id)
+                power_mode = output.power_mode;
+        });
+    return power_mode;
+}
+}
+
+auto mgg::Display::unchanged_display_buffers(RealKMSDisplayConfiguration const& kms_conf) const
+    -> std::vector<DisplayBuffer*>
+{
+    std::vector<DisplayBuffer*> unchanged;
+    OverlappingOutputGrouping grouping{kms_conf};
+
+    grouping.for_each_group(
+        [&](OverlappingOutputGroup const& group)
+        {
+            std::vector<std::vector<std::shared_ptr<KMSOutput>>> kms_output_groups;
+            bool group_unchanged{true};
+
+            group.for_each_output(
+                [&](DisplayConfigurationOutput const& conf_output)
+                {
+                    group_unchanged &= unchanged_in(current_display_configuration, conf_output);
+                    add_to_drm_device_group(
+                        kms_output_groups, current_display_configuration.get_output_for(conf_output.id));
+                });
+
+            if (!group_unchanged)
+                return;
+
+            // A DisplayBuffer that showed other outputs as well would still need replacing
+            for (auto const& outputs : kms_output_groups)
+            {
+                for (auto const& db : display_buffers)
+                {
+                    if (db->drives_exactly(outputs))
+                        unchanged.push_back(db.get());
+                }
+            }
+        });
+
+    return unchanged;
+}
+
+bool mgg::Display::apply_if_configuration_only_changes_power_modes(
+    mg::DisplayConfiguration const& conf,
+    std::function<void(mg::DisplaySyncGroup&)> const& suspend,
+    std::function<void(mg::DisplaySyncGroup&)> const& resume)
+{
+    auto const& new_kms_conf = dynamic_cast<RealKMSDisplayConfiguration const&>(conf);
+
+    struct Resuming
+    {
+        DisplayBuffer* db;
+        glm::mat2 transformation;
+        geom::Rectangle area;
+    };
+
+    {
+        std::lock_guard<decltype(configuration_mutex)> lock{configuration_mutex};
+        if (!only_power_modes_differ(current_display_configuration, new_kms_conf))
+            return false;
+
+        /*
+         * A DisplayBuffer can be kept only if all the outputs shown with it are powered off together,
+         * and brought back only if they're all powered on together.
+         */
+        bool keepable{true};
+        std::vector<DisplayBuffer*> suspending;
+        std::vector<Resuming> resuming;
+
+        OverlappingOutputGrouping{current_display_configuration}.for_each_group(
+            [&](OverlappingOutputGroup const& group)
+            {
+                size_t outputs{0};
+                std::vector<std::shared_ptr<KMSOutput>> powering_off;
+
+                group.for_each_output(
+                    [&](DisplayConfigurationOutput const& conf_output)
+                    {
+                        ++outputs;
+                        if (power_mode_in(new_kms_conf, conf_output.id) != mir_power_mode_on)
+                            powering_off.push_back(current_display_configuration.get_output_for(conf_output.id));
+                    });
+
+                if (powering_off.empty())
+                    return;
+                keepable &= (powering_off.size() == outputs);
+
+                for (auto const& db : display_buffers)
+                {
+                    if (std::any_of(powering_off.begin(), powering_off.end(),
+                                    [&db](auto const& kms_output) { return db->drives(kms_output); }))
+                    {
+                        suspending.push_back(db.get());
+                    }
+                }
+            });
+
+        OverlappingOutputGrouping{new_kms_conf}.for_each_group(
+            [&](OverlappingOutputGroup const& group)
+            {
+                size_t outputs{0};
+                size_t powering_on{0};
+                std::vector<std::vector<std::shared_ptr<KMSOutput>>> kms_output_groups;
+                glm::mat2 transformation;
+
+                group.for_each_output(
+                    [&](DisplayConfigurationOutput const& conf_output)
+                    {
+                        ++outputs;
+                        if (power_mode_in(current_display_configuration, conf_output.id) != mir_power_mode_on)
+                            ++powering_on;
+                        add_to_drm_device_group(
+                            kms_output_groups, current_display_configuration.get_output_for(conf_output.id));
+                        transformation = conf_output.transformation();
+                    });
+
+                if (powering_on == 0)
+                    return;
+                keepable &= (powering_on == outputs);
+
+                for (auto const& kms_outputs : kms_output_groups)
+                {
+                    auto const kept = std::find_if(
+                        suspended_display_buffers.begin(), suspended_display_buffers.end(),
+                        [&](auto const& db) { return db->drives_exactly(kms_outputs); });
+
+                    if (kept == suspended_display_buffers.end())
+                        keepable = false;
+                    else
+                        resuming.push_back({kept->get(), transformation, group.bounding_rectangle()});
+                }
+            });
+
+        if (!keepable)
+            return false;
+
+        for (auto const db : suspending)
+        {
+            suspend(*db);
+            db->wait_for_page_flip();
+        }
+
+        new_kms_conf.for_each_output(
+            [&](DisplayConfigurationOutput const& conf_output)
+            {
+                if (conf_output.connected &&
+                    conf_output.power_mode != power_mode_in(current_display_configuration, conf_output.id))
+                {
+                    current_display_configuration.get_output_for(conf_output.id)->set_power_mode(conf_output.power_mode);
+                }
+            });
+
+        auto const take = [](std::vector<std::unique_ptr<DisplayBuffer>>& from, DisplayBuffer* db)
+            {
+                auto const i = std::find_if(from.begin(), from.end(), [db](auto const& p) { return p.get() == db; });
+                auto taken = std::move(*i);
+                from.erase(i);
+                return taken;
+            };
+
+        for (auto const db : suspending)
+            suspended_display_buffers.push_back(take(display_buffers, db));
+
+        for (auto const& r : resuming)
+        {
+            // Orientation and the like may have changed while the outputs were off
+            r.db->set_transformation(r.transformation, r.area);
+            // Whatever the CRTCs showed was dropped with the power, so the next post() sets them
+            r.db->schedule_set_crtc();
+            display_buffers.push_back(take(suspended_display_buffers, r.db));
+        }
+
+        // configure_locked() expects the DisplayBuffers in the order of the groups they show
+        std::vector<std::unique_ptr<DisplayBuffer>> ordered;
+        OverlappingOutputGrouping{new_kms_conf}.for_each_group(
+            [&](OverlappingOutputGroup const& group)
+            {
+                group.for_each_output(
+                    [&](DisplayConfigurationOutput const& conf_output)
+                    {
+                        auto const kms_output = current_display_configuration.get_output_for(conf_output.id);
+                        for (auto& db : display_buffers)
+                        {
+                            if (db && db->drives(kms_output))
+                                ordered.push_back(std::move(db));
+                        }
+                    });
+            });
+        display_buffers = std::move(ordered);
+
+        current_display_configuration = new_kms_conf;
+
+        for (auto const& r : resuming)
+            resume(*r.db);
+    }
+
+    if (auto c = cursor.lock()) c->resume();
+    return true;
 }
 
 void mgg::Display::configure_locked(
     mgg::RealKMSDisplayConfiguration const& kms_conf,
+    std::function<void(mg::DisplaySyncGroup&)> const& release,
     std::lock_guard<std::mutex> const&)
 {
     // Treat the current_display_configuration as incompatible with itself,
@@ -458,8 +887,34 @@ void mgg::Display::configure_locked(
         compatible(kms_conf, current_display_configuration)};
     std::vector<std::unique_ptr<DisplayBuffer>> display_buffers_new;
 
+    // Given someone to release the rest to, DisplayBuffers showing unchanged outputs carry on as they are
+    std::vector<DisplayBuffer*> const unchanged{
+        !comp && release ? unchanged_display_buffers(kms_conf) : std::vector<DisplayBuffer*>{}};
+    auto const is_unchanged = [&unchanged](DisplayBuffer* db)
+        {
+            return std::find(unchanged.begin(), unchanged.end(), db) != unchanged.end();
+        };
+    auto const drives_unchanged = [&unchanged](std::shared_ptr<KMSOutput> const& kms_output)
+        {
+            return std::any_of(unchanged.begin(), unchanged.end(),
+                [&](DisplayBuffer* db) { return db->drives(kms_output); });
+        };
+
     if (!comp)
     {
+        if (release)
+        {
+            for (auto& db : display_buffers)
+            {
+                if (!is_unchanged(db.get()))
+                    release(*db);
+            }
+
+            // Those kept for powered off outputs are replaced along with the rest
+            for (auto& db : suspended_display_buffers)
+                release(*db);
+        }
+
         /*
          * Notice for a little while here we will have duplicate
          * DisplayBuffers attached to each output, and the display_buffers_new
@@ -469,13 +924,18 @@ void mgg::Display::configure_locked(
          * display_buffers_new are created and take control of the outputs.
          */
         for (auto& db : display_buffers)
-            db->wait_for_page_flip();
+        {
+            if (!is_unchanged(db.get()))
+                db->wait_for_page_flip();
+        }
 
-        /* Reset the state of all outputs */
+        /* Reset the state of all outputs we're replacing the DisplayBuffers of */
         kms_conf.for_each_output(
             [&](DisplayConfigurationOutput const& conf_output)
             {
                 auto kms_output = current_display_configuration.get_output_for(conf_output.id);
+                if (drives_unchanged(kms_output))
+                    return;
                 kms_output->clear_cursor();
                 kms_output->reset();
             });
@@ -499,6 +959,12 @@ void mgg::Display::configure_locked(
                 {
                     auto kms_output = current_display_configuration.get_output_for(conf_output.id);
 
+                    if (drives_unchanged(kms_output))
+                    {
+                        add_to_drm_device_group(kms_output_groups, std::move(kms_output));
+                        return;
+                    }
+
                     auto const mode_index = kms_conf.get_kms_mode_index(conf_output.id,
                                                                   conf_output.current_mode_index);
                     kms_output->configure(conf_output.top_left - bounding_rect.top_left, mode_index);
@@ -506,6 +972,7 @@ void mgg::Display::configure_locked(
                     {
                         kms_output->set_power_mode(conf_output.power_mode);
                         kms_output->set_gamma(conf_output.gamma);
+                        kms_output->set_adaptive_sync(adaptive_sync == AdaptiveSync::enabled);
                         add_to_drm_device_group(kms_output_groups, std::move(kms_output));
                     }
 
@@ -530,18 +997,29 @@ void mgg::Display::configure_locked(
 
                 for (auto const& group : kms_output_groups)
                 {
+                    auto const kept = std::find_if(display_buffers.begin(), display_buffers.end(),
+                        [&](auto const& db) { return db && is_unchanged(db.get()) && db->drives_exactly(group); });
+                    if (kept != display_buffers.end())
+                    {
+                        display_buffers_new.push_back(std::move(*kept));
+                        continue;
+                    }
+
                     /*
                      * In a hybrid setup a scanout surface needs to be allocated differently if it
-                     * needs to be able to be shared across GPUs. This likely reduces performance.
-                     *
-                     * As a first cut, assume every scanout buffer in a hybrid setup might need
-                     * to be shared.
+                     * needs to be able to be shared across GPUs: linear buffers can be scanned out
+                     * directly, or at least copied, by the other GPU. This likely reduces rendering
+                     * performance, so outputs on the rendering GPU keep their native layout.
                      */
-                    auto surface = gbm->create_scanout_surface(width, height, drm.size() != 1);
+                    auto const sharable = drm.size() != 1 && !renders_on(*gbm, group.front()->drm_fd());
+                    auto surface = gbm->create_scanout_surface(
+                        width, height, sharable, common_scanout_modifiers(group, GBM_FORMAT_XRGB8888));
                     auto const raw_surface = surface.get();
 
                     auto db = std::make_unique<DisplayBuffer>(
                         bypass_option,
+                        frame_deadline_margin,
+                        frame_pipelining,
                         listener,
                         group,
                         GBMOutputSurface{
@@ -564,7 +1042,10 @@ void mgg::Display::configure_locked(
         });
 
     if (!comp)
+    {
         display_buffers = std::move(display_buffers_new);
+        suspended_display_buffers.clear();
+    }
 
     /* Store applied configuration */
     current_display_configuration = kms_conf;
@@ -26,8 +26,11 @@
 #include "display_helpers.h"
 #include "egl_helper.h"
 #include "platform_common.h"
+#include "buffer_allocator.h"
+#include "mir/fd.h"
 
 #include <atomic>
+#include <chrono>
 #include <mutex>
 #include <vector>
 
@@ -60,13 +63,17 @@ class DisplayBuffer;
 class KMSOutput;
 class Cursor;
 
-class Display : public graphics::Display
+class Display : public graphics::Display, public ScanoutTargets
 {
 public:
     Display(std::vector<std::shared_ptr<helpers::DRMHelper>> const& drm,
             std::shared_ptr<helpers::GBMHelper> const& gbm,
             std::shared_ptr<ConsoleServices> const& vt,
             BypassOption bypass_option,
+            std::chrono::milliseconds frame_deadline_margin,
+            FramePipelining frame_pipelining,
+            AdaptiveSync adaptive_sync,
+            std::chrono::milliseconds idle_refresh_timeout,
             std::shared_ptr<DisplayConfigurationPolicy> const& initial_conf_policy,
             std::shared_ptr<GLConfig> const& gl_config,
             std::shared_ptr<DisplayReport> const& listener);
@@ -79,6 +86,13 @@ public:
     std::unique_ptr<DisplayConfiguration> configuration() const override;
     bool apply_if_configuration_preserves_display_buffers(DisplayConfiguration const& conf) override;
     void configure(DisplayConfiguration const& conf) override;
+    void configure_incrementally(
+        DisplayConfiguration const& conf,
+        std::function<void(graphics::DisplaySyncGroup&)> const& release) override;
+    bool apply_if_configuration_only_changes_power_modes(
+        DisplayConfiguration const& conf,
+        std::function<void(graphics::DisplaySyncGroup&)> const& suspend,
+        std::function<void(graphics::DisplaySyncGroup&)> const& resume) override;
 
     void register_configuration_change_handler(
         EventHandlerRegister& handlers,
@@ -99,6 +113,9 @@ public:
 
     Frame last_frame_on(unsigned output_id) const override;
 
+    auto scanout_tranche(geometry::Rectangle const& output_area, bool fullscreen) const
+        -> std::experimental::optional<LinuxDmaBufUnstable::ScanoutTranche> override;
+
 private:
     void clear_connected_unused_outputs();
 
@@ -108,17 +125,31 @@ private:
     std::shared_ptr<ConsoleServices> const vt;
     std::shared_ptr<DisplayReport> const listener;
     mir::udev::Monitor monitor;
+    /// Armed by each udev event, so a burst of them (a dock, say) is handled once it has settled
+    mir::Fd hotplug_timer;
     helpers::EGLHelper shared_egl;
     std::vector<std::unique_ptr<DisplayBuffer>> display_buffers;
+    /// Kept, while their outputs are powered off, for when they're powered on again
+    std::vector<std::unique_ptr<DisplayBuffer>> suspended_display_buffers;
     std::shared_ptr<KMSOutputContainer> const output_container;
     mutable RealKMSDisplayConfiguration current_display_configuration;
     mutable std::atomic<bool> dirty_configuration;
 
+    /// \param release  if set, DisplayBuffers the change leaves alone are kept, and the rest passed to it
     void configure_locked(
         RealKMSDisplayConfiguration const& conf,
+        std::function<void(graphics::DisplaySyncGroup&)> const& release,
         std::lock_guard<decltype(configuration_mutex)> const&);
+    /// The DisplayBuffers that would show the same outputs, configured just the same, under \a conf
+    auto unchanged_display_buffers(RealKMSDisplayConfiguration const& conf) const -> std::vector<DisplayBuffer*>;
 
     BypassOption bypass_option;
+    std::chrono::milliseconds const frame_deadline_margin;
+    FramePipelining const frame_pipelining;
+    AdaptiveSync const adaptive_sync;
+    /// How long without a frame before outputs drop to their slowest refresh rate; zero for never
+    std::chrono::milliseconds const idle_refresh_timeout;
+    mir::Fd idle_timer;
     std::weak_ptr<Cursor> cursor;
     std::shared_ptr<GLConfig> const gl_config;
 };
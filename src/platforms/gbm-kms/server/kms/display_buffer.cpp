@@ -43,10 +43,12 @@
 #include <chrono>
 #include <thread>
 #include <algorithm>
+#include <cmath>
 
 namespace mg = mir::graphics;
 namespace mgg = mir::graphics::gbm;
 namespace geom = mir::geometry;
+namespace mrs = mir::renderer::software;
 namespace mgmh = mir::graphics::gbm::helpers;
 
 mgg::GBMOutputSurface::FrontBuffer::FrontBuffer()
@@ -114,6 +116,9 @@ mgg::GBMOutputSurface::FrontBuffer::operator bool() const
 
 namespace
 {
+// Few display controllers have more overlay planes, and each candidate costs an FB import to test
+size_t const max_overlays{3};
+
 void require_extensions(
     std::initializer_list<char const*> extensions,
     std::function<std::string()> const& extension_getter)
@@ -164,6 +169,40 @@ void require_gl_extensions(std::initializer_list<char const*> extensions)
         });
 }
 
+/**
+ * The DRM plane rotation that scans a buffer drawn for the view area out as \a transformation
+ * would composite it, if there is one
+ */
+auto drm_rotation_for(glm::mat2 const& transformation) -> std::optional<uint32_t>
+{
+    // The transformation is in GL's coordinates, in which y goes up; KMS's y goes down
+    glm::mat2 const flip_y{1, 0, 0, -1};
+    auto const wanted = flip_y * transformation * flip_y;
+
+    // KMS reflects the buffer first, then rotates it anticlockwise
+    glm::mat2 const reflect_x{-1, 0, 0, 1};
+    std::pair<uint32_t, glm::mat2> const rotations[] = {
+        {DRM_MODE_ROTATE_0,   glm::mat2{ 1,  0,  0,  1}},
+        {DRM_MODE_ROTATE_90,  glm::mat2{ 0, -1,  1,  0}},
+        {DRM_MODE_ROTATE_180, glm::mat2{-1,  0,  0, -1}},
+        {DRM_MODE_ROTATE_270, glm::mat2{ 0,  1, -1,  0}}};
+
+    for (auto const& [rotation, rotate] : rotations)
+    {
+        if (rotate == wanted)
+            return rotation;
+        if (rotate * reflect_x == wanted)
+            return rotation | DRM_MODE_REFLECT_X;
+    }
+
+    return std::nullopt;
+}
+
+bool is_quarter_turn(uint32_t rotation)
+{
+    return (rotation & (DRM_MODE_ROTATE_90 | DRM_MODE_ROTATE_270)) != 0;
+}
+
 bool needs_bounce_buffer(mgg::KMSOutput const& destination, gbm_bo* source)
 {
     return destination.buffer_requires_migration(source);
@@ -247,7 +286,7 @@ public:
           device{drm_fd},
           width{width},
           height{height},
-          surface{device.create_scanout_surface(width, height, false)},
+          surface{device.create_scanout_surface(width, height, false, {})},
           egl{NoAuxGlConfig{}}
     {
         egl.setup(device, surface.get(), EGL_NO_CONTEXT, true);
@@ -428,6 +467,8 @@ public:
 
 mgg::DisplayBuffer::DisplayBuffer(
     mgg::BypassOption option,
+    std::chrono::milliseconds frame_deadline_margin,
+    mgg::FramePipelining frame_pipelining,
     std::shared_ptr<DisplayReport> const& listener,
     std::vector<std::shared_ptr<KMSOutput>> const& outputs,
     GBMOutputSurface&& surface_gbm,
@@ -435,12 +476,15 @@ mgg::DisplayBuffer::DisplayBuffer(
     glm::mat2 const& transformation)
     : listener(listener),
       bypass_option(option),
+      frame_pipelining{frame_pipelining},
       outputs(outputs),
       surface{std::move(surface_gbm)},
       area(area),
       transform{transformation},
       needs_set_crtc{false},
-      page_flips_pending{false}
+      page_flips_pending{false},
+      scheduler{frame_deadline_margin},
+      last_post{std::chrono::steady_clock::now()}
 {
     listener->report_successful_setup_of_native_resources();
 
@@ -477,6 +521,7 @@ mgg::DisplayBuffer::DisplayBuffer(
     }
 
     visible_composite_frame = get_front_buffer(std::move(temporary_front));
+    scanout_device = gbm_bo_get_device(visible_composite_frame);
 
     /*
      * Check that our (possibly bounced) front buffer is usable on *all* the
@@ -491,9 +536,15 @@ mgg::DisplayBuffer::DisplayBuffer(
         }
     }
 
-    set_crtc(*outputs.front()->fb_for(visible_composite_frame));
+    auto const composite_fb = outputs.front()->fb_for(visible_composite_frame);
+    // The outputs may have been rotated for a bypass buffer of an earlier configuration
+    for (auto const& output : outputs)
+        output->rotate_scanout(*composite_fb, DRM_MODE_ROTATE_0);
+    set_crtc(*composite_fb);
 
     release_current();
+    render_start = std::nullopt;
+    unfinished_render_start = std::nullopt;
 
     listener->report_successful_drm_mode_set_crtc_on_construction();
     listener->report_successful_display_construction();
@@ -524,36 +575,162 @@ void mgg::DisplayBuffer::set_transformation(glm::mat2 const& t, geometry::Rectan
     area = a;
 }
 
-bool mgg::DisplayBuffer::overlay(RenderableList const& renderable_list)
+bool mgg::DisplayBuffer::overlay(RenderableList& renderable_list)
 {
-    glm::mat2 static const no_transformation(1);
-    if (transform == no_transformation &&
+    bypass_buf = nullptr;
+    bypass_bufobj = nullptr;
+    bypass_tearing = false;
+    bypass_rotated = false;
+    overlay_bufs.clear();
+
+    /*
+     * On a rotated or reflected output, the hardware may be able to scan buffers out transformed.
+     * In clone mode each output would need its own rotation tested, so we don't bother.
+     */
+    auto const rotation = drm_rotation_for(transform);
+    if (rotation && (*rotation == DRM_MODE_ROTATE_0 || outputs.size() == 1) &&
        (bypass_option == mgg::BypassOption::allowed))
     {
-        mgg::BypassMatch bypass_match(area);
-        auto bypass_it = std::find_if(renderable_list.rbegin(), renderable_list.rend(), bypass_match);
-        if (bypass_it != renderable_list.rend())
+        if (bypass(renderable_list, *rotation))
+        {
+            for (auto const& output : outputs)
+                output->assign_overlays({});
+            return true;
+        }
+
+        // A fullscreen game beneath a small OSD can still bypass, once the OSD is on an overlay
+        assign_overlays(renderable_list, *rotation);
+        if (!overlay_bufs.empty() && bypass(renderable_list, *rotation))
+            return true;
+    }
+    else
+    {
+        for (auto const& output : outputs)
+            output->assign_overlays({});
+    }
+
+    return false;
+}
+
+bool mgg::DisplayBuffer::bypass(RenderableList const& renderable_list, uint32_t rotation)
+{
+    // The buffer is drawn for the view area, so a quarter turn scans its columns out as rows
+    auto const output_size = surface.size();
+    auto const buffer_size = is_quarter_turn(rotation) ?
+        geom::Size{output_size.height, output_size.width} :
+        output_size;
+
+    mgg::BypassMatch bypass_match(area);
+    auto bypass_it = std::find_if(renderable_list.rbegin(), renderable_list.rend(), bypass_match);
+    if (bypass_it != renderable_list.rend())
+    {
+        auto bypass_buffer = (*bypass_it)->buffer();
+        auto dmabuf_image = dynamic_cast<mg::DMABufBuffer*>(bypass_buffer->native_buffer_base());
+        if (dmabuf_image &&
+            bypass_buffer->size() == buffer_size)
         {
-            auto bypass_buffer = (*bypass_it)->buffer();
-            auto dmabuf_image = dynamic_cast<mg::DMABufBuffer*>(bypass_buffer->native_buffer_base());
-            if (dmabuf_image &&
-                bypass_buffer->size() == surface.size())
+            auto bufobj = outputs.front()->fb_for(*dmabuf_image);
+            if (bufobj && (rotation == DRM_MODE_ROTATE_0 || outputs.front()->rotate_scanout(*bufobj, rotation)))
             {
-                if (auto bufobj = outputs.front()->fb_for(*dmabuf_image))
-                {
-                    bypass_buf = bypass_buffer;
-                    bypass_bufobj = bufobj;
-                    return true;
-                }
+                bypass_buf = bypass_buffer;
+                bypass_bufobj = bufobj;
+                bypass_tearing = (*bypass_it)->tearing_allowed();
+                bypass_rotated = (rotation != DRM_MODE_ROTATE_0);
+                return true;
             }
         }
     }
 
-    bypass_buf = nullptr;
-    bypass_bufobj = nullptr;
     return false;
 }
 
+void mgg::DisplayBuffer::assign_overlays(RenderableList& renderable_list, uint32_t rotation)
+{
+    /*
+     * Overlay planes sit above the primary plane, so only the top of the
+     * stack can go on them; everything below is composited onto the primary
+     * plane. In clone mode each output would need its own assignment, so we
+     * don't bother.
+     */
+    if (outputs.size() != 1)
+    {
+        for (auto const& output : outputs)
+            output->assign_overlays({});
+        return;
+    }
+
+    auto const& output = outputs.front();
+
+    // Top first, as we find them
+    std::vector<Overlay> candidates;
+    std::vector<std::shared_ptr<Renderable>> renderables;
+    for (auto it = renderable_list.rbegin();
+         it != renderable_list.rend() && candidates.size() < max_overlays;
+         ++it)
+    {
+        auto const& renderable = *it;
+        if (!area.overlaps(renderable->screen_position()))
+            continue;
+        if (!can_overlay(area, *renderable))
+            break;
+
+        auto const buffer = renderable->buffer();
+        auto const fb = output->fb_for(*dynamic_cast<mg::DMABufBuffer*>(buffer->native_buffer_base()));
+        if (!fb)
+            break;
+
+        candidates.push_back({fb, renderable->src_bounds(), scanout_rect(renderable->screen_position()), rotation});
+        renderables.push_back(renderable);
+    }
+
+    // If the hardware can't show them all, it may manage the topmost few
+    for (auto count = candidates.size(); count != 0; --count)
+    {
+        std::vector<Overlay> const overlays(candidates.rend() - count, candidates.rend());
+        if (output->assign_overlays(overlays))
+        {
+            renderables.resize(count);
+            for (auto const& renderable : renderables)
+                overlay_bufs.push_back(renderable->buffer());
+
+            renderable_list.erase(
+                std::remove_if(
+                    renderable_list.begin(), renderable_list.end(),
+                    [&renderables](auto const& renderable)
+                    {
+                        return std::find(renderables.begin(), renderables.end(), renderable) != renderables.end();
+                    }),
+                renderable_list.end());
+            return;
+        }
+    }
+
+    output->assign_overlays({});
+}
+
+auto mgg::DisplayBuffer::scanout_rect(geom::Rectangle const& rect) const -> geom::Rectangle
+{
+    if (transform == glm::mat2(1))
+        return {rect.top_left - as_displacement(area.top_left), rect.size};
+
+    // Transform the corners about the centres of the view area and the scanout, in KMS's y-down coordinates
+    glm::mat2 const flip_y{1, 0, 0, -1};
+    auto const to_scanout = flip_y * transform * flip_y;
+    glm::vec2 const area_centre{
+        area.top_left.x.as_int() + area.size.width.as_int() / 2.0f,
+        area.top_left.y.as_int() + area.size.height.as_int() / 2.0f};
+    glm::vec2 const scanout_centre{surface.size().width.as_int() / 2.0f, surface.size().height.as_int() / 2.0f};
+
+    auto const a = to_scanout * (glm::vec2{rect.top_left.x.as_int(), rect.top_left.y.as_int()} - area_centre);
+    auto const b = to_scanout * (glm::vec2{rect.bottom_right().x.as_int(), rect.bottom_right().y.as_int()} - area_centre);
+    auto const top_left = glm::min(a, b) + scanout_centre;
+    auto const size = glm::abs(b - a);
+
+    return {
+        {std::lround(top_left.x), std::lround(top_left.y)},
+        {std::lround(size.x), std::lround(size.y)}};
+}
+
 void mgg::DisplayBuffer::for_each_display_buffer(
     std::function<void(graphics::DisplayBuffer&)> const& f)
 {
@@ -562,9 +739,47 @@ void mgg::DisplayBuffer::for_each_display_buffer(
 
 void mgg::DisplayBuffer::swap_buffers()
 {
+    finish_render_time();
     surface.swap_buffers();
     bypass_buf = nullptr;
     bypass_bufobj = nullptr;
+    bypass_tearing = false;
+    bypass_rotated = false;
+}
+
+void mgg::DisplayBuffer::swap_buffers_with_damage(geometry::Rectangles const& damage)
+{
+    finish_render_time();
+    surface.swap_buffers_with_damage(damage);
+    bypass_buf = nullptr;
+    bypass_bufobj = nullptr;
+    bypass_tearing = false;
+    bypass_rotated = false;
+}
+
+void mgg::DisplayBuffer::collect_render_time()
+{
+    if (!unfinished_render_start)
+        return;
+
+    // Without a fence all we can measure is the CPU's part, up to now
+    if (auto const finished = surface.rendering_finished())
+    {
+        scheduler.record_render_time(*finished - *unfinished_render_start);
+        unfinished_render_start = std::nullopt;
+    }
+}
+
+void mgg::DisplayBuffer::finish_render_time()
+{
+    collect_render_time();
+
+    // The swap replaces the fence, and the GPU taking this long is at least as bad as we can tell
+    if (unfinished_render_start)
+    {
+        scheduler.record_render_time(mir::time::PosixTimestamp::now(CLOCK_MONOTONIC) - *unfinished_render_start);
+        unfinished_render_start = std::nullopt;
+    }
 }
 
 void mgg::DisplayBuffer::set_crtc(FBHandle const& forced_frame)
@@ -587,6 +802,26 @@ void mgg::DisplayBuffer::set_crtc(FBHandle const& forced_frame)
 
 void mgg::DisplayBuffer::post()
 {
+    bool const composited = !bypass_buf;
+    if (render_start && composited)
+    {
+        unfinished_render_start = render_start;
+        // The GPU has usually only just been given the frame, so we'll likely check again later
+        collect_render_time();
+    }
+    render_start = std::nullopt;
+
+    std::lock_guard<std::mutex> lock{idle_mutex};
+    last_post = std::chrono::steady_clock::now();
+    // Something changed, so the outputs go back to full rate with this frame
+    if (idle_refresh)
+    {
+        for (auto& output : outputs)
+            output->set_idle_refresh(false);
+        idle_refresh = false;
+        needs_set_crtc = true;
+    }
+
     /*
      * We might not have waited for the previous frame to page flip yet.
      * This is good because it maximizes the time available to spend rendering
@@ -600,6 +835,16 @@ void mgg::DisplayBuffer::post()
     {
         bufobj = bypass_bufobj;
     }
+    else if (software_frame_posted)
+    {
+        // The software renderer drew straight into a scanout buffer
+        bufobj = outputs.front()->fb_for(software_framebuffers->front());
+        if (!bufobj)
+            fatal_error("Failed to get software framebuffer object");
+        scheduled_composite_frame = nullptr;
+        scheduled_software_frame = true;
+        software_frame_posted = false;
+    }
     else
     {
         scheduled_composite_frame = get_front_buffer(surface.lock_front());
@@ -608,12 +853,29 @@ void mgg::DisplayBuffer::post()
             fatal_error("Failed to get front buffer object");
     }
 
+    // A rotated bypass buffer had the rotation tested and set by bypass(); anything else is shown as it is
+    if (!bypass_rotated)
+    {
+        for (auto const& output : outputs)
+            output->rotate_scanout(*bufobj, DRM_MODE_ROTATE_0);
+    }
+
     scheduled_fb = std::move(bufobj);
+    // Whatever is on the overlay planes goes out with the primary framebuffer
+    scheduled_overlay_bufs = std::move(overlay_bufs);
+    overlay_bufs.clear();
     /*
-     * Try to schedule a page flip as first preference to avoid tearing.
+     * A bypassed client that asked to tear gets its buffer on screen without
+     * waiting for vblank, where the hardware allows.
+     */
+    bool const tearing = bypass_buf && bypass_tearing && !needs_set_crtc &&
+        schedule_async_page_flip(*scheduled_fb);
+
+    /*
+     * Otherwise try to schedule a page flip as first preference to avoid tearing.
      * [will complete in a background thread]
      */
-    if (!needs_set_crtc && !schedule_page_flip(*scheduled_fb))
+    if (!tearing && !needs_set_crtc && !schedule_page_flip(*scheduled_fb))
         needs_set_crtc = true;
 
     /*
@@ -630,11 +892,6 @@ void mgg::DisplayBuffer::post()
         needs_set_crtc = false;
     }
 
-    using namespace std::chrono_literals;  // For operator""ms()
-
-    // Predicted worst case render time for the next frame...
-    auto predicted_render_time = 50ms;
-
     if (bypass_buf)
     {
         /*
@@ -648,10 +905,6 @@ void mgg::DisplayBuffer::post()
          */
         scheduled_bypass_frame = bypass_buf;
         wait_for_page_flip();
-
-        // It's very likely the next frame will be bypassed like this one so
-        // we only need time for kernel page flip scheduling...
-        predicted_render_time = 5ms;
     }
     else
     {
@@ -659,36 +912,66 @@ void mgg::DisplayBuffer::post()
          * Not in clone mode? We can afford to wait for the page flip then,
          * making us double-buffered (noticeably less laggy than the triple
          * buffering that clone mode requires).
-         */
-        if (outputs.size() == 1)
-            wait_for_page_flip();
-
-        /*
-         * TODO: If you're optimistic about your GPU performance and/or
-         *       measure it carefully you may wish to set predicted_render_time
-         *       to a lower value here for lower latency.
          *
-         *predicted_render_time = 9ms; // e.g. about the same as Weston
+         * Unless we're pipelining: then the next frame is rendered while
+         * this one waits for vblank, and it's the next post() that waits
+         * for the flip. Only one flip can be pending per CRTC, so we are
+         * never more than a frame ahead.
          */
+        if (outputs.size() == 1 && frame_pipelining == mgg::FramePipelining::disabled)
+            wait_for_page_flip();
     }
 
     // Buffer lifetimes are managed exclusively by scheduled*/visible* now
     bypass_buf = nullptr;
     bypass_bufobj = nullptr;
+    bypass_tearing = false;
+    bypass_rotated = false;
+
+    // The next frame is very likely to be bypassed (or not), and to tear (or not), like this one
+    last_post_composited = composited;
+    last_post_tore = tearing;
+    last_post_time = mir::time::PosixTimestamp::now(CLOCK_MONOTONIC);
+}
+
+std::chrono::milliseconds mgg::DisplayBuffer::recommended_sleep() const
+{
+    // A tearing client isn't waiting on vblank, so neither should its next frame
+    if (last_post_tore)
+        return std::chrono::milliseconds{0};
 
-    recommend_sleep = 0ms;
-    if (outputs.size() == 1)
+    /*
+     * Start the next frame as late as we can while still finishing it for
+     * the next vblank we can make on every output. This is worked out when
+     * the compositor asks, just before it samples the scene, so even a frame
+     * started by a buffer arriving at an idle output latches the newest
+     * buffers at the last safe moment.
+     */
+    std::vector<mg::common::FrameScheduler::OutputTiming> timings;
+    std::chrono::nanoseconds longest_interval{0};
+    for (auto const& output : outputs)
     {
-        auto const& output = outputs.front();
-        auto const min_frame_interval = 1000ms / output->max_refresh_rate();
-        if (predicted_render_time < min_frame_interval)
-            recommend_sleep = min_frame_interval - predicted_render_time;
+        using namespace std::chrono_literals;
+        if (auto const refresh_rate = output->max_refresh_rate())
+        {
+            timings.push_back(
+                {output->last_frame(), std::chrono::nanoseconds{1s} / refresh_rate, output->adaptive_sync()});
+            longest_interval = std::max(longest_interval, timings.back().frame_interval);
+        }
     }
+
+    // We only wait for a flip at the next post(), but one scheduled a whole frame ago has landed
+    auto const since_post = mir::time::PosixTimestamp::now(CLOCK_MONOTONIC) - last_post_time;
+    bool const flips_pending = page_flips_pending && since_post < longest_interval;
+
+    auto const clock = timings.empty() ? CLOCK_MONOTONIC : timings.front().last_frame.ust.clock_id;
+    return scheduler.delay_before_next_frame(
+        mir::time::PosixTimestamp::now(clock), timings, flips_pending, last_post_composited);
 }
 
-std::chrono::milliseconds mgg::DisplayBuffer::recommended_sleep() const
+mg::Frame mgg::DisplayBuffer::last_frame() const
 {
-    return recommend_sleep;
+    return outputs.empty() ? Frame{} : outputs.front()->last_frame();
 }
 
 bool mgg::DisplayBuffer::schedule_page_flip(FBHandle const& bufobj)
@@ -706,6 +989,16 @@ bool mgg::DisplayBuffer::schedule_page_flip(FBHandle const& bufobj)
     return page_flips_pending;
 }
 
+bool mgg::DisplayBuffer::schedule_async_page_flip(FBHandle const& bufobj)
+{
+    // In clone mode a flip that only some outputs could take would leave them out of step
+    if (outputs.size() != 1 || !outputs.front()->schedule_async_page_flip(bufobj))
+        return false;
+
+    page_flips_pending = true;
+    return true;
+}
+
 void mgg::DisplayBuffer::wait_for_page_flip()
 {
     if (page_flips_pending)
@@ -720,7 +1013,7 @@ void mgg::DisplayBuffer::wait_for_page_flip()
         page_flips_pending = false;
     }
 
-    if (scheduled_bypass_frame || scheduled_composite_frame)
+    if (scheduled_bypass_frame || scheduled_composite_frame || scheduled_software_frame)
     {
         // Why are both of these grouped into a single statement?
         // Because in either case both types of frame need releasing each time.
@@ -730,11 +1023,58 @@ void mgg::DisplayBuffer::wait_for_page_flip()
 
         visible_composite_frame = std::move(scheduled_composite_frame);
         scheduled_composite_frame = nullptr;
+        scheduled_software_frame = false;
+
+        visible_overlay_bufs = std::move(scheduled_overlay_bufs);
+        scheduled_overlay_bufs.clear();
     }
 }
 
+void mgg::DisplayBuffer::drop_refresh_if_idle_since(std::chrono::steady_clock::time_point cutoff)
+{
+    std::lock_guard<std::mutex> lock{idle_mutex};
+    // Setting the CRTC would take down the overlay planes with what they show
+    if (idle_refresh || last_post > cutoff || !visible_overlay_bufs.empty())
+        return;
+
+    wait_for_page_flip();
+    if (!visible_fb)
+        return;
+
+    bool dropped{false};
+    for (auto& output : outputs)
+    {
+        // Adaptive sync already stretches vblank while we aren't flipping
+        if (!output->adaptive_sync() && output->set_idle_refresh(true))
+            dropped = true;
+    }
+
+    if (dropped)
+    {
+        set_crtc(*visible_fb);
+        idle_refresh = true;
+    }
+}
+
+bool mgg::DisplayBuffer::drives(std::shared_ptr<KMSOutput> const& output) const
+{
+    return std::find(outputs.begin(), outputs.end(), output) != outputs.end();
+}
+
+bool mgg::DisplayBuffer::drives_exactly(std::vector<std::shared_ptr<KMSOutput>> const& outputs) const
+{
+    return this->outputs == outputs;
+}
+
 void mgg::DisplayBuffer::make_current()
 {
+    // The compositor makes us current to start rendering (and maybe again later in the frame)
+    if (!render_start)
+    {
+        collect_render_time();
+        render_start = mir::time::PosixTimestamp::now(CLOCK_MONOTONIC);
+    }
+
     surface.make_current();
 }
 
@@ -743,6 +1083,22 @@ void mgg::DisplayBuffer::bind()
     surface.bind();
 }
 
+auto mgg::DisplayBuffer::map_framebuffer() -> std::unique_ptr<mrs::Mapping<unsigned char>>
+{
+    if (!software_framebuffers)
+        software_framebuffers.emplace(scanout_device, surface.size());
+
+    // The back buffer is the one on screen until the last frame has flipped
+    wait_for_page_flip();
+    return software_framebuffers->map_back();
+}
+
+void mgg::DisplayBuffer::post(geom::Rectangles const& damage)
+{
+    software_framebuffers->swap(damage);
+    software_frame_posted = true;
+}
+
 void mgg::DisplayBuffer::release_current()
 {
     surface.release_current();
@@ -753,6 +1109,20 @@ void mgg::DisplayBuffer::schedule_set_crtc()
     needs_set_crtc = true;
 }
 
+void mgg::DisplayBuffer::restore_crtc()
+{
+    wait_for_page_flip();
+
+    // Setting the CRTC would leave the overlay planes off, so leave it all to the next post()
+    if (!visible_fb || !visible_overlay_bufs.empty())
+    {
+        needs_set_crtc = true;
+        return;
+    }
+
+    set_crtc(*visible_fb);
+}
+
 mg::NativeDisplayBuffer* mgg::DisplayBuffer::native_display_buffer()
 {
     return this;
@@ -801,6 +1171,12 @@ void mgg::GBMOutputSurface::swap_buffers()
         fatal_error("Failed to perform buffer swap");
 }
 
+void mgg::GBMOutputSurface::swap_buffers_with_damage(geometry::Rectangles const& damage)
+{
+    if (!egl.swap_buffers_with_damage(damage))
+        fatal_error("Failed to perform buffer swap");
+}
+
 void mgg::GBMOutputSurface::bind()
 {
 
@@ -811,6 +1187,11 @@ auto mgg::GBMOutputSurface::lock_front() -> FrontBuffer
     return FrontBuffer{surface.get()};
 }
 
+auto mgg::GBMOutputSurface::rendering_finished() -> std::optional<time::PosixTimestamp>
+{
+    return egl.rendering_finished();
+}
+
 void mgg::GBMOutputSurface::report_egl_configuration(
     std::function<void(EGLDisplay, EGLConfig)> const& to)
 {
@@ -22,13 +22,19 @@
 #include "mir/graphics/display_buffer.h"
 #include "mir/graphics/display.h"
 #include "mir/renderer/gl/render_target.h"
+#include "mir/renderer/sw/render_target.h"
 #include "display_helpers.h"
 #include "egl_helper.h"
 #include "platform_common.h"
+#include "frame_scheduler.h"
+#include "software_framebuffers.h"
 
 #include <vector>
 #include <memory>
 #include <atomic>
+#include <optional>
+#include <mutex>
+#include <chrono>
 
 namespace mir
 {
@@ -81,9 +87,12 @@ public:
     void make_current() override;
     void release_current() override;
     void swap_buffers() override;
+    void swap_buffers_with_damage(geometry::Rectangles const& damage) override;
     void bind() override;
 
     FrontBuffer lock_front();
+    /// When the GPU finished rendering the last swapped buffer, or nullopt if it hasn't yet
+    auto rendering_finished() -> std::optional<time::PosixTimestamp>;
     void report_egl_configuration(std::function<void(EGLDisplay, EGLConfig)> const& to);
     geometry::Size size() const { return {width, height}; }
 private:
@@ -96,10 +105,13 @@ private:
 class DisplayBuffer : public graphics::DisplayBuffer,
                       public graphics::DisplaySyncGroup,
                       public graphics::NativeDisplayBuffer,
-                      public renderer::gl::RenderTarget
+                      public renderer::gl::RenderTarget,
+                      public renderer::software::RenderTarget
 {
 public:
     DisplayBuffer(BypassOption bypass_options,
+                  std::chrono::milliseconds frame_deadline_margin,
+                  FramePipelining frame_pipelining,
                   std::shared_ptr<DisplayReport> const& listener,
                   std::vector<std::shared_ptr<KMSOutput>> const& outputs,
                   GBMOutputSurface&& surface_gbm,
@@ -111,30 +123,71 @@ public:
     void make_current() override;
     void release_current() override;
     void swap_buffers() override;
-    bool overlay(RenderableList const& renderlist) override;
+    void swap_buffers_with_damage(geometry::Rectangles const& damage) override;
+    bool overlay(RenderableList& renderlist) override;
     void bind() override;
 
+    auto map_framebuffer() -> std::unique_ptr<renderer::software::Mapping<unsigned char>> override;
+    void post(geometry::Rectangles const& damage) override;
+
     void for_each_display_buffer(
         std::function<void(graphics::DisplayBuffer&)> const& f) override;
     void post() override;
     std::chrono::milliseconds recommended_sleep() const override;
+    Frame last_frame() const override;
 
     glm::mat2 transformation() const override;
     NativeDisplayBuffer* native_display_buffer() override;
 
     void set_transformation(glm::mat2 const& t, geometry::Rectangle const& a);
     void schedule_set_crtc();
+    /**
+     * Sets the CRTCs to show the last frame posted, now rather than on the next post()
+     *
+     * \note   Only while the compositor isn't posting to us, as after a pause.
+     */
+    void restore_crtc();
     void wait_for_page_flip();
+    /**
+     * Drops the outputs to their slowest refresh rate if nothing has been posted since \a cutoff.
+     * The next post() restores the full rate.
+     */
+    void drop_refresh_if_idle_since(std::chrono::steady_clock::time_point cutoff);
+
+    /// Whether \a output is one of the outputs this shows
+    bool drives(std::shared_ptr<KMSOutput> const& output) const;
+    /// Whether this shows \a outputs, and no others
+    bool drives_exactly(std::vector<std::shared_ptr<KMSOutput>> const& outputs) const;
 
 private:
+    /**
+     * Shows the renderable on top of renderlist on the primary plane, if it fills the output
+     *
+     * \param [in] rotation  The DRM rotation that shows the output's transformation
+     */
+    bool bypass(RenderableList const& renderlist, uint32_t rotation);
+    /// Takes as much of the top of renderlist as the hardware allows for overlay planes
+    void assign_overlays(RenderableList& renderlist, uint32_t rotation);
+    /// Where \a rect, on the view area, is on the output's (possibly rotated) scanout
+    auto scanout_rect(geometry::Rectangle const& rect) const -> geometry::Rectangle;
     bool schedule_page_flip(FBHandle const& bufobj);
+    /// Flips without waiting for vblank, if there's a single output and it can
+    bool schedule_async_page_flip(FBHandle const& bufobj);
     void set_crtc(FBHandle const&);
+    /// Record the render time of the last composited frame, if the GPU has finished it
+    void collect_render_time();
+    /// As collect_render_time(), but before the next swap replaces the fence, so don't wait any longer
+    void finish_render_time();
 
     std::shared_ptr<graphics::Buffer> visible_bypass_frame, scheduled_bypass_frame;
     std::shared_ptr<Buffer> bypass_buf{nullptr};
     std::shared_ptr<FBHandle const> bypass_bufobj{nullptr};
+    bool bypass_tearing{false};     ///< The bypassed renderable would rather tear than wait for vblank
+    bool bypass_rotated{false};     ///< The bypass buffer has had the output's scanout rotated for it
+    std::vector<std::shared_ptr<graphics::Buffer>> overlay_bufs, scheduled_overlay_bufs, visible_overlay_bufs;
     std::shared_ptr<DisplayReport> const listener;
     BypassOption bypass_option;
+    FramePipelining const frame_pipelining;
 
     std::vector<std::shared_ptr<KMSOutput>> outputs;
 
@@ -150,14 +203,34 @@ private:
     GBMOutputSurface::FrontBuffer visible_composite_frame;
     GBMOutputSurface::FrontBuffer scheduled_composite_frame;
 
+    /// Where the composite frames are scanned out from, so where software framebuffers have to be
+    gbm_device* scanout_device{nullptr};
+    /// Only allocated once something renders in software
+    std::optional<SoftwareFramebuffers> software_framebuffers;
+    bool software_frame_posted{false};
+    bool scheduled_software_frame{false};
+
     std::shared_ptr<FBHandle const> scheduled_fb{nullptr};
     std::shared_ptr<FBHandle const> visible_fb{nullptr};
 
     geometry::Rectangle area;
     glm::mat2 transform;
     std::atomic<bool> needs_set_crtc;
-    std::chrono::milliseconds recommend_sleep{0};
+    bool last_post_composited{true};
+    bool last_post_tore{false};
+    time::PosixTimestamp last_post_time;
     bool page_flips_pending;
+
+    common::FrameScheduler scheduler;
+    /// When we started rendering the frame we're about to post, if we have
+    std::optional<time::PosixTimestamp> render_start;
+    /// When we started rendering the last composited frame, until we see the GPU finish it
+    std::optional<time::PosixTimestamp> unfinished_render_start;
+
+    /// Serialises post() with dropping the refresh rate from the display's idle timer
+    std::mutex idle_mutex;
+    std::chrono::steady_clock::time_point last_post;
+    bool idle_refresh{false};
 };
 
 }
@@ -19,9 +19,16 @@
 #include "egl_helper.h"
 #include "mir/graphics/gl_config.h"
 #include "mir/graphics/egl_error.h"
+#include "mir/fd.h"
 #include <boost/exception/errinfo_errno.hpp>
 #include <boost/throw_exception.hpp>
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include <linux/sync_file.h>
+#include <sys/ioctl.h>
+
 #define MIR_LOG_COMPONENT "EGL"
 #include "mir/log.h"
 
@@ -29,6 +36,29 @@ namespace mg = mir::graphics;
 namespace mgg = mir::graphics::gbm;
 namespace mgmh = mir::graphics::gbm::helpers;
 
+namespace
+{
+/// When the kernel saw every fence in a sync_file signal, if it has
+auto signal_time(mir::Fd const& sync_file) -> std::optional<mir::time::PosixTimestamp>
+{
+    sync_file_info info{};
+    if (ioctl(sync_file, SYNC_IOC_FILE_INFO, &info) < 0 || info.num_fences == 0)
+        return std::nullopt;
+
+    std::vector<sync_fence_info> fences(info.num_fences);
+    info.sync_fence_info = reinterpret_cast<uintptr_t>(fences.data());
+    if (ioctl(sync_file, SYNC_IOC_FILE_INFO, &info) < 0 || info.status != 1)
+        return std::nullopt;
+
+    auto const last = std::max_element(
+        fences.begin(), fences.end(),
+        [](auto const& a, auto const& b) { return a.timestamp_ns < b.timestamp_ns; });
+
+    // Fence timestamps come from ktime_get(), which is CLOCK_MONOTONIC
+    return mir::time::PosixTimestamp{CLOCK_MONOTONIC, std::chrono::nanoseconds{last->timestamp_ns}};
+}
+}
+
 mgmh::EGLHelper::EGLHelper(GLConfig const& gl_config)
     : depth_buffer_bits{gl_config.depth_buffer_bits()},
       stencil_buffer_bits{gl_config.stencil_buffer_bits()},
@@ -55,8 +85,15 @@ mgmh::EGLHelper::EGLHelper(EGLHelper&& from)
       egl_config{from.egl_config},
       egl_context{from.egl_context},
       egl_surface{from.egl_surface},
-      should_terminate_egl{from.should_terminate_egl}
+      should_terminate_egl{from.should_terminate_egl},
+      swap_with_damage{from.swap_with_damage},
+      create_sync{from.create_sync},
+      destroy_sync{from.destroy_sync},
+      client_wait_sync{from.client_wait_sync},
+      dup_native_fence{from.dup_native_fence},
+      rendering_fence{from.rendering_fence}
 {
+    from.rendering_fence = EGL_NO_SYNC_KHR;
     from.should_terminate_egl = false;
     from.egl_display = EGL_NO_DISPLAY;
     from.egl_context = EGL_NO_CONTEXT;
@@ -129,6 +166,8 @@ void mgmh::EGLHelper::setup(
 mgmh::EGLHelper::~EGLHelper() noexcept
 {
     if (egl_display != EGL_NO_DISPLAY) {
+        if (rendering_fence != EGL_NO_SYNC_KHR)
+            destroy_sync(egl_display, rendering_fence);
         if (egl_context != EGL_NO_CONTEXT)
         {
             eglBindAPI(EGL_OPENGL_ES_API);
@@ -146,9 +185,60 @@ mgmh::EGLHelper::~EGLHelper() noexcept
 bool mgmh::EGLHelper::swap_buffers()
 {
     auto ret = eglSwapBuffers(egl_display, egl_surface);
+    fence_rendering();
+    return (ret == EGL_TRUE);
+}
+
+bool mgmh::EGLHelper::swap_buffers_with_damage(geometry::Rectangles const& damage)
+{
+    if (!swap_with_damage)
+        return swap_buffers();
+
+    auto ret = (*swap_with_damage)(egl_display, egl_surface, damage);
+    fence_rendering();
     return (ret == EGL_TRUE);
 }
 
+void mgmh::EGLHelper::fence_rendering()
+{
+    if (!create_sync)
+        return;
+
+    if (rendering_fence != EGL_NO_SYNC_KHR)
+        destroy_sync(egl_display, rendering_fence);
+
+    // A native fence can tell us when it signalled, rather than when we noticed
+    rendering_fence = dup_native_fence ?
+        create_sync(egl_display, EGL_SYNC_NATIVE_FENCE_ANDROID, nullptr) :
+        create_sync(egl_display, EGL_SYNC_FENCE_KHR, nullptr);
+}
+
+auto mgmh::EGLHelper::rendering_finished() -> std::optional<time::PosixTimestamp>
+{
+    auto const now = time::PosixTimestamp::now(CLOCK_MONOTONIC);
+    if (rendering_fence == EGL_NO_SYNC_KHR)
+        return now;
+
+    // Don't wait: the flush just makes sure the fence will signal at all
+    auto const result = client_wait_sync(
+        egl_display, rendering_fence, EGL_SYNC_FLUSH_COMMANDS_BIT_KHR, 0);
+    if (result == EGL_TIMEOUT_EXPIRED_KHR)
+        return std::nullopt;
+
+    std::optional<time::PosixTimestamp> finished;
+    if (result == EGL_CONDITION_SATISFIED_KHR && dup_native_fence)
+    {
+        mir::Fd const sync_file{dup_native_fence(egl_display, rendering_fence)};
+        if (sync_file >= 0)
+            finished = signal_time(sync_file);
+    }
+
+    destroy_sync(egl_display, rendering_fence);
+    rendering_fence = EGL_NO_SYNC_KHR;
+
+    return finished ? std::min(*finished, now) : now;
+}
+
 bool mgmh::EGLHelper::make_current() const
 {
     auto ret = eglMakeCurrent(egl_display, egl_surface, egl_surface, egl_context);
@@ -230,6 +320,25 @@ void mgmh::EGLHelper::setup_internal(GBMHelper const& gbm, bool initialize, EGLi
         should_terminate_egl = true;
     }
 
+    if (auto const extension = EGLExtensions::SwapBuffersWithDamage::maybe_swap_buffers_with_damage(egl_display))
+        swap_with_damage.emplace(*extension);
+
+    auto const egl_extensions = eglQueryString(egl_display, EGL_EXTENSIONS);
+    if (egl_extensions && strstr(egl_extensions, "EGL_KHR_fence_sync"))
+    {
+        create_sync = reinterpret_cast<PFNEGLCREATESYNCKHRPROC>(eglGetProcAddress("eglCreateSyncKHR"));
+        destroy_sync = reinterpret_cast<PFNEGLDESTROYSYNCKHRPROC>(eglGetProcAddress("eglDestroySyncKHR"));
+        client_wait_sync = reinterpret_cast<PFNEGLCLIENTWAITSYNCKHRPROC>(eglGetProcAddress("eglClientWaitSyncKHR"));
+        if (!destroy_sync || !client_wait_sync)
+            create_sync = nullptr;
+
+        if (create_sync && strstr(egl_extensions, "EGL_ANDROID_native_fence_sync"))
+        {
+            dup_native_fence = reinterpret_cast<PFNEGLDUPNATIVEFENCEFDANDROIDPROC>(
+                eglGetProcAddress("eglDupNativeFenceFDANDROID"));
+        }
+    }
+
     for (auto const& config : get_matching_configs(egl_display, config_attr))
     {
         EGLint id;
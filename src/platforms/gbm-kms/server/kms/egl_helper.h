@@ -21,8 +21,11 @@
 
 #include "display_helpers.h"
 #include "mir/graphics/egl_extensions.h"
+#include "mir/time/posix_timestamp.h"
 #include <EGL/egl.h>
 
+#include <optional>
+
 namespace mir
 {
 namespace graphics
@@ -52,6 +55,16 @@ public:
     void setup(GBMHelper const& gbm, gbm_surface* surface_gbm, EGLContext shared_context, bool owns_egl);
 
     bool swap_buffers();
+    bool swap_buffers_with_damage(geometry::Rectangles const& damage);
+    /**
+     * Check, without blocking, whether the GPU has finished the rendering
+     * submitted before the last swap.
+     *
+     * \returns when it finished (exactly, if the driver exports the fence,
+     *          otherwise now; without a fence, also now), or nullopt if
+     *          it is still rendering
+     */
+    auto rendering_finished() -> std::optional<time::PosixTimestamp>;
     bool make_current() const;
     bool release_current() const;
 
@@ -60,6 +73,7 @@ public:
     void report_egl_configuration(std::function<void(EGLDisplay, EGLConfig)>);
 private:
     void setup_internal(GBMHelper const& gbm, bool initialize, EGLint gbm_format);
+    void fence_rendering();
 
     EGLint const depth_buffer_bits;
     EGLint const stencil_buffer_bits;
@@ -69,6 +83,12 @@ private:
     EGLSurface egl_surface;
     bool should_terminate_egl;
     EGLExtensions::PlatformBaseEXT platform_base;
+    std::optional<EGLExtensions::SwapBuffersWithDamage> swap_with_damage;
+    PFNEGLCREATESYNCKHRPROC create_sync{nullptr};       ///< nullptr without EGL_KHR_fence_sync
+    PFNEGLDESTROYSYNCKHRPROC destroy_sync{nullptr};
+    PFNEGLCLIENTWAITSYNCKHRPROC client_wait_sync{nullptr};
+    PFNEGLDUPNATIVEFENCEFDANDROIDPROC dup_native_fence{nullptr};  ///< nullptr without EGL_ANDROID_native_fence_sync
+    EGLSyncKHR rendering_fence{EGL_NO_SYNC_KHR};
 };
 }
 }
@@ -22,6 +22,8 @@
 #include "mir/geometry/size.h"
 #include "mir/geometry/point.h"
 #include "mir/geometry/displacement.h"
+#include "mir/geometry/rectangle.h"
+#include "mir/geometry/rectangle_f.h"
 #include "mir/graphics/display_configuration.h"
 #include "mir/graphics/frame.h"
 #include "mir/graphics/dmabuf_buffer.h"
@@ -31,6 +33,9 @@
 
 #include <gbm.h>
 
+#include <memory>
+#include <vector>
+
 namespace mir
 {
 namespace graphics
@@ -42,6 +47,18 @@ namespace gbm
 
 class FBHandle;
 
+/// A buffer to scan out on an overlay plane, above the output's primary framebuffer
+struct Overlay
+{
+    std::shared_ptr<FBHandle const> fb;
+    /// The part of the buffer to show, in buffer coordinates
+    geometry::RectangleF source;
+    /// In output coordinates; the source is scaled to fill it
+    geometry::Rectangle destination;
+    /// DRM_MODE_ROTATE_* and DRM_MODE_REFLECT_* flags, applied to the source as it fills the destination
+    uint32_t rotation{DRM_MODE_ROTATE_0};
+};
+
 class KMSOutput
 {
 public:
@@ -68,8 +85,37 @@ public:
     virtual bool set_crtc(FBHandle const& fb) = 0;
     virtual void clear_crtc() = 0;
     virtual bool schedule_page_flip(FBHandle const& fb) = 0;
+    /**
+     * As schedule_page_flip(), but the flip happens as soon as the hardware allows
+     * rather than at vblank, so the image may tear.
+     *
+     * \return  False if the output can't flip asynchronously, in which case nothing is
+     *          scheduled and the caller should fall back on schedule_page_flip().
+     */
+    virtual bool schedule_async_page_flip(FBHandle const& fb) = 0;
     virtual void wait_for_page_flip() = 0;
 
+    /**
+     * Show overlays on overlay planes, bottom first, from the next page flip.
+     * set_crtc() clears them.
+     *
+     * \return  False if the hardware can't show all of them at once, in which case the
+     *          overlays shown are left as they were. Clearing them always succeeds.
+     */
+    virtual bool assign_overlays(std::vector<Overlay> const& overlays) = 0;
+
+    /**
+     * Scan out the primary plane rotated and reflected by \a rotation (DRM_MODE_ROTATE_* and
+     * DRM_MODE_REFLECT_* flags) from the next page flip, so a buffer drawn for a rotated output
+     * can be shown as it is. set_crtc() keeps the rotation.
+     *
+     * \param [in] fb  The framebuffer to test the rotation with, as the hardware often can only
+     *                 rotate some formats and layouts
+     * \return  False if the hardware can't scan out \a fb with \a rotation, in which case the
+     *          rotation is left as it was. Returning to DRM_MODE_ROTATE_0 always succeeds.
+     */
+    virtual bool rotate_scanout(FBHandle const& fb, uint32_t rotation) = 0;
+
     virtual bool set_cursor(gbm_bo* buffer) = 0;
     virtual void move_cursor(geometry::Point destination) = 0;
     virtual bool clear_cursor() = 0;
@@ -110,6 +156,9 @@ public:
     /**
      * Check whether buffer need to be migrated to GPU-private memory for display.
      *
+     * Buffers from another GPU that the display device can import need no migration;
+     * fb_for(buffer) scans them out directly.
+     *
      * \param [in] bo   GBM buffer to test
      * \return  True if buffer must be migrated to display-private memory in order to be displayed.
      *          If this method returns true the caller should probably copy it to a new buffer before
@@ -118,6 +167,45 @@ public:
      */
     virtual bool buffer_requires_migration(gbm_bo* bo) const = 0;
 
+    /**
+     * The format modifiers the output can scan out buffers of (GBM or DRM) \a format with.
+     *
+     * Safe to call from any thread: it answers from the planes found when the output
+     * was last configured, and doesn't configure it.
+     *
+     * \return  Empty if the output doesn't say, or hasn't been configured, in which case
+     *          only buffers allocated without explicit modifiers should be used.
+     */
+    virtual auto scanout_modifiers(uint32_t format) -> std::vector<uint64_t> = 0;
+
+    /**
+     * The format modifiers every overlay plane assign_overlays() could use can scan out
+     * buffers of (GBM or DRM) \a format with, whether or not any overlay is assigned yet.
+     *
+     * Safe to call from any thread, as scanout_modifiers() is.
+     *
+     * \return  Empty if there are no such planes or they don't say.
+     */
+    virtual auto overlay_modifiers(uint32_t format) -> std::vector<uint64_t> = 0;
+
+    /**
+     * Have the output refresh when we flip, within the panel's range, rather than at a fixed rate.
+     * Takes effect from the next set_crtc() or page flip.
+     *
+     * \return  Whether adaptive sync is now in use; false if the output isn't capable of it
+     */
+    virtual bool set_adaptive_sync(bool enabled) = 0;
+    virtual bool adaptive_sync() const = 0;
+
+    /**
+     * Refresh at the slowest rate the configured resolution has a mode for, to save power while
+     * nothing on the output changes. Takes effect from the next set_crtc(); configure() returns
+     * the output to its configured rate.
+     *
+     * \return  False if \a idle was requested but there's no slower mode to drop to
+     */
+    virtual bool set_idle_refresh(bool idle) = 0;
+
     virtual int drm_fd() const = 0;
 protected:
     KMSOutput() = default;
@@ -18,14 +18,21 @@
 
 #include "kms_page_flipper.h"
 #include "mir/graphics/display_report.h"
+#include "mir/thread_name.h"
+#include "mir/fatal.h"
 
 #include <stdexcept>
+#include <system_error>
 #include <boost/throw_exception.hpp>
 #include <boost/exception/errinfo_errno.hpp>
 
 #include <xf86drm.h>
 #include <xf86drmMode.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 #include <chrono>
+#include <cerrno>
 #include <cstring>
 
 namespace mg = mir::graphics;
@@ -33,17 +40,30 @@ namespace mgg = mir::graphics::gbm;
 
 namespace
 {
+mir::LockProfile page_flipper_lock_profile{"KMSPageFlipper"};
 
 void page_flip_handler(int /*fd*/, unsigned int seq,
                        unsigned int sec, unsigned int usec,
                        void* data)
 {
     auto page_flip_data = static_cast<mgg::PageFlipEventData*>(data);
+    if (page_flip_data->cursor_update)
+    {
+        page_flip_data->flipper->notify_cursor_update(page_flip_data->crtc_id);
+        return;
+    }
+
     std::chrono::nanoseconds ns{sec*1000000000LL + usec*1000LL};
     page_flip_data->flipper->notify_page_flip(page_flip_data->crtc_id,
                                               seq, ns);
 }
 
+auto make_event_error(std::string const& message) -> std::exception_ptr
+{
+    return std::make_exception_ptr(
+        boost::enable_error_info(std::runtime_error(message)) << boost::errinfo_errno(errno));
+}
+
 }
 
 mgg::KMSPageFlipper::KMSPageFlipper(
@@ -52,25 +72,82 @@ mgg::KMSPageFlipper::KMSPageFlipper(
     drm_fd{drm_fd},
     report{report},
     pending_page_flips(),
-    worker_tid()
+    pf_mutex{page_flipper_lock_profile},
+    shutdown_signal{eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)}
 {
+    if (shutdown_signal < 0)
+    {
+        BOOST_THROW_EXCEPTION(
+            std::system_error(errno, std::system_category(), "Failed to create page flipper shutdown notifier"));
+    }
+
     uint64_t mono = 0;
     if (drmGetCap(drm_fd, DRM_CAP_TIMESTAMP_MONOTONIC, &mono) || !mono)
         clock_id = CLOCK_REALTIME;
     else
         clock_id = CLOCK_MONOTONIC;
+
+    event_thread = std::thread{[this]() { handle_events(); }};
+}
+
+mgg::KMSPageFlipper::~KMSPageFlipper()
+{
+    {
+        std::lock_guard<ProfiledMutex> lock{pf_mutex};
+        shutdown = true;
+    }
+    pf_cv.notify_all();
+
+    // Interrupt the event thread's poll(), if it's in one
+    uint64_t const one{1};
+    if (write(shutdown_signal, &one, sizeof(one)) != sizeof(one))
+        fatal_error("Failed to stop the page flip event thread (%s)", strerror(errno));
+
+    event_thread.join();
 }
 
 bool mgg::KMSPageFlipper::schedule_flip(uint32_t crtc_id,
                                         uint32_t fb_id,
                                         uint32_t connector_id)
 {
-    std::unique_lock<std::mutex> lock{pf_mutex};
+    return legacy_flip(crtc_id, fb_id, connector_id, DRM_MODE_PAGE_FLIP_EVENT);
+}
+
+bool mgg::KMSPageFlipper::schedule_async_flip(uint32_t crtc_id,
+                                              uint32_t fb_id,
+                                              uint32_t connector_id)
+{
+    return legacy_flip(crtc_id, fb_id, connector_id, DRM_MODE_PAGE_FLIP_EVENT | DRM_MODE_PAGE_FLIP_ASYNC);
+}
+
+bool mgg::KMSPageFlipper::schedule_atomic_flip(
+    drmModeAtomicReq* request,
+    uint32_t crtc_id,
+    uint32_t connector_id)
+{
+    return atomic_flip(request, crtc_id, connector_id, DRM_MODE_PAGE_FLIP_EVENT);
+}
+
+bool mgg::KMSPageFlipper::schedule_async_atomic_flip(
+    drmModeAtomicReq* request,
+    uint32_t crtc_id,
+    uint32_t connector_id)
+{
+    return atomic_flip(request, crtc_id, connector_id, DRM_MODE_PAGE_FLIP_EVENT | DRM_MODE_PAGE_FLIP_ASYNC);
+}
+
+bool mgg::KMSPageFlipper::legacy_flip(
+    uint32_t crtc_id,
+    uint32_t fb_id,
+    uint32_t connector_id,
+    uint32_t flags)
+{
+    std::unique_lock<ProfiledMutex> lock{pf_mutex};
 
     if (pending_page_flips.find(crtc_id) != pending_page_flips.end())
         BOOST_THROW_EXCEPTION(std::logic_error("Page flip for crtc_id is already scheduled"));
 
-    pending_page_flips[crtc_id] = PageFlipEventData{crtc_id, connector_id, this};
+    pending_page_flips[crtc_id] = PageFlipEventData{crtc_id, connector_id, this, false};
 
     /*
      * It appears we can't tell the difference between flipping being
@@ -79,94 +156,169 @@ bool mgg::KMSPageFlipper::schedule_flip(uint32_t crtc_id,
      * apparently valid.
      */
     auto ret = drmModePageFlip(drm_fd, crtc_id, fb_id,
-                               DRM_MODE_PAGE_FLIP_EVENT,
+                               flags,
                                &pending_page_flips[crtc_id]);
 
     if (ret)
         pending_page_flips.erase(crtc_id);
+    else
+        pf_cv.notify_all();
+
+    return (ret == 0);
+}
+
+bool mgg::KMSPageFlipper::atomic_flip(
+    drmModeAtomicReq* request,
+    uint32_t crtc_id,
+    uint32_t connector_id,
+    uint32_t flags)
+{
+    std::unique_lock<ProfiledMutex> lock{pf_mutex};
+
+    if (pending_page_flips.find(crtc_id) != pending_page_flips.end())
+        BOOST_THROW_EXCEPTION(std::logic_error("Page flip for crtc_id is already scheduled"));
+
+    pending_page_flips[crtc_id] = PageFlipEventData{crtc_id, connector_id, this, false};
+
+    auto ret = drmModeAtomicCommit(drm_fd, request,
+                                   DRM_MODE_ATOMIC_NONBLOCK | flags,
+                                   &pending_page_flips[crtc_id]);
+
+    /*
+     * An earlier commit without an event (such as a cursor update) is still
+     * in flight. Waiting for it costs less than dropping the frame.
+     */
+    if (ret == -EBUSY)
+    {
+        ret = drmModeAtomicCommit(drm_fd, request,
+                                  flags,
+                                  &pending_page_flips[crtc_id]);
+    }
+
+    if (ret)
+        pending_page_flips.erase(crtc_id);
+    else
+        pf_cv.notify_all();
 
     return (ret == 0);
 }
 
 mg::Frame mgg::KMSPageFlipper::wait_for_flip(uint32_t crtc_id)
 {
+    std::unique_lock<ProfiledMutex> lock{pf_mutex};
+
+    pf_cv.wait(lock, [this, crtc_id]() { return page_flip_is_done(crtc_id) || event_error; });
+
+    if (!page_flip_is_done(crtc_id))
+        std::rethrow_exception(event_error);
+
+    return completed_page_flips[crtc_id];
+}
+
+bool mgg::KMSPageFlipper::schedule_atomic_cursor_update(
+    drmModeAtomicReq* request,
+    uint32_t crtc_id,
+    std::function<void()> const& on_vblank)
+{
+    std::unique_lock<ProfiledMutex> lock{pf_mutex};
+
+    // The kernel still holds the event data of an update in flight, even a cancelled one
+    if (pending_cursor_updates.find(crtc_id) != pending_cursor_updates.end())
+        return false;
+
+    auto& update = pending_cursor_updates[crtc_id];
+    update = CursorUpdate{PageFlipEventData{crtc_id, 0, this, true}, on_vblank};
+
+    auto const ret = drmModeAtomicCommit(drm_fd, request,
+                                         DRM_MODE_ATOMIC_NONBLOCK | DRM_MODE_PAGE_FLIP_EVENT,
+                                         &update.event_data);
+
+    if (ret)
+        pending_cursor_updates.erase(crtc_id);
+    else
+        pf_cv.notify_all();
+
+    return (ret == 0);
+}
+
+void mgg::KMSPageFlipper::cancel_cursor_update(uint32_t crtc_id)
+{
+    std::unique_lock<ProfiledMutex> lock{pf_mutex};
+
+    auto const pending = pending_cursor_updates.find(crtc_id);
+    if (pending != pending_cursor_updates.end())
+        pending->second.on_vblank = nullptr;
+
+    // A completed update's on_vblank may already be on its way
+    pf_cv.wait(lock, [this]() { return !running_cursor_callbacks || event_error; });
+}
+
+void mgg::KMSPageFlipper::handle_events()
+{
+    mir::set_thread_name("Mir/KMS events");
+
     drmEventContext evctx;
     memset(&evctx, 0, sizeof evctx);
     evctx.version = 2;  // We only support the old v2 page_flip_handler
     evctx.page_flip_handler = &page_flip_handler;
 
-    static std::thread::id const invalid_tid;
+    std::unique_lock<ProfiledMutex> lock{pf_mutex};
 
+    while (!shutdown && !event_error)
     {
-        std::unique_lock<std::mutex> lock{pf_mutex};
-
-        /*
-         * While another thread is the worker (it is controlling the
-         * page flip event loop) and our event has not arrived, wait.
-         */
-        while (worker_tid != invalid_tid && !page_flip_is_done(crtc_id))
-            pf_cv.wait(lock);
+        // Page flips are the only events we ask for, so there's nothing to read until one is pending
+        pf_cv.wait(lock, [this]()
+            {
+                return shutdown || !pending_page_flips.empty() || !pending_cursor_updates.empty();
+            });
+        if (shutdown)
+            break;
 
-        /* If the page flip we are waiting for has arrived we are done. */
-        if (page_flip_is_done(crtc_id))
-            return completed_page_flips[crtc_id];
+        // Let flips be scheduled while we wait
+        lock.unlock();
 
-        /* ...otherwise we become the worker */
-        worker_tid = std::this_thread::get_id();
-    }
+        pollfd fds[2] = {{drm_fd, POLLIN, 0}, {shutdown_signal, POLLIN, 0}};
+        auto const ret = poll(fds, 2, -1);
 
-    /* Only the worker thread reaches this point */
-    bool done{false};
+        lock.lock();
 
-    while (!done)
-    {
-        fd_set fds;
-        FD_ZERO(&fds);
-        FD_SET(drm_fd, &fds);
-
-        /*
-         * Wait for a page flip event. When we get a page flip event,
-         * page_flip_handler(), called through drmHandleEvent(), will update
-         * the pending_page_flips map.
-         */
-        auto ret = select(drm_fd + 1, &fds, nullptr, nullptr, nullptr);
+        if (ret < 0)
+        {
+            if (errno != EINTR)
+                event_error = make_event_error("Error while waiting for page-flip event");
+        }
+        else if (fds[0].revents & (POLLERR | POLLHUP | POLLNVAL))
+        {
+            event_error = make_event_error("Error while waiting for page-flip event");
+        }
+        else if (fds[0].revents & POLLIN)
+        {
+            /*
+             * page_flip_handler(), called through drmHandleEvent(), will
+             * update the pending_page_flips map.
+             */
+            if (drmHandleEvent(drm_fd, &evctx) < 0)
+                event_error = make_event_error("Failed to handle DRM events");
+        }
 
+        if (!completed_cursor_updates.empty())
         {
-            std::unique_lock<std::mutex> lock{pf_mutex};
+            // on_vblank may schedule the next cursor update, so mustn't be called with pf_mutex held
+            auto callbacks = std::move(completed_cursor_updates);
+            completed_cursor_updates.clear();
+            running_cursor_callbacks = true;
+            lock.unlock();
 
-            if (ret > 0)
-            {
-                drmHandleEvent(drm_fd, &evctx);
-            }
-            else if (ret < 0 && errno != EINTR)
-            {
-                std::string const msg("Error while waiting for page-flip event");
-                BOOST_THROW_EXCEPTION(
-                    boost::enable_error_info(
-                        std::runtime_error(msg)) << boost::errinfo_errno(errno));
-            }
-
-            done = page_flip_is_done(crtc_id);
-            /* Give up loop control if we are done */
-            if (done)
-                worker_tid = invalid_tid;
+            for (auto const& callback : callbacks)
+                callback();
+
+            lock.lock();
+            running_cursor_callbacks = false;
         }
 
-        /*
-         * Wake up other (non-worker) threads, so they can check whether
-         * their page-flip events have arrived, or whether they can become
-         * the worker (see pf_cv.wait(lock) above).
-         */
+        // Wake whoever is waiting for the flips that have (or now never will) complete
         pf_cv.notify_all();
     }
-    return completed_page_flips[crtc_id];
-}
-
-std::thread::id mgg::KMSPageFlipper::debug_get_worker_tid()
-{
-    std::unique_lock<std::mutex> lock{pf_mutex};
-
-    return worker_tid;
 }
 
 /* This method should be called with the 'pf_mutex' locked */
@@ -184,7 +336,19 @@ void mgg::KMSPageFlipper::notify_page_flip(uint32_t crtc_id, int64_t msc,
         auto& frame = completed_page_flips[crtc_id];
         frame.msc = msc;
         frame.ust = {clock_id, ust};
+        frame.hardware = true;
         report->report_vsync(pending->second.connector_id, frame);
         pending_page_flips.erase(pending);
     }
 }
+
+void mgg::KMSPageFlipper::notify_cursor_update(uint32_t crtc_id)
+{
+    auto pending = pending_cursor_updates.find(crtc_id);
+    if (pending != pending_cursor_updates.end())
+    {
+        if (pending->second.on_vblank)
+            completed_cursor_updates.push_back(std::move(pending->second.on_vblank));
+        pending_cursor_updates.erase(pending);
+    }
+}
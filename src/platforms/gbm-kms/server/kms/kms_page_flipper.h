@@ -20,9 +20,14 @@
 #define MIR_GRAPHICS_GBM_KMS_PAGE_FLIPPER_H_
 
 #include "page_flipper.h"
+#include "mir/fd.h"
+#include "mir/profiled_mutex.h"
 
+#include <functional>
 #include <unordered_map>
+#include <vector>
 #include <chrono>
+#include <exception>
 #include <mutex>
 #include <condition_variable>
 #include <thread>
@@ -45,30 +50,61 @@ struct PageFlipEventData
     uint32_t crtc_id;
     uint32_t connector_id;
     KMSPageFlipper* flipper;
+    bool cursor_update;
 };
 
+/**
+ * Schedules page flips on a DRM device and tracks their completion.
+ *
+ * Page flip events are handled on a thread of our own as soon as they
+ * arrive, so flips on one CRTC complete without waiting for anyone to wait
+ * for them, or for flips on the other CRTCs.
+ */
 class KMSPageFlipper : public PageFlipper
 {
 public:
     KMSPageFlipper(int drm_fd, std::shared_ptr<DisplayReport> const& report);
+    ~KMSPageFlipper();
 
     bool schedule_flip(uint32_t crtc_id, uint32_t fb_id, uint32_t connector_id) override;
+    bool schedule_async_flip(uint32_t crtc_id, uint32_t fb_id, uint32_t connector_id) override;
+    bool schedule_atomic_flip(drmModeAtomicReq* request, uint32_t crtc_id, uint32_t connector_id) override;
+    bool schedule_async_atomic_flip(drmModeAtomicReq* request, uint32_t crtc_id, uint32_t connector_id) override;
     Frame wait_for_flip(uint32_t crtc_id) override;
-
-    std::thread::id debug_get_worker_tid();
+    bool schedule_atomic_cursor_update(
+        drmModeAtomicReq* request, uint32_t crtc_id, std::function<void()> const& on_vblank) override;
+    void cancel_cursor_update(uint32_t crtc_id) override;
 
     void notify_page_flip(uint32_t crtc_id, int64_t msc, std::chrono::nanoseconds ust);
+    void notify_cursor_update(uint32_t crtc_id);
 private:
+    bool legacy_flip(uint32_t crtc_id, uint32_t fb_id, uint32_t connector_id, uint32_t flags);
+    bool atomic_flip(drmModeAtomicReq* request, uint32_t crtc_id, uint32_t connector_id, uint32_t flags);
     bool page_flip_is_done(uint32_t crtc_id);
+    void handle_events();
 
     int const drm_fd;
     std::shared_ptr<DisplayReport> const report;
     std::unordered_map<uint32_t,PageFlipEventData> pending_page_flips;
     std::unordered_map<uint32_t,Frame> completed_page_flips;
-    std::mutex pf_mutex;
-    std::condition_variable pf_cv;
-    std::thread::id worker_tid;
+    struct CursorUpdate
+    {
+        PageFlipEventData event_data;
+        std::function<void()> on_vblank;
+    };
+    std::unordered_map<uint32_t,CursorUpdate> pending_cursor_updates;
+    /// The on_vblanks of completed cursor updates, which the event thread calls without pf_mutex
+    std::vector<std::function<void()>> completed_cursor_updates;
+    bool running_cursor_callbacks{false};
+    ProfiledMutex pf_mutex;
+    std::condition_variable_any pf_cv;      ///< As pf_mutex isn't a std::mutex
     clockid_t clock_id;
+
+    mir::Fd const shutdown_signal;
+    bool shutdown{false};
+    /// Set if the event thread has failed, leaving pending flips to never complete
+    std::exception_ptr event_error;
+    std::thread event_thread;
 };
 
 }
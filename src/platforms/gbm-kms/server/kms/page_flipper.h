@@ -21,6 +21,8 @@
 
 #include "mir/graphics/frame.h"
 #include <cstdint>
+#include <functional>
+#include <xf86drmMode.h>
 
 namespace mir
 {
@@ -35,8 +37,24 @@ public:
     virtual ~PageFlipper() {}
 
     virtual bool schedule_flip(uint32_t crtc_id, uint32_t fb_id, uint32_t connector_id) = 0;
+    /// As schedule_flip(), but flips as soon as possible rather than at vblank, so may tear
+    virtual bool schedule_async_flip(uint32_t crtc_id, uint32_t fb_id, uint32_t connector_id) = 0;
+    /// Commits \a request without blocking, to complete (like a page flip) on \a crtc_id's next vblank
+    virtual bool schedule_atomic_flip(drmModeAtomicReq* request, uint32_t crtc_id, uint32_t connector_id) = 0;
+    /// As schedule_atomic_flip(), but completes as soon as possible; \a request may only change FB_IDs
+    virtual bool schedule_async_atomic_flip(drmModeAtomicReq* request, uint32_t crtc_id, uint32_t connector_id) = 0;
     virtual Frame wait_for_flip(uint32_t crtc_id) = 0;
 
+    /**
+     * Commits the cursor-only \a request without blocking, calling \a on_vblank (from
+     * another thread) once it has reached the screen. Returns false, committing nothing,
+     * if an earlier cursor update on \a crtc_id is still in flight.
+     */
+    virtual bool schedule_atomic_cursor_update(
+        drmModeAtomicReq* request, uint32_t crtc_id, std::function<void()> const& on_vblank) = 0;
+    /// Drops the on_vblank of any cursor update in flight on \a crtc_id, waiting for it if it is running
+    virtual void cancel_cursor_update(uint32_t crtc_id) = 0;
+
 protected:
     PageFlipper() = default;
     PageFlipper(PageFlipper const&) = delete;
@@ -39,6 +39,8 @@
 
 #include <boost/throw_exception.hpp>
 #include <stdexcept>
+#include <system_error>
+#include <sys/stat.h>
 #include <mir/renderer/gl/texture_source.h>
 #include <wayland-server-core.h>
 #include <wayland-server-protocol.h>
@@ -47,22 +49,65 @@ namespace mg = mir::graphics;
 namespace mgg = mg::gbm;
 namespace mgmh = mgg::helpers;
 
+namespace
+{
+/// The one of \a drm that \a render_device names, or if that's empty the boot GPU (which we assume comes first)
+auto render_device_in(std::vector<std::shared_ptr<mgmh::DRMHelper>> const& drm, std::string const& render_device)
+    -> std::shared_ptr<mgmh::DRMHelper>
+{
+    if (render_device.empty())
+        return drm.front();
+
+    struct stat wanted;
+    if (stat(render_device.c_str(), &wanted) != 0)
+    {
+        BOOST_THROW_EXCEPTION((std::system_error{
+            errno, std::system_category(), "Failed to find render device " + render_device}));
+    }
+
+    for (auto const& device : drm)
+    {
+        struct stat opened;
+        if (fstat(device->fd, &opened) == 0 && opened.st_rdev == wanted.st_rdev)
+        {
+            mir::log_info("Compositing on %s", render_device.c_str());
+            return device;
+        }
+    }
+
+    BOOST_THROW_EXCEPTION(std::runtime_error{"Render device " + render_device + " isn't a DRM device we use"});
+}
+}
+
 mgg::Platform::Platform(std::shared_ptr<DisplayReport> const& listener,
                         std::shared_ptr<ConsoleServices> const& vt,
                         EmergencyCleanupRegistry&,
-                        BypassOption bypass_option)
+                        BypassOption bypass_option,
+                        std::chrono::milliseconds frame_deadline_margin,
+                        FramePipelining frame_pipelining,
+                        AdaptiveSync adaptive_sync,
+                        std::chrono::milliseconds idle_refresh_timeout,
+                        std::string const& render_device,
+                        std::string const& seat)
     : udev{std::make_shared<mir::udev::Context>()},
-      drm{helpers::DRMHelper::open_all_devices(udev, *vt)},
-      // We assume the first DRM device is the boot GPU, and arbitrarily pick it as our
-      // shell renderer.
-      //
-      // TODO: expose multiple rendering GPUs to the shell.
-      gbm{std::make_shared<mgmh::GBMHelper>(drm.front()->fd)},
+      drm{helpers::DRMHelper::open_all_devices(udev, *vt, seat)},
+      /*
+       * Unless told otherwise, the boot GPU is our shell renderer. Outputs on other GPUs
+       * are shown copies of what it renders (see DisplayBuffer's EGLBufferCopier).
+       *
+       * TODO: expose multiple rendering GPUs to the shell.
+       */
+      render_drm{render_device_in(drm, render_device)},
+      gbm{std::make_shared<mgmh::GBMHelper>(render_drm->fd)},
       listener{listener},
       vt{vt},
-      bypass_option_{bypass_option}
+      bypass_option_{bypass_option},
+      frame_deadline_margin_{frame_deadline_margin},
+      frame_pipelining_{frame_pipelining},
+      adaptive_sync_{adaptive_sync},
+      idle_refresh_timeout_{idle_refresh_timeout}
 {
-    auth_factory = std::make_unique<DRMNativePlatformAuthFactory>(*drm.front());
+    auth_factory = std::make_unique<DRMNativePlatformAuthFactory>(*render_drm);
 }
 
 mir::UniqueModulePtr<mg::GraphicBufferAllocator> mgg::Platform::create_buffer_allocator(
@@ -79,6 +124,10 @@ mir::UniqueModulePtr<mg::Display> mgg::Platform::create_display(
         gbm,
         vt,
         bypass_option_,
+        frame_deadline_margin_,
+        frame_pipelining_,
+        adaptive_sync_,
+        idle_refresh_timeout_,
         initial_conf_policy,
         gl_config,
         listener);
@@ -93,3 +142,23 @@ mgg::BypassOption mgg::Platform::bypass_option() const
 {
     return bypass_option_;
 }
+
+std::chrono::milliseconds mgg::Platform::frame_deadline_margin() const
+{
+    return frame_deadline_margin_;
+}
+
+mgg::FramePipelining mgg::Platform::frame_pipelining() const
+{
+    return frame_pipelining_;
+}
+
+mgg::AdaptiveSync mgg::Platform::adaptive_sync() const
+{
+    return adaptive_sync_;
+}
+
+std::chrono::milliseconds mgg::Platform::idle_refresh_timeout() const
+{
+    return idle_refresh_timeout_;
+}
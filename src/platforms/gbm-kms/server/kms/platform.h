@@ -26,6 +26,9 @@
 #include "platform_common.h"
 #include "display_helpers.h"
 
+#include <chrono>
+#include <string>
+
 namespace mir
 {
 class EmergencyCleanupRegistry;
@@ -43,7 +46,13 @@ public:
     explicit Platform(std::shared_ptr<DisplayReport> const& reporter,
                       std::shared_ptr<ConsoleServices> const& vt,
                       EmergencyCleanupRegistry& emergency_cleanup_registry,
-                      BypassOption bypass_option);
+                      BypassOption bypass_option,
+                      std::chrono::milliseconds frame_deadline_margin,
+                      FramePipelining frame_pipelining,
+                      AdaptiveSync adaptive_sync,
+                      std::chrono::milliseconds idle_refresh_timeout,
+                      std::string const& render_device = {},
+                      std::string const& seat = "seat0");
 
     /* From Platform */
     UniqueModulePtr<GraphicBufferAllocator> create_buffer_allocator(
@@ -56,14 +65,24 @@ public:
 
     std::shared_ptr<mir::udev::Context> udev;
     std::vector<std::shared_ptr<helpers::DRMHelper>> const drm;
+    /// The device we composite on, and clients are authenticated to
+    std::shared_ptr<helpers::DRMHelper> const render_drm;
     std::shared_ptr<helpers::GBMHelper> const gbm;
 
     std::shared_ptr<DisplayReport> const listener;
     std::shared_ptr<ConsoleServices> const vt;
 
     BypassOption bypass_option() const;
+    std::chrono::milliseconds frame_deadline_margin() const;
+    FramePipelining frame_pipelining() const;
+    AdaptiveSync adaptive_sync() const;
+    std::chrono::milliseconds idle_refresh_timeout() const;
 private:
     BypassOption const bypass_option_;
+    std::chrono::milliseconds const frame_deadline_margin_;
+    FramePipelining const frame_pipelining_;
+    AdaptiveSync const adaptive_sync_;
+    std::chrono::milliseconds const idle_refresh_timeout_;
     std::unique_ptr<DRMNativePlatformAuthFactory> auth_factory;
 };
 
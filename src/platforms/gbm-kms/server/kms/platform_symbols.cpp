@@ -31,6 +31,7 @@
 #include "mir/libname.h"
 #include "mir/console_services.h"
 #include "one_shot_device_observer.h"
+#include "shm_buffer.h"
 #include "mir/raii.h"
 #include "mir/graphics/egl_error.h"
 #include "mir/graphics/gl_config.h"
@@ -50,6 +51,12 @@ namespace mo = mir::options;
 namespace
 {
 char const* bypass_option_name{"bypass"};
+char const* frame_deadline_margin_option_name{"frame-deadline-margin"};
+char const* frame_pipelining_option_name{"frame-pipelining"};
+char const* adaptive_sync_option_name{"adaptive-sync"};
+char const* idle_refresh_timeout_option_name{"idle-refresh-timeout"};
+char const* texture_budget_option_name{"texture-budget"};
+char const* render_device_option_name{"render-device"};
 char const* host_socket{"host-socket"};
 
 }
@@ -73,8 +80,34 @@ mir::UniqueModulePtr<mg::Platform> create_host_platform(
     if (!options->get<bool>(bypass_option_name))
         bypass_option = mgg::BypassOption::prohibited;
 
+    std::chrono::milliseconds const frame_deadline_margin{
+        options->get<int>(frame_deadline_margin_option_name)};
+
+    auto frame_pipelining = mgg::FramePipelining::disabled;
+    if (options->get<bool>(frame_pipelining_option_name))
+        frame_pipelining = mgg::FramePipelining::enabled;
+
+    auto adaptive_sync = mgg::AdaptiveSync::disabled;
+    if (options->get<bool>(adaptive_sync_option_name))
+        adaptive_sync = mgg::AdaptiveSync::enabled;
+
+    std::chrono::milliseconds const idle_refresh_timeout{
+        options->get<int>(idle_refresh_timeout_option_name)};
+
+    if (auto const texture_budget = options->get<int>(texture_budget_option_name))
+        mgc::ShmBuffer::set_texture_budget(static_cast<size_t>(texture_budget) * 1024 * 1024);
+
     return mir::make_module_ptr<mgg::Platform>(
-        report, console, *emergency_cleanup_registry, bypass_option);
+        report,
+        console,
+        *emergency_cleanup_registry,
+        bypass_option,
+        frame_deadline_margin,
+        frame_pipelining,
+        adaptive_sync,
+        idle_refresh_timeout,
+        options->is_set(render_device_option_name) ? options->get<std::string>(render_device_option_name) : "",
+        options->is_set(mo::seat_opt) ? options->get<std::string>(mo::seat_opt) : "seat0");
 }
 
 void add_graphics_platform_options(boost::program_options::options_description& config)
@@ -83,7 +116,31 @@ void add_graphics_platform_options(boost::program_options::options_description&
     config.add_options()
         (bypass_option_name,
          boost::program_options::value<bool>()->default_value(false),
-         "[platform-specific] utilize the bypass optimization for fullscreen surfaces.");
+         "[platform-specific] utilize the bypass optimization for fullscreen surfaces.")
+        (frame_deadline_margin_option_name,
+         boost::program_options::value<int>()->default_value(3),
+         "[platform-specific] time (in milliseconds) to allow between finishing a frame and its vblank. "
+         "Smaller values reduce latency but make missed frames more likely.")
+        (frame_pipelining_option_name,
+         boost::program_options::value<bool>()->default_value(false),
+         "[platform-specific] render the next frame while the last one waits for vblank. "
+         "Keeps frame rate up when rendering takes over half a frame, at the cost of a frame of latency.")
+        (adaptive_sync_option_name,
+         boost::program_options::value<bool>()->default_value(false),
+         "[platform-specific] let outputs that support variable refresh rate show fullscreen clients' "
+         "frames as soon as they are ready, rather than at the next fixed vblank.")
+        (idle_refresh_timeout_option_name,
+         boost::program_options::value<int>()->default_value(0),
+         "[platform-specific] time (in milliseconds) without a new frame before outputs drop to "
+         "their slowest refresh rate, returning to full rate on the next change. 0 disables this.")
+        (texture_budget_option_name,
+         boost::program_options::value<int>()->default_value(0),
+         "[platform-specific] GPU memory (in MiB) for the textures of shared memory buffers. Past it the "
+         "least recently drawn are released, as are those of hidden or occluded windows. 0 means no limit.")
+        (render_device_option_name,
+         boost::program_options::value<std::string>(),
+         "[platform-specific] DRM device (e.g. /dev/dri/card1) to composite on, rather than the boot GPU. "
+         "Outputs on other GPUs show copies of its frames. Useful where a discrete GPU drives most outputs.");
 }
 
 namespace
@@ -110,6 +167,7 @@ mg::PlatformPriority probe_graphics_platform(
     mir::assert_entry_point_signature<mg::PlatformProbe>(&probe_graphics_platform);
 
     auto nested = options.is_set(host_socket);
+    auto const seat = options.is_set(mo::seat_opt) ? options.get<std::string>(mo::seat_opt) : "seat0";
 
     auto udev = std::make_shared<mir::udev::Context>();
 
@@ -160,6 +218,11 @@ mg::PlatformPriority probe_graphics_platform(
             continue;
         }
 
+        if (mir::udev::seat_of(device) != seat)
+        {
+            continue;
+        }
+
         try
         {
             auto maximum_suitability = mg::PlatformPriority::best;
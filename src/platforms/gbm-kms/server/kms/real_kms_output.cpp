@@ -22,18 +22,31 @@
 #include "kms-utils/kms_connector.h"
 #include "mir/fatal.h"
 #include "mir/log.h"
+#include "mir/fd.h"
 #include <string.h> // strcmp
 #include <sys/stat.h>
 
 #include <boost/throw_exception.hpp>
+#include <algorithm>
+#include <optional>
 #include <system_error>
 #include <xf86drm.h>
+#include <drm_fourcc.h>
 
 namespace mg = mir::graphics;
 namespace mgg = mg::gbm;
 namespace mgk = mg::kms;
 namespace geom = mir::geometry;
 
+namespace
+{
+bool supports_async_page_flips(int drm_fd)
+{
+    uint64_t supported{0};
+    return drmGetCap(drm_fd, DRM_CAP_ASYNC_PAGE_FLIP, &supported) == 0 && supported;
+}
+}
+
 class mgg::FBHandle
 {
 public:
@@ -68,10 +81,11 @@ mgg::RealKMSOutput::RealKMSOutput(
       connector{std::move(connector)},
       mode_index{0},
       current_crtc(),
-      saved_crtc(),
       using_saved_crtc{true},
       has_cursor_{false},
-      power_mode(mir_power_mode_on)
+      power_mode(mir_power_mode_on),
+      saved_crtc(),
+      async_page_flips{supports_async_page_flips(drm_fd)}
 {
     reset();
 
@@ -92,6 +106,11 @@ mgg::RealKMSOutput::~RealKMSOutput()
     restore_saved_crtc();
 }
 
+auto mgg::RealKMSOutput::drm_fb_id(FBHandle const& fb) -> uint32_t
+{
+    return fb.get_drm_fb_id();
+}
+
 uint32_t mgg::RealKMSOutput::id() const
 {
     return connector->connector_id;
@@ -149,6 +168,7 @@ void mgg::RealKMSOutput::configure(geom::Displacement offset, size_t kms_mode_in
 {
     fb_offset = offset;
     mode_index = kms_mode_index;
+    idle_refresh = false;
 }
 
 bool mgg::RealKMSOutput::set_crtc(FBHandle const& fb)
@@ -163,7 +183,7 @@ bool mgg::RealKMSOutput::set_crtc(FBHandle const& fb)
     auto ret = drmModeSetCrtc(drm_fd_, current_crtc->crtc_id,
                               fb.get_drm_fb_id(), fb_offset.dx.as_int(), fb_offset.dy.as_int(),
                               &connector->connector_id, 1,
-                              &connector->modes[mode_index]);
+                              &connector->modes[crtc_mode_index()]);
     if (ret)
     {
         current_crtc = nullptr;
@@ -236,6 +256,20 @@ bool mgg::RealKMSOutput::schedule_page_flip(FBHandle const& fb)
         connector->connector_id);
 }
 
+bool mgg::RealKMSOutput::schedule_async_page_flip(FBHandle const& fb)
+{
+    std::unique_lock<std::mutex> lg(power_mutex);
+    if (power_mode != mir_power_mode_on)
+        return true;
+    if (!async_page_flips || !current_crtc)
+        return false;
+
+    return page_flipper->schedule_async_flip(
+        current_crtc->crtc_id,
+        fb.get_drm_fb_id(),
+        connector->connector_id);
+}
+
 void mgg::RealKMSOutput::wait_for_page_flip()
 {
     std::unique_lock<std::mutex> lg(power_mutex);
@@ -250,6 +284,18 @@ void mgg::RealKMSOutput::wait_for_page_flip()
     last_frame_.store(page_flipper->wait_for_flip(current_crtc->crtc_id));
 }
 
+bool mgg::RealKMSOutput::assign_overlays(std::vector<Overlay> const& overlays)
+{
+    // Legacy page flips can't carry overlay planes with them
+    return overlays.empty();
+}
+
+bool mgg::RealKMSOutput::rotate_scanout(FBHandle const& /*fb*/, uint32_t rotation)
+{
+    // Nor the primary plane's rotation
+    return rotation == DRM_MODE_ROTATE_0;
+}
+
 mg::Frame mgg::RealKMSOutput::last_frame() const
 {
     return last_frame_.load();
@@ -621,9 +667,58 @@ void bo_user_data_destroy(gbm_bo* /*bo*/, void *data)
     auto bufobj = static_cast<std::shared_ptr<mgg::FBHandle const>*>(data);
     delete bufobj;
 }
+
+/// A GEM handle on \a drm_fd for \a bo, which was allocated on another device
+auto import_gem_handle(int drm_fd, gbm_bo* bo) -> std::optional<uint32_t>
+{
+    mir::Fd const dma_buf{gbm_bo_get_fd(bo)};
+    if (dma_buf < 0)
+        return std::nullopt;
+
+    uint32_t handle;
+    if (drmPrimeFDToHandle(drm_fd, dma_buf, &handle))
+        return std::nullopt;
+
+    return handle;
 }
 
-auto mgg::RealKMSOutput::FBRegistry::lookup_or_create(int const drm_fd, gbm_bo* bo)
+void close_gem_handle(int drm_fd, uint32_t handle)
+{
+    drm_gem_close close_args{handle, 0};
+    drmIoctl(drm_fd, DRM_IOCTL_GEM_CLOSE, &close_args);
+}
+
+auto fb_format(gbm_bo* bo) -> uint32_t
+{
+    auto format = gbm_bo_get_format(bo);
+    /*
+     * Mir might use the old GBM_BO_ enum formats, but KMS and the rest of
+     * the world need fourcc formats, so convert...
+     */
+    if (format == GBM_BO_FORMAT_XRGB8888)
+        format = GBM_FORMAT_XRGB8888;
+    else if (format == GBM_BO_FORMAT_ARGB8888)
+        format = GBM_FORMAT_ARGB8888;
+    return format;
+}
+
+auto primary_device_node(int fd, char const* description) -> std::unique_ptr<char, decltype(&free)>
+{
+    errno = 0;
+    std::unique_ptr<char, decltype(&free)> node{drmGetPrimaryDeviceNameFromFd(fd), &free};
+    if (!node)
+    {
+        BOOST_THROW_EXCEPTION((
+            std::system_error{
+                errno,
+                std::system_category(),
+                std::string{"Failed to query DRM device node of "} + description}));
+    }
+    return node;
+}
+}
+
+auto mgg::RealKMSOutput::FBRegistry::lookup_or_create(int const drm_fd, gbm_bo* bo, bool import_via_prime)
     -> std::shared_ptr<FBHandle const>
 {
     if (!bo)
@@ -644,22 +739,61 @@ auto mgg::RealKMSOutput::FBRegistry::lookup_or_create(int const drm_fd, gbm_bo*
     uint32_t strides[4] = {gbm_bo_get_stride(bo), 0, 0, 0};
     uint32_t offsets[4] = {0, 0, 0, 0};
 
-    auto format = gbm_bo_get_format(bo);
-    /*
-     * Mir might use the old GBM_BO_ enum formats, but KMS and the rest of
-     * the world need fourcc formats, so convert...
-     */
-    if (format == GBM_BO_FORMAT_XRGB8888)
-        format = GBM_FORMAT_XRGB8888;
-    else if (format == GBM_BO_FORMAT_ARGB8888)
-        format = GBM_FORMAT_ARGB8888;
+    if (import_via_prime)
+    {
+        // The GBM handle is only meaningful on the GPU that allocated the buffer
+        auto const imported = import_gem_handle(drm_fd, bo);
+        if (!imported)
+            return nullptr;
+        handles[0] = *imported;
+    }
 
+    auto const format = fb_format(bo);
     auto const width = gbm_bo_get_width(bo);
     auto const height = gbm_bo_get_height(bo);
 
-    /* Create a KMS FB object with the gbm_bo attached to it. */
-    auto ret = drmModeAddFB2(drm_fd, width, height, format,
-                             handles, strides, offsets, &fb_id, 0);
+    int ret{-EINVAL};
+#ifndef MIR_NO_GBM_MODIFIERS
+    /*
+     * Buffers allocated with an explicit modifier may have several planes
+     * (such as compression metadata), all of which KMS needs to know about.
+     */
+    auto const modifier = gbm_bo_get_modifier(bo);
+    if (!import_via_prime && modifier != DRM_FORMAT_MOD_INVALID)
+    {
+        uint32_t mod_handles[4] = {0, 0, 0, 0};
+        uint32_t mod_strides[4] = {0, 0, 0, 0};
+        uint32_t mod_offsets[4] = {0, 0, 0, 0};
+        uint64_t modifiers[4] = {0, 0, 0, 0};
+
+        auto const plane_count = std::min(gbm_bo_get_plane_count(bo), 4);
+        for (auto i = 0; i < plane_count; ++i)
+        {
+            mod_handles[i] = gbm_bo_get_handle_for_plane(bo, i).u32;
+            mod_strides[i] = gbm_bo_get_stride_for_plane(bo, i);
+            mod_offsets[i] = gbm_bo_get_offset(bo, i);
+            modifiers[i] = modifier;
+        }
+
+        ret = drmModeAddFB2WithModifiers(
+            drm_fd, width, height, format,
+            mod_handles, mod_strides, mod_offsets, modifiers,
+            &fb_id, DRM_MODE_FB_MODIFIERS);
+    }
+
+    // Without modifiers, only a single-plane buffer can be described to KMS
+    if (ret && gbm_bo_get_plane_count(bo) <= 1)
+#endif
+    {
+        /* Create a KMS FB object with the gbm_bo attached to it. */
+        ret = drmModeAddFB2(drm_fd, width, height, format,
+                            handles, strides, offsets, &fb_id, 0);
+    }
+
+    // The FB holds its own reference to an imported buffer
+    if (import_via_prime)
+        close_gem_handle(drm_fd, handles[0]);
+
     if (ret)
         return nullptr;
 
@@ -673,7 +807,10 @@ auto mgg::RealKMSOutput::FBRegistry::lookup_or_create(int const drm_fd, gbm_bo*
 
 auto mgg::RealKMSOutput::fb_for(gbm_bo* bo) const -> std::shared_ptr<FBHandle const>
 {
-    return framebuffers.lookup_or_create(drm_fd(), bo);
+    if (!bo)
+        return nullptr;
+
+    return framebuffers.lookup_or_create(drm_fd(), bo, buffer_path(bo) == BufferPath::prime_import);
 }
 
 struct mgg::RealKMSOutput::FBRegistry::DMABufFB
@@ -822,48 +959,128 @@ auto mgg::RealKMSOutput::fb_for(mg::DMABufBuffer const& image) const -> std::sha
 
 bool mgg::RealKMSOutput::buffer_requires_migration(gbm_bo* bo) const
 {
-    /*
-     * It's possible that some devices will not require migration -
-     * Intel GPUs can obviously scanout from main memory, as can USB outputs such as
-     * DisplayLink.
-     *
-     * For a first go, just say that *every* device scans out of GPU-private memory.
-     *
-     * To complicate matters, Mali's gbm-kms implementation does *not* return the same
-     * integer fd from gbm_device_get_fd() as the drm fd that the device was created
-     * from, and GBM may choose to internally open the DRM render node associated
-     * with the DRM node passed to gbm_create_device.
-     */
+    return buffer_path(bo) == BufferPath::migrate;
+}
 
-    errno = 0;
-    auto const gbm_device_node = std::unique_ptr<char, decltype(&free)>{
-        drmGetPrimaryDeviceNameFromFd(gbm_device_get_fd(gbm_bo_get_device(bo))),
-        &free
-    };
-    if (!gbm_device_node)
+auto mgg::RealKMSOutput::scanout_modifiers(uint32_t /*format*/) -> std::vector<uint64_t>
+{
+    // Without universal planes legacy modesetting doesn't show us the primary plane to ask
+    return {};
+}
+
+auto mgg::RealKMSOutput::overlay_modifiers(uint32_t /*format*/) -> std::vector<uint64_t>
+{
+    // assign_overlays() never uses overlay planes here
+    return {};
+}
+
+bool mgg::RealKMSOutput::set_adaptive_sync(bool /*enabled*/)
+{
+    // VRR_ENABLED is only set in AtomicKMSOutput's commits
+    return false;
+}
+
+bool mgg::RealKMSOutput::adaptive_sync() const
+{
+    return false;
+}
+
+bool mgg::RealKMSOutput::set_idle_refresh(bool idle)
+{
+    if (idle && idle_mode_index() == mode_index)
+        return false;
+
+    idle_refresh = idle;
+    return true;
+}
+
+auto mgg::RealKMSOutput::crtc_mode_index() const -> size_t
+{
+    return idle_refresh ? idle_mode_index() : mode_index;
+}
+
+auto mgg::RealKMSOutput::idle_mode_index() const -> size_t
+{
+    auto const& current = connector->modes[mode_index];
+    auto slowest = mode_index;
+
+    for (auto m = 0; m < connector->count_modes; m++)
     {
-        BOOST_THROW_EXCEPTION((
-            std::system_error{
-                errno,
-                std::system_category(),
-                "Failed to query DRM device backing GBM buffer"}));
+        auto const& mode = connector->modes[m];
+        if (mode.hdisplay == current.hdisplay &&
+            mode.vdisplay == current.vdisplay &&
+            (mode.flags & DRM_MODE_FLAG_INTERLACE) == (current.flags & DRM_MODE_FLAG_INTERLACE) &&
+            mode.vrefresh < connector->modes[slowest].vrefresh)
+        {
+            slowest = m;
+        }
     }
 
-    auto const drm_device_node = std::unique_ptr<char, decltype(&free)>{
-        drmGetPrimaryDeviceNameFromFd(drm_fd_),
-        &free
-    };
-    if (!drm_device_node)
+    return slowest;
+}
+
+auto mgg::RealKMSOutput::buffer_path(gbm_bo* bo) const -> BufferPath
+{
+    auto const device = gbm_bo_get_device(bo);
+
+    std::lock_guard<decltype(buffer_paths_mutex)> lock{buffer_paths_mutex};
+    auto path = buffer_paths.find(device);
+    if (path == buffer_paths.end())
+        path = buffer_paths.emplace(device, probe_buffer_path(bo)).first;
+
+    return path->second;
+}
+
+auto mgg::RealKMSOutput::probe_buffer_path(gbm_bo* bo) const -> BufferPath
+{
+    /*
+     * Mali's gbm-kms implementation does *not* return the same integer fd
+     * from gbm_device_get_fd() as the drm fd that the device was created
+     * from, and GBM may choose to internally open the DRM render node
+     * associated with the DRM node passed to gbm_create_device. So compare
+     * primary nodes rather than fds.
+     */
+    auto const gbm_device_node = primary_device_node(gbm_device_get_fd(gbm_bo_get_device(bo)), "GBM buffer");
+    auto const drm_device_node = primary_device_node(drm_fd_, "display device");
+
+    // These *should* match if we're on the same device
+    if (strcmp(gbm_device_node.get(), drm_device_node.get()) == 0)
+        return BufferPath::native;
+
+    /*
+     * Plenty of display devices can scan out of a buffer in another GPU's
+     * memory: Intel GPUs and USB outputs such as DisplayLink scan out of
+     * system memory, and linear buffers are widely importable. The only
+     * reliable test is to try, so make (and discard) a framebuffer for
+     * the buffer on the display device. The answer holds for every buffer
+     * the GPU allocates for us, as those are all allocated alike.
+     */
+    auto path = BufferPath::migrate;
+    if (auto const handle = import_gem_handle(drm_fd_, bo))
     {
-        BOOST_THROW_EXCEPTION((
-            std::system_error{
-                errno,
-                std::system_category(),
-                "Failed to query DRM device node of display device"}));
+        uint32_t handles[4] = {*handle, 0, 0, 0};
+        uint32_t strides[4] = {gbm_bo_get_stride(bo), 0, 0, 0};
+        uint32_t offsets[4] = {0, 0, 0, 0};
+        uint32_t fb_id;
+
+        if (drmModeAddFB2(
+            drm_fd_, gbm_bo_get_width(bo), gbm_bo_get_height(bo), fb_format(bo),
+            handles, strides, offsets, &fb_id, 0) == 0)
+        {
+            drmModeRmFB(drm_fd_, fb_id);
+            path = BufferPath::prime_import;
+        }
+
+        close_gem_handle(drm_fd_, *handle);
     }
 
-    // These *should* match if we're on the same device
-    return strcmp(gbm_device_node.get(), drm_device_node.get()) != 0;
+    mir::log_info(
+        "%s %s scan out of buffers from %s directly",
+        drm_device_node.get(),
+        path == BufferPath::prime_import ? "can" : "cannot",
+        gbm_device_node.get());
+
+    return path;
 }
 
 int mgg::RealKMSOutput::drm_fd() const
@@ -25,6 +25,7 @@
 
 #include <memory>
 #include <mutex>
+#include <unordered_map>
 
 namespace mir
 {
@@ -54,7 +55,10 @@ public:
     bool set_crtc(FBHandle const& fb) override;
     void clear_crtc() override;
     bool schedule_page_flip(FBHandle const& fb) override;
+    bool schedule_async_page_flip(FBHandle const& fb) override;
     void wait_for_page_flip() override;
+    bool assign_overlays(std::vector<Overlay> const& overlays) override;
+    bool rotate_scanout(FBHandle const& fb, uint32_t rotation) override;
 
     bool set_cursor(gbm_bo* buffer) override;
     void move_cursor(geometry::Point destination) override;
@@ -73,22 +77,63 @@ public:
     auto fb_for(DMABufBuffer const& image) const -> std::shared_ptr<FBHandle const> override;
 
     bool buffer_requires_migration(gbm_bo* bo) const override;
+    auto scanout_modifiers(uint32_t format) -> std::vector<uint64_t> override;
+    auto overlay_modifiers(uint32_t format) -> std::vector<uint64_t> override;
+    bool set_adaptive_sync(bool enabled) override;
+    bool adaptive_sync() const override;
+    bool set_idle_refresh(bool idle) override;
     int drm_fd() const override;
 
-private:
+protected:
     bool ensure_crtc();
-    void restore_saved_crtc();
+    /// The DRM ID of the framebuffer behind \a fb
+    static auto drm_fb_id(FBHandle const& fb) -> uint32_t;
+    /// The mode to set on the CRTC: the configured one, or its idle counterpart
+    auto crtc_mode_index() const -> size_t;
 
     int const drm_fd_;
     std::shared_ptr<PageFlipper> const page_flipper;
 
+    kms::DRMModeConnectorUPtr connector;
+    size_t mode_index;
+    bool idle_refresh{false};
+    geometry::Displacement fb_offset;
+    kms::DRMModeCrtcUPtr current_crtc;
+    bool using_saved_crtc;
+    bool has_cursor_;
+
+    MirPowerMode power_mode;
+
+    std::mutex power_mutex;
+
+private:
+    void restore_saved_crtc();
+    /// The slowest mode with the same resolution as the configured one
+    auto idle_mode_index() const -> size_t;
+
+    /// How buffers from a GPU reach the display device
+    enum class BufferPath
+    {
+        native,         ///< Allocated on the display device itself
+        prime_import,   ///< Scanned out directly, imported as a DMA-buf
+        migrate         ///< Must be copied to display-private memory
+    };
+    /// The path for \a bo, probing (and caching) it for a GPU we haven't seen before
+    auto buffer_path(gbm_bo* bo) const -> BufferPath;
+    auto probe_buffer_path(gbm_bo* bo) const -> BufferPath;
+
+    std::mutex mutable buffer_paths_mutex;
+    std::unordered_map<gbm_device*, BufferPath> mutable buffer_paths;
+
     /* TODO: This should really be owned by a DRM-device-level object,
      * not per-output. We don't have one of those at the moment, so here'll do.
      */
     class FBRegistry
     {
     public:
-        auto lookup_or_create(int const drm_fd, gbm_bo* bo) -> std::shared_ptr<FBHandle const>;
+        /// \param import_via_prime  \a bo is from another GPU, so must be imported as a DMA-buf
+        auto lookup_or_create(int const drm_fd, gbm_bo* bo, bool import_via_prime)
+            -> std::shared_ptr<FBHandle const>;
         auto lookup_or_create(int const drm_fd, DMABufBuffer const& image) -> std::shared_ptr<FBHandle const>;
 
         struct DMABufFB;
@@ -97,18 +142,9 @@ private:
     };
     FBRegistry mutable framebuffers;
 
-    kms::DRMModeConnectorUPtr connector;
-    size_t mode_index;
-    geometry::Displacement fb_offset;
-    kms::DRMModeCrtcUPtr current_crtc;
     drmModeCrtc saved_crtc;
-    bool using_saved_crtc;
-    bool has_cursor_;
-
-    MirPowerMode power_mode;
     int dpms_enum_id;
-
-    std::mutex power_mutex;
+    bool const async_page_flips;
 
     AtomicFrame last_frame_;
 };
@@ -17,12 +17,27 @@
  */
 
 #include <algorithm>
+#include <cstdlib>
 #include "real_kms_output_container.h"
 #include "real_kms_output.h"
+#include "atomic_kms_output.h"
 #include "kms-utils/drm_mode_resources.h"
 
 namespace mgg = mir::graphics::gbm;
 
+namespace
+{
+bool use_atomic_kms(int drm_fd)
+{
+    if (getenv("MIR_GBM_KMS_DISABLE_ATOMIC"))
+        return false;
+
+    // Atomic modesetting needs every plane (including primary and cursor) to be exposed
+    return drmSetClientCap(drm_fd, DRM_CLIENT_CAP_UNIVERSAL_PLANES, 1) == 0 &&
+           drmSetClientCap(drm_fd, DRM_CLIENT_CAP_ATOMIC, 1) == 0;
+}
+}
+
 mgg::RealKMSOutputContainer::RealKMSOutputContainer(
     std::vector<int> const& drm_fds,
     std::function<std::shared_ptr<PageFlipper>(int)> const& construct_page_flipper)
@@ -57,6 +72,8 @@ void mgg::RealKMSOutputContainer::update_from_hardware_state()
             continue;
         }
 
+        auto const atomic = use_atomic_kms(drm_fd);
+
         for (auto &&connector : resources->connectors())
         {
             // Caution: O(n²) here, but n is the number of outputs, so should
@@ -80,6 +97,13 @@ void mgg::RealKMSOutputContainer::update_from_hardware_state()
                 new_outputs.push_back(*existing_output);
                 new_outputs.back()->refresh_hardware_state();
             }
+            else if (atomic)
+            {
+                new_outputs.push_back(std::make_shared<AtomicKMSOutput>(
+                    drm_fd,
+                    std::move(connector),
+                    construct_page_flipper(drm_fd)));
+            }
             else
             {
                 new_outputs.push_back(std::make_shared<RealKMSOutput>(
@@ -0,0 +1,115 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "software_framebuffers.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <cstring>
+#include <stdexcept>
+
+namespace mgg = mir::graphics::gbm;
+namespace mrs = mir::renderer::software;
+namespace geom = mir::geometry;
+
+namespace
+{
+class BOMapping : public mrs::Mapping<unsigned char>
+{
+public:
+    BOMapping(gbm_bo* bo, geom::Size size, uint32_t flags)
+        : bo{bo},
+          size_{size}
+    {
+        uint32_t stride_bytes{0};
+        pixels = static_cast<unsigned char*>(gbm_bo_map(
+            bo, 0, 0, size.width.as_int(), size.height.as_int(), flags, &stride_bytes, &map_data));
+        if (!pixels)
+            BOOST_THROW_EXCEPTION(std::runtime_error{"Failed to map software framebuffer"});
+        stride_ = geom::Stride{static_cast<int>(stride_bytes)};
+    }
+
+    ~BOMapping()
+    {
+        gbm_bo_unmap(bo, map_data);
+    }
+
+    auto format() const -> MirPixelFormat override { return mir_pixel_format_xrgb_8888; }
+    auto stride() const -> geom::Stride override { return stride_; }
+    auto size() const -> geom::Size override { return size_; }
+    auto data() -> unsigned char* override { return pixels; }
+    auto len() const -> size_t override { return static_cast<size_t>(stride_.as_int()) * size_.height.as_int(); }
+
+private:
+    gbm_bo* const bo;
+    geom::Size const size_;
+    geom::Stride stride_;
+    unsigned char* pixels{nullptr};
+    void* map_data{nullptr};
+};
+}
+
+mgg::SoftwareFramebuffers::SoftwareFramebuffers(gbm_device* device, geom::Size size)
+    : size{size}
+{
+    for (auto& buffer : buffers)
+    {
+        buffer.reset(gbm_bo_create(
+            device,
+            size.width.as_int(),
+            size.height.as_int(),
+            GBM_FORMAT_XRGB8888,
+            GBM_BO_USE_SCANOUT | GBM_BO_USE_LINEAR));
+        if (!buffer)
+            BOOST_THROW_EXCEPTION(std::runtime_error{"Failed to allocate software framebuffer"});
+    }
+}
+
+auto mgg::SoftwareFramebuffers::map_back() -> std::unique_ptr<mrs::Mapping<unsigned char>>
+{
+    auto back_mapping = std::make_unique<BOMapping>(buffers[back].get(), size, GBM_BO_TRANSFER_READ_WRITE);
+
+    if (back_stale.size() > 0)
+    {
+        // Scanout memory is slow to read, so copy no more than we have to
+        BOMapping front_mapping{front(), size, GBM_BO_TRANSFER_READ};
+        auto const front_stride = front_mapping.stride().as_int();
+        auto const back_stride = back_mapping->stride().as_int();
+
+        for (auto const& stale : back_stale)
+        {
+            auto const area = intersection_of(stale, geom::Rectangle{{0, 0}, size});
+            auto const left = area.left().as_int() * 4;
+            auto const width = area.size.width.as_int() * 4;
+            for (auto y = area.top().as_int(); y < area.bottom().as_int(); ++y)
+            {
+                std::memcpy(
+                    back_mapping->data() + y * back_stride + left,
+                    front_mapping.data() + y * front_stride + left,
+                    width);
+            }
+        }
+        back_stale.clear();
+    }
+
+    return back_mapping;
+}
+
+void mgg::SoftwareFramebuffers::swap(geom::Rectangles const& damage)
+{
+    back = 1 - back;
+    back_stale = damage;
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_GBM_SOFTWARE_FRAMEBUFFERS_H_
+#define MIR_GRAPHICS_GBM_SOFTWARE_FRAMEBUFFERS_H_
+
+#include "mir/renderer/sw/pixel_source.h"
+#include "mir/geometry/rectangles.h"
+
+#include <gbm.h>
+
+#include <array>
+#include <memory>
+
+namespace mir
+{
+namespace graphics
+{
+namespace gbm
+{
+
+/**
+ * A pair of linear scanout buffers for the CPU to draw frames into.
+ *
+ * On a display-only device (such as simpledrm) GBM allocates these as KMS
+ * dumb buffers.
+ */
+class SoftwareFramebuffers
+{
+public:
+    /// \throws std::runtime_error if the buffers can't be allocated
+    SoftwareFramebuffers(gbm_device* device, geometry::Size size);
+
+    /**
+     * Map the back buffer, holding the same frame as the front buffer.
+     *
+     * Only the area last drawn into the front buffer is copied back.
+     */
+    auto map_back() -> std::unique_ptr<renderer::software::Mapping<unsigned char>>;
+
+    /// Make the back buffer the front, with \a damage the only area drawn since map_back()
+    void swap(geometry::Rectangles const& damage);
+
+    auto front() const -> gbm_bo* { return buffers[1 - back].get(); }
+
+private:
+    struct BODeleter
+    {
+        void operator()(gbm_bo* bo) const { gbm_bo_destroy(bo); }
+    };
+
+    geometry::Size const size;
+    std::array<std::unique_ptr<gbm_bo, BODeleter>, 2> buffers;
+    size_t back{0};
+    /// What was drawn into the front buffer and is missing from the back
+    geometry::Rectangles back_stale;
+};
+
+}
+}
+}
+
+#endif // MIR_GRAPHICS_GBM_SOFTWARE_FRAMEBUFFERS_H_
@@ -32,6 +32,20 @@ enum class BypassOption
     prohibited
 };
 
+/// Whether a composited frame may be rendered while the previous one waits for its page flip
+enum class FramePipelining
+{
+    disabled,
+    enabled
+};
+
+/// Whether outputs capable of variable refresh rate should use it
+enum class AdaptiveSync
+{
+    disabled,
+    enabled
+};
+
 }
 }
 }
@@ -30,6 +30,7 @@
 #include "mir/anonymous_shm_file.h"
 #include "mir/graphics/egl_extensions.h"
 #include "mir/graphics/egl_error.h"
+#include "mir/graphics/wayland_shm.h"
 #include "mir/graphics/display.h"
 #include "mir/renderer/gl/context_source.h"
 #include "mir/renderer/gl/context.h"
@@ -456,21 +457,21 @@ class DispmanxWlShmBuffer : public DispmanxShmBuffer
 {
 public:
     DispmanxWlShmBuffer(
-        wl_shm_buffer* buffer,
+        mg::WlShmBufferContent const& content,
         std::shared_ptr<mg::common::EGLContextExecutor> egl_executor,
         std::function<void()>&& on_consumed)
         : DispmanxShmBuffer(
-            geom::Size{wl_shm_buffer_get_width(buffer), wl_shm_buffer_get_height(buffer)},
-            geom::Stride{wl_shm_buffer_get_stride(buffer)},
-            wl_format_to_mir_format(wl_shm_buffer_get_format(buffer)),
+            content.size(),
+            content.stride(),
+            wl_format_to_mir_format(content.format()),
             std::move(egl_executor)),
           on_consumed(std::move(on_consumed))
     {
-        wl_shm_buffer_begin_access(buffer);
-        write(
-            static_cast<unsigned char*>(wl_shm_buffer_get_data(buffer)),
-            stride().as_uint32_t() * size().height.as_uint32_t());
-        wl_shm_buffer_end_access(buffer);
+        content.read(
+            [this](unsigned char const* pixels)
+            {
+                write(pixels, stride().as_uint32_t() * size().height.as_uint32_t());
+            });
     }
 
     void bind() override
@@ -495,16 +496,19 @@ private:
 auto mg::rpi::BufferAllocator::buffer_from_shm(
     wl_resource* buffer,
     std::shared_ptr<mir::Executor> /*wayland_executor*/,
-    std::function<void()>&& on_consumed) -> std::shared_ptr<Buffer>
+    std::function<void()>&& on_consumed,
+    std::shared_ptr<Buffer> const& /*previous*/,
+    std::experimental::optional<geom::Rectangles> const& /*damage*/) -> std::shared_ptr<Buffer>
 {
-    auto shm_buffer = wl_shm_buffer_get(buffer);
-    if (shm_buffer == nullptr)
+    // The content is copied into a DispmanX resource anyway, so there's no texture upload to save
+    auto const shm_content = mg::wl_shm_buffer_content(buffer);
+    if (!shm_content)
     {
         BOOST_THROW_EXCEPTION((std::runtime_error{"Attempt to allocate Shm buffer from non-shm wl_resource"}));
     }
 
     auto const mir_buffer = std::make_shared<DispmanxWlShmBuffer>(
-        shm_buffer,
+        *shm_content,
         egl_executor,
         std::move(on_consumed));
 
@@ -245,6 +245,23 @@ void mg::rpi::Display::configure(mg::DisplayConfiguration const& conf)
         dynamic_cast<DisplayConfiguration*>(conf.clone().release())};
 }
 
+void mg::rpi::Display::configure_incrementally(
+    mg::DisplayConfiguration const& conf,
+    std::function<void(mg::DisplaySyncGroup&)> const& /*release*/)
+{
+    // Configuring doesn't touch the display buffers, so none need releasing
+    configure(conf);
+}
+
+bool mg::rpi::Display::apply_if_configuration_only_changes_power_modes(
+    mg::DisplayConfiguration const& /*conf*/,
+    std::function<void(mg::DisplaySyncGroup&)> const& /*suspend*/,
+    std::function<void(mg::DisplaySyncGroup&)> const& /*resume*/)
+{
+    // Configuring doesn't touch the display buffers, so there's nothing to save
+    return false;
+}
+
 void mg::rpi::Display::register_configuration_change_handler(
     mg::EventHandlerRegister&,
     mg::DisplayConfigurationChangeHandler const&)
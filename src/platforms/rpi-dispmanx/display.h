@@ -47,6 +47,13 @@ public:
     std::unique_ptr<graphics::DisplayConfiguration> configuration() const override;
     bool apply_if_configuration_preserves_display_buffers(graphics::DisplayConfiguration const& conf) override;
     void configure(graphics::DisplayConfiguration const& conf) override;
+    void configure_incrementally(
+        graphics::DisplayConfiguration const& conf,
+        std::function<void(graphics::DisplaySyncGroup&)> const& release) override;
+    bool apply_if_configuration_only_changes_power_modes(
+        graphics::DisplayConfiguration const& conf,
+        std::function<void(graphics::DisplaySyncGroup&)> const& suspend,
+        std::function<void(graphics::DisplaySyncGroup&)> const& resume) override;
     void register_configuration_change_handler(
         EventHandlerRegister& handlers, DisplayConfigurationChangeHandler const& conf_change_handler) override;
     void register_pause_resume_handlers(
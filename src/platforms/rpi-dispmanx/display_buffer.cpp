@@ -25,6 +25,7 @@
 
 #include <boost/throw_exception.hpp>
 #include <algorithm>
+#include <iterator>
 
 #ifndef GLM_ENABLE_EXPERIMENTAL
 #define GLM_ENABLE_EXPERIMENTAL
@@ -141,6 +142,11 @@ std::chrono::milliseconds mg::rpi::DisplayBuffer::recommended_sleep() const
 {
     return std::chrono::milliseconds();
 }
+
+mg::Frame mg::rpi::DisplayBuffer::last_frame() const
+{
+    return {};
+}
 mir::geometry::Rectangle mg::rpi::DisplayBuffer::view_area() const
 {
     return view;
@@ -169,7 +175,10 @@ bool renderable_is_overlay_candidate(std::shared_ptr<mg::Renderable> const& rend
         is_dispmanx_capable_buffer(*renderable->buffer());
 }
 
-auto dispmanx_handle_for_renderable(mg::Renderable const& renderable)
+/// \param [out] created  Gets any resource we're left owning, to delete once it's off screen
+auto dispmanx_handle_for_renderable(
+    mg::Renderable const& renderable,
+    std::vector<DISPMANX_RESOURCE_HANDLE_T>& created)
     -> DISPMANX_RESOURCE_HANDLE_T
 {
     auto const buffer = renderable.buffer().get();
@@ -188,6 +197,7 @@ auto dispmanx_handle_for_renderable(mg::Renderable const& renderable)
             width | (pixel_source->stride().as_uint32_t() << 16),
             height | (height << 16),
             &dummy);
+        created.push_back(handle);
 
 
         pixel_source->read(
@@ -217,41 +227,76 @@ auto dispmanx_handle_for_renderable(mg::Renderable const& renderable)
 auto transform_for_renderable(mg::Renderable const& renderable) -> DISPMANX_TRANSFORM_T
 {
     // TODO: Handle rotations etc
-    return dynamic_cast<mg::rpi::DispmanXBuffer const&>(*renderable.buffer())
-        .resource_transform();
+    if (auto const dispmanx_buffer = dynamic_cast<mg::rpi::DispmanXBuffer const*>(renderable.buffer().get()))
+        return dispmanx_buffer->resource_transform();
+    return DISPMANX_NO_ROTATE;
+}
+
+void set_dest_rect(
+    DISPMANX_UPDATE_HANDLE_T update_handle,
+    DISPMANX_ELEMENT_HANDLE_T element,
+    mir::geometry::Rectangle const& area)
+{
+    VC_RECT_T dest_rect;
+    vc_dispmanx_rect_set(
+        &dest_rect,
+        area.top_left.x.as_uint32_t(),
+        area.top_left.y.as_uint32_t(),
+        area.size.width.as_uint32_t(),
+        area.size.height.as_uint32_t());
+
+    vc_dispmanx_element_change_attributes(
+        update_handle,
+        element,
+        ELEMENT_CHANGE_DEST_RECT,
+        0,
+        0,
+        &dest_rect,
+        nullptr,
+        DISPMANX_NO_HANDLE,
+        DISPMANX_NO_ROTATE);
 }
 }
 
-bool mg::rpi::DisplayBuffer::overlay(mg::RenderableList const& renderlist)
+bool mg::rpi::DisplayBuffer::overlay(mg::RenderableList& renderlist)
 {
-    if (!std::all_of(
-        renderlist.begin(),
-        renderlist.end(),
-        &renderable_is_overlay_candidate))
+    // Elements sit above the (opaque) EGL layer, so only the top of the stack can go on them
+    auto const first_element = std::find_if_not(
+        renderlist.rbegin(),
+        renderlist.rend(),
+        &renderable_is_overlay_candidate).base();
+
+    if (first_element == renderlist.begin())
     {
-        return false;
-    }
+        // The HVS can show the lot, so the EGL layer isn't needed at all
+        pending_elements.clear();
+        auto const update_handle = vc_dispmanx_update_start(0);
+        if (egl_layer_visible)
+        {
+            set_dest_rect(update_handle, egl_target_element, {});
+            egl_layer_visible = false;
+        }
+        show_elements(update_handle, renderlist);
 
-    auto update_handle = vc_dispmanx_update_start(0);
+        // Add an opaque black background.
+        vc_dispmanx_display_set_background(update_handle, display_handle, 0, 0, 0);
 
-    if (current_elements.empty())
-    {
-        // Change the EGL layer's output layer to empty.
-        VC_RECT_T empty_output;
-        vc_dispmanx_rect_set(&empty_output, 0, 0, 0, 0);
-
-        vc_dispmanx_element_change_attributes(
-            update_handle,
-            egl_target_element,
-            ELEMENT_CHANGE_DEST_RECT,
-            0,
-            0,
-            &empty_output,
-            nullptr,
-            DISPMANX_NO_HANDLE,
-            DISPMANX_NO_ROTATE);
+        // TODO: This doesn't have to be synchronous; we could use the vblank callback.
+        vc_dispmanx_update_submit_sync(update_handle);
+        delete_retired_resources();
+        return true;
     }
 
+    // The rest is composited with GL, and the elements go up with its frame in swap_buffers()
+    pending_elements.assign(first_element, renderlist.end());
+    renderlist.erase(first_element, renderlist.end());
+    return false;
+}
+
+void mg::rpi::DisplayBuffer::show_elements(
+    DISPMANX_UPDATE_HANDLE_T update_handle,
+    RenderableList const& renderables)
+{
     // First, remove everything
     for (auto const& element : current_elements)
     {
@@ -259,13 +304,18 @@ bool mg::rpi::DisplayBuffer::overlay(mg::RenderableList const& renderlist)
     }
     current_elements.clear();
 
-    // Add an opaque black background.
-    vc_dispmanx_display_set_background(update_handle, display_handle, 0, 0, 0);
+    // What they showed can go once the update is submitted
+    retired_resources.insert(retired_resources.end(), current_resources.begin(), current_resources.end());
+    current_resources.clear();
+    // ...and the HVS goes on scanning out their buffers until then
+    std::move(current_buffers.begin(), current_buffers.end(), std::back_inserter(retired_buffers));
+    current_buffers.clear();
 
+    // The EGL layer is layer 0
     int32_t layer{0};
 
     // Now, add the renderables
-    for (auto const& renderable : renderlist)
+    for (auto const& renderable : renderables)
     {
         layer++;
 
@@ -279,11 +329,13 @@ bool mg::rpi::DisplayBuffer::overlay(mg::RenderableList const& renderlist)
             renderable->screen_position().size.height.as_uint32_t());
 
         // …but source rect coödinates are in 16.16 fixed point.
+        auto const src = renderable->src_bounds();
         vc_dispmanx_rect_set(
             &src_rect,
-            0, 0,
-            renderable->buffer()->size().width.as_uint32_t() << 16,
-            renderable->buffer()->size().height.as_uint32_t() << 16);
+            static_cast<uint32_t>(src.top_left.x.as_value() * 65536),
+            static_cast<uint32_t>(src.top_left.y.as_value() * 65536),
+            static_cast<uint32_t>(src.size.width.as_value() * 65536),
+            static_cast<uint32_t>(src.size.height.as_value() * 65536));
 
         VC_DISPMANX_ALPHA_T alpha_flags = {
             static_cast<DISPMANX_FLAGS_ALPHA_T>(DISPMANX_FLAGS_ALPHA_FROM_SOURCE | DISPMANX_FLAGS_ALPHA_MIX),
@@ -299,7 +351,7 @@ bool mg::rpi::DisplayBuffer::overlay(mg::RenderableList const& renderlist)
                 display_handle,
                 layer,
                 &dest_rect,
-                dispmanx_handle_for_renderable(*renderable),
+                dispmanx_handle_for_renderable(*renderable, current_resources),
                 &src_rect,
                 DISPMANX_PROTECTION_NONE,
                 &alpha_flags,
@@ -310,12 +362,20 @@ bool mg::rpi::DisplayBuffer::overlay(mg::RenderableList const& renderlist)
             // TODO: We should probably back out to GL rendering here
             BOOST_THROW_EXCEPTION((std::runtime_error{"Failed to add element to DispmanX display list"}));
         }
-    }
 
-    // TODO: This doesn't have to be synchronous; we could use the vblank callback.
-    vc_dispmanx_update_submit_sync(update_handle);
+        // The HVS reads the buffer for as long as the element is shown
+        current_buffers.push_back(renderable->buffer());
+    }
+}
 
-    return true;
+void mg::rpi::DisplayBuffer::delete_retired_resources()
+{
+    for (auto const resource : retired_resources)
+    {
+        vc_dispmanx_resource_delete(resource);
+    }
+    retired_resources.clear();
+    retired_buffers.clear();
 }
 
 glm::mat2 mg::rpi::DisplayBuffer::transformation() const
@@ -343,6 +403,12 @@ void mg::rpi::DisplayBuffer::release_current()
     }
 }
 
+void mg::rpi::DisplayBuffer::swap_buffers_with_damage(geometry::Rectangles const&)
+{
+    // The dispmanx EGL implementation doesn't support partial updates
+    swap_buffers();
+}
+
 void mg::rpi::DisplayBuffer::swap_buffers()
 {
     if (eglSwapBuffers(dpy, surface) != EGL_TRUE)
@@ -350,40 +416,25 @@ void mg::rpi::DisplayBuffer::swap_buffers()
         BOOST_THROW_EXCEPTION((mg::egl_error("Failed to swap buffers")));
     }
 
-    if (!current_elements.empty())
+    if (!current_elements.empty() || !pending_elements.empty() || !egl_layer_visible)
     {
-        /* Previous frame used overlays; we need to remove them and then re-expand
-         * the EGL layer to fullscreen
-         */
         auto const update_handle = vc_dispmanx_update_start(0);
 
-        for (auto const& element : current_elements)
+        if (!egl_layer_visible)
         {
-            vc_dispmanx_element_remove(update_handle, element);
+            // Previous frame was all overlays; we need to re-expand the EGL layer to fullscreen
+            set_dest_rect(update_handle, egl_target_element, view_area());
+            egl_layer_visible = true;
         }
-        current_elements.clear();
 
-        VC_RECT_T fullscreen_output;
-        vc_dispmanx_rect_set(
-            &fullscreen_output,
-            view_area().top_left.x.as_uint32_t(),
-            view_area().top_left.y.as_uint32_t(),
-            view_area().size.width.as_uint32_t(),
-            view_area().size.height.as_uint32_t());
-
-        vc_dispmanx_element_change_attributes(
-            update_handle,
-            egl_target_element,
-            ELEMENT_CHANGE_DEST_RECT,
-            0,
-            0,
-            &fullscreen_output,
-            nullptr,
-            DISPMANX_NO_HANDLE,
-            DISPMANX_NO_ROTATE);
+        // Whatever GL didn't composite goes above it
+        show_elements(update_handle, pending_elements);
+        pending_elements.clear();
 
         vc_dispmanx_update_submit_sync(update_handle);
     }
+
+    delete_retired_resources();
 }
 
 void mg::rpi::DisplayBuffer::bind()
@@ -26,6 +26,9 @@
 #include <EGL/egl.h>
 #include <bcm_host.h>
 
+#include <memory>
+#include <vector>
+
 namespace mir
 {
 namespace graphics
@@ -49,25 +52,38 @@ public:
     void for_each_display_buffer(std::function<void(graphics::DisplayBuffer&)> const& f) override;
     void post() override;
     std::chrono::milliseconds recommended_sleep() const override;
+    Frame last_frame() const override;
 
     geometry::Rectangle view_area() const override;
-    bool overlay(RenderableList const& renderlist) override;
+    bool overlay(RenderableList& renderlist) override;
     glm::mat2 transformation() const override;
     NativeDisplayBuffer* native_display_buffer() override;
 
     void make_current() override;
     void release_current() override;
     void swap_buffers() override;
+    void swap_buffers_with_damage(geometry::Rectangles const& damage) override;
     void bind() override;
 
 private:
+    /// Replaces the elements shown above the EGL layer with \a renderables, bottom first
+    void show_elements(DISPMANX_UPDATE_HANDLE_T update_handle, RenderableList const& renderables);
+    /// Deletes the resources, and releases the buffers, of elements whose removal has been submitted
+    void delete_retired_resources();
+
     geometry::Rectangle const view;
     EGLDisplay const dpy;
     EGLContext const ctx;
     DISPMANX_DISPLAY_HANDLE_T const display_handle;
     DISPMANX_ELEMENT_HANDLE_T const egl_target_element;
     EGLSurface const surface;
+    bool egl_layer_visible{true};
     std::vector<DISPMANX_ELEMENT_HANDLE_T> current_elements;
+    std::vector<std::shared_ptr<Buffer>> current_buffers;
+    std::vector<DISPMANX_RESOURCE_HANDLE_T> current_resources;  ///< Those we created for current_elements
+    std::vector<DISPMANX_RESOURCE_HANDLE_T> retired_resources;
+    std::vector<std::shared_ptr<Buffer>> retired_buffers;
+    RenderableList pending_elements;                            ///< To go above the next GL frame
 };
 }
 }
@@ -127,6 +127,7 @@ void mgw::BufferAllocator::bind_display(wl_display* display, std::shared_ptr<Exe
                     dpy,
                     egl_extensions,
                     modifier_ext,
+                    wayland_executor,
                 },
                 [wayland_executor](LinuxDmaBufUnstable* global)
                 {
@@ -200,11 +201,15 @@ auto mgw::BufferAllocator::buffer_from_resource(
 auto mgw::BufferAllocator::buffer_from_shm(
     wl_resource* buffer,
     std::shared_ptr<Executor> wayland_executor,
-    std::function<void()>&& on_consumed) -> std::shared_ptr<Buffer>
+    std::function<void()>&& on_consumed,
+    std::shared_ptr<Buffer> const& previous,
+    std::experimental::optional<geom::Rectangles> const& damage) -> std::shared_ptr<Buffer>
 {
     return mg::wayland::buffer_from_wl_shm(
         buffer,
         std::move(wayland_executor),
         egl_delegate,
-        std::move(on_consumed));
+        std::move(on_consumed),
+        previous,
+        damage);
 }
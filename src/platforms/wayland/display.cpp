@@ -83,9 +83,10 @@ mgw::Display* the_display = nullptr;
 
 mgw::Display::Display(
     wl_display* const wl_display,
+    bool forward_buffers,
     std::shared_ptr<GLConfig> const& gl_config,
     std::shared_ptr<DisplayReport> const& report) :
-    DisplayClient{wl_display, gl_config},
+    DisplayClient{wl_display, forward_buffers, gl_config},
     report{report},
     shutdown_signal{::eventfd(0, EFD_CLOEXEC)},
     flush_signal{::eventfd(0, EFD_SEMAPHORE)},
@@ -110,6 +111,23 @@ void mgw::Display::configure(DisplayConfiguration const& /*conf*/)
 {
 }
 
+void mgw::Display::configure_incrementally(
+    DisplayConfiguration const& conf,
+    std::function<void(DisplaySyncGroup&)> const& /*release*/)
+{
+    // Configuring doesn't touch the display buffers, so none need releasing
+    configure(conf);
+}
+
+bool mgw::Display::apply_if_configuration_only_changes_power_modes(
+    DisplayConfiguration const& /*conf*/,
+    std::function<void(DisplaySyncGroup&)> const& /*suspend*/,
+    std::function<void(DisplaySyncGroup&)> const& /*resume*/)
+{
+    // The host compositor's outputs have no power modes for us to change
+    return false;
+}
+
 void mgw::Display::register_configuration_change_handler(
     EventHandlerRegister& /*handlers*/,
     DisplayConfigurationChangeHandler const& /*conf_change_handler*/)
@@ -58,6 +58,7 @@ class Display : public mir::graphics::Display,
 public:
     Display(
         wl_display* const wl_display,
+        bool forward_buffers,
         std::shared_ptr<GLConfig> const& gl_config,
         std::shared_ptr<DisplayReport> const& report);
 
@@ -76,6 +77,14 @@ public:
     bool apply_if_configuration_preserves_display_buffers(DisplayConfiguration const& conf) override;
 
     void configure(DisplayConfiguration const& conf) override;
+    void configure_incrementally(
+        DisplayConfiguration const& conf,
+        std::function<void(DisplaySyncGroup&)> const& release) override;
+
+    bool apply_if_configuration_only_changes_power_modes(
+        DisplayConfiguration const& conf,
+        std::function<void(DisplaySyncGroup&)> const& suspend,
+        std::function<void(DisplaySyncGroup&)> const& resume) override;
 
     void register_configuration_change_handler(EventHandlerRegister& handlers,
         DisplayConfigurationChangeHandler const& conf_change_handler) override;
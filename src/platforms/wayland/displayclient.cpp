@@ -16,8 +16,12 @@
  */
 
 #include "displayclient.h"
+#include "host_buffer_cache.h"
 #include "mir/graphics/egl_error.h"
+#include <mir/graphics/dmabuf_buffer.h>
 #include <mir/graphics/pixel_format_utils.h>
+#include <mir/graphics/renderable.h>
+#include <mir/log.h>
 
 #include <wayland-client.h>
 #include <wayland-egl.h>
@@ -29,6 +33,8 @@
 #include <boost/throw_exception.hpp>
 
 #include <algorithm>
+#include <climits>
+#include <cmath>
 #include <condition_variable>
 #include <cstring>
 #include <stdlib.h>
@@ -95,14 +101,33 @@ public:
 
     std::function<void(Output const&)> on_done;
 
+    /// A host subsurface above ours, for showing a client buffer directly
+    struct Subsurface
+    {
+        Subsurface(wl_compositor* compositor, wl_subcompositor* subcompositor, wl_surface* parent);
+        ~Subsurface();
+
+        wl_surface* const surface;
+        wl_subsurface* const subsurface;
+    };
+
+    /// Bottom to top; grown as needed
+    std::vector<std::unique_ptr<Subsurface>> subsurfaces;
+    /// Unmapped by the frame being drawn, so destroyed once our commit has unmapped them
+    std::vector<std::unique_ptr<Subsurface>> retired_subsurfaces;
+
+    class HostBuffer;
+    HostBufferCache<HostBuffer> host_buffers;
+
     // DisplaySyncGroup implementation
     void for_each_display_buffer(std::function<void(DisplayBuffer&)> const& /*f*/) override;
     void post() override;
     std::chrono::milliseconds recommended_sleep() const override;
+    Frame last_frame() const override;
 
     // DisplayBuffer implementation
     auto view_area() const -> geometry::Rectangle override;
-    bool overlay(RenderableList const& renderlist) override;
+    bool overlay(RenderableList& renderlist) override;
     auto transformation() const -> glm::mat2 override;
     auto native_display_buffer() -> NativeDisplayBuffer* override;
 
@@ -110,7 +135,13 @@ public:
     void make_current() override;
     void release_current() override;
     void swap_buffers() override;
+    void swap_buffers_with_damage(geometry::Rectangles const& damage) override;
     void bind() override;
+
+private:
+    void swap_and_wait_for_frame(geometry::Rectangles const* damage);
+
+    auto can_forward(Renderable const& renderable) const -> bool;
 };
 
 namespace
@@ -122,6 +153,64 @@ static EGLint const ctxattribs[] =
     };
 }
 
+/// A wl_buffer sharing a client buffer with the host
+class mgw::DisplayClient::Output::HostBuffer : public std::enable_shared_from_this<HostBuffer>
+{
+public:
+    explicit HostBuffer(wl_buffer* buffer) :
+        buffer{buffer}
+    {
+        static wl_buffer_listener const listener{
+            [](void* data, wl_buffer*) { static_cast<HostBuffer*>(data)->released(); }
+        };
+
+        wl_buffer_add_listener(buffer, &listener, this);
+    }
+
+    ~HostBuffer()
+    {
+        wl_buffer_destroy(buffer);
+    }
+
+    /// Keeps the client's buffer from being reused (and us alive) until the host releases it
+    void attach_to(wl_surface* surface, std::shared_ptr<Buffer> const& client_buffer)
+    {
+        wl_surface_attach(surface, buffer, 0, 0);
+        held_client_buffer = client_buffer;
+        held_self = shared_from_this();
+    }
+
+private:
+    void released()
+    {
+        held_client_buffer.reset();
+        auto const last_reference = std::move(held_self);
+    }
+
+    wl_buffer* const buffer;
+    std::shared_ptr<Buffer> held_client_buffer;
+    std::shared_ptr<HostBuffer> held_self;
+};
+
+mgw::DisplayClient::Output::Subsurface::Subsurface(
+    wl_compositor* compositor,
+    wl_subcompositor* subcompositor,
+    wl_surface* parent) :
+    surface{wl_compositor_create_surface(compositor)},
+    subsurface{wl_subcompositor_get_subsurface(subcompositor, surface, parent)}
+{
+    // Leave input to the parent, where we expect it
+    auto const empty = wl_compositor_create_region(compositor);
+    wl_surface_set_input_region(surface, empty);
+    wl_region_destroy(empty);
+}
+
+mgw::DisplayClient::Output::Subsurface::~Subsurface()
+{
+    wl_subsurface_destroy(subsurface);
+    wl_surface_destroy(surface);
+}
+
 void mgw::DisplayClient::Output::geometry(
     void* data,
     struct wl_output* /*wl_output*/,
@@ -239,7 +328,14 @@ mgw::DisplayClient::Output::Output(
     owner{owner},
     surface{wl_compositor_create_surface(owner->compositor)},
     on_done{[this, on_constructed = std::move(on_constructed), on_change=std::move(on_change)]
-        (Output const& o) mutable { on_constructed(o), on_done = std::move(on_change); }}
+        (Output const& o) mutable { on_constructed(o), on_done = std::move(on_change); }},
+    host_buffers{[owner](std::shared_ptr<Buffer> const& buffer) -> std::shared_ptr<HostBuffer>
+        {
+            auto const host_buffer = (*owner->buffer_from_image)(
+                owner->egldisplay,
+                *dynamic_cast<DMABufBuffer*>(buffer->native_buffer_base()));
+            return host_buffer ? std::make_shared<HostBuffer>(host_buffer) : nullptr;
+        }}
 {
     wl_output_add_listener(output, &output_listener, this);
 
@@ -259,6 +355,9 @@ mgw::DisplayClient::Output::Output(
 
 mgw::DisplayClient::Output::~Output()
 {
+    retired_subsurfaces.clear();
+    subsurfaces.clear();
+
     if (output)
         wl_output_destroy(output);
 
@@ -323,13 +422,83 @@ auto mgw::DisplayClient::Output::recommended_sleep() const -> std::chrono::milli
     return std::chrono::milliseconds{0};
 }
 
+auto mgw::DisplayClient::Output::last_frame() const -> Frame
+{
+    // The host doesn't tell us when our frames reach its screen
+    return {};
+}
+
 auto mgw::DisplayClient::Output::view_area() const -> geometry::Rectangle
 {
     return dcout.extents();
 }
 
-bool mgw::DisplayClient::Output::overlay(mir::graphics::RenderableList const&)
+auto mgw::DisplayClient::Output::can_forward(Renderable const& renderable) const -> bool
 {
+    // Without wp_viewporter the host can only show a buffer at its own size
+    auto const scale = static_cast<int>(std::round(dcout.scale));
+    auto const area = renderable.screen_position();
+    auto const buffer = renderable.buffer();
+
+    return dynamic_cast<DMABufBuffer*>(buffer->native_buffer_base()) &&
+        renderable.transformation() == glm::mat4{1} &&
+        renderable.alpha() == 1.0f &&
+        !renderable.clip_area() &&
+        renderable.src_bounds() == geometry::RectangleF{{}, geometry::SizeF{buffer->size()}} &&
+        buffer->size() == geometry::Size{area.size.width.as_int() * scale, area.size.height.as_int() * scale} &&
+        view_area().contains(area);
+}
+
+bool mgw::DisplayClient::Output::overlay(mir::graphics::RenderableList& renderlist)
+{
+    if (!owner->buffer_from_image || !owner->subcompositor)
+        return false;
+
+    // Subsurfaces sit above our (opaque) surface, so only the top of the stack can go on them
+    std::vector<std::pair<std::shared_ptr<Renderable>, std::shared_ptr<HostBuffer>>> forwarded;
+    for (auto r = renderlist.rbegin(); r != renderlist.rend() && can_forward(**r); ++r)
+    {
+        auto const host_buffer = host_buffers.host_buffer_for((*r)->buffer());
+        if (!host_buffer)
+            break;
+
+        forwarded.emplace_back(*r, host_buffer);
+    }
+    host_buffers.end_frame();
+
+    while (subsurfaces.size() < forwarded.size())
+        subsurfaces.push_back(std::make_unique<Subsurface>(owner->compositor, owner->subcompositor, surface));
+
+    // Subsurfaces are synchronized, so none of this shows until our own commit in swap_buffers()
+    auto const scale = static_cast<int>(std::round(dcout.scale));
+    auto below = surface;
+    auto next = begin(subsurfaces);
+    for (auto f = forwarded.rbegin(); f != forwarded.rend(); ++f, ++next)
+    {
+        auto& subsurface = **next;
+        auto const position = f->first->screen_position().top_left - dcout.top_left;
+
+        wl_subsurface_set_position(subsurface.subsurface, position.dx.as_int(), position.dy.as_int());
+        wl_subsurface_place_above(subsurface.subsurface, below);
+        wl_surface_set_buffer_scale(subsurface.surface, scale);
+        f->second->attach_to(subsurface.surface, f->first->buffer());
+        wl_surface_damage(subsurface.surface, 0, 0, INT32_MAX, INT32_MAX);
+        wl_surface_commit(subsurface.surface);
+
+        below = subsurface.surface;
+    }
+
+    // Destroying a subsurface unmaps it at once, so the rest are unmapped with our commit first
+    for (; next != end(subsurfaces); ++next)
+    {
+        wl_surface_attach((*next)->surface, nullptr, 0, 0);
+        wl_surface_commit((*next)->surface);
+        retired_subsurfaces.push_back(std::move(*next));
+    }
+    subsurfaces.resize(forwarded.size());
+
+    // The rest is composited with GL as usual
+    renderlist.erase(renderlist.end() - forwarded.size(), renderlist.end());
     return false;
 }
 
@@ -358,6 +527,16 @@ void mgw::DisplayClient::Output::release_current()
 }
 
 void mgw::DisplayClient::Output::swap_buffers()
+{
+    swap_and_wait_for_frame(nullptr);
+}
+
+void mgw::DisplayClient::Output::swap_buffers_with_damage(geometry::Rectangles const& damage)
+{
+    swap_and_wait_for_frame(&damage);
+}
+
+void mgw::DisplayClient::Output::swap_and_wait_for_frame(geometry::Rectangles const* damage)
 {
     struct FrameSync
     {
@@ -402,9 +581,17 @@ void mgw::DisplayClient::Output::swap_buffers()
     // Instead we use the frame "done" notification.
     eglSwapInterval(owner->egldisplay, 0);
 
-    if (eglSwapBuffers(owner->egldisplay, eglsurface) != EGL_TRUE)
+    // Passing the damage on lets the host compositor limit its own repaint
+    auto const swapped = damage && owner->swap_with_damage ?
+        (*owner->swap_with_damage)(owner->egldisplay, eglsurface, *damage) :
+        eglSwapBuffers(owner->egldisplay, eglsurface);
+
+    if (swapped != EGL_TRUE)
         BOOST_THROW_EXCEPTION(egl_error("Failed to perform buffer swap"));
 
+    // Our commit has unmapped them
+    retired_subsurfaces.clear();
+
     frame_sync.wait_for_done();
 }
 
@@ -414,6 +601,7 @@ void mgw::DisplayClient::Output::bind()
 
 mgw::DisplayClient::DisplayClient(
     wl_display* display,
+    bool forward_buffers,
     std::shared_ptr<GLConfig> const& gl_config) :
     display{display},
     keyboard_context_{xkb_context_new(XKB_CONTEXT_NO_FLAGS)},
@@ -457,6 +645,17 @@ mgw::DisplayClient::DisplayClient(
     if (major != 1 || minor < 4)
         BOOST_THROW_EXCEPTION(egl_error("EGL version is not at least 1.4"));
 
+    if (auto const extension = EGLExtensions::SwapBuffersWithDamage::maybe_swap_buffers_with_damage(egldisplay))
+        swap_with_damage.emplace(*extension);
+
+    if (forward_buffers)
+    {
+        if (auto const extension = EGLExtensions::WaylandBufferFromImage::maybe_wayland_buffer_from_image(egldisplay))
+            buffer_from_image.emplace(*extension);
+        else
+            mir::log_warning("Host EGL can't create wl_buffers from dma-bufs; not forwarding client buffers");
+    }
+
     EGLint neglconfigs;
     if (!eglChooseConfig(egldisplay, cfgattribs, &eglconfig, 1, &neglconfigs))
         BOOST_THROW_EXCEPTION(egl_error("Could not eglChooseConfig"));
@@ -512,6 +711,11 @@ void mgw::DisplayClient::new_global(
         self->compositor =
             static_cast<decltype(self->compositor)>(wl_registry_bind(registry, id, &wl_compositor_interface, std::min(version, 3u)));
     }
+    else if (strcmp(interface, "wl_subcompositor") == 0)
+    {
+        self->subcompositor = static_cast<decltype(self->subcompositor)>(
+            wl_registry_bind(registry, id, &wl_subcompositor_interface, std::min(version, 1u)));
+    }
     else if (strcmp(interface, "wl_shm") == 0)
     {
         self->shm = static_cast<decltype(self->shm)>(wl_registry_bind(registry, id, &wl_shm_interface, std::min(version, 1u)));
@@ -24,6 +24,7 @@
 #include <mir/graphics/display_configuration.h>
 #include <mir/renderer/gl/render_target.h>
 #include <mir/graphics/gl_config.h>
+#include <mir/graphics/egl_extensions.h>
 
 #include <wayland-client.h>
 #include <EGL/egl.h>
@@ -32,6 +33,7 @@
 #include <unordered_map>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <mir/geometry/displacement.h>
 
 struct xkb_context;
@@ -49,6 +51,7 @@ class DisplayClient
 {
 public:
     DisplayClient(wl_display* display,
+    bool forward_buffers,
     std::shared_ptr<GLConfig> const& gl_config);
 
     virtual ~DisplayClient();
@@ -129,6 +132,7 @@ protected:
     void on_output_gone(Output const*);
 
     wl_compositor* compositor = nullptr;
+    wl_subcompositor* subcompositor = nullptr;
     wl_shell* shell = nullptr;
     wl_seat* seat = nullptr;
     wl_shm* shm = nullptr;
@@ -168,6 +172,9 @@ protected:
     EGLDisplay egldisplay;
     EGLConfig eglconfig;
     EGLContext eglctx;
+    std::optional<EGLExtensions::SwapBuffersWithDamage> swap_with_damage;
+    /// Set if we were asked to forward client buffers to the host and EGL lets us
+    std::optional<EGLExtensions::WaylandBufferFromImage> buffer_from_image;
 };
 }
 }
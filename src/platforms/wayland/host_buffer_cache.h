@@ -0,0 +1,85 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_PLATFORMS_WAYLAND_HOST_BUFFER_CACHE_H_
+#define MIR_PLATFORMS_WAYLAND_HOST_BUFFER_CACHE_H_
+
+#include <mir/graphics/buffer.h>
+#include <mir/graphics/buffer_id.h>
+
+#include <functional>
+#include <map>
+#include <memory>
+
+namespace mir
+{
+namespace graphics
+{
+namespace wayland
+{
+/**
+ * What we've shared with the host for each client buffer we forward, kept for as long as
+ * the client buffer is shown so a frame only imports the buffers that are new to it.
+ */
+template<typename HostBuffer>
+class HostBufferCache
+{
+public:
+    /// Shares \a buffer with the host, returning null if it can't be
+    using Import = std::function<std::shared_ptr<HostBuffer>(std::shared_ptr<Buffer> const& buffer)>;
+
+    explicit HostBufferCache(Import import)
+        : import{std::move(import)}
+    {
+    }
+
+    /// What is shared for \a buffer: that of the last frame if it was in it, or newly imported
+    auto host_buffer_for(std::shared_ptr<Buffer> const& buffer) -> std::shared_ptr<HostBuffer>
+    {
+        auto const id = buffer->id();
+        if (auto const shown = current.find(id); shown != current.end())
+            return shown->second;
+
+        std::shared_ptr<HostBuffer> host_buffer;
+        if (auto const last = previous.find(id); last != previous.end())
+            host_buffer = last->second;
+        else
+            host_buffer = import(buffer);
+
+        if (host_buffer)
+            current.emplace(id, host_buffer);
+        return host_buffer;
+    }
+
+    /// Forgets what was shared for the buffers that weren't in the frame just ended
+    void end_frame()
+    {
+        previous = std::move(current);
+        current.clear();
+    }
+
+    auto size() const -> size_t { return previous.size() + current.size(); }
+
+private:
+    Import const import;
+    std::map<BufferID, std::shared_ptr<HostBuffer>> previous;
+    std::map<BufferID, std::shared_ptr<HostBuffer>> current;
+};
+}
+}
+}
+
+#endif // MIR_PLATFORMS_WAYLAND_HOST_BUFFER_CACHE_H_
@@ -31,8 +31,12 @@ namespace mg = mir::graphics;
 namespace mgw = mir::graphics::wayland;
 using namespace std::literals;
 
-mgw::Platform::Platform(struct wl_display* const wl_display, std::shared_ptr<mg::DisplayReport> const& report) :
+mgw::Platform::Platform(
+    struct wl_display* const wl_display,
+    bool forward_buffers,
+    std::shared_ptr<mg::DisplayReport> const& report) :
     wl_display{wl_display},
+    forward_buffers{forward_buffers},
     report{report}
 {
     if (!wl_display)
@@ -45,7 +49,7 @@ mir::UniqueModulePtr<mg::Display> mgw::Platform::create_display(
     std::shared_ptr<DisplayConfigurationPolicy> const&,
     std::shared_ptr<GLConfig> const& gl_config)
 {
-  return mir::make_module_ptr<mgw::Display>(wl_display, gl_config, report);
+  return mir::make_module_ptr<mgw::Display>(wl_display, forward_buffers, gl_config, report);
 }
 
 EGLNativeDisplayType mgw::Platform::egl_native_display() const
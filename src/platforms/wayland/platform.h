@@ -41,7 +41,10 @@ class Platform : public graphics::Platform,
                  public mir::renderer::gl::EGLPlatform
 {
 public:
-    Platform(struct wl_display* const wl_display, std::shared_ptr<DisplayReport> const& report);
+    Platform(
+        struct wl_display* const wl_display,
+        bool forward_buffers,
+        std::shared_ptr<DisplayReport> const& report);
     ~Platform() = default;
 
     UniqueModulePtr<GraphicBufferAllocator> create_buffer_allocator(Display const& output) override;
@@ -54,6 +57,7 @@ public:
 
 private:
     struct wl_display* const wl_display;
+    bool const forward_buffers;
     std::shared_ptr<DisplayReport> const report;
 };
 }
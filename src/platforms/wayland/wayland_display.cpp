@@ -36,6 +36,10 @@ struct WaylandDisplay
 
 char const* wayland_host_option_name{"wayland-host"};
 char const* wayland_host_option_description{"Socket name for host compositor"};
+
+char const* forward_buffers_option_name{"wayland-forward-buffers"};
+char const* forward_buffers_option_description{
+    "Where possible, hand client buffers to the host compositor as subsurfaces instead of compositing them"};
 }
 
 void mpw::add_connection_options(boost::program_options::options_description& config)
@@ -43,7 +47,10 @@ void mpw::add_connection_options(boost::program_options::options_description& co
     config.add_options()
         (wayland_host_option_name,
          boost::program_options::value<std::string>(),
-         wayland_host_option_description);
+         wayland_host_option_description)
+        (forward_buffers_option_name,
+         boost::program_options::value<bool>()->default_value(false),
+         forward_buffers_option_description);
 }
 
 auto mpw::connection(options::Option const& options) -> struct wl_display*
@@ -54,6 +61,11 @@ auto mpw::connection(options::Option const& options) -> struct wl_display*
     return wayland_display->wl_display;
 }
 
+auto mpw::forward_buffers(options::Option const& options) -> bool
+{
+    return options.get<bool>(forward_buffers_option_name);
+}
+
 auto mir::platform::wayland::connection_options_supplied(mir::options::Option const& options) -> bool
 {
     return options.is_set(wayland_host_option_name);
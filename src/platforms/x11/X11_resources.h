@@ -20,6 +20,8 @@
 #define MIR_X11_RESOURCES_H_
 
 #include <X11/Xlib.h>
+#include <chrono>
+#include <cstdint>
 #include <optional>
 #include <unordered_map>
 #include <functional>
@@ -54,6 +56,9 @@ public:
 
         virtual auto configuration() const -> graphics::DisplayConfigurationOutput const& = 0;
         virtual void set_size(geometry::Size const& size) = 0;
+
+        /// A frame reached the screen at \a ust (CLOCK_MONOTONIC), as told by PresentCompleteNotify
+        virtual void frame_presented(uint64_t msc, std::chrono::microseconds ust) = 0;
     };
 
     auto get_conn() -> std::shared_ptr<::Display>;
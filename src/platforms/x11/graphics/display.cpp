@@ -301,6 +301,24 @@ void mgx::Display::configure(mg::DisplayConfiguration const& new_configuration)
     });
 }
 
+void mgx::Display::configure_incrementally(
+    mg::DisplayConfiguration const& conf,
+    std::function<void(mg::DisplaySyncGroup&)> const& release)
+{
+    // The display buffers are updated in place, which mustn't happen while they're composited
+    for_each_display_sync_group(release);
+    configure(conf);
+}
+
+bool mgx::Display::apply_if_configuration_only_changes_power_modes(
+    mg::DisplayConfiguration const& /*conf*/,
+    std::function<void(mg::DisplaySyncGroup&)> const& /*suspend*/,
+    std::function<void(mg::DisplaySyncGroup&)> const& /*resume*/)
+{
+    // The windows we show outputs in have no power modes of their own
+    return false;
+}
+
 void mgx::Display::register_configuration_change_handler(
     EventHandlerRegister& /* event_handler*/,
     DisplayConfigurationChangeHandler const& change_handler)
@@ -387,3 +405,8 @@ void mgx::Display::OutputInfo::set_size(geometry::Size const& size)
         handler();
     }
 }
+
+void mgx::Display::OutputInfo::frame_presented(uint64_t msc, std::chrono::microseconds ust)
+{
+    display_buffer->frame_presented(msc, ust);
+}
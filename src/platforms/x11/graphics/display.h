@@ -85,6 +85,14 @@ public:
     bool apply_if_configuration_preserves_display_buffers(graphics::DisplayConfiguration const& conf) override;
 
     void configure(graphics::DisplayConfiguration const&) override;
+    void configure_incrementally(
+        graphics::DisplayConfiguration const& conf,
+        std::function<void(graphics::DisplaySyncGroup&)> const& release) override;
+
+    bool apply_if_configuration_only_changes_power_modes(
+        graphics::DisplayConfiguration const& conf,
+        std::function<void(graphics::DisplaySyncGroup&)> const& suspend,
+        std::function<void(graphics::DisplaySyncGroup&)> const& resume) override;
 
     void register_configuration_change_handler(
         EventHandlerRegister& handlers,
@@ -117,6 +125,7 @@ private:
 
         auto configuration() const -> graphics::DisplayConfigurationOutput const& override { return *config; }
         void set_size(geometry::Size const& size) override;
+        void frame_presented(uint64_t msc, std::chrono::microseconds ust) override;
 
         Display* const owner;
         std::unique_ptr<X11Window> const window;
@@ -23,6 +23,7 @@
 #include "display_configuration.h"
 #include "mir/graphics/display_report.h"
 #include "mir/graphics/transformation.h"
+#include <X11/extensions/Xpresent.h>
 #include <cstring>
 
 namespace mg=mir::graphics;
@@ -41,7 +42,7 @@ mgx::DisplayBuffer::DisplayBuffer(::Display* const x_dpy,
                                     area{view_area},
                                     transform(1),
                                     egl{gl_config, x_dpy, win, shared_context},
-                                    last_frame{f},
+                                    last_frame_{f},
                                     output_id{output_id},
                                     eglGetSyncValues{nullptr}
 {
@@ -80,6 +81,15 @@ mgx::DisplayBuffer::DisplayBuffer(::Display* const x_dpy,
             eglGetSyncValues = reinterpret_cast<EglGetSyncValuesCHROMIUM*>(
                                  eglGetProcAddress("eglGetSyncValuesCHROMIUM"));
     }
+
+    /*
+     * Mesa's X11 EGL already swaps through DRI3/Present, so the server knows
+     * exactly when each frame reaches the screen. Asking for the completion
+     * events gets us that, rather than our best guess at swap time.
+     */
+    int opcode, event_base, error_base;
+    if (XPresentQueryExtension(x_dpy, &opcode, &event_base, &error_base))
+        XPresentSelectInput(x_dpy, win, PresentCompleteNotifyMask);
 }
 
 geom::Rectangle mgx::DisplayBuffer::view_area() const
@@ -98,7 +108,7 @@ void mgx::DisplayBuffer::release_current()
     egl.release_current();
 }
 
-bool mgx::DisplayBuffer::overlay(RenderableList const& /*renderlist*/)
+bool mgx::DisplayBuffer::overlay(RenderableList& /*renderlist*/)
 {
     return false;
 }
@@ -108,15 +118,31 @@ void mgx::DisplayBuffer::swap_buffers()
     if (!egl.swap_buffers())
         fatal_error("Failed to perform buffer swap");
 
+    update_last_frame();
+}
+
+void mgx::DisplayBuffer::swap_buffers_with_damage(geometry::Rectangles const& damage)
+{
+    if (!egl.swap_buffers_with_damage(damage))
+        fatal_error("Failed to perform buffer swap");
+
+    update_last_frame();
+}
+
+void mgx::DisplayBuffer::update_last_frame()
+{
     /*
      * It would be nice to call this on demand as required. However the
      * implementation requires an EGL context. So for simplicity we call it here
      * on every frame.
-     *   This does mean the current last_frame will be a bit out of date if
+     *   This does mean the current last_frame_ will be a bit out of date if
      * the compositor missed a frame. But that doesn't actually matter because
      * the consequence of that would be the client scheduling the next frame
      * immediately without waiting, which is probably ideal anyway.
      */
+    if (have_present_timestamps)
+        return;
+
     int64_t ust_us, msc, sbc;
     if (eglGetSyncValues &&
         eglGetSyncValues(egl.display(), egl.surface(), &ust_us, &msc, &sbc))
@@ -125,12 +151,13 @@ void mgx::DisplayBuffer::swap_buffers()
         mg::Frame frame;
         frame.msc = msc;
         frame.ust = {CLOCK_MONOTONIC, ust_ns};
-        last_frame->store(frame);
+        frame.hardware = true;
+        last_frame_->store(frame);
         (void)sbc; // unused
     }
     else  // Extension not available? Fall back to a reasonable estimate:
     {
-        last_frame->increment_now();
+        last_frame_->increment_now();
     }
 
     /*
@@ -138,7 +165,19 @@ void mgx::DisplayBuffer::swap_buffers()
      * but this is best-effort. And besides, we don't want Mir reporting all
      * real vsyncs because that would mean the compositor never sleeps.
      */
-    report->report_vsync(output_id.as_value(), last_frame->load());
+    report->report_vsync(output_id.as_value(), last_frame_->load());
+}
+
+void mgx::DisplayBuffer::frame_presented(uint64_t msc, std::chrono::microseconds ust)
+{
+    mg::Frame frame;
+    frame.msc = msc;
+    frame.ust = {CLOCK_MONOTONIC, ust};
+    frame.hardware = true;
+    last_frame_->store(frame);
+    have_present_timestamps = true;
+
+    report->report_vsync(output_id.as_value(), frame);
 }
 
 void mgx::DisplayBuffer::bind()
@@ -175,6 +214,11 @@ void mgx::DisplayBuffer::post()
 {
 }
 
+mg::Frame mgx::DisplayBuffer::last_frame() const
+{
+    return last_frame_->load();
+}
+
 std::chrono::milliseconds mgx::DisplayBuffer::recommended_sleep() const
 {
     return std::chrono::milliseconds::zero();
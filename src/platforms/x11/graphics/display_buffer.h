@@ -27,6 +27,8 @@
 #include "egl_helper.h"
 
 #include <EGL/egl.h>
+#include <atomic>
+#include <chrono>
 #include <memory>
 
 namespace mir
@@ -61,8 +63,9 @@ public:
     void make_current() override;
     void release_current() override;
     void swap_buffers() override;
+    void swap_buffers_with_damage(geometry::Rectangles const& damage) override;
     void bind() override;
-    bool overlay(RenderableList const& renderlist) override;
+    bool overlay(RenderableList& renderlist) override;
     void set_view_area(geometry::Rectangle const& a);
     void set_transformation(glm::mat2 const& t);
 
@@ -70,22 +73,31 @@ public:
         std::function<void(graphics::DisplayBuffer&)> const& f) override;
     void post() override;
     std::chrono::milliseconds recommended_sleep() const override;
+    Frame last_frame() const override;
 
     glm::mat2 transformation() const override;
     NativeDisplayBuffer* native_display_buffer() override;
 
+    /// Record a frame the X server says reached the screen
+    void frame_presented(uint64_t msc, std::chrono::microseconds ust);
+
 private:
+    void update_last_frame();
+
     std::shared_ptr<DisplayReport> const report;
     geometry::Rectangle area;
     glm::mat2 transform;
     helpers::EGLHelper const egl;
-    std::shared_ptr<AtomicFrame> const last_frame;
+    std::shared_ptr<AtomicFrame> const last_frame_;
     DisplayConfigurationOutputId const output_id;
 
     typedef EGLBoolean (EGLAPIENTRY EglGetSyncValuesCHROMIUM)
         (EGLDisplay dpy, EGLSurface surface, int64_t *ust,
          int64_t *msc, int64_t *sbc);
     EglGetSyncValuesCHROMIUM* eglGetSyncValues;
+
+    /// Set once PresentCompleteNotify gives us real timestamps, after which we stop guessing
+    std::atomic<bool> have_present_timestamps{false};
 };
 
 }
@@ -105,6 +105,15 @@ bool mgxh::EGLHelper::swap_buffers() const
     return (ret == EGL_TRUE);
 }
 
+bool mgxh::EGLHelper::swap_buffers_with_damage(geometry::Rectangles const& damage) const
+{
+    if (!swap_with_damage)
+        return swap_buffers();
+
+    auto ret = (*swap_with_damage)(egl_display, egl_surface, damage);
+    return (ret == EGL_TRUE);
+}
+
 bool mgxh::EGLHelper::make_current() const
 {
     auto ret = eglMakeCurrent(egl_display, egl_surface, egl_surface, egl_context);
@@ -173,6 +182,9 @@ void mgxh::EGLHelper::setup_internal(::Display* const x_dpy, bool initialize)
     {
         BOOST_THROW_EXCEPTION(mg::egl_error("Failed to choose ARGB EGL config"));
     }
+
+    if (auto const extension = EGLExtensions::SwapBuffersWithDamage::maybe_swap_buffers_with_damage(egl_display))
+        swap_with_damage.emplace(*extension);
 }
 
 void mgxh::EGLHelper::report_egl_configuration(std::function<void(EGLDisplay, EGLConfig)> f) const
@@ -19,8 +19,12 @@
 #ifndef MIR_GRAPHICS_X11_EGL_HELPER_H_
 #define MIR_GRAPHICS_X11_EGL_HELPER_H_
 
+#include "mir/graphics/egl_extensions.h"
+#include "mir/geometry/rectangles.h"
+
 #include <memory>
 #include <functional>
+#include <optional>
 
 #include <X11/Xlib.h>
 #include <EGL/egl.h>
@@ -49,6 +53,7 @@ public:
     ~EGLHelper() noexcept;
 
     bool swap_buffers() const;
+    bool swap_buffers_with_damage(geometry::Rectangles const& damage) const;
     bool make_current() const;
     bool release_current() const;
 
@@ -69,6 +74,7 @@ private:
     EGLContext egl_context;
     EGLSurface egl_surface;
     bool should_terminate_egl;
+    std::optional<EGLExtensions::SwapBuffersWithDamage> swap_with_damage;
 };
 
 }
@@ -29,6 +29,7 @@
 #include "mir/log.h"
 
 #include <X11/extensions/Xfixes.h>
+#include <X11/extensions/Xpresent.h>
 #include <X11/Xutil.h>
 #include <X11/Xlib.h>
 #include <linux/input.h>
@@ -73,6 +74,14 @@ geom::Point get_pos_on_output(Window x11_window, int x, int y)
     return pos;
 }
 
+auto present_opcode(::Display* dpy) -> std::optional<int>
+{
+    int opcode, event_base, error_base;
+    if (XPresentQueryExtension(dpy, &opcode, &event_base, &error_base))
+        return opcode;
+    return std::nullopt;
+}
+
 void window_resized(Window x11_window, geom::Size const& size)
 {
     mx::X11Resources::instance.with_output_for_window(
@@ -101,7 +110,8 @@ mix::XInputPlatform::XInputPlatform(std::shared_ptr<mi::InputDeviceRegistry> con
     core_pointer(std::make_shared<mix::XInputDevice>(
             mi::InputDeviceInfo{"x11-mouse-device", "x11-mouse-dev-1", mi::DeviceCapability::pointer})),
     kbd_grabbed{false},
-    ptr_grabbed{false}
+    ptr_grabbed{false},
+    present_opcode{::present_opcode(conn.get())}
 {
 }
 
@@ -140,6 +150,13 @@ void mix::XInputPlatform::process_input_event()
 
         XNextEvent(x11_connection.get(), &xev);
 
+        // Frame timing is for the display, so it doesn't wait on the input devices
+        if (xev.type == GenericEvent && present_opcode && xev.xcookie.extension == *present_opcode)
+        {
+            process_present_event(xev.xcookie);
+            continue;
+        }
+
         if (core_keyboard->started() && core_pointer->started())
         {
             switch (xev.type)
@@ -358,3 +375,27 @@ void mix::XInputPlatform::process_input_event()
             mir::log_error("input event received with no sink to handle it");
     }
 }
+
+void mix::XInputPlatform::process_present_event(XGenericEventCookie& cookie)
+{
+    if (cookie.evtype != PresentCompleteNotify || !XGetEventData(x11_connection.get(), &cookie))
+        return;
+
+    auto const& xpcev = *static_cast<XPresentCompleteNotifyEvent const*>(cookie.data);
+
+    // Skipped presents never reached the screen, and notify-MSC completions aren't frames
+    if (xpcev.kind == PresentCompleteKindPixmap && xpcev.mode != PresentCompleteModeSkip)
+    {
+        mx::X11Resources::instance.with_output_for_window(
+            xpcev.window,
+            [&](std::optional<mx::X11Resources::VirtualOutput*> output)
+            {
+                if (output)
+                {
+                    output.value()->frame_presented(xpcev.msc, std::chrono::microseconds{xpcev.ust});
+                }
+            });
+    }
+
+    XFreeEventData(x11_connection.get(), &cookie);
+}
@@ -20,6 +20,7 @@
 
 #include "mir/input/platform.h"
 #include <memory>
+#include <optional>
 #include <X11/Xlib.h>
 
 namespace mir
@@ -53,6 +54,7 @@ public:
 
 private:
     void process_input_event();
+    void process_present_event(XGenericEventCookie& cookie);
     std::shared_ptr<::Display> x11_connection;
     std::shared_ptr<dispatch::ReadableFd> const xcon_dispatchable;
     std::shared_ptr<input::InputDeviceRegistry> const registry;
@@ -60,6 +62,7 @@ private:
     std::shared_ptr<XInputDevice> const core_pointer;
     bool kbd_grabbed;
     bool ptr_grabbed;
+    std::optional<int> const present_opcode;
 };
 
 }
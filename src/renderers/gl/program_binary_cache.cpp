@@ -0,0 +1,204 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define MIR_LOG_COMPONENT "GLRenderer"
+
+#include "program_binary_cache.h"
+#include "mir/log.h"
+
+#include <EGL/egl.h>
+#include <boost/filesystem.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <sstream>
+#include <vector>
+
+#include <stdlib.h>
+#include <unistd.h>
+
+namespace mrg = mir::renderer::gl;
+
+namespace
+{
+template<typename Proc>
+auto proc_address(char const* name) -> Proc
+{
+    return reinterpret_cast<Proc>(eglGetProcAddress(name));
+}
+
+auto gl_string(GLenum name) -> std::string
+{
+    auto const value = reinterpret_cast<char const*>(glGetString(name));
+    return value ? value : "";
+}
+
+/* A cache file holds the binary format, the full key (to catch hash collisions)
+ * and then the binary itself.
+ */
+struct FileHeader
+{
+    uint32_t format;
+    uint32_t key_length;
+};
+}
+
+mrg::ProgramBinaryCache::ProgramBinaryCache(std::string directory)
+    : directory{std::move(directory)},
+      get_program_binary{proc_address<PFNGLGETPROGRAMBINARYOESPROC>("glGetProgramBinaryOES")},
+      program_binary{proc_address<PFNGLPROGRAMBINARYOESPROC>("glProgramBinaryOES")}
+{
+}
+
+auto mrg::ProgramBinaryCache::default_directory() -> std::string
+{
+    if (auto const cache_home = getenv("XDG_CACHE_HOME"))
+        return std::string{cache_home} + "/mir/gl-programs";
+    if (auto const home = getenv("HOME"))
+        return std::string{home} + "/.cache/mir/gl-programs";
+    return {};
+}
+
+auto mrg::ProgramBinaryCache::key_for(GLchar const* vertex_shader, GLchar const* fragment_shader) const
+    -> std::string
+{
+    if (directory.empty() || !get_program_binary || !program_binary)
+        return {};
+
+    // Each context could be on a different GPU (or driver), so check the current one
+    auto const extensions = gl_string(GL_EXTENSIONS);
+    if (extensions.find("GL_OES_get_program_binary") == std::string::npos)
+        return {};
+
+    GLint formats{0};
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS_OES, &formats);
+    if (formats <= 0)
+        return {};
+
+    std::stringstream key;
+    key << gl_string(GL_VENDOR) << '\n'
+        << gl_string(GL_RENDERER) << '\n'
+        << gl_string(GL_VERSION) << '\n'
+        << vertex_shader << '\0'
+        << fragment_shader;
+    return key.str();
+}
+
+auto mrg::ProgramBinaryCache::path_for(std::string const& key) const -> std::string
+{
+    std::stringstream path;
+    path << directory << '/' << std::hex << std::hash<std::string>{}(key) << ".bin";
+    return path.str();
+}
+
+auto mrg::ProgramBinaryCache::load(GLchar const* vertex_shader, GLchar const* fragment_shader) const -> GLuint
+{
+    auto const key = key_for(vertex_shader, fragment_shader);
+    if (key.empty())
+        return 0;
+
+    auto const path = path_for(key);
+    std::ifstream file{path, std::ios::binary};
+    if (!file)
+        return 0;
+
+    FileHeader header;
+    std::string stored_key;
+    if (file.read(reinterpret_cast<char*>(&header), sizeof header) && header.key_length == key.size())
+    {
+        stored_key.resize(header.key_length);
+        file.read(&stored_key[0], header.key_length);
+    }
+    if (!file || stored_key != key)
+        return 0;
+
+    std::vector<char> const binary{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+    if (binary.empty())
+        return 0;
+
+    auto const program = glCreateProgram();
+    program_binary(program, header.format, binary.data(), static_cast<GLint>(binary.size()));
+
+    GLint ok{GL_FALSE};
+    glGetProgramiv(program, GL_LINK_STATUS, &ok);
+    if (!ok)
+    {
+        // Drivers may reject binaries from an older build with the same version string
+        glDeleteProgram(program);
+        unlink(path.c_str());
+        mir::log_debug("Discarded stale GL program binary %s", path.c_str());
+        return 0;
+    }
+
+    return program;
+}
+
+void mrg::ProgramBinaryCache::store(
+    GLchar const* vertex_shader,
+    GLchar const* fragment_shader,
+    GLuint program) const
+{
+    auto const key = key_for(vertex_shader, fragment_shader);
+    if (key.empty())
+        return;
+
+    GLint length{0};
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH_OES, &length);
+    if (length <= 0)
+        return;
+
+    std::vector<char> binary(length);
+    GLsizei written{0};
+    GLenum format{0};
+    get_program_binary(program, length, &written, &format, binary.data());
+    if (written <= 0)
+        return;
+
+    boost::system::error_code ec;
+    boost::filesystem::create_directories(directory, ec);
+    if (ec)
+    {
+        mir::log_debug("Failed to create GL program cache %s: %s", directory.c_str(), ec.message().c_str());
+        return;
+    }
+
+    // Write to a temporary file and rename it over the entry, so readers never see a partial binary
+    auto const path = path_for(key);
+    std::vector<char> temp_path{path.begin(), path.end()};
+    char const suffix[] = ".XXXXXX";
+    temp_path.insert(temp_path.end(), suffix, suffix + sizeof suffix);
+
+    auto const fd = mkstemp(temp_path.data());
+    if (fd < 0)
+        return;
+    close(fd);
+
+    FileHeader const header{format, static_cast<uint32_t>(key.size())};
+    std::ofstream file{temp_path.data(), std::ios::binary | std::ios::trunc};
+    file.write(reinterpret_cast<char const*>(&header), sizeof header);
+    file.write(key.data(), key.size());
+    file.write(binary.data(), written);
+    file.close();
+
+    if (!file || rename(temp_path.data(), path.c_str()) != 0)
+    {
+        unlink(temp_path.data());
+        mir::log_debug("Failed to write GL program binary %s", path.c_str());
+    }
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_RENDERER_GL_PROGRAM_BINARY_CACHE_H_
+#define MIR_RENDERER_GL_PROGRAM_BINARY_CACHE_H_
+
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+
+#include <string>
+
+namespace mir
+{
+namespace renderer
+{
+namespace gl
+{
+
+/**
+ * Keeps linked GL programs on disk (through GL_OES_get_program_binary), so a
+ * new renderer needn't compile and link its shaders again.
+ *
+ * Binaries are keyed by the GL driver (vendor, renderer and version) and the
+ * shader sources. Without driver support, or without a directory, the cache
+ * holds nothing.
+ */
+class ProgramBinaryCache
+{
+public:
+    /// \param [in] directory   Where to keep binaries; created when first needed
+    explicit ProgramBinaryCache(std::string directory);
+
+    /// $XDG_CACHE_HOME/mir/gl-programs (or under $HOME/.cache), or "" if neither is set
+    static auto default_directory() -> std::string;
+
+    /**
+     * Create a program from the cached binary for these sources.
+     *
+     * \return  The linked program, or 0 if there is no usable binary
+     * \note    Must be called with a current GL context
+     */
+    auto load(GLchar const* vertex_shader, GLchar const* fragment_shader) const -> GLuint;
+
+    /**
+     * Save the binary of a program linked from these sources.
+     *
+     * \note    Must be called with a current GL context
+     */
+    void store(GLchar const* vertex_shader, GLchar const* fragment_shader, GLuint program) const;
+
+private:
+    /// The cache key for the current context's driver, or "" if it can't provide binaries
+    auto key_for(GLchar const* vertex_shader, GLchar const* fragment_shader) const -> std::string;
+    auto path_for(std::string const& key) const -> std::string;
+
+    std::string const directory;
+    PFNGLGETPROGRAMBINARYOESPROC const get_program_binary;
+    PFNGLPROGRAMBINARYOESPROC const program_binary;
+};
+
+}
+}
+}
+
+#endif // MIR_RENDERER_GL_PROGRAM_BINARY_CACHE_H_
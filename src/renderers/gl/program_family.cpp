@@ -17,6 +17,7 @@
  */
 
 #include "program_family.h"
+#include "program_binary_cache.h"
 #include <GLES2/gl2.h>
 #include <GLES2/gl2ext.h>
 #include <mutex>
@@ -53,6 +54,11 @@ void ProgramFamily::Shader::init(GLenum type, const GLchar* src)
     }
 }
 
+ProgramFamily::ProgramFamily(std::shared_ptr<ProgramBinaryCache const> binary_cache)
+    : binary_cache{std::move(binary_cache)}
+{
+}
+
 ProgramFamily::~ProgramFamily() noexcept
 {
     // shader and program lifetimes are managed manually, so that we don't
@@ -89,15 +95,18 @@ GLuint ProgramFamily::add_program(const GLchar* const vshader_src,
     static std::mutex lp1416482_mutex;
     std::lock_guard<decltype(lp1416482_mutex)> lock{lp1416482_mutex};
 
-    auto& v = vshader[vshader_src];
-    if (!v.id) v.init(GL_VERTEX_SHADER, vshader_src);
-
-    auto& f = fshader[fshader_src];
-    if (!f.id) f.init(GL_FRAGMENT_SHADER, fshader_src);
+    auto& p = program[{vshader_src, fshader_src}];
+    if (!p.id && binary_cache)
+        p.id = binary_cache->load(vshader_src, fshader_src);
 
-    auto& p = program[{v.id, f.id}];
     if (!p.id)
     {
+        auto& v = vshader[vshader_src];
+        if (!v.id) v.init(GL_VERTEX_SHADER, vshader_src);
+
+        auto& f = fshader[fshader_src];
+        if (!f.id) f.init(GL_FRAGMENT_SHADER, fshader_src);
+
         p.id = glCreateProgram();
         glAttachShader(p.id, v.id);
         glAttachShader(p.id, f.id);
@@ -113,6 +122,9 @@ GLuint ProgramFamily::add_program(const GLchar* const vshader_src,
             p.id = 0;
             throw std::runtime_error(std::string("Link failed: ")+log);
         }
+
+        if (binary_cache)
+            binary_cache->store(vshader_src, fshader_src, p.id);
     }
 
     return p.id;
@@ -20,6 +20,7 @@
 #define MIR_RENDERER_GL_PROGRAM_FAMILY_H_
 
 #include <GLES2/gl2.h>
+#include <memory>
 #include <utility>
 #include <map>
 #include <unordered_map>
@@ -30,6 +31,7 @@ namespace renderer
 {
 namespace gl
 {
+class ProgramBinaryCache;
 
 /**
  * ProgramFamily represents a set of GLSL programs that are closely
@@ -38,11 +40,14 @@ namespace gl
  *   A secondary intention is that this class may be extended to allow the
  * different programs within the family to share common patterns of uniform
  * usage too.
+ *   Programs found in the (optional) binary cache are loaded from it without
+ * compiling any shaders.
  */
 class ProgramFamily
 {
 public:
     ProgramFamily() = default;
+    explicit ProgramFamily(std::shared_ptr<ProgramBinaryCache const> binary_cache);
     ProgramFamily(ProgramFamily const&) = delete;
     ProgramFamily& operator=(ProgramFamily const&) = delete;
     ~ProgramFamily() noexcept;
@@ -59,12 +64,14 @@ private:
     typedef std::unordered_map<const GLchar*, Shader> ShaderMap;
     ShaderMap vshader, fshader;
 
-    typedef std::pair<GLuint, GLuint> ShaderPair;
+    typedef std::pair<const GLchar*, const GLchar*> SourcePair;
     struct Program
     {
         GLuint id = 0;
     };
-    std::map<ShaderPair, Program> program;
+    std::map<SourcePair, Program> program;
+
+    std::shared_ptr<ProgramBinaryCache const> const binary_cache;
 };
 
 }
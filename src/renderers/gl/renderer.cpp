@@ -19,6 +19,7 @@
 #define MIR_LOG_COMPONENT "GLRenderer"
 
 #include "renderer.h"
+#include "program_binary_cache.h"
 #include "mir/compositor/buffer_stream.h"
 #include "mir/gl/default_program_factory.h"
 #include "mir/graphics/renderable.h"
@@ -30,9 +31,14 @@
 #include "mir/log.h"
 #include "mir/report_exception.h"
 #include "mir/graphics/egl_error.h"
+#include "mir/graphics/egl_extensions.h"
 #include "mir/graphics/texture.h"
 #include "mir/graphics/program_factory.h"
 #include "mir/graphics/program.h"
+#include "mir/graphics/solid_color_buffer.h"
+#include "renderer_gl.tp.h"
+
+#include <GLES2/gl2ext.h>
 
 #define GLM_FORCE_RADIANS
 #include <glm/gtc/matrix_transform.hpp>
@@ -40,8 +46,12 @@
 #include <EGL/egl.h>
 
 #include <boost/throw_exception.hpp>
+#include <algorithm>
+#include <chrono>
 #include <stdexcept>
 #include <cmath>
+#include <cstddef>
+#include <cstring>
 #include <sstream>
 
 namespace mg = mir::graphics;
@@ -49,6 +59,24 @@ namespace mgl = mir::gl;
 namespace mrg = mir::renderer::gl;
 namespace geom = mir::geometry;
 
+namespace
+{
+/// Enough to cover triple buffering with some slack
+size_t const max_damage_history = 4;
+
+void set_scissor(geom::Rectangle const& gl_rect)
+{
+    glScissor(
+        gl_rect.left().as_int(),
+        gl_rect.top().as_int(),
+        gl_rect.size.width.as_int(),
+        gl_rect.size.height.as_int());
+}
+
+/// Beyond this many separate areas a single clear of everything is cheaper than clearing each
+size_t const max_partial_clears = 4;
+}
+
 mrg::CurrentRenderTarget::CurrentRenderTarget(mg::DisplayBuffer* display_buffer)
     : render_target{
         dynamic_cast<renderer::gl::RenderTarget*>(display_buffer->native_display_buffer())}
@@ -80,6 +108,11 @@ void mrg::CurrentRenderTarget::swap_buffers()
     render_target->swap_buffers();
 }
 
+void mrg::CurrentRenderTarget::swap_buffers_with_damage(geom::Rectangles const& damage)
+{
+    render_target->swap_buffers_with_damage(damage);
+}
+
 const GLchar* const mrg::Renderer::vshader =
 {
     "attribute vec3 position;\n"
@@ -123,6 +156,18 @@ const GLchar* const mrg::Renderer::default_fshader =
     "}\n"
 };
 
+const GLchar* const mrg::Renderer::solid_fshader =
+{
+    "#ifdef GL_ES\n"
+    "precision mediump float;\n"
+    "#endif\n"
+    "uniform vec4 color;\n"
+    "uniform float alpha;\n"
+    "void main() {\n"
+    "   gl_FragColor = alpha*color;\n"
+    "}\n"
+};
+
 namespace
 {
 template<void (* deleter)(GLuint)>
@@ -198,9 +243,8 @@ const GLchar* const vertex_shader_src =
 class mrg::Renderer::ProgramFactory : public mir::graphics::gl::ProgramFactory
 {
 public:
-    // NOTE: This must be called with a current GL context
-    ProgramFactory()
-        : vertex_shader{compile_shader(GL_VERTEX_SHADER, vertex_shader_src)}
+    explicit ProgramFactory(std::shared_ptr<ProgramBinaryCache const> binary_cache)
+        : binary_cache{std::move(binary_cache)}
     {
     }
 
@@ -260,19 +304,14 @@ public:
         // GL shader compilation is *not* threadsafe, and requires external synchronisation
         std::lock_guard<std::mutex> lock{compilation_mutex};
 
-        ShaderHandle const opaque_shader{
-            compile_shader(GL_FRAGMENT_SHADER, opaque_fragment.str().c_str())};
-        ShaderHandle const alpha_shader{
-            compile_shader(GL_FRAGMENT_SHADER, alpha_fragment.str().c_str())};
+        auto opaque_program = load_or_link(opaque_fragment.str());
+        auto alpha_program = load_or_link(alpha_fragment.str());
 
         programs.emplace_back(id, std::make_unique<::Program>(
-            link_shader(vertex_shader, opaque_shader),
-            link_shader(vertex_shader, alpha_shader)));
+            std::move(opaque_program),
+            std::move(alpha_program)));
 
         return *programs.back().second;
-
-        // We delete opaque_shader and alpha_shader here. This is fine; it only marks them
-        // for deletion. GL will only delete them once the GL Program they're linked in is destroyed.
     }
 
 private:
@@ -323,12 +362,157 @@ private:
         return program;
     }
 
-    ShaderHandle const vertex_shader;
+    auto load_or_link(std::string const& fragment_shader_src) -> ProgramHandle
+    {
+        if (binary_cache)
+        {
+            if (auto const cached = binary_cache->load(vertex_shader_src, fragment_shader_src.c_str()))
+                return ProgramHandle{cached};
+        }
+
+        // The vertex shader is only needed for programs we have to link ourselves
+        if (!vertex_shader)
+            vertex_shader = std::make_unique<ShaderHandle>(compile_shader(GL_VERTEX_SHADER, vertex_shader_src));
+
+        // We delete fragment_shader on return. This is fine; it only marks it for deletion.
+        // GL will only delete it once the GL Program it's linked in is destroyed.
+        ShaderHandle const fragment_shader{compile_shader(GL_FRAGMENT_SHADER, fragment_shader_src.c_str())};
+        auto program = link_shader(*vertex_shader, fragment_shader);
+
+        if (binary_cache)
+            binary_cache->store(vertex_shader_src, fragment_shader_src.c_str(), program);
+
+        return program;
+    }
+
+    std::shared_ptr<ProgramBinaryCache const> const binary_cache;
+    std::unique_ptr<ShaderHandle> vertex_shader;
     std::vector<std::pair<void const*, std::unique_ptr<::Program>>> programs;
     // GL requires us to synchronise multi-threaded access to the shader APIs.
     std::mutex compilation_mutex;
 };
 
+class mrg::Renderer::GPUTimer
+{
+public:
+    // NOTE: This must be called with a current GL context
+    GPUTimer()
+        : gen_queries{proc_address<PFNGLGENQUERIESEXTPROC>("glGenQueriesEXT")},
+          delete_queries{proc_address<PFNGLDELETEQUERIESEXTPROC>("glDeleteQueriesEXT")},
+          begin_query{proc_address<PFNGLBEGINQUERYEXTPROC>("glBeginQueryEXT")},
+          end_query{proc_address<PFNGLENDQUERYEXTPROC>("glEndQueryEXT")},
+          get_query_uiv{proc_address<PFNGLGETQUERYOBJECTUIVEXTPROC>("glGetQueryObjectuivEXT")},
+          get_query_ui64v{proc_address<PFNGLGETQUERYOBJECTUI64VEXTPROC>("glGetQueryObjectui64vEXT")}
+    {
+        auto const extensions = reinterpret_cast<char const*>(glGetString(GL_EXTENSIONS));
+        supported = extensions && strstr(extensions, "GL_EXT_disjoint_timer_query") &&
+            gen_queries && delete_queries && begin_query && end_query && get_query_uiv && get_query_ui64v;
+    }
+
+    // NOTE: This must be called with a current GL context
+    ~GPUTimer()
+    {
+        if (supported)
+        {
+            free_queries.insert(free_queries.end(), pending_queries.begin(), pending_queries.end());
+            delete_queries(static_cast<GLsizei>(free_queries.size()), free_queries.data());
+        }
+    }
+
+    GPUTimer(GPUTimer const&) = delete;
+    GPUTimer& operator=(GPUTimer const&) = delete;
+
+    auto is_supported() const -> bool
+    {
+        return supported;
+    }
+
+    void begin_frame()
+    {
+        collect_results();
+
+        // If the GPU is that far behind we'll hear about it from the frames already being timed
+        if (pending_queries.size() >= max_pending_queries)
+            return;
+
+        if (free_queries.empty())
+        {
+            GLuint query{0};
+            gen_queries(1, &query);
+            free_queries.push_back(query);
+        }
+
+        active_query = free_queries.back();
+        free_queries.pop_back();
+        begin_query(GL_TIME_ELAPSED_EXT, active_query);
+    }
+
+    void end_frame()
+    {
+        if (!active_query)
+            return;
+
+        end_query(GL_TIME_ELAPSED_EXT);
+        pending_queries.push_back(active_query);
+        active_query = 0;
+    }
+
+    auto take_result() -> std::experimental::optional<std::chrono::nanoseconds>
+    {
+        auto const result = latest_result;
+        latest_result = std::experimental::nullopt;
+        return result;
+    }
+
+private:
+    template<typename Proc>
+    static auto proc_address(char const* name) -> Proc
+    {
+        return reinterpret_cast<Proc>(eglGetProcAddress(name));
+    }
+
+    void collect_results()
+    {
+        // Something like a GPU reset or clock change makes the results in flight meaningless
+        GLint disjoint{0};
+        glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+
+        // Queries complete in order, so stop at the first that hasn't
+        while (!pending_queries.empty())
+        {
+            auto const query = pending_queries.front();
+
+            GLuint available{0};
+            get_query_uiv(query, GL_QUERY_RESULT_AVAILABLE_EXT, &available);
+            if (!available)
+                break;
+
+            GLuint64 elapsed{0};
+            get_query_ui64v(query, GL_QUERY_RESULT_EXT, &elapsed);
+            if (!disjoint)
+                latest_result = std::chrono::nanoseconds{elapsed};
+
+            pending_queries.pop_front();
+            free_queries.push_back(query);
+        }
+    }
+
+    static size_t const max_pending_queries{4};
+
+    PFNGLGENQUERIESEXTPROC const gen_queries;
+    PFNGLDELETEQUERIESEXTPROC const delete_queries;
+    PFNGLBEGINQUERYEXTPROC const begin_query;
+    PFNGLENDQUERYEXTPROC const end_query;
+    PFNGLGETQUERYOBJECTUIVEXTPROC const get_query_uiv;
+    PFNGLGETQUERYOBJECTUI64VEXTPROC const get_query_ui64v;
+    bool supported{false};
+
+    GLuint active_query{0};
+    std::deque<GLuint> pending_queries;
+    std::vector<GLuint> free_queries;
+    std::experimental::optional<std::chrono::nanoseconds> latest_result;
+};
+
 mrg::Renderer::Program::Program(GLuint program_id)
 {
     id = program_id;
@@ -347,14 +531,20 @@ mrg::Renderer::Program::Program(GLuint program_id)
     transform_uniform = glGetUniformLocation(id, "transform");
     screen_to_gl_coords_uniform = glGetUniformLocation(id, "screen_to_gl_coords");
     alpha_uniform = glGetUniformLocation(id, "alpha");
+    color_uniform = glGetUniformLocation(id, "color");
 }
 
-mrg::Renderer::Renderer(graphics::DisplayBuffer& display_buffer)
+mrg::Renderer::Renderer(
+    graphics::DisplayBuffer& display_buffer,
+    bool opaque_front_to_back,
+    std::shared_ptr<ProgramBinaryCache const> const& binary_cache)
     : render_target(&display_buffer),
       clear_color{0.0f, 0.0f, 0.0f, 0.0f},
+      family{binary_cache},
       default_program(family.add_program(vshader, default_fshader)),
       alpha_program(family.add_program(vshader, alpha_fshader)),
-      program_factory{std::make_unique<ProgramFactory>()},
+      solid_program(family.add_program(vshader, solid_fshader)),
+      program_factory{std::make_unique<ProgramFactory>(binary_cache)},
       texture_cache(mgl::DefaultProgramFactory().create_texture_cache()),
       display_transform(1)
 {
@@ -374,6 +564,9 @@ mrg::Renderer::Renderer(graphics::DisplayBuffer& display_buffer)
             auto val = eglQueryString(disp, s.id);
             mir::log_info(std::string(s.label) + ": " + (val ? val : ""));
         }
+
+        auto const extensions = eglQueryString(disp, EGL_EXTENSIONS);
+        buffer_age_supported = extensions && strstr(extensions, "EGL_EXT_buffer_age");
     }
 
     struct {GLenum id; char const* label;} const glstrings[] =
@@ -405,14 +598,31 @@ mrg::Renderer::Renderer(graphics::DisplayBuffer& display_buffer)
     mir::log_info("GL framebuffer bits: RGBA=%d%d%d%d, depth=%d, stencil=%d",
                   rbits, gbits, bbits, abits, dbits, sbits);
 
+    if (opaque_front_to_back)
+    {
+        depth_sorting = dbits > 0;
+        if (!depth_sorting)
+            mir::log_info("No depth buffer: drawing opaque surfaces back to front");
+    }
+
+    glGenBuffers(1, &vertex_buffer);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 
+    auto timer = std::make_unique<GPUTimer>();
+    if (timer->is_supported())
+    {
+        mir::log_info("Measuring GPU render time with GL_EXT_disjoint_timer_query");
+        gpu_timer = std::move(timer);
+    }
+
     set_viewport(display_buffer.view_area());
 }
 
 mrg::Renderer::~Renderer()
 {
     render_target.ensure_current();
+    if (vertex_buffer)
+        glDeleteBuffers(1, &vertex_buffer);
 }
 
 void mrg::Renderer::tessellate(std::vector<mgl::Primitive>& primitives,
@@ -422,21 +632,89 @@ void mrg::Renderer::tessellate(std::vector<mgl::Primitive>& primitives,
     primitives[0] = mgl::tessellate_renderable_into_rectangle(renderable, geom::Displacement{0,0});
 }
 
+bool mrg::Renderer::tessellation_depends_only_on_position() const
+{
+    return true;
+}
+
 void mrg::Renderer::render(mg::RenderableList const& renderables) const
 {
     render_target.bind();
 
-    glClearColor(clear_color[0], clear_color[1], clear_color[2], clear_color[3]);
-    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
-    glClear(GL_COLOR_BUFFER_BIT);
+    if (gpu_timer)
+        gpu_timer->begin_frame();
+
+    // Damage relative to the framebuffer (with the origin top-left)
+    std::experimental::optional<geom::Rectangles> frame_damage;
+    if (damage && damage_maps_to_pixels)
+    {
+        frame_damage = geom::Rectangles{};
+        for (auto const& rect : damage.value())
+            frame_damage.value().add({rect.top_left - as_displacement(viewport.top_left), rect.size});
+    }
+
+    frame_scissor = frame_damage ? repaint_area(frame_damage.value()) : std::experimental::nullopt;
+    if (frame_scissor)
+    {
+        glEnable(GL_SCISSOR_TEST);
+        set_scissor(frame_scissor.value());
+    }
+
+    find_opaque_areas(renderables);
+
+    if (!depth_sorting)
+        clear_uncovered();
 
     ++frameno;
-    for (auto const& r : renderables)
+    buffer_vertices(renderables);
+
+    draw_state = DrawState{};
+    if (depth_sorting)
+    {
+        draw_front_to_back(renderables);
+    }
+    else
+    {
+        for (auto i = 0u; i != renderables.size(); ++i)
+        {
+            draw_renderable(renderables, i);
+        }
+    }
+    if (auto const prog = draw_state.program)
+    {
+        glDisableVertexAttribArray(prog->texcoord_attr);
+        glDisableVertexAttribArray(prog->position_attr);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    if (frame_scissor)
+    {
+        glDisable(GL_SCISSOR_TEST);
+        frame_scissor = std::experimental::nullopt;
+    }
+
+    if (gpu_timer)
+        gpu_timer->end_frame();
+
+    // Read back whatever's captured before the frame is swapped away
+    for (auto const& read : frame_reads)
+        read_back(read.first, read.second);
+    frame_reads.clear();
+
+    if (frame_damage)
+    {
+        render_target.swap_buffers_with_damage(frame_damage.value());
+        damage_history.push_front(frame_damage.value());
+    }
+    else
     {
-        draw(*r);
+        render_target.swap_buffers();
+        damage_history.push_front(geom::Rectangles{{{0, 0}, viewport.size}});
     }
 
-    render_target.swap_buffers();
+    if (damage_history.size() > max_damage_history)
+        damage_history.pop_back();
+    damage = std::experimental::nullopt;
 
     // Deleting unused textures only requires the GL context. This clean-up
     // does not affect screen contents so can happen after swap_buffers...
@@ -446,27 +724,318 @@ void mrg::Renderer::render(mg::RenderableList const& renderables) const
         mir::log_debug("GL error: %d", gl_error);
 }
 
-void mrg::Renderer::draw(mg::Renderable const& renderable) const
+void mrg::Renderer::find_opaque_areas(mg::RenderableList const& renderables) const
+{
+    opaque_renderables.assign(renderables.size(), false);
+    shaped_renderables.assign(renderables.size(), false);
+    opaque_area = geom::Region{};
+    for (auto i = 0u; i != renderables.size(); ++i)
+    {
+        auto const& renderable = *renderables[i];
+        auto const shaped = renderable.shaped();
+        shaped_renderables[i] = shaped;
+
+        // Transformed renderables needn't stay within their screen_position()
+        if (renderable.alpha() < 1.0f || renderable.transformation() != glm::mat4(1))
+            continue;
+
+        auto visible = renderable.screen_position();
+        if (auto const clip_area = renderable.clip_area())
+            visible = intersection_of(visible, clip_area.value());
+
+        if (!shaped)
+        {
+            opaque_renderables[i] = true;
+            opaque_area |= visible;
+            continue;
+        }
+
+        auto const opaque = geom::Region{renderable.opaque_region()} & visible;
+        opaque_renderables[i] = opaque.contains(visible);
+        opaque_area |= opaque;
+    }
+}
+
+void mrg::Renderer::clear_uncovered() const
+{
+    glClearColor(clear_color[0], clear_color[1], clear_color[2], clear_color[3]);
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+    // Letterbox bars and transformed outputs don't map simply onto the viewport, so clear everything
+    if (!viewport_fills_framebuffer || !damage_maps_to_pixels)
+    {
+        glClear(GL_COLOR_BUFFER_BIT);
+        return;
+    }
+
+    auto const parts = (geom::Region{viewport} - opaque_area).rectangles();
+    if (parts.size() > max_partial_clears)
+    {
+        glClear(GL_COLOR_BUFFER_BIT);
+        return;
+    }
+
+    // Opaque content will paint over the rest, so only clear what shows through
+    if (parts.empty())
+        return;
+
+    if (!frame_scissor)
+        glEnable(GL_SCISSOR_TEST);
+    for (auto const& part : parts)
+    {
+        geom::Rectangle gl_part{
+            {part.left().as_int() - viewport.left().as_int(),
+             framebuffer_height - (part.bottom().as_int() - viewport.top().as_int())},
+            part.size};
+        if (frame_scissor)
+            gl_part = intersection_of(gl_part, frame_scissor.value());
+        if (gl_part.size.width.as_int() <= 0 || gl_part.size.height.as_int() <= 0)
+            continue;
+
+        set_scissor(gl_part);
+        glClear(GL_COLOR_BUFFER_BIT);
+    }
+    if (frame_scissor)
+        set_scissor(frame_scissor.value());
+    else
+        glDisable(GL_SCISSOR_TEST);
+}
+
+void mrg::Renderer::draw_renderable(mg::RenderableList const& renderables, size_t i) const
+{
+    known_shaped = shaped_renderables[i];
+    draw(*renderables[i], buffered_primitives[i]);
+    known_shaped = std::experimental::nullopt;
+}
+
+void mrg::Renderer::draw_front_to_back(mg::RenderableList const& renderables) const
+{
+    // Nothing shows through opaque content, so the colour clear is only needed if some of the viewport isn't
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    GLbitfield clear_mask{GL_DEPTH_BUFFER_BIT};
+    if (!viewport_fills_framebuffer || !opaque_area.contains(viewport))
+    {
+        glClearColor(clear_color[0], clear_color[1], clear_color[2], clear_color[3]);
+        clear_mask |= GL_COLOR_BUFFER_BIT;
+    }
+    glDepthMask(GL_TRUE);
+    glClearDepthf(1.0f);
+    glClear(clear_mask);
+
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LEQUAL);
+
+    // Each renderable is drawn at a depth of its own, nearer the higher it is stacked
+    auto const draw_at_depth =
+        [this, &renderables](size_t i)
+        {
+            GLclampf const depth = static_cast<GLclampf>(renderables.size() - i) / (renderables.size() + 1);
+            glDepthRangef(depth, depth);
+            draw_renderable(renderables, i);
+        };
+
+    // Opaque renderables from the top down, so the depth test skips the fragments they hide...
+    for (auto i = renderables.size(); i-- != 0;)
+    {
+        if (opaque_renderables[i])
+            draw_at_depth(i);
+    }
+
+    // ...then the rest from the bottom up, blended over whatever isn't hidden
+    glDepthMask(GL_FALSE);
+    for (auto i = 0u; i != renderables.size(); ++i)
+    {
+        if (!opaque_renderables[i])
+            draw_at_depth(i);
+    }
+
+    glDepthMask(GL_TRUE);
+    glDepthRangef(0.0f, 1.0f);
+    glDisable(GL_DEPTH_TEST);
+}
+
+void mrg::Renderer::buffer_vertices(mg::RenderableList const& renderables) const
+{
+    if (buffered_primitives.size() < renderables.size())
+        buffered_primitives.resize(renderables.size());
+
+    auto const reuse_tessellation = tessellation_depends_only_on_position();
+    auto changed = !reuse_tessellation || buffered_ids.size() != renderables.size();
+
+    frame_geometry.clear();
+    for (auto i = 0u; i != renderables.size(); ++i)
+    {
+        auto const& renderable = *renderables[i];
+        auto const id = renderable.id();
+        auto const position = renderable.screen_position();
+        auto const src_bounds = renderable.src_bounds();
+        auto const buffer_size = renderable.buffer()->size();
+        auto& cached = geometry_cache[id];
+
+        if (!reuse_tessellation || cached.last_used_frameno == 0 || cached.position != position ||
+            cached.src_bounds != src_bounds || cached.buffer_size != buffer_size)
+        {
+            primitives.clear();
+            tessellate(primitives, renderable);
+
+            cached.position = position;
+            cached.src_bounds = src_bounds;
+            cached.buffer_size = buffer_size;
+            cached.vertices.clear();
+            cached.primitives.clear();
+            for (auto const& p : primitives)
+            {
+                cached.primitives.push_back({p.type, static_cast<GLint>(cached.vertices.size()), p.nvertices});
+                cached.vertices.insert(cached.vertices.end(), p.vertices, p.vertices + p.nvertices);
+            }
+            changed = true;
+        }
+        cached.last_used_frameno = frameno;
+        frame_geometry.push_back(&cached);
+
+        if (!changed && buffered_ids[i] != id)
+            changed = true;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+
+    // Nothing has moved, so vertex_buffer and buffered_primitives still describe this frame
+    if (!changed)
+        return;
+
+    frame_vertices.clear();
+    buffered_ids.clear();
+    for (auto i = 0u; i != renderables.size(); ++i)
+    {
+        auto const& cached = *frame_geometry[i];
+        auto const first = static_cast<GLint>(frame_vertices.size());
+
+        auto& buffered = buffered_primitives[i];
+        buffered.clear();
+        for (auto const& p : cached.primitives)
+            buffered.push_back({p.type, first + p.first, p.count});
+
+        frame_vertices.insert(frame_vertices.end(), cached.vertices.begin(), cached.vertices.end());
+        buffered_ids.push_back(renderables[i]->id());
+    }
+
+    // Every vertex of the frame goes to the GPU in one upload, rather than one per draw call
+    glBufferData(
+        GL_ARRAY_BUFFER,
+        frame_vertices.size() * sizeof(mgl::Vertex),
+        frame_vertices.data(),
+        GL_STREAM_DRAW);
+
+    // Forget renderables that have left the scene
+    for (auto i = geometry_cache.begin(); i != geometry_cache.end();)
+    {
+        if (i->second.last_used_frameno == frameno)
+            ++i;
+        else
+            i = geometry_cache.erase(i);
+    }
+}
+
+void mrg::Renderer::use_program(Program const& prog) const
+{
+    if (draw_state.program == &prog)
+        return;
+
+    if (auto const previous = draw_state.program)
+    {
+        if (previous->texcoord_attr >= 0)
+            glDisableVertexAttribArray(previous->texcoord_attr);
+        glDisableVertexAttribArray(previous->position_attr);
+    }
+
+    glUseProgram(prog.id);
+    draw_state.program = &prog;
+
+    if (prog.last_used_frameno != frameno)
+    {   // Avoid reloading the screen-global uniforms on every renderable
+        // TODO: We actually only need to bind these *once*, right? Not once per frame?
+        prog.last_used_frameno = frameno;
+        for (auto i = 0u; i < prog.tex_uniforms.size(); ++i)
+        {
+            if (prog.tex_uniforms[i] != -1)
+            {
+                glUniform1i(prog.tex_uniforms[i], i);
+            }
+        }
+        glUniformMatrix4fv(prog.display_transform_uniform, 1, GL_FALSE,
+                           glm::value_ptr(display_transform));
+        glUniformMatrix4fv(prog.screen_to_gl_coords_uniform, 1, GL_FALSE,
+                           glm::value_ptr(screen_to_gl_coords));
+    }
+
+    // The whole frame's vertices are in vertex_buffer, so these hold until the program changes
+    glEnableVertexAttribArray(prog.position_attr);
+    glVertexAttribPointer(prog.position_attr, 3, GL_FLOAT,
+                          GL_FALSE, sizeof(mgl::Vertex),
+                          reinterpret_cast<void const*>(offsetof(mgl::Vertex, position)));
+    // A program that samples no texture (like solid_program) may have had texcoord optimised away
+    if (prog.texcoord_attr >= 0)
+    {
+        glEnableVertexAttribArray(prog.texcoord_attr);
+        glVertexAttribPointer(prog.texcoord_attr, 2, GL_FLOAT,
+                              GL_FALSE, sizeof(mgl::Vertex),
+                              reinterpret_cast<void const*>(offsetof(mgl::Vertex, texcoord)));
+    }
+}
+
+void mrg::Renderer::set_blend(BlendSeparate const& blend) const
+{
+    if (blend.dst_rgb == GL_ZERO)
+    {
+        if (!draw_state.blend || draw_state.blend.value())
+            glDisable(GL_BLEND);
+        draw_state.blend = false;
+        return;
+    }
+
+    if (!draw_state.blend || !draw_state.blend.value())
+        glEnable(GL_BLEND);
+    draw_state.blend = true;
+
+    auto const& current = draw_state.blend_func;
+    if (!current ||
+        current.value().src_rgb != blend.src_rgb || current.value().dst_rgb != blend.dst_rgb ||
+        current.value().src_alpha != blend.src_alpha || current.value().dst_alpha != blend.dst_alpha)
+    {
+        glBlendFuncSeparate(blend.src_rgb,   blend.dst_rgb,
+                            blend.src_alpha, blend.dst_alpha);
+        draw_state.blend_func = blend;
+    }
+}
+
+void mrg::Renderer::draw(mg::Renderable const& renderable, std::vector<BufferedPrimitive> const& primitives) const
 {
     auto const clip_area = renderable.clip_area();
     if (clip_area)
     {
-        glEnable(GL_SCISSOR_TEST);
-        glScissor(
-            clip_area.value().top_left.x.as_int() -
+        geom::Rectangle clip_scissor{
+            {clip_area.value().top_left.x.as_int() -
                 viewport.top_left.x.as_int(),
             viewport.top_left.y.as_int() +
                 viewport.size.height.as_int() -
                 clip_area.value().top_left.y.as_int() -
-                clip_area.value().size.height.as_int(),
-            clip_area.value().size.width.as_int(), 
-            clip_area.value().size.height.as_int()
-        );
+                clip_area.value().size.height.as_int()},
+            clip_area.value().size};
+
+        if (frame_scissor)
+            clip_scissor = intersection_of(clip_scissor, frame_scissor.value());
+
+        glEnable(GL_SCISSOR_TEST);
+        set_scissor(clip_scissor);
     }
 
-    auto const texture = std::dynamic_pointer_cast<mg::gl::Texture>(renderable.buffer());
+    // A solid color needs no texture: it's drawn straight from a uniform
+    auto const buffer = renderable.buffer();
+    auto const solid = dynamic_cast<mg::SolidColorBuffer const*>(buffer->native_buffer_base());
+
+    auto const texture = std::dynamic_pointer_cast<mg::gl::Texture>(buffer);
     auto const surface_tex =
-        [this, &renderable, need_fallback = !static_cast<bool>(texture)]() -> std::shared_ptr<mir::gl::Texture>
+        [this, &renderable, need_fallback = !texture && !solid]() -> std::shared_ptr<mir::gl::Texture>
         {
             if (need_fallback)
             {
@@ -483,9 +1052,13 @@ void mrg::Renderer::draw(mg::Renderable const& renderable) const
         }();
 
     auto const* maybe_prog =
-        [this, &texture, &surface_tex](bool alpha) -> Program const*
+        [this, solid, &texture, &surface_tex](bool alpha) -> Program const*
         {
-            if (texture)
+            if (solid)
+            {
+                return &solid_program;
+            }
+            else if (texture)
             {
                 auto const& family = static_cast<::Program const&>(texture->shader(*program_factory));
                 if (alpha)
@@ -512,33 +1085,19 @@ void mrg::Renderer::draw(mg::Renderable const& renderable) const
     }
 
     auto const& prog = *maybe_prog;
-
-    glUseProgram(prog.id);
-    if (prog.last_used_frameno != frameno)
-    {   // Avoid reloading the screen-global uniforms on every renderable
-        // TODO: We actually only need to bind these *once*, right? Not once per frame?
-        prog.last_used_frameno = frameno;
-        for (auto i = 0u; i < prog.tex_uniforms.size(); ++i)
-        {
-            if (prog.tex_uniforms[i] != -1)
-            {
-                glUniform1i(prog.tex_uniforms[i], i);
-            }
-        }
-        glUniformMatrix4fv(prog.display_transform_uniform, 1, GL_FALSE,
-                           glm::value_ptr(display_transform));
-        glUniformMatrix4fv(prog.screen_to_gl_coords_uniform, 1, GL_FALSE,
-                           glm::value_ptr(screen_to_gl_coords));
-    }
+    use_program(prog);
 
     glActiveTexture(GL_TEXTURE0);
 
     auto const& rect = renderable.screen_position();
-    GLfloat centrex = rect.top_left.x.as_int() +
-                      rect.size.width.as_int() / 2.0f;
-    GLfloat centrey = rect.top_left.y.as_int() +
-                      rect.size.height.as_int() / 2.0f;
-    glUniform2f(prog.centre_uniform, centrex, centrey);
+    glm::vec2 const centre{
+        rect.top_left.x.as_int() + rect.size.width.as_int() / 2.0f,
+        rect.top_left.y.as_int() + rect.size.height.as_int() / 2.0f};
+    if (prog.loaded_centre != centre)
+    {
+        glUniform2f(prog.centre_uniform, centre.x, centre.y);
+        prog.loaded_centre = centre;
+    }
 
     glm::mat4 transform = renderable.transformation();
     if (texture && (texture->layout() == mg::gl::Texture::Layout::TopRowFirst))
@@ -553,30 +1112,32 @@ void mrg::Renderer::draw(mg::Renderable const& renderable) const
         };
     }
 
-    glUniformMatrix4fv(prog.transform_uniform, 1, GL_FALSE,
-                       glm::value_ptr(transform));
+    if (prog.loaded_transform != transform)
+    {
+        glUniformMatrix4fv(prog.transform_uniform, 1, GL_FALSE,
+                           glm::value_ptr(transform));
+        prog.loaded_transform = transform;
+    }
 
-    if (prog.alpha_uniform >= 0)
+    if (prog.alpha_uniform >= 0 && prog.loaded_alpha != renderable.alpha())
+    {
         glUniform1f(prog.alpha_uniform, renderable.alpha());
+        prog.loaded_alpha = renderable.alpha();
+    }
 
-    glEnableVertexAttribArray(prog.position_attr);
-    glEnableVertexAttribArray(prog.texcoord_attr);
-
-    primitives.clear();
-    tessellate(primitives, renderable);
+    if (solid)
+    {
+        auto const color = solid->color();
+        glUniform4f(prog.color_uniform, color[0], color[1], color[2], color[3]);
+    }
 
     // if we fail to load the texture, we need to carry on (part of lp:1629275)
     try
     {
-        typedef struct  // Represents parameters of glBlendFuncSeparate()
-        {
-            GLenum src_rgb, dst_rgb, src_alpha, dst_alpha;
-        } BlendSeparate;
-
         BlendSeparate client_blend;
 
         // These renderable method names could be better (see LP: #1236224)
-        if (renderable.shaped())  // Client is RGBA:
+        if (known_shaped ? known_shaped.value() : renderable.shaped())  // Client is RGBA:
         {
             client_blend = {GL_ONE, GL_ONE_MINUS_SRC_ALPHA,
                             GL_ONE, GL_ONE_MINUS_SRC_ALPHA};
@@ -595,39 +1156,30 @@ void mrg::Renderer::draw(mg::Renderable const& renderable) const
             glBlendColor(0.0f, 0.0f, 0.0f, renderable.alpha());
         }
 
+        // Binding a buffer's texture for the first time is what uploads its pixels or imports its EGLImage
+        bool const trace_bind = (surface_tex || texture) && tracepoint_enabled(mir_renderer_gl, texture_bound);
+        auto const bind_started = trace_bind ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+
         for (auto const& p : primitives)
         {
-            BlendSeparate blend;
-
-            blend = client_blend;
             if (surface_tex)
             {
                 surface_tex->bind();
             }
-            else
+            else if (texture)
             {
                 texture->bind();
             }
 
-            glVertexAttribPointer(prog.position_attr, 3, GL_FLOAT,
-                                  GL_FALSE, sizeof(mgl::Vertex),
-                                  &p.vertices[0].position);
-            glVertexAttribPointer(prog.texcoord_attr, 2, GL_FLOAT,
-                                  GL_FALSE, sizeof(mgl::Vertex),
-                                  &p.vertices[0].texcoord);
-
-            if (blend.dst_rgb == GL_ZERO)
+            if (trace_bind && &p == &primitives.front())
             {
-                glDisable(GL_BLEND);
-            }
-            else
-            {
-                glEnable(GL_BLEND);
-                glBlendFuncSeparate(blend.src_rgb,   blend.dst_rgb,
-                                    blend.src_alpha, blend.dst_alpha);
+                std::chrono::nanoseconds const duration{std::chrono::steady_clock::now() - bind_started};
+                do_tracepoint(mir_renderer_gl, texture_bound, buffer->id().as_value(), duration.count());
             }
 
-            glDrawArrays(p.type, 0, p.nvertices);
+            set_blend(client_blend);
+
+            glDrawArrays(p.type, p.first, p.count);
 
             if (texture)
             {
@@ -641,11 +1193,13 @@ void mrg::Renderer::draw(mg::Renderable const& renderable) const
         report_exception();
     }
 
-    glDisableVertexAttribArray(prog.texcoord_attr);
-    glDisableVertexAttribArray(prog.position_attr);
-    if (renderable.clip_area())
+    if (clip_area)
     {
-        glDisable(GL_SCISSOR_TEST);
+        // Restore the scissor limiting the whole frame
+        if (frame_scissor)
+            set_scissor(frame_scissor.value());
+        else
+            glDisable(GL_SCISSOR_TEST);
     }
 }
 
@@ -725,7 +1279,61 @@ void mrg::Renderer::update_gl_viewport()
         GLint offset_y = (buf_height - reduced_height) / 2;
 
         glViewport(offset_x, offset_y, reduced_width, reduced_height);
+
+        framebuffer_height = buf_height;
+        viewport_fills_framebuffer = reduced_width == buf_width && reduced_height == buf_height;
+        damage_maps_to_pixels =
+            display_transform == glm::mat4(1) &&
+            buf_width == viewport.size.width.as_int() &&
+            buf_height == viewport.size.height.as_int();
+    }
+    else
+    {
+        damage_maps_to_pixels = false;
+        viewport_fills_framebuffer = false;
+    }
+
+    // The old damage no longer describes what is in the framebuffers
+    damage_history.clear();
+}
+
+void mrg::Renderer::set_damage(geom::Rectangles const& damage)
+{
+    this->damage = damage;
+}
+
+auto mrg::Renderer::buffer_age() const -> int
+{
+    if (!buffer_age_supported)
+        return 0;
+
+    EGLint age = 0;
+    if (!eglQuerySurface(eglGetCurrentDisplay(), eglGetCurrentSurface(EGL_DRAW), EGL_BUFFER_AGE_EXT, &age))
+        return 0;
+
+    return age;
+}
+
+auto mrg::Renderer::repaint_area(geom::Rectangles const& frame_damage) const
+    -> std::experimental::optional<geom::Rectangle>
+{
+    // An age of N means the back buffer holds the frame from N frames ago,
+    // so we need to repaint what has changed in the N-1 frames since.
+    auto const age = buffer_age();
+    if (age <= 0 || static_cast<size_t>(age - 1) > damage_history.size())
+        return std::experimental::nullopt;
+
+    geom::Rectangles repaint{frame_damage};
+    for (auto frame = damage_history.begin(); frame != damage_history.begin() + (age - 1); ++frame)
+    {
+        for (auto const& rect : *frame)
+            repaint.add(rect);
     }
+
+    auto const bounds = repaint.bounding_rectangle();
+    return geom::Rectangle{
+        {bounds.left().as_int(), framebuffer_height - bounds.bottom().as_int()},
+        bounds.size};
 }
 
 void mrg::Renderer::set_output_transform(glm::mat2 const& t)
@@ -738,8 +1346,60 @@ void mrg::Renderer::set_output_transform(glm::mat2 const& t)
     }
 }
 
+auto mrg::Renderer::gpu_render_time() -> std::experimental::optional<std::chrono::nanoseconds>
+{
+    if (!gpu_timer)
+        return std::experimental::nullopt;
+
+    return gpu_timer->take_result();
+}
+
+void mrg::Renderer::read_next_frame(geom::Rectangle const& area, FrameReader const& reader)
+{
+    frame_reads.emplace_back(area, reader);
+}
+
+void mrg::Renderer::read_back(geom::Rectangle const& area, FrameReader const& reader) const
+{
+    // Only an untransformed, unscaled framebuffer holds the area pixel for pixel
+    if (!damage_maps_to_pixels || !viewport.contains(area))
+    {
+        reader({}, {}, nullptr);
+        return;
+    }
+
+    auto const width = area.size.width.as_int();
+    auto const height = area.size.height.as_int();
+    read_pixels.resize(size_t(width) * height * 2);
+    auto const gl_rows = read_pixels.data();
+    auto const rows = read_pixels.data() + size_t(width) * height;
+
+    // GL_RGBA is the only format reading is sure to support
+    glReadPixels(
+        area.left().as_int() - viewport.left().as_int(),
+        framebuffer_height - (area.bottom().as_int() - viewport.top().as_int()),
+        width, height,
+        GL_RGBA, GL_UNSIGNED_BYTE,
+        gl_rows);
+
+    // GL's rows are bottom first, and its bytes RGBA (0xAABBGGRR, little endian)
+    for (auto y = 0; y != height; ++y)
+    {
+        auto const src = gl_rows + size_t(height - 1 - y) * width;
+        auto const dst = rows + size_t(y) * width;
+        for (auto x = 0; x != width; ++x)
+        {
+            auto const p = src[x];
+            dst[x] = (p & 0xff00ff00) | ((p << 16) & 0x00ff0000) | ((p >> 16) & 0x000000ff);
+        }
+    }
+
+    reader(area.size, geom::Stride{width * 4}, rows);
+}
+
 void mrg::Renderer::suspend()
 {
     texture_cache->invalidate();
+    damage_history.clear();
 }
 
@@ -23,14 +23,21 @@
 
 #include <mir/renderer/renderer.h>
 #include <mir/geometry/rectangle.h>
+#include <mir/geometry/rectangles.h>
+#include <mir/geometry/region.h>
 #include <mir/graphics/buffer_id.h>
 #include <mir/graphics/renderable.h>
 #include <mir/gl/primitive.h>
 #include "mir/renderer/gl/render_target.h"
 
 #include <GLES2/gl2.h>
+#include <cstdint>
+#include <deque>
+#include <experimental/optional>
+#include <memory>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace mir
@@ -41,6 +48,7 @@ namespace renderer
 {
 namespace gl
 {
+class ProgramBinaryCache;
 
 class CurrentRenderTarget
 {
@@ -51,6 +59,7 @@ public:
     void ensure_current();
     void bind();
     void swap_buffers();
+    void swap_buffers_with_damage(geometry::Rectangles const& damage);
 
 private:
     renderer::gl::RenderTarget* const render_target;
@@ -59,17 +68,31 @@ private:
 class Renderer : public renderer::Renderer
 {
 public:
-    Renderer(graphics::DisplayBuffer& display_buffer);
+    /**
+     * \param [in] opaque_front_to_back  Draw opaque renderables front to back with
+     *                                   depth testing before blending the rest, if
+     *                                   the framebuffer has a depth buffer
+     * \param [in] binary_cache          Where to look for (and keep) linked shader programs
+     */
+    Renderer(
+        graphics::DisplayBuffer& display_buffer,
+        bool opaque_front_to_back = false,
+        std::shared_ptr<ProgramBinaryCache const> const& binary_cache = nullptr);
     virtual ~Renderer();
 
     // These are called with a valid GL context:
     void set_viewport(geometry::Rectangle const& rect) override;
     void set_output_transform(glm::mat2 const&) override;
+    void set_damage(geometry::Rectangles const& damage) override;
     void render(graphics::RenderableList const&) const override;
 
     // This is called _without_ a GL context:
     void suspend() override;
 
+    auto gpu_render_time() -> std::experimental::optional<std::chrono::nanoseconds> override;
+
+    void read_next_frame(geometry::Rectangle const& area, FrameReader const& reader) override;
+
     struct Program
     {
         GLuint id = 0;
@@ -85,7 +108,12 @@ public:
         GLint transform_uniform = -1;
         GLint screen_to_gl_coords_uniform = -1;
         GLint alpha_uniform = -1;
+        GLint color_uniform = -1;
         mutable long long last_used_frameno = 0;
+        /// Per-renderable uniform values last loaded, so repeated values aren't reloaded
+        mutable std::experimental::optional<glm::vec2> loaded_centre;
+        mutable std::experimental::optional<glm::mat4> loaded_transform;
+        mutable std::experimental::optional<GLfloat> loaded_alpha;
 
         Program(GLuint program_id);
     };
@@ -112,29 +140,132 @@ protected:
     virtual void tessellate(std::vector<mir::gl::Primitive>& primitives,
                             graphics::Renderable const& renderable) const;
 
+    /**
+     * Whether tessellate() depends on nothing but a renderable's screen
+     * position and src_bounds(), as the default one does. If so, renderables
+     * are only tessellated again when they move or are cropped differently,
+     * and vertices are only uploaded when the scene's geometry changes.
+     * Overrides of tessellate() that deform renderables over time should
+     * return false.
+     */
+    virtual bool tessellation_depends_only_on_position() const;
+
     GLfloat clear_color[4];
 
     mutable long long frameno = 0;
 
     ProgramFamily family;
-    Program default_program, alpha_program;
+    Program default_program, alpha_program, solid_program;
 
     static const GLchar* const vshader;
     static const GLchar* const default_fshader;
     static const GLchar* const alpha_fshader;
+    /// For graphics::SolidColorBuffer, which has no texture to sample
+    static const GLchar* const solid_fshader;
 
-    virtual void draw(graphics::Renderable const& renderable) const;
+    /// Where a tessellated primitive's vertices are in this frame's vertex buffer
+    struct BufferedPrimitive
+    {
+        GLenum type;
+        GLint first;
+        GLsizei count;
+    };
+
+    virtual void draw(graphics::Renderable const& renderable, std::vector<BufferedPrimitive> const& primitives) const;
 
 private:
+    /// Parameters of glBlendFuncSeparate()
+    struct BlendSeparate
+    {
+        GLenum src_rgb, dst_rgb, src_alpha, dst_alpha;
+    };
+
+    /// The GL state set so far this frame, so consecutive renderables needn't set it again
+    struct DrawState
+    {
+        Program const* program{nullptr};
+        std::experimental::optional<bool> blend;
+        std::experimental::optional<BlendSeparate> blend_func;
+    };
+
+    /// Fills opaque_renderables, shaped_renderables and opaque_area for a frame
+    void find_opaque_areas(graphics::RenderableList const& renderables) const;
+    /// Clears the parts of the viewport that opaque_area leaves uncovered (or everything)
+    void clear_uncovered() const;
+    /// Draws renderables[i], telling draw() what find_opaque_areas() already learnt
+    void draw_renderable(graphics::RenderableList const& renderables, size_t i) const;
+    /// Draws the opaque renderables front to back, then the others back to front
+    void draw_front_to_back(graphics::RenderableList const& renderables) const;
+
+    /// Tessellates every renderable into vertex_buffer, filling buffered_primitives
+    void buffer_vertices(graphics::RenderableList const& renderables) const;
+    void use_program(Program const& prog) const;
+    void set_blend(BlendSeparate const& blend) const;
+
     void update_gl_viewport();
 
+    /// The framebuffer area to repaint this frame, in GL coordinates (or nullopt for everything)
+    auto repaint_area(geometry::Rectangles const& frame_damage) const -> std::experimental::optional<geometry::Rectangle>;
+    auto buffer_age() const -> int;
+    /// Reads area of the frame in the framebuffer (before it's swapped) and passes it to reader
+    void read_back(geometry::Rectangle const& area, FrameReader const& reader) const;
+
     class ProgramFactory;
     std::unique_ptr<ProgramFactory> const program_factory;
+    /// Measures render() with GL_EXT_disjoint_timer_query (null without it)
+    class GPUTimer;
+    std::unique_ptr<GPUTimer> gpu_timer;
     std::unique_ptr<mir::gl::TextureCache> const texture_cache;
     geometry::Rectangle viewport;
     glm::mat4 screen_to_gl_coords;
     glm::mat4 display_transform;
     std::vector<mir::gl::Primitive> mutable primitives;
+
+    GLuint vertex_buffer{0};
+    std::vector<mir::gl::Vertex> mutable frame_vertices;
+    /// The primitives of each renderable in the current frame (storage is kept between frames)
+    std::vector<std::vector<BufferedPrimitive>> mutable buffered_primitives;
+
+    /// A renderable's tessellation, kept while its screen position and source area are unchanged
+    struct CachedGeometry
+    {
+        geometry::Rectangle position;
+        geometry::RectangleF src_bounds;
+        geometry::Size buffer_size;
+        std::vector<mir::gl::Vertex> vertices;
+        /// As buffered, but relative to the start of vertices
+        std::vector<BufferedPrimitive> primitives;
+        long long last_used_frameno{0};
+    };
+    std::unordered_map<graphics::Renderable::ID, CachedGeometry> mutable geometry_cache;
+    /// The renderables, in order, whose vertices vertex_buffer holds
+    std::vector<graphics::Renderable::ID> mutable buffered_ids;
+    std::vector<CachedGeometry const*> mutable frame_geometry;
+    DrawState mutable draw_state;
+
+    bool depth_sorting{false};
+    /// Which renderables of the current frame hide everything below them
+    std::vector<bool> mutable opaque_renderables;
+    /// The area known to be painted opaquely in the current frame
+    geometry::Region mutable opaque_area;
+    /// shaped() of each renderable of the current frame, so each is only asked once
+    std::vector<bool> mutable shaped_renderables;
+    /// shaped() of the renderable draw() is drawing, if already known
+    std::experimental::optional<bool> mutable known_shaped;
+
+    bool buffer_age_supported{false};
+    /// Whether the viewport maps 1:1 onto framebuffer pixels, so damage can be applied
+    bool damage_maps_to_pixels{false};
+    /// Whether the viewport is not letterboxed, so there are no bars that only glClear() paints
+    bool viewport_fills_framebuffer{false};
+    int framebuffer_height{0};
+    std::experimental::optional<geometry::Rectangles> mutable damage;
+    /// Framebuffer damage of the most recent frames, newest first
+    std::deque<geometry::Rectangles> mutable damage_history;
+    /// Areas to read back from the next frame
+    std::vector<std::pair<geometry::Rectangle, FrameReader>> mutable frame_reads;
+    std::vector<std::uint32_t> mutable read_pixels;
+    std::experimental::optional<geometry::Rectangle> mutable frame_scissor;
 };
 
 }
@@ -18,13 +18,20 @@
 
 #include "renderer_factory.h"
 #include "renderer.h"
+#include "program_binary_cache.h"
 #include "mir/graphics/display_buffer.h"
 
 namespace mrg = mir::renderer::gl;
 
+mrg::RendererFactory::RendererFactory(bool opaque_front_to_back)
+    : opaque_front_to_back{opaque_front_to_back},
+      binary_cache{std::make_shared<ProgramBinaryCache>(ProgramBinaryCache::default_directory())}
+{
+}
+
 std::unique_ptr<mir::renderer::Renderer>
 mrg::RendererFactory::create_renderer_for(
     graphics::DisplayBuffer& display_buffer)
 {
-    return std::make_unique<Renderer>(display_buffer);
+    return std::make_unique<Renderer>(display_buffer, opaque_front_to_back, binary_cache);
 }
@@ -21,18 +21,29 @@
 
 #include "mir/renderer/renderer_factory.h"
 
+#include <memory>
+
 namespace mir
 {
 namespace renderer
 {
 namespace gl
 {
+class ProgramBinaryCache;
 
 class RendererFactory : public renderer::RendererFactory
 {
 public:
+    /// \param [in] opaque_front_to_back  See Renderer::Renderer()
+    explicit RendererFactory(bool opaque_front_to_back = false);
+
     std::unique_ptr<renderer::Renderer> create_renderer_for(
         graphics::DisplayBuffer& display_buffer) override;
+
+private:
+    bool const opaque_front_to_back;
+    /// Shared by every renderer, so outputs (and hotplugs) reuse each other's programs
+    std::shared_ptr<ProgramBinaryCache const> const binary_cache;
 };
 
 }
@@ -0,0 +1,142 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "blend.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace mrs = mir::renderer::software;
+
+namespace
+{
+std::uint32_t const alpha_mask{0xff000000};
+
+/// c * a / 255, correctly rounded for 8-bit c and a
+inline auto mul_div255(std::uint32_t c, std::uint32_t a) -> std::uint32_t
+{
+    auto const t = c * a + 128;
+    return (t + (t >> 8)) >> 8;
+}
+
+inline auto blend_pixel(std::uint32_t dst, std::uint32_t src, std::uint32_t alpha) -> std::uint32_t
+{
+    std::uint32_t result = 0;
+    if (alpha != 255)
+    {
+        for (auto shift = 0; shift != 32; shift += 8)
+            result |= mul_div255((src >> shift) & 0xff, alpha) << shift;
+        src = result;
+        result = 0;
+    }
+
+    auto const inv_src_alpha = 255 - (src >> 24);
+    for (auto shift = 0; shift != 32; shift += 8)
+    {
+        auto const c = ((src >> shift) & 0xff) + mul_div255((dst >> shift) & 0xff, inv_src_alpha);
+        // Saturate, in case the source isn't properly premultiplied
+        result |= std::min(c, 255u) << shift;
+    }
+    return result;
+}
+
+#if defined(__SSE2__)
+/// Per 16-bit lane x / 255, correctly rounded for x <= 255 * 255
+inline auto div255_epi16(__m128i x) -> __m128i
+{
+    auto const t = _mm_add_epi16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+/// Broadcast the alpha lane of each of the two pixels in \a px (unpacked to 16-bit lanes)
+inline auto alpha_epi16(__m128i px) -> __m128i
+{
+    return _mm_shufflehi_epi16(_mm_shufflelo_epi16(px, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+/// The SSE2 version of blend_pixel() for four pixels at a time
+inline auto blend_4_pixels(__m128i dst, __m128i src, __m128i alpha) -> __m128i
+{
+    auto const zero = _mm_setzero_si128();
+    auto const max = _mm_set1_epi16(255);
+
+    auto src_lo = _mm_unpacklo_epi8(src, zero);
+    auto src_hi = _mm_unpackhi_epi8(src, zero);
+    src_lo = div255_epi16(_mm_mullo_epi16(src_lo, alpha));
+    src_hi = div255_epi16(_mm_mullo_epi16(src_hi, alpha));
+
+    auto const dst_lo = div255_epi16(
+        _mm_mullo_epi16(_mm_unpacklo_epi8(dst, zero), _mm_sub_epi16(max, alpha_epi16(src_lo))));
+    auto const dst_hi = div255_epi16(
+        _mm_mullo_epi16(_mm_unpackhi_epi8(dst, zero), _mm_sub_epi16(max, alpha_epi16(src_hi))));
+
+    return _mm_adds_epu8(_mm_packus_epi16(src_lo, src_hi), _mm_packus_epi16(dst_lo, dst_hi));
+}
+#endif
+}
+
+void mrs::blend_span(
+    std::uint32_t* dst,
+    std::uint32_t const* src,
+    std::size_t count,
+    std::uint8_t alpha,
+    bool ignore_src_alpha)
+{
+    if (alpha == 0)
+        return;
+
+    std::size_t i = 0;
+
+    if (ignore_src_alpha && alpha == 255)
+    {
+        // Nothing to blend: this is the common case of an opaque window
+#if defined(__SSE2__)
+        auto const mask = _mm_set1_epi32(alpha_mask);
+        for (; i + 4 <= count; i += 4)
+        {
+            auto const s = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_or_si128(s, mask));
+        }
+#endif
+        for (; i != count; ++i)
+            dst[i] = src[i] | alpha_mask;
+        return;
+    }
+
+    std::uint32_t const forced_alpha = ignore_src_alpha ? alpha_mask : 0;
+
+#if defined(__SSE2__)
+    auto const mask = _mm_set1_epi32(forced_alpha);
+    auto const span_alpha = _mm_set1_epi16(alpha);
+    for (; i + 4 <= count; i += 4)
+    {
+        auto const s = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i)), mask);
+        auto const d = _mm_loadu_si128(reinterpret_cast<__m128i const*>(dst + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), blend_4_pixels(d, s, span_alpha));
+    }
+#endif
+    for (; i != count; ++i)
+        dst[i] = blend_pixel(dst[i], src[i] | forced_alpha, alpha);
+}
+
+void mrs::fill_span(std::uint32_t* dst, std::size_t count, std::uint32_t pixel)
+{
+    std::fill_n(dst, count, pixel);
+}
@@ -0,0 +1,50 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_RENDERER_SOFTWARE_BLEND_H_
+#define MIR_RENDERER_SOFTWARE_BLEND_H_
+
+#include <cstdint>
+#include <cstddef>
+
+namespace mir
+{
+namespace renderer
+{
+namespace software
+{
+
+/**
+ * Composite \a count premultiplied 0xAARRGGBB pixels from \a src over \a dst.
+ *
+ * \param [in] alpha            Opacity applied to the whole span (255 is opaque)
+ * \param [in] ignore_src_alpha Treat the source as XRGB, i.e. fully opaque
+ */
+void blend_span(
+    std::uint32_t* dst,
+    std::uint32_t const* src,
+    std::size_t count,
+    std::uint8_t alpha,
+    bool ignore_src_alpha);
+
+/// Set \a count pixels of \a dst to \a pixel
+void fill_span(std::uint32_t* dst, std::size_t count, std::uint32_t pixel);
+
+}
+}
+}
+
+#endif // MIR_RENDERER_SOFTWARE_BLEND_H_
@@ -0,0 +1,252 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define MIR_LOG_COMPONENT "SoftwareRenderer"
+
+#include "renderer.h"
+#include "blend.h"
+
+#include "mir/renderer/sw/render_target.h"
+#include "mir/renderer/sw/pixel_source.h"
+#include "mir/graphics/display_buffer.h"
+#include "mir/graphics/buffer.h"
+#include "mir/graphics/solid_color_buffer.h"
+#include "mir/geometry/region.h"
+#include "mir/log.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace mg = mir::graphics;
+namespace mrs = mir::renderer::software;
+namespace geom = mir::geometry;
+
+namespace
+{
+/// Matches the GL renderer's clear colour
+std::uint32_t const clear_pixel{0x00000000};
+
+auto is_rgb_8888(MirPixelFormat format) -> bool
+{
+    return format == mir_pixel_format_argb_8888 || format == mir_pixel_format_xrgb_8888;
+}
+
+/// A premultiplied RGBA color as the 0xAARRGGBB pixel of an ARGB 8888 buffer
+auto as_argb_8888(std::array<float, 4> const& color) -> std::uint32_t
+{
+    auto const channel =
+        [](float value)
+        {
+            return static_cast<std::uint32_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255));
+        };
+    return channel(color[3]) << 24 | channel(color[0]) << 16 | channel(color[1]) << 8 | channel(color[2]);
+}
+
+auto as_render_target(mg::DisplayBuffer& display_buffer) -> mrs::RenderTarget&
+{
+    auto const target = dynamic_cast<mrs::RenderTarget*>(display_buffer.native_display_buffer());
+    if (!target)
+        BOOST_THROW_EXCEPTION(std::runtime_error{"Display buffer does not support software rendering"});
+    return *target;
+}
+
+auto row(mrs::Mapping<unsigned char>& mapping, int y) -> std::uint32_t*
+{
+    return reinterpret_cast<std::uint32_t*>(mapping.data() + y * mapping.stride().as_int());
+}
+
+auto row(mrs::Mapping<unsigned char const>& mapping, int y) -> std::uint32_t const*
+{
+    return reinterpret_cast<std::uint32_t const*>(mapping.data() + y * mapping.stride().as_int());
+}
+}
+
+mrs::Renderer::Renderer(graphics::DisplayBuffer& display_buffer)
+    : render_target{as_render_target(display_buffer)},
+      viewport{display_buffer.view_area()}
+{
+}
+
+void mrs::Renderer::set_viewport(geom::Rectangle const& rect)
+{
+    viewport = rect;
+}
+
+void mrs::Renderer::set_output_transform(glm::mat2 const& transform)
+{
+    if (transform != glm::mat2{1})
+        mir::log_warning("Software renderer cannot apply output transformations; drawing untransformed");
+}
+
+void mrs::Renderer::set_damage(geom::Rectangles const& damage)
+{
+    this->damage = damage;
+}
+
+void mrs::Renderer::render(mg::RenderableList const& renderables) const
+{
+    auto framebuffer = render_target.map_framebuffer();
+    if (!is_rgb_8888(framebuffer->format()))
+        BOOST_THROW_EXCEPTION(std::runtime_error{"Software renderer needs an ARGB or XRGB 8888 framebuffer"});
+
+    // The region's rectangles don't overlap, so nothing is blended twice
+    geom::Region repaint{intersection_of(viewport, {viewport.top_left, framebuffer->size()})};
+    if (damage)
+        repaint &= geom::Region{damage.value()};
+    damage = std::experimental::nullopt;
+
+    auto const repaint_rects = repaint.rectangles();
+    for (auto const& area : repaint_rects)
+        repaint_area(*framebuffer, area, renderables);
+
+    // Captures read straight from the framebuffer, before it's posted
+    geom::Rectangle const framebuffer_area{viewport.top_left, framebuffer->size()};
+    for (auto const& read : frame_reads)
+    {
+        auto const& area = read.first;
+        if (framebuffer_area.contains(area))
+        {
+            auto const left = area.left().as_int() - viewport.left().as_int();
+            auto const top = area.top().as_int() - viewport.top().as_int();
+            read.second(area.size, framebuffer->stride(), row(*framebuffer, top) + left);
+        }
+        else
+        {
+            read.second({}, {}, nullptr);
+        }
+    }
+    frame_reads.clear();
+
+    framebuffer.reset();
+
+    geom::Rectangles frame_damage;
+    for (auto const& area : repaint_rects)
+        frame_damage.add({as_point(area.top_left - viewport.top_left), area.size});
+    render_target.post(frame_damage);
+}
+
+void mrs::Renderer::repaint_area(
+    Mapping<unsigned char>& framebuffer,
+    geom::Rectangle const& repaint,
+    mg::RenderableList const& renderables) const
+{
+    auto const width = repaint.size.width.as_int();
+    auto const height = repaint.size.height.as_int();
+    auto const fb_left = repaint.left().as_int() - viewport.left().as_int();
+    auto const fb_top = repaint.top().as_int() - viewport.top().as_int();
+
+    for (auto y = 0; y < height; ++y)
+        fill_span(row(framebuffer, fb_top + y) + fb_left, width, clear_pixel);
+
+    for (auto const& renderable : renderables)
+    {
+        auto const buffer = renderable->buffer();
+        if (!is_rgb_8888(buffer->pixel_format()))
+            continue;
+
+        auto const dest = renderable->screen_position();
+        auto area = intersection_of(dest, repaint);
+        if (auto const clip = renderable->clip_area())
+            area = intersection_of(area, clip.value());
+
+        auto const area_width = area.size.width.as_int();
+        auto const area_height = area.size.height.as_int();
+        auto const alpha = static_cast<std::uint8_t>(std::lround(std::clamp(renderable->alpha(), 0.0f, 1.0f) * 255));
+        if (area_width <= 0 || area_height <= 0 || alpha == 0)
+            continue;
+
+        auto const dst_x = area.left().as_int() - viewport.left().as_int();
+        auto const dst_top = area.top().as_int() - viewport.top().as_int();
+
+        // A solid color has no pixels to map: every row is the same span
+        if (auto const solid = dynamic_cast<mg::SolidColorBuffer const*>(buffer->native_buffer_base()))
+        {
+            scaled_row.assign(area_width, as_argb_8888(solid->color()));
+            auto const ignore_alpha = buffer->pixel_format() == mir_pixel_format_xrgb_8888;
+            for (auto y = 0; y < area_height; ++y)
+                blend_span(row(framebuffer, dst_top + y) + dst_x, scaled_row.data(), area_width, alpha, ignore_alpha);
+            continue;
+        }
+
+        std::shared_ptr<ReadMappableBuffer> mappable;
+        try
+        {
+            mappable = as_read_mappable_buffer(buffer);
+        }
+        catch (std::runtime_error const&)
+        {
+            // Not CPU-accessible (e.g. a dmabuf), so there's nothing we can draw
+            continue;
+        }
+
+        auto const source = mappable->map_readable();
+        auto const ignore_src_alpha = source->format() == mir_pixel_format_xrgb_8888;
+
+        // Sample only the src_bounds() of the buffer, to the nearest whole pixel
+        auto const bounds = renderable->src_bounds();
+        auto const buffer_width = source->size().width.as_int();
+        auto const buffer_height = source->size().height.as_int();
+        auto const src_left = std::clamp(static_cast<int>(std::lround(bounds.top_left.x.as_value())), 0, buffer_width);
+        auto const src_top = std::clamp(static_cast<int>(std::lround(bounds.top_left.y.as_value())), 0, buffer_height);
+        auto const src_width = std::clamp(
+            static_cast<int>(std::lround(bounds.size.width.as_value())), 0, buffer_width - src_left);
+        auto const src_height = std::clamp(
+            static_cast<int>(std::lround(bounds.size.height.as_value())), 0, buffer_height - src_top);
+        auto const dest_width = dest.size.width.as_int();
+        auto const dest_height = dest.size.height.as_int();
+        if (src_width <= 0 || src_height <= 0)
+            continue;
+
+        auto const x_offset = area.left().as_int() - dest.left().as_int();
+        auto const y_offset = area.top().as_int() - dest.top().as_int();
+        auto const unscaled_x = src_width == dest_width;
+        scaled_row.resize(area_width);
+
+        for (auto y = 0; y < area_height; ++y)
+        {
+            auto const src_y = src_top + static_cast<int>(static_cast<long>(y_offset + y) * src_height / dest_height);
+            auto const src_row = row(*source, src_y) + src_left;
+
+            std::uint32_t const* src = src_row + x_offset;
+            if (!unscaled_x)
+            {
+                // Nearest-neighbour: fine for the integer scales outputs actually use
+                for (auto x = 0; x < area_width; ++x)
+                    scaled_row[x] = src_row[static_cast<long>(x_offset + x) * src_width / dest_width];
+                src = scaled_row.data();
+            }
+
+            blend_span(row(framebuffer, dst_top + y) + dst_x, src, area_width, alpha, ignore_src_alpha);
+        }
+    }
+}
+
+void mrs::Renderer::suspend()
+{
+}
+
+auto mrs::Renderer::gpu_render_time() -> std::experimental::optional<std::chrono::nanoseconds>
+{
+    return {};
+}
+
+void mrs::Renderer::read_next_frame(geom::Rectangle const& area, FrameReader const& reader)
+{
+    frame_reads.emplace_back(area, reader);
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_RENDERER_SOFTWARE_RENDERER_H_
+#define MIR_RENDERER_SOFTWARE_RENDERER_H_
+
+#include "mir/renderer/renderer.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace mir
+{
+namespace graphics
+{
+struct DisplayBuffer;
+}
+namespace renderer
+{
+namespace software
+{
+class RenderTarget;
+template<typename T>
+class Mapping;
+
+/**
+ * Composites CPU-accessible (shm and PixelSource) buffers on the CPU, for
+ * outputs without a GPU.
+ *
+ * Only ARGB and XRGB 8888 buffers are drawn; other renderables are skipped.
+ * Renderables are drawn axis-aligned at their screen position, scaled with
+ * nearest-neighbour sampling: renderable and output transformations are
+ * not applied.
+ */
+class Renderer : public renderer::Renderer
+{
+public:
+    /// \throws std::runtime_error if \a display_buffer isn't a software RenderTarget
+    explicit Renderer(graphics::DisplayBuffer& display_buffer);
+
+    void set_viewport(geometry::Rectangle const& rect) override;
+    void set_output_transform(glm::mat2 const&) override;
+    void set_damage(geometry::Rectangles const& damage) override;
+    void render(graphics::RenderableList const&) const override;
+    void suspend() override;
+    auto gpu_render_time() -> std::experimental::optional<std::chrono::nanoseconds> override;
+    void read_next_frame(geometry::Rectangle const& area, FrameReader const& reader) override;
+
+private:
+    /// Clears \a repaint (in screen coordinates) and draws the renderables' parts within it
+    void repaint_area(
+        Mapping<unsigned char>& framebuffer,
+        geometry::Rectangle const& repaint,
+        graphics::RenderableList const& renderables) const;
+
+    RenderTarget& render_target;
+    geometry::Rectangle viewport;
+    std::experimental::optional<geometry::Rectangles> mutable damage;
+    /// Areas to read back from the next frame
+    std::vector<std::pair<geometry::Rectangle, FrameReader>> mutable frame_reads;
+    /// Scratch row for scaling sources, kept to avoid reallocating every frame
+    std::vector<std::uint32_t> mutable scaled_row;
+};
+
+}
+}
+}
+
+#endif // MIR_RENDERER_SOFTWARE_RENDERER_H_
@@ -0,0 +1,95 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "buffer_release_thread.h"
+
+#include "mir/thread/executor_batch.h"
+#include "mir/thread_name.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <sys/eventfd.h>
+
+#include <cerrno>
+#include <system_error>
+
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+
+mc::BufferReleaseThread::BufferReleaseThread()
+    : notify_fd{eventfd(0, EFD_CLOEXEC)}
+{
+    if (notify_fd == mir::Fd::invalid)
+    {
+        BOOST_THROW_EXCEPTION((std::system_error{
+            errno,
+            std::system_category(),
+            "Failed to create buffer release eventfd"}));
+    }
+
+    thread = std::thread{[this] { run(); }};
+}
+
+mc::BufferReleaseThread::~BufferReleaseThread()
+{
+    stopping.store(true, std::memory_order_release);
+    notify();
+    thread.join();
+}
+
+void mc::BufferReleaseThread::release(mg::RenderableList&& renderables)
+{
+    if (renderables.empty())
+        return;
+
+    queue.push(std::move(renderables));
+
+    // Only the first handover since the thread last woke needs to wake it
+    if (!wakeup_pending.exchange(true, std::memory_order_acq_rel))
+        notify();
+}
+
+void mc::BufferReleaseThread::notify()
+{
+    while (eventfd_write(notify_fd, 1) && errno == EINTR)
+    {
+    }
+}
+
+void mc::BufferReleaseThread::run()
+{
+    mir::set_thread_name("Mir/BufRelease");
+
+    for (;;)
+    {
+        eventfd_t unused;
+        if (eventfd_read(notify_fd, &unused) && errno == EINTR)
+            continue;
+
+        // Re-armed before draining, so a handover we miss wakes us again
+        wakeup_pending.store(false, std::memory_order_release);
+
+        {
+            thread::ExecutorBatch const batch;
+            mg::RenderableList renderables;
+            while (queue.pop(renderables))
+                renderables.clear();
+        }
+
+        if (stopping.load(std::memory_order_acquire))
+            return;
+    }
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_COMPOSITOR_BUFFER_RELEASE_THREAD_H_
+#define MIR_COMPOSITOR_BUFFER_RELEASE_THREAD_H_
+
+#include "mir/graphics/renderable.h"
+#include "mir/thread/mpsc_queue.h"
+#include "mir/fd.h"
+
+#include <atomic>
+#include <thread>
+
+namespace mir
+{
+namespace compositor
+{
+/**
+ * Drops the renderables compositors have finished with, and so their references to their buffers, on a thread
+ * of its own
+ *
+ * Dropping the last reference to a buffer releases it to its client, which takes locks and may destroy GPU
+ * resources. That has no place on a compositor thread, so compositors hand their renderables over instead,
+ * without taking a lock or waiting. The release work of everything handed over by the time the thread wakes
+ * is sent to the frontend as a single batch.
+ */
+class BufferReleaseThread
+{
+public:
+    BufferReleaseThread();
+    /// Releases anything still handed over, then joins the thread
+    ~BufferReleaseThread();
+
+    void release(graphics::RenderableList&& renderables);
+
+private:
+    BufferReleaseThread(BufferReleaseThread const&) = delete;
+    BufferReleaseThread& operator=(BufferReleaseThread const&) = delete;
+
+    void run();
+    void notify();
+
+    thread::MPSCQueue<graphics::RenderableList> queue;
+    Fd const notify_fd;
+    /// Set when the thread has been woken, but not yet got round to what it was woken for
+    std::atomic<bool> wakeup_pending{false};
+    std::atomic<bool> stopping{false};
+    std::thread thread;
+};
+}
+}
+
+#endif /* MIR_COMPOSITOR_BUFFER_RELEASE_THREAD_H_ */
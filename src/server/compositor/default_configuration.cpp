@@ -22,12 +22,17 @@
 #include "buffer_stream_factory.h"
 #include "default_display_buffer_compositor_factory.h"
 #include "multi_threaded_compositor.h"
+#include "mir/compositor/screen_capture.h"
+#include "mir/input/scene.h"
 #include "gl/renderer_factory.h"
+#include "software/renderer_factory.h"
 #include "mir/main_loop.h"
+#include "mir/thread_scheduling.h"
 
 #include "mir/options/configuration.h"
 
 #include <boost/throw_exception.hpp>
+#include <stdexcept>
 
 namespace mc = mir::compositor;
 namespace ms = mir::scene;
@@ -50,7 +55,24 @@ mir::DefaultServerConfiguration::the_display_buffer_compositor_factory()
         [this]()
         {
             return wrap_display_buffer_compositor_factory(std::make_shared<mc::DefaultDisplayBufferCompositorFactory>(
-                the_renderer_factory(), the_compositor_report()));
+                the_renderer_factory(), the_compositor_report(), the_screen_capture()));
+        });
+}
+
+std::shared_ptr<mc::ScreenCapture>
+mir::DefaultServerConfiguration::the_screen_capture()
+{
+    return screen_capture(
+        [this]()
+        {
+            // Captures waiting on a new frame need the outputs recomposited
+            std::weak_ptr<mir::input::Scene> const scene = the_input_scene();
+            return std::make_shared<mc::ScreenCapture>(
+                [scene]
+                {
+                    if (auto const live = scene.lock())
+                        live->emit_scene_changed();
+                });
         });
 }
 
@@ -77,15 +99,31 @@ mir::DefaultServerConfiguration::the_compositor()
                 the_shell(),
                 the_compositor_report(),
                 composite_delay,
-                true);
+                true,
+                thread_scheduling_from(
+                    *the_options(),
+                    options::compositor_thread_priority_opt,
+                    options::compositor_thread_cpus_opt));
         });
 }
 
 std::shared_ptr<mir::renderer::RendererFactory> mir::DefaultServerConfiguration::the_renderer_factory()
 {
     return renderer_factory(
-        []()
+        [this]() -> std::shared_ptr<mir::renderer::RendererFactory>
         {
-            return std::make_shared<mir::renderer::gl::RendererFactory>();
+            auto const renderer_choice = the_options()->get<std::string>(options::renderer_opt);
+
+            if (renderer_choice == "gl")
+            {
+                return std::make_shared<mir::renderer::gl::RendererFactory>(
+                    the_options()->get<bool>(options::opaque_front_to_back_opt));
+            }
+            else if (renderer_choice == "software")
+            {
+                return std::make_shared<mir::renderer::software::RendererFactory>();
+            }
+
+            BOOST_THROW_EXCEPTION(std::runtime_error{"Unknown renderer: \"" + renderer_choice + "\""});
         });
 }
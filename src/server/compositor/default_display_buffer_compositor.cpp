@@ -25,22 +25,62 @@
 #include "mir/graphics/display_buffer.h"
 #include "mir/graphics/buffer.h"
 #include "mir/compositor/buffer_stream.h"
+#include "mir/compositor/screen_capture.h"
 #include "mir/renderer/renderer.h"
+#include "buffer_release_thread.h"
 #include "occlusion.h"
+#include "compositor_frame.tp.h"
 #include <mutex>
 #include <cstdlib>
 #include <algorithm>
+#include <unordered_map>
 
 namespace mc = mir::compositor;
 namespace mg = mir::graphics;
+namespace geom = mir::geometry;
+
+namespace
+{
+glm::mat4 const identity(1);
+
+auto visible_area(geom::Rectangle const& position, std::experimental::optional<geom::Rectangle> const& clip_area)
+    -> geom::Rectangle
+{
+    return clip_area ? position.intersection_with(clip_area.value()) : position;
+}
+
+void add_damage(geom::Rectangles& damage, geom::Rectangle const& rect)
+{
+    if (rect.size.width.as_int() > 0 && rect.size.height.as_int() > 0)
+        damage.add(rect);
+}
+
+void collect_buffer_ids(std::vector<unsigned int>& ids, mc::SceneElementSequence const& elements)
+{
+    ids.clear();
+    for (auto const& element : elements)
+        ids.push_back(element->renderable()->buffer()->id().as_value());
+}
+
+void collect_buffer_ids(std::vector<unsigned int>& ids, mg::RenderableList const& renderables)
+{
+    ids.clear();
+    for (auto const& renderable : renderables)
+        ids.push_back(renderable->buffer()->id().as_value());
+}
+}
 
 mc::DefaultDisplayBufferCompositor::DefaultDisplayBufferCompositor(
     mg::DisplayBuffer& display_buffer,
     std::shared_ptr<mir::renderer::Renderer> const& renderer,
-    std::shared_ptr<mc::CompositorReport> const& report) :
+    std::shared_ptr<mc::CompositorReport> const& report,
+    std::shared_ptr<ScreenCapture> const& screen_capture,
+    std::shared_ptr<BufferReleaseThread> const& buffer_release) :
     display_buffer(display_buffer),
     renderer(renderer),
-    report(report)
+    report(report),
+    screen_capture(screen_capture),
+    buffer_release(buffer_release)
 {
 }
 
@@ -54,7 +94,14 @@ void mc::DefaultDisplayBufferCompositor::composite(mc::SceneElementSequence&& sc
     for (auto const& element : occlusions)
         element->occluded();
 
-    mg::RenderableList renderable_list;
+    if (tracepoint_enabled(mir_server_frame, occluded))
+    {
+        collect_buffer_ids(traced_buffer_ids, occlusions);
+        do_tracepoint(
+            mir_server_frame, occluded, &display_buffer, traced_buffer_ids.data(), traced_buffer_ids.size());
+    }
+
+    // renderable_list is emptied at the end of each frame (and keeps its storage, unless handed to buffer_release)
     renderable_list.reserve(scene_elements.size());
     for (auto const& element : scene_elements)
     {
@@ -70,35 +117,209 @@ void mc::DefaultDisplayBufferCompositor::composite(mc::SceneElementSequence&& sc
      *       Actually, there's a third reference held by the texture cache
      *       in GLRenderer, but that gets released earlier in render().
      */
+
+    // The display buffer removes whatever it puts on hardware planes (and holds those buffers itself).
+    // A capture needs a rendered frame to read, so waits on that for the frame it wants.
+    bool const capturing = screen_capture && screen_capture->wants_frame_of(view_area);
+    bool const overlaid = !capturing && display_buffer.overlay(renderable_list);
+
+    // Whatever it took is on screen without our having composited it
+    traced_buffer_ids.clear();
+    if (overlaid || renderable_list.size() < scene_elements.size())
+    {
+        for (auto const& element : scene_elements)
+        {
+            auto const renderable = element->renderable();
+            if (overlaid || std::find(begin(renderable_list), end(renderable_list), renderable) == end(renderable_list))
+            {
+                element->scanned_out();
+                traced_buffer_ids.push_back(renderable->buffer()->id().as_value());
+            }
+        }
+    }
+    if (!traced_buffer_ids.empty())
+    {
+        tracepoint(
+            mir_server_frame, scanned_out, &display_buffer, traced_buffer_ids.data(), traced_buffer_ids.size());
+    }
+
     scene_elements.clear();  // Those in use are still in renderable_list
 
-    if (display_buffer.overlay(renderable_list))
+    if (overlaid)
     {
         report->renderables_in_frame(this, renderable_list);
         renderer->suspend();
+        release_renderables();
+
+        // Whatever the renderer last drew is no longer on screen
+        last_frame.clear();
+        last_view_area = std::experimental::nullopt;
     }
     else
     {
         renderer->set_output_transform(display_buffer.transformation());
         renderer->set_viewport(view_area);
+        auto const damage = damage_since_last_frame(renderable_list);
+        if (damage)
+            renderer->set_damage(damage.value());
+        if (capturing)
+            screen_capture->prepare_frame(view_area, damage, *renderer);
         renderer->render(renderable_list);
 
+        if (tracepoint_enabled(mir_server_frame, composited))
+        {
+            collect_buffer_ids(traced_buffer_ids, renderable_list);
+            do_tracepoint(
+                mir_server_frame, composited, &display_buffer, traced_buffer_ids.data(), traced_buffer_ids.size());
+        }
+
         report->renderables_in_frame(this, renderable_list);
         report->rendered_frame(this);
+        if (auto const gpu_time = renderer->gpu_render_time())
+            report->measured_gpu_render_time(this, gpu_time.value());
 
         /*
          * This is used for the 'early release' optimization to release buffers
          * we did use back to clients before starting on the potentially slow
-         * post() call.
-         * FIXME: This clear() call is blocking a little because we drive IPC
-         *        here (LP: #1395421). However if the early release
-         *        optimization is disabled or absent (LP: #1561418) then this
-         *        clear() doesn't contribute anything. In that case the
-         *        problematic IPC (LP: #1395421) will instead occur in buffer
-         *        acquisition calls when we composite the next frame.
+         * post() call. The GPU may still be reading them, but shm content
+         * has been uploaded already and the kernel synchronises a client's
+         * next use of a dmabuf with our reads, so there's no fence to wait on.
          */
-        renderable_list.clear();
+        release_renderables();
     }
 
     report->finished_frame(this);
 }
+
+void mc::DefaultDisplayBufferCompositor::release_renderables()
+{
+    if (buffer_release)
+    {
+        // Releasing a buffer to its client can block, so isn't for the compositor thread
+        buffer_release->release(std::move(renderable_list));
+        renderable_list.clear();
+    }
+    else
+    {
+        renderable_list.clear();
+    }
+}
+
+auto mc::DefaultDisplayBufferCompositor::damage_since_last_frame(mg::RenderableList const& renderables)
+    -> std::experimental::optional<geom::Rectangles>
+{
+    auto const view_area = display_buffer.view_area();
+    auto const transformation = display_buffer.transformation();
+
+    // The storage of the frame before last is free to reuse
+    auto& this_frame = previous_frame_storage;
+    this_frame.clear();
+    this_frame.reserve(renderables.size());
+    for (auto const& renderable : renderables)
+    {
+        this_frame.push_back(RenderedState{
+            renderable->id(),
+            renderable->buffer()->id(),
+            renderable->screen_position(),
+            renderable->clip_area(),
+            renderable->alpha(),
+            renderable->transformation()});
+    }
+
+    bool const output_changed =
+        !last_view_area || last_view_area.value() != view_area || last_transformation != transformation;
+
+    std::swap(last_frame, this_frame);
+    auto const& previous_frame = this_frame;
+    auto const& current_frame = last_frame;
+    last_view_area = view_area;
+    last_transformation = transformation;
+
+    if (output_changed)
+        return std::experimental::nullopt;
+
+    std::unordered_map<mg::Renderable::ID, RenderedState const*> previous;
+    for (auto const& state : previous_frame)
+        previous[state.id] = &state;
+
+    std::unordered_map<mg::Renderable::ID, RenderedState const*> current;
+    for (auto const& state : current_frame)
+        current[state.id] = &state;
+
+    // Restacking is rare enough not to bother working out what it exposed
+    {
+        auto prev = previous_frame.begin();
+        for (auto const& state : current_frame)
+        {
+            if (!previous.count(state.id))
+                continue;
+
+            while (!current.count(prev->id))
+                ++prev;
+
+            if (prev->id != state.id)
+                return std::experimental::nullopt;
+
+            ++prev;
+        }
+    }
+
+    geom::Rectangles damage;
+
+    for (auto const& state : previous_frame)
+    {
+        if (!current.count(state.id))
+        {
+            if (state.transformation != identity)
+                return std::experimental::nullopt;
+
+            add_damage(damage, visible_area(state.position, state.clip_area));
+        }
+    }
+
+    for (auto i = 0u; i != current_frame.size(); ++i)
+    {
+        auto const& state = current_frame[i];
+        auto const visible = visible_area(state.position, state.clip_area);
+        auto const found = previous.find(state.id);
+
+        if (found == previous.end())
+        {
+            if (state.transformation != identity)
+                return std::experimental::nullopt;
+
+            add_damage(damage, visible);
+            continue;
+        }
+
+        auto const& before = *found->second;
+        if (before.position != state.position ||
+            before.clip_area != state.clip_area ||
+            before.alpha != state.alpha ||
+            before.transformation != state.transformation)
+        {
+            if (before.transformation != identity || state.transformation != identity)
+                return std::experimental::nullopt;
+
+            add_damage(damage, visible_area(before.position, before.clip_area));
+            add_damage(damage, visible);
+        }
+        else if (before.buffer != state.buffer)
+        {
+            if (state.transformation != identity)
+                return std::experimental::nullopt;
+
+            if (auto const buffer_damage = renderables[i]->damage())
+            {
+                for (auto const& rect : buffer_damage.value())
+                    add_damage(damage, rect.intersection_with(visible));
+            }
+            else
+            {
+                add_damage(damage, visible);
+            }
+        }
+    }
+
+    return damage;
+}
@@ -21,7 +21,14 @@
 
 #include "mir/compositor/display_buffer_compositor.h"
 #include "mir/compositor/compositor_report.h"
+#include "mir/graphics/renderable.h"
+#include "mir/graphics/buffer_id.h"
+#include "mir/geometry/rectangles.h"
+
+#include <glm/glm.hpp>
+#include <experimental/optional>
 #include <memory>
+#include <vector>
 
 namespace mir
 {
@@ -36,7 +43,9 @@ class Renderer;
 namespace compositor
 {
 
+class BufferReleaseThread;
 class Scene;
+class ScreenCapture;
 
 class DefaultDisplayBufferCompositor : public DisplayBufferCompositor
 {
@@ -44,14 +53,45 @@ public:
     DefaultDisplayBufferCompositor(
         graphics::DisplayBuffer& display_buffer,
         std::shared_ptr<renderer::Renderer> const& renderer,
-        std::shared_ptr<CompositorReport> const& report);
+        std::shared_ptr<CompositorReport> const& report,
+        std::shared_ptr<ScreenCapture> const& screen_capture = nullptr,
+        std::shared_ptr<BufferReleaseThread> const& buffer_release = nullptr);
 
     void composite(SceneElementSequence&& scene_sequence) override;
 
 private:
+    /// What we last drew of each renderable; enough to tell what has changed since
+    struct RenderedState
+    {
+        graphics::Renderable::ID id;
+        graphics::BufferID buffer;
+        geometry::Rectangle position;
+        std::experimental::optional<geometry::Rectangle> clip_area;
+        float alpha;
+        glm::mat4 transformation;
+    };
+
+    /// Lets go of renderable_list's renderables, on buffer_release's thread if there is one
+    void release_renderables();
+
+    /// The area of the output that differs from the previous frame, or nullopt if that's unknown
+    auto damage_since_last_frame(graphics::RenderableList const& renderables)
+        -> std::experimental::optional<geometry::Rectangles>;
+
     graphics::DisplayBuffer& display_buffer;
     std::shared_ptr<renderer::Renderer> const renderer;
     std::shared_ptr<CompositorReport> const report;
+    std::shared_ptr<ScreenCapture> const screen_capture;
+    std::shared_ptr<BufferReleaseThread> const buffer_release;
+
+    graphics::RenderableList renderable_list;
+    std::vector<RenderedState> last_frame;
+    std::vector<RenderedState> previous_frame_storage;
+    std::experimental::optional<geometry::Rectangle> last_view_area;
+    glm::mat2 last_transformation;
+
+    /// Storage for the buffer IDs passed to tracepoints, reused from frame to frame
+    std::vector<unsigned int> traced_buffer_ids;
 };
 
 }
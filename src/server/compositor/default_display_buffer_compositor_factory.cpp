@@ -22,15 +22,19 @@
 #include "mir/graphics/display_buffer.h"
 
 #include "default_display_buffer_compositor.h"
+#include "buffer_release_thread.h"
 
 namespace mc = mir::compositor;
 namespace mg = mir::graphics;
 
 mc::DefaultDisplayBufferCompositorFactory::DefaultDisplayBufferCompositorFactory(
     std::shared_ptr<mir::renderer::RendererFactory> const& renderer_factory,
-    std::shared_ptr<mc::CompositorReport> const& report) :
+    std::shared_ptr<mc::CompositorReport> const& report,
+    std::shared_ptr<ScreenCapture> const& screen_capture) :
     renderer_factory{renderer_factory},
-    report{report}
+    report{report},
+    screen_capture{screen_capture},
+    buffer_release{std::make_shared<BufferReleaseThread>()}
 {
 }
 
@@ -40,5 +44,5 @@ mc::DefaultDisplayBufferCompositorFactory::create_compositor_for(
 {
     auto renderer = renderer_factory->create_renderer_for(display_buffer);
     return std::make_unique<DefaultDisplayBufferCompositor>(
-         display_buffer, std::move(renderer), report);
+         display_buffer, std::move(renderer), report, screen_capture, buffer_release);
 }
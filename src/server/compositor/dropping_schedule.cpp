@@ -29,25 +29,25 @@ mc::DroppingSchedule::DroppingSchedule()
 
 void mc::DroppingSchedule::schedule(std::shared_ptr<mg::Buffer> const& buffer)
 {
-    std::lock_guard<decltype(mutex)> lk(mutex);
-    the_only_buffer = buffer;
+    slots[back] = buffer;
+    auto const previous = mailbox.exchange(back | fresh, std::memory_order_acq_rel);
+    back = previous & index_mask;
+
+    // The consumer never took what we put there last time, so drop it
+    slots[back] = nullptr;
 }
 
 unsigned int mc::DroppingSchedule::num_scheduled()
 {
-    std::lock_guard<decltype(mutex)> lk(mutex);
-    if (the_only_buffer)
-        return 1;
-    else
-        return 0;
+    return (mailbox.load(std::memory_order_acquire) & fresh) ? 1 : 0;
 }
 
 std::shared_ptr<mg::Buffer> mc::DroppingSchedule::next_buffer()
 {
-    std::lock_guard<decltype(mutex)> lk(mutex);
-    if (!the_only_buffer)
+    if (!(mailbox.load(std::memory_order_acquire) & fresh))
         BOOST_THROW_EXCEPTION(std::logic_error("no buffer scheduled"));
-    auto buffer = the_only_buffer;
-    the_only_buffer = nullptr;
-    return buffer;
+
+    auto const previous = mailbox.exchange(front, std::memory_order_acq_rel);
+    front = previous & index_mask;
+    return std::move(slots[front]);
 }
@@ -19,14 +19,22 @@
 #ifndef MIR_COMPOSITOR_DROPPING_SCHEDULE_H_
 #define MIR_COMPOSITOR_DROPPING_SCHEDULE_H_
 #include "schedule.h"
+#include <atomic>
 #include <memory>
-#include <mutex>
 
 namespace mir
 {
 namespace graphics { class Buffer; }
 namespace compositor
 {
+/**
+ * A lock-free mailbox holding the most recently scheduled buffer
+ *
+ * There are three slots: the producer fills "back", the consumer empties "front", and the third sits in the mailbox,
+ * swapped atomically with either side. A producer swapping in its slot over one the consumer hasn't taken drops the
+ * buffer there. schedule() must be serialized with itself, and next_buffer() with itself, but the two sides never
+ * wait on each other; num_scheduled() may be called from anywhere.
+ */
 class DroppingSchedule : public Schedule
 {
 public:
@@ -36,8 +44,13 @@ public:
     std::shared_ptr<graphics::Buffer> next_buffer() override;
 
 private:
-    std::mutex mutable mutex;
-    std::shared_ptr<graphics::Buffer> the_only_buffer;
+    static unsigned int const index_mask = 0x3;
+    static unsigned int const fresh = 0x4;
+
+    std::shared_ptr<graphics::Buffer> slots[3];
+    unsigned int back{0};               ///< Only touched by the producer
+    std::atomic<unsigned int> mailbox{1};
+    unsigned int front{2};              ///< Only touched by the consumer
 };
 }
 }
@@ -93,6 +93,15 @@ void mc::MultiMonitorArbiter::set_schedule(std::shared_ptr<Schedule> const& new_
     schedule = new_schedule;
 }
 
+void mc::MultiMonitorArbiter::transfer_schedule(std::shared_ptr<Schedule> const& new_schedule)
+{
+    // Draining the old schedule is a consumer's job, so it needs the same lock as compositor_acquire()
+    std::lock_guard<decltype(mutex)> lk(mutex);
+    while (schedule->num_scheduled() > 0)
+        new_schedule->schedule(schedule->next_buffer());
+    schedule = new_schedule;
+}
+
 bool mc::MultiMonitorArbiter::buffer_ready_for(mc::CompositorID id)
 {
     std::lock_guard<decltype(mutex)> lk(mutex);
@@ -117,6 +126,17 @@ void mc::MultiMonitorArbiter::advance_schedule()
     } 
 }
 
+void mc::MultiMonitorArbiter::advance_to_latest()
+{
+    std::lock_guard<decltype(mutex)> lk(mutex);
+    if (schedule->num_scheduled() > 0)
+    {
+        while (schedule->num_scheduled() > 0)
+            current_buffer = schedule->next_buffer();
+        clear_current_users();
+    }
+}
+
 void mc::MultiMonitorArbiter::add_current_buffer_user(mc::CompositorID id)
 {
     // First try and find an empty slot in our vector…
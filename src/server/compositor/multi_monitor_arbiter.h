@@ -44,8 +44,12 @@ public:
     std::shared_ptr<graphics::Buffer> compositor_acquire(compositor::CompositorID id) override;
     std::shared_ptr<graphics::Buffer> snapshot_acquire() override;
     void set_schedule(std::shared_ptr<Schedule> const& schedule);
+    /// Moves anything scheduled but not yet acquired onto new_schedule, then uses that
+    void transfer_schedule(std::shared_ptr<Schedule> const& new_schedule);
     bool buffer_ready_for(compositor::CompositorID id);
     void advance_schedule();
+    /// Makes the newest scheduled buffer (if any) current, dropping those scheduled before it
+    void advance_to_latest();
 
 private:
     void add_current_buffer_user(compositor::CompositorID id);
@@ -24,6 +24,9 @@
 #include "mir/compositor/display_listener.h"
 #include "mir/compositor/scene.h"
 #include "mir/compositor/compositor_report.h"
+#include "mir/compositor/scene_element.h"
+#include "mir/graphics/renderable.h"
+#include "mir/graphics/buffer.h"
 #include "mir/scene/legacy_scene_change_notification.h"
 #include "mir/scene/surface_observer.h"
 #include "mir/scene/surface.h"
@@ -31,10 +34,17 @@
 #include "mir/raii.h"
 #include "mir/unwind_helpers.h"
 #include "mir/thread_name.h"
+#include "mir/thread_scheduling.h"
+#include "mir/thread/executor_batch.h"
+#include "compositor_frame.tp.h"
 
+#include <algorithm>
+#include <functional>
 #include <thread>
 #include <chrono>
 #include <condition_variable>
+#include <exception>
+#include <mutex>
 #include <boost/throw_exception.hpp>
 
 using namespace std::literals::chrono_literals;
@@ -43,6 +53,185 @@ namespace mc = mir::compositor;
 namespace mg = mir::graphics;
 namespace ms = mir::scene;
 
+namespace
+{
+/// What a display buffer showed for a frame, in enough detail to tell whether it would change
+struct FrameFingerprint
+{
+    struct RenderableState
+    {
+        mg::Renderable::ID id;
+        mg::BufferID buffer;
+        mir::geometry::Rectangle position;
+        std::experimental::optional<mir::geometry::Rectangle> clip_area;
+        float alpha;
+        glm::mat4 transformation;
+        bool shaped;
+
+        bool operator==(RenderableState const& other) const
+        {
+            return id == other.id &&
+                   buffer == other.buffer &&
+                   position == other.position &&
+                   clip_area == other.clip_area &&
+                   alpha == other.alpha &&
+                   transformation == other.transformation &&
+                   shaped == other.shaped;
+        }
+    };
+
+    FrameFingerprint(mg::DisplayBuffer const& display_buffer, mc::SceneElementSequence const& elements)
+        : view_area{display_buffer.view_area()},
+          transformation{display_buffer.transformation()}
+    {
+        renderables.reserve(elements.size());
+        for (auto const& element : elements)
+        {
+            auto const renderable = element->renderable();
+            auto const buffer = renderable->buffer();
+            renderables.push_back({
+                renderable->id(),
+                buffer ? buffer->id() : mg::BufferID{},
+                renderable->screen_position(),
+                renderable->clip_area(),
+                renderable->alpha(),
+                renderable->transformation(),
+                renderable->shaped()});
+        }
+    }
+
+    bool operator==(FrameFingerprint const& other) const
+    {
+        return view_area == other.view_area &&
+               transformation == other.transformation &&
+               renderables == other.renderables;
+    }
+
+    mir::geometry::Rectangle view_area;
+    glm::mat2 transformation;
+    std::vector<RenderableState> renderables;
+};
+
+/*
+ * Composites an output of a group on a thread of its own, so that the group's outputs
+ * render at the same time rather than one after another. The wrapped compositor is
+ * created, used and destroyed on that thread, as it leaves its output's GL context
+ * current there.
+ */
+class OutputThreadCompositor : public mc::DisplayBufferCompositor
+{
+public:
+    OutputThreadCompositor(
+        mc::DisplayBufferCompositorFactory& factory,
+        mg::DisplayBuffer& buffer,
+        mir::ThreadScheduling const& thread_scheduling) :
+        thread{[this, thread_scheduling] { run(thread_scheduling); }}
+    {
+        try
+        {
+            start([&] { wrapped = factory.create_compositor_for(buffer); });
+            finish_compositing();
+        }
+        catch (...)
+        {
+            stop();
+            throw;
+        }
+    }
+
+    ~OutputThreadCompositor()
+    {
+        start([this] { wrapped.reset(); });
+        stop();
+    }
+
+    void composite(mc::SceneElementSequence&& scene_sequence) override
+    {
+        start_compositing(std::move(scene_sequence));
+        finish_compositing();
+    }
+
+    void start_compositing(mc::SceneElementSequence&& scene_sequence)
+    {
+        start([this, frame = std::move(scene_sequence)]() mutable { wrapped->composite(std::move(frame)); });
+    }
+
+    /// Waits for the work begun by start_compositing(), rethrowing anything it threw
+    void finish_compositing()
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        done_cv.wait(lock, [this] { return !work; });
+
+        if (auto const error = std::exchange(work_error, nullptr))
+            std::rethrow_exception(error);
+    }
+
+private:
+    /// Gives the thread new work, once it has finished what it was doing
+    void start(std::function<void()>&& new_work)
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        done_cv.wait(lock, [this] { return !work; });
+        work = std::move(new_work);
+        work_cv.notify_one();
+    }
+
+    /// Joins the thread once it has done any work it has been given
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            exiting = true;
+            work_cv.notify_one();
+        }
+        thread.join();
+    }
+
+    void run(mir::ThreadScheduling const& thread_scheduling) noexcept
+    {
+        mir::set_thread_name("Mir/Comp");
+        apply_thread_scheduling(thread_scheduling, "Mir/Comp");
+
+        std::unique_lock<std::mutex> lock{mutex};
+        for (;;)
+        {
+            work_cv.wait(lock, [this] { return work || exiting; });
+
+            if (work)
+            {
+                lock.unlock();
+                std::exception_ptr error;
+                try
+                {
+                    work();
+                }
+                catch (...)
+                {
+                    error = std::current_exception();
+                }
+                lock.lock();
+                work = nullptr;
+                work_error = error;
+                done_cv.notify_one();
+            }
+            else
+            {
+                return;
+            }
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable work_cv;
+    std::condition_variable done_cv;
+    std::function<void()> work;
+    std::exception_ptr work_error;
+    bool exiting{false};
+    std::unique_ptr<mc::DisplayBufferCompositor> wrapped;
+    std::thread thread;
+};
+}
+
 namespace mir
 {
 namespace compositor
@@ -57,7 +246,8 @@ public:
         std::shared_ptr<mc::Scene> const& scene,
         std::shared_ptr<DisplayListener> const& display_listener,
         std::chrono::milliseconds fixed_composite_delay,
-        std::shared_ptr<CompositorReport> const& report) :
+        std::shared_ptr<CompositorReport> const& report,
+        ThreadScheduling const& thread_scheduling) :
         compositor_factory{db_compositor_factory},
         group(group),
         scene(scene),
@@ -66,6 +256,7 @@ public:
         force_sleep{fixed_composite_delay},
         display_listener{display_listener},
         report{report},
+        thread_scheduling{thread_scheduling},
         started_future{started.get_future()}
     {
     }
@@ -74,13 +265,26 @@ public:
     try
     {
         mir::set_thread_name("Mir/Comp");
+        apply_thread_scheduling(thread_scheduling, "Mir/Comp");
 
         std::vector<std::tuple<mg::DisplayBuffer*, std::unique_ptr<mc::DisplayBufferCompositor>>> compositors;
+        // The outputs after the first, which (each having its own context) render on their own threads
+        std::vector<OutputThreadCompositor*> output_threads;
         group.for_each_display_buffer(
-        [this, &compositors](mg::DisplayBuffer& buffer)
+        [this, &compositors, &output_threads](mg::DisplayBuffer& buffer)
         {
-            compositors.emplace_back(
-                std::make_tuple(&buffer, compositor_factory->create_compositor_for(buffer)));
+            if (compositors.empty())
+            {
+                compositors.emplace_back(
+                    std::make_tuple(&buffer, compositor_factory->create_compositor_for(buffer)));
+            }
+            else
+            {
+                auto output_thread = std::make_unique<OutputThreadCompositor>(
+                    *compositor_factory, buffer, thread_scheduling);
+                output_threads.push_back(output_thread.get());
+                compositors.emplace_back(std::make_tuple(&buffer, std::move(output_thread)));
+            }
 
             auto const& r = buffer.view_area();
             auto const comp_id = std::get<1>(compositors.back()).get();
@@ -101,7 +305,10 @@ public:
             [this,&compositors]
             {
                 for (auto& compositor : compositors)
+                {
                     scene->register_compositor(std::get<1>(compositor).get());
+                    compositor_ids.push_back(std::get<1>(compositor).get());
+                }
             },
             [this,&compositors]{
                 for (auto& compositor : compositors)
@@ -112,11 +319,15 @@ public:
 
         try
         {
+            std::vector<FrameFingerprint> last_fingerprints;
+            // Numbers the frames the traces follow a buffer through
+            uint64_t frame_number = 0;
+            std::vector<unsigned int> traced_buffer_ids;
             std::unique_lock<std::mutex> lock{run_mutex};
             while (running)
             {
-                /* Wait until compositing has been scheduled or we are stopped */
-                run_cv.wait(lock, [&]{ return (frames_scheduled > 0) || !running; });
+                /* Wait until compositing has been scheduled (and we aren't paused or suspended) or we are stopped */
+                run_cv.wait(lock, [&]{ return (frames_scheduled > 0 && !paused && !suspended) || !running; });
 
                 /*
                  * Check if we are running before compositing, since we may have
@@ -133,27 +344,124 @@ public:
                      */
                     frames_scheduled--;
                     not_posted_yet = false;
-                    lock.unlock();
-
-                    for (auto& tuple : compositors)
+                    compositing = true;
+                    if (repaint_needed)
                     {
-                        auto& compositor = std::get<1>(tuple);
-                        compositor->composite(scene->scene_elements_for(compositor.get()));
+                        last_fingerprints.clear();
+                        repaint_needed = false;
                     }
-                    group.post();
+                    lock.unlock();
 
                     /*
                      * "Predictive bypass" optimization: If the last frame was
                      * bypassed/overlayed or you simply have a fast GPU, it is
-                     * beneficial to sleep for most of the next frame. This reduces
-                     * the latency between snapshotting the scene and post()
-                     * completing by almost a whole frame.
+                     * beneficial to sleep for most of the next frame. Doing so
+                     * just before sampling the scene latches the newest buffers
+                     * clients have submitted by then (a fullscreen client's in
+                     * particular) rather than those ready when the frame was
+                     * scheduled, even when this frame follows an idle spell.
                      */
                     auto delay = force_sleep >= std::chrono::milliseconds::zero() ?
                                  force_sleep : group.recommended_sleep();
                     std::this_thread::sleep_for(delay);
 
+                    /*
+                     * Consuming and compositing buffers releases their predecessors
+                     * and readies frame callbacks; hand that work to the frontend in
+                     * one go rather than a work item per surface.
+                     */
+                    auto composite_batch = std::make_unique<mir::thread::ExecutorBatch>();
+
+                    std::vector<mc::SceneElementSequence> frames;
+                    std::vector<FrameFingerprint> fingerprints;
+                    for (auto& tuple : compositors)
+                    {
+                        auto& compositor = std::get<1>(tuple);
+                        frames.push_back(scene->scene_elements_for(compositor.get(), std::get<0>(tuple)->view_area()));
+                        fingerprints.emplace_back(*std::get<0>(tuple), frames.back());
+                    }
+
+                    /*
+                     * If the group would show exactly what it is already showing
+                     * there's no need to wake the GPU to render and post it again.
+                     */
+                    if (fingerprints == last_fingerprints)
+                    {
+                        composite_batch.reset();
+                        lock.lock();
+                        finished_frame();
+                        continue;
+                    }
+
+                    // Not the elements themselves, as they'd keep the buffers from their clients until after post()
+                    std::vector<std::pair<SceneElement::PresentationCallback, geometry::Rectangle>> presentation_callbacks;
+                    for (auto i = 0u; i != compositors.size(); ++i)
+                    {
+                        auto const output_area = std::get<0>(compositors[i])->view_area();
+                        for (auto const& element : frames[i])
+                        {
+                            if (auto callback = element->presentation_callback())
+                                presentation_callbacks.emplace_back(std::move(callback), output_area);
+                        }
+                    }
+
+                    ++frame_number;
+                    if (tracepoint_enabled(mir_server_frame, scene_snapshot))
+                    {
+                        for (auto i = 0u; i != compositors.size(); ++i)
+                        {
+                            traced_buffer_ids.clear();
+                            for (auto const& element : frames[i])
+                                traced_buffer_ids.push_back(element->renderable()->buffer()->id().as_value());
+                            do_tracepoint(
+                                mir_server_frame, scene_snapshot, std::get<0>(compositors[i]), frame_number,
+                                traced_buffer_ids.data(), traced_buffer_ids.size());
+                        }
+                    }
+
+                    /*
+                     * The outputs of a group (in clone mode, say) render at once,
+                     * each on its own thread, so their render times don't add up.
+                     * They all finish before post() so the group still posts together.
+                     */
+                    for (auto i = 0u; i != output_threads.size(); ++i)
+                    {
+                        output_threads[i]->start_compositing(std::move(frames[i + 1]));
+                    }
+                    std::get<1>(compositors.front())->composite(std::move(frames.front()));
+                    for (auto const output_thread : output_threads)
+                    {
+                        output_thread->finish_compositing();
+                    }
+                    composite_batch.reset();
+
+                    for (auto const& compositor : compositors)
+                        tracepoint(mir_server_frame, post_started, std::get<0>(compositor), frame_number);
+
+                    {
+                        // Likewise the buffers post() lets go of, and presentation reports
+                        mir::thread::ExecutorBatch const post_batch;
+
+                        group.post();
+
+                        if (!presentation_callbacks.empty() || tracepoint_enabled(mir_server_frame, presented))
+                        {
+                            auto const frame = group.last_frame();
+                            for (auto const& callback : presentation_callbacks)
+                                callback.first(frame, callback.second);
+
+                            for (auto const& compositor : compositors)
+                            {
+                                tracepoint(
+                                    mir_server_frame, presented, std::get<0>(compositor), frame_number,
+                                    frame.msc, frame.ust.nanoseconds.count());
+                            }
+                        }
+                    }
+                    last_fingerprints = std::move(fingerprints);
+
                     lock.lock();
+                    finished_frame();
 
                     /*
                      * Note the compositor may have chosen to ignore any number
@@ -222,6 +530,39 @@ public:
         run_cv.notify_one();
     }
 
+    /// Stops compositing, once any frame in progress has been posted, keeping the compositors
+    void pause()
+    {
+        hold(paused);
+    }
+
+    void resume()
+    {
+        release(paused);
+    }
+
+    /// Stops compositing like pause(), and as our outputs show nothing meanwhile, leaves the scene without us
+    void suspend()
+    {
+        hold(suspended);
+
+        for (auto const id : compositor_ids)
+            scene->unregister_compositor(id);
+    }
+
+    void unsuspend()
+    {
+        for (auto const id : compositor_ids)
+            scene->register_compositor(id);
+
+        release(suspended);
+    }
+
+    bool composites(mg::DisplaySyncGroup const& other) const
+    {
+        return &group == &other;
+    }
+
     void wait_until_started()
     {
         if (started_future.wait_for(10s) != std::future_status::ready)
@@ -231,6 +572,31 @@ public:
     }
 
 private:
+    void hold(bool& reason)
+    {
+        std::unique_lock<std::mutex> lock{run_mutex};
+        reason = true;
+        idle_cv.wait(lock, [this]{ return !compositing; });
+    }
+
+    void release(bool& reason)
+    {
+        std::lock_guard<std::mutex> lock{run_mutex};
+        reason = false;
+        // What we last posted may not be what's on screen any more
+        repaint_needed = true;
+        if (frames_scheduled < 1)
+            frames_scheduled = 1;
+        run_cv.notify_one();
+    }
+
+    /// Called with run_mutex held
+    void finished_frame()
+    {
+        compositing = false;
+        idle_cv.notify_all();
+    }
+
     std::shared_ptr<mc::DisplayBufferCompositorFactory> const compositor_factory;
     mg::DisplaySyncGroup& group;
     std::shared_ptr<mc::Scene> const scene;
@@ -241,9 +607,17 @@ private:
     std::condition_variable run_cv;
     std::shared_ptr<DisplayListener> const display_listener;
     std::shared_ptr<CompositorReport> const report;
+    ThreadScheduling const thread_scheduling;
     std::promise<void> started;
     std::future<void> started_future;
     bool not_posted_yet = true;
+    bool paused{false};
+    bool suspended{false};
+    bool compositing{false};
+    bool repaint_needed{false};
+    std::condition_variable idle_cv;
+    /// Set before the thread has started, and unchanged after
+    std::vector<CompositorID> compositor_ids;
 };
 
 }
@@ -256,7 +630,8 @@ mc::MultiThreadedCompositor::MultiThreadedCompositor(
     std::shared_ptr<DisplayListener> const& display_listener,
     std::shared_ptr<CompositorReport> const& compositor_report,
     std::chrono::milliseconds fixed_composite_delay,
-    bool compose_on_start)
+    bool compose_on_start,
+    ThreadScheduling const& thread_scheduling)
     : display{display},
       scene{scene},
       display_buffer_compositor_factory{db_compositor_factory},
@@ -265,6 +640,7 @@ mc::MultiThreadedCompositor::MultiThreadedCompositor(
       state{CompositorState::stopped},
       fixed_composite_delay{fixed_composite_delay},
       compose_on_start{compose_on_start},
+      thread_scheduling{thread_scheduling},
       thread_pool{1}
 {
     observer = std::make_shared<ms::LegacySceneChangeNotification>(
@@ -286,6 +662,7 @@ mc::MultiThreadedCompositor::~MultiThreadedCompositor()
 void mc::MultiThreadedCompositor::schedule_compositing(int num)
 {
     report->scheduled();
+    std::lock_guard<std::mutex> lock{threads_mutex};
     for (auto& f : thread_functors)
         f->schedule_compositing(num);
 }
@@ -293,6 +670,7 @@ void mc::MultiThreadedCompositor::schedule_compositing(int num)
 void mc::MultiThreadedCompositor::schedule_compositing(int num, geometry::Rectangle const& damage) const
 {
     report->scheduled();
+    std::lock_guard<std::mutex> lock{threads_mutex};
     for (auto& f : thread_functors)
         f->schedule_compositing(num, damage);
 }
@@ -331,20 +709,23 @@ void mc::MultiThreadedCompositor::start()
 
 void mc::MultiThreadedCompositor::stop()
 {
-    auto started = CompositorState::started;
+    auto previous = CompositorState::started;
 
-    if (!state.compare_exchange_strong(started, CompositorState::stopping))
+    if (!state.compare_exchange_strong(previous, CompositorState::stopping) &&
+        !(previous == CompositorState::paused && state.compare_exchange_strong(previous, CompositorState::stopping)))
+    {
         return;
+    }
 
     /* To cleanup state if any code below throws */
-    auto cleanup_if_unwinding = on_unwind([this]
+    auto cleanup_if_unwinding = on_unwind([this, previous]
         {
             // https://gcc.gnu.org/bugzilla/show_bug.cgi?id=62258
             // After using rethrow_exception() (and catching the exception),
             // all subsequent calls to uncaught_exception() return `true'.
             if (state == CompositorState::stopped) return;
 
-            state = CompositorState::started;
+            state = previous;
         });
 
     /* Remove the observer before destroying the compositing threads */
@@ -361,33 +742,154 @@ void mc::MultiThreadedCompositor::stop()
     state = CompositorState::stopped;
 }
 
+void mc::MultiThreadedCompositor::pause()
+{
+    auto started = CompositorState::started;
+
+    if (!state.compare_exchange_strong(started, CompositorState::paused))
+        return;
+
+    /*
+     * Unlike stop() the threads, with their renderers (and the programs and
+     * textures those have built up), stay for resume().
+     *
+     * Display configuration is paused along with us, so the functors stay put
+     * while we wait for them outside the lock compositing may need.
+     */
+    std::vector<CompositingFunctor*> pausing;
+    {
+        std::lock_guard<std::mutex> lock{threads_mutex};
+        for (auto const& f : thread_functors)
+            pausing.push_back(f.get());
+    }
+
+    for (auto const f : pausing)
+        f->pause();
+}
+
+void mc::MultiThreadedCompositor::resume()
+{
+    auto paused = CompositorState::paused;
+
+    if (!state.compare_exchange_strong(paused, CompositorState::started))
+        return;
+
+    report->scheduled();
+    std::lock_guard<std::mutex> lock{threads_mutex};
+    for (auto& f : thread_functors)
+        f->resume();
+}
+
+void mc::MultiThreadedCompositor::stop_compositing(mg::DisplaySyncGroup& group)
+{
+    std::unique_ptr<CompositingFunctor> functor;
+    std::future<void> future;
+    {
+        std::lock_guard<std::mutex> lock{threads_mutex};
+        auto const i = std::find_if(thread_functors.begin(), thread_functors.end(),
+            [&group](auto const& f) { return f->composites(group); });
+        if (i == thread_functors.end())
+            return;
+
+        auto const index = i - thread_functors.begin();
+        functor = std::move(*i);
+        future = std::move(futures[index]);
+        thread_functors.erase(i);
+        futures.erase(futures.begin() + index);
+    }
+
+    // The other groups carry on compositing meanwhile
+    functor->stop();
+    future.wait();
+}
+
+void mc::MultiThreadedCompositor::start_compositing_new_groups()
+{
+    if (state != CompositorState::started)
+        return;
+
+    auto const started = start_compositing_threads_for_new_groups();
+
+    // There's nothing on the new groups yet
+    if (!started.empty())
+        report->scheduled();
+    for (auto const functor : started)
+        functor->schedule_compositing(1);
+}
+
+void mc::MultiThreadedCompositor::suspend_compositing(mg::DisplaySyncGroup& group)
+{
+    // As for pause(), only display configuration changes the functors, so this one stays put
+    if (auto const functor = functor_for(group))
+        functor->suspend();
+}
+
+void mc::MultiThreadedCompositor::resume_compositing(mg::DisplaySyncGroup& group)
+{
+    if (auto const functor = functor_for(group))
+    {
+        report->scheduled();
+        functor->unsuspend();
+    }
+}
+
 void mc::MultiThreadedCompositor::create_compositing_threads()
 {
+    start_compositing_threads_for_new_groups();
+}
+
+auto mc::MultiThreadedCompositor::start_compositing_threads_for_new_groups() -> std::vector<CompositingFunctor*>
+{
+    std::vector<CompositingFunctor*> started;
+
     /* Start the display buffer compositing threads */
-    display->for_each_display_sync_group([this](mg::DisplaySyncGroup& group)
+    display->for_each_display_sync_group([this, &started](mg::DisplaySyncGroup& group)
     {
+        std::lock_guard<std::mutex> lock{threads_mutex};
+        if (std::any_of(thread_functors.begin(), thread_functors.end(),
+                        [&group](auto const& f) { return f->composites(group); }))
+        {
+            return;
+        }
+
         auto thread_functor = std::make_unique<mc::CompositingFunctor>(
             display_buffer_compositor_factory, group, scene, display_listener,
-            fixed_composite_delay, report);
+            fixed_composite_delay, report, thread_scheduling);
 
         futures.push_back(thread_pool.run(std::ref(*thread_functor), &group));
+        started.push_back(thread_functor.get());
         thread_functors.push_back(std::move(thread_functor));
     });
 
     thread_pool.shrink();
 
-    for (auto& functor : thread_functors)
+    for (auto const functor : started)
         functor->wait_until_started();
+
+    return started;
+}
+
+auto mc::MultiThreadedCompositor::functor_for(mg::DisplaySyncGroup const& group) const -> CompositingFunctor*
+{
+    std::lock_guard<std::mutex> lock{threads_mutex};
+    auto const i = std::find_if(thread_functors.begin(), thread_functors.end(),
+        [&group](auto const& f) { return f->composites(group); });
+    return i != thread_functors.end() ? i->get() : nullptr;
 }
 
 void mc::MultiThreadedCompositor::destroy_compositing_threads()
 {
-    for (auto& f : thread_functors)
+    decltype(thread_functors) stopping_functors;
+    decltype(futures) stopping_futures;
+    {
+        std::lock_guard<std::mutex> lock{threads_mutex};
+        std::swap(stopping_functors, thread_functors);
+        std::swap(stopping_futures, futures);
+    }
+
+    for (auto& f : stopping_functors)
         f->stop();
 
-    for (auto& f : futures)
+    for (auto& f : stopping_futures)
         f.wait();
-
-    thread_functors.clear();
-    futures.clear();
 }
@@ -21,6 +21,7 @@
 
 #include "mir/compositor/compositor.h"
 #include "mir/thread/basic_thread_pool.h"
+#include "mir/thread_scheduling.h"
 
 #include <mutex>
 #include <memory>
@@ -35,6 +36,7 @@ namespace geometry { struct Rectangle; }
 namespace graphics
 {
 class Display;
+class DisplaySyncGroup;
 }
 namespace scene
 {
@@ -55,7 +57,8 @@ enum class CompositorState
     started,
     stopped,
     starting,
-    stopping
+    stopping,
+    paused
 };
 
 class MultiThreadedCompositor : public Compositor
@@ -68,15 +71,27 @@ public:
         std::shared_ptr<DisplayListener> const& display_listener,
         std::shared_ptr<CompositorReport> const& compositor_report,
         std::chrono::milliseconds fixed_composite_delay,  // -1 = automatic
-        bool compose_on_start);
+        bool compose_on_start,
+        ThreadScheduling const& thread_scheduling = {});
     ~MultiThreadedCompositor();
 
     void start();
     void stop();
+    void pause();
+    void resume();
+
+    void stop_compositing(graphics::DisplaySyncGroup& group);
+    void start_compositing_new_groups();
+    void suspend_compositing(graphics::DisplaySyncGroup& group);
+    void resume_compositing(graphics::DisplaySyncGroup& group);
 
 private:
     void create_compositing_threads();
     void destroy_compositing_threads();
+    /// Starts threads for the display's sync groups we don't have one for, returning their functors
+    auto start_compositing_threads_for_new_groups() -> std::vector<CompositingFunctor*>;
+    /// The functor compositing \a group, if any
+    auto functor_for(graphics::DisplaySyncGroup const& group) const -> CompositingFunctor*;
 
     std::shared_ptr<graphics::Display> const display;
     std::shared_ptr<Scene> const scene;
@@ -84,12 +99,15 @@ private:
     std::shared_ptr<DisplayListener> const display_listener;
     std::shared_ptr<CompositorReport> const report;
 
+    /// Guards thread_functors and futures, which change while scene observers are scheduling compositing
+    std::mutex mutable threads_mutex;
     std::vector<std::unique_ptr<CompositingFunctor>> thread_functors;
     std::vector<std::future<void>> futures;
 
     std::atomic<CompositorState> state;
     std::chrono::milliseconds fixed_composite_delay;
     bool compose_on_start;
+    ThreadScheduling const thread_scheduling;
 
     void schedule_compositing(int number_composites);
     void schedule_compositing(int number_composites, geometry::Rectangle const& damage) const;
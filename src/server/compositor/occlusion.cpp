@@ -16,11 +16,12 @@
  * Authored by: Daniel van Vugt <daniel.van.vugt@canonical.com>
  */
 
-#include "mir/geometry/rectangle.h"
+#include "mir/geometry/region.h"
 #include "mir/compositor/scene_element.h"
 #include "mir/graphics/renderable.h"
 #include "occlusion.h"
 
+#include <algorithm>
 #include <vector>
 
 using namespace mir::geometry;
@@ -32,7 +33,7 @@ namespace
 bool renderable_is_occluded(
     Renderable const& renderable, 
     Rectangle const& area,
-    std::vector<Rectangle>& coverage)
+    Region& coverage)
 {
     static glm::mat4 const identity(1);
     static Rectangle const empty{};
@@ -46,20 +47,26 @@ bool renderable_is_occluded(
     if (clipped_window == empty)
         return true;  // Not in the area; definitely occluded.
 
-    bool occluded = false;
-    for (auto const& r : coverage)
+    if (coverage.contains(clipped_window))
+        return true;
+
+    if (renderable.alpha() == 1.0f)
     {
-        if (r.contains(clipped_window))
+        // Only what is actually drawn can hide anything
+        auto const drawn = renderable.clip_area() ?
+            clipped_window.intersection_with(renderable.clip_area().value()) : clipped_window;
+
+        if (!renderable.shaped())
         {
-            occluded = true;
-            break;
+            coverage |= drawn;
+        }
+        else
+        {
+            coverage |= Region{renderable.opaque_region()} & drawn;
         }
     }
 
-    if (!occluded && renderable.alpha() == 1.0f && !renderable.shaped())
-        coverage.push_back(clipped_window);
-
-    return occluded;
+    return false;
 }
 }
 
@@ -68,7 +75,7 @@ SceneElementSequence mir::compositor::filter_occlusions_from(
     Rectangle const& area)
 {
     SceneElementSequence occluded;
-    std::vector<Rectangle> coverage;
+    Region coverage;
 
     auto it = elements.rbegin();
     while (it != elements.rend())
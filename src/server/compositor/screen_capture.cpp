@@ -0,0 +1,171 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/compositor/screen_capture.h"
+#include "mir/renderer/renderer.h"
+
+#include <atomic>
+
+namespace mc = mir::compositor;
+namespace geom = mir::geometry;
+
+struct mc::ScreenCapture::Pending
+{
+    Pending(geom::Rectangle const& area, bool with_damage, Callback const& callback) :
+        area{area},
+        with_damage{with_damage},
+        callback{callback}
+    {
+    }
+
+    geom::Rectangle const area;
+    bool const with_damage;
+    Callback const callback;
+
+    /// Accumulated (relative to area) while the capture waits. Guarded by the ScreenCapture mutex.
+    geom::Rectangles damage;
+
+    /// Held while delivering, so that cancelling waits for a callback in progress
+    std::mutex delivery_mutex;
+    std::atomic<bool> cancelled{false};
+};
+
+class mc::ScreenCapture::PendingRequest : public Request
+{
+public:
+    explicit PendingRequest(std::shared_ptr<Pending> const& capture) :
+        capture{capture}
+    {
+    }
+
+    ~PendingRequest() override
+    {
+        std::lock_guard<std::mutex> lock{capture->delivery_mutex};
+        capture->cancelled = true;
+    }
+
+private:
+    std::shared_ptr<Pending> const capture;
+};
+
+mc::ScreenCapture::ScreenCapture(std::function<void()> const& schedule_frame) :
+    schedule_frame{schedule_frame}
+{
+}
+
+mc::ScreenCapture::~ScreenCapture() = default;
+
+auto mc::ScreenCapture::capture(geom::Rectangle const& area, bool with_damage, Callback const& callback)
+    -> std::unique_ptr<Request>
+{
+    auto const capture = std::make_shared<Pending>(area, with_damage, callback);
+
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        pending.push_back(capture);
+    }
+
+    // A capture waiting for damage waits for the scene to change; anything else wants the next frame now
+    if (!with_damage)
+        schedule_frame();
+
+    return std::make_unique<PendingRequest>(capture);
+}
+
+auto mc::ScreenCapture::wants_frame_of(geom::Rectangle const& view_area) const -> bool
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    for (auto const& capture : pending)
+    {
+        if (!capture->cancelled && view_area.contains(capture->area))
+            return true;
+    }
+
+    return false;
+}
+
+void mc::ScreenCapture::prepare_frame(
+    geom::Rectangle const& view_area,
+    std::experimental::optional<geom::Rectangles> const& damage,
+    renderer::Renderer& renderer)
+{
+    std::vector<std::shared_ptr<Pending>> ready;
+
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+
+        for (auto i = pending.begin(); i != pending.end();)
+        {
+            auto const& capture = *i;
+
+            if (capture->cancelled)
+            {
+                i = pending.erase(i);
+                continue;
+            }
+
+            if (!view_area.contains(capture->area))
+            {
+                ++i;
+                continue;
+            }
+
+            auto const origin = as_displacement(capture->area.top_left);
+            if (damage)
+            {
+                for (auto const& rect : damage.value())
+                {
+                    auto const part = intersection_of(rect, capture->area);
+                    if (part.size.width.as_int() > 0 && part.size.height.as_int() > 0)
+                        capture->damage.add({part.top_left - origin, part.size});
+                }
+            }
+            else
+            {
+                capture->damage.add({{0, 0}, capture->area.size});
+            }
+
+            if (capture->with_damage && capture->damage.size() == 0)
+            {
+                ++i;
+                continue;
+            }
+
+            ready.push_back(capture);
+            i = pending.erase(i);
+        }
+    }
+
+    for (auto const& capture : ready)
+    {
+        renderer.read_next_frame(
+            capture->area,
+            [capture](geom::Size const& size, geom::Stride stride, void const* pixels)
+            {
+                std::lock_guard<std::mutex> lock{capture->delivery_mutex};
+                if (capture->cancelled)
+                    return;
+
+                capture->callback(Frame{
+                    size,
+                    stride,
+                    pixels,
+                    capture->damage,
+                    std::chrono::steady_clock::now().time_since_epoch()});
+            });
+    }
+}
@@ -21,7 +21,9 @@
 #include "queueing_schedule.h"
 #include "dropping_schedule.h"
 #include "mir/graphics/buffer.h"
+#include "compositor_frame.tp.h"
 #include <boost/throw_exception.hpp>
+#include <algorithm>
 
 namespace mc = mir::compositor;
 namespace geom = mir::geometry;
@@ -29,6 +31,13 @@ namespace mg = mir::graphics;
 namespace ms = mir::scene;
 namespace geom = mir::geometry;
 
+namespace
+{
+// Enough to cover the deepest buffer queue a client can build up between
+// two compositor acquisitions; anything older is treated as fully damaged.
+size_t const max_damage_history = 8;
+}
+
 enum class mc::Stream::ScheduleMode {
     Queueing,
     Dropping
@@ -42,7 +51,8 @@ mc::Stream::Stream(
     latest_buffer_size(size),
     pf(pf),
     first_frame_posted(false),
-    frame_callback{[](auto){}}
+    frame_callback{[](auto){}},
+    presented_callback{[](auto const&){}}
 {
 }
 
@@ -57,42 +67,159 @@ void mc::Stream::submit_buffer(std::shared_ptr<mg::Buffer> const& buffer)
         std::lock_guard<decltype(mutex)> lk(mutex);
         pf = buffer->pixel_format();
         latest_buffer_size = buffer->size();
+
+        {
+            // Recorded before the buffer is scheduled, so a compositor acquiring it can find its damage
+            std::lock_guard<decltype(damage_mutex)> damage_lock(damage_mutex);
+
+            // A dropping schedule holds one buffer, so one not yet taken by a compositor is never shown.
+            // (Compositors don't wait on us to take it, so this is only a good guess.)
+            if (schedule_mode == ScheduleMode::Dropping && schedule->num_scheduled() > 0 && !damage_history.empty())
+                tracepoint(mir_server_frame, buffer_dropped, this, damage_history.back().buffer.as_value());
+
+            damage_history.push_back({++submission_count, buffer->id(), std::move(pending_damage)});
+            pending_damage = std::experimental::nullopt;
+            if (damage_history.size() > max_damage_history)
+                damage_history.pop_front();
+        }
+
         schedule->schedule(buffer);
         first_frame_posted = true;
     }
     {
-        std::lock_guard<decltype(callback_mutex)> lock{callback_mutex};
+        std::lock_guard<decltype(frame_callback_mutex)> lock{frame_callback_mutex};
         frame_callback(buffer->size());
     }
 }
 
+void mc::Stream::add_damage(geom::Rectangles const& buffer_damage)
+{
+    std::lock_guard<decltype(damage_mutex)> lk(damage_mutex);
+    if (!pending_damage)
+        pending_damage = geom::Rectangles{};
+
+    for (auto const& rect : buffer_damage)
+        pending_damage.value().add(rect);
+}
+
+auto mc::Stream::submitted_damage() const -> std::experimental::optional<geom::Rectangles>
+{
+    std::lock_guard<decltype(damage_mutex)> lk(damage_mutex);
+    if (damage_history.empty())
+        return std::experimental::nullopt;
+    return damage_history.back().damage;
+}
+
 void mc::Stream::with_most_recent_buffer_do(std::function<void(mg::Buffer&)> const& fn)
 {
-    std::lock_guard<decltype(mutex)> lk(mutex);
     fn(*arbiter->snapshot_acquire());
 }
 
 MirPixelFormat mc::Stream::pixel_format() const
 {
-    std::lock_guard<decltype(mutex)> lk(mutex);
     return pf;
 }
 
 void mc::Stream::set_frame_posted_callback(
     std::function<void(geometry::Size const&)> const& callback)
 {
-    std::lock_guard<decltype(callback_mutex)> lock{callback_mutex};
+    std::lock_guard<decltype(frame_callback_mutex)> lock{frame_callback_mutex};
     frame_callback = callback;
 }
 
+void mc::Stream::set_frame_presented_callback(
+    std::function<void(Presentation const&)> const& callback)
+{
+    std::lock_guard<decltype(presented_callback_mutex)> lock{presented_callback_mutex};
+    presented_callback = callback;
+}
+
+void mc::Stream::frame_presented(Presentation const& presentation)
+{
+    std::lock_guard<decltype(presented_callback_mutex)> lock{presented_callback_mutex};
+    presented_callback(presentation);
+}
+
 std::shared_ptr<mg::Buffer> mc::Stream::lock_compositor_buffer(void const* id)
 {
-    return arbiter->compositor_acquire(id);
+    auto const buffer = arbiter->compositor_acquire(id);
+
+    std::lock_guard<decltype(damage_mutex)> lk(damage_mutex);
+
+    // Clients may resubmit a buffer, so the newest submission of it is the one we are showing
+    auto const submitted = std::find_if(
+        damage_history.rbegin(), damage_history.rend(),
+        [&buffer](SubmittedDamage const& entry) { return entry.buffer == buffer->id(); });
+    auto const submission = submitted != damage_history.rend() ? submitted->submission : 0;
+
+    auto& state = compositor_damage[id];
+    if (state.last_submission != submission || !submission)
+    {
+        // A compositor may lock the same buffer several times (e.g. for each
+        // output in a display group); only a new submission changes the damage.
+        state.damage = damage_between(state.last_submission, submission, lk);
+        state.last_submission = submission;
+    }
+
+    return buffer;
+}
+
+auto mc::Stream::buffer_damage(void const* user_id) const -> std::experimental::optional<geom::Rectangles>
+{
+    std::lock_guard<decltype(damage_mutex)> lk(damage_mutex);
+    auto const found = compositor_damage.find(user_id);
+    if (found == compositor_damage.end())
+        return std::experimental::nullopt;
+
+    return found->second.damage;
+}
+
+auto mc::Stream::damage_between(uint64_t from, uint64_t to, std::lock_guard<std::mutex> const&) const
+    -> std::experimental::optional<geom::Rectangles>
+{
+    // We don't know what happened since "from"
+    if (!from || !to || to < from || damage_history.empty() || damage_history.front().submission > from + 1)
+        return std::experimental::nullopt;
+
+    geom::Rectangles result;
+    for (auto const& entry : damage_history)
+    {
+        if (entry.submission <= from || entry.submission > to)
+            continue;
+
+        if (!entry.damage)
+            return std::experimental::nullopt;
+
+        for (auto const& rect : entry.damage.value())
+            result.add(rect);
+    }
+
+    return result;
+}
+
+void mc::Stream::set_opaque_region(geom::Rectangles const& region)
+{
+    std::lock_guard<decltype(mutex)> lk(mutex);
+    opaque_region_ = region;
+}
+
+auto mc::Stream::opaque_region() const -> geom::Rectangles
+{
+    std::lock_guard<decltype(mutex)> lk(mutex);
+    return opaque_region_;
 }
 
 geom::Size mc::Stream::stream_size()
 {
     std::lock_guard<decltype(mutex)> lk(mutex);
+    if (viewport_destination)
+        return viewport_destination.value();
+    if (viewport_source)
+    {
+        return geom::Size{
+            roundf(viewport_source.value().size.width.as_value()),
+            roundf(viewport_source.value().size.height.as_value())};
+    }
     return geom::Size{
         roundf(latest_buffer_size.width.as_int() / scale_),
         roundf(latest_buffer_size.height.as_int() / scale_)};
@@ -103,12 +230,14 @@ void mc::Stream::allow_framedropping(bool dropping)
     std::lock_guard<decltype(mutex)> lk(mutex);
     if (dropping && schedule_mode == ScheduleMode::Queueing)
     {
-        transition_schedule(std::make_shared<mc::DroppingSchedule>(), lk);
+        schedule = std::make_shared<mc::DroppingSchedule>();
+        arbiter->transfer_schedule(schedule);
         schedule_mode = ScheduleMode::Dropping;
     }
     else if (!dropping && schedule_mode == ScheduleMode::Dropping)
     {
-        transition_schedule(std::make_shared<mc::QueueingSchedule>(), lk);
+        schedule = std::make_shared<mc::QueueingSchedule>();
+        arbiter->transfer_schedule(schedule);
         schedule_mode = ScheduleMode::Queueing;
     }
 }
@@ -118,21 +247,8 @@ bool mc::Stream::framedropping() const
     return schedule_mode == ScheduleMode::Dropping;
 }
 
-void mc::Stream::transition_schedule(
-    std::shared_ptr<mc::Schedule>&& new_schedule, std::lock_guard<std::mutex> const&)
-{
-    std::vector<std::shared_ptr<mg::Buffer>> transferred_buffers;
-    while(schedule->num_scheduled())
-        transferred_buffers.emplace_back(schedule->next_buffer());
-    for(auto& buffer : transferred_buffers)
-        new_schedule->schedule(buffer);
-    schedule = new_schedule;
-    arbiter->set_schedule(schedule);
-}
-
 int mc::Stream::buffers_ready_for_compositor(void const* id) const
 {
-    std::lock_guard<decltype(mutex)> lk(mutex);
     if (arbiter->buffer_ready_for(id))
         return 1;
     return 0;
@@ -140,18 +256,7 @@ int mc::Stream::buffers_ready_for_compositor(void const* id) const
 
 void mc::Stream::drop_old_buffers()
 {
-    std::lock_guard<decltype(mutex)> lk(mutex);
-    std::vector<std::shared_ptr<mg::Buffer>> transferred_buffers;
-    while(schedule->num_scheduled())
-        transferred_buffers.emplace_back(schedule->next_buffer());
-
-    if (!transferred_buffers.empty())
-    {
-        schedule->schedule(transferred_buffers.back());
-        transferred_buffers.pop_back();
-    }
-
-    arbiter->advance_schedule();
+    arbiter->advance_to_latest();
 }
 
 bool mc::Stream::has_submitted_buffer() const
@@ -165,3 +270,25 @@ void mc::Stream::set_scale(float scale)
     std::lock_guard<decltype(mutex)> lk(mutex);
     scale_ = scale;
 }
+
+void mc::Stream::set_viewport(
+    std::experimental::optional<geom::RectangleF> const& source,
+    std::experimental::optional<geom::Size> const& destination)
+{
+    std::lock_guard<decltype(mutex)> lk(mutex);
+    viewport_source = source;
+    viewport_destination = destination;
+}
+
+auto mc::Stream::source_bounds(geom::Size const& buffer_size) const -> geom::RectangleF
+{
+    std::lock_guard<decltype(mutex)> lk(mutex);
+    if (!viewport_source)
+        return {{}, geom::SizeF{buffer_size}};
+
+    // The source is in logical coordinates, so scale it back up to buffer pixels
+    auto const& source = viewport_source.value();
+    return {
+        {source.top_left.x.as_value() * scale_, source.top_left.y.as_value() * scale_},
+        {source.size.width.as_value() * scale_, source.size.height.as_value() * scale_}};
+}
@@ -29,6 +29,9 @@
 #include <mutex>
 #include <memory>
 #include <set>
+#include <deque>
+#include <unordered_map>
+#include <cstdint>
 
 namespace mir
 {
@@ -43,6 +46,8 @@ public:
     ~Stream();
 
     void submit_buffer(std::shared_ptr<graphics::Buffer> const& buffer) override;
+    void add_damage(geometry::Rectangles const& buffer_damage) override;
+    auto submitted_damage() const -> std::experimental::optional<geometry::Rectangles> override;
     void with_most_recent_buffer_do(std::function<void(graphics::Buffer&)> const& exec) override;
     MirPixelFormat pixel_format() const override;
     void set_frame_posted_callback(
@@ -56,22 +61,58 @@ public:
     void drop_old_buffers() override;
     bool has_submitted_buffer() const override;
     void set_scale(float scale) override;
+    void set_viewport(
+        std::experimental::optional<geometry::RectangleF> const& source,
+        std::experimental::optional<geometry::Size> const& destination) override;
+    auto source_bounds(geometry::Size const& buffer_size) const -> geometry::RectangleF override;
+    auto buffer_damage(void const* user_id) const
+        -> std::experimental::optional<geometry::Rectangles> override;
+    void set_opaque_region(geometry::Rectangles const& region) override;
+    auto opaque_region() const -> geometry::Rectangles override;
+    void set_frame_presented_callback(
+        std::function<void(Presentation const&)> const& callback) override;
+    void frame_presented(Presentation const& presentation) override;
 
 private:
     enum class ScheduleMode;
-    void transition_schedule(std::shared_ptr<Schedule>&& new_schedule, std::lock_guard<std::mutex> const&);
+    auto damage_between(uint64_t from, uint64_t to, std::lock_guard<std::mutex> const&) const
+        -> std::experimental::optional<geometry::Rectangles>;
 
+    /// Guards submission and the stream's geometry; compositors acquiring buffers don't take it
     std::mutex mutable mutex;
     ScheduleMode schedule_mode;
     std::shared_ptr<Schedule> schedule;
     std::shared_ptr<MultiMonitorArbiter> const arbiter;
     geometry::Size latest_buffer_size;
     float scale_{1.0f};
-    MirPixelFormat pf;
+    std::experimental::optional<geometry::RectangleF> viewport_source;
+    std::experimental::optional<geometry::Size> viewport_destination;
+    std::atomic<MirPixelFormat> pf;
     std::atomic<bool> first_frame_posted;
 
-    std::mutex callback_mutex;
+    struct SubmittedDamage
+    {
+        uint64_t submission;
+        graphics::BufferID buffer;
+        std::experimental::optional<geometry::Rectangles> damage;  // relative to the preceding submission
+    };
+    struct CompositorDamage
+    {
+        uint64_t last_submission;   // 0 when unknown
+        std::experimental::optional<geometry::Rectangles> damage;
+    };
+    /// Guards the damage bookkeeping, shared by the submitting client and the compositors
+    std::mutex mutable damage_mutex;
+    uint64_t submission_count{0};
+    std::experimental::optional<geometry::Rectangles> pending_damage;
+    std::deque<SubmittedDamage> damage_history;
+    std::unordered_map<void const*, CompositorDamage> compositor_damage;
+    geometry::Rectangles opaque_region_;
+
+    std::mutex frame_callback_mutex;
     std::function<void(geometry::Size const&)> frame_callback;
+    std::mutex presented_callback_mutex;
+    std::function<void(Presentation const&)> presented_callback;
 };
 }
 }
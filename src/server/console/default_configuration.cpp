@@ -30,6 +30,7 @@
 #include <fcntl.h>
 #include <sys/ioctl.h>
 #include <boost/exception/diagnostic_information.hpp>
+#include <boost/throw_exception.hpp>
 
 namespace
 {
@@ -108,8 +109,14 @@ std::shared_ptr<mir::ConsoleServices> mir::DefaultServerConfiguration::the_conso
                 {
                     try
                     {
+                        auto const glib_main_loop = std::dynamic_pointer_cast<mir::GLibMainLoop>(the_main_loop());
+                        if (!glib_main_loop)
+                        {
+                            BOOST_THROW_EXCEPTION(std::runtime_error{"logind console services need the GLib main loop"});
+                        }
                         auto const vt_services = std::make_shared<mir::LogindConsoleServices>(
-                            std::dynamic_pointer_cast<mir::GLibMainLoop>(the_main_loop()));
+                            glib_main_loop,
+                            the_options()->get<std::string>(options::seat_opt));
                         mir::log_debug("Using logind for session management");
                         return vt_services;
                     }
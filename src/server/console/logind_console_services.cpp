@@ -17,6 +17,8 @@
  */
 
 #include <cinttypes>
+#include <cctype>
+#include <cstdio>
 #include <cstring>
 #include <boost/throw_exception.hpp>
 #include <boost/current_function.hpp>
@@ -32,6 +34,9 @@
 #include "mir/fd.h"
 #include "mir/main_loop.h"
 #include "mir/glib_main_loop.h"
+#include "mir/thread_name.h"
+
+#include <thread>
 
 #define MIR_LOG_COMPONTENT "logind"
 #include "mir/log.h"
@@ -161,6 +166,33 @@ std::unique_ptr<LogindSeat, decltype(&g_object_unref)> simple_seat_proxy_on_syst
         }).get();
 }
 
+/// logind's object path for a seat: the name escaped as sd_bus_path_encode() does
+std::string object_path_for_seat(std::string const& seat)
+{
+    std::string path{"/org/freedesktop/login1/seat/"};
+
+    if (seat.empty())
+    {
+        return path + "_";
+    }
+
+    for (unsigned char const c : seat)
+    {
+        if (isalnum(c) && c < 0x80)
+        {
+            path += c;
+        }
+        else
+        {
+            char escaped[4];
+            snprintf(escaped, sizeof escaped, "_%02x", c);
+            path += escaped;
+        }
+    }
+
+    return path;
+}
+
 std::string object_path_for_current_session(LogindSeat* seat_proxy)
 {
     auto const session_property = logind_seat_get_active_session(seat_proxy);
@@ -240,11 +272,79 @@ connect_to_system_bus(mir::GLibMainLoop& ml)
 }
 }
 
-mir::LogindConsoleServices::LogindConsoleServices(std::shared_ptr<mir::GLibMainLoop> const& ml)
+/**
+ * Dispatches the replies to D-Bus calls made before the main loop is running
+ *
+ * Without it those calls would have to be synchronous, each device waiting on the
+ * round-trip for the one before; with it they are all in flight at once, and whoever
+ * acquired a device only waits for it when (and if) they need it.
+ */
+class mir::LogindConsoleServices::StartupDispatcher
+{
+public:
+    StartupDispatcher()
+        : context{g_main_context_new(), &g_main_context_unref},
+          thread{[this]() { run(); }}
+    {
+    }
+
+    ~StartupDispatcher()
+    {
+        invoke([this]() { stopping = true; });
+        thread.join();
+    }
+
+    /// Runs \a call on the dispatch thread, with the dispatcher's context as the thread default
+    void invoke(std::function<void()> call)
+    {
+        g_main_context_invoke_full(
+            context.get(),
+            G_PRIORITY_DEFAULT,
+            [](gpointer data) -> gboolean
+            {
+                (*static_cast<std::function<void()>*>(data))();
+                return G_SOURCE_REMOVE;
+            },
+            new std::function<void()>{std::move(call)},
+            [](gpointer data) { delete static_cast<std::function<void()>*>(data); });
+    }
+
+private:
+    void run()
+    {
+        mir::set_thread_name("Mir/logind");
+
+        g_main_context_push_thread_default(context.get());
+        while (!stopping)
+        {
+            g_main_context_iteration(context.get(), TRUE);
+        }
+        g_main_context_pop_thread_default(context.get());
+    }
+
+    std::unique_ptr<GMainContext, decltype(&g_main_context_unref)> const context;
+    /// Only touched by the dispatch thread
+    bool stopping{false};
+    std::thread thread;
+};
+
+auto mir::LogindConsoleServices::startup_dispatcher() -> StartupDispatcher&
+{
+    std::lock_guard<std::mutex> lock{startup_dispatcher_mutex};
+    if (!startup_dispatcher_)
+    {
+        startup_dispatcher_ = std::make_unique<StartupDispatcher>();
+    }
+    return *startup_dispatcher_;
+}
+
+mir::LogindConsoleServices::LogindConsoleServices(
+    std::shared_ptr<mir::GLibMainLoop> const& ml,
+    std::string const& seat)
     : ml{ml},
       connection{connect_to_system_bus(*ml)},
       seat_proxy{
-        simple_seat_proxy_on_system_bus(*ml, connection.get(), "/org/freedesktop/login1/seat/seat0")},
+        simple_seat_proxy_on_system_bus(*ml, connection.get(), object_path_for_seat(seat).c_str())},
       session_path{object_path_for_current_session(seat_proxy.get())},
       session_proxy{
         simple_proxy_on_system_bus(
@@ -534,6 +634,29 @@ std::future<std::unique_ptr<mir::Device>> mir::LogindConsoleServices::acquire_de
 
     auto future = context->promise.get_future();
 
+    auto const take_device =
+        [
+            major,
+            minor,
+            proxy = G_DBUS_PROXY(session_proxy.get()),
+            userdata = context.release()
+        ](int timeout_ms)
+        {
+            g_dbus_proxy_call_with_unix_fd_list(
+                proxy,
+                "TakeDevice",
+                g_variant_new(
+                    "(uu)",
+                    major,
+                    minor),
+                G_DBUS_CALL_FLAGS_NO_AUTO_START,
+                timeout_ms,
+                nullptr,
+                nullptr,
+                &complete_take_device_call,
+                userdata);
+        };
+
     if (ml->running())
     {
         /*
@@ -544,70 +667,26 @@ std::future<std::unique_ptr<mir::Device>> mir::LogindConsoleServices::acquire_de
          * the main loop.
          */
         ml->run_with_context_as_thread_default(
-            [
-                major,
-                minor,
-                proxy = G_DBUS_PROXY(session_proxy.get()),
-                userdata = context.release()
-            ]()
+            [take_device]()
             {
-                g_dbus_proxy_call_with_unix_fd_list(
-                    proxy,
-                    "TakeDevice",
-                    g_variant_new(
-                        "(uu)",
-                        major,
-                        minor),
-                    G_DBUS_CALL_FLAGS_NO_AUTO_START,
-                    G_MAXINT,
-                    nullptr,
-                    nullptr,
-                    &complete_take_device_call,
-                    userdata);
+                take_device(G_MAXINT);
             }); // We don't need to wait for completion here, so throw away the std::future.
     }
     else
     {
         /*
-         * The main loop is not running; we must make a synchronous call, as
-         * the asynchronous call requires the main loop to dispatch the result.
+         * The main loop is not running, so can't dispatch the result. Rather than make
+         * a synchronous call, and have every device acquired during startup wait its
+         * turn, have the startup dispatcher make (and complete) the call.
          */
         using namespace std::chrono;
         using namespace std::chrono_literals;
 
-        GUnixFDList* resultant_fds;
-        GErrorPtr error;
-
-        std::unique_ptr<GVariant, decltype(&g_variant_unref)> dbus_result{
-            g_dbus_proxy_call_with_unix_fd_list_sync(
-                G_DBUS_PROXY(session_proxy.get()),
-                "TakeDevice",
-                g_variant_new(
-                    "(uu)",
-                    major,
-                    minor),
-                G_DBUS_CALL_FLAGS_NO_AUTO_START,
-                duration_cast<milliseconds>(10s).count(),
-                nullptr,
-                &resultant_fds,
-                nullptr,
-                &error),
-            &g_variant_unref};
-
-        if (!dbus_result)
-        {
-            std::string error_msg = error ? error->message : "unknown error";
-            context->promise.set_exception(
-                MIR_MAKE_EXCEPTION_PTR((
-                    std::runtime_error{
-                        std::string{"TakeDevice call failed: "} + error_msg})));
-            return future;
-        }
-
-        handle_take_device_dbus_result(
-            std::move(context),
-            std::move(dbus_result),
-            resultant_fds);
+        startup_dispatcher().invoke(
+            [take_device]()
+            {
+                take_device(duration_cast<milliseconds>(10s).count());
+            });
     }
     return future;
 }
@@ -19,6 +19,9 @@
 #define MIR_LOGIND_CONSOLE_SERVICES_H_
 
 #include <future>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <unordered_map>
 #include "mir/console_services.h"
 
@@ -33,7 +36,7 @@ class GLibMainLoop;
 class LogindConsoleServices : public ConsoleServices
 {
 public:
-    LogindConsoleServices(std::shared_ptr<GLibMainLoop> const& ml);
+    LogindConsoleServices(std::shared_ptr<GLibMainLoop> const& ml, std::string const& seat = "seat0");
     ~LogindConsoleServices();
 
     void register_switch_handlers(
@@ -51,6 +54,10 @@ public:
 
     class Device;
 private:
+    class StartupDispatcher;
+    /// Created on first use, as most devices are acquired once the main loop is running
+    auto startup_dispatcher() -> StartupDispatcher&;
+
     static void on_state_change(GObject* session_proxy, GParamSpec*, gpointer ctx) noexcept;
     static void on_pause_device(
         LogindSession*,
@@ -82,6 +89,10 @@ private:
     std::function<bool()> switch_to;
     bool active;
     std::unordered_map<dev_t, Device const* const> acquired_devices;
+
+    std::mutex startup_dispatcher_mutex;
+    /// Destroyed before the proxies its calls are made on
+    std::unique_ptr<StartupDispatcher> startup_dispatcher_;
 };
 }
 
@@ -21,6 +21,7 @@
 #include "mir/options/default_configuration.h"
 #include "mir/abnormal_exit.h"
 #include "mir/glib_main_loop.h"
+#include "mir/epoll_main_loop.h"
 #include "mir/default_server_status_listener.h"
 #include "mir/emergency_cleanup.h"
 #include "mir/default_configuration.h"
@@ -28,6 +29,7 @@
 #include "mir/frontend/wayland.h"
 
 #include "mir/logging/dumb_console_logger.h"
+#include "report/logging/async_logger.h"
 #include "mir/options/program_option.h"
 #include "mir/frontend/session_credentials.h"
 #include "mir/frontend/session_authorizer.h"
@@ -46,6 +48,8 @@
 #include "mir/scene/coordinate_translator.h"
 #include "mir/console_services.h"
 
+#include <boost/throw_exception.hpp>
+
 #include <type_traits>
 
 namespace mc = mir::compositor;
@@ -169,7 +173,22 @@ std::shared_ptr<mir::MainLoop> mir::DefaultServerConfiguration::the_main_loop()
     return main_loop(
         [this]() -> std::shared_ptr<mir::MainLoop>
         {
-            return std::make_shared<mir::GLibMainLoop>(the_clock());
+            auto const main_loop = the_options()->get<std::string>(options::main_loop_opt);
+
+            if (main_loop == options::epoll_main_loop)
+            {
+                return std::make_shared<mir::EpollMainLoop>();
+            }
+            else if (main_loop == options::glib_main_loop)
+            {
+                return std::make_shared<mir::GLibMainLoop>(
+                    the_clock(),
+                    std::chrono::milliseconds{the_options()->get<int>(options::timer_slack_opt)});
+            }
+
+            BOOST_THROW_EXCEPTION((
+                std::runtime_error{
+                    std::string{"Unknown main loop: "} + main_loop}));
         });
 }
 
@@ -226,8 +245,12 @@ auto mir::DefaultServerConfiguration::the_logger()
     -> std::shared_ptr<ml::Logger>
 {
     return logger(
-        []() -> std::shared_ptr<ml::Logger>
+        [this]() -> std::shared_ptr<ml::Logger>
         {
+            auto const options = the_options();
+            if (options->get<bool>(options::async_logging_opt))
+                return std::make_shared<report::logging::AsyncLogger>(options->get<int>(options::log_rate_limit_opt));
+
             return std::make_shared<ml::DumbConsoleLogger>();
         });
 }
@@ -36,6 +36,7 @@
 #include <boost/exception/diagnostic_information.hpp>
 
 #include <chrono>
+#include <future>
 #include <stdexcept>
 #include <thread>
 
@@ -102,8 +103,8 @@ struct mir::DisplayServer::Private
                 [&, this] { display_changer->resume_display_config_processing(); });
 
             auto comp = try_but_revert_if_unwinding(
-                [this] { compositor->stop(); },
-                [&, this] { compositor->start(); });
+                [this] { compositor->pause(); },
+                [&, this] { compositor->resume(); });
 
             display->pause();
         }
@@ -143,8 +144,8 @@ struct mir::DisplayServer::Private
                 [&, this] { display->pause(); });
 
             auto comp = try_but_revert_if_unwinding(
-                [this] { compositor->start(); },
-                [&, this] { compositor->stop(); });
+                [this] { compositor->resume(); },
+                [&, this] { compositor->pause(); });
 
             auto display_config_processing = try_but_revert_if_unwinding(
                 [this] { display_changer->resume_display_config_processing(); },
@@ -224,8 +225,14 @@ void mir::DisplayServer::run()
 
     auto const& server = *p.load();
 
+    /*
+     * Starting input enumerates the devices (and compiles their keymaps) on the input
+     * thread, and starting the compositor creates a renderer for each output. Neither
+     * needs the other, so don't make the first frame wait for the input devices.
+     */
+    auto input_started = std::async(std::launch::async, [&server] { server.input_manager->start(); });
     server.compositor->start();
-    server.input_manager->start();
+    input_started.get();
     server.input_dispatcher->start();
     server.prompt_connector->start();
     server.connector->start();
@@ -0,0 +1,493 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/epoll_main_loop.h"
+#include "mir/time/alarm.h"
+#include "mir/lockable_callback.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <system_error>
+
+namespace
+{
+int const max_events = 64;
+
+/// Internal fds are registered with generation 0, handlers' fds with later generations
+auto event_data(int fd, uint32_t generation) -> uint64_t
+{
+    return (uint64_t{generation} << 32) | uint32_t(fd);
+}
+
+auto create_epoll_fd() -> int
+{
+    auto const fd = epoll_create1(EPOLL_CLOEXEC);
+    if (fd < 0)
+    {
+        BOOST_THROW_EXCEPTION(std::system_error(errno, std::system_category(), "Failed to create epoll fd"));
+    }
+    return fd;
+}
+
+auto create_wake_fd() -> int
+{
+    auto const fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (fd < 0)
+    {
+        BOOST_THROW_EXCEPTION(std::system_error(errno, std::system_category(), "Failed to create eventfd"));
+    }
+    return fd;
+}
+
+void add_to_epoll(int epoll_fd, int fd, uint32_t generation)
+{
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = event_data(fd, generation);
+
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0)
+    {
+        BOOST_THROW_EXCEPTION(std::system_error(errno, std::system_category(), "Failed to add fd to epoll"));
+    }
+}
+}
+
+struct mir::EpollMainLoop::FdHandler
+{
+    FdHandler(void const* owner, std::function<void(int)> const& handler)
+        : owner{owner},
+          handler{handler}
+    {
+    }
+
+    void call(int fd)
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+
+        if (enabled)
+            handler(fd);
+    }
+
+    /// Once this returns the handler will not be called (except by this thread, if it is calling it now)
+    void disable()
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        enabled = false;
+    }
+
+    void const* const owner;
+
+private:
+    std::function<void(int)> const handler;
+    std::recursive_mutex mutex;
+    bool enabled{true};
+};
+
+mir::EpollMainLoop::EpollMainLoop()
+    : epoll_fd{create_epoll_fd()},
+      wake_fd{create_wake_fd()},
+      signal_sources{*this}
+{
+    add_to_epoll(epoll_fd, wake_fd, 0);
+    add_to_epoll(epoll_fd, alarms.watch_fd(), 0);
+}
+
+mir::EpollMainLoop::~EpollMainLoop() = default;
+
+void mir::EpollMainLoop::run()
+{
+    main_loop_exception = nullptr;
+    running_ = true;
+
+    epoll_event events[max_events];
+
+    while (running_)
+    {
+        auto const count = epoll_wait(epoll_fd, events, max_events, -1);
+        if (count < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            BOOST_THROW_EXCEPTION(std::system_error(errno, std::system_category(), "Failed to wait on epoll fd"));
+        }
+
+        // As with GLibMainLoop, a stop takes priority over anything else pending
+        if (stop_requested.exchange(false))
+        {
+            halt();
+            break;
+        }
+
+        bool woken{false};
+        for (auto event = events; event != events + count; ++event)
+        {
+            int const fd = uint32_t(event->data.u64);
+            auto const generation = uint32_t(event->data.u64 >> 32);
+
+            if (generation)
+            {
+                dispatch_fd(fd, generation);
+            }
+            else if (fd == wake_fd)
+            {
+                woken = true;
+            }
+            else
+            {
+                try { alarms.dispatch(dispatch::FdEvent::readable); }
+                catch (...) { handle_exception(std::current_exception()); }
+            }
+        }
+
+        if (woken)
+        {
+            eventfd_t value;
+            eventfd_read(wake_fd, &value);
+            dispatch_actions();
+        }
+    }
+
+    if (main_loop_exception)
+        std::rethrow_exception(main_loop_exception);
+}
+
+void mir::EpollMainLoop::stop()
+{
+    stop_requested = true;
+    wake();
+}
+
+bool mir::EpollMainLoop::running() const
+{
+    return running_;
+}
+
+void mir::EpollMainLoop::halt()
+{
+    {
+        std::lock_guard<std::mutex> lock{run_on_halt_mutex};
+        running_ = false;
+    }
+    // We know any other thread sees running == false here, so don't need
+    // to lock run_on_halt_queue.
+    for (auto& action : run_on_halt_queue)
+    {
+        try { action(); }
+        catch (...) { handle_exception(std::current_exception()); }
+    }
+    run_on_halt_queue.clear();
+}
+
+void mir::EpollMainLoop::wake()
+{
+    eventfd_write(wake_fd, 1);
+}
+
+void mir::EpollMainLoop::register_signal_handler(
+    std::initializer_list<int> sigs,
+    std::function<void(int)> const& handler)
+{
+    auto const handler_with_exception_handling =
+        [this, handler] (int sig)
+        {
+            try { handler(sig); }
+            catch (...) { handle_exception(std::current_exception()); }
+        };
+
+    signal_sources.add(sigs, handler_with_exception_handling);
+}
+
+void mir::EpollMainLoop::register_signal_handler(
+    std::initializer_list<int> sigs,
+    mir::UniqueModulePtr<std::function<void(int)>> handler)
+{
+    std::shared_ptr<std::function<void(int)>> const shared_handler{std::move(handler)};
+
+    auto const handler_with_exception_handling =
+        [this, shared_handler] (int sig)
+        {
+            try { (*shared_handler)(sig); }
+            catch (...) { handle_exception(std::current_exception()); }
+        };
+
+    signal_sources.add(sigs, handler_with_exception_handling);
+}
+
+void mir::EpollMainLoop::register_fd_handler(
+    std::initializer_list<int> fds,
+    void const* owner,
+    std::function<void(int)> const& handler)
+{
+    auto const handler_with_exception_handling =
+        [this, handler] (int fd)
+        {
+            try { handler(fd); }
+            catch (...) { handle_exception(std::current_exception()); }
+        };
+
+    for (auto fd : fds)
+        add_fd_handler(fd, owner, handler_with_exception_handling);
+}
+
+void mir::EpollMainLoop::register_fd_handler(
+    std::initializer_list<int> fds,
+    void const* owner,
+    mir::UniqueModulePtr<std::function<void(int)>> handler)
+{
+    std::shared_ptr<std::function<void(int)>> const shared_handler{std::move(handler)};
+
+    auto const handler_with_exception_handling =
+        [this, shared_handler] (int fd)
+        {
+            try { (*shared_handler)(fd); }
+            catch (...) { handle_exception(std::current_exception()); }
+        };
+
+    for (auto fd : fds)
+        add_fd_handler(fd, owner, handler_with_exception_handling);
+}
+
+void mir::EpollMainLoop::add_fd_handler(int fd, void const* owner, std::function<void(int)> const& handler)
+{
+    std::lock_guard<std::mutex> lock{fd_handlers_mutex};
+
+    auto const [registration, inserted] = fd_handlers.try_emplace(fd);
+    if (inserted)
+    {
+        // An fd can only be in the epoll set once, so handlers sharing an fd share the registration
+        registration->second.generation = next_generation++;
+        if (!next_generation) next_generation = 1;
+
+        try
+        {
+            add_to_epoll(epoll_fd, fd, registration->second.generation);
+        }
+        catch (...)
+        {
+            fd_handlers.erase(registration);
+            throw;
+        }
+    }
+
+    registration->second.handlers.push_back(std::make_shared<FdHandler>(owner, handler));
+}
+
+void mir::EpollMainLoop::unregister_fd_handler(void const* owner)
+{
+    std::vector<std::shared_ptr<FdHandler>> removed;
+    {
+        std::lock_guard<std::mutex> lock{fd_handlers_mutex};
+
+        for (auto registration = fd_handlers.begin(); registration != fd_handlers.end();)
+        {
+            auto& handlers = registration->second.handlers;
+            auto const new_end = std::stable_partition(handlers.begin(), handlers.end(),
+                [&](auto const& handler) { return handler->owner != owner; });
+            std::move(new_end, handlers.end(), std::back_inserter(removed));
+            handlers.erase(new_end, handlers.end());
+
+            if (handlers.empty())
+            {
+                // The fd may already have been closed (which removes it from the epoll set)
+                epoll_ctl(epoll_fd, EPOLL_CTL_DEL, registration->first, nullptr);
+                registration = fd_handlers.erase(registration);
+            }
+            else
+            {
+                ++registration;
+            }
+        }
+    }
+
+    // Wait for any dispatch in progress on another thread
+    for (auto const& handler : removed)
+        handler->disable();
+}
+
+void mir::EpollMainLoop::dispatch_fd(int fd, uint32_t generation)
+{
+    std::vector<std::shared_ptr<FdHandler>> handlers;
+    {
+        std::lock_guard<std::mutex> lock{fd_handlers_mutex};
+
+        // Events for an fd unregistered (and maybe reused) earlier in this iteration are stale
+        auto const registration = fd_handlers.find(fd);
+        if (registration == fd_handlers.end() || registration->second.generation != generation)
+            return;
+
+        handlers = registration->second.handlers;
+    }
+
+    for (auto const& handler : handlers)
+        handler->call(fd);
+}
+
+void mir::EpollMainLoop::enqueue(void const* owner, ServerAction const& action)
+{
+    auto const action_with_exception_handling =
+        [this, action]
+        {
+            try { action(); }
+            catch (...) { handle_exception(std::current_exception()); }
+        };
+
+    queue_action(owner, true, action_with_exception_handling);
+}
+
+void mir::EpollMainLoop::enqueue_with_guaranteed_execution(mir::ServerAction const& action)
+{
+    auto const action_with_exception_handling =
+        [this]
+        {
+            try
+            {
+                mir::ServerAction action;
+                {
+                    std::lock_guard<std::mutex> lock{run_on_halt_mutex};
+                    // halt() runs (and clears) anything still queued
+                    if (run_on_halt_queue.empty())
+                        return;
+                    action = run_on_halt_queue.front();
+                    run_on_halt_queue.pop_front();
+                }
+                action();
+            }
+            catch (...)
+            {
+                handle_exception(std::current_exception());
+            }
+        };
+
+    {
+        std::unique_lock<std::mutex> lock{run_on_halt_mutex};
+
+        if (!running_)
+        {
+            lock.unlock();
+            action();
+            return;
+        }
+        else
+        {
+            run_on_halt_queue.push_back(action);
+        }
+    }
+
+    queue_action(nullptr, false, action_with_exception_handling);
+}
+
+void mir::EpollMainLoop::spawn(std::function<void()>&& work)
+{
+    auto const action_with_exception_handling =
+        [this, action = std::move(work)]
+        {
+            try { action(); }
+            catch (...) { handle_exception(std::current_exception()); }
+        };
+
+    queue_action(nullptr, false, action_with_exception_handling);
+}
+
+void mir::EpollMainLoop::queue_action(void const* owner, bool conditional, ServerAction const& action)
+{
+    {
+        std::lock_guard<std::mutex> lock{actions_mutex};
+        actions.push_back({owner, conditional, action});
+    }
+
+    wake();
+}
+
+void mir::EpollMainLoop::dispatch_actions()
+{
+    // Take everything that's ready now: actions queued by these are left for the next iteration
+    std::vector<ServerAction> batch;
+    {
+        std::lock_guard<std::mutex> lock{actions_mutex};
+
+        auto held_back = actions.begin();
+        for (auto& action : actions)
+        {
+            if (!action.conditional || should_process_actions_for(action.owner))
+            {
+                batch.push_back(std::move(action.action));
+            }
+            else
+            {
+                if (&*held_back != &action)
+                    *held_back = std::move(action);
+                ++held_back;
+            }
+        }
+        actions.erase(held_back, actions.end());
+    }
+
+    for (auto const& action : batch)
+        action();
+}
+
+void mir::EpollMainLoop::pause_processing_for(void const* owner)
+{
+    std::lock_guard<std::mutex> lock{actions_mutex};
+
+    auto const iter = std::find(do_not_process.begin(), do_not_process.end(), owner);
+    if (iter == do_not_process.end())
+        do_not_process.push_back(owner);
+}
+
+void mir::EpollMainLoop::resume_processing_for(void const* owner)
+{
+    {
+        std::lock_guard<std::mutex> lock{actions_mutex};
+
+        auto const new_end = std::remove(do_not_process.begin(), do_not_process.end(), owner);
+        do_not_process.erase(new_end, do_not_process.end());
+    }
+
+    // Wake up the loop to dispatch any actions held back
+    wake();
+}
+
+/// Called with actions_mutex held
+bool mir::EpollMainLoop::should_process_actions_for(void const* owner)
+{
+    auto const iter = std::find(do_not_process.begin(), do_not_process.end(), owner);
+    return iter == do_not_process.end();
+}
+
+std::unique_ptr<mir::time::Alarm> mir::EpollMainLoop::create_alarm(
+    std::function<void()> const& callback)
+{
+    return alarms.create_alarm(callback);
+}
+
+std::unique_ptr<mir::time::Alarm> mir::EpollMainLoop::create_alarm(
+    std::unique_ptr<LockableCallback> callback)
+{
+    return alarms.create_alarm(std::move(callback));
+}
+
+void mir::EpollMainLoop::handle_exception(std::exception_ptr const& e)
+{
+    main_loop_exception = e;
+    stop();
+}
@@ -124,3 +124,9 @@ mf::AuthorizingDisplayChanger::cancel_base_configuration_preview(std::shared_ptr
     // has already been authorised to change configuration.
     changer->cancel_base_configuration_preview(session);
 }
+
+mir::graphics::Frame mf::AuthorizingDisplayChanger::last_frame_on(unsigned output_id)
+{
+    // Frame timing reveals nothing about the configuration, so needs no authorisation
+    return changer->last_frame_on(output_id);
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "event_ring_sink.h"
+#include "event_sender.h"
+
+#include "mir/event_ring.h"
+#include "mir/events/event.h"
+
+namespace mf = mir::frontend;
+namespace mfd = mir::frontend::detail;
+
+namespace
+{
+/// Room for a few hundred input events: a client that falls further behind than that goes back to the socket
+size_t const ring_size = 64 * 1024;
+}
+
+mfd::InputEventRing::InputEventRing(std::shared_ptr<MessageSender> const& sender) :
+    ring{std::make_unique<EventRing>(ring_size)}
+{
+    EventSender{sender}.send_event_ring(*ring);
+}
+
+mfd::InputEventRing::~InputEventRing() = default;
+
+bool mfd::InputEventRing::write(MirEvent const& event)
+{
+    auto const raw = MirEvent::serialize(&event);
+
+    std::lock_guard<decltype(mutex)> lock{mutex};
+
+    if (!ring)
+        return false;
+
+    if (!ring->write(raw.data(), raw.size()))
+    {
+        ring.reset();
+        return false;
+    }
+
+    return true;
+}
+
+mfd::EventRingSink::EventRingSink(
+    std::shared_ptr<InputEventRing> const& ring,
+    std::shared_ptr<EventSink> const& socket_sink,
+    bool started) :
+    ring{ring},
+    socket_sink{socket_sink},
+    started{started}
+{
+}
+
+void mfd::EventRingSink::start()
+{
+    started = true;
+}
+
+void mfd::EventRingSink::handle_event(EventUPtr&& event)
+{
+    if (started && event->type() == mir_event_type_input && ring->write(*event))
+        return;
+
+    socket_sink->handle_event(std::move(event));
+}
+
+void mfd::EventRingSink::handle_lifecycle_event(MirLifecycleState state)
+{
+    socket_sink->handle_lifecycle_event(state);
+}
+
+void mfd::EventRingSink::handle_display_config_change(graphics::DisplayConfiguration const& config)
+{
+    socket_sink->handle_display_config_change(config);
+}
+
+void mfd::EventRingSink::send_ping(int32_t serial)
+{
+    socket_sink->send_ping(serial);
+}
+
+void mfd::EventRingSink::handle_input_config_change(MirInputConfig const& config)
+{
+    socket_sink->handle_input_config_change(config);
+}
+
+void mfd::EventRingSink::handle_error(ClientVisibleError const& error)
+{
+    socket_sink->handle_error(error);
+}
+
+void mfd::EventRingSink::send_buffer(BufferStreamId id, graphics::Buffer& buffer, graphics::BufferIpcMsgType type)
+{
+    socket_sink->send_buffer(id, buffer, type);
+}
+
+void mfd::EventRingSink::add_buffer(graphics::Buffer& buffer)
+{
+    socket_sink->add_buffer(buffer);
+}
+
+void mfd::EventRingSink::error_buffer(geometry::Size req_size, MirPixelFormat req_format, std::string const& error_msg)
+{
+    socket_sink->error_buffer(req_size, req_format, error_msg);
+}
+
+void mfd::EventRingSink::update_buffer(graphics::Buffer& buffer)
+{
+    socket_sink->update_buffer(buffer);
+}
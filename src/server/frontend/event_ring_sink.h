@@ -0,0 +1,92 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_FRONTEND_EVENT_RING_SINK_H_
+#define MIR_FRONTEND_EVENT_RING_SINK_H_
+
+#include "mir/frontend/event_sink.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+namespace mir
+{
+class EventRing;
+namespace frontend
+{
+class MessageSender;
+
+namespace detail
+{
+/**
+ * A connection's ring of input events, shared by the EventSinks of its session and surfaces
+ *
+ * The client is sent the ring when it is created. Once an event has had to go by the socket
+ * (because the client has fallen behind and the ring is full), later events must follow it
+ * or the client could see them out of order, so the ring isn't used again.
+ */
+class InputEventRing
+{
+public:
+    explicit InputEventRing(std::shared_ptr<MessageSender> const& sender);
+    ~InputEventRing();
+
+    /// \return false if the event needs to be sent by the socket
+    bool write(MirEvent const& event);
+
+private:
+    InputEventRing(InputEventRing const&) = delete;
+    InputEventRing& operator=(InputEventRing const&) = delete;
+
+    std::mutex mutex;
+    std::unique_ptr<EventRing> ring;
+};
+
+/// Sends input events through an InputEventRing, and everything else to the socket's EventSink
+class EventRingSink : public EventSink
+{
+public:
+    /// \param started  whether to use the ring immediately, or only after start()
+    EventRingSink(
+        std::shared_ptr<InputEventRing> const& ring,
+        std::shared_ptr<EventSink> const& socket_sink,
+        bool started);
+
+    /// Starts using the ring, once anything the socket sink is holding back has been sent
+    void start();
+
+    void handle_event(EventUPtr&& event) override;
+    void handle_lifecycle_event(MirLifecycleState state) override;
+    void handle_display_config_change(graphics::DisplayConfiguration const& config) override;
+    void send_ping(int32_t serial) override;
+    void handle_input_config_change(MirInputConfig const& config) override;
+    void handle_error(ClientVisibleError const& error) override;
+    void send_buffer(BufferStreamId id, graphics::Buffer& buffer, graphics::BufferIpcMsgType type) override;
+    void add_buffer(graphics::Buffer& buffer) override;
+    void error_buffer(geometry::Size req_size, MirPixelFormat req_format, std::string const& error_msg) override;
+    void update_buffer(graphics::Buffer& buffer) override;
+
+private:
+    std::shared_ptr<InputEventRing> const ring;
+    std::shared_ptr<EventSink> const socket_sink;
+    std::atomic<bool> started;
+};
+}
+}
+}
+
+#endif /* MIR_FRONTEND_EVENT_RING_SINK_H_ */
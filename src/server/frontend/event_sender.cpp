@@ -18,6 +18,7 @@
 
 #include "event_sender.h"
 #include "mir/events/event.h"
+#include "mir/event_ring.h"
 #include "mir/frontend/client_constants.h"
 #include "mir/graphics/display_configuration.h"
 #include "mir/variable_length_array.h"
@@ -99,6 +100,14 @@ void mfd::EventSender::handle_input_config_change(MirInputConfig const& config)
     send_event_sequence(seq, {});
 }
 
+void mfd::EventSender::send_event_ring(EventRing const& ring)
+{
+    mp::EventSequence seq;
+
+    seq.mutable_event_ring()->set_fds_on_side_channel(2);
+    send_event_sequence(seq, {{ring.memory(), ring.doorbell()}});
+}
+
 void mfd::EventSender::send_event_sequence(mp::EventSequence& seq, FdSets const& fds)
 {
     mir::VariableLengthArray<frontend::serialization_buffer_size>
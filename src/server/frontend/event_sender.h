@@ -25,6 +25,7 @@
 
 namespace mir
 {
+class EventRing;
 namespace graphics { class PlatformIpcOperations; }
 namespace protobuf
 {
@@ -52,6 +53,9 @@ public:
     void error_buffer(geometry::Size, MirPixelFormat, std::string const&) override;
     void update_buffer(graphics::Buffer&) override;
 
+    /// Sends the client the ring its input events will come through
+    void send_event_ring(EventRing const& ring);
+
 private:
     void send_event_sequence(protobuf::EventSequence&, FdSets const&);
     void send_buffer(protobuf::EventSequence&, graphics::Buffer&, graphics::BufferIpcMsgType);
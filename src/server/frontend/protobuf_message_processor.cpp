@@ -35,6 +35,7 @@ template<class Response>
 std::vector<mir::Fd> extract_fds_from(Response* response)
 {
     std::vector<mir::Fd> fd;
+    fd.reserve(response->fd().size());
     for (auto i = 0; i < response->fd().size(); ++i)
         fd.emplace_back(mir::Fd(dup(response->fd().data()[i])));
     response->clear_fd();
@@ -68,12 +69,10 @@ template<> struct result_ptr_t<mir::protobuf::SocketFD>     { typedef ::mir::pro
 template<> struct result_ptr_t<mir::protobuf::PlatformOperationMessage> { typedef ::mir::protobuf::PlatformOperationMessage* type; };
 
 template<class ParameterMessage>
-ParameterMessage parse_parameter(Invocation const& invocation)
+void parse_parameter(Invocation const& invocation, ParameterMessage& request)
 {
-    ParameterMessage request;
     if (!request.ParseFromString(invocation.parameters()))
         BOOST_THROW_EXCEPTION(std::runtime_error("Failed to parse message parameters!"));
-    return request;
 }
 
 class CallbackClosure : public google::protobuf::Closure
@@ -104,10 +103,9 @@ void invoke(
         ResponseType* response,
         ::google::protobuf::Closure* done),
     unsigned int invocation_id,
-    RequestType* request)
+    RequestType* request,
+    std::shared_ptr<ResponseType> const& result_message)
 {
-    auto const result_message = std::make_shared<ResponseType>();
-
     std::weak_ptr<ProtobufMessageProcessor> weak_mp = mp;
     auto const response_callback = [weak_mp, invocation_id, result_message]
     {
@@ -209,11 +207,25 @@ bool mfd::ProtobufMessageProcessor::dispatch(
         }
         else if ("submit_buffer" == invocation.method_name())
         {
-            auto request = parse_parameter<mir::protobuf::BufferRequest>(invocation);
-            request.mutable_buffer()->clear_fd();
+            // Legacy clients submit every frame, so the messages are reused rather than allocated each time
+            parse_parameter(invocation, submit_buffer_request);
+            submit_buffer_request.mutable_buffer()->clear_fd();
             for (auto& fd : side_channel_fds)
-                request.mutable_buffer()->add_fd(fd);
-            invoke(shared_from_this(), display_server.get(), &DisplayServer::submit_buffer, invocation.id(), &request);
+                submit_buffer_request.mutable_buffer()->add_fd(fd);
+
+            // The response is only shared with a callback that hasn't yet run
+            if (submit_buffer_response.use_count() == 1)
+                submit_buffer_response->Clear();
+            else
+                submit_buffer_response = std::make_shared<mir::protobuf::Void>();
+
+            invoke(
+                shared_from_this(),
+                display_server.get(),
+                &DisplayServer::submit_buffer,
+                invocation.id(),
+                &submit_buffer_request,
+                submit_buffer_response);
         }
         else if ("allocate_buffers" == invocation.method_name())
         {
@@ -223,6 +235,14 @@ bool mfd::ProtobufMessageProcessor::dispatch(
         {
             invoke(this, display_server.get(), &DisplayServer::release_buffers, invocation);
         }
+        else if ("exchange_buffers" == invocation.method_name())
+        {
+            invoke(this, display_server.get(), &DisplayServer::exchange_buffers, invocation);
+        }
+        else if ("frame_timing" == invocation.method_name())
+        {
+            invoke(this, display_server.get(), &DisplayServer::frame_timing, invocation);
+        }
         else if ("release_surface" == invocation.method_name())
         {
             invoke(this, display_server.get(), &DisplayServer::release_surface, invocation);
@@ -67,6 +67,10 @@ private:
     std::shared_ptr<ProtobufMessageSender> const sender;
     std::shared_ptr<DisplayServer> const display_server;
     std::shared_ptr<MessageProcessorReport> const report;
+
+    /// Messages for the per-frame submit_buffer call, reused to avoid allocating them (and their fields) each frame
+    protobuf::BufferRequest submit_buffer_request;
+    std::shared_ptr<protobuf::Void> submit_buffer_response{std::make_shared<protobuf::Void>()};
 };
 }
 }
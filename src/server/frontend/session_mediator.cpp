@@ -18,6 +18,7 @@
 
 #include "session_mediator.h"
 #include "reordering_message_sender.h"
+#include "event_ring_sink.h"
 #include "event_sink_factory.h"
 
 #include "mir/frontend/session_mediator_observer.h"
@@ -151,7 +152,14 @@ void mf::SessionMediator::connect(
 {
     observer->session_connect_called(request->application_name());
 
-    auto const mir_client_session = shell->open_session(client_pid_, request->application_name(), event_sink);
+    std::shared_ptr<mf::EventSink> session_sink = event_sink;
+    if (request->event_ring())
+    {
+        input_event_ring = std::make_shared<mfd::InputEventRing>(message_sender);
+        session_sink = std::make_shared<mfd::EventRingSink>(input_event_ring, event_sink, true);
+    }
+
+    auto const mir_client_session = shell->open_session(client_pid_, request->application_name(), session_sink);
     auto const scene_session = shell->scene_session_for(mir_client_session);
 
     weak_mir_client_session = mir_client_session;
@@ -326,6 +334,11 @@ void mf::SessionMediator::create_surface(
     auto buffering_sender = std::make_shared<mf::ReorderingMessageSender>(message_sender);
     std::shared_ptr<mf::EventSink> sink = sink_factory->create_sink(buffering_sender);
 
+    // Input events mustn't overtake the surface events held back by the buffering_sender
+    std::shared_ptr<mfd::EventRingSink> ring_sink;
+    if (input_event_ring)
+        sink = ring_sink = std::make_shared<mfd::EventRingSink>(input_event_ring, sink, false);
+
     auto const surf_id = shell->create_surface(mir_client_session, params, sink);
 
     auto surface = mir_client_session->frontend_surface(surf_id);
@@ -357,6 +370,8 @@ void mf::SessionMediator::create_surface(
     done->Run();
     // ...then uncork the message sender, sending all buffered surface events.
     buffering_sender->uncork();
+    if (ring_sink)
+        ring_sink->start();
 }
 
 namespace
@@ -426,18 +441,26 @@ void mf::SessionMediator::submit_buffer(
 {
     auto const mir_client_session = weak_mir_client_session.lock();
     if (!mir_client_session) BOOST_THROW_EXCEPTION(std::logic_error("Invalid application session"));
+
+    submit(mir_client_session, *request);
+
+    done->Run();
+}
+
+void mf::SessionMediator::submit(
+    std::shared_ptr<MirClientSession> const& mir_client_session,
+    mir::protobuf::BufferRequest const& request)
+{
     observer->session_submit_buffer_called(mir_client_session->name());
     
-    mf::BufferStreamId const stream_id{request->id().value()};
-    mg::BufferID const buffer_id{static_cast<uint32_t>(request->buffer().buffer_id())};
+    mf::BufferStreamId const stream_id{request.id().value()};
+    mg::BufferID const buffer_id{static_cast<uint32_t>(request.buffer().buffer_id())};
     auto stream = mir_client_session->buffer_stream(stream_id);
 
-    mfd::ProtobufBufferPacker request_msg{const_cast<mir::protobuf::Buffer*>(&request->buffer())};
+    mfd::ProtobufBufferPacker request_msg{const_cast<mir::protobuf::Buffer*>(&request.buffer())};
     auto b = buffer_cache.at(buffer_id);
 
     stream->submit_buffer(std::make_shared<AutoSendBuffer>(b, executor, event_sink));
-
-    done->Run();
 }
 
 namespace
@@ -534,21 +557,30 @@ void mf::SessionMediator::release_buffers(
     if (!mir_client_session)
         BOOST_THROW_EXCEPTION(std::logic_error("Invalid application session"));
 
+    release(mir_client_session, *request);
+
+    done->Run();
+}
+
+void mf::SessionMediator::release(
+    std::shared_ptr<MirClientSession> const& mir_client_session,
+    mir::protobuf::BufferRelease const& request)
+{
     observer->session_release_buffers_called(mir_client_session->name());
 
-    std::vector<mg::BufferID> to_release(request->buffers().size());
+    std::vector<mg::BufferID> to_release(request.buffers().size());
     std::transform(
-        request->buffers().begin(),
-        request->buffers().end(),
+        request.buffers().begin(),
+        request.buffers().end(),
         to_release.begin(),
         [](auto buffer)
         {
             return mg::BufferID{static_cast<uint32_t>(buffer.buffer_id())};
         });
 
-    if (request->has_id())
+    if (request.has_id())
     {
-        auto const stream_id = mf::BufferStreamId{request->id().value()};
+        auto const stream_id = mf::BufferStreamId{request.id().value()};
 
         auto const associated_range = stream_associated_buffers.equal_range(stream_id);
         for (auto match = associated_range.first; match != associated_range.second;)
@@ -565,7 +597,38 @@ void mf::SessionMediator::release_buffers(
     {
         buffer_cache.erase(buffer_id);
     }
-   done->Run();
+}
+
+void mf::SessionMediator::exchange_buffers(
+    mir::protobuf::BufferExchange const* request,
+    mir::protobuf::Void*,
+    google::protobuf::Closure* done)
+{
+    auto mir_client_session = weak_mir_client_session.lock();
+    if (!mir_client_session)
+        BOOST_THROW_EXCEPTION(std::logic_error("Invalid application session"));
+
+    for (auto const& submission : request->submissions())
+        submit(mir_client_session, submission);
+
+    for (auto const& release_request : request->releases())
+        release(mir_client_session, release_request);
+
+    done->Run();
+}
+
+void mf::SessionMediator::frame_timing(
+    mir::protobuf::FrameTimingRequest const* request,
+    mir::protobuf::FrameTiming* response,
+    google::protobuf::Closure* done)
+{
+    auto const frame = display_changer->last_frame_on(request->output_id());
+
+    response->set_msc(frame.msc);
+    response->set_ust(frame.ust.nanoseconds.count());
+    response->set_clock_id(frame.ust.clock_id);
+
+    done->Run();
 }
 
 void mf::SessionMediator::release_surface(
@@ -591,7 +654,7 @@ void mf::SessionMediator::release_surface(
         legacy_default_stream_map.erase(it);
     }
 
-    // TODO: We rely on this sending responses synchronously.
+    // NOTE: We rely on responses reaching the client in the order they are sent (as SocketMessenger ensures).
     done->Run();
 }
 
@@ -83,6 +83,7 @@ class BufferMap;
 
 namespace detail
 {
+class InputEventRing;
 typedef IntWrapper<struct PromptSessionTag> PromptSessionId;
 
 struct PromptSessionStore
@@ -236,6 +237,14 @@ public:
         mir::protobuf::BufferRelease const* request,
         mir::protobuf::Void* response,
         google::protobuf::Closure* done) override;
+    void exchange_buffers(
+        mir::protobuf::BufferExchange const* request,
+        mir::protobuf::Void* response,
+        google::protobuf::Closure* done) override;
+    void frame_timing(
+        mir::protobuf::FrameTimingRequest const* request,
+        mir::protobuf::FrameTiming* response,
+        google::protobuf::Closure* done) override;
     void request_persistent_surface_id(
         mir::protobuf::SurfaceId const* request,
         mir::protobuf::PersistentSurfaceId* response,
@@ -271,6 +280,9 @@ private:
     std::shared_ptr<graphics::DisplayConfiguration> unpack_and_sanitize_display_configuration(
         protobuf::DisplayConfiguration const*);
 
+    void submit(std::shared_ptr<MirClientSession> const& session, mir::protobuf::BufferRequest const& request);
+    void release(std::shared_ptr<MirClientSession> const& session, mir::protobuf::BufferRelease const& request);
+
     virtual std::function<void(std::shared_ptr<scene::Session> const&)>
     prompt_session_connect_handler(detail::PromptSessionId prompt_session_id) const;
 
@@ -284,6 +296,7 @@ private:
     std::shared_ptr<EventSinkFactory> const sink_factory;
     std::shared_ptr<EventSink> const event_sink;
     std::shared_ptr<MessageSender> const message_sender;
+    std::shared_ptr<detail::InputEventRing> input_event_ring;
     std::shared_ptr<MessageResourceCache> const resource_cache;
     ConnectionContext const connection_context;
     std::shared_ptr<input::CursorImages> const cursor_images;
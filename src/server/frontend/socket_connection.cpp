@@ -97,7 +97,6 @@ try
         BOOST_THROW_EXCEPTION(std::runtime_error(error.message()));
     }
 
-    mir::protobuf::wire::Invocation invocation;
     invocation.ParseFromArray(body.data(), body.size());
 
     int const v = invocation.has_protocol_version() ?
@@ -107,7 +106,7 @@ try
         v >= mir::protobuf::next_incompatible_protocol_version())
         BOOST_THROW_EXCEPTION(std::runtime_error("Unsupported protocol version"));
 
-    std::vector<mir::Fd> fds;
+    fds.clear();
     if (invocation.side_channel_fds() > 0)
     {
         fds.resize(invocation.side_channel_fds());
@@ -120,7 +119,12 @@ try
         processor->client_pid(client_pid);
     }
 
-    if (processor->dispatch(invocation, fds))
+    auto const dispatched = processor->dispatch(invocation, fds);
+
+    // Don't hold the client's fds open until its next message
+    fds.clear();
+
+    if (dispatched)
     {
         read_next_message();
     }
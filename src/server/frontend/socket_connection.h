@@ -21,6 +21,9 @@
 #define MIR_FRONTEND_DETAIL_SOCKET_CONNECTION_H_
 
 #include "mir/frontend/connections.h"
+#include "mir/fd.h"
+
+#include "mir_protobuf_wire.pb.h"
 
 #include <boost/asio.hpp>
 
@@ -64,6 +67,10 @@ private:
     char header[header_size];
     std::vector<char> body;
 
+    // Reused for each message, so that their storage is only allocated as the connection starts
+    mir::protobuf::wire::Invocation invocation;
+    std::vector<mir::Fd> fds;
+
     int client_pid = 0;
 };
 
@@ -17,7 +17,6 @@
  */
 
 #include "socket_messenger.h"
-#include "mir/frontend/client_constants.h"
 #include "mir/variable_length_array.h"
 #include "mir/fd_socket_transmission.h"
 #include "mir/raii.h"
@@ -26,23 +25,33 @@
 
 #include <errno.h>
 #include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
 
 #include <stdexcept>
+#include <system_error>
 
 namespace mf = mir::frontend;
 namespace mfd = mf::detail;
 namespace bs = boost::system;
 namespace ba = boost::asio;
 
+namespace
+{
+size_t const header_size{2};
+
+/// Each set of fds travels on a byte of its own, as mir::send_fds() sends them and clients receive them
+char const fd_carrier{'M'};
+}
+
 mfd::SocketMessenger::SocketMessenger(std::shared_ptr<ba::local::stream_protocol::socket> const& socket)
     : socket(socket),
       socket_fd{IntOwnedFd{socket->native_handle()}}
 {
     // Make the socket non-blocking to avoid hanging the server when a client
-    // is unresponsive. Also increase the send buffer size to 64KiB to allow
-    // more leeway for transient client freezes.
+    // is unresponsive; what the socket won't take is queued by send(). Also
+    // increase the send buffer size to 64KiB so that queuing is the exception.
     // See https://bugs.launchpad.net/mir/+bug/1350207
-    // TODO: Rework the messenger to support asynchronous sends
     socket->non_blocking(true);
     boost::asio::socket_base::send_buffer_size option(64*1024);
     socket->set_option(option);
@@ -73,24 +82,171 @@ mf::SessionCredentials mfd::SocketMessenger::client_creds()
 
 void mfd::SocketMessenger::send(char const* data, size_t length, FdSets const& fd_set)
 {
-    static size_t const header_size{2};
-    mir::VariableLengthArray<mf::serialization_buffer_size> whole_message{header_size + length};
+    char header[header_size] = {
+        static_cast<char>((length >> 8) & 0xff),
+        static_cast<char>((length >> 0) & 0xff)};
 
-    whole_message.data()[0] = static_cast<unsigned char>((length >> 8) & 0xff);
-    whole_message.data()[1] = static_cast<unsigned char>((length >> 0) & 0xff);
-    std::copy(data, data + length, whole_message.data() + header_size);
+    std::lock_guard<std::mutex> lock{message_lock};
 
-    std::unique_lock<std::mutex> lg(message_lock);
+    // Nothing is written ahead of what's already queued: mf::SessionMediator::create_surface (among
+    // others) relies on messages and their fds reaching the client in the order they are sent.
+    size_t written{0};
+    if (pending.empty())
+    {
+        iovec iov[] = {{header, header_size}, {const_cast<char*>(data), length}};
+        written = write_some(iov, 2, {});
+    }
 
-    // TODO: This should be asynchronous, but we are not making sure
-    // that a potential call to send_fds is executed _after_ this
-    // function has completed (if it would be executed asynchronously.
-    // NOTE: we rely on this synchronous behavior as per the comment in
-    // mf::SessionMediator::create_surface
-    ba::write(*socket, ba::buffer(whole_message.data(), whole_message.size()));
+    if (written < header_size + length)
+    {
+        PendingWrite write{{}, 0, {}};
+        write.bytes.reserve(header_size + length - written);
+        if (written < header_size)
+            write.bytes.insert(write.bytes.end(), header + written, header + header_size);
+        auto const payload_written = written > header_size ? written - header_size : 0;
+        write.bytes.insert(write.bytes.end(), data + payload_written, data + length);
+        queue(lock, std::move(write));
+    }
 
     for (auto const& fds : fd_set)
-        mir::send_fds(socket_fd, fds);
+    {
+        if (fds.empty())
+            continue;
+
+        iovec iov{const_cast<char*>(&fd_carrier), 1};
+        if (!pending.empty() || write_some(&iov, 1, fds) == 0)
+            queue(lock, PendingWrite{{fd_carrier}, 0, fds});
+    }
+
+    if (!pending.empty())
+        wait_until_writable(lock);
+}
+
+auto mfd::SocketMessenger::write_some(iovec* iov, size_t iov_count, std::vector<Fd> const& fds) -> size_t
+{
+    static auto const builtin_n_fds = 5;
+    static auto const builtin_cmsg_space = CMSG_SPACE(builtin_n_fds * sizeof(int));
+    auto const fds_bytes = fds.size() * sizeof(int);
+    mir::VariableLengthArray<builtin_cmsg_space> control{fds.empty() ? 0 : CMSG_SPACE(fds_bytes)};
+
+    msghdr header{};
+    header.msg_iov = iov;
+    header.msg_iovlen = iov_count;
+
+    if (!fds.empty())
+    {
+        // Silence valgrind uninitialized memory complaint
+        memset(control.data(), 0, control.size());
+        header.msg_control = control.data();
+        header.msg_controllen = control.size();
+
+        auto const message = CMSG_FIRSTHDR(&header);
+        message->cmsg_len = CMSG_LEN(fds_bytes);
+        message->cmsg_level = SOL_SOCKET;
+        message->cmsg_type = SCM_RIGHTS;
+
+        auto fd_data = reinterpret_cast<int*>(CMSG_DATA(message));
+        for (auto const& fd : fds)
+            *fd_data++ = fd;
+    }
+
+    for (;;)
+    {
+        auto const sent = sendmsg(socket_fd, &header, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent >= 0)
+            return sent;
+
+        switch (errno)
+        {
+        case EINTR:
+            continue;
+
+        case EAGAIN:
+#if EAGAIN != EWOULDBLOCK
+        case EWOULDBLOCK:
+#endif
+            return 0;
+
+        default:
+            BOOST_THROW_EXCEPTION((std::system_error{errno, std::system_category(), "Failed to send message to client"}));
+        }
+    }
+}
+
+void mfd::SocketMessenger::queue(std::lock_guard<std::mutex> const&, PendingWrite&& write)
+{
+    pending_bytes += write.bytes.size() - write.written;
+    pending.push_back(std::move(write));
+
+    if (pending_bytes > max_pending_bytes)
+    {
+        // The client isn't reading: rather than buffer without limit, disconnect it. Its
+        // pending read fails and the connection is torn down as for any other lost client.
+        pending.clear();
+        pending_bytes = 0;
+        ::shutdown(socket_fd, SHUT_RDWR);
+        BOOST_THROW_EXCEPTION(std::runtime_error("Client is not reading its messages; disconnected"));
+    }
+}
+
+void mfd::SocketMessenger::write_pending(std::lock_guard<std::mutex> const&)
+{
+    while (!pending.empty())
+    {
+        auto& write = pending.front();
+
+        // A set of fds goes on its own byte, so is never split by a partial write
+        iovec iov{write.bytes.data() + write.written, write.bytes.size() - write.written};
+        auto const written = write_some(&iov, 1, write.fds);
+        if (written == 0)
+            return;
+
+        write.written += written;
+        pending_bytes -= written;
+
+        if (write.written < write.bytes.size())
+            return;
+
+        pending.pop_front();
+    }
+}
+
+void mfd::SocketMessenger::wait_until_writable(std::lock_guard<std::mutex> const&)
+{
+    if (waiting_until_writable)
+        return;
+
+    waiting_until_writable = true;
+
+    socket->async_write_some(
+        ba::null_buffers(),
+        [weak_self = weak_from_this()](bs::error_code const& error, size_t)
+        {
+            auto const self = weak_self.lock();
+            if (!self)
+                return;
+
+            std::lock_guard<std::mutex> lock{self->message_lock};
+            self->waiting_until_writable = false;
+
+            try
+            {
+                if (error)
+                    BOOST_THROW_EXCEPTION(bs::system_error(error));
+
+                self->write_pending(lock);
+            }
+            catch (std::exception const&)
+            {
+                // The client has gone: the read side finds out and tears down the connection
+                self->pending.clear();
+            }
+
+            if (self->pending.empty())
+                self->pending_bytes = 0;
+            else
+                self->wait_until_writable(lock);
+        });
 }
 
 void mfd::SocketMessenger::async_receive_msg(
@@ -21,7 +21,12 @@
 #include "message_sender.h"
 #include "message_receiver.h"
 #include "mir/frontend/session_credentials.h"
+#include <deque>
+#include <memory>
 #include <mutex>
+#include <vector>
+
+struct iovec;
 
 namespace mir
 {
@@ -29,8 +34,16 @@ namespace frontend
 {
 namespace detail
 {
+/**
+ * Sends messages without blocking the sending thread on a client that isn't reading
+ *
+ * Whatever the socket won't take straight away is queued, in order, and written from the socket's
+ * io_service when the client makes room. A client that lets more than max_pending_bytes queue up
+ * is disconnected.
+ */
 class SocketMessenger : public MessageSender,
-                        public MessageReceiver
+                        public MessageReceiver,
+                        public std::enable_shared_from_this<SocketMessenger>
 {
 public:
     SocketMessenger(std::shared_ptr<boost::asio::local::stream_protocol::socket> const& socket);
@@ -43,15 +56,34 @@ public:
     SessionCredentials client_creds() override;
     void receive_fds(std::vector<Fd>& fds) override;
 
+    static size_t const max_pending_bytes{1024*1024};
+
 private:
+    /// Message bytes, or the dummy byte carrying a set of fds, not yet written
+    struct PendingWrite
+    {
+        std::vector<char> bytes;
+        size_t written;
+        std::vector<Fd> fds;
+    };
+
     void set_passcred(int opt);
     void update_session_creds();
     SessionCredentials creator_creds() const;
 
+    /// Writes what it can without blocking, returning how much
+    auto write_some(iovec* iov, size_t iov_count, std::vector<Fd> const& fds) -> size_t;
+    void queue(std::lock_guard<std::mutex> const&, PendingWrite&& write);
+    void write_pending(std::lock_guard<std::mutex> const&);
+    void wait_until_writable(std::lock_guard<std::mutex> const&);
+
     std::shared_ptr<boost::asio::local::stream_protocol::socket> socket;
     mir::Fd socket_fd;
 
     std::mutex message_lock;
+    std::deque<PendingWrite> pending;
+    size_t pending_bytes{0};
+    bool waiting_until_writable{false};
     SessionCredentials session_creds{0, 0, 0};
 };
 }
@@ -0,0 +1,44 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "client_backlog.h"
+
+#include <wayland-server-core.h>
+
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <linux/sockios.h>
+
+namespace mf = mir::frontend;
+
+auto mf::client_is_backlogged(wl_client* client) -> bool
+{
+    return socket_is_backlogged(wl_client_get_fd(client));
+}
+
+auto mf::socket_is_backlogged(int fd) -> bool
+{
+    int unread{0};
+    if (ioctl(fd, SIOCOUTQ, &unread) < 0)
+        return false;
+
+    int capacity{0};
+    socklen_t size{sizeof(capacity)};
+    if (getsockopt(fd, SOL_SOCKET, SO_SNDBUF, &capacity, &size) < 0)
+        return false;
+
+    return unread > capacity / 2;
+}
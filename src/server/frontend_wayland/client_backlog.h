@@ -0,0 +1,41 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_FRONTEND_CLIENT_BACKLOG_H
+#define MIR_FRONTEND_CLIENT_BACKLOG_H
+
+#include <chrono>
+
+struct wl_client;
+
+namespace mir
+{
+namespace frontend
+{
+/// True when the client isn't keeping up with what we send it: over half its socket's send buffer is
+/// still unread. libwayland disconnects a client whose buffers overflow, so events that only update
+/// state (motion and the like) should be held back and collapsed while this holds.
+auto client_is_backlogged(wl_client* client) -> bool;
+
+/// True when over half the send buffer of the socket \a fd is still unread by its peer
+auto socket_is_backlogged(int fd) -> bool;
+
+/// How long to hold collapsed events back before looking at a backlogged client again
+std::chrono::milliseconds constexpr backlog_retry_interval{10};
+}
+}
+
+#endif // MIR_FRONTEND_CLIENT_BACKLOG_H
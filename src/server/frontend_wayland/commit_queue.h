@@ -0,0 +1,152 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_FRONTEND_COMMIT_QUEUE_H
+#define MIR_FRONTEND_COMMIT_QUEUE_H
+
+#include "mir/time/posix_timestamp.h"
+
+#include <wayland-server-core.h>
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <experimental/optional>
+#include <functional>
+#include <limits>
+#include <poll.h>
+
+namespace mir
+{
+namespace frontend
+{
+/**
+ * Surface commits waiting, in order, to be applied.
+ *
+ * The first state is held while its acquire_fence is unsignalled or until the time hold_until() gives it, and
+ * the rest wait their turn behind it. States are applied on the event loop as what they wait for arrives.
+ */
+template<typename State>
+class CommitQueue
+{
+public:
+    /// When a state may be applied, or nullopt if it may be applied now
+    using HoldUntil = std::function<std::experimental::optional<time::PosixTimestamp>(State const& state)>;
+    using Apply = std::function<void(State const& state)>;
+
+    CommitQueue(wl_event_loop* loop, HoldUntil hold_until, Apply apply)
+        : loop{loop},
+          hold_until{std::move(hold_until)},
+          apply{std::move(apply)}
+    {
+    }
+
+    ~CommitQueue()
+    {
+        if (fence_watch)
+            wl_event_source_remove(fence_watch);
+        if (timer)
+            wl_event_source_remove(timer);
+    }
+
+    CommitQueue(CommitQueue const&) = delete;
+    CommitQueue& operator=(CommitQueue const&) = delete;
+
+    auto empty() const -> bool { return states.empty(); }
+    auto queued() const -> std::deque<State> const& { return states; }
+
+    /// Adds a state behind any already waiting, and applies what is ready
+    void push(State&& state)
+    {
+        states.push_back(std::move(state));
+        apply_ready();
+    }
+
+    /// Applies states until one still has something to wait for
+    void apply_ready()
+    {
+        while (!states.empty())
+        {
+            auto& next = states.front();
+            if (next.acquire_fence)
+            {
+                pollfd fence{*next.acquire_fence, POLLIN, 0};
+                if (poll(&fence, 1, 0) == 0)
+                {
+                    if (!fence_watch)
+                    {
+                        fence_watch = wl_event_loop_add_fd(
+                            loop, *next.acquire_fence, WL_EVENT_READABLE, &on_fence_signalled, this);
+                    }
+                    return;
+                }
+                next.acquire_fence = std::experimental::nullopt;
+            }
+
+            if (auto const when = hold_until(next))
+            {
+                wake_at(when.value());
+                return;
+            }
+
+            auto const state = std::move(next);
+            states.pop_front();
+            apply(state);
+        }
+    }
+
+private:
+    wl_event_loop* const loop;
+    HoldUntil const hold_until;
+    Apply const apply;
+    std::deque<State> states;
+    wl_event_source* fence_watch{nullptr};
+    wl_event_source* timer{nullptr};
+
+    void wake_at(time::PosixTimestamp const& when)
+    {
+        if (!timer)
+        {
+            timer = wl_event_loop_add_timer(loop, &on_timeout, this);
+        }
+
+        // Rounded up, and never 0 (which would disarm the timer)
+        auto const delay = when - time::PosixTimestamp::now(when.clock_id);
+        auto const delay_ms = std::chrono::ceil<std::chrono::milliseconds>(delay).count();
+        wl_event_source_timer_update(
+            timer,
+            static_cast<int>(std::clamp<int64_t>(delay_ms, 1, std::numeric_limits<int>::max())));
+    }
+
+    static int on_fence_signalled(int /*fd*/, uint32_t /*mask*/, void* data)
+    {
+        auto const self = static_cast<CommitQueue*>(data);
+        wl_event_source_remove(self->fence_watch);
+        self->fence_watch = nullptr;
+        self->apply_ready();
+        return 0;
+    }
+
+    static int on_timeout(void* data)
+    {
+        static_cast<CommitQueue*>(data)->apply_ready();
+        return 0;
+    }
+};
+}
+}
+
+#endif // MIR_FRONTEND_COMMIT_QUEUE_H
@@ -0,0 +1,155 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "commit_timing_v1.h"
+#include "commit-timing-v1_wrapper.h"
+#include "wl_surface.h"
+
+#include <boost/throw_exception.hpp>
+
+namespace mf = mir::frontend;
+namespace mw = mir::wayland;
+
+namespace mir
+{
+namespace frontend
+{
+class CommitTimingManagerV1 : public wayland::CommitTimingManagerV1
+{
+public:
+    CommitTimingManagerV1(wl_resource* resource);
+
+    class Global : public wayland::CommitTimingManagerV1::Global
+    {
+    public:
+        Global(wl_display* display);
+
+    private:
+        void bind(wl_resource* new_wp_commit_timing_manager_v1) override;
+    };
+
+private:
+    void destroy() override;
+    void get_timer(wl_resource* id, wl_resource* surface) override;
+};
+
+/// The target time is double-buffered surface state; WlSurface holds back the commit until shortly before it
+class CommitTimerV1 : public wayland::CommitTimerV1
+{
+public:
+    CommitTimerV1(wl_resource* id, WlSurface* surface);
+    ~CommitTimerV1();
+
+private:
+    wayland::Weak<WlSurface> const surface;
+
+    void set_timestamp(uint32_t tv_sec_hi, uint32_t tv_sec_lo, uint32_t tv_nsec) override;
+    void destroy() override;
+};
+}
+}
+
+auto mf::create_commit_timing_manager_v1(wl_display* display) -> std::shared_ptr<void>
+{
+    return std::make_shared<CommitTimingManagerV1::Global>(display);
+}
+
+mf::CommitTimingManagerV1::Global::Global(wl_display* display) :
+    wayland::CommitTimingManagerV1::Global::Global{display, Version<1>{}}
+{
+}
+
+void mf::CommitTimingManagerV1::Global::bind(wl_resource* new_wp_commit_timing_manager_v1)
+{
+    new CommitTimingManagerV1{new_wp_commit_timing_manager_v1};
+}
+
+mf::CommitTimingManagerV1::CommitTimingManagerV1(wl_resource* resource) :
+    wayland::CommitTimingManagerV1{resource, Version<1>{}}
+{
+}
+
+void mf::CommitTimingManagerV1::destroy()
+{
+    destroy_wayland_object();
+}
+
+void mf::CommitTimingManagerV1::get_timer(wl_resource* id, wl_resource* surface)
+{
+    auto const wl_surface = WlSurface::from(surface);
+    if (wl_surface->commit_timer())
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::commit_timer_exists,
+            "wl_surface@%d already has a wp_commit_timer_v1",
+            wl_resource_get_id(surface)));
+    }
+
+    new CommitTimerV1{id, wl_surface};
+}
+
+mf::CommitTimerV1::CommitTimerV1(wl_resource* id, WlSurface* surface) :
+    wayland::CommitTimerV1{id, Version<1>{}},
+    surface{surface}
+{
+    surface->set_commit_timer(resource);
+}
+
+mf::CommitTimerV1::~CommitTimerV1()
+{
+    if (surface)
+        surface.value().set_commit_timer(nullptr);
+}
+
+void mf::CommitTimerV1::set_timestamp(uint32_t tv_sec_hi, uint32_t tv_sec_lo, uint32_t tv_nsec)
+{
+    if (!surface)
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::surface_destroyed,
+            "wp_commit_timer_v1@%d used after its surface was destroyed",
+            wl_resource_get_id(resource)));
+    }
+
+    if (tv_nsec >= 1000000000)
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::invalid_timestamp,
+            "tv_nsec %u is not less than a second",
+            tv_nsec));
+    }
+
+    if (surface.value().has_pending_target_time())
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::timestamp_exists,
+            "wl_surface@%d already has a timestamp for this commit",
+            wl_resource_get_id(surface.value().raw_resource())));
+    }
+
+    // In the presentation clock, which wp_presentation advertises as CLOCK_MONOTONIC
+    std::chrono::seconds const sec{(static_cast<int64_t>(tv_sec_hi) << 32) | tv_sec_lo};
+    surface.value().set_pending_target_time(
+        time::PosixTimestamp{CLOCK_MONOTONIC, sec + std::chrono::nanoseconds{tv_nsec}});
+}
+
+void mf::CommitTimerV1::destroy()
+{
+    destroy_wayland_object();
+}
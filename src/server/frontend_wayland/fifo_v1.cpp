@@ -0,0 +1,146 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "fifo_v1.h"
+#include "fifo-v1_wrapper.h"
+#include "wl_surface.h"
+
+#include <boost/throw_exception.hpp>
+
+namespace mf = mir::frontend;
+namespace mw = mir::wayland;
+
+namespace mir
+{
+namespace frontend
+{
+class FifoManagerV1 : public wayland::FifoManagerV1
+{
+public:
+    FifoManagerV1(wl_resource* resource);
+
+    class Global : public wayland::FifoManagerV1::Global
+    {
+    public:
+        Global(wl_display* display);
+
+    private:
+        void bind(wl_resource* new_wp_fifo_manager_v1) override;
+    };
+
+private:
+    void destroy() override;
+    void get_fifo(wl_resource* id, wl_resource* surface) override;
+};
+
+/// The barrier and the wait are double-buffered surface state; WlSurface holds back the commits that wait
+class FifoV1 : public wayland::FifoV1
+{
+public:
+    FifoV1(wl_resource* id, WlSurface* surface);
+    ~FifoV1();
+
+private:
+    wayland::Weak<WlSurface> const surface;
+
+    auto surface_or_throw() -> WlSurface&;
+
+    void set_barrier() override;
+    void wait_barrier() override;
+    void destroy() override;
+};
+}
+}
+
+auto mf::create_fifo_manager_v1(wl_display* display) -> std::shared_ptr<void>
+{
+    return std::make_shared<FifoManagerV1::Global>(display);
+}
+
+mf::FifoManagerV1::Global::Global(wl_display* display) :
+    wayland::FifoManagerV1::Global::Global{display, Version<1>{}}
+{
+}
+
+void mf::FifoManagerV1::Global::bind(wl_resource* new_wp_fifo_manager_v1)
+{
+    new FifoManagerV1{new_wp_fifo_manager_v1};
+}
+
+mf::FifoManagerV1::FifoManagerV1(wl_resource* resource) :
+    wayland::FifoManagerV1{resource, Version<1>{}}
+{
+}
+
+void mf::FifoManagerV1::destroy()
+{
+    destroy_wayland_object();
+}
+
+void mf::FifoManagerV1::get_fifo(wl_resource* id, wl_resource* surface)
+{
+    auto const wl_surface = WlSurface::from(surface);
+    if (wl_surface->fifo())
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::already_exists,
+            "wl_surface@%d already has a wp_fifo_v1",
+            wl_resource_get_id(surface)));
+    }
+
+    new FifoV1{id, wl_surface};
+}
+
+mf::FifoV1::FifoV1(wl_resource* id, WlSurface* surface) :
+    wayland::FifoV1{id, Version<1>{}},
+    surface{surface}
+{
+    surface->set_fifo(resource);
+}
+
+mf::FifoV1::~FifoV1()
+{
+    if (surface)
+        surface.value().set_fifo(nullptr);
+}
+
+auto mf::FifoV1::surface_or_throw() -> WlSurface&
+{
+    if (!surface)
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::surface_destroyed,
+            "wp_fifo_v1@%d used after its surface was destroyed",
+            wl_resource_get_id(resource)));
+    }
+    return surface.value();
+}
+
+void mf::FifoV1::set_barrier()
+{
+    surface_or_throw().set_pending_fifo_barrier();
+}
+
+void mf::FifoV1::wait_barrier()
+{
+    surface_or_throw().set_pending_fifo_wait();
+}
+
+void mf::FifoV1::destroy()
+{
+    destroy_wayland_object();
+}
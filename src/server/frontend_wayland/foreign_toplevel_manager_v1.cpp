@@ -97,6 +97,22 @@ private:
         std::owner_less<std::weak_ptr<scene::Surface>>> surface_observers;
 };
 
+/// Changes to a toplevel that have not yet been sent. Surfaces can change many times between iterations of the Wayland
+/// main loop (for example, a media player with a timestamp in its title), so clients get one update per iteration.
+struct PendingToplevelUpdate
+{
+    /// Sends everything gathered since the last flush, followed by a single .done event
+    void flush();
+
+    std::mutex mutex;
+    bool flush_scheduled{false};
+    /// The handle to send to, or nullptr if it has been closed
+    std::shared_ptr<wayland::Weak<ForeignToplevelHandleV1>> handle;
+    std::experimental::optional<std::string> title;
+    std::experimental::optional<std::string> app_id;
+    std::experimental::optional<std::pair<MirWindowFocusState, MirWindowState>> state;
+};
+
 /// Bound by a client in order to get notified of toplevels from other clients via ForeignToplevelHandleV1
 class ForeignSurfaceObserver
     : public scene::NullSurfaceObserver
@@ -113,6 +129,8 @@ public:
 private:
     /// if we don't have a live handle, action is not called and no error is raised
     void with_toplevel_handle(std::lock_guard<std::mutex>&, std::function<void(ForeignToplevelHandleV1&)>&& action);
+    /// if we don't have a live handle, the update is dropped. Otherwise it is sent on the next Wayland loop iteration.
+    void update_toplevel_handle(std::lock_guard<std::mutex>&, std::function<void(PendingToplevelUpdate&)>&& update);
     void create_or_close_toplevel_handle_as_needed(std::lock_guard<std::mutex>& lock);
 
     /// Surface observer
@@ -130,6 +148,7 @@ private:
     /// If nullptr, the surface is not supposed to have a handle (such as when it does not have a toplevel type)
     /// If it points to an empty Weak, the handle is being created or was destroyed by the client
     std::shared_ptr<wayland::Weak<ForeignToplevelHandleV1>> handle;
+    std::shared_ptr<PendingToplevelUpdate> const pending_update{std::make_shared<PendingToplevelUpdate>()};
 };
 
 class ForeignToplevelManagerV1
@@ -342,6 +361,26 @@ void mf::ForeignSurfaceObserver::with_toplevel_handle(
     }
 }
 
+void mf::ForeignSurfaceObserver::update_toplevel_handle(
+    std::lock_guard<std::mutex>&,
+    std::function<void(PendingToplevelUpdate&)>&& update)
+{
+    if (handle)
+    {
+        std::lock_guard<std::mutex> pending_lock{pending_update->mutex};
+        pending_update->handle = handle;
+        update(*pending_update);
+        if (!pending_update->flush_scheduled)
+        {
+            pending_update->flush_scheduled = true;
+            wayland_executor->spawn([pending_update = pending_update]()
+                {
+                    pending_update->flush();
+                });
+        }
+    }
+}
+
 void mf::ForeignSurfaceObserver::create_or_close_toplevel_handle_as_needed(std::lock_guard<std::mutex>& lock)
 {
     bool should_have_handle = true;
@@ -412,6 +451,14 @@ void mf::ForeignSurfaceObserver::create_or_close_toplevel_handle_as_needed(std::
         }
         else
         {
+            {
+                // Anything not yet sent is for a handle that's about to be closed
+                std::lock_guard<std::mutex> pending_lock{pending_update->mutex};
+                pending_update->handle = nullptr;
+                pending_update->title = std::experimental::nullopt;
+                pending_update->app_id = std::experimental::nullopt;
+                pending_update->state = std::experimental::nullopt;
+            }
             with_toplevel_handle(lock, [](ForeignToplevelHandleV1& handle)
                 {
                     handle.should_close();
@@ -456,10 +503,9 @@ void mf::ForeignSurfaceObserver::attrib_changed(const scene::Surface*, MirWindow
     {
         auto focused = surface->focus_state();
         auto state = surface->state();
-        with_toplevel_handle(lock, [focused, state](ForeignToplevelHandleV1& handle)
+        update_toplevel_handle(lock, [focused, state](PendingToplevelUpdate& update)
             {
-                handle.send_state(focused, state);
-                handle.send_done_event();
+                update.state = std::make_pair(focused, state);
             });
     }   break;
 
@@ -473,10 +519,9 @@ void mf::ForeignSurfaceObserver::renamed(ms::Surface const*, char const* name_c_
     std::lock_guard<std::mutex> lock{mutex};
 
     std::string name = name_c_str;
-    with_toplevel_handle(lock, [name](ForeignToplevelHandleV1& handle)
+    update_toplevel_handle(lock, [&name](PendingToplevelUpdate& update)
         {
-            handle.send_title_event(name);
-            handle.send_done_event();
+            update.title = std::move(name);
         });
 }
 
@@ -486,14 +531,42 @@ void mf::ForeignSurfaceObserver::application_id_set_to(
 {
     std::lock_guard<std::mutex> lock{mutex};
 
-    std::string id = application_id;
-    with_toplevel_handle(lock, [id](ForeignToplevelHandleV1& handle)
+    update_toplevel_handle(lock, [&application_id](PendingToplevelUpdate& update)
         {
-            handle.send_app_id_event(id);
-            handle.send_done_event();
+            update.app_id = application_id;
         });
 }
 
+// PendingToplevelUpdate
+
+void mf::PendingToplevelUpdate::flush()
+{
+    std::unique_lock<std::mutex> lock{mutex};
+    flush_scheduled = false;
+    auto const target = std::move(handle);
+    auto const pending_title = std::move(title);
+    auto const pending_app_id = std::move(app_id);
+    auto const pending_state = std::move(state);
+    title = std::experimental::nullopt;
+    app_id = std::experimental::nullopt;
+    state = std::experimental::nullopt;
+    lock.unlock();
+
+    if (!target || !*target || !(pending_title || pending_app_id || pending_state))
+    {
+        return;
+    }
+
+    auto& toplevel_handle = target->value();
+    if (pending_title)
+        toplevel_handle.send_title_event(pending_title.value());
+    if (pending_app_id)
+        toplevel_handle.send_app_id_event(pending_app_id.value());
+    if (pending_state)
+        toplevel_handle.send_state(pending_state.value().first, pending_state.value().second);
+    toplevel_handle.send_done_event();
+}
+
 // ForeignToplevelManagerV1
 
 mf::ForeignToplevelManagerV1::ForeignToplevelManagerV1(
@@ -0,0 +1,130 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "keymap_cache.h"
+
+#include "mir/anonymous_shm_file.h"
+#include "mir/input/keymap.h"
+#include "mir/log.h"
+
+#include <xkbcommon/xkbcommon.h>
+#include <boost/throw_exception.hpp>
+
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <fcntl.h>
+
+namespace mf = mir::frontend;
+namespace mi = mir::input;
+
+namespace
+{
+auto keymap_text(xkb_keymap* keymap) -> std::string
+{
+    std::unique_ptr<char, void(*)(void*)> const text{
+        xkb_keymap_get_as_string(keymap, XKB_KEYMAP_FORMAT_TEXT_V1),
+        &free};
+    if (!text)
+        BOOST_THROW_EXCEPTION(std::runtime_error{"Failed to serialise keymap"});
+    return text.get();
+}
+
+/// The text of each keymap, and its memfd (xkbcommon's own structures aren't counted)
+mir::MemoryAccount compiled_keymaps{"keymaps", "compiled"};
+
+/// A memfd holding text that no one (us included) can change once it's sent
+auto sealed_memfd(std::string const& text) -> std::experimental::optional<mir::Fd>
+{
+    mir::AnonymousShmFile::Options options;
+    options.sealable = true;
+
+    try
+    {
+        mir::AnonymousShmFile file{text.size(), options};
+        memcpy(file.base_ptr(), text.data(), text.size());
+        if (!file.seal())
+            return std::experimental::nullopt;
+
+        // The file closes its own descriptor
+        mir::Fd fd{fcntl(file.fd(), F_DUPFD_CLOEXEC, 0)};
+        if (fd == mir::Fd::invalid)
+            return std::experimental::nullopt;
+        return fd;
+    }
+    catch (std::system_error const&)
+    {
+        return std::experimental::nullopt;
+    }
+}
+}
+
+mf::CompiledKeymap::CompiledKeymap(xkb_keymap* keymap)
+    : keymap_{keymap, &xkb_keymap_unref},
+      text_{keymap_text(keymap)},
+      sealed_fd_{sealed_memfd(text_)},
+      charge{compiled_keymaps, sealed_fd_ ? 2 * text_.size() : text_.size()}
+{
+    if (!sealed_fd_)
+    {
+        log_warning("Could not seal a keymap file; each wl_keyboard will get its own copy");
+    }
+}
+
+mf::KeymapCache::KeymapCache()
+    : context{xkb_context_new(XKB_CONTEXT_NO_FLAGS), &xkb_context_unref}
+{
+}
+
+mf::KeymapCache::~KeymapCache() = default;
+
+auto mf::KeymapCache::compiled(mi::Keymap const& keymap) -> std::shared_ptr<CompiledKeymap const>
+{
+    Key const key{keymap.model, keymap.layout, keymap.variant, keymap.options};
+
+    std::lock_guard<std::mutex> lock{mutex};
+    auto& entry = keymaps[key];
+    if (!entry)
+    {
+        xkb_rule_names const names = {
+            "evdev",
+            keymap.model.c_str(),
+            keymap.layout.c_str(),
+            keymap.variant.c_str(),
+            keymap.options.c_str()
+        };
+
+        auto const xkb_keymap = xkb_keymap_new_from_names(context.get(), &names, XKB_KEYMAP_COMPILE_NO_FLAGS);
+        if (!xkb_keymap)
+        {
+            keymaps.erase(key);
+            BOOST_THROW_EXCEPTION(std::runtime_error{"Failed to compile keymap"});
+        }
+
+        try
+        {
+            entry = std::make_shared<CompiledKeymap>(xkb_keymap);
+        }
+        catch (...)
+        {
+            // CompiledKeymap has taken ownership of xkb_keymap, even on failure
+            keymaps.erase(key);
+            throw;
+        }
+    }
+    return entry;
+}
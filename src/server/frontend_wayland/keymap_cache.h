@@ -0,0 +1,93 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_FRONTEND_KEYMAP_CACHE_H
+#define MIR_FRONTEND_KEYMAP_CACHE_H
+
+#include "mir/fd.h"
+#include "mir/memory_account.h"
+
+#include <experimental/optional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+// from <xkbcommon/xkbcommon.h>
+struct xkb_keymap;
+struct xkb_context;
+
+namespace mir
+{
+namespace input
+{
+class Keymap;
+}
+
+namespace frontend
+{
+/// An xkb keymap compiled once, with the text every wl_keyboard using it is sent
+class CompiledKeymap
+{
+public:
+    CompiledKeymap(xkb_keymap* keymap);
+
+    CompiledKeymap(CompiledKeymap const&) = delete;
+    CompiledKeymap& operator=(CompiledKeymap const&) = delete;
+
+    /// Shared, so must only be used to create xkb_states (which aren't)
+    auto keymap() const -> xkb_keymap* { return keymap_.get(); }
+    auto text() const -> std::string const& { return text_; }
+    /**
+     * A sealed, read-only memfd holding text(), which can be sent to any
+     * number of clients (nullopt if the kernel can't seal one)
+     */
+    auto sealed_fd() const -> std::experimental::optional<Fd> const& { return sealed_fd_; }
+
+private:
+    std::unique_ptr<xkb_keymap, void (*)(xkb_keymap*)> const keymap_;
+    std::string const text_;
+    std::experimental::optional<Fd> const sealed_fd_;
+    MemoryCharge const charge;
+};
+
+/**
+ * Compiles each distinct keymap once for the whole server, rather than once per wl_keyboard
+ *
+ * Keymaps are kept for the life of the cache: there are only ever a handful of
+ * distinct ones, and the next client to log in probably wants the same again.
+ */
+class KeymapCache
+{
+public:
+    KeymapCache();
+    ~KeymapCache();
+
+    auto compiled(input::Keymap const& keymap) -> std::shared_ptr<CompiledKeymap const>;
+
+private:
+    using Key = std::tuple<std::string, std::string, std::string, std::string>;
+
+    std::unique_ptr<xkb_context, void (*)(xkb_context*)> const context;
+
+    std::mutex mutex;
+    std::map<Key, std::shared_ptr<CompiledKeymap const>> keymaps;
+};
+}
+}
+
+#endif // MIR_FRONTEND_KEYMAP_CACHE_H
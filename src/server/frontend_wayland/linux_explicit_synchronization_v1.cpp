@@ -0,0 +1,245 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "linux_explicit_synchronization_v1.h"
+#include "wl_surface.h"
+#include "deleted_for_resource.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <linux/dma-buf.h>
+#include <linux/sync_file.h>
+#include <sys/ioctl.h>
+#include <cstring>
+
+namespace mf = mir::frontend;
+namespace mw = mir::wayland;
+
+namespace mir
+{
+namespace frontend
+{
+class LinuxExplicitSynchronizationV1 : public wayland::LinuxExplicitSynchronizationV1
+{
+public:
+    LinuxExplicitSynchronizationV1(wl_resource* resource);
+
+    class Global : public wayland::LinuxExplicitSynchronizationV1::Global
+    {
+    public:
+        Global(wl_display* display);
+
+    private:
+        void bind(wl_resource* new_zwp_linux_explicit_synchronization_v1) override;
+    };
+
+private:
+    void destroy() override;
+    void get_synchronization(wl_resource* id, wl_resource* surface) override;
+};
+
+class LinuxSurfaceSynchronizationV1 : public wayland::LinuxSurfaceSynchronizationV1
+{
+public:
+    LinuxSurfaceSynchronizationV1(wl_resource* id, WlSurface* surface);
+    ~LinuxSurfaceSynchronizationV1();
+
+private:
+    wayland::Weak<WlSurface> const surface;
+
+    /// Raises no_surface if the surface has gone
+    auto live_surface() -> WlSurface&;
+
+    void destroy() override;
+    void set_acquire_fence(mir::Fd fd) override;
+    void get_release(wl_resource* release) override;
+};
+}
+}
+
+namespace
+{
+/// A sync_file for the compositor's outstanding reads of dma_buf, or an invalid Fd if the kernel can't give us one
+auto export_read_fence(mir::Fd const& dma_buf) -> mir::Fd
+{
+#ifdef DMA_BUF_IOCTL_EXPORT_SYNC_FILE
+    // Asking for the fences a writer must wait on gives us our reads as well as any writes
+    dma_buf_export_sync_file args{};
+    args.flags = DMA_BUF_SYNC_WRITE;
+    args.fd = -1;
+    if (ioctl(dma_buf, DMA_BUF_IOCTL_EXPORT_SYNC_FILE, &args) == 0)
+        return mir::Fd{args.fd};
+#else
+    (void)dma_buf;
+#endif
+    return mir::Fd{};
+}
+
+auto merge_fences(mir::Fd const& a, mir::Fd const& b) -> mir::Fd
+{
+    sync_merge_data data{};
+    strncpy(data.name, "mir buffer release", sizeof(data.name) - 1);
+    data.fd2 = b;
+    if (ioctl(a, SYNC_IOC_MERGE, &data) < 0)
+        return mir::Fd{};
+    return mir::Fd{data.fence};
+}
+}
+
+auto mf::create_linux_explicit_synchronization_v1(wl_display* display) -> std::shared_ptr<void>
+{
+    return std::make_shared<LinuxExplicitSynchronizationV1::Global>(display);
+}
+
+mf::LinuxExplicitSynchronizationV1::Global::Global(wl_display* display) :
+    wayland::LinuxExplicitSynchronizationV1::Global::Global{display, Version<2>{}}
+{
+}
+
+void mf::LinuxExplicitSynchronizationV1::Global::bind(wl_resource* new_zwp_linux_explicit_synchronization_v1)
+{
+    new LinuxExplicitSynchronizationV1{new_zwp_linux_explicit_synchronization_v1};
+}
+
+mf::LinuxExplicitSynchronizationV1::LinuxExplicitSynchronizationV1(wl_resource* resource) :
+    wayland::LinuxExplicitSynchronizationV1{resource, Version<2>{}}
+{
+}
+
+void mf::LinuxExplicitSynchronizationV1::destroy()
+{
+    destroy_wayland_object();
+}
+
+void mf::LinuxExplicitSynchronizationV1::get_synchronization(wl_resource* id, wl_resource* surface)
+{
+    auto const wl_surface = WlSurface::from(surface);
+    if (wl_surface->explicit_synchronization())
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::synchronization_exists,
+            "wl_surface@%d already has explicit synchronization",
+            wl_resource_get_id(surface)));
+    }
+
+    new LinuxSurfaceSynchronizationV1{id, wl_surface};
+}
+
+mf::LinuxSurfaceSynchronizationV1::LinuxSurfaceSynchronizationV1(wl_resource* id, WlSurface* surface) :
+    wayland::LinuxSurfaceSynchronizationV1{id, Version<2>{}},
+    surface{surface}
+{
+    surface->set_explicit_synchronization(resource);
+}
+
+mf::LinuxSurfaceSynchronizationV1::~LinuxSurfaceSynchronizationV1()
+{
+    if (surface)
+        surface.value().set_explicit_synchronization(nullptr);
+}
+
+auto mf::LinuxSurfaceSynchronizationV1::live_surface() -> WlSurface&
+{
+    if (!surface)
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::no_surface,
+            "The wl_surface has been destroyed"));
+    }
+    return surface.value();
+}
+
+void mf::LinuxSurfaceSynchronizationV1::destroy()
+{
+    destroy_wayland_object();
+}
+
+void mf::LinuxSurfaceSynchronizationV1::set_acquire_fence(mir::Fd fd)
+{
+    auto& wl_surface = live_surface();
+
+    sync_file_info info{};
+    if (ioctl(fd, SYNC_IOC_FILE_INFO, &info) < 0)
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::invalid_fence,
+            "fd %d is not a sync_file",
+            static_cast<int>(fd)));
+    }
+
+    if (wl_surface.has_pending_acquire_fence())
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::duplicate_fence,
+            "An acquire fence has already been set for this commit"));
+    }
+
+    wl_surface.set_pending_acquire_fence(fd);
+}
+
+void mf::LinuxSurfaceSynchronizationV1::get_release(wl_resource* release)
+{
+    auto& wl_surface = live_surface();
+
+    if (wl_surface.has_pending_buffer_release())
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::duplicate_release,
+            "A buffer release has already been requested for this commit"));
+    }
+
+    wl_surface.set_pending_buffer_release(std::make_shared<LinuxBufferReleaseV1>(release));
+}
+
+mf::LinuxBufferReleaseV1::LinuxBufferReleaseV1(wl_resource* new_resource) :
+    wayland::LinuxBufferReleaseV1{new_resource, Version<1>{}},
+    destroyed{deleted_flag_for_resource(resource)}
+{
+}
+
+void mf::LinuxBufferReleaseV1::release(std::vector<mir::Fd> const& dma_bufs)
+{
+    if (*destroyed)
+        return;
+
+    // Without a fence for every dma-buf we fall back on implicit synchronization, as wl_buffer.release does
+    mir::Fd fence;
+    for (auto const& dma_buf : dma_bufs)
+    {
+        auto const plane_fence = export_read_fence(dma_buf);
+        if (plane_fence == mir::Fd::invalid)
+        {
+            fence = mir::Fd{};
+            break;
+        }
+
+        fence = fence == mir::Fd::invalid ? plane_fence : merge_fences(fence, plane_fence);
+        if (fence == mir::Fd::invalid)
+            break;
+    }
+
+    // Both events destroy the object
+    if (fence != mir::Fd::invalid)
+        send_fenced_release_event(fence);
+    else
+        send_immediate_release_event();
+    destroy_wayland_object();
+}
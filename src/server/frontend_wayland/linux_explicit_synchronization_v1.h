@@ -0,0 +1,47 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_FRONTEND_LINUX_EXPLICIT_SYNCHRONIZATION_V1_H
+#define MIR_FRONTEND_LINUX_EXPLICIT_SYNCHRONIZATION_V1_H
+
+#include "linux-explicit-synchronization-unstable-v1_wrapper.h"
+
+#include <memory>
+#include <vector>
+
+struct wl_display;
+
+namespace mir
+{
+namespace frontend
+{
+auto create_linux_explicit_synchronization_v1(wl_display* display) -> std::shared_ptr<void>;
+
+/// Tells the client when the compositor has finished with the buffer of one commit
+class LinuxBufferReleaseV1 : public wayland::LinuxBufferReleaseV1
+{
+public:
+    LinuxBufferReleaseV1(wl_resource* new_resource);
+
+    /// Sends fenced_release if the dma-bufs can give us a fence for our reads, and immediate_release otherwise
+    void release(std::vector<mir::Fd> const& dma_bufs);
+
+    std::shared_ptr<bool> const destroyed;
+};
+}
+}
+
+#endif  // MIR_FRONTEND_LINUX_EXPLICIT_SYNCHRONIZATION_V1_H
@@ -0,0 +1,133 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_FRONTEND_MOTION_BACKLOG_H
+#define MIR_FRONTEND_MOTION_BACKLOG_H
+
+#include "client_backlog.h"
+
+#include <wayland-server-core.h>
+
+#include <functional>
+#include <map>
+
+namespace mir
+{
+namespace frontend
+{
+/**
+ * Motion for a client, sent as it happens unless the client is backlogged.
+ *
+ * While it is, only the latest motion of each key (a touch ID, say) is kept. What is held back is sent once a
+ * look on the event loop finds the client has caught up, or when flush() is called before an event that can't
+ * be collapsed.
+ */
+template<typename Key, typename Motion>
+class MotionBacklog
+{
+public:
+    using IsBacklogged = std::function<bool()>;
+    using Send = std::function<void(Key const& key, Motion const& motion)>;
+    /// Called once the event loop has sent what was held back (to send a frame event, say)
+    using Caught = std::function<void()>;
+
+    MotionBacklog(wl_event_loop* loop, IsBacklogged is_backlogged, Send send, Caught caught)
+        : loop{loop},
+          is_backlogged{std::move(is_backlogged)},
+          send{std::move(send)},
+          caught{std::move(caught)}
+    {
+    }
+
+    ~MotionBacklog()
+    {
+        if (timer)
+            wl_event_source_remove(timer);
+    }
+
+    MotionBacklog(MotionBacklog const&) = delete;
+    MotionBacklog& operator=(MotionBacklog const&) = delete;
+
+    auto held_back() const -> std::map<Key, Motion> const& { return pending; }
+
+    /// Sends \a motion, or holds it back in place of any held back for \a key
+    void motion(Key const& key, Motion const& motion)
+    {
+        // Once anything is held back everything is, so motion isn't sent out of order
+        if (pending.empty() && !is_backlogged())
+        {
+            send(key, motion);
+            return;
+        }
+
+        pending.insert_or_assign(key, motion);
+        arm_timer();
+    }
+
+    /// Sends everything held back now
+    void flush()
+    {
+        for (auto const& [key, motion] : pending)
+            send(key, motion);
+        pending.clear();
+
+        if (timer_armed)
+        {
+            wl_event_source_timer_update(timer, 0);
+            timer_armed = false;
+        }
+    }
+
+private:
+    wl_event_loop* const loop;
+    IsBacklogged const is_backlogged;
+    Send const send;
+    Caught const caught;
+    std::map<Key, Motion> pending;
+    wl_event_source* timer{nullptr};
+    bool timer_armed{false};
+
+    void arm_timer()
+    {
+        if (timer_armed)
+            return;
+
+        if (!timer)
+            timer = wl_event_loop_add_timer(loop, &on_timeout, this);
+
+        wl_event_source_timer_update(timer, backlog_retry_interval.count());
+        timer_armed = true;
+    }
+
+    static int on_timeout(void* data)
+    {
+        auto const self = static_cast<MotionBacklog*>(data);
+        self->timer_armed = false;
+        if (self->is_backlogged())
+        {
+            // Keep collapsing into what's held back until the client catches up
+            self->arm_timer();
+            return 0;
+        }
+        self->flush();
+        self->caught();
+        return 0;
+    }
+};
+}
+}
+
+#endif // MIR_FRONTEND_MOTION_BACKLOG_H
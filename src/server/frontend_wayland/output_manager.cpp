@@ -27,7 +27,8 @@ using namespace mir::geometry;
 
 mf::Output::Output(wl_display* display, mg::DisplayConfigurationOutput const& initial_configuration) :
     output{make_output(display)},
-    current_config{initial_configuration}
+    current_config{initial_configuration},
+    events{events_for(initial_configuration)}
 {
 }
 
@@ -56,12 +57,21 @@ mf::Output::~Output()
 
 void mf::Output::handle_configuration_changed(mg::DisplayConfigurationOutput const& config)
 {
+    current_config = config;
+
+    auto new_events = events_for(config);
+    if (new_events == events)
+    {
+        // Nothing clients can see has changed
+        return;
+    }
+    events = std::move(new_events);
+
     for (auto const& client : resource_map)
     {
         for (auto const& resource : client.second)
         {
-            // Possibly not optimal
-            send_initial_config(resource, config);
+            send_events(resource, events);
         }
     }
 }
@@ -123,38 +133,73 @@ auto transform_size(Size const& size, MirOrientation orientation) -> Size
 }
 }
 
-void mf::Output::send_initial_config(wl_resource* client_resource, mg::DisplayConfigurationOutput const& config)
+auto mf::Output::Events::operator==(Events const& other) const -> bool
 {
-    // TODO: send correct output transform
-    //       this will cause some clients to send transformed buffers, which we must be able to deal with
-    wl_output_send_geometry(
-        client_resource,
+    auto const same_mode = [](Mode const& a, Mode const& b)
+        {
+            return a.flags == b.flags && a.width == b.width && a.height == b.height && a.refresh == b.refresh;
+        };
+
+    return x == other.x &&
+           y == other.y &&
+           physical_width == other.physical_width &&
+           physical_height == other.physical_height &&
+           subpixel == other.subpixel &&
+           scale == other.scale &&
+           std::equal(modes.begin(), modes.end(), other.modes.begin(), other.modes.end(), same_mode);
+}
+
+auto mf::Output::events_for(mg::DisplayConfigurationOutput const& config) -> Events
+{
+    Events result{
         config.top_left.x.as_int(),
         config.top_left.y.as_int(),
         config.physical_size_mm.width.as_int(),
         config.physical_size_mm.height.as_int(),
         as_subpixel_arrangement(config.subpixel_arrangement),
-        "Fake manufacturer",
-        "Fake model",
-        WL_OUTPUT_TRANSFORM_NORMAL);
+        {},
+        static_cast<int32_t>(ceil(config.scale))};
+
     for (size_t i = 0; i < config.modes.size(); ++i)
     {
         auto const& mode = config.modes[i];
 
-        // As we are not sending the display orientation as a transform (see above),
+        // As we are not sending the display orientation as a transform (see send_events()),
         // we doctor the size of each mode to match the extents
         auto const size = transform_size(mode.size, config.orientation);
-        wl_output_send_mode(
-            client_resource,
-            ((i == config.preferred_mode_index ? WL_OUTPUT_MODE_PREFERRED : 0) |
-             (i == config.current_mode_index ? WL_OUTPUT_MODE_CURRENT : 0)),
-             size.width.as_int(),
-             size.height.as_int(),
-            mode.vrefresh_hz * 1000);
+        result.modes.push_back({
+            static_cast<uint32_t>(
+                (i == config.preferred_mode_index ? WL_OUTPUT_MODE_PREFERRED : 0) |
+                (i == config.current_mode_index ? WL_OUTPUT_MODE_CURRENT : 0)),
+            size.width.as_int(),
+            size.height.as_int(),
+            static_cast<int32_t>(mode.vrefresh_hz * 1000)});
+    }
+
+    return result;
+}
+
+void mf::Output::send_events(wl_resource* client_resource, Events const& events)
+{
+    // TODO: send correct output transform
+    //       this will cause some clients to send transformed buffers, which we must be able to deal with
+    wl_output_send_geometry(
+        client_resource,
+        events.x,
+        events.y,
+        events.physical_width,
+        events.physical_height,
+        events.subpixel,
+        "Fake manufacturer",
+        "Fake model",
+        WL_OUTPUT_TRANSFORM_NORMAL);
+    for (auto const& mode : events.modes)
+    {
+        wl_output_send_mode(client_resource, mode.flags, mode.width, mode.height, mode.refresh);
     }
 
     if (wl_resource_get_version(client_resource) >= WL_OUTPUT_SCALE_SINCE_VERSION)
-        wl_output_send_scale(client_resource, ceil(config.scale));
+        wl_output_send_scale(client_resource, events.scale);
 
     if (wl_resource_get_version(client_resource) >= WL_OUTPUT_DONE_SINCE_VERSION)
         wl_output_send_done(client_resource);
@@ -196,7 +241,7 @@ void mf::Output::on_bind(wl_client* client, void* data, uint32_t version, uint32
     output->resource_map[client].push_back(resource);
     wl_resource_set_implementation(resource, &wl_output_impl, &(output->resource_map), mf::Output::resource_destructor);
 
-    send_initial_config(resource, output->current_config);
+    send_events(resource, output->events);
 }
 
 void mf::Output::resource_destructor(wl_resource* resource)
@@ -255,6 +300,17 @@ auto mf::OutputManager::output_for(graphics::DisplayConfigurationOutputId id) ->
         return std::experimental::nullopt;
 }
 
+auto mf::OutputManager::output_showing(Rectangle const& area) -> std::experimental::optional<Output*>
+{
+    for (auto const& output : outputs)
+    {
+        if (output.second->configuration().extents() == area)
+            return output.second.get();
+    }
+
+    return std::experimental::nullopt;
+}
+
 void mf::OutputManager::create_output(mg::DisplayConfigurationOutput const& initial_config)
 {
     if (initial_config.used)
@@ -49,8 +49,34 @@ public:
 
     void for_each_output_resource_bound_by(wl_client* client, std::function<void(wl_resource*)> const& functor);
 
+    auto configuration() const -> graphics::DisplayConfigurationOutput const& { return current_config; }
+
 private:
-    static void send_initial_config(wl_resource* client_resource, graphics::DisplayConfigurationOutput const& config);
+    /// The wl_output events describing a configuration. These are worked out once per configuration change, rather
+    /// than for every client that binds.
+    struct Events
+    {
+        struct Mode
+        {
+            uint32_t flags;
+            int32_t width;
+            int32_t height;
+            int32_t refresh;
+        };
+
+        int32_t x;
+        int32_t y;
+        int32_t physical_width;
+        int32_t physical_height;
+        int32_t subpixel;
+        std::vector<Mode> modes;
+        int32_t scale;
+
+        auto operator==(Events const& other) const -> bool;
+    };
+
+    static auto events_for(graphics::DisplayConfigurationOutput const& config) -> Events;
+    static void send_events(wl_resource* client_resource, Events const& events);
 
     wl_global* make_output(wl_display* display);
 
@@ -61,6 +87,7 @@ private:
 private:
     wl_global* const output;
     graphics::DisplayConfigurationOutput current_config;
+    Events events;
     std::unordered_map<wl_client*, std::vector<wl_resource*>> resource_map;
 };
 
@@ -75,6 +102,9 @@ public:
 
     auto output_for(graphics::DisplayConfigurationOutputId id) -> std::experimental::optional<Output*>;
 
+    /// The output showing exactly the given area of the scene, if there is one
+    auto output_showing(geometry::Rectangle const& area) -> std::experimental::optional<Output*>;
+
     auto display_config() const -> std::shared_ptr<MirDisplay> {return display_config_;}
 
 private:
@@ -0,0 +1,171 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "presentation_time.h"
+#include "wl_surface.h"
+#include "output_manager.h"
+#include "deleted_for_resource.h"
+
+#include "mir/compositor/presentation.h"
+
+#include <ctime>
+
+namespace mf = mir::frontend;
+namespace mw = mir::wayland;
+namespace mt = mir::time;
+
+namespace mir
+{
+namespace frontend
+{
+class Presentation : public wayland::Presentation
+{
+public:
+    Presentation(wl_resource* resource, OutputManager* output_manager);
+
+    class Global : public wayland::Presentation::Global
+    {
+    public:
+        Global(wl_display* display, OutputManager* output_manager);
+
+    private:
+        void bind(wl_resource* new_wp_presentation) override;
+
+        OutputManager* const output_manager;
+    };
+
+private:
+    void destroy() override;
+    void feedback(wl_resource* surface, wl_resource* callback) override;
+
+    OutputManager* const output_manager;
+};
+}
+}
+
+namespace
+{
+/// The clock we tell clients our timestamps are in
+clockid_t const presentation_clock{CLOCK_MONOTONIC};
+
+auto in_presentation_clock(mt::PosixTimestamp const& timestamp) -> mt::PosixTimestamp
+{
+    if (timestamp.clock_id == presentation_clock)
+        return timestamp;
+
+    auto const age = mt::PosixTimestamp::now(timestamp.clock_id) - timestamp;
+    return mt::PosixTimestamp::now(presentation_clock) - age;
+}
+}
+
+auto mf::create_presentation_time(wl_display* display, OutputManager* output_manager) -> std::shared_ptr<void>
+{
+    return std::make_shared<Presentation::Global>(display, output_manager);
+}
+
+mf::Presentation::Global::Global(wl_display* display, OutputManager* output_manager) :
+    wayland::Presentation::Global::Global{display, Version<1>{}},
+    output_manager{output_manager}
+{
+}
+
+void mf::Presentation::Global::bind(wl_resource* new_wp_presentation)
+{
+    auto const presentation = new Presentation{new_wp_presentation, output_manager};
+    presentation->send_clock_id_event(presentation_clock);
+}
+
+mf::Presentation::Presentation(wl_resource* resource, OutputManager* output_manager) :
+    wayland::Presentation{resource, Version<1>{}},
+    output_manager{output_manager}
+{
+}
+
+void mf::Presentation::destroy()
+{
+    destroy_wayland_object();
+}
+
+void mf::Presentation::feedback(wl_resource* surface, wl_resource* callback)
+{
+    WlSurface::from(surface)->add_presentation_feedback(
+        std::make_shared<PresentationFeedback>(callback, output_manager));
+}
+
+mf::PresentationFeedback::PresentationFeedback(wl_resource* new_resource, OutputManager* output_manager) :
+    wayland::PresentationFeedback{new_resource, Version<1>{}},
+    destroyed{deleted_flag_for_resource(resource)},
+    output_manager{output_manager}
+{
+}
+
+void mf::PresentationFeedback::presented(compositor::Presentation const& presentation)
+{
+    if (*destroyed)
+        return;
+
+    uint32_t refresh_ns{0};
+    if (auto const output = output_manager->output_showing(presentation.output_area))
+    {
+        output.value()->for_each_output_resource_bound_by(client, [this](wl_resource* output_resource)
+            {
+                send_sync_output_event(output_resource);
+            });
+
+        auto const& config = output.value()->configuration();
+        if (config.current_mode_index < config.modes.size())
+        {
+            auto const hz = config.modes[config.current_mode_index].vrefresh_hz;
+            if (hz > 0)
+                refresh_ns = static_cast<uint32_t>(1e9 / hz);
+        }
+    }
+
+    // A frame the platform estimated says nothing about when the flip happened, so the best we have is now
+    auto const& frame = presentation.frame;
+    bool const from_hardware{frame.hardware};
+    auto const timestamp = from_hardware ?
+        in_presentation_clock(frame.ust) :
+        mt::PosixTimestamp::now(presentation_clock);
+
+    uint32_t flags{0};
+    if (from_hardware)
+        flags |= Kind::vsync | Kind::hw_clock | Kind::hw_completion;
+    if (presentation.zero_copy)
+        flags |= Kind::zero_copy;
+
+    auto const seconds = static_cast<uint64_t>(timestamp.nanoseconds.count() / 1000000000);
+    auto const nanoseconds = static_cast<uint32_t>(timestamp.nanoseconds.count() % 1000000000);
+    auto const msc = static_cast<uint64_t>(frame.msc);
+
+    // Both events destroy the object
+    send_presented_event(
+        seconds >> 32, seconds & 0xffffffff,
+        nanoseconds,
+        refresh_ns,
+        msc >> 32, msc & 0xffffffff,
+        flags);
+    destroy_wayland_object();
+}
+
+void mf::PresentationFeedback::discarded()
+{
+    if (*destroyed)
+        return;
+
+    send_discarded_event();
+    destroy_wayland_object();
+}
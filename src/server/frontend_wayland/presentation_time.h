@@ -0,0 +1,56 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_FRONTEND_PRESENTATION_TIME_H
+#define MIR_FRONTEND_PRESENTATION_TIME_H
+
+#include "presentation-time_wrapper.h"
+
+#include <memory>
+
+struct wl_display;
+
+namespace mir
+{
+namespace compositor
+{
+struct Presentation;
+}
+namespace frontend
+{
+class OutputManager;
+
+auto create_presentation_time(wl_display* display, OutputManager* output_manager) -> std::shared_ptr<void>;
+
+/// Tells the client how the content of one commit reached the screen, or that it never did
+class PresentationFeedback : public wayland::PresentationFeedback
+{
+public:
+    PresentationFeedback(wl_resource* new_resource, OutputManager* output_manager);
+
+    /// Sends sync_output for each of the client's bindings of the output, then presented
+    void presented(compositor::Presentation const& presentation);
+    void discarded();
+
+    std::shared_ptr<bool> const destroyed;
+
+private:
+    OutputManager* const output_manager;
+};
+}
+}
+
+#endif  // MIR_FRONTEND_PRESENTATION_TIME_H
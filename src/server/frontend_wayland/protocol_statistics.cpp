@@ -0,0 +1,286 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "protocol_statistics.h"
+
+#include "wayland_frontend.tp.h"
+
+#include "mir/log.h"
+
+#include <wayland-server-core.h>
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <vector>
+
+namespace mf = mir::frontend;
+
+#if (WAYLAND_VERSION_MAJOR == 1) && (WAYLAND_VERSION_MINOR < 14)
+#define MIR_NO_WAYLAND_PROTOCOL_LOGGER
+#endif
+
+namespace
+{
+/// How many clients and requests the report names
+size_t const report_top_count{5};
+
+auto as_us(std::chrono::nanoseconds duration) -> long long
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+
+/// The histogram bucket for a handler time: n for times under 2^n us (and over 2^(n-1) us)
+auto latency_bucket(std::chrono::nanoseconds duration, size_t buckets) -> size_t
+{
+    size_t bucket{0};
+    for (auto us = as_us(duration); us > 0 && bucket + 1 < buckets; us >>= 1)
+        ++bucket;
+    return bucket;
+}
+
+/// The bound (in us) under which \a fraction of the histogram's samples fall
+template<typename Histogram>
+auto latency_percentile(Histogram const& histogram, long samples, double fraction) -> long long
+{
+    auto const wanted = std::ceil(fraction * samples);
+    long seen{0};
+    for (size_t bucket = 0; bucket != histogram.size(); ++bucket)
+    {
+        seen += histogram[bucket];
+        if (seen >= wanted)
+            return 1ll << bucket;
+    }
+    return 1ll << (histogram.size() - 1);
+}
+
+auto percent(std::chrono::nanoseconds busy, double seconds) -> long
+{
+    return std::lround(100 * std::chrono::duration<double>{busy}.count() / seconds);
+}
+}
+
+mf::ProtocolStatistics::ProtocolStatistics(wl_display* display, std::chrono::seconds report_interval)
+    : loop{wl_display_get_event_loop(display)},
+      report_interval{report_interval},
+      report_start{Clock::now()}
+{
+#ifndef MIR_NO_WAYLAND_PROTOCOL_LOGGER
+    logger = wl_display_add_protocol_logger(
+        display,
+        [](void* data, wl_protocol_logger_type direction, wl_protocol_logger_message const* message)
+        {
+            // Events are ours to send; it's the requests that cost us
+            if (direction == WL_PROTOCOL_LOGGER_REQUEST)
+                static_cast<ProtocolStatistics*>(data)->request_started(message);
+        },
+        this);
+#else
+    log_warning("Cannot account for Wayland requests: "
+        "wl_display_add_protocol_logger() is unavailable in libwayland-dev "
+        WAYLAND_VERSION);
+#endif
+
+    if (report_interval.count() > 0)
+    {
+        report_timer = wl_event_loop_add_timer(loop, &on_report_timeout, this);
+        wl_event_source_timer_update(
+            report_timer,
+            std::chrono::duration_cast<std::chrono::milliseconds>(report_interval).count());
+    }
+}
+
+mf::ProtocolStatistics::~ProtocolStatistics()
+{
+#ifndef MIR_NO_WAYLAND_PROTOCOL_LOGGER
+    if (logger)
+        wl_protocol_logger_destroy(logger);
+#endif
+    if (idle_source)
+        wl_event_source_remove(idle_source);
+    if (report_timer)
+        wl_event_source_remove(report_timer);
+}
+
+void mf::ProtocolStatistics::request_started(wl_protocol_logger_message const* message)
+{
+#ifndef MIR_NO_WAYLAND_PROTOCOL_LOGGER
+    auto const now = Clock::now();
+    finish_request(now);
+
+    // The handler may destroy the resource (or the client), so take what we need from it now
+    auto const client = wl_resource_get_client(message->resource);
+    pid_t pid{0};
+    wl_client_get_credentials(client, &pid, nullptr, nullptr);
+    current = InFlightRequest{
+        client,
+        pid,
+        wl_resource_get_class(message->resource),
+        static_cast<uint32_t>(message->message_opcode),
+        message->message->name,
+        now};
+    in_flight = true;
+
+    if (!idle_source)
+        idle_source = wl_event_loop_add_idle(loop, &on_idle, this);
+#else
+    (void)message;
+#endif
+}
+
+void mf::ProtocolStatistics::finish_request(Clock::time_point now)
+{
+    if (!in_flight)
+        return;
+    in_flight = false;
+
+    std::chrono::nanoseconds const duration{now - current.start};
+    tracepoint(
+        mir_server_wayland,
+        request_handled,
+        current.client,
+        current.interface,
+        current.request,
+        duration.count());
+
+    if (report_timer)
+    {
+        auto& totals = requests[{current.interface, current.opcode}];
+        totals.request = current.request;
+        totals.count++;
+        totals.total_time += duration;
+        totals.longest_time = std::max(totals.longest_time, duration);
+
+        requests_by_client[current.pid]++;
+        request_latency[latency_bucket(duration, request_latency.size())]++;
+    }
+}
+
+void mf::ProtocolStatistics::on_idle(void* data)
+{
+    auto const self = static_cast<ProtocolStatistics*>(data);
+    // Idle sources are freed once they've run
+    self->idle_source = nullptr;
+    self->finish_request(Clock::now());
+}
+
+void mf::ProtocolStatistics::executor_drained(
+    size_t work_items,
+    std::chrono::nanoseconds wait,
+    std::chrono::nanoseconds run_time)
+{
+    // The executor's work isn't the last request's, so don't charge it to that request
+    if (in_flight)
+        finish_request(std::max(current.start, Clock::now() - run_time));
+
+    tracepoint(
+        mir_server_wayland,
+        executor_drained,
+        static_cast<int>(work_items),
+        wait.count(),
+        run_time.count());
+
+    executor.wakeups++;
+    executor.work_items += work_items;
+    executor.most_work_items = std::max(executor.most_work_items, work_items);
+    executor.total_wait += wait;
+    executor.longest_wait = std::max(executor.longest_wait, wait);
+    executor.total_run_time += run_time;
+}
+
+int mf::ProtocolStatistics::on_report_timeout(void* data)
+{
+    auto const self = static_cast<ProtocolStatistics*>(data);
+    self->report();
+    wl_event_source_timer_update(
+        self->report_timer,
+        std::chrono::duration_cast<std::chrono::milliseconds>(self->report_interval).count());
+    return 0;
+}
+
+void mf::ProtocolStatistics::report()
+{
+    auto const now = Clock::now();
+    auto const seconds = std::max(std::chrono::duration<double>{now - report_start}.count(), 1e-3);
+    report_start = now;
+
+    std::vector<std::pair<pid_t, long>> clients{begin(requests_by_client), end(requests_by_client)};
+    auto const client_count = std::min(report_top_count, clients.size());
+    std::partial_sort(
+        begin(clients), begin(clients) + client_count, end(clients),
+        [](auto const& a, auto const& b) { return a.second > b.second; });
+
+    long total_requests{0};
+    std::chrono::nanoseconds request_time{0};
+    std::chrono::nanoseconds longest_request{0};
+    std::vector<std::pair<char const*, RequestTotals const*>> busiest;
+    for (auto const& request : requests)
+    {
+        total_requests += request.second.count;
+        request_time += request.second.total_time;
+        longest_request = std::max(longest_request, request.second.longest_time);
+        busiest.emplace_back(request.first.first, &request.second);
+    }
+    // Ranked by the Wayland thread's time they took, which is what starves everyone else
+    auto const request_count = std::min(report_top_count, busiest.size());
+    std::partial_sort(
+        begin(busiest), begin(busiest) + request_count, end(busiest),
+        [](auto const& a, auto const& b) { return a.second->total_time > b.second->total_time; });
+
+    std::ostringstream out;
+    out << "Wayland: " << std::lround(total_requests / seconds) << " requests/s";
+
+    out << "; thread " << percent(request_time + executor.total_run_time, seconds) << "% busy"
+        << " (requests " << percent(request_time, seconds) << "%"
+        << ", executor " << percent(executor.total_run_time, seconds) << "%)";
+
+    if (total_requests > 0)
+    {
+        out << "; request time: p50 <" << latency_percentile(request_latency, total_requests, 0.5) << "us"
+            << " p99 <" << latency_percentile(request_latency, total_requests, 0.99) << "us"
+            << " max " << as_us(longest_request) << "us";
+    }
+
+    out << "; busiest clients:";
+    for (auto i = begin(clients); i != begin(clients) + client_count; ++i)
+        out << " pid " << i->first << " (" << std::lround(i->second / seconds) << "/s)";
+
+    out << "; busiest requests:";
+    for (auto i = begin(busiest); i != begin(busiest) + request_count; ++i)
+    {
+        auto const& totals = *i->second;
+        out << " " << i->first << "." << totals.request
+            << " (" << std::lround(totals.count / seconds) << "/s"
+            << ", mean " << as_us(totals.total_time / totals.count) << "us"
+            << ", max " << as_us(totals.longest_time) << "us)";
+    }
+
+    out << "; executor: " << executor.wakeups << " wakeups";
+    if (executor.wakeups > 0)
+    {
+        out << ", mean " << (executor.work_items / executor.wakeups) << " max " << executor.most_work_items
+            << " work items, mean wait " << as_us(executor.total_wait / executor.wakeups) << "us"
+            << " max wait " << as_us(executor.longest_wait) << "us"
+            << ", mean run " << as_us(executor.total_run_time / executor.wakeups) << "us";
+    }
+
+    mir::log_info(out.str());
+
+    requests.clear();
+    requests_by_client.clear();
+    request_latency.fill(0);
+    executor = ExecutorTotals{};
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MIR_FRONTEND_PROTOCOL_STATISTICS_H
+#define MIR_FRONTEND_PROTOCOL_STATISTICS_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <utility>
+
+#include <sys/types.h>
+
+struct wl_client;
+struct wl_display;
+struct wl_event_loop;
+struct wl_event_source;
+struct wl_protocol_logger;
+struct wl_protocol_logger_message;
+
+namespace mir
+{
+namespace frontend
+{
+/**
+ * Accounts for the Wayland thread's time: each request handled, and each batch of work the executor runs
+ *
+ * The connector only creates this when --wayland-request-report asks for it, as watching every request costs the
+ * Wayland thread. Both are then traced (as mir_server_wayland:request_handled and
+ * mir_server_wayland:executor_drained). If report_interval is non-zero the busiest clients and requests are also
+ * logged at that interval, so a client flooding the compositor shows up without a tracing session, along with how
+ * busy the Wayland thread was, the distribution of handler times and how deep the executor's queue got.
+ *
+ * \note Apart from construction and destruction (while the event loop isn't running), everything here happens on
+ *       the Wayland thread
+ */
+class ProtocolStatistics
+{
+public:
+    ProtocolStatistics(wl_display* display, std::chrono::seconds report_interval);
+    ~ProtocolStatistics();
+
+    void executor_drained(size_t work_items, std::chrono::nanoseconds wait, std::chrono::nanoseconds run_time);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    /// Handler time is taken as the time until the next request starts, or the event loop goes idle
+    struct InFlightRequest
+    {
+        wl_client* client;
+        pid_t pid;
+        char const* interface;
+        uint32_t opcode;
+        char const* request;
+        Clock::time_point start;
+    };
+
+    struct RequestTotals
+    {
+        char const* request;
+        long count{0};
+        std::chrono::nanoseconds total_time{0};
+        std::chrono::nanoseconds longest_time{0};
+    };
+
+    struct ExecutorTotals
+    {
+        long wakeups{0};
+        long work_items{0};
+        size_t most_work_items{0};
+        std::chrono::nanoseconds total_wait{0};
+        std::chrono::nanoseconds longest_wait{0};
+        std::chrono::nanoseconds total_run_time{0};
+    };
+
+    /// Handler times, in power-of-two buckets of microseconds: bucket n counts those under 2^n us
+    using LatencyHistogram = std::array<long, 24>;
+
+    static void on_idle(void* data);
+    static int on_report_timeout(void* data);
+
+    void request_started(wl_protocol_logger_message const* message);
+    void finish_request(Clock::time_point now);
+    void report();
+
+    wl_event_loop* const loop;
+    std::chrono::seconds const report_interval;
+    wl_protocol_logger* logger{nullptr};
+    wl_event_source* idle_source{nullptr};
+    wl_event_source* report_timer{nullptr};
+
+    bool in_flight{false};
+    InFlightRequest current;
+
+    /// Keyed by interface name and opcode (the names are static strings, so their addresses are stable)
+    std::map<std::pair<char const*, uint32_t>, RequestTotals> requests;
+    std::unordered_map<pid_t, long> requests_by_client;
+    LatencyHistogram request_latency{};
+    ExecutorTotals executor;
+    Clock::time_point report_start;
+};
+}
+}
+
+#endif  // MIR_FRONTEND_PROTOCOL_STATISTICS_H
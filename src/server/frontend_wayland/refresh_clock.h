@@ -0,0 +1,77 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_FRONTEND_REFRESH_CLOCK_H
+#define MIR_FRONTEND_REFRESH_CLOCK_H
+
+#include "mir/graphics/frame.h"
+#include "mir/geometry/rectangle.h"
+
+#include <algorithm>
+#include <chrono>
+#include <experimental/optional>
+
+namespace mir
+{
+namespace frontend
+{
+/**
+ * The refresh interval of the output showing a surface, as measured between the presentations of its content.
+ *
+ * Until two presentations on the same output have been seen, a 60Hz output is assumed.
+ */
+class RefreshClock
+{
+public:
+    /// Assumed until there's a measurement
+    static constexpr std::chrono::nanoseconds default_interval{16'666'667};
+    /// Measurements outside this range are more likely a glitch (or a platform without vsync) than a real output
+    static constexpr std::chrono::nanoseconds shortest_interval{std::chrono::milliseconds{2}};
+    static constexpr std::chrono::nanoseconds longest_interval{std::chrono::milliseconds{100}};
+    /// How many refreshes that don't show the surface we wait through before assuming none will
+    static constexpr int missable_refreshes{3};
+
+    /// Measures the interval from \a frame and the last frame presented on the output at \a output_area
+    void presented(graphics::Frame const& frame, geometry::Rectangle const& output_area)
+    {
+        if (last_presented && last_output_area == output_area &&
+            frame.ust.clock_id == last_presented.value().ust.clock_id &&
+            frame.msc > last_presented.value().msc)
+        {
+            auto const measured = (frame.ust - last_presented.value().ust) / (frame.msc - last_presented.value().msc);
+            interval_ = std::clamp(measured, shortest_interval, longest_interval);
+        }
+        last_presented = frame;
+        last_output_area = output_area;
+    }
+
+    auto interval() const -> std::chrono::nanoseconds { return interval_; }
+
+    /// How long to wait for a refresh that shows the surface before going ahead without one
+    auto fallback() const -> std::chrono::milliseconds
+    {
+        return std::chrono::ceil<std::chrono::milliseconds>(interval_ * missable_refreshes);
+    }
+
+private:
+    std::chrono::nanoseconds interval_{default_interval};
+    std::experimental::optional<graphics::Frame> last_presented;
+    geometry::Rectangle last_output_area;
+};
+}
+}
+
+#endif // MIR_FRONTEND_REFRESH_CLOCK_H
@@ -0,0 +1,367 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "screencopy_v1.h"
+#include "wlr-screencopy-unstable-v1_wrapper.h"
+#include "output_manager.h"
+#include "deleted_for_resource.h"
+
+#include "mir/compositor/screen_capture.h"
+#include "mir/executor.h"
+#include "mir/graphics/wayland_shm.h"
+
+#include <wayland-server.h>
+#include <boost/throw_exception.hpp>
+
+#include <cstring>
+#include <vector>
+
+namespace mf = mir::frontend;
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+namespace mw = mir::wayland;
+namespace geom = mir::geometry;
+
+namespace
+{
+/// A ScreenCapture::Frame, copied out of the renderer for delivery on the Wayland thread
+struct CapturedFrame
+{
+    explicit CapturedFrame(mc::ScreenCapture::Frame const& frame) :
+        size{frame.size},
+        damage{frame.damage},
+        time{frame.time}
+    {
+        auto const row_bytes = size.width.as_uint32_t() * 4;
+        pixels.resize(row_bytes * size.height.as_uint32_t());
+        for (auto row = 0u; row != size.height.as_uint32_t(); ++row)
+        {
+            std::memcpy(
+                pixels.data() + row * row_bytes,
+                static_cast<char const*>(frame.pixels) + row * frame.stride.as_uint32_t(),
+                row_bytes);
+        }
+    }
+
+    geom::Size const size;
+    geom::Rectangles const damage;
+    std::chrono::nanoseconds const time;
+    std::vector<char> pixels;
+};
+
+/// Both layouts are 0xAARRGGBB in native order, which is what the compositor captures
+auto is_supported_format(uint32_t format) -> bool
+{
+    return format == WL_SHM_FORMAT_XRGB8888 || format == WL_SHM_FORMAT_ARGB8888;
+}
+}
+
+namespace mir
+{
+namespace frontend
+{
+class ScreencopyManagerV1 : public wayland::ScreencopyManagerV1
+{
+public:
+    ScreencopyManagerV1(
+        wl_resource* resource,
+        std::shared_ptr<Executor> const& wayland_executor,
+        OutputManager* output_manager,
+        std::shared_ptr<compositor::ScreenCapture> const& screen_capture);
+
+    class Global : public wayland::ScreencopyManagerV1::Global
+    {
+    public:
+        Global(
+            wl_display* display,
+            std::shared_ptr<Executor> const& wayland_executor,
+            OutputManager* output_manager,
+            std::shared_ptr<compositor::ScreenCapture> const& screen_capture);
+
+    private:
+        void bind(wl_resource* new_zwlr_screencopy_manager_v1) override;
+
+        std::shared_ptr<Executor> const wayland_executor;
+        OutputManager* const output_manager;
+        std::shared_ptr<compositor::ScreenCapture> const screen_capture;
+    };
+
+private:
+    std::shared_ptr<Executor> const wayland_executor;
+    OutputManager* const output_manager;
+    std::shared_ptr<compositor::ScreenCapture> const screen_capture;
+
+    /// The area of the scene shown on output (nullopt if the output has gone)
+    auto extents_of(wl_resource* output) const -> std::experimental::optional<geom::Rectangle>;
+
+    void capture_output(wl_resource* frame, int32_t overlay_cursor, wl_resource* output) override;
+    void capture_output_region(
+        wl_resource* frame,
+        int32_t overlay_cursor,
+        wl_resource* output,
+        int32_t x, int32_t y, int32_t width, int32_t height) override;
+    void destroy() override;
+};
+
+/// A single copy of (part of) an output into a client's shm buffer
+class ScreencopyFrameV1 : public wayland::ScreencopyFrameV1
+{
+public:
+    ScreencopyFrameV1(
+        wl_resource* id,
+        std::shared_ptr<Executor> const& wayland_executor,
+        std::shared_ptr<compositor::ScreenCapture> const& screen_capture,
+        std::experimental::optional<geom::Rectangle> const& area);
+
+private:
+    std::shared_ptr<Executor> const wayland_executor;
+    std::shared_ptr<compositor::ScreenCapture> const screen_capture;
+    std::experimental::optional<geom::Rectangle> const area;
+    /// Only read on the Wayland thread
+    std::shared_ptr<bool> const destroyed;
+
+    bool used{false};
+    bool with_damage{false};
+    wl_resource* buffer{nullptr};
+    std::shared_ptr<bool> buffer_destroyed;
+    /// The pixels of buffer, mapped by our wl_shm
+    std::shared_ptr<graphics::WlShmBufferContent const> buffer_content;
+    /// Destroyed before the rest of the frame, so a callback in progress can't outlive it
+    std::unique_ptr<compositor::ScreenCapture::Request> request;
+
+    void copy(wl_resource* buffer) override;
+    void copy_with_damage(wl_resource* buffer) override;
+    void destroy() override;
+
+    void start_copy(wl_resource* buffer, bool with_damage);
+    void deliver(CapturedFrame const& frame);
+};
+}
+}
+
+auto mf::create_screencopy_manager_v1(
+    wl_display* display,
+    std::shared_ptr<Executor> const& wayland_executor,
+    OutputManager* output_manager,
+    std::shared_ptr<compositor::ScreenCapture> const& screen_capture) -> std::shared_ptr<void>
+{
+    return std::make_shared<ScreencopyManagerV1::Global>(display, wayland_executor, output_manager, screen_capture);
+}
+
+mf::ScreencopyManagerV1::Global::Global(
+    wl_display* display,
+    std::shared_ptr<Executor> const& wayland_executor,
+    OutputManager* output_manager,
+    std::shared_ptr<compositor::ScreenCapture> const& screen_capture) :
+    wayland::ScreencopyManagerV1::Global::Global{display, Version<3>{}},
+    wayland_executor{wayland_executor},
+    output_manager{output_manager},
+    screen_capture{screen_capture}
+{
+}
+
+void mf::ScreencopyManagerV1::Global::bind(wl_resource* new_zwlr_screencopy_manager_v1)
+{
+    new ScreencopyManagerV1{new_zwlr_screencopy_manager_v1, wayland_executor, output_manager, screen_capture};
+}
+
+mf::ScreencopyManagerV1::ScreencopyManagerV1(
+    wl_resource* resource,
+    std::shared_ptr<Executor> const& wayland_executor,
+    OutputManager* output_manager,
+    std::shared_ptr<compositor::ScreenCapture> const& screen_capture) :
+    wayland::ScreencopyManagerV1{resource, Version<3>{}},
+    wayland_executor{wayland_executor},
+    output_manager{output_manager},
+    screen_capture{screen_capture}
+{
+}
+
+auto mf::ScreencopyManagerV1::extents_of(wl_resource* output) const -> std::experimental::optional<geom::Rectangle>
+{
+    if (auto const id = output_manager->output_id_for(client, output))
+    {
+        if (auto const found = output_manager->output_for(id.value()))
+            return found.value()->configuration().extents();
+    }
+    return {};
+}
+
+void mf::ScreencopyManagerV1::capture_output(wl_resource* frame, int32_t /*overlay_cursor*/, wl_resource* output)
+{
+    // The cursor is captured when it is composited (as a software cursor), and not when it is on a hardware plane
+    new ScreencopyFrameV1{frame, wayland_executor, screen_capture, extents_of(output)};
+}
+
+void mf::ScreencopyManagerV1::capture_output_region(
+    wl_resource* frame,
+    int32_t /*overlay_cursor*/,
+    wl_resource* output,
+    int32_t x, int32_t y, int32_t width, int32_t height)
+{
+    auto area = extents_of(output);
+    if (area)
+    {
+        geom::Rectangle const region{
+            area.value().top_left + geom::Displacement{x, y},
+            geom::Size{std::max(width, 0), std::max(height, 0)}};
+        area = intersection_of(region, area.value());
+    }
+
+    new ScreencopyFrameV1{frame, wayland_executor, screen_capture, area};
+}
+
+void mf::ScreencopyManagerV1::destroy()
+{
+    destroy_wayland_object();
+}
+
+mf::ScreencopyFrameV1::ScreencopyFrameV1(
+    wl_resource* id,
+    std::shared_ptr<Executor> const& wayland_executor,
+    std::shared_ptr<compositor::ScreenCapture> const& screen_capture,
+    std::experimental::optional<geom::Rectangle> const& area) :
+    wayland::ScreencopyFrameV1{id, Version<3>{}},
+    wayland_executor{wayland_executor},
+    screen_capture{screen_capture},
+    area{area},
+    destroyed{deleted_flag_for_resource(resource)}
+{
+    if (!area || area.value().size.width.as_int() <= 0 || area.value().size.height.as_int() <= 0)
+    {
+        send_failed_event();
+        return;
+    }
+
+    auto const size = area.value().size;
+    send_buffer_event(
+        WL_SHM_FORMAT_XRGB8888,
+        size.width.as_uint32_t(),
+        size.height.as_uint32_t(),
+        size.width.as_uint32_t() * 4);
+
+    if (version_supports_buffer_done())
+        send_buffer_done_event();
+}
+
+void mf::ScreencopyFrameV1::copy(wl_resource* buffer)
+{
+    start_copy(buffer, false);
+}
+
+void mf::ScreencopyFrameV1::copy_with_damage(wl_resource* buffer)
+{
+    start_copy(buffer, true);
+}
+
+void mf::ScreencopyFrameV1::destroy()
+{
+    destroy_wayland_object();
+}
+
+void mf::ScreencopyFrameV1::start_copy(wl_resource* buffer, bool with_damage)
+{
+    if (used)
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::already_used,
+            "zwlr_screencopy_frame_v1@%d has already been copied",
+            wl_resource_get_id(resource)));
+    }
+    used = true;
+
+    if (!area || area.value().size.width.as_int() <= 0 || area.value().size.height.as_int() <= 0)
+    {
+        send_failed_event();
+        return;
+    }
+
+    auto const content = mg::wl_shm_buffer_content(buffer);
+    auto const size = area.value().size;
+    if (!content ||
+        !content->writable() ||
+        !is_supported_format(content->format()) ||
+        content->size() != size ||
+        content->stride().as_int() < size.width.as_int() * 4)
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::invalid_buffer,
+            "wl_buffer@%d does not match the zwlr_screencopy_frame_v1.buffer event",
+            wl_resource_get_id(buffer)));
+    }
+
+    this->buffer = buffer;
+    this->buffer_destroyed = deleted_flag_for_resource(buffer);
+    this->buffer_content = content;
+    this->with_damage = with_damage;
+
+    // The callback runs on a compositor thread, so it copies the frame out and hands it to the Wayland thread
+    request = screen_capture->capture(
+        area.value(),
+        with_damage,
+        [self = this, destroyed = destroyed, executor = wayland_executor](mc::ScreenCapture::Frame const& frame)
+        {
+            auto const captured = std::make_shared<CapturedFrame>(frame);
+            executor->spawn([self, destroyed, captured]()
+                {
+                    if (!*destroyed)
+                        self->deliver(*captured);
+                });
+        });
+}
+
+void mf::ScreencopyFrameV1::deliver(CapturedFrame const& frame)
+{
+    request.reset();
+
+    if (*buffer_destroyed || frame.size != area.value().size)
+    {
+        send_failed_event();
+        return;
+    }
+
+    auto const row_bytes = frame.size.width.as_uint32_t() * 4;
+    auto const stride = buffer_content->stride().as_uint32_t();
+
+    buffer_content->write([&](unsigned char* data)
+        {
+            for (auto row = 0u; row != frame.size.height.as_uint32_t(); ++row)
+                std::memcpy(data + row * stride, frame.pixels.data() + row * row_bytes, row_bytes);
+        });
+
+    send_flags_event(0);
+
+    if (with_damage && version_supports_damage())
+    {
+        for (auto const& rect : frame.damage)
+        {
+            send_damage_event(
+                rect.top_left.x.as_uint32_t(),
+                rect.top_left.y.as_uint32_t(),
+                rect.size.width.as_uint32_t(),
+                rect.size.height.as_uint32_t());
+        }
+    }
+
+    auto const seconds = std::chrono::duration_cast<std::chrono::seconds>(frame.time);
+    uint64_t const tv_sec = seconds.count();
+    send_ready_event(
+        tv_sec >> 32,
+        tv_sec & 0xffffffff,
+        (frame.time - seconds).count());
+}
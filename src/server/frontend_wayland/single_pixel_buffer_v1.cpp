@@ -0,0 +1,175 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "single_pixel_buffer_v1.h"
+#include "single-pixel-buffer-v1_wrapper.h"
+#include "wayland_wrapper.h"
+
+#include "mir/graphics/buffer_basic.h"
+#include "mir/graphics/solid_color_buffer.h"
+
+#include <array>
+#include <limits>
+
+namespace mf = mir::frontend;
+namespace mg = mir::graphics;
+namespace mw = mir::wayland;
+namespace geom = mir::geometry;
+
+namespace mir
+{
+namespace frontend
+{
+class SinglePixelBufferManagerV1 : public wayland::SinglePixelBufferManagerV1
+{
+public:
+    SinglePixelBufferManagerV1(wl_resource* resource);
+
+    class Global : public wayland::SinglePixelBufferManagerV1::Global
+    {
+    public:
+        Global(wl_display* display);
+
+    private:
+        void bind(wl_resource* new_wp_single_pixel_buffer_manager_v1) override;
+    };
+
+private:
+    void destroy() override;
+    void create_u32_rgba_buffer(wl_resource* id, uint32_t r, uint32_t g, uint32_t b, uint32_t a) override;
+};
+
+/// A wl_buffer that is just a color; it has no storage, so may be shown for as long as it's wanted
+class SinglePixelBufferV1 : public wayland::Buffer
+{
+public:
+    SinglePixelBufferV1(wl_resource* id, std::array<float, 4> const& color);
+
+    std::array<float, 4> const color;
+
+private:
+    void destroy() override;
+};
+}
+}
+
+namespace
+{
+class SinglePixelContent : public mg::BufferBasic, public mg::SolidColorBuffer
+{
+public:
+    SinglePixelContent(std::array<float, 4> const& color, std::function<void()>&& on_release)
+        : color_{color},
+          on_release{std::move(on_release)}
+    {
+    }
+
+    ~SinglePixelContent() override
+    {
+        on_release();
+    }
+
+    auto native_buffer_handle() const -> std::shared_ptr<mg::NativeBuffer> override
+    {
+        return nullptr;
+    }
+
+    auto size() const -> geom::Size override
+    {
+        return {1, 1};
+    }
+
+    auto pixel_format() const -> MirPixelFormat override
+    {
+        // Lets the compositor treat an opaque color as opaque
+        return color_[3] >= 1.0f ? mir_pixel_format_xrgb_8888 : mir_pixel_format_argb_8888;
+    }
+
+    auto native_buffer_base() -> mg::NativeBufferBase* override
+    {
+        return this;
+    }
+
+    auto color() const -> std::array<float, 4> override
+    {
+        return color_;
+    }
+
+private:
+    std::array<float, 4> const color_;
+    std::function<void()> const on_release;
+};
+
+auto normalised(uint32_t value) -> float
+{
+    return static_cast<float>(static_cast<double>(value) / std::numeric_limits<uint32_t>::max());
+}
+}
+
+auto mf::create_single_pixel_buffer_manager_v1(wl_display* display) -> std::shared_ptr<void>
+{
+    return std::make_shared<SinglePixelBufferManagerV1::Global>(display);
+}
+
+auto mf::is_single_pixel_buffer(wl_resource* buffer) -> bool
+{
+    return dynamic_cast<SinglePixelBufferV1*>(mw::Buffer::from(buffer));
+}
+
+auto mf::single_pixel_buffer_from(
+    wl_resource* buffer,
+    std::function<void()>&& on_release) -> std::shared_ptr<mg::Buffer>
+{
+    auto const& single_pixel = dynamic_cast<SinglePixelBufferV1&>(*mw::Buffer::from(buffer));
+    return std::make_shared<SinglePixelContent>(single_pixel.color, std::move(on_release));
+}
+
+mf::SinglePixelBufferManagerV1::Global::Global(wl_display* display) :
+    wayland::SinglePixelBufferManagerV1::Global::Global{display, Version<1>{}}
+{
+}
+
+void mf::SinglePixelBufferManagerV1::Global::bind(wl_resource* new_wp_single_pixel_buffer_manager_v1)
+{
+    new SinglePixelBufferManagerV1{new_wp_single_pixel_buffer_manager_v1};
+}
+
+mf::SinglePixelBufferManagerV1::SinglePixelBufferManagerV1(wl_resource* resource) :
+    wayland::SinglePixelBufferManagerV1{resource, Version<1>{}}
+{
+}
+
+void mf::SinglePixelBufferManagerV1::destroy()
+{
+    destroy_wayland_object();
+}
+
+void mf::SinglePixelBufferManagerV1::create_u32_rgba_buffer(
+    wl_resource* id, uint32_t r, uint32_t g, uint32_t b, uint32_t a)
+{
+    new SinglePixelBufferV1{id, {normalised(r), normalised(g), normalised(b), normalised(a)}};
+}
+
+mf::SinglePixelBufferV1::SinglePixelBufferV1(wl_resource* id, std::array<float, 4> const& color) :
+    wayland::Buffer{id, Version<1>{}},
+    color{color}
+{
+}
+
+void mf::SinglePixelBufferV1::destroy()
+{
+    destroy_wayland_object();
+}
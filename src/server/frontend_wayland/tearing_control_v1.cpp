@@ -0,0 +1,131 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tearing_control_v1.h"
+#include "tearing-control-v1_wrapper.h"
+#include "wl_surface.h"
+
+#include <boost/throw_exception.hpp>
+
+namespace mf = mir::frontend;
+namespace mw = mir::wayland;
+
+namespace mir
+{
+namespace frontend
+{
+class TearingControlManagerV1 : public wayland::TearingControlManagerV1
+{
+public:
+    TearingControlManagerV1(wl_resource* resource);
+
+    class Global : public wayland::TearingControlManagerV1::Global
+    {
+    public:
+        Global(wl_display* display);
+
+    private:
+        void bind(wl_resource* new_wp_tearing_control_manager_v1) override;
+    };
+
+private:
+    void destroy() override;
+    void get_tearing_control(wl_resource* id, wl_resource* surface) override;
+};
+
+/// The presentation hint is double-buffered surface state, which the window manager sees as a modification request
+class TearingControlV1 : public wayland::TearingControlV1
+{
+public:
+    TearingControlV1(wl_resource* id, WlSurface* surface);
+    ~TearingControlV1();
+
+private:
+    wayland::Weak<WlSurface> const surface;
+
+    void set_presentation_hint(uint32_t hint) override;
+    void destroy() override;
+};
+}
+}
+
+auto mf::create_tearing_control_v1(wl_display* display) -> std::shared_ptr<void>
+{
+    return std::make_shared<TearingControlManagerV1::Global>(display);
+}
+
+mf::TearingControlManagerV1::Global::Global(wl_display* display) :
+    wayland::TearingControlManagerV1::Global::Global{display, Version<1>{}}
+{
+}
+
+void mf::TearingControlManagerV1::Global::bind(wl_resource* new_wp_tearing_control_manager_v1)
+{
+    new TearingControlManagerV1{new_wp_tearing_control_manager_v1};
+}
+
+mf::TearingControlManagerV1::TearingControlManagerV1(wl_resource* resource) :
+    wayland::TearingControlManagerV1{resource, Version<1>{}}
+{
+}
+
+void mf::TearingControlManagerV1::destroy()
+{
+    destroy_wayland_object();
+}
+
+void mf::TearingControlManagerV1::get_tearing_control(wl_resource* id, wl_resource* surface)
+{
+    auto const wl_surface = WlSurface::from(surface);
+    if (wl_surface->tearing_control())
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::tearing_control_exists,
+            "wl_surface@%d already has tearing control",
+            wl_resource_get_id(surface)));
+    }
+
+    new TearingControlV1{id, wl_surface};
+}
+
+mf::TearingControlV1::TearingControlV1(wl_resource* id, WlSurface* surface) :
+    wayland::TearingControlV1{id, Version<1>{}},
+    surface{surface}
+{
+    surface->set_tearing_control(resource);
+}
+
+mf::TearingControlV1::~TearingControlV1()
+{
+    if (surface)
+        surface.value().set_tearing_control(nullptr);
+}
+
+void mf::TearingControlV1::set_presentation_hint(uint32_t hint)
+{
+    // The object is inert once the surface has gone
+    if (surface)
+        surface.value().set_pending_tearing_allowed(hint == PresentationHint::async);
+}
+
+void mf::TearingControlV1::destroy()
+{
+    // Reverts to vsync from the next commit
+    if (surface)
+        surface.value().set_pending_tearing_allowed(false);
+    destroy_wayland_object();
+}
@@ -0,0 +1,187 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "viewporter.h"
+#include "viewporter_wrapper.h"
+#include "wl_surface.h"
+
+#include <boost/throw_exception.hpp>
+
+namespace mf = mir::frontend;
+namespace mw = mir::wayland;
+namespace geom = mir::geometry;
+
+namespace mir
+{
+namespace frontend
+{
+class Viewporter : public wayland::Viewporter
+{
+public:
+    Viewporter(wl_resource* resource);
+
+    class Global : public wayland::Viewporter::Global
+    {
+    public:
+        Global(wl_display* display);
+
+    private:
+        void bind(wl_resource* new_wp_viewporter) override;
+    };
+
+private:
+    void destroy() override;
+    void get_viewport(wl_resource* id, wl_resource* surface) override;
+};
+
+/// The source and destination are double-buffered surface state, applied on the surface's next commit
+class Viewport : public wayland::Viewport
+{
+public:
+    Viewport(wl_resource* id, WlSurface* surface);
+    ~Viewport();
+
+private:
+    wayland::Weak<WlSurface> const surface;
+
+    void destroy() override;
+    void set_source(double x, double y, double width, double height) override;
+    void set_destination(int32_t width, int32_t height) override;
+
+    auto surface_or_throw() -> WlSurface&;
+};
+}
+}
+
+auto mf::create_viewporter(wl_display* display) -> std::shared_ptr<void>
+{
+    return std::make_shared<Viewporter::Global>(display);
+}
+
+mf::Viewporter::Global::Global(wl_display* display) :
+    wayland::Viewporter::Global::Global{display, Version<1>{}}
+{
+}
+
+void mf::Viewporter::Global::bind(wl_resource* new_wp_viewporter)
+{
+    new Viewporter{new_wp_viewporter};
+}
+
+mf::Viewporter::Viewporter(wl_resource* resource) :
+    wayland::Viewporter{resource, Version<1>{}}
+{
+}
+
+void mf::Viewporter::destroy()
+{
+    destroy_wayland_object();
+}
+
+void mf::Viewporter::get_viewport(wl_resource* id, wl_resource* surface)
+{
+    auto const wl_surface = WlSurface::from(surface);
+    if (wl_surface->viewport())
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::viewport_exists,
+            "wl_surface@%d already has a viewport",
+            wl_resource_get_id(surface)));
+    }
+
+    new Viewport{id, wl_surface};
+}
+
+mf::Viewport::Viewport(wl_resource* id, WlSurface* surface) :
+    wayland::Viewport{id, Version<1>{}},
+    surface{surface}
+{
+    surface->set_viewport(resource);
+}
+
+mf::Viewport::~Viewport()
+{
+    if (surface)
+        surface.value().set_viewport(nullptr);
+}
+
+void mf::Viewport::destroy()
+{
+    // Shows the whole buffer at its own size from the next commit
+    if (surface)
+    {
+        surface.value().set_pending_viewport_source(std::experimental::nullopt);
+        surface.value().set_pending_viewport_destination(std::experimental::nullopt);
+    }
+    destroy_wayland_object();
+}
+
+void mf::Viewport::set_source(double x, double y, double width, double height)
+{
+    auto& wl_surface = surface_or_throw();
+
+    if (x == -1 && y == -1 && width == -1 && height == -1)
+    {
+        wl_surface.set_pending_viewport_source(std::experimental::nullopt);
+        return;
+    }
+
+    if (x < 0 || y < 0 || width <= 0 || height <= 0)
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::bad_value,
+            "Invalid wp_viewport source %f,%f %fx%f",
+            x, y, width, height));
+    }
+
+    wl_surface.set_pending_viewport_source(geom::RectangleF{{x, y}, {width, height}});
+}
+
+void mf::Viewport::set_destination(int32_t width, int32_t height)
+{
+    auto& wl_surface = surface_or_throw();
+
+    if (width == -1 && height == -1)
+    {
+        wl_surface.set_pending_viewport_destination(std::experimental::nullopt);
+        return;
+    }
+
+    if (width <= 0 || height <= 0)
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::bad_value,
+            "Invalid wp_viewport destination %dx%d",
+            width, height));
+    }
+
+    wl_surface.set_pending_viewport_destination(geom::Size{width, height});
+}
+
+auto mf::Viewport::surface_or_throw() -> WlSurface&
+{
+    if (!surface)
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::no_surface,
+            "wl_surface of wp_viewport has been destroyed"));
+    }
+    return surface.value();
+}
@@ -30,6 +30,7 @@
 
 #include "output_manager.h"
 #include "wayland_executor.h"
+#include "protocol_statistics.h"
 
 #include "wayland_wrapper.h"
 
@@ -46,6 +47,7 @@
 #include "mir/graphics/buffer_properties.h"
 #include "mir/graphics/buffer.h"
 #include "mir/graphics/graphic_buffer_allocator.h"
+#include "mir/graphics/wayland_shm.h"
 
 #include "mir/renderer/gl/texture_target.h"
 #include "mir/frontend/buffer_stream_id.h"
@@ -493,9 +495,14 @@ mf::WaylandConnector::WaylandConnector(
     std::shared_ptr<mf::SessionAuthorizer> const& session_authorizer,
     std::shared_ptr<SurfaceStack> const& surface_stack,
     std::shared_ptr<ms::Clipboard> const& clipboard,
+    std::shared_ptr<mc::ScreenCapture> const& screen_capture,
     bool arw_socket,
     std::unique_ptr<WaylandExtensions> extensions_,
-    WaylandProtocolExtensionFilter const& extension_filter)
+    WaylandProtocolExtensionFilter const& extension_filter,
+    std::chrono::milliseconds pointer_coalescing_interval,
+    std::shared_ptr<mi::InputReport> const& input_report,
+    size_t shm_client_limit,
+    std::optional<std::chrono::seconds> request_report_interval)
     : display{wl_display_create(), &cleanup_display},
       pause_signal{eventfd(0, EFD_CLOEXEC | EFD_SEMAPHORE)},
       executor{std::make_shared<WaylandExecutor>(wl_display_get_event_loop(display.get()))},
@@ -517,6 +524,18 @@ mf::WaylandConnector::WaylandConnector(
         BOOST_THROW_EXCEPTION(std::runtime_error{"Failed to create wl_display"});
     }
 
+    // Accounting for every request costs the Wayland thread, so only when asked to
+    if (request_report_interval)
+    {
+        protocol_statistics = std::make_unique<ProtocolStatistics>(display.get(), request_report_interval.value());
+        executor->set_drain_observer(
+            [statistics = protocol_statistics.get()](
+                size_t work_items, std::chrono::nanoseconds wait, std::chrono::nanoseconds run_time)
+            {
+                statistics->executor_drained(work_items, wait, run_time);
+            });
+    }
+
 #ifndef MIR_NO_WAYLAND_FILTER
     wl_display_set_global_filter(display.get(), &wl_display_global_filter_func_thunk, this);
 #else
@@ -544,7 +563,8 @@ mf::WaylandConnector::WaylandConnector(
         executor,
         this->allocator);
     subcompositor_global = std::make_unique<mf::WlSubcompositor>(display.get());
-    seat_global = std::make_unique<mf::WlSeat>(display.get(), input_hub, seat);
+    seat_global = std::make_unique<mf::WlSeat>(
+        display.get(), input_hub, seat, pointer_coalescing_interval, input_report);
     output_manager = std::make_unique<mf::OutputManager>(
         display.get(),
         display_config,
@@ -559,9 +579,10 @@ mf::WaylandConnector::WaylandConnector(
         clipboard,
         seat_global.get(),
         output_manager.get(),
-        surface_stack});
+        surface_stack,
+        screen_capture});
 
-    wl_display_init_shm(display.get());
+    shm_global = mg::create_wl_shm(display.get(), shm_client_limit);
 
     char const* wayland_display = nullptr;
 
@@ -24,6 +24,8 @@
 #include "mir/optional_value.h"
 
 #include <wayland-server-core.h>
+#include <chrono>
+#include <optional>
 #include <unordered_map>
 #include <thread>
 #include <vector>
@@ -36,12 +38,17 @@ class Executor;
 namespace input
 {
 class InputDeviceHub;
+class InputReport;
 class Seat;
 }
 namespace graphics
 {
 class GraphicBufferAllocator;
 }
+namespace compositor
+{
+class ScreenCapture;
+}
 namespace geometry
 {
 struct Size;
@@ -66,6 +73,8 @@ class SessionAuthorizer;
 class WlDataDeviceManager;
 class WlSurface;
 class SurfaceStack;
+class WaylandExecutor;
+class ProtocolStatistics;
 
 class WaylandExtensions
 {
@@ -80,6 +89,7 @@ public:
         WlSeat* seat;
         OutputManager* output_manager;
         std::shared_ptr<SurfaceStack> surface_stack;
+        std::shared_ptr<compositor::ScreenCapture> screen_capture;
     };
 
     WaylandExtensions() = default;
@@ -116,9 +126,14 @@ public:
         std::shared_ptr<SessionAuthorizer> const& session_authorizer,
         std::shared_ptr<SurfaceStack> const& surface_stack,
         std::shared_ptr<scene::Clipboard> const& clipboard,
+        std::shared_ptr<compositor::ScreenCapture> const& screen_capture,
         bool arw_socket,
         std::unique_ptr<WaylandExtensions> extensions,
-        WaylandProtocolExtensionFilter const& extension_filter);
+        WaylandProtocolExtensionFilter const& extension_filter,
+        std::chrono::milliseconds pointer_coalescing_interval,
+        std::shared_ptr<input::InputReport> const& input_report,
+        size_t shm_client_limit,
+        std::optional<std::chrono::seconds> request_report_interval);
 
     ~WaylandConnector() override;
 
@@ -151,7 +166,9 @@ private:
     std::unique_ptr<WlSeat> seat_global;
     std::unique_ptr<OutputManager> output_manager;
     std::unique_ptr<WlDataDeviceManager> data_device_manager_global;
-    std::shared_ptr<Executor> const executor;
+    std::shared_ptr<void> shm_global;
+    std::shared_ptr<WaylandExecutor> const executor;
+    std::unique_ptr<ProtocolStatistics> protocol_statistics;
     std::shared_ptr<graphics::GraphicBufferAllocator> const allocator;
     std::shared_ptr<shell::Shell> const shell;
     std::unique_ptr<WaylandExtensions> const extensions;
@@ -18,6 +18,7 @@
 
 #include "mir/default_server_configuration.h"
 #include "mir/frontend/wayland.h"
+#include "mir/startup_report.h"
 
 #include "wayland_connector.h"
 #include "xdg_shell_v6.h"
@@ -34,12 +35,35 @@
 #include "pointer_constraints_unstable_v1.h"
 #include "relative-pointer-unstable-v1_wrapper.h"
 #include "relative_pointer_unstable_v1.h"
+#include "linux-explicit-synchronization-unstable-v1_wrapper.h"
+#include "linux_explicit_synchronization_v1.h"
+#include "tearing-control-v1_wrapper.h"
+#include "tearing_control_v1.h"
+#include "viewporter_wrapper.h"
+#include "viewporter.h"
+#include "single-pixel-buffer-v1_wrapper.h"
+#include "single_pixel_buffer_v1.h"
+#include "presentation-time_wrapper.h"
+#include "presentation_time.h"
+#include "fifo-v1_wrapper.h"
+#include "fifo_v1.h"
+#include "commit-timing-v1_wrapper.h"
+#include "commit_timing_v1.h"
+#include "wlr-screencopy-unstable-v1_wrapper.h"
+#include "screencopy_v1.h"
 
 #include "mir/graphics/platform.h"
 #include "mir/options/default_configuration.h"
 #include "mir/scene/session.h"
+#include "mir/abnormal_exit.h"
 #include "mir/log.h"
 
+#include <boost/throw_exception.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+
 namespace mf = mir::frontend;
 namespace ms = mir::scene;
 namespace msh = mir::shell;
@@ -123,6 +147,44 @@ std::vector<ExtensionBuilder> const internal_extension_builders = {
         mw::PointerConstraintsV1::interface_name, [](auto const& ctx) -> std::shared_ptr<void>
             { return mf::create_pointer_constraints_unstable_v1(ctx.display, *ctx.wayland_executor, ctx.shell); }
     },
+    {
+        mw::LinuxExplicitSynchronizationV1::interface_name, [](auto const& ctx) -> std::shared_ptr<void>
+            { return mf::create_linux_explicit_synchronization_v1(ctx.display); }
+    },
+    {
+        mw::TearingControlManagerV1::interface_name, [](auto const& ctx) -> std::shared_ptr<void>
+            { return mf::create_tearing_control_v1(ctx.display); }
+    },
+    {
+        mw::Viewporter::interface_name, [](auto const& ctx) -> std::shared_ptr<void>
+            { return mf::create_viewporter(ctx.display); }
+    },
+    {
+        mw::SinglePixelBufferManagerV1::interface_name, [](auto const& ctx) -> std::shared_ptr<void>
+            { return mf::create_single_pixel_buffer_manager_v1(ctx.display); }
+    },
+    {
+        mw::Presentation::interface_name, [](auto const& ctx) -> std::shared_ptr<void>
+            { return mf::create_presentation_time(ctx.display, ctx.output_manager); }
+    },
+    {
+        mw::FifoManagerV1::interface_name, [](auto const& ctx) -> std::shared_ptr<void>
+            { return mf::create_fifo_manager_v1(ctx.display); }
+    },
+    {
+        mw::CommitTimingManagerV1::interface_name, [](auto const& ctx) -> std::shared_ptr<void>
+            { return mf::create_commit_timing_manager_v1(ctx.display); }
+    },
+    {
+        mw::ScreencopyManagerV1::interface_name, [](auto const& ctx) -> std::shared_ptr<void>
+            {
+                return mf::create_screencopy_manager_v1(
+                    ctx.display,
+                    ctx.wayland_executor,
+                    ctx.output_manager,
+                    ctx.screen_capture);
+            }
+    },
 };
 
 ExtensionBuilder const xwayland_builder {
@@ -217,7 +279,12 @@ auto mf::get_standard_extensions() -> std::vector<std::string>
         mw::Shell::interface_name,
         mw::XdgWmBase::interface_name,
         mw::XdgShellV6::interface_name,
-        mw::XdgOutputManagerV1::interface_name};
+        mw::XdgOutputManagerV1::interface_name,
+        mw::Presentation::interface_name,
+        mw::Viewporter::interface_name,
+        mw::SinglePixelBufferManagerV1::interface_name,
+        mw::FifoManagerV1::interface_name,
+        mw::CommitTimingManagerV1::interface_name};
 }
 
 auto mf::get_supported_extensions() -> std::vector<std::string>
@@ -238,6 +305,30 @@ std::shared_ptr<mf::Connector>
         {
             auto options = the_options();
             bool const arw_socket = options->is_set(options::arw_server_socket_opt);
+            auto const pointer_motion_rate = options->get<double>(options::wayland_pointer_motion_rate_opt);
+            std::chrono::milliseconds const pointer_coalescing_interval{
+                pointer_motion_rate > 0 ? std::max(1l, std::lround(1000 / pointer_motion_rate)) : 0};
+            auto const shm_client_limit_mib = options->get<int>(options::wayland_shm_client_limit_opt);
+            size_t const shm_client_limit = shm_client_limit_mib > 0 ? size_t(shm_client_limit_mib) << 20 : 0;
+            auto const request_report = options->get<std::string>(options::wayland_request_report_opt);
+            std::optional<std::chrono::seconds> request_report_interval;
+            if (request_report == options::log_opt_value)
+            {
+                request_report_interval = std::chrono::seconds{
+                    std::max(1, options->get<int>(options::wayland_request_report_interval_opt))};
+            }
+            else if (request_report == options::lttng_opt_value)
+            {
+                // Only the tracepoints
+                request_report_interval = std::chrono::seconds::zero();
+            }
+            else if (request_report != options::off_opt_value)
+            {
+                BOOST_THROW_EXCEPTION(AbnormalExit(
+                    std::string("Invalid ") + options::wayland_request_report_opt + " option: " + request_report +
+                    " (valid options are: \"" + options::off_opt_value + "\" and \"" + options::log_opt_value +
+                    "\" and \"" + options::lttng_opt_value + "\")"));
+            }
 
             auto wayland_extensions = std::set<std::string>{
                 enabled_wayland_extensions.begin(),
@@ -247,7 +338,7 @@ std::shared_ptr<mf::Connector>
                 the_frontend_display_changer(),
                 the_display_configuration_observer_registrar());
 
-            return std::make_shared<mf::WaylandConnector>(
+            auto const connector = std::make_shared<mf::WaylandConnector>(
                 the_shell(),
                 display_config,
                 the_input_device_hub(),
@@ -256,12 +347,21 @@ std::shared_ptr<mf::Connector>
                 the_session_authorizer(),
                 the_frontend_surface_stack(),
                 the_clipboard(),
+                the_screen_capture(),
                 arw_socket,
                 configure_wayland_extensions(
                     wayland_extensions,
                     options->is_set(mo::x11_display_opt),
                     wayland_extension_hooks),
-                wayland_extension_filter);
+                wayland_extension_filter,
+                pointer_coalescing_interval,
+                the_input_report(),
+                shm_client_limit,
+                request_report_interval);
+
+            // The socket is bound (and accepting connections) as the connector is created
+            the_startup_report()->phase_completed(StartupReport::Phase::wayland_socket_ready);
+            return connector;
         });
 }
 
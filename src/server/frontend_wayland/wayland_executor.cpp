@@ -20,16 +20,18 @@
 
 #include "mir/fd.h"
 #include "mir/log.h"
+#include "mir/thread/mpsc_queue.h"
 
 #include <sys/eventfd.h>
 
 #include <boost/throw_exception.hpp>
 
+#include <atomic>
 #include <cstring>
-#include <deque>
 #include <functional>
 #include <mutex>
 #include <system_error>
+#include <utility>
 
 namespace mf = mir::frontend;
 
@@ -44,6 +46,13 @@ namespace mf = mir::frontend;
  * wl_event_source and the WaylandExecutor. WaylandExecutor can then always
  * enqueue new work, even if no more work is going to be processed, and the work
  * processing function always has a reference to the workqueue state.
+ *
+ * Work is spawned from the compositor and input threads far more often than
+ * the executor is created or destroyed, so the workqueue is a lock-free
+ * multi-producer, single-consumer queue and only the (rare) termination
+ * handshake takes the mutex. The event loop is only woken when the queue goes
+ * from idle to busy; everything spawned before the loop gets around to it is
+ * handled by the same wakeup.
  */
 
 class mf::WaylandExecutor::State
@@ -59,28 +68,46 @@ public:
     explicit State(wl_event_loop* loop)
         : loop{loop}
     {
-        enqueue(
+        // This will be handled by the wakeup for the first spawn()
+        workqueue.push(
             []()
             {
                 on_wayland_thread = true;
             });
     }
 
-    void enqueue(std::function<void()>&& work)
+    /// \return true if the event loop needs waking to process the work
+    auto enqueue(std::function<void()>&& work) -> bool
     {
         if (on_wayland_thread)
         {
             work();
-            return;
+            return false;
         }
 
-        std::lock_guard<std::mutex> lock{mutex};
-        if (state == ExecutionState::Running)
+        if (state.load(std::memory_order_acquire) != ExecutionState::Running)
         {
-            workqueue.emplace_back(std::move(work));
+            // If we've been terminated then drop the work on the floor, letting the
+            // std::function destructor clean up any necessary state.
+            return false;
         }
-        // If we've been terminated then drop the work on the floor, letting the
-        // std::function destructor clean up any necessary state.
+
+        if (!work)
+        {
+            // An empty work item would look like the end of the queue to on_notify()
+            return false;
+        }
+
+        workqueue.push(std::move(work));
+        if (wakeup_pending.exchange(true, std::memory_order_acq_rel))
+        {
+            return false;
+        }
+
+        wakeup_requested.store(
+            std::chrono::steady_clock::now().time_since_epoch().count(),
+            std::memory_order_release);
+        return true;
     }
 
     void enqueue_termination(std::function<void()>&& terminator)
@@ -88,7 +115,7 @@ public:
         std::lock_guard<std::mutex> lock{mutex};
         if (state == ExecutionState::Running)
         {
-            workqueue.emplace_front(std::move(terminator));
+            this->terminator = std::move(terminator);
             on_wayland_thread = false;
             state = ExecutionState::TerminationRequested;
         }
@@ -96,14 +123,18 @@ public:
 
     std::function<void()> get_work()
     {
-        std::lock_guard<std::mutex> lock{mutex};
-        if (!workqueue.empty())
+        if (state.load(std::memory_order_acquire) == ExecutionState::TerminationRequested)
         {
-            auto const work = std::move(workqueue.front());
-            workqueue.pop_front();
-            return work;
+            // The termination request jumps the queue
+            std::lock_guard<std::mutex> lock{mutex};
+            if (auto work = std::exchange(terminator, {}))
+            {
+                return work;
+            }
         }
-        return {};
+        std::function<void()> work;
+        workqueue.pop(work);
+        return work;
     }
 
     std::unique_lock<std::mutex> drain()
@@ -112,31 +143,40 @@ public:
 
         if (state == ExecutionState::TerminationRequested)
         {
-            // If we've been asked to terminate then the front of the workqueue
-            // will contain the termination request.
+            if (std::function<void()> const work = std::exchange(terminator, {}))
             {
-                std::function<void()> const work = std::move(workqueue.front());
                 lock.unlock();
 
                 work();
+
+                lock.lock();
             }
-            lock.lock();
         }
 
         on_wayland_thread = false;
         state = ExecutionState::Stopped;
-        workqueue.clear();
+        std::function<void()> discarded;
+        while (workqueue.pop(discarded))
+        {
+        }
 
         return lock;
     }
 
     static int on_notify(int fd, uint32_t, void* data);
+
+    std::function<void(size_t work_items, std::chrono::nanoseconds wait, std::chrono::nanoseconds run_time)>
+        drain_observer;
 private:
     static thread_local bool on_wayland_thread;
     std::mutex mutex;
-    ExecutionState state{ExecutionState::Running};
+    std::atomic<ExecutionState> state{ExecutionState::Running};
     wl_event_loop* const loop;
-    std::deque<std::function<void()>> workqueue;
+    mir::thread::MPSCQueue<std::function<void()>> workqueue;
+    std::atomic<bool> wakeup_pending{false};
+    /// When the pending wakeup was asked for, in steady_clock ticks
+    std::atomic<std::chrono::steady_clock::rep> wakeup_requested{0};
+    std::function<void()> terminator;
 };
 
 thread_local bool mf::WaylandExecutor::State::on_wayland_thread{false};
@@ -233,8 +273,17 @@ int mf::WaylandExecutor::State::on_notify(int fd, uint32_t, void* data)
             err);
     }
 
+    // Anything spawned from here on needs a fresh wakeup
+    state->wakeup_pending.store(false, std::memory_order_release);
+    std::chrono::steady_clock::duration const wait{
+        std::chrono::steady_clock::now().time_since_epoch().count() -
+        state->wakeup_requested.load(std::memory_order_acquire)};
+
+    auto const drain_start = std::chrono::steady_clock::now();
+    size_t work_items{0};
     while (auto work = state->get_work())
     {
+        ++work_items;
         try
         {
             work();
@@ -248,6 +297,11 @@ int mf::WaylandExecutor::State::on_notify(int fd, uint32_t, void* data)
                 "Exception processing Wayland event loop work item");
         }
     }
+    // A wakeup can find its work already done by the previous one
+    if (state->drain_observer && work_items > 0)
+    {
+        state->drain_observer(work_items, wait, std::chrono::steady_clock::now() - drain_start);
+    }
     if (state->state != ExecutionState::Running)
     {
         EventLoopDestroyedHandler::remove_destruction_handler_for_loop(state->loop);
@@ -260,7 +314,7 @@ int mf::WaylandExecutor::State::on_notify(int fd, uint32_t, void* data)
 
 mf::WaylandExecutor::WaylandExecutor(wl_event_loop* loop)
     : state{std::make_shared<State>(loop)},
-      notify_fd{eventfd(0, EFD_CLOEXEC | EFD_SEMAPHORE | EFD_NONBLOCK)},
+      notify_fd{eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)},
       source{wl_event_loop_add_fd(
           loop,
           notify_fd,
@@ -317,9 +371,19 @@ mf::WaylandExecutor::~WaylandExecutor()
     }
 }
 
+void mf::WaylandExecutor::set_drain_observer(
+    std::function<void(size_t work_items, std::chrono::nanoseconds wait, std::chrono::nanoseconds run_time)> observer)
+{
+    state->drain_observer = std::move(observer);
+}
+
 void mf::WaylandExecutor::spawn (std::function<void()>&& work)
 {
-    state->enqueue(std::move(work));
+    if (!state->enqueue(std::move(work)))
+    {
+        // Either we ran it already, or the event loop has a wakeup outstanding
+        return;
+    }
 
     if (auto err = eventfd_write(notify_fd, 1))
     {
@@ -24,9 +24,9 @@
 
 #include <wayland-server-core.h>
 
-#include <mutex>
+#include <chrono>
+#include <functional>
 #include <memory>
-#include <deque>
 
 namespace mir
 {
@@ -40,6 +40,18 @@ public:
 
     void spawn(std::function<void()>&& work) override;
 
+    /**
+     * Tells observer, on the Wayland thread, how much work each wakeup found queued, how long the first of it
+     * waited for the Wayland thread and how long running it all took
+     *
+     * \note This must be set before the event loop runs
+     */
+    void set_drain_observer(
+        std::function<void(
+            size_t work_items,
+            std::chrono::nanoseconds wait,
+            std::chrono::nanoseconds run_time)> observer);
+
     class State;
 private:
     std::shared_ptr<State> state;
@@ -23,6 +23,7 @@
 #include "wl_keyboard.h"
 #include "wl_touch.h"
 
+#include <mir/input/input_report.h>
 #include <mir/input/keymap.h>
 #include <mir/log.h>
 
@@ -116,6 +117,8 @@ void mf::WaylandInputDispatcher::handle_event(MirInputEvent const* event)
     }   break;
 
     default:
-        break;
+        return;
     }
+
+    seat->input_report().event_reached_stage(mi::InputReport::Stage::client, mir_input_event_get_event_time(event));
 }
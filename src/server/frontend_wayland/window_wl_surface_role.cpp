@@ -31,6 +31,7 @@
 #include "null_event_sink.h"
 
 #include "mir/log.h"
+#include "mir/compositor/buffer_stream.h"
 #include "mir/scene/surface.h"
 #include "mir/scene/surface_creation_parameters.h"
 
@@ -38,6 +39,7 @@
 
 namespace mf = mir::frontend;
 namespace ms = mir::scene;
+namespace mc = mir::compositor;
 namespace msh = mir::shell;
 namespace geom = mir::geometry;
 
@@ -105,9 +107,17 @@ auto mf::WindowWlSurfaceRole::scene_surface() const -> std::experimental::option
 
 void mf::WindowWlSurfaceRole::populate_spec_with_surface_data(shell::SurfaceSpecification& spec)
 {
-    spec.streams = std::vector<shell::StreamSpecification>();
-    spec.input_shape = std::vector<geom::Rectangle>();
-    surface->populate_surface_data(spec.streams.value(), spec.input_shape.value(), {});
+    std::vector<shell::StreamSpecification> streams;
+    std::vector<geom::Rectangle> input_shape;
+    surface->populate_surface_data(streams, input_shape, {});
+
+    // Subsurfaces that only moved (as they do every frame of a scrolling browser) don't need the window manager
+    if (try_move_streams_directly(streams, input_shape))
+        return;
+
+    record_surface_data(streams, input_shape);
+    spec.streams = std::move(streams);
+    spec.input_shape = std::move(input_shape);
 }
 
 void mf::WindowWlSurfaceRole::refresh_surface_data_now()
@@ -116,8 +126,47 @@ void mf::WindowWlSurfaceRole::refresh_surface_data_now()
     {
         shell::SurfaceSpecification surface_data_spec;
         populate_spec_with_surface_data(surface_data_spec);
-        shell->modify_surface(session, scene_surface, surface_data_spec);
+        if (!surface_data_spec.is_empty())
+            shell->modify_surface(session, scene_surface, surface_data_spec);
+    }
+}
+
+auto mf::WindowWlSurfaceRole::try_move_streams_directly(
+    std::vector<shell::StreamSpecification> const& streams,
+    std::vector<geom::Rectangle> const& input_shape) -> bool
+{
+    auto const scene_surface = weak_scene_surface.lock();
+    if (!scene_surface || streams.size() != committed_stream_order.size())
+        return false;
+
+    std::list<ms::StreamInfo> stream_info;
+    for (auto i = 0u; i != streams.size(); ++i)
+    {
+        auto const stream = streams[i].stream.lock();
+        if (stream.get() != committed_stream_order[i])
+            return false;
+
+        if (auto const bs = std::dynamic_pointer_cast<mc::BufferStream>(stream))
+            stream_info.push_back(ms::StreamInfo{bs, streams[i].displacement, streams[i].size});
+    }
+
+    scene_surface->set_streams(stream_info);
+    if (input_shape != committed_input_shape)
+    {
+        scene_surface->set_input_region(input_shape);
+        committed_input_shape = input_shape;
     }
+    return true;
+}
+
+void mf::WindowWlSurfaceRole::record_surface_data(
+    std::vector<shell::StreamSpecification> const& streams,
+    std::vector<geom::Rectangle> const& input_shape)
+{
+    committed_stream_order.clear();
+    for (auto const& stream : streams)
+        committed_stream_order.push_back(stream.stream.lock().get());
+    committed_input_shape = input_shape;
 }
 
 void mf::WindowWlSurfaceRole::apply_spec(mir::shell::SurfaceSpecification const& new_spec)
@@ -376,6 +425,10 @@ void mf::WindowWlSurfaceRole::commit(WlSurfaceState const& state)
     auto size = pending_size();
     observer->latest_client_size(size);
 
+    // Before the scene surface exists this waits in pending_changes for the next commit
+    if (state.tearing_allowed)
+        spec().tearing_allowed = state.tearing_allowed.value();
+
     if (auto const scene_surface = weak_scene_surface.lock())
     {
         bool const is_mapped = scene_surface->visible();
@@ -444,6 +497,7 @@ void mf::WindowWlSurfaceRole::create_scene_surface()
     params->streams = std::vector<shell::StreamSpecification>{};
     params->input_shape = std::vector<geom::Rectangle>{};
     surface->populate_surface_data(params->streams.value(), params->input_shape.value(), {});
+    record_surface_data(params->streams.value(), params->input_shape.value());
 
     auto const scene_surface = shell->create_surface(session, *params, observer);
     weak_scene_surface = scene_surface;
@@ -30,6 +30,7 @@
 
 #include <experimental/optional>
 #include <chrono>
+#include <vector>
 
 struct wl_client;
 struct wl_resource;
@@ -46,10 +47,12 @@ class Session;
 namespace shell
 {
 struct SurfaceSpecification;
+struct StreamSpecification;
 class Shell;
 }
 namespace frontend
 {
+class BufferStream;
 class WaylandSurfaceObserver;
 class OutputManager;
 class WlSurface;
@@ -152,7 +155,21 @@ private:
 
     std::unique_ptr<shell::SurfaceSpecification> pending_changes;
 
+    /// The streams (in stacking order) and input shape last given to the scene surface
+    /// @{
+    std::vector<BufferStream const*> committed_stream_order;
+    std::vector<geometry::Rectangle> committed_input_shape;
+    /// @}
+
     shell::SurfaceSpecification& spec();
+
+    /// Moves the scene surface's streams without going through the shell, if nothing but their positions changed
+    auto try_move_streams_directly(
+        std::vector<shell::StreamSpecification> const& streams,
+        std::vector<geometry::Rectangle> const& input_shape) -> bool;
+    void record_surface_data(
+        std::vector<shell::StreamSpecification> const& streams,
+        std::vector<geometry::Rectangle> const& input_shape);
 };
 
 }
@@ -32,6 +32,9 @@ namespace msh = mir::shell;
 
 namespace
 {
+/// Each connected client, so that other accounts can be divided by it
+mir::MemoryAccount connected_clients{"wayland", "clients"};
+
 /// The context required for creating new WlClient's from wl_client*s
 struct ConstructionCtx
 {
@@ -128,7 +131,8 @@ mf::WlClient::~WlClient()
 mf::WlClient::WlClient(wl_client* client, std::shared_ptr<ms::Session> const& session, msh::Shell* shell)
     : shell{shell},
       client{client},
-      session{session}
+      session{session},
+      charge{connected_clients, sizeof(WlClient)}
 {
 }
 
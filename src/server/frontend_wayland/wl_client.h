@@ -23,6 +23,8 @@ struct wl_client;
 struct wl_listener;
 struct wl_display;
 
+#include "mir/memory_account.h"
+
 #include <memory>
 #include <functional>
 
@@ -85,6 +87,8 @@ private:
     std::shared_ptr<scene::Session> const session;
 
     float output_geometry_scale_{1};
+
+    MemoryCharge const charge;
 };
 }
 }
@@ -18,6 +18,7 @@
 
 #include "wl_keyboard.h"
 
+#include "keymap_cache.h"
 #include "wayland_utils.h"
 #include "wl_surface.h"
 #include "wl_seat.h"
@@ -38,14 +39,20 @@ namespace mf = mir::frontend;
 namespace mw = mir::wayland;
 namespace mi = mir::input;
 
+namespace
+{
+/// From this version clients must map the keymap MAP_PRIVATE, so may be given a read-only file
+int const keymap_is_mapped_private_since{7};
+}
+
 mf::WlKeyboard::WlKeyboard(
     wl_resource* new_resource,
     mir::input::Keymap const& initial_keymap,
+    std::shared_ptr<KeymapCache> const& keymap_cache,
     std::function<std::vector<uint32_t>()> const& acquire_current_keyboard_state)
     : Keyboard(new_resource, Version<6>()),
-      keymap{nullptr, &xkb_keymap_unref},
+      keymap_cache{keymap_cache},
       state{nullptr, &xkb_state_unref},
-      context{xkb_context_new(XKB_CONTEXT_NO_FLAGS), &xkb_context_unref},
       acquire_current_keyboard_state{acquire_current_keyboard_state}
 {
     // TODO: We should really grab the keymap for the focused surface when
@@ -187,7 +194,7 @@ void mf::WlKeyboard::focussed(WlSurface& surface, bool should_be_focused)
 void mf::WlKeyboard::update_keyboard_state(std::vector<uint32_t> const& keyboard_state)
 {
     // Rebuild xkb state
-    state = decltype(state)(xkb_state_new(keymap.get()), &xkb_state_unref);
+    state = decltype(state)(xkb_state_new(keymap->keymap()), &xkb_state_unref);
     for (auto scancode : keyboard_state)
     {
         xkb_state_update_key(state.get(), scancode + 8, XKB_KEY_DOWN);
@@ -198,32 +205,29 @@ void mf::WlKeyboard::update_keyboard_state(std::vector<uint32_t> const& keyboard
 
 void mf::WlKeyboard::set_keymap(mi::Keymap const& new_keymap)
 {
-    xkb_rule_names const names = {
-        "evdev",
-        new_keymap.model.c_str(),
-        new_keymap.layout.c_str(),
-        new_keymap.variant.c_str(),
-        new_keymap.options.c_str()
-    };
-    keymap = decltype(keymap){
-        xkb_keymap_new_from_names(
-            context.get(),
-            &names,
-            XKB_KEYMAP_COMPILE_NO_FLAGS),
-        &xkb_keymap_unref};
+    keymap = keymap_cache->compiled(new_keymap);
 
     // TODO: We might need to copy across the existing depressed keys?
-    state = decltype(state)(xkb_state_new(keymap.get()), &xkb_state_unref);
+    state = decltype(state)(xkb_state_new(keymap->keymap()), &xkb_state_unref);
 
-    std::unique_ptr<char, void(*)(void*)> buffer{xkb_keymap_get_as_string(keymap.get(), XKB_KEYMAP_FORMAT_TEXT_V1), free};
-    auto length = strlen(buffer.get());
+    auto const length = keymap->text().size();
 
-    mir::AnonymousShmFile shm_buffer{length};
-    memcpy(shm_buffer.base_ptr(), buffer.get(), length);
+    auto const& sealed_fd = keymap->sealed_fd();
+    if (sealed_fd && wl_resource_get_version(resource) >= keymap_is_mapped_private_since)
+    {
+        // The file is shared by every such client, but sealed so none can change it
+        send_keymap_event(KeymapFormat::xkb_v1, sealed_fd.value(), length);
+    }
+    else
+    {
+        // Older clients may map it shared and writable, which a sealed file refuses, so get their own
+        mir::AnonymousShmFile shm_buffer{length};
+        memcpy(shm_buffer.base_ptr(), keymap->text().data(), length);
 
-    send_keymap_event(KeymapFormat::xkb_v1,
-                      Fd{IntOwnedFd{shm_buffer.fd()}},
-                      length);
+        send_keymap_event(KeymapFormat::xkb_v1,
+                          Fd{IntOwnedFd{shm_buffer.fd()}},
+                          length);
+    }
 }
 
 void mf::WlKeyboard::update_modifier_state()
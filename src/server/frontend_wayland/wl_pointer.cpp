@@ -19,6 +19,7 @@
 #include "wl_pointer.h"
 
 #include "wayland_utils.h"
+#include "client_backlog.h"
 #include "wl_surface.h"
 #include "wl_seat.h"
 #include "relative-pointer-unstable-v1_wrapper.h"
@@ -33,6 +34,7 @@
 #include "mir/graphics/buffer.h"
 #include "mir/renderer/sw/pixel_source.h"
 #include "mir/compositor/buffer_stream.h"
+#include "mir/memory_account.h"
 
 #include <linux/input-event-codes.h>
 #include <boost/throw_exception.hpp>
@@ -48,13 +50,17 @@ namespace mrs = mir::renderer::software;
 
 namespace
 {
+/// Cursors from client buffers. Their bytes are of the buffers they keep mapped, which are also under "buffers".
+mir::MemoryAccount client_cursors{"cursors", "client"};
+
 class BufferCursorImage : public mg::CursorImage
 {
 public:
     BufferCursorImage(std::shared_ptr<mg::Buffer> buffer, geom::Displacement const& hotspot)
         : buffer{mrs::as_read_mappable_buffer(std::move(buffer))},
           mapping{this->buffer->map_readable()},
-          hotspot_(hotspot)
+          hotspot_(hotspot),
+          charge{client_cursors, mapping->len()}
     {
     }
 
@@ -77,6 +83,7 @@ private:
     std::shared_ptr<mrs::ReadMappableBuffer> const buffer;
     std::unique_ptr<mrs::Mapping<unsigned char const>> const mapping;
     geom::Displacement const hotspot_;
+    mir::MemoryCharge const charge;
 };
 
 static auto const button_mapping = {
@@ -119,10 +126,11 @@ struct NullCursor : mf::WlPointer::Cursor
 };
 }
 
-mf::WlPointer::WlPointer(wl_resource* new_resource)
+mf::WlPointer::WlPointer(wl_resource* new_resource, std::chrono::milliseconds coalescing_interval)
     : Pointer(new_resource, Version<6>()),
       display{wl_client_get_display(client)},
-      cursor{std::make_unique<NullCursor>()}
+      cursor{std::make_unique<NullCursor>()},
+      coalescing_interval{coalescing_interval}
 {
 }
 
@@ -130,6 +138,8 @@ mf::WlPointer::~WlPointer()
 {
     if (surface_under_cursor)
         surface_under_cursor.value().remove_destroy_listener(destroy_listener_id);
+    if (flush_timer)
+        wl_event_source_remove(flush_timer);
 }
 
 void mir::frontend::WlPointer::set_relative_pointer(mir::wayland::RelativePointerV1* relative_ptr)
@@ -169,6 +179,8 @@ void mf::WlPointer::leave(std::optional<MirPointerEvent const*> event)
     (void)event;
     if (!surface_under_cursor)
         return;
+    // Anything held back happened on the surface we're leaving
+    flush_coalesced();
     surface_under_cursor.value().remove_destroy_listener(destroy_listener_id);
     auto const serial = wl_display_next_serial(display);
     send_leave_event(
@@ -184,6 +196,9 @@ void mf::WlPointer::leave(std::optional<MirPointerEvent const*> event)
 
 void mf::WlPointer::buttons(MirPointerEvent const* event)
 {
+    // The client needs to know where the pointer was when the button changed
+    flush_coalesced();
+
     MirPointerButtons const event_buttons = mir_pointer_event_buttons(event);
 
     for (auto const& mapping : button_mapping)
@@ -207,6 +222,17 @@ void mf::WlPointer::axis(MirPointerEvent const* event)
     auto const h_scroll = mir_pointer_event_axis_value(event, mir_pointer_axis_hscroll);
     auto const v_scroll = mir_pointer_event_axis_value(event, mir_pointer_axis_vscroll);
 
+    if ((h_scroll || v_scroll) && holding_back_motion())
+    {
+        if (!pending_axis)
+            pending_axis = PendingAxis{0, 0, 0};
+        pending_axis->timestamp = timestamp_of(event);
+        pending_axis->horizontal += h_scroll;
+        pending_axis->vertical += v_scroll;
+        arm_flush_timer();
+        return;
+    }
+
     if (h_scroll)
     {
         send_axis_event(
@@ -280,12 +306,20 @@ void mf::WlPointer::enter_or_motion(MirPointerEvent const* event, WlSurface& roo
             break;
 
         default:
-            send_motion_event(
-                timestamp_of(event),
-                position_on_target.first,
-                position_on_target.second);
             current_position = position_on_target;
-            needs_frame = true;
+            if (holding_back_motion())
+            {
+                pending_motion = PendingMotion{timestamp_of(event), position_on_target};
+                arm_flush_timer();
+            }
+            else
+            {
+                send_motion_event(
+                    timestamp_of(event),
+                    position_on_target.first,
+                    position_on_target.second);
+                needs_frame = true;
+            }
         }
     }
 }
@@ -299,7 +333,17 @@ void mf::WlPointer::relative_motion(MirPointerEvent const* event)
     auto const motion = std::make_pair(
         mir_pointer_event_axis_value(event, mir_pointer_axis_relative_x),
         mir_pointer_event_axis_value(event, mir_pointer_axis_relative_y));
-    if (motion.first || motion.second)
+    // Held back with (and flushed in the same frame as) the wl_pointer motion it goes with
+    if ((motion.first || motion.second) && holding_back_motion())
+    {
+        if (!pending_relative_motion)
+            pending_relative_motion = PendingRelativeMotion{0, 0, 0};
+        pending_relative_motion->timestamp = timestamp_of(event);
+        pending_relative_motion->dx += motion.first;
+        pending_relative_motion->dy += motion.second;
+        arm_flush_timer();
+    }
+    else if (motion.first || motion.second)
     {
         auto const timestamp = timestamp_of(event);
         relative_pointer.value().send_relative_motion_event(
@@ -319,6 +363,84 @@ void mf::WlPointer::maybe_frame()
     needs_frame = false;
 }
 
+auto mf::WlPointer::holding_back_motion() const -> bool
+{
+    return coalescing_interval.count() || pending_motion || pending_axis || pending_relative_motion ||
+        client_is_backlogged(client);
+}
+
+void mf::WlPointer::flush_coalesced()
+{
+    if (pending_motion)
+    {
+        send_motion_event(
+            pending_motion->timestamp,
+            pending_motion->position.first,
+            pending_motion->position.second);
+        pending_motion = std::nullopt;
+        needs_frame = true;
+    }
+
+    if (pending_axis)
+    {
+        if (pending_axis->horizontal)
+            send_axis_event(pending_axis->timestamp, Axis::horizontal_scroll, pending_axis->horizontal);
+        if (pending_axis->vertical)
+            send_axis_event(pending_axis->timestamp, Axis::vertical_scroll, pending_axis->vertical);
+        pending_axis = std::nullopt;
+        needs_frame = true;
+    }
+
+    if (pending_relative_motion)
+    {
+        if (relative_pointer)
+        {
+            relative_pointer.value().send_relative_motion_event(
+                pending_relative_motion->timestamp, pending_relative_motion->timestamp,
+                pending_relative_motion->dx, pending_relative_motion->dy,
+                pending_relative_motion->dx, pending_relative_motion->dy);
+            needs_frame = true;
+        }
+        pending_relative_motion = std::nullopt;
+    }
+
+    if (flush_timer_armed)
+    {
+        wl_event_source_timer_update(flush_timer, 0);
+        flush_timer_armed = false;
+    }
+}
+
+void mf::WlPointer::arm_flush_timer()
+{
+    if (flush_timer_armed)
+        return;
+
+    if (!flush_timer)
+    {
+        flush_timer = wl_event_loop_add_timer(wl_display_get_event_loop(display), &on_flush_timeout, this);
+    }
+
+    auto const interval = coalescing_interval.count() ? coalescing_interval : backlog_retry_interval;
+    wl_event_source_timer_update(flush_timer, interval.count());
+    flush_timer_armed = true;
+}
+
+int mf::WlPointer::on_flush_timeout(void* data)
+{
+    auto const self = static_cast<WlPointer*>(data);
+    self->flush_timer_armed = false;
+    if (client_is_backlogged(self->client))
+    {
+        // Keep collapsing into what's held back until the client catches up
+        self->arm_flush_timer();
+        return 0;
+    }
+    self->flush_coalesced();
+    self->maybe_frame();
+    return 0;
+}
+
 namespace
 {
 struct WlSurfaceCursor : mf::WlPointer::Cursor
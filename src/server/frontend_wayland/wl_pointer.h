@@ -49,7 +49,8 @@ class WlPointer : public wayland::Pointer
 {
 public:
 
-    WlPointer(wl_resource* new_resource);
+    /// A zero coalescing_interval sends motion and axis events as they arrive
+    WlPointer(wl_resource* new_resource, std::chrono::milliseconds coalescing_interval);
 
     ~WlPointer();
 
@@ -74,6 +75,12 @@ private:
     void relative_motion(MirPointerEvent const* event);
     /// Sends a frame event only if needed, leaves needs_frame false
     void maybe_frame();
+    /// True if motion and axis events are to be held back rather than sent as they arrive
+    auto holding_back_motion() const -> bool;
+    /// Sends any motion and axis events held back for coalescing
+    void flush_coalesced();
+    void arm_flush_timer();
+    static int on_flush_timeout(void* data);
 
     /// Wayland request handlers
     ///@{
@@ -92,6 +99,32 @@ private:
     std::experimental::optional<std::pair<float, float>> current_position;
     std::unique_ptr<Cursor> cursor;
     wayland::Weak<wayland::RelativePointerV1> relative_pointer;
+
+    /// Motion and axis events are held back until this has passed, or a button, enter or leave needs sending.
+    /// They are also held back (with relative motion) while the client is backlogged, however long that lasts.
+    std::chrono::milliseconds const coalescing_interval;
+    struct PendingMotion
+    {
+        uint32_t timestamp;
+        std::pair<float, float> position;
+    };
+    std::optional<PendingMotion> pending_motion;
+    struct PendingAxis
+    {
+        uint32_t timestamp;
+        float horizontal;
+        float vertical;
+    };
+    std::optional<PendingAxis> pending_axis;
+    struct PendingRelativeMotion
+    {
+        uint32_t timestamp;
+        float dx;
+        float dy;
+    };
+    std::optional<PendingRelativeMotion> pending_relative_motion;
+    wl_event_source* flush_timer{nullptr};
+    bool flush_timer_armed{false};
 };
 
 }
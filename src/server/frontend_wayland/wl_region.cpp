@@ -19,8 +19,6 @@
 
 #include "wl_region.h"
 
-#include <mir/log.h>
-
 namespace mf = mir::frontend;
 namespace geom = mir::geometry;
 namespace mw = mir::wayland;
@@ -34,7 +32,7 @@ mf::WlRegion::~WlRegion()
 
 std::vector<geom::Rectangle> mf::WlRegion::rectangle_vector()
 {
-    return rects;
+    return region.rectangles();
 }
 
 mf::WlRegion* mf::WlRegion::from(wl_resource* resource)
@@ -50,14 +48,10 @@ void mf::WlRegion::destroy()
 
 void mf::WlRegion::add(int32_t x, int32_t y, int32_t width, int32_t height)
 {
-    rects.push_back(geom::Rectangle{{x, y}, {width, height}});
+    region |= geom::Rectangle{{x, y}, {width, height}};
 }
 
 void mf::WlRegion::subtract(int32_t x, int32_t y, int32_t width, int32_t height)
 {
-    (void)x;
-    (void)y;
-    (void)width;
-    (void)height;
-    log_warning("WlRegion::subtract not implemented. ignoring.");
+    region -= geom::Rectangle{{x, y}, {width, height}};
 }
@@ -20,6 +20,7 @@
 
 #include "wl_seat.h"
 
+#include "keymap_cache.h"
 #include "wayland_utils.h"
 #include "wl_surface.h"
 #include "wl_keyboard.h"
@@ -151,9 +152,12 @@ private:
 mf::WlSeat::WlSeat(
     wl_display* display,
     std::shared_ptr<mi::InputDeviceHub> const& input_hub,
-    std::shared_ptr<mi::Seat> const& seat)
+    std::shared_ptr<mi::Seat> const& seat,
+    std::chrono::milliseconds pointer_coalescing_interval,
+    std::shared_ptr<mi::InputReport> const& input_report)
     :   Global(display, Version<6>()),
         keymap{std::make_unique<input::Keymap>()},
+        keymap_cache{std::make_shared<KeymapCache>()},
         config_observer{
             std::make_shared<ConfigObserver>(
                 *keymap,
@@ -165,7 +169,9 @@ mf::WlSeat::WlSeat(
         keyboard_listeners{std::make_shared<ListenerList<WlKeyboard>>()},
         touch_listeners{std::make_shared<ListenerList<WlTouch>>()},
         input_hub{input_hub},
-        seat{seat}
+        seat{seat},
+        pointer_coalescing_interval{pointer_coalescing_interval},
+        input_report_{input_report}
 {
     input_hub->add_observer(config_observer);
     add_focus_listener(&focus);
@@ -223,7 +229,7 @@ mf::WlSeat::Instance::Instance(wl_resource* new_resource, mf::WlSeat* seat)
 
 void mf::WlSeat::Instance::get_pointer(wl_resource* new_pointer)
 {
-    auto const pointer = new WlPointer{new_pointer};
+    auto const pointer = new WlPointer{new_pointer, seat->pointer_coalescing_interval};
     seat->pointer_listeners->register_listener(client, pointer);
     pointer->add_destroy_listener(
         [listeners = seat->pointer_listeners, listener = pointer, client = client]()
@@ -237,6 +243,7 @@ void mf::WlSeat::Instance::get_keyboard(wl_resource* new_keyboard)
     auto const keyboard = new WlKeyboard{
         new_keyboard,
         *seat->keymap,
+        seat->keymap_cache,
         [seat = seat->seat]()
         {
             std::unordered_set<uint32_t> pressed_keys;
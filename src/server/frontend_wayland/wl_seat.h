@@ -21,6 +21,7 @@
 
 #include "wayland_wrapper.h"
 
+#include <chrono>
 #include <unordered_map>
 #include <vector>
 #include <functional>
@@ -39,6 +40,7 @@ namespace mir
 namespace input
 {
 class InputDeviceHub;
+class InputReport;
 class Seat;
 class Keymap;
 }
@@ -47,6 +49,7 @@ namespace frontend
 class WlPointer;
 class WlKeyboard;
 class WlTouch;
+class KeymapCache;
 
 class WlSeat : public wayland::Seat::Global
 {
@@ -54,7 +57,9 @@ public:
     WlSeat(
         wl_display* display,
         std::shared_ptr<mir::input::InputDeviceHub> const& input_hub,
-        std::shared_ptr<mir::input::Seat> const& seat);
+        std::shared_ptr<mir::input::Seat> const& seat,
+        std::chrono::milliseconds pointer_coalescing_interval,
+        std::shared_ptr<mir::input::InputReport> const& input_report);
 
     ~WlSeat();
 
@@ -82,6 +87,8 @@ public:
 
     void server_restart();
 
+    auto input_report() const -> mir::input::InputReport& { return *input_report_; }
+
 private:
     wl_client* focused_client{nullptr}; ///< Can be null
     std::vector<ListenerTracker*> focus_listeners;
@@ -103,6 +110,7 @@ private:
     class Instance;
 
     std::unique_ptr<mir::input::Keymap> const keymap;
+    std::shared_ptr<KeymapCache> const keymap_cache;
     std::shared_ptr<ConfigObserver> const config_observer;
 
     // listener list are shared pointers so devices can keep them around long enough to remove themselves
@@ -112,6 +120,8 @@ private:
 
     std::shared_ptr<input::InputDeviceHub> const input_hub;
     std::shared_ptr<input::Seat> const seat;
+    std::chrono::milliseconds const pointer_coalescing_interval;
+    std::shared_ptr<input::InputReport> const input_report_;
 
     void bind(wl_resource* new_wl_seat) override;
 };
@@ -23,6 +23,10 @@
 #include "wl_subcompositor.h"
 #include "wl_region.h"
 #include "deleted_for_resource.h"
+#include "linux_explicit_synchronization_v1.h"
+#include "presentation_time.h"
+#include "single_pixel_buffer_v1.h"
+#include "viewporter_wrapper.h"
 
 #include "wayland_wrapper.h"
 
@@ -32,14 +36,20 @@
 #include "mir/scene/session.h"
 #include "mir/frontend/wayland.h"
 #include "mir/compositor/buffer_stream.h"
+#include "mir/compositor/presentation.h"
 #include "mir/executor.h"
+#include "mir/thread/executor_batch.h"
 #include "mir/graphics/graphic_buffer_allocator.h"
+#include "mir/graphics/dmabuf_buffer.h"
+#include "mir/graphics/wayland_shm.h"
 #include "mir/scene/surface.h"
 #include "mir/shell/surface_specification.h"
 #include "mir/log.h"
 
 #include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <limits>
 #include <boost/throw_exception.hpp>
 #include <wayland-server-protocol.h>
 
@@ -48,6 +58,12 @@ namespace geom = mir::geometry;
 namespace mw = mir::wayland;
 namespace msh = mir::shell;
 
+namespace
+{
+/// How often an occluded surface gets its frame callbacks, so that it doesn't render what no one will see
+int const occluded_frame_callback_ms{1000};
+}
+
 mf::WlSurfaceState::Callback::Callback(wl_resource* new_resource)
     : mw::Callback{new_resource, Version<1>()},
       destroyed{deleted_flag_for_resource(resource)}
@@ -68,10 +84,52 @@ void mf::WlSurfaceState::update_from(WlSurfaceState const& source)
     if (source.input_shape)
         input_shape = source.input_shape;
 
+    if (source.opaque_region)
+        opaque_region = source.opaque_region;
+
+    if (source.acquire_fence)
+        acquire_fence = source.acquire_fence;
+
+    if (source.tearing_allowed)
+        tearing_allowed = source.tearing_allowed;
+
+    if (source.viewport_source)
+        viewport_source = source.viewport_source;
+
+    if (source.viewport_destination)
+        viewport_destination = source.viewport_destination;
+
+    if (source.fifo_barrier)
+        fifo_barrier = true;
+
+    if (source.fifo_wait)
+        fifo_wait = true;
+
+    if (source.target_time)
+        target_time = source.target_time;
+
+    if (source.buffer_release)
+    {
+        // The buffer this was for has been replaced without our ever using it
+        if (buffer_release)
+            buffer_release->release({});
+        buffer_release = source.buffer_release;
+    }
+
     frame_callbacks.insert(end(frame_callbacks),
                            begin(source.frame_callbacks),
                            end(source.frame_callbacks));
 
+    presentation_feedbacks.insert(end(presentation_feedbacks),
+                                  begin(source.presentation_feedbacks),
+                                  end(source.presentation_feedbacks));
+
+    for (auto const& rect : source.surface_damage)
+        surface_damage.add(rect);
+
+    for (auto const& rect : source.buffer_damage)
+        buffer_damage.add(rect);
+
     if (source.surface_data_invalidated)
         surface_data_invalidated = true;
 }
@@ -93,7 +151,11 @@ mf::WlSurface::WlSurface(
         allocator{allocator},
         executor{executor},
         null_role{this},
-        role{&null_role}
+        role{&null_role},
+        queued_commits{
+            wl_display_get_event_loop(wl_client_get_display(client)),
+            [this](WlSurfaceState const& state) { return hold_commit_until(state); },
+            [this](WlSurfaceState const& state) { role->commit(state); }}
 {
     // wl_surface is specified to act in mailbox mode
     stream->allow_framedropping(true);
@@ -101,6 +163,22 @@ mf::WlSurface::WlSurface(
 
 mf::WlSurface::~WlSurface()
 {
+    if (frame_callback_timer)
+        wl_event_source_remove(frame_callback_timer);
+    if (stream_reports_presentation)
+        stream->set_frame_presented_callback([](auto const&){});
+
+    // None of the content still waiting will reach the screen now
+    for (auto const& feedback : presentation_feedbacks)
+        feedback.second->discarded();
+    for (auto const& state : queued_commits.queued())
+    {
+        for (auto const& feedback : state.presentation_feedbacks)
+            feedback->discarded();
+    }
+    for (auto const& feedback : pending.presentation_feedbacks)
+        feedback->discarded();
+
     role->destroy();
     session->destroy_buffer_stream(stream);
 }
@@ -226,6 +304,17 @@ mf::WlSurface* mf::WlSurface::from(wl_resource* resource)
 
 void mf::WlSurface::send_frame_callbacks()
 {
+    if (!frame_callbacks.empty())
+    {
+        tracepoint(
+            mir_server_wayland,
+            frame_callbacks_sent,
+            wl_resource_get_client(resource),
+            this,
+            current_buffer ? current_buffer.value().as_value() : 0,
+            static_cast<int>(frame_callbacks.size()));
+    }
+
     for (auto const& frame : frame_callbacks)
     {
         if (!*frame->destroyed)
@@ -237,6 +326,179 @@ void mf::WlSurface::send_frame_callbacks()
         }
     }
     frame_callbacks.clear();
+    frame_callbacks_last_sent = std::chrono::steady_clock::now();
+
+    frame_callbacks_await_refresh = false;
+    if (frame_callback_timer_armed)
+    {
+        wl_event_source_timer_update(frame_callback_timer, 0);
+        frame_callback_timer_armed = false;
+    }
+    update_presentation_reporting();
+}
+
+void mf::WlSurface::frame_callbacks_ready()
+{
+    if (frame_callbacks.empty())
+        return;
+
+    auto const surface = scene_surface();
+    if (!surface || !surface.value())
+    {
+        // Nothing the compositor shows (a cursor, say), so there's no refresh to wait for
+        send_frame_callbacks();
+        return;
+    }
+
+    frame_callbacks_await_refresh = true;
+    update_presentation_reporting();
+
+    if (!frame_callback_timer_armed)
+    {
+        if (!frame_callback_timer)
+        {
+            frame_callback_timer = wl_event_loop_add_timer(
+                wl_display_get_event_loop(wl_client_get_display(client)),
+                &on_frame_callback_timeout,
+                this);
+        }
+
+        // A rate limit longer than the usual wait stretches it; a shorter one is met by the refreshes
+        auto const timeout_ms = std::max<int>(
+            occluded() ? occluded_frame_callback_ms : refresh_clock.fallback().count(),
+            frame_callback_holdoff().count());
+        wl_event_source_timer_update(frame_callback_timer, timeout_ms);
+        frame_callback_timer_armed = true;
+    }
+}
+
+auto mf::WlSurface::frame_callback_holdoff() const -> std::chrono::milliseconds
+{
+    auto const surface = scene_surface();
+    if (!surface || !surface.value())
+        return std::chrono::milliseconds::zero();
+
+    auto const max_frame_rate = surface.value()->max_frame_rate();
+    if (max_frame_rate <= 0)
+        return std::chrono::milliseconds::zero();
+
+    auto const min_interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<float>{1.0f / max_frame_rate});
+    auto const elapsed = std::chrono::steady_clock::now() - frame_callbacks_last_sent;
+    if (elapsed >= min_interval)
+        return std::chrono::milliseconds::zero();
+
+    return std::chrono::ceil<std::chrono::milliseconds>(min_interval - elapsed);
+}
+
+auto mf::WlSurface::occluded() const -> bool
+{
+    auto const surface = scene_surface();
+    return surface && surface.value() &&
+        surface.value()->query(mir_window_attrib_visibility) == mir_window_visibility_occluded;
+}
+
+int mf::WlSurface::on_frame_callback_timeout(void* data)
+{
+    auto const self = static_cast<WlSurface*>(data);
+    self->frame_callback_timer_armed = false;
+    self->send_frame_callbacks();
+    return 0;
+}
+
+void mf::WlSurface::frame_presented(compositor::Presentation const& presentation)
+{
+    update_scanout_placement(presentation);
+
+    refresh_clock.presented(presentation.frame, presentation.output_area);
+
+    // Held back by the window manager's frame rate limit, they wait for a later refresh or the timer
+    if (frame_callbacks_await_refresh && frame_callback_holdoff() == std::chrono::milliseconds::zero())
+        send_frame_callbacks();
+
+    auto const is_presented = [&](auto const& feedback) { return feedback.first == presentation.buffer; };
+    auto const first = std::find_if(begin(presentation_feedbacks), end(presentation_feedbacks), is_presented);
+    if (first != end(presentation_feedbacks))
+    {
+        // Anything committed before this buffer was replaced without reaching the screen
+        for (auto i = begin(presentation_feedbacks); i != first; ++i)
+            i->second->discarded();
+
+        auto const last = std::find_if_not(first, end(presentation_feedbacks), is_presented);
+        for (auto i = first; i != last; ++i)
+            i->second->presented(presentation);
+
+        presentation_feedbacks.erase(begin(presentation_feedbacks), last);
+    }
+
+    // The content that set the barrier has been shown for a refresh, so commits waiting on it may follow
+    if (fifo_barrier && current_buffer && presentation.buffer == current_buffer.value())
+    {
+        fifo_barrier = std::experimental::nullopt;
+        queued_commits.apply_ready();
+    }
+    update_presentation_reporting();
+}
+
+void mf::WlSurface::update_scanout_placement(compositor::Presentation const& presentation)
+{
+    auto const fits_on = [&](geom::Rectangle const& output_area)
+        -> std::experimental::optional<graphics::ScanoutPlacement>
+        {
+            if (!output_area.contains(presentation.placement))
+                return std::experimental::nullopt;
+            return graphics::ScanoutPlacement{output_area, presentation.placement == output_area};
+        };
+
+    auto placement = fits_on(presentation.output_area);
+    // Where outputs overlap, we only need to fit on one of those presenting us
+    if (!placement && scanout_placement)
+        placement = fits_on(scanout_placement.value().output_area);
+
+    if (placement && scanout_placement &&
+        placement.value().output_area == scanout_placement.value().output_area &&
+        placement.value().fullscreen == scanout_placement.value().fullscreen)
+    {
+        return;
+    }
+    if (!placement && !scanout_placement)
+        return;
+
+    scanout_placement = placement;
+    allocator->surface_placed(resource, placement);
+}
+
+void mf::WlSurface::update_presentation_reporting()
+{
+    bool const wanted{frame_callbacks_await_refresh || !presentation_feedbacks.empty() || fifo_barrier};
+    if (wanted == stream_reports_presentation)
+        return;
+
+    if (wanted)
+    {
+        // Called on the compositor thread
+        stream->set_frame_presented_callback(
+            [executor = executor, weak_self = mw::make_weak(this)](compositor::Presentation const& presentation)
+            {
+                mir::thread::ExecutorBatch::spawn(executor, [weak_self, presentation]()
+                    {
+                        if (weak_self)
+                        {
+                            weak_self.value().frame_presented(presentation);
+                        }
+                    });
+            });
+    }
+    else
+    {
+        stream->set_frame_presented_callback([](auto const&){});
+    }
+    stream_reports_presentation = wanted;
+}
+
+void mf::WlSurface::add_presentation_feedback(std::shared_ptr<PresentationFeedback> const& feedback)
+{
+    pending.presentation_feedbacks.push_back(feedback);
 }
 
 void mf::WlSurface::destroy()
@@ -244,6 +506,18 @@ void mf::WlSurface::destroy()
     destroy_wayland_object();
 }
 
+void mf::WlSurface::set_explicit_synchronization(wl_resource* synchronization)
+{
+    this->synchronization = synchronization;
+    if (!synchronization)
+        pending.acquire_fence = std::experimental::nullopt;
+}
+
+void mf::WlSurface::set_pending_buffer_release(std::shared_ptr<LinuxBufferReleaseV1> const& release)
+{
+    pending.buffer_release = release;
+}
+
 void mf::WlSurface::attach(std::experimental::optional<wl_resource*> const& buffer, int32_t x, int32_t y)
 {
     if (x != 0 || y != 0)
@@ -254,22 +528,30 @@ void mf::WlSurface::attach(std::experimental::optional<wl_resource*> const& buff
     pending.buffer = buffer.value_or(nullptr);
 }
 
+namespace
+{
+/// Clients commonly damage {0, 0, INT32_MAX, INT32_MAX}, so take care not to overflow
+auto clamped_damage(int64_t x, int64_t y, int64_t width, int64_t height) -> geom::Rectangle
+{
+    int64_t const limit = std::numeric_limits<int32_t>::max();
+    x = std::clamp<int64_t>(x, 0, limit);
+    y = std::clamp<int64_t>(y, 0, limit);
+    width = std::clamp<int64_t>(width, 0, limit - x);
+    height = std::clamp<int64_t>(height, 0, limit - y);
+    return {
+        {static_cast<int32_t>(x), static_cast<int32_t>(y)},
+        {static_cast<int32_t>(width), static_cast<int32_t>(height)}};
+}
+}
+
 void mf::WlSurface::damage(int32_t x, int32_t y, int32_t width, int32_t height)
 {
-    (void)x;
-    (void)y;
-    (void)width;
-    (void)height;
-    // This isn't essential, but could enable optimizations
+    pending.surface_damage.add(clamped_damage(x, y, width, height));
 }
 
 void mf::WlSurface::damage_buffer(int32_t x, int32_t y, int32_t width, int32_t height)
 {
-    (void)x;
-    (void)y;
-    (void)width;
-    (void)height;
-    // This isn't essential, but could enable optimizations
+    pending.buffer_damage.add(clamped_damage(x, y, width, height));
 }
 
 void mf::WlSurface::frame(wl_resource* new_callback)
@@ -279,8 +561,10 @@ void mf::WlSurface::frame(wl_resource* new_callback)
 
 void mf::WlSurface::set_opaque_region(std::experimental::optional<wl_resource*> const& region)
 {
-    (void)region;
-    // This isn't essential, but could enable optimizations
+    if (region)
+        pending.opaque_region = WlRegion::from(region.value())->rectangle_vector();
+    else
+        pending.opaque_region = std::vector<geom::Rectangle>{};
 }
 
 void mf::WlSurface::set_input_region(std::experimental::optional<wl_resource*> const& region)
@@ -341,8 +625,40 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
     if (state.input_shape)
         input_shape = state.input_shape.value();
 
+    if (state.opaque_region)
+    {
+        // Lets the compositor skip drawing whatever we hide, even if our buffers have alpha
+        geom::Rectangles region;
+        for (auto const& rect : state.opaque_region.value())
+            region.add(rect);
+        stream->set_opaque_region(region);
+    }
+
     if (state.scale)
+    {
+        buffer_scale = state.scale.value();
         stream->set_scale(state.scale.value());
+    }
+
+    if (state.viewport_source)
+        viewport_source = state.viewport_source.value();
+
+    if (state.viewport_destination)
+        viewport_destination = state.viewport_destination.value();
+
+    if (state.viewport_source || state.viewport_destination)
+    {
+        stream->set_viewport(viewport_source, viewport_destination);
+
+        // The surface size may have changed even without a new buffer
+        if (buffer_size_)
+        {
+            auto const new_size = stream->stream_size();
+            if (!input_shape && new_size != buffer_size_.value())
+                state.invalidate_surface_data();
+            buffer_size_ = new_size;
+        }
+    }
 
     if (state.buffer)
     {
@@ -352,28 +668,69 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
         {
             // TODO: unmap surface, and unmap all subsurfaces
             buffer_size_ = std::experimental::nullopt;
+            current_buffer = std::experimental::nullopt;
             send_frame_callbacks();
+
+            for (auto const& feedback : presentation_feedbacks)
+                feedback.second->discarded();
+            presentation_feedbacks.clear();
         }
         else
         {
-            auto const executor_send_frame_callbacks = [executor = executor, weak_self = mw::make_weak(this)]()
+            auto const executor_frame_callbacks_ready = [executor = executor, weak_self = mw::make_weak(this)]()
                 {
-                    executor->spawn([weak_self]()
+                    mir::thread::ExecutorBatch::spawn(executor, [weak_self]()
                         {
                             if (weak_self)
                             {
-                                weak_self.value().send_frame_callbacks();
+                                weak_self.value().frame_callbacks_ready();
                             }
                         });
                 };
 
             std::shared_ptr<graphics::Buffer> mir_buffer;
 
-            if (auto const shm_buffer = wl_shm_buffer_get(buffer))
+            // Damage to the new buffer, in buffer coordinates
+            std::experimental::optional<geom::Rectangles> damage;
+            if (state.surface_damage.size() || state.buffer_damage.size())
+            {
+                damage = state.buffer_damage;
+                for (auto const& rect : state.surface_damage)
+                {
+                    damage.value().add(clamped_damage(
+                        int64_t{rect.left().as_int()} * buffer_scale,
+                        int64_t{rect.top().as_int()} * buffer_scale,
+                        int64_t{rect.size.width.as_int()} * buffer_scale,
+                        int64_t{rect.size.height.as_int()} * buffer_scale));
+                }
+            }
+
+            if (is_single_pixel_buffer(buffer))
             {
-                auto const stride = wl_shm_buffer_get_stride(shm_buffer);
-                auto const width = wl_shm_buffer_get_width(shm_buffer);
-                auto const format = wl_format_to_mir_format(wl_shm_buffer_get_format(shm_buffer));
+                auto release_buffer =
+                    [executor = executor, buffer = buffer, destroyed = deleted_flag_for_resource(buffer),
+                     buffer_release = state.buffer_release]()
+                    {
+                        mir::thread::ExecutorBatch::spawn(executor, [buffer, destroyed, buffer_release]()
+                            {
+                                if (buffer_release)
+                                    buffer_release->release({});
+                                if (!*destroyed)
+                                    wl_resource_post_event(buffer, wayland::Buffer::Opcode::release);
+                            });
+                    };
+
+                mir_buffer = single_pixel_buffer_from(buffer, std::move(release_buffer));
+                previous_shm_buffer.reset();
+
+                // There's nothing to upload, so it's as good as consumed already
+                executor_frame_callbacks_ready();
+            }
+            else if (auto const shm_content = graphics::wl_shm_buffer_content(buffer))
+            {
+                auto const stride = shm_content->stride().as_int();
+                auto const width = shm_content->size().width.as_int();
+                auto const format = wl_format_to_mir_format(shm_content->format());
                 if (stride < width * MIR_BYTES_PER_PIXEL(format)) {
                     wl_resource_post_error(
                         buffer,
@@ -385,39 +742,76 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
                     BOOST_THROW_EXCEPTION((
                                               std::runtime_error{"Buffer has invalid stride"}));
                 }
+                auto on_consumed = [frame_callbacks_ready = std::move(executor_frame_callbacks_ready),
+                                    executor = executor, buffer_release = state.buffer_release]()
+                    {
+                        // We're done with the client's pixels once they've been copied
+                        if (buffer_release)
+                            mir::thread::ExecutorBatch::spawn(executor, [buffer_release]() { buffer_release->release({}); });
+                        frame_callbacks_ready();
+                    };
+
                 mir_buffer = allocator->buffer_from_shm(
                     buffer,
                     executor,
-                    std::move(executor_send_frame_callbacks));
+                    std::move(on_consumed),
+                    previous_shm_buffer.lock(),
+                    damage);
+                previous_shm_buffer = mir_buffer;
                 tracepoint(
                     mir_server_wayland,
                     sw_buffer_committed,
                     wl_resource_get_client(resource),
+                    this,
                     mir_buffer->id().as_value());
             }
             else
             {
                 std::shared_ptr<bool> buffer_destroyed = deleted_flag_for_resource(buffer);
+                // Filled in once we have the buffer, so a zwp_linux_buffer_release_v1 can fence on them
+                auto const dma_bufs = std::make_shared<std::vector<mir::Fd>>();
 
-                auto release_buffer = [executor = executor, buffer = buffer, destroyed = buffer_destroyed]()
+                auto release_buffer =
+                    [executor = executor, buffer = buffer, destroyed = buffer_destroyed,
+                     buffer_release = state.buffer_release, dma_bufs]()
                     {
-                        executor->spawn(run_unless(
-                            destroyed,
-                            [buffer](){ wl_resource_post_event(buffer, wayland::Buffer::Opcode::release); }));
+                        mir::thread::ExecutorBatch::spawn(executor, [buffer, destroyed, buffer_release, dma_bufs]()
+                            {
+                                if (buffer_release)
+                                    buffer_release->release(*dma_bufs);
+                                if (!*destroyed)
+                                    wl_resource_post_event(buffer, wayland::Buffer::Opcode::release);
+                            });
                     };
 
                 mir_buffer = allocator->buffer_from_resource(
                     buffer,
-                    std::move(executor_send_frame_callbacks),
+                    std::move(executor_frame_callbacks_ready),
                     std::move(release_buffer));
+                if (auto const dmabuf = dynamic_cast<graphics::DMABufBuffer*>(mir_buffer->native_buffer_base()))
+                {
+                    for (auto const& plane : dmabuf->planes())
+                        dma_bufs->push_back(plane.dma_buf);
+                }
+                previous_shm_buffer.reset();
                 tracepoint(
                     mir_server_wayland,
                     hw_buffer_committed,
                     wl_resource_get_client(resource),
+                    this,
                     mir_buffer->id().as_value());
             }
 
+            if (damage)
+                stream->add_damage(damage.value());
+
             stream->submit_buffer(mir_buffer);
+            current_buffer = mir_buffer->id();
+            buffer_pixels = mir_buffer->size();
+
+            // The compositor won't consume a buffer it isn't showing, so don't wait for that
+            if (occluded())
+                frame_callbacks_ready();
             auto const new_buffer_size = stream->stream_size();
 
             if (!input_shape && std::experimental::make_optional(new_buffer_size) != buffer_size_)
@@ -430,9 +824,42 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
     }
     else
     {
-        send_frame_callbacks();
+        frame_callbacks_ready();
+    }
+
+    if (viewport_source && buffer_size_ && (state.viewport_source || state.buffer || state.scale))
+    {
+        // Posted rather than thrown, as a queued commit is applied outside of any request
+        auto const& source = viewport_source.value();
+        auto const right = (source.top_left.x.as_value() + source.size.width.as_value()) * buffer_scale;
+        auto const bottom = (source.top_left.y.as_value() + source.size.height.as_value()) * buffer_scale;
+        if (right > buffer_pixels.width.as_int() || bottom > buffer_pixels.height.as_int())
+        {
+            wl_resource_post_error(
+                viewport_ ? viewport_ : resource,
+                mw::Viewport::Error::out_of_buffer,
+                "wp_viewport source rectangle extends outside of the %dx%d buffer",
+                buffer_pixels.width.as_int(), buffer_pixels.height.as_int());
+        }
     }
 
+    // Feedback for a commit without a new buffer waits for the current one to be shown again
+    for (auto const& feedback : state.presentation_feedbacks)
+    {
+        if (current_buffer)
+            presentation_feedbacks.emplace_back(current_buffer.value(), feedback);
+        else
+            feedback->discarded();
+    }
+    // A barrier on content that can't be shown (no buffer, or no scene surface) has nothing to wait for
+    if (state.fifo_barrier && current_buffer && scene_surface().value_or(nullptr))
+    {
+        fifo_barrier = time::PosixTimestamp::now(CLOCK_MONOTONIC) + (occluded() ?
+            std::chrono::milliseconds{occluded_frame_callback_ms} : refresh_clock.fallback());
+    }
+
+    update_presentation_reporting();
+
     for (WlSubsurface* child: children)
     {
         child->parent_has_committed();
@@ -450,10 +877,82 @@ void mf::WlSurface::commit()
     if (pending.input_shape && *pending.input_shape == input_shape)
         pending.input_shape = std::experimental::nullopt;
 
+    if (synchronization && (pending.acquire_fence || pending.buffer_release) && !(pending.buffer && *pending.buffer))
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            synchronization,
+            mw::LinuxSurfaceSynchronizationV1::Error::no_buffer,
+            "Explicit synchronization requested without a buffer attached"));
+    }
+
+    if (synchronization && pending.acquire_fence && graphics::wl_shm_buffer_content(*pending.buffer))
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            synchronization,
+            mw::LinuxSurfaceSynchronizationV1::Error::unsupported_buffer,
+            "Acquire fences are not supported for wl_shm buffers"));
+    }
+
+    // Without a destination the source's size becomes the surface's, so must be whole
+    auto const& source = pending.viewport_source ? pending.viewport_source.value() : viewport_source;
+    auto const& destination = pending.viewport_destination ? pending.viewport_destination.value() : viewport_destination;
+    if (source && !destination && viewport_)
+    {
+        auto const size = source.value().size;
+        if (size.width.as_value() != std::floor(size.width.as_value()) ||
+            size.height.as_value() != std::floor(size.height.as_value()))
+        {
+            BOOST_THROW_EXCEPTION(mw::ProtocolError(
+                viewport_,
+                mw::Viewport::Error::bad_size,
+                "wp_viewport source size %fx%f is not integer and no destination is set",
+                size.width.as_value(), size.height.as_value()));
+        }
+    }
+
     // order is important
-    auto const state = std::move(pending);
+    auto state = std::move(pending);
     pending = WlSurfaceState();
-    role->commit(state);
+
+    // A synchronized subsurface is applied with its parent, so can't wait on its own barrier
+    if (synchronized())
+        state.fifo_wait = false;
+
+    // Rather than have the compositor wait on the client's rendering, we keep showing the previous buffer
+    // until the fence signals (or the FIFO barrier clears, or the target time nears). Later commits have to
+    // wait their turn.
+    if (state.acquire_fence || state.fifo_wait || state.target_time || !queued_commits.empty())
+    {
+        queued_commits.push(std::move(state));
+    }
+    else
+    {
+        role->commit(state);
+    }
+}
+
+auto mf::WlSurface::hold_commit_until(WlSurfaceState const& state)
+    -> std::experimental::optional<time::PosixTimestamp>
+{
+    if (state.fifo_wait && fifo_barrier)
+    {
+        // We don't hold commits back indefinitely for a refresh that isn't coming (when we're occluded, say)
+        if (time::PosixTimestamp::now(CLOCK_MONOTONIC) < fifo_barrier.value())
+            return fifo_barrier;
+
+        fifo_barrier = std::experimental::nullopt;
+        update_presentation_reporting();
+    }
+
+    if (state.target_time)
+    {
+        // Applying half a refresh early lands the content on the refresh closest to its target
+        auto const apply_at = state.target_time.value() - refresh_clock.interval() / 2;
+        if (time::PosixTimestamp::now(CLOCK_MONOTONIC) < apply_at)
+            return apply_at;
+    }
+
+    return std::experimental::nullopt;
 }
 
 void mf::WlSurface::set_buffer_transform(int32_t transform)
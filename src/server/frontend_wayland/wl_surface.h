@@ -22,20 +22,33 @@
 #include "wayland_wrapper.h"
 
 #include "wl_surface_role.h"
+#include "commit_queue.h"
+#include "refresh_clock.h"
 
 #include "mir/geometry/displacement.h"
 #include "mir/geometry/size.h"
 #include "mir/geometry/point.h"
+#include "mir/geometry/rectangles.h"
+#include "mir/geometry/rectangle_f.h"
+#include "mir/graphics/buffer_id.h"
+#include "mir/graphics/graphic_buffer_allocator.h"
+#include "mir/graphics/frame.h"
+#include "mir/time/posix_timestamp.h"
 
+#include <chrono>
+#include <deque>
 #include <vector>
 #include <map>
 
+struct wl_event_source;
+
 namespace mir
 {
 class Executor;
 
 namespace graphics
 {
+class Buffer;
 class GraphicBufferAllocator;
 }
 namespace scene
@@ -53,11 +66,14 @@ class Rectangle;
 namespace compositor
 {
 class BufferStream;
+struct Presentation;
 }
 namespace frontend
 {
 class WlSurface;
 class WlSubsurface;
+class LinuxBufferReleaseV1;
+class PresentationFeedback;
 
 struct WlSurfaceState
 {
@@ -83,7 +99,22 @@ struct WlSurfaceState
     std::experimental::optional<int> scale;
     std::experimental::optional<geometry::Displacement> offset;
     std::experimental::optional<std::experimental::optional<std::vector<geometry::Rectangle>>> input_shape;
+    std::experimental::optional<std::vector<geometry::Rectangle>> opaque_region;    ///< In surface coordinates
     std::vector<std::shared_ptr<Callback>> frame_callbacks;
+    geometry::Rectangles surface_damage;    ///< From wl_surface.damage, in surface coordinates
+    geometry::Rectangles buffer_damage;     ///< From wl_surface.damage_buffer, in buffer coordinates
+    std::experimental::optional<mir::Fd> acquire_fence;    ///< Must signal before the buffer may be used
+    std::shared_ptr<LinuxBufferReleaseV1> buffer_release;   ///< Told when we're finished with the buffer
+    std::experimental::optional<bool> tearing_allowed;      ///< From wp_tearing_control_v1's presentation hint
+    /// From wp_viewport.set_source, in surface coordinates (nullopt inside to show the whole buffer)
+    std::experimental::optional<std::experimental::optional<geometry::RectangleF>> viewport_source;
+    /// From wp_viewport.set_destination (nullopt inside for the size of the source)
+    std::experimental::optional<std::experimental::optional<geometry::Size>> viewport_destination;
+    std::vector<std::shared_ptr<PresentationFeedback>> presentation_feedbacks;
+    bool fifo_barrier{false};   ///< From wp_fifo_v1.set_barrier: held until this content has been shown
+    bool fifo_wait{false};      ///< From wp_fifo_v1.wait_barrier: not to be applied while a barrier is held
+    /// From wp_commit_timer_v1, in CLOCK_MONOTONIC: not to be shown before this
+    std::experimental::optional<time::PosixTimestamp> target_time;
 
 private:
     // only set to true if invalidate_surface_data() is called
@@ -130,6 +161,36 @@ public:
     void remove_subsurface(WlSubsurface* child);
     void refresh_surface_data_now();
     void pending_invalidate_surface_data() { pending.invalidate_surface_data(); }
+    /// The zwp_linux_surface_synchronization_v1 for this surface, if there is one
+    auto explicit_synchronization() const -> wl_resource* { return synchronization; }
+    /// Setting nullptr discards any acquire fence not yet committed
+    void set_explicit_synchronization(wl_resource* synchronization);
+    bool has_pending_acquire_fence() const { return static_cast<bool>(pending.acquire_fence); }
+    void set_pending_acquire_fence(mir::Fd const& fence) { pending.acquire_fence = fence; }
+    bool has_pending_buffer_release() const { return static_cast<bool>(pending.buffer_release); }
+    void set_pending_buffer_release(std::shared_ptr<LinuxBufferReleaseV1> const& release);
+    /// The wp_tearing_control_v1 for this surface, if there is one
+    auto tearing_control() const -> wl_resource* { return tearing_control_; }
+    void set_tearing_control(wl_resource* tearing_control) { tearing_control_ = tearing_control; }
+    void set_pending_tearing_allowed(bool allowed) { pending.tearing_allowed = allowed; }
+    /// The wp_viewport for this surface, if there is one
+    auto viewport() const -> wl_resource* { return viewport_; }
+    void set_viewport(wl_resource* viewport) { viewport_ = viewport; }
+    void set_pending_viewport_source(std::experimental::optional<geometry::RectangleF> const& source)
+        { pending.viewport_source = source; }
+    void set_pending_viewport_destination(std::experimental::optional<geometry::Size> const& destination)
+        { pending.viewport_destination = destination; }
+    /// The wp_fifo_v1 for this surface, if there is one
+    auto fifo() const -> wl_resource* { return fifo_; }
+    void set_fifo(wl_resource* fifo) { fifo_ = fifo; }
+    void set_pending_fifo_barrier() { pending.fifo_barrier = true; }
+    void set_pending_fifo_wait() { pending.fifo_wait = true; }
+    /// The wp_commit_timer_v1 for this surface, if there is one
+    auto commit_timer() const -> wl_resource* { return commit_timer_; }
+    void set_commit_timer(wl_resource* commit_timer) { commit_timer_ = commit_timer; }
+    bool has_pending_target_time() const { return static_cast<bool>(pending.target_time); }
+    void set_pending_target_time(time::PosixTimestamp const& target) { pending.target_time = target; }
+    void add_presentation_feedback(std::shared_ptr<PresentationFeedback> const& feedback);
     void populate_surface_data(std::vector<shell::StreamSpecification>& buffer_streams,
                                std::vector<mir::geometry::Rectangle>& input_shape_accumulator,
                                geometry::Displacement const& parent_offset) const;
@@ -152,10 +213,55 @@ private:
     WlSurfaceState pending;
     geometry::Displacement offset_;
     std::experimental::optional<geometry::Size> buffer_size_;
+    int buffer_scale{1};
+    /// The most recently committed buffer, if it was wl_shm; its texture can be reused
+    std::weak_ptr<graphics::Buffer> previous_shm_buffer;
     std::vector<std::shared_ptr<WlSurfaceState::Callback>> frame_callbacks;
+    /// frame_callbacks are ready to go with the next refresh of an output showing us
+    bool frame_callbacks_await_refresh{false};
+    /// Sends frame_callbacks if no refresh shows us in time (as when we're occluded)
+    wl_event_source* frame_callback_timer{nullptr};
+    bool frame_callback_timer_armed{false};
+    /// When frame_callbacks were last sent, to pace them to the window manager's max_frame_rate()
+    std::chrono::steady_clock::time_point frame_callbacks_last_sent;
+    /// The buffer now on the stream, if there is one
+    std::experimental::optional<graphics::BufferID> current_buffer;
+    /// Committed feedback, in order, with the buffer whose presentation it waits for
+    std::deque<std::pair<graphics::BufferID, std::shared_ptr<PresentationFeedback>>> presentation_feedbacks;
+    bool stream_reports_presentation{false};
+    /// Where the allocator was last told we are, for choosing buffers an output could scan out
+    std::experimental::optional<graphics::ScanoutPlacement> scanout_placement;
     std::experimental::optional<std::vector<mir::geometry::Rectangle>> input_shape;
+    wl_resource* synchronization{nullptr};
+    wl_resource* tearing_control_{nullptr};
+    wl_resource* viewport_{nullptr};
+    wl_resource* fifo_{nullptr};
+    wl_resource* commit_timer_{nullptr};
+    std::experimental::optional<geometry::RectangleF> viewport_source;
+    std::experimental::optional<geometry::Size> viewport_destination;
+    /// The size, in pixels, of the buffer now on the stream
+    geometry::Size buffer_pixels;
+    /// Commits waiting, in order, for the first one's acquire fence, FIFO barrier or target time
+    CommitQueue<WlSurfaceState> queued_commits;
+    /// Set when content with a FIFO barrier is applied, until it's shown or this deadline passes
+    std::experimental::optional<time::PosixTimestamp> fifo_barrier;
+    /// The refresh interval of the output last showing us
+    RefreshClock refresh_clock;
 
     void send_frame_callbacks();
+    /// Sends frame_callbacks with the next refresh that shows us, or at a throttled rate if none does
+    void frame_callbacks_ready();
+    static int on_frame_callback_timeout(void* data);
+    auto occluded() const -> bool;
+    /// How long the window manager's frame rate limit holds frame_callbacks back from being sent
+    auto frame_callback_holdoff() const -> std::chrono::milliseconds;
+    void frame_presented(compositor::Presentation const& presentation);
+    /// Tells the allocator if the presentation shows we've moved on or off an output
+    void update_scanout_placement(compositor::Presentation const& presentation);
+    /// Only has the stream tell us about presentations while frame callbacks, feedback or a barrier wait for one
+    void update_presentation_reporting();
+    /// When queued_commits may apply \a state, for its FIFO barrier or target time
+    auto hold_commit_until(WlSurfaceState const& state) -> std::experimental::optional<time::PosixTimestamp>;
 
     void destroy() override;
     void attach(std::experimental::optional<wl_resource*> const& buffer, int32_t x, int32_t y) override;
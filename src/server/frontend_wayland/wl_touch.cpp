@@ -19,6 +19,7 @@
 #include "wl_touch.h"
 
 #include "wayland_utils.h"
+#include "client_backlog.h"
 #include "wl_surface.h"
 #include "wl_seat.h"
 
@@ -33,7 +34,16 @@ namespace mw = mir::wayland;
 namespace geom = mir::geometry;
 
 mf::WlTouch::WlTouch(wl_resource* new_resource)
-    : Touch(new_resource, Version<6>())
+    : Touch(new_resource, Version<6>()),
+      motion_backlog{
+          wl_display_get_event_loop(wl_client_get_display(client)),
+          [this]() { return client_is_backlogged(client); },
+          [this](int32_t touch_id, PendingMotion const& motion)
+          {
+              send_motion_event(motion.timestamp.count(), touch_id, motion.position.first, motion.position.second);
+              needs_frame = true;
+          },
+          [this]() { maybe_frame(); }}
 {
 }
 
@@ -92,6 +102,8 @@ void mf::WlTouch::down(
     WlSurface& root_surface,
     std::pair<float, float> const& root_position)
 {
+    motion_backlog.flush();
+
     geom::Point root_point{root_position.first, root_position.second};
     auto const target_surface = root_surface.subsurface_at(root_point).value_or(&root_surface);
     auto const offset = target_surface->total_offset();
@@ -145,16 +157,14 @@ void mf::WlTouch::motion(
         root_position.first - offset.dx.as_int(),
         root_position.second - offset.dy.as_int());
 
-    send_motion_event(
-        ms.count(),
-        touch_id,
-        position_on_target.first,
-        position_on_target.second);
-    needs_frame = true;
+    motion_backlog.motion(touch_id, PendingMotion{ms, position_on_target});
 }
 
 void mf::WlTouch::up(uint32_t serial, std::chrono::milliseconds const& ms, int32_t touch_id)
 {
+    // The client needs to know where the touch was when it was lifted
+    motion_backlog.flush();
+
     auto const touch = touch_id_to_surface.find(touch_id);
     if (touch != touch_id_to_surface.end())
     {
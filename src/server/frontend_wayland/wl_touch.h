@@ -20,6 +20,7 @@
 #define MIR_FRONTEND_WL_TOUCH_H
 
 #include "wayland_wrapper.h"
+#include "motion_backlog.h"
 
 #include "mir/geometry/point.h"
 
@@ -59,6 +60,15 @@ private:
     std::unordered_map<int32_t, TouchedSurface> touch_id_to_surface;
     bool needs_frame{false};
 
+    /// While the client is backlogged only the latest motion of each touch is kept, to be sent when it catches
+    /// up or before the next down or up
+    struct PendingMotion
+    {
+        std::chrono::milliseconds timestamp;
+        std::pair<float, float> position;
+    };
+    MotionBacklog<int32_t, PendingMotion> motion_backlog;
+
     void down(
         uint32_t serial,
         std::chrono::milliseconds const& ms,
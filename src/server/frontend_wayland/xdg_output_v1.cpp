@@ -106,7 +106,6 @@ void mf::XdgOutputManagerV1::Instance::destroy()
 
 void mf::XdgOutputManagerV1::Instance::get_xdg_output(wl_resource* new_output, wl_resource* output)
 {
-    bool found = false;
     auto const output_id_opt = output_manager->output_id_for(client, output);
     if (!output_id_opt)
     {
@@ -115,26 +114,16 @@ void mf::XdgOutputManagerV1::Instance::get_xdg_output(wl_resource* new_output, w
     }
     auto const output_id = output_id_opt.value();
 
-    output_manager->display_config()->for_each_output(
-        [&found, output, output_id, new_output](mg::DisplayConfigurationOutput const& config)
-        {
-            if (config.id == output_id)
-            {
-                if (found)
-                {
-                    BOOST_THROW_EXCEPTION(std::runtime_error(
-                        "Found multiple output configs with id " + std::to_string(output_id.as_value())));
-                }
-                new XdgOutputV1{new_output, config, output};
-                found = true;
-            }
-        });
-
+    // The output manager keeps the current configuration of each output, so there's no need to fetch (and search) the
+    // whole display configuration for every client
+    auto const found = output_manager->output_for(output_id);
     if (!found)
     {
         BOOST_THROW_EXCEPTION(std::runtime_error(
             "Did not find output config with id " + std::to_string(output_id.as_value())));
     }
+
+    new XdgOutputV1{new_output, found.value()->configuration(), output};
 }
 
 mf::XdgOutputV1::XdgOutputV1(
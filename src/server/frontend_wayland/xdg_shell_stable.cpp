@@ -58,7 +58,11 @@ public:
     void set_window_geometry(int32_t x, int32_t y, int32_t width, int32_t height) override;
     void ack_configure(uint32_t serial) override;
 
-    void send_configure();
+    /// Returns the serial of the configure sent
+    auto send_configure() -> uint32_t;
+
+    /// If the client has acked the configure with the given serial (or a later one)
+    auto has_acked(uint32_t serial) const -> bool;
 
     mw::Weak<WindowWlSurfaceRole> const& window_role();
 
@@ -70,6 +74,7 @@ private:
 
     mw::Weak<WindowWlSurfaceRole> window_role_;
     WlSurface* const surface;
+    std::experimental::optional<uint32_t> latest_acked_serial;
 
 public:
     XdgShellStable const& xdg_shell;
@@ -98,7 +103,7 @@ public:
     void unset_fullscreen() override;
     void set_minimized() override;
 
-    void handle_commit() override {};
+    void handle_commit() override;
     void handle_state_change(MirWindowState /*new_state*/) override;
     void handle_active_change(bool /*is_now_active*/) override;
     void handle_resize(std::experimental::optional<geometry::Point> const& new_top_left,
@@ -110,6 +115,11 @@ private:
     void send_toplevel_configure();
 
     XdgSurfaceStable* const xdg_surface;
+
+    /// The configure the client is still working on (if any). While there is one, resizes are held back so that a
+    /// slow client isn't buried under configures for sizes that are already out of date.
+    std::experimental::optional<uint32_t> unacked_configure;
+    bool resize_deferred{false}; ///< If a resize arrived while unacked_configure was set
 };
 
 class XdgPositionerStable : public mw::XdgPositioner, public shell::SurfaceSpecification
@@ -255,14 +265,20 @@ void mf::XdgSurfaceStable::set_window_geometry(int32_t x, int32_t y, int32_t wid
 
 void mf::XdgSurfaceStable::ack_configure(uint32_t serial)
 {
-    (void)serial;
-    // TODO
+    latest_acked_serial = serial;
 }
 
-void mf::XdgSurfaceStable::send_configure()
+auto mf::XdgSurfaceStable::send_configure() -> uint32_t
 {
     auto const serial = wl_display_next_serial(wl_client_get_display(mw::XdgSurface::client));
     send_configure_event(serial);
+    return serial;
+}
+
+auto mf::XdgSurfaceStable::has_acked(uint32_t serial) const -> bool
+{
+    // Serials wrap, so compare the difference rather than the values
+    return latest_acked_serial && static_cast<int32_t>(latest_acked_serial.value() - serial) >= 0;
 }
 
 mw::Weak<mf::WindowWlSurfaceRole> const& mf::XdgSurfaceStable::window_role()
@@ -541,6 +557,19 @@ void mf::XdgToplevelStable::set_minimized()
     set_state_now(mir_window_state_minimized);
 }
 
+void mf::XdgToplevelStable::handle_commit()
+{
+    if (unacked_configure && xdg_surface->has_acked(unacked_configure.value()))
+    {
+        // The client has caught up, so now tell it the latest size (if that's changed in the meantime)
+        unacked_configure = std::experimental::nullopt;
+        if (resize_deferred)
+        {
+            send_toplevel_configure();
+        }
+    }
+}
+
 void mf::XdgToplevelStable::handle_state_change(MirWindowState /*new_state*/)
 {
     send_toplevel_configure();
@@ -554,7 +583,15 @@ void mf::XdgToplevelStable::handle_active_change(bool /*is_now_active*/)
 void mf::XdgToplevelStable::handle_resize(std::experimental::optional<geometry::Point> const& /*new_top_left*/,
                                           geometry::Size const& /*new_size*/)
 {
-    send_toplevel_configure();
+    if (unacked_configure)
+    {
+        // An interactive resize produces one of these for every pointer motion. The client only needs the latest.
+        resize_deferred = true;
+    }
+    else
+    {
+        send_toplevel_configure();
+    }
 }
 
 void mf::XdgToplevelStable::handle_close_request()
@@ -597,7 +634,8 @@ void mf::XdgToplevelStable::send_toplevel_configure()
     send_configure_event(size.width.as_int(), size.height.as_int(), &states);
     wl_array_release(&states);
 
-    xdg_surface->send_configure();
+    unacked_configure = xdg_surface->send_configure();
+    resize_deferred = false;
 }
 
 mf::XdgToplevelStable* mf::XdgToplevelStable::from(wl_resource* surface)
@@ -0,0 +1,88 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_FRONTEND_XWAYLAND_RESTACK_ORDER_H
+#define MIR_FRONTEND_XWAYLAND_RESTACK_ORDER_H
+
+#include <xcb/xcb.h>
+
+#include <algorithm>
+#include <experimental/optional>
+#include <unordered_map>
+#include <vector>
+
+namespace mir
+{
+namespace frontend
+{
+/// For each window in new_order, whether it can stay put
+/// These are the longest subsequence of new_order already stacked in that order in old_order. Windows not in
+/// old_order must always move, as must all but one of a window that appears more than once in new_order.
+inline auto windows_that_keep_their_order(
+    std::vector<xcb_window_t> const& old_order,
+    std::vector<xcb_window_t> const& new_order) -> std::vector<bool>
+{
+    std::unordered_map<xcb_window_t, size_t> old_index;
+    for (size_t i = 0; i < old_order.size(); i++)
+    {
+        old_index[old_order[i]] = i;
+    }
+
+    // Longest increasing subsequence of old indices, by patience sorting
+    // tails[n] is the position in new_order that ends the best subsequence of length n + 1 found so far
+    std::vector<size_t> tails;
+    std::vector<std::experimental::optional<size_t>> previous(new_order.size());
+    auto const old_index_at = [&](size_t i) { return old_index.at(new_order[i]); };
+    for (size_t i = 0; i < new_order.size(); i++)
+    {
+        if (old_index.find(new_order[i]) == old_index.end())
+        {
+            continue;
+        }
+
+        auto const insert_at = std::lower_bound(
+            tails.begin(), tails.end(), old_index_at(i),
+            [&](size_t tail, size_t index) { return old_index_at(tail) < index; });
+
+        if (insert_at != tails.begin())
+        {
+            previous[i] = *(insert_at - 1);
+        }
+
+        if (insert_at == tails.end())
+        {
+            tails.push_back(i);
+        }
+        else
+        {
+            *insert_at = i;
+        }
+    }
+
+    std::vector<bool> result(new_order.size(), false);
+    if (!tails.empty())
+    {
+        for (std::experimental::optional<size_t> i = tails.back(); i; i = previous[i.value()])
+        {
+            result[i.value()] = true;
+        }
+    }
+    return result;
+}
+}
+}
+
+#endif // MIR_FRONTEND_XWAYLAND_RESTACK_ORDER_H
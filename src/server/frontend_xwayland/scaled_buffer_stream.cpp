@@ -19,6 +19,8 @@
 #include "scaled_buffer_stream.h"
 #include "mir/log.h"
 
+#include <cmath>
+
 namespace mf = mir::frontend;
 
 mf::ScaledBufferStream::ScaledBufferStream(std::shared_ptr<compositor::BufferStream>&& inner, float scale)
@@ -32,12 +34,35 @@ void mf::ScaledBufferStream::submit_buffer(std::shared_ptr<graphics::Buffer> con
     inner->submit_buffer(buffer);
 }
 
+void mf::ScaledBufferStream::add_damage(geometry::Rectangles const& buffer_damage)
+{
+    // Damage is in buffer coordinates, so is unaffected by our scale
+    inner->add_damage(buffer_damage);
+}
+
+auto mf::ScaledBufferStream::submitted_damage() const -> std::experimental::optional<geometry::Rectangles>
+{
+    return inner->submitted_damage();
+}
+
+void mf::ScaledBufferStream::set_opaque_region(geometry::Rectangles const& region)
+{
+    // The region is in the inner stream's coordinates
+    inner->set_opaque_region(region);
+}
+
 void mf::ScaledBufferStream::set_frame_posted_callback(std::function<void(geometry::Size const&)> const& callback)
 {
     // Does this need to be scaled? I don't ? think ? so? compositor::Stream seems to leave it unscaled.
     inner->set_frame_posted_callback(callback);
 }
 
+void mf::ScaledBufferStream::set_frame_presented_callback(
+    std::function<void(compositor::Presentation const&)> const& callback)
+{
+    inner->set_frame_presented_callback(callback);
+}
+
 void mf::ScaledBufferStream::with_most_recent_buffer_do(std::function<void(graphics::Buffer&)> const& exec)
 {
     inner->with_most_recent_buffer_do(exec);
@@ -59,6 +84,14 @@ void mf::ScaledBufferStream::set_scale(float scale)
     inner->set_scale(scale);
 }
 
+void mf::ScaledBufferStream::set_viewport(
+    std::experimental::optional<geometry::RectangleF> const& source,
+    std::experimental::optional<geometry::Size> const& destination)
+{
+    // Like set_scale(), this is the inner stream's business
+    inner->set_viewport(source, destination);
+}
+
 auto mf::ScaledBufferStream::lock_compositor_buffer(void const* user_id) -> std::shared_ptr<graphics::Buffer>
 {
     return inner->lock_compositor_buffer(user_id);
@@ -70,6 +103,12 @@ auto mf::ScaledBufferStream::stream_size() -> geometry::Size
     return inner->stream_size() * inv_scale;
 }
 
+auto mf::ScaledBufferStream::source_bounds(geometry::Size const& buffer_size) const -> geometry::RectangleF
+{
+    // Scaling the stream doesn't change which part of the buffer it shows
+    return inner->source_bounds(buffer_size);
+}
+
 auto mf::ScaledBufferStream::buffers_ready_for_compositor(void const* user_id) const -> int
 {
     return inner->buffers_ready_for_compositor(user_id);
@@ -90,4 +129,29 @@ auto mf::ScaledBufferStream::framedropping() const -> bool
     return inner->framedropping();
 }
 
+auto mf::ScaledBufferStream::buffer_damage(void const* user_id) const
+    -> std::experimental::optional<geometry::Rectangles>
+{
+    return inner->buffer_damage(user_id);
+}
+
+auto mf::ScaledBufferStream::opaque_region() const -> geometry::Rectangles
+{
+    // Scale the inner stream's region to match stream_size(), rounding inwards so we never claim too much
+    geometry::Rectangles result;
+    for (auto const& rect : inner->opaque_region())
+    {
+        int const left = std::ceil(rect.left().as_int() * inv_scale);
+        int const top = std::ceil(rect.top().as_int() * inv_scale);
+        int const right = std::floor(rect.right().as_int() * inv_scale);
+        int const bottom = std::floor(rect.bottom().as_int() * inv_scale);
+        if (right > left && bottom > top)
+            result.add({{left, top}, {right - left, bottom - top}});
+    }
+    return result;
+}
 
+void mf::ScaledBufferStream::frame_presented(compositor::Presentation const& presentation)
+{
+    inner->frame_presented(presentation);
+}
@@ -28,6 +28,9 @@ namespace frontend
 /// Wrappes another buffer stream and scales it's size, which is required for scaling XWayland surfaces without messing
 /// with the scale of the buffer stream owned by the underlying WlSurface.
 ///
+/// Only the geometry is scaled here, once per query. The pixels are never resampled on the CPU. The renderer maps
+/// the unchanged buffer onto the (smaller or larger) stream_size() when it draws, as it does for any other surface.
+///
 /// Note that even though shell->modify_surface() takes a frontend::BufferStream, this must implement
 /// compositor::BufferStream as well because some dynamic casting happens somewhere.
 class ScaledBufferStream : public compositor::BufferStream
@@ -38,21 +41,32 @@ public:
     /// Overrides from frontend::BufferStream
     /// @{
     void submit_buffer(std::shared_ptr<graphics::Buffer> const& buffer);
+    void add_damage(geometry::Rectangles const& buffer_damage);
+    auto submitted_damage() const -> std::experimental::optional<geometry::Rectangles>;
+    void set_opaque_region(geometry::Rectangles const& region);
     void set_frame_posted_callback(std::function<void(geometry::Size const&)> const& callback);
+    void set_frame_presented_callback(std::function<void(compositor::Presentation const&)> const& callback);
     void with_most_recent_buffer_do(std::function<void(graphics::Buffer&)> const& exec);
     MirPixelFormat pixel_format() const;
     void allow_framedropping(bool allow);
     void set_scale(float scale);
+    void set_viewport(
+        std::experimental::optional<geometry::RectangleF> const& source,
+        std::experimental::optional<geometry::Size> const& destination);
     /// @}
 
     /// Overrides from compositor::BufferStream
     /// @{
     auto lock_compositor_buffer(void const* user_id) -> std::shared_ptr<graphics::Buffer>;
     auto stream_size() -> geometry::Size;
+    auto source_bounds(geometry::Size const& buffer_size) const -> geometry::RectangleF;
     auto buffers_ready_for_compositor(void const* user_id) const -> int;
     void drop_old_buffers();
     auto has_submitted_buffer() const -> bool;
     auto framedropping() const -> bool;
+    auto buffer_damage(void const* user_id) const -> std::experimental::optional<geometry::Rectangles>;
+    auto opaque_region() const -> geometry::Rectangles;
+    void frame_presented(compositor::Presentation const& presentation);
     /// @}
 
 private:
@@ -23,6 +23,7 @@
 #include "mir/c_memory.h"
 
 #include "boost/throw_exception.hpp"
+#include <xcb/xcbext.h>
 #include <sstream>
 
 namespace mf = mir::frontend;
@@ -178,6 +179,7 @@ mf::XCBConnection::Atom::Atom(std::string const& name, XCBConnection* connection
       name_{name},
       cookie{xcb_intern_atom(*connection, 0, name_.size(), name_.c_str())}
 {
+    connection->declared_atoms.push_back(this);
 }
 
 mf::XCBConnection::Atom::operator xcb_atom_t() const
@@ -208,6 +210,32 @@ mf::XCBConnection::XCBConnection(Fd const& fd)
       xcb_screen{xcb_setup_roots_iterator(xcb_get_setup(xcb_connection)).data},
       atom_name_cache{{XCB_ATOM_NONE, "None/Any"}}
 {
+    // The names of the predefined atoms only matter for logging, but are looked up often when it's enabled
+    std::vector<std::pair<xcb_atom_t, xcb_get_atom_name_cookie_t>> predefined_names;
+    if (verbose_xwayland_logging_enabled())
+    {
+        for (xcb_atom_t atom = XCB_ATOM_PRIMARY; atom <= XCB_ATOM_WM_TRANSIENT_FOR; atom++)
+        {
+            predefined_names.emplace_back(atom, xcb_get_atom_name(xcb_connection, atom));
+        }
+    }
+
+    // Every declared atom sent its intern request on construction, so waiting on them all now costs a single round
+    // trip. That spares the first X11 client the wait, and fills the cache used by query_name().
+    for (auto const atom : declared_atoms)
+    {
+        static_cast<xcb_atom_t>(*atom);
+    }
+
+    for (auto const& predefined : predefined_names)
+    {
+        if (auto const reply = make_unique_cptr(xcb_get_atom_name_reply(xcb_connection, predefined.second, nullptr)))
+        {
+            atom_name_cache[predefined.first] = std::string{
+                xcb_get_atom_name_name(reply.get()),
+                static_cast<size_t>(xcb_get_atom_name_name_length(reply.get()))};
+        }
+    }
 }
 
 mf::XCBConnection::~XCBConnection()
@@ -225,35 +253,35 @@ void mf::XCBConnection::verify_not_in_error_state() const
 
 auto mf::XCBConnection::query_name(xcb_atom_t atom) const -> std::string
 {
-    std::lock_guard<std::mutex>{atom_name_cache_mutex};
-    auto const iter = atom_name_cache.find(atom);
-
-    if (iter == atom_name_cache.end())
     {
-        xcb_get_atom_name_cookie_t const cookie = xcb_get_atom_name(xcb_connection, atom);
-        auto const reply = make_unique_cptr(xcb_get_atom_name_reply(xcb_connection, cookie, nullptr));
-
-        std::string name;
-
-        if (reply)
+        std::lock_guard<std::mutex> lock{atom_name_cache_mutex};
+        auto const iter = atom_name_cache.find(atom);
+        if (iter != atom_name_cache.end())
         {
-            name = std::string{
-                xcb_get_atom_name_name(reply.get()),
-                static_cast<size_t>(xcb_get_atom_name_name_length(reply.get()))};
-        }
-        else
-        {
-            name = "Atom " + std::to_string(atom);
+            return iter->second;
         }
+    }
 
-        atom_name_cache[atom] = name;
+    // Not under lock, as this is a round trip
+    xcb_get_atom_name_cookie_t const cookie = xcb_get_atom_name(xcb_connection, atom);
+    auto const reply = make_unique_cptr(xcb_get_atom_name_reply(xcb_connection, cookie, nullptr));
 
-        return name;
+    std::string name;
+
+    if (reply)
+    {
+        name = std::string{
+            xcb_get_atom_name_name(reply.get()),
+            static_cast<size_t>(xcb_get_atom_name_name_length(reply.get()))};
     }
     else
     {
-        return iter->second;
+        name = "Atom " + std::to_string(atom);
     }
+
+    std::lock_guard<std::mutex> lock{atom_name_cache_mutex};
+    atom_name_cache[atom] = name;
+    return name;
 }
 
 auto mf::XCBConnection::reply_contains_string_data(xcb_get_property_reply_t const* reply) const -> bool
@@ -285,31 +313,20 @@ bool mf::XCBConnection::is_ours(uint32_t id) const
     return (id & ~setup->resource_id_mask) == setup->resource_id_base;
 }
 
-auto mf::XCBConnection::read_property(
+auto mf::XCBConnection::reply_completion(
     xcb_window_t window,
     xcb_atom_t prop,
-    bool delete_after_read,
-    uint32_t max_length,
-    Handler<xcb_get_property_reply_t*>&& handler) const -> std::function<void()>
+    Handler<xcb_get_property_reply_t*>&& handler) const -> ReplyCompletion
 {
-    xcb_get_property_cookie_t cookie = xcb_get_property(
-        xcb_connection,
-        delete_after_read ? 1 : 0,
-        window,
-        prop,
-        XCB_ATOM_ANY,
-        0, // no offset
-        max_length);
-
-    return [this, cookie, handler=std::move(handler), window, prop]()
+    return [this, handler=std::move(handler), window, prop](
+            xcb_get_property_reply_t* reply,
+            xcb_generic_error_t* error)
         {
             try
             {
-                Error error;
-                auto const reply = make_unique_cptr(xcb_get_property_reply(xcb_connection, cookie, &error.ptr));
                 if (reply && reply->type != XCB_ATOM_NONE)
                 {
-                    handler.on_success(reply.get());
+                    handler.on_success(reply);
                 }
                 else if (reply)
                 {
@@ -327,7 +344,7 @@ auto mf::XCBConnection::read_property(
                     {
                         message = "error reading " + window_debug_string(window) + "." + query_name(prop) + ": ";
                     }
-                    handler.on_error(message + error_debug_string(error.ptr));
+                    handler.on_error(message + error_debug_string(error));
                 }
             }
             catch (...)
@@ -341,6 +358,30 @@ auto mf::XCBConnection::read_property(
         };
 }
 
+auto mf::XCBConnection::read_property(
+    xcb_window_t window,
+    xcb_atom_t prop,
+    bool delete_after_read,
+    uint32_t max_length,
+    Handler<xcb_get_property_reply_t*>&& handler) const -> std::function<void()>
+{
+    xcb_get_property_cookie_t cookie = xcb_get_property(
+        xcb_connection,
+        delete_after_read ? 1 : 0,
+        window,
+        prop,
+        XCB_ATOM_ANY,
+        0, // no offset
+        max_length);
+
+    return [this, cookie, complete=reply_completion(window, prop, std::move(handler))]()
+        {
+            Error error;
+            auto const reply = make_unique_cptr(xcb_get_property_reply(xcb_connection, cookie, &error.ptr));
+            complete(reply.get(), error.ptr);
+        };
+}
+
 auto mf::XCBConnection::read_property(
     xcb_window_t window,
     xcb_atom_t prop,
@@ -354,16 +395,7 @@ auto mf::XCBConnection::read_property(
     xcb_atom_t prop,
     Handler<std::string> handler) const -> std::function<void()>
 {
-    return read_property(
-        window,
-        prop,
-        {
-            [this, on_success=move(handler.on_success)](xcb_get_property_reply_t const* reply)
-            {
-                on_success(string_from(reply));
-            },
-            move(handler.on_error)
-        });
+    return read_property(window, prop, reply_handler(prop, std::move(handler)));
 }
 
 auto mf::XCBConnection::read_property(
@@ -371,7 +403,7 @@ auto mf::XCBConnection::read_property(
     xcb_atom_t prop,
     Handler<uint32_t> handler) const -> std::function<void()>
 {
-    return read_property(window, prop, value_handler(this, prop, handler));
+    return read_property(window, prop, reply_handler(prop, std::move(handler)));
 }
 
 auto mf::XCBConnection::read_property(
@@ -379,7 +411,7 @@ auto mf::XCBConnection::read_property(
     xcb_atom_t prop,
     Handler<int32_t> handler) const -> std::function<void()>
 {
-    return read_property(window, prop, value_handler(this, prop, handler));
+    return read_property(window, prop, reply_handler(prop, std::move(handler)));
 }
 
 auto mf::XCBConnection::read_property(
@@ -387,7 +419,7 @@ auto mf::XCBConnection::read_property(
     xcb_atom_t prop,
     Handler<std::vector<uint32_t>> handler) const -> std::function<void()>
 {
-    return read_property(window, prop, vector_handler(this, prop, handler));
+    return read_property(window, prop, reply_handler(prop, std::move(handler)));
 }
 
 auto mf::XCBConnection::read_property(
@@ -395,7 +427,134 @@ auto mf::XCBConnection::read_property(
     xcb_atom_t prop,
     Handler<std::vector<int32_t>> handler) const -> std::function<void()>
 {
-    return read_property(window, prop, vector_handler(this, prop, handler));
+    return read_property(window, prop, reply_handler(prop, std::move(handler)));
+}
+
+void mf::XCBConnection::read_property_async(
+    xcb_window_t window,
+    xcb_atom_t prop,
+    Handler<xcb_get_property_reply_t*>&& handler) const
+{
+    auto complete = reply_completion(window, prop, std::move(handler));
+
+    // Taking the lock first keeps pending_replies in the order the requests were sent
+    std::lock_guard<std::mutex> lock{pending_replies_mutex};
+    xcb_get_property_cookie_t const cookie = xcb_get_property(
+        xcb_connection,
+        0, // don't delete
+        window,
+        prop,
+        XCB_ATOM_ANY,
+        0, // no offset
+        2048);
+    pending_replies.push_back({cookie.sequence, std::move(complete)});
+}
+
+void mf::XCBConnection::read_property_async(
+    xcb_window_t window,
+    xcb_atom_t prop,
+    Handler<std::string> handler) const
+{
+    read_property_async(window, prop, reply_handler(prop, std::move(handler)));
+}
+
+void mf::XCBConnection::read_property_async(
+    xcb_window_t window,
+    xcb_atom_t prop,
+    Handler<uint32_t> handler) const
+{
+    read_property_async(window, prop, reply_handler(prop, std::move(handler)));
+}
+
+void mf::XCBConnection::read_property_async(
+    xcb_window_t window,
+    xcb_atom_t prop,
+    Handler<int32_t> handler) const
+{
+    read_property_async(window, prop, reply_handler(prop, std::move(handler)));
+}
+
+void mf::XCBConnection::read_property_async(
+    xcb_window_t window,
+    xcb_atom_t prop,
+    Handler<std::vector<uint32_t>> handler) const
+{
+    read_property_async(window, prop, reply_handler(prop, std::move(handler)));
+}
+
+void mf::XCBConnection::read_property_async(
+    xcb_window_t window,
+    xcb_atom_t prop,
+    Handler<std::vector<int32_t>> handler) const
+{
+    read_property_async(window, prop, reply_handler(prop, std::move(handler)));
+}
+
+void mf::XCBConnection::dispatch_replies() const
+{
+    while (true)
+    {
+        PendingReply next;
+        void* reply{nullptr};
+        Error error;
+
+        {
+            std::lock_guard<std::mutex> lock{pending_replies_mutex};
+            // Replies arrive in the order they were requested, so if the first isn't here none of the rest are
+            if (pending_replies.empty() ||
+                !xcb_poll_for_reply(xcb_connection, pending_replies.front().sequence, &reply, &error.ptr))
+            {
+                return;
+            }
+            next = std::move(pending_replies.front());
+            pending_replies.pop_front();
+        }
+
+        // Without the lock, so the handler can make further requests
+        auto const property_reply = make_unique_cptr(static_cast<xcb_get_property_reply_t*>(reply));
+        next.complete(property_reply.get(), error.ptr);
+    }
+}
+
+auto mf::XCBConnection::reply_handler(
+    xcb_atom_t,
+    Handler<std::string> handler) const -> Handler<xcb_get_property_reply_t*>
+{
+    return {
+        [this, on_success=move(handler.on_success)](xcb_get_property_reply_t const* reply)
+        {
+            on_success(string_from(reply));
+        },
+        move(handler.on_error)
+    };
+}
+
+auto mf::XCBConnection::reply_handler(
+    xcb_atom_t prop,
+    Handler<uint32_t> handler) const -> Handler<xcb_get_property_reply_t*>
+{
+    return value_handler(this, prop, std::move(handler));
+}
+
+auto mf::XCBConnection::reply_handler(
+    xcb_atom_t prop,
+    Handler<int32_t> handler) const -> Handler<xcb_get_property_reply_t*>
+{
+    return value_handler(this, prop, std::move(handler));
+}
+
+auto mf::XCBConnection::reply_handler(
+    xcb_atom_t prop,
+    Handler<std::vector<uint32_t>> handler) const -> Handler<xcb_get_property_reply_t*>
+{
+    return vector_handler(this, prop, std::move(handler));
+}
+
+auto mf::XCBConnection::reply_handler(
+    xcb_atom_t prop,
+    Handler<std::vector<int32_t>> handler) const -> Handler<xcb_get_property_reply_t*>
+{
+    return vector_handler(this, prop, std::move(handler));
 }
 
 void mf::XCBConnection::configure_window(
@@ -32,6 +32,7 @@
 #include <functional>
 #include <mutex>
 #include <atomic>
+#include <deque>
 #include <experimental/optional>
 
 namespace mir
@@ -72,9 +73,6 @@ private:
     xcb_connection_t* const xcb_connection;
     xcb_screen_t* const xcb_screen;
 
-    std::mutex mutable atom_name_cache_mutex;
-    std::unordered_map<xcb_atom_t, std::string> mutable atom_name_cache;
-
 public:
     class Atom
     {
@@ -97,6 +95,15 @@ public:
         std::atomic<xcb_atom_t> mutable atom{XCB_ATOM_NONE};
     };
 
+private:
+    std::mutex mutable atom_name_cache_mutex;
+    std::unordered_map<xcb_atom_t, std::string> mutable atom_name_cache;
+
+    /// Every atom declared below, which registers itself on construction
+    std::vector<Atom const*> declared_atoms;
+
+public:
+
     struct Error
     {
         Error() = default;
@@ -158,6 +165,7 @@ public:
 
     /// Read a single property of various types from the window
     /// Returns a function that will wait on the reply before calling action()
+    /// \note Prefer read_property_async() on the XCB event thread, where waiting holds up every other event
     /// @{
     auto read_property(
         xcb_window_t window,
@@ -197,6 +205,59 @@ public:
         Handler<std::vector<int32_t>> handler) const -> std::function<void()>;
     /// @}
 
+    /// Read a single property of various types from the window without waiting for the reply
+    /// The handler is called by dispatch_replies() once the reply arrives. Replies are handled in the order they
+    /// were requested, so several reads can be issued together and cost a single round trip.
+    /// \note The request is only sent on the next flush()
+    /// @{
+    void read_property_async(
+        xcb_window_t window,
+        xcb_atom_t prop,
+        Handler<xcb_get_property_reply_t*>&& handler) const;
+
+    void read_property_async(
+        xcb_window_t window,
+        xcb_atom_t prop,
+        Handler<std::string> handler) const;
+
+    void read_property_async(
+        xcb_window_t window,
+        xcb_atom_t prop,
+        Handler<uint32_t> handler) const;
+
+    void read_property_async(
+        xcb_window_t window,
+        xcb_atom_t prop,
+        Handler<int32_t> handler) const;
+
+    void read_property_async(
+        xcb_window_t window,
+        xcb_atom_t prop,
+        Handler<std::vector<uint32_t>> handler) const;
+
+    void read_property_async(
+        xcb_window_t window,
+        xcb_atom_t prop,
+        Handler<std::vector<int32_t>> handler) const;
+    /// @}
+
+    /// Calls the handlers of read_property_async() replies that have arrived
+    /// Should be called on the XCB event thread each time it has read from the connection
+    void dispatch_replies() const;
+
+    /// Adapts a handler for a property's value to one for the raw reply
+    /// @{
+    auto reply_handler(xcb_atom_t prop, Handler<std::string> handler) const -> Handler<xcb_get_property_reply_t*>;
+    auto reply_handler(xcb_atom_t prop, Handler<uint32_t> handler) const -> Handler<xcb_get_property_reply_t*>;
+    auto reply_handler(xcb_atom_t prop, Handler<int32_t> handler) const -> Handler<xcb_get_property_reply_t*>;
+    auto reply_handler(
+        xcb_atom_t prop,
+        Handler<std::vector<uint32_t>> handler) const -> Handler<xcb_get_property_reply_t*>;
+    auto reply_handler(
+        xcb_atom_t prop,
+        Handler<std::vector<int32_t>> handler) const -> Handler<xcb_get_property_reply_t*>;
+    /// @}
+
     /// Set X11 window properties
     /// Safer and more fun than the C-style function provided by XCB
     /// @{
@@ -324,6 +385,24 @@ private:
 
     auto xcb_type_atom(XCBType type) const -> xcb_atom_t;
 
+    using ReplyCompletion = std::function<void(xcb_get_property_reply_t* reply, xcb_generic_error_t* error)>;
+
+    struct PendingReply
+    {
+        unsigned int sequence;
+        ReplyCompletion complete;
+    };
+
+    /// Wraps handler with the reporting of missing properties and errors
+    auto reply_completion(
+        xcb_window_t window,
+        xcb_atom_t prop,
+        Handler<xcb_get_property_reply_t*>&& handler) const -> ReplyCompletion;
+
+    std::mutex mutable pending_replies_mutex;
+    /// read_property_async() requests, in the order they were sent
+    std::deque<PendingReply> mutable pending_replies;
+
     template<XCBType type>
     static inline constexpr uint8_t xcb_type_format()
     {
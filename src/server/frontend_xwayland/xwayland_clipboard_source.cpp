@@ -25,6 +25,7 @@
 #include <xcb/xfixes.h>
 #include <string.h>
 #include <unistd.h>
+#include <functional>
 #include <map>
 #include <set>
 
@@ -129,9 +130,16 @@ public:
     /// Returns if the previous buffer was empty. If return value is true, this needs to be added to the dispatcher.
     auto add_data(std::vector<uint8_t>&& new_data) -> bool {
         std::lock_guard<std::mutex> lock{mutex};
-        if (data.empty())
+        if (failed)
+        {
+            // Nothing will be written, but keep an incremental transfer moving so the X11 client can finish it
+            request_more();
+            return false;
+        }
+        else if (written == data.size())
         {
             data = std::move(new_data);
+            written = 0;
             return true;
         }
         else
@@ -141,6 +149,20 @@ public:
         }
     }
 
+    /// Sets what to do each time the data runs out (used to ask the X11 client for the next incremental chunk)
+    void on_drained(std::function<void()>&& request_more)
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        this->request_more = std::move(request_more);
+    }
+
+    /// After this returns the drained callback will not be called again
+    void cancel()
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        request_more = []{};
+    }
+
 private:
     auto watch_fd() const -> mir::Fd override
     {
@@ -154,27 +176,39 @@ private:
         if (events & md::FdEvent::error)
         {
             mir::log_error("failed to send X11 clipboard data: fd error");
+            fail();
             return false;
         }
 
         if (events & md::FdEvent::remote_closed)
         {
             mir::log_error("failed to send X11 clipboard data: fd closed");
+            fail();
             return false;
         }
 
         if (events & md::FdEvent::writable)
         {
-            auto const len = write(destination_fd, &data[0], data.size());
+            auto const len = write(destination_fd, data.data() + written, data.size() - written);
             if (len < 0)
             {
                 mir::log_error("failed to send X11 clipboard data: %s", strerror(errno));
+                fail();
                 return false;
             }
-            data.erase(data.begin(), data.begin() + len);
+            // Rather than shuffling the unwritten data down the buffer, keep track of how far we've got
+            written += len;
+        }
+
+        if (written == data.size())
+        {
+            data.clear();
+            written = 0;
+            request_more();
+            return false;
         }
 
-        return !data.empty();
+        return true;
     }
 
     auto relevant_events() const -> md::FdEvents override
@@ -182,10 +216,21 @@ private:
         return md::FdEvent::writable;
     }
 
+    void fail()
+    {
+        failed = true;
+        data.clear();
+        written = 0;
+        request_more();
+    }
+
     mir::Fd const destination_fd;
 
     std::mutex mutex;
     std::vector<uint8_t> data;
+    size_t written{0}; ///< how much of data has already been sent
+    bool failed{false};
+    std::function<void()> request_more{[]{}};
 };
 
 mf::XWaylandClipboardSource::XWaylandClipboardSource(
@@ -216,6 +261,11 @@ mf::XWaylandClipboardSource::~XWaylandClipboardSource()
 {
     std::unique_lock<std::mutex> lock{mutex};
     auto const source_to_reset = std::move(clipboard_source);
+    if (in_progress_send)
+    {
+        // The sender can outlive us in the dispatcher, so it must stop touching our window
+        in_progress_send->cancel();
+    }
     lock.unlock();
 
     if (source_to_reset)
@@ -404,7 +454,9 @@ void mf::XWaylandClipboardSource::read_and_send_wl_selection_data(std::lock_guar
     auto const completion = connection.read_property(
         receiving_window,
         connection._WL_SELECTION,
-        true, // delete
+        // Deleting the property asks the X11 client for the next chunk of an incremental transfer, so we hold off on
+        // that until the chunk has been written out. This keeps at most one chunk in memory however slow the receiver.
+        !incremental_transfer_in_progress, // delete
         0x1fffffff, // length lifted from Weston
         {[&](xcb_get_property_reply_t* reply)
         {
@@ -415,6 +467,15 @@ void mf::XWaylandClipboardSource::read_and_send_wl_selection_data(std::lock_guar
                     log_info("Initiating incremental data transfer from X11");
                 }
                 incremental_transfer_in_progress = true;
+                if (in_progress_send)
+                {
+                    in_progress_send->on_drained(
+                        [connection = &connection, window = receiving_window]()
+                        {
+                            xcb_delete_property(*connection, window, connection->_WL_SELECTION);
+                            connection->flush();
+                        });
+                }
             }
             else
             {
@@ -462,6 +523,13 @@ void mf::XWaylandClipboardSource::add_data_to_in_progress_send(
     // Normal transfers are done after the first chunk, incremental transfers are done after a zero-size chunk
     if (!incremental_transfer_in_progress || data_size == 0)
     {
+        if (incremental_transfer_in_progress)
+        {
+            // The zero-size chunk wasn't deleted when it was read, and nothing more should be requested
+            in_progress_send->cancel();
+            xcb_delete_property(connection, receiving_window, connection._WL_SELECTION);
+        }
+
         // in_progress_send may still be sending data on it's fd, but the dispatcher will hold onto it until it's done
         in_progress_send.reset();
         incremental_transfer_in_progress = false;
@@ -23,6 +23,7 @@
 #include "xwayland_spawner.h"
 #include "xwayland_wm.h"
 #include "mir/log.h"
+#include "mir/startup_report.h"
 #include "mir/dispatch/multiplexing_dispatchable.h"
 #include "mir/dispatch/readable_fd.h"
 #include "mir/executor.h"
@@ -36,11 +37,13 @@ mf::XWaylandConnector::XWaylandConnector(
     std::shared_ptr<Executor> const& main_loop,
     std::shared_ptr<WaylandConnector> const& wayland_connector,
     std::string const& xwayland_path,
-    float scale)
+    float scale,
+    std::shared_ptr<StartupReport> const& startup_report)
     : main_loop{main_loop},
       wayland_connector{wayland_connector},
       xwayland_path{xwayland_path},
-      scale{scale}
+      scale{scale},
+      startup_report{startup_report}
 {
     if (access(xwayland_path.c_str(), F_OK | X_OK) != 0)
     {
@@ -71,6 +74,7 @@ void mf::XWaylandConnector::start()
         is_started = true;
         maybe_create_spawner(lock);
         mir::log_info("XWayland started on X11 display %s", spawner->x11_display().c_str());
+        startup_report->phase_completed(StartupReport::Phase::xwayland_socket_ready);
     }
 }
 
@@ -206,6 +210,7 @@ void mf::XWaylandConnector::spawn()
             wm_dispatcher,
             scale);
         mir::log_info("XWayland is running");
+        startup_report->phase_completed(StartupReport::Phase::xwayland_running);
     }
     catch (...)
     {
@@ -27,6 +27,7 @@
 namespace mir
 {
 class Executor;
+class StartupReport;
 namespace dispatch
 {
 class ReadableFd;
@@ -50,7 +51,8 @@ public:
         std::shared_ptr<Executor> const& main_loop,
         std::shared_ptr<WaylandConnector> const& wayland_connector,
         std::string const& xwayland_path,
-        float scale);
+        float scale,
+        std::shared_ptr<StartupReport> const& startup_report);
     ~XWaylandConnector();
 
     void start() override;
@@ -67,6 +69,7 @@ private:
     std::shared_ptr<WaylandConnector> const wayland_connector;
     std::string const xwayland_path;
     float const scale;
+    std::shared_ptr<StartupReport> const startup_report;
 
     /// Creates the spawner if it doesn't already exist and is_started is true, given lock must be locked
     void maybe_create_spawner(std::unique_lock<std::mutex> const& lock);
@@ -79,7 +79,8 @@ std::shared_ptr<mf::Connector> mir::DefaultServerConfiguration::the_xwayland_con
                     the_main_loop(),
                     wayland_connector,
                     options->get<std::string>("xwayland-path"),
-                    scale);
+                    scale,
+                    the_startup_report());
             }
             catch (std::exception& x)
             {
@@ -163,29 +163,34 @@ auto wm_resize_edge_to_mir_resize_edge(NetWmMoveresize wm_resize_edge) -> std::e
 template<typename T>
 auto property_handler(
     std::shared_ptr<mf::XCBConnection> const& connection,
-    xcb_window_t window,
     xcb_atom_t property,
-    mf::XCBConnection::Handler<T>&& handler) -> std::pair<xcb_atom_t, std::function<std::function<void()>()>>
+    mf::XCBConnection::Handler<T>&& handler)
+    -> std::pair<xcb_atom_t, std::function<mf::XCBConnection::Handler<xcb_get_property_reply_t*>()>>
 {
     return std::make_pair(
         property,
-        [connection, window, property, handler = std::move(handler)]()
+        [connection, property, handler = std::move(handler)]()
         {
-            return connection->read_property(window, property, std::move(handler));
+            return connection->reply_handler(property, handler);
         });
 }
 
 template<typename T>
 auto property_handler(
     std::shared_ptr<mf::XCBConnection> const& connection,
-    xcb_window_t window,
     xcb_atom_t property,
-    std::function<void(T const&)> handler) -> std::pair<xcb_atom_t, std::function<std::function<void()>()>>
+    std::function<void(T const&)> handler)
+    -> std::pair<xcb_atom_t, std::function<mf::XCBConnection::Handler<xcb_get_property_reply_t*>()>>
 {
-    return property_handler<T>(connection, window, property, mf::XCBConnection::Handler<T>{std::move(handler)});
+    return property_handler<T>(connection, property, mf::XCBConnection::Handler<T>{std::move(handler)});
 }
 }
 
+namespace
+{
+mir::MemoryAccount xwayland_surfaces{"xwayland", "surfaces"};
+}
+
 mf::XWaylandSurface::XWaylandSurface(
     XWaylandWM *wm,
     std::shared_ptr<XCBConnection> const& connection,
@@ -205,7 +210,6 @@ mf::XWaylandSurface::XWaylandSurface(
       property_handlers{
           property_handler<std::string>(
               connection,
-              window,
               XCB_ATOM_WM_CLASS,
               [this](auto value)
               {
@@ -214,7 +218,6 @@ mf::XWaylandSurface::XWaylandSurface(
               }),
           property_handler<std::string>(
               connection,
-              window,
               XCB_ATOM_WM_NAME,
               [this](auto value)
               {
@@ -223,7 +226,6 @@ mf::XWaylandSurface::XWaylandSurface(
               }),
           property_handler<std::string>(
               connection,
-              window,
               connection->_NET_WM_NAME,
               [this](auto value)
               {
@@ -232,7 +234,6 @@ mf::XWaylandSurface::XWaylandSurface(
               }),
           property_handler<xcb_window_t>(
               connection,
-              window,
               XCB_ATOM_WM_TRANSIENT_FOR,
               {
                   [this](xcb_window_t const& value)
@@ -246,7 +247,6 @@ mf::XWaylandSurface::XWaylandSurface(
               }),
           property_handler<std::vector<xcb_atom_t>>(
               connection,
-              window,
               connection->_NET_WM_WINDOW_TYPE,
               [this](auto wm_types)
               {
@@ -254,7 +254,6 @@ mf::XWaylandSurface::XWaylandSurface(
               }),
           property_handler<std::vector<int32_t>>(
               connection,
-              window,
               connection->WM_NORMAL_HINTS,
               [this](auto hints)
               {
@@ -262,7 +261,6 @@ mf::XWaylandSurface::XWaylandSurface(
               }),
           property_handler<std::vector<xcb_atom_t>>(
               connection,
-              window,
               connection->WM_PROTOCOLS,
               {
                   [this](auto value)
@@ -278,12 +276,12 @@ mf::XWaylandSurface::XWaylandSurface(
               }),
           property_handler<std::vector<uint32_t>>(
               connection,
-              window,
               connection->_MOTIF_WM_HINTS,
               [this](auto hints)
               {
                   motif_wm_hints(hints);
-              })}
+              })},
+      charge{xwayland_surfaces, sizeof(XWaylandSurface)}
 {
     cached.top_left = geometry.top_left;
     cached.size = geometry.size;
@@ -300,30 +298,45 @@ mf::XWaylandSurface::~XWaylandSurface()
 
 void mf::XWaylandSurface::map()
 {
-    WindowState state;
-    {
-        std::lock_guard<std::mutex> lock{mutex};
-        state = cached.state;
-    }
-
     // _NET_WM_STATE is not in property_handlers because we only read it on window creation
     // We, the server (not the client) are responsible for updating it after the window has been mapped
     // The client should use a client message to change state later
-    auto const cookie = connection->read_property(
+    connection->read_property_async(
         window,
         connection->_NET_WM_STATE,
-        {
-            [&](std::vector<xcb_atom_t> const& net_wm_states)
+        XCBConnection::Handler<std::vector<xcb_atom_t>>{
+            [weak_self = weak_from_this()](std::vector<xcb_atom_t> const& net_wm_states)
+            {
+                if (auto const self = weak_self.lock())
+                {
+                    self->complete_map(net_wm_states);
+                }
+            },
+            [weak_self = weak_from_this()](std::string const& message)
             {
-                for (auto const& net_wm_state : net_wm_states)
+                log_error("XCB error: %s", message.c_str());
+                if (auto const self = weak_self.lock())
                 {
-                    state.apply_change(connection, NetWmStateAction::ADD, net_wm_state);
+                    self->complete_map({});
                 }
             }
         });
 
-    // If we had more properties to read we would queue them all up before completing the first one
-    cookie();
+    connection->flush();
+}
+
+void mf::XWaylandSurface::complete_map(std::vector<xcb_atom_t> const& net_wm_states)
+{
+    WindowState state;
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        state = cached.state;
+    }
+
+    for (auto const& net_wm_state : net_wm_states)
+    {
+        state.apply_change(connection, NetWmStateAction::ADD, net_wm_state);
+    }
 
     uint32_t const workspace = 1;
     connection->set_property<XCBType::CARDINAL32>(
@@ -585,10 +598,31 @@ void mf::XWaylandSurface::property_notify(xcb_atom_t property)
     auto const handler = property_handlers.find(property);
     if (handler != property_handlers.end())
     {
-        auto completion = handler->second();
-        completion();
-
-        apply_any_mods_to_scene_surface();
+        // The handlers capture this, so only run them if we're still alive when the reply arrives
+        auto reply_handler = handler->second();
+        connection->read_property_async(
+            window,
+            property,
+            XCBConnection::Handler<xcb_get_property_reply_t*>{
+                [weak_self = weak_from_this(), on_success = std::move(reply_handler.on_success)](
+                    xcb_get_property_reply_t* const& reply)
+                {
+                    if (auto const self = weak_self.lock())
+                    {
+                        on_success(reply);
+                        self->apply_any_mods_to_scene_surface();
+                    }
+                },
+                [weak_self = weak_from_this(), on_error = std::move(reply_handler.on_error)](
+                    std::string const& message)
+                {
+                    if (auto const self = weak_self.lock())
+                    {
+                        on_error(message);
+                        self->apply_any_mods_to_scene_surface();
+                    }
+                }
+            });
     }
 }
 
@@ -640,7 +674,7 @@ void mf::XWaylandSurface::attach_wl_surface(WlSurface* wl_surface)
     // Read all properties
     for (auto const& handler : property_handlers)
     {
-        reply_functions.push_back(handler.second());
+        reply_functions.push_back(connection->read_property(window, handler.first, handler.second()));
     }
 
     std::shared_ptr<XWaylandClientManager::Session> local_client_session;
@@ -699,6 +733,7 @@ void mf::XWaylandSurface::attach_wl_surface(WlSurface* wl_surface)
         scaled_content_size_of(*surface),
         std::experimental::nullopt,
         XCB_STACK_MODE_ABOVE);
+    xwm->window_restacked(window);
 
     {
         std::lock_guard<std::mutex> lock{mutex};
@@ -854,6 +889,7 @@ void mf::XWaylandSurface::scene_surface_state_set(MirWindowState new_state)
             std::experimental::nullopt,
             std::experimental::nullopt,
             XCB_STACK_MODE_BELOW);
+        xwm->window_restacked(window);
     }
 }
 
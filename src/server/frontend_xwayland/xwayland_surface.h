@@ -24,9 +24,11 @@
 #include "xwayland_client_manager.h"
 #include "xwayland_surface_role_surface.h"
 #include "xwayland_surface_observer_surface.h"
+#include "mir/memory_account.h"
 
 #include <xcb/xcb.h>
 
+#include <memory>
 #include <mutex>
 #include <chrono>
 #include <set>
@@ -46,7 +48,8 @@ class XWaylandSurfaceObserver;
 
 class XWaylandSurface
     : public XWaylandSurfaceRoleSurface,
-      public XWaylandSurfaceObserverSurface
+      public XWaylandSurfaceObserverSurface,
+      public std::enable_shared_from_this<XWaylandSurface>
 {
 public:
     XWaylandSurface(
@@ -126,6 +129,9 @@ private:
     /// Updates the pending spec
     void is_transient_for(xcb_window_t transient_for);
 
+    /// Finishes map() once the client's initial _NET_WM_STATE has been read
+    void complete_map(std::vector<xcb_atom_t> const& net_wm_states);
+
     /// Updates the window's WM_STATE and _NET_WM_STATE properties
     /// Should NOT be called under lock
     void inform_client_of_window_state(WindowState const& state);
@@ -174,7 +180,8 @@ private:
     std::shared_ptr<XWaylandClientManager> const client_manager;
     xcb_window_t const window;
     float const scale;
-    std::map<xcb_window_t, std::function<std::function<void()>()>> const property_handlers;
+    /// Creates a handler for each property we track, to be given to XCBConnection::read_property[_async]()
+    std::map<xcb_atom_t, std::function<XCBConnection::Handler<xcb_get_property_reply_t*>()>> const property_handlers;
 
     std::mutex mutable mutex;
 
@@ -202,6 +209,8 @@ private:
     std::unique_ptr<shell::SurfaceSpecification> nullable_pending_spec;
     std::shared_ptr<XWaylandClientManager::Session> client_session;
     std::weak_ptr<scene::Surface> weak_scene_surface;
+
+    MemoryCharge const charge;
 };
 } /* frontend */
 } /* mir */
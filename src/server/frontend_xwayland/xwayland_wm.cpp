@@ -27,6 +27,7 @@
 #include "xwayland_client_manager.h"
 #include "xwayland_clipboard_source.h"
 #include "xwayland_clipboard_provider.h"
+#include "restack_order.h"
 
 #include "mir/c_memory.h"
 #include "mir/fd.h"
@@ -34,6 +35,7 @@
 #include "mir/frontend/surface_stack.h"
 #include "mir/scene/null_observer.h"
 
+#include <algorithm>
 #include <cstring>
 #include <poll.h>
 #include <sys/socket.h>
@@ -269,8 +271,6 @@ mf::XWaylandWM::~XWaylandWM()
 
 void mf::XWaylandWM::handle_events()
 {
-    bool got_events = false;
-
     connection->verify_not_in_error_state();
 
     while (xcb_generic_event_t* const event = xcb_poll_for_event(*connection))
@@ -288,13 +288,13 @@ void mf::XWaylandWM::handle_events()
                 "Error processing XCB event");
         }
         free(event);
-        got_events = true;
     }
 
-    if (got_events)
-    {
-        connection->flush();
-    }
+    // Reading events may also have read the replies to read_property_async() requests
+    connection->dispatch_replies();
+
+    // Handlers (of events or replies) may have made requests
+    connection->flush();
 }
 
 auto mf::XWaylandWM::get_wm_surface(
@@ -382,6 +382,12 @@ void mf::XWaylandWM::forget_scene_surface(std::weak_ptr<scene::Surface> const& s
     scene_surface_set.erase(scene_surface);
 }
 
+void mf::XWaylandWM::window_restacked(xcb_window_t window)
+{
+    std::lock_guard<std::mutex> lock{restack_mutex};
+    stacked_windows.erase(std::remove(stacked_windows.begin(), stacked_windows.end(), window), stacked_windows.end());
+}
+
 void mf::XWaylandWM::surfaces_reordered(scene::SurfaceSet const& affected_surfaces)
 {
     bool our_surfaces_affected = false;
@@ -421,29 +427,55 @@ void mf::XWaylandWM::restack_surfaces()
         }
     }
 
-    xcb_window_t window_below = 0;
-    for (auto const& window : new_order)
+    std::lock_guard<std::mutex> restack_lock{restack_mutex};
+
+    // Only restack the windows that are out of order. Those that are still in the same order relative to each
+    // other (the longest run that is) can stay where they are, and everything else moves next to them.
+    auto const stays = windows_that_keep_their_order(stacked_windows, new_order);
+    size_t first_kept = std::find(stays.begin(), stays.end(), true) - stays.begin();
+    if (first_kept == new_order.size())
     {
-        if (window_below)
+        // None of the windows have a known position, so stack them all on the bottom one
+        first_kept = 0;
+    }
+
+    auto const restack = [&](size_t i, size_t sibling_index, uint32_t stack_mode)
         {
+            auto const window = new_order[i];
+            auto const sibling = new_order[sibling_index];
+
             if (verbose_xwayland_logging_enabled())
             {
                 log_debug(
-                    "Stacking %s on top of %s",
+                    "Stacking %s %s %s",
                     connection->window_debug_string(window).c_str(),
-                    connection->window_debug_string(window_below).c_str());
+                    stack_mode == XCB_STACK_MODE_ABOVE ? "on top of" : "below",
+                    connection->window_debug_string(sibling).c_str());
             }
 
             connection->configure_window(
                 window,
                 std::experimental::nullopt,
                 std::experimental::nullopt,
-                window_below,
-                XCB_STACK_MODE_ABOVE);
+                sibling,
+                stack_mode);
+        };
+
+    // Windows below the lowest one that stays are stacked downwards from it, the rest upwards
+    for (auto i = first_kept; i > 0; i--)
+    {
+        restack(i - 1, i, XCB_STACK_MODE_BELOW);
+    }
+    for (auto i = first_kept + 1; i < new_order.size(); i++)
+    {
+        if (!stays[i])
+        {
+            restack(i, i - 1, XCB_STACK_MODE_ABOVE);
         }
-        window_below = window;
     }
 
+    stacked_windows = std::move(new_order);
+
     connection->flush();
 }
 
@@ -455,8 +487,8 @@ void mf::XWaylandWM::manage_window(xcb_window_t window, geom::Rectangle const& g
         auto const props_reply = xcb_list_properties_reply(*connection, props_cookie, nullptr);
         if (props_reply)
         {
-            std::vector<std::function<void()>> functions;
             int const prop_count = xcb_list_properties_atoms_length(props_reply);
+            log_debug("%s has %d initial propertie(s):", connection->window_debug_string(window).c_str(), prop_count);
             for (int i = 0; i < prop_count; i++)
             {
                 auto const atom = xcb_list_properties_atoms(props_reply)[i];
@@ -470,11 +502,11 @@ void mf::XWaylandWM::manage_window(xcb_window_t window, geom::Rectangle const& g
                             value.c_str());
                     };
 
-                functions.push_back(connection->read_property(
+                connection->read_property_async(
                     window,
                     atom,
-                    {
-                        [this, log_prop](xcb_get_property_reply_t* reply)
+                    XCBConnection::Handler<xcb_get_property_reply_t*>{
+                        [this, log_prop](xcb_get_property_reply_t* const& reply)
                         {
                             auto const reply_str = connection->reply_debug_string(reply);
                             log_prop(reply_str);
@@ -483,13 +515,9 @@ void mf::XWaylandWM::manage_window(xcb_window_t window, geom::Rectangle const& g
                         {
                             log_prop("error getting value: " + message);
                         }
-                    }));
+                    });
             }
             free(props_reply);
-
-            log_debug("%s has %d initial propertie(s):", connection->window_debug_string(window).c_str(), prop_count);
-            for (auto const& f : functions)
-                f();
         }
         else
         {
@@ -629,21 +657,22 @@ void mf::XWaylandWM::handle_property_notify(xcb_property_notify_event_t *event)
         }
         else
         {
-            auto const log_prop = [this, event](std::string const& value)
+            // The event is gone by the time the reply arrives, so capture what we need from it
+            auto const log_prop = [this, window = event->window, atom = event->atom](std::string const& value)
                 {
-                    auto const prop_name = connection->query_name(event->atom);
+                    auto const prop_name = connection->query_name(atom);
                     log_debug(
                         "XCB_PROPERTY_NOTIFY (%s).%s: %s",
-                        connection->window_debug_string(event->window).c_str(),
+                        connection->window_debug_string(window).c_str(),
                         prop_name.c_str(),
                         value.c_str());
                 };
 
-            auto const reply_function = connection->read_property(
+            connection->read_property_async(
                 event->window,
                 event->atom,
-                {
-                    [this, log_prop](xcb_get_property_reply_t* reply)
+                XCBConnection::Handler<xcb_get_property_reply_t*>{
+                    [this, log_prop](xcb_get_property_reply_t* const& reply)
                     {
                         auto const reply_str = connection->reply_debug_string(reply);
                         log_prop(reply_str);
@@ -653,8 +682,6 @@ void mf::XWaylandWM::handle_property_notify(xcb_property_notify_event_t *event)
                         log_prop("error getting value: " + message);
                     }
                 });
-
-            reply_function();
         }
     }
 
@@ -27,6 +27,7 @@
 #include <map>
 #include <set>
 #include <thread>
+#include <vector>
 #include <experimental/optional>
 #include <mutex>
 
@@ -78,6 +79,9 @@ public:
     void set_focus(xcb_window_t xcb_window, bool should_be_focused);
     void remember_scene_surface(std::weak_ptr<scene::Surface> const& scene_surface, xcb_window_t window);
     void forget_scene_surface(std::weak_ptr<scene::Surface> const& scene_surface);
+    /// Should be called when a window is stacked by anything other than restack_surfaces(), so the next restack
+    /// doesn't assume it's where we last put it
+    void window_restacked(xcb_window_t window);
 
     void surfaces_reordered(scene::SurfaceSet const& affected_surfaces);
 
@@ -131,6 +135,11 @@ private:
     /// Could be regenerated from scene_surfaces at any time, but more efficient to keep this up to date
     std::set<std::weak_ptr<scene::Surface>, std::owner_less<std::weak_ptr<scene::Surface>>> scene_surface_set;
     std::experimental::optional<xcb_window_t> focused_window;
+
+    /// Held while restacking, so stacked_windows matches what has been sent to the X server
+    std::mutex restack_mutex;
+    /// The windows of scene surfaces, bottom to top, as restack_surfaces() last left them
+    std::vector<xcb_window_t> stacked_windows;
 };
 } /* frontend */
 } /* mir */
@@ -37,10 +37,12 @@ public:
     AlarmImpl(
         GMainContext* main_context,
         std::shared_ptr<mir::time::Clock> const& clock,
+        std::chrono::milliseconds slack,
         std::unique_ptr<mir::LockableCallback>&& callback,
         std::function<void()> const& exception_handler)
         : main_context{g_main_context_ref(main_context)},
           clock{clock},
+          slack{slack},
           state_{State::cancelled},
           exception_handler{exception_handler},
           wrapped_callback{std::make_shared<mir::LockableCallbackWrapper>(
@@ -89,7 +91,8 @@ public:
             clock,
             wrapped_callback,
             exception_handler,
-            time_point);
+            time_point,
+            slack);
 
         return old_state == State::pending;
     }
@@ -98,6 +101,7 @@ private:
     mutable std::mutex alarm_mutex;
     GMainContext* main_context;
     std::shared_ptr<mir::time::Clock> const clock;
+    std::chrono::milliseconds const slack;
     State state_;
     std::function<void()> exception_handler;
     std::shared_ptr<mir::LockableCallback> wrapped_callback;
@@ -126,11 +130,14 @@ mir::detail::GMainContextHandle::operator GMainContext*() const
 
 
 mir::GLibMainLoop::GLibMainLoop(
-    std::shared_ptr<time::Clock> const& clock)
+    std::shared_ptr<time::Clock> const& clock,
+    std::chrono::milliseconds timer_slack)
     : clock{clock},
+      timer_slack{timer_slack},
       running_{false},
       fd_sources{main_context},
-      signal_sources{fd_sources},
+      signal_sources{*this},
+      server_actions{main_context},
       before_iteration_hook{[]{}}
 {
 }
@@ -256,12 +263,7 @@ void mir::GLibMainLoop::enqueue(void const* owner, ServerAction const& action)
             catch (...) { handle_exception(std::current_exception()); }
         };
 
-    detail::add_server_action_gsource(main_context, owner,
-        action_with_exception_handling,
-        [this] (void const* owner)
-        {
-            return should_process_actions_for(owner);
-        });
+    server_actions.enqueue(owner, action_with_exception_handling);
 }
 
 
@@ -275,6 +277,9 @@ void mir::GLibMainLoop::enqueue_with_guaranteed_execution(mir::ServerAction cons
                 mir::ServerAction action;
                 {
                     std::lock_guard<std::mutex> lock{run_on_halt_mutex};
+                    // stop() runs (and clears) anything still queued
+                    if (run_on_halt_queue.empty())
+                        return;
                     action = run_on_halt_queue.front();
                     run_on_halt_queue.pop_front();
                 }
@@ -301,38 +306,17 @@ void mir::GLibMainLoop::enqueue_with_guaranteed_execution(mir::ServerAction cons
         }
     }
 
-    detail::add_idle_gsource(
-        main_context,
-        G_PRIORITY_DEFAULT,
-        action_with_exception_handling);
+    server_actions.enqueue_unconditionally(action_with_exception_handling);
 }
 
 void mir::GLibMainLoop::pause_processing_for(void const* owner)
 {
-    std::lock_guard<std::mutex> lock{do_not_process_mutex};
-
-    auto const iter = std::find(do_not_process.begin(), do_not_process.end(), owner);
-    if (iter == do_not_process.end())
-        do_not_process.push_back(owner);
+    server_actions.pause(owner);
 }
 
 void mir::GLibMainLoop::resume_processing_for(void const* owner)
 {
-    std::lock_guard<std::mutex> lock{do_not_process_mutex};
-
-    auto const new_end = std::remove(do_not_process.begin(), do_not_process.end(), owner);
-    do_not_process.erase(new_end, do_not_process.end());
-
-    // Wake up the context to reprocess all sources
-    g_main_context_wakeup(main_context);
-}
-
-bool mir::GLibMainLoop::should_process_actions_for(void const* owner)
-{
-    std::lock_guard<std::mutex> lock{do_not_process_mutex};
-
-    auto const iter = std::find(do_not_process.begin(), do_not_process.end(), owner);
-    return iter == do_not_process.end();
+    server_actions.resume(owner);
 }
 
 std::unique_ptr<mir::time::Alarm> mir::GLibMainLoop::create_alarm(
@@ -351,7 +335,7 @@ std::unique_ptr<mir::time::Alarm> mir::GLibMainLoop::create_alarm(
         };
 
     return std::make_unique<AlarmImpl>(
-        main_context, clock, std::move(callback), exception_hander);
+        main_context, clock, timer_slack, std::move(callback), exception_hander);
 }
 
 void mir::GLibMainLoop::reprocess_all_sources()
@@ -460,9 +444,5 @@ void mir::GLibMainLoop::spawn(std::function<void()>&& work)
             catch (...) { handle_exception(std::current_exception()); }
         };
 
-    detail::add_server_action_gsource(
-        main_context,
-        nullptr,
-        action_with_exception_handling,
-        [](auto) { return true; });
+    server_actions.enqueue_unconditionally(action_with_exception_handling);
 }
@@ -20,19 +20,13 @@
 #include "mir/glib_main_loop_sources.h"
 #include "mir/lockable_callback.h"
 #include "mir/raii.h"
-#include <mir/log.h>
 
 #include <algorithm>
 #include <atomic>
-#include <system_error>
-#include <sstream>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
 
-#include <csignal>
-#include <cstring>
-#include <unistd.h>
-#include <fcntl.h>
-
-#include <boost/throw_exception.hpp>
 #include <glib-unix.h>
 
 namespace md = mir::detail;
@@ -40,6 +34,25 @@ namespace md = mir::detail;
 namespace
 {
 
+auto coalesced_wake_time(
+    mir::time::Timestamp now,
+    mir::time::Timestamp target_time,
+    std::chrono::milliseconds slack) -> mir::time::Timestamp
+{
+    if (slack <= std::chrono::milliseconds::zero())
+        return target_time;
+
+    mir::time::Duration const window{slack};
+    auto const since_epoch = target_time.time_since_epoch();
+    mir::time::Timestamp const window_end{((since_epoch + window - mir::time::Duration{1}) / window) * window};
+
+    // Don't make a short timer (such as key repeat) proportionally late
+    if (window_end - target_time > (target_time - now) / 4)
+        return target_time;
+
+    return window_end;
+}
+
 class GSourceRef
 {
 public:
@@ -180,61 +193,160 @@ void md::add_idle_gsource(
     g_source_attach(gsource, main_context);
 }
 
-void md::add_server_action_gsource(
-    GMainContext* main_context,
-    void const* owner,
-    std::function<void()> const& action,
-    std::function<bool(void const*)> const& should_dispatch)
+namespace
 {
-    struct ServerActionContext
+struct ServerActionContext
+{
+    struct Action
     {
-        void const* const owner;
-        std::function<void(void)> const action;
-        std::function<bool(void const*)> const should_dispatch;
-
-        // If we come to finalize() before dispatch() we have already
-        // torn down most of Mir and even unloaded some shared libraries.
-        // That means the action could refer to  stuff that is no longer
-        // in the address space.
-        // We will just leak any resources instead of crashing.
-        bool mutable dispatched{false};
+        void const* owner;
+        bool conditional;
+        std::function<void()> action;
     };
 
-    struct ServerActionGSource
+    explicit ServerActionContext(GMainContext* main_context)
+        : main_context{main_context}
     {
-        GSource gsource;
-        ServerActionContext ctx;
-        bool ctx_constructed;
+    }
 
-        static gboolean prepare(GSource* source, gint *timeout)
-        {
-            *timeout = -1;
-            auto const& ctx = reinterpret_cast<ServerActionGSource*>(source)->ctx;
-            return ctx.should_dispatch(ctx.owner);
-        }
+    GMainContext* const main_context;
 
-        static gboolean check(GSource* source)
+    std::mutex mutex;
+    std::deque<Action> actions;
+    /// How many conditional actions each owner has queued
+    std::unordered_map<void const*, size_t> queued_for;
+    std::unordered_set<void const*> paused;
+    /// How many of actions are ready to dispatch, kept as they are queued, dispatched, paused and resumed
+    size_t ready_count{0};
+    bool enabled{true};
+
+    /// Set when the context has been woken for newly queued actions and not yet prepared
+    std::atomic<bool> woken{false};
+
+    auto ready(Action const& action) const -> bool
+    {
+        return !action.conditional || paused.find(action.owner) == paused.end();
+    }
+
+    auto any_ready() -> bool
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        return enabled && ready_count;
+    }
+
+    void queued(Action const& action)
+    {
+        if (action.conditional)
+            ++queued_for[action.owner];
+        if (ready(action))
+            ++ready_count;
+    }
+
+    void dequeued(Action const& action)
+    {
+        if (action.conditional)
         {
-            auto const& ctx = reinterpret_cast<ServerActionGSource*>(source)->ctx;
-            return ctx.should_dispatch(ctx.owner);
+            auto const count = queued_for.find(action.owner);
+            if (--count->second == 0)
+                queued_for.erase(count);
         }
+        --ready_count;
+    }
 
-        static gboolean dispatch(GSource* source, GSourceFunc, gpointer)
+    auto queued_count_for(void const* owner) const -> size_t
+    {
+        auto const count = queued_for.find(owner);
+        return count == queued_for.end() ? 0 : count->second;
+    }
+};
+
+struct ServerActionGSource
+{
+    GSource gsource;
+    ServerActionContext ctx;
+    bool ctx_constructed;
+
+    static auto ctx_of(GSource* source) -> ServerActionContext&
+    {
+        return reinterpret_cast<ServerActionGSource*>(source)->ctx;
+    }
+
+    static gboolean prepare(GSource* source, gint *timeout)
+    {
+        *timeout = -1;
+        auto& ctx = ctx_of(source);
+        // Clear this first, so that an action queued after we look will wake the context
+        ctx.woken = false;
+        return ctx.any_ready();
+    }
+
+    static gboolean check(GSource* source)
+    {
+        return ctx_of(source).any_ready();
+    }
+
+    static gboolean dispatch(GSource* source, GSourceFunc, gpointer)
+    {
+        auto& ctx = ctx_of(source);
+
+        // Take everything that's ready now: actions queued by these are left for the next dispatch
+        std::vector<std::function<void()>> batch;
         {
-            auto const& ctx = reinterpret_cast<ServerActionGSource*>(source)->ctx;
-            ctx.action();
-            ctx.dispatched = true;
-            return FALSE;
+            std::lock_guard<std::mutex> lock{ctx.mutex};
+            if (!ctx.enabled)
+                return G_SOURCE_CONTINUE;
+
+            auto held_back = ctx.actions.begin();
+            for (auto& action : ctx.actions)
+            {
+                if (ctx.ready(action))
+                {
+                    ctx.dequeued(action);
+                    batch.push_back(std::move(action.action));
+                }
+                else
+                {
+                    if (&*held_back != &action)
+                        *held_back = std::move(action);
+                    ++held_back;
+                }
+            }
+            ctx.actions.erase(held_back, ctx.actions.end());
         }
 
-        static void finalize(GSource* source)
+        for (auto const& action : batch)
+            action();
+
+        return G_SOURCE_CONTINUE;
+    }
+
+    static void finalize(GSource* source)
+    {
+        auto const sa_gsource = reinterpret_cast<ServerActionGSource*>(source);
+        if (sa_gsource->ctx_constructed)
         {
-            auto const sa_gsource = reinterpret_cast<ServerActionGSource*>(source);
-            if (sa_gsource->ctx_constructed && sa_gsource->ctx.dispatched)
-                sa_gsource->ctx.~ServerActionContext();
+            // If we come to finalize() with actions still queued we have already
+            // torn down most of Mir and even unloaded some shared libraries.
+            // That means the actions could refer to stuff that is no longer
+            // in the address space.
+            // We will just leak them instead of crashing.
+            if (!sa_gsource->ctx.actions.empty())
+                new std::deque<ServerActionContext::Action>{std::move(sa_gsource->ctx.actions)};
+
+            sa_gsource->ctx.~ServerActionContext();
         }
-    };
+    }
+
+    static void disable(GSource* source)
+    {
+        auto& ctx = ctx_of(source);
+        std::lock_guard<std::mutex> lock{ctx.mutex};
+        ctx.enabled = false;
+    }
+};
 
+auto create_server_action_gsource(GMainContext* main_context) -> md::GSourceHandle
+{
     static GSourceFuncs gsource_funcs{
         ServerActionGSource::prepare,
         ServerActionGSource::check,
@@ -244,14 +356,76 @@ void md::add_server_action_gsource(
         nullptr
     };
 
-    GSourceRef gsource{g_source_new(&gsource_funcs, sizeof(ServerActionGSource))};
+    md::GSourceHandle gsource{
+        g_source_new(&gsource_funcs, sizeof(ServerActionGSource)),
+        [](GSource* gsource) { ServerActionGSource::disable(gsource); }};
     auto const sa_gsource = reinterpret_cast<ServerActionGSource*>(static_cast<GSource*>(gsource));
 
     sa_gsource->ctx_constructed = false;
-    new (&sa_gsource->ctx) decltype(sa_gsource->ctx){owner, action, should_dispatch};
+    new (&sa_gsource->ctx) ServerActionContext{main_context};
     sa_gsource->ctx_constructed = true;
 
     g_source_attach(gsource, main_context);
+
+    return gsource;
+}
+}
+
+md::ServerActionQueue::ServerActionQueue(GMainContext* main_context)
+    : gsource{create_server_action_gsource(main_context)}
+{
+}
+
+md::ServerActionQueue::~ServerActionQueue()
+{
+    gsource.ensure_no_further_dispatch();
+}
+
+void md::ServerActionQueue::enqueue(void const* owner, std::function<void()> const& action)
+{
+    enqueue(owner, true, action);
+}
+
+void md::ServerActionQueue::enqueue_unconditionally(std::function<void()> const& action)
+{
+    enqueue(nullptr, false, action);
+}
+
+void md::ServerActionQueue::enqueue(void const* owner, bool conditional, std::function<void()> const& action)
+{
+    auto& ctx = ServerActionGSource::ctx_of(gsource);
+
+    {
+        std::lock_guard<std::mutex> lock{ctx.mutex};
+        ctx.actions.push_back({owner, conditional, action});
+        ctx.queued(ctx.actions.back());
+    }
+
+    if (!ctx.woken.exchange(true))
+        g_main_context_wakeup(ctx.main_context);
+}
+
+void md::ServerActionQueue::pause(void const* owner)
+{
+    auto& ctx = ServerActionGSource::ctx_of(gsource);
+
+    std::lock_guard<std::mutex> lock{ctx.mutex};
+    if (ctx.paused.insert(owner).second)
+        ctx.ready_count -= ctx.queued_count_for(owner);
+}
+
+void md::ServerActionQueue::resume(void const* owner)
+{
+    auto& ctx = ServerActionGSource::ctx_of(gsource);
+
+    {
+        std::lock_guard<std::mutex> lock{ctx.mutex};
+        if (ctx.paused.erase(owner))
+            ctx.ready_count += ctx.queued_count_for(owner);
+    }
+
+    // Wake up the context to reprocess all sources
+    g_main_context_wakeup(ctx.main_context);
 }
 
 md::GSourceHandle md::add_timer_gsource(
@@ -259,22 +433,25 @@ md::GSourceHandle md::add_timer_gsource(
     std::shared_ptr<time::Clock> const& clock,
     std::shared_ptr<LockableCallback> const& handler,
     std::function<void()> const& exception_handler,
-    time::Timestamp target_time)
+    time::Timestamp target_time,
+    std::chrono::milliseconds slack)
 {
     struct TimerContext
     {
         TimerContext(std::shared_ptr<time::Clock> const& clock,
                      std::shared_ptr<LockableCallback> const& handler,
                      std::function<void()> const& exception_handler,
-                     time::Timestamp target_time)
+                     time::Timestamp target_time,
+                     time::Timestamp wake_time)
             : clock{clock}, handler{handler}, exception_handler{exception_handler},
-              target_time{target_time}, enabled{true}
+              target_time{target_time}, wake_time{wake_time}, enabled{true}
         {
         }
         std::shared_ptr<time::Clock> clock;
         std::shared_ptr<LockableCallback> handler;
         std::function<void()> exception_handler;
         time::Timestamp target_time;
+        time::Timestamp wake_time;
         std::recursive_mutex mutex;
         bool enabled;
     };
@@ -295,7 +472,7 @@ md::GSourceHandle md::add_timer_gsource(
                 *timeout = -1;
             else
                 *timeout = std::chrono::duration_cast<std::chrono::milliseconds>(
-                    ctx.clock->min_wait_until(ctx.target_time)).count();
+                    ctx.clock->min_wait_until(ctx.wake_time)).count();
 
             return ready;
         }
@@ -360,7 +537,8 @@ md::GSourceHandle md::add_timer_gsource(
     auto const timer_gsource = reinterpret_cast<TimerGSource*>(static_cast<GSource*>(gsource));
 
     timer_gsource->ctx_constructed = false;
-    new (&timer_gsource->ctx) TimerContext{clock, handler, exception_handler, target_time};
+    auto const wake_time = coalesced_wake_time(clock->now(), target_time, slack);
+    new (&timer_gsource->ctx) TimerContext{clock, handler, exception_handler, target_time, wake_time};
     timer_gsource->ctx_constructed = true;
 
     g_source_attach(gsource, main_context);
@@ -463,192 +641,3 @@ void md::FdSources::remove_all_owned_by(void const* owner)
 
     sources.erase(new_end, sources.end());
 }
-
-/*****************
- * SignalSources *
- *****************/
-
-class md::SignalSources::SourceRegistration
-{
-public:
-    SourceRegistration(int write_fd)
-        : write_fd{write_fd}
-    {
-        init_write_fds();
-        add_write_fd();
-    }
-
-    ~SourceRegistration()
-    {
-        remove_write_fd();
-    }
-
-    static void notify_sources_of_signal(int sig, siginfo_t* info, void*)
-    {
-        SignalPid const sigpid{sig, info->si_pid};
-
-        for (auto const& write_fd : write_fds)
-        {
-            // There is a benign race here: write_fd may have changed
-            // between checking and using it. This doesn't matter
-            // since in the worst case we will call write() with an invalid
-            // fd (-1) which is harmless.
-            if (write_fd >= 0 && write(write_fd, &sigpid, sizeof(sigpid))) {}
-        }
-    }
-
-private:
-    void init_write_fds()
-    {
-        static std::once_flag once;
-        std::call_once(once,
-            [&]
-            {
-                for (auto& wfd : write_fds)
-                    wfd = -1;
-            });
-    }
-
-    void add_write_fd()
-    {
-        for (auto& wfd : write_fds)
-        {
-            int v = -1;
-            if (wfd.compare_exchange_strong(v, write_fd))
-                return;
-        }
-
-        BOOST_THROW_EXCEPTION(
-            std::runtime_error(
-                "Failed to add signal write fd. Have you created too many main loops?"));
-    }
-
-    void remove_write_fd()
-    {
-        for (auto& wfd : write_fds)
-        {
-            int v = write_fd;
-            if (wfd.compare_exchange_strong(v, -1))
-                break;
-        }
-    }
-
-    static int const max_write_fds{10};
-    static std::array<std::atomic<int>, max_write_fds> write_fds;
-    int const write_fd;
-};
-
-std::array<std::atomic<int>,10> md::SignalSources::SourceRegistration::write_fds;
-
-md::SignalSources::SignalSources(md::FdSources& fd_sources)
-    : fd_sources(fd_sources)
-{
-    int pipefd[2];
-
-    if (pipe(pipefd) == -1)
-    {
-        BOOST_THROW_EXCEPTION(
-            std::system_error(errno, std::system_category(), "Failed to create signal pipe"));
-    }
-
-    signal_read_fd = mir::Fd(pipefd[0]);
-    signal_write_fd = mir::Fd(pipefd[1]);
-
-    fcntl(signal_read_fd, F_SETFD, FD_CLOEXEC);
-    fcntl(signal_write_fd, F_SETFD, FD_CLOEXEC);
-    // Make the signal_write_fd non-blocking, to avoid blocking in the signal handler
-    fcntl(signal_write_fd, F_SETFL, O_NONBLOCK);
-
-    source_registration.reset(new SourceRegistration{signal_write_fd});
-
-    fd_sources.add(signal_read_fd, this,
-        [this] (int) { dispatch_pending_signal(); });
-}
-
-md::SignalSources::~SignalSources()
-{
-    for (auto const& handled : handled_signals)
-        sigaction(handled.first, &handled.second, nullptr);
-
-    fd_sources.remove_all_owned_by(this);
-}
-
-void md::SignalSources::dispatch_pending_signal()
-{
-    auto const sig = read_pending_signal();
-    if (sig.sig != -1)
-    {
-        mir::log_debug("Handling %s from pid=%d", strsignal(sig.sig), sig.pid);
-        dispatch_signal(sig.sig);
-    }
-}
-
-auto md::SignalSources::read_pending_signal() -> SignalPid
-{
-    SignalPid sig{-1, 0};
-    size_t total = 0;
-
-    do
-    {
-        auto const nread = read(
-            signal_read_fd,
-            reinterpret_cast<char*>(&sig) + total,
-            sizeof(sig) - total);
-
-        if (nread < 0)
-        {
-            if (errno != EINTR)
-                return SignalPid{-1, 0};
-        }
-        else
-        {
-            total += nread;
-        }
-    }
-    while (total < sizeof(sig));
-
-    return sig;
-}
-
-void md::SignalSources::add(
-    std::vector<int> const& sigs, std::function<void(int)> const& handler)
-{
-    handlers.add({sigs, handler});
-    for (auto sig : sigs)
-        ensure_signal_is_handled(sig);
-}
-
-void md::SignalSources::ensure_signal_is_handled(int sig)
-{
-    std::lock_guard<std::mutex> lock{handled_signals_mutex};
-
-    if (handled_signals.find(sig) != handled_signals.end())
-        return;
-
-    struct sigaction old_action;
-    struct sigaction new_action;
-
-    new_action.sa_sigaction = SourceRegistration::notify_sources_of_signal;
-    sigfillset(&new_action.sa_mask);
-    new_action.sa_flags = SA_SIGINFO;
-
-    if (sigaction(sig, &new_action, &old_action) == -1)
-    {
-        std::stringstream msg;
-        msg << "Failed to register action for signal " << sig;
-        BOOST_THROW_EXCEPTION(
-            std::system_error(errno, std::system_category(), msg.str()));
-    }
-
-    handled_signals.emplace(sig, old_action);
-}
-
-void md::SignalSources::dispatch_signal(int sig)
-{
-    handlers.for_each(
-        [&] (HandlerElement const& element)
-        {
-            if (std::find(element.sigs.begin(), element.sigs.end(), sig) != element.sigs.end())
-                element.handler(sig);
-        });
-}
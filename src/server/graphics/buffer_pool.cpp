@@ -0,0 +1,209 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/graphics/buffer_pool.h"
+
+#include "mir/graphics/buffer_basic.h"
+#include "mir/time/clock.h"
+
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace mg = mir::graphics;
+namespace geom = mir::geometry;
+
+mir::time::Duration const mg::BufferPool::max_idle_time{std::chrono::seconds{5}};
+
+class mg::BufferPool::Idle
+{
+public:
+    explicit Idle(std::shared_ptr<time::Clock> const& clock)
+        : clock{clock}
+    {
+    }
+
+    auto take(geom::Size size, MirPixelFormat format) -> std::shared_ptr<Buffer>
+    {
+        std::vector<std::shared_ptr<Buffer>> trimmed;
+        std::lock_guard<std::mutex> lock{mutex};
+        trim(trimmed, lock);
+
+        // The most recently returned is likeliest to still be in the cache
+        for (auto entry = buffers.rbegin(); entry != buffers.rend(); ++entry)
+        {
+            if (entry->buffer->size() == size && entry->buffer->pixel_format() == format)
+            {
+                auto const buffer = std::move(entry->buffer);
+                buffers.erase(std::next(entry).base());
+                return buffer;
+            }
+        }
+        return nullptr;
+    }
+
+    void give_back(std::shared_ptr<Buffer> buffer)
+    {
+        // Trimmed buffers are freed after the lock is released
+        std::vector<std::shared_ptr<Buffer>> trimmed;
+        std::lock_guard<std::mutex> lock{mutex};
+        buffers.push_back(Entry{std::move(buffer), clock->now()});
+        trim(trimmed, lock);
+    }
+
+    auto size() const -> int
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        return buffers.size();
+    }
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<Buffer> buffer;
+        time::Timestamp returned;
+    };
+
+    void trim(std::vector<std::shared_ptr<Buffer>>& trimmed, std::lock_guard<std::mutex> const&)
+    {
+        auto const too_old = clock->now() - max_idle_time;
+        while (!buffers.empty() &&
+               (buffers.size() > static_cast<size_t>(max_idle_buffers) || buffers.front().returned < too_old))
+        {
+            trimmed.push_back(std::move(buffers.front().buffer));
+            buffers.pop_front();
+        }
+    }
+
+    std::shared_ptr<time::Clock> const clock;
+
+    std::mutex mutable mutex;
+    /// Oldest first
+    std::deque<Entry> buffers;
+};
+
+class mg::BufferPool::PooledBuffer : public BufferBasic
+{
+public:
+    PooledBuffer(std::shared_ptr<Buffer> buffer, std::weak_ptr<Idle> pool)
+        : buffer{std::move(buffer)},
+          pool{std::move(pool)}
+    {
+    }
+
+    ~PooledBuffer()
+    {
+        if (auto const idle = pool.lock())
+        {
+            try
+            {
+                idle->give_back(std::move(buffer));
+            }
+            catch (...)
+            {
+                // Then the buffer is simply freed
+            }
+        }
+    }
+
+    auto native_buffer_handle() const -> std::shared_ptr<NativeBuffer> override
+    {
+        return buffer->native_buffer_handle();
+    }
+
+    auto size() const -> geom::Size override
+    {
+        return buffer->size();
+    }
+
+    auto pixel_format() const -> MirPixelFormat override
+    {
+        return buffer->pixel_format();
+    }
+
+    auto native_buffer_base() -> NativeBufferBase* override
+    {
+        return buffer->native_buffer_base();
+    }
+
+private:
+    std::shared_ptr<Buffer> buffer;
+    std::weak_ptr<Idle> const pool;
+};
+
+mg::BufferPool::BufferPool(
+    std::shared_ptr<GraphicBufferAllocator> const& wrapped,
+    std::shared_ptr<time::Clock> const& clock)
+    : wrapped{wrapped},
+      idle{std::make_shared<Idle>(clock)}
+{
+}
+
+mg::BufferPool::~BufferPool() = default;
+
+auto mg::BufferPool::supported_pixel_formats() -> std::vector<MirPixelFormat>
+{
+    return wrapped->supported_pixel_formats();
+}
+
+auto mg::BufferPool::alloc_software_buffer(geom::Size size, MirPixelFormat format) -> std::shared_ptr<Buffer>
+{
+    auto buffer = idle->take(size, format);
+    if (!buffer)
+        buffer = wrapped->alloc_software_buffer(size, format);
+
+    return std::make_shared<PooledBuffer>(std::move(buffer), idle);
+}
+
+void mg::BufferPool::bind_display(wl_display* display, std::shared_ptr<Executor> wayland_executor)
+{
+    wrapped->bind_display(display, std::move(wayland_executor));
+}
+
+void mg::BufferPool::unbind_display(wl_display* display)
+{
+    wrapped->unbind_display(display);
+}
+
+auto mg::BufferPool::buffer_from_resource(
+    wl_resource* buffer,
+    std::function<void()>&& on_consumed,
+    std::function<void()>&& on_release) -> std::shared_ptr<Buffer>
+{
+    return wrapped->buffer_from_resource(buffer, std::move(on_consumed), std::move(on_release));
+}
+
+auto mg::BufferPool::buffer_from_shm(
+    wl_resource* buffer,
+    std::shared_ptr<Executor> wayland_executor,
+    std::function<void()>&& on_consumed,
+    std::shared_ptr<Buffer> const& previous,
+    std::experimental::optional<geom::Rectangles> const& damage) -> std::shared_ptr<Buffer>
+{
+    return wrapped->buffer_from_shm(buffer, std::move(wayland_executor), std::move(on_consumed), previous, damage);
+}
+
+void mg::BufferPool::surface_placed(
+    wl_resource* surface,
+    std::experimental::optional<ScanoutPlacement> const& placement)
+{
+    wrapped->surface_placed(surface, placement);
+}
+
+auto mg::BufferPool::idle_buffers() const -> int
+{
+    return idle->size();
+}
@@ -22,6 +22,7 @@
 
 #include "mir/graphics/default_display_configuration_policy.h"
 #include "mir/graphics/graphic_buffer_allocator.h"
+#include "mir/graphics/buffer_pool.h"
 #include "mir/renderer/gl/egl_platform.h"
 #include "null_cursor.h"
 #include "offscreen/display.h"
@@ -40,6 +41,7 @@
 #include "mir/log.h"
 #include "mir/main_loop.h"
 #include "mir/report_exception.h"
+#include "mir/startup_report.h"
 
 #include "mir_toolkit/common.h"
 
@@ -120,12 +122,15 @@ std::shared_ptr<mg::Platform> mir::DefaultServerConfiguration::the_graphics_plat
                               description->minor_version,
                               description->micro_version);
 
-                return create_host_platform(
+                std::shared_ptr<mg::Platform> const platform = create_host_platform(
                     the_options(),
                     the_emergency_cleanup(),
                     the_console_services(),
                     the_display_report(),
                     the_logger());
+
+                the_startup_report()->phase_completed(StartupReport::Phase::platform_probed);
+                return platform;
             }
             catch(...)
             {
@@ -147,6 +152,16 @@ mir::DefaultServerConfiguration::the_buffer_allocator()
         });
 }
 
+std::shared_ptr<mg::BufferPool>
+mir::DefaultServerConfiguration::the_buffer_pool()
+{
+    return buffer_pool(
+        [this]()
+        {
+            return std::make_shared<mg::BufferPool>(the_buffer_allocator(), the_clock());
+        });
+}
+
 std::shared_ptr<mg::Display>
 mir::DefaultServerConfiguration::the_display()
 {
@@ -158,10 +173,14 @@ mir::DefaultServerConfiguration::the_display()
                 if (auto egl_access = std::dynamic_pointer_cast<mir::renderer::gl::EGLPlatform>(
                     the_graphics_platform()))
                 {
-                    return std::make_shared<mg::offscreen::Display>(
+                    auto const offscreen_display = std::make_shared<mg::offscreen::Display>(
                         egl_access->egl_native_display(),
                         the_display_configuration_policy(),
-                        the_display_report());
+                        the_display_report(),
+                        the_options()->get<double>(options::offscreen_refresh_rate_opt));
+
+                    the_startup_report()->phase_completed(StartupReport::Phase::display_configured);
+                    return offscreen_display;
                 }
                 else
                 {
@@ -171,9 +190,12 @@ mir::DefaultServerConfiguration::the_display()
                 }
             }
 
-            return the_graphics_platform()->create_display(
+            std::shared_ptr<mg::Display> const platform_display = the_graphics_platform()->create_display(
                 the_display_configuration_policy(),
                 the_gl_config());
+
+            the_startup_report()->phase_completed(StartupReport::Phase::display_configured);
+            return platform_display;
         });
 }
 
@@ -201,7 +223,7 @@ mir::DefaultServerConfiguration::the_cursor()
             {
                 mir::log_info("Using software cursor");
                 primary_cursor = std::make_shared<mg::SoftwareCursor>(
-                    the_buffer_allocator(),
+                    the_buffer_pool(),
                     the_main_loop(),
                     the_input_scene());
             }
@@ -221,14 +243,18 @@ std::shared_ptr<mg::GLConfig>
 mir::DefaultServerConfiguration::the_gl_config()
 {
     return gl_config(
-        []
+        [this]
         {
-            struct NoGLConfig : public mg::GLConfig
+            struct DefaultGLConfig : public mg::GLConfig
             {
-                int depth_buffer_bits() const override { return 0; }
+                explicit DefaultGLConfig(int depth_bits) : depth_bits{depth_bits} {}
+                int depth_buffer_bits() const override { return depth_bits; }
                 int stencil_buffer_bits() const override { return 0; }
+                int const depth_bits;
             };
-            return std::make_shared<NoGLConfig>();
+            // The renderer only needs a depth buffer to draw opaque surfaces front to back
+            return std::make_shared<DefaultGLConfig>(
+                the_options()->get<bool>(options::opaque_front_to_back_opt) ? 16 : 0);
         });
 }
 
@@ -20,11 +20,11 @@
 #include "display_buffer.h"
 #include "mir/graphics/display_configuration_policy.h"
 #include "mir/graphics/egl_error.h"
-#include "mir/graphics/virtual_output.h"
 #include "mir/geometry/size.h"
 
 #include <boost/throw_exception.hpp>
 #include <stdexcept>
+#include <thread>
 
 namespace mg = mir::graphics;
 namespace mgo = mg::offscreen;
@@ -41,6 +41,14 @@ create_and_initialize_display(EGLNativeDisplayType egl_native_display)
     return egl_display;
 }
 
+auto frame_interval_for(double refresh_rate) -> std::chrono::nanoseconds
+{
+    if (refresh_rate <= 0)
+        return std::chrono::nanoseconds::zero();
+
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>{1.0 / refresh_rate});
+}
+
 }
 
 mgo::detail::EGLDisplayHandle::EGLDisplayHandle(EGLNativeDisplayType native_display)
@@ -82,9 +90,42 @@ mgo::detail::EGLDisplayHandle::~EGLDisplayHandle() noexcept
         eglTerminate(egl_display);
 }
 
-mgo::detail::DisplaySyncGroup::DisplaySyncGroup(std::unique_ptr<mg::DisplayBuffer> output) :
-    output(std::move(output))
+mgo::detail::DisplaySyncGroup::DisplaySyncGroup(
+    std::unique_ptr<mg::DisplayBuffer> output,
+    DisplayConfigurationOutputId output_id,
+    std::chrono::nanoseconds frame_interval) :
+    output_id{output_id},
+    output(std::move(output)),
+    frame_interval{frame_interval},
+    last_vblank{std::chrono::steady_clock::now()}
+{
+}
+
+mgo::detail::VirtualOutput::VirtualOutput(std::weak_ptr<Display> const& display, geom::Size const& size) :
+    display{display},
+    size{size}
+{
+}
+
+mgo::detail::VirtualOutput::~VirtualOutput()
+{
+    disable();
+}
+
+void mgo::detail::VirtualOutput::enable()
+{
+    if (auto const d = display.lock(); d && !output_id)
+        output_id = d->add_virtual_output(size);
+}
+
+void mgo::detail::VirtualOutput::disable()
 {
+    if (output_id)
+    {
+        if (auto const d = display.lock())
+            d->remove_virtual_output(output_id.value());
+        output_id.reset();
+    }
 }
 
 void mgo::detail::DisplaySyncGroup::for_each_display_buffer(
@@ -95,6 +136,16 @@ void mgo::detail::DisplaySyncGroup::for_each_display_buffer(
 
 void mgo::detail::DisplaySyncGroup::post()
 {
+    if (frame_interval > std::chrono::nanoseconds::zero())
+    {
+        // Wait for the next virtual vblank, as a real output would; but don't catch up on ones we've missed
+        auto const now = std::chrono::steady_clock::now();
+        auto const next_vblank = std::max(last_vblank + frame_interval, now);
+        std::this_thread::sleep_until(next_vblank);
+        last_vblank = next_vblank;
+    }
+
+    last_frame_.increment_now();
 }
 
 std::chrono::milliseconds
@@ -103,11 +154,18 @@ mgo::detail::DisplaySyncGroup::recommended_sleep() const
     return std::chrono::milliseconds::zero();
 }
 
+mg::Frame mgo::detail::DisplaySyncGroup::last_frame() const
+{
+    return last_frame_.load();
+}
+
 mgo::Display::Display(
     EGLNativeDisplayType egl_native_display,
     std::shared_ptr<DisplayConfigurationPolicy> const& initial_conf_policy,
-    std::shared_ptr<DisplayReport> const&)
+    std::shared_ptr<DisplayReport> const&,
+    double refresh_rate)
     : egl_display{create_and_initialize_display(egl_native_display)},
+      frame_interval{frame_interval_for(refresh_rate)},
       egl_context_shared{egl_display, EGL_NO_CONTEXT},
       current_display_configuration{geom::Size{1024,768}}
 {
@@ -152,6 +210,7 @@ void mgo::Display::configure(mg::DisplayConfiguration const& conf)
 
     std::lock_guard<std::mutex> lock{configuration_mutex};
 
+    current_display_configuration.update_outputs_from(conf);
     display_sync_groups.clear();
 
     conf.for_each_output(
@@ -161,19 +220,43 @@ void mgo::Display::configure(mg::DisplayConfiguration const& conf)
             {
                 eglBindAPI(EGL_OPENGL_ES_API);
                 auto raw_db = new mgo::DisplayBuffer{
+                    egl_display,
                     SurfacelessEGLContext{egl_display, egl_context_shared},
                     output.extents()};
 
                 display_sync_groups.emplace_back(
-                    new mgo::detail::DisplaySyncGroup(std::unique_ptr<mg::DisplayBuffer>(raw_db)));
+                    new mgo::detail::DisplaySyncGroup(
+                        std::unique_ptr<mg::DisplayBuffer>(raw_db),
+                        output.id,
+                        frame_interval));
             }
         });
 }
 
+void mgo::Display::configure_incrementally(
+    mg::DisplayConfiguration const& conf,
+    std::function<void(mg::DisplaySyncGroup&)> const& release)
+{
+    // Configuring replaces all the display buffers
+    for_each_display_sync_group(release);
+    configure(conf);
+}
+
+bool mgo::Display::apply_if_configuration_only_changes_power_modes(
+    mg::DisplayConfiguration const& /*conf*/,
+    std::function<void(mg::DisplaySyncGroup&)> const& /*suspend*/,
+    std::function<void(mg::DisplaySyncGroup&)> const& /*resume*/)
+{
+    // Every output is drawn offscreen, so there's nothing to power
+    return false;
+}
+
 void mgo::Display::register_configuration_change_handler(
     EventHandlerRegister&,
-    DisplayConfigurationChangeHandler const&)
+    DisplayConfigurationChangeHandler const& conf_change_handler)
 {
+    std::lock_guard<std::mutex> lock{configuration_mutex};
+    configuration_change_handlers.push_back(conf_change_handler);
 }
 
 void mgo::Display::register_pause_resume_handlers(
@@ -202,14 +285,59 @@ std::unique_ptr<mir::renderer::gl::Context> mgo::Display::create_gl_context() co
     return std::make_unique<SurfacelessEGLContext>(egl_display, egl_context_shared);
 }
 
-mg::Frame mgo::Display::last_frame_on(unsigned) const
+mg::Frame mgo::Display::last_frame_on(unsigned output_id) const
 {
+    std::lock_guard<std::mutex> lock{configuration_mutex};
+
+    for (auto const& group : display_sync_groups)
+    {
+        if (group->output_id.as_value() == static_cast<int>(output_id))
+            return group->last_frame();
+    }
+
     return {};
 }
 
-std::unique_ptr<mg::VirtualOutput> mgo::Display::create_virtual_output(int /*width*/, int /*height*/)
+std::unique_ptr<mg::VirtualOutput> mgo::Display::create_virtual_output(int width, int height)
 {
-    return nullptr;
+    // Throws std::bad_weak_ptr if we're not owned by a shared_ptr, rather than leave the output dangling
+    return std::make_unique<detail::VirtualOutput>(shared_from_this(), geom::Size{width, height});
+}
+
+auto mgo::Display::add_virtual_output(geom::Size const& size) -> DisplayConfigurationOutputId
+{
+    DisplayConfigurationOutputId id;
+    {
+        std::lock_guard<std::mutex> lock{configuration_mutex};
+        id = current_display_configuration.add_output(size);
+    }
+
+    // The output only gets a display buffer once the configuration change has been applied
+    notify_configuration_change_handlers();
+    return id;
+}
+
+void mgo::Display::remove_virtual_output(DisplayConfigurationOutputId id)
+{
+    {
+        std::lock_guard<std::mutex> lock{configuration_mutex};
+        current_display_configuration.remove_output(id);
+    }
+
+    notify_configuration_change_handlers();
+}
+
+void mgo::Display::notify_configuration_change_handlers()
+{
+    decltype(configuration_change_handlers) handlers;
+    {
+        std::lock_guard<std::mutex> lock{configuration_mutex};
+        handlers = configuration_change_handlers;
+    }
+
+    // The handlers reconfigure the display, so must be called without the lock held
+    for (auto const& handler : handlers)
+        handler();
 }
 
 bool mgo::Display::apply_if_configuration_preserves_display_buffers(mg::DisplayConfiguration const&)
@@ -20,11 +20,16 @@
 #define MIR_GRAPHICS_OFFSCREEN_DISPLAY_H_
 
 #include "mir/graphics/display.h"
+#include "mir/graphics/atomic_frame.h"
 #include "display_configuration.h"
 #include "mir/graphics/surfaceless_egl_context.h"
+#include "mir/graphics/virtual_output.h"
 #include "mir/renderer/gl/context_source.h"
 
+#include <chrono>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <vector>
 
 #include <EGL/egl.h>
@@ -39,6 +44,8 @@ class DisplayReport;
 
 namespace offscreen
 {
+class Display;
+
 namespace detail
 {
 
@@ -62,28 +69,64 @@ private:
 class DisplaySyncGroup : public graphics::DisplaySyncGroup
 {
 public:
-    DisplaySyncGroup(std::unique_ptr<DisplayBuffer> output);
+    /// \param frame_interval  Time between virtual vblanks; zero to post as fast as we can
+    DisplaySyncGroup(
+        std::unique_ptr<DisplayBuffer> output,
+        DisplayConfigurationOutputId output_id,
+        std::chrono::nanoseconds frame_interval);
     void for_each_display_buffer(std::function<void(DisplayBuffer&)> const&) override;
     void post() override;
     std::chrono::milliseconds recommended_sleep() const override;
+    Frame last_frame() const override;
+
+    DisplayConfigurationOutputId const output_id;
 private:
+    AtomicFrame last_frame_;
     std::unique_ptr<DisplayBuffer> const output;
+    std::chrono::nanoseconds const frame_interval;
+    std::chrono::steady_clock::time_point last_vblank;
 };
 
+/// An output of a size chosen at runtime, for instance for a remote session
+class VirtualOutput : public graphics::VirtualOutput
+{
+public:
+    /// Does nothing once \a display is gone
+    VirtualOutput(std::weak_ptr<Display> const& display, geometry::Size const& size);
+    ~VirtualOutput();
+
+    void enable() override;
+    void disable() override;
+
+private:
+    std::weak_ptr<Display> const display;
+    geometry::Size const size;
+    std::optional<DisplayConfigurationOutputId> output_id;
+};
 }
 
-class Display : public graphics::Display
+class Display : public graphics::Display, public std::enable_shared_from_this<Display>
 {
 public:
+    /// \param refresh_rate  Virtual refresh rate of the outputs, in Hz; zero to composite as fast as we can
     Display(EGLNativeDisplayType egl_native_display,
             std::shared_ptr<DisplayConfigurationPolicy> const& initial_conf_policy,
-            std::shared_ptr<DisplayReport> const& listener);
+            std::shared_ptr<DisplayReport> const& listener,
+            double refresh_rate);
     ~Display() noexcept;
 
     void for_each_display_sync_group(std::function<void(DisplaySyncGroup&)> const& f) override;
 
     std::unique_ptr<graphics::DisplayConfiguration> configuration() const override;
     void configure(graphics::DisplayConfiguration const& conf) override;
+    void configure_incrementally(
+        graphics::DisplayConfiguration const& conf,
+        std::function<void(graphics::DisplaySyncGroup&)> const& release) override;
+
+    bool apply_if_configuration_only_changes_power_modes(
+        graphics::DisplayConfiguration const& conf,
+        std::function<void(graphics::DisplaySyncGroup&)> const& suspend,
+        std::function<void(graphics::DisplaySyncGroup&)> const& resume) override;
 
     void register_configuration_change_handler(
         EventHandlerRegister& handlers,
@@ -104,12 +147,20 @@ public:
 
     std::unique_ptr<renderer::gl::Context> create_gl_context() const override;
     bool apply_if_configuration_preserves_display_buffers(graphics::DisplayConfiguration const& conf) override;
+
+    /// Hotplugs an output of \a size, as a physical monitor would be
+    auto add_virtual_output(geometry::Size const& size) -> DisplayConfigurationOutputId;
+    void remove_virtual_output(DisplayConfigurationOutputId id);
 private:
+    void notify_configuration_change_handlers();
+
     detail::EGLDisplayHandle const egl_display;
+    std::chrono::nanoseconds const frame_interval;
     SurfacelessEGLContext const egl_context_shared;
     mutable std::mutex configuration_mutex;
     DisplayConfiguration current_display_configuration;
-    std::vector<std::unique_ptr<DisplaySyncGroup>> display_sync_groups;
+    std::vector<std::unique_ptr<detail::DisplaySyncGroup>> display_sync_groups;
+    std::vector<DisplayConfigurationChangeHandler> configuration_change_handlers;
 };
 
 }
@@ -21,6 +21,7 @@
 #include "mir/raii.h"
 
 #include <boost/throw_exception.hpp>
+#include <cstring>
 #include <stdexcept>
 
 #include <GLES2/gl2.h>
@@ -116,12 +117,34 @@ void mgo::detail::GLFramebufferObject::unbind() const
                old_viewport[2], old_viewport[3]);
 }
 
-mgo::DisplayBuffer::DisplayBuffer(SurfacelessEGLContext egl_context,
+mgo::DisplayBuffer::DisplayBuffer(EGLDisplay egl_display,
+                                  SurfacelessEGLContext egl_context,
                                   geom::Rectangle const& area)
-    : egl_context{std::move(egl_context)},
+    : egl_display{egl_display},
+      egl_context{std::move(egl_context)},
       fbo{area.size},
       area(area)
 {
+    fences.fill(EGL_NO_SYNC_KHR);
+
+    auto const egl_extensions = eglQueryString(egl_display, EGL_EXTENSIONS);
+    if (egl_extensions && strstr(egl_extensions, "EGL_KHR_fence_sync"))
+    {
+        create_sync = reinterpret_cast<PFNEGLCREATESYNCKHRPROC>(eglGetProcAddress("eglCreateSyncKHR"));
+        destroy_sync = reinterpret_cast<PFNEGLDESTROYSYNCKHRPROC>(eglGetProcAddress("eglDestroySyncKHR"));
+        client_wait_sync = reinterpret_cast<PFNEGLCLIENTWAITSYNCKHRPROC>(eglGetProcAddress("eglClientWaitSyncKHR"));
+        if (!destroy_sync || !client_wait_sync)
+            create_sync = nullptr;
+    }
+}
+
+mgo::DisplayBuffer::~DisplayBuffer()
+{
+    for (auto const fence : fences)
+    {
+        if (fence != EGL_NO_SYNC_KHR)
+            destroy_sync(egl_display, fence);
+    }
 }
 
 geom::Rectangle mgo::DisplayBuffer::view_area() const
@@ -147,10 +170,33 @@ void mgo::DisplayBuffer::release_current()
 
 void mgo::DisplayBuffer::swap_buffers()
 {
-    glFinish();
+    if (!create_sync)
+    {
+        // Without fences the only way to keep the CPU from running away from the GPU is to wait for it
+        glFinish();
+        return;
+    }
+
+    // Nobody scans this out, so there's no need to wait for this frame; only for the oldest one in flight
+    auto& fence = fences[next_fence];
+    if (fence != EGL_NO_SYNC_KHR)
+    {
+        client_wait_sync(egl_display, fence, EGL_SYNC_FLUSH_COMMANDS_BIT_KHR, EGL_FOREVER_KHR);
+        destroy_sync(egl_display, fence);
+    }
+
+    fence = create_sync(egl_display, EGL_SYNC_FENCE_KHR, nullptr);
+    glFlush();
+    next_fence = (next_fence + 1) % fences.size();
+}
+
+void mgo::DisplayBuffer::swap_buffers_with_damage(geometry::Rectangles const&)
+{
+    // There's only one buffer, so there's nothing to gain from the damage
+    swap_buffers();
 }
 
-bool mgo::DisplayBuffer::overlay(RenderableList const&)
+bool mgo::DisplayBuffer::overlay(RenderableList&)
 {
     return false;
 }
@@ -27,6 +27,9 @@
 #include "mir/renderer/gl/render_target.h"
 
 #include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <array>
 
 namespace mir
 {
@@ -62,21 +65,33 @@ class DisplayBuffer : public graphics::DisplayBuffer,
                       public renderer::gl::RenderTarget
 {
 public:
-    DisplayBuffer(SurfacelessEGLContext egl_context,
+    DisplayBuffer(EGLDisplay egl_display,
+                  SurfacelessEGLContext egl_context,
                   geometry::Rectangle const& area);
+    ~DisplayBuffer();
 
     geometry::Rectangle view_area() const override;
-    bool overlay(RenderableList const& renderlist) override;
+    bool overlay(RenderableList& renderlist) override;
     glm::mat2 transformation() const override;
     NativeDisplayBuffer* native_display_buffer() override;
     void make_current() override;
     void bind() override;
     void release_current() override;
     void swap_buffers() override;
+    void swap_buffers_with_damage(geometry::Rectangles const& damage) override;
 private:
+    EGLDisplay const egl_display;
     SurfacelessEGLContext const egl_context;
     detail::GLFramebufferObject const fbo;
     geometry::Rectangle const area;
+
+    PFNEGLCREATESYNCKHRPROC create_sync{nullptr};       ///< nullptr without EGL_KHR_fence_sync
+    PFNEGLDESTROYSYNCKHRPROC destroy_sync{nullptr};
+    PFNEGLCLIENTWAITSYNCKHRPROC client_wait_sync{nullptr};
+
+    /// One per frame we let the GPU queue up, oldest at next_fence
+    std::array<EGLSyncKHR, 2> fences;
+    size_t next_fence{0};
 };
 
 }
@@ -16,12 +16,18 @@
 
 #include "display_configuration.h"
 
+#include <algorithm>
+
 namespace mg = mir::graphics;
 namespace mgo = mg::offscreen;
 namespace geom = mir::geometry;
 
-mgo::DisplayConfiguration::DisplayConfiguration(geom::Size const& display_size)
-        : output{mg::DisplayConfigurationOutputId{1},
+namespace
+{
+auto output_of_size(mg::DisplayConfigurationOutputId id, geom::Size const& display_size, geom::Point top_left)
+    -> mg::DisplayConfigurationOutput
+{
+    return {id,
                  mg::DisplayConfigurationCardId{0},
                  mg::DisplayConfigurationLogicalGroupId{0},
                  mg::DisplayConfigurationOutputType::lvds,
@@ -31,7 +37,7 @@ mgo::DisplayConfiguration::DisplayConfiguration(geom::Size const& display_size)
                  geom::Size{0,0},
                  true,
                  true,
-                 geom::Point{0,0},
+                 top_left,
                  0,
                  mir_pixel_format_xrgb_8888,
                  mir_power_mode_on,
@@ -42,14 +48,19 @@ mgo::DisplayConfiguration::DisplayConfiguration(geom::Size const& display_size)
                  {},
                  mir_output_gamma_unsupported,
                  {},
-                 {}},
+                 {}};
+}
+}
+
+mgo::DisplayConfiguration::DisplayConfiguration(geom::Size const& display_size)
+        : outputs{output_of_size(mg::DisplayConfigurationOutputId{1}, display_size, geom::Point{0,0})},
           card{mg::DisplayConfigurationCardId{0}, 1}
 {
 }
 
 mgo::DisplayConfiguration::DisplayConfiguration(DisplayConfiguration const& other)
     : mg::DisplayConfiguration(),
-      output(other.output),
+      outputs(other.outputs),
       card(other.card)
 {
 }
@@ -59,7 +70,7 @@ mgo::DisplayConfiguration::operator=(DisplayConfiguration const& other)
 {
     if (&other != this)
     {
-        output = other.output;
+        outputs = other.outputs;
         card = other.card;
     }
     return *this;
@@ -74,17 +85,59 @@ void mgo::DisplayConfiguration::for_each_card(
 void mgo::DisplayConfiguration::for_each_output(
     std::function<void(mg::DisplayConfigurationOutput const&)> f) const
 {
-    f(output);
+    for (auto const& output : outputs)
+        f(output);
 }
 
 void mgo::DisplayConfiguration::for_each_output(
     std::function<void(mg::UserDisplayConfigurationOutput&)> f)
 {
-    mg::UserDisplayConfigurationOutput user(output);
-    f(user);
+    for (auto& output : outputs)
+    {
+        mg::UserDisplayConfigurationOutput user(output);
+        f(user);
+    }
 }
 
 std::unique_ptr<mg::DisplayConfiguration> mgo::DisplayConfiguration::clone() const
 {
     return std::make_unique<mgo::DisplayConfiguration>(*this);
 }
+
+auto mgo::DisplayConfiguration::add_output(geom::Size const& size) -> DisplayConfigurationOutputId
+{
+    int max_id{0};
+    geom::X right{0};
+    for (auto const& output : outputs)
+    {
+        max_id = std::max(max_id, output.id.as_value());
+        right = std::max(right, output.extents().right());
+    }
+
+    auto const id = DisplayConfigurationOutputId{max_id + 1};
+    outputs.push_back(output_of_size(id, size, geom::Point{right, 0}));
+    card.max_simultaneous_outputs = outputs.size();
+    return id;
+}
+
+void mgo::DisplayConfiguration::remove_output(DisplayConfigurationOutputId id)
+{
+    outputs.erase(
+        std::remove_if(begin(outputs), end(outputs), [id](auto const& output) { return output.id == id; }),
+        end(outputs));
+}
+
+void mgo::DisplayConfiguration::update_outputs_from(mg::DisplayConfiguration const& conf)
+{
+    std::vector<DisplayConfigurationOutput> applied;
+    conf.for_each_output([&applied](DisplayConfigurationOutput const& output) { applied.push_back(output); });
+
+    for (auto& output : outputs)
+    {
+        for (auto const& update : applied)
+        {
+            if (update.id == output.id)
+                output = update;
+        }
+    }
+}
@@ -19,6 +19,8 @@
 
 #include "mir/graphics/display_configuration.h"
 
+#include <vector>
+
 namespace mir
 {
 namespace graphics
@@ -38,8 +40,14 @@ public:
     void for_each_output(std::function<void(UserDisplayConfigurationOutput&)> f) override;
     std::unique_ptr<graphics::DisplayConfiguration> clone() const override;
 
+    /// Adds an output of \a size to the right of the others
+    auto add_output(geometry::Size const& size) -> DisplayConfigurationOutputId;
+    void remove_output(DisplayConfigurationOutputId id);
+    /// Takes the settings of the outputs we share with \a conf
+    void update_outputs_from(graphics::DisplayConfiguration const& conf);
+
 private:
-    DisplayConfigurationOutput output;
+    std::vector<DisplayConfigurationOutput> outputs;
     DisplayConfigurationCard card;
 };
 
@@ -17,11 +17,140 @@
  */
 
 #include "mir/log.h"
+#include "mir/console_services.h"
 #include "mir/graphics/platform.h"
 #include "platform_probe.h"
 
 #include <boost/throw_exception.hpp>
 
+#include <condition_variable>
+#include <future>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace mg = mir::graphics;
+
+class mg::ProbeConsoleServices::TakenDevices
+{
+public:
+    /// Waits until no other probe (thread) holds the device, then holds it for this one
+    void take(std::pair<int, int> const& device)
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        auto const probe = std::this_thread::get_id();
+        released.wait(lock, [&]
+            {
+                auto const holder = holders.find(device);
+                return holder == holders.end() || holder->second.probe == probe;
+            });
+
+        auto& holder = holders[device];
+        holder.probe = probe;
+        ++holder.count;
+    }
+
+    void give_back(std::pair<int, int> const& device)
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            auto const holder = holders.find(device);
+            if (--holder->second.count == 0)
+                holders.erase(holder);
+        }
+        released.notify_all();
+    }
+
+private:
+    struct Holder
+    {
+        std::thread::id probe;
+        int count{0};
+    };
+
+    std::mutex mutex;
+    std::condition_variable released;
+    std::map<std::pair<int, int>, Holder> holders;
+};
+
+/// Gives a device back for other probes to take when the last reference to it goes
+class mg::ProbeConsoleServices::Taken
+{
+public:
+    Taken(std::shared_ptr<TakenDevices> const& devices, std::pair<int, int> device)
+        : devices{devices},
+          device{device}
+    {
+        devices->take(device);
+    }
+
+    ~Taken()
+    {
+        devices->give_back(device);
+    }
+
+    Taken(Taken const&) = delete;
+    Taken& operator=(Taken const&) = delete;
+
+private:
+    std::shared_ptr<TakenDevices> const devices;
+    std::pair<int, int> const device;
+};
+
+/// Keeps the device to its probe until the probe lets it go
+struct mg::ProbeConsoleServices::TakenDevice : mir::Device
+{
+    TakenDevice(std::unique_ptr<mir::Device> device, std::shared_ptr<Taken> taken)
+        : taken{std::move(taken)},
+          device{std::move(device)}
+    {
+    }
+
+    std::shared_ptr<Taken> const taken;
+    std::unique_ptr<mir::Device> const device;
+};
+
+mg::ProbeConsoleServices::ProbeConsoleServices(std::shared_ptr<ConsoleServices> const& wrapped)
+    : wrapped{wrapped},
+      taken_devices{std::make_shared<TakenDevices>()}
+{
+}
+
+void mg::ProbeConsoleServices::register_switch_handlers(
+    EventHandlerRegister& handlers,
+    std::function<bool()> const& switch_away,
+    std::function<bool()> const& switch_back)
+{
+    wrapped->register_switch_handlers(handlers, switch_away, switch_back);
+}
+
+void mg::ProbeConsoleServices::restore()
+{
+    wrapped->restore();
+}
+
+std::unique_ptr<mir::VTSwitcher> mg::ProbeConsoleServices::create_vt_switcher()
+{
+    return wrapped->create_vt_switcher();
+}
+
+std::future<std::unique_ptr<mir::Device>> mg::ProbeConsoleServices::acquire_device(
+    int major, int minor,
+    std::unique_ptr<Device::Observer> observer)
+{
+    // Held until the device is destroyed, or the future is if the probe never gets it
+    auto const taken = std::make_shared<Taken>(taken_devices, std::make_pair(major, minor));
+    auto pending = std::make_shared<std::future<std::unique_ptr<Device>>>(
+        wrapped->acquire_device(major, minor, std::move(observer)));
+
+    return std::async(
+        std::launch::deferred,
+        [taken, pending]() -> std::unique_ptr<Device>
+        {
+            return std::make_unique<TakenDevice>(pending->get(), taken);
+        });
+}
+
 auto mir::graphics::probe_module(
     mir::SharedLibrary& module,
     mir::options::ProgramOption const& options,
@@ -54,21 +183,36 @@ mir::graphics::module_for_device(
     mir::options::ProgramOption const& options,
     std::shared_ptr<ConsoleServices> const& console)
 {
-    mir::graphics::PlatformPriority best_priority_so_far = mir::graphics::unsupported;
-    std::shared_ptr<mir::SharedLibrary> best_module_so_far;
+    // Probes spend most of their time waiting on devices and drivers, so they're run together
+    auto const probe_console = std::make_shared<ProbeConsoleServices>(console);
+    std::vector<std::future<mir::graphics::PlatformPriority>> priorities;
     for (auto& module : modules)
     {
-        try
-        {
-            auto module_priority = probe_module(*module, options, console);
-            if (module_priority > best_priority_so_far)
+        priorities.push_back(std::async(
+            std::launch::async,
+            [&options, probe_console, module]()
             {
-                best_priority_so_far = module_priority;
-                best_module_so_far = module;
-            }
-        }
-        catch (std::runtime_error const&)
+                try
+                {
+                    return probe_module(*module, options, probe_console);
+                }
+                catch (std::runtime_error const&)
+                {
+                    return mir::graphics::PlatformPriority::unsupported;
+                }
+            }));
+    }
+
+    // The modules are considered in order, so the first of equally good ones is chosen, as before
+    mir::graphics::PlatformPriority best_priority_so_far = mir::graphics::unsupported;
+    std::shared_ptr<mir::SharedLibrary> best_module_so_far;
+    for (auto i = 0u; i != modules.size(); ++i)
+    {
+        auto const module_priority = priorities[i].get();
+        if (module_priority > best_priority_so_far)
         {
+            best_priority_so_far = module_priority;
+            best_module_so_far = modules[i];
         }
     }
     if (best_priority_so_far > mir::graphics::unsupported)
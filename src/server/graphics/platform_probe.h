@@ -24,15 +24,46 @@
 #include "mir/shared_library.h"
 #include "mir/options/program_option.h"
 #include "mir/graphics/platform.h"
+#include "mir/console_services.h"
 
 namespace mir
 {
-class ConsoleServices;
-
 namespace graphics
 {
 class Platform;
 
+/**
+ * Lets concurrent probes share the console: each device is held by one probe at
+ * a time, as it would be if they were run in turn. (logind, for one, refuses to
+ * hand out a device that's already been taken.)
+ *
+ * A probe waits for a device another probe holds, but may take one it holds itself
+ * again. The device is free again once the probe destroys it, on whatever thread.
+ */
+class ProbeConsoleServices : public ConsoleServices
+{
+public:
+    explicit ProbeConsoleServices(std::shared_ptr<ConsoleServices> const& wrapped);
+
+    void register_switch_handlers(
+        EventHandlerRegister& handlers,
+        std::function<bool()> const& switch_away,
+        std::function<bool()> const& switch_back) override;
+    void restore() override;
+    std::unique_ptr<VTSwitcher> create_vt_switcher() override;
+    std::future<std::unique_ptr<Device>> acquire_device(
+        int major, int minor,
+        std::unique_ptr<Device::Observer> observer) override;
+
+private:
+    class TakenDevices;
+    class Taken;
+    struct TakenDevice;
+
+    std::shared_ptr<ConsoleServices> const wrapped;
+    std::shared_ptr<TakenDevices> const taken_devices;
+};
+
 auto probe_module(
     SharedLibrary& module,
     options::ProgramOption const& options,
@@ -72,6 +72,11 @@ public:
         return 1;
     }
 
+    bool tearing_allowed() const override
+    {
+        return false;
+    }
+
     mg::Renderable::ID id() const override
     {
         return this;
@@ -88,6 +93,11 @@ public:
         return {position, buffer_->size()};
     }
 
+    geom::RectangleF src_bounds() const override
+    {
+        return {{}, geom::SizeF{buffer_->size()}};
+    }
+
     std::experimental::optional<geometry::Rectangle> clip_area() const override
     {
         return std::experimental::optional<geometry::Rectangle>();
@@ -108,6 +118,17 @@ public:
         return true;
     }
 
+    std::experimental::optional<geom::Rectangles> damage() const override
+    {
+        // Our buffer never changes; a new cursor image gets a new renderable
+        return geom::Rectangles{};
+    }
+
+    geom::Rectangles opaque_region() const override
+    {
+        return {};
+    }
+
     void move_to(geom::Point new_position)
     {
         std::lock_guard<std::mutex> lock{position_mutex};
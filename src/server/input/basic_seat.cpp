@@ -41,17 +41,18 @@ namespace geom = mir::geometry;
 struct mi::BasicSeat::OutputTracker : mg::DisplayConfigurationObserver
 {
     OutputTracker(SeatInputDeviceTracker& tracker)
-        : input_state_tracker{tracker}
+        : input_state_tracker{tracker},
+          layout{std::make_shared<Layout const>()}
     {
     }
 
     void update_outputs(mg::DisplayConfiguration const& conf)
     {
-        std::lock_guard<std::mutex> lock(output_mutex);
-        outputs.clear();
+        auto updated = std::make_shared<Layout>();
+        auto& outputs = updated->outputs;
         geom::Rectangles output_rectangles;
         conf.for_each_output(
-            [this, &output_rectangles](mg::DisplayConfigurationOutput const& output)
+            [&outputs, &output_rectangles](mg::DisplayConfigurationOutput const& output)
             {
                 if (!output.used || !output.connected)
                     return;
@@ -99,7 +100,8 @@ struct mi::BasicSeat::OutputTracker : mg::DisplayConfigurationObserver
                 outputs.insert(std::make_pair(output.id.as_value(), OutputInfo{active, output_size, output_matrix}));
             });
         input_state_tracker.update_outputs(output_rectangles);
-        bounding_rectangle = output_rectangles.bounding_rectangle();
+        updated->bounding_rectangle = output_rectangles.bounding_rectangle();
+        std::atomic_store(&layout, std::shared_ptr<Layout const>{std::move(updated)});
     }
 
     void initial_configuration(std::shared_ptr<mg::DisplayConfiguration const> const& config) override
@@ -139,13 +141,13 @@ struct mi::BasicSeat::OutputTracker : mg::DisplayConfigurationObserver
 
     geom::Rectangle get_bounding_rectangle() const
     {
-        std::lock_guard<std::mutex> lock(output_mutex);
-        return bounding_rectangle;
+        return std::atomic_load(&layout)->bounding_rectangle;
     }
 
     mi::OutputInfo get_output_info(uint32_t output) const
     {
-        std::lock_guard<std::mutex> lock(output_mutex);
+        auto const current = std::atomic_load(&layout);
+        auto const& outputs = current->outputs;
         if (output)
         {
             auto pos = outputs.find(output);
@@ -165,10 +167,16 @@ struct mi::BasicSeat::OutputTracker : mg::DisplayConfigurationObserver
     }
 
 private:
-    mutable std::mutex output_mutex;
+    /// Event builders consult this for every touch and absolute pointer event, so it is replaced
+    /// (never modified) on reconfiguration and read without locking
+    struct Layout
+    {
+        std::map<uint32_t, mi::OutputInfo> outputs;
+        geom::Rectangle bounding_rectangle;
+    };
+
     mi::SeatInputDeviceTracker& input_state_tracker;
-    std::map<uint32_t, mi::OutputInfo> outputs;
-    geom::Rectangle bounding_rectangle;
+    std::shared_ptr<Layout const> layout;   ///< Read and written with std::atomic_load()/std::atomic_store()
 };
 
 mi::BasicSeat::BasicSeat(std::shared_ptr<mi::InputDispatcher> const& dispatcher,
@@ -177,13 +185,15 @@ mi::BasicSeat::BasicSeat(std::shared_ptr<mi::InputDispatcher> const& dispatcher,
                          std::shared_ptr<Registrar> const& registrar,
                          std::shared_ptr<mi::KeyMapper> const& key_mapper,
                          std::shared_ptr<time::Clock> const& clock,
-                         std::shared_ptr<mi::SeatObserver> const& observer) :
+                         std::shared_ptr<mi::SeatObserver> const& observer,
+                         std::shared_ptr<mi::InputReport> const& report) :
       input_state_tracker{dispatcher,
                           touch_visualizer,
                           cursor_listener,
                           key_mapper,
                           clock,
-                          observer},
+                          observer,
+                          report},
       output_tracker{std::make_shared<OutputTracker>(input_state_tracker)}
 {
     registrar->register_interest(output_tracker);
@@ -208,6 +218,11 @@ void mi::BasicSeat::dispatch_event(std::shared_ptr<MirEvent> const& event)
     input_state_tracker.dispatch(event);
 }
 
+void mi::BasicSeat::dispatch_events(std::vector<std::shared_ptr<MirEvent>> const& events)
+{
+    input_state_tracker.dispatch(events);
+}
+
 geom::Rectangle mi::BasicSeat::bounding_rectangle() const
 {
     return output_tracker->get_bounding_rectangle();
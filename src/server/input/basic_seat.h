@@ -44,6 +44,7 @@ class CursorListener;
 class InputDispatcher;
 class KeyMapper;
 class SeatObserver;
+class InputReport;
 
 class BasicSeat : public Seat
 {
@@ -55,11 +56,13 @@ public:
               std::shared_ptr<Registrar> const& registrar,
               std::shared_ptr<KeyMapper> const& key_mapper,
               std::shared_ptr<time::Clock> const& clock,
-              std::shared_ptr<SeatObserver> const& observer);
+              std::shared_ptr<SeatObserver> const& observer,
+              std::shared_ptr<InputReport> const& report);
     // Seat methods:
     void add_device(Device const& device) override;
     void remove_device(Device const& device) override;
     void dispatch_event(std::shared_ptr<MirEvent> const& event) override;
+    void dispatch_events(std::vector<std::shared_ptr<MirEvent>> const& events) override;
     geometry::Rectangle bounding_rectangle() const override;
     input::OutputInfo output_info(uint32_t output_id) const override;
     EventUPtr create_device_state() override;
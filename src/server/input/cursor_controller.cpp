@@ -83,13 +83,13 @@ struct UpdateCursorOnSurfaceChanges : ms::NullSurfaceObserver
     {
         cursor_controller->update_cursor_image();
     }
-    void cursor_image_set_to(ms::Surface const*, const mir::graphics::CursorImage&) override
+    void cursor_image_set_to(ms::Surface const* surface, const mir::graphics::CursorImage&) override
     {
-        cursor_controller->update_cursor_image();
+        cursor_controller->update_cursor_image_of(surface);
     }
-    void cursor_image_removed(ms::Surface const*) override
+    void cursor_image_removed(ms::Surface const* surface) override
     {
-        cursor_controller->update_cursor_image();
+        cursor_controller->update_cursor_image_of(surface);
     }
     void orientation_set_to(ms::Surface const*, MirOrientation) override
     {
@@ -149,7 +149,8 @@ struct UpdateCursorOnSceneChanges : ms::Observer
 
     void scene_changed() override
     {
-        cursor_controller->update_cursor_image();
+        // Only input visualizations (such as the software cursor following each motion) report this, and
+        // they don't change which surface is under the cursor
     }
 
     void surface_exists(std::shared_ptr<ms::Surface> const& surface) override
@@ -250,6 +251,7 @@ void mi::CursorController::set_cursor_image_locked(std::unique_lock<std::mutex>&
 void mi::CursorController::update_cursor_image_locked(std::unique_lock<std::mutex>& lock)
 {
     auto surface = topmost_surface_containing_point(input_targets, cursor_location);
+    current_target = surface.get();
     if (surface)
     {
         set_cursor_image_locked(lock, surface->cursor_image());
@@ -266,6 +268,17 @@ void mi::CursorController::update_cursor_image()
     update_cursor_image_locked(lock);
 }
 
+void mi::CursorController::update_cursor_image_of(Surface const* surface)
+{
+    std::unique_lock<std::mutex> lock(cursor_state_guard);
+
+    // The cursor of a surface that isn't under the pointer doesn't matter
+    if (surface != current_target)
+        return;
+
+    set_cursor_image_locked(lock, surface->cursor_image());
+}
+
 void mi::CursorController::cursor_moved_to(float abs_x, float abs_y)
 {
     auto const new_location = geom::Point{geom::X{abs_x}, geom::Y{abs_y}};
@@ -40,6 +40,7 @@ class Observer;
 namespace input
 {
 class Scene;
+class Surface;
 
 class CursorController : public CursorListener
 {
@@ -55,6 +56,9 @@ public:
     // in response to scene changes.
     void update_cursor_image();
 
+    // Update the cursor image after that of surface changes; nothing to do unless it is under the cursor.
+    void update_cursor_image_of(Surface const* surface);
+
     void pointer_usable() override;
 
     void pointer_unusable() override;
@@ -67,6 +71,7 @@ private:
 
     std::mutex cursor_state_guard;
     geometry::Point cursor_location;
+    Surface const* current_target = nullptr;    // Only compared, never dereferenced
     std::shared_ptr<graphics::CursorImage> current_cursor;
     bool usable = false;
 
@@ -19,6 +19,7 @@
 #include "mir/default_server_configuration.h"
 
 #include "key_repeat_dispatcher.h"
+#include "resampling_dispatcher.h"
 #include "event_filter_chain_dispatcher.h"
 #include "config_changer.h"
 #include "cursor_controller.h"
@@ -50,6 +51,8 @@
 #include "mir/shared_library.h"
 #include "mir/dispatch/action_queue.h"
 #include "mir/console_services.h"
+#include "mir/thread_scheduling.h"
+#include "mir/time/timer_wheel.h"
 #include "mir/log.h"
 
 #include "mir_toolkit/cursors.h"
@@ -140,8 +143,17 @@ mir::DefaultServerConfiguration::the_input_dispatcher()
             // lp:1675357: Disable generation of key repeat events on nested servers
             auto enable_repeat = options->get<bool>(options::enable_key_repeat_opt);
 
+            std::shared_ptr<mi::InputDispatcher> next_dispatcher = the_event_filter_chain_dispatcher();
+            if (auto const resample_rate = options->get<int>(options::input_resample_rate_opt); resample_rate > 0)
+            {
+                next_dispatcher = std::make_shared<mi::ResamplingDispatcher>(
+                    next_dispatcher,
+                    the_input_alarm_factory(),
+                    std::chrono::nanoseconds{std::chrono::seconds{1}} / resample_rate);
+            }
+
             return std::make_shared<mi::KeyRepeatDispatcher>(
-                the_event_filter_chain_dispatcher(), the_main_loop(), the_cookie_authority(),
+                next_dispatcher, the_input_alarm_factory(), the_cookie_authority(),
                 enable_repeat, key_repeat_timeout, key_repeat_delay, false);
         });
 }
@@ -249,7 +261,13 @@ mir::DefaultServerConfiguration::the_input_manager()
                         *the_shared_library_prober_report());
                 }
 
-                return std::make_shared<mi::DefaultInputManager>(the_input_reading_multiplexer(), std::move(platform));
+                return std::make_shared<mi::DefaultInputManager>(
+                    the_input_reading_multiplexer(),
+                    std::move(platform),
+                    thread_scheduling_from(
+                        *options,
+                        options::input_thread_priority_opt,
+                        options::input_thread_cpus_opt));
             }
         }
     );
@@ -266,6 +284,21 @@ mir::DefaultServerConfiguration::the_input_reading_multiplexer()
     );
 }
 
+std::shared_ptr<mir::time::AlarmFactory> mir::DefaultServerConfiguration::the_input_alarm_factory()
+{
+    return input_alarm_factory(
+        [this]() -> std::shared_ptr<time::AlarmFactory>
+        {
+            // Without input there's no input thread to dispatch the alarms
+            if (!the_options()->get<bool>(options::enable_input_opt))
+                return the_main_loop();
+
+            auto const timer_wheel = std::make_shared<time::TimerWheel>();
+            the_input_reading_multiplexer()->add_watch(timer_wheel);
+            return timer_wheel;
+        });
+}
+
 std::shared_ptr<mi::Seat> mir::DefaultServerConfiguration::the_seat()
 {
     return seat(
@@ -278,7 +311,8 @@ std::shared_ptr<mi::Seat> mir::DefaultServerConfiguration::the_seat()
                     the_display_configuration_observer_registrar(),
                     the_key_mapper(),
                     the_clock(),
-                    the_seat_observer());
+                    the_seat_observer(),
+                    the_input_report());
         });
 }
 
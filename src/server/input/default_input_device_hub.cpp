@@ -277,13 +277,21 @@ MirInputDeviceId mi::DefaultInputDeviceHub::RegisteredDevice::id()
     return device_id;
 }
 
-void mi::DefaultInputDeviceHub::RegisteredDevice::handle_input(std::shared_ptr<MirEvent> const& event)
+namespace
+{
+void check_is_input_event(MirEvent const& event)
 {
-    auto type = mir_event_get_type(event.get());
+    auto type = mir_event_get_type(&event);
 
     if (type != mir_event_type_input &&
         type != mir_event_type_input_device_state)
         BOOST_THROW_EXCEPTION(std::invalid_argument("Invalid input event received from device"));
+}
+}
+
+void mi::DefaultInputDeviceHub::RegisteredDevice::handle_input(std::shared_ptr<MirEvent> const& event)
+{
+    check_is_input_event(*event);
 
     if (!seat)
         return;
@@ -291,6 +299,18 @@ void mi::DefaultInputDeviceHub::RegisteredDevice::handle_input(std::shared_ptr<M
     seat->dispatch_event(event);
 }
 
+void mi::DefaultInputDeviceHub::RegisteredDevice::handle_input_batch(
+    std::vector<std::shared_ptr<MirEvent>> const& events)
+{
+    for (auto const& event : events)
+        check_is_input_event(*event);
+
+    if (!seat || events.empty())
+        return;
+
+    seat->dispatch_events(events);
+}
+
 bool mi::DefaultInputDeviceHub::RegisteredDevice::device_matches(std::shared_ptr<InputDevice> const& dev) const
 {
     return dev == device;
@@ -397,12 +417,16 @@ void mi::DefaultInputDeviceHub::add_device_handle(std::shared_ptr<DefaultDevice>
         handles.push_back(handle);
     }
 
-    observers.for_each([&handle](std::shared_ptr<InputDeviceObserver> const& observer)
+    auto observed = false;
+    observers.for_each([&](std::shared_ptr<InputDeviceObserver> const& observer)
         {
             observer->device_added(handle);
-            observer->changes_complete();
+            observed = true;
         });
 
+    if (observed)
+        complete_changes_later();
+
     if (!ready)
     {
         server_status_listener->ready_for_user_input();
@@ -435,15 +459,19 @@ void mi::DefaultInputDeviceHub::remove_device_handle(MirInputDeviceId id)
         no_of_devices = handles.size();
     }
 
+    auto observed = false;
     for (auto const& handle : removed_devices)
     {
         observers.for_each([&](std::shared_ptr<InputDeviceObserver> const& observer)
             {
                 observer->device_removed(handle);
-                observer->changes_complete();
+                observed = true;
             });
     }
 
+    if (observed)
+        complete_changes_later();
+
     removed_devices.clear();
 
     if (ready && 0 == no_of_devices)
@@ -453,6 +481,24 @@ void mi::DefaultInputDeviceHub::remove_device_handle(MirInputDeviceId id)
     }
 }
 
+void mi::DefaultInputDeviceHub::complete_changes_later()
+{
+    // A dock or a hub brings a whole burst of devices at once: tell the observers the changes are
+    // complete once the burst has been handled, so they (and the clients) see it as one change
+    if (changes_complete_pending.exchange(true))
+        return;
+
+    device_queue->enqueue(
+        [this]
+        {
+            changes_complete_pending = false;
+            observers.for_each([](std::shared_ptr<InputDeviceObserver> const& observer)
+                {
+                    observer->changes_complete();
+                });
+        });
+}
+
 void mi::DefaultInputDeviceHub::device_changed(Device* dev)
 {
     auto more_changes_in_progress = false;
@@ -37,6 +37,7 @@
 #include <vector>
 #include <memory>
 #include <mutex>
+#include <atomic>
 
 namespace mir
 {
@@ -101,6 +102,7 @@ public:
 private:
     void add_device_handle(std::shared_ptr<DefaultDevice> const& handle);
     void remove_device_handle(MirInputDeviceId id);
+    void complete_changes_later();
     void device_changed(Device* dev);
     void emit_changed_devices();
     MirInputDeviceId create_new_device_id();
@@ -126,6 +128,7 @@ private:
                          std::shared_ptr<cookie::Authority> const& cookie_authority,
                          std::shared_ptr<DefaultDevice> const& handle);
         void handle_input(std::shared_ptr<MirEvent> const& event) override;
+        void handle_input_batch(std::vector<std::shared_ptr<MirEvent>> const& events) override;
         geometry::Rectangle bounding_rectangle() const override;
         input::OutputInfo output_info(uint32_t output_id) const override;
         bool device_matches(std::shared_ptr<InputDevice> const& dev) const;
@@ -151,6 +154,7 @@ private:
     ThreadSafeList<std::shared_ptr<InputDeviceObserver>> observers;
     std::mutex changed_devices_guard;
     std::unique_ptr<std::vector<std::shared_ptr<Device>>> changed_devices;
+    std::atomic<bool> changes_complete_pending{false};
 
     std::mutex stored_configurations_guard;
     std::vector<MirInputDevice> stored_devices;
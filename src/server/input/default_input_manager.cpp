@@ -35,10 +35,12 @@ namespace mi = mir::input;
 
 mi::DefaultInputManager::DefaultInputManager(
     std::shared_ptr<dispatch::MultiplexingDispatchable> const& multiplexer,
-    std::shared_ptr<Platform> const& platform) :
+    std::shared_ptr<Platform> const& platform,
+    ThreadScheduling const& thread_scheduling) :
     platform{platform},
     multiplexer{multiplexer},
     queue{std::make_shared<mir::dispatch::ActionQueue>()},
+    thread_scheduling{thread_scheduling},
     state{State::stopped}
 {
 }
@@ -83,6 +85,7 @@ void mi::DefaultInputManager::start()
      */
     queue->enqueue([this,promise = std::move(started_promise)]()
                    {
+                        apply_thread_scheduling(thread_scheduling, "Mir/Input Reader");
                         start_platforms();
                         promise->set_value();
                    });
@@ -20,6 +20,7 @@
 #define MIR_INPUT_DEFAULT_INPUT_MANAGER_H_
 
 #include "mir/input/input_manager.h"
+#include "mir/thread_scheduling.h"
 
 #include <atomic>
 #include <memory>
@@ -44,7 +45,8 @@ class DefaultInputManager : public InputManager
 public:
     DefaultInputManager(
         std::shared_ptr<dispatch::MultiplexingDispatchable> const& multiplexer,
-        std::shared_ptr<Platform> const& platform);
+        std::shared_ptr<Platform> const& platform,
+        ThreadScheduling const& thread_scheduling = {});
     ~DefaultInputManager();
 
     void start() override;
@@ -57,6 +59,7 @@ private:
     std::shared_ptr<Platform> const platform;
     std::shared_ptr<dispatch::MultiplexingDispatchable> const multiplexer;
     std::shared_ptr<dispatch::ActionQueue> const queue;
+    ThreadScheduling const thread_scheduling;
     std::unique_ptr<dispatch::ThreadedDispatcher> input_thread;
 
     enum class State
@@ -18,12 +18,26 @@
 
 #include "event_filter_chain_dispatcher.h"
 
+#include <algorithm>
+
 namespace mi = mir::input;
 
+namespace
+{
+auto without_expired(std::vector<std::weak_ptr<mi::EventFilter>> filters)
+    -> std::vector<std::weak_ptr<mi::EventFilter>>
+{
+    filters.erase(
+        std::remove_if(begin(filters), end(filters), [](auto const& filter) { return filter.expired(); }),
+        end(filters));
+    return filters;
+}
+}
+
 mi::EventFilterChainDispatcher::EventFilterChainDispatcher(
     std::vector<std::weak_ptr<mi::EventFilter>> initial_filters,
     std::shared_ptr<mi::InputDispatcher> const& next_dispatcher)
-    : filters(std::move(initial_filters)),
+    : filters(std::make_shared<Filters const>(std::move(initial_filters))),
       next_dispatcher(next_dispatcher)
 {
 }
@@ -31,19 +45,16 @@ mi::EventFilterChainDispatcher::EventFilterChainDispatcher(
 // TODO: It probably makes sense to provide keymapped events.
 bool mi::EventFilterChainDispatcher::handle(MirEvent const& event)
 {
-    std::lock_guard<std::mutex> lg(filter_guard);
-    
-    auto it = filters.begin();
-    while (it != filters.end())
+    // The filters are not ours to keep alive, so each is still locked while it handles the event. Expired ones
+    // are skipped here, and pruned by the next change to the chain.
+    auto const current = std::atomic_load(&filters);
+
+    for (auto const& weak_filter : *current)
     {
-        auto filter = (*it).lock();
-        if (!filter)
+        if (auto const filter = weak_filter.lock())
         {
-            it = filters.erase(it);
-            continue;
+            if (filter->handle(event)) return true;
         }
-        if (filter->handle(event)) return true;
-        ++it;
     }
     return false;
 }
@@ -52,14 +63,18 @@ void mi::EventFilterChainDispatcher::append(std::weak_ptr<EventFilter> const& fi
 {
     std::lock_guard<std::mutex> lg(filter_guard);
 
-    filters.push_back(filter);
+    auto updated = without_expired(*std::atomic_load(&filters));
+    updated.push_back(filter);
+    std::atomic_store(&filters, std::make_shared<Filters const>(std::move(updated)));
 }
 
 void mi::EventFilterChainDispatcher::prepend(std::weak_ptr<EventFilter> const& filter)
 {
     std::lock_guard<std::mutex> lg(filter_guard);
-        
-    filters.insert(filters.begin(), filter);
+
+    auto updated = without_expired(*std::atomic_load(&filters));
+    updated.insert(updated.begin(), filter);
+    std::atomic_store(&filters, std::make_shared<Filters const>(std::move(updated)));
 }
 
 bool mi::EventFilterChainDispatcher::dispatch(std::shared_ptr<MirEvent const> const& event)
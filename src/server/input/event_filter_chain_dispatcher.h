@@ -48,9 +48,13 @@ public:
     void stop() override;
     
 private:
+    using Filters = std::vector<std::weak_ptr<EventFilter>>;
+
+    /// Serialises changes to the filters
     std::mutex filter_guard;
-    
-    std::vector<std::weak_ptr<EventFilter>> filters;
+
+    /// Only accessed through std::atomic_load() and std::atomic_store(), so events never wait on changes
+    std::shared_ptr<Filters const> filters;
     std::shared_ptr<InputDispatcher> const next_dispatcher;
 };
 
@@ -0,0 +1,330 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "resampling_dispatcher.h"
+
+#include "mir/events/event_builders.h"
+#include "mir/events/event.h"
+#include "mir/events/pointer_event.h"
+#include "mir/events/touch_event.h"
+#include "mir/lockable_callback.h"
+#include "mir/time/alarm.h"
+#include "mir/time/alarm_factory.h"
+
+#include <algorithm>
+
+namespace mi = mir::input;
+namespace mev = mir::events;
+
+using namespace std::chrono_literals;
+
+namespace
+{
+/// How far before the frame motion is sampled, so that it can usually be interpolated rather than extrapolated
+auto const resample_latency = 5ms;
+/// The furthest we guess ahead of the latest sample
+auto const max_extrapolation = 8ms;
+
+/// Runs the frame callback with the dispatcher's mutex held, preserving lock order against the alarm's own locks
+class FrameCallback : public mir::LockableCallback
+{
+public:
+    FrameCallback(std::mutex& mutex, std::function<void()> const& on_frame)
+        : mutex{mutex},
+          on_frame{on_frame}
+    {
+    }
+
+    void operator()() override { on_frame(); }
+    void lock() override { mutex.lock(); }
+    void unlock() override { mutex.unlock(); }
+
+private:
+    std::mutex& mutex;
+    std::function<void()> const on_frame;
+};
+
+auto event_time(MirEvent const& event) -> std::chrono::nanoseconds
+{
+    return event.to_input()->event_time();
+}
+
+/// Touch motion (every contact moving) or pointer motion (not scrolling) that can be delivered per frame
+auto is_motion(MirInputEvent const& event) -> bool
+{
+    switch (event.input_type())
+    {
+    case mir_input_event_type_touch:
+    {
+        auto const touch = event.to_touch();
+        for (size_t i = 0; i != touch->pointer_count(); ++i)
+        {
+            if (touch->action(i) != mir_touch_action_change)
+                return false;
+        }
+        return touch->pointer_count() > 0;
+    }
+
+    case mir_input_event_type_pointer:
+    {
+        auto const pointer = event.to_pointer();
+        return pointer->action() == mir_pointer_action_motion &&
+               pointer->vscroll() == 0.0f &&
+               pointer->hscroll() == 0.0f;
+    }
+
+    default:
+        return false;
+    }
+}
+
+/// Whether newer continues the motion of older (the same contacts, or buttons held)
+auto continues(MirEvent const& older, MirEvent const& newer) -> bool
+{
+    auto const old_input = older.to_input();
+    auto const new_input = newer.to_input();
+
+    if (old_input->input_type() != new_input->input_type())
+        return false;
+
+    if (new_input->input_type() == mir_input_event_type_pointer)
+        return old_input->to_pointer()->buttons() == new_input->to_pointer()->buttons();
+
+    auto const old_touch = old_input->to_touch();
+    auto const new_touch = new_input->to_touch();
+
+    if (old_touch->pointer_count() != new_touch->pointer_count())
+        return false;
+
+    for (size_t i = 0; i != new_touch->pointer_count(); ++i)
+    {
+        if (old_touch->id(i) != new_touch->id(i))
+            return false;
+    }
+
+    return true;
+}
+
+auto lerp(float from, float to, float alpha) -> float
+{
+    return from + (to - from) * alpha;
+}
+
+/// A copy of newest positioned at alpha along the way from older (0) to newest (1), or beyond
+auto interpolate(MirEvent const& older, MirEvent const& newest, float alpha, std::chrono::nanoseconds time)
+    -> mir::EventUPtr
+{
+    auto result = mev::clone_event(newest);
+    auto const input = result->to_input();
+    input->set_event_time(time);
+
+    if (input->input_type() == mir_input_event_type_pointer)
+    {
+        auto const from = older.to_input()->to_pointer();
+        auto const pointer = input->to_pointer();
+        pointer->set_x(lerp(from->x(), pointer->x(), alpha));
+        pointer->set_y(lerp(from->y(), pointer->y(), alpha));
+    }
+    else
+    {
+        auto const from = older.to_input()->to_touch();
+        auto const touch = input->to_touch();
+        for (size_t i = 0; i != touch->pointer_count(); ++i)
+        {
+            touch->set_x(i, lerp(from->x(i), touch->x(i), alpha));
+            touch->set_y(i, lerp(from->y(i), touch->y(i), alpha));
+        }
+    }
+
+    return result;
+}
+}
+
+mi::ResamplingDispatcher::ResamplingDispatcher(
+    std::shared_ptr<InputDispatcher> const& next_dispatcher,
+    std::shared_ptr<time::AlarmFactory> const& alarm_factory,
+    std::chrono::nanoseconds frame_interval) :
+    next_dispatcher{next_dispatcher},
+    frame_interval{frame_interval},
+    frame_alarm{alarm_factory->create_alarm(
+        std::make_unique<FrameCallback>(mutex, [this] { on_frame_locked(); }))}
+{
+}
+
+mi::ResamplingDispatcher::~ResamplingDispatcher() = default;
+
+bool mi::ResamplingDispatcher::dispatch(std::shared_ptr<MirEvent const> const& event)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    if (mir_event_get_type(event.get()) != mir_event_type_input)
+        return next_dispatcher->dispatch(event);
+
+    auto const input = event->to_input();
+    auto const id = input->device_id();
+    auto const motion = is_motion(*input);
+
+    if (motion)
+    {
+        auto const existing = motion_by_device.find(id);
+        if (existing != motion_by_device.end() && continues(*existing->second.samples.back(), *event))
+        {
+            auto& state = existing->second;
+            if (state.samples.size() == 2)
+                state.samples.erase(state.samples.begin());
+            state.samples.push_back(event);
+            state.newest_delivered = false;
+            if (input->input_type() == mir_input_event_type_pointer)
+            {
+                state.pending_dx += input->to_pointer()->dx();
+                state.pending_dy += input->to_pointer()->dy();
+            }
+
+            schedule_frame_locked();
+            return true;
+        }
+    }
+
+    flush_device_locked(id);
+
+    if (motion)
+    {
+        // The start of some new motion goes straight through, and is what we interpolate from
+        auto& state = motion_by_device[id];
+        state.samples.push_back(event);
+        state.newest_delivered = true;
+        state.last_delivered = event_time(*event);
+    }
+
+    return next_dispatcher->dispatch(event);
+}
+
+void mi::ResamplingDispatcher::start()
+{
+    next_dispatcher->start();
+}
+
+void mi::ResamplingDispatcher::stop()
+{
+    frame_alarm->cancel();
+
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        motion_by_device.clear();
+    }
+
+    next_dispatcher->stop();
+}
+
+void mi::ResamplingDispatcher::resample_for_frame(std::chrono::nanoseconds frame_time)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    resample_locked(frame_time);
+}
+
+void mi::ResamplingDispatcher::on_frame_locked()
+{
+    resample_locked(next_frame.time_since_epoch());
+
+    if (!motion_by_device.empty())
+        schedule_frame_locked();
+}
+
+void mi::ResamplingDispatcher::resample_locked(std::chrono::nanoseconds frame_time)
+{
+    auto const sample_time = frame_time - resample_latency;
+
+    for (auto i = motion_by_device.begin(); i != motion_by_device.end();)
+    {
+        auto& state = i->second;
+
+        if (state.newest_delivered)
+        {
+            // Nothing has moved since the last frame
+            i = motion_by_device.erase(i);
+            continue;
+        }
+
+        auto const& older = *state.samples.front();
+        auto const& newest = *state.samples.back();
+        auto const older_time = event_time(older);
+        auto const newest_time = event_time(newest);
+
+        auto time = std::max(sample_time, state.last_delivered);
+        float alpha = 1.0f;
+        if (newest_time > older_time)
+        {
+            auto const extrapolation = std::min<std::chrono::nanoseconds>(
+                (newest_time - older_time) / 2,
+                max_extrapolation);
+            time = std::clamp(time, older_time, newest_time + extrapolation);
+            alpha = float((time - older_time).count()) / (newest_time - older_time).count();
+        }
+        else
+        {
+            time = newest_time;
+        }
+
+        auto resampled = interpolate(older, newest, alpha, time);
+        if (resampled->to_input()->input_type() == mir_input_event_type_pointer)
+        {
+            resampled->to_input()->to_pointer()->set_dx(state.pending_dx);
+            resampled->to_input()->to_pointer()->set_dy(state.pending_dy);
+            state.pending_dx = state.pending_dy = 0;
+        }
+
+        state.newest_delivered = time >= newest_time;
+        state.last_delivered = time;
+        next_dispatcher->dispatch(std::move(resampled));
+
+        ++i;
+    }
+}
+
+void mi::ResamplingDispatcher::schedule_frame_locked()
+{
+    if (frame_alarm->state() == time::Alarm::pending)
+        return;
+
+    auto const now = std::chrono::steady_clock::now();
+    if (next_frame <= now)
+    {
+        next_frame += ((now - next_frame) / frame_interval + 1) * frame_interval;
+    }
+
+    frame_alarm->reschedule_for(next_frame);
+}
+
+void mi::ResamplingDispatcher::flush_device_locked(MirInputDeviceId id)
+{
+    auto const existing = motion_by_device.find(id);
+    if (existing == motion_by_device.end())
+        return;
+
+    auto& state = existing->second;
+    if (!state.newest_delivered)
+    {
+        auto latest = mev::clone_event(*state.samples.back());
+        if (latest->to_input()->input_type() == mir_input_event_type_pointer)
+        {
+            latest->to_input()->to_pointer()->set_dx(state.pending_dx);
+            latest->to_input()->to_pointer()->set_dy(state.pending_dy);
+        }
+        next_dispatcher->dispatch(std::move(latest));
+    }
+
+    motion_by_device.erase(existing);
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_INPUT_RESAMPLING_DISPATCHER_H_
+#define MIR_INPUT_RESAMPLING_DISPATCHER_H_
+
+#include "mir/input/input_dispatcher.h"
+#include "mir/time/types.h"
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace mir
+{
+namespace time
+{
+class AlarmFactory;
+class Alarm;
+}
+namespace input
+{
+/**
+ * Delivers touch and pointer motion once per frame instead of as it arrives
+ *
+ * Devices report at their own rate (often 120Hz or more), which beats against the display's refresh rate and
+ * makes drawing and scrolling judder. Motion is held back and, at each frame, one sample per device is
+ * interpolated (or briefly extrapolated) to just before the frame time. Everything else (contacts starting
+ * and ending, button presses, scrolling, keys...) is passed on immediately, after any motion it follows.
+ *
+ * Seat observers still see every raw event: this sits after the seat.
+ */
+class ResamplingDispatcher : public InputDispatcher
+{
+public:
+    ResamplingDispatcher(
+        std::shared_ptr<InputDispatcher> const& next_dispatcher,
+        std::shared_ptr<time::AlarmFactory> const& alarm_factory,
+        std::chrono::nanoseconds frame_interval);
+    ~ResamplingDispatcher();
+
+    // InputDispatcher
+    bool dispatch(std::shared_ptr<MirEvent const> const& event) override;
+    void start() override;
+    void stop() override;
+
+    /// Delivers the motion of each device as of frame_time (normally called by the frame alarm)
+    void resample_for_frame(std::chrono::nanoseconds frame_time);
+
+private:
+    struct DeviceMotion
+    {
+        /// The two most recent motion events, oldest first
+        std::vector<std::shared_ptr<MirEvent const>> samples;
+        bool newest_delivered{false};
+        std::chrono::nanoseconds last_delivered{0};
+        /// Relative pointer motion not yet delivered
+        float pending_dx{0}, pending_dy{0};
+    };
+
+    /// mutex must be locked by the caller of the *_locked() functions
+    void resample_locked(std::chrono::nanoseconds frame_time);
+    void schedule_frame_locked();
+    void flush_device_locked(MirInputDeviceId id);
+    void on_frame_locked();
+
+    std::shared_ptr<InputDispatcher> const next_dispatcher;
+    std::chrono::nanoseconds const frame_interval;
+
+    std::mutex mutex;
+    std::unordered_map<MirInputDeviceId, DeviceMotion> motion_by_device;
+    time::Timestamp next_frame;
+    std::unique_ptr<time::Alarm> const frame_alarm;
+};
+}
+}
+
+#endif // MIR_INPUT_RESAMPLING_DISPATCHER_H_
@@ -21,6 +21,7 @@
 #include "mir/input/device.h"
 #include "mir/input/cursor_listener.h"
 #include "mir/input/input_dispatcher.h"
+#include "mir/input/input_report.h"
 #include "mir/input/key_mapper.h"
 #include "mir/input/seat_observer.h"
 #include "mir/geometry/displacement.h"
@@ -46,9 +47,11 @@ mi::SeatInputDeviceTracker::SeatInputDeviceTracker(std::shared_ptr<InputDispatch
                                                    std::shared_ptr<CursorListener> const& cursor_listener,
                                                    std::shared_ptr<KeyMapper> const& key_mapper,
                                                    std::shared_ptr<time::Clock> const& clock,
-                                                   std::shared_ptr<SeatObserver> const& observer)
+                                                   std::shared_ptr<SeatObserver> const& observer,
+                                                   std::shared_ptr<InputReport> const& report)
     : dispatcher{dispatcher}, touch_visualizer{touch_visualizer}, cursor_listener{cursor_listener},
-      key_mapper{key_mapper}, clock{clock}, observer{observer}, buttons{0}
+      key_mapper{key_mapper}, clock{clock}, observer{observer}, report{report}, buttons{0},
+      regions{std::make_shared<Regions const>()}
 {
 }
 
@@ -91,26 +94,73 @@ void mi::SeatInputDeviceTracker::dispatch(std::shared_ptr<MirEvent> const& event
     {
         std::lock_guard<std::mutex> lock(device_state_mutex);
 
-        auto input_event = mir_event_get_input_event(event.get());
-
-        if (filter_input_event(input_event))
+        if (!prepare_input_event(*event))
             return;
+    }
 
-        update_seat_properties(input_event);
+    deliver(event);
+}
+
+void mi::SeatInputDeviceTracker::dispatch(std::vector<std::shared_ptr<MirEvent>> const& events)
+{
+    std::vector<std::shared_ptr<MirEvent>> accepted;
+    accepted.reserve(events.size());
 
-        key_mapper->map_event(*event);
+    {
+        std::lock_guard<std::mutex> lock(device_state_mutex);
 
-        if (mir_input_event_type_pointer == mir_input_event_get_type(input_event))
+        for (auto const& event : events)
         {
-            mev::set_cursor_position(*event, cursor_x, cursor_y);
-            mev::set_button_state(*event, buttons);
+            if (mir_event_get_type(event.get()) != mir_event_type_input || prepare_input_event(*event))
+                accepted.push_back(event);
         }
     }
 
-    dispatcher->dispatch(event);
+    for (auto const& event : accepted)
+        deliver(event);
+}
+
+void mi::SeatInputDeviceTracker::deliver(std::shared_ptr<MirEvent> const& event)
+{
+    auto const dispatched = dispatcher->dispatch(event);
+
+    if (mir_event_get_type(event.get()) == mir_event_type_input)
+    {
+        auto const event_time = mir_input_event_get_event_time(mir_event_get_input_event(event.get()));
+        if (dispatched)
+            report->event_reached_stage(InputReport::Stage::dispatcher, event_time);
+        else
+            report->event_dropped(InputReport::Stage::dispatcher, event_time);
+    }
+
     observer->seat_dispatch_event(event);
 }
 
+bool mi::SeatInputDeviceTracker::prepare_input_event(MirEvent& event)
+{
+    auto input_event = mir_event_get_input_event(&event);
+
+    if (filter_input_event(input_event))
+    {
+        report->event_dropped(InputReport::Stage::seat, mir_input_event_get_event_time(input_event));
+        return false;
+    }
+
+    report->event_reached_stage(InputReport::Stage::seat, mir_input_event_get_event_time(input_event));
+
+    update_seat_properties(input_event);
+
+    key_mapper->map_event(event);
+
+    if (mir_input_event_type_pointer == mir_input_event_get_type(input_event))
+    {
+        mev::set_cursor_position(event, cursor_x, cursor_y);
+        mev::set_button_state(event, buttons);
+    }
+
+    return true;
+}
+
 bool mi::SeatInputDeviceTracker::filter_input_event(MirInputEvent const* event)
 {
     auto device_id = mir_input_event_get_device_id(event);
@@ -197,49 +247,50 @@ void mi::SeatInputDeviceTracker::update_states()
                               end(device_data),
                               MirPointerButtons{0},
                               [](auto const& acc, auto const& item) { return acc | item.second.buttons; });
+    published_buttons = buttons;
 }
 
 mir::geometry::Point mi::SeatInputDeviceTracker::cursor_position() const
 {
-    std::lock_guard<std::mutex> lock(device_state_mutex);
-    return {cursor_x, cursor_y};
+    auto const cursor = published_cursor.load();
+    return {cursor.x, cursor.y};
 }
 
 MirPointerButtons mi::SeatInputDeviceTracker::button_state() const
 {
-    std::lock_guard<std::mutex> lock(device_state_mutex);
-    return buttons;
+    return published_buttons;
 }
 
-void mi::SeatInputDeviceTracker::set_confinement_regions(geometry::Rectangles const& regions)
+void mi::SeatInputDeviceTracker::update_regions(std::function<void(Regions&)> const& update)
 {
-    {
-        std::lock_guard<std::mutex> lg(region_mutex);
-        confined_region = regions;
-    }
-    observer->seat_set_confinement_region_called(regions);
+    std::lock_guard<std::mutex> lock(regions_update_mutex);
+    auto updated = std::make_shared<Regions>(*regions);
+    update(*updated);
+    std::atomic_store(&regions, std::shared_ptr<Regions const>{std::move(updated)});
+}
+
+void mi::SeatInputDeviceTracker::set_confinement_regions(geometry::Rectangles const& confinement)
+{
+    update_regions([&](Regions& updated) { updated.confinement = confinement; });
+    observer->seat_set_confinement_region_called(confinement);
 }
 
 void mi::SeatInputDeviceTracker::reset_confinement_regions()
 {
-    {
-        std::lock_guard<std::mutex> lg(region_mutex);
-        confined_region.clear();
-    }
+    update_regions([](Regions& updated) { updated.confinement.clear(); });
     observer->seat_reset_confinement_regions();
 }
 
 void mi::SeatInputDeviceTracker::update_outputs(geom::Rectangles const& output_regions)
 {
-    std::lock_guard<std::mutex> lg(output_mutex);
-    input_region = output_regions;
+    update_regions([&](Regions& updated) { updated.outputs = output_regions; });
 }
 
 void mi::SeatInputDeviceTracker::confine_function(mir::geometry::Point& p) const
 {
-    std::lock_guard<std::mutex> lg(region_mutex);
-    input_region.confine(p);
-    confined_region.confine(p);
+    auto const current = std::atomic_load(&regions);
+    current->outputs.confine(p);
+    current->confinement.confine(p);
 }
 
 void mi::SeatInputDeviceTracker::confine_pointer()
@@ -257,6 +308,7 @@ void mi::SeatInputDeviceTracker::update_cursor(MirPointerEvent const* event)
     cursor_y += mir_pointer_event_axis_value(event, mir_pointer_axis_relative_y);
 
     confine_pointer();
+    published_cursor = CursorState{cursor_x, cursor_y};
 
     cursor_listener->cursor_moved_to(cursor_x, cursor_y);
 }
@@ -360,6 +412,7 @@ void mi::SeatInputDeviceTracker::set_cursor_position(float x, float y)
         std::lock_guard<std::mutex> lock(device_state_mutex);
         cursor_x = x;
         cursor_y = y;
+        published_cursor = CursorState{x, y};
     }
 
     observer->seat_set_cursor_position(x, y);
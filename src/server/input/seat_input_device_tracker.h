@@ -28,9 +28,11 @@
 #include "mir_toolkit/event.h"
 
 #include <atomic>
+#include <functional>
 #include <unordered_map>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 namespace mir
 {
@@ -43,6 +45,7 @@ namespace input
 {
 class CursorListener;
 class InputDispatcher;
+class InputReport;
 class KeyMapper;
 class SeatObserver;
 
@@ -61,13 +64,16 @@ public:
                            std::shared_ptr<CursorListener> const& cursor_listener,
                            std::shared_ptr<KeyMapper> const& key_mapper,
                            std::shared_ptr<time::Clock> const& clock,
-                           std::shared_ptr<SeatObserver> const& observer);
+                           std::shared_ptr<SeatObserver> const& observer,
+                           std::shared_ptr<InputReport> const& report);
     void add_device(MirInputDeviceId);
     void remove_device(MirInputDeviceId);
     void add_pointing_device();
     void remove_pointing_device();
 
     void dispatch(std::shared_ptr<MirEvent> const& event);
+    /// Dispatches events in order, updating the seat state for all of them under a single lock
+    void dispatch(std::vector<std::shared_ptr<MirEvent>> const& events);
 
     MirPointerButtons button_state() const;
     geometry::Point cursor_position() const;
@@ -81,6 +87,10 @@ public:
 
     void update_outputs(geometry::Rectangles const& outputs);
 private:
+    /// Updates the seat from an input event and annotates it with the seat state; false if it should be dropped
+    bool prepare_input_event(MirEvent& event);
+    /// Passes the event to the dispatcher and observer, reporting whether the dispatcher took it
+    void deliver(std::shared_ptr<MirEvent> const& event);
     void update_seat_properties(MirInputEvent const* event);
     void update_cursor(MirPointerEvent const* event);
     void update_spots();
@@ -95,6 +105,7 @@ private:
     std::shared_ptr<KeyMapper> const key_mapper;
     std::shared_ptr<time::Clock> const clock;
     std::shared_ptr<SeatObserver> const observer;
+    std::shared_ptr<InputReport> const report;
 
     struct DeviceData
     {
@@ -120,13 +131,27 @@ private:
     MirPointerButtons buttons;
     std::unordered_map<MirInputDeviceId, DeviceData> device_data;
     std::vector<TouchVisualizer::Spot> spots;
-    mir::geometry::Rectangles confined_region;
 
     std::mutex mutable device_state_mutex;
-    std::mutex mutable region_mutex;
 
-    std::mutex mutable output_mutex;
-    geometry::Rectangles input_region;
+    /// Copies of the cursor state for readers on other threads, so they don't contend with event handling
+    struct CursorState
+    {
+        float x, y;
+    };
+    std::atomic<CursorState> published_cursor{CursorState{0.0f, 0.0f}};
+    std::atomic<MirPointerButtons> published_buttons{0};
+
+    /// The areas the cursor is kept within, replaced (never modified) so each event can read them without locking
+    struct Regions
+    {
+        geometry::Rectangles outputs;
+        geometry::Rectangles confinement;
+    };
+    void update_regions(std::function<void(Regions&)> const& update);
+
+    std::mutex regions_update_mutex;    ///< Serializes replacing regions
+    std::shared_ptr<Regions const> regions; ///< Read and written with std::atomic_load()/std::atomic_store()
 };
 
 }
@@ -59,6 +59,11 @@ public:
         return 1;
     }
 
+    bool tearing_allowed() const override
+    {
+        return false;
+    }
+
     mg::Renderable::ID id() const override
     {
         return this;
@@ -71,9 +76,15 @@ public:
     
     geom::Rectangle screen_position() const override
     {
+        std::lock_guard<std::mutex> lg(guard);
         return {position, buffer_->size()};
     }
 
+    geom::RectangleF src_bounds() const override
+    {
+        return {{}, geom::SizeF{buffer_->size()}};
+    }
+
     std::experimental::optional<geometry::Rectangle> clip_area() const override
     {
         return std::experimental::optional<geometry::Rectangle>();
@@ -94,18 +105,35 @@ public:
         return true;
     }
 
+    std::experimental::optional<geom::Rectangles> damage() const override
+    {
+        // Our buffer never changes
+        return geom::Rectangles{};
+    }
+
+    geom::Rectangles opaque_region() const override
+    {
+        return {};
+    }
+
 // TouchspotRenderable    
-    void move_center_to(geom::Point pos)
+    /// \returns whether the spot moved
+    bool move_center_to(geom::Point pos)
     {
         std::lock_guard<std::mutex> lg(guard);
-        position = pos - geom::Displacement{0.5*touchspot_image.width, 0.5*touchspot_image.height};
+        auto const new_position = pos - geom::Displacement{0.5*touchspot_image.width, 0.5*touchspot_image.height};
+        if (new_position == position)
+            return false;
+
+        position = new_position;
+        return true;
     }
 
     
 private:
     std::shared_ptr<mg::Buffer> const buffer_;
     
-    std::mutex guard;
+    std::mutex mutable guard;
     geom::Point position;
 };
 
@@ -128,9 +156,10 @@ mi::TouchspotController::TouchspotController(std::shared_ptr<mg::GraphicBufferAl
 void mi::TouchspotController::visualize_touches(std::vector<Spot> const& touches)
 {
     // The compositor is unable to track damage to the touchspot renderables via the SurfaceObserver
-    // interface as it does with application window surfaces. So if our last action is moving a spot
-    // we must ask the scene to emit a scene changed. In the case of adding or removing a visualiza-
-    // tion we expect the scene to handle this for us.
+    // interface as it does with application window surfaces. So if we moved a spot that was already
+    // shown we must ask the scene to emit a scene changed. In the case of adding or removing a visualiza-
+    // tion we expect the scene to handle this for us. Touch updates that don't move any spot (pressure
+    // changes, or contacts resting still) don't need a recomposite at all.
     bool must_update_scene = false;
 
     {
@@ -145,11 +174,11 @@ void mi::TouchspotController::visualize_touches(std::vector<Spot> const& touches
     {
         auto const& renderable = touchspot_renderables[i];
         
-        renderable->move_center_to(touches[i].touch_location);
+        auto const moved = renderable->move_center_to(touches[i].touch_location);
         if (i >= renderables_in_use)
             scene->add_input_visualization(renderable);
-        
-        must_update_scene = true;
+        else if (moved)
+            must_update_scene = true;
     }
     
     for (unsigned int i = num_touches; i < renderables_in_use; i++)
@@ -20,11 +20,23 @@
 #include "mir/options/configuration.h"
 
 #include "reports.h"
+#include "startup_compositor_report.h"
+#include "performance_hud.h"
 #include "lttng_report_factory.h"
 #include "logging_report_factory.h"
+#include "metrics_report_factory.h"
 #include "null_report_factory.h"
+#include "logging/compositor_statistics_report.h"
+#include "metrics/registry.h"
+#include "metrics/endpoint.h"
 
 #include "mir/abnormal_exit.h"
+#include "mir/startup_report.h"
+#include "mir/input/composite_event_filter.h"
+#include "mir/main_loop.h"
+
+#include <cstdlib>
+#include <unistd.h>
 
 namespace mg = mir::graphics;
 namespace mf = mir::frontend;
@@ -32,6 +44,16 @@ namespace mc = mir::compositor;
 namespace mi = mir::input;
 namespace ms = mir::scene;
 
+namespace
+{
+/// Only the compositor report can gather statistics
+char const* const statistics_opt_value = "stats";
+auto const statistics_report_interval = std::chrono::seconds{10};
+
+char const* const hud_hidden_opt_value = "hidden";
+char const* const hud_shown_opt_value = "shown";
+}
+
 std::unique_ptr<mir::report::ReportFactory> mir::DefaultServerConfiguration::report_factory(char const* report_opt)
 {
     auto opt = the_options()->get<std::string>(report_opt);
@@ -44,6 +66,10 @@ std::unique_ptr<mir::report::ReportFactory> mir::DefaultServerConfiguration::rep
     {
         return std::make_unique<report::LttngReportFactory>();
     }
+    else if (opt == options::metrics_opt_value)
+    {
+        return std::make_unique<report::MetricsReportFactory>(the_metrics_registry(), the_clock());
+    }
     else if (opt == options::off_opt_value)
     {
         return std::make_unique<report::NullReportFactory>();
@@ -52,10 +78,68 @@ std::unique_ptr<mir::report::ReportFactory> mir::DefaultServerConfiguration::rep
     {
         throw AbnormalExit(std::string("Invalid ") + report_opt + " option: " + opt + " (valid options are: \"" +
             options::off_opt_value + "\" and \"" + options::log_opt_value +
-                           "\" and \"" + options::lttng_opt_value + "\")");
+                           "\" and \"" + options::lttng_opt_value + "\" and \"" + options::metrics_opt_value + "\")");
     }
 }
 
+auto mir::DefaultServerConfiguration::the_metrics_registry() -> std::shared_ptr<report::metrics::Registry>
+{
+    return metrics_registry(
+        [this]() -> std::shared_ptr<report::metrics::Registry>
+        {
+            auto socket_path = the_options()->get<std::string>(options::metrics_socket_opt);
+            if (socket_path.empty())
+            {
+                auto const runtime_dir = getenv("XDG_RUNTIME_DIR");
+                socket_path = std::string{runtime_dir ? runtime_dir : "/tmp"} + "/mir-metrics-" + std::to_string(getpid());
+            }
+
+            auto const registry = std::make_shared<report::metrics::Registry>();
+            auto const endpoint = std::make_shared<report::metrics::Endpoint>(registry, socket_path);
+
+            // The endpoint serves for as long as any report maintains metrics
+            return {registry.get(), [registry, endpoint](report::metrics::Registry*) {}};
+        });
+}
+
+auto mir::DefaultServerConfiguration::the_performance_hud() -> std::shared_ptr<report::PerformanceHud>
+{
+    return performance_hud(
+        [this]() -> std::shared_ptr<report::PerformanceHud>
+        {
+            auto const opt = the_options()->get<std::string>(options::performance_hud_opt);
+            if (opt == options::off_opt_value)
+                return {};
+
+            if (opt != hud_hidden_opt_value && opt != hud_shown_opt_value)
+            {
+                throw AbnormalExit(std::string("Invalid ") + options::performance_hud_opt + " option: " + opt +
+                    " (valid options are: \"" + options::off_opt_value + "\" and \"" + hud_hidden_opt_value +
+                    "\" and \"" + hud_shown_opt_value + "\")");
+            }
+
+            return std::make_shared<report::PerformanceHud>(the_clock());
+        });
+}
+
+auto mir::DefaultServerConfiguration::performance_hud_overlay() -> std::shared_ptr<void>
+{
+    auto const hud = the_performance_hud();
+    if (!hud)
+        return {};
+
+    auto const overlay = std::make_shared<report::PerformanceHudOverlay>(
+        hud,
+        the_input_scene(),
+        the_buffer_allocator(),
+        *the_main_loop(),
+        the_options()->get<std::string>(options::performance_hud_opt) == hud_shown_opt_value);
+
+    // The filter chain only holds the overlay weakly, so it stops toggling when we're let go of
+    the_composite_event_filter()->prepend(overlay);
+    return overlay;
+}
+
 std::shared_ptr<void> mir::DefaultServerConfiguration::default_reports()
 {
     return std::make_unique<report::Reports>(*this, *the_options());
@@ -66,7 +150,21 @@ auto mir::DefaultServerConfiguration::the_compositor_report() -> std::shared_ptr
     return compositor_report(
         [this]()->std::shared_ptr<mc::CompositorReport>
         {
-            return report_factory(options::compositor_report_opt)->create_compositor_report();
+            std::shared_ptr<mc::CompositorReport> wrapped;
+            if (the_options()->get<std::string>(options::compositor_report_opt) == statistics_opt_value)
+            {
+                wrapped = std::make_shared<report::logging::CompositorStatisticsReport>(
+                    the_logger(), the_clock(), statistics_report_interval);
+            }
+            else
+            {
+                wrapped = report_factory(options::compositor_report_opt)->create_compositor_report();
+            }
+
+            if (auto const hud = the_performance_hud())
+                wrapped = hud->compositor_report(wrapped);
+
+            return std::make_shared<report::StartupCompositorReport>(wrapped, the_startup_report());
         });
 }
 
@@ -93,7 +191,10 @@ auto mir::DefaultServerConfiguration::the_display_report() -> std::shared_ptr<mg
     return display_report(
         [this]()->std::shared_ptr<mg::DisplayReport>
         {
-            return report_factory(options::display_report_opt)->create_display_report();
+            auto const report = report_factory(options::display_report_opt)->create_display_report();
+            if (auto const hud = the_performance_hud())
+                return hud->display_report(report);
+            return report;
         });
 }
 
@@ -133,3 +234,11 @@ auto mir::DefaultServerConfiguration::the_shell_report() -> std::shared_ptr<shel
         });
 }
 
+auto mir::DefaultServerConfiguration::the_startup_report() -> std::shared_ptr<StartupReport>
+{
+    return startup_report(
+        [this]()->std::shared_ptr<StartupReport>
+        {
+            return report_factory(options::startup_report_opt)->create_startup_report();
+        });
+}
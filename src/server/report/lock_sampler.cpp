@@ -0,0 +1,56 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "lock_sampler.h"
+
+#include "mir/lock_profile.h"
+#include "mir/lock_report.h"
+#include "mir/time/alarm.h"
+#include "mir/time/alarm_factory.h"
+
+#include <vector>
+
+namespace mr = mir::report;
+
+mr::LockSampler::LockSampler(
+    time::AlarmFactory& alarm_factory,
+    std::chrono::milliseconds interval,
+    std::shared_ptr<LockReport> const& report) :
+    interval{interval},
+    report{report},
+    alarm{alarm_factory.create_alarm([this] { sample(); alarm->reschedule_in(this->interval); })}
+{
+    LockProfile::enable(true);
+    alarm->reschedule_in(interval);
+}
+
+mr::LockSampler::~LockSampler()
+{
+    alarm->cancel();
+    LockProfile::enable(false);
+}
+
+void mr::LockSampler::sample()
+{
+    std::vector<LockReport::Lock> locks;
+    for_each_lock_profile(
+        [&](LockProfile const& profile)
+        {
+            locks.push_back({profile.name, profile.totals()});
+        });
+
+    report->locks_sampled(locks);
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_REPORT_LOCK_SAMPLER_H_
+#define MIR_REPORT_LOCK_SAMPLER_H_
+
+#include <chrono>
+#include <memory>
+
+namespace mir
+{
+class LockReport;
+namespace time
+{
+class Alarm;
+class AlarmFactory;
+}
+namespace report
+{
+/// Enables lock profiling while it exists, and samples every LockProfile each \a interval for a LockReport
+class LockSampler
+{
+public:
+    LockSampler(
+        time::AlarmFactory& alarm_factory,
+        std::chrono::milliseconds interval,
+        std::shared_ptr<LockReport> const& report);
+    ~LockSampler();
+
+    void sample();
+
+private:
+    LockSampler(LockSampler const&) = delete;
+    LockSampler& operator=(LockSampler const&) = delete;
+
+    std::chrono::milliseconds const interval;
+    std::shared_ptr<LockReport> const report;
+    std::unique_ptr<time::Alarm> const alarm;
+};
+}
+}
+
+#endif // MIR_REPORT_LOCK_SAMPLER_H_
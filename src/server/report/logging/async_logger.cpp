@@ -0,0 +1,404 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "async_logger.h"
+#include "mir/thread_name.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+
+namespace ml = mir::logging;
+namespace mrl = mir::report::logging;
+
+namespace
+{
+unsigned const ring_size = 64;
+size_t const text_size = 1000;
+auto const write_interval = std::chrono::milliseconds{20};
+
+std::atomic<uint64_t> next_logger_id{1};
+
+char const* const severity_labels[5] =
+{
+    "< CRITICAL! > ",
+    "< - ERROR - > ",
+    "< -warning- > ",
+    "<information> ",
+    "< - debug - > "
+};
+
+void write_all(int fd, std::string const& text)
+{
+    auto data = text.data();
+    auto remaining = text.size();
+
+    while (remaining)
+    {
+        auto const written = ::write(fd, data, remaining);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return; // There's nowhere left to report the failure
+        }
+        data += written;
+        remaining -= written;
+    }
+}
+
+/// Marks a message cut short to fit by replacing its end with "..."
+void mark_truncated(char* end)
+{
+    memcpy(end - 3, "...", 3);
+}
+}
+
+/// Written by one logging thread, read by the writing thread
+class mrl::AsyncLogger::Ring
+{
+public:
+    struct Entry
+    {
+        timespec time;
+        ml::Severity severity;
+        uint16_t component_length;
+        uint16_t message_length;
+        char text[text_size];   ///< The component followed by the message
+    };
+
+    /// Returns the entry to fill (then publish()), or nullptr if it must be dropped
+    auto next_entry(int max_rate, timespec const& now) -> Entry*
+    {
+        if (max_rate)
+        {
+            if (now.tv_sec != rate_second)
+            {
+                rate_second = now.tv_sec;
+                rate_count = 0;
+            }
+            if (++rate_count > max_rate)
+            {
+                rate_limited.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+        }
+
+        auto const h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == ring_size)
+        {
+            ring_full.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        auto const entry = &entries[h % ring_size];
+        entry->time = now;
+        return entry;
+    }
+
+    /// Makes the entry returned by next_entry() visible to the writer; returns whether the ring is filling up
+    auto publish() -> bool
+    {
+        auto const h = head.load(std::memory_order_relaxed) + 1;
+        head.store(h, std::memory_order_release);
+        return h - tail.load(std::memory_order_relaxed) >= ring_size / 2;
+    }
+
+    std::atomic<uint32_t> head{0};
+    std::atomic<uint32_t> tail{0};
+    std::atomic<uint64_t> ring_full{0};
+    std::atomic<uint64_t> rate_limited{0};
+    Entry entries[ring_size];
+
+private:
+    time_t rate_second{0};
+    int rate_count{0};
+};
+
+mrl::AsyncLogger::AsyncLogger(int max_rate, int out_fd, int err_fd) :
+    max_rate{std::max(0, max_rate)},
+    out_fd{out_fd},
+    err_fd{err_fd},
+    id{next_logger_id++},
+    writer{[this]
+        {
+            mir::set_thread_name("Mir/Logger");
+            write_loop();
+        }}
+{
+}
+
+mrl::AsyncLogger::~AsyncLogger()
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        stopping = true;
+    }
+    wake.notify_one();
+    writer.join();
+}
+
+void mrl::AsyncLogger::log(ml::Severity severity, std::string const& message, std::string const& component)
+{
+    timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    auto& ring = this_thread_ring();
+    auto const entry = ring.next_entry(max_rate, now);
+    if (!entry)
+        return;
+
+    entry->severity = severity;
+    entry->component_length = std::min(component.size(), text_size / 4);
+    memcpy(entry->text, component.data(), entry->component_length);
+
+    auto const space = text_size - entry->component_length;
+    entry->message_length = std::min(message.size(), space);
+    memcpy(entry->text + entry->component_length, message.data(), entry->message_length);
+    if (message.size() > space)
+        mark_truncated(entry->text + text_size);
+
+    if (ring.publish())
+    {
+        write_requested = true;
+        wake.notify_one();
+    }
+}
+
+void mrl::AsyncLogger::log(char const* component, ml::Severity severity, char const* format, ...)
+{
+    timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    auto& ring = this_thread_ring();
+    auto const entry = ring.next_entry(max_rate, now);
+    if (!entry)
+        return;
+
+    entry->severity = severity;
+    entry->component_length = strnlen(component, text_size / 4);
+    memcpy(entry->text, component, entry->component_length);
+
+    // Format straight into the ring: vsnprintf() needs room for a '\0' we don't keep
+    auto const space = text_size - entry->component_length;
+    va_list va;
+    va_start(va, format);
+    auto const length = vsnprintf(entry->text + entry->component_length, space, format, va);
+    va_end(va);
+
+    if (length < 0)
+    {
+        entry->message_length = 0;
+    }
+    else if (static_cast<size_t>(length) >= space)
+    {
+        entry->message_length = space - 1;
+        mark_truncated(entry->text + text_size - 1);
+    }
+    else
+    {
+        entry->message_length = length;
+    }
+
+    if (ring.publish())
+    {
+        write_requested = true;
+        wake.notify_one();
+    }
+}
+
+auto mrl::AsyncLogger::dropped() const -> Dropped
+{
+    std::lock_guard<std::mutex> lock{rings_mutex};
+
+    auto result = retired_drops;
+    for (auto const& ring : rings)
+    {
+        result.ring_full += ring->ring_full.load(std::memory_order_relaxed);
+        result.rate_limited += ring->rate_limited.load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+void mrl::AsyncLogger::flush()
+{
+    std::unique_lock<std::mutex> lock{mutex};
+    auto const ticket = ++flush_requests;
+    wake.notify_one();
+    flushed.wait(lock, [&] { return flushes_done >= ticket; });
+}
+
+auto mrl::AsyncLogger::this_thread_ring() -> Ring&
+{
+    // The ring of the logger the current thread last logged to
+    thread_local struct
+    {
+        uint64_t logger_id;
+        std::shared_ptr<Ring> ring;
+    } current_ring{0, nullptr};
+
+    if (current_ring.logger_id != id)
+    {
+        auto ring = std::make_shared<Ring>();
+        {
+            std::lock_guard<std::mutex> lock{rings_mutex};
+            rings.push_back(ring);
+        }
+        current_ring = {id, std::move(ring)};
+    }
+
+    return *current_ring.ring;
+}
+
+void mrl::AsyncLogger::write_loop()
+{
+    std::unique_lock<std::mutex> lock{mutex};
+
+    while (!stopping)
+    {
+        // Logging threads don't take the mutex to request a write, so don't rely on seeing their notification
+        wake.wait_for(lock, write_interval,
+            [this] { return stopping || write_requested || flush_requests != flushes_done; });
+
+        auto const requests = flush_requests;
+        write_requested = false;
+
+        lock.unlock();
+        write_pending();
+        lock.lock();
+
+        flushes_done = requests;
+        flushed.notify_all();
+    }
+
+    lock.unlock();
+    write_pending();
+}
+
+void mrl::AsyncLogger::write_pending()
+{
+    struct Pending
+    {
+        Ring::Entry const* entry;
+        unsigned ring;
+    };
+
+    std::vector<std::shared_ptr<Ring>> snapshot;
+    Dropped drops;
+    {
+        std::lock_guard<std::mutex> lock{rings_mutex};
+        snapshot = rings;
+        drops = retired_drops;
+    }
+
+    std::vector<Pending> pending;
+    std::vector<uint32_t> heads(snapshot.size());
+
+    for (unsigned i = 0; i != snapshot.size(); ++i)
+    {
+        auto& ring = *snapshot[i];
+        heads[i] = ring.head.load(std::memory_order_acquire);
+        for (auto t = ring.tail.load(std::memory_order_relaxed); t != heads[i]; ++t)
+            pending.push_back({&ring.entries[t % ring_size], i});
+
+        drops.ring_full += ring.ring_full.load(std::memory_order_relaxed);
+        drops.rate_limited += ring.rate_limited.load(std::memory_order_relaxed);
+    }
+
+    // Each ring is in time order already, so a stable sort keeps each thread's messages in sequence
+    std::stable_sort(pending.begin(), pending.end(), [](Pending const& a, Pending const& b)
+        {
+            return a.entry->time.tv_sec < b.entry->time.tv_sec ||
+                (a.entry->time.tv_sec == b.entry->time.tv_sec && a.entry->time.tv_nsec < b.entry->time.tv_nsec);
+        });
+
+    std::string out;
+    std::string err;
+    time_t formatted_second = -1;
+    char date[24] = "";
+
+    auto const append_line = [&](
+        std::string& to, timespec const& time, ml::Severity severity,
+        char const* component, size_t component_length, char const* message, size_t message_length)
+        {
+            // Formatting the date is relatively expensive, and many lines share one
+            if (time.tv_sec != formatted_second)
+            {
+                tm local;
+                localtime_r(&time.tv_sec, &local);
+                strftime(date, sizeof(date), "%F %T", &local);
+                formatted_second = time.tv_sec;
+            }
+            char usec[8];
+            snprintf(usec, sizeof(usec), ".%06ld", time.tv_nsec / 1000);
+
+            to.append("[").append(date).append(usec).append("] ")
+                .append(severity_labels[static_cast<int>(severity)])
+                .append(component, component_length)
+                .append(": ")
+                .append(message, message_length)
+                .append("\n");
+        };
+
+    for (auto const& p : pending)
+    {
+        auto const& entry = *p.entry;
+        append_line(
+            entry.severity < ml::Severity::informational ? err : out,
+            entry.time, entry.severity,
+            entry.text, entry.component_length,
+            entry.text + entry.component_length, entry.message_length);
+    }
+
+    // The entries have been copied out, so the logging threads can reuse them
+    for (unsigned i = 0; i != snapshot.size(); ++i)
+        snapshot[i]->tail.store(heads[i], std::memory_order_release);
+
+    if (drops.ring_full != reported_drops.ring_full || drops.rate_limited != reported_drops.rate_limited)
+    {
+        timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        auto const message =
+            std::to_string(drops.ring_full - reported_drops.ring_full) + " messages dropped (logging too fast), " +
+            std::to_string(drops.rate_limited - reported_drops.rate_limited) + " messages dropped (rate limited)";
+        append_line(err, now, ml::Severity::warning, "logging", 7, message.data(), message.size());
+        reported_drops = drops;
+    }
+
+    write_all(out_fd, out);
+    write_all(err_fd, err);
+
+    // Retire the rings of threads that have finished (or moved on to another logger) once they're drained
+    snapshot.clear();
+    std::lock_guard<std::mutex> lock{rings_mutex};
+    rings.erase(
+        std::remove_if(rings.begin(), rings.end(), [this](std::shared_ptr<Ring> const& ring)
+            {
+                if (ring.use_count() != 1 ||
+                    ring->head.load(std::memory_order_acquire) != ring->tail.load(std::memory_order_relaxed))
+                {
+                    return false;
+                }
+                retired_drops.ring_full += ring->ring_full.load(std::memory_order_relaxed);
+                retired_drops.rate_limited += ring->rate_limited.load(std::memory_order_relaxed);
+                return true;
+            }),
+        rings.end());
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_REPORT_LOGGING_ASYNC_LOGGER_H_
+#define MIR_REPORT_LOGGING_ASYNC_LOGGER_H_
+
+#include "mir/logging/logger.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+namespace mir
+{
+namespace report
+{
+namespace logging
+{
+/**
+ * A Logger that writes from a thread of its own, so that logging barely affects the threads doing it
+ *
+ * Each logging thread has a lock-free ring of fixed size entries, which the messages (truncated if need be) are
+ * copied into with the time they were logged. The writing thread merges the rings in time order and writes them
+ * in the same format as DumbConsoleLogger. Messages are dropped, and counted, rather than block a thread whose
+ * ring is full or that exceeds the rate limit; the writing thread logs how many.
+ */
+class AsyncLogger : public mir::logging::Logger
+{
+public:
+    /// \param max_rate The messages per second each thread may log, or 0 for no limit
+    explicit AsyncLogger(int max_rate = 0, int out_fd = STDOUT_FILENO, int err_fd = STDERR_FILENO);
+    /// Writes whatever is still queued
+    ~AsyncLogger();
+
+    void log(mir::logging::Severity severity, std::string const& message, std::string const& component) override;
+    void log(char const* component, mir::logging::Severity severity, char const* format, ...) override
+        __attribute__ ((format (printf, 4, 5)));
+
+    struct Dropped
+    {
+        uint64_t ring_full;
+        uint64_t rate_limited;
+    };
+    auto dropped() const -> Dropped;
+
+    /// Waits until everything logged (on any thread) before the call has been written
+    void flush();
+
+private:
+    class Ring;
+
+    auto this_thread_ring() -> Ring&;
+    void write_loop();
+    void write_pending();
+
+    int const max_rate;
+    int const out_fd;
+    int const err_fd;
+    uint64_t const id;
+
+    mutable std::mutex rings_mutex;
+    std::vector<std::shared_ptr<Ring>> rings;
+    /// Drops by threads that have exited
+    Dropped retired_drops{0, 0};
+    /// Only used by the writing thread
+    Dropped reported_drops{0, 0};
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable flushed;
+    std::atomic<bool> write_requested{false};
+    uint64_t flush_requests{0};
+    uint64_t flushes_done{0};
+    bool stopping{false};
+
+    std::thread writer;
+};
+}
+}
+}
+
+#endif // MIR_REPORT_LOGGING_ASYNC_LOGGER_H_
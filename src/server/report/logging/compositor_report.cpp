@@ -74,6 +74,14 @@ void mrl::CompositorReport::rendered_frame(SubCompositorId id)
     inst.bypassed = false;
 }
 
+void mrl::CompositorReport::measured_gpu_render_time(SubCompositorId id, std::chrono::nanoseconds gpu_time)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& inst = instance[id];
+    inst.gpu_time_sum += gpu_time;
+    inst.ngpu_times++;
+}
+
 void mrl::CompositorReport::Instance::log(ml::Logger& logger, SubCompositorId id)
 {
     // The first report is a valid sample, but don't log anything because
@@ -103,12 +111,25 @@ void mrl::CompositorReport::Instance::log(ml::Logger& logger, SubCompositorId id
         long avg_latency_usec = dn ? dl / dn : 0;
         long dt_msec = dt / 1000L;
 
-        char msg[128];
+        // GPU times are only measured by some renderers, and only for some frames
+        auto const dg = ngpu_times - last_reported_ngpu_times;
+        char gpu_time[32] = "";
+        if (dg > 0)
+        {
+            long const avg_gpu_time_usec =
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    gpu_time_sum - last_reported_gpu_time_sum).count() / dg;
+            snprintf(gpu_time, sizeof gpu_time, ", GPU %ld.%03ld ms/frame",
+                     avg_gpu_time_usec / 1000,
+                     avg_gpu_time_usec % 1000);
+        }
+
+        char msg[192];
         snprintf(msg, sizeof msg, "Display %p averaged %ld.%03ld FPS, "
                  "%ld.%03ld ms/frame, "
                  "latency %ld.%03ld ms, "
                  "%ld frames over %ld.%03ld sec, "
-                 "%ld%% bypassed",
+                 "%ld%% bypassed%s",
                  id,
                  frames_per_1000sec / 1000,
                  frames_per_1000sec % 1000,
@@ -119,7 +140,8 @@ void mrl::CompositorReport::Instance::log(ml::Logger& logger, SubCompositorId id
                  dn,
                  dt_msec / 1000,
                  dt_msec % 1000,
-                 bypass_percent
+                 bypass_percent,
+                 gpu_time
                  );
 
         logger.log(ml::Severity::informational, msg, component);
@@ -128,6 +150,8 @@ void mrl::CompositorReport::Instance::log(ml::Logger& logger, SubCompositorId id
     last_reported_total_time_sum = total_time_sum;
     last_reported_render_time_sum = render_time_sum;
     last_reported_latency_sum = latency_sum;
+    last_reported_gpu_time_sum = gpu_time_sum;
+    last_reported_ngpu_times = ngpu_times;
     last_reported_nframes = nframes;
     last_reported_bypassed = nbypassed;
 }
@@ -46,6 +46,7 @@ public:
     void began_frame(SubCompositorId id) override;
     void renderables_in_frame(SubCompositorId id, graphics::RenderableList const& renderables) override;
     void rendered_frame(SubCompositorId id) override;
+    void measured_gpu_render_time(SubCompositorId id, std::chrono::nanoseconds gpu_time) override;
     void finished_frame(SubCompositorId id) override;
     void started() override;
     void stopped() override;
@@ -65,6 +66,8 @@ private:
         TimePoint total_time_sum;
         TimePoint render_time_sum;
         TimePoint latency_sum;
+        std::chrono::nanoseconds gpu_time_sum{0};
+        long ngpu_times = 0;
         long nframes = 0;
         long nbypassed = 0;
         bool bypassed = true;
@@ -73,6 +76,8 @@ private:
         TimePoint last_reported_total_time_sum;
         TimePoint last_reported_render_time_sum;
         TimePoint last_reported_latency_sum;
+        std::chrono::nanoseconds last_reported_gpu_time_sum{0};
+        long last_reported_ngpu_times = 0;
         long last_reported_nframes = 0;
         long last_reported_bypassed = 0;
 
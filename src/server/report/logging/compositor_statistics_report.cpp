@@ -0,0 +1,191 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "compositor_statistics_report.h"
+#include "mir/logging/logger.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+namespace ml = mir::logging;
+namespace mrl = mir::report::logging;
+
+namespace
+{
+char const* const component = "compositor";
+
+/// Formats the 50th, 95th and 99th percentiles in milliseconds
+auto percentiles(mrl::DurationHistogram const& histogram) -> std::string
+{
+    char buffer[64];
+    auto const p50 = histogram.percentile(50).count();
+    auto const p95 = histogram.percentile(95).count();
+    auto const p99 = histogram.percentile(99).count();
+    snprintf(buffer, sizeof buffer, "%ld.%ld/%ld.%ld/%ld.%ld",
+             static_cast<long>(p50 / 1000), static_cast<long>(p50 % 1000 / 100),
+             static_cast<long>(p95 / 1000), static_cast<long>(p95 % 1000 / 100),
+             static_cast<long>(p99 / 1000), static_cast<long>(p99 % 1000 / 100));
+    return buffer;
+}
+}
+
+void mrl::DurationHistogram::add(std::chrono::nanoseconds duration)
+{
+    auto const bucket = duration < duration.zero() ? 0 : duration / bucket_width;
+    buckets[std::min<size_t>(bucket, bucket_count - 1)]++;
+    total++;
+}
+
+auto mrl::DurationHistogram::percentile(int percent) const -> std::chrono::microseconds
+{
+    if (total == 0)
+        return std::chrono::microseconds::zero();
+
+    // The smallest number of samples that covers the requested percentage
+    long const rank = (total * percent + 99) / 100;
+
+    long seen = 0;
+    for (size_t i = 0; i != bucket_count; ++i)
+    {
+        seen += buckets[i];
+        if (seen >= rank)
+            return static_cast<long>(i + 1) * bucket_width;
+    }
+
+    return static_cast<long>(bucket_count) * bucket_width;
+}
+
+mrl::CompositorStatisticsReport::CompositorStatisticsReport(
+    std::shared_ptr<ml::Logger> const& logger,
+    std::shared_ptr<time::Clock> const& clock,
+    std::chrono::seconds report_interval)
+    : logger{logger},
+      clock{clock},
+      report_interval{report_interval},
+      last_report{clock->now()}
+{
+}
+
+void mrl::CompositorStatisticsReport::added_display(int width, int height, int x, int y, SubCompositorId id)
+{
+    char msg[128];
+    snprintf(msg, sizeof msg, "Added display %p: %dx%d %+d%+d",
+             id, width, height, x, y);
+    logger->log(ml::Severity::informational, msg, component);
+}
+
+void mrl::CompositorStatisticsReport::began_frame(SubCompositorId id)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& inst = instance[id];
+
+    auto const t = clock->now();
+    inst.start_of_frame = t;
+    inst.statistics.latency.add(t - last_scheduled);
+}
+
+void mrl::CompositorStatisticsReport::renderables_in_frame(SubCompositorId, graphics::RenderableList const&)
+{
+}
+
+void mrl::CompositorStatisticsReport::rendered_frame(SubCompositorId id)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& inst = instance[id];
+    inst.statistics.render_time.add(clock->now() - inst.start_of_frame);
+}
+
+void mrl::CompositorStatisticsReport::measured_gpu_render_time(SubCompositorId id, std::chrono::nanoseconds gpu_time)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    instance[id].statistics.gpu_time.add(gpu_time);
+}
+
+void mrl::CompositorStatisticsReport::finished_frame(SubCompositorId id)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& inst = instance[id];
+
+    auto const t = clock->now();
+    inst.statistics.frame_time.add(t - inst.start_of_frame);
+    if (inst.end_of_frame)
+        inst.statistics.frame_interval.add(t - inst.end_of_frame.value());
+    inst.end_of_frame = t;
+
+    if (t - last_report >= report_interval)
+    {
+        last_report = t;
+
+        for (auto& i : instance)
+        {
+            log(i.first, i.second.statistics);
+            i.second.statistics = Statistics{};
+        }
+    }
+}
+
+void mrl::CompositorStatisticsReport::started()
+{
+    logger->log(ml::Severity::informational, "Started", component);
+}
+
+void mrl::CompositorStatisticsReport::stopped()
+{
+    logger->log(ml::Severity::informational, "Stopped", component);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    instance.clear();
+}
+
+void mrl::CompositorStatisticsReport::scheduled()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    last_scheduled = clock->now();
+}
+
+auto mrl::CompositorStatisticsReport::statistics() const -> std::unordered_map<SubCompositorId, Statistics>
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::unordered_map<SubCompositorId, Statistics> result;
+    for (auto const& i : instance)
+        result.emplace(i.first, i.second.statistics);
+    return result;
+}
+
+void mrl::CompositorStatisticsReport::log(SubCompositorId id, Statistics const& statistics) const
+{
+    if (statistics.frame_time.count() == 0)
+        return;
+
+    auto const gpu_time = statistics.gpu_time.count() ?
+        ", GPU " + percentiles(statistics.gpu_time) : std::string{};
+
+    char msg[256];
+    snprintf(msg, sizeof msg, "Display %p: %ld frames (%ld rendered), "
+             "p50/p95/p99 ms: interval %s, frame %s, render %s, latency %s%s",
+             id,
+             statistics.frame_time.count(),
+             statistics.render_time.count(),
+             percentiles(statistics.frame_interval).c_str(),
+             percentiles(statistics.frame_time).c_str(),
+             percentiles(statistics.render_time).c_str(),
+             percentiles(statistics.latency).c_str(),
+             gpu_time.c_str());
+
+    logger->log(ml::Severity::informational, msg, component);
+}
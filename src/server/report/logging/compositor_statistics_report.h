@@ -0,0 +1,122 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_REPORT_LOGGING_COMPOSITOR_STATISTICS_REPORT_H_
+#define MIR_REPORT_LOGGING_COMPOSITOR_STATISTICS_REPORT_H_
+
+#include "mir/compositor/compositor_report.h"
+#include "mir/time/clock.h"
+
+#include <array>
+#include <chrono>
+#include <experimental/optional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace mir
+{
+namespace logging
+{
+class Logger;
+}
+namespace report
+{
+namespace logging
+{
+
+/// Counts durations in 0.1ms buckets, up to 100ms
+class DurationHistogram
+{
+public:
+    void add(std::chrono::nanoseconds duration);
+
+    /// The duration that \a percent percent of those added were no longer than, to bucket precision
+    auto percentile(int percent) const -> std::chrono::microseconds;
+    auto count() const -> long { return total; }
+
+private:
+    static constexpr std::chrono::microseconds bucket_width{100};
+    static constexpr size_t bucket_count{1000};     ///< The last bucket also takes everything longer
+
+    std::array<long, bucket_count> buckets{};
+    long total{0};
+};
+
+/**
+ * Keeps histograms of each display's frame timing, and logs their
+ * percentiles at regular intervals.
+ *
+ * Unlike CompositorReport this shows the spread of frame times, so
+ * occasional janky frames don't vanish into an average.
+ */
+class CompositorStatisticsReport : public mir::compositor::CompositorReport
+{
+public:
+    CompositorStatisticsReport(
+        std::shared_ptr<mir::logging::Logger> const& logger,
+        std::shared_ptr<time::Clock> const& clock,
+        std::chrono::seconds report_interval);
+
+    void added_display(int width, int height, int x, int y, SubCompositorId id) override;
+    void began_frame(SubCompositorId id) override;
+    void renderables_in_frame(SubCompositorId id, graphics::RenderableList const& renderables) override;
+    void rendered_frame(SubCompositorId id) override;
+    void measured_gpu_render_time(SubCompositorId id, std::chrono::nanoseconds gpu_time) override;
+    void finished_frame(SubCompositorId id) override;
+    void started() override;
+    void stopped() override;
+    void scheduled() override;
+
+    struct Statistics
+    {
+        DurationHistogram latency;          ///< From scheduling compositing to starting the frame
+        DurationHistogram render_time;      ///< From starting the frame to finishing rendering (if not bypassed)
+        DurationHistogram frame_time;       ///< From starting the frame to finishing it
+        DurationHistogram frame_interval;   ///< Between finishing successive frames, including the wait for the display
+        DurationHistogram gpu_time;         ///< GPU time of rendered frames (if the renderer measures it)
+    };
+
+    /// What has been gathered for each display since it was last logged
+    auto statistics() const -> std::unordered_map<SubCompositorId, Statistics>;
+
+private:
+    using TimePoint = time::Timestamp;
+
+    struct Instance
+    {
+        TimePoint start_of_frame;
+        std::experimental::optional<TimePoint> end_of_frame;
+        Statistics statistics;
+    };
+
+    void log(SubCompositorId id, Statistics const& statistics) const;
+
+    std::shared_ptr<mir::logging::Logger> const logger;
+    std::shared_ptr<time::Clock> const clock;
+    std::chrono::seconds const report_interval;
+
+    std::mutex mutable mutex; // Protects the following...
+    std::unordered_map<SubCompositorId, Instance> instance;
+    TimePoint last_scheduled;
+    TimePoint last_report;
+};
+
+}
+}
+}
+
+#endif // MIR_REPORT_LOGGING_COMPOSITOR_STATISTICS_REPORT_H_
@@ -30,8 +30,10 @@
 namespace mrl = mir::report::logging;
 namespace ml = mir::logging;
 
-mrl::InputReport::InputReport(const std::shared_ptr<ml::Logger>& logger)
-    : logger(logger)
+mrl::InputReport::InputReport(const std::shared_ptr<ml::Logger>& logger, std::shared_ptr<time::Clock> const& clock)
+    : logger(logger),
+      clock(clock),
+      last_stage_report(clock->now())
 {
 }
 
@@ -173,3 +175,44 @@ void mrl::InputReport::failed_to_open_input_device(char const* device_name, char
 
     logger->log(ml::Severity::informational, ss.str(), component());
 }
+
+void mrl::InputReport::event_reached_stage(Stage stage, int64_t event_time)
+{
+    auto const latency = clock->now().time_since_epoch() - std::chrono::nanoseconds{event_time};
+
+    std::lock_guard<std::mutex> lock{stages_mutex};
+    stage_latency[static_cast<size_t>(stage)].add(latency);
+    log_stages_if_due(lock);
+}
+
+void mrl::InputReport::event_dropped(Stage stage, int64_t /*event_time*/)
+{
+    std::lock_guard<std::mutex> lock{stages_mutex};
+    stage_dropped[static_cast<size_t>(stage)]++;
+    log_stages_if_due(lock);
+}
+
+void mrl::InputReport::log_stages_if_due(std::lock_guard<std::mutex> const&)
+{
+    auto const now = clock->now();
+    if (now - last_stage_report < std::chrono::seconds{10})
+        return;
+
+    char const* const stage_names[stage_count] = {"seat", "dispatcher", "client"};
+
+    std::stringstream ss;
+    ss << "Input latency from kernel (p50/p95/p99 us):";
+    for (size_t i = 0; i != stage_count; ++i)
+    {
+        ss << " " << stage_names[i] << "=" << stage_latency[i].percentile(50).count()
+           << "/" << stage_latency[i].percentile(95).count()
+           << "/" << stage_latency[i].percentile(99).count()
+           << " (" << stage_latency[i].count() << " events, " << stage_dropped[i] << " dropped)";
+    }
+
+    logger->log(ml::Severity::informational, ss.str(), component());
+
+    stage_latency = {};
+    stage_dropped = {};
+    last_stage_report = now;
+}
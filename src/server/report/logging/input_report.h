@@ -19,9 +19,14 @@
 #ifndef MIR_REPORT_LOGGING_INPUT_REPORT_H_
 #define MIR_REPORT_LOGGING_INPUT_REPORT_H_
 
+#include "compositor_statistics_report.h"
+
 #include "mir/input/input_report.h"
+#include "mir/time/clock.h"
 
+#include <array>
 #include <memory>
+#include <mutex>
 
 namespace mir
 {
@@ -37,7 +42,7 @@ namespace logging
 class InputReport : public input::InputReport
 {
 public:
-    InputReport(std::shared_ptr<mir::logging::Logger> const& logger);
+    InputReport(std::shared_ptr<mir::logging::Logger> const& logger, std::shared_ptr<time::Clock> const& clock);
     virtual ~InputReport() noexcept(true) = default;
 
     void received_event_from_kernel(int64_t when, int type, int code, int value) override;
@@ -47,9 +52,22 @@ public:
 
     void opened_input_device(char const* device_name, char const* input_platform) override;
     void failed_to_open_input_device(char const* device_name, char const* input_platform) override;
+
+    /// Latencies from the kernel to each stage are gathered, and logged every ten seconds
+    void event_reached_stage(Stage stage, int64_t event_time) override;
+    void event_dropped(Stage stage, int64_t event_time) override;
 private:
     char const* component();
+    void log_stages_if_due(std::lock_guard<std::mutex> const&);
+
     std::shared_ptr<mir::logging::Logger> const logger;
+    std::shared_ptr<time::Clock> const clock;
+
+    static size_t constexpr stage_count{3};
+    std::mutex stages_mutex; // Protects the following...
+    std::array<DurationHistogram, stage_count> stage_latency;
+    std::array<long, stage_count> stage_dropped{};
+    time::Timestamp last_stage_report;
 };
 
 }
@@ -0,0 +1,83 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "lock_report.h"
+
+#include "mir/logging/logger.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+
+namespace ml = mir::logging;
+namespace mrl = mir::report::logging;
+
+using Totals = mir::LockProfile::Totals;
+
+namespace
+{
+char const* const component = "locks";
+
+auto operator-(Totals const& now, Totals const& before) -> Totals
+{
+    return {
+        now.acquisitions - before.acquisitions,
+        now.contended - before.contended,
+        now.waited - before.waited,
+        now.longest_wait,
+        now.held - before.held,
+        now.longest_hold};
+}
+
+auto in_ms(std::chrono::nanoseconds duration) -> double
+{
+    return std::chrono::duration<double, std::milli>{duration}.count();
+}
+}
+
+mrl::LockReport::LockReport(std::shared_ptr<ml::Logger> const& logger) :
+    logger{logger}
+{
+}
+
+void mrl::LockReport::locks_sampled(std::vector<Lock> const& locks)
+{
+    std::vector<Lock> interval;
+    for (auto const& lock : locks)
+    {
+        auto& before = previous[lock.name];
+        auto const since = lock.totals - before;
+        before = lock.totals;
+
+        if (since.acquisitions > 0)
+            interval.push_back({lock.name, since});
+    }
+
+    std::sort(interval.begin(), interval.end(),
+              [](Lock const& a, Lock const& b) { return a.totals.waited > b.totals.waited; });
+
+    for (auto const& lock : interval)
+    {
+        auto const& t = lock.totals;
+        char message[256];
+        snprintf(message, sizeof message,
+                 "Locks: %s: %" PRIu64 " acquisitions, %" PRIu64 " contended (%.1f%%), "
+                 "waited %.3fms, held %.3fms (longest yet: wait %.3fms, hold %.3fms)",
+                 lock.name, t.acquisitions, t.contended, 100.0 * t.contended / t.acquisitions,
+                 in_ms(t.waited), in_ms(t.held), in_ms(t.longest_wait), in_ms(t.longest_hold));
+        logger->log(ml::Severity::informational, message, component);
+    }
+}
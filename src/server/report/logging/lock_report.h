@@ -0,0 +1,52 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_REPORT_LOGGING_LOCK_REPORT_H_
+#define MIR_REPORT_LOGGING_LOCK_REPORT_H_
+
+#include "mir/lock_report.h"
+
+#include <map>
+#include <memory>
+#include <string>
+
+namespace mir
+{
+namespace logging
+{
+class Logger;
+}
+namespace report
+{
+namespace logging
+{
+/// Logs what each lock saw since the last sample, most waited for first
+class LockReport : public mir::LockReport
+{
+public:
+    LockReport(std::shared_ptr<mir::logging::Logger> const& logger);
+
+    void locks_sampled(std::vector<Lock> const& locks) override;
+
+private:
+    std::shared_ptr<mir::logging::Logger> const logger;
+    std::map<std::string, LockProfile::Totals> previous;
+};
+}
+}
+}
+
+#endif /* MIR_REPORT_LOGGING_LOCK_REPORT_H_ */
@@ -27,6 +27,10 @@
 #include "shell_report.h"
 #include "input_report.h"
 #include "seat_report.h"
+#include "startup_report.h"
+#include "lock_report.h"
+#include "memory_report.h"
+#include "../process_start.h"
 #include "mir/logging/shared_library_prober_report.h"
 
 #include "mir/default_server_configuration.h"
@@ -72,7 +76,7 @@ std::shared_ptr<mir::frontend::MessageProcessorReport> mr::LoggingReportFactory:
 
 std::shared_ptr<mir::input::InputReport> mr::LoggingReportFactory::create_input_report()
 {
-    return std::make_shared<logging::InputReport>(logger);
+    return std::make_shared<logging::InputReport>(logger, clock);
 }
 
 std::shared_ptr<mir::input::SeatObserver> mr::LoggingReportFactory::create_seat_report()
@@ -89,3 +93,18 @@ std::shared_ptr<mir::shell::ShellReport> mir::report::LoggingReportFactory::crea
 {
     return std::make_shared<mir::logging::ShellReport>(logger);
 }
+
+std::shared_ptr<mir::StartupReport> mr::LoggingReportFactory::create_startup_report()
+{
+    return std::make_shared<logging::StartupReport>(logger, clock, process_start_time(*clock));
+}
+
+std::shared_ptr<mir::MemoryReport> mr::LoggingReportFactory::create_memory_report()
+{
+    return std::make_shared<logging::MemoryReport>(logger);
+}
+
+std::shared_ptr<mir::LockReport> mr::LoggingReportFactory::create_lock_report()
+{
+    return std::make_shared<logging::LockReport>(logger);
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "memory_report.h"
+
+#include "mir/logging/logger.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+namespace ml = mir::logging;
+namespace mrl = mir::report::logging;
+
+namespace
+{
+char const* const component = "memory";
+
+auto is_clients(mir::MemoryReport::Account const& account) -> bool
+{
+    return strcmp(account.subsystem, "wayland") == 0 && strcmp(account.kind, "clients") == 0;
+}
+}
+
+mrl::MemoryReport::MemoryReport(std::shared_ptr<ml::Logger> const& logger) :
+    logger{logger}
+{
+}
+
+void mrl::MemoryReport::memory_sampled(std::vector<Account> const& accounts, int64_t resident_bytes)
+{
+    int64_t clients{0};
+    int64_t accounted{0};
+    for (auto const& account : accounts)
+    {
+        if (is_clients(account))
+            clients = account.objects;
+        accounted += account.bytes;
+    }
+
+    char message[256];
+    snprintf(message, sizeof message,
+             "Memory: %" PRId64 " bytes resident, %" PRId64 " bytes accounted, %" PRId64 " clients",
+             resident_bytes, accounted, clients);
+    logger->log(ml::Severity::informational, message, component);
+
+    for (auto const& account : accounts)
+    {
+        if (account.objects == 0 && account.bytes == 0)
+            continue;
+
+        auto const length = snprintf(message, sizeof message,
+            "Memory: %s/%s: %" PRId64 " objects, %" PRId64 " bytes",
+            account.subsystem, account.kind, account.objects, account.bytes);
+
+        if (clients > 0 && length > 0 && static_cast<size_t>(length) < sizeof message)
+        {
+            snprintf(message + length, sizeof message - length,
+                     " (%.1f objects, %" PRId64 " bytes per client)",
+                     static_cast<double>(account.objects) / clients, account.bytes / clients);
+        }
+
+        logger->log(ml::Severity::informational, message, component);
+    }
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "startup_report.h"
+
+#include "mir/logging/logger.h"
+#include "mir/time/clock.h"
+
+#include <cstdio>
+
+namespace ml = mir::logging;
+namespace mrl = mir::report::logging;
+
+namespace
+{
+char const* const component = "startup";
+
+auto as_ms(mir::time::Duration duration) -> double
+{
+    return std::chrono::duration<double, std::milli>{duration}.count();
+}
+}
+
+mrl::StartupReport::StartupReport(
+    std::shared_ptr<ml::Logger> const& logger,
+    std::shared_ptr<time::Clock> const& clock,
+    time::Timestamp process_start) :
+    logger{logger},
+    clock{clock},
+    process_start{process_start},
+    previous{process_start}
+{
+}
+
+void mrl::StartupReport::phase_completed(Phase phase)
+{
+    auto const now = clock->now();
+
+    std::lock_guard<std::mutex> lock{mutex};
+    if (!completed.insert(phase).second)
+        return;
+
+    char message[128];
+    snprintf(message, sizeof message, "Startup: %s after %.1f ms (+%.1f ms)",
+             name_of(phase), as_ms(now - process_start), as_ms(now - previous));
+    previous = now;
+
+    logger->log(ml::Severity::informational, message, component);
+}
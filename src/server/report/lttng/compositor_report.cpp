@@ -58,6 +58,13 @@ void mir::report::lttng::CompositorReport::rendered_frame(SubCompositorId id)
     mir_tracepoint(mir_server_compositor, rendered_frame, id);
 }
 
+void mir::report::lttng::CompositorReport::measured_gpu_render_time(
+    SubCompositorId id,
+    std::chrono::nanoseconds gpu_time)
+{
+    mir_tracepoint(mir_server_compositor, measured_gpu_render_time, id, gpu_time.count());
+}
+
 void mir::report::lttng::CompositorReport::finished_frame(SubCompositorId id)
 {
     mir_tracepoint(mir_server_compositor, finished_frame, id);
@@ -39,6 +39,7 @@ public:
     void began_frame(SubCompositorId id) override;
     void renderables_in_frame(SubCompositorId id, graphics::RenderableList const& renderables) override;
     void rendered_frame(SubCompositorId id) override;
+    void measured_gpu_render_time(SubCompositorId id, std::chrono::nanoseconds gpu_time) override;
     void finished_frame(SubCompositorId id) override;
     void started() override;
     void stopped() override;
@@ -80,6 +80,16 @@ TRACEPOINT_EVENT_INSTANCE(
     TP_ARGS(void const*, id)
 )
 
+TRACEPOINT_EVENT(
+    mir_server_compositor,
+    measured_gpu_render_time,
+    TP_ARGS(void const*, id, int64_t, gpu_time_ns),
+    TP_FIELDS(
+        ctf_integer_hex(uintptr_t, id, (uintptr_t)(id))
+        ctf_integer(int64_t, gpu_time_ns, gpu_time_ns)
+    )
+)
+
 TRACEPOINT_EVENT(
     mir_server_compositor,
     buffers_in_frame,
@@ -48,3 +48,13 @@ void mir::report::lttng::InputReport::failed_to_open_input_device(char const* na
 {
     mir_tracepoint(mir_server_input, failed_to_open_input_device, name, platform);
 }
+
+void mir::report::lttng::InputReport::event_reached_stage(Stage stage, int64_t event_time)
+{
+    mir_tracepoint(mir_server_input, event_reached_stage, static_cast<int>(stage), event_time);
+}
+
+void mir::report::lttng::InputReport::event_dropped(Stage stage, int64_t event_time)
+{
+    mir_tracepoint(mir_server_input, event_dropped, static_cast<int>(stage), event_time);
+}
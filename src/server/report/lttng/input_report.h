@@ -43,6 +43,9 @@ public:
 
     void opened_input_device(char const* device_name, char const* input_platform) override;
     void failed_to_open_input_device(char const* device_name, char const* input_platform) override;
+
+    void event_reached_stage(Stage stage, int64_t event_time) override;
+    void event_dropped(Stage stage, int64_t event_time) override;
 private:
     ServerTracepointProvider tp_provider;
 };
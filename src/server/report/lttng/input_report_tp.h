@@ -88,6 +88,32 @@ TRACEPOINT_EVENT_INSTANCE(
     TP_ARGS(const char*, device, const char*, platform)
 )
 
+/* stage is a mir::input::InputReport::Stage: 0 seat, 1 dispatcher, 2 client.
+ * event_time is the kernel timestamp, so the stages of one event share it. */
+TRACEPOINT_EVENT_CLASS(
+    mir_server_input,
+    event_stage,
+    TP_ARGS(int, stage, int64_t, event_time),
+    TP_FIELDS(
+        ctf_integer(int, stage, stage)
+        ctf_integer(int64_t, event_time, event_time)
+    )
+)
+
+TRACEPOINT_EVENT_INSTANCE(
+    mir_server_input,
+    event_stage,
+    event_reached_stage,
+    TP_ARGS(int, stage, int64_t, event_time)
+)
+
+TRACEPOINT_EVENT_INSTANCE(
+    mir_server_input,
+    event_stage,
+    event_dropped,
+    TP_ARGS(int, stage, int64_t, event_time)
+)
+
 #endif /* MIR_LTTNG_DISPLAY_REPORT_TP_H_ */
 
 #include <lttng/tracepoint-event.h>
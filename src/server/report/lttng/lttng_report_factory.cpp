@@ -77,3 +77,18 @@ std::shared_ptr<mir::shell::ShellReport> mir::report::LttngReportFactory::create
 {
     BOOST_THROW_EXCEPTION(std::logic_error("Not implemented"));
 }
+
+std::shared_ptr<mir::StartupReport> mir::report::LttngReportFactory::create_startup_report()
+{
+    BOOST_THROW_EXCEPTION(std::logic_error("Not implemented"));
+}
+
+std::shared_ptr<mir::MemoryReport> mir::report::LttngReportFactory::create_memory_report()
+{
+    BOOST_THROW_EXCEPTION(std::logic_error("Not implemented"));
+}
+
+std::shared_ptr<mir::LockReport> mir::report::LttngReportFactory::create_lock_report()
+{
+    BOOST_THROW_EXCEPTION(std::logic_error("Not implemented"));
+}
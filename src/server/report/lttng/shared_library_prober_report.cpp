@@ -50,3 +50,9 @@ void mrl::SharedLibraryProberReport::loading_failed(bf::path const& filename, st
     mir_tracepoint(mir_server_shared_library_prober, loading_failed,
                    filename.string().c_str(), error.what());
 }
+
+void mrl::SharedLibraryProberReport::library_skipped(bf::path const& filename, std::string const& requirement)
+{
+    mir_tracepoint(mir_server_shared_library_prober, library_skipped,
+                   filename.string().c_str(), requirement.c_str());
+}
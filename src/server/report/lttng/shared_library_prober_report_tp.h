@@ -65,6 +65,16 @@ TRACEPOINT_EVENT(
     )
 )
 
+TRACEPOINT_EVENT(
+    mir_server_shared_library_prober,
+    library_skipped,
+    TP_ARGS(const char*, path, const char*, requirement),
+    TP_FIELDS(
+        ctf_string(path, path)
+        ctf_string(requirement, requirement)
+    )
+)
+
 #endif /* MIR_LTTNG_SHARED_LIBRARY_PROBER_REPORT_TP_H_ */
 
 #include <lttng/tracepoint-event.h>
@@ -38,6 +38,9 @@ public:
     std::shared_ptr<input::SeatObserver> create_seat_report() override;
     std::shared_ptr<SharedLibraryProberReport> create_shared_library_prober_report() override;
     std::shared_ptr<shell::ShellReport> create_shell_report() override;
+    std::shared_ptr<StartupReport> create_startup_report() override;
+    std::shared_ptr<MemoryReport> create_memory_report() override;
+    std::shared_ptr<LockReport> create_lock_report() override;
 };
 }
 }
@@ -0,0 +1,68 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "memory_sampler.h"
+
+#include "mir/memory_account.h"
+#include "mir/memory_report.h"
+#include "mir/time/alarm.h"
+#include "mir/time/alarm_factory.h"
+
+#include <fstream>
+#include <vector>
+
+#include <unistd.h>
+
+namespace mr = mir::report;
+
+mr::MemorySampler::MemorySampler(
+    time::AlarmFactory& alarm_factory,
+    std::chrono::milliseconds interval,
+    std::shared_ptr<MemoryReport> const& report) :
+    interval{interval},
+    report{report},
+    alarm{alarm_factory.create_alarm([this] { sample(); alarm->reschedule_in(this->interval); })}
+{
+    alarm->reschedule_in(interval);
+}
+
+mr::MemorySampler::~MemorySampler()
+{
+    alarm->cancel();
+}
+
+void mr::MemorySampler::sample()
+{
+    std::vector<MemoryReport::Account> accounts;
+    for_each_memory_account(
+        [&](MemoryAccount const& account)
+        {
+            accounts.push_back({account.subsystem, account.kind, account.objects(), account.bytes()});
+        });
+
+    report->memory_sampled(accounts, resident_bytes());
+}
+
+auto mr::resident_bytes() -> int64_t
+{
+    // statm gives the total and resident sizes, in pages
+    std::ifstream statm{"/proc/self/statm"};
+    int64_t size{0}, resident{0};
+    if (!(statm >> size >> resident))
+        return 0;
+
+    return resident * sysconf(_SC_PAGESIZE);
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_REPORT_MEMORY_SAMPLER_H_
+#define MIR_REPORT_MEMORY_SAMPLER_H_
+
+#include <chrono>
+#include <memory>
+
+namespace mir
+{
+class MemoryReport;
+namespace time
+{
+class Alarm;
+class AlarmFactory;
+}
+namespace report
+{
+/// Samples every MemoryAccount, and the resident set, each \a interval for a MemoryReport
+class MemorySampler
+{
+public:
+    MemorySampler(
+        time::AlarmFactory& alarm_factory,
+        std::chrono::milliseconds interval,
+        std::shared_ptr<MemoryReport> const& report);
+    ~MemorySampler();
+
+    void sample();
+
+private:
+    MemorySampler(MemorySampler const&) = delete;
+    MemorySampler& operator=(MemorySampler const&) = delete;
+
+    std::chrono::milliseconds const interval;
+    std::shared_ptr<MemoryReport> const report;
+    std::unique_ptr<time::Alarm> const alarm;
+};
+
+/// The process's resident set, in bytes (0 if /proc can't say)
+auto resident_bytes() -> int64_t;
+}
+}
+
+#endif // MIR_REPORT_MEMORY_SAMPLER_H_
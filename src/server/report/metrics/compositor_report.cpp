@@ -0,0 +1,134 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "compositor_report.h"
+#include "registry.h"
+
+#include <cstdio>
+
+namespace mrm = mir::report::metrics;
+
+namespace
+{
+std::vector<double> const frame_time_bounds{0.001, 0.002, 0.004, 0.008, 0.016, 0.033, 0.066, 0.1};
+
+auto seconds(std::chrono::nanoseconds duration) -> double
+{
+    return std::chrono::duration<double>(duration).count();
+}
+}
+
+mrm::CompositorReport::Display::Display(Registry& registry, std::string const& name) :
+    frames{registry.counter(
+        "mir_compositor_frames", "Frames composited", {{"display", name}})},
+    bypassed_frames{registry.counter(
+        "mir_compositor_bypassed_frames", "Frames scanned out directly from a client buffer", {{"display", name}})},
+    frame_time{registry.histogram(
+        "mir_compositor_frame_time_seconds", "Time to composite a frame", frame_time_bounds, {{"display", name}})},
+    gpu_time{registry.histogram(
+        "mir_compositor_gpu_time_seconds", "GPU time of rendered frames", frame_time_bounds, {{"display", name}})},
+    renderables{registry.gauge(
+        "mir_compositor_renderables", "Buffers composited in the latest frame", {{"display", name}})}
+{
+}
+
+mrm::CompositorReport::CompositorReport(
+    std::shared_ptr<Registry> const& registry,
+    std::shared_ptr<time::Clock> const& clock) :
+    registry{registry},
+    clock{clock}
+{
+}
+
+auto mrm::CompositorReport::display_for(SubCompositorId id, std::lock_guard<std::mutex> const&) -> Display&
+{
+    auto display = displays.find(id);
+    if (display == displays.end())
+    {
+        auto name = names.find(id);
+        if (name == names.end())
+        {
+            char buffer[32];
+            snprintf(buffer, sizeof buffer, "%p", id);
+            name = names.emplace(id, buffer).first;
+        }
+        display = displays.emplace(
+            std::piecewise_construct, std::forward_as_tuple(id), std::forward_as_tuple(*registry, name->second)).first;
+    }
+    return display->second;
+}
+
+void mrm::CompositorReport::added_display(int width, int height, int x, int y, SubCompositorId id)
+{
+    char name[64];
+    snprintf(name, sizeof name, "%dx%d%+d%+d", width, height, x, y);
+
+    std::lock_guard<std::mutex> lock{mutex};
+    names[id] = name;
+    displays.erase(id);
+}
+
+void mrm::CompositorReport::began_frame(SubCompositorId id)
+{
+    auto const now = clock->now();
+
+    std::lock_guard<std::mutex> lock{mutex};
+    auto& display = display_for(id, lock);
+    display.start_of_frame = now;
+    display.rendered = false;
+}
+
+void mrm::CompositorReport::renderables_in_frame(SubCompositorId id, graphics::RenderableList const& renderables)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    display_for(id, lock).renderables.set(renderables.size());
+}
+
+void mrm::CompositorReport::rendered_frame(SubCompositorId id)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    display_for(id, lock).rendered = true;
+}
+
+void mrm::CompositorReport::measured_gpu_render_time(SubCompositorId id, std::chrono::nanoseconds gpu_time)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    display_for(id, lock).gpu_time.observe(seconds(gpu_time));
+}
+
+void mrm::CompositorReport::finished_frame(SubCompositorId id)
+{
+    auto const now = clock->now();
+
+    std::lock_guard<std::mutex> lock{mutex};
+    auto& display = display_for(id, lock);
+    display.frames.increment();
+    if (!display.rendered)
+        display.bypassed_frames.increment();
+    display.frame_time.observe(seconds(now - display.start_of_frame));
+}
+
+void mrm::CompositorReport::started()
+{
+}
+
+void mrm::CompositorReport::stopped()
+{
+}
+
+void mrm::CompositorReport::scheduled()
+{
+}
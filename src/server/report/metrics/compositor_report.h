@@ -0,0 +1,82 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_REPORT_METRICS_COMPOSITOR_REPORT_H_
+#define MIR_REPORT_METRICS_COMPOSITOR_REPORT_H_
+
+#include "mir/compositor/compositor_report.h"
+#include "mir/time/clock.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace mir
+{
+namespace report
+{
+namespace metrics
+{
+class Registry;
+class Counter;
+class Gauge;
+class Histogram;
+
+class CompositorReport : public compositor::CompositorReport
+{
+public:
+    CompositorReport(std::shared_ptr<Registry> const& registry, std::shared_ptr<time::Clock> const& clock);
+
+    void added_display(int width, int height, int x, int y, SubCompositorId id) override;
+    void began_frame(SubCompositorId id) override;
+    void renderables_in_frame(SubCompositorId id, graphics::RenderableList const& renderables) override;
+    void rendered_frame(SubCompositorId id) override;
+    void measured_gpu_render_time(SubCompositorId id, std::chrono::nanoseconds gpu_time) override;
+    void finished_frame(SubCompositorId id) override;
+    void started() override;
+    void stopped() override;
+    void scheduled() override;
+
+private:
+    struct Display
+    {
+        Display(Registry& registry, std::string const& name);
+
+        Counter& frames;
+        Counter& bypassed_frames;
+        Histogram& frame_time;
+        Histogram& gpu_time;
+        Gauge& renderables;
+
+        time::Timestamp start_of_frame;
+        bool rendered{false};
+    };
+
+    auto display_for(SubCompositorId id, std::lock_guard<std::mutex> const&) -> Display&;
+
+    std::shared_ptr<Registry> const registry;
+    std::shared_ptr<time::Clock> const clock;
+
+    std::mutex mutex;
+    std::unordered_map<SubCompositorId, std::string> names;
+    std::unordered_map<SubCompositorId, Display> displays;
+};
+}
+}
+}
+
+#endif // MIR_REPORT_METRICS_COMPOSITOR_REPORT_H_
@@ -0,0 +1,97 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "display_report.h"
+#include "registry.h"
+
+#include "mir/graphics/frame.h"
+
+namespace mrm = mir::report::metrics;
+
+mrm::DisplayReport::DisplayReport(std::shared_ptr<Registry> const& registry) :
+    registry{registry},
+    drm_master_failures{registry->counter(
+        "mir_display_drm_master_failures", "Failures to acquire or drop DRM master")},
+    vt_switch_away_failures{registry->counter(
+        "mir_display_vt_switch_failures", "Failed VT switches", {{"direction", "away"}})},
+    vt_switch_back_failures{registry->counter(
+        "mir_display_vt_switch_failures", "Failed VT switches", {{"direction", "back"}})}
+{
+}
+
+void mrm::DisplayReport::report_successful_setup_of_native_resources()
+{
+}
+
+void mrm::DisplayReport::report_successful_egl_make_current_on_construction()
+{
+}
+
+void mrm::DisplayReport::report_successful_egl_buffer_swap_on_construction()
+{
+}
+
+void mrm::DisplayReport::report_successful_display_construction()
+{
+}
+
+void mrm::DisplayReport::report_egl_configuration(EGLDisplay, EGLConfig)
+{
+}
+
+void mrm::DisplayReport::report_vsync(unsigned int output_id, graphics::Frame const& frame)
+{
+    Labels const labels{{"output", std::to_string(output_id)}};
+    registry->counter("mir_display_page_flips", "Page flips completed", labels).increment();
+
+    int64_t previous_msc;
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        auto& last = last_msc[output_id];
+        previous_msc = last;
+        last = frame.msc;
+    }
+
+    // While the output is animating, more than one vblank between flips means a missed flip; while it's idle
+    // the intervals are long. The buckets distinguish the two.
+    if (previous_msc && frame.msc > previous_msc)
+    {
+        registry->histogram(
+            "mir_display_vblanks_per_flip",
+            "Vblanks between successive page flips",
+            {1, 2, 3, 4, 8},
+            labels).observe(frame.msc - previous_msc);
+    }
+}
+
+void mrm::DisplayReport::report_successful_drm_mode_set_crtc_on_construction()
+{
+}
+
+void mrm::DisplayReport::report_drm_master_failure(int)
+{
+    drm_master_failures.increment();
+}
+
+void mrm::DisplayReport::report_vt_switch_away_failure()
+{
+    vt_switch_away_failures.increment();
+}
+
+void mrm::DisplayReport::report_vt_switch_back_failure()
+{
+    vt_switch_back_failures.increment();
+}
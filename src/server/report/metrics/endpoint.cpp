@@ -0,0 +1,186 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "endpoint.h"
+#include "registry.h"
+
+#include "mir/thread_name.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace mrm = mir::report::metrics;
+
+namespace
+{
+/// How long a client has to send a request before it gets the plain exposition
+int const request_timeout_ms = 100;
+size_t const max_request_size = 4096;
+
+auto address_of(std::string const& path) -> sockaddr_un
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+
+    if (path.size() >= sizeof address.sun_path)
+        BOOST_THROW_EXCEPTION(std::runtime_error("Metrics socket path too long: " + path));
+
+    strncpy(address.sun_path, path.c_str(), sizeof address.sun_path - 1);
+    return address;
+}
+
+auto listen_on(std::string const& path) -> mir::Fd
+{
+    auto const address = address_of(path);
+    auto const addr = reinterpret_cast<sockaddr const*>(&address);
+
+    mir::Fd socket{::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+    if (socket < 0)
+        BOOST_THROW_EXCEPTION(std::system_error(errno, std::system_category(), "Failed to create metrics socket"));
+
+    // Replace a socket left behind by an earlier server, but not one that's in use
+    {
+        mir::Fd probe{::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+        if (connect(probe, addr, sizeof address) == 0)
+            BOOST_THROW_EXCEPTION(std::runtime_error("Metrics socket already in use: " + path));
+        if (errno == ECONNREFUSED)
+            unlink(path.c_str());
+    }
+
+    if (bind(socket, addr, sizeof address) < 0)
+        BOOST_THROW_EXCEPTION(std::system_error(errno, std::system_category(), "Failed to bind metrics socket " + path));
+
+    // Only our own user may read the metrics, even in a shared directory (such as the /tmp fallback). No one can
+    // connect until we listen, so there's no window in which anyone else can.
+    if (chmod(path.c_str(), S_IRUSR | S_IWUSR) < 0)
+    {
+        auto const error = errno;
+        unlink(path.c_str());
+        BOOST_THROW_EXCEPTION(std::system_error(error, std::system_category(), "Failed to restrict metrics socket " + path));
+    }
+
+    if (listen(socket, SOMAXCONN) < 0)
+        BOOST_THROW_EXCEPTION(std::system_error(errno, std::system_category(), "Failed to listen on metrics socket"));
+
+    return socket;
+}
+
+void send_all(int fd, std::string const& data)
+{
+    for (size_t sent = 0; sent < data.size();)
+    {
+        auto const result = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (result < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return; // The client has gone; there's no one to tell
+        }
+        sent += result;
+    }
+}
+}
+
+mrm::Endpoint::Endpoint(std::shared_ptr<Registry const> const& registry, std::string const& socket_path) :
+    registry{registry},
+    socket_path{socket_path},
+    socket{listen_on(socket_path)},
+    shutdown_fd{eventfd(0, EFD_CLOEXEC)}
+{
+    if (shutdown_fd < 0)
+        BOOST_THROW_EXCEPTION(std::system_error(errno, std::system_category(), "Failed to create eventfd"));
+
+    thread = std::thread{[this]
+        {
+            mir::set_thread_name("Mir/Metrics");
+            serve();
+        }};
+}
+
+mrm::Endpoint::~Endpoint()
+{
+    uint64_t const one = 1;
+    if (write(shutdown_fd, &one, sizeof one) != sizeof one)
+    {
+        // Can't happen to an eventfd we've only written once
+    }
+    thread.join();
+    unlink(socket_path.c_str());
+}
+
+void mrm::Endpoint::serve()
+{
+    pollfd fds[] = {{socket, POLLIN, 0}, {shutdown_fd, POLLIN, 0}};
+
+    for (;;)
+    {
+        if (poll(fds, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+
+        if (fds[1].revents)
+            return;
+
+        if (fds[0].revents & POLLIN)
+        {
+            Fd client{accept4(socket, nullptr, nullptr, SOCK_CLOEXEC)};
+            if (client >= 0)
+                respond(client);
+        }
+    }
+}
+
+void mrm::Endpoint::respond(Fd const& client)
+{
+    // Read the request, if the client sends one, up to the blank line that ends its headers
+    std::string request;
+    pollfd fd{client, POLLIN, 0};
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < max_request_size &&
+           poll(&fd, 1, request_timeout_ms) > 0)
+    {
+        char buffer[512];
+        auto const received = recv(client, buffer, sizeof buffer, 0);
+        if (received <= 0)
+            break;
+        request.append(buffer, received);
+    }
+
+    auto const body = registry->exposition();
+
+    if (request.compare(0, 4, "GET ") == 0)
+    {
+        send_all(client,
+            "HTTP/1.0 200 OK\r\n"
+            "Content-Type: application/openmetrics-text; version=1.0.0; charset=utf-8\r\n"
+            "Content-Length: " + std::to_string(body.size()) + "\r\n"
+            "Connection: close\r\n"
+            "\r\n");
+    }
+    send_all(client, body);
+}
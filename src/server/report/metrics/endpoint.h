@@ -0,0 +1,64 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_REPORT_METRICS_ENDPOINT_H_
+#define MIR_REPORT_METRICS_ENDPOINT_H_
+
+#include "mir/fd.h"
+
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace mir
+{
+namespace report
+{
+namespace metrics
+{
+class Registry;
+
+/**
+ * Serves a Registry's exposition on a local socket
+ *
+ * A client sending an HTTP GET request (such as "curl --unix-socket <path> http://localhost/metrics", or a
+ * Prometheus scrape through a socket proxy) gets an HTTP response; any other client just gets the exposition.
+ * Each connection is served then closed, from a thread of the endpoint's own.
+ */
+class Endpoint
+{
+public:
+    Endpoint(std::shared_ptr<Registry const> const& registry, std::string const& socket_path);
+    ~Endpoint();
+
+private:
+    Endpoint(Endpoint const&) = delete;
+    Endpoint& operator=(Endpoint const&) = delete;
+
+    void serve();
+    void respond(Fd const& client);
+
+    std::shared_ptr<Registry const> const registry;
+    std::string const socket_path;
+    Fd const socket;
+    Fd const shutdown_fd;
+    std::thread thread;
+};
+}
+}
+}
+
+#endif // MIR_REPORT_METRICS_ENDPOINT_H_
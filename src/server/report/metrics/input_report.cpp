@@ -0,0 +1,93 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "input_report.h"
+#include "registry.h"
+
+namespace mrm = mir::report::metrics;
+
+namespace
+{
+char const* const stage_names[] = {"seat", "dispatcher", "client"};
+
+auto latency_histogram(mrm::Registry& registry, char const* stage) -> mrm::Histogram*
+{
+    return &registry.histogram(
+        "mir_input_latency_seconds",
+        "Time from the kernel's timestamp to an input event reaching each stage",
+        {0.0005, 0.001, 0.002, 0.004, 0.008, 0.016, 0.033},
+        {{"stage", stage}});
+}
+
+auto dropped_counter(mrm::Registry& registry, char const* stage) -> mrm::Counter*
+{
+    return &registry.counter(
+        "mir_input_events_dropped",
+        "Input events that went no further than a stage",
+        {{"stage", stage}});
+}
+}
+
+mrm::InputReport::InputReport(std::shared_ptr<Registry> const& registry, std::shared_ptr<time::Clock> const& clock) :
+    registry{registry},
+    clock{clock},
+    kernel_events{registry->counter("mir_input_kernel_events", "Events read from input devices")},
+    stage_latency{{
+        latency_histogram(*registry, stage_names[0]),
+        latency_histogram(*registry, stage_names[1]),
+        latency_histogram(*registry, stage_names[2])}},
+    stage_dropped{{
+        dropped_counter(*registry, stage_names[0]),
+        dropped_counter(*registry, stage_names[1]),
+        dropped_counter(*registry, stage_names[2])}}
+{
+}
+
+void mrm::InputReport::received_event_from_kernel(int64_t, int, int, int)
+{
+    kernel_events.increment();
+}
+
+void mrm::InputReport::published_key_event(int, uint32_t, int64_t)
+{
+}
+
+void mrm::InputReport::published_motion_event(int, uint32_t, int64_t)
+{
+}
+
+void mrm::InputReport::opened_input_device(char const*, char const* input_platform)
+{
+    registry->counter("mir_input_devices_opened", "Input devices opened", {{"platform", input_platform}}).increment();
+}
+
+void mrm::InputReport::failed_to_open_input_device(char const*, char const* input_platform)
+{
+    registry->counter(
+        "mir_input_device_open_failures", "Input devices that failed to open", {{"platform", input_platform}})
+        .increment();
+}
+
+void mrm::InputReport::event_reached_stage(Stage stage, int64_t event_time)
+{
+    auto const latency = clock->now().time_since_epoch() - std::chrono::nanoseconds{event_time};
+    stage_latency[static_cast<size_t>(stage)]->observe(std::chrono::duration<double>(latency).count());
+}
+
+void mrm::InputReport::event_dropped(Stage stage, int64_t)
+{
+    stage_dropped[static_cast<size_t>(stage)]->increment();
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "lock_report.h"
+#include "registry.h"
+
+namespace mrm = mir::report::metrics;
+
+namespace
+{
+auto in_us(std::chrono::nanoseconds duration) -> int64_t
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+}
+
+mrm::LockReport::LockReport(std::shared_ptr<Registry> const& registry) :
+    registry{registry}
+{
+}
+
+void mrm::LockReport::locks_sampled(std::vector<Lock> const& locks)
+{
+    for (auto const& lock : locks)
+    {
+        Labels const labels{{"lock", lock.name}};
+        auto const& now = lock.totals;
+        auto& before = previous[lock.name];
+
+        registry->counter(
+            "mir_lock_acquisitions",
+            "Times each profiled lock was taken",
+            labels).increment(now.acquisitions - before.acquisitions);
+        registry->counter(
+            "mir_lock_contended_acquisitions",
+            "Times each profiled lock was taken after waiting for another holder",
+            labels).increment(now.contended - before.contended);
+        registry->counter(
+            "mir_lock_wait_microseconds",
+            "Time spent waiting for each profiled lock",
+            labels).increment(in_us(now.waited) - in_us(before.waited));
+        registry->counter(
+            "mir_lock_hold_microseconds",
+            "Time each profiled lock was held exclusively",
+            labels).increment(in_us(now.held) - in_us(before.held));
+        registry->gauge(
+            "mir_lock_longest_wait_microseconds",
+            "The longest wait for each profiled lock",
+            labels).set(in_us(now.longest_wait));
+        registry->gauge(
+            "mir_lock_longest_hold_microseconds",
+            "The longest exclusive hold of each profiled lock",
+            labels).set(in_us(now.longest_hold));
+
+        before = now;
+    }
+}
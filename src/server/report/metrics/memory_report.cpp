@@ -0,0 +1,46 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "memory_report.h"
+#include "registry.h"
+
+namespace mrm = mir::report::metrics;
+
+mrm::MemoryReport::MemoryReport(std::shared_ptr<Registry> const& registry) :
+    registry{registry}
+{
+}
+
+void mrm::MemoryReport::memory_sampled(std::vector<Account> const& accounts, int64_t resident_bytes)
+{
+    registry->gauge(
+        "mir_memory_resident_bytes",
+        "The server's resident set size").set(resident_bytes);
+
+    for (auto const& account : accounts)
+    {
+        Labels const labels{{"subsystem", account.subsystem}, {"kind", account.kind}};
+
+        registry->gauge(
+            "mir_memory_objects",
+            "Objects each subsystem holds, by kind",
+            labels).set(account.objects);
+        registry->gauge(
+            "mir_memory_bytes",
+            "Memory each subsystem's objects hold or pin, by kind",
+            labels).set(account.bytes);
+    }
+}
@@ -0,0 +1,46 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_REPORT_METRICS_MEMORY_REPORT_H_
+#define MIR_REPORT_METRICS_MEMORY_REPORT_H_
+
+#include "mir/memory_report.h"
+
+#include <memory>
+
+namespace mir
+{
+namespace report
+{
+namespace metrics
+{
+class Registry;
+
+class MemoryReport : public mir::MemoryReport
+{
+public:
+    MemoryReport(std::shared_ptr<Registry> const& registry);
+
+    void memory_sampled(std::vector<Account> const& accounts, int64_t resident_bytes) override;
+
+private:
+    std::shared_ptr<Registry> const registry;
+};
+}
+}
+}
+
+#endif // MIR_REPORT_METRICS_MEMORY_REPORT_H_
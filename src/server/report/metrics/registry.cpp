@@ -0,0 +1,193 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "registry.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+
+namespace mrm = mir::report::metrics;
+
+namespace
+{
+auto format_number(double value) -> std::string
+{
+    char buffer[32];
+    snprintf(buffer, sizeof buffer, "%.9g", value);
+    return buffer;
+}
+
+/// Escapes a label value or help text (help text doesn't escape quotes, but never contains them)
+auto escape(std::string const& text) -> std::string
+{
+    std::string result;
+    for (auto c : text)
+    {
+        switch (c)
+        {
+        case '\\': result += "\\\\"; break;
+        case '"':  result += "\\\""; break;
+        case '\n': result += "\\n"; break;
+        default:   result += c;
+        }
+    }
+    return result;
+}
+
+/// The labels as a comma separated list, without braces, so that a histogram can add "le"
+auto format_labels(mrm::Labels const& labels) -> std::string
+{
+    std::string result;
+    for (auto const& label : labels)
+    {
+        if (!result.empty())
+            result += ',';
+        result += label.first + "=\"" + escape(label.second) + '"';
+    }
+    return result;
+}
+
+void append_sample(std::string& out, std::string const& name, std::string const& labels, std::string const& value)
+{
+    out += name;
+    if (!labels.empty())
+        out += '{' + labels + '}';
+    out += ' ' + value + '\n';
+}
+}
+
+void mrm::Counter::expose(std::string& out, std::string const& name, std::string const& labels) const
+{
+    append_sample(out, name + "_total", labels, std::to_string(value()));
+}
+
+void mrm::Gauge::expose(std::string& out, std::string const& name, std::string const& labels) const
+{
+    append_sample(out, name, labels, std::to_string(value()));
+}
+
+mrm::Histogram::Histogram(std::vector<double> const& bounds) :
+    bounds{bounds},
+    buckets{new std::atomic<uint64_t>[bounds.size() + 1]}
+{
+    if (!std::is_sorted(bounds.begin(), bounds.end()))
+        BOOST_THROW_EXCEPTION(std::logic_error("Histogram bucket bounds must be ascending"));
+
+    for (size_t i = 0; i != bounds.size() + 1; ++i)
+        buckets[i] = 0;
+}
+
+void mrm::Histogram::observe(double value)
+{
+    auto const bucket = std::lower_bound(bounds.begin(), bounds.end(), value) - bounds.begin();
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+
+    auto current = total.load(std::memory_order_relaxed);
+    while (!total.compare_exchange_weak(current, current + value, std::memory_order_relaxed))
+        ;
+}
+
+auto mrm::Histogram::count() const -> uint64_t
+{
+    uint64_t result = 0;
+    for (size_t i = 0; i != bounds.size() + 1; ++i)
+        result += buckets[i].load(std::memory_order_relaxed);
+    return result;
+}
+
+void mrm::Histogram::expose(std::string& out, std::string const& name, std::string const& labels) const
+{
+    auto const prefix = labels.empty() ? std::string{} : labels + ',';
+
+    // Accumulating a single read of each bucket keeps the buckets and count consistent
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i != bounds.size(); ++i)
+    {
+        cumulative += buckets[i].load(std::memory_order_relaxed);
+        append_sample(out, name + "_bucket", prefix + "le=\"" + format_number(bounds[i]) + '"', std::to_string(cumulative));
+    }
+    cumulative += buckets[bounds.size()].load(std::memory_order_relaxed);
+    append_sample(out, name + "_bucket", prefix + "le=\"+Inf\"", std::to_string(cumulative));
+    append_sample(out, name + "_count", labels, std::to_string(cumulative));
+    append_sample(out, name + "_sum", labels, format_number(sum()));
+}
+
+template<typename MetricType, typename... Args>
+auto mrm::Registry::find_or_add(
+    std::string const& name, Type type, std::string const& help, Labels const& labels, Args const&... args)
+    -> MetricType&
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    auto family = families.find(name);
+    if (family == families.end())
+    {
+        family = families.emplace(name, Family{type, help, {}}).first;
+    }
+    else if (family->second.type != type)
+    {
+        BOOST_THROW_EXCEPTION(std::logic_error("Metric \"" + name + "\" already registered with a different type"));
+    }
+
+    auto& member = family->second.members[labels];
+    if (!member)
+        member = std::make_unique<MetricType>(args...);
+
+    return static_cast<MetricType&>(*member);
+}
+
+auto mrm::Registry::counter(std::string const& name, std::string const& help, Labels const& labels) -> Counter&
+{
+    return find_or_add<Counter>(name, Type::counter, help, labels);
+}
+
+auto mrm::Registry::gauge(std::string const& name, std::string const& help, Labels const& labels) -> Gauge&
+{
+    return find_or_add<Gauge>(name, Type::gauge, help, labels);
+}
+
+auto mrm::Registry::histogram(
+    std::string const& name,
+    std::string const& help,
+    std::vector<double> const& bounds,
+    Labels const& labels) -> Histogram&
+{
+    return find_or_add<Histogram>(name, Type::histogram, help, labels, bounds);
+}
+
+auto mrm::Registry::exposition() const -> std::string
+{
+    static char const* const type_names[] = {"counter", "gauge", "histogram"};
+
+    std::string out;
+    std::lock_guard<std::mutex> lock{mutex};
+
+    for (auto const& family : families)
+    {
+        auto const& name = family.first;
+        out += "# TYPE " + name + ' ' + type_names[static_cast<int>(family.second.type)] + '\n';
+        out += "# HELP " + name + ' ' + escape(family.second.help) + '\n';
+
+        for (auto const& member : family.second.members)
+            member.second->expose(out, name, format_labels(member.first));
+    }
+
+    out += "# EOF\n";
+    return out;
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_REPORT_METRICS_REGISTRY_H_
+#define MIR_REPORT_METRICS_REGISTRY_H_
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mir
+{
+namespace report
+{
+namespace metrics
+{
+using Labels = std::vector<std::pair<std::string, std::string>>;
+
+class Metric
+{
+public:
+    virtual ~Metric() = default;
+
+    /// Appends the metric's samples, in OpenMetrics text format
+    virtual void expose(std::string& out, std::string const& name, std::string const& labels) const = 0;
+
+protected:
+    Metric() = default;
+    Metric(Metric const&) = delete;
+    Metric& operator=(Metric const&) = delete;
+};
+
+class Counter : public Metric
+{
+public:
+    void increment(uint64_t by = 1) { count.fetch_add(by, std::memory_order_relaxed); }
+    auto value() const -> uint64_t { return count.load(std::memory_order_relaxed); }
+
+    void expose(std::string& out, std::string const& name, std::string const& labels) const override;
+
+private:
+    std::atomic<uint64_t> count{0};
+};
+
+class Gauge : public Metric
+{
+public:
+    void increment() { current.fetch_add(1, std::memory_order_relaxed); }
+    void decrement() { current.fetch_sub(1, std::memory_order_relaxed); }
+    void set(int64_t value) { current.store(value, std::memory_order_relaxed); }
+    auto value() const -> int64_t { return current.load(std::memory_order_relaxed); }
+
+    void expose(std::string& out, std::string const& name, std::string const& labels) const override;
+
+private:
+    std::atomic<int64_t> current{0};
+};
+
+class Histogram : public Metric
+{
+public:
+    /// \param bounds The (ascending) upper bounds of the buckets; there is always a final bucket for everything else
+    explicit Histogram(std::vector<double> const& bounds);
+
+    void observe(double value);
+    auto count() const -> uint64_t;
+    auto sum() const -> double { return total.load(std::memory_order_relaxed); }
+
+    void expose(std::string& out, std::string const& name, std::string const& labels) const override;
+
+private:
+    std::vector<double> const bounds;
+    std::unique_ptr<std::atomic<uint64_t>[]> const buckets;
+    std::atomic<double> total{0};
+};
+
+/**
+ * The metrics the metrics reports maintain, and which MetricsEndpoint exposes
+ *
+ * Metrics are found (or created) by name and labels; this takes a lock, so reports keep references to the
+ * metrics they update frequently. Those references are valid for the lifetime of the Registry.
+ */
+class Registry
+{
+public:
+    auto counter(std::string const& name, std::string const& help, Labels const& labels = {}) -> Counter&;
+    auto gauge(std::string const& name, std::string const& help, Labels const& labels = {}) -> Gauge&;
+    auto histogram(
+        std::string const& name,
+        std::string const& help,
+        std::vector<double> const& bounds,
+        Labels const& labels = {}) -> Histogram&;
+
+    /// Every metric, in OpenMetrics text format
+    auto exposition() const -> std::string;
+
+private:
+    enum class Type { counter, gauge, histogram };
+
+    struct Family
+    {
+        Type type;
+        std::string help;
+        std::map<Labels, std::unique_ptr<Metric>> members;
+    };
+
+    template<typename MetricType, typename... Args>
+    auto find_or_add(std::string const& name, Type type, std::string const& help, Labels const& labels, Args const&... args)
+        -> MetricType&;
+
+    std::mutex mutable mutex;
+    std::map<std::string, Family> families;
+};
+}
+}
+}
+
+#endif // MIR_REPORT_METRICS_REGISTRY_H_
@@ -0,0 +1,76 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "seat_report.h"
+#include "registry.h"
+
+#include "mir_toolkit/events/event.h"
+#include "mir_toolkit/events/input/input_event.h"
+
+namespace mrm = mir::report::metrics;
+
+mrm::SeatReport::SeatReport(std::shared_ptr<Registry> const& registry) :
+    registry{registry},
+    devices{registry->gauge("mir_input_devices", "Input devices on the seat")}
+{
+}
+
+void mrm::SeatReport::seat_add_device(uint64_t)
+{
+    devices.increment();
+}
+
+void mrm::SeatReport::seat_remove_device(uint64_t)
+{
+    devices.decrement();
+}
+
+void mrm::SeatReport::seat_dispatch_event(std::shared_ptr<MirEvent const> const& event)
+{
+    if (mir_event_get_type(event.get()) != mir_event_type_input)
+        return;
+
+    auto const device = mir_input_event_get_device_id(mir_event_get_input_event(event.get()));
+
+    std::lock_guard<std::mutex> lock{mutex};
+    auto& counter = device_events[device];
+    if (!counter)
+    {
+        counter = &registry->counter(
+            "mir_input_events", "Input events dispatched by the seat", {{"device", std::to_string(device)}});
+    }
+    counter->increment();
+}
+
+void mrm::SeatReport::seat_set_key_state(uint64_t, std::vector<uint32_t> const&)
+{
+}
+
+void mrm::SeatReport::seat_set_pointer_state(uint64_t, unsigned)
+{
+}
+
+void mrm::SeatReport::seat_set_cursor_position(float, float)
+{
+}
+
+void mrm::SeatReport::seat_set_confinement_region_called(geometry::Rectangles const&)
+{
+}
+
+void mrm::SeatReport::seat_reset_confinement_regions()
+{
+}
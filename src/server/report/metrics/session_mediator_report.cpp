@@ -0,0 +1,105 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "session_mediator_report.h"
+#include "registry.h"
+
+namespace mrm = mir::report::metrics;
+
+mrm::SessionMediatorReport::SessionMediatorReport(std::shared_ptr<Registry> const& registry) :
+    registry{registry}
+{
+}
+
+void mrm::SessionMediatorReport::session_connect_called(std::string const& app_name)
+{
+    registry->counter("mir_client_connections", "Client connections", {{"client", app_name}}).increment();
+}
+
+void mrm::SessionMediatorReport::session_create_surface_called(std::string const&)
+{
+}
+
+void mrm::SessionMediatorReport::session_submit_buffer_called(std::string const& app_name)
+{
+    registry->counter("mir_client_buffer_submissions", "Buffers submitted by a client", {{"client", app_name}})
+        .increment();
+}
+
+void mrm::SessionMediatorReport::session_allocate_buffers_called(std::string const& app_name)
+{
+    registry->counter("mir_client_buffer_allocations", "Buffer allocation requests", {{"client", app_name}})
+        .increment();
+}
+
+void mrm::SessionMediatorReport::session_release_buffers_called(std::string const& app_name)
+{
+    registry->counter("mir_client_buffer_releases", "Buffer release requests", {{"client", app_name}})
+        .increment();
+}
+
+void mrm::SessionMediatorReport::session_release_surface_called(std::string const&)
+{
+}
+
+void mrm::SessionMediatorReport::session_disconnect_called(std::string const&)
+{
+}
+
+void mrm::SessionMediatorReport::session_configure_surface_called(std::string const&)
+{
+}
+
+void mrm::SessionMediatorReport::session_configure_surface_cursor_called(std::string const&)
+{
+}
+
+void mrm::SessionMediatorReport::session_configure_display_called(std::string const&)
+{
+}
+
+void mrm::SessionMediatorReport::session_set_base_display_configuration_called(std::string const&)
+{
+}
+
+void mrm::SessionMediatorReport::session_preview_base_display_configuration_called(std::string const&)
+{
+}
+
+void mrm::SessionMediatorReport::session_confirm_base_display_configuration_called(std::string const&)
+{
+}
+
+void mrm::SessionMediatorReport::session_start_prompt_session_called(std::string const&, pid_t)
+{
+}
+
+void mrm::SessionMediatorReport::session_stop_prompt_session_called(std::string const&)
+{
+}
+
+void mrm::SessionMediatorReport::session_create_buffer_stream_called(std::string const&)
+{
+}
+
+void mrm::SessionMediatorReport::session_release_buffer_stream_called(std::string const&)
+{
+}
+
+void mrm::SessionMediatorReport::session_error(std::string const& app_name, char const*, std::string const&)
+{
+    registry->counter("mir_client_errors", "Failed client requests", {{"client", app_name}}).increment();
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "shell_report.h"
+#include "registry.h"
+
+namespace mrm = mir::report::metrics;
+
+mrm::ShellReport::ShellReport(std::shared_ptr<Registry> const& registry) :
+    registry{registry},
+    clients{registry->gauge("mir_clients", "Connected clients")},
+    surfaces{registry->gauge("mir_surfaces", "Surfaces (windows) of all clients")},
+    surface_updates{registry->counter("mir_surface_updates", "Changes made to surfaces by the shell")},
+    focus_changes{registry->counter("mir_focus_changes", "Changes of input focus")}
+{
+}
+
+void mrm::ShellReport::opened_session(scene::Session const&)
+{
+    clients.increment();
+}
+
+void mrm::ShellReport::closing_session(scene::Session const&)
+{
+    clients.decrement();
+}
+
+void mrm::ShellReport::created_surface(scene::Session const&, scene::Surface const&)
+{
+    surfaces.increment();
+}
+
+void mrm::ShellReport::update_surface(scene::Session const&, scene::Surface const&, shell::SurfaceSpecification const&)
+{
+    surface_updates.increment();
+}
+
+void mrm::ShellReport::update_surface(scene::Session const&, scene::Surface const&, MirWindowAttrib, int)
+{
+    surface_updates.increment();
+}
+
+void mrm::ShellReport::destroying_surface(scene::Session const&, scene::Surface const&)
+{
+    surfaces.decrement();
+}
+
+void mrm::ShellReport::started_prompt_session(scene::PromptSession const&, scene::Session const&)
+{
+}
+
+void mrm::ShellReport::added_prompt_provider(scene::PromptSession const&, scene::Session const&)
+{
+}
+
+void mrm::ShellReport::stopping_prompt_session(scene::PromptSession const&)
+{
+}
+
+void mrm::ShellReport::adding_display(geometry::Rectangle const&)
+{
+}
+
+void mrm::ShellReport::removing_display(geometry::Rectangle const&)
+{
+}
+
+void mrm::ShellReport::input_focus_set_to(scene::Session const*, scene::Surface const*)
+{
+    focus_changes.increment();
+}
+
+void mrm::ShellReport::surfaces_raised(shell::SurfaceSet const&)
+{
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_REPORT_METRICS_SHELL_REPORT_H_
+#define MIR_REPORT_METRICS_SHELL_REPORT_H_
+
+#include "mir/shell/shell_report.h"
+
+#include <memory>
+
+namespace mir
+{
+namespace report
+{
+namespace metrics
+{
+class Registry;
+class Counter;
+class Gauge;
+
+class ShellReport : public shell::ShellReport
+{
+public:
+    ShellReport(std::shared_ptr<Registry> const& registry);
+
+    void opened_session(scene::Session const& session) override;
+    void closing_session(scene::Session const& session) override;
+    void created_surface(scene::Session const& session, scene::Surface const& surface) override;
+    void update_surface(
+        scene::Session const& session,
+        scene::Surface const& surface,
+        shell::SurfaceSpecification const& modifications) override;
+    void update_surface(
+        scene::Session const& session,
+        scene::Surface const& surface,
+        MirWindowAttrib attrib, int value) override;
+    void destroying_surface(scene::Session const& session, scene::Surface const& surface) override;
+    void started_prompt_session(scene::PromptSession const& prompt_session, scene::Session const& session) override;
+    void added_prompt_provider(scene::PromptSession const& prompt_session, scene::Session const& session) override;
+    void stopping_prompt_session(scene::PromptSession const& prompt_session) override;
+    void adding_display(geometry::Rectangle const& area) override;
+    void removing_display(geometry::Rectangle const& area) override;
+    void input_focus_set_to(scene::Session const* focus_session, scene::Surface const* focus_surface) override;
+    void surfaces_raised(shell::SurfaceSet const& surfaces) override;
+
+private:
+    std::shared_ptr<Registry> const registry;
+    Gauge& clients;
+    Gauge& surfaces;
+    Counter& surface_updates;
+    Counter& focus_changes;
+};
+}
+}
+}
+
+#endif // MIR_REPORT_METRICS_SHELL_REPORT_H_
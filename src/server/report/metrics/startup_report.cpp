@@ -0,0 +1,46 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "startup_report.h"
+#include "registry.h"
+
+#include "mir/time/clock.h"
+
+namespace mrm = mir::report::metrics;
+
+mrm::StartupReport::StartupReport(
+    std::shared_ptr<Registry> const& registry,
+    std::shared_ptr<time::Clock> const& clock,
+    time::Timestamp process_start) :
+    registry{registry},
+    clock{clock},
+    process_start{process_start}
+{
+}
+
+void mrm::StartupReport::phase_completed(Phase phase)
+{
+    auto const since_start = std::chrono::duration_cast<std::chrono::milliseconds>(clock->now() - process_start);
+
+    std::lock_guard<std::mutex> lock{mutex};
+    if (!completed.insert(phase).second)
+        return;
+
+    registry->gauge(
+        "mir_startup_phase_milliseconds",
+        "When each phase of starting the server completed, after the process started",
+        {{"phase", name_of(phase)}}).set(since_start.count());
+}
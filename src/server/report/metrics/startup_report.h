@@ -0,0 +1,61 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_REPORT_METRICS_STARTUP_REPORT_H_
+#define MIR_REPORT_METRICS_STARTUP_REPORT_H_
+
+#include "mir/startup_report.h"
+#include "mir/time/types.h"
+
+#include <memory>
+#include <mutex>
+#include <set>
+
+namespace mir
+{
+namespace time
+{
+class Clock;
+}
+namespace report
+{
+namespace metrics
+{
+class Registry;
+
+class StartupReport : public mir::StartupReport
+{
+public:
+    StartupReport(
+        std::shared_ptr<Registry> const& registry,
+        std::shared_ptr<time::Clock> const& clock,
+        time::Timestamp process_start);
+
+    void phase_completed(Phase phase) override;
+
+private:
+    std::shared_ptr<Registry> const registry;
+    std::shared_ptr<time::Clock> const clock;
+    time::Timestamp const process_start;
+
+    std::mutex mutex;
+    std::set<Phase> completed;
+};
+}
+}
+}
+
+#endif // MIR_REPORT_METRICS_STARTUP_REPORT_H_
@@ -36,6 +36,10 @@ void mrn::CompositorReport::rendered_frame(SubCompositorId)
 {
 }
 
+void mrn::CompositorReport::measured_gpu_render_time(SubCompositorId, std::chrono::nanoseconds)
+{
+}
+
 void mrn::CompositorReport::finished_frame(SubCompositorId)
 {
 }
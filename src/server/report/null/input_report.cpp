@@ -39,3 +39,11 @@ void mrn::InputReport::opened_input_device(char const* /* name */, char const* /
 void mrn::InputReport::failed_to_open_input_device(char const* /* name */, char const* /* platform */)
 {
 }
+
+void mrn::InputReport::event_reached_stage(Stage /* stage */, int64_t /* event_time */)
+{
+}
+
+void mrn::InputReport::event_dropped(Stage /* stage */, int64_t /* event_time */)
+{
+}
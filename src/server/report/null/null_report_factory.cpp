@@ -27,6 +27,9 @@
 #include "seat_report.h"
 #include "shell_report.h"
 #include "scene_report.h"
+#include "startup_report.h"
+#include "lock_report.h"
+#include "memory_report.h"
 #include "mir/logging/null_shared_library_prober_report.h"
 
 std::shared_ptr<mir::compositor::CompositorReport> mir::report::NullReportFactory::create_compositor_report()
@@ -118,3 +121,18 @@ std::shared_ptr<mir::input::SeatObserver> mir::report::null_seat_report()
 {
     return NullReportFactory{}.create_seat_report();
 }
+
+std::shared_ptr<mir::StartupReport> mir::report::NullReportFactory::create_startup_report()
+{
+    return std::make_shared<null::StartupReport>();
+}
+
+std::shared_ptr<mir::MemoryReport> mir::report::NullReportFactory::create_memory_report()
+{
+    return std::make_shared<null::MemoryReport>();
+}
+
+std::shared_ptr<mir::LockReport> mir::report::NullReportFactory::create_lock_report()
+{
+    return std::make_shared<null::LockReport>();
+}
@@ -0,0 +1,885 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "performance_hud.h"
+
+#include "mir/graphics/buffer.h"
+#include "mir/graphics/display_report.h"
+#include "mir/graphics/frame.h"
+#include "mir/graphics/graphic_buffer_allocator.h"
+#include "mir/graphics/renderable.h"
+#include "mir/input/scene.h"
+#include "mir/renderer/sw/pixel_source.h"
+#include "mir/scene/null_observer.h"
+#include "mir/scene/null_surface_observer.h"
+#include "mir/scene/session.h"
+#include "mir/scene/surface.h"
+#include "mir/time/alarm.h"
+#include "mir/time/alarm_factory.h"
+#include "mir/time/clock.h"
+
+#include <linux/input.h>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdio>
+
+namespace mr = mir::report;
+namespace mg = mir::graphics;
+namespace ms = mir::scene;
+namespace geom = mir::geometry;
+namespace mrs = mir::renderer::software;
+
+using namespace std::chrono_literals;
+
+namespace
+{
+auto const rate_window = 1s;
+auto const redraw_interval = 250ms;
+int const updates_until_idle = 5;   ///< Just over a second without frames of their own means the displays are idle
+
+/// A 3x5 pixel font, enough for numbers and (upper case) names
+struct GlyphRows
+{
+    char c;
+    char const* rows[5];
+};
+
+GlyphRows const font[]{
+    {'0', {"###", "#.#", "#.#", "#.#", "###"}},
+    {'1', {".#.", "##.", ".#.", ".#.", "###"}},
+    {'2', {"###", "..#", "###", "#..", "###"}},
+    {'3', {"###", "..#", ".##", "..#", "###"}},
+    {'4', {"#.#", "#.#", "###", "..#", "..#"}},
+    {'5', {"###", "#..", "###", "..#", "###"}},
+    {'6', {"###", "#..", "###", "#.#", "###"}},
+    {'7', {"###", "..#", "..#", ".#.", ".#."}},
+    {'8', {"###", "#.#", "###", "#.#", "###"}},
+    {'9', {"###", "#.#", "###", "..#", "###"}},
+    {'A', {".#.", "#.#", "###", "#.#", "#.#"}},
+    {'B', {"##.", "#.#", "##.", "#.#", "##."}},
+    {'C', {".##", "#..", "#..", "#..", ".##"}},
+    {'D', {"##.", "#.#", "#.#", "#.#", "##."}},
+    {'E', {"###", "#..", "##.", "#..", "###"}},
+    {'F', {"###", "#..", "##.", "#..", "#.."}},
+    {'G', {".##", "#..", "#.#", "#.#", ".##"}},
+    {'H', {"#.#", "#.#", "###", "#.#", "#.#"}},
+    {'I', {"###", ".#.", ".#.", ".#.", "###"}},
+    {'J', {"..#", "..#", "..#", "#.#", ".#."}},
+    {'K', {"#.#", "#.#", "##.", "#.#", "#.#"}},
+    {'L', {"#..", "#..", "#..", "#..", "###"}},
+    {'M', {"#.#", "###", "###", "#.#", "#.#"}},
+    {'N', {"##.", "#.#", "#.#", "#.#", "#.#"}},
+    {'O', {".#.", "#.#", "#.#", "#.#", ".#."}},
+    {'P', {"##.", "#.#", "##.", "#..", "#.."}},
+    {'Q', {".#.", "#.#", "#.#", "##.", ".##"}},
+    {'R', {"##.", "#.#", "##.", "#.#", "#.#"}},
+    {'S', {".##", "#..", ".#.", "..#", "##."}},
+    {'T', {"###", ".#.", ".#.", ".#.", ".#."}},
+    {'U', {"#.#", "#.#", "#.#", "#.#", "###"}},
+    {'V', {"#.#", "#.#", "#.#", "#.#", ".#."}},
+    {'W', {"#.#", "#.#", "###", "###", "#.#"}},
+    {'X', {"#.#", "#.#", ".#.", "#.#", "#.#"}},
+    {'Y', {"#.#", "#.#", ".#.", ".#.", ".#."}},
+    {'Z', {"###", "..#", ".#.", "#..", "###"}},
+    {'.', {"...", "...", "...", "...", ".#."}},
+    {':', {"...", ".#.", "...", ".#.", "..."}},
+    {'-', {"...", "...", "###", "...", "..."}},
+    {'_', {"...", "...", "...", "...", "###"}},
+    {'+', {"...", ".#.", "###", ".#.", "..."}},
+    {'/', {"..#", "..#", ".#.", "#..", "#.."}},
+    {'%', {"#..", "..#", ".#.", "#..", "..#"}},
+    {'(', {".#.", "#..", "#..", "#..", ".#."}},
+    {')', {".#.", "..#", "..#", "..#", ".#."}},
+    {'?', {"###", "..#", ".#.", "...", ".#."}},
+};
+
+int const glyph_width{3};
+int const glyph_height{5};
+int const scale{2};
+int const advance{(glyph_width + 1) * scale};
+int const line_height{(glyph_height + 2) * scale};
+int const margin{6};
+int const bar_width{4};
+int const graph_height{30};
+std::chrono::microseconds const graph_full_scale{33333};
+std::chrono::microseconds const frame_budget{16667};
+
+uint32_t const background{0xC0000000};  // Premultiplied
+uint32_t const text_color{0xFFFFFFFF};
+uint32_t const guide_color{0xFF606060};
+uint32_t const good_color{0xFF40C040};
+uint32_t const late_color{0xFFE0C020};
+uint32_t const janky_color{0xFFE04040};
+
+/// Each glyph's pixels, a bit for each (top row in the highest bits); zero for characters the font lacks
+auto glyph_bits(char c) -> uint16_t
+{
+    static auto const bits = []
+        {
+            std::array<uint16_t, 128> bits{};
+            for (auto const& glyph : font)
+            {
+                uint16_t value{0};
+                for (auto const row : glyph.rows)
+                {
+                    for (int x = 0; x != glyph_width; ++x)
+                        value = (value << 1) | (row[x] == '#');
+                }
+                bits[static_cast<unsigned char>(glyph.c)] = value;
+            }
+            return bits;
+        }();
+
+    auto const upper = std::toupper(static_cast<unsigned char>(c));
+    if (upper < 0 || upper >= static_cast<int>(bits.size()))
+        return bits['?'];
+    if (upper != ' ' && !bits[upper])
+        return bits['?'];
+    return bits[upper];
+}
+
+class Canvas
+{
+public:
+    Canvas(geom::Size size) :
+        size{size},
+        pixels(size.width.as_int() * size.height.as_int(), background)
+    {
+    }
+
+    void fill(int left, int top, int width, int height, uint32_t color)
+    {
+        int const right = std::min(left + width, size.width.as_int());
+        int const bottom = std::min(top + height, size.height.as_int());
+        for (int y = std::max(top, 0); y < bottom; ++y)
+        {
+            for (int x = std::max(left, 0); x < right; ++x)
+                pixels[y * size.width.as_int() + x] = color;
+        }
+    }
+
+    void text(int left, int top, std::string const& text)
+    {
+        for (auto const c : text)
+        {
+            auto const bits = glyph_bits(c);
+            for (int y = 0; y != glyph_height; ++y)
+            {
+                for (int x = 0; x != glyph_width; ++x)
+                {
+                    if (bits & (1 << ((glyph_height - y) * glyph_width - x - 1)))
+                        fill(left + x * scale, top + y * scale, scale, scale, text_color);
+                }
+            }
+            left += advance;
+        }
+    }
+
+    geom::Size const size;
+    std::vector<uint32_t> pixels;
+};
+
+auto lines_for(mr::PerformanceHud::Summary const& summary) -> int
+{
+    int lines = 1;  // Missed vblanks
+    if (!summary.commits_per_second.empty())
+        lines += 1 + summary.commits_per_second.size();
+    return lines + summary.displays.size();
+}
+
+auto hud_size(mr::PerformanceHud::Summary const& summary) -> geom::Size
+{
+    int const displays = summary.displays.size();
+    return {
+        2 * margin + mr::PerformanceHud::max_frame_times * bar_width,
+        2 * margin + lines_for(summary) * line_height + displays * (graph_height + margin)};
+}
+
+auto draw(mr::PerformanceHud::Summary const& summary) -> Canvas
+{
+    Canvas canvas{hud_size(summary)};
+    int const max_chars = (canvas.size.width.as_int() - 2 * margin) / advance;
+    auto const clipped = [max_chars](std::string text)
+        {
+            if (static_cast<int>(text.size()) > max_chars)
+                text.resize(max_chars);
+            return text;
+        };
+
+    int y = margin;
+    char line[128];
+    int number = 1;
+    for (auto const& display : summary.displays)
+    {
+        snprintf(
+            line, sizeof line, "%d: %dX%d %d FPS %s",
+            number++,
+            display.area.size.width.as_int(), display.area.size.height.as_int(),
+            display.frames_per_second,
+            display.composited ? "COMPOSITED" : "BYPASSED");
+        canvas.text(margin, y, clipped(line));
+        y += line_height;
+
+        // The frame times, scaled so the frame budget of a 60Hz display is half way up
+        int const bottom = y + graph_height;
+        int const guide = bottom - graph_height * frame_budget / graph_full_scale;
+        canvas.fill(margin, guide, canvas.size.width.as_int() - 2 * margin, 1, guide_color);
+
+        int x = canvas.size.width.as_int() - margin - static_cast<int>(display.frame_times.size()) * bar_width;
+        for (auto const frame_time : display.frame_times)
+        {
+            int const height = std::clamp<int>(graph_height * frame_time / graph_full_scale, 1, graph_height);
+            auto const color =
+                frame_time <= frame_budget ? good_color :
+                frame_time <= 2 * frame_budget ? late_color :
+                janky_color;
+            canvas.fill(x, bottom - height, bar_width - 1, height, color);
+            x += bar_width;
+        }
+        y = bottom + margin;
+    }
+
+    snprintf(line, sizeof line, "MISSED VBLANKS %d/S", summary.missed_vblanks_per_second);
+    canvas.text(margin, y, line);
+    y += line_height;
+
+    if (!summary.commits_per_second.empty())
+    {
+        canvas.text(margin, y, "COMMITS");
+        y += line_height;
+        for (auto const& client : summary.commits_per_second)
+        {
+            auto const rate = " " + std::to_string(client.second) + "/S";
+            auto const name = client.first.substr(0, std::max<int>(max_chars - 2 - rate.size(), 0));
+            canvas.text(margin, y, "  " + name + rate);
+            y += line_height;
+        }
+    }
+
+    return canvas;
+}
+}
+
+class mr::PerformanceHud::CompositorReport : public compositor::CompositorReport
+{
+public:
+    CompositorReport(
+        std::shared_ptr<compositor::CompositorReport> const& wrapped,
+        std::shared_ptr<PerformanceHud> const& hud) :
+        wrapped{wrapped},
+        hud{hud}
+    {
+    }
+
+    void added_display(int width, int height, int x, int y, SubCompositorId id) override
+    {
+        wrapped->added_display(width, height, x, y, id);
+        hud->added_display(id, {{x, y}, {width, height}});
+    }
+
+    void began_frame(SubCompositorId id) override
+    {
+        wrapped->began_frame(id);
+        hud->began_frame(id);
+    }
+
+    void renderables_in_frame(SubCompositorId id, graphics::RenderableList const& renderables) override
+    {
+        wrapped->renderables_in_frame(id, renderables);
+    }
+
+    void rendered_frame(SubCompositorId id) override
+    {
+        wrapped->rendered_frame(id);
+        hud->rendered_frame(id);
+    }
+
+    void measured_gpu_render_time(SubCompositorId id, std::chrono::nanoseconds gpu_time) override
+    {
+        wrapped->measured_gpu_render_time(id, gpu_time);
+    }
+
+    void finished_frame(SubCompositorId id) override
+    {
+        wrapped->finished_frame(id);
+        hud->finished_frame(id);
+    }
+
+    void started() override
+    {
+        wrapped->started();
+    }
+
+    void stopped() override
+    {
+        wrapped->stopped();
+    }
+
+    void scheduled() override
+    {
+        wrapped->scheduled();
+        hud->scheduled();
+    }
+
+private:
+    std::shared_ptr<compositor::CompositorReport> const wrapped;
+    std::shared_ptr<PerformanceHud> const hud;
+};
+
+class mr::PerformanceHud::DisplayReport : public graphics::DisplayReport
+{
+public:
+    DisplayReport(
+        std::shared_ptr<graphics::DisplayReport> const& wrapped,
+        std::shared_ptr<PerformanceHud> const& hud) :
+        wrapped{wrapped},
+        hud{hud}
+    {
+    }
+
+    void report_successful_setup_of_native_resources() override
+    {
+        wrapped->report_successful_setup_of_native_resources();
+    }
+
+    void report_successful_egl_make_current_on_construction() override
+    {
+        wrapped->report_successful_egl_make_current_on_construction();
+    }
+
+    void report_successful_egl_buffer_swap_on_construction() override
+    {
+        wrapped->report_successful_egl_buffer_swap_on_construction();
+    }
+
+    void report_successful_display_construction() override
+    {
+        wrapped->report_successful_display_construction();
+    }
+
+    void report_egl_configuration(EGLDisplay disp, EGLConfig cfg) override
+    {
+        wrapped->report_egl_configuration(disp, cfg);
+    }
+
+    void report_vsync(unsigned int output_id, graphics::Frame const& frame) override
+    {
+        wrapped->report_vsync(output_id, frame);
+        hud->vsync(output_id, frame.msc, frame.ust);
+    }
+
+    void report_successful_drm_mode_set_crtc_on_construction() override
+    {
+        wrapped->report_successful_drm_mode_set_crtc_on_construction();
+    }
+
+    void report_drm_master_failure(int error) override
+    {
+        wrapped->report_drm_master_failure(error);
+    }
+
+    void report_vt_switch_away_failure() override
+    {
+        wrapped->report_vt_switch_away_failure();
+    }
+
+    void report_vt_switch_back_failure() override
+    {
+        wrapped->report_vt_switch_back_failure();
+    }
+
+private:
+    std::shared_ptr<graphics::DisplayReport> const wrapped;
+    std::shared_ptr<PerformanceHud> const hud;
+};
+
+mr::PerformanceHud::PerformanceHud(std::shared_ptr<time::Clock> const& clock) :
+    clock{clock},
+    window_start{clock->now()}
+{
+}
+
+auto mr::PerformanceHud::compositor_report(std::shared_ptr<compositor::CompositorReport> const& wrapped)
+    -> std::shared_ptr<compositor::CompositorReport>
+{
+    return std::make_shared<CompositorReport>(wrapped, shared_from_this());
+}
+
+auto mr::PerformanceHud::display_report(std::shared_ptr<graphics::DisplayReport> const& wrapped)
+    -> std::shared_ptr<graphics::DisplayReport>
+{
+    return std::make_shared<DisplayReport>(wrapped, shared_from_this());
+}
+
+void mr::PerformanceHud::added_display(SubCompositorId id, geometry::Rectangle const& area)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    // A display's compositor is replaced when the configuration changes, so forget those it replaces
+    display_order.erase(
+        std::remove_if(
+            display_order.begin(),
+            display_order.end(),
+            [&](SubCompositorId other)
+            {
+                if (other == id || !displays[other].area.overlaps(area))
+                    return false;
+                displays.erase(other);
+                return true;
+            }),
+        display_order.end());
+
+    if (std::find(display_order.begin(), display_order.end(), id) == display_order.end())
+        display_order.push_back(id);
+    displays[id].area = area;
+}
+
+void mr::PerformanceHud::began_frame(SubCompositorId id)
+{
+    auto const now = clock->now();
+
+    std::lock_guard<std::mutex> lock{mutex};
+    auto& display = displays[id];
+    display.start_of_frame = now;
+    display.rendered = false;
+
+    frame_scheduled = scheduled_since;
+    scheduled_since = {};
+}
+
+void mr::PerformanceHud::rendered_frame(SubCompositorId id)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    displays[id].rendered = true;
+}
+
+void mr::PerformanceHud::finished_frame(SubCompositorId id)
+{
+    auto const now = clock->now();
+
+    std::lock_guard<std::mutex> lock{mutex};
+    auto& display = displays[id];
+    display.composited = display.rendered;
+    display.frame_times.push_back(std::chrono::duration_cast<std::chrono::microseconds>(now - display.start_of_frame));
+    if (display.frame_times.size() > static_cast<size_t>(max_frame_times))
+        display.frame_times.pop_front();
+    ++display.frames;
+    ++total_frames;
+}
+
+void mr::PerformanceHud::scheduled()
+{
+    auto const now = time::PosixTimestamp::now(CLOCK_MONOTONIC);
+
+    std::lock_guard<std::mutex> lock{mutex};
+    if (!scheduled_since)
+        scheduled_since = now;
+}
+
+void mr::PerformanceHud::vsync(unsigned int output_id, int64_t msc, time::PosixTimestamp const& ust)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    auto const previous = outputs.find(output_id);
+    if (previous != outputs.end())
+    {
+        // If the frame was asked for before the previous vblank, every vblank since that one went unused
+        auto const& last = previous->second;
+        if (frame_scheduled &&
+            frame_scheduled->clock_id == last.ust.clock_id &&
+            *frame_scheduled < last.ust &&
+            msc > last.msc + 1)
+        {
+            missed_vblanks += msc - last.msc - 1;
+        }
+    }
+    outputs[output_id] = Output{ust, msc};
+}
+
+void mr::PerformanceHud::committed(std::string const& client)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    ++commits[client];
+}
+
+void mr::PerformanceHud::roll_window(std::lock_guard<std::mutex> const&)
+{
+    auto const now = clock->now();
+    auto const elapsed = now - window_start;
+    if (elapsed < rate_window)
+        return;
+
+    auto const per_second = [elapsed](int count)
+        {
+            return static_cast<int>((count * std::chrono::nanoseconds{1s} + elapsed / 2) / elapsed);
+        };
+
+    for (auto& display : displays)
+    {
+        display.second.frames_per_second = per_second(display.second.frames);
+        display.second.frames = 0;
+    }
+
+    missed_vblanks_per_second = per_second(missed_vblanks);
+    missed_vblanks = 0;
+
+    commits_per_second.clear();
+    for (auto const& client : commits)
+        commits_per_second.emplace_back(client.first, per_second(client.second));
+    commits.clear();
+
+    auto const shown = std::min<size_t>(commits_per_second.size(), max_clients_shown);
+    std::partial_sort(
+        commits_per_second.begin(),
+        commits_per_second.begin() + shown,
+        commits_per_second.end(),
+        [](auto const& a, auto const& b) { return a.second > b.second; });
+    commits_per_second.resize(shown);
+
+    window_start = now;
+}
+
+auto mr::PerformanceHud::summary() -> Summary
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    roll_window(lock);
+
+    Summary summary;
+    for (auto const id : display_order)
+    {
+        auto const& display = displays[id];
+        summary.displays.push_back(
+            {display.area,
+             display.frames_per_second,
+             display.composited,
+             {display.frame_times.begin(), display.frame_times.end()}});
+    }
+    summary.missed_vblanks_per_second = missed_vblanks_per_second;
+    summary.commits_per_second = commits_per_second;
+    return summary;
+}
+
+auto mr::PerformanceHud::frames_finished() const -> unsigned long
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    return total_frames;
+}
+
+namespace
+{
+class HudRenderable : public mg::Renderable
+{
+public:
+    HudRenderable(std::shared_ptr<mg::Buffer> const& buffer, geom::Point position) :
+        buffer_{buffer},
+        position{position}
+    {
+    }
+
+    unsigned int swap_interval() const override
+    {
+        return 1;
+    }
+
+    bool tearing_allowed() const override
+    {
+        return false;
+    }
+
+    mg::Renderable::ID id() const override
+    {
+        return this;
+    }
+
+    std::shared_ptr<mg::Buffer> buffer() const override
+    {
+        return buffer_;
+    }
+
+    geom::Rectangle screen_position() const override
+    {
+        return {position, buffer_->size()};
+    }
+
+    geom::RectangleF src_bounds() const override
+    {
+        return {{}, geom::SizeF{buffer_->size()}};
+    }
+
+    std::experimental::optional<geom::Rectangle> clip_area() const override
+    {
+        return std::experimental::optional<geom::Rectangle>();
+    }
+
+    float alpha() const override
+    {
+        return 1.0;
+    }
+
+    glm::mat4 transformation() const override
+    {
+        return glm::mat4(1);
+    }
+
+    bool shaped() const override
+    {
+        return true;
+    }
+
+    std::experimental::optional<geom::Rectangles> damage() const override
+    {
+        // Our buffer never changes; a redrawn HUD gets a new renderable
+        return geom::Rectangles{};
+    }
+
+    geom::Rectangles opaque_region() const override
+    {
+        return {};
+    }
+
+private:
+    std::shared_ptr<mg::Buffer> const buffer_;
+    geom::Point const position;
+};
+
+class CommittingClient : public ms::NullSurfaceObserver
+{
+public:
+    CommittingClient(std::shared_ptr<mr::PerformanceHud> const& hud, std::string const& name) :
+        hud{hud},
+        name{name}
+    {
+    }
+
+    void frame_posted(ms::Surface const*, int, geom::Size const&) override
+    {
+        hud->committed(name);
+    }
+
+private:
+    std::shared_ptr<mr::PerformanceHud> const hud;
+    std::string const name;
+};
+}
+
+class mr::PerformanceHudOverlay::CommitCounter : public ms::NullObserver
+{
+public:
+    explicit CommitCounter(std::shared_ptr<PerformanceHud> const& hud) :
+        hud{hud}
+    {
+    }
+
+    void surface_added(std::shared_ptr<ms::Surface> const& surface) override
+    {
+        std::string name;
+        if (auto const session = surface->session().lock())
+            name = session->name();
+        else
+            name = surface->name();
+
+        auto const observer = std::make_shared<CommittingClient>(hud, name);
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            observers[surface.get()] = {surface, observer};
+        }
+        surface->add_observer(observer);
+    }
+
+    void surface_exists(std::shared_ptr<ms::Surface> const& surface) override
+    {
+        surface_added(surface);
+    }
+
+    void surface_removed(std::shared_ptr<ms::Surface> const& surface) override
+    {
+        std::shared_ptr<ms::SurfaceObserver> observer;
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            auto const counted = observers.find(surface.get());
+            if (counted == observers.end())
+                return;
+            observer = counted->second.second;
+            observers.erase(counted);
+        }
+        surface->remove_observer(observer);
+    }
+
+    void end_observation() override
+    {
+        std::unordered_map<ms::Surface const*, Counted> counted;
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            counted.swap(observers);
+        }
+        for (auto const& surface : counted)
+        {
+            if (auto const live = surface.second.first.lock())
+                live->remove_observer(surface.second.second);
+        }
+    }
+
+private:
+    using Counted = std::pair<std::weak_ptr<ms::Surface>, std::shared_ptr<ms::SurfaceObserver>>;
+
+    std::shared_ptr<PerformanceHud> const hud;
+    std::mutex mutex;
+    std::unordered_map<ms::Surface const*, Counted> observers;
+};
+
+mr::PerformanceHudOverlay::PerformanceHudOverlay(
+    std::shared_ptr<PerformanceHud> const& hud,
+    std::shared_ptr<input::Scene> const& scene,
+    std::shared_ptr<graphics::GraphicBufferAllocator> const& allocator,
+    time::AlarmFactory& alarms,
+    bool shown) :
+    hud{hud},
+    scene{scene},
+    allocator{allocator},
+    commit_counter{std::make_shared<CommitCounter>(hud)},
+    redraw_alarm{alarms.create_alarm([this] { update(); })}
+{
+    scene->add_observer(commit_counter);
+    if (shown)
+        show();
+}
+
+mr::PerformanceHudOverlay::~PerformanceHudOverlay()
+{
+    hide();
+    redraw_alarm->cancel();
+    scene->remove_observer(commit_counter);
+}
+
+bool mr::PerformanceHudOverlay::handle(MirEvent const& event)
+{
+    if (mir_event_get_type(&event) != mir_event_type_input)
+        return false;
+
+    auto const input_event = mir_event_get_input_event(&event);
+    if (mir_input_event_get_type(input_event) != mir_input_event_type_key)
+        return false;
+
+    auto const keyboard_event = mir_input_event_get_keyboard_event(input_event);
+    auto const modifiers = mir_keyboard_event_modifiers(keyboard_event);
+    auto const chord = mir_input_event_modifier_ctrl | mir_input_event_modifier_alt | mir_input_event_modifier_shift;
+
+    if ((modifiers & chord) != chord || mir_keyboard_event_scan_code(keyboard_event) != KEY_H)
+        return false;
+
+    if (mir_keyboard_event_action(keyboard_event) == mir_keyboard_action_down)
+    {
+        bool is_shown;
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            is_shown = shown;
+        }
+
+        if (is_shown)
+            hide();
+        else
+            show();
+    }
+
+    // Swallow the repeats and release too, so the focused client doesn't see half a key press
+    return true;
+}
+
+void mr::PerformanceHudOverlay::show()
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        if (shown)
+            return;
+
+        shown = true;
+        frames_drawn = 0;
+        quiet_updates = 0;
+    }
+
+    // Drawn on the alarm's thread rather than the caller's (which may be the input thread). The alarm isn't
+    // touched under our lock, as its callback takes that.
+    redraw_alarm->reschedule_in(0ms);
+}
+
+void mr::PerformanceHudOverlay::hide()
+{
+    redraw_alarm->cancel();
+
+    std::lock_guard<std::mutex> lock{mutex};
+    shown = false;
+
+    if (renderable)
+    {
+        scene->remove_input_visualization(renderable);
+        renderable.reset();
+    }
+}
+
+void mr::PerformanceHudOverlay::update()
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    if (!shown)
+        return;
+
+    // Safe under our lock from the alarm's own callback
+    redraw_alarm->reschedule_in(redraw_interval);
+
+    auto summary = hud->summary();
+    auto const frames = hud->frames_finished();
+
+    // Drawing the HUD shows a frame on each display, so only frames beyond those are anything new to show
+    if (!renderable || frames > frames_drawn + summary.displays.size())
+    {
+        quiet_updates = 0;
+    }
+    else if (++quiet_updates == updates_until_idle)
+    {
+        for (auto& display : summary.displays)
+            display.frames_per_second = 0;
+    }
+    else
+    {
+        return;
+    }
+
+    frames_drawn = frames;
+    redraw(summary, lock);
+}
+
+void mr::PerformanceHudOverlay::redraw(PerformanceHud::Summary const& summary, std::lock_guard<std::mutex> const&)
+{
+    auto const canvas = draw(summary);
+
+    geom::Point position{margin, margin};
+    if (!summary.displays.empty())
+        position = summary.displays.front().area.top_left + geom::Displacement{margin, margin};
+
+    auto const buffer = mrs::alloc_buffer_with_content(
+        *allocator,
+        reinterpret_cast<unsigned char const*>(canvas.pixels.data()),
+        canvas.size,
+        geom::Stride{canvas.size.width.as_int() * MIR_BYTES_PER_PIXEL(mir_pixel_format_argb_8888)},
+        mir_pixel_format_argb_8888);
+
+    // Add the new renderable before removing the old one, so the HUD doesn't flicker
+    auto const previous = std::move(renderable);
+    renderable = std::make_shared<HudRenderable>(buffer, position);
+    scene->add_input_visualization(renderable);
+    if (previous)
+        scene->remove_input_visualization(previous);
+}
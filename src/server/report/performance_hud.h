@@ -0,0 +1,200 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_REPORT_PERFORMANCE_HUD_H_
+#define MIR_REPORT_PERFORMANCE_HUD_H_
+
+#include "mir/compositor/compositor_report.h"
+#include "mir/geometry/rectangle.h"
+#include "mir/input/event_filter.h"
+#include "mir/time/posix_timestamp.h"
+#include "mir/time/types.h"
+
+#include <chrono>
+#include <deque>
+#include <experimental/optional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mir
+{
+namespace graphics
+{
+class DisplayReport;
+class GraphicBufferAllocator;
+class Renderable;
+}
+namespace input
+{
+class Scene;
+}
+namespace scene
+{
+class Observer;
+}
+namespace time
+{
+class Alarm;
+class AlarmFactory;
+class Clock;
+}
+namespace report
+{
+/**
+ * Gathers what the performance HUD shows: for each display its frame rate, recent frame times and whether it
+ * is composited or bypassed/overlaid; the vblanks missed while there was a frame to show; and the clients that
+ * commit most often. Rates are counted over whole seconds.
+ *
+ * It's fed by the compositor and display reports it wraps, and by PerformanceHudOverlay.
+ */
+class PerformanceHud : public std::enable_shared_from_this<PerformanceHud>
+{
+public:
+    explicit PerformanceHud(std::shared_ptr<time::Clock> const& clock);
+
+    /// Gathers the compositor's frames, forwarding them to \a wrapped
+    auto compositor_report(std::shared_ptr<compositor::CompositorReport> const& wrapped)
+        -> std::shared_ptr<compositor::CompositorReport>;
+
+    /// Gathers the outputs' vblanks, forwarding them to \a wrapped
+    auto display_report(std::shared_ptr<graphics::DisplayReport> const& wrapped)
+        -> std::shared_ptr<graphics::DisplayReport>;
+
+    /// Counts a buffer \a client committed
+    void committed(std::string const& client);
+
+    struct Summary
+    {
+        struct Display
+        {
+            geometry::Rectangle area;
+            int frames_per_second;
+            bool composited;                                    ///< Whether the last frame was rendered
+            std::vector<std::chrono::microseconds> frame_times; ///< Oldest first
+        };
+
+        std::vector<Display> displays;
+        int missed_vblanks_per_second;
+        std::vector<std::pair<std::string, int>> commits_per_second; ///< The busiest clients, busiest first
+    };
+
+    /// What to show now
+    auto summary() -> Summary;
+
+    /// How many frames the displays have finished so far, to tell whether there's anything new to show
+    auto frames_finished() const -> unsigned long;
+
+    static int constexpr max_frame_times{80};
+    static int constexpr max_clients_shown{3};
+
+private:
+    class CompositorReport;
+    class DisplayReport;
+
+    using SubCompositorId = compositor::CompositorReport::SubCompositorId;
+
+    void added_display(SubCompositorId id, geometry::Rectangle const& area);
+    void began_frame(SubCompositorId id);
+    void rendered_frame(SubCompositorId id);
+    void finished_frame(SubCompositorId id);
+    void scheduled();
+    void vsync(unsigned int output_id, int64_t msc, time::PosixTimestamp const& ust);
+
+    /// Starts a new second's counts, if it's time to
+    void roll_window(std::lock_guard<std::mutex> const&);
+
+    std::shared_ptr<time::Clock> const clock;
+
+    struct Display
+    {
+        geometry::Rectangle area;
+        time::Timestamp start_of_frame;
+        bool rendered{false};
+        bool composited{true};
+        std::deque<std::chrono::microseconds> frame_times;
+        int frames{0};
+        int frames_per_second{0};
+    };
+
+    struct Output
+    {
+        time::PosixTimestamp ust;
+        int64_t msc;
+    };
+
+    std::mutex mutable mutex;
+    std::vector<SubCompositorId> display_order;
+    std::unordered_map<SubCompositorId, Display> displays;
+    std::unordered_map<unsigned int, Output> outputs;
+    std::experimental::optional<time::PosixTimestamp> scheduled_since;  ///< Since the last frame began
+    std::experimental::optional<time::PosixTimestamp> frame_scheduled;  ///< When the latest frame was asked for
+    unsigned long total_frames{0};
+    int missed_vblanks{0};
+    int missed_vblanks_per_second{0};
+    std::unordered_map<std::string, int> commits;
+    std::vector<std::pair<std::string, int>> commits_per_second;
+    time::Timestamp window_start;
+};
+
+/**
+ * Draws a PerformanceHud over the top-left of the first display, for as long as it exists
+ *
+ * It counts the commits of the scene's surfaces' clients, and it's an event filter that shows or hides the HUD
+ * on Ctrl+Alt+Shift+H. While shown it's drawn again at most a few times a second, and only after the displays
+ * have shown frames of their own: as a new renderable, like a changed software cursor, so the compositor
+ * damages only the HUD's own area.
+ */
+class PerformanceHudOverlay : public input::EventFilter
+{
+public:
+    PerformanceHudOverlay(
+        std::shared_ptr<PerformanceHud> const& hud,
+        std::shared_ptr<input::Scene> const& scene,
+        std::shared_ptr<graphics::GraphicBufferAllocator> const& allocator,
+        time::AlarmFactory& alarms,
+        bool shown);
+    ~PerformanceHudOverlay();
+
+    bool handle(MirEvent const& event) override;
+
+    void show();
+    void hide();
+
+private:
+    class CommitCounter;
+
+    void update();
+    void redraw(PerformanceHud::Summary const& summary, std::lock_guard<std::mutex> const&);
+
+    std::shared_ptr<PerformanceHud> const hud;
+    std::shared_ptr<input::Scene> const scene;
+    std::shared_ptr<graphics::GraphicBufferAllocator> const allocator;
+    std::shared_ptr<scene::Observer> const commit_counter;
+    std::unique_ptr<time::Alarm> const redraw_alarm;
+
+    std::mutex mutex;
+    bool shown{false};
+    unsigned long frames_drawn{0};
+    int quiet_updates{0};
+    std::shared_ptr<graphics::Renderable> renderable;
+};
+}
+}
+
+#endif /* MIR_REPORT_PERFORMANCE_HUD_H_ */
@@ -0,0 +1,63 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "process_start.h"
+#include "mir/time/clock.h"
+
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+
+#include <time.h>
+#include <unistd.h>
+
+auto mir::report::process_start_time(time::Clock const& clock) -> time::Timestamp
+{
+    auto const now = clock.now();
+
+    std::ifstream stat_file{"/proc/self/stat"};
+    std::string const stat{std::istreambuf_iterator<char>{stat_file}, std::istreambuf_iterator<char>{}};
+
+    // The command may contain spaces, but is the only field in parentheses. After it, starttime is the 20th field.
+    auto const end_of_command = stat.rfind(')');
+    if (end_of_command == std::string::npos)
+        return now;
+
+    std::istringstream fields{stat.substr(end_of_command + 1)};
+    std::string field;
+    for (auto i = 0; i != 20 && fields >> field; ++i)
+    {
+    }
+
+    unsigned long long start_ticks{0};
+    timespec boot_time;
+    if (!(fields >> start_ticks) || clock_gettime(CLOCK_BOOTTIME, &boot_time) != 0)
+        return now;
+
+    // starttime is since boot, so measure the process's age on the same clock
+    auto const ticks_per_second = sysconf(_SC_CLK_TCK);
+    if (ticks_per_second <= 0)
+        return now;
+
+    auto const since_boot = std::chrono::seconds{boot_time.tv_sec} + std::chrono::nanoseconds{boot_time.tv_nsec};
+    std::chrono::nanoseconds const started{start_ticks * 1000000000ull / ticks_per_second};
+
+    if (started > since_boot)
+        return now;
+
+    return now - std::chrono::duration_cast<time::Duration>(since_boot - started);
+}
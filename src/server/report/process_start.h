@@ -0,0 +1,39 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_REPORT_PROCESS_START_H_
+#define MIR_REPORT_PROCESS_START_H_
+
+#include "mir/time/types.h"
+
+namespace mir
+{
+namespace time
+{
+class Clock;
+}
+namespace report
+{
+/**
+ * When this process started, on \a clock
+ *
+ * The kernel records the start in clock ticks (usually 10ms). Where that isn't available, this is now.
+ */
+auto process_start_time(time::Clock const& clock) -> time::Timestamp;
+}
+}
+
+#endif /* MIR_REPORT_PROCESS_START_H_ */
@@ -24,6 +24,9 @@
 namespace mir
 {
 class SharedLibraryProberReport;
+class StartupReport;
+class MemoryReport;
+class LockReport;
 namespace compositor
 {
 class CompositorReport;
@@ -65,6 +68,9 @@ public:
     virtual std::shared_ptr<input::SeatObserver> create_seat_report() = 0;
     virtual std::shared_ptr<SharedLibraryProberReport> create_shared_library_prober_report() = 0;
     virtual std::shared_ptr<shell::ShellReport> create_shell_report() = 0;
+    virtual std::shared_ptr<StartupReport> create_startup_report() = 0;
+    virtual std::shared_ptr<MemoryReport> create_memory_report() = 0;
+    virtual std::shared_ptr<LockReport> create_lock_report() = 0;
 
 protected:
     ReportFactory() = default;
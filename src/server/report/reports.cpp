@@ -17,6 +17,8 @@
  */
 
 #include "reports.h"
+#include "lock_sampler.h"
+#include "memory_sampler.h"
 
 #include "mir/default_server_configuration.h"
 #include "mir/options/option.h"
@@ -24,12 +26,15 @@
 #include "mir/observer_multiplexer.h"
 #include "mir/options/configuration.h"
 #include "mir/abnormal_exit.h"
+#include "mir/main_loop.h"
 
 #include "report_factory.h"
 #include "lttng_report_factory.h"
 #include "logging_report_factory.h"
+#include "metrics_report_factory.h"
 #include "null_report_factory.h"
 
+#include <algorithm>
 #include <string>
 
 namespace mo = mir::options;
@@ -41,7 +46,8 @@ enum class ReportOutput
 {
     Discarded,
     Log,
-    LTTNG
+    LTTNG,
+    Metrics
 };
 
 std::unique_ptr<mr::ReportFactory> factory_for_type(
@@ -56,6 +62,8 @@ std::unique_ptr<mr::ReportFactory> factory_for_type(
         return std::make_unique<mr::LoggingReportFactory>(config.the_logger(), config.the_clock());
     case ReportOutput::LTTNG:
         return std::make_unique<mr::LttngReportFactory>();
+    case ReportOutput::Metrics:
+        return std::make_unique<mr::MetricsReportFactory>(config.the_metrics_registry(), config.the_clock());
     }
 #ifndef __clang__
     /*
@@ -80,6 +88,10 @@ ReportOutput parse_report_option(std::string const& opt)
     {
         return ReportOutput::LTTNG;
     }
+    else if (opt == mo::metrics_opt_value)
+    {
+        return ReportOutput::Metrics;
+    }
     else if (opt == mo::off_opt_value)
     {
         return ReportOutput::Discarded;
@@ -89,7 +101,7 @@ ReportOutput parse_report_option(std::string const& opt)
         throw mir::AbnormalExit(
             std::string("Invalid report option: ") + opt + " (valid options are: \"" +
             mo::off_opt_value + "\" and \"" + mo::log_opt_value +
-            "\" and \"" + mo::lttng_opt_value + "\")");
+            "\" and \"" + mo::lttng_opt_value + "\" and \"" + mo::metrics_opt_value + "\")");
     }
 }
 
@@ -122,6 +134,50 @@ std::shared_ptr<mir::frontend::SessionMediatorObserver> create_session_mediator_
         std::throw_with_nested(mir::AbnormalExit("Failed to create report for "s + mo::session_mediator_report_opt));
     }
 }
+
+auto create_memory_sampler(
+    mir::DefaultServerConfiguration& config,
+    mir::options::Option const& options) -> std::unique_ptr<mr::MemorySampler>
+{
+    using namespace std::string_literals;
+    auto const type = parse_report_option(options.get<std::string>(mo::memory_report_opt));
+    if (type == ReportOutput::Discarded)
+        return nullptr;
+
+    try
+    {
+        return std::make_unique<mr::MemorySampler>(
+            *config.the_main_loop(),
+            std::chrono::seconds{std::max(1, options.get<int>(mo::memory_report_interval_opt))},
+            factory_for_type(config, type)->create_memory_report());
+    }
+    catch (...)
+    {
+        std::throw_with_nested(mir::AbnormalExit("Failed to create report for "s + mo::memory_report_opt));
+    }
+}
+
+auto create_lock_sampler(
+    mir::DefaultServerConfiguration& config,
+    mir::options::Option const& options) -> std::unique_ptr<mr::LockSampler>
+{
+    using namespace std::string_literals;
+    auto const type = parse_report_option(options.get<std::string>(mo::lock_report_opt));
+    if (type == ReportOutput::Discarded)
+        return nullptr;
+
+    try
+    {
+        return std::make_unique<mr::LockSampler>(
+            *config.the_main_loop(),
+            std::chrono::seconds{std::max(1, options.get<int>(mo::lock_report_interval_opt))},
+            factory_for_type(config, type)->create_lock_report());
+    }
+    catch (...)
+    {
+        std::throw_with_nested(mir::AbnormalExit("Failed to create report for "s + mo::lock_report_opt));
+    }
+}
 }
 
 mir::report::Reports::Reports(
@@ -135,9 +191,13 @@ mir::report::Reports::Reports(
           create_session_mediator_reports(
               server,
               options.get<std::string>(mo::session_mediator_report_opt))},
-      session_mediator_observer_multiplexer{server.the_session_mediator_observer_registrar()}
+      session_mediator_observer_multiplexer{server.the_session_mediator_observer_registrar()},
+      memory_sampler{create_memory_sampler(server, options)},
+      lock_sampler{create_lock_sampler(server, options)}
 {
     display_configuration_multiplexer->register_interest(display_configuration_report);
     seat_observer_multiplexer->register_interest(seat_report);
     session_mediator_observer_multiplexer->register_interest(session_mediator_report);
 }
+
+mir::report::Reports::~Reports() = default;
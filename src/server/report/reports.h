@@ -54,11 +54,14 @@ class DisplayConfigurationReport;
 }
 
 class ReportFactory;
+class MemorySampler;
+class LockSampler;
 
 class Reports
 {
 public:
     Reports(DefaultServerConfiguration& server, options::Option const& options);
+    ~Reports();
 
 private:
     std::shared_ptr<logging::DisplayConfigurationReport> const display_configuration_report;
@@ -68,6 +71,8 @@ private:
     std::shared_ptr<frontend::SessionMediatorObserver> const session_mediator_report;
     std::shared_ptr<ObserverRegistrar<frontend::SessionMediatorObserver>> const
         session_mediator_observer_multiplexer;
+    std::unique_ptr<MemorySampler> const memory_sampler;   ///< Only while --memory-report isn't "off"
+    std::unique_ptr<LockSampler> const lock_sampler;       ///< Only while --lock-report isn't "off"
 };
 }
 }
@@ -0,0 +1,82 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "startup_compositor_report.h"
+#include "mir/startup_report.h"
+
+namespace mr = mir::report;
+
+mr::StartupCompositorReport::StartupCompositorReport(
+    std::shared_ptr<compositor::CompositorReport> const& wrapped,
+    std::shared_ptr<StartupReport> const& startup_report) :
+    wrapped{wrapped},
+    startup_report{startup_report}
+{
+}
+
+void mr::StartupCompositorReport::added_display(int width, int height, int x, int y, SubCompositorId id)
+{
+    wrapped->added_display(width, height, x, y, id);
+
+    // A compositing thread adds its display once it has created the renderer for it
+    if (!renderer_created.exchange(true))
+        startup_report->phase_completed(StartupReport::Phase::renderer_created);
+}
+
+void mr::StartupCompositorReport::began_frame(SubCompositorId id)
+{
+    wrapped->began_frame(id);
+}
+
+void mr::StartupCompositorReport::renderables_in_frame(
+    SubCompositorId id, graphics::RenderableList const& renderables)
+{
+    wrapped->renderables_in_frame(id, renderables);
+}
+
+void mr::StartupCompositorReport::rendered_frame(SubCompositorId id)
+{
+    wrapped->rendered_frame(id);
+}
+
+void mr::StartupCompositorReport::measured_gpu_render_time(SubCompositorId id, std::chrono::nanoseconds gpu_time)
+{
+    wrapped->measured_gpu_render_time(id, gpu_time);
+}
+
+void mr::StartupCompositorReport::finished_frame(SubCompositorId id)
+{
+    wrapped->finished_frame(id);
+
+    // Checked without a read-modify-write, as this is on every frame
+    if (!composited.load(std::memory_order_relaxed) && !composited.exchange(true))
+        startup_report->phase_completed(StartupReport::Phase::first_frame);
+}
+
+void mr::StartupCompositorReport::started()
+{
+    wrapped->started();
+}
+
+void mr::StartupCompositorReport::stopped()
+{
+    wrapped->stopped();
+}
+
+void mr::StartupCompositorReport::scheduled()
+{
+    wrapped->scheduled();
+}
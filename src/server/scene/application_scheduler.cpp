@@ -0,0 +1,223 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "application_scheduler.h"
+
+#include "mir/scene/null_surface_observer.h"
+#include "mir/scene/session.h"
+#include "mir/scene/surface.h"
+#include "mir/log.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace ms = mir::scene;
+
+class ms::ApplicationScheduler::VisibilityObserver : public NullSurfaceObserver
+{
+public:
+    explicit VisibilityObserver(ApplicationScheduler* scheduler) : scheduler{scheduler} {}
+
+    void attrib_changed(Surface const* surf, MirWindowAttrib attrib, int value) override
+    {
+        if (attrib == mir_window_attrib_visibility)
+            scheduler->visibility_changed(surf, value == mir_window_visibility_exposed);
+    }
+
+private:
+    ApplicationScheduler* const scheduler;
+};
+
+auto ms::parse_application_scheduling(std::string const& settings) -> ApplicationScheduling
+{
+    ApplicationScheduling result;
+    std::istringstream stream{settings};
+    std::string setting;
+
+    while (stream >> setting)
+    {
+        auto const equals = setting.find('=');
+        auto const key = setting.substr(0, equals);
+        auto const value = equals == std::string::npos ? std::string{} : setting.substr(equals + 1);
+
+        if (value.empty() || value.front() != '/')
+            BOOST_THROW_EXCEPTION(std::invalid_argument{"Expected \"<kind>=<cgroup directory>\", not \"" + setting + "\""});
+
+        if (key == "focused")
+            result.focused = value;
+        else if (key == "visible")
+            result.visible = value;
+        else if (key == "hidden")
+            result.hidden = value;
+        else
+            BOOST_THROW_EXCEPTION(std::invalid_argument{"Unexpected application scheduling setting \"" + setting + "\""});
+    }
+
+    return result;
+}
+
+void ms::move_process_to_cgroup(pid_t pid, std::string const& cgroup)
+{
+    auto const pid_string = std::to_string(pid);
+
+    // cgroup.procs moves every thread of the process, on both cgroup v1 and v2
+    auto const fd = open((cgroup + "/cgroup.procs").c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        log_warning("Failed to open cgroup \"%s\": %s", cgroup.c_str(), strerror(errno));
+        return;
+    }
+
+    if (write(fd, pid_string.c_str(), pid_string.size()) < 0)
+    {
+        // The process may well have exited, so this is no cause for alarm
+        log_debug("Failed to move process %d to cgroup \"%s\": %s", pid, cgroup.c_str(), strerror(errno));
+    }
+    close(fd);
+}
+
+ms::ApplicationScheduler::ApplicationScheduler(ApplicationScheduling const& scheduling, MoveProcess const& move_process) :
+    scheduling{scheduling},
+    move_process{move_process},
+    visibility_observer{std::make_shared<VisibilityObserver>(this)}
+{
+}
+
+void ms::ApplicationScheduler::starting(std::shared_ptr<Session> const& session)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    if (auto const app = application_for(*session, lock))
+        reschedule(session.get(), *app, lock);
+}
+
+void ms::ApplicationScheduler::stopping(std::shared_ptr<Session> const& session)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    applications.erase(session.get());
+    if (focused_session == session.get())
+        focused_session = nullptr;
+}
+
+void ms::ApplicationScheduler::focused(std::shared_ptr<Session> const& session)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    auto const previous = focused_session;
+    focused_session = session.get();
+
+    if (previous == focused_session)
+        return;
+
+    // Demote the old focus before promoting the new, so the two never share the focused cgroup
+    if (auto const app = applications.find(previous); app != applications.end())
+        reschedule(previous, app->second, lock);
+
+    if (auto const app = application_for(*session, lock))
+        reschedule(session.get(), *app, lock);
+}
+
+void ms::ApplicationScheduler::unfocused()
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    auto const previous = focused_session;
+    focused_session = nullptr;
+
+    if (auto const app = applications.find(previous); app != applications.end())
+        reschedule(previous, app->second, lock);
+}
+
+void ms::ApplicationScheduler::surface_created(Session& session, std::shared_ptr<Surface> const& surface)
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        if (!application_for(session, lock))
+            return;
+
+        surface_owners[surface.get()] = &session;
+    }
+
+    surface->add_observer(visibility_observer);
+}
+
+void ms::ApplicationScheduler::destroying_surface(Session& session, std::shared_ptr<Surface> const& surface)
+{
+    surface->remove_observer(visibility_observer);
+
+    std::lock_guard<std::mutex> lock{mutex};
+    surface_owners.erase(surface.get());
+
+    if (auto const app = applications.find(&session); app != applications.end())
+    {
+        if (app->second.exposed.erase(surface.get()))
+            reschedule(&session, app->second, lock);
+    }
+}
+
+void ms::ApplicationScheduler::visibility_changed(Surface const* surface, bool exposed)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    auto const owner = surface_owners.find(surface);
+    if (owner == surface_owners.end())
+        return;
+
+    auto const app = applications.find(owner->second);
+    if (app == applications.end())
+        return;
+
+    auto const changed = exposed ?
+        app->second.exposed.insert(surface).second :
+        app->second.exposed.erase(surface) > 0;
+
+    if (changed)
+        reschedule(owner->second, app->second, lock);
+}
+
+auto ms::ApplicationScheduler::application_for(Session const& session, std::lock_guard<std::mutex> const&)
+    -> Application*
+{
+    if (auto const app = applications.find(&session); app != applications.end())
+        return &app->second;
+
+    auto const pid = session.process_id();
+    if (pid <= 0 || pid == getpid())
+        return nullptr;
+
+    return &applications.emplace(&session, Application{pid, {}, nullptr}).first->second;
+}
+
+void ms::ApplicationScheduler::reschedule(
+    Session const* session,
+    Application& app,
+    std::lock_guard<std::mutex> const&)
+{
+    auto const cgroup =
+        session == focused_session ? &scheduling.focused :
+        !app.exposed.empty() ? &scheduling.visible :
+        &scheduling.hidden;
+
+    if (cgroup == app.cgroup)
+        return;
+
+    app.cgroup = cgroup;
+    if (!cgroup->empty())
+        move_process(app.pid, *cgroup);
+}
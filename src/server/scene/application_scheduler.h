@@ -0,0 +1,110 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MIR_SCENE_APPLICATION_SCHEDULER_H_
+#define MIR_SCENE_APPLICATION_SCHEDULER_H_
+
+#include "mir/scene/session_listener.h"
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <sys/types.h>
+
+namespace mir
+{
+namespace scene
+{
+class SurfaceObserver;
+
+/// The cgroups client processes are moved into as the user's attention moves between them
+struct ApplicationScheduling
+{
+    /// For the focused client
+    std::string focused;
+    /// For other clients with a window on screen
+    std::string visible;
+    /// For clients with nothing on screen
+    std::string hidden;
+};
+
+/**
+ * Parses settings such as "focused=/sys/fs/cgroup/apps/focused hidden=/sys/fs/cgroup/apps/background"
+ *
+ * Clients of a kind without a cgroup are left where they are.
+ * \throws std::invalid_argument if the settings are malformed
+ */
+auto parse_application_scheduling(std::string const& settings) -> ApplicationScheduling;
+
+/// Moves a process into a cgroup, logging (rather than throwing) on failure
+void move_process_to_cgroup(pid_t pid, std::string const& cgroup);
+
+/**
+ * Moves each client process into the cgroup for how much the user is attending to it
+ *
+ * The scheduling of each cgroup (its cpu.weight, cpu.uclamp.min and so on) is up to whoever set them up: this
+ * only decides which one a client belongs in. A process is moved as a whole, threads and all, and only when its
+ * kind changes. The server's own process (for internal clients) is never moved.
+ */
+class ApplicationScheduler : public SessionListener
+{
+public:
+    using MoveProcess = std::function<void(pid_t pid, std::string const& cgroup)>;
+
+    ApplicationScheduler(ApplicationScheduling const& scheduling, MoveProcess const& move_process);
+
+    void starting(std::shared_ptr<Session> const& session) override;
+    void stopping(std::shared_ptr<Session> const& session) override;
+    void focused(std::shared_ptr<Session> const& session) override;
+    void unfocused() override;
+
+    void surface_created(Session& session, std::shared_ptr<Surface> const& surface) override;
+    void destroying_surface(Session& session, std::shared_ptr<Surface> const& surface) override;
+
+    void buffer_stream_created(Session&, std::shared_ptr<frontend::BufferStream> const&) override {}
+    void buffer_stream_destroyed(Session&, std::shared_ptr<frontend::BufferStream> const&) override {}
+
+private:
+    class VisibilityObserver;
+
+    struct Application
+    {
+        pid_t pid;
+        /// The application's surfaces that the compositor has found on screen
+        std::unordered_set<Surface const*> exposed;
+        /// The cgroup it was last moved to
+        std::string const* cgroup;
+    };
+
+    void visibility_changed(Surface const* surface, bool exposed);
+    auto application_for(Session const& session, std::lock_guard<std::mutex> const&) -> Application*;
+    void reschedule(Session const* session, Application& app, std::lock_guard<std::mutex> const&);
+
+    ApplicationScheduling const scheduling;
+    MoveProcess const move_process;
+    std::shared_ptr<VisibilityObserver> const visibility_observer;
+
+    std::mutex mutex;
+    std::unordered_map<Session const*, Application> applications;
+    std::unordered_map<Surface const*, Session const*> surface_owners;
+    Session const* focused_session{nullptr};
+};
+}
+}
+
+#endif /* MIR_SCENE_APPLICATION_SCHEDULER_H_ */
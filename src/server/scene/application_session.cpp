@@ -240,6 +240,25 @@ void ms::ApplicationSession::take_snapshot(SnapshotCallback const& snapshot_take
     snapshot_taken(Snapshot());
 }
 
+void ms::ApplicationSession::take_thumbnail_of(
+    std::shared_ptr<Surface> const& surface,
+    geometry::Size const& max_size,
+    SnapshotCallback const& thumbnail_taken)
+{
+    std::shared_ptr<compositor::BufferStream> content;
+    {
+        std::lock_guard<std::mutex> lock{surfaces_and_streams_mutex};
+        auto const found = default_content_map.find(surface);
+        if (found != default_content_map.end())
+            content = found->second.lock();
+    }
+
+    if (content)
+        snapshot_strategy->take_thumbnail_of(content, max_size, thumbnail_taken);
+    else
+        thumbnail_taken(Snapshot());
+}
+
 std::shared_ptr<ms::Surface> ms::ApplicationSession::default_surface() const
 {
     std::unique_lock<std::mutex> lock(surfaces_and_streams_mutex);
@@ -72,6 +72,10 @@ public:
     auto surface_after(std::shared_ptr<Surface> const& sruface) const -> std::shared_ptr<Surface> override;
 
     void take_snapshot(SnapshotCallback const& snapshot_taken) override;
+    void take_thumbnail_of(
+        std::shared_ptr<Surface> const& surface,
+        geometry::Size const& max_size,
+        SnapshotCallback const& thumbnail_taken) override;
     std::shared_ptr<Surface> default_surface() const override;
 
     std::string name() const override;
@@ -20,11 +20,13 @@
 
 #include "basic_surface.h"
 #include "mir/compositor/buffer_stream.h"
+#include "mir/compositor/presentation.h"
 #include "mir/frontend/event_sink.h"
 #include "mir/shell/input_targeter.h"
 #include "mir/graphics/buffer.h"
 #include "mir/graphics/cursor_image.h"
 #include "mir/graphics/pixel_format_utils.h"
+#include "mir/graphics/texture.h"
 #include "mir/geometry/displacement.h"
 #include "mir/renderer/sw/pixel_source.h"
 
@@ -35,6 +37,8 @@
 
 #include <stdexcept>
 #include <algorithm>
+#include <cmath>
+#include <limits>
 
 #include <string.h> // memcpy
 
@@ -47,34 +51,123 @@ namespace mf = mir::frontend;
 namespace geom = mir::geometry;
 namespace mrs = mir::renderer::software;
 
+namespace
+{
+/// Identifies the property a held back notification is for, so only its latest value is delivered
+enum BatchedChange : int
+{
+    window_size_change,
+    content_size_change,
+    position_change,
+    visibility_change,
+    alpha_change,
+    orientation_change,
+    transformation_change,
+    reception_mode_change,
+    name_change,
+    relative_placement_change,
+    application_id_change,
+    attrib_change   ///< Followed by one key per MirWindowAttrib
+};
+}
+
+template<typename Notify>
+void ms::SurfaceObservers::notify_change(int key, Notify const& notify)
+{
+    if (batching)
+    {
+        std::lock_guard<std::mutex> lock{batch_mutex};
+        if (batching && batch_thread == std::this_thread::get_id())
+        {
+            auto const existing = std::find_if(begin(pending), end(pending), [key](auto const& change)
+                { return change.first == key; });
+
+            if (existing != end(pending))
+                existing->second = notify;
+            else
+                pending.emplace_back(key, notify);
+            return;
+        }
+    }
+
+    notify();
+}
+
+void ms::SurfaceObservers::begin_batch()
+{
+    std::lock_guard<std::mutex> lock{batch_mutex};
+
+    if (!batching)
+    {
+        batch_thread = std::this_thread::get_id();
+        batching = true;
+    }
+
+    // A batch begun on another thread while one is open is ignored (along with its end)
+    if (batch_thread == std::this_thread::get_id())
+        ++batch_depth;
+}
+
+void ms::SurfaceObservers::end_batch()
+{
+    decltype(pending) changes;
+    {
+        std::lock_guard<std::mutex> lock{batch_mutex};
+
+        if (!batching || batch_thread != std::this_thread::get_id() || --batch_depth > 0)
+            return;
+
+        batching = false;
+        changes.swap(pending);
+    }
+
+    for (auto const& change : changes)
+        change.second();
+}
+
 void ms::SurfaceObservers::attrib_changed(Surface const* surf, MirWindowAttrib attrib, int value)
 {
-    for_each([&](std::shared_ptr<SurfaceObserver> const& observer)
-        { observer->attrib_changed(surf, attrib, value); });
+    notify_change(attrib_change + int(attrib), [=]
+        {
+            for_each([&](std::shared_ptr<SurfaceObserver> const& observer)
+                { observer->attrib_changed(surf, attrib, value); });
+        });
 }
 
 void ms::SurfaceObservers::window_resized_to(Surface const* surf, geometry::Size const& window_size)
 {
-    for_each([&](std::shared_ptr<SurfaceObserver> const& observer)
-        { observer->window_resized_to(surf, window_size); });
+    notify_change(window_size_change, [=]
+        {
+            for_each([&](std::shared_ptr<SurfaceObserver> const& observer)
+                { observer->window_resized_to(surf, window_size); });
+        });
 }
 
 void ms::SurfaceObservers::content_resized_to(Surface const* surf, geometry::Size const& content_size)
 {
-    for_each([&](std::shared_ptr<SurfaceObserver> const& observer)
-        { observer->content_resized_to(surf, content_size); });
+    notify_change(content_size_change, [=]
+        {
+            for_each([&](std::shared_ptr<SurfaceObserver> const& observer)
+                { observer->content_resized_to(surf, content_size); });
+        });
 }
 
 void ms::SurfaceObservers::moved_to(Surface const* surf, geometry::Point const& top_left)
 {
-    for_each([&](std::shared_ptr<SurfaceObserver> const& observer)
-        { observer->moved_to(surf, top_left); });
+    notify_change(position_change, [=]
+        {
+            for_each([&](std::shared_ptr<SurfaceObserver> const& observer)
+                { observer->moved_to(surf, top_left); });
+        });
 }
 
 void ms::SurfaceObservers::hidden_set_to(Surface const* surf, bool hide)
 {
-    for_each([&](std::shared_ptr<SurfaceObserver> const& observer)
-        { observer->hidden_set_to(surf, hide); });
+    notify_change(visibility_change, [=]
+        {
+            for_each([&](std::shared_ptr<SurfaceObserver> const& observer)
+                { observer->hidden_set_to(surf, hide); });
+        });
 }
 
 void ms::SurfaceObservers::frame_posted(Surface const* surf, int frames_available, geometry::Size const& size)
@@ -85,20 +178,29 @@ void ms::SurfaceObservers::frame_posted(Surface const* surf, int frames_availabl
 
 void ms::SurfaceObservers::alpha_set_to(Surface const* surf, float alpha)
 {
-    for_each([&](std::shared_ptr<SurfaceObserver> const& observer)
-        { observer->alpha_set_to(surf, alpha); });
+    notify_change(alpha_change, [=]
+        {
+            for_each([&](std::shared_ptr<SurfaceObserver> const& observer)
+                { observer->alpha_set_to(surf, alpha); });
+        });
 }
 
 void ms::SurfaceObservers::orientation_set_to(Surface const* surf, MirOrientation orientation)
 {
-    for_each([&](std::shared_ptr<SurfaceObserver> const& observer)
-        { observer->orientation_set_to(surf, orientation); });
+    notify_change(orientation_change, [=]
+        {
+            for_each([&](std::shared_ptr<SurfaceObserver> const& observer)
+                { observer->orientation_set_to(surf, orientation); });
+        });
 }
 
 void ms::SurfaceObservers::transformation_set_to(Surface const* surf, glm::mat4 const& t)
 {
-    for_each([&](std::shared_ptr<SurfaceObserver> const& observer)
-        { observer->transformation_set_to(surf, t); });
+    notify_change(transformation_change, [=]
+        {
+            for_each([&](std::shared_ptr<SurfaceObserver> const& observer)
+                { observer->transformation_set_to(surf, t); });
+        });
 }
 
 void ms::SurfaceObservers::cursor_image_set_to(Surface const* surf, graphics::CursorImage const& image)
@@ -109,8 +211,11 @@ void ms::SurfaceObservers::cursor_image_set_to(Surface const* surf, graphics::Cu
 
 void ms::SurfaceObservers::reception_mode_set_to(Surface const* surf, input::InputReceptionMode mode)
 {
-    for_each([&](std::shared_ptr<SurfaceObserver> const& observer)
-        { observer->reception_mode_set_to(surf, mode); });
+    notify_change(reception_mode_change, [=]
+        {
+            for_each([&](std::shared_ptr<SurfaceObserver> const& observer)
+                { observer->reception_mode_set_to(surf, mode); });
+        });
 }
 
 void ms::SurfaceObservers::client_surface_close_requested(Surface const* surf)
@@ -131,8 +236,11 @@ void ms::SurfaceObservers::keymap_changed(
 
 void ms::SurfaceObservers::renamed(Surface const* surf, char const* name)
 {
-    for_each([&surf, name](std::shared_ptr<SurfaceObserver> const& observer)
-        { observer->renamed(surf, name); });
+    notify_change(name_change, [surf, name = std::string{name}, this]
+        {
+            for_each([&](std::shared_ptr<SurfaceObserver> const& observer)
+                { observer->renamed(surf, name.c_str()); });
+        });
 }
 
 void ms::SurfaceObservers::cursor_image_removed(Surface const* surf)
@@ -143,8 +251,11 @@ void ms::SurfaceObservers::cursor_image_removed(Surface const* surf)
 
 void ms::SurfaceObservers::placed_relative(Surface const* surf, geometry::Rectangle const& placement)
 {
-    for_each([&](std::shared_ptr<SurfaceObserver> const& observer)
-                 { observer->placed_relative(surf, placement); });
+    notify_change(relative_placement_change, [=]
+        {
+            for_each([&](std::shared_ptr<SurfaceObserver> const& observer)
+                { observer->placed_relative(surf, placement); });
+        });
 }
 
 void ms::SurfaceObservers::input_consumed(Surface const* surf, MirEvent const* event)
@@ -167,11 +278,14 @@ void ms::SurfaceObservers::depth_layer_set_to(Surface const* surf, MirDepthLayer
 
 void ms::SurfaceObservers::application_id_set_to(Surface const* surf, std::string const& application_id)
 {
-    for_each([&](std::shared_ptr<SurfaceObserver> const& observer)
-                 { observer->application_id_set_to(surf, application_id); });
+    notify_change(application_id_change, [=]
+        {
+            for_each([&](std::shared_ptr<SurfaceObserver> const& observer)
+                { observer->application_id_set_to(surf, application_id); });
+        });
 }
 
-ms::BasicSurface::ProofOfMutexLock::ProofOfMutexLock(std::unique_lock<std::mutex> const& lock)
+ms::BasicSurface::ProofOfMutexLock::ProofOfMutexLock(std::unique_lock<ProfiledMutex> const& lock)
 {
     if (!lock.owns_lock())
         fatal_error("ProofOfMutexLock created with unlocked unique_lock");
@@ -258,6 +372,13 @@ auto weak(std::shared_ptr<ms::SurfaceObservers>& observers) -> std::weak_ptr<ms:
 }
 }
 
+namespace
+{
+/// Only the surfaces themselves: their buffers are accounted where they're created
+mir::MemoryAccount scene_surfaces{"scene", "surfaces"};
+mir::LockProfile surface_lock_profile{"BasicSurface"};
+}
+
 ms::BasicSurface::BasicSurface(
     std::shared_ptr<Session> const& session,
     std::string const& name,
@@ -267,13 +388,14 @@ ms::BasicSurface::BasicSurface(
     std::list<StreamInfo> const& layers,
     std::shared_ptr<mg::CursorImage> const& cursor_image,
     std::shared_ptr<SceneReport> const& report) :
+    guard(surface_lock_profile),
     surface_name(name),
     surface_rect(rect),
     transformation_matrix(1),
     surface_alpha(1.0f),
     hidden(false),
     input_mode(mi::InputReceptionMode::normal),
-    custom_input_rectangles(),
+    custom_input_region(),
     surface_buffer_stream(default_stream(layers)),
     cursor_image_(cursor_image),
     report(report),
@@ -281,7 +403,8 @@ ms::BasicSurface::BasicSurface(
     layers(layers),
     confine_pointer_state_(state),
     cursor_stream_adapter{std::make_unique<ms::CursorStreamImageAdapter>(*this)},
-    session_{session}
+    session_{session},
+    charge{scene_surfaces, sizeof(BasicSurface)}
 {
     auto callback = [this, observers=weak(observers)](auto const& size)
         {
@@ -293,6 +416,12 @@ ms::BasicSurface::BasicSurface(
     {
         layer.stream->set_frame_posted_callback(callback);
     }
+
+    {
+        std::lock_guard<ProfiledMutex> lock(guard);
+        update_input_area_bounds(lock);
+    }
+
     report->surface_created(this, surface_name);
 }
 
@@ -318,15 +447,16 @@ ms::BasicSurface::~BasicSurface() noexcept
 
 std::string ms::BasicSurface::name() const
 {
-    std::lock_guard<std::mutex> lock(guard);
+    std::lock_guard<ProfiledMutex> lock(guard);
     return surface_name;
 }
 
 void ms::BasicSurface::move_to(geometry::Point const& top_left)
 {
     {
-        std::lock_guard<std::mutex> lock(guard);
+        std::lock_guard<ProfiledMutex> lock(guard);
         surface_rect.top_left = top_left;
+        update_input_area_bounds(lock);
     }
     observers->moved_to(this, top_left);
 }
@@ -334,27 +464,29 @@ void ms::BasicSurface::move_to(geometry::Point const& top_left)
 void ms::BasicSurface::set_hidden(bool hide)
 {
     {
-        std::lock_guard<std::mutex> lock(guard);
+        std::lock_guard<ProfiledMutex> lock(guard);
         hidden = hide;
     }
+    if (hide)
+        release_textures();
     observers->hidden_set_to(this, hide);
 }
 
 mir::geometry::Size ms::BasicSurface::window_size() const
 {
-    std::lock_guard<std::mutex> lock(guard);
+    std::lock_guard<ProfiledMutex> lock(guard);
     return surface_rect.size;
 }
 
 mir::geometry::Displacement ms::BasicSurface::content_offset() const
 {
-    std::lock_guard<std::mutex> lock(guard);
+    std::lock_guard<ProfiledMutex> lock(guard);
     return geom::Displacement{margins.left, margins.top};
 }
 
 mir::geometry::Size ms::BasicSurface::content_size() const
 {
-    std::lock_guard<std::mutex> lock(guard);
+    std::lock_guard<ProfiledMutex> lock(guard);
     return content_size(lock);
 }
 
@@ -366,8 +498,12 @@ std::shared_ptr<mf::BufferStream> ms::BasicSurface::primary_buffer_stream() cons
 
 void ms::BasicSurface::set_input_region(std::vector<geom::Rectangle> const& input_rectangles)
 {
-    std::lock_guard<std::mutex> lock(guard);
-    custom_input_rectangles = input_rectangles;
+    std::lock_guard<ProfiledMutex> lock(guard);
+    if (input_rectangles.empty())
+        custom_input_region = std::experimental::nullopt;
+    else
+        custom_input_region = geom::Region{input_rectangles};
+    update_input_area_bounds(lock);
 }
 
 void ms::BasicSurface::resize(geom::Size const& desired_size)
@@ -376,10 +512,11 @@ void ms::BasicSurface::resize(geom::Size const& desired_size)
     if (new_size.width <= geom::Width{0})   new_size.width = geom::Width{1};
     if (new_size.height <= geom::Height{0}) new_size.height = geom::Height{1};
 
-    std::unique_lock<std::mutex> lock(guard);
+    std::unique_lock<ProfiledMutex> lock(guard);
     if (new_size != surface_rect.size)
     {
         surface_rect.size = new_size;
+        update_input_area_bounds(lock);
         auto const content_size_ = content_size(lock);
 
         lock.unlock();
@@ -390,20 +527,24 @@ void ms::BasicSurface::resize(geom::Size const& desired_size)
 
 geom::Point ms::BasicSurface::top_left() const
 {
-    std::lock_guard<std::mutex> lock(guard);
+    std::lock_guard<ProfiledMutex> lock(guard);
     return surface_rect.top_left;
 }
 
 geom::Rectangle ms::BasicSurface::input_bounds() const
 {
-    std::lock_guard<std::mutex> lock(guard);
+    std::lock_guard<ProfiledMutex> lock(guard);
     return geom::Rectangle{content_top_left(lock), content_size(lock)};
 }
 
 // TODO: Does not account for transformation().
 bool ms::BasicSurface::input_area_contains(geom::Point const& point) const
 {
-    std::lock_guard<std::mutex> lock(guard);
+    // Hit-testing asks every surface in the stack, most of which are nowhere near the point
+    if (!input_area_bounds_contain(point))
+        return false;
+
+    std::lock_guard<ProfiledMutex> lock(guard);
 
     if (!visible(lock))
         return false;
@@ -414,28 +555,20 @@ bool ms::BasicSurface::input_area_contains(geom::Point const& point) const
             return false;
     }
 
-    if (custom_input_rectangles.empty())
+    if (!custom_input_region)
     {
         // no custom input, restrict to bounding rectangle
         auto const input_rect = geom::Rectangle{content_top_left(lock), content_size(lock)};
         return input_rect.contains(point);
     }
-    else
-    {
-        auto local_point = as_point(point - content_top_left(lock));
-        for (auto const& rectangle : custom_input_rectangles)
-        {
-            if (rectangle.contains(local_point))
-                return true;
-        }
-    }
-    return false;
+
+    return custom_input_region.value().contains(as_point(point - content_top_left(lock)));
 }
 
 void ms::BasicSurface::set_alpha(float alpha)
 {
     {
-        std::lock_guard<std::mutex> lock(guard);
+        std::lock_guard<ProfiledMutex> lock(guard);
         surface_alpha = alpha;
     }
     observers->alpha_set_to(this, alpha);
@@ -449,7 +582,7 @@ void ms::BasicSurface::set_orientation(MirOrientation orientation)
 void ms::BasicSurface::set_transformation(glm::mat4 const& t)
 {
     {
-        std::lock_guard<std::mutex> lock(guard);
+        std::lock_guard<ProfiledMutex> lock(guard);
         transformation_matrix = t;
     }
     observers->transformation_set_to(this, t);
@@ -457,7 +590,7 @@ void ms::BasicSurface::set_transformation(glm::mat4 const& t)
 
 bool ms::BasicSurface::visible() const
 {
-    std::lock_guard<std::mutex> lock(guard);
+    std::lock_guard<ProfiledMutex> lock(guard);
     return visible(lock);
 }
 
@@ -477,7 +610,7 @@ mi::InputReceptionMode ms::BasicSurface::reception_mode() const
 void ms::BasicSurface::set_reception_mode(mi::InputReceptionMode mode)
 {
     {
-        std::lock_guard<std::mutex> lk(guard);
+        std::lock_guard<ProfiledMutex> lk(guard);
         input_mode = mode;
     }
     observers->reception_mode_set_to(this, mode);
@@ -485,7 +618,7 @@ void ms::BasicSurface::set_reception_mode(mi::InputReceptionMode mode)
 
 MirWindowType ms::BasicSurface::type() const
 {
-    std::lock_guard<std::mutex> lock(guard);
+    std::lock_guard<ProfiledMutex> lock(guard);
     return type_;
 }
 
@@ -497,7 +630,7 @@ MirWindowType ms::BasicSurface::set_type(MirWindowType t)
             "type."));
     }
 
-    std::unique_lock<std::mutex> lock(guard);
+    std::unique_lock<ProfiledMutex> lock(guard);
     if (type_ != t)
     {
         type_ = t;
@@ -511,7 +644,7 @@ MirWindowType ms::BasicSurface::set_type(MirWindowType t)
 
 MirWindowState ms::BasicSurface::state() const
 {
-    std::lock_guard<std::mutex> lock(guard);
+    std::lock_guard<ProfiledMutex> lock(guard);
     return state_;
 }
 
@@ -520,12 +653,14 @@ MirWindowState ms::BasicSurface::set_state(MirWindowState s)
     if (s < mir_window_state_unknown || s >= mir_window_states)
         BOOST_THROW_EXCEPTION(std::logic_error("Invalid surface state."));
 
-    std::unique_lock<std::mutex> lock(guard);
+    std::unique_lock<ProfiledMutex> lock(guard);
     if (state_ != s)
     {
         state_ = s;
 
         lock.unlock();
+        if (s == mir_window_state_minimized || s == mir_window_state_hidden)
+            release_textures();
         observers->attrib_changed(this, mir_window_attrib_state, s);
     }
 
@@ -539,7 +674,7 @@ int ms::BasicSurface::set_swap_interval(int interval)
         BOOST_THROW_EXCEPTION(std::logic_error("Invalid swapinterval"));
     }
 
-    std::unique_lock<std::mutex> lock(guard);
+    std::unique_lock<ProfiledMutex> lock(guard);
     if (swapinterval_ != interval)
     {
         swapinterval_ = interval;
@@ -561,7 +696,7 @@ MirOrientationMode ms::BasicSurface::set_preferred_orientation(MirOrientationMod
         BOOST_THROW_EXCEPTION(std::logic_error("Invalid orientation mode"));
     }
 
-    std::unique_lock<std::mutex> lock(guard);
+    std::unique_lock<ProfiledMutex> lock(guard);
     if (pref_orientation_mode != new_orientation_mode)
     {
         pref_orientation_mode = new_orientation_mode;
@@ -608,7 +743,7 @@ int ms::BasicSurface::configure(MirWindowAttrib attrib, int value)
 
 int ms::BasicSurface::query(MirWindowAttrib attrib) const
 {
-    std::lock_guard<std::mutex> lock(guard);
+    std::lock_guard<ProfiledMutex> lock(guard);
     switch (attrib)
     {
         case mir_window_attrib_type: return type_;
@@ -636,7 +771,7 @@ void ms::BasicSurface::show()
 void ms::BasicSurface::set_cursor_image(std::shared_ptr<mg::CursorImage> const& image)
 {
     {
-        std::lock_guard<std::mutex> lock(guard);
+        std::lock_guard<ProfiledMutex> lock(guard);
         cursor_stream_adapter->reset();
 
         cursor_image_ = image;
@@ -651,7 +786,7 @@ void ms::BasicSurface::set_cursor_image(std::shared_ptr<mg::CursorImage> const&
 void ms::BasicSurface::remove_cursor_image()
 {
     {
-        std::lock_guard<std::mutex> lock(guard);
+        std::lock_guard<ProfiledMutex> lock(guard);
         cursor_image_ = nullptr;
     }
     observers->cursor_image_removed(this);
@@ -659,7 +794,7 @@ void ms::BasicSurface::remove_cursor_image()
 
 std::shared_ptr<mg::CursorImage> ms::BasicSurface::cursor_image() const
 {
-    std::lock_guard<std::mutex> lock(guard);
+    std::lock_guard<ProfiledMutex> lock(guard);
     return cursor_image_;
 }
 
@@ -702,7 +837,7 @@ void ms::BasicSurface::set_cursor_from_buffer(
 {
     auto image = std::make_shared<CursorImageFromBuffer>(buffer, hotspot);
     {
-        std::lock_guard<std::mutex> lock(guard);
+        std::lock_guard<ProfiledMutex> lock(guard);
         cursor_image_ = image;
     }
     observers->cursor_image_set_to(this, *image);
@@ -728,7 +863,7 @@ void ms::BasicSurface::request_client_surface_close()
 
 int ms::BasicSurface::dpi() const
 {
-    std::lock_guard<std::mutex> lock(guard);
+    std::lock_guard<ProfiledMutex> lock(guard);
     return dpi_;
 }
 
@@ -739,7 +874,7 @@ int ms::BasicSurface::set_dpi(int new_dpi)
         BOOST_THROW_EXCEPTION(std::logic_error("Invalid DPI value"));
     }
 
-    std::unique_lock<std::mutex> lock(guard);
+    std::unique_lock<ProfiledMutex> lock(guard);
     if (dpi_ != new_dpi)
     {
         dpi_ = new_dpi;
@@ -759,7 +894,7 @@ MirWindowVisibility ms::BasicSurface::set_visibility(MirWindowVisibility new_vis
         BOOST_THROW_EXCEPTION(std::logic_error("Invalid visibility value"));
     }
 
-    std::unique_lock<std::mutex> lock(guard);
+    std::unique_lock<ProfiledMutex> lock(guard);
     if (visibility_ != new_visibility)
     {
         visibility_ = new_visibility;
@@ -770,12 +905,39 @@ MirWindowVisibility ms::BasicSurface::set_visibility(MirWindowVisibility new_vis
             for (auto& info : layers)
                 info.stream->drop_old_buffers();
         }
+        else
+        {
+            release_textures();
+        }
         observers->attrib_changed(this, mir_window_attrib_visibility, visibility_);
     }
 
     return new_visibility;
 }
 
+void ms::BasicSurface::release_textures()
+{
+    std::vector<std::shared_ptr<mc::BufferStream>> streams;
+    {
+        std::lock_guard<ProfiledMutex> lock(guard);
+        for (auto const& info : layers)
+            streams.push_back(info.stream);
+    }
+
+    for (auto const& stream : streams)
+    {
+        if (!stream->has_submitted_buffer())
+            continue;
+
+        stream->with_most_recent_buffer_do(
+            [](mg::Buffer& buffer)
+            {
+                if (auto const texture = dynamic_cast<mg::gl::ReleasableTexture*>(buffer.native_buffer_base()))
+                    texture->release_texture();
+            });
+    }
+}
+
 void ms::BasicSurface::add_observer(std::shared_ptr<SurfaceObserver> const& observer)
 {
     observers->add(observer);
@@ -789,9 +951,19 @@ void ms::BasicSurface::remove_observer(std::weak_ptr<SurfaceObserver> const& obs
     observers->remove(o);
 }
 
+void ms::BasicSurface::begin_batched_changes()
+{
+    observers->begin_batch();
+}
+
+void ms::BasicSurface::end_batched_changes()
+{
+    observers->end_batch();
+}
+
 std::shared_ptr<ms::Surface> ms::BasicSurface::parent() const
 {
-    std::lock_guard<std::mutex> lock(guard);
+    std::lock_guard<ProfiledMutex> lock(guard);
     return parent_.lock();
 }
 
@@ -808,10 +980,12 @@ public:
         std::experimental::optional<geom::Rectangle> const& clip_area,
         glm::mat4 const& transform,
         float alpha,
+        bool tearing_allowed,
         mg::Renderable::ID id)
     : underlying_buffer_stream{stream},
       compositor_id{compositor_id},
       alpha_{alpha},
+      tearing_allowed_{tearing_allowed},
       screen_position_(position),
       clip_area_(clip_area),
       transformation_(transform),
@@ -828,6 +1002,11 @@ public:
         return underlying_buffer_stream->framedropping() ? 0 : 1;
     }
 
+    bool tearing_allowed() const override
+    {
+        return tearing_allowed_;
+    }
+
     std::shared_ptr<mg::Buffer> buffer() const override
     {
         if (!compositor_buffer)
@@ -838,6 +1017,9 @@ public:
     geom::Rectangle screen_position() const override
     { return screen_position_; }
 
+    geom::RectangleF src_bounds() const override
+    { return underlying_buffer_stream->source_bounds(buffer()->size()); }
+
     std::experimental::optional<geom::Rectangle> clip_area() const override
     { return clip_area_; }
 
@@ -852,11 +1034,78 @@ public:
 
     mg::Renderable::ID id() const override
     { return id_; }
+
+    std::experimental::optional<geom::Rectangles> damage() const override
+    {
+        auto const buf = buffer();
+        auto const buffer_damage = underlying_buffer_stream->buffer_damage(compositor_id);
+        if (!buffer_damage)
+            return std::experimental::nullopt;
+
+        // Map from (the shown part of) buffer coordinates to screen coordinates, rounding outwards
+        auto const src = underlying_buffer_stream->source_bounds(buf->size());
+        if (src.size.width.as_value() <= 0 || src.size.height.as_value() <= 0)
+            return std::experimental::nullopt;
+
+        float const x_scale = screen_position_.size.width.as_int() / src.size.width.as_value();
+        float const y_scale = screen_position_.size.height.as_int() / src.size.height.as_value();
+        float const x_offset = src.top_left.x.as_value();
+        float const y_offset = src.top_left.y.as_value();
+
+        geom::Rectangles result;
+        for (auto const& rect : buffer_damage.value())
+        {
+            int const left = std::floor((rect.left().as_int() - x_offset) * x_scale);
+            int const top = std::floor((rect.top().as_int() - y_offset) * y_scale);
+            int const right = std::ceil((rect.right().as_int() - x_offset) * x_scale);
+            int const bottom = std::ceil((rect.bottom().as_int() - y_offset) * y_scale);
+
+            auto const screen_rect = geom::Rectangle{
+                screen_position_.top_left + geom::Displacement{left, top},
+                geom::Size{right - left, bottom - top}}.intersection_with(screen_position_);
+
+            if (screen_rect.size != geom::Size{})
+                result.add(screen_rect);
+        }
+        return result;
+    }
+
+    geom::Rectangles opaque_region() const override
+    {
+        auto const stream_region = underlying_buffer_stream->opaque_region();
+        auto const stream_size = underlying_buffer_stream->stream_size();
+        if (stream_size.width.as_int() <= 0 || stream_size.height.as_int() <= 0)
+            return {};
+
+        float const x_scale = float(screen_position_.size.width.as_int()) / stream_size.width.as_int();
+        float const y_scale = float(screen_position_.size.height.as_int()) / stream_size.height.as_int();
+
+        // Map from stream coordinates to screen coordinates, rounding inwards
+        geom::Rectangles result;
+        for (auto const& rect : stream_region)
+        {
+            int const left = std::ceil(rect.left().as_int() * x_scale);
+            int const top = std::ceil(rect.top().as_int() * y_scale);
+            int const right = std::floor(rect.right().as_int() * x_scale);
+            int const bottom = std::floor(rect.bottom().as_int() * y_scale);
+            if (right <= left || bottom <= top)
+                continue;
+
+            auto const screen_rect = geom::Rectangle{
+                screen_position_.top_left + geom::Displacement{left, top},
+                geom::Size{right - left, bottom - top}}.intersection_with(screen_position_);
+
+            if (screen_rect.size != geom::Size{})
+                result.add(screen_rect);
+        }
+        return result;
+    }
 private:
     std::shared_ptr<mc::BufferStream> const underlying_buffer_stream;
     std::shared_ptr<mg::Buffer> mutable compositor_buffer;
     void const*const compositor_id;
     float const alpha_;
+    bool const tearing_allowed_;
     geom::Rectangle const screen_position_;
     std::experimental::optional<geom::Rectangle> const clip_area_;
     glm::mat4 const transformation_;
@@ -866,7 +1115,7 @@ private:
 
 int ms::BasicSurface::buffers_ready_for_compositor(void const* id) const
 {
-    std::lock_guard<std::mutex> lock(guard);
+    std::lock_guard<ProfiledMutex> lock(guard);
     auto max_buf = 0;
     for (auto const& info : layers)
         max_buf = std::max(max_buf, info.stream->buffers_ready_for_compositor(id));
@@ -886,7 +1135,7 @@ void ms::BasicSurface::set_keymap(MirInputDeviceId id, std::string const& model,
 
 void ms::BasicSurface::rename(std::string const& title)
 {
-    std::unique_lock<std::mutex> lock(guard);
+    std::unique_lock<ProfiledMutex> lock(guard);
     if (surface_name != title)
     {
         surface_name = title;
@@ -900,7 +1149,7 @@ void ms::BasicSurface::set_streams(std::list<scene::StreamInfo> const& s)
 {
     geom::Point surface_top_left;
     {
-        std::lock_guard<std::mutex> lock(guard);
+        std::lock_guard<ProfiledMutex> lock(guard);
         for(auto& layer : layers)
             layer.stream->set_frame_posted_callback([](auto){});
 
@@ -920,7 +1169,7 @@ void ms::BasicSurface::set_streams(std::list<scene::StreamInfo> const& s)
 
 mg::RenderableList ms::BasicSurface::generate_renderables(mc::CompositorID id) const
 {
-    std::lock_guard<std::mutex> lock(guard);
+    std::lock_guard<ProfiledMutex> lock(guard);
     mg::RenderableList list;
     
     if (clip_area_)
@@ -945,7 +1194,7 @@ mg::RenderableList ms::BasicSurface::generate_renderables(mc::CompositorID id) c
                 info.stream, id,
                 geom::Rectangle{content_top_left_ + info.displacement, std::move(size)},
                 clip_area_,
-                transformation_matrix, surface_alpha, info.stream.get()));
+                transformation_matrix, surface_alpha, tearing_allowed_, info.stream.get()));
         }
     }
     return list;
@@ -953,16 +1202,57 @@ mg::RenderableList ms::BasicSurface::generate_renderables(mc::CompositorID id) c
 
 void ms::BasicSurface::set_confine_pointer_state(MirPointerConfinementState state)
 {
-    std::lock_guard<std::mutex> lock(guard);
+    std::lock_guard<ProfiledMutex> lock(guard);
     confine_pointer_state_ = state;
 }
 
 MirPointerConfinementState ms::BasicSurface::confine_pointer_state() const
 {
-    std::lock_guard<std::mutex> lock(guard);
+    std::lock_guard<ProfiledMutex> lock(guard);
     return confine_pointer_state_;
 }
 
+void ms::BasicSurface::set_tearing_allowed(bool allowed)
+{
+    std::lock_guard<ProfiledMutex> lock(guard);
+    tearing_allowed_ = allowed;
+}
+
+bool ms::BasicSurface::tearing_allowed() const
+{
+    std::lock_guard<ProfiledMutex> lock(guard);
+    return tearing_allowed_;
+}
+
+void ms::BasicSurface::presented(mg::Renderable::ID renderable, mc::Presentation const& presentation)
+{
+    std::shared_ptr<mc::BufferStream> stream;
+    {
+        std::lock_guard<ProfiledMutex> lock(guard);
+        // Our renderables are identified by their streams
+        for (auto const& info : layers)
+        {
+            if (info.stream.get() == renderable)
+                stream = info.stream;
+        }
+    }
+
+    if (stream)
+        stream->frame_presented(presentation);
+}
+
+void ms::BasicSurface::set_max_frame_rate(float frames_per_second)
+{
+    std::lock_guard<ProfiledMutex> lock(guard);
+    max_frame_rate_ = std::max(frames_per_second, 0.0f);
+}
+
+float ms::BasicSurface::max_frame_rate() const
+{
+    std::lock_guard<ProfiledMutex> lock(guard);
+    return max_frame_rate_;
+}
+
 void ms::BasicSurface::placed_relative(geometry::Rectangle const& placement)
 {
     observers->placed_relative(this, placement);
@@ -975,14 +1265,14 @@ void mir::scene::BasicSurface::start_drag_and_drop(std::vector<uint8_t> const& h
 
 auto mir::scene::BasicSurface::depth_layer() const -> MirDepthLayer
 {
-    std::lock_guard<std::mutex> lock(guard);
+    std::lock_guard<ProfiledMutex> lock(guard);
     return depth_layer_;
 }
 
 void mir::scene::BasicSurface::set_depth_layer(MirDepthLayer depth_layer)
 {
     {
-        std::lock_guard<std::mutex> lock(guard);
+        std::lock_guard<ProfiledMutex> lock(guard);
         depth_layer_ = depth_layer;
     }
     observers->depth_layer_set_to(this, depth_layer);
@@ -990,19 +1280,20 @@ void mir::scene::BasicSurface::set_depth_layer(MirDepthLayer depth_layer)
 
 std::experimental::optional<geom::Rectangle> mir::scene::BasicSurface::clip_area() const
 {
-    std::lock_guard<std::mutex> lock(guard);
+    std::lock_guard<ProfiledMutex> lock(guard);
     return clip_area_;
 }
 
 void mir::scene::BasicSurface::set_clip_area(std::experimental::optional<geom::Rectangle> const& area)
 {
-    std::lock_guard<std::mutex> lock(guard);
+    std::lock_guard<ProfiledMutex> lock(guard);
     clip_area_ = area;
+    update_input_area_bounds(lock);
 }
 
 auto mir::scene::BasicSurface::focus_state() const -> MirWindowFocusState
 {
-    std::lock_guard<std::mutex> lock(guard);
+    std::lock_guard<ProfiledMutex> lock(guard);
     return focus_;
 }
 
@@ -1014,7 +1305,7 @@ void mir::scene::BasicSurface::set_focus_state(MirWindowFocusState new_state)
         BOOST_THROW_EXCEPTION(std::logic_error("Invalid focus state."));
     }
 
-    std::unique_lock<std::mutex> lock(guard);
+    std::unique_lock<ProfiledMutex> lock(guard);
     if (focus_ != new_state)
     {
         focus_ = new_state;
@@ -1026,13 +1317,13 @@ void mir::scene::BasicSurface::set_focus_state(MirWindowFocusState new_state)
 
 auto mir::scene::BasicSurface::application_id() const -> std::string
 {
-    std::lock_guard<std::mutex> lock(guard);
+    std::lock_guard<ProfiledMutex> lock(guard);
     return application_id_;
 }
 
 void mir::scene::BasicSurface::set_application_id(std::string const& application_id)
 {
-    std::unique_lock<std::mutex> lock(guard);
+    std::unique_lock<ProfiledMutex> lock(guard);
     if (application_id_ != application_id)
     {
         application_id_ = application_id;
@@ -1044,7 +1335,7 @@ void mir::scene::BasicSurface::set_application_id(std::string const& application
 
 auto mir::scene::BasicSurface::session() const -> std::weak_ptr<Session>
 {
-    std::lock_guard<std::mutex> lock(guard);
+    std::lock_guard<ProfiledMutex> lock(guard);
     return session_;
 }
 
@@ -1059,7 +1350,7 @@ void mir::scene::BasicSurface::set_window_margins(
     bottom = std::max(bottom, geom::DeltaY{});
     right  = std::max(right,  geom::DeltaX{});
 
-    std::unique_lock<std::mutex> lock(guard);
+    std::unique_lock<ProfiledMutex> lock(guard);
     if (top    != margins.top    ||
         left   != margins.left   ||
         bottom != margins.bottom ||
@@ -1069,6 +1360,7 @@ void mir::scene::BasicSurface::set_window_margins(
         margins.left   = left;
         margins.bottom = bottom;
         margins.right  = right;
+        update_input_area_bounds(lock);
 
         auto const size = content_size(lock);
         lock.unlock();
@@ -1088,3 +1380,61 @@ auto mir::scene::BasicSurface::content_top_left(ProofOfMutexLock const&) const -
 {
     return surface_rect.top_left + geom::Displacement{margins.left, margins.top};
 }
+
+void mir::scene::BasicSurface::update_input_area_bounds(ProofOfMutexLock const& lock)
+{
+    auto const content_top_left_ = content_top_left(lock);
+    auto const content_rect = geom::Rectangle{content_top_left_, content_size(lock)};
+
+    auto left = content_rect.left().as_int();
+    auto top = content_rect.top().as_int();
+    auto right = content_rect.right().as_int();
+    auto bottom = content_rect.bottom().as_int();
+
+    if (custom_input_region)
+    {
+        auto const bounds = custom_input_region.value().bounding_rectangle();
+        auto const rect = geom::Rectangle{content_top_left_ + as_displacement(bounds.top_left), bounds.size};
+        left = rect.left().as_int();
+        top = rect.top().as_int();
+        right = rect.right().as_int();
+        bottom = rect.bottom().as_int();
+    }
+
+    if (clip_area_)
+    {
+        left = std::max(left, clip_area_.value().left().as_int());
+        top = std::max(top, clip_area_.value().top().as_int());
+        right = std::min(right, clip_area_.value().right().as_int());
+        bottom = std::min(bottom, clip_area_.value().bottom().as_int());
+    }
+
+    auto const sequence = input_area_bounds.sequence.load(std::memory_order_relaxed);
+    input_area_bounds.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    input_area_bounds.left.store(left, std::memory_order_relaxed);
+    input_area_bounds.top.store(top, std::memory_order_relaxed);
+    input_area_bounds.right.store(right, std::memory_order_relaxed);
+    input_area_bounds.bottom.store(bottom, std::memory_order_relaxed);
+    input_area_bounds.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+auto mir::scene::BasicSurface::input_area_bounds_contain(geometry::Point const& point) const -> bool
+{
+    auto const x = point.x.as_int();
+    auto const y = point.y.as_int();
+
+    while (true)
+    {
+        auto const sequence = input_area_bounds.sequence.load(std::memory_order_acquire);
+        bool const contains =
+            x >= input_area_bounds.left.load(std::memory_order_relaxed) &&
+            y >= input_area_bounds.top.load(std::memory_order_relaxed) &&
+            x < input_area_bounds.right.load(std::memory_order_relaxed) &&
+            y < input_area_bounds.bottom.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (!(sequence & 1) && sequence == input_area_bounds.sequence.load(std::memory_order_relaxed))
+            return contains;
+    }
+}
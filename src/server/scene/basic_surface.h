@@ -24,10 +24,14 @@
 #include "mir/scene/surface_observers.h"
 
 #include "mir/geometry/rectangle.h"
+#include "mir/geometry/region.h"
+#include "mir/memory_account.h"
+#include "mir/profiled_mutex.h"
 
 #include "mir_toolkit/common.h"
 
 #include <glm/glm.hpp>
+#include <atomic>
 #include <vector>
 #include <list>
 #include <memory>
@@ -134,6 +138,8 @@ public:
 
     void add_observer(std::shared_ptr<SurfaceObserver> const& observer) override;
     void remove_observer(std::weak_ptr<SurfaceObserver> const& observer) override;
+    void begin_batched_changes() override;
+    void end_batched_changes() override;
 
     int dpi() const;
 
@@ -144,6 +150,11 @@ public:
 
     void set_confine_pointer_state(MirPointerConfinementState state) override;
     MirPointerConfinementState confine_pointer_state() const override;
+    void set_tearing_allowed(bool allowed) override;
+    bool tearing_allowed() const override;
+    void set_max_frame_rate(float frames_per_second) override;
+    float max_frame_rate() const override;
+    void presented(graphics::Renderable::ID renderable, compositor::Presentation const& presentation) override;
     void placed_relative(geometry::Rectangle const& placement) override;
     void start_drag_and_drop(std::vector<uint8_t> const& handle) override;
 
@@ -170,8 +181,8 @@ public:
 private:
     struct ProofOfMutexLock
     {
-        ProofOfMutexLock(std::lock_guard<std::mutex> const&) {}
-        ProofOfMutexLock(std::unique_lock<std::mutex> const& lock);
+        ProofOfMutexLock(std::lock_guard<ProfiledMutex> const&) {}
+        ProofOfMutexLock(std::unique_lock<ProfiledMutex> const& lock);
         ProofOfMutexLock(ProofOfMutexLock const&) = delete;
         ProofOfMutexLock operator=(ProofOfMutexLock const&) = delete;
     };
@@ -181,20 +192,27 @@ private:
     MirWindowState set_state(MirWindowState s);
     int set_dpi(int);
     MirWindowVisibility set_visibility(MirWindowVisibility v);
+    /// Lets the platform free the textures of our buffers, while they aren't being drawn
+    void release_textures();
     int set_swap_interval(int);
     MirOrientationMode set_preferred_orientation(MirOrientationMode mode);
     auto content_size(ProofOfMutexLock const&) const -> geometry::Size;
     auto content_top_left(ProofOfMutexLock const&) const -> geometry::Point;
+    /// Must be called after any change to the state input_area_contains() depends on (other than visibility)
+    void update_input_area_bounds(ProofOfMutexLock const&);
+    /// False if point is certainly outside the input area. Doesn't lock guard.
+    auto input_area_bounds_contain(geometry::Point const& point) const -> bool;
 
     std::shared_ptr<SurfaceObservers> observers = std::make_shared<SurfaceObservers>();
-    std::mutex mutable guard;
+    ProfiledMutex mutable guard;
     std::string surface_name;
     geometry::Rectangle surface_rect;
     glm::mat4 transformation_matrix;
     float surface_alpha;
     bool hidden;
     input::InputReceptionMode input_mode;
-    std::vector<geometry::Rectangle> custom_input_rectangles;
+    /// Relative to the content, and unset while input goes to the whole of it
+    std::experimental::optional<geometry::Region> custom_input_region;
     std::shared_ptr<compositor::BufferStream> const surface_buffer_stream;
     std::shared_ptr<graphics::CursorImage> cursor_image_;
     std::shared_ptr<SceneReport> const report;
@@ -210,6 +228,8 @@ private:
     MirWindowVisibility visibility_ = mir_window_visibility_occluded;
     MirOrientationMode pref_orientation_mode = mir_orientation_mode_any;
     MirPointerConfinementState confine_pointer_state_ = mir_pointer_unconfined;
+    bool tearing_allowed_ = false;
+    float max_frame_rate_ = 0;
 
     /// \deprecated can be removed along with mirclient
     std::unique_ptr<CursorStreamImageAdapter> const cursor_stream_adapter;
@@ -226,6 +246,23 @@ private:
         geometry::DeltaY bottom;
         geometry::DeltaX right;
     } margins;
+
+    /**
+     * A rectangle containing all of the input area, published so hit-testing can pass over the surface without
+     * locking guard when the point is nowhere near it.
+     *
+     * Written only under guard, and read as a seqlock: sequence is odd while the edges are being written.
+     */
+    struct
+    {
+        std::atomic<unsigned> sequence{0};
+        std::atomic<int> left{0};
+        std::atomic<int> top{0};
+        std::atomic<int> right{0};
+        std::atomic<int> bottom{0};
+    } input_area_bounds;
+
+    MemoryCharge const charge;
 };
 
 }
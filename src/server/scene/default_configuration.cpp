@@ -41,10 +41,18 @@
 #include "unsupported_coordinate_translator.h"
 #include "timeout_application_not_responding_detector.h"
 #include "basic_clipboard.h"
+#include "scene_recorder.h"
+#include "scene_replayer.h"
+#include "application_scheduler.h"
 #include "mir/options/program_option.h"
 #include "mir/options/default_configuration.h"
 #include "mir/graphics/display_configuration.h"
 #include "mir/frontend/display_changer.h"
+#include "mir/frontend/surface_stack.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <fstream>
 
 namespace mc = mir::compositor;
 namespace mf = mir::frontend;
@@ -277,3 +285,89 @@ mir::DefaultServerConfiguration::the_display_configuration_controller()
 {
     return the_mediating_display_changer();
 }
+
+namespace
+{
+class SceneRecording
+{
+public:
+    SceneRecording(
+        std::string const& record_to,
+        std::shared_ptr<mf::SurfaceStack> const& stack,
+        std::shared_ptr<mir::time::Clock> const& clock) :
+        stack{stack},
+        out{open(record_to)},
+        recorder{std::make_shared<ms::SceneRecorder>(out, stack, clock)}
+    {
+        stack->add_observer(recorder);
+    }
+
+    ~SceneRecording()
+    {
+        stack->remove_observer(recorder);
+    }
+
+private:
+    static auto open(std::string const& path) -> std::ofstream
+    {
+        std::ofstream out{path};
+        if (!out)
+            BOOST_THROW_EXCEPTION(mir::AbnormalExit("Failed to open scene recording \"" + path + "\""));
+        return out;
+    }
+
+    std::shared_ptr<mf::SurfaceStack> const stack;
+    std::ofstream out;
+    std::shared_ptr<ms::SceneRecorder> const recorder;
+};
+}
+
+auto mir::DefaultServerConfiguration::scene_recording() -> std::shared_ptr<void>
+{
+    auto const record_to = the_options()->get<std::string>(options::scene_record_opt);
+    auto const replay_from = the_options()->get<std::string>(options::scene_replay_opt);
+
+    std::shared_ptr<SceneRecording> recording;
+    if (!record_to.empty())
+        recording = std::make_shared<SceneRecording>(record_to, the_frontend_surface_stack(), the_clock());
+
+    std::shared_ptr<ms::SceneReplayer> replayer;
+    if (!replay_from.empty())
+    {
+        std::ifstream in{replay_from};
+        if (!in)
+            BOOST_THROW_EXCEPTION(AbnormalExit("Failed to open scene trace \"" + replay_from + "\""));
+
+        replayer = std::make_shared<ms::SceneReplayer>(
+            ms::read_scene_trace(in),
+            the_surface_stack(),
+            the_buffer_stream_factory(),
+            the_buffer_allocator(),
+            the_scene_report());
+    }
+
+    if (!recording && !replayer)
+        return {};
+
+    // Stop replaying before we stop recording, so a recording of a replay ends with its surfaces' removal
+    return std::make_shared<std::pair<std::shared_ptr<SceneRecording>, std::shared_ptr<ms::SceneReplayer>>>(
+        recording, replayer);
+}
+
+auto mir::DefaultServerConfiguration::application_scheduling() -> std::shared_ptr<void>
+{
+    auto const settings = the_options()->get<std::string>(options::app_scheduling_opt);
+    if (settings.empty())
+        return {};
+
+    auto const scheduler = std::make_shared<ms::ApplicationScheduler>(
+        ms::parse_application_scheduling(settings),
+        &ms::move_process_to_cgroup);
+
+    // The coordinator only holds its listeners weakly, so keep the scheduler for as long as we're held
+    auto const coordinator = the_session_coordinator();
+    coordinator->add_listener(scheduler);
+    return std::shared_ptr<void>{
+        scheduler.get(),
+        [coordinator, scheduler](void*) { coordinator->remove_listener(scheduler); }};
+}
@@ -22,10 +22,17 @@
 #include "mir/renderer/gl/texture_source.h"
 
 #include <stdexcept>
+#include <utility>
 #include <boost/throw_exception.hpp>
 #include <GLES2/gl2.h>
 #include <GLES2/gl2ext.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 namespace mg = mir::graphics;
 namespace ms = mir::scene;
 namespace geom = mir::geometry;
@@ -47,11 +54,87 @@ inline uint32_t abgr_to_argb(uint32_t p)
            ((p) & 0xff000000);        /* A remains at same position */
 }
 
+/* Converts count pixels from src to dst, which may be the same line */
+void abgr_to_argb_line(uint32_t const* src, uint32_t* dst, size_t count)
+{
+    size_t n = 0;
+
+#if defined(__SSE2__)
+    auto const green_alpha = _mm_set1_epi32(0xff00ff00);
+    auto const red = _mm_set1_epi32(0x00ff0000);
+    auto const blue = _mm_set1_epi32(0x000000ff);
+
+    for (; n + 4 <= count; n += 4)
+    {
+        auto const p = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + n));
+        auto const converted = _mm_or_si128(
+            _mm_and_si128(p, green_alpha),
+            _mm_or_si128(
+                _mm_and_si128(_mm_slli_epi32(p, 16), red),
+                _mm_and_si128(_mm_srli_epi32(p, 16), blue)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + n), converted);
+    }
+#elif defined(__ARM_NEON)
+    for (; n + 16 <= count; n += 16)
+    {
+        /* Loading de-interleaves the channels into separate registers, so swapping R and B is free */
+        auto channels = vld4q_u8(reinterpret_cast<uint8_t const*>(src + n));
+        std::swap(channels.val[0], channels.val[2]);
+        vst4q_u8(reinterpret_cast<uint8_t*>(dst + n), channels);
+    }
+#endif
+
+    for (; n < count; n++)
+        dst[n] = abgr_to_argb(src[n]);
+}
+
+/* Draws the bound texture over the whole viewport, averaging four bilinear taps
+ * per destination pixel so that downscaling by up to 4x in each direction
+ * samples every source pixel */
+char const* const scaling_vertex_shader =
+    "attribute vec2 position;\n"
+    "varying vec2 v_texcoord;\n"
+    "void main() {\n"
+    "   v_texcoord = (position + 1.0) * 0.5;\n"
+    "   gl_Position = vec4(position, 0.0, 1.0);\n"
+    "}\n";
+
+char const* const scaling_fragment_shader =
+    "precision mediump float;\n"
+    "uniform sampler2D tex;\n"
+    "uniform vec2 texel;\n"
+    "varying vec2 v_texcoord;\n"
+    "void main() {\n"
+    "   gl_FragColor = 0.25 * (\n"
+    "       texture2D(tex, v_texcoord + vec2(-texel.x, -texel.y)) +\n"
+    "       texture2D(tex, v_texcoord + vec2( texel.x, -texel.y)) +\n"
+    "       texture2D(tex, v_texcoord + vec2(-texel.x,  texel.y)) +\n"
+    "       texture2D(tex, v_texcoord + vec2( texel.x,  texel.y)));\n"
+    "}\n";
+
+GLuint compile_shader(GLenum type, char const* source)
+{
+    auto const shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint compiled = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+    if (compiled != GL_TRUE)
+    {
+        glDeleteShader(shader);
+        BOOST_THROW_EXCEPTION(std::runtime_error("Failed to compile snapshot scaling shader"));
+    }
+
+    return shader;
+}
+
 }
 
 ms::GLPixelBuffer::GLPixelBuffer(std::unique_ptr<renderer::gl::Context> gl_context)
     : gl_context{std::move(gl_context)},
-      tex{0}, fbo{0}, gl_pixel_format{0}, pixels_need_y_flip{false}
+      tex{0}, fbo{0}, scaled_tex{0}, scaling_program{0}, position_attrib{-1}, texel_uniform{-1},
+      gl_pixel_format{0}, pixels_need_y_flip{false}
 {
     /*
      * TODO: Handle systems that are big-endian, and therefore GL_BGRA doesn't
@@ -70,13 +153,17 @@ ms::GLPixelBuffer::~GLPixelBuffer() noexcept
      * This may be called from a different thread
      * than the one that called prepare
      */
-    if (tex != 0 || fbo != 0)
+    if (tex != 0 || fbo != 0 || scaled_tex != 0 || scaling_program != 0)
         gl_context->make_current();
 
     if (tex != 0)
         glDeleteTextures(1, &tex);
+    if (scaled_tex != 0)
+        glDeleteTextures(1, &scaled_tex);
     if (fbo != 0)
         glDeleteFramebuffers(1, &fbo);
+    if (scaling_program != 0)
+        glDeleteProgram(scaling_program);
 }
 
 void ms::GLPixelBuffer::prepare()
@@ -95,6 +182,34 @@ void ms::GLPixelBuffer::prepare()
     glBindFramebuffer(GL_FRAMEBUFFER, fbo);
 }
 
+void ms::GLPixelBuffer::bind_buffer(graphics::Buffer& buffer)
+{
+    auto const texture_source =
+        dynamic_cast<mir::renderer::gl::TextureSource*>(
+            buffer.native_buffer_base());
+    if (!texture_source)
+        BOOST_THROW_EXCEPTION(std::logic_error("Buffer does not support GL rendering"));
+    texture_source->gl_bind_to_texture();
+}
+
+void ms::GLPixelBuffer::read_pixels(GLsizei width, GLsizei height)
+{
+    /* First try to get pixels as BGRA, unless we've already found that unsupported */
+    if (gl_pixel_format != GL_RGBA)
+    {
+        glGetError();
+        gl_pixel_format = GL_BGRA_EXT;
+        glReadPixels(0, 0, width, height, gl_pixel_format, GL_UNSIGNED_BYTE, pixels.data());
+
+        if (glGetError() != GL_NO_ERROR)
+            gl_pixel_format = GL_RGBA;
+    }
+
+    /* If getting pixels as BGRA failed, fall back to RGBA */
+    if (gl_pixel_format == GL_RGBA)
+        glReadPixels(0, 0, width, height, gl_pixel_format, GL_UNSIGNED_BYTE, pixels.data());
+}
+
 void ms::GLPixelBuffer::fill_from(graphics::Buffer& buffer)
 {
     auto width = buffer.size().width.as_uint32_t();
@@ -103,29 +218,95 @@ void ms::GLPixelBuffer::fill_from(graphics::Buffer& buffer)
     pixels.resize(width * height * 4);
 
     prepare();
-
-    auto const texture_source =
-        dynamic_cast<mir::renderer::gl::TextureSource*>(
-            buffer.native_buffer_base());
-    if (!texture_source)
-        BOOST_THROW_EXCEPTION(std::logic_error("Buffer does not support GL rendering"));
-    texture_source->gl_bind_to_texture();
+    bind_buffer(buffer);
 
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tex, 0);
 
-    /* First try to get pixels as BGRA */
-    glGetError();
-    gl_pixel_format = GL_BGRA_EXT;
-    glReadPixels(0, 0, width, height, gl_pixel_format, GL_UNSIGNED_BYTE, pixels.data());
+    read_pixels(width, height);
 
-    /* If getting pixels as BGRA failed, fall back to RGBA */
-    if (glGetError() != GL_NO_ERROR)
+    size_ = buffer.size();
+    pixels_need_y_flip = true;
+}
+
+void ms::GLPixelBuffer::prepare_scaling_program()
+{
+    if (scaling_program != 0)
+        return;
+
+    auto const vertex = compile_shader(GL_VERTEX_SHADER, scaling_vertex_shader);
+    auto const fragment = compile_shader(GL_FRAGMENT_SHADER, scaling_fragment_shader);
+
+    auto const program = glCreateProgram();
+    glAttachShader(program, vertex);
+    glAttachShader(program, fragment);
+    glLinkProgram(program);
+    glDeleteShader(vertex);
+    glDeleteShader(fragment);
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (linked != GL_TRUE)
     {
-        gl_pixel_format = GL_RGBA;
-        glReadPixels(0, 0, width, height, gl_pixel_format, GL_UNSIGNED_BYTE, pixels.data());
+        glDeleteProgram(program);
+        BOOST_THROW_EXCEPTION(std::runtime_error("Failed to link snapshot scaling program"));
     }
 
-    size_ = buffer.size();
+    position_attrib = glGetAttribLocation(program, "position");
+    texel_uniform = glGetUniformLocation(program, "texel");
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "tex"), 0);
+
+    scaling_program = program;
+}
+
+void ms::GLPixelBuffer::fill_scaled_from(graphics::Buffer& buffer, geometry::Size const& size)
+{
+    if (size == buffer.size())
+    {
+        fill_from(buffer);
+        return;
+    }
+
+    auto const width = size.width.as_uint32_t();
+    auto const height = size.height.as_uint32_t();
+
+    pixels.resize(width * height * 4);
+
+    prepare();
+    prepare_scaling_program();
+
+    /* Render into a texture of the requested size... */
+    if (scaled_tex == 0)
+        glGenTextures(1, &scaled_tex);
+
+    glBindTexture(GL_TEXTURE_2D, scaled_tex);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, scaled_tex, 0);
+
+    /* ...sampling from the buffer's texture */
+    glBindTexture(GL_TEXTURE_2D, tex);
+    bind_buffer(buffer);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    /* The taps sit a quarter of a destination pixel either side of its centre */
+    static GLfloat const quad[] = {-1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f};
+    glUseProgram(scaling_program);
+    glUniform2f(texel_uniform, 0.25f / width, 0.25f / height);
+    glVertexAttribPointer(position_attrib, 2, GL_FLOAT, GL_FALSE, 0, quad);
+    glEnableVertexAttribArray(position_attrib);
+    glViewport(0, 0, width, height);
+    glDisable(GL_BLEND);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    glDisableVertexAttribArray(position_attrib);
+
+    read_pixels(width, height);
+
+    size_ = size;
     pixels_need_y_flip = true;
 }
 
@@ -180,12 +361,10 @@ void ms::GLPixelBuffer::copy_and_convert_pixel_line(char* src, char* dst)
     if (gl_pixel_format == GL_RGBA)
     {
         /* Convert from abgr_8888 to argb_8888 while copying */
-        auto pixels_src = reinterpret_cast<uint32_t*>(src);
-        auto pixels_dst = reinterpret_cast<uint32_t*>(dst);
-        auto const width = size_.width.as_uint32_t();
-
-        for (uint32_t n = 0; n < width; n++)
-            pixels_dst[n] = abgr_to_argb(pixels_src[n]);
+        abgr_to_argb_line(
+            reinterpret_cast<uint32_t const*>(src),
+            reinterpret_cast<uint32_t*>(dst),
+            size_.width.as_uint32_t());
     }
     else if (src != dst)
     {
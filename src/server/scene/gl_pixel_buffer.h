@@ -50,17 +50,25 @@ public:
     ~GLPixelBuffer() noexcept;
 
     void fill_from(graphics::Buffer& buffer);
+    void fill_scaled_from(graphics::Buffer& buffer, geometry::Size const& size);
     void const* as_argb_8888();
     geometry::Size size() const;
     geometry::Stride stride() const;
 
 private:
     void prepare();
+    void bind_buffer(graphics::Buffer& buffer);
+    void read_pixels(GLsizei width, GLsizei height);
+    void prepare_scaling_program();
     void copy_and_convert_pixel_line(char* src, char* dst);
 
     std::unique_ptr<renderer::gl::Context> const gl_context;
     GLuint tex;
     GLuint fbo;
+    GLuint scaled_tex;
+    GLuint scaling_program;
+    GLint position_attrib;
+    GLint texel_uniform;
     std::vector<char> pixels;
     GLuint gl_pixel_format;
     bool pixels_need_y_flip;
@@ -23,6 +23,8 @@
 
 #include <boost/throw_exception.hpp>
 
+#include <mutex>
+
 namespace ms = mir::scene;
 
 ms::LegacySceneChangeNotification::LegacySceneChangeNotification(
@@ -49,6 +51,7 @@ ms::LegacySceneChangeNotification::~LegacySceneChangeNotification()
 
 namespace
 {
+/// Reports changes to a surface as damage to the area it covers, so only the outputs affected need recompositing
 class NonLegacySurfaceChangeNotification : public ms::LegacySurfaceChangeNotification
 {
 public:
@@ -57,11 +60,18 @@ public:
         std::function<void(int frames, mir::geometry::Rectangle const& damage)> const& damage_notify_change,
         ms::Surface* surface);
 
+    void content_resized_to(ms::Surface const* surf, mir::geometry::Size const& size) override;
     void moved_to(ms::Surface const* surf, const mir::geometry::Point&) override;
+    void hidden_set_to(ms::Surface const* surf, bool hide) override;
     void frame_posted(ms::Surface const* surf, int frames_available, const mir::geometry::Size& size) override;
+    void alpha_set_to(ms::Surface const* surf, float alpha) override;
 
 private:
-    mir::geometry::Point top_left;
+    /// Damages both where the surface was and where it is now
+    void area_changed(mir::geometry::Rectangle const& old_area, mir::geometry::Rectangle const& new_area);
+
+    std::mutex mutex;
+    mir::geometry::Rectangle area;
     std::function<void(int frames, mir::geometry::Rectangle const& damage)> const damage_notify_change;
 };
 
@@ -70,22 +80,71 @@ NonLegacySurfaceChangeNotification::NonLegacySurfaceChangeNotification(
     std::function<void(int frames, mir::geometry::Rectangle const& damage)> const& damage_notify_change,
     ms::Surface* surface) :
     ms::LegacySurfaceChangeNotification(notify_scene_change, {}),
+    area{surface->top_left(), surface->window_size()},
     damage_notify_change(damage_notify_change)
 {
-    top_left = surface->top_left();
+}
+
+void NonLegacySurfaceChangeNotification::content_resized_to(ms::Surface const* surf, mir::geometry::Size const&)
+{
+    std::unique_lock<std::mutex> lock{mutex};
+    auto const old_area = area;
+    area.size = surf->window_size();
+    auto const new_area = area;
+    lock.unlock();
+
+    if (surf->visible())
+        area_changed(old_area, new_area);
 }
 
 void NonLegacySurfaceChangeNotification::moved_to(ms::Surface const* surf, const mir::geometry::Point& top_left)
 {
-    this->top_left = top_left;
-    ms::LegacySurfaceChangeNotification::moved_to(surf, top_left);
+    std::unique_lock<std::mutex> lock{mutex};
+    auto const old_area = area;
+    area.top_left = top_left;
+    auto const new_area = area;
+    lock.unlock();
+
+    if (surf->visible())
+        area_changed(old_area, new_area);
+}
+
+void NonLegacySurfaceChangeNotification::hidden_set_to(ms::Surface const*, bool)
+{
+    std::unique_lock<std::mutex> lock{mutex};
+    auto const current_area = area;
+    lock.unlock();
+
+    damage_notify_change(1, current_area);
 }
 
 void NonLegacySurfaceChangeNotification::frame_posted(ms::Surface const*, int frames_available, const mir::geometry::Size& size)
 {
-    mir::geometry::Rectangle const update_region{top_left, size};
+    std::unique_lock<std::mutex> lock{mutex};
+    mir::geometry::Rectangle const update_region{area.top_left, size};
+    lock.unlock();
+
     damage_notify_change(frames_available, update_region);
 }
+
+void NonLegacySurfaceChangeNotification::alpha_set_to(ms::Surface const* surf, float)
+{
+    std::unique_lock<std::mutex> lock{mutex};
+    auto const current_area = area;
+    lock.unlock();
+
+    if (surf->visible())
+        damage_notify_change(1, current_area);
+}
+
+void NonLegacySurfaceChangeNotification::area_changed(
+    mir::geometry::Rectangle const& old_area,
+    mir::geometry::Rectangle const& new_area)
+{
+    damage_notify_change(1, old_area);
+    if (new_area != old_area)
+        damage_notify_change(1, new_area);
+}
 }
 
 void ms::LegacySceneChangeNotification::add_surface_observer(ms::Surface* surface)
@@ -489,13 +489,29 @@ void ms::MediatingDisplayChanger::apply_config(
     auto existing_configuration = display->configuration();
     try
     {
-        if (configuration_has_new_outputs_enabled(*display->configuration(), *conf) ||
+        /*
+         * Powering outputs off and on (DPMS) is frequent and shouldn't cost a rebuild of
+         * their compositors, so where the display can it keeps them for the outputs' return.
+         */
+        if (display->apply_if_configuration_only_changes_power_modes(
+                *conf,
+                [this](mg::DisplaySyncGroup& group) { compositor->suspend_compositing(group); },
+                [this](mg::DisplaySyncGroup& group) { compositor->resume_compositing(group); }))
+        {
+            // Groups the compositor was restarted without meanwhile have no compositor to resume
+            compositor->start_compositing_new_groups();
+        }
+        else if (configuration_has_new_outputs_enabled(*display->configuration(), *conf) ||
             !display->apply_if_configuration_preserves_display_buffers(*conf))
         {
-            ApplyNowAndRevertOnScopeExit comp{
-                [this] { compositor->stop(); },
-                [this] { compositor->start(); }};
-            display->configure(*conf);
+            /*
+             * Only the outputs the change affects stop compositing while it's applied;
+             * the display keeps the rest as they are.
+             */
+            display->configure_incrementally(
+                *conf,
+                [this](mg::DisplaySyncGroup& group) { compositor->stop_compositing(group); });
+            compositor->start_compositing_new_groups();
         }
 
         observer->configuration_applied(conf);
@@ -615,3 +631,7 @@ void ms::MediatingDisplayChanger::set_base_configuration(std::shared_ptr<mg::Dis
         });
 }
 
+mir::graphics::Frame ms::MediatingDisplayChanger::last_frame_on(unsigned output_id)
+{
+    return display->last_frame_on(output_id);
+}
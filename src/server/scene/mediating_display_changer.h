@@ -82,6 +82,7 @@ public:
 
     void cancel_base_configuration_preview(
         std::shared_ptr<scene::Session> const& session) override;
+    graphics::Frame last_frame_on(unsigned output_id) override;
 
     /* From mir::DisplayChanger */
     void configure_for_hardware_change(
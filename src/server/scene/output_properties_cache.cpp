@@ -21,6 +21,7 @@
 #include "mir/geometry/rectangle.h"
 #include "mir/graphics/display_configuration.h"
 
+#include <algorithm>
 #include <atomic>
 #include <cmath>
 
@@ -43,9 +44,17 @@ int calculate_dpi(mir::geometry::Size const& resolution, mir::geometry::Size con
 }
 }
 
+struct ms::OutputPropertiesCache::Snapshot
+{
+    std::vector<OutputProperties> outputs;
+    /// Whether each output overlaps no other, so that a surface within it is on it alone
+    std::vector<bool> alone;
+};
+
 void ms::OutputPropertiesCache::update_from(mg::DisplayConfiguration const &config)
 {
-    auto new_properties = std::make_shared<std::vector<OutputProperties>>();
+    auto new_snapshot = std::make_shared<Snapshot>();
+    auto& new_properties = new_snapshot->outputs;
 
     config.for_each_output(
         [&new_properties](mg::DisplayConfigurationOutput const& output)
@@ -53,7 +62,7 @@ void ms::OutputPropertiesCache::update_from(mg::DisplayConfiguration const &conf
             if (output.current_mode_index < output.modes.size())
             {
                 auto const mode = output.modes[output.current_mode_index];
-                new_properties->emplace_back(OutputProperties {
+                new_properties.emplace_back(OutputProperties {
                     output.extents(),
                     calculate_dpi(mode.size, output.physical_size_mm),
                     output.scale,
@@ -63,26 +72,28 @@ void ms::OutputPropertiesCache::update_from(mg::DisplayConfiguration const &conf
             }
         });
 
-    std::lock_guard<std::mutex> lk(mutex);
-    cache = new_properties;
-}
+    for (auto const& output : new_properties)
+    {
+        new_snapshot->alone.push_back(std::none_of(
+            new_properties.begin(), new_properties.end(),
+            [&output](OutputProperties const& other)
+            {
+                return &other != &output && other.extents.overlaps(output.extents);
+            }));
+    }
 
-auto ms::OutputPropertiesCache::get_cache() const
-    -> std::shared_ptr<std::vector<OutputProperties>>
-{
-    std::lock_guard<std::mutex> lk(mutex);
-    return cache;
+    std::atomic_store(&snapshot, std::shared_ptr<Snapshot const>{std::move(new_snapshot)});
 }
 
 auto ms::OutputPropertiesCache::properties_for(geom::Rectangle const& extents) const
     -> std::shared_ptr<OutputProperties const>
 {
-    auto temp_properties = get_cache();
+    auto const current = std::atomic_load(&snapshot);
 
     std::shared_ptr<OutputProperties const> matching_output_properties{};
-    if (temp_properties)
+    if (current)
     {
-        for (auto const &output : *temp_properties)
+        for (auto const &output : current->outputs)
         {
             if (output.extents.overlaps(extents))
             {
@@ -90,7 +101,7 @@ auto ms::OutputPropertiesCache::properties_for(geom::Rectangle const& extents) c
                     (output.scale > matching_output_properties->scale))
                 {
                     matching_output_properties = std::shared_ptr<OutputProperties const>(
-                        temp_properties,
+                        current,
                         &output
                     );
                 }
@@ -100,3 +111,22 @@ auto ms::OutputPropertiesCache::properties_for(geom::Rectangle const& extents) c
 
     return matching_output_properties;
 }
+
+auto ms::OutputPropertiesCache::properties_for(
+    geom::Rectangle const& extents,
+    std::shared_ptr<OutputProperties const> const& previous) const
+    -> std::shared_ptr<OutputProperties const>
+{
+    if (previous && previous->extents.contains(extents))
+    {
+        auto const current = std::atomic_load(&snapshot);
+
+        // previous shares ownership of the snapshot it came from
+        bool const is_current = current && !current.owner_before(previous) && !previous.owner_before(current);
+
+        if (is_current && current->alone[previous.get() - current->outputs.data()])
+            return previous;
+    }
+
+    return properties_for(extents);
+}
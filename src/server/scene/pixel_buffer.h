@@ -45,11 +45,20 @@ public:
      */
     virtual void fill_from(graphics::Buffer& buffer) = 0;
 
+    /**
+     * Fills the PixelBuffer with the contents of a graphics::Buffer, scaled
+     * to the given size.
+     *
+     * \param [in] buffer the buffer to get the pixels of
+     * \param [in] size   the size to scale the pixels to
+     */
+    virtual void fill_scaled_from(graphics::Buffer& buffer, geometry::Size const& size) = 0;
+
     /**
      * The pixels in 0xAARRGGBB format.
      *
      * The pixel data is owned by the PixelBuffer object and is only valid
-     * until the next call to fill_from().
+     * until the next call to fill_from() or fill_scaled_from().
      *
      * This method may involve transformation of the extracted data.
      */
@@ -0,0 +1,66 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "scene_element_pool.h"
+
+#include <new>
+
+namespace ms = mir::scene;
+
+ms::SceneElementPool::~SceneElementPool()
+{
+    for (auto const block : free_blocks)
+        ::operator delete(block);
+}
+
+auto ms::SceneElementPool::allocate(std::size_t size) -> void*
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        if (size == block_size && !free_blocks.empty())
+        {
+            auto const block = free_blocks.back();
+            free_blocks.pop_back();
+            return block;
+        }
+    }
+
+    return ::operator new(size);
+}
+
+void ms::SceneElementPool::deallocate(void* block, std::size_t size) noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        if (block_size == 0)
+            block_size = size;
+
+        if (size == block_size)
+        {
+            try
+            {
+                free_blocks.push_back(block);
+                return;
+            }
+            catch (std::bad_alloc const&)
+            {
+                // Just give it back to the heap
+            }
+        }
+    }
+
+    ::operator delete(block);
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_SCENE_SCENE_ELEMENT_POOL_H_
+#define MIR_SCENE_SCENE_ELEMENT_POOL_H_
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace mir
+{
+namespace scene
+{
+/**
+ * Recycles the memory of one compositor's scene elements from frame to frame.
+ *
+ * Every element of a frame is the same size, so the pool keeps freed blocks of
+ * that size for reuse and, once it has seen a frame's worth, stops touching
+ * the heap (and contending for it with the other compositors).
+ */
+class SceneElementPool
+{
+public:
+    SceneElementPool() = default;
+    ~SceneElementPool();
+
+    auto allocate(std::size_t size) -> void*;
+    void deallocate(void* block, std::size_t size) noexcept;
+
+private:
+    SceneElementPool(SceneElementPool const&) = delete;
+    SceneElementPool& operator=(SceneElementPool const&) = delete;
+
+    std::mutex mutex;
+    std::size_t block_size{0};
+    std::vector<void*> free_blocks;
+};
+
+/// Allocates from a SceneElementPool, for std::allocate_shared()
+template<typename T>
+class SceneElementAllocator
+{
+public:
+    using value_type = T;
+
+    explicit SceneElementAllocator(std::shared_ptr<SceneElementPool> pool)
+        : pool{std::move(pool)}
+    {
+    }
+
+    template<typename U>
+    SceneElementAllocator(SceneElementAllocator<U> const& other)
+        : pool{other.pool}
+    {
+    }
+
+    auto allocate(std::size_t n) -> T*
+    {
+        static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "Pooled blocks are only suitably aligned for new");
+        return static_cast<T*>(pool->allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* block, std::size_t n) noexcept
+    {
+        pool->deallocate(block, n * sizeof(T));
+    }
+
+    template<typename U>
+    auto operator==(SceneElementAllocator<U> const& other) const -> bool
+    {
+        return pool == other.pool;
+    }
+
+    template<typename U>
+    auto operator!=(SceneElementAllocator<U> const& other) const -> bool
+    {
+        return pool != other.pool;
+    }
+
+private:
+    template<typename U> friend class SceneElementAllocator;
+
+    std::shared_ptr<SceneElementPool> pool;
+};
+}
+}
+
+#endif /* MIR_SCENE_SCENE_ELEMENT_POOL_H_ */
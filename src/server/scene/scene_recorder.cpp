@@ -0,0 +1,236 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "scene_recorder.h"
+
+#include "mir/frontend/buffer_stream.h"
+#include "mir/frontend/surface_stack.h"
+#include "mir/scene/null_surface_observer.h"
+#include "mir/scene/surface.h"
+#include "mir/time/clock.h"
+
+namespace ms = mir::scene;
+namespace geom = mir::geometry;
+
+using Type = ms::SceneTraceEvent::Type;
+
+class ms::SceneRecorder::SurfaceRecorder : public NullSurfaceObserver
+{
+public:
+    explicit SurfaceRecorder(SceneRecorder* recorder) :
+        recorder{recorder}
+    {
+    }
+
+    void window_resized_to(Surface const* surf, geom::Size const& window_size) override
+    {
+        SceneTraceEvent event;
+        event.type = Type::resize;
+        event.area.size = window_size;
+        recorder->record(surf, event);
+    }
+
+    void moved_to(Surface const* surf, geom::Point const& top_left) override
+    {
+        SceneTraceEvent event;
+        event.type = Type::move;
+        event.area.top_left = top_left;
+        recorder->record(surf, event);
+    }
+
+    void hidden_set_to(Surface const* surf, bool hide) override
+    {
+        SceneTraceEvent event;
+        event.type = Type::visible;
+        event.visible = !hide;
+        recorder->record(surf, event);
+    }
+
+    void frame_posted(Surface const* surf, int, geom::Size const& size) override
+    {
+        SceneTraceEvent event;
+        event.type = Type::frame;
+        event.area.size = size;
+        // Asked before taking our lock, as the stream's is taken for it
+        if (auto const stream = surf->primary_buffer_stream())
+        {
+            event.format = stream->pixel_format();
+            event.damage = stream->submitted_damage();
+        }
+        recorder->record(surf, event);
+    }
+
+    void alpha_set_to(Surface const* surf, float alpha) override
+    {
+        SceneTraceEvent event;
+        event.type = Type::alpha;
+        event.alpha = alpha;
+        recorder->record(surf, event);
+    }
+
+    void depth_layer_set_to(Surface const* surf, MirDepthLayer depth_layer) override
+    {
+        SceneTraceEvent event;
+        event.type = Type::layer;
+        event.depth_layer = depth_layer;
+        recorder->record(surf, event);
+    }
+
+private:
+    SceneRecorder* const recorder;
+};
+
+ms::SceneRecorder::SceneRecorder(
+    std::ostream& out,
+    std::weak_ptr<frontend::SurfaceStack> const& stack,
+    std::shared_ptr<time::Clock> const& clock) :
+    out{out},
+    stack{stack},
+    clock{clock},
+    start{clock->now()}
+{
+    out << scene_trace_header << '\n';
+}
+
+ms::SceneRecorder::~SceneRecorder()
+{
+    end_observation();
+    out.flush();
+}
+
+void ms::SceneRecorder::surface_added(std::shared_ptr<Surface> const& surface)
+{
+    auto const observer = std::make_shared<SurfaceRecorder>(this);
+
+    SceneTraceEvent event;
+    event.type = Type::add;
+    event.depth_layer = surface->depth_layer();
+    event.area = {surface->top_left(), surface->window_size()};
+    if (auto const stream = surface->primary_buffer_stream())
+        event.format = stream->pixel_format();
+
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        event.surface = next_id++;
+        surfaces[surface.get()] = RecordedSurface{event.surface, surface, observer};
+        write(event, lock);
+
+        // A replayed surface is shown unless it says otherwise
+        if (!surface->visible())
+        {
+            SceneTraceEvent hidden;
+            hidden.type = Type::visible;
+            hidden.surface = event.surface;
+            hidden.visible = false;
+            write(hidden, lock);
+        }
+    }
+
+    surface->add_observer(observer);
+}
+
+void ms::SceneRecorder::surface_removed(std::shared_ptr<Surface> const& surface)
+{
+    std::shared_ptr<SurfaceObserver> observer;
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        auto const recorded = surfaces.find(surface.get());
+        if (recorded == surfaces.end())
+            return;
+
+        SceneTraceEvent event;
+        event.type = Type::remove;
+        event.surface = recorded->second.id;
+        write(event, lock);
+
+        observer = recorded->second.observer;
+        surfaces.erase(recorded);
+    }
+    surface->remove_observer(observer);
+}
+
+void ms::SceneRecorder::surfaces_reordered(SurfaceSet const&)
+{
+    auto const the_stack = stack.lock();
+    if (!the_stack)
+        return;
+
+    // The reordered surfaces alone don't say where they went, so record where every surface is
+    SurfaceSet all;
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        for (auto const& recorded : surfaces)
+            all.insert(recorded.second.surface);
+    }
+
+    auto const order = the_stack->stacking_order_of(all);
+
+    std::lock_guard<std::mutex> lock{mutex};
+    SceneTraceEvent event;
+    event.type = Type::order;
+    for (auto const& weak_surface : order)
+    {
+        if (auto const surface = weak_surface.lock())
+        {
+            auto const recorded = surfaces.find(surface.get());
+            if (recorded != surfaces.end())
+                event.order.push_back(recorded->second.id);
+        }
+    }
+    write(event, lock);
+}
+
+void ms::SceneRecorder::scene_changed()
+{
+}
+
+void ms::SceneRecorder::surface_exists(std::shared_ptr<Surface> const& surface)
+{
+    // Existing surfaces are reported bottom to top, so adding them in turn recreates their order
+    surface_added(surface);
+}
+
+void ms::SceneRecorder::end_observation()
+{
+    std::map<Surface const*, RecordedSurface> recorded;
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        std::swap(recorded, surfaces);
+    }
+
+    for (auto const& entry : recorded)
+    {
+        if (auto const surface = entry.second.surface.lock())
+            surface->remove_observer(entry.second.observer);
+    }
+}
+
+void ms::SceneRecorder::record(Surface const* surface, SceneTraceEvent event)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    auto const recorded = surfaces.find(surface);
+    if (recorded == surfaces.end())
+        return;
+
+    event.surface = recorded->second.id;
+    write(event, lock);
+}
+
+void ms::SceneRecorder::write(SceneTraceEvent& event, std::lock_guard<std::mutex> const&)
+{
+    event.time = std::chrono::duration_cast<std::chrono::microseconds>(clock->now() - start);
+    out << to_string(event) << '\n';
+}
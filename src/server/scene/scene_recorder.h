@@ -0,0 +1,93 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_SCENE_SCENE_RECORDER_H_
+#define MIR_SCENE_SCENE_RECORDER_H_
+
+#include "scene_trace.h"
+
+#include "mir/scene/observer.h"
+#include "mir/time/types.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+
+namespace mir
+{
+namespace frontend
+{
+class SurfaceStack;
+}
+namespace time
+{
+class Clock;
+}
+namespace scene
+{
+class SurfaceObserver;
+
+/**
+ * Writes the scene's workload to a trace (see SceneTraceEvent), for SceneReplayer
+ *
+ * Add it as an observer of the stack. It records what the compositor has to do, and nothing of what's shown:
+ * each surface's geometry, depth layer, visibility and alpha, the stacking order, and each frame's size, pixel
+ * format and damage. Frames of a surface's other streams (such as subsurfaces) are recorded as its own.
+ */
+class SceneRecorder : public Observer
+{
+public:
+    SceneRecorder(
+        std::ostream& out,
+        std::weak_ptr<frontend::SurfaceStack> const& stack,
+        std::shared_ptr<time::Clock> const& clock);
+    ~SceneRecorder();
+
+    void surface_added(std::shared_ptr<Surface> const& surface) override;
+    void surface_removed(std::shared_ptr<Surface> const& surface) override;
+    void surfaces_reordered(SurfaceSet const& affected_surfaces) override;
+    void scene_changed() override;
+    void surface_exists(std::shared_ptr<Surface> const& surface) override;
+    void end_observation() override;
+
+private:
+    class SurfaceRecorder;
+
+    struct RecordedSurface
+    {
+        int id;
+        std::weak_ptr<Surface> surface;
+        std::shared_ptr<SurfaceObserver> observer;
+    };
+
+    /// Writes an event for the surface, if it's one we're recording
+    void record(Surface const* surface, SceneTraceEvent event);
+    void write(SceneTraceEvent& event, std::lock_guard<std::mutex> const&);
+
+    std::ostream& out;
+    std::weak_ptr<frontend::SurfaceStack> const stack;
+    std::shared_ptr<time::Clock> const clock;
+    time::Timestamp const start;
+
+    std::mutex mutex;
+    int next_id{1};
+    std::map<Surface const*, RecordedSurface> surfaces;
+};
+}
+}
+
+#endif /* MIR_SCENE_SCENE_RECORDER_H_ */
@@ -0,0 +1,234 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "scene_replayer.h"
+#include "basic_surface.h"
+
+#include "mir/compositor/buffer_stream.h"
+#include "mir/graphics/buffer.h"
+#include "mir/graphics/buffer_properties.h"
+#include "mir/graphics/graphic_buffer_allocator.h"
+#include "mir/input/input_reception_mode.h"
+#include "mir/log.h"
+#include "mir/scene/buffer_stream_factory.h"
+#include "mir/shell/surface_stack.h"
+#include "mir/thread_name.h"
+
+namespace ms = mir::scene;
+namespace mg = mir::graphics;
+namespace geom = mir::geometry;
+
+using Type = ms::SceneTraceEvent::Type;
+
+namespace
+{
+/// Enough for one on screen, one being composited and one being submitted
+int const buffers_per_surface = 3;
+
+auto replayable(MirPixelFormat format) -> MirPixelFormat
+{
+    return format == mir_pixel_format_invalid ? mir_pixel_format_argb_8888 : format;
+}
+}
+
+ms::SceneReplayer::SceneReplayer(
+    std::vector<SceneTraceEvent> events,
+    std::shared_ptr<shell::SurfaceStack> const& stack,
+    std::shared_ptr<BufferStreamFactory> const& stream_factory,
+    std::shared_ptr<mg::GraphicBufferAllocator> const& allocator,
+    std::shared_ptr<SceneReport> const& report) :
+    events{std::move(events)},
+    stack{stack},
+    stream_factory{stream_factory},
+    allocator{allocator},
+    report{report},
+    thread{[this] { run(); }}
+{
+}
+
+ms::SceneReplayer::~SceneReplayer()
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        stopping = true;
+    }
+    stop_requested.notify_all();
+    thread.join();
+}
+
+void ms::SceneReplayer::run()
+{
+    mir::set_thread_name("Mir/SceneReplay");
+
+    try
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        while (!stopping)
+        {
+            auto const start = std::chrono::steady_clock::now();
+
+            for (auto const& event : events)
+            {
+                if (stop_requested.wait_until(lock, start + event.time, [this] { return stopping; }))
+                    break;
+
+                lock.unlock();
+                apply(event);
+                lock.lock();
+            }
+
+            lock.unlock();
+            remove_all();
+            lock.lock();
+
+            // An empty trace has nothing to loop over
+            if (events.empty())
+                stop_requested.wait(lock, [this] { return stopping; });
+        }
+    }
+    catch (...)
+    {
+        mir::log(
+            mir::logging::Severity::error,
+            "scene",
+            std::current_exception(),
+            "Scene replay stopped");
+    }
+
+    remove_all();
+}
+
+void ms::SceneReplayer::apply(SceneTraceEvent const& event)
+{
+    if (event.type == Type::order)
+    {
+        // Raising each in turn, bottom first, leaves them in the recorded order
+        for (auto const id : event.order)
+        {
+            auto const replayed = surfaces.find(id);
+            if (replayed != surfaces.end())
+                stack->raise(replayed->second.surface);
+        }
+        return;
+    }
+
+    if (event.type == Type::add)
+    {
+        auto const format = replayable(event.format);
+        auto const stream = stream_factory->create_buffer_stream(
+            mg::BufferProperties{event.area.size, format, mg::BufferUsage::software});
+
+        auto const surface = std::make_shared<BasicSurface>(
+            nullptr /* session */,
+            "scene-replay",
+            event.area,
+            mir_pointer_unconfined,
+            std::list<StreamInfo>{{stream, {}, {}}},
+            std::shared_ptr<mg::CursorImage>(),
+            report);
+
+        surface->set_depth_layer(event.depth_layer);
+        // Replayed surfaces are only there to be drawn
+        surface->set_input_region({geom::Rectangle{}});
+
+        remove_surface_with(event.surface);
+        surfaces[event.surface] = ReplayedSurface{surface, stream, {}, 0};
+        stack->add_surface(surface, input::InputReceptionMode::normal);
+        return;
+    }
+
+    auto const replayed = surfaces.find(event.surface);
+    if (replayed == surfaces.end())
+        return;
+
+    auto& surface = *replayed->second.surface;
+
+    switch (event.type)
+    {
+    case Type::remove:
+        remove_surface_with(event.surface);
+        break;
+
+    case Type::move:
+        surface.move_to(event.area.top_left);
+        break;
+
+    case Type::resize:
+        surface.resize(event.area.size);
+        break;
+
+    case Type::visible:
+        if (event.visible)
+            surface.show();
+        else
+            surface.hide();
+        break;
+
+    case Type::alpha:
+        surface.set_alpha(event.alpha);
+        break;
+
+    case Type::layer:
+        surface.set_depth_layer(event.depth_layer);
+        break;
+
+    case Type::frame:
+        submit_frame(replayed->second, event);
+        break;
+
+    case Type::add:
+    case Type::order:
+        break;
+    }
+}
+
+void ms::SceneReplayer::submit_frame(ReplayedSurface& replayed, SceneTraceEvent const& event)
+{
+    auto const format = replayable(event.format);
+    auto const& buffers = replayed.buffers;
+
+    if (buffers.empty() || buffers.front()->size() != event.area.size || buffers.front()->pixel_format() != format)
+    {
+        replayed.buffers.clear();
+        for (int i = 0; i != buffers_per_surface; ++i)
+            replayed.buffers.push_back(allocator->alloc_software_buffer(event.area.size, format));
+        replayed.next_buffer = 0;
+    }
+
+    auto const& buffer = replayed.buffers[replayed.next_buffer];
+    replayed.next_buffer = (replayed.next_buffer + 1) % replayed.buffers.size();
+
+    if (event.damage)
+        replayed.stream->add_damage(event.damage.value());
+    replayed.stream->submit_buffer(buffer);
+}
+
+void ms::SceneReplayer::remove_surface_with(int id)
+{
+    auto const replayed = surfaces.find(id);
+    if (replayed != surfaces.end())
+    {
+        stack->remove_surface(replayed->second.surface);
+        surfaces.erase(replayed);
+    }
+}
+
+void ms::SceneReplayer::remove_all()
+{
+    for (auto const& replayed : surfaces)
+        stack->remove_surface(replayed.second.surface);
+    surfaces.clear();
+}
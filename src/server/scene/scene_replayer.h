@@ -0,0 +1,104 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_SCENE_SCENE_REPLAYER_H_
+#define MIR_SCENE_SCENE_REPLAYER_H_
+
+#include "scene_trace.h"
+
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mir
+{
+namespace compositor
+{
+class BufferStream;
+}
+namespace graphics
+{
+class Buffer;
+class GraphicBufferAllocator;
+}
+namespace shell
+{
+class SurfaceStack;
+}
+namespace scene
+{
+class BasicSurface;
+class BufferStreamFactory;
+class SceneReport;
+
+/**
+ * Plays a trace recorded by SceneRecorder into the stack, as it was recorded and then over again, until destroyed
+ *
+ * Each recorded surface becomes a surface of our own, with no client, that takes no input. Its frames are software
+ * buffers of the recorded size and format, submitted with the recorded damage, so the compositor has the same work
+ * to do (uploading and drawing) as it had when the trace was recorded.
+ */
+class SceneReplayer
+{
+public:
+    SceneReplayer(
+        std::vector<SceneTraceEvent> events,
+        std::shared_ptr<shell::SurfaceStack> const& stack,
+        std::shared_ptr<BufferStreamFactory> const& stream_factory,
+        std::shared_ptr<graphics::GraphicBufferAllocator> const& allocator,
+        std::shared_ptr<SceneReport> const& report);
+    ~SceneReplayer();
+
+private:
+    SceneReplayer(SceneReplayer const&) = delete;
+    SceneReplayer& operator=(SceneReplayer const&) = delete;
+
+    struct ReplayedSurface
+    {
+        std::shared_ptr<BasicSurface> surface;
+        std::shared_ptr<compositor::BufferStream> stream;
+        /// Cycled through, so the compositor can hold a couple while we submit another
+        std::vector<std::shared_ptr<graphics::Buffer>> buffers;
+        size_t next_buffer{0};
+    };
+
+    void run();
+    void apply(SceneTraceEvent const& event);
+    void submit_frame(ReplayedSurface& replayed, SceneTraceEvent const& event);
+    void remove_surface_with(int id);
+    void remove_all();
+
+    std::vector<SceneTraceEvent> const events;
+    std::shared_ptr<shell::SurfaceStack> const stack;
+    std::shared_ptr<BufferStreamFactory> const stream_factory;
+    std::shared_ptr<graphics::GraphicBufferAllocator> const allocator;
+    std::shared_ptr<SceneReport> const report;
+
+    /// Only touched by the replay thread
+    std::map<int, ReplayedSurface> surfaces;
+
+    std::mutex mutex;
+    std::condition_variable stop_requested;
+    bool stopping{false};
+    std::thread thread;
+};
+}
+}
+
+#endif /* MIR_SCENE_SCENE_REPLAYER_H_ */
@@ -0,0 +1,261 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "scene_trace.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <algorithm>
+#include <istream>
+#include <sstream>
+#include <stdexcept>
+
+namespace ms = mir::scene;
+namespace geom = mir::geometry;
+
+char const* const ms::scene_trace_header = "mir-scene-trace 1";
+
+namespace
+{
+struct TypeName
+{
+    ms::SceneTraceEvent::Type type;
+    char const* name;
+};
+
+TypeName const type_names[] = {
+    {ms::SceneTraceEvent::Type::add, "add"},
+    {ms::SceneTraceEvent::Type::remove, "remove"},
+    {ms::SceneTraceEvent::Type::move, "move"},
+    {ms::SceneTraceEvent::Type::resize, "resize"},
+    {ms::SceneTraceEvent::Type::visible, "visible"},
+    {ms::SceneTraceEvent::Type::alpha, "alpha"},
+    {ms::SceneTraceEvent::Type::layer, "layer"},
+    {ms::SceneTraceEvent::Type::order, "order"},
+    {ms::SceneTraceEvent::Type::frame, "frame"}};
+
+auto name_of(ms::SceneTraceEvent::Type type) -> char const*
+{
+    for (auto const& t : type_names)
+    {
+        if (t.type == type)
+            return t.name;
+    }
+    return "unknown";
+}
+
+void write_size(std::ostream& out, geom::Size const& size)
+{
+    out << " " << size.width.as_int() << " " << size.height.as_int();
+}
+
+void write_point(std::ostream& out, geom::Point const& point)
+{
+    out << " " << point.x.as_int() << " " << point.y.as_int();
+}
+
+template<typename T>
+auto read(std::istream& in) -> T
+{
+    T value;
+    if (!(in >> value))
+        BOOST_THROW_EXCEPTION(std::runtime_error{"Truncated scene trace event"});
+    return value;
+}
+
+auto read_size(std::istream& in) -> geom::Size
+{
+    auto const width = read<int>(in);
+    auto const height = read<int>(in);
+    return {width, height};
+}
+
+auto read_point(std::istream& in) -> geom::Point
+{
+    auto const x = read<int>(in);
+    auto const y = read<int>(in);
+    return {x, y};
+}
+}
+
+auto ms::to_string(SceneTraceEvent const& event) -> std::string
+{
+    std::ostringstream out;
+    out << event.time.count() << " " << name_of(event.type);
+
+    if (event.type != SceneTraceEvent::Type::order)
+        out << " " << event.surface;
+
+    switch (event.type)
+    {
+    case SceneTraceEvent::Type::add:
+        out << " " << event.depth_layer;
+        write_point(out, event.area.top_left);
+        write_size(out, event.area.size);
+        out << " " << event.format;
+        break;
+
+    case SceneTraceEvent::Type::remove:
+        break;
+
+    case SceneTraceEvent::Type::move:
+        write_point(out, event.area.top_left);
+        break;
+
+    case SceneTraceEvent::Type::resize:
+        write_size(out, event.area.size);
+        break;
+
+    case SceneTraceEvent::Type::visible:
+        out << " " << (event.visible ? 1 : 0);
+        break;
+
+    case SceneTraceEvent::Type::alpha:
+        out << " " << event.alpha;
+        break;
+
+    case SceneTraceEvent::Type::layer:
+        out << " " << event.depth_layer;
+        break;
+
+    case SceneTraceEvent::Type::order:
+        for (auto const surface : event.order)
+            out << " " << surface;
+        break;
+
+    case SceneTraceEvent::Type::frame:
+        write_size(out, event.area.size);
+        out << " " << event.format;
+        if (event.damage)
+        {
+            auto const& damage = event.damage.value();
+            out << " " << damage.size();
+            for (auto const& rect : damage)
+            {
+                write_point(out, rect.top_left);
+                write_size(out, rect.size);
+            }
+        }
+        else
+        {
+            out << " -1";
+        }
+        break;
+    }
+
+    return out.str();
+}
+
+auto ms::parse_scene_trace_event(std::string const& line) -> SceneTraceEvent
+{
+    std::istringstream in{line};
+    SceneTraceEvent event;
+
+    event.time = std::chrono::microseconds{read<long long>(in)};
+    auto const name = read<std::string>(in);
+    auto const type = std::find_if(
+        std::begin(type_names), std::end(type_names),
+        [&](auto const& t) { return name == t.name; });
+    if (type == std::end(type_names))
+        BOOST_THROW_EXCEPTION(std::runtime_error{"Unknown scene trace event \"" + name + "\""});
+    event.type = type->type;
+
+    if (event.type != SceneTraceEvent::Type::order)
+        event.surface = read<int>(in);
+
+    switch (event.type)
+    {
+    case SceneTraceEvent::Type::add:
+        event.depth_layer = static_cast<MirDepthLayer>(read<int>(in));
+        event.area.top_left = read_point(in);
+        event.area.size = read_size(in);
+        event.format = static_cast<MirPixelFormat>(read<int>(in));
+        break;
+
+    case SceneTraceEvent::Type::remove:
+        break;
+
+    case SceneTraceEvent::Type::move:
+        event.area.top_left = read_point(in);
+        break;
+
+    case SceneTraceEvent::Type::resize:
+        event.area.size = read_size(in);
+        break;
+
+    case SceneTraceEvent::Type::visible:
+        event.visible = read<int>(in) != 0;
+        break;
+
+    case SceneTraceEvent::Type::alpha:
+        event.alpha = read<float>(in);
+        break;
+
+    case SceneTraceEvent::Type::layer:
+        event.depth_layer = static_cast<MirDepthLayer>(read<int>(in));
+        break;
+
+    case SceneTraceEvent::Type::order:
+        for (int surface; in >> surface;)
+            event.order.push_back(surface);
+        break;
+
+    case SceneTraceEvent::Type::frame:
+    {
+        event.area.size = read_size(in);
+        event.format = static_cast<MirPixelFormat>(read<int>(in));
+        auto const rects = read<int>(in);
+        if (rects >= 0)
+        {
+            geom::Rectangles damage;
+            for (int i = 0; i != rects; ++i)
+            {
+                auto const top_left = read_point(in);
+                damage.add({top_left, read_size(in)});
+            }
+            event.damage = damage;
+        }
+        break;
+    }
+    }
+
+    return event;
+}
+
+auto ms::read_scene_trace(std::istream& in) -> std::vector<SceneTraceEvent>
+{
+    std::string line;
+    if (!std::getline(in, line) || line != scene_trace_header)
+        BOOST_THROW_EXCEPTION(std::runtime_error{"Not a scene trace (expected \"" + std::string{scene_trace_header} + "\")"});
+
+    std::vector<SceneTraceEvent> events;
+    for (int line_number = 2; std::getline(in, line); ++line_number)
+    {
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        try
+        {
+            events.push_back(parse_scene_trace_event(line));
+        }
+        catch (std::exception const& error)
+        {
+            BOOST_THROW_EXCEPTION(std::runtime_error{
+                "Scene trace line " + std::to_string(line_number) + ": " + error.what()});
+        }
+    }
+    return events;
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_SCENE_SCENE_TRACE_H_
+#define MIR_SCENE_SCENE_TRACE_H_
+
+#include "mir/geometry/rectangle.h"
+#include "mir/geometry/rectangles.h"
+#include "mir_toolkit/common.h"
+
+#include <chrono>
+#include <experimental/optional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace mir
+{
+namespace scene
+{
+/**
+ * One change to the scene's workload, as recorded by SceneRecorder and replayed by SceneReplayer
+ *
+ * A trace is a line of text per event, after a header line, so it can be read, trimmed and edited by hand:
+ *
+ *   mir-scene-trace 1
+ *   <us> add <surface> <depth layer> <x> <y> <width> <height> <pixel format>
+ *   <us> remove <surface>
+ *   <us> move <surface> <x> <y>
+ *   <us> resize <surface> <width> <height>
+ *   <us> visible <surface> <0|1>
+ *   <us> alpha <surface> <alpha>
+ *   <us> layer <surface> <depth layer>
+ *   <us> order <surface>...                  (every surface, bottom to top)
+ *   <us> frame <surface> <width> <height> <pixel format> <damage rectangles, or -1 for all> [<x> <y> <w> <h>]...
+ *
+ * Blank lines, and lines starting with #, are ignored.
+ *
+ * Times are microseconds from the start of the recording; surfaces are numbered in order of appearance. Nothing
+ * names an application or holds any content, so a trace is safe to share.
+ */
+struct SceneTraceEvent
+{
+    enum class Type
+    {
+        add,
+        remove,
+        move,
+        resize,
+        visible,
+        alpha,
+        layer,
+        order,
+        frame
+    };
+
+    std::chrono::microseconds time{0};
+    Type type{Type::add};
+    int surface{0};
+
+    /// The position (add, move) and size (add, resize, frame)
+    geometry::Rectangle area;
+    MirPixelFormat format{mir_pixel_format_invalid};
+    MirDepthLayer depth_layer{mir_depth_layer_application};
+    bool visible{true};
+    float alpha{1.0f};
+    /// For order: every surface, bottom to top
+    std::vector<int> order;
+    /// For frame: nullopt if the whole buffer changed
+    std::experimental::optional<geometry::Rectangles> damage;
+};
+
+extern char const* const scene_trace_header;
+
+auto to_string(SceneTraceEvent const& event) -> std::string;
+
+/// \throws std::runtime_error if \a line isn't an event
+auto parse_scene_trace_event(std::string const& line) -> SceneTraceEvent;
+
+/// Reads a whole trace, throwing std::runtime_error (naming the line) if it's malformed
+auto read_scene_trace(std::istream& in) -> std::vector<SceneTraceEvent>;
+}
+}
+
+#endif /* MIR_SCENE_SCENE_TRACE_H_ */
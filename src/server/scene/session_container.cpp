@@ -20,41 +20,57 @@
 
 #include <boost/throw_exception.hpp>
 
-#include <algorithm>
+#include <atomic>
 #include <stdexcept>
 
 namespace ms = mir::scene;
 
-ms::SessionContainer::SessionContainer() = default;
+ms::SessionContainer::SessionContainer()
+    : snapshot{std::make_shared<Snapshot>()}
+{
+}
+
 ms::SessionContainer::~SessionContainer() = default;
 
 void ms::SessionContainer::insert_session(std::shared_ptr<Session> const& session)
 {
-    std::unique_lock<std::mutex> lk(guard);
+    std::lock_guard<std::mutex> lk(guard);
+
+    auto fresh = std::make_shared<Snapshot>(*current_snapshot());
+    fresh->index[session.get()] = fresh->apps.size();
+    fresh->apps.push_back(session);
 
-    apps.push_back(session);
+    std::atomic_store(&snapshot, std::shared_ptr<Snapshot const>{std::move(fresh)});
 }
 
 void ms::SessionContainer::remove_session(std::shared_ptr<Session> const& session)
 {
-    std::unique_lock<std::mutex> lk(guard);
+    std::lock_guard<std::mutex> lk(guard);
 
-    auto it = std::find(apps.begin(), apps.end(), session);
-    if (it != apps.end())
-    {
-        apps.erase(it);
-    }
-    else
-    {
+    auto const current = current_snapshot();
+    auto const position = current->index.find(session.get());
+    if (position == current->index.end())
         BOOST_THROW_EXCEPTION(std::logic_error("Invalid Session"));
+
+    auto fresh = std::make_shared<Snapshot>();
+    fresh->apps.reserve(current->apps.size() - 1);
+    for (auto const& app : current->apps)
+    {
+        if (app != session)
+        {
+            fresh->index[app.get()] = fresh->apps.size();
+            fresh->apps.push_back(app);
+        }
     }
+
+    std::atomic_store(&snapshot, std::shared_ptr<Snapshot const>{std::move(fresh)});
 }
 
 void ms::SessionContainer::for_each(std::function<void(std::shared_ptr<Session> const&)> f) const
 {
-    std::unique_lock<std::mutex> lk(guard);
+    auto const current = current_snapshot();
 
-    for (auto const& ptr : apps)
+    for (auto const& ptr : current->apps)
     {
         f(ptr);
     }
@@ -63,47 +79,38 @@ void ms::SessionContainer::for_each(std::function<void(std::shared_ptr<Session>
 auto ms::SessionContainer::successor_of(std::shared_ptr<Session> const& session) const
     -> std::shared_ptr<ms::Session>
 {
-    std::shared_ptr<Session> result, first;
+    auto const current = current_snapshot();
+    auto const& apps = current->apps;
 
-    if (!session && apps.size())
-        return apps.back();
-    else if(!session)
-        return std::shared_ptr<Session>();
+    if (!session)
+        return apps.empty() ? std::shared_ptr<Session>() : apps.back();
 
-    for (auto it = apps.begin(); it != apps.end(); it++)
-    {
-        if (*it == session)
-        {
-            auto successor = ++it;
-            if (successor == apps.end())
-                return *apps.begin();
-            else return *successor;
-        }
-    }
-
-    BOOST_THROW_EXCEPTION(std::logic_error("Invalid session"));
+    return apps[(index_of(*current, session) + 1) % apps.size()];
 }
 
 auto mir::scene::SessionContainer::predecessor_of(std::shared_ptr<Session> const& session) const
     -> std::shared_ptr<Session>
 {
-    std::shared_ptr<Session> result, first;
+    auto const current = current_snapshot();
+    auto const& apps = current->apps;
 
-    if (!session && apps.size())
-        return apps.front();
-    else if(!session)
-        return std::shared_ptr<Session>();
+    if (!session)
+        return apps.empty() ? std::shared_ptr<Session>() : apps.front();
 
-    for (auto it = apps.rbegin(); it != apps.rend(); it++)
-    {
-        if (*it == session)
-        {
-            auto successor = ++it;
-            if (successor == apps.rend())
-                return *apps.rbegin();
-            else return *successor;
-        }
-    }
+    return apps[(index_of(*current, session) + apps.size() - 1) % apps.size()];
+}
+
+auto ms::SessionContainer::current_snapshot() const -> std::shared_ptr<Snapshot const>
+{
+    return std::atomic_load(&snapshot);
+}
+
+auto ms::SessionContainer::index_of(Snapshot const& snapshot, std::shared_ptr<Session> const& session)
+    -> std::size_t
+{
+    auto const position = snapshot.index.find(session.get());
+    if (position == snapshot.index.end())
+        BOOST_THROW_EXCEPTION(std::logic_error("Invalid session"));
 
-    BOOST_THROW_EXCEPTION(std::logic_error("Invalid session"));
+    return position->second;
 }
@@ -20,6 +20,7 @@
 #define MIR_SCENE_SNAPSHOT_STRATEGY_H_
 
 #include "mir/scene/snapshot.h"
+#include "mir/geometry/size.h"
 
 #include <memory>
 
@@ -38,6 +39,17 @@ public:
         std::shared_ptr<compositor::BufferStream> const& surface_buffer_access,
         SnapshotCallback const& snapshot_taken) = 0;
 
+    /**
+     * Takes a snapshot scaled down (preserving aspect ratio) to fit within max_size.
+     *
+     * Thumbnails of the same buffer may be reused, so the Snapshot passed to
+     * thumbnail_taken is only valid during the callback.
+     */
+    virtual void take_thumbnail_of(
+        std::shared_ptr<compositor::BufferStream> const& surface_buffer_access,
+        geometry::Size const& max_size,
+        SnapshotCallback const& thumbnail_taken) = 0;
+
 protected:
     SnapshotStrategy() = default;
     SnapshotStrategy(SnapshotStrategy const&) = delete;
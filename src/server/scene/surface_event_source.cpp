@@ -48,8 +48,11 @@ void ms::SurfaceEventSource::content_resized_to(Surface const*, geometry::Size c
 
 void ms::SurfaceEventSource::moved_to(Surface const* surface, geometry::Point const& top_left)
 {
-    auto new_output_properties = outputs.properties_for(geom::Rectangle{top_left, surface->window_size()});
-    if (new_output_properties && (new_output_properties != last_output.lock()))
+    auto const previous_output = last_output.lock();
+    auto new_output_properties = outputs.properties_for(
+        geom::Rectangle{top_left, surface->window_size()},
+        previous_output);
+    if (new_output_properties && (new_output_properties != previous_output))
     {
         event_sink->handle_event(mev::make_event(
             id,
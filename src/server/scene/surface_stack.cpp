@@ -20,12 +20,16 @@
 
 #include "surface_stack.h"
 #include "rendering_tracker.h"
+#include "scene_element_pool.h"
 #include "mir/scene/surface.h"
 #include "mir/scene/null_surface_observer.h"
 #include "mir/scene/scene_report.h"
 #include "mir/compositor/scene_element.h"
+#include "mir/compositor/presentation.h"
+#include "mir/graphics/buffer.h"
 #include "mir/graphics/renderable.h"
 #include "mir/depth_layer.h"
+#include "mir/lock_profile.h"
 
 #include <boost/throw_exception.hpp>
 
@@ -41,21 +45,27 @@ namespace mg = mir::graphics;
 namespace mi = mir::input;
 namespace geom = mir::geometry;
 
+using namespace std::chrono_literals;
+
 namespace
 {
+/// A compositor waits no longer than this for a transaction to end, rather than stall indefinitely
+auto const max_transaction_wait = 100ms;
+
+mir::LockProfile stack_lock_profile{"SurfaceStack"};
 
 class SurfaceSceneElement : public mc::SceneElement
 {
 public:
     SurfaceSceneElement(
-        std::string name,
         std::shared_ptr<mg::Renderable> const& renderable,
+        std::shared_ptr<ms::Surface> const& surface,
         std::shared_ptr<ms::RenderingTracker> const& tracker,
         mc::CompositorID id)
         : renderable_{renderable},
+          surface{surface},
           tracker{tracker},
-          cid{id},
-          surface_name(name)
+          cid{id}
     {
     }
 
@@ -67,6 +77,8 @@ public:
     void rendered() override
     {
         tracker->rendered_in(cid);
+        if (presentation)
+            presentation->rendered = true;
     }
 
     void occluded() override
@@ -74,11 +86,46 @@ public:
         tracker->occluded_in(cid);
     }
 
+    void scanned_out() override
+    {
+        if (presentation)
+            presentation->zero_copy = true;
+    }
+
+    auto presentation_callback() -> PresentationCallback override
+    {
+        auto const buffer = renderable_->buffer();
+        if (!buffer)
+            return {};
+
+        presentation = std::make_shared<Outcome>();
+        return [presentation = presentation,
+                weak_surface = std::weak_ptr<ms::Surface>{surface},
+                id = renderable_->id(),
+                buffer_id = buffer->id(),
+                placement = renderable_->screen_position()](mg::Frame const& frame, geom::Rectangle const& output_area)
+            {
+                if (!presentation->rendered)
+                    return;
+
+                if (auto const surface = weak_surface.lock())
+                    surface->presented(id, {buffer_id, frame, output_area, presentation->zero_copy, placement});
+            };
+    }
+
 private:
+    /// What the compositor did with us, for the presentation callback
+    struct Outcome
+    {
+        bool rendered{false};
+        bool zero_copy{false};
+    };
+
     std::shared_ptr<mg::Renderable> const renderable_;
+    std::shared_ptr<ms::Surface> const surface;
     std::shared_ptr<ms::RenderingTracker> const tracker;
     mc::CompositorID cid;
-    std::string const surface_name;
+    std::shared_ptr<Outcome> presentation;
 };
 
 //note: something different than a 2D/HWC overlay
@@ -104,10 +151,33 @@ public:
     {
     }
 
+    void scanned_out() override
+    {
+    }
+
+    auto presentation_callback() -> PresentationCallback override
+    {
+        return {};
+    }
+
 private:
     std::shared_ptr<mg::Renderable> const renderable_;
 };
 
+/// Whether a compositor showing area can't show any of the renderable
+bool is_outside(mg::Renderable const& renderable, geom::Rectangle const& area)
+{
+    static glm::mat4 const identity(1);
+
+    // A transformed renderable may be drawn anywhere
+    if (renderable.transformation() != identity)
+        return false;
+
+    auto const& position = renderable.screen_position();
+    return position.right() <= area.left() || position.left() >= area.right() ||
+           position.bottom() <= area.top() || position.top() >= area.bottom();
+}
+
 /**
  * A SurfaceDepthLayerObserver must not outlive the SurfaceStack it was created for
  */
@@ -132,10 +202,13 @@ private:
 
 ms::SurfaceStack::SurfaceStack(
     std::shared_ptr<SceneReport> const& report) :
+    guard{stack_lock_profile},
     report{report},
     scene_changed{false},
     surface_observer{std::make_shared<SurfaceDepthLayerObserver>(this)}
 {
+    RecursiveWriteLock lg(guard);
+    publish_snapshot();
 }
 
 ms::SurfaceStack::~SurfaceStack() noexcept(true)
@@ -150,59 +223,78 @@ ms::SurfaceStack::~SurfaceStack() noexcept(true)
     }
 }
 
-mc::SceneElementSequence ms::SurfaceStack::scene_elements_for(mc::CompositorID id)
+mc::SceneElementSequence ms::SurfaceStack::scene_elements_for(mc::CompositorID id, geom::Rectangle const& area)
 {
-    RecursiveReadLock lg(guard);
-
     scene_changed = false;
-    mc::SceneElementSequence elements;
-    for (auto const& layer : surface_layers)
+
+    for (;;)
     {
-        for (auto const& surface : layer)
+        // Don't show a transaction half done: wait for it, and start again if one began while we were reading
+        auto const transactions = wait_for_transactions();
+
+        // The snapshot keeps everything in it alive, so we needn't hold up changes to the stack while we use it
+        auto const scene = current_snapshot();
+
+        std::shared_ptr<SceneElementPool> pool;
+        auto const compositor = scene->element_pools.find(id);
+        if (compositor != scene->element_pools.end())
+            pool = compositor->second;
+
+        mc::SceneElementSequence elements;
+        elements.reserve(scene->surfaces.size() + scene->overlays.size());
+
+        for (auto const& entry : scene->surfaces)
         {
-            if (surface->visible())
+            if (entry.surface->visible())
             {
-                for (auto& renderable : surface->generate_renderables(id))
+                for (auto& renderable : entry.surface->generate_renderables(id))
                 {
-                    elements.emplace_back(
-                        std::make_shared<SurfaceSceneElement>(
-                            surface->name(),
-                            renderable,
-                            rendering_trackers[surface.get()],
-                            id));
+                    if (is_outside(*renderable, area))
+                    {
+                        // The compositor would only have found it occluded, after locking its buffer
+                        if (pool)
+                            entry.tracker->occluded_in(id);
+                        continue;
+                    }
+
+                    if (pool)
+                    {
+                        elements.emplace_back(std::allocate_shared<SurfaceSceneElement>(
+                            SceneElementAllocator<SurfaceSceneElement>{pool}, renderable, entry.surface, entry.tracker, id));
+                    }
+                    else
+                    {
+                        elements.emplace_back(
+                            std::make_shared<SurfaceSceneElement>(renderable, entry.surface, entry.tracker, id));
+                    }
                 }
             }
         }
+        for (auto const& renderable : scene->overlays)
+        {
+            elements.emplace_back(std::make_shared<OverlaySceneElement>(renderable));
+        }
+
+        if (transaction_count == transactions)
+            return elements;
     }
-    for (auto const& renderable : overlays)
-    {
-        elements.emplace_back(std::make_shared<OverlaySceneElement>(renderable));
-    }
-    return elements;
 }
 
 int ms::SurfaceStack::frames_pending(mc::CompositorID id) const
 {
-    RecursiveReadLock lg(guard);
+    auto const scene = current_snapshot();
 
     int result = scene_changed ? 1 : 0;
-    for (auto const& layer : surface_layers)
+    for (auto const& entry : scene->surfaces)
     {
-        for (auto const& surface : layer)
+        if (entry.surface->visible() && entry.tracker->is_exposed_in(id))
         {
-            if (surface->visible())
-            {
-                auto const tracker = rendering_trackers.find(surface.get());
-                if (tracker != rendering_trackers.end() && tracker->second->is_exposed_in(id))
-                {
-                    // Note that we ask the surface and not a Renderable.
-                    // This is because we don't want to waste time and resources
-                    // on a snapshot till we're sure we need it...
-                    int ready = surface->buffers_ready_for_compositor(id);
-                    if (ready > result)
-                        result = ready;
-                }
-            }
+            // Note that we ask the surface and not a Renderable.
+            // This is because we don't want to waste time and resources
+            // on a snapshot till we're sure we need it...
+            int ready = entry.surface->buffers_ready_for_compositor(id);
+            if (ready > result)
+                result = ready;
         }
     }
     return result;
@@ -213,6 +305,8 @@ void ms::SurfaceStack::register_compositor(mc::CompositorID cid)
     RecursiveWriteLock lg(guard);
 
     registered_compositors.insert(cid);
+    compositor_elements.emplace(cid, std::make_shared<SceneElementPool>());
+    publish_snapshot();
 
     update_rendering_tracker_compositors();
 }
@@ -222,6 +316,8 @@ void ms::SurfaceStack::unregister_compositor(mc::CompositorID cid)
     RecursiveWriteLock lg(guard);
 
     registered_compositors.erase(cid);
+    compositor_elements.erase(cid);
+    publish_snapshot();
 
     update_rendering_tracker_compositors();
 }
@@ -232,6 +328,7 @@ void ms::SurfaceStack::add_input_visualization(
     {
         RecursiveWriteLock lg(guard);
         overlays.push_back(overlay);
+        publish_snapshot();
     }
     emit_scene_changed();
 }
@@ -248,6 +345,7 @@ void ms::SurfaceStack::remove_input_visualization(
             BOOST_THROW_EXCEPTION(std::runtime_error("Attempt to remove an overlay which was never added or which has been previously removed"));
         }
         overlays.erase(p);
+        publish_snapshot();
     }
     
     emit_scene_changed();
@@ -259,9 +357,115 @@ void ms::SurfaceStack::emit_scene_changed()
         RecursiveWriteLock lg(guard);
         scene_changed = true;
     }
+    {
+        // The end of the transaction notifies observers once for everything in it
+        std::lock_guard<std::mutex> lock{transaction_mutex};
+        if (transaction_depth > 0 && transaction_thread == std::this_thread::get_id())
+            return;
+    }
     observers.scene_changed();
 }
 
+void ms::SurfaceStack::begin_transaction()
+{
+    {
+        std::unique_lock<std::mutex> lock{transaction_mutex};
+        if (transaction_depth > 0 && transaction_thread == std::this_thread::get_id())
+        {
+            ++transaction_depth;
+            return;
+        }
+
+        transaction_ended.wait(lock, [this] { return transaction_depth == 0; });
+        transaction_thread = std::this_thread::get_id();
+        transaction_depth = 1;
+        ++transaction_count;
+    }
+
+    // Until the transaction ends only this thread uses transaction_surfaces
+    auto const scene = current_snapshot();
+    transaction_surfaces.reserve(scene->surfaces.size());
+    for (auto const& entry : scene->surfaces)
+    {
+        entry.surface->begin_batched_changes();
+        transaction_surfaces.push_back(entry.surface);
+    }
+}
+
+void ms::SurfaceStack::end_transaction()
+{
+    {
+        std::lock_guard<std::mutex> lock{transaction_mutex};
+        if (transaction_depth == 0 || transaction_thread != std::this_thread::get_id())
+            BOOST_THROW_EXCEPTION(std::logic_error("No transaction open on this thread"));
+
+        if (transaction_depth > 1)
+        {
+            --transaction_depth;
+            return;
+        }
+    }
+
+    SurfaceSet reordered;
+    auto const close = [&]
+        {
+            {
+                std::lock_guard<std::mutex> lock{transaction_mutex};
+                transaction_depth = 0;
+                transaction_thread = {};
+                ++transaction_count;
+                reordered.swap(transaction_reordered);
+            }
+            transaction_ended.notify_all();
+        };
+
+    // Compositors woken by the surfaces' observers wait for the transaction to close before reading the scene
+    std::vector<std::shared_ptr<Surface>> surfaces;
+    surfaces.swap(transaction_surfaces);
+    try
+    {
+        for (auto const& surface : surfaces)
+            surface->end_batched_changes();
+    }
+    catch (...)
+    {
+        close();
+        throw;
+    }
+    close();
+
+    if (!reordered.empty())
+        observers.surfaces_reordered(reordered);
+    emit_scene_changed();
+}
+
+void ms::SurfaceStack::notify_surfaces_reordered(SurfaceSet const& affected_surfaces)
+{
+    {
+        std::lock_guard<std::mutex> lock{transaction_mutex};
+        if (transaction_depth > 0 && transaction_thread == std::this_thread::get_id())
+        {
+            transaction_reordered.insert(begin(affected_surfaces), end(affected_surfaces));
+            return;
+        }
+    }
+    observers.surfaces_reordered(affected_surfaces);
+}
+
+auto ms::SurfaceStack::wait_for_transactions() const -> uint64_t
+{
+    auto const transactions = transaction_count.load();
+    if (transactions % 2 == 0)
+        return transactions;
+
+    std::unique_lock<std::mutex> lock{transaction_mutex};
+    if (transaction_thread != std::this_thread::get_id())
+    {
+        transaction_ended.wait_for(lock, max_transaction_wait, [this] { return transaction_count % 2 == 0; });
+    }
+    return transaction_count;
+}
+
 void ms::SurfaceStack::add_surface(
     std::shared_ptr<Surface> const& surface,
     mi::InputReceptionMode input_mode)
@@ -271,6 +475,7 @@ void ms::SurfaceStack::add_surface(
         insert_surface_at_top_of_depth_layer(surface);
         create_rendering_tracker_for(surface);
         surface->add_observer(surface_observer);
+        publish_snapshot();
     }
     surface->set_reception_mode(input_mode);
     observers.surface_added(surface);
@@ -295,6 +500,7 @@ void ms::SurfaceStack::remove_surface(std::weak_ptr<Surface> const& surface)
                 layer.erase(surface);
                 rendering_trackers.erase(keep_alive.get());
                 keep_alive->remove_observer(surface_observer);
+                publish_snapshot();
                 found_surface = true;
                 break;
             }
@@ -325,18 +531,15 @@ InReverse<Container> in_reverse(Container& container) { return InReverse<Contain
 auto ms::SurfaceStack::surface_at(geometry::Point cursor) const
 -> std::shared_ptr<Surface>
 {
-    RecursiveReadLock lg(guard);
-    for (auto const& layer : in_reverse(surface_layers))
+    auto const scene = current_snapshot();
+    for (auto const& entry : in_reverse(scene->surfaces))
     {
-        for (auto const& surface : in_reverse(layer))
-        {
-            // TODO There's a lack of clarity about how the input area will
-            // TODO be maintained and whether this test will detect clicks on
-            // TODO decorations (it should) as these may be outside the area
-            // TODO known to the client.  But it works for now.
-            if (surface->input_area_contains(cursor))
-                    return surface;
-        }
+        // TODO There's a lack of clarity about how the input area will
+        // TODO be maintained and whether this test will detect clicks on
+        // TODO decorations (it should) as these may be outside the area
+        // TODO known to the client.  But it works for now.
+        if (entry.surface->input_area_contains(cursor))
+                return entry.surface;
     }
 
     return {};
@@ -344,13 +547,10 @@ auto ms::SurfaceStack::surface_at(geometry::Point cursor) const
 
 void ms::SurfaceStack::for_each(std::function<void(std::shared_ptr<mi::Surface> const&)> const& callback)
 {
-    RecursiveReadLock lg(guard);
-    for (auto const& layer : surface_layers)
+    auto const scene = current_snapshot();
+    for (auto const& entry : scene->surfaces)
     {
-        for (auto const& surface : layer)
-        {
-            callback(surface);
-        }
+        callback(entry.surface);
     }
 }
 
@@ -375,6 +575,7 @@ void ms::SurfaceStack::raise(Surface const* surface)
                 std::shared_ptr<Surface> surface_shared = *p;
                 layer.erase(p);
                 insert_surface_at_top_of_depth_layer(surface_shared);
+                publish_snapshot();
                 affected_surfaces.insert(surface_shared);
                 break;
             }
@@ -387,7 +588,7 @@ void ms::SurfaceStack::raise(Surface const* surface)
     }
     else
     {
-        observers.surfaces_reordered(affected_surfaces);
+        notify_surfaces_reordered(affected_surfaces);
     }
 
 }
@@ -426,11 +627,14 @@ void ms::SurfaceStack::raise(SurfaceSet const& ss)
             if (old_layer != layer)
                 surfaces_reordered = true;
         }
+
+        if (surfaces_reordered)
+            publish_snapshot();
     }
 
     if (surfaces_reordered)
     {
-        observers.surfaces_reordered(ss);
+        notify_surfaces_reordered(ss);
     }
 }
 
@@ -459,6 +663,29 @@ void ms::SurfaceStack::insert_surface_at_top_of_depth_layer(std::shared_ptr<Surf
     surface_layers[depth_index].push_back(surface);
 }
 
+auto ms::SurfaceStack::current_snapshot() const -> std::shared_ptr<Snapshot const>
+{
+    return std::atomic_load(&snapshot);
+}
+
+void ms::SurfaceStack::publish_snapshot()
+{
+    auto fresh = std::make_shared<Snapshot>();
+    for (auto const& layer : surface_layers)
+    {
+        for (auto const& surface : layer)
+        {
+            auto const tracker = rendering_trackers.find(surface.get());
+            if (tracker != rendering_trackers.end())
+                fresh->surfaces.push_back({surface, tracker->second});
+        }
+    }
+    fresh->overlays = overlays;
+    fresh->element_pools = compositor_elements;
+
+    std::atomic_store(&snapshot, std::shared_ptr<Snapshot const>{std::move(fresh)});
+}
+
 void ms::SurfaceStack::add_observer(std::shared_ptr<ms::Observer> const& observer)
 {
     observers.add(observer);
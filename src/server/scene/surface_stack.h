@@ -31,10 +31,12 @@
 #include "mir/scene/surface_observer.h"
 
 #include <atomic>
+#include <condition_variable>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <set>
+#include <thread>
 #include <vector>
 
 namespace mir
@@ -50,6 +52,7 @@ namespace scene
 class BasicSurface;
 class SceneReport;
 class RenderingTracker;
+class SceneElementPool;
 
 class Observers : public Observer, BasicObservers<Observer>
 {
@@ -78,7 +81,9 @@ public:
     virtual ~SurfaceStack() noexcept(true);
 
     // From Scene
-    compositor::SceneElementSequence scene_elements_for(compositor::CompositorID id) override;
+    compositor::SceneElementSequence scene_elements_for(
+        compositor::CompositorID id,
+        geometry::Rectangle const& area) override;
     int frames_pending(compositor::CompositorID) const override;
     void register_compositor(compositor::CompositorID id) override;
     void unregister_compositor(compositor::CompositorID id) override;
@@ -109,12 +114,43 @@ public:
 
     void emit_scene_changed() override;
 
+    void begin_transaction() override;
+    void end_transaction() override;
+
 private:
     SurfaceStack(const SurfaceStack&) = delete;
     SurfaceStack& operator=(const SurfaceStack&) = delete;
     void create_rendering_tracker_for(std::shared_ptr<Surface> const&);
     void update_rendering_tracker_compositors();
     void insert_surface_at_top_of_depth_layer(std::shared_ptr<Surface> const& surface);
+    /// Notifies observers, or holds the notification back if there's a transaction open on this thread
+    void notify_surfaces_reordered(SurfaceSet const& affected_surfaces);
+    /// Waits for any transaction open on another thread to end, returning transaction_count
+    auto wait_for_transactions() const -> uint64_t;
+
+    /**
+     * The stack as it stands, flattened for readers.
+     *
+     * Snapshots are immutable: writers publish a new one after each change,
+     * so readers never need to lock guard, and the last reader of an old
+     * snapshot frees it.
+     */
+    struct Snapshot
+    {
+        struct Entry
+        {
+            std::shared_ptr<Surface> surface;
+            std::shared_ptr<RenderingTracker> tracker;
+        };
+
+        std::vector<Entry> surfaces;    ///< Bottom to top, including those not currently visible
+        std::vector<std::shared_ptr<graphics::Renderable>> overlays;
+        std::map<compositor::CompositorID, std::shared_ptr<SceneElementPool>> element_pools;
+    };
+
+    auto current_snapshot() const -> std::shared_ptr<Snapshot const>;
+    /// Must be called with guard write locked, after any change to the state captured by Snapshot
+    void publish_snapshot();
 
     RecursiveReadWriteMutex mutable guard;
 
@@ -130,9 +166,25 @@ private:
     std::vector<std::vector<std::shared_ptr<Surface>>> surface_layers;
     std::map<Surface*,std::shared_ptr<RenderingTracker>> rendering_trackers;
     std::set<compositor::CompositorID> registered_compositors;
+
+    /// Lets a registered compositor build its scene without going to the heap for each element
+    std::map<compositor::CompositorID, std::shared_ptr<SceneElementPool>> compositor_elements;
     
     std::vector<std::shared_ptr<graphics::Renderable>> overlays;
 
+    /// Only accessed through std::atomic_load() and std::atomic_store()
+    std::shared_ptr<Snapshot const> snapshot;
+
+    std::mutex mutable transaction_mutex;
+    std::condition_variable mutable transaction_ended;
+    std::thread::id transaction_thread;
+    int transaction_depth{0};
+    /// The surfaces whose notifications are batched by the open transaction
+    std::vector<std::shared_ptr<Surface>> transaction_surfaces;
+    SurfaceSet transaction_reordered;
+    /// Odd while a transaction is open, so that compositors can tell whether one overlapped their reading the scene
+    std::atomic<uint64_t> transaction_count{0};
+
     Observers observers;
     std::atomic<bool> scene_changed;
     std::shared_ptr<SurfaceObserver> surface_observer;
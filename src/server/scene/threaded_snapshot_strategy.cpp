@@ -19,11 +19,18 @@
 #include "threaded_snapshot_strategy.h"
 #include "pixel_buffer.h"
 #include "mir/compositor/buffer_stream.h"
+#include "mir/graphics/buffer.h"
+#include "mir/graphics/buffer_id.h"
 #include "mir/thread_name.h"
 
+#include <algorithm>
+#include <cmath>
 #include <deque>
 #include <mutex>
 #include <condition_variable>
+#include <experimental/optional>
+#include <unordered_map>
+#include <vector>
 
 namespace geom = mir::geometry;
 namespace ms = mir::scene;
@@ -37,8 +44,39 @@ struct WorkItem
 {
     std::shared_ptr<compositor::BufferStream> const stream;
     ms::SnapshotCallback const snapshot_taken;
+    /// Set for thumbnails: the size the snapshot is scaled to fit within
+    std::experimental::optional<geom::Size> const max_size;
 };
 
+namespace
+{
+/// Scales size down (never up) to fit within max_size, preserving its aspect ratio
+auto fit_within(geom::Size const& size, geom::Size const& max_size) -> geom::Size
+{
+    auto const width = size.width.as_int();
+    auto const height = size.height.as_int();
+    auto const max_width = std::max(1, max_size.width.as_int());
+    auto const max_height = std::max(1, max_size.height.as_int());
+
+    if (width <= max_width && height <= max_height)
+        return size;
+
+    auto const scale = std::min(double(max_width) / width, double(max_height) / height);
+    return {std::max(1, int(std::lround(width * scale))), std::max(1, int(std::lround(height * scale)))};
+}
+
+/// A thumbnail kept until its stream has a new buffer (that is, until the next commit)
+struct Thumbnail
+{
+    std::weak_ptr<compositor::BufferStream> stream;
+    graphics::BufferID buffer;
+    geom::Size requested;
+    geom::Size size;
+    geom::Stride stride;
+    std::vector<char> pixels;
+};
+}
+
 class SnapshottingFunctor
 {
 public:
@@ -73,6 +111,12 @@ public:
 
     void take_snapshot(WorkItem const& wi)
     {
+        if (wi.max_size)
+        {
+            take_thumbnail(wi);
+            return;
+        }
+
         wi.stream->with_most_recent_buffer_do([this](mir::graphics::Buffer& buffer) {
             pixels->fill_from(buffer);
         });
@@ -83,6 +127,46 @@ public:
                      pixels->as_argb_8888()});
     }
 
+    void take_thumbnail(WorkItem const& wi)
+    {
+        auto& thumbnail = thumbnails[wi.stream.get()];
+        bool filled{false};
+
+        wi.stream->with_most_recent_buffer_do([&](mir::graphics::Buffer& buffer)
+            {
+                auto const size = fit_within(buffer.size(), *wi.max_size);
+
+                if (thumbnail.stream.lock() != wi.stream ||
+                    thumbnail.buffer != buffer.id() ||
+                    thumbnail.requested != size)
+                {
+                    pixels->fill_scaled_from(buffer, size);
+                    thumbnail.stream = wi.stream;
+                    thumbnail.buffer = buffer.id();
+                    thumbnail.requested = size;
+                    filled = true;
+                }
+            });
+
+        if (filled)
+        {
+            thumbnail.size = pixels->size();
+            thumbnail.stride = pixels->stride();
+            auto const data = static_cast<char const*>(pixels->as_argb_8888());
+            thumbnail.pixels.assign(data, data + thumbnail.stride.as_int() * thumbnail.size.height.as_int());
+        }
+
+        wi.snapshot_taken(ms::Snapshot{thumbnail.size, thumbnail.stride, thumbnail.pixels.data()});
+
+        for (auto i = thumbnails.begin(); i != thumbnails.end();)
+        {
+            if (i->second.stream.expired())
+                i = thumbnails.erase(i);
+            else
+                ++i;
+        }
+    }
+
     void schedule_snapshot(WorkItem const& wi)
     {
         std::lock_guard<std::mutex> lg{work_mutex};
@@ -103,6 +187,8 @@ private:
     std::mutex work_mutex;
     std::condition_variable work_cv;
     std::deque<WorkItem> work;
+    /// Only touched by the snapshotting thread
+    std::unordered_map<compositor::BufferStream const*, Thumbnail> thumbnails;
 };
 
 }
@@ -126,5 +212,13 @@ void ms::ThreadedSnapshotStrategy::take_snapshot_of(
     std::shared_ptr<compositor::BufferStream> const& surface_buffer_access,
     SnapshotCallback const& snapshot_taken)
 {
-    functor->schedule_snapshot(WorkItem{surface_buffer_access, snapshot_taken});
+    functor->schedule_snapshot(WorkItem{surface_buffer_access, snapshot_taken, {}});
+}
+
+void ms::ThreadedSnapshotStrategy::take_thumbnail_of(
+    std::shared_ptr<compositor::BufferStream> const& surface_buffer_access,
+    geometry::Size const& max_size,
+    SnapshotCallback const& thumbnail_taken)
+{
+    functor->schedule_snapshot(WorkItem{surface_buffer_access, thumbnail_taken, max_size});
 }
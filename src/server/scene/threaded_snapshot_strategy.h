@@ -42,6 +42,12 @@ public:
         std::shared_ptr<compositor::BufferStream> const& surface_buffer_access,
         SnapshotCallback const& snapshot_taken);
 
+    /// Scales on the GPU, and reuses the thumbnail until the stream's buffer changes
+    void take_thumbnail_of(
+        std::shared_ptr<compositor::BufferStream> const& surface_buffer_access,
+        geometry::Size const& max_size,
+        SnapshotCallback const& thumbnail_taken);
+
 private:
     std::shared_ptr<PixelBuffer> const pixels;
     std::unique_ptr<SnapshottingFunctor> functor;
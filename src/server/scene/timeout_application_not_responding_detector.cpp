@@ -18,24 +18,43 @@
 
 #include "timeout_application_not_responding_detector.h"
 #include "mir/scene/session.h"
+#include "mir/scene/surface.h"
 
 #include "mir/time/alarm_factory.h"
 
 namespace ms = mir::scene;
 namespace mt = mir::time;
 
+namespace
+{
+/// A session nobody can see is pinged (and so found unresponsive) this many times less often
+uint64_t const hidden_session_ping_cycles = 4;
+
+/// Enough slots that a session is never scheduled a whole turn of the wheel ahead
+size_t const wheel_slots = 8;
+
+bool is_hidden(ms::Session const* session)
+{
+    auto const surface = session->default_surface();
+    return surface &&
+        (!surface->visible() || surface->query(mir_window_attrib_visibility) == mir_window_visibility_occluded);
+}
+}
+
 struct ms::TimeoutApplicationNotRespondingDetector::ANRContext
 {
     ANRContext(std::function<void()> const& pinger)
         : pinger{pinger},
           replied_since_last_ping{true},
-          flagged_as_unresponsive{false}
+          flagged_as_unresponsive{false},
+          due_cycle{0}
     {
     }
 
     std::function<void()> const pinger;
     bool replied_since_last_ping;
     bool flagged_as_unresponsive;
+    uint64_t due_cycle;     ///< The cycle the session is in the wheel for, or 0 if it isn't
 };
 
 void ms::TimeoutApplicationNotRespondingDetector::ANRObservers::session_unresponsive(
@@ -53,7 +72,8 @@ void ms::TimeoutApplicationNotRespondingDetector::ANRObservers::session_now_resp
 ms::TimeoutApplicationNotRespondingDetector::TimeoutApplicationNotRespondingDetector(
     mt::AlarmFactory& alarms,
     std::chrono::milliseconds period)
-    : period{period},
+    : wheel(wheel_slots),
+      period{period},
       alarm{alarms.create_alarm(std::bind(&TimeoutApplicationNotRespondingDetector::handle_ping_cycle, this))}
 {
 }
@@ -68,7 +88,11 @@ void ms::TimeoutApplicationNotRespondingDetector::register_session(
     bool alarm_needs_schedule;
     {
         std::lock_guard<std::mutex> lock{session_mutex};
-        sessions[dynamic_cast<Session const*>(session)] = std::make_unique<ANRContext>(pinger);
+        auto& context = sessions[dynamic_cast<Session const*>(session)];
+        if (context && context->due_cycle)
+            --scheduled_sessions;
+        context = std::make_unique<ANRContext>(pinger);
+        schedule(session, *context, current_cycle + 1);
         alarm_needs_schedule = alarm->state() != mt::Alarm::State::pending;
     }
     if (alarm_needs_schedule)
@@ -81,7 +105,13 @@ void ms::TimeoutApplicationNotRespondingDetector::unregister_session(
     scene::Session const* session)
 {
     std::lock_guard<std::mutex> lock{session_mutex};
-    sessions.erase(dynamic_cast<Session const*>(session));
+    auto const context = sessions.find(dynamic_cast<Session const*>(session));
+    if (context != sessions.end())
+    {
+        if (context->second->due_cycle)
+            --scheduled_sessions;
+        sessions.erase(context);
+    }
 }
 
 void ms::TimeoutApplicationNotRespondingDetector::pong_received(
@@ -100,6 +130,10 @@ void ms::TimeoutApplicationNotRespondingDetector::pong_received(
         }
         session_ctx->replied_since_last_ping = true;
 
+        // An unresponsive session isn't in the wheel; it's pinged again from the next cycle
+        if (!session_ctx->due_cycle)
+            schedule(received_for, *session_ctx, current_cycle + 1);
+
         alarm_needs_rescheduling = alarm->state() != mt::Alarm::State::pending;
     }
     if (needs_now_responsive_notification)
@@ -141,31 +175,54 @@ void ms::TimeoutApplicationNotRespondingDetector::unregister_observer(
     observers.remove(observer);
 }
 
+void ms::TimeoutApplicationNotRespondingDetector::schedule(
+    Session const* session, ANRContext& context, uint64_t cycle)
+{
+    if (!context.due_cycle)
+        ++scheduled_sessions;
+    context.due_cycle = cycle;
+    wheel[cycle % wheel.size()].push_back(session);
+}
+
 void ms::TimeoutApplicationNotRespondingDetector::handle_ping_cycle()
 {
     bool needs_rearm{false};
     {
         std::lock_guard<std::mutex> lock{session_mutex};
-        for (auto const& session_pair : sessions)
+        auto const cycle = ++current_cycle;
+
+        // Sessions are only ever scheduled for later cycles, so nothing adds to this slot while we work through it
+        auto& due_sessions = wheel[cycle % wheel.size()];
+        for (auto const session : due_sessions)
         {
-            bool const newly_unresponsive =
-                !session_pair.second->replied_since_last_ping &&
-                !session_pair.second->flagged_as_unresponsive;
-            bool const needs_ping =
-                session_pair.second->replied_since_last_ping;
+            auto const found = sessions.find(session);
+            if (found == sessions.end() || found->second->due_cycle != cycle)
+                continue;   // Unregistered or rescheduled since this entry was made
+
+            auto& context = *found->second;
+            context.due_cycle = 0;
+            --scheduled_sessions;
 
-            if (newly_unresponsive)
+            if (!context.replied_since_last_ping)
             {
-                session_pair.second->flagged_as_unresponsive = true;
-                unresponsive_sessions_temporary.push_back(session_pair.first);
+                // It stays out of the wheel until it pongs
+                if (!context.flagged_as_unresponsive)
+                {
+                    context.flagged_as_unresponsive = true;
+                    unresponsive_sessions_temporary.push_back(session);
+                }
             }
-            else if (needs_ping)
+            else
             {
-                session_pair.second->pinger();
-                session_pair.second->replied_since_last_ping = false;
-                needs_rearm = true;
+                context.pinger();
+                context.replied_since_last_ping = false;
+                schedule(session, context, cycle + (is_hidden(session) ? hidden_session_ping_cycles : 1));
             }
         }
+
+        due_sessions.clear();
+
+        needs_rearm = scheduled_sessions > 0;
     }
 
     // Dispatch notifications outside the lock.
@@ -23,8 +23,11 @@
 #include "mir/basic_observers.h"
 
 #include <chrono>
-#include <unordered_map>
+#include <cstdint>
 #include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 namespace mir
 {
@@ -68,6 +71,9 @@ private:
 
     struct ANRContext;
 
+    /// Puts the session in the slot of the ping cycle it next needs attention
+    void schedule(Session const* session, ANRContext& context, uint64_t cycle);
+
     class ANRObservers : public Observer, private BasicObservers<Observer>
     {
     public:
@@ -82,6 +88,17 @@ private:
     std::unordered_map<Session const*, std::unique_ptr<ANRContext>> sessions;
     std::vector<Session const*> unresponsive_sessions_temporary;
 
+    /**
+     * A timing wheel of the sessions due attention in each of the next few ping cycles
+     *
+     * A cycle only visits the sessions in its slot, rather than every session. Entries aren't removed
+     * when a session is unregistered or rescheduled; they are skipped unless the session is (still)
+     * due in the cycle being handled.
+     */
+    std::vector<std::vector<Session const*>> wheel;
+    uint64_t current_cycle{0};
+    size_t scheduled_sessions{0};
+
     std::chrono::milliseconds const period;
     std::unique_ptr<time::Alarm> const alarm;
 };
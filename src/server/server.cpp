@@ -33,6 +33,10 @@
 #include "mir/main_loop.h"
 #include "mir/report_exception.h"
 #include "mir/run_mir.h"
+#include "mir/startup_report.h"
+#include "mir/raii.h"
+#include "mir/thread_name.h"
+#include "mir/thread_scheduling.h"
 #include "mir/cookie/authority.h"
 
 // TODO these are used to frig a stub renderer when running headless
@@ -109,6 +113,7 @@ struct TemporaryCompositeEventFilter : public mi::CompositeEventFilter
     MACRO(persistent_surface_store)
 
 #define FOREACH_ACCESSOR(MACRO)\
+    MACRO(the_buffer_pool)\
     MACRO(the_buffer_stream_factory)\
     MACRO(the_compositor)\
     MACRO(the_compositor_report)\
@@ -401,18 +406,45 @@ void mir::Server::run()
 
         // keep the default_reports alive while the server is running
         auto const default_reports = self->server_config->default_reports();
+        auto const startup_report = self->server_config->the_startup_report();
 
         self->temporary_event_filter->move_filters(composite_event_filter);
 
         if (self->emergency_cleanup_handler)
             emergency_cleanup->add(self->emergency_cleanup_handler);
 
+        // Before the server's threads start, so their stacks and heaps are locked as they grow
+        if (self->server_config->the_options()->get<bool>(options::lock_memory_opt))
+            lock_process_memory();
+
+        // Applied to each thread as it is named, while the server runs
+        auto const thread_scheduling = parse_thread_scheduling_rules(
+            self->server_config->the_options()->get<std::string>(options::thread_scheduling_opt));
+        auto const thread_scheduling_hook = raii::paired_calls(
+            [&] { set_thread_name_hook([thread_scheduling](auto const& name) { apply_thread_scheduling(thread_scheduling, name); }); },
+            [] { set_thread_name_hook({}); });
+
         self->pre_init_callback();
 
+        // Started once the display is up, and kept while the server runs
+        std::shared_ptr<void> scene_recording;
+        std::shared_ptr<void> application_scheduling;
+        std::shared_ptr<void> performance_hud_overlay;
+
         run_mir(
             *self->server_config,
             [&](DisplayServer&)
-                { self->init_callback(); self->init_callback = []{}; },
+                {
+                    self->init_callback(); self->init_callback = []{};
+                    scene_recording = self->server_config->scene_recording();
+                    application_scheduling = self->server_config->application_scheduling();
+                    performance_hud_overlay = self->server_config->performance_hud_overlay();
+
+                    // Runs once the main loop does, after everything has started
+                    self->server_config->the_main_loop()->enqueue(
+                        this,
+                        [startup_report] { startup_report->phase_completed(StartupReport::Phase::started); });
+                },
             self->terminator);
 
         self->exit_status = true;
@@ -617,6 +617,16 @@ void msh::AbstractShell::raise(SurfaceSet const& surfaces)
     report->surfaces_raised(surfaces);
 }
 
+void msh::AbstractShell::begin_transaction()
+{
+    surface_stack->begin_transaction();
+}
+
+void msh::AbstractShell::end_transaction()
+{
+    surface_stack->end_transaction();
+}
+
 void msh::AbstractShell::set_drag_and_drop_handle(std::vector<uint8_t> const& handle)
 {
     input_targeter->set_drag_and_drop_handle(handle);
@@ -264,8 +264,7 @@ void msd::BasicDecoration::request_close()
 void msd::BasicDecoration::set_cursor(std::string const& cursor_image_name)
 {
     msh::SurfaceSpecification spec;
-    // size is hard-coded because current implementation ignores it
-    spec.cursor_image = cursor_images->image(cursor_image_name, {16, 16});
+    spec.cursor_image = cursor_images->image(cursor_image_name, mir::input::default_cursor_size);
     shell->modify_surface(session, decoration_surface, spec);
 }
 
@@ -378,10 +377,9 @@ void msd::BasicDecoration::update(
         std::shared_ptr<mc::BufferStream>,
         std::experimental::optional<std::shared_ptr<mg::Buffer>>>> new_buffers;
 
+    // Borders are a solid color stretched over their rect, so only change with the theme
     if (window_updated({
-            &WindowState::focused_state,
-            &WindowState::side_border_width,
-            &WindowState::side_border_height}))
+            &WindowState::focused_state}))
     {
         new_buffers.emplace_back(
             buffer_streams->left_border,
@@ -389,13 +387,6 @@ void msd::BasicDecoration::update(
         new_buffers.emplace_back(
             buffer_streams->right_border,
             renderer->render_right_border());
-    }
-
-    if (window_updated({
-            &WindowState::focused_state,
-            &WindowState::bottom_border_width,
-            &WindowState::bottom_border_height}))
-    {
         new_buffers.emplace_back(
             buffer_streams->bottom_border,
             renderer->render_bottom_border());
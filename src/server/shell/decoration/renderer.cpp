@@ -22,17 +22,28 @@
 #include "input.h"
 
 #include "mir/graphics/graphic_buffer_allocator.h"
+#include "mir/graphics/buffer_basic.h"
+#include "mir/graphics/solid_color_buffer.h"
 #include "mir/renderer/sw/pixel_source.h"
 #include "mir/geometry/displacement.h"
 #include "mir/log.h"
+#include "mir/memory_account.h"
 
 #include <boost/throw_exception.hpp>
 #include <boost/filesystem.hpp>
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <locale>
 #include <codecvt>
+#include <unordered_map>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 namespace ms = mir::scene;
 namespace mg = mir::graphics;
@@ -167,6 +178,132 @@ inline void render_minimize_icon(
         render_row(data, buf_size, {box.left(), y}, mini_taskbar_size, color);
     }
 }
+
+/// The title strip is drawn to a multiple of this width
+int const title_strip_slack = 256;
+
+mir::MemoryAccount decorations{"decorations", "renderers"};
+
+/// Enough for the titles of a busy desktop in a few scripts; past this the glyph cache starts again
+size_t const max_cached_glyphs = 1024;
+
+/// c * a / 255, correctly rounded for 8-bit c and a
+inline auto mul_div255(uint32_t c, uint32_t a) -> uint32_t
+{
+    auto const t = c * a + 128;
+    return (t + (t >> 8)) >> 8;
+}
+
+#if defined(__SSE2__)
+/// Per 16-bit lane x / 255, correctly rounded for x <= 255 * 255
+inline auto div255_epi16(__m128i x) -> __m128i
+{
+    auto const t = _mm_add_epi16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+#endif
+
+/// Blends color over count pixels of dst, each weighted by its coverage (and color's alpha).
+/// The alpha of dst is left as it is.
+void blend_coverage_span(uint32_t* dst, uint8_t const* coverage, size_t count, uint32_t color)
+{
+    auto const color_alpha = color >> 24;
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    auto const zero = _mm_setzero_si128();
+    auto const max = _mm_set1_epi16(255);
+    auto const dst_alpha = _mm_set1_epi32(0xff000000);
+    auto const color_alpha_lanes = _mm_set1_epi16(color_alpha);
+    auto const color_lanes = _mm_unpacklo_epi8(_mm_set1_epi32(color), zero);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        uint32_t four_coverages;
+        std::memcpy(&four_coverages, coverage + i, sizeof four_coverages);
+        if (!four_coverages)
+            continue;   // Most of a line of text is the gaps between strokes
+
+        // Spread each pixel's coverage over its four channels
+        auto spread = _mm_cvtsi32_si128(four_coverages);
+        spread = _mm_unpacklo_epi8(spread, spread);
+        spread = _mm_unpacklo_epi16(spread, spread);
+        auto const alpha_lo = div255_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(spread, zero), color_alpha_lanes));
+        auto const alpha_hi = div255_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(spread, zero), color_alpha_lanes));
+
+        auto const d = _mm_loadu_si128(reinterpret_cast<__m128i const*>(dst + i));
+        auto const result_lo = _mm_add_epi16(
+            div255_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), _mm_sub_epi16(max, alpha_lo))),
+            div255_epi16(_mm_mullo_epi16(color_lanes, alpha_lo)));
+        auto const result_hi = _mm_add_epi16(
+            div255_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), _mm_sub_epi16(max, alpha_hi))),
+            div255_epi16(_mm_mullo_epi16(color_lanes, alpha_hi)));
+
+        auto const result = _mm_or_si128(
+            _mm_and_si128(d, dst_alpha),
+            _mm_andnot_si128(dst_alpha, _mm_packus_epi16(result_lo, result_hi)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), result);
+    }
+#endif
+
+    for (; i != count; ++i)
+    {
+        auto const alpha = mul_div255(coverage[i], color_alpha);
+        if (!alpha)
+            continue;
+
+        uint32_t result = dst[i] & 0xff000000;
+        for (auto shift = 0; shift != 24; shift += 8)
+        {
+            auto const c = mul_div255((dst[i] >> shift) & 0xff, 255 - alpha) + mul_div255((color >> shift) & 0xff, alpha);
+            result |= std::min(c, 255u) << shift;
+        }
+        dst[i] = result;
+    }
+}
+
+/// A border: the renderers fill it with its color, so there are no pixels to draw or upload
+class SolidColor : public mg::BufferBasic, public mg::SolidColorBuffer
+{
+public:
+    explicit SolidColor(uint32_t argb)
+        : color_{
+              ((argb >> 16) & 0xFF) / 255.0f,
+              ((argb >>  8) & 0xFF) / 255.0f,
+              ((argb >>  0) & 0xFF) / 255.0f,
+              1.0f}
+    {
+        // Decoration colors are opaque, so these are already premultiplied
+    }
+
+    auto native_buffer_handle() const -> std::shared_ptr<mg::NativeBuffer> override
+    {
+        return nullptr;
+    }
+
+    auto size() const -> geom::Size override
+    {
+        return {1, 1};
+    }
+
+    auto pixel_format() const -> MirPixelFormat override
+    {
+        return mir_pixel_format_xrgb_8888;
+    }
+
+    auto native_buffer_base() -> mg::NativeBufferBase* override
+    {
+        return this;
+    }
+
+    auto color() const -> std::array<float, 4> override
+    {
+        return color_;
+    }
+
+private:
+    std::array<float, 4> const color_;
+};
 }
 
 class msd::Renderer::Text::Impl
@@ -185,16 +322,31 @@ public:
         Pixel color) override;
 
 private:
+    /// A glyph as FreeType rendered it, so that drawing the same title again needn't
+    struct Glyph
+    {
+        int left;
+        int top;
+        geom::Displacement advance;
+        geom::Size size;
+        std::vector<uint8_t> coverage; ///< size.width bytes per row
+    };
+
     std::mutex mutex;
     FT_Library library;
     FT_Face face;
+    geom::Height char_size;
+
+    /// Keyed by pixel height (high 32 bits) and codepoint
+    std::unordered_map<uint64_t, Glyph> glyphs;
 
+    auto glyph_for(char32_t codepoint, geom::Height height) -> Glyph const&;
     void set_char_size(geom::Height height);
     void rasterize_glyph(char32_t glyph);
     void render_glyph(
         Pixel* buf,
         geom::Size buf_size,
-        FT_Bitmap const* glyph,
+        Glyph const& glyph,
         geom::Point top_left,
         Pixel color);
 
@@ -290,34 +442,22 @@ void msd::Renderer::Text::Impl::render(
         return;
     }
 
-    try
-    {
-        set_char_size(height_pixels);
-    }
-    catch (std::runtime_error const& error)
-    {
-        log_warning("%s", error.what());
-        return;
-    }
-
     auto const utf32 = utf8_to_utf32(text);
 
-    for (char32_t const glyph : utf32)
+    for (char32_t const codepoint : utf32)
     {
         try
         {
-            rasterize_glyph(glyph);
+            auto const& glyph = glyph_for(codepoint, height_pixels);
 
             geom::Point glyph_top_left =
                 top_left +
                 geom::Displacement{
-                    face->glyph->bitmap_left,
-                    height_pixels.as_int() - face->glyph->bitmap_top};
-            render_glyph(buf, buf_size, &face->glyph->bitmap, glyph_top_left, color);
+                    glyph.left,
+                    height_pixels.as_int() - glyph.top};
+            render_glyph(buf, buf_size, glyph, glyph_top_left, color);
 
-            top_left += geom::Displacement{
-                face->glyph->advance.x / 64,
-                face->glyph->advance.y / 64};
+            top_left += glyph.advance;
         }
         catch (std::runtime_error const& error)
         {
@@ -326,6 +466,39 @@ void msd::Renderer::Text::Impl::render(
     }
 }
 
+auto msd::Renderer::Text::Impl::glyph_for(char32_t codepoint, geom::Height height) -> Glyph const&
+{
+    auto const key = (uint64_t(height.as_uint32_t()) << 32) | codepoint;
+    auto const cached = glyphs.find(key);
+    if (cached != glyphs.end())
+        return cached->second;
+
+    if (glyphs.size() >= max_cached_glyphs)
+        glyphs.clear();
+
+    if (height != char_size)
+    {
+        set_char_size(height);
+        char_size = height;
+    }
+
+    rasterize_glyph(codepoint);
+
+    auto const slot = face->glyph;
+    auto const& bitmap = slot->bitmap;
+    Glyph glyph{
+        slot->bitmap_left,
+        slot->bitmap_top,
+        {slot->advance.x / 64, slot->advance.y / 64},
+        {bitmap.width, bitmap.rows},
+        std::vector<uint8_t>(bitmap.width * bitmap.rows)};
+
+    for (unsigned row = 0; row < bitmap.rows; row++)
+        std::copy_n(bitmap.buffer + row * bitmap.pitch, bitmap.width, glyph.coverage.data() + row * bitmap.width);
+
+    return glyphs.emplace(key, std::move(glyph)).first->second;
+}
+
 void msd::Renderer::Text::Impl::set_char_size(geom::Height height)
 {
     if (auto const error = FT_Set_Pixel_Sizes(face, 0, height.as_int()))
@@ -349,40 +522,30 @@ void msd::Renderer::Text::Impl::rasterize_glyph(char32_t glyph)
 void msd::Renderer::Text::Impl::render_glyph(
     Pixel* buf,
     geom::Size buf_size,
-    FT_Bitmap const* glyph,
+    Glyph const& glyph,
     geom::Point top_left,
     Pixel color)
 {
     geom::X const buffer_left = std::max(top_left.x, geom::X{});
-    geom::X const buffer_right = std::min(top_left.x + geom::DeltaX{glyph->width}, as_x(buf_size.width));
+    geom::X const buffer_right = std::min(top_left.x + as_delta(glyph.size.width), as_x(buf_size.width));
 
     geom::Y const buffer_top = std::max(top_left.y, geom::Y{});
-    geom::Y const buffer_bottom = std::min(top_left.y + geom::DeltaY{glyph->rows}, as_y(buf_size.height));
+    geom::Y const buffer_bottom = std::min(top_left.y + as_delta(glyph.size.height), as_y(buf_size.height));
 
-    geom::Displacement const glyph_offset = as_displacement(top_left);
+    if (buffer_right <= buffer_left)
+        return;
 
-    unsigned char* const color_pixels = (unsigned char *)&color;
-    unsigned char const color_alpha = color_pixels[3];
+    geom::Displacement const glyph_offset = as_displacement(top_left);
+    auto const glyph_left = (buffer_left - glyph_offset.dx).as_int();
+    auto const span = (buffer_right - buffer_left).as_int();
 
     for (geom::Y buffer_y = buffer_top; buffer_y < buffer_bottom; buffer_y += geom::DeltaY{1})
     {
         geom::Y const glyph_y = buffer_y - glyph_offset.dy;
-        unsigned char* const glyph_row = glyph->buffer + glyph_y.as_int() * glyph->pitch;
+        uint8_t const* const glyph_row = glyph.coverage.data() + glyph_y.as_int() * glyph.size.width.as_int();
         Pixel* const buffer_row = buf + buffer_y.as_int() * buf_size.width.as_int();
 
-        for (geom::X buffer_x = buffer_left; buffer_x < buffer_right; buffer_x += geom::DeltaX{1})
-        {
-            geom::X const glyph_x = buffer_x - glyph_offset.dx;
-            unsigned char const glyph_alpha = ((int)glyph_row[glyph_x.as_int()] * color_alpha) / 255;
-            unsigned char* const buffer_pixels = (unsigned char *)(buffer_row + buffer_x.as_int());
-            for (int i = 0; i < 3; i++)
-            {
-                // Blend color with the previous buffer color based on the glyph's alpha
-                buffer_pixels[i] =
-                    ((int)buffer_pixels[i] * (255 - glyph_alpha)) / 255 +
-                    ((int)color_pixels[i] * glyph_alpha) / 255;
-            }
-        }
+        blend_coverage_span(buffer_row + buffer_left.as_int(), glyph_row + glyph_left, span, color);
     }
 }
 
@@ -462,68 +625,50 @@ msd::Renderer::Renderer(
               render_minimize_icon}},
       },
       static_geometry{static_geometry},
-      text{Text::instance()}
+      text{Text::instance()},
+      charge{decorations}
 {
 }
 
 void msd::Renderer::update_state(WindowState const& window_state, InputState const& input_state)
 {
-    left_border_size = window_state.left_border_rect().size;
-    right_border_size = window_state.right_border_rect().size;
-    bottom_border_size = window_state.bottom_border_rect().size;
-
-    size_t length{0};
-    length = std::max(length, area(left_border_size));
-    length = std::max(length, area(right_border_size));
-    length = std::max(length, area(bottom_border_size));
-
-    if (length != solid_color_pixels_length)
-    {
-        solid_color_pixels_length = length;
-        solid_color_pixels.reset(); // force a reallocation next time it's needed
-    }
-
     if (window_state.titlebar_rect().size != titlebar_size)
     {
         titlebar_size = window_state.titlebar_rect().size;
-        titlebar_pixels.reset(); // force a reallocation next time it's needed
+        titlebars.clear(); // force a reallocation next time they're needed
+        update_charge();
     }
 
-    Theme const* const new_theme = (window_state.focused_state() == mir_window_focus_state_focused) ?
+    current_theme = (window_state.focused_state() == mir_window_focus_state_focused) ?
         &focused_theme :
         &unfocused_theme;
 
-    if (new_theme != current_theme)
-    {
-        current_theme = new_theme;
-        needs_titlebar_redraw = true;
-        needs_solid_color_redraw = true;
-    }
-
     if (window_state.window_name() != name)
     {
         name = window_state.window_name();
-        needs_titlebar_redraw = true;
+        title_strips.clear();
+        update_charge();
+        for (auto& titlebar : titlebars)
+            titlebar.second.needs_redraw = true;
     }
 
     if (input_state.buttons() != buttons)
     {
         // If the number of buttons or their location changed, redraw the whole titlebar
         // Otherwise if the buttons are in the same place, just redraw them
-        if (input_state.buttons().size() != buttons.size())
+        bool moved = input_state.buttons().size() != buttons.size();
+        for (unsigned i = 0; !moved && i < buttons.size(); i++)
         {
-            needs_titlebar_redraw = true;
+            if (input_state.buttons()[i].rect != buttons[i].rect)
+                moved = true;
         }
-        else
+        buttons = input_state.buttons();
+
+        for (auto& titlebar : titlebars)
         {
-            for (unsigned i = 0; i < buttons.size(); i++)
-            {
-                if (input_state.buttons()[i].rect != buttons[i].rect)
-                    needs_titlebar_redraw = true;
-            }
+            titlebar.second.needs_redraw |= moved;
+            titlebar.second.needs_buttons_redraw = true;
         }
-        buttons = input_state.buttons();
-        needs_titlebar_buttons_redraw = true;
     }
 }
 
@@ -532,115 +677,122 @@ auto msd::Renderer::render_titlebar() -> std::experimental::optional<std::shared
     if (!area(titlebar_size))
         return std::experimental::nullopt;
 
-    if (!titlebar_pixels)
+    auto& titlebar = titlebars[current_theme];
+
+    if (!titlebar.pixels)
     {
-        titlebar_pixels = alloc_pixels(titlebar_size);
-        needs_titlebar_redraw = true;
+        titlebar.pixels = alloc_pixels(titlebar_size);
+        titlebar.needs_redraw = true;
     }
 
-    if (needs_titlebar_redraw)
+    if (titlebar.needs_redraw)
+        draw_title(titlebar.pixels.get());
+
+    if (titlebar.needs_redraw || titlebar.needs_buttons_redraw)
+        draw_buttons(titlebar.pixels.get());
+
+    titlebar.needs_redraw = false;
+    titlebar.needs_buttons_redraw = false;
+    update_charge();
+
+    return make_buffer(titlebar.pixels.get(), titlebar_size);
+}
+
+void msd::Renderer::draw_title(Pixel* pixels)
+{
+    auto& strip = title_strips[current_theme];
+
+    if (!strip.pixels || strip.size.width < titlebar_size.width || strip.size.height != titlebar_size.height)
     {
-        for (geom::Y y{0}; y < as_y(titlebar_size.height); y += geom::DeltaY{1})
+        // Interactive resizing changes the width on every motion, so leave room to grow
+        auto const width = (titlebar_size.width.as_int() + title_strip_slack - 1) / title_strip_slack * title_strip_slack;
+        strip.size = geom::Size{width, titlebar_size.height};
+        strip.pixels = alloc_pixels(strip.size);
+
+        for (geom::Y y{0}; y < as_y(strip.size.height); y += geom::DeltaY{1})
         {
             render_row(
-                titlebar_pixels.get(), titlebar_size,
-                {0, y}, titlebar_size.width,
+                strip.pixels.get(), strip.size,
+                {0, y}, strip.size.width,
                 current_theme->background_color);
         }
 
         text->render(
-            titlebar_pixels.get(),
-            titlebar_size,
+            strip.pixels.get(),
+            strip.size,
             name,
             static_geometry->title_font_top_left,
             static_geometry->title_font_height,
             current_theme->text_color);
     }
 
-    if (needs_titlebar_redraw || needs_titlebar_buttons_redraw)
+    // The text is clipped to the titlebar the same way it would be if drawn at this width
+    auto const row_length = titlebar_size.width.as_int();
+    for (auto y = 0; y < titlebar_size.height.as_int(); y++)
+    {
+        std::copy_n(strip.pixels.get() + y * strip.size.width.as_int(), row_length, pixels + y * row_length);
+    }
+}
+
+void msd::Renderer::draw_buttons(Pixel* pixels)
+{
+    for (auto const& button : buttons)
     {
-        for (auto const& button : buttons)
+        auto const icon = button_icons.find(button.function);
+        if (icon != button_icons.end())
         {
-            auto const icon = button_icons.find(button.function);
-            if (icon != button_icons.end())
+            Pixel button_color = icon->second.normal_color;
+            if (button.state == ButtonState::Hovered)
+                button_color = icon->second.active_color;
+            for (geom::Y y{button.rect.top()}; y < button.rect.bottom(); y += geom::DeltaY{1})
             {
-                Pixel button_color = icon->second.normal_color;
-                if (button.state == ButtonState::Hovered)
-                    button_color = icon->second.active_color;
-                for (geom::Y y{button.rect.top()}; y < button.rect.bottom(); y += geom::DeltaY{1})
-                {
-                    render_row(
-                        titlebar_pixels.get(),
-                        titlebar_size,
-                        {button.rect.left(), y},
-                        button.rect.size.width,
-                        button_color);
-                }
-                geom::Rectangle const icon_rect = {
-                button.rect.top_left + static_geometry->icon_padding, {
-                    button.rect.size.width - static_geometry->icon_padding.dx * 2,
-                    button.rect.size.height - static_geometry->icon_padding.dy * 2}};
-                icon->second.render_icon(
-                    titlebar_pixels.get(),
+                render_row(
+                    pixels,
                     titlebar_size,
-                    icon_rect,
-                    static_geometry->icon_line_width,
-                    icon->second.icon_color);
-            }
-            else
-            {
-                log_warning("Could not render decoration button with unknown function %d\n", static_cast<int>(button.function));
+                    {button.rect.left(), y},
+                    button.rect.size.width,
+                    button_color);
             }
+            geom::Rectangle const icon_rect = {
+            button.rect.top_left + static_geometry->icon_padding, {
+                button.rect.size.width - static_geometry->icon_padding.dx * 2,
+                button.rect.size.height - static_geometry->icon_padding.dy * 2}};
+            icon->second.render_icon(
+                pixels,
+                titlebar_size,
+                icon_rect,
+                static_geometry->icon_line_width,
+                icon->second.icon_color);
+        }
+        else
+        {
+            log_warning("Could not render decoration button with unknown function %d\n", static_cast<int>(button.function));
         }
     }
-
-    needs_titlebar_redraw = false;
-    needs_titlebar_buttons_redraw = false;
-
-    return make_buffer(titlebar_pixels.get(), titlebar_size);
 }
 
 auto msd::Renderer::render_left_border() -> std::experimental::optional<std::shared_ptr<mg::Buffer>>
 {
-    if (!area(left_border_size))
-        return std::experimental::nullopt;
-    update_solid_color_pixels();
-    return make_buffer(solid_color_pixels.get(), left_border_size);
+    return render_border();
 }
 
 auto msd::Renderer::render_right_border() -> std::experimental::optional<std::shared_ptr<mg::Buffer>>
 {
-    if (!area(right_border_size))
-        return std::experimental::nullopt;
-    update_solid_color_pixels();
-    return make_buffer(solid_color_pixels.get(), right_border_size);
+    return render_border();
 }
 
 auto msd::Renderer::render_bottom_border() -> std::experimental::optional<std::shared_ptr<mg::Buffer>>
 {
-    if (!area(bottom_border_size))
-        return std::experimental::nullopt;
-    update_solid_color_pixels();
-    return make_buffer(solid_color_pixels.get(), bottom_border_size);
+    return render_border();
 }
 
-void msd::Renderer::update_solid_color_pixels()
+auto msd::Renderer::render_border() -> std::experimental::optional<std::shared_ptr<mg::Buffer>>
 {
-    if (!solid_color_pixels)
-    {
-        solid_color_pixels = alloc_pixels(geom::Size{solid_color_pixels_length, 1});
-        needs_solid_color_redraw = true;
-    }
-
-    if (needs_solid_color_redraw)
-    {
-        render_row(
-            solid_color_pixels.get(), geom::Size{solid_color_pixels_length, 1},
-            geom::Point{}, geom::Width{solid_color_pixels_length},
-            current_theme->background_color);
-    }
+    if (!current_theme)
+        return std::experimental::nullopt;
 
-    needs_solid_color_redraw = false;
+    // The surface stretches the buffer over the border, so resizing needs no new buffer at all
+    return std::make_shared<SolidColor>(current_theme->background_color);
 }
 
 auto msd::Renderer::make_buffer(
@@ -671,9 +823,25 @@ auto msd::Renderer::make_buffer(
 
 auto msd::Renderer::alloc_pixels(geometry::Size size) -> std::unique_ptr<uint32_t[]>
 {
-    size_t const buf_size = area(size) * bytes_per_pixel;
-    if (buf_size)
-        return std::unique_ptr<uint32_t[]>{new uint32_t[buf_size]};
+    size_t const pixel_count = area(size);
+    if (pixel_count)
+        return std::unique_ptr<uint32_t[]>{new uint32_t[pixel_count]};
     else
         return nullptr;
 }
+
+void msd::Renderer::update_charge()
+{
+    size_t pixels{0};
+    for (auto const& titlebar : titlebars)
+    {
+        if (titlebar.second.pixels)
+            pixels += area(titlebar_size);
+    }
+    for (auto const& strip : title_strips)
+    {
+        if (strip.second.pixels)
+            pixels += area(strip.second.size);
+    }
+    charge.resize(pixels * bytes_per_pixel);
+}
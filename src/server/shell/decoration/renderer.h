@@ -20,6 +20,7 @@
 #define MIR_SHELL_DECORATION_RENDERER_H_
 
 #include "mir/geometry/rectangle.h"
+#include "mir/memory_account.h"
 
 #include "input.h"
 
@@ -112,28 +113,42 @@ private:
     std::map<ButtonFunction, Icon const> button_icons;
     std::shared_ptr<StaticGeometry const> const static_geometry;
 
-    bool needs_solid_color_redraw{true};
-    geometry::Size left_border_size;
-    geometry::Size right_border_size;
-    geometry::Size bottom_border_size;
-    size_t solid_color_pixels_length{0};
-    std::unique_ptr<Pixel[]> solid_color_pixels; // can be nullptr
+    /// The background and title, drawn wider than the titlebar so that resizing can copy it rather than draw the
+    /// text again
+    struct TitleStrip
+    {
+        geometry::Size size;
+        std::unique_ptr<Pixel[]> pixels; // can be nullptr
+    };
+
+    /// A titlebar as last drawn in a theme, so that changing focus back needn't draw it again
+    struct Titlebar
+    {
+        std::unique_ptr<Pixel[]> pixels; // can be nullptr
+        bool needs_redraw{true};
+        bool needs_buttons_redraw{true};
+    };
 
     geometry::Size titlebar_size{};
-    std::unique_ptr<Pixel[]> titlebar_pixels; // can be nullptr
+    std::map<Theme const*, TitleStrip> title_strips;
+    std::map<Theme const*, Titlebar> titlebars;
 
-    bool needs_titlebar_redraw{true};
-    bool needs_titlebar_buttons_redraw{true};
     std::string name;
     std::vector<ButtonInfo> buttons;
 
     std::shared_ptr<Text> const text;
 
-    void update_solid_color_pixels();
+    /// The titlebars and title strips held
+    MemoryCharge charge;
+
+    void draw_title(Pixel* pixels);
+    void draw_buttons(Pixel* pixels);
+    auto render_border() -> std::experimental::optional<std::shared_ptr<graphics::Buffer>>;
     auto make_buffer(
         Pixel const* pixels,
         geometry::Size size) -> std::experimental::optional<std::shared_ptr<graphics::Buffer>>;
     static auto alloc_pixels(geometry::Size size) -> std::unique_ptr<Pixel[]>;
+    void update_charge();
 };
 }
 }
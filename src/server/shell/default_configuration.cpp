@@ -23,6 +23,7 @@
 
 #include "mir/input/composite_event_filter.h"
 #include "mir/shell/abstract_shell.h"
+#include "mir/graphics/buffer_pool.h"
 #include "default_persistent_surface_store.h"
 #include "frontend_shell.h"
 #include "graphics_display_layout.h"
@@ -70,7 +71,7 @@ auto mir::DefaultServerConfiguration::the_decoration_manager() -> std::shared_pt
         [this]()->std::shared_ptr<msd::Manager>
         {
             return std::make_shared<msd::BasicManager>(
-                [buffer_allocator = the_buffer_allocator(),
+                [buffer_allocator = std::shared_ptr<mir::graphics::GraphicBufferAllocator>{the_buffer_pool()},
                  executor = the_main_loop(),
                  cursor_images = the_cursor_images()](
                     std::shared_ptr<shell::Shell> const& shell,
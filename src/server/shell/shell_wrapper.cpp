@@ -185,6 +185,16 @@ void msh::ShellWrapper::raise(SurfaceSet const& surfaces)
     return wrapped->raise(surfaces);
 }
 
+void msh::ShellWrapper::begin_transaction()
+{
+    wrapped->begin_transaction();
+}
+
+void msh::ShellWrapper::end_transaction()
+{
+    wrapped->end_transaction();
+}
+
 void msh::ShellWrapper::set_drag_and_drop_handle(std::vector<uint8_t> const& handle)
 {
     wrapped->set_drag_and_drop_handle(handle);
@@ -67,7 +67,9 @@ bool msh::SurfaceSpecification::is_empty() const
         !depth_layer.is_set() &&
         !attached_edges.is_set() &&
         !exclusive_rect.is_set() &&
-        !application_id.is_set();
+        !application_id.is_set() &&
+        !tearing_allowed.is_set() &&
+        !max_frame_rate.is_set();
 }
 
 void msh::SurfaceSpecification::update_from(SurfaceSpecification const& that)
@@ -146,4 +148,8 @@ void msh::SurfaceSpecification::update_from(SurfaceSpecification const& that)
         exclusive_rect = that.exclusive_rect;
     if (that.application_id.is_set())
         application_id = that.application_id;
+    if (that.tearing_allowed.is_set())
+        tearing_allowed = that.tearing_allowed;
+    if (that.max_frame_rate.is_set())
+        max_frame_rate = that.max_frame_rate;
 }
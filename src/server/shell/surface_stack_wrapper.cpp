@@ -55,3 +55,13 @@ auto msh::SurfaceStackWrapper::surface_at(geometry::Point point) const -> std::s
 {
     return wrapped->surface_at(point);
 }
+
+void msh::SurfaceStackWrapper::begin_transaction()
+{
+    wrapped->begin_transaction();
+}
+
+void msh::SurfaceStackWrapper::end_transaction()
+{
+    wrapped->end_transaction();
+}
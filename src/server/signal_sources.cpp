@@ -0,0 +1,217 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/signal_sources.h"
+#include <mir/log.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <sstream>
+#include <system_error>
+
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <boost/throw_exception.hpp>
+
+namespace md = mir::detail;
+
+class md::SignalSources::SourceRegistration
+{
+public:
+    SourceRegistration(int write_fd)
+        : write_fd{write_fd}
+    {
+        init_write_fds();
+        add_write_fd();
+    }
+
+    ~SourceRegistration()
+    {
+        remove_write_fd();
+    }
+
+    static void notify_sources_of_signal(int sig, siginfo_t* info, void*)
+    {
+        SignalPid const sigpid{sig, info->si_pid};
+
+        for (auto const& write_fd : write_fds)
+        {
+            // There is a benign race here: write_fd may have changed
+            // between checking and using it. This doesn't matter
+            // since in the worst case we will call write() with an invalid
+            // fd (-1) which is harmless.
+            if (write_fd >= 0 && write(write_fd, &sigpid, sizeof(sigpid))) {}
+        }
+    }
+
+private:
+    void init_write_fds()
+    {
+        static std::once_flag once;
+        std::call_once(once,
+            [&]
+            {
+                for (auto& wfd : write_fds)
+                    wfd = -1;
+            });
+    }
+
+    void add_write_fd()
+    {
+        for (auto& wfd : write_fds)
+        {
+            int v = -1;
+            if (wfd.compare_exchange_strong(v, write_fd))
+                return;
+        }
+
+        BOOST_THROW_EXCEPTION(
+            std::runtime_error(
+                "Failed to add signal write fd. Have you created too many main loops?"));
+    }
+
+    void remove_write_fd()
+    {
+        for (auto& wfd : write_fds)
+        {
+            int v = write_fd;
+            if (wfd.compare_exchange_strong(v, -1))
+                break;
+        }
+    }
+
+    static int const max_write_fds{10};
+    static std::array<std::atomic<int>, max_write_fds> write_fds;
+    int const write_fd;
+};
+
+std::array<std::atomic<int>,10> md::SignalSources::SourceRegistration::write_fds;
+
+md::SignalSources::SignalSources(mir::graphics::EventHandlerRegister& fd_register)
+    : fd_register(fd_register)
+{
+    int pipefd[2];
+
+    if (pipe(pipefd) == -1)
+    {
+        BOOST_THROW_EXCEPTION(
+            std::system_error(errno, std::system_category(), "Failed to create signal pipe"));
+    }
+
+    signal_read_fd = mir::Fd(pipefd[0]);
+    signal_write_fd = mir::Fd(pipefd[1]);
+
+    fcntl(signal_read_fd, F_SETFD, FD_CLOEXEC);
+    fcntl(signal_write_fd, F_SETFD, FD_CLOEXEC);
+    // Make the signal_write_fd non-blocking, to avoid blocking in the signal handler
+    fcntl(signal_write_fd, F_SETFL, O_NONBLOCK);
+
+    source_registration.reset(new SourceRegistration{signal_write_fd});
+
+    fd_register.register_fd_handler({signal_read_fd}, this,
+        [this] (int) { dispatch_pending_signal(); });
+}
+
+md::SignalSources::~SignalSources()
+{
+    for (auto const& handled : handled_signals)
+        sigaction(handled.first, &handled.second, nullptr);
+
+    fd_register.unregister_fd_handler(this);
+}
+
+void md::SignalSources::dispatch_pending_signal()
+{
+    auto const sig = read_pending_signal();
+    if (sig.sig != -1)
+    {
+        mir::log_debug("Handling %s from pid=%d", strsignal(sig.sig), sig.pid);
+        dispatch_signal(sig.sig);
+    }
+}
+
+auto md::SignalSources::read_pending_signal() -> SignalPid
+{
+    SignalPid sig{-1, 0};
+    size_t total = 0;
+
+    do
+    {
+        auto const nread = read(
+            signal_read_fd,
+            reinterpret_cast<char*>(&sig) + total,
+            sizeof(sig) - total);
+
+        if (nread < 0)
+        {
+            if (errno != EINTR)
+                return SignalPid{-1, 0};
+        }
+        else
+        {
+            total += nread;
+        }
+    }
+    while (total < sizeof(sig));
+
+    return sig;
+}
+
+void md::SignalSources::add(
+    std::vector<int> const& sigs, std::function<void(int)> const& handler)
+{
+    handlers.add({sigs, handler});
+    for (auto sig : sigs)
+        ensure_signal_is_handled(sig);
+}
+
+void md::SignalSources::ensure_signal_is_handled(int sig)
+{
+    std::lock_guard<std::mutex> lock{handled_signals_mutex};
+
+    if (handled_signals.find(sig) != handled_signals.end())
+        return;
+
+    struct sigaction old_action;
+    struct sigaction new_action;
+
+    new_action.sa_sigaction = SourceRegistration::notify_sources_of_signal;
+    sigfillset(&new_action.sa_mask);
+    new_action.sa_flags = SA_SIGINFO;
+
+    if (sigaction(sig, &new_action, &old_action) == -1)
+    {
+        std::stringstream msg;
+        msg << "Failed to register action for signal " << sig;
+        BOOST_THROW_EXCEPTION(
+            std::system_error(errno, std::system_category(), msg.str()));
+    }
+
+    handled_signals.emplace(sig, old_action);
+}
+
+void md::SignalSources::dispatch_signal(int sig)
+{
+    handlers.for_each(
+        [&] (HandlerElement const& element)
+        {
+            if (std::find(element.sigs.begin(), element.sigs.end(), sig) != element.sigs.end())
+                element.handler(sig);
+        });
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/thread/executor_batch.h"
+#include "mir/terminate_with_current_exception.h"
+#include "mir/executor.h"
+#include "mir/log.h"
+
+#include <algorithm>
+
+namespace mth = mir::thread;
+
+namespace
+{
+thread_local mth::ExecutorBatch* current_batch{nullptr};
+}
+
+mth::ExecutorBatch::ExecutorBatch()
+    : outermost{current_batch == nullptr}
+{
+    if (outermost)
+        current_batch = this;
+}
+
+mth::ExecutorBatch::~ExecutorBatch()
+{
+    if (!outermost)
+        return;
+
+    current_batch = nullptr;
+
+    for (auto& executor_work : pending)
+    {
+        try
+        {
+            executor_work.first->spawn(
+                [work = std::move(executor_work.second)]()
+                {
+                    for (auto const& item : work)
+                    {
+                        // One failure shouldn't cost the rest of the batch
+                        try
+                        {
+                            item();
+                        }
+                        catch (...)
+                        {
+                            mir::log(
+                                mir::logging::Severity::critical,
+                                MIR_LOG_COMPONENT,
+                                std::current_exception(),
+                                "Exception processing batched work item");
+                        }
+                    }
+                });
+        }
+        catch (...)
+        {
+            // Spawning unbatched would have thrown out of the spawning thread
+            mir::terminate_with_current_exception();
+        }
+    }
+}
+
+void mth::ExecutorBatch::spawn(std::shared_ptr<Executor> const& executor, std::function<void()>&& work)
+{
+    if (!current_batch)
+    {
+        executor->spawn(std::move(work));
+        return;
+    }
+
+    auto& pending = current_batch->pending;
+    auto const existing = std::find_if(
+        begin(pending),
+        end(pending),
+        [&](auto const& executor_work) { return executor_work.first == executor; });
+
+    if (existing != end(pending))
+    {
+        existing->second.push_back(std::move(work));
+    }
+    else
+    {
+        pending.emplace_back(executor, std::vector<std::function<void()>>{});
+        pending.back().second.push_back(std::move(work));
+    }
+}
@@ -0,0 +1,386 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/thread_scheduling.h"
+
+#include "mir/log.h"
+#include "mir/options/option.h"
+#include "mir/options/configuration.h"
+
+#include <gio/gio.h>
+
+#include <boost/throw_exception.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+#include <alloca.h>
+#include <fcntl.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace
+{
+/// The stack prefaulted for the compositor and input threads when memory is locked: far more than a frame needs
+std::size_t const critical_thread_stack_prefault{256 * 1024};
+
+/// RealtimeKit refuses threads that could hog a CPU, so they need a limit at or below its own (200ms by default)
+rlim_t const rttime_limit_usec{200000};
+
+/// Asks RealtimeKit to make the calling thread realtime, for when we aren't allowed to ourselves
+auto make_realtime_with_rtkit(int priority) -> std::string
+{
+    rlimit limit;
+    if (getrlimit(RLIMIT_RTTIME, &limit) == 0 && (limit.rlim_max == RLIM_INFINITY || limit.rlim_max > rttime_limit_usec))
+    {
+        limit.rlim_cur = limit.rlim_max = rttime_limit_usec;
+        if (setrlimit(RLIMIT_RTTIME, &limit) != 0)
+        {
+            return std::string{"could not limit RLIMIT_RTTIME: "} + strerror(errno);
+        }
+    }
+
+    GError* error{nullptr};
+    std::unique_ptr<GDBusConnection, decltype(&g_object_unref)> const bus{
+        g_bus_get_sync(G_BUS_TYPE_SYSTEM, nullptr, &error),
+        &g_object_unref};
+
+    if (bus)
+    {
+        auto const tid = static_cast<guint64>(syscall(SYS_gettid));
+        if (auto const reply = g_dbus_connection_call_sync(
+                bus.get(),
+                "org.freedesktop.RealtimeKit1",
+                "/org/freedesktop/RealtimeKit1",
+                "org.freedesktop.RealtimeKit1",
+                "MakeThreadRealtime",
+                g_variant_new("(tu)", tid, static_cast<guint32>(priority)),
+                nullptr,
+                G_DBUS_CALL_FLAGS_NONE,
+                -1,
+                nullptr,
+                &error))
+        {
+            g_variant_unref(reply);
+            return {};
+        }
+    }
+
+    std::string const message = error ? error->message : "unknown error";
+    if (error)
+    {
+        g_error_free(error);
+    }
+    return message;
+}
+
+/// Moves the calling thread into cgroup, returning an error message on failure
+auto move_to_cgroup(std::string const& cgroup) -> std::string
+{
+    auto const tid = std::to_string(syscall(SYS_gettid));
+
+    // cgroup v2 (which needs a threaded cgroup for this) then v1
+    for (auto const file : {"/cgroup.threads", "/tasks"})
+    {
+        auto const fd = open((cgroup + file).c_str(), O_WRONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            if (errno == ENOENT)
+            {
+                continue;
+            }
+            return strerror(errno);
+        }
+
+        auto const written = write(fd, tid.c_str(), tid.size());
+        auto const write_error = errno;
+        close(fd);
+
+        return written < 0 ? strerror(write_error) : std::string{};
+    }
+
+    return "not a cgroup directory";
+}
+
+/// Touches the next bytes of the calling thread's stack, so they're faulted in (and, once locked, stay in)
+void prefault_stack(std::size_t bytes)
+{
+    auto const stack = static_cast<volatile char*>(alloca(bytes));
+    for (std::size_t offset = 0; offset < bytes; offset += sysconf(_SC_PAGESIZE))
+    {
+        stack[offset] = 0;
+    }
+}
+
+auto parse_int_setting(std::string const& key, std::string const& value, int min, int max) -> int
+{
+    try
+    {
+        size_t end;
+        auto const result = std::stoi(value, &end);
+        if (end == value.size() && min <= result && result <= max)
+        {
+            return result;
+        }
+    }
+    catch (std::logic_error const&)
+    {
+    }
+
+    BOOST_THROW_EXCEPTION(std::invalid_argument{
+        "Invalid " + key + " \"" + value + "\" (expected " + std::to_string(min) + " to " + std::to_string(max) + ")"});
+}
+
+auto matches(std::string const& pattern, std::string const& name) -> bool
+{
+    if (!pattern.empty() && pattern.back() == '*')
+    {
+        return name.compare(0, pattern.size() - 1, pattern, 0, pattern.size() - 1) == 0;
+    }
+    return name == pattern;
+}
+}
+
+auto mir::parse_cpu_list(std::string const& list) -> std::vector<int>
+{
+    std::vector<int> result;
+    std::istringstream stream{list};
+    std::string item;
+
+    while (std::getline(stream, item, ','))
+    {
+        if (item.empty())
+        {
+            continue;
+        }
+
+        try
+        {
+            size_t end;
+            auto const first = std::stoi(item, &end);
+            auto last = first;
+            if (end < item.size())
+            {
+                if (item[end] != '-')
+                {
+                    BOOST_THROW_EXCEPTION(std::invalid_argument{"Unexpected \"" + item + "\""});
+                }
+                last = std::stoi(item.substr(end + 1));
+            }
+
+            if (first < 0 || last < first || last >= CPU_SETSIZE)
+            {
+                BOOST_THROW_EXCEPTION(std::invalid_argument{"Invalid CPU range \"" + item + "\""});
+            }
+
+            for (auto cpu = first; cpu <= last; cpu++)
+            {
+                result.push_back(cpu);
+            }
+        }
+        catch (std::out_of_range const&)
+        {
+            BOOST_THROW_EXCEPTION(std::invalid_argument{"Invalid CPU \"" + item + "\""});
+        }
+    }
+
+    return result;
+}
+
+auto mir::parse_thread_scheduling_rules(std::string const& rules) -> std::vector<ThreadSchedulingRule>
+{
+    std::vector<ThreadSchedulingRule> result;
+    std::istringstream stream{rules};
+    std::string rule;
+
+    while (std::getline(stream, rule, ';'))
+    {
+        if (rule.find_first_not_of(" \t") == std::string::npos)
+        {
+            continue;
+        }
+
+        auto const colon = rule.find(':');
+        auto const pattern_begin = rule.find_first_not_of(" \t");
+        if (colon == std::string::npos || colon == pattern_begin)
+        {
+            BOOST_THROW_EXCEPTION(std::invalid_argument{"Expected \"<thread name>:<settings>\", not \"" + rule + "\""});
+        }
+
+        ThreadSchedulingRule parsed;
+        parsed.name_pattern = rule.substr(pattern_begin, rule.find_last_not_of(" \t", colon - 1) + 1 - pattern_begin);
+
+        std::istringstream settings{rule.substr(colon + 1)};
+        std::string setting;
+        while (settings >> setting)
+        {
+            auto const equals = setting.find('=');
+            auto const key = setting.substr(0, equals);
+            auto const value = equals == std::string::npos ? std::string{} : setting.substr(equals + 1);
+
+            if (key == "cpus")
+            {
+                parsed.scheduling.cpus = parse_cpu_list(value);
+            }
+            else if (key == "rt")
+            {
+                parsed.scheduling.realtime_priority = parse_int_setting(key, value, 1, 99);
+            }
+            else if (key == "nice")
+            {
+                parsed.scheduling.nice = parse_int_setting(key, value, -20, 19);
+            }
+            else if (key == "cgroup" && !value.empty() && value.front() == '/')
+            {
+                parsed.scheduling.cgroup = value;
+            }
+            else if (key == "stack")
+            {
+                parsed.scheduling.prefault_stack = parse_int_setting(key, value, 1, 8192) * std::size_t{1024};
+            }
+            else
+            {
+                BOOST_THROW_EXCEPTION(std::invalid_argument{"Unexpected thread scheduling setting \"" + setting + "\""});
+            }
+        }
+
+        result.push_back(std::move(parsed));
+    }
+
+    return result;
+}
+
+auto mir::thread_scheduling_from(
+    options::Option const& options,
+    char const* priority_opt,
+    char const* cpus_opt) -> ThreadScheduling
+{
+    ThreadScheduling result;
+    result.realtime_priority = options.get<int>(priority_opt);
+    result.cpus = parse_cpu_list(options.get<std::string>(cpus_opt));
+    if (options.get<bool>(options::lock_memory_opt))
+    {
+        result.prefault_stack = critical_thread_stack_prefault;
+    }
+    return result;
+}
+
+void mir::apply_thread_scheduling(ThreadScheduling const& scheduling, std::string const& thread_name)
+{
+    if (scheduling.prefault_stack > 0)
+    {
+        prefault_stack(scheduling.prefault_stack);
+    }
+
+    if (!scheduling.cpus.empty())
+    {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for (auto const cpu : scheduling.cpus)
+        {
+            CPU_SET(cpu, &cpus);
+        }
+
+        if (auto const result = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus))
+        {
+            log_warning("Failed to set CPU affinity of %s thread: %s", thread_name.c_str(), strerror(result));
+        }
+    }
+
+    if (!scheduling.cgroup.empty())
+    {
+        auto const error = move_to_cgroup(scheduling.cgroup);
+        if (!error.empty())
+        {
+            log_warning(
+                "Failed to move %s thread to cgroup %s: %s",
+                thread_name.c_str(),
+                scheduling.cgroup.c_str(),
+                error.c_str());
+        }
+    }
+
+    if (scheduling.nice.is_set())
+    {
+        // On Linux, nice values are per thread
+        if (setpriority(PRIO_PROCESS, syscall(SYS_gettid), scheduling.nice.value()) != 0)
+        {
+            log_warning("Failed to set nice value of %s thread: %s", thread_name.c_str(), strerror(errno));
+        }
+    }
+
+    if (scheduling.realtime_priority > 0)
+    {
+        sched_param param{};
+        param.sched_priority = scheduling.realtime_priority;
+
+        auto const result = pthread_setschedparam(pthread_self(), SCHED_FIFO | SCHED_RESET_ON_FORK, &param);
+        if (result == EPERM)
+        {
+            auto const rtkit_error = make_realtime_with_rtkit(scheduling.realtime_priority);
+            if (!rtkit_error.empty())
+            {
+                log_warning(
+                    "Failed to make %s thread realtime, and RealtimeKit could not either: %s",
+                    thread_name.c_str(),
+                    rtkit_error.c_str());
+                return;
+            }
+        }
+        else if (result)
+        {
+            log_warning("Failed to make %s thread realtime: %s", thread_name.c_str(), strerror(result));
+            return;
+        }
+
+        log_info("%s thread is scheduled SCHED_FIFO at priority %d", thread_name.c_str(), scheduling.realtime_priority);
+    }
+}
+
+void mir::apply_thread_scheduling(std::vector<ThreadSchedulingRule> const& rules, std::string const& thread_name)
+{
+    for (auto const& rule : rules)
+    {
+        if (matches(rule.name_pattern, thread_name))
+        {
+            apply_thread_scheduling(rule.scheduling, thread_name);
+            return;
+        }
+    }
+}
+
+void mir::lock_process_memory()
+{
+    // Freed heap would otherwise go back to the system, to be faulted in again when next allocated
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+    {
+        log_warning("Failed to lock the server's memory (is RLIMIT_MEMLOCK too low?): %s", strerror(errno));
+        return;
+    }
+
+    log_info("Server memory is locked");
+}
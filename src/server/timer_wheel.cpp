@@ -0,0 +1,424 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/time/timer_wheel.h"
+#include "mir/time/alarm.h"
+#include "mir/basic_callback.h"
+#include "mir/lockable_callback.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <exception>
+#include <limits>
+#include <list>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace mt = mir::time;
+
+namespace
+{
+using Tick = uint64_t;
+
+auto constexpr tick_length = std::chrono::milliseconds{1};
+unsigned constexpr slot_bits = 6;
+unsigned constexpr slot_count = 1u << slot_bits;
+unsigned constexpr level_count = 4;
+/// Alarms further away than this wait in the last slot of the top level, and are placed again when it is reached
+Tick constexpr wheel_span = Tick{1} << (slot_bits * level_count);
+
+/// The first tick no earlier than time, so that alarms never fire early
+auto tick_at_or_after(mt::Timestamp time) -> Tick
+{
+    auto const since_epoch = time.time_since_epoch();
+    if (since_epoch.count() <= 0)
+        return 0;
+    return (since_epoch + tick_length - mt::Duration{1}) / tick_length;
+}
+
+auto tick_at_or_before(mt::Timestamp time) -> Tick
+{
+    return std::max<int64_t>(0, time.time_since_epoch() / tick_length);
+}
+
+auto rotate_right(uint64_t bits, unsigned by) -> uint64_t
+{
+    return (bits >> by) | (bits << ((64 - by) & 63));
+}
+
+struct Entry
+{
+    explicit Entry(std::unique_ptr<mir::LockableCallback> callback)
+        : callback{std::move(callback)}
+    {
+    }
+
+    std::unique_ptr<mir::LockableCallback> const callback;
+
+    // Guarded by the TimerWheelState mutex...
+    mt::Alarm::State state{mt::Alarm::cancelled};
+    Tick expiry{0};
+    bool in_wheel{false};
+    unsigned level{0};
+    unsigned slot{0};
+    std::list<std::shared_ptr<Entry>>::iterator position;
+    bool destroyed{false};
+    bool firing{false};
+    std::thread::id firing_thread;
+};
+}
+
+class mt::detail::TimerWheelState
+{
+public:
+    TimerWheelState()
+        : timer_fd{timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK)},
+          current{tick_at_or_before(std::chrono::steady_clock::now())}
+    {
+        if (timer_fd == mir::Fd::invalid)
+        {
+            BOOST_THROW_EXCEPTION(std::system_error(errno, std::system_category(), "Failed to create timerfd"));
+        }
+    }
+
+    auto schedule(std::shared_ptr<Entry> const& entry, Timestamp deadline) -> bool
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+
+        auto const was_pending = entry->state == Alarm::pending;
+        if (entry->in_wheel)
+            remove_locked(*entry);
+
+        entry->expiry = tick_at_or_after(deadline);
+        entry->state = Alarm::pending;
+        insert_locked(entry, current + 1);
+        rearm_locked();
+
+        return was_pending;
+    }
+
+    auto cancel(Entry& entry) -> bool
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+
+        if (entry.state == Alarm::pending)
+        {
+            if (entry.in_wheel)
+                remove_locked(entry);
+            entry.state = Alarm::cancelled;
+        }
+        return entry.state == Alarm::cancelled;
+    }
+
+    auto state(Entry const& entry) -> Alarm::State
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        return entry.state;
+    }
+
+    void destroy(Entry& entry)
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+
+        entry.destroyed = true;
+        if (entry.in_wheel)
+            remove_locked(entry);
+
+        // An alarm destroyed from its own callback needn't (and can't) wait for it
+        firing_finished.wait(lock, [&]
+            {
+                return !entry.firing || entry.firing_thread == std::this_thread::get_id();
+            });
+    }
+
+    void dispatch_due()
+    {
+        std::vector<std::shared_ptr<Entry>> due;
+        std::exception_ptr failure;
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            advance_locked(tick_at_or_before(std::chrono::steady_clock::now()), due);
+            rearm_locked();
+        }
+
+        for (auto const& entry : due)
+        {
+            // As with the other AlarmFactory implementations, the callback's lock comes before ours
+            entry->callback->lock();
+
+            bool fire;
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                fire = !entry->destroyed && !entry->in_wheel && entry->state == Alarm::pending;
+                if (fire)
+                {
+                    entry->state = Alarm::triggered;
+                    entry->firing = true;
+                    entry->firing_thread = std::this_thread::get_id();
+                }
+            }
+
+            if (fire)
+            {
+                try
+                {
+                    (*entry->callback)();
+                }
+                catch (...)
+                {
+                    // The other alarms due still fire; the first failure is reported once they have
+                    if (!failure)
+                        failure = std::current_exception();
+                }
+                finish_firing(*entry);
+            }
+
+            entry->callback->unlock();
+        }
+
+        if (failure)
+            std::rethrow_exception(failure);
+    }
+
+    mir::Fd const timer_fd;
+
+private:
+    void finish_firing(Entry& entry)
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            entry.firing = false;
+        }
+        firing_finished.notify_all();
+    }
+
+    /// Places entry in the lowest level that reaches its expiry (or earliest, if that is later)
+    void insert_locked(std::shared_ptr<Entry> const& entry, Tick earliest)
+    {
+        auto const expiry = std::max(entry->expiry, earliest);
+        auto const delta = expiry - current;
+
+        unsigned level = 0;
+        while (level + 1 < level_count && delta >= (Tick{1} << (slot_bits * (level + 1))))
+            ++level;
+
+        auto const slot_expiry = delta < wheel_span ? expiry : current + wheel_span - 1;
+        auto const slot = unsigned(slot_expiry >> (slot_bits * level)) & (slot_count - 1);
+
+        auto& list = slots[level][slot];
+        entry->in_wheel = true;
+        entry->level = level;
+        entry->slot = slot;
+        entry->position = list.insert(list.end(), entry);
+        occupied[level] |= uint64_t{1} << slot;
+        ++entry_count;
+    }
+
+    void remove_locked(Entry& entry)
+    {
+        auto& list = slots[entry.level][entry.slot];
+        list.erase(entry.position);
+        if (list.empty())
+            occupied[entry.level] &= ~(uint64_t{1} << entry.slot);
+        entry.in_wheel = false;
+        --entry_count;
+    }
+
+    /// Takes everything out of a slot (to be placed again, or expired)
+    auto take_slot_locked(unsigned level, unsigned slot) -> std::list<std::shared_ptr<Entry>>
+    {
+        std::list<std::shared_ptr<Entry>> taken;
+        taken.swap(slots[level][slot]);
+        occupied[level] &= ~(uint64_t{1} << slot);
+        entry_count -= taken.size();
+        for (auto const& entry : taken)
+            entry->in_wheel = false;
+        return taken;
+    }
+
+    /// The first tick after the current one at which an occupied slot is reached (at any level)
+    auto next_event_locked() const -> Tick
+    {
+        auto next = std::numeric_limits<Tick>::max();
+        for (unsigned level = 0; level != level_count; ++level)
+        {
+            if (!occupied[level])
+                continue;
+
+            auto const shift = slot_bits * level;
+            auto const base = current >> shift;
+            auto const first = unsigned(base + 1) & (slot_count - 1);
+            auto const steps = __builtin_ctzll(rotate_right(occupied[level], first));
+            next = std::min(next, (base + 1 + steps) << shift);
+        }
+        return next;
+    }
+
+    void advance_locked(Tick to, std::vector<std::shared_ptr<Entry>>& due)
+    {
+        while (current < to)
+        {
+            auto const next = entry_count ? next_event_locked() : std::numeric_limits<Tick>::max();
+            if (next > to)
+            {
+                current = to;
+                break;
+            }
+
+            current = next;
+
+            // Higher levels first, as they may cascade into the lower slots reached at the same tick
+            for (unsigned level = level_count - 1; level != 0; --level)
+            {
+                auto const shift = slot_bits * level;
+                if ((current & ((Tick{1} << shift) - 1)) == 0)
+                {
+                    for (auto const& entry : take_slot_locked(level, unsigned(current >> shift) & (slot_count - 1)))
+                        insert_locked(entry, current);
+                }
+            }
+
+            for (auto const& entry : take_slot_locked(0, unsigned(current) & (slot_count - 1)))
+                due.push_back(entry);
+        }
+    }
+
+    void rearm_locked()
+    {
+        auto const next = entry_count ? next_event_locked() : 0;
+        if (next == armed)
+            return;
+
+        itimerspec spec{};
+        if (next)
+        {
+            std::chrono::nanoseconds const when = next * tick_length;
+            spec.it_value.tv_sec = std::chrono::duration_cast<std::chrono::seconds>(when).count();
+            spec.it_value.tv_nsec = (when % std::chrono::seconds{1}).count();
+        }
+
+        if (timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &spec, nullptr) < 0)
+        {
+            BOOST_THROW_EXCEPTION(std::system_error(errno, std::system_category(), "Failed to arm timerfd"));
+        }
+        armed = next;
+    }
+
+    std::mutex mutex;
+    std::condition_variable firing_finished;
+    Tick current;
+    Tick armed{0};  ///< The tick the timerfd is set for, or 0 if disarmed
+    size_t entry_count{0};
+    std::array<std::array<std::list<std::shared_ptr<Entry>>, slot_count>, level_count> slots;
+    std::array<uint64_t, level_count> occupied{};   ///< A bit for each non-empty slot
+};
+
+namespace
+{
+class AlarmImpl : public mt::Alarm
+{
+public:
+    AlarmImpl(std::shared_ptr<mt::detail::TimerWheelState> const& wheel, std::unique_ptr<mir::LockableCallback> callback)
+        : wheel{wheel},
+          entry{std::make_shared<Entry>(std::move(callback))}
+    {
+    }
+
+    ~AlarmImpl() override
+    {
+        wheel->destroy(*entry);
+    }
+
+    bool cancel() override
+    {
+        return wheel->cancel(*entry);
+    }
+
+    State state() const override
+    {
+        return wheel->state(*entry);
+    }
+
+    bool reschedule_in(std::chrono::milliseconds delay) override
+    {
+        return reschedule_for(std::chrono::steady_clock::now() + delay);
+    }
+
+    bool reschedule_for(mt::Timestamp timeout) override
+    {
+        return wheel->schedule(entry, timeout);
+    }
+
+private:
+    std::shared_ptr<mt::detail::TimerWheelState> const wheel;
+    std::shared_ptr<Entry> const entry;
+};
+}
+
+mt::TimerWheel::TimerWheel()
+    : state{std::make_shared<detail::TimerWheelState>()}
+{
+}
+
+mt::TimerWheel::~TimerWheel() = default;
+
+std::unique_ptr<mt::Alarm> mt::TimerWheel::create_alarm(std::function<void()> const& callback)
+{
+    return create_alarm(std::make_unique<BasicCallback>(callback));
+}
+
+std::unique_ptr<mt::Alarm> mt::TimerWheel::create_alarm(std::unique_ptr<LockableCallback> callback)
+{
+    return std::make_unique<AlarmImpl>(state, std::move(callback));
+}
+
+mir::Fd mt::TimerWheel::watch_fd() const
+{
+    return state->timer_fd;
+}
+
+bool mt::TimerWheel::dispatch(dispatch::FdEvents events)
+{
+    if (events & dispatch::FdEvent::error)
+        return false;
+
+    if (events & dispatch::FdEvent::readable)
+    {
+        uint64_t expirations;
+        // Nonblocking: nothing to read just means someone else got there first
+        if (read(state->timer_fd, &expirations, sizeof expirations) < 0 && errno != EAGAIN)
+        {
+            BOOST_THROW_EXCEPTION(std::system_error(errno, std::system_category(), "Failed to read timerfd"));
+        }
+
+        state->dispatch_due();
+    }
+
+    return true;
+}
+
+mir::dispatch::FdEvents mt::TimerWheel::relevant_events() const
+{
+    return dispatch::FdEvent::readable;
+}
@@ -0,0 +1,293 @@
+/*
+ * AUTOGENERATED - DO NOT EDIT
+ *
+ * This file is generated from commit-timing-v1.xml
+ * To regenerate, run the “refresh-wayland-wrapper” target.
+ */
+
+#include "commit-timing-v1_wrapper.h"
+
+#include <boost/throw_exception.hpp>
+#include <boost/exception/diagnostic_information.hpp>
+
+#include <wayland-server-core.h>
+
+#include "mir/log.h"
+
+namespace mir
+{
+namespace wayland
+{
+extern struct wl_interface const wl_surface_interface_data;
+extern struct wl_interface const wp_commit_timing_manager_v1_interface_data;
+extern struct wl_interface const wp_commit_timer_v1_interface_data;
+}
+}
+
+namespace mw = mir::wayland;
+
+namespace
+{
+struct wl_interface const* all_null_types [] {
+    nullptr,
+    nullptr};
+}
+
+// CommitTimingManagerV1
+
+struct mw::CommitTimingManagerV1::Thunks
+{
+    static int const supported_version;
+
+    static void destroy_thunk(struct wl_client* client, struct wl_resource* resource)
+    {
+        auto me = static_cast<CommitTimingManagerV1*>(wl_resource_get_user_data(resource));
+        try
+        {
+            me->destroy();
+        }
+        catch(ProtocolError const& err)
+        {
+            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
+        }
+        catch(...)
+        {
+            internal_error_processing_request(client, "CommitTimingManagerV1::destroy()");
+        }
+    }
+
+    static void get_timer_thunk(struct wl_client* client, struct wl_resource* resource, uint32_t id, struct wl_resource* surface)
+    {
+        auto me = static_cast<CommitTimingManagerV1*>(wl_resource_get_user_data(resource));
+        wl_resource* id_resolved{
+            wl_resource_create(client, &wp_commit_timer_v1_interface_data, wl_resource_get_version(resource), id)};
+        if (id_resolved == nullptr)
+        {
+            wl_client_post_no_memory(client);
+            BOOST_THROW_EXCEPTION((std::bad_alloc{}));
+        }
+        try
+        {
+            me->get_timer(id_resolved, surface);
+        }
+        catch(ProtocolError const& err)
+        {
+            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
+        }
+        catch(...)
+        {
+            internal_error_processing_request(client, "CommitTimingManagerV1::get_timer()");
+        }
+    }
+
+    static void resource_destroyed_thunk(wl_resource* resource)
+    {
+        delete static_cast<CommitTimingManagerV1*>(wl_resource_get_user_data(resource));
+    }
+
+    static void bind_thunk(struct wl_client* client, void* data, uint32_t version, uint32_t id)
+    {
+        auto me = static_cast<CommitTimingManagerV1::Global*>(data);
+        auto resource = wl_resource_create(
+            client,
+            &wp_commit_timing_manager_v1_interface_data,
+            std::min((int)version, Thunks::supported_version),
+            id);
+        if (resource == nullptr)
+        {
+            wl_client_post_no_memory(client);
+            BOOST_THROW_EXCEPTION((std::bad_alloc{}));
+        }
+        try
+        {
+            me->bind(resource);
+        }
+        catch(...)
+        {
+            internal_error_processing_request(client, "CommitTimingManagerV1 global bind");
+        }
+    }
+
+    static struct wl_interface const* get_timer_types[];
+    static struct wl_message const request_messages[];
+    static void const* request_vtable[];
+};
+
+int const mw::CommitTimingManagerV1::Thunks::supported_version = 1;
+
+mw::CommitTimingManagerV1::CommitTimingManagerV1(struct wl_resource* resource, Version<1>)
+    : client{wl_resource_get_client(resource)},
+      resource{resource}
+{
+    if (resource == nullptr)
+    {
+        BOOST_THROW_EXCEPTION((std::bad_alloc{}));
+    }
+    wl_resource_set_implementation(resource, Thunks::request_vtable, this, &Thunks::resource_destroyed_thunk);
+}
+
+mw::CommitTimingManagerV1::~CommitTimingManagerV1()
+{
+    wl_resource_set_implementation(resource, nullptr, nullptr, nullptr);
+}
+
+bool mw::CommitTimingManagerV1::is_instance(wl_resource* resource)
+{
+    return wl_resource_instance_of(resource, &wp_commit_timing_manager_v1_interface_data, Thunks::request_vtable);
+}
+
+void mw::CommitTimingManagerV1::destroy_wayland_object() const
+{
+    wl_resource_destroy(resource);
+}
+
+mw::CommitTimingManagerV1::Global::Global(wl_display* display, Version<1>)
+    : wayland::Global{
+          wl_global_create(
+              display,
+              &wp_commit_timing_manager_v1_interface_data,
+              Thunks::supported_version,
+              this,
+              &Thunks::bind_thunk)}
+{
+}
+
+auto mw::CommitTimingManagerV1::Global::interface_name() const -> char const*
+{
+    return CommitTimingManagerV1::interface_name;
+}
+
+struct wl_interface const* mw::CommitTimingManagerV1::Thunks::get_timer_types[] {
+    &wp_commit_timer_v1_interface_data,
+    &wl_surface_interface_data};
+
+struct wl_message const mw::CommitTimingManagerV1::Thunks::request_messages[] {
+    {"destroy", "", all_null_types},
+    {"get_timer", "no", get_timer_types}};
+
+void const* mw::CommitTimingManagerV1::Thunks::request_vtable[] {
+    (void*)Thunks::destroy_thunk,
+    (void*)Thunks::get_timer_thunk};
+
+mw::CommitTimingManagerV1* mw::CommitTimingManagerV1::from(struct wl_resource* resource)
+{
+    if (wl_resource_instance_of(resource, &wp_commit_timing_manager_v1_interface_data, CommitTimingManagerV1::Thunks::request_vtable))
+    {
+        return static_cast<CommitTimingManagerV1*>(wl_resource_get_user_data(resource));
+    }
+    return nullptr;
+}
+
+// CommitTimerV1
+
+struct mw::CommitTimerV1::Thunks
+{
+    static int const supported_version;
+
+    static void set_timestamp_thunk(struct wl_client* client, struct wl_resource* resource, uint32_t tv_sec_hi, uint32_t tv_sec_lo, uint32_t tv_nsec)
+    {
+        auto me = static_cast<CommitTimerV1*>(wl_resource_get_user_data(resource));
+        try
+        {
+            me->set_timestamp(tv_sec_hi, tv_sec_lo, tv_nsec);
+        }
+        catch(ProtocolError const& err)
+        {
+            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
+        }
+        catch(...)
+        {
+            internal_error_processing_request(client, "CommitTimerV1::set_timestamp()");
+        }
+    }
+
+    static void destroy_thunk(struct wl_client* client, struct wl_resource* resource)
+    {
+        auto me = static_cast<CommitTimerV1*>(wl_resource_get_user_data(resource));
+        try
+        {
+            me->destroy();
+        }
+        catch(ProtocolError const& err)
+        {
+            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
+        }
+        catch(...)
+        {
+            internal_error_processing_request(client, "CommitTimerV1::destroy()");
+        }
+    }
+
+    static void resource_destroyed_thunk(wl_resource* resource)
+    {
+        delete static_cast<CommitTimerV1*>(wl_resource_get_user_data(resource));
+    }
+
+    static struct wl_message const request_messages[];
+    static void const* request_vtable[];
+};
+
+int const mw::CommitTimerV1::Thunks::supported_version = 1;
+
+mw::CommitTimerV1::CommitTimerV1(struct wl_resource* resource, Version<1>)
+    : client{wl_resource_get_client(resource)},
+      resource{resource}
+{
+    if (resource == nullptr)
+    {
+        BOOST_THROW_EXCEPTION((std::bad_alloc{}));
+    }
+    wl_resource_set_implementation(resource, Thunks::request_vtable, this, &Thunks::resource_destroyed_thunk);
+}
+
+mw::CommitTimerV1::~CommitTimerV1()
+{
+    wl_resource_set_implementation(resource, nullptr, nullptr, nullptr);
+}
+
+bool mw::CommitTimerV1::is_instance(wl_resource* resource)
+{
+    return wl_resource_instance_of(resource, &wp_commit_timer_v1_interface_data, Thunks::request_vtable);
+}
+
+void mw::CommitTimerV1::destroy_wayland_object() const
+{
+    wl_resource_destroy(resource);
+}
+
+struct wl_message const mw::CommitTimerV1::Thunks::request_messages[] {
+    {"set_timestamp", "uuu", all_null_types},
+    {"destroy", "", all_null_types}};
+
+void const* mw::CommitTimerV1::Thunks::request_vtable[] {
+    (void*)Thunks::set_timestamp_thunk,
+    (void*)Thunks::destroy_thunk};
+
+mw::CommitTimerV1* mw::CommitTimerV1::from(struct wl_resource* resource)
+{
+    if (wl_resource_instance_of(resource, &wp_commit_timer_v1_interface_data, CommitTimerV1::Thunks::request_vtable))
+    {
+        return static_cast<CommitTimerV1*>(wl_resource_get_user_data(resource));
+    }
+    return nullptr;
+}
+
+namespace mir
+{
+namespace wayland
+{
+
+struct wl_interface const wp_commit_timing_manager_v1_interface_data {
+    mw::CommitTimingManagerV1::interface_name,
+    mw::CommitTimingManagerV1::Thunks::supported_version,
+    2, mw::CommitTimingManagerV1::Thunks::request_messages,
+    0, nullptr};
+
+struct wl_interface const wp_commit_timer_v1_interface_data {
+    mw::CommitTimerV1::interface_name,
+    mw::CommitTimerV1::Thunks::supported_version,
+    2, mw::CommitTimerV1::Thunks::request_messages,
+    0, nullptr};
+
+}
+}
@@ -0,0 +1,101 @@
+/*
+ * AUTOGENERATED - DO NOT EDIT
+ *
+ * This file is generated from commit-timing-v1.xml
+ * To regenerate, run the “refresh-wayland-wrapper” target.
+ */
+
+#ifndef MIR_FRONTEND_WAYLAND_COMMIT_TIMING_V1_XML_WRAPPER
+#define MIR_FRONTEND_WAYLAND_COMMIT_TIMING_V1_XML_WRAPPER
+
+#include <experimental/optional>
+
+#include "mir/fd.h"
+#include <wayland-server-core.h>
+
+#include "mir/wayland/wayland_base.h"
+
+namespace mir
+{
+namespace wayland
+{
+
+class CommitTimingManagerV1;
+class CommitTimerV1;
+
+class CommitTimingManagerV1 : public Resource
+{
+public:
+    static char const constexpr* interface_name = "wp_commit_timing_manager_v1";
+
+    static CommitTimingManagerV1* from(struct wl_resource*);
+
+    CommitTimingManagerV1(struct wl_resource* resource, Version<1>);
+    virtual ~CommitTimingManagerV1();
+
+    void destroy_wayland_object() const;
+
+    struct wl_client* const client;
+    struct wl_resource* const resource;
+
+    struct Error
+    {
+        static uint32_t const commit_timer_exists = 0;
+    };
+
+    struct Thunks;
+
+    static bool is_instance(wl_resource* resource);
+
+    class Global : public wayland::Global
+    {
+    public:
+        Global(wl_display* display, Version<1>);
+
+        auto interface_name() const -> char const* override;
+
+    private:
+        virtual void bind(wl_resource* new_wp_commit_timing_manager_v1) = 0;
+        friend CommitTimingManagerV1::Thunks;
+    };
+
+private:
+    virtual void destroy() = 0;
+    virtual void get_timer(struct wl_resource* id, struct wl_resource* surface) = 0;
+};
+
+class CommitTimerV1 : public Resource
+{
+public:
+    static char const constexpr* interface_name = "wp_commit_timer_v1";
+
+    static CommitTimerV1* from(struct wl_resource*);
+
+    CommitTimerV1(struct wl_resource* resource, Version<1>);
+    virtual ~CommitTimerV1();
+
+    void destroy_wayland_object() const;
+
+    struct wl_client* const client;
+    struct wl_resource* const resource;
+
+    struct Error
+    {
+        static uint32_t const invalid_timestamp = 0;
+        static uint32_t const timestamp_exists = 1;
+        static uint32_t const surface_destroyed = 2;
+    };
+
+    struct Thunks;
+
+    static bool is_instance(wl_resource* resource);
+
+private:
+    virtual void set_timestamp(uint32_t tv_sec_hi, uint32_t tv_sec_lo, uint32_t tv_nsec) = 0;
+    virtual void destroy() = 0;
+};
+
+}
+}
+
+#endif // MIR_FRONTEND_WAYLAND_COMMIT_TIMING_V1_XML_WRAPPER
@@ -0,0 +1,312 @@
+/*
+ * AUTOGENERATED - DO NOT EDIT
+ *
+ * This file is generated from fifo-v1.xml
+ * To regenerate, run the “refresh-wayland-wrapper” target.
+ */
+
+#include "fifo-v1_wrapper.h"
+
+#include <boost/throw_exception.hpp>
+#include <boost/exception/diagnostic_information.hpp>
+
+#include <wayland-server-core.h>
+
+#include "mir/log.h"
+
+namespace mir
+{
+namespace wayland
+{
+extern struct wl_interface const wl_surface_interface_data;
+extern struct wl_interface const wp_fifo_manager_v1_interface_data;
+extern struct wl_interface const wp_fifo_v1_interface_data;
+}
+}
+
+namespace mw = mir::wayland;
+
+namespace
+{
+struct wl_interface const* all_null_types [] {
+    nullptr,
+    nullptr};
+}
+
+// FifoManagerV1
+
+struct mw::FifoManagerV1::Thunks
+{
+    static int const supported_version;
+
+    static void destroy_thunk(struct wl_client* client, struct wl_resource* resource)
+    {
+        auto me = static_cast<FifoManagerV1*>(wl_resource_get_user_data(resource));
+        try
+        {
+            me->destroy();
+        }
+        catch(ProtocolError const& err)
+        {
+            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
+        }
+        catch(...)
+        {
+            internal_error_processing_request(client, "FifoManagerV1::destroy()");
+        }
+    }
+
+    static void get_fifo_thunk(struct wl_client* client, struct wl_resource* resource, uint32_t id, struct wl_resource* surface)
+    {
+        auto me = static_cast<FifoManagerV1*>(wl_resource_get_user_data(resource));
+        wl_resource* id_resolved{
+            wl_resource_create(client, &wp_fifo_v1_interface_data, wl_resource_get_version(resource), id)};
+        if (id_resolved == nullptr)
+        {
+            wl_client_post_no_memory(client);
+            BOOST_THROW_EXCEPTION((std::bad_alloc{}));
+        }
+        try
+        {
+            me->get_fifo(id_resolved, surface);
+        }
+        catch(ProtocolError const& err)
+        {
+            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
+        }
+        catch(...)
+        {
+            internal_error_processing_request(client, "FifoManagerV1::get_fifo()");
+        }
+    }
+
+    static void resource_destroyed_thunk(wl_resource* resource)
+    {
+        delete static_cast<FifoManagerV1*>(wl_resource_get_user_data(resource));
+    }
+
+    static void bind_thunk(struct wl_client* client, void* data, uint32_t version, uint32_t id)
+    {
+        auto me = static_cast<FifoManagerV1::Global*>(data);
+        auto resource = wl_resource_create(
+            client,
+            &wp_fifo_manager_v1_interface_data,
+            std::min((int)version, Thunks::supported_version),
+            id);
+        if (resource == nullptr)
+        {
+            wl_client_post_no_memory(client);
+            BOOST_THROW_EXCEPTION((std::bad_alloc{}));
+        }
+        try
+        {
+            me->bind(resource);
+        }
+        catch(...)
+        {
+            internal_error_processing_request(client, "FifoManagerV1 global bind");
+        }
+    }
+
+    static struct wl_interface const* get_fifo_types[];
+    static struct wl_message const request_messages[];
+    static void const* request_vtable[];
+};
+
+int const mw::FifoManagerV1::Thunks::supported_version = 1;
+
+mw::FifoManagerV1::FifoManagerV1(struct wl_resource* resource, Version<1>)
+    : client{wl_resource_get_client(resource)},
+      resource{resource}
+{
+    if (resource == nullptr)
+    {
+        BOOST_THROW_EXCEPTION((std::bad_alloc{}));
+    }
+    wl_resource_set_implementation(resource, Thunks::request_vtable, this, &Thunks::resource_destroyed_thunk);
+}
+
+mw::FifoManagerV1::~FifoManagerV1()
+{
+    wl_resource_set_implementation(resource, nullptr, nullptr, nullptr);
+}
+
+bool mw::FifoManagerV1::is_instance(wl_resource* resource)
+{
+    return wl_resource_instance_of(resource, &wp_fifo_manager_v1_interface_data, Thunks::request_vtable);
+}
+
+void mw::FifoManagerV1::destroy_wayland_object() const
+{
+    wl_resource_destroy(resource);
+}
+
+mw::FifoManagerV1::Global::Global(wl_display* display, Version<1>)
+    : wayland::Global{
+          wl_global_create(
+              display,
+              &wp_fifo_manager_v1_interface_data,
+              Thunks::supported_version,
+              this,
+              &Thunks::bind_thunk)}
+{
+}
+
+auto mw::FifoManagerV1::Global::interface_name() const -> char const*
+{
+    return FifoManagerV1::interface_name;
+}
+
+struct wl_interface const* mw::FifoManagerV1::Thunks::get_fifo_types[] {
+    &wp_fifo_v1_interface_data,
+    &wl_surface_interface_data};
+
+struct wl_message const mw::FifoManagerV1::Thunks::request_messages[] {
+    {"destroy", "", all_null_types},
+    {"get_fifo", "no", get_fifo_types}};
+
+void const* mw::FifoManagerV1::Thunks::request_vtable[] {
+    (void*)Thunks::destroy_thunk,
+    (void*)Thunks::get_fifo_thunk};
+
+mw::FifoManagerV1* mw::FifoManagerV1::from(struct wl_resource* resource)
+{
+    if (wl_resource_instance_of(resource, &wp_fifo_manager_v1_interface_data, FifoManagerV1::Thunks::request_vtable))
+    {
+        return static_cast<FifoManagerV1*>(wl_resource_get_user_data(resource));
+    }
+    return nullptr;
+}
+
+// FifoV1
+
+struct mw::FifoV1::Thunks
+{
+    static int const supported_version;
+
+    static void set_barrier_thunk(struct wl_client* client, struct wl_resource* resource)
+    {
+        auto me = static_cast<FifoV1*>(wl_resource_get_user_data(resource));
+        try
+        {
+            me->set_barrier();
+        }
+        catch(ProtocolError const& err)
+        {
+            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
+        }
+        catch(...)
+        {
+            internal_error_processing_request(client, "FifoV1::set_barrier()");
+        }
+    }
+
+    static void wait_barrier_thunk(struct wl_client* client, struct wl_resource* resource)
+    {
+        auto me = static_cast<FifoV1*>(wl_resource_get_user_data(resource));
+        try
+        {
+            me->wait_barrier();
+        }
+        catch(ProtocolError const& err)
+        {
+            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
+        }
+        catch(...)
+        {
+            internal_error_processing_request(client, "FifoV1::wait_barrier()");
+        }
+    }
+
+    static void destroy_thunk(struct wl_client* client, struct wl_resource* resource)
+    {
+        auto me = static_cast<FifoV1*>(wl_resource_get_user_data(resource));
+        try
+        {
+            me->destroy();
+        }
+        catch(ProtocolError const& err)
+        {
+            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
+        }
+        catch(...)
+        {
+            internal_error_processing_request(client, "FifoV1::destroy()");
+        }
+    }
+
+    static void resource_destroyed_thunk(wl_resource* resource)
+    {
+        delete static_cast<FifoV1*>(wl_resource_get_user_data(resource));
+    }
+
+    static struct wl_message const request_messages[];
+    static void const* request_vtable[];
+};
+
+int const mw::FifoV1::Thunks::supported_version = 1;
+
+mw::FifoV1::FifoV1(struct wl_resource* resource, Version<1>)
+    : client{wl_resource_get_client(resource)},
+      resource{resource}
+{
+    if (resource == nullptr)
+    {
+        BOOST_THROW_EXCEPTION((std::bad_alloc{}));
+    }
+    wl_resource_set_implementation(resource, Thunks::request_vtable, this, &Thunks::resource_destroyed_thunk);
+}
+
+mw::FifoV1::~FifoV1()
+{
+    wl_resource_set_implementation(resource, nullptr, nullptr, nullptr);
+}
+
+bool mw::FifoV1::is_instance(wl_resource* resource)
+{
+    return wl_resource_instance_of(resource, &wp_fifo_v1_interface_data, Thunks::request_vtable);
+}
+
+void mw::FifoV1::destroy_wayland_object() const
+{
+    wl_resource_destroy(resource);
+}
+
+struct wl_message const mw::FifoV1::Thunks::request_messages[] {
+    {"set_barrier", "", all_null_types},
+    {"wait_barrier", "", all_null_types},
+    {"destroy", "", all_null_types}};
+
+void const* mw::FifoV1::Thunks::request_vtable[] {
+    (void*)Thunks::set_barrier_thunk,
+    (void*)Thunks::wait_barrier_thunk,
+    (void*)Thunks::destroy_thunk};
+
+mw::FifoV1* mw::FifoV1::from(struct wl_resource* resource)
+{
+    if (wl_resource_instance_of(resource, &wp_fifo_v1_interface_data, FifoV1::Thunks::request_vtable))
+    {
+        return static_cast<FifoV1*>(wl_resource_get_user_data(resource));
+    }
+    return nullptr;
+}
+
+namespace mir
+{
+namespace wayland
+{
+
+struct wl_interface const wp_fifo_manager_v1_interface_data {
+    mw::FifoManagerV1::interface_name,
+    mw::FifoManagerV1::Thunks::supported_version,
+    2, mw::FifoManagerV1::Thunks::request_messages,
+    0, nullptr};
+
+struct wl_interface const wp_fifo_v1_interface_data {
+    mw::FifoV1::interface_name,
+    mw::FifoV1::Thunks::supported_version,
+    3, mw::FifoV1::Thunks::request_messages,
+    0, nullptr};
+
+}
+}
@@ -0,0 +1,100 @@
+/*
+ * AUTOGENERATED - DO NOT EDIT
+ *
+ * This file is generated from fifo-v1.xml
+ * To regenerate, run the “refresh-wayland-wrapper” target.
+ */
+
+#ifndef MIR_FRONTEND_WAYLAND_FIFO_V1_XML_WRAPPER
+#define MIR_FRONTEND_WAYLAND_FIFO_V1_XML_WRAPPER
+
+#include <experimental/optional>
+
+#include "mir/fd.h"
+#include <wayland-server-core.h>
+
+#include "mir/wayland/wayland_base.h"
+
+namespace mir
+{
+namespace wayland
+{
+
+class FifoManagerV1;
+class FifoV1;
+
+class FifoManagerV1 : public Resource
+{
+public:
+    static char const constexpr* interface_name = "wp_fifo_manager_v1";
+
+    static FifoManagerV1* from(struct wl_resource*);
+
+    FifoManagerV1(struct wl_resource* resource, Version<1>);
+    virtual ~FifoManagerV1();
+
+    void destroy_wayland_object() const;
+
+    struct wl_client* const client;
+    struct wl_resource* const resource;
+
+    struct Error
+    {
+        static uint32_t const already_exists = 0;
+    };
+
+    struct Thunks;
+
+    static bool is_instance(wl_resource* resource);
+
+    class Global : public wayland::Global
+    {
+    public:
+        Global(wl_display* display, Version<1>);
+
+        auto interface_name() const -> char const* override;
+
+    private:
+        virtual void bind(wl_resource* new_wp_fifo_manager_v1) = 0;
+        friend FifoManagerV1::Thunks;
+    };
+
+private:
+    virtual void destroy() = 0;
+    virtual void get_fifo(struct wl_resource* id, struct wl_resource* surface) = 0;
+};
+
+class FifoV1 : public Resource
+{
+public:
+    static char const constexpr* interface_name = "wp_fifo_v1";
+
+    static FifoV1* from(struct wl_resource*);
+
+    FifoV1(struct wl_resource* resource, Version<1>);
+    virtual ~FifoV1();
+
+    void destroy_wayland_object() const;
+
+    struct wl_client* const client;
+    struct wl_resource* const resource;
+
+    struct Error
+    {
+        static uint32_t const surface_destroyed = 0;
+    };
+
+    struct Thunks;
+
+    static bool is_instance(wl_resource* resource);
+
+private:
+    virtual void set_barrier() = 0;
+    virtual void wait_barrier() = 0;
+    virtual void destroy() = 0;
+};
+
+}
+}
+
+#endif // MIR_FRONTEND_WAYLAND_FIFO_V1_XML_WRAPPER
@@ -304,12 +304,12 @@ mw::LockedPointerV1::~LockedPointerV1()
 
 void mw::LockedPointerV1::send_locked_event() const
 {
-    wl_resource_post_event(resource, Opcode::locked);
+    wl_resource_post_event_array(resource, Opcode::locked, nullptr);
 }
 
 void mw::LockedPointerV1::send_unlocked_event() const
 {
-    wl_resource_post_event(resource, Opcode::unlocked);
+    wl_resource_post_event_array(resource, Opcode::unlocked, nullptr);
 }
 
 bool mw::LockedPointerV1::is_instance(wl_resource* resource)
@@ -412,12 +412,12 @@ mw::ConfinedPointerV1::~ConfinedPointerV1()
 
 void mw::ConfinedPointerV1::send_confined_event() const
 {
-    wl_resource_post_event(resource, Opcode::confined);
+    wl_resource_post_event_array(resource, Opcode::confined, nullptr);
 }
 
 void mw::ConfinedPointerV1::send_unconfined_event() const
 {
-    wl_resource_post_event(resource, Opcode::unconfined);
+    wl_resource_post_event_array(resource, Opcode::unconfined, nullptr);
 }
 
 bool mw::ConfinedPointerV1::is_instance(wl_resource* resource)
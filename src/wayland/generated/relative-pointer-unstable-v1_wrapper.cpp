@@ -228,7 +228,14 @@ void mw::RelativePointerV1::send_relative_motion_event(uint32_t utime_hi, uint32
     wl_fixed_t dy_resolved{wl_fixed_from_double(dy)};
     wl_fixed_t dx_unaccel_resolved{wl_fixed_from_double(dx_unaccel)};
     wl_fixed_t dy_unaccel_resolved{wl_fixed_from_double(dy_unaccel)};
-    wl_resource_post_event(resource, Opcode::relative_motion, utime_hi, utime_lo, dx_resolved, dy_resolved, dx_unaccel_resolved, dy_unaccel_resolved);
+    wl_argument args[6];
+    args[0].u = utime_hi;
+    args[1].u = utime_lo;
+    args[2].f = dx_resolved;
+    args[3].f = dy_resolved;
+    args[4].f = dx_unaccel_resolved;
+    args[5].f = dy_unaccel_resolved;
+    wl_resource_post_event_array(resource, Opcode::relative_motion, args);
 }
 
 bool mw::RelativePointerV1::is_instance(wl_resource* resource)
@@ -0,0 +1,64 @@
+/*
+ * AUTOGENERATED - DO NOT EDIT
+ *
+ * This file is generated from single-pixel-buffer-v1.xml
+ * To regenerate, run the “refresh-wayland-wrapper” target.
+ */
+
+#ifndef MIR_FRONTEND_WAYLAND_SINGLE_PIXEL_BUFFER_V1_XML_WRAPPER
+#define MIR_FRONTEND_WAYLAND_SINGLE_PIXEL_BUFFER_V1_XML_WRAPPER
+
+#include <experimental/optional>
+
+#include "mir/fd.h"
+#include <wayland-server-core.h>
+
+#include "mir/wayland/wayland_base.h"
+
+namespace mir
+{
+namespace wayland
+{
+
+class SinglePixelBufferManagerV1;
+
+class SinglePixelBufferManagerV1 : public Resource
+{
+public:
+    static char const constexpr* interface_name = "wp_single_pixel_buffer_manager_v1";
+
+    static SinglePixelBufferManagerV1* from(struct wl_resource*);
+
+    SinglePixelBufferManagerV1(struct wl_resource* resource, Version<1>);
+    virtual ~SinglePixelBufferManagerV1();
+
+    void destroy_wayland_object() const;
+
+    struct wl_client* const client;
+    struct wl_resource* const resource;
+
+    struct Thunks;
+
+    static bool is_instance(wl_resource* resource);
+
+    class Global : public wayland::Global
+    {
+    public:
+        Global(wl_display* display, Version<1>);
+
+        auto interface_name() const -> char const* override;
+
+    private:
+        virtual void bind(wl_resource* new_wp_single_pixel_buffer_manager_v1) = 0;
+        friend SinglePixelBufferManagerV1::Thunks;
+    };
+
+private:
+    virtual void destroy() = 0;
+    virtual void create_u32_rgba_buffer(struct wl_resource* id, uint32_t r, uint32_t g, uint32_t b, uint32_t a) = 0;
+};
+
+}
+}
+
+#endif // MIR_FRONTEND_WAYLAND_SINGLE_PIXEL_BUFFER_V1_XML_WRAPPER
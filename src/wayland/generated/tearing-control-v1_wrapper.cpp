@@ -0,0 +1,293 @@
+/*
+ * AUTOGENERATED - DO NOT EDIT
+ *
+ * This file is generated from tearing-control-v1.xml
+ * To regenerate, run the “refresh-wayland-wrapper” target.
+ */
+
+#include "tearing-control-v1_wrapper.h"
+
+#include <boost/throw_exception.hpp>
+#include <boost/exception/diagnostic_information.hpp>
+
+#include <wayland-server-core.h>
+
+#include "mir/log.h"
+
+namespace mir
+{
+namespace wayland
+{
+extern struct wl_interface const wl_surface_interface_data;
+extern struct wl_interface const wp_tearing_control_manager_v1_interface_data;
+extern struct wl_interface const wp_tearing_control_v1_interface_data;
+}
+}
+
+namespace mw = mir::wayland;
+
+namespace
+{
+struct wl_interface const* all_null_types [] {
+    nullptr,
+    nullptr};
+}
+
+// TearingControlManagerV1
+
+struct mw::TearingControlManagerV1::Thunks
+{
+    static int const supported_version;
+
+    static void destroy_thunk(struct wl_client* client, struct wl_resource* resource)
+    {
+        auto me = static_cast<TearingControlManagerV1*>(wl_resource_get_user_data(resource));
+        try
+        {
+            me->destroy();
+        }
+        catch(ProtocolError const& err)
+        {
+            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
+        }
+        catch(...)
+        {
+            internal_error_processing_request(client, "TearingControlManagerV1::destroy()");
+        }
+    }
+
+    static void get_tearing_control_thunk(struct wl_client* client, struct wl_resource* resource, uint32_t id, struct wl_resource* surface)
+    {
+        auto me = static_cast<TearingControlManagerV1*>(wl_resource_get_user_data(resource));
+        wl_resource* id_resolved{
+            wl_resource_create(client, &wp_tearing_control_v1_interface_data, wl_resource_get_version(resource), id)};
+        if (id_resolved == nullptr)
+        {
+            wl_client_post_no_memory(client);
+            BOOST_THROW_EXCEPTION((std::bad_alloc{}));
+        }
+        try
+        {
+            me->get_tearing_control(id_resolved, surface);
+        }
+        catch(ProtocolError const& err)
+        {
+            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
+        }
+        catch(...)
+        {
+            internal_error_processing_request(client, "TearingControlManagerV1::get_tearing_control()");
+        }
+    }
+
+    static void resource_destroyed_thunk(wl_resource* resource)
+    {
+        delete static_cast<TearingControlManagerV1*>(wl_resource_get_user_data(resource));
+    }
+
+    static void bind_thunk(struct wl_client* client, void* data, uint32_t version, uint32_t id)
+    {
+        auto me = static_cast<TearingControlManagerV1::Global*>(data);
+        auto resource = wl_resource_create(
+            client,
+            &wp_tearing_control_manager_v1_interface_data,
+            std::min((int)version, Thunks::supported_version),
+            id);
+        if (resource == nullptr)
+        {
+            wl_client_post_no_memory(client);
+            BOOST_THROW_EXCEPTION((std::bad_alloc{}));
+        }
+        try
+        {
+            me->bind(resource);
+        }
+        catch(...)
+        {
+            internal_error_processing_request(client, "TearingControlManagerV1 global bind");
+        }
+    }
+
+    static struct wl_interface const* get_tearing_control_types[];
+    static struct wl_message const request_messages[];
+    static void const* request_vtable[];
+};
+
+int const mw::TearingControlManagerV1::Thunks::supported_version = 1;
+
+mw::TearingControlManagerV1::TearingControlManagerV1(struct wl_resource* resource, Version<1>)
+    : client{wl_resource_get_client(resource)},
+      resource{resource}
+{
+    if (resource == nullptr)
+    {
+        BOOST_THROW_EXCEPTION((std::bad_alloc{}));
+    }
+    wl_resource_set_implementation(resource, Thunks::request_vtable, this, &Thunks::resource_destroyed_thunk);
+}
+
+mw::TearingControlManagerV1::~TearingControlManagerV1()
+{
+    wl_resource_set_implementation(resource, nullptr, nullptr, nullptr);
+}
+
+bool mw::TearingControlManagerV1::is_instance(wl_resource* resource)
+{
+    return wl_resource_instance_of(resource, &wp_tearing_control_manager_v1_interface_data, Thunks::request_vtable);
+}
+
+void mw::TearingControlManagerV1::destroy_wayland_object() const
+{
+    wl_resource_destroy(resource);
+}
+
+mw::TearingControlManagerV1::Global::Global(wl_display* display, Version<1>)
+    : wayland::Global{
+          wl_global_create(
+              display,
+              &wp_tearing_control_manager_v1_interface_data,
+              Thunks::supported_version,
+              this,
+              &Thunks::bind_thunk)}
+{
+}
+
+auto mw::TearingControlManagerV1::Global::interface_name() const -> char const*
+{
+    return TearingControlManagerV1::interface_name;
+}
+
+struct wl_interface const* mw::TearingControlManagerV1::Thunks::get_tearing_control_types[] {
+    &wp_tearing_control_v1_interface_data,
+    &wl_surface_interface_data};
+
+struct wl_message const mw::TearingControlManagerV1::Thunks::request_messages[] {
+    {"destroy", "", all_null_types},
+    {"get_tearing_control", "no", get_tearing_control_types}};
+
+void const* mw::TearingControlManagerV1::Thunks::request_vtable[] {
+    (void*)Thunks::destroy_thunk,
+    (void*)Thunks::get_tearing_control_thunk};
+
+mw::TearingControlManagerV1* mw::TearingControlManagerV1::from(struct wl_resource* resource)
+{
+    if (wl_resource_instance_of(resource, &wp_tearing_control_manager_v1_interface_data, TearingControlManagerV1::Thunks::request_vtable))
+    {
+        return static_cast<TearingControlManagerV1*>(wl_resource_get_user_data(resource));
+    }
+    return nullptr;
+}
+
+// TearingControlV1
+
+struct mw::TearingControlV1::Thunks
+{
+    static int const supported_version;
+
+    static void set_presentation_hint_thunk(struct wl_client* client, struct wl_resource* resource, uint32_t hint)
+    {
+        auto me = static_cast<TearingControlV1*>(wl_resource_get_user_data(resource));
+        try
+        {
+            me->set_presentation_hint(hint);
+        }
+        catch(ProtocolError const& err)
+        {
+            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
+        }
+        catch(...)
+        {
+            internal_error_processing_request(client, "TearingControlV1::set_presentation_hint()");
+        }
+    }
+
+    static void destroy_thunk(struct wl_client* client, struct wl_resource* resource)
+    {
+        auto me = static_cast<TearingControlV1*>(wl_resource_get_user_data(resource));
+        try
+        {
+            me->destroy();
+        }
+        catch(ProtocolError const& err)
+        {
+            wl_resource_post_error(err.resource(), err.code(), "%s", err.message());
+        }
+        catch(...)
+        {
+            internal_error_processing_request(client, "TearingControlV1::destroy()");
+        }
+    }
+
+    static void resource_destroyed_thunk(wl_resource* resource)
+    {
+        delete static_cast<TearingControlV1*>(wl_resource_get_user_data(resource));
+    }
+
+    static struct wl_message const request_messages[];
+    static void const* request_vtable[];
+};
+
+int const mw::TearingControlV1::Thunks::supported_version = 1;
+
+mw::TearingControlV1::TearingControlV1(struct wl_resource* resource, Version<1>)
+    : client{wl_resource_get_client(resource)},
+      resource{resource}
+{
+    if (resource == nullptr)
+    {
+        BOOST_THROW_EXCEPTION((std::bad_alloc{}));
+    }
+    wl_resource_set_implementation(resource, Thunks::request_vtable, this, &Thunks::resource_destroyed_thunk);
+}
+
+mw::TearingControlV1::~TearingControlV1()
+{
+    wl_resource_set_implementation(resource, nullptr, nullptr, nullptr);
+}
+
+bool mw::TearingControlV1::is_instance(wl_resource* resource)
+{
+    return wl_resource_instance_of(resource, &wp_tearing_control_v1_interface_data, Thunks::request_vtable);
+}
+
+void mw::TearingControlV1::destroy_wayland_object() const
+{
+    wl_resource_destroy(resource);
+}
+
+struct wl_message const mw::TearingControlV1::Thunks::request_messages[] {
+    {"set_presentation_hint", "u", all_null_types},
+    {"destroy", "", all_null_types}};
+
+void const* mw::TearingControlV1::Thunks::request_vtable[] {
+    (void*)Thunks::set_presentation_hint_thunk,
+    (void*)Thunks::destroy_thunk};
+
+mw::TearingControlV1* mw::TearingControlV1::from(struct wl_resource* resource)
+{
+    if (wl_resource_instance_of(resource, &wp_tearing_control_v1_interface_data, TearingControlV1::Thunks::request_vtable))
+    {
+        return static_cast<TearingControlV1*>(wl_resource_get_user_data(resource));
+    }
+    return nullptr;
+}
+
+namespace mir
+{
+namespace wayland
+{
+
+struct wl_interface const wp_tearing_control_manager_v1_interface_data {
+    mw::TearingControlManagerV1::interface_name,
+    mw::TearingControlManagerV1::Thunks::supported_version,
+    2, mw::TearingControlManagerV1::Thunks::request_messages,
+    0, nullptr};
+
+struct wl_interface const wp_tearing_control_v1_interface_data {
+    mw::TearingControlV1::interface_name,
+    mw::TearingControlV1::Thunks::supported_version,
+    2, mw::TearingControlV1::Thunks::request_messages,
+    0, nullptr};
+
+}
+}
@@ -81,7 +81,9 @@ mw::Callback::~Callback()
 
 void mw::Callback::send_done_event(uint32_t callback_data) const
 {
-    wl_resource_post_event(resource, Opcode::done, callback_data);
+    wl_argument args[1];
+    args[0].u = callback_data;
+    wl_resource_post_event_array(resource, Opcode::done, args);
 }
 
 void mw::Callback::destroy_wayland_object() const
@@ -467,7 +469,9 @@ mw::Shm::~Shm()
 
 void mw::Shm::send_format_event(uint32_t format) const
 {
-    wl_resource_post_event(resource, Opcode::format, format);
+    wl_argument args[1];
+    args[0].u = format;
+    wl_resource_post_event_array(resource, Opcode::format, args);
 }
 
 bool mw::Shm::is_instance(wl_resource* resource)
@@ -572,7 +576,7 @@ mw::Buffer::~Buffer()
 
 void mw::Buffer::send_release_event() const
 {
-    wl_resource_post_event(resource, Opcode::release);
+    wl_resource_post_event_array(resource, Opcode::release, nullptr);
 }
 
 bool mw::Buffer::is_instance(wl_resource* resource)
@@ -731,7 +735,9 @@ mw::DataOffer::~DataOffer()
 void mw::DataOffer::send_offer_event(std::string const& mime_type) const
 {
     const char* mime_type_resolved = mime_type.c_str();
-    wl_resource_post_event(resource, Opcode::offer, mime_type_resolved);
+    wl_argument args[1];
+    args[0].s = mime_type_resolved;
+    wl_resource_post_event_array(resource, Opcode::offer, args);
 }
 
 bool mw::DataOffer::version_supports_source_actions()
@@ -741,7 +747,9 @@ bool mw::DataOffer::version_supports_source_actions()
 
 void mw::DataOffer::send_source_actions_event(uint32_t source_actions) const
 {
-    wl_resource_post_event(resource, Opcode::source_actions, source_actions);
+    wl_argument args[1];
+    args[0].u = source_actions;
+    wl_resource_post_event_array(resource, Opcode::source_actions, args);
 }
 
 bool mw::DataOffer::version_supports_action()
@@ -751,7 +759,9 @@ bool mw::DataOffer::version_supports_action()
 
 void mw::DataOffer::send_action_event(uint32_t dnd_action) const
 {
-    wl_resource_post_event(resource, Opcode::action, dnd_action);
+    wl_argument args[1];
+    args[0].u = dnd_action;
+    wl_resource_post_event_array(resource, Opcode::action, args);
 }
 
 bool mw::DataOffer::is_instance(wl_resource* resource)
@@ -884,19 +894,24 @@ void mw::DataSource::send_target_event(std::experimental::optional<std::string>
     {
         mime_type_resolved = mime_type.value().c_str();
     }
-    wl_resource_post_event(resource, Opcode::target, mime_type_resolved);
+    wl_argument args[1];
+    args[0].s = mime_type_resolved;
+    wl_resource_post_event_array(resource, Opcode::target, args);
 }
 
 void mw::DataSource::send_send_event(std::string const& mime_type, mir::Fd fd) const
 {
     const char* mime_type_resolved = mime_type.c_str();
     int32_t fd_resolved{fd};
-    wl_resource_post_event(resource, Opcode::send, mime_type_resolved, fd_resolved);
+    wl_argument args[2];
+    args[0].s = mime_type_resolved;
+    args[1].h = fd_resolved;
+    wl_resource_post_event_array(resource, Opcode::send, args);
 }
 
 void mw::DataSource::send_cancelled_event() const
 {
-    wl_resource_post_event(resource, Opcode::cancelled);
+    wl_resource_post_event_array(resource, Opcode::cancelled, nullptr);
 }
 
 bool mw::DataSource::version_supports_dnd_drop_performed()
@@ -906,7 +921,7 @@ bool mw::DataSource::version_supports_dnd_drop_performed()
 
 void mw::DataSource::send_dnd_drop_performed_event() const
 {
-    wl_resource_post_event(resource, Opcode::dnd_drop_performed);
+    wl_resource_post_event_array(resource, Opcode::dnd_drop_performed, nullptr);
 }
 
 bool mw::DataSource::version_supports_dnd_finished()
@@ -916,7 +931,7 @@ bool mw::DataSource::version_supports_dnd_finished()
 
 void mw::DataSource::send_dnd_finished_event() const
 {
-    wl_resource_post_event(resource, Opcode::dnd_finished);
+    wl_resource_post_event_array(resource, Opcode::dnd_finished, nullptr);
 }
 
 bool mw::DataSource::version_supports_action()
@@ -926,7 +941,9 @@ bool mw::DataSource::version_supports_action()
 
 void mw::DataSource::send_action_event(uint32_t dnd_action) const
 {
-    wl_resource_post_event(resource, Opcode::action, dnd_action);
+    wl_argument args[1];
+    args[0].u = dnd_action;
+    wl_resource_post_event_array(resource, Opcode::action, args);
 }
 
 bool mw::DataSource::is_instance(wl_resource* resource)
@@ -1073,7 +1090,9 @@ mw::DataDevice::~DataDevice()
 
 void mw::DataDevice::send_data_offer_event(struct wl_resource* id) const
 {
-    wl_resource_post_event(resource, Opcode::data_offer, id);
+    wl_argument args[1];
+    args[0].o = reinterpret_cast<struct wl_object*>(id);
+    wl_resource_post_event_array(resource, Opcode::data_offer, args);
 }
 
 void mw::DataDevice::send_enter_event(uint32_t serial, struct wl_resource* surface, double x, double y, std::experimental::optional<struct wl_resource*> const& id) const
@@ -1085,24 +1104,34 @@ void mw::DataDevice::send_enter_event(uint32_t serial, struct wl_resource* surfa
     {
         id_resolved = id.value();
     }
-    wl_resource_post_event(resource, Opcode::enter, serial, surface, x_resolved, y_resolved, id_resolved);
+    wl_argument args[5];
+    args[0].u = serial;
+    args[1].o = reinterpret_cast<struct wl_object*>(surface);
+    args[2].f = x_resolved;
+    args[3].f = y_resolved;
+    args[4].o = reinterpret_cast<struct wl_object*>(id_resolved);
+    wl_resource_post_event_array(resource, Opcode::enter, args);
 }
 
 void mw::DataDevice::send_leave_event() const
 {
-    wl_resource_post_event(resource, Opcode::leave);
+    wl_resource_post_event_array(resource, Opcode::leave, nullptr);
 }
 
 void mw::DataDevice::send_motion_event(uint32_t time, double x, double y) const
 {
     wl_fixed_t x_resolved{wl_fixed_from_double(x)};
     wl_fixed_t y_resolved{wl_fixed_from_double(y)};
-    wl_resource_post_event(resource, Opcode::motion, time, x_resolved, y_resolved);
+    wl_argument args[3];
+    args[0].u = time;
+    args[1].f = x_resolved;
+    args[2].f = y_resolved;
+    wl_resource_post_event_array(resource, Opcode::motion, args);
 }
 
 void mw::DataDevice::send_drop_event() const
 {
-    wl_resource_post_event(resource, Opcode::drop);
+    wl_resource_post_event_array(resource, Opcode::drop, nullptr);
 }
 
 void mw::DataDevice::send_selection_event(std::experimental::optional<struct wl_resource*> const& id) const
@@ -1112,7 +1141,9 @@ void mw::DataDevice::send_selection_event(std::experimental::optional<struct wl_
     {
         id_resolved = id.value();
     }
-    wl_resource_post_event(resource, Opcode::selection, id_resolved);
+    wl_argument args[1];
+    args[0].o = reinterpret_cast<struct wl_object*>(id_resolved);
+    wl_resource_post_event_array(resource, Opcode::selection, args);
 }
 
 bool mw::DataDevice::is_instance(wl_resource* resource)
@@ -1679,17 +1710,23 @@ mw::ShellSurface::~ShellSurface()
 
 void mw::ShellSurface::send_ping_event(uint32_t serial) const
 {
-    wl_resource_post_event(resource, Opcode::ping, serial);
+    wl_argument args[1];
+    args[0].u = serial;
+    wl_resource_post_event_array(resource, Opcode::ping, args);
 }
 
 void mw::ShellSurface::send_configure_event(uint32_t edges, int32_t width, int32_t height) const
 {
-    wl_resource_post_event(resource, Opcode::configure, edges, width, height);
+    wl_argument args[3];
+    args[0].u = edges;
+    args[1].i = width;
+    args[2].i = height;
+    wl_resource_post_event_array(resource, Opcode::configure, args);
 }
 
 void mw::ShellSurface::send_popup_done_event() const
 {
-    wl_resource_post_event(resource, Opcode::popup_done);
+    wl_resource_post_event_array(resource, Opcode::popup_done, nullptr);
 }
 
 bool mw::ShellSurface::is_instance(wl_resource* resource)
@@ -2005,12 +2042,16 @@ mw::Surface::~Surface()
 
 void mw::Surface::send_enter_event(struct wl_resource* output) const
 {
-    wl_resource_post_event(resource, Opcode::enter, output);
+    wl_argument args[1];
+    args[0].o = reinterpret_cast<struct wl_object*>(output);
+    wl_resource_post_event_array(resource, Opcode::enter, args);
 }
 
 void mw::Surface::send_leave_event(struct wl_resource* output) const
 {
-    wl_resource_post_event(resource, Opcode::leave, output);
+    wl_argument args[1];
+    args[0].o = reinterpret_cast<struct wl_object*>(output);
+    wl_resource_post_event_array(resource, Opcode::leave, args);
 }
 
 bool mw::Surface::is_instance(wl_resource* resource)
@@ -2231,7 +2272,9 @@ mw::Seat::~Seat()
 
 void mw::Seat::send_capabilities_event(uint32_t capabilities) const
 {
-    wl_resource_post_event(resource, Opcode::capabilities, capabilities);
+    wl_argument args[1];
+    args[0].u = capabilities;
+    wl_resource_post_event_array(resource, Opcode::capabilities, args);
 }
 
 bool mw::Seat::version_supports_name()
@@ -2242,7 +2285,9 @@ bool mw::Seat::version_supports_name()
 void mw::Seat::send_name_event(std::string const& name) const
 {
     const char* name_resolved = name.c_str();
-    wl_resource_post_event(resource, Opcode::name, name_resolved);
+    wl_argument args[1];
+    args[0].s = name_resolved;
+    wl_resource_post_event_array(resource, Opcode::name, args);
 }
 
 bool mw::Seat::is_instance(wl_resource* resource)
@@ -2385,30 +2430,51 @@ void mw::Pointer::send_enter_event(uint32_t serial, struct wl_resource* surface,
 {
     wl_fixed_t surface_x_resolved{wl_fixed_from_double(surface_x)};
     wl_fixed_t surface_y_resolved{wl_fixed_from_double(surface_y)};
-    wl_resource_post_event(resource, Opcode::enter, serial, surface, surface_x_resolved, surface_y_resolved);
+    wl_argument args[4];
+    args[0].u = serial;
+    args[1].o = reinterpret_cast<struct wl_object*>(surface);
+    args[2].f = surface_x_resolved;
+    args[3].f = surface_y_resolved;
+    wl_resource_post_event_array(resource, Opcode::enter, args);
 }
 
 void mw::Pointer::send_leave_event(uint32_t serial, struct wl_resource* surface) const
 {
-    wl_resource_post_event(resource, Opcode::leave, serial, surface);
+    wl_argument args[2];
+    args[0].u = serial;
+    args[1].o = reinterpret_cast<struct wl_object*>(surface);
+    wl_resource_post_event_array(resource, Opcode::leave, args);
 }
 
 void mw::Pointer::send_motion_event(uint32_t time, double surface_x, double surface_y) const
 {
     wl_fixed_t surface_x_resolved{wl_fixed_from_double(surface_x)};
     wl_fixed_t surface_y_resolved{wl_fixed_from_double(surface_y)};
-    wl_resource_post_event(resource, Opcode::motion, time, surface_x_resolved, surface_y_resolved);
+    wl_argument args[3];
+    args[0].u = time;
+    args[1].f = surface_x_resolved;
+    args[2].f = surface_y_resolved;
+    wl_resource_post_event_array(resource, Opcode::motion, args);
 }
 
 void mw::Pointer::send_button_event(uint32_t serial, uint32_t time, uint32_t button, uint32_t state) const
 {
-    wl_resource_post_event(resource, Opcode::button, serial, time, button, state);
+    wl_argument args[4];
+    args[0].u = serial;
+    args[1].u = time;
+    args[2].u = button;
+    args[3].u = state;
+    wl_resource_post_event_array(resource, Opcode::button, args);
 }
 
 void mw::Pointer::send_axis_event(uint32_t time, uint32_t axis, double value) const
 {
     wl_fixed_t value_resolved{wl_fixed_from_double(value)};
-    wl_resource_post_event(resource, Opcode::axis, time, axis, value_resolved);
+    wl_argument args[3];
+    args[0].u = time;
+    args[1].u = axis;
+    args[2].f = value_resolved;
+    wl_resource_post_event_array(resource, Opcode::axis, args);
 }
 
 bool mw::Pointer::version_supports_frame()
@@ -2418,7 +2484,7 @@ bool mw::Pointer::version_supports_frame()
 
 void mw::Pointer::send_frame_event() const
 {
-    wl_resource_post_event(resource, Opcode::frame);
+    wl_resource_post_event_array(resource, Opcode::frame, nullptr);
 }
 
 bool mw::Pointer::version_supports_axis_source()
@@ -2428,7 +2494,9 @@ bool mw::Pointer::version_supports_axis_source()
 
 void mw::Pointer::send_axis_source_event(uint32_t axis_source) const
 {
-    wl_resource_post_event(resource, Opcode::axis_source, axis_source);
+    wl_argument args[1];
+    args[0].u = axis_source;
+    wl_resource_post_event_array(resource, Opcode::axis_source, args);
 }
 
 bool mw::Pointer::version_supports_axis_stop()
@@ -2438,7 +2506,10 @@ bool mw::Pointer::version_supports_axis_stop()
 
 void mw::Pointer::send_axis_stop_event(uint32_t time, uint32_t axis) const
 {
-    wl_resource_post_event(resource, Opcode::axis_stop, time, axis);
+    wl_argument args[2];
+    args[0].u = time;
+    args[1].u = axis;
+    wl_resource_post_event_array(resource, Opcode::axis_stop, args);
 }
 
 bool mw::Pointer::version_supports_axis_discrete()
@@ -2448,7 +2519,10 @@ bool mw::Pointer::version_supports_axis_discrete()
 
 void mw::Pointer::send_axis_discrete_event(uint32_t axis, int32_t discrete) const
 {
-    wl_resource_post_event(resource, Opcode::axis_discrete, axis, discrete);
+    wl_argument args[2];
+    args[0].u = axis;
+    args[1].i = discrete;
+    wl_resource_post_event_array(resource, Opcode::axis_discrete, args);
 }
 
 bool mw::Pointer::is_instance(wl_resource* resource)
@@ -2561,27 +2635,49 @@ mw::Keyboard::~Keyboard()
 void mw::Keyboard::send_keymap_event(uint32_t format, mir::Fd fd, uint32_t size) const
 {
     int32_t fd_resolved{fd};
-    wl_resource_post_event(resource, Opcode::keymap, format, fd_resolved, size);
+    wl_argument args[3];
+    args[0].u = format;
+    args[1].h = fd_resolved;
+    args[2].u = size;
+    wl_resource_post_event_array(resource, Opcode::keymap, args);
 }
 
 void mw::Keyboard::send_enter_event(uint32_t serial, struct wl_resource* surface, struct wl_array* keys) const
 {
-    wl_resource_post_event(resource, Opcode::enter, serial, surface, keys);
+    wl_argument args[3];
+    args[0].u = serial;
+    args[1].o = reinterpret_cast<struct wl_object*>(surface);
+    args[2].a = keys;
+    wl_resource_post_event_array(resource, Opcode::enter, args);
 }
 
 void mw::Keyboard::send_leave_event(uint32_t serial, struct wl_resource* surface) const
 {
-    wl_resource_post_event(resource, Opcode::leave, serial, surface);
+    wl_argument args[2];
+    args[0].u = serial;
+    args[1].o = reinterpret_cast<struct wl_object*>(surface);
+    wl_resource_post_event_array(resource, Opcode::leave, args);
 }
 
 void mw::Keyboard::send_key_event(uint32_t serial, uint32_t time, uint32_t key, uint32_t state) const
 {
-    wl_resource_post_event(resource, Opcode::key, serial, time, key, state);
+    wl_argument args[4];
+    args[0].u = serial;
+    args[1].u = time;
+    args[2].u = key;
+    args[3].u = state;
+    wl_resource_post_event_array(resource, Opcode::key, args);
 }
 
 void mw::Keyboard::send_modifiers_event(uint32_t serial, uint32_t mods_depressed, uint32_t mods_latched, uint32_t mods_locked, uint32_t group) const
 {
-    wl_resource_post_event(resource, Opcode::modifiers, serial, mods_depressed, mods_latched, mods_locked, group);
+    wl_argument args[5];
+    args[0].u = serial;
+    args[1].u = mods_depressed;
+    args[2].u = mods_latched;
+    args[3].u = mods_locked;
+    args[4].u = group;
+    wl_resource_post_event_array(resource, Opcode::modifiers, args);
 }
 
 bool mw::Keyboard::version_supports_repeat_info()
@@ -2591,7 +2687,10 @@ bool mw::Keyboard::version_supports_repeat_info()
 
 void mw::Keyboard::send_repeat_info_event(int32_t rate, int32_t delay) const
 {
-    wl_resource_post_event(resource, Opcode::repeat_info, rate, delay);
+    wl_argument args[2];
+    args[0].i = rate;
+    args[1].i = delay;
+    wl_resource_post_event_array(resource, Opcode::repeat_info, args);
 }
 
 bool mw::Keyboard::is_instance(wl_resource* resource)
@@ -2692,29 +2791,45 @@ void mw::Touch::send_down_event(uint32_t serial, uint32_t time, struct wl_resour
 {
     wl_fixed_t x_resolved{wl_fixed_from_double(x)};
     wl_fixed_t y_resolved{wl_fixed_from_double(y)};
-    wl_resource_post_event(resource, Opcode::down, serial, time, surface, id, x_resolved, y_resolved);
+    wl_argument args[6];
+    args[0].u = serial;
+    args[1].u = time;
+    args[2].o = reinterpret_cast<struct wl_object*>(surface);
+    args[3].i = id;
+    args[4].f = x_resolved;
+    args[5].f = y_resolved;
+    wl_resource_post_event_array(resource, Opcode::down, args);
 }
 
 void mw::Touch::send_up_event(uint32_t serial, uint32_t time, int32_t id) const
 {
-    wl_resource_post_event(resource, Opcode::up, serial, time, id);
+    wl_argument args[3];
+    args[0].u = serial;
+    args[1].u = time;
+    args[2].i = id;
+    wl_resource_post_event_array(resource, Opcode::up, args);
 }
 
 void mw::Touch::send_motion_event(uint32_t time, int32_t id, double x, double y) const
 {
     wl_fixed_t x_resolved{wl_fixed_from_double(x)};
     wl_fixed_t y_resolved{wl_fixed_from_double(y)};
-    wl_resource_post_event(resource, Opcode::motion, time, id, x_resolved, y_resolved);
+    wl_argument args[4];
+    args[0].u = time;
+    args[1].i = id;
+    args[2].f = x_resolved;
+    args[3].f = y_resolved;
+    wl_resource_post_event_array(resource, Opcode::motion, args);
 }
 
 void mw::Touch::send_frame_event() const
 {
-    wl_resource_post_event(resource, Opcode::frame);
+    wl_resource_post_event_array(resource, Opcode::frame, nullptr);
 }
 
 void mw::Touch::send_cancel_event() const
 {
-    wl_resource_post_event(resource, Opcode::cancel);
+    wl_resource_post_event_array(resource, Opcode::cancel, nullptr);
 }
 
 bool mw::Touch::version_supports_shape()
@@ -2726,7 +2841,11 @@ void mw::Touch::send_shape_event(int32_t id, double major, double minor) const
 {
     wl_fixed_t major_resolved{wl_fixed_from_double(major)};
     wl_fixed_t minor_resolved{wl_fixed_from_double(minor)};
-    wl_resource_post_event(resource, Opcode::shape, id, major_resolved, minor_resolved);
+    wl_argument args[3];
+    args[0].i = id;
+    args[1].f = major_resolved;
+    args[2].f = minor_resolved;
+    wl_resource_post_event_array(resource, Opcode::shape, args);
 }
 
 bool mw::Touch::version_supports_orientation()
@@ -2737,7 +2856,10 @@ bool mw::Touch::version_supports_orientation()
 void mw::Touch::send_orientation_event(int32_t id, double orientation) const
 {
     wl_fixed_t orientation_resolved{wl_fixed_from_double(orientation)};
-    wl_resource_post_event(resource, Opcode::orientation, id, orientation_resolved);
+    wl_argument args[2];
+    args[0].i = id;
+    args[1].f = orientation_resolved;
+    wl_resource_post_event_array(resource, Opcode::orientation, args);
 }
 
 bool mw::Touch::is_instance(wl_resource* resource)
@@ -2861,12 +2983,26 @@ void mw::Output::send_geometry_event(int32_t x, int32_t y, int32_t physical_widt
 {
     const char* make_resolved = make.c_str();
     const char* model_resolved = model.c_str();
-    wl_resource_post_event(resource, Opcode::geometry, x, y, physical_width, physical_height, subpixel, make_resolved, model_resolved, transform);
+    wl_argument args[8];
+    args[0].i = x;
+    args[1].i = y;
+    args[2].i = physical_width;
+    args[3].i = physical_height;
+    args[4].i = subpixel;
+    args[5].s = make_resolved;
+    args[6].s = model_resolved;
+    args[7].i = transform;
+    wl_resource_post_event_array(resource, Opcode::geometry, args);
 }
 
 void mw::Output::send_mode_event(uint32_t flags, int32_t width, int32_t height, int32_t refresh) const
 {
-    wl_resource_post_event(resource, Opcode::mode, flags, width, height, refresh);
+    wl_argument args[4];
+    args[0].u = flags;
+    args[1].i = width;
+    args[2].i = height;
+    args[3].i = refresh;
+    wl_resource_post_event_array(resource, Opcode::mode, args);
 }
 
 bool mw::Output::version_supports_done()
@@ -2876,7 +3012,7 @@ bool mw::Output::version_supports_done()
 
 void mw::Output::send_done_event() const
 {
-    wl_resource_post_event(resource, Opcode::done);
+    wl_resource_post_event_array(resource, Opcode::done, nullptr);
 }
 
 bool mw::Output::version_supports_scale()
@@ -2886,7 +3022,9 @@ bool mw::Output::version_supports_scale()
 
 void mw::Output::send_scale_event(int32_t factor) const
 {
-    wl_resource_post_event(resource, Opcode::scale, factor);
+    wl_argument args[1];
+    args[0].i = factor;
+    wl_resource_post_event_array(resource, Opcode::scale, args);
 }
 
 bool mw::Output::is_instance(wl_resource* resource)
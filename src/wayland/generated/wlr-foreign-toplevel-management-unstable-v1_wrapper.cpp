@@ -116,12 +116,14 @@ mw::ForeignToplevelManagerV1::~ForeignToplevelManagerV1()
 
 void mw::ForeignToplevelManagerV1::send_toplevel_event(struct wl_resource* toplevel) const
 {
-    wl_resource_post_event(resource, Opcode::toplevel, toplevel);
+    wl_argument args[1];
+    args[0].o = reinterpret_cast<struct wl_object*>(toplevel);
+    wl_resource_post_event_array(resource, Opcode::toplevel, args);
 }
 
 void mw::ForeignToplevelManagerV1::send_finished_event() const
 {
-    wl_resource_post_event(resource, Opcode::finished);
+    wl_resource_post_event_array(resource, Opcode::finished, nullptr);
 }
 
 bool mw::ForeignToplevelManagerV1::is_instance(wl_resource* resource)
@@ -389,38 +391,48 @@ mw::ForeignToplevelHandleV1::~ForeignToplevelHandleV1()
 void mw::ForeignToplevelHandleV1::send_title_event(std::string const& title) const
 {
     const char* title_resolved = title.c_str();
-    wl_resource_post_event(resource, Opcode::title, title_resolved);
+    wl_argument args[1];
+    args[0].s = title_resolved;
+    wl_resource_post_event_array(resource, Opcode::title, args);
 }
 
 void mw::ForeignToplevelHandleV1::send_app_id_event(std::string const& app_id) const
 {
     const char* app_id_resolved = app_id.c_str();
-    wl_resource_post_event(resource, Opcode::app_id, app_id_resolved);
+    wl_argument args[1];
+    args[0].s = app_id_resolved;
+    wl_resource_post_event_array(resource, Opcode::app_id, args);
 }
 
 void mw::ForeignToplevelHandleV1::send_output_enter_event(struct wl_resource* output) const
 {
-    wl_resource_post_event(resource, Opcode::output_enter, output);
+    wl_argument args[1];
+    args[0].o = reinterpret_cast<struct wl_object*>(output);
+    wl_resource_post_event_array(resource, Opcode::output_enter, args);
 }
 
 void mw::ForeignToplevelHandleV1::send_output_leave_event(struct wl_resource* output) const
 {
-    wl_resource_post_event(resource, Opcode::output_leave, output);
+    wl_argument args[1];
+    args[0].o = reinterpret_cast<struct wl_object*>(output);
+    wl_resource_post_event_array(resource, Opcode::output_leave, args);
 }
 
 void mw::ForeignToplevelHandleV1::send_state_event(struct wl_array* state) const
 {
-    wl_resource_post_event(resource, Opcode::state, state);
+    wl_argument args[1];
+    args[0].a = state;
+    wl_resource_post_event_array(resource, Opcode::state, args);
 }
 
 void mw::ForeignToplevelHandleV1::send_done_event() const
 {
-    wl_resource_post_event(resource, Opcode::done);
+    wl_resource_post_event_array(resource, Opcode::done, nullptr);
 }
 
 void mw::ForeignToplevelHandleV1::send_closed_event() const
 {
-    wl_resource_post_event(resource, Opcode::closed);
+    wl_resource_post_event_array(resource, Opcode::closed, nullptr);
 }
 
 bool mw::ForeignToplevelHandleV1::is_instance(wl_resource* resource)
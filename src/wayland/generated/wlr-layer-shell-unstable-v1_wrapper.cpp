@@ -382,12 +382,16 @@ mw::LayerSurfaceV1::~LayerSurfaceV1()
 
 void mw::LayerSurfaceV1::send_configure_event(uint32_t serial, uint32_t width, uint32_t height) const
 {
-    wl_resource_post_event(resource, Opcode::configure, serial, width, height);
+    wl_argument args[3];
+    args[0].u = serial;
+    args[1].u = width;
+    args[2].u = height;
+    wl_resource_post_event_array(resource, Opcode::configure, args);
 }
 
 void mw::LayerSurfaceV1::send_closed_event() const
 {
-    wl_resource_post_event(resource, Opcode::closed);
+    wl_resource_post_event_array(resource, Opcode::closed, nullptr);
 }
 
 bool mw::LayerSurfaceV1::is_instance(wl_resource* resource)
@@ -235,17 +235,23 @@ mw::XdgOutputV1::~XdgOutputV1()
 
 void mw::XdgOutputV1::send_logical_position_event(int32_t x, int32_t y) const
 {
-    wl_resource_post_event(resource, Opcode::logical_position, x, y);
+    wl_argument args[2];
+    args[0].i = x;
+    args[1].i = y;
+    wl_resource_post_event_array(resource, Opcode::logical_position, args);
 }
 
 void mw::XdgOutputV1::send_logical_size_event(int32_t width, int32_t height) const
 {
-    wl_resource_post_event(resource, Opcode::logical_size, width, height);
+    wl_argument args[2];
+    args[0].i = width;
+    args[1].i = height;
+    wl_resource_post_event_array(resource, Opcode::logical_size, args);
 }
 
 void mw::XdgOutputV1::send_done_event() const
 {
-    wl_resource_post_event(resource, Opcode::done);
+    wl_resource_post_event_array(resource, Opcode::done, nullptr);
 }
 
 bool mw::XdgOutputV1::version_supports_name()
@@ -256,7 +262,9 @@ bool mw::XdgOutputV1::version_supports_name()
 void mw::XdgOutputV1::send_name_event(std::string const& name) const
 {
     const char* name_resolved = name.c_str();
-    wl_resource_post_event(resource, Opcode::name, name_resolved);
+    wl_argument args[1];
+    args[0].s = name_resolved;
+    wl_resource_post_event_array(resource, Opcode::name, args);
 }
 
 bool mw::XdgOutputV1::version_supports_description()
@@ -267,7 +275,9 @@ bool mw::XdgOutputV1::version_supports_description()
 void mw::XdgOutputV1::send_description_event(std::string const& description) const
 {
     const char* description_resolved = description.c_str();
-    wl_resource_post_event(resource, Opcode::description, description_resolved);
+    wl_argument args[1];
+    args[0].s = description_resolved;
+    wl_resource_post_event_array(resource, Opcode::description, args);
 }
 
 bool mw::XdgOutputV1::is_instance(wl_resource* resource)
@@ -185,7 +185,9 @@ mw::XdgShellV6::~XdgShellV6()
 
 void mw::XdgShellV6::send_ping_event(uint32_t serial) const
 {
-    wl_resource_post_event(resource, Opcode::ping, serial);
+    wl_argument args[1];
+    args[0].u = serial;
+    wl_resource_post_event_array(resource, Opcode::ping, args);
 }
 
 bool mw::XdgShellV6::is_instance(wl_resource* resource)
@@ -571,7 +573,9 @@ mw::XdgSurfaceV6::~XdgSurfaceV6()
 
 void mw::XdgSurfaceV6::send_configure_event(uint32_t serial) const
 {
-    wl_resource_post_event(resource, Opcode::configure, serial);
+    wl_argument args[1];
+    args[0].u = serial;
+    wl_resource_post_event_array(resource, Opcode::configure, args);
 }
 
 bool mw::XdgSurfaceV6::is_instance(wl_resource* resource)
@@ -907,12 +911,16 @@ mw::XdgToplevelV6::~XdgToplevelV6()
 
 void mw::XdgToplevelV6::send_configure_event(int32_t width, int32_t height, struct wl_array* states) const
 {
-    wl_resource_post_event(resource, Opcode::configure, width, height, states);
+    wl_argument args[3];
+    args[0].i = width;
+    args[1].i = height;
+    args[2].a = states;
+    wl_resource_post_event_array(resource, Opcode::configure, args);
 }
 
 void mw::XdgToplevelV6::send_close_event() const
 {
-    wl_resource_post_event(resource, Opcode::close);
+    wl_resource_post_event_array(resource, Opcode::close, nullptr);
 }
 
 bool mw::XdgToplevelV6::is_instance(wl_resource* resource)
@@ -1062,12 +1070,17 @@ mw::XdgPopupV6::~XdgPopupV6()
 
 void mw::XdgPopupV6::send_configure_event(int32_t x, int32_t y, int32_t width, int32_t height) const
 {
-    wl_resource_post_event(resource, Opcode::configure, x, y, width, height);
+    wl_argument args[4];
+    args[0].i = x;
+    args[1].i = y;
+    args[2].i = width;
+    args[3].i = height;
+    wl_resource_post_event_array(resource, Opcode::configure, args);
 }
 
 void mw::XdgPopupV6::send_popup_done_event() const
 {
-    wl_resource_post_event(resource, Opcode::popup_done);
+    wl_resource_post_event_array(resource, Opcode::popup_done, nullptr);
 }
 
 bool mw::XdgPopupV6::is_instance(wl_resource* resource)
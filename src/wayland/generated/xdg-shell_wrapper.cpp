@@ -185,7 +185,9 @@ mw::XdgWmBase::~XdgWmBase()
 
 void mw::XdgWmBase::send_ping_event(uint32_t serial) const
 {
-    wl_resource_post_event(resource, Opcode::ping, serial);
+    wl_argument args[1];
+    args[0].u = serial;
+    wl_resource_post_event_array(resource, Opcode::ping, args);
 }
 
 bool mw::XdgWmBase::is_instance(wl_resource* resource)
@@ -576,7 +578,9 @@ mw::XdgSurface::~XdgSurface()
 
 void mw::XdgSurface::send_configure_event(uint32_t serial) const
 {
-    wl_resource_post_event(resource, Opcode::configure, serial);
+    wl_argument args[1];
+    args[0].u = serial;
+    wl_resource_post_event_array(resource, Opcode::configure, args);
 }
 
 bool mw::XdgSurface::is_instance(wl_resource* resource)
@@ -912,12 +916,16 @@ mw::XdgToplevel::~XdgToplevel()
 
 void mw::XdgToplevel::send_configure_event(int32_t width, int32_t height, struct wl_array* states) const
 {
-    wl_resource_post_event(resource, Opcode::configure, width, height, states);
+    wl_argument args[3];
+    args[0].i = width;
+    args[1].i = height;
+    args[2].a = states;
+    wl_resource_post_event_array(resource, Opcode::configure, args);
 }
 
 void mw::XdgToplevel::send_close_event() const
 {
-    wl_resource_post_event(resource, Opcode::close);
+    wl_resource_post_event_array(resource, Opcode::close, nullptr);
 }
 
 bool mw::XdgToplevel::is_instance(wl_resource* resource)
@@ -1067,12 +1075,17 @@ mw::XdgPopup::~XdgPopup()
 
 void mw::XdgPopup::send_configure_event(int32_t x, int32_t y, int32_t width, int32_t height) const
 {
-    wl_resource_post_event(resource, Opcode::configure, x, y, width, height);
+    wl_argument args[4];
+    args[0].i = x;
+    args[1].i = y;
+    args[2].i = width;
+    args[3].i = height;
+    wl_resource_post_event_array(resource, Opcode::configure, args);
 }
 
 void mw::XdgPopup::send_popup_done_event() const
 {
-    wl_resource_post_event(resource, Opcode::popup_done);
+    wl_resource_post_event_array(resource, Opcode::popup_done, nullptr);
 }
 
 bool mw::XdgPopup::is_instance(wl_resource* resource)
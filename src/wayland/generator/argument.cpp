@@ -180,6 +180,20 @@ Emitter Argument::type_str_fragment() const
     return descriptor.wl_type_abbr;
 }
 
+Emitter Argument::wl_argument_fragment() const
+{
+    // Optional types are abbreviated "?x"; they go in the same member as "x"
+    switch (descriptor.wl_type_abbr.back())
+    {
+    case 'o':
+    case 'n':
+        return {"o = reinterpret_cast<struct wl_object*>(", call_fragment(), ")"};
+
+    default:
+        return {std::string{descriptor.wl_type_abbr.back()}, " = ", call_fragment()};
+    }
+}
+
 std::experimental::optional<Emitter> Argument::converter() const
 {
     if (descriptor.converter)
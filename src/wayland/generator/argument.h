@@ -49,6 +49,7 @@ public:
     Emitter call_fragment() const;
     Emitter object_type_fragment() const;
     Emitter type_str_fragment() const;
+    Emitter wl_argument_fragment() const; // the wl_argument member, and value to set it to, for the call
     std::experimental::optional<Emitter> converter() const;
 
     void populate_required_interfaces(std::set<std::string>& interfaces) const; // fills the set with interfaces used
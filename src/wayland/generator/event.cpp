@@ -57,7 +57,8 @@ Emitter Event::impl() const
         {"void mw::", class_name, "::send_", name, "_event(", mir_args(), ") const"},
         Block{
             mir2wl_converters(),
-            {"wl_resource_post_event(", wl_call_args(), ");"},
+            wl_argument_array(),
+            {"wl_resource_post_event_array(", wl_call_args(), ");"},
         }
     };
 }
@@ -85,8 +86,19 @@ Emitter Event::mir_args() const
 
 Emitter Event::wl_call_args() const
 {
-    std::vector<Emitter> call_args{"resource", "Opcode::" + sanitize_name(name)};
-    for (auto& arg : arguments)
-        call_args.push_back(arg.call_fragment());
-    return Emitter::seq(call_args, ", ");
+    return Emitter::seq({
+        "resource",
+        "Opcode::" + sanitize_name(name),
+        arguments.empty() ? "nullptr" : "args"}, ", ");
+}
+
+Emitter Event::wl_argument_array() const
+{
+    if (arguments.empty())
+        return nullptr;
+
+    std::vector<Emitter> lines{Line{"wl_argument args[", std::to_string(arguments.size()), "];"}};
+    for (auto i = 0u; i != arguments.size(); ++i)
+        lines.push_back(Line{"args[", std::to_string(i), "].", arguments[i].wl_argument_fragment(), ";"});
+    return Lines{lines};
 }
@@ -39,6 +39,9 @@ protected:
     // arguments to call the virtual mir function call (just names, no types)
     Emitter wl_call_args() const;
 
+    // fills in the wl_argument array for the call, sparing libwayland a walk of the signature
+    Emitter wl_argument_array() const;
+
     int const opcode;
 };
 
@@ -18,6 +18,7 @@
 
 #include "mir/wayland/wayland_base.h"
 #include "mir/log.h"
+#include "mir/memory_account.h"
 
 #include <map>
 #include <boost/throw_exception.hpp>
@@ -125,8 +126,20 @@ void mw::LifetimeTracker::mark_destroyed() const
     }
 }
 
+namespace
+{
+/// Counted rather than sized: what each holds depends on its interface
+mir::MemoryAccount protocol_objects{"wayland", "protocol objects"};
+}
+
 mw::Resource::Resource()
 {
+    protocol_objects.allocated(0);
+}
+
+mw::Resource::~Resource()
+{
+    protocol_objects.freed(0);
 }
 
 mw::Global::Global(wl_global* global)
@@ -94,6 +94,11 @@ public:
     {
         return rect;
     }
+
+    geometry::RectangleF src_bounds() const override
+    {
+        return {{}, geometry::SizeF{buf->size()}};
+    }
     
     std::experimental::optional<geometry::Rectangle> clip_area() const override
     {
@@ -105,8 +110,41 @@ public:
         return 1u;
     }
 
+    void set_tearing_allowed(bool allowed)
+    {
+        tearing_allowed_ = allowed;
+    }
+
+    bool tearing_allowed() const override
+    {
+        return tearing_allowed_;
+    }
+
+    void set_damage(std::experimental::optional<geometry::Rectangles> const& d)
+    {
+        damage_ = d;
+    }
+
+    std::experimental::optional<geometry::Rectangles> damage() const override
+    {
+        return damage_;
+    }
+
+    void set_opaque_region(geometry::Rectangles const& region)
+    {
+        opaque_region_ = region;
+    }
+
+    geometry::Rectangles opaque_region() const override
+    {
+        return opaque_region_;
+    }
+
 private:
     std::shared_ptr<graphics::Buffer> buf;
+    std::experimental::optional<geometry::Rectangles> damage_;
+    geometry::Rectangles opaque_region_;
+    bool tearing_allowed_{false};
     mir::geometry::Rectangle rect;
     float opacity;
     bool rectangular;
@@ -20,6 +20,7 @@
 #define MIR_TEST_DOUBLES_MOCK_BUFFER_STREAM_H_
 
 #include "mir/compositor/buffer_stream.h"
+#include "mir/compositor/presentation.h"
 #include "stub_buffer.h"
 #include <gmock/gmock.h>
 
@@ -53,6 +54,9 @@ struct MockBufferStream : public compositor::BufferStream
             .WillByDefault(testing::Return(mir_pixel_format_abgr_8888));
         ON_CALL(*this, stream_size())
             .WillByDefault(testing::Return(geometry::Size{0,0}));
+        ON_CALL(*this, source_bounds(testing::_))
+            .WillByDefault(testing::Invoke(
+                [](geometry::Size const& size) { return geometry::RectangleF{{}, geometry::SizeF{size}}; }));
     }
     std::shared_ptr<StubBuffer> buffer { std::make_shared<StubBuffer>() };
     MOCK_METHOD1(acquire_client_buffer, void(std::function<void(graphics::Buffer* buffer)>));
@@ -78,6 +82,17 @@ struct MockBufferStream : public compositor::BufferStream
     MOCK_METHOD1(disassociate_buffer, void(graphics::BufferID));
     MOCK_METHOD1(associate_buffer, void(graphics::BufferID));
     MOCK_METHOD1(set_scale, void(float));
+    MOCK_METHOD2(set_viewport, void(
+        std::experimental::optional<geometry::RectangleF> const&,
+        std::experimental::optional<geometry::Size> const&));
+    MOCK_CONST_METHOD1(source_bounds, geometry::RectangleF(geometry::Size const&));
+    MOCK_METHOD1(add_damage, void(geometry::Rectangles const&));
+    MOCK_CONST_METHOD0(submitted_damage, std::experimental::optional<geometry::Rectangles>());
+    MOCK_CONST_METHOD1(buffer_damage, std::experimental::optional<geometry::Rectangles>(void const*));
+    MOCK_METHOD1(set_opaque_region, void(geometry::Rectangles const&));
+    MOCK_CONST_METHOD0(opaque_region, geometry::Rectangles());
+    MOCK_METHOD1(set_frame_presented_callback, void(std::function<void(compositor::Presentation const&)> const&));
+    MOCK_METHOD1(frame_presented, void(compositor::Presentation const&));
 
 };
 }
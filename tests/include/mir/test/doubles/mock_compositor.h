@@ -35,6 +35,12 @@ class MockCompositor : public compositor::Compositor
 public:
     MOCK_METHOD0(start, void());
     MOCK_METHOD0(stop, void());
+    MOCK_METHOD0(pause, void());
+    MOCK_METHOD0(resume, void());
+    MOCK_METHOD1(stop_compositing, void(graphics::DisplaySyncGroup&));
+    MOCK_METHOD0(start_compositing_new_groups, void());
+    MOCK_METHOD1(suspend_compositing, void(graphics::DisplaySyncGroup&));
+    MOCK_METHOD1(resume_compositing, void(graphics::DisplaySyncGroup&));
 };
 
 }
@@ -41,6 +41,8 @@ public:
                  void(compositor::CompositorReport::SubCompositorId, graphics::RenderableList const&));
     MOCK_METHOD1(rendered_frame,
                  void(compositor::CompositorReport::SubCompositorId));
+    MOCK_METHOD2(measured_gpu_render_time,
+                 void(compositor::CompositorReport::SubCompositorId, std::chrono::nanoseconds));
     MOCK_METHOD1(finished_frame,
                  void(compositor::CompositorReport::SubCompositorId));
     MOCK_METHOD0(started, void());
@@ -40,6 +40,12 @@ public:
     MOCK_CONST_METHOD0(configuration, std::unique_ptr<graphics::DisplayConfiguration>());
     MOCK_METHOD1(apply_if_configuration_preserves_display_buffers, bool(graphics::DisplayConfiguration const&));
     MOCK_METHOD1(configure, void(graphics::DisplayConfiguration const&));
+    MOCK_METHOD2(configure_incrementally,
+                 void(graphics::DisplayConfiguration const&, std::function<void(graphics::DisplaySyncGroup&)> const&));
+    MOCK_METHOD3(apply_if_configuration_only_changes_power_modes,
+                 bool(graphics::DisplayConfiguration const&,
+                      std::function<void(graphics::DisplaySyncGroup&)> const&,
+                      std::function<void(graphics::DisplaySyncGroup&)> const&));
     MOCK_METHOD2(register_configuration_change_handler,
                  void(graphics::EventHandlerRegister&, graphics::DisplayConfigurationChangeHandler const&));
 
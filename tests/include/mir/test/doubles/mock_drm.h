@@ -130,6 +130,16 @@ public:
 
     MOCK_METHOD5(drmModePageFlip, int(int fd, uint32_t crtc_id, uint32_t fb_id,
                                                   uint32_t flags, void *user_data));
+
+    MOCK_METHOD0(drmModeAtomicAlloc, drmModeAtomicReqPtr());
+    MOCK_METHOD1(drmModeAtomicFree, void(drmModeAtomicReqPtr req));
+    MOCK_METHOD4(drmModeAtomicAddProperty, int(drmModeAtomicReqPtr req, uint32_t object_id,
+                                               uint32_t property_id, uint64_t value));
+    MOCK_METHOD4(drmModeAtomicCommit, int(int fd, drmModeAtomicReqPtr req, uint32_t flags, void* user_data));
+    MOCK_METHOD4(drmModeCreatePropertyBlob, int(int fd, void const* data, size_t size, uint32_t* id));
+    MOCK_METHOD2(drmModeDestroyPropertyBlob, int(int fd, uint32_t id));
+    MOCK_METHOD2(drmModeGetPropertyBlob, drmModePropertyBlobPtr(int fd, uint32_t blob_id));
+    MOCK_METHOD1(drmModeFreePropertyBlob, void(drmModePropertyBlobPtr ptr));
     MOCK_METHOD2(drmHandleEvent, int(int fd, drmEventContextPtr evctx));
 
     MOCK_METHOD3(drmGetCap, int(int fd, uint64_t capability, uint64_t *value));
@@ -201,6 +211,7 @@ private:
     std::unordered_map<std::string, FakeDRMResources> fake_drms;
     std::unordered_map<int, FakeDRMResources&> fd_to_drm;
     drmModeObjectProperties empty_object_props;
+    int fake_atomic_request;
     mir_test_framework::OpenHandlerHandle open_interposer;
 };
 
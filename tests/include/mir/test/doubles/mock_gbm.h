@@ -61,6 +61,13 @@ public:
     MOCK_METHOD5(gbm_surface_create, struct gbm_surface*(struct gbm_device *gbm,
                                                          uint32_t width, uint32_t height,
                                                          uint32_t format, uint32_t flags));
+#ifndef MIR_NO_GBM_MODIFIERS
+    MOCK_METHOD6(gbm_surface_create_with_modifiers, struct gbm_surface*(struct gbm_device *gbm,
+                                                                        uint32_t width, uint32_t height,
+                                                                        uint32_t format,
+                                                                        uint64_t const* modifiers,
+                                                                        unsigned int count));
+#endif
     MOCK_METHOD1(gbm_surface_destroy, void(struct gbm_surface *surface));
     MOCK_METHOD1(gbm_surface_lock_front_buffer, struct gbm_bo*(struct gbm_surface *surface));
     MOCK_METHOD2(gbm_surface_release_buffer, void(struct gbm_surface *surface, struct gbm_bo *bo));
@@ -74,10 +81,20 @@ public:
     MOCK_METHOD1(gbm_bo_get_stride, uint32_t(struct gbm_bo *bo));
     MOCK_METHOD1(gbm_bo_get_format, uint32_t(struct gbm_bo *bo));
     MOCK_METHOD1(gbm_bo_get_handle, union gbm_bo_handle(struct gbm_bo *bo));
+#ifndef MIR_NO_GBM_MODIFIERS
+    MOCK_METHOD1(gbm_bo_get_modifier, uint64_t(struct gbm_bo *bo));
+    MOCK_METHOD1(gbm_bo_get_plane_count, int(struct gbm_bo *bo));
+    MOCK_METHOD2(gbm_bo_get_handle_for_plane, union gbm_bo_handle(struct gbm_bo *bo, int plane));
+    MOCK_METHOD2(gbm_bo_get_stride_for_plane, uint32_t(struct gbm_bo *bo, int plane));
+    MOCK_METHOD2(gbm_bo_get_offset, uint32_t(struct gbm_bo *bo, int plane));
+#endif
     MOCK_METHOD3(gbm_bo_set_user_data, void(struct gbm_bo *bo, void *data,
                                             void (*destroy_user_data)(struct gbm_bo *, void *)));
     MOCK_METHOD1(gbm_bo_get_user_data, void*(struct gbm_bo *bo));
     MOCK_METHOD3(gbm_bo_write, bool(struct gbm_bo *bo, const void *buf, size_t count));
+    MOCK_METHOD8(gbm_bo_map, void*(struct gbm_bo *bo, uint32_t x, uint32_t y, uint32_t width, uint32_t height,
+                                   uint32_t flags, uint32_t *stride, void **map_data));
+    MOCK_METHOD2(gbm_bo_unmap, void(struct gbm_bo *bo, void *map_data));
     MOCK_METHOD1(gbm_bo_destroy, void(struct gbm_bo *bo));
     MOCK_METHOD4(gbm_bo_import, struct gbm_bo*(struct gbm_device*, uint32_t, void*, uint32_t));
     MOCK_METHOD1(gbm_bo_get_fd, int(gbm_bo*));
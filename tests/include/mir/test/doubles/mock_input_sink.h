@@ -33,6 +33,7 @@ namespace doubles
 struct MockInputSink : mir::input::InputSink
 {
     MOCK_METHOD1(handle_input, void(std::shared_ptr<MirEvent> const&));
+    MOCK_METHOD1(handle_input_batch, void(std::vector<std::shared_ptr<MirEvent>> const&));
     MOCK_METHOD1(confine_pointer, void(mir::geometry::Point&));
     MOCK_CONST_METHOD0(bounding_rectangle, mir::geometry::Rectangle());
     MOCK_CONST_METHOD1(output_info, mir::input::OutputInfo(uint32_t));
@@ -45,17 +45,29 @@ struct MockRenderable : public graphics::Renderable
             .WillByDefault(testing::Return(glm::mat4{}));
         ON_CALL(*this, visible())
             .WillByDefault(testing::Return(true));
+        ON_CALL(*this, opaque_region())
+            .WillByDefault(testing::Return(geometry::Rectangles{}));
+        ON_CALL(*this, src_bounds())
+            .WillByDefault(testing::Invoke(
+                [this]() -> geometry::RectangleF
+                {
+                    return {{}, geometry::SizeF{buffer()->size()}};
+                }));
     }
 
     MOCK_CONST_METHOD0(id, ID());
     MOCK_CONST_METHOD0(buffer, std::shared_ptr<graphics::Buffer>());
     MOCK_CONST_METHOD0(screen_position, geometry::Rectangle());
+    MOCK_CONST_METHOD0(src_bounds, geometry::RectangleF());
     MOCK_CONST_METHOD0(clip_area, std::experimental::optional<geometry::Rectangle>());
     MOCK_CONST_METHOD0(alpha, float());
     MOCK_CONST_METHOD0(transformation, glm::mat4());
     MOCK_CONST_METHOD0(visible, bool());
     MOCK_CONST_METHOD0(shaped, bool());
     MOCK_CONST_METHOD0(swap_interval, unsigned int());
+    MOCK_CONST_METHOD0(tearing_allowed, bool());
+    MOCK_CONST_METHOD0(damage, std::experimental::optional<geometry::Rectangles>());
+    MOCK_CONST_METHOD0(opaque_region, geometry::Rectangles());
 };
 }
 }
@@ -33,8 +33,11 @@ struct MockRenderer : public renderer::Renderer
 {
     MOCK_METHOD1(set_viewport, void(geometry::Rectangle const&));
     MOCK_METHOD1(set_output_transform, void(glm::mat2 const&));
+    MOCK_METHOD1(set_damage, void(geometry::Rectangles const&));
     MOCK_CONST_METHOD1(render, void(graphics::RenderableList const&));
     MOCK_METHOD0(suspend, void());
+    MOCK_METHOD0(gpu_render_time, std::experimental::optional<std::chrono::nanoseconds>());
+    MOCK_METHOD2(read_next_frame, void(geometry::Rectangle const&, FrameReader const&));
 
     ~MockRenderer() noexcept {}
 };
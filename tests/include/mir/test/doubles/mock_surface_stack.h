@@ -41,6 +41,9 @@ struct MockSurfaceStack : public shell::SurfaceStack
 
     MOCK_METHOD1(remove_surface, void(std::weak_ptr<scene::Surface> const& surface));
     MOCK_CONST_METHOD1(surface_at, std::shared_ptr<scene::Surface>(geometry::Point));
+
+    MOCK_METHOD0(begin_transaction, void());
+    MOCK_METHOD0(end_transaction, void());
 };
 
 }
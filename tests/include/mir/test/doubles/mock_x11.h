@@ -95,6 +95,10 @@ public:
     MOCK_METHOD9(XGetGeometry, Status(Display*, Drawable, Window*, int*, int*, unsigned int*, unsigned int*, unsigned int*, unsigned int*));
     MOCK_METHOD2(XFixesHideCursor, void(Display *dpy, Window win));
     MOCK_METHOD2(XFixesShowCursor, void(Display *dpy, Window win));
+    MOCK_METHOD2(XGetEventData, Bool(Display*, XGenericEventCookie*));
+    MOCK_METHOD2(XFreeEventData, void(Display*, XGenericEventCookie*));
+    MOCK_METHOD4(XPresentQueryExtension, Bool(Display*, int*, int*, int*));
+    MOCK_METHOD3(XPresentSelectInput, XID(Display*, Window, unsigned));
 
     FakeX11Resources fake_x11;
 };
@@ -20,6 +20,7 @@
 #define MIR_TEST_DOUBLES_STUB_BUFFER_ALLOCATOR_H_
 
 #include "mir/graphics/graphic_buffer_allocator.h"
+#include "mir/graphics/wayland_shm.h"
 #include "mir/test/doubles/stub_buffer.h"
 #include "mir_test_framework/stub_platform_native_buffer.h"
 #include "mir_toolkit/client_types.h"
@@ -40,16 +41,18 @@ namespace doubles
 
 namespace
 {
-void memcpy_from_shm_buffer(struct wl_shm_buffer* buffer)
+void memcpy_from_shm_buffer(graphics::WlShmBufferContent const& buffer)
 {
-    auto const height = wl_shm_buffer_get_height(buffer);
-    auto const stride = wl_shm_buffer_get_stride(buffer);
+    auto const height = buffer.size().height.as_int();
+    auto const stride = buffer.stride().as_int();
     // The 32 here is a workaround for a spurious(?) Valgrind failure
     auto dummy_destination = std::make_unique<unsigned char[]>(height * stride + 32);
 
-    wl_shm_buffer_begin_access(buffer);
-    memcpy(dummy_destination.get(), wl_shm_buffer_get_data(buffer), height * stride);
-    wl_shm_buffer_end_access(buffer);
+    buffer.read(
+        [&](unsigned char const* pixels)
+        {
+            memcpy(dummy_destination.get(), pixels, height * stride);
+        });
 }
 }
 
@@ -83,18 +86,22 @@ struct StubBufferAllocator : public graphics::GraphicBufferAllocator
     auto buffer_from_shm(
         wl_resource* resource,
         std::shared_ptr<mir::Executor> executor,
-        std::function<void()>&& on_consumed) -> std::shared_ptr<graphics::Buffer> override
+        std::function<void()>&& on_consumed,
+        std::shared_ptr<graphics::Buffer> const& previous,
+        std::experimental::optional<geometry::Rectangles> const& damage) -> std::shared_ptr<graphics::Buffer> override
     {
         // Temporary(?!) hack to actually use the buffer, for WLCS test
         // Transitioning the StubGraphicsPlatform to use the MESA surfaceless GL platform would
         // allow us to test more of Mir, and drop this hack
-        memcpy_from_shm_buffer(wl_shm_buffer_get(resource));
+        memcpy_from_shm_buffer(*graphics::wl_shm_buffer_content(resource));
 
         return graphics::wayland::buffer_from_wl_shm(
             resource,
             std::move(executor),
             std::make_shared<graphics::common::EGLContextExecutor>(std::make_unique<test::doubles::NullGLContext>()),
-            std::move(on_consumed));
+            std::move(on_consumed),
+            previous,
+            damage);
     }
 };
 
@@ -20,6 +20,7 @@
 #define MIR_TEST_DOUBLES_NULL_BUFFER_STREAM_H_
 
 #include <mir/compositor/buffer_stream.h>
+#include <mir/compositor/presentation.h>
 #include <mir/test/doubles/stub_buffer.h>
 #include "mir_test_framework/stub_platform_native_buffer.h"
 
@@ -65,14 +66,39 @@ public:
     {
         if (b) ++nready;
     }
+    void add_damage(geometry::Rectangles const&) override {}
+    auto submitted_damage() const -> std::experimental::optional<geometry::Rectangles> override
+    {
+        return std::experimental::nullopt;
+    }
+    void set_opaque_region(geometry::Rectangles const&) override {}
     void with_most_recent_buffer_do(std::function<void(graphics::Buffer&)> const& fn) override
     {
         fn(*stub_compositor_buffer);
     }
     MirPixelFormat pixel_format() const override { return mir_pixel_format_abgr_8888; }
     void set_frame_posted_callback(std::function<void(geometry::Size const&)> const&) override {}
+    void set_frame_presented_callback(std::function<void(compositor::Presentation const&)> const&) override {}
+    void frame_presented(compositor::Presentation const&) override {}
     bool has_submitted_buffer() const override { return true; }
     void set_scale(float) override {}
+    void set_viewport(
+        std::experimental::optional<geometry::RectangleF> const&,
+        std::experimental::optional<geometry::Size> const&) override
+    {
+    }
+    auto source_bounds(geometry::Size const& buffer_size) const -> geometry::RectangleF override
+    {
+        return {{}, geometry::SizeF{buffer_size}};
+    }
+    auto buffer_damage(void const*) const -> std::experimental::optional<geometry::Rectangles> override
+    {
+        return std::experimental::nullopt;
+    }
+    auto opaque_region() const -> geometry::Rectangles override
+    {
+        return {};
+    }
 
     std::shared_ptr<graphics::Buffer> stub_compositor_buffer;
     int nready = 0;
@@ -38,6 +38,7 @@ public:
     void make_current() override {}
     void release_current() override {}
     void swap_buffers() override {}
+    void swap_buffers_with_damage(geometry::Rectangles const&) override {}
     void bind() override {}
 };
 
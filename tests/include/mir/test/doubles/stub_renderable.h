@@ -74,6 +74,10 @@ public:
     {
         return rect;
     }
+    geometry::RectangleF src_bounds() const override
+    {
+        return {{}, geometry::SizeF{stub_buffer->size()}};
+    }
     std::experimental::optional<geometry::Rectangle> clip_area() const override
     {
         return std::experimental::optional<geometry::Rectangle>();
@@ -94,6 +98,18 @@ public:
     {
         return 1;
     }
+    bool tearing_allowed() const override
+    {
+        return false;
+    }
+    std::experimental::optional<geometry::Rectangles> damage() const override
+    {
+        return std::experimental::nullopt;
+    }
+    geometry::Rectangles opaque_region() const override
+    {
+        return {};
+    }
 
 private:
     std::shared_ptr<graphics::Buffer> make_stub_buffer(geometry::Rectangle const& rect)
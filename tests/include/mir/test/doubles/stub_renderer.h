@@ -35,7 +35,10 @@ class StubRenderer : public renderer::Renderer
 public:
     void set_viewport(geometry::Rectangle const&) override {}
     void set_output_transform(glm::mat2 const&) override {}
+    void set_damage(geometry::Rectangles const&) override {}
     void suspend() override {}
+    auto gpu_render_time() -> std::experimental::optional<std::chrono::nanoseconds> override { return {}; }
+    void read_next_frame(geometry::Rectangle const&, FrameReader const&) override {}
 
     void render(graphics::RenderableList const& renderables) const override
     {
@@ -55,6 +55,15 @@ public:
     {
     }
 
+    void scanned_out() override
+    {
+    }
+
+    auto presentation_callback() -> PresentationCallback override
+    {
+        return {};
+    }
+
 private:
     std::shared_ptr<graphics::Renderable> const renderable_;
 };
@@ -86,6 +86,14 @@ struct StubShell : public shell::Shell
     {
     }
 
+    void begin_transaction() override
+    {
+    }
+
+    void end_transaction() override
+    {
+    }
+
     void set_drag_and_drop_handle(std::vector<uint8_t> const& /*handle*/) override
     {
     }
@@ -138,6 +138,22 @@ struct StubServerTool : doubles::StubDisplayServer
         done->Run();
     }
 
+    void exchange_buffers(
+        mir::protobuf::BufferExchange const* /*request*/,
+        mir::protobuf::Void* /*response*/,
+        google::protobuf::Closure* done) override
+    {
+        done->Run();
+    }
+
+    void frame_timing(
+        mir::protobuf::FrameTimingRequest const* /*request*/,
+        mir::protobuf::FrameTiming* /*response*/,
+        google::protobuf::Closure* done) override
+    {
+        done->Run();
+    }
+
     std::string application_name() const
     {
         std::lock_guard<std::mutex> lock(guard);
@@ -74,6 +74,16 @@ struct TestSurfaceStack : public msh::SurfaceStack
         return wrapped->surface_at(point);
     }
 
+    void begin_transaction() override
+    {
+        wrapped->begin_transaction();
+    }
+
+    void end_transaction() override
+    {
+        wrapped->end_transaction();
+    }
+
     void default_add_surface(
         std::shared_ptr<ms::Surface> const& surface,
         mir::input::InputReceptionMode input_mode)
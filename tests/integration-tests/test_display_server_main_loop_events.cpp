@@ -360,13 +360,15 @@ struct DisplayServerMainLoopEvents : testing::Test
         mock_connector = server_config.the_mock_connector();
         mock_input_manager = server_config.the_mock_input_manager();
         mock_input_dispatcher = server_config.the_mock_input_dispatcher();
+
+        // The compositor starts concurrently with input, so is outside the tests' sequences
+        compositor_started = EXPECT_CALL(*mock_compositor, start()).Times(1);
     }
 
     void expect_start()
     {
-        EXPECT_CALL(*mock_compositor, start()).Times(1);
         EXPECT_CALL(*mock_input_manager, start()).Times(1);
-        EXPECT_CALL(*mock_input_dispatcher, start()).Times(1);
+        EXPECT_CALL(*mock_input_dispatcher, start()).Times(1).After(compositor_started);
         EXPECT_CALL(*mock_connector, start()).Times(1);
     }
 
@@ -375,14 +377,14 @@ struct DisplayServerMainLoopEvents : testing::Test
         EXPECT_CALL(*mock_connector, stop()).Times(1);
         EXPECT_CALL(*mock_input_dispatcher, stop()).Times(1);
         EXPECT_CALL(*mock_input_manager, stop()).Times(1);
-        EXPECT_CALL(*mock_compositor, stop()).Times(1);
+        EXPECT_CALL(*mock_compositor, pause()).Times(1);
         EXPECT_CALL(*mock_display, pause()).Times(1);
     }
 
     void expect_resume()
     {
         EXPECT_CALL(*mock_display, resume()).Times(1);
-        EXPECT_CALL(*mock_compositor, start()).Times(1);
+        EXPECT_CALL(*mock_compositor, resume()).Times(1);
         EXPECT_CALL(*mock_input_manager, start()).Times(1);
         EXPECT_CALL(*mock_input_dispatcher, start()).Times(1);
         EXPECT_CALL(*mock_connector, start()).Times(1);
@@ -398,9 +400,8 @@ struct DisplayServerMainLoopEvents : testing::Test
 
     void expect_change_configuration()
     {
-        EXPECT_CALL(*mock_compositor, stop()).Times(1);
         EXPECT_CALL(*mock_display, configure(testing::_)).Times(1);
-        EXPECT_CALL(*mock_compositor, start()).Times(1);
+        EXPECT_CALL(*mock_compositor, start_compositing_new_groups()).Times(1);
     }
 
     std::shared_ptr<MockDisplay> mock_display;
@@ -408,6 +409,7 @@ struct DisplayServerMainLoopEvents : testing::Test
     std::shared_ptr<MockConnector> mock_connector;
     std::shared_ptr<mtd::MockInputManager> mock_input_manager;
     std::shared_ptr<mtd::MockInputDispatcher> mock_input_dispatcher;
+    testing::Expectation compositor_started;
 };
 
 }
@@ -509,12 +511,12 @@ TEST_F(DisplayServerMainLoopEvents, display_server_attempts_to_continue_on_pause
         EXPECT_CALL(*mock_connector, stop()).Times(1);
         EXPECT_CALL(*mock_input_dispatcher, stop()).Times(1);
         EXPECT_CALL(*mock_input_manager, stop()).Times(1);
-        EXPECT_CALL(*mock_compositor, stop()).Times(1);
+        EXPECT_CALL(*mock_compositor, pause()).Times(1);
         EXPECT_CALL(*mock_display, pause())
             .WillOnce(Throw(std::runtime_error("")));
 
         /* Attempt to continue */
-        EXPECT_CALL(*mock_compositor, start()).Times(1);
+        EXPECT_CALL(*mock_compositor, resume()).Times(1);
         EXPECT_CALL(*mock_input_manager, start()).Times(1);
         EXPECT_CALL(*mock_input_dispatcher, start()).Times(1);
         EXPECT_CALL(*mock_connector, start()).Times(1);
@@ -81,7 +81,7 @@ public:
                 group.for_each_display_buffer([this](mg::DisplayBuffer& display_buffer)
                 {
                     auto& dbc = display_buffer_compositor_map[&display_buffer];
-                    dbc->composite(this->scene->scene_elements_for(dbc.get()));
+                    dbc->composite(this->scene->scene_elements_for(dbc.get(), display_buffer.view_area()));
                 });
                 group.post();
             });
@@ -107,6 +107,30 @@ public:
         scene->remove_observer(observer);
     }
 
+    void pause()
+    {
+    }
+
+    void resume()
+    {
+    }
+
+    void stop_compositing(mg::DisplaySyncGroup&)
+    {
+    }
+
+    void start_compositing_new_groups()
+    {
+    }
+
+    void suspend_compositing(mg::DisplaySyncGroup&)
+    {
+    }
+
+    void resume_compositing(mg::DisplaySyncGroup&)
+    {
+    }
+
 private:
     std::shared_ptr<mg::Display> const display;
     std::shared_ptr<mc::DisplayListener> const display_listener;
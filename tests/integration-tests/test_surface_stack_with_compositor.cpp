@@ -214,6 +214,9 @@ TEST_F(SurfaceStackCompositor, compositor_runs_until_all_surfaces_buffers_are_co
     std::function<void(mir::geometry::Size const&)> frame_callback;
     ON_CALL(*mock_buffer_stream, buffers_ready_for_compositor(_))
         .WillByDefault(Return(5));
+    // Each queued frame is a new buffer (otherwise the compositor skips it as unchanged)
+    ON_CALL(*mock_buffer_stream, lock_compositor_buffer(_))
+        .WillByDefault(InvokeWithoutArgs([]{ return std::make_shared<mtd::StubBuffer>(); }));
     EXPECT_CALL(*mock_buffer_stream, set_frame_posted_callback(_))
         .WillOnce(SaveArg<0>(&frame_callback))
         .WillRepeatedly(Return());
@@ -241,7 +244,7 @@ TEST_F(SurfaceStackCompositor, bypassed_compositor_runs_until_all_surfaces_buffe
     ON_CALL(*mock_buffer_stream, buffers_ready_for_compositor(_))
         .WillByDefault(Return(5));
     ON_CALL(*mock_buffer_stream, lock_compositor_buffer(_))
-        .WillByDefault(Return(mt::fake_shared(*stub_buffer)));
+        .WillByDefault(InvokeWithoutArgs([]{ return std::make_shared<mtd::StubBuffer>(); }));
     EXPECT_CALL(*mock_buffer_stream, set_frame_posted_callback(_))
         .WillOnce(SaveArg<0>(&frame_callback))
         .WillRepeatedly(Return());
@@ -22,6 +22,7 @@
 #include "mir/geometry/size.h"
 #include <gtest/gtest.h>
 
+#include <cerrno>
 #include <stdexcept>
 #include <unistd.h>
 #include <dlfcn.h>
@@ -307,6 +308,14 @@ mtd::MockDRM::MockDRM()
     ON_CALL(*this, drmModeObjectGetProperties(_, _, _))
         .WillByDefault(Return(&empty_object_props));
 
+    // The fake devices only do legacy modesetting
+    ON_CALL(*this, drmSetClientCap(_, DRM_CLIENT_CAP_ATOMIC, _))
+        .WillByDefault(Return(-EOPNOTSUPP));
+
+    // An opaque, non-null request; the contents are never looked at
+    ON_CALL(*this, drmModeAtomicAlloc())
+        .WillByDefault(Return(reinterpret_cast<drmModeAtomicReqPtr>(&fake_atomic_request)));
+
     ON_CALL(*this, drmSetInterfaceVersion(_, _))
         .WillByDefault(
             Invoke(
@@ -680,6 +689,46 @@ int drmModePageFlip(int fd, uint32_t crtc_id, uint32_t fb_id,
                                         flags, user_data);
 }
 
+drmModeAtomicReqPtr drmModeAtomicAlloc()
+{
+    return global_mock->drmModeAtomicAlloc();
+}
+
+void drmModeAtomicFree(drmModeAtomicReqPtr req)
+{
+    global_mock->drmModeAtomicFree(req);
+}
+
+int drmModeAtomicAddProperty(drmModeAtomicReqPtr req, uint32_t object_id, uint32_t property_id, uint64_t value)
+{
+    return global_mock->drmModeAtomicAddProperty(req, object_id, property_id, value);
+}
+
+int drmModeAtomicCommit(int fd, drmModeAtomicReqPtr req, uint32_t flags, void* user_data)
+{
+    return global_mock->drmModeAtomicCommit(fd, req, flags, user_data);
+}
+
+int drmModeCreatePropertyBlob(int fd, void const* data, size_t size, uint32_t* id)
+{
+    return global_mock->drmModeCreatePropertyBlob(fd, data, size, id);
+}
+
+int drmModeDestroyPropertyBlob(int fd, uint32_t id)
+{
+    return global_mock->drmModeDestroyPropertyBlob(fd, id);
+}
+
+drmModePropertyBlobPtr drmModeGetPropertyBlob(int fd, uint32_t blob_id)
+{
+    return global_mock->drmModeGetPropertyBlob(fd, blob_id);
+}
+
+void drmModeFreePropertyBlob(drmModePropertyBlobPtr ptr)
+{
+    global_mock->drmModeFreePropertyBlob(ptr);
+}
+
 int drmHandleEvent(int fd, drmEventContextPtr evctx)
 {
     return global_mock->drmHandleEvent(fd, evctx);
@@ -19,6 +19,7 @@
 
 #include "mir/test/doubles/mock_gbm.h"
 #include <gtest/gtest.h>
+#include <drm_fourcc.h>
 
 namespace mtd=mir::test::doubles;
 
@@ -51,6 +52,18 @@ mtd::MockGBM::MockGBM()
     ON_CALL(*this, gbm_surface_create(fake_gbm.device,_,_,_,_))
     .WillByDefault(Return(fake_gbm.surface));
 
+#ifndef MIR_NO_GBM_MODIFIERS
+    ON_CALL(*this, gbm_surface_create_with_modifiers(fake_gbm.device,_,_,_,_,_))
+    .WillByDefault(Return(fake_gbm.surface));
+
+    // Buffers allocated without modifiers don't have one
+    ON_CALL(*this, gbm_bo_get_modifier(_))
+    .WillByDefault(Return(DRM_FORMAT_MOD_INVALID));
+
+    ON_CALL(*this, gbm_bo_get_plane_count(_))
+    .WillByDefault(Return(1));
+#endif
+
     ON_CALL(*this, gbm_surface_lock_front_buffer(fake_gbm.surface))
     .WillByDefault(Return(fake_gbm.bo));
 
@@ -105,6 +118,17 @@ struct gbm_surface *gbm_surface_create(struct gbm_device *gbm,
     return global_mock->gbm_surface_create(gbm, width, height, format, flags);
 }
 
+#ifndef MIR_NO_GBM_MODIFIERS
+struct gbm_surface *gbm_surface_create_with_modifiers(struct gbm_device *gbm,
+                                                      uint32_t width, uint32_t height,
+                                                      uint32_t format,
+                                                      const uint64_t *modifiers,
+                                                      const unsigned int count)
+{
+    return global_mock->gbm_surface_create_with_modifiers(gbm, width, height, format, modifiers, count);
+}
+#endif
+
 void gbm_surface_destroy(struct gbm_surface *surface)
 {
     return global_mock->gbm_surface_destroy(surface);
@@ -173,6 +197,18 @@ int gbm_bo_write(struct gbm_bo *bo, const void *buf, size_t count)
     return global_mock->gbm_bo_write(bo, buf, count);
 }
 
+void* gbm_bo_map(
+    struct gbm_bo *bo, uint32_t x, uint32_t y, uint32_t width, uint32_t height,
+    uint32_t flags, uint32_t *stride, void **map_data)
+{
+    return global_mock->gbm_bo_map(bo, x, y, width, height, flags, stride, map_data);
+}
+
+void gbm_bo_unmap(struct gbm_bo *bo, void *map_data)
+{
+    global_mock->gbm_bo_unmap(bo, map_data);
+}
+
 void gbm_bo_destroy(struct gbm_bo *bo)
 {
     return global_mock->gbm_bo_destroy(bo);
@@ -187,3 +223,30 @@ int gbm_bo_get_fd(gbm_bo* bo)
 {
     return global_mock->gbm_bo_get_fd(bo);
 }
+
+#ifndef MIR_NO_GBM_MODIFIERS
+uint64_t gbm_bo_get_modifier(struct gbm_bo *bo)
+{
+    return global_mock->gbm_bo_get_modifier(bo);
+}
+
+int gbm_bo_get_plane_count(struct gbm_bo *bo)
+{
+    return global_mock->gbm_bo_get_plane_count(bo);
+}
+
+union gbm_bo_handle gbm_bo_get_handle_for_plane(struct gbm_bo *bo, int plane)
+{
+    return global_mock->gbm_bo_get_handle_for_plane(bo, plane);
+}
+
+uint32_t gbm_bo_get_stride_for_plane(struct gbm_bo *bo, int plane)
+{
+    return global_mock->gbm_bo_get_stride_for_plane(bo, plane);
+}
+
+uint32_t gbm_bo_get_offset(struct gbm_bo *bo, int plane)
+{
+    return global_mock->gbm_bo_get_offset(bo, plane);
+}
+#endif
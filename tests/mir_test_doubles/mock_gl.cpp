@@ -114,6 +114,30 @@ void glClearColor(GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha)
     global_mock_gl->glClearColor(red, green, blue, alpha);
 }
 
+void glClearDepthf(GLclampf depth)
+{
+    CHECK_GLOBAL_VOID_MOCK();
+    global_mock_gl->glClearDepthf(depth);
+}
+
+void glDepthFunc(GLenum func)
+{
+    CHECK_GLOBAL_VOID_MOCK();
+    global_mock_gl->glDepthFunc(func);
+}
+
+void glDepthMask(GLboolean flag)
+{
+    CHECK_GLOBAL_VOID_MOCK();
+    global_mock_gl->glDepthMask(flag);
+}
+
+void glDepthRangef(GLclampf near, GLclampf far)
+{
+    CHECK_GLOBAL_VOID_MOCK();
+    global_mock_gl->glDepthRangef(near, far);
+}
+
 void glColorMask(GLboolean r, GLboolean g, GLboolean b, GLboolean a)
 {
     CHECK_GLOBAL_VOID_MOCK();
@@ -178,6 +202,12 @@ void glUniform2f(GLint location, GLfloat x, GLfloat y)
     global_mock_gl->glUniform2f(location, x, y);
 }
 
+void glUniform4f(GLint location, GLfloat x, GLfloat y, GLfloat z, GLfloat w)
+{
+    CHECK_GLOBAL_VOID_MOCK();
+    global_mock_gl->glUniform4f(location, x, y, z, w);
+}
+
 void glBindBuffer(GLenum buffer, GLuint name)
 {
     CHECK_GLOBAL_VOID_MOCK();
@@ -361,6 +391,14 @@ void glTexImage2D(GLenum target, GLint level, GLint internalformat,
     global_mock_gl->glTexImage2D(target, level, internalformat, width, height, border, format, type, pixels);
 }
 
+void glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset,
+                     GLsizei width, GLsizei height,
+                     GLenum format, GLenum type, const GLvoid* pixels)
+{
+    CHECK_GLOBAL_VOID_MOCK();
+    global_mock_gl->glTexSubImage2D(target, level, xoffset, yoffset, width, height, format, type, pixels);
+}
+
 void glGenFramebuffers(GLsizei n, GLuint *framebuffers)
 {
     CHECK_GLOBAL_VOID_MOCK();
@@ -453,6 +491,12 @@ void glFinish()
     global_mock_gl->glFinish();
 }
 
+void glFlush()
+{
+    CHECK_GLOBAL_VOID_MOCK();
+    global_mock_gl->glFlush();
+}
+
 void glGenerateMipmap(GLenum target)
 {
     CHECK_GLOBAL_VOID_MOCK();
@@ -282,3 +282,23 @@ extern "C" void XFixesShowCursor(Display *dpy, Window win)
 {
     global_mock->XFixesShowCursor(dpy, win);
 }
+
+Bool XGetEventData(Display* dpy, XGenericEventCookie* cookie)
+{
+    return global_mock->XGetEventData(dpy, cookie);
+}
+
+void XFreeEventData(Display* dpy, XGenericEventCookie* cookie)
+{
+    global_mock->XFreeEventData(dpy, cookie);
+}
+
+extern "C" Bool XPresentQueryExtension(Display* dpy, int* major_opcode, int* event_base, int* error_base)
+{
+    return global_mock->XPresentQueryExtension(dpy, major_opcode, event_base, error_base);
+}
+
+extern "C" XID XPresentSelectInput(Display* dpy, Window window, unsigned event_mask)
+{
+    return global_mock->XPresentSelectInput(dpy, window, event_mask);
+}
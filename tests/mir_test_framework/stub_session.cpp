@@ -42,6 +42,13 @@ void mtd::StubSession::take_snapshot(
 {
 }
 
+void mtd::StubSession::take_thumbnail_of(
+    std::shared_ptr<mir::scene::Surface> const& /*surface*/,
+    mir::geometry::Size const& /*max_size*/,
+    mir::scene::SnapshotCallback const& /*thumbnail_taken*/)
+{
+}
+
 std::shared_ptr<mir::scene::Surface> mtd::StubSession::default_surface() const
 {
     return {};
@@ -17,6 +17,7 @@
  */
 
 #include <miral/test_server.h>
+#include <miral/runner.h>
 #include <miral/external_client.h>
 #include <miral/x11_support.h>
 
@@ -24,7 +25,10 @@
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
+#include <chrono>
 #include <fstream>
+#include <system_error>
+#include <thread>
 #include <miral/x11_support.h>
 
 using namespace testing;
@@ -72,6 +76,30 @@ struct ExternalClient : miral::TestServer
         return result;
     }
     
+    /// Apps launched from the helper aren't our children, so can't be waited for: poll for their output instead
+    auto helper_client_env_value(std::string const& key) const -> std::string
+    {
+        unlink(output.c_str());
+
+        // Written to one side and moved into place, so the output is never seen half written
+        auto const partial = output + ".partial";
+        auto const client_pid = external_client.launch(
+            {"bash", "-c", "echo ${" + key + ":-(unset)} >" + partial + " && mv " + partial + " " + output});
+        EXPECT_THAT(client_pid, Gt(0));
+
+        for (auto retries = 0; retries != 100; ++retries)
+        {
+            std::ifstream in{output};
+            std::string result;
+            if (getline(in, result))
+                return result;
+
+            std::this_thread::sleep_for(std::chrono::milliseconds{50});
+        }
+
+        return "(no output)";
+    }
+
     bool cannot_start_X_server()
     {
         // Starting an X server on LP builder, or Fedora CI, doesn't work
@@ -80,6 +108,7 @@ struct ExternalClient : miral::TestServer
 };
 
 auto const app_env = "MIR_SERVER_APP_ENV";
+auto const app_launch_helper = "MIR_SERVER_APP_LAUNCH_HELPER";
 auto const app_x11_env = "MIR_SERVER_APP_ENV_X11";
 }
 
@@ -233,3 +262,56 @@ TEST_F(ExternalClient, another_strange_override_does_nothing)
     EXPECT_THAT(client_env_x11_value("NO_AT_BRIDGE"), StrEq("1"));
     EXPECT_THAT(client_env_x11_value("_JAVA_AWT_WM_NONREPARENTING"), StrEq("1"));
 }
+
+TEST_F(ExternalClient, app_launched_from_helper_gets_the_app_env)
+{
+    if (getenv("XDG_RUNTIME_DIR") == nullptr)
+        add_to_environment("XDG_RUNTIME_DIR", "/tmp");
+
+    // Both would be inherited by the app if the helper didn't apply the app environment
+    add_to_environment("DISPLAY", ":42");
+    add_to_environment("GTK_MODULES", "stray-module");
+
+    add_to_environment(app_env, "GDK_BACKEND=mir:-GTK_MODULES");
+    add_to_environment(app_launch_helper, "on");
+    start_server();
+
+    mir::optional_value<std::string> wayland_display;
+    invoke_runner([&](miral::MirRunner& runner) { wayland_display = runner.wayland_display(); });
+
+    ASSERT_TRUE(wayland_display.is_set());
+    EXPECT_THAT(helper_client_env_value("WAYLAND_DISPLAY"), StrEq(wayland_display.value()));
+    EXPECT_THAT(helper_client_env_value("DISPLAY"), StrEq("(unset)"));
+    EXPECT_THAT(helper_client_env_value("GDK_BACKEND"), StrEq("mir"));
+    EXPECT_THAT(helper_client_env_value("GTK_MODULES"), StrEq("(unset)"));
+}
+
+TEST_F(ExternalClient, app_launched_from_helper_has_a_pid)
+{
+    if (getenv("XDG_RUNTIME_DIR") == nullptr)
+        add_to_environment("XDG_RUNTIME_DIR", "/tmp");
+
+    add_to_environment(app_launch_helper, "on");
+    start_server();
+
+    EXPECT_THAT(external_client.launch({"true"}), Gt(0));
+}
+
+TEST_F(ExternalClient, launching_nothing_from_helper_fails_with_einval)
+{
+    if (getenv("XDG_RUNTIME_DIR") == nullptr)
+        add_to_environment("XDG_RUNTIME_DIR", "/tmp");
+
+    add_to_environment(app_launch_helper, "on");
+    start_server();
+
+    try
+    {
+        external_client.launch({});
+        FAIL() << "Launching an empty command line should fail";
+    }
+    catch (std::system_error const& error)
+    {
+        EXPECT_THAT(error.code().value(), Eq(EINVAL));
+    }
+}
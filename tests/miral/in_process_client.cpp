@@ -0,0 +1,135 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <miral/test_server.h>
+
+#include <miral/internal_client.h>
+#include <miral/window_info.h>
+#include <miral/window_manager_tools.h>
+
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+using mir::geometry::Size;
+
+namespace
+{
+Size const panel_size{320, 24};
+
+struct InProcessClient : miral::TestServer
+{
+    InProcessClient()
+    {
+        add_server_init(launcher);
+    }
+
+    // Runs code on the client thread, then keeps the session open until the server stops
+    void run_in_process(std::function<void(miral::InProcessClient& client)>&& code)
+    {
+        bool client_run = false;
+        std::condition_variable cv;
+        std::mutex mutex;
+
+        launcher.run_in_process("in-process client", [&, code](miral::InProcessClient& client)
+            {
+                code(client);
+                {
+                    std::lock_guard<decltype(mutex)> lock{mutex};
+                    client_run = true;
+                    cv.notify_one();
+                }
+                while (client.wait_for(std::chrono::milliseconds{100}))
+                    ;
+            });
+
+        std::unique_lock<decltype(mutex)> lock{mutex};
+        cv.wait(lock, [&]{ return client_run; });
+    }
+
+    static auto panel_spec() -> miral::WindowSpecification
+    {
+        miral::WindowSpecification spec;
+        spec.name() = "panel";
+        spec.size() = panel_size;
+        return spec;
+    }
+
+    static void clear(miral::InProcessSurface::Pixels const& pixels)
+    {
+        for (auto row = 0; row != pixels.size.height.as_int(); ++row)
+            memset(pixels.data + row*pixels.stride.as_int(), 0, pixels.size.width.as_int()*4);
+    }
+
+    miral::InternalClientLauncher launcher;
+};
+}
+
+TEST_F(InProcessClient, surface_is_a_window_of_the_clients_session)
+{
+    run_in_process([this](miral::InProcessClient& client)
+        {
+            miral::InProcessSurface surface{client, panel_spec(), mir_pixel_format_argb_8888};
+            surface.draw(panel_size, &clear);
+
+            auto const window = surface.window();
+            ASSERT_TRUE(window);
+            EXPECT_THAT(window.application(), Eq(client.session()));
+
+            invoke_tools([&](miral::WindowManagerTools& tools)
+                {
+                    EXPECT_THAT(tools.info_for(window).name(), Eq("panel"));
+                });
+        });
+}
+
+TEST_F(InProcessClient, draws_into_a_buffer_of_the_requested_size)
+{
+    run_in_process([](miral::InProcessClient& client)
+        {
+            miral::InProcessSurface surface{client, panel_spec(), mir_pixel_format_argb_8888};
+
+            bool painted = false;
+            surface.draw(panel_size, [&](miral::InProcessSurface::Pixels const& pixels)
+                {
+                    EXPECT_THAT(pixels.size, Eq(panel_size));
+                    EXPECT_THAT(pixels.format, Eq(mir_pixel_format_argb_8888));
+                    EXPECT_THAT(pixels.stride.as_int(), Ge(panel_size.width.as_int()*4));
+                    clear(pixels);
+                    painted = true;
+                });
+
+            EXPECT_TRUE(painted);
+        });
+}
+
+TEST_F(InProcessClient, drawing_at_a_new_size_resizes_the_window)
+{
+    Size const new_size{480, 32};
+
+    run_in_process([&](miral::InProcessClient& client)
+        {
+            miral::InProcessSurface surface{client, panel_spec(), mir_pixel_format_argb_8888};
+            surface.draw(panel_size, &clear);
+            surface.draw(new_size, &clear);
+
+            EXPECT_THAT(surface.window().size(), Eq(new_size));
+        });
+}
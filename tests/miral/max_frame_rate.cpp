@@ -0,0 +1,91 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_window_manager_tools.h"
+
+using namespace miral;
+using namespace testing;
+namespace mt = mir::test;
+
+namespace
+{
+Rectangle const display_area{{0, 0}, {1280, 720}};
+
+struct MaxFrameRate : mt::TestWindowManagerTools
+{
+    void SetUp() override
+    {
+        notify_configuration_applied(create_fake_display_configuration({display_area}));
+        basic_window_manager.add_session(session);
+
+        EXPECT_CALL(*window_manager_policy, advise_new_window(_))
+            .WillOnce(Invoke([this](WindowInfo const& window_info) { window = window_info.window(); }));
+
+        basic_window_manager.add_surface(session, mir::scene::SurfaceCreationParameters{}, &create_surface);
+        Mock::VerifyAndClearExpectations(window_manager_policy);
+
+        surface = window;
+    }
+
+    Window window;
+    std::shared_ptr<mir::scene::Surface> surface;
+};
+}
+
+TEST_F(MaxFrameRate, windows_are_not_limited_by_default)
+{
+    ASSERT_THAT(surface, NotNull());
+    EXPECT_THAT(surface->max_frame_rate(), Eq(0));
+}
+
+TEST_F(MaxFrameRate, modify_window_limits_the_surface)
+{
+    WindowSpecification mods;
+    mods.max_frame_rate() = 15;
+    basic_window_manager.modify_window(basic_window_manager.info_for(window), mods);
+
+    EXPECT_THAT(surface->max_frame_rate(), Eq(15));
+}
+
+TEST_F(MaxFrameRate, modify_window_without_a_rate_keeps_the_limit)
+{
+    {
+        WindowSpecification mods;
+        mods.max_frame_rate() = 1;
+        basic_window_manager.modify_window(basic_window_manager.info_for(window), mods);
+    }
+
+    WindowSpecification mods;
+    mods.name() = "renamed";
+    basic_window_manager.modify_window(basic_window_manager.info_for(window), mods);
+
+    EXPECT_THAT(surface->max_frame_rate(), Eq(1));
+}
+
+TEST_F(MaxFrameRate, a_zero_rate_lifts_the_limit)
+{
+    {
+        WindowSpecification mods;
+        mods.max_frame_rate() = 1;
+        basic_window_manager.modify_window(basic_window_manager.info_for(window), mods);
+    }
+
+    WindowSpecification mods;
+    mods.max_frame_rate() = 0;
+    basic_window_manager.modify_window(basic_window_manager.info_for(window), mods);
+
+    EXPECT_THAT(surface->max_frame_rate(), Eq(0));
+}
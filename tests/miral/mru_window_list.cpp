@@ -142,6 +142,21 @@ TEST_F(MRUWindowList, after_multiple_pushes_windows_are_enumerated_in_mru_order)
     EXPECT_THAT(as_enumerated, ElementsAre(window_a, window_b, window_c));
 }
 
+TEST_F(MRUWindowList, erasing_a_window_leaves_the_others_in_mru_order)
+{
+    mru_list.push(window_a);
+    mru_list.push(window_b);
+    mru_list.push(window_c);
+    mru_list.erase(window_b);
+
+    std::vector<miral::Window> as_enumerated;
+
+    mru_list.enumerate([&](miral::Window& window)
+       { as_enumerated.push_back(window); return true; });
+
+    EXPECT_THAT(as_enumerated, ElementsAre(window_c, window_a));
+}
+
 TEST_F(MRUWindowList, when_enumerator_returns_false_enumeration_is_short_circuited)
 {
     mru_list.push(window_a);
@@ -0,0 +1,123 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_window_manager_tools.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace miral;
+using namespace testing;
+namespace mt = mir::test;
+using namespace std::chrono_literals;
+
+namespace
+{
+Rectangle const display_area{{0, 0}, {640, 480}};
+
+struct SharedLockQueries : mt::TestWindowManagerTools
+{
+    void SetUp() override
+    {
+        notify_configuration_applied(create_fake_display_configuration({display_area}));
+        basic_window_manager.add_session(session);
+    }
+
+    auto create_window() -> Window
+    {
+        Window window;
+
+        mir::scene::SurfaceCreationParameters creation_parameters;
+        creation_parameters.type = mir_window_type_normal;
+        creation_parameters.size = Size{200, 200};
+
+        EXPECT_CALL(*window_manager_policy, advise_new_window(_))
+            .WillOnce([&window](WindowInfo const& window_info) { window = window_info.window(); });
+
+        basic_window_manager.add_surface(session, creation_parameters, &create_surface);
+        basic_window_manager.select_active_window(window);
+
+        return window;
+    }
+};
+}
+
+TEST_F(SharedLockQueries, can_query_the_model)
+{
+    auto const window = create_window();
+
+    Window active;
+    unsigned applications{0};
+    window_manager_tools.invoke_under_shared_lock([&]
+        {
+            active = window_manager_tools.active_window();
+            applications = window_manager_tools.count_applications();
+        });
+
+    EXPECT_THAT(active, Eq(window));
+    EXPECT_THAT(applications, Eq(1u));
+}
+
+TEST_F(SharedLockQueries, queries_do_not_wait_for_one_another)
+{
+    std::atomic<int> inside{0};
+
+    // Each query waits (for a while) until the other is also inside
+    auto const query = [&]
+        {
+            bool met{false};
+            window_manager_tools.invoke_under_shared_lock([&]
+                {
+                    ++inside;
+                    auto const deadline = std::chrono::steady_clock::now() + 5s;
+                    while (inside < 2 && std::chrono::steady_clock::now() < deadline)
+                        std::this_thread::yield();
+                    met = inside == 2;
+                });
+            return met;
+        };
+
+    bool other_met{false};
+    std::thread other{[&] { other_met = query(); }};
+    auto const met = query();
+    other.join();
+
+    EXPECT_TRUE(met);
+    EXPECT_TRUE(other_met);
+}
+
+TEST_F(SharedLockQueries, queries_wait_for_updates)
+{
+    std::atomic<bool> updating{false};
+    std::atomic<bool> queried_during_update{false};
+    std::thread query;
+
+    window_manager_tools.invoke_under_lock([&]
+        {
+            updating = true;
+            query = std::thread{[&]
+                {
+                    window_manager_tools.invoke_under_shared_lock([&] { queried_during_update = updating.load(); });
+                }};
+            std::this_thread::sleep_for(20ms);
+            updating = false;
+        });
+
+    query.join();
+
+    EXPECT_FALSE(queried_during_update);
+}
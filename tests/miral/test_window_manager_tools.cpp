@@ -57,6 +57,10 @@ struct StubFocusController : mir::shell::FocusController
 
     void raise(mir::shell::SurfaceSet const& /*windows*/) override {}
 
+    void begin_transaction() override {}
+
+    void end_transaction() override {}
+
     virtual auto surface_at(mir::geometry::Point /*cursor*/) const -> std::shared_ptr<mir::scene::Surface> override
         { return {}; }
 
@@ -120,6 +124,9 @@ struct StubSurface : mir::test::doubles::StubSurface
     auto depth_layer() const -> MirDepthLayer override { return depth_layer_; }
     void set_depth_layer(MirDepthLayer depth_layer) override { depth_layer_ = depth_layer; }
 
+    void set_max_frame_rate(float frames_per_second) override { max_frame_rate_ = frames_per_second; }
+    float max_frame_rate() const override { return max_frame_rate_; }
+
     mir::geometry::Displacement content_offset() const override { return content_offset_; }
     mir::geometry::Size content_size() const override
     {
@@ -141,6 +148,7 @@ struct StubSurface : mir::test::doubles::StubSurface
     mir::geometry::Size size_;
     MirWindowState state_ = mir_window_state_restored;
     MirDepthLayer depth_layer_;
+    float max_frame_rate_ = 0;
     mir::geometry::Displacement content_offset_;
     mir::geometry::Displacement content_size_offset;
 };
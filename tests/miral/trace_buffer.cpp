@@ -0,0 +1,109 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "trace_buffer.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <string>
+#include <vector>
+
+using namespace testing;
+
+namespace
+{
+struct TraceBuffer : Test
+{
+    miral::TraceBuffer buffer{3};
+
+    void record(std::string const& entry)
+    {
+        buffer.record([entry] { return entry; });
+    }
+
+    /// The entries dumped, without the age they are prefixed with
+    auto dump() -> std::vector<std::string>
+    {
+        std::vector<std::string> lines;
+        buffer.dump([&](std::string const& line) { lines.push_back(line.substr(line.find("] ") + 2)); });
+        return lines;
+    }
+};
+}
+
+TEST_F(TraceBuffer, dumps_entries_oldest_first)
+{
+    record("one");
+    record("two");
+
+    EXPECT_THAT(dump(), ElementsAre("one", "two"));
+}
+
+TEST_F(TraceBuffer, keeps_only_the_most_recent_entries)
+{
+    record("one");
+    record("two");
+    record("three");
+    record("four");
+    record("five");
+
+    EXPECT_THAT(dump(), ElementsAre("three", "four", "five"));
+}
+
+TEST_F(TraceBuffer, formats_entries_only_when_dumped)
+{
+    int formatted{0};
+    buffer.record([&] { ++formatted; return std::string{"entry"}; });
+
+    EXPECT_THAT(formatted, Eq(0));
+
+    dump();
+
+    EXPECT_THAT(formatted, Eq(1));
+}
+
+TEST_F(TraceBuffer, entries_overwritten_are_never_formatted)
+{
+    int formatted{0};
+    buffer.record([&] { ++formatted; return std::string{"entry"}; });
+    record("two");
+    record("three");
+    record("four");
+
+    dump();
+
+    EXPECT_THAT(formatted, Eq(0));
+}
+
+TEST_F(TraceBuffer, dumping_forgets_the_entries)
+{
+    record("one");
+    dump();
+    record("two");
+
+    EXPECT_THAT(dump(), ElementsAre("two"));
+}
+
+TEST_F(TraceBuffer, entries_are_prefixed_with_their_age)
+{
+    record("one");
+
+    std::vector<std::string> lines;
+    buffer.dump([&](std::string const& line) { lines.push_back(line); });
+
+    EXPECT_THAT(lines, ElementsAre(MatchesRegex("\\[-[0-9.]+ms\\] one")));
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "weak_ptr_map.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <string>
+#include <vector>
+
+using namespace testing;
+
+namespace
+{
+struct WeakPtrMap : Test
+{
+    miral::WeakPtrMap<int, std::string> map;
+    std::shared_ptr<int> const one{std::make_shared<int>(1)};
+    std::shared_ptr<int> const two{std::make_shared<int>(2)};
+};
+}
+
+TEST_F(WeakPtrMap, finds_entries_by_key)
+{
+    map.emplace(one, "one");
+    map.emplace(two, "two");
+
+    EXPECT_THAT(map.at(one), Eq("one"));
+    EXPECT_THAT(map.at(two), Eq("two"));
+    EXPECT_THAT(map.size(), Eq(2u));
+}
+
+TEST_F(WeakPtrMap, does_not_find_other_keys)
+{
+    map.emplace(one, "one");
+
+    EXPECT_THAT(map.find(two), Eq(map.end()));
+    EXPECT_THAT(map.find(std::weak_ptr<int>{}), Eq(map.end()));
+    EXPECT_THROW(map.at(two), std::out_of_range);
+}
+
+TEST_F(WeakPtrMap, emplace_keeps_an_existing_entry)
+{
+    map.emplace(one, "one");
+
+    auto const result = map.emplace(one, "uno");
+
+    EXPECT_FALSE(result.second);
+    EXPECT_THAT(map.at(one), Eq("one"));
+}
+
+TEST_F(WeakPtrMap, finds_entries_whose_key_has_expired)
+{
+    auto three = std::make_shared<int>(3);
+    std::weak_ptr<int> const key{three};
+    map.emplace(one, "one");
+    map.emplace(three, "three");
+    three.reset();
+
+    EXPECT_THAT(map.at(key), Eq("three"));
+    EXPECT_THAT(map.erase(key), Eq(1u));
+    EXPECT_THAT(map.size(), Eq(1u));
+}
+
+TEST_F(WeakPtrMap, keys_sharing_an_address_are_kept_apart)
+{
+    // Different owners of the same address, as when memory is reused for an object that isn't yet erased
+    std::shared_ptr<int> const alias{two, one.get()};
+    map.emplace(one, "one");
+    map.emplace(alias, "alias");
+
+    EXPECT_THAT(map.at(one), Eq("one"));
+    EXPECT_THAT(map.at(alias), Eq("alias"));
+
+    map.erase(one);
+
+    EXPECT_THAT(map.find(one), Eq(map.end()));
+    EXPECT_THAT(map.at(alias), Eq("alias"));
+}
+
+TEST_F(WeakPtrMap, references_remain_valid_as_entries_are_added)
+{
+    auto& first = map[one];
+    first = "one";
+
+    std::vector<std::shared_ptr<int>> others;
+    for (auto i = 0; i != 100; ++i)
+    {
+        others.push_back(std::make_shared<int>(i));
+        map.emplace(others.back(), std::to_string(i));
+    }
+
+    EXPECT_THAT(&map.at(one), Eq(&first));
+    EXPECT_THAT(first, Eq("one"));
+}
+
+TEST_F(WeakPtrMap, iterates_over_every_entry)
+{
+    map.emplace(one, "one");
+    map.emplace(two, "two");
+
+    std::vector<std::string> values;
+    for (auto const& entry : map)
+        values.push_back(entry.second);
+
+    EXPECT_THAT(values, UnorderedElementsAre("one", "two"));
+}
@@ -0,0 +1,199 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+extern "C"
+{
+#include "xcursor.h"
+}
+
+#include "mir/fd.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace testing;
+
+namespace
+{
+uint32_t const magic{0x72756358};   // "Xcur"
+uint32_t const file_header_len{16};
+uint32_t const image_type{0xfffd0002};
+uint32_t const image_header_len{36};
+
+/// An image chunk, as laid out in a cursor file
+struct Image
+{
+    uint32_t nominal_size;
+    uint32_t width;
+    uint32_t height;
+    uint32_t pixel;
+};
+
+/// Builds a cursor file a word at a time
+struct CursorFile
+{
+    std::vector<uint32_t> words;
+
+    /// A well formed file of images, with a table of contents entry for each
+    static auto of(std::vector<Image> const& images) -> CursorFile
+    {
+        CursorFile file;
+        file.words = {magic, file_header_len, 0x10000, static_cast<uint32_t>(images.size())};
+
+        auto position = file_header_len + images.size() * 3 * 4;
+        for (auto const& image : images)
+        {
+            file.words.insert(file.words.end(), {image_type, image.nominal_size, static_cast<uint32_t>(position)});
+            position += image_header_len + image.width * image.height * 4;
+        }
+
+        for (auto const& image : images)
+        {
+            file.words.insert(file.words.end(), {image_header_len, image_type, image.nominal_size, 1});
+            file.words.insert(file.words.end(), {image.width, image.height, 0, 0, 50});
+            file.words.insert(file.words.end(), image.width * image.height, image.pixel);
+        }
+        return file;
+    }
+
+    auto bytes() const -> size_t { return words.size() * 4; }
+};
+
+struct XCursorFile : Test
+{
+    /// Writes contents to an anonymous file, and returns a path that opens it
+    auto path_of(CursorFile const& contents, size_t bytes) -> std::string
+    {
+        files.emplace_back(memfd_create("xcursor-test", MFD_CLOEXEC));
+        auto const& fd = files.back();
+        if (fd < 0 || write(fd, contents.words.data(), bytes) != static_cast<ssize_t>(bytes))
+            throw std::system_error{errno, std::system_category(), "Failed to write cursor file"};
+        return "/proc/self/fd/" + std::to_string(fd);
+    }
+
+    auto path_of(CursorFile const& contents) -> std::string
+    {
+        return path_of(contents, contents.bytes());
+    }
+
+    static auto load(std::string const& path, int size) -> std::unique_ptr<XcursorImages, void(*)(XcursorImages*)>
+    {
+        return {xcursor_load_file(path.c_str(), size), &XcursorImagesDestroy};
+    }
+
+    std::vector<mir::Fd> files;
+};
+}
+
+TEST_F(XCursorFile, loads_the_images_of_the_nearest_size)
+{
+    auto const path = path_of(CursorFile::of({{24, 24, 24, 0xff000001}, {32, 32, 32, 0xff000002}, {32, 32, 32, 0xff000003}}));
+
+    auto const images = load(path, 30);
+
+    ASSERT_THAT(images, NotNull());
+    ASSERT_THAT(images->nimage, Eq(2));
+    EXPECT_THAT(images->images[0]->size, Eq(32u));
+    EXPECT_THAT(images->images[0]->width, Eq(32u));
+    EXPECT_THAT(images->images[0]->pixels[0], Eq(0xff000002u));
+    EXPECT_THAT(images->images[1]->pixels[32 * 32 - 1], Eq(0xff000003u));
+}
+
+TEST_F(XCursorFile, missing_file_loads_nothing)
+{
+    EXPECT_THAT(load("/proc/self/fd/-1", 24), IsNull());
+}
+
+TEST_F(XCursorFile, empty_file_loads_nothing)
+{
+    EXPECT_THAT(load(path_of(CursorFile{}), 24), IsNull());
+}
+
+TEST_F(XCursorFile, file_truncated_in_its_pixels_loads_nothing)
+{
+    auto const file = CursorFile::of({{24, 24, 24, 0xff000001}});
+
+    EXPECT_THAT(load(path_of(file, file.bytes() - 4), 24), IsNull());
+    EXPECT_THAT(load(path_of(file, file.bytes() / 2), 24), IsNull());
+}
+
+TEST_F(XCursorFile, file_truncated_in_its_table_of_contents_loads_nothing)
+{
+    auto const file = CursorFile::of({{24, 24, 24, 0xff000001}, {32, 32, 32, 0xff000002}});
+
+    EXPECT_THAT(load(path_of(file, file_header_len + 3 * 4 + 2), 24), IsNull());
+}
+
+TEST_F(XCursorFile, file_truncated_after_the_images_of_the_size_asked_for_still_loads_them)
+{
+    auto const file = CursorFile::of({{24, 24, 24, 0xff000001}, {32, 32, 32, 0xff000002}});
+
+    auto const images = load(path_of(file, file.bytes() - 4), 24);
+
+    ASSERT_THAT(images, NotNull());
+    EXPECT_THAT(images->nimage, Eq(1));
+}
+
+TEST_F(XCursorFile, table_of_contents_pointing_past_the_end_loads_nothing)
+{
+    auto file = CursorFile::of({{24, 24, 24, 0xff000001}});
+    file.words[6] = static_cast<uint32_t>(file.bytes() + 4096);
+
+    EXPECT_THAT(load(path_of(file), 24), IsNull());
+}
+
+TEST_F(XCursorFile, more_table_of_contents_entries_than_the_file_holds_loads_nothing)
+{
+    auto file = CursorFile::of({{24, 24, 24, 0xff000001}});
+    file.words[3] = 0x10000;
+
+    EXPECT_THAT(load(path_of(file), 24), IsNull());
+}
+
+TEST_F(XCursorFile, header_shorter_than_a_header_loads_nothing)
+{
+    auto file = CursorFile::of({{24, 24, 24, 0xff000001}});
+    file.words[1] = 4;
+
+    EXPECT_THAT(load(path_of(file), 24), IsNull());
+}
+
+TEST_F(XCursorFile, image_larger_than_the_file_loads_nothing)
+{
+    auto file = CursorFile::of({{24, 24, 24, 0xff000001}});
+    auto const image_header = file_header_len / 4 + 3;
+    file.words[image_header + 4] = 0xffff;  // width
+    file.words[image_header + 5] = 0xffff;  // height
+
+    EXPECT_THAT(load(path_of(file), 24), IsNull());
+}
+
+TEST_F(XCursorFile, bad_magic_loads_nothing)
+{
+    auto file = CursorFile::of({{24, 24, 24, 0xff000001}});
+    file.words[0] = 0;
+
+    EXPECT_THAT(load(path_of(file), 24), IsNull());
+}
@@ -467,6 +467,11 @@ void basic_software_buffer_drawing(
             return mir::geometry::Rectangle{top_left, buffer()->size()};
         }
 
+        auto src_bounds() const -> mir::geometry::RectangleF override
+        {
+            return {{}, mir::geometry::SizeF{buffer()->size()}};
+        }
+
         auto alpha() const -> float override
         {
             return 1.0f;
@@ -492,6 +497,21 @@ void basic_software_buffer_drawing(
             return 0;
         }
 
+        bool tearing_allowed() const override
+        {
+            return false;
+        }
+
+        auto damage() const -> std::experimental::optional<mir::geometry::Rectangles> override
+        {
+            return mir::geometry::Rectangles{};
+        }
+
+        auto opaque_region() const -> mir::geometry::Rectangles override
+        {
+            return {};
+        }
+
         void set_position(mir::geometry::Point top_left)
         {
             this->top_left = top_left;
@@ -0,0 +1,187 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/client/mir_event_distributor.h"
+
+#include "mir/events/event_builders.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace mev = mir::events;
+
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+struct EventDistributor : Test
+{
+    MirEventDistributor distributor;
+    mir::EventUPtr const event = mev::make_event(mir_prompt_session_state_started);
+};
+}
+
+TEST_F(EventDistributor, registered_handlers_receive_each_event)
+{
+    int first_calls{0}, second_calls{0};
+    distributor.register_event_handler([&](MirEvent const& e) { EXPECT_THAT(&e, Eq(event.get())); ++first_calls; });
+    distributor.register_event_handler([&](MirEvent const&) { ++second_calls; });
+
+    distributor.handle_event(*event);
+    distributor.handle_event(*event);
+
+    EXPECT_THAT(first_calls, Eq(2));
+    EXPECT_THAT(second_calls, Eq(2));
+}
+
+TEST_F(EventDistributor, unregistered_handler_is_not_called)
+{
+    int calls{0};
+    auto const id = distributor.register_event_handler([&](MirEvent const&) { ++calls; });
+
+    distributor.unregister_event_handler(id);
+    distributor.handle_event(*event);
+
+    EXPECT_THAT(calls, Eq(0));
+}
+
+TEST_F(EventDistributor, handler_can_unregister_itself)
+{
+    int calls{0};
+    int id{0};
+    id = distributor.register_event_handler(
+        [&](MirEvent const&)
+        {
+            ++calls;
+            distributor.unregister_event_handler(id);
+        });
+
+    distributor.handle_event(*event);
+    distributor.handle_event(*event);
+
+    EXPECT_THAT(calls, Eq(1));
+}
+
+TEST_F(EventDistributor, handler_unregistered_by_an_earlier_one_is_skipped)
+{
+    int later_calls{0};
+    int later_id{0};
+    distributor.register_event_handler([&](MirEvent const&) { distributor.unregister_event_handler(later_id); });
+    later_id = distributor.register_event_handler([&](MirEvent const&) { ++later_calls; });
+
+    distributor.handle_event(*event);
+
+    EXPECT_THAT(later_calls, Eq(0));
+}
+
+TEST_F(EventDistributor, handler_registered_by_a_handler_gets_the_next_event)
+{
+    int added_calls{0};
+    auto registered = false;
+    distributor.register_event_handler(
+        [&](MirEvent const&)
+        {
+            if (!registered)
+            {
+                registered = true;
+                distributor.register_event_handler([&](MirEvent const&) { ++added_calls; });
+            }
+        });
+
+    distributor.handle_event(*event);
+    EXPECT_THAT(added_calls, Eq(0));
+
+    distributor.handle_event(*event);
+    EXPECT_THAT(added_calls, Eq(1));
+}
+
+TEST_F(EventDistributor, registering_does_not_wait_for_a_handler_in_progress)
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool handling{false}, release{false};
+
+    distributor.register_event_handler(
+        [&](MirEvent const&)
+        {
+            std::unique_lock<std::mutex> lock{mutex};
+            handling = true;
+            cv.notify_all();
+            cv.wait(lock, [&] { return release; });
+        });
+
+    std::thread dispatcher{[&] { distributor.handle_event(*event); }};
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        ASSERT_TRUE(cv.wait_for(lock, 10s, [&] { return handling; }));
+    }
+
+    // The handler is still running on the other thread
+    distributor.register_event_handler([](MirEvent const&) {});
+
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        release = true;
+    }
+    cv.notify_all();
+    dispatcher.join();
+}
+
+TEST_F(EventDistributor, unregistering_waits_for_a_call_in_progress)
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool handling{false};
+    std::atomic<bool> finished{false};
+    std::atomic<bool> called_after_unregister{false};
+    std::atomic<bool> unregistered{false};
+
+    auto const id = distributor.register_event_handler(
+        [&](MirEvent const&)
+        {
+            if (unregistered)
+                called_after_unregister = true;
+
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                handling = true;
+            }
+            cv.notify_all();
+            std::this_thread::sleep_for(50ms);
+            finished = true;
+        });
+
+    std::thread dispatcher{[&] { distributor.handle_event(*event); }};
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        ASSERT_TRUE(cv.wait_for(lock, 10s, [&] { return handling; }));
+    }
+
+    distributor.unregister_event_handler(id);
+    unregistered = true;
+    EXPECT_TRUE(finished);
+
+    dispatcher.join();
+    distributor.handle_event(*event);
+    EXPECT_FALSE(called_after_unregister);
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/compositor/buffer_release_thread.h"
+
+#include "mir/test/doubles/stub_renderable.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <chrono>
+#include <future>
+#include <thread>
+
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+namespace mtd = mir::test::doubles;
+using namespace std::chrono_literals;
+using namespace testing;
+
+namespace
+{
+struct ReleaseRecordingRenderable : mtd::StubRenderable
+{
+    explicit ReleaseRecordingRenderable(std::promise<std::thread::id>& released) :
+        released{released}
+    {
+    }
+
+    ~ReleaseRecordingRenderable()
+    {
+        released.set_value(std::this_thread::get_id());
+    }
+
+    std::promise<std::thread::id>& released;
+};
+}
+
+TEST(BufferReleaseThread, releases_renderables_on_its_own_thread)
+{
+    std::promise<std::thread::id> released;
+    auto released_on = released.get_future();
+    mc::BufferReleaseThread release_thread;
+
+    mg::RenderableList renderables{std::make_shared<ReleaseRecordingRenderable>(released)};
+    release_thread.release(std::move(renderables));
+
+    ASSERT_THAT(released_on.wait_for(10s), Eq(std::future_status::ready));
+    EXPECT_THAT(released_on.get(), Ne(std::this_thread::get_id()));
+}
+
+TEST(BufferReleaseThread, releases_everything_handed_over_before_destruction)
+{
+    std::vector<std::weak_ptr<mg::Renderable>> handed_over;
+
+    {
+        mc::BufferReleaseThread release_thread;
+
+        for (auto i = 0; i != 100; ++i)
+        {
+            auto const renderable = std::make_shared<mtd::StubRenderable>();
+            handed_over.push_back(renderable);
+            release_thread.release({renderable});
+        }
+    }
+
+    for (auto const& renderable : handed_over)
+        EXPECT_TRUE(renderable.expired());
+}
+
+TEST(BufferReleaseThread, releases_renderables_handed_over_from_several_threads)
+{
+    std::vector<std::promise<std::thread::id>> released(4);
+    mc::BufferReleaseThread release_thread;
+    std::vector<std::thread> compositors;
+
+    for (auto& promise : released)
+    {
+        compositors.emplace_back(
+            [&release_thread, &promise]
+            {
+                mg::RenderableList renderables{std::make_shared<ReleaseRecordingRenderable>(promise)};
+                release_thread.release(std::move(renderables));
+            });
+    }
+
+    for (auto& compositor : compositors)
+        compositor.join();
+
+    for (auto& promise : released)
+        EXPECT_THAT(promise.get_future().wait_for(10s), Eq(std::future_status::ready));
+}
@@ -20,8 +20,10 @@
 #include "mir/compositor/display_buffer_compositor.h"
 #include "src/server/report/null_report_factory.h"
 #include "mir/compositor/scene.h"
+#include "mir/compositor/screen_capture.h"
 #include "mir/renderer/renderer.h"
 #include "mir/geometry/rectangle.h"
+#include "mir/graphics/frame.h"
 #include "mir/test/doubles/mock_renderer.h"
 #include "mir/test/fake_shared.h"
 #include "mir/test/gmock_fixes.h"
@@ -73,6 +75,15 @@ struct StubSceneElement : mc::SceneElement
     {
     }
 
+    void scanned_out() override
+    {
+    }
+
+    auto presentation_callback() -> PresentationCallback override
+    {
+        return {};
+    }
+
 private:
     std::shared_ptr<mg::Renderable> const renderable_;
 };
@@ -156,6 +167,26 @@ TEST_F(DefaultDisplayBufferCompositor, optimization_skips_composition)
     compositor.composite(make_scene_elements({}));
 }
 
+TEST_F(DefaultDisplayBufferCompositor, renders_frames_that_are_being_captured)
+{
+    using namespace testing;
+    auto const screen_capture = std::make_shared<mc::ScreenCapture>([]{});
+    auto const request = screen_capture->capture(screen, false, [](auto const&){});
+
+    EXPECT_CALL(display_buffer, overlay(_))
+        .Times(0);
+    InSequence seq;
+    EXPECT_CALL(mock_renderer, read_next_frame(screen, _));
+    EXPECT_CALL(mock_renderer, render(_));
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report(),
+        screen_capture);
+    compositor.composite(make_scene_elements({fullscreen}));
+}
+
 TEST_F(DefaultDisplayBufferCompositor, rendering_reports_everything)
 {
     using namespace testing;
@@ -184,6 +215,26 @@ TEST_F(DefaultDisplayBufferCompositor, rendering_reports_everything)
     compositor.composite(make_scene_elements({}));
 }
 
+TEST_F(DefaultDisplayBufferCompositor, reports_gpu_render_time_when_the_renderer_measures_it)
+{
+    using namespace testing;
+    auto report = std::make_shared<NiceMock<mtd::MockCompositorReport>>();
+    std::chrono::nanoseconds const gpu_time{std::chrono::milliseconds{3}};
+
+    EXPECT_CALL(mock_renderer, gpu_render_time())
+        .WillOnce(Return(std::experimental::optional<std::chrono::nanoseconds>{}))
+        .WillOnce(Return(std::experimental::optional<std::chrono::nanoseconds>{gpu_time}));
+    EXPECT_CALL(*report, measured_gpu_render_time(_, gpu_time))
+        .Times(1);
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        report);
+    compositor.composite(make_scene_elements({}));
+    compositor.composite(make_scene_elements({}));
+}
+
 TEST_F(DefaultDisplayBufferCompositor, calls_renderer_in_sequence)
 {
     using namespace testing;
@@ -342,6 +393,8 @@ struct MockSceneElement : mc::SceneElement
     MOCK_CONST_METHOD0(renderable, std::shared_ptr<mir::graphics::Renderable>());
     MOCK_METHOD0(rendered, void());
     MOCK_METHOD0(occluded, void());
+    MOCK_METHOD0(scanned_out, void());
+    MOCK_METHOD0(presentation_callback, PresentationCallback());
 };
 }
 
@@ -388,3 +441,128 @@ TEST_F(DefaultDisplayBufferCompositor, marks_occluded_scene_elements)
     compositor.composite({element0_occluded, element1_rendered, element2_occluded});
 }
 
+TEST_F(DefaultDisplayBufferCompositor, marks_scene_elements_the_display_buffer_takes_as_scanned_out)
+{
+    using namespace testing;
+
+    auto const overlaid = std::make_shared<mtd::FakeRenderable>(geom::Rectangle{{10,10},{20,20}});
+    auto element0_composited = std::make_shared<NiceMock<MockSceneElement>>(
+        std::make_shared<mtd::FakeRenderable>(geom::Rectangle{{0,0},{100,100}}));
+    auto element1_overlaid = std::make_shared<NiceMock<MockSceneElement>>(overlaid);
+
+    ON_CALL(display_buffer, overlay(_))
+        .WillByDefault(Invoke([&](mg::RenderableList& renderables)
+            {
+                renderables.erase(std::remove(begin(renderables), end(renderables), overlaid), end(renderables));
+                return false;
+            }));
+
+    EXPECT_CALL(*element0_composited, scanned_out()).Times(0);
+    EXPECT_CALL(*element1_overlaid, scanned_out());
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+
+    compositor.composite({element0_composited, element1_overlaid});
+}
+
+
+TEST_F(DefaultDisplayBufferCompositor, does_not_limit_damage_of_first_frame)
+{
+    using namespace testing;
+    EXPECT_CALL(mock_renderer, set_damage(_))
+        .Times(0);
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+
+    compositor.composite(make_scene_elements({big, small}));
+}
+
+TEST_F(DefaultDisplayBufferCompositor, damages_nothing_when_nothing_changed)
+{
+    using namespace testing;
+    EXPECT_CALL(mock_renderer, set_damage(Eq(geom::Rectangles{})))
+        .Times(1);
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+
+    compositor.composite(make_scene_elements({big, small}));
+    compositor.composite(make_scene_elements({big, small}));
+}
+
+TEST_F(DefaultDisplayBufferCompositor, damages_area_of_added_and_removed_renderables)
+{
+    using namespace testing;
+    EXPECT_CALL(mock_renderer, set_damage(Eq(geom::Rectangles{big->screen_position(), small->screen_position()})))
+        .Times(1);
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+
+    compositor.composite(make_scene_elements({big}));
+    compositor.composite(make_scene_elements({small}));
+}
+
+TEST_F(DefaultDisplayBufferCompositor, damages_buffer_damage_of_updated_renderable)
+{
+    using namespace testing;
+    geom::Rectangle const buffer_damage{{12, 22}, {5, 5}};
+    EXPECT_CALL(mock_renderer, set_damage(Eq(geom::Rectangles{buffer_damage})))
+        .Times(1);
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+
+    compositor.composite(make_scene_elements({small}));
+    small->set_buffer(std::make_shared<mtd::StubBuffer>());
+    small->set_damage(geom::Rectangles{buffer_damage});
+    compositor.composite(make_scene_elements({small}));
+}
+
+TEST_F(DefaultDisplayBufferCompositor, damages_whole_renderable_when_buffer_damage_is_unknown)
+{
+    using namespace testing;
+    EXPECT_CALL(mock_renderer, set_damage(Eq(geom::Rectangles{small->screen_position()})))
+        .Times(1);
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+
+    compositor.composite(make_scene_elements({small}));
+    small->set_buffer(std::make_shared<mtd::StubBuffer>());
+    compositor.composite(make_scene_elements({small}));
+}
+
+TEST_F(DefaultDisplayBufferCompositor, does_not_limit_damage_when_output_changes)
+{
+    using namespace testing;
+    geom::Rectangle const moved_screen{{1366, 0}, {1366, 768}};
+    EXPECT_CALL(display_buffer, view_area())
+        .WillOnce(Return(screen))
+        .WillOnce(Return(screen))
+        .WillRepeatedly(Return(moved_screen));
+    EXPECT_CALL(mock_renderer, set_damage(_))
+        .Times(0);
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+
+    compositor.composite(make_scene_elements({small}));
+    compositor.composite(make_scene_elements({small}));
+}
@@ -22,6 +22,9 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <atomic>
+#include <thread>
+
 using namespace testing;
 namespace mtd = mir::test::doubles;
 namespace mt = mir::test;
@@ -86,3 +89,34 @@ TEST_F(DroppingSchedule, queueing_same_buffer_many_times_doesnt_drop)
     ASSERT_THAT(queue, SizeIs(1));
     EXPECT_THAT(queue[0]->id(), Eq(buffers[2]->id()));
 }
+
+TEST_F(DroppingSchedule, consumer_sees_buffers_in_the_order_scheduled_while_producer_runs)
+{
+    int const submissions{10000};
+    std::vector<std::shared_ptr<mg::Buffer>> all_buffers;
+    for (auto i = 0; i != submissions; ++i)
+        all_buffers.emplace_back(std::make_shared<mtd::StubBuffer>());
+
+    std::atomic<bool> done{false};
+    std::thread producer{
+        [&]
+        {
+            for (auto const& buffer : all_buffers)
+                schedule.schedule(buffer);
+            done = true;
+        }};
+
+    std::vector<mg::BufferID> seen;
+    while (!done || schedule.num_scheduled())
+    {
+        if (schedule.num_scheduled())
+            seen.push_back(schedule.next_buffer()->id());
+    }
+    producer.join();
+
+    ASSERT_THAT(seen, Not(IsEmpty()));
+    EXPECT_THAT(seen.back(), Eq(all_buffers.back()->id()));
+    EXPECT_TRUE(std::is_sorted(
+        seen.begin(), seen.end(), [](auto const& a, auto const& b) { return a.as_value() < b.as_value(); }));
+    EXPECT_THAT(std::adjacent_find(seen.begin(), seen.end()), Eq(seen.end()));
+}
@@ -21,6 +21,7 @@
 #include "mir/test/doubles/stub_buffer_allocator.h"
 #include "src/server/compositor/multi_monitor_arbiter.h"
 #include "src/server/compositor/schedule.h"
+#include "src/server/compositor/queueing_schedule.h"
 
 #include <gtest/gtest.h>
 using namespace testing;
@@ -661,3 +662,40 @@ TEST_F(MultiMonitorArbiter, second_compositor_advances_schedule_after_both_aquir
     auto cbuffer4 = arbiter.compositor_acquire(&comp_id2);
     EXPECT_THAT(cbuffer1, Not(IsSameBufferAs(cbuffer4)));
 }
+
+TEST_F(MultiMonitorArbiter, advancing_to_latest_skips_over_older_buffers)
+{
+    int comp_id1{0};
+
+    schedule.set_schedule({buffers[0], buffers[1], buffers[2]});
+    arbiter.advance_to_latest();
+
+    EXPECT_THAT(schedule.num_scheduled(), Eq(0u));
+    EXPECT_THAT(arbiter.compositor_acquire(&comp_id1), IsSameBufferAs(buffers[2]));
+}
+
+TEST_F(MultiMonitorArbiter, advancing_to_latest_with_nothing_scheduled_keeps_current_buffer)
+{
+    int comp_id1{0};
+    int comp_id2{1};
+
+    schedule.set_schedule({buffers[0]});
+    arbiter.compositor_acquire(&comp_id1);
+    arbiter.advance_to_latest();
+
+    EXPECT_FALSE(arbiter.buffer_ready_for(&comp_id1));
+    EXPECT_THAT(arbiter.compositor_acquire(&comp_id2), IsSameBufferAs(buffers[0]));
+}
+
+TEST_F(MultiMonitorArbiter, transferring_schedule_moves_unacquired_buffers_in_order)
+{
+    int comp_id1{0};
+    auto const new_schedule = std::make_shared<mc::QueueingSchedule>();
+
+    schedule.set_schedule({buffers[0], buffers[1]});
+    arbiter.transfer_schedule(new_schedule);
+
+    EXPECT_THAT(schedule.num_scheduled(), Eq(0u));
+    EXPECT_THAT(arbiter.compositor_acquire(&comp_id1), IsSameBufferAs(buffers[0]));
+    EXPECT_THAT(arbiter.compositor_acquire(&comp_id1), IsSameBufferAs(buffers[1]));
+}
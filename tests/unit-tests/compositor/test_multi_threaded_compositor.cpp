@@ -33,6 +33,7 @@
 #include "mir/test/doubles/mock_compositor_report.h"
 #include "mir/test/doubles/mock_scene.h"
 #include "mir/test/doubles/stub_scene.h"
+#include "mir/test/doubles/stub_scene_element.h"
 #include "mir/test/doubles/stub_display.h"
 #include "mir/test/doubles/null_display_buffer_compositor_factory.h"
 
@@ -42,6 +43,7 @@
 #include <unordered_set>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
 #include <chrono>
 
 #include <gmock/gmock.h>
@@ -87,6 +89,10 @@ private:
         {
             return std::chrono::milliseconds::zero();
         }
+        mg::Frame last_frame() const override
+        {
+            return {};
+        }
         testing::NiceMock<mtd::MockDisplayBuffer> buffer; 
     };
 
@@ -136,6 +142,12 @@ public:
         throw_on_add_observer_ = flag;
     }
 
+    mc::SceneElementSequence scene_elements_for(mc::CompositorID, geom::Rectangle const&) override
+    {
+        // A new renderable every time, so no frame is skipped as unchanged
+        return {std::make_shared<mtd::StubSceneElement>()};
+    }
+
     int frames_pending(mc::CompositorID) const override
     {
         return pending;
@@ -154,6 +166,49 @@ private:
     bool throw_on_add_observer_;
 };
 
+class UnchangingScene : public StubScene
+{
+public:
+    mc::SceneElementSequence scene_elements_for(mc::CompositorID, geom::Rectangle const&) override
+    {
+        return {element};
+    }
+
+private:
+    std::shared_ptr<mc::SceneElement> const element{std::make_shared<mtd::StubSceneElement>()};
+};
+
+// Records which of a client's buffers was newest each time the scene is sampled
+class LatchingScene : public StubScene
+{
+public:
+    mc::SceneElementSequence scene_elements_for(mc::CompositorID id, geom::Rectangle const& area) override
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            latched.push_back(newest_buffer);
+        }
+        return StubScene::scene_elements_for(id, area);
+    }
+
+    void submit_buffer(int buffer)
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        newest_buffer = buffer;
+    }
+
+    auto buffers_latched() -> std::vector<int>
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        return latched;
+    }
+
+private:
+    std::mutex mutex;
+    int newest_buffer{0};
+    std::vector<int> latched;
+};
+
 class RecordingDisplayBufferCompositor : public mc::DisplayBufferCompositor
 {
 public:
@@ -347,6 +402,103 @@ public:
 
 namespace
 {
+class StubDisplayWithOneGroup : public mtd::NullDisplay
+{
+public:
+    StubDisplayWithOneGroup(unsigned int nbuffers) : group{nbuffers} {}
+
+    void for_each_display_sync_group(std::function<void(mg::DisplaySyncGroup&)> const& f) override
+    {
+        f(group);
+    }
+
+    void on_post(std::function<void()> const& callback)
+    {
+        group.post_callback = callback;
+    }
+
+private:
+    struct StubDisplaySyncGroup : mg::DisplaySyncGroup
+    {
+        StubDisplaySyncGroup(unsigned int nbuffers) : buffers(nbuffers) {}
+
+        void for_each_display_buffer(std::function<void(mg::DisplayBuffer&)> const& f) override
+        {
+            for (auto& buffer : buffers)
+                f(buffer);
+        }
+        void post() override
+        {
+            post_callback();
+        }
+        std::chrono::milliseconds recommended_sleep() const override
+        {
+            return std::chrono::milliseconds::zero();
+        }
+        mg::Frame last_frame() const override
+        {
+            return {};
+        }
+        std::vector<testing::NiceMock<mtd::MockDisplayBuffer>> buffers;
+        std::function<void()> post_callback{[]{}};
+    };
+
+    StubDisplaySyncGroup group;
+};
+
+// Compositors that wait (briefly) for all of a group's outputs to be compositing at once
+class ConcurrentDisplayBufferCompositorFactory : public mc::DisplayBufferCompositorFactory
+{
+public:
+    ConcurrentDisplayBufferCompositorFactory(unsigned int noutputs) : noutputs{noutputs} {}
+
+    std::unique_ptr<mc::DisplayBufferCompositor> create_compositor_for(mg::DisplayBuffer&) override
+    {
+        return std::make_unique<Compositor>(*this);
+    }
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    unsigned int const noutputs;
+    unsigned int compositing{0};
+    unsigned int composited{0};
+    unsigned int overlapping{0};
+    std::unordered_set<std::thread::id> threads;
+    bool stayed_on_their_threads{true};
+
+private:
+    class Compositor : public mc::DisplayBufferCompositor
+    {
+    public:
+        Compositor(ConcurrentDisplayBufferCompositorFactory& factory) : factory(factory) {}
+
+        ~Compositor()
+        {
+            std::lock_guard<std::mutex> lock{factory.mutex};
+            if (std::this_thread::get_id() != thread)
+                factory.stayed_on_their_threads = false;
+        }
+
+        void composite(mc::SceneElementSequence&&) override
+        {
+            std::unique_lock<std::mutex> lock{factory.mutex};
+            if (std::this_thread::get_id() != thread)
+                factory.stayed_on_their_threads = false;
+            factory.threads.insert(thread);
+
+            ++factory.compositing;
+            factory.cv.notify_all();
+            if (factory.cv.wait_for(lock, 1s, [this] { return factory.compositing >= factory.noutputs; }))
+                ++factory.overlapping;
+            ++factory.composited;
+        }
+
+    private:
+        ConcurrentDisplayBufferCompositorFactory& factory;
+        std::thread::id const thread{std::this_thread::get_id()};
+    };
+};
+
 struct StubDisplayListener : mc::DisplayListener
 {
     virtual void add_display(geom::Rectangle const& /*area*/) override {}
@@ -537,6 +689,32 @@ TEST(MultiThreadedCompositor, composites_only_on_demand)
     compositor.stop();
 }
 
+TEST(MultiThreadedCompositor, skips_frames_when_the_scene_is_unchanged)
+{
+    using namespace testing;
+
+    unsigned int const nbuffers = 3;
+
+    auto display = std::make_shared<mtd::StubDisplay>(nbuffers);
+    auto scene = std::make_shared<UnchangingScene>();
+    auto factory = std::make_shared<RecordingDisplayBufferCompositorFactory>();
+    mc::MultiThreadedCompositor compositor{display, scene, factory,
+                                           null_display_listener, null_report, default_delay, true};
+
+    compositor.start();
+
+    while (!factory->check_record_count_for_each_buffer(nbuffers, 1))
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    scene->emit_change_event();
+    scene->set_pending(3);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    EXPECT_TRUE(factory->check_record_count_for_each_buffer(nbuffers, 1, 1));
+
+    compositor.stop();
+}
+
 TEST(MultiThreadedCompositor, schedules_enough_frames)
 {
     using namespace testing;
@@ -662,6 +840,47 @@ TEST(MultiThreadedCompositor, recommended_sleep_throttles_compositor_loop)
     compositor.stop();
 }
 
+TEST(MultiThreadedCompositor, buffer_submitted_during_the_recommended_sleep_is_latched_by_that_frame)
+{
+    using namespace testing;
+    using namespace std::chrono;
+
+    unsigned int const nbuffers = 1;
+    milliseconds const recommendation(200);
+
+    auto display = std::make_shared<mtd::StubDisplay>(nbuffers);
+    auto scene = std::make_shared<LatchingScene>();
+    auto factory = std::make_shared<RecordingDisplayBufferCompositorFactory>();
+    mc::MultiThreadedCompositor compositor{display, scene, factory,
+                                           null_display_listener, null_report,
+                                           recommendation, false};
+
+    compositor.start();
+
+    // The compositor is idle until a client submits a buffer...
+    scene->submit_buffer(1);
+    scene->emit_change_event();
+
+    // ...and another while the compositor sleeps before the frame
+    std::this_thread::sleep_for(recommendation / 4);
+    scene->submit_buffer(2);
+
+    int const max_retries = 100;
+    int retry = 0;
+    while (retry < max_retries && !factory->check_record_count_for_each_buffer(nbuffers, 1))
+    {
+        std::this_thread::sleep_for(milliseconds(10));
+        ++retry;
+    }
+    ASSERT_LT(retry, max_retries);
+
+    compositor.stop();
+
+    auto const latched = scene->buffers_latched();
+    ASSERT_THAT(latched, Not(IsEmpty()));
+    EXPECT_THAT(latched.front(), Eq(2));
+}
+
 TEST(MultiThreadedCompositor, when_no_initial_composite_is_needed_there_is_none)
 {
     using namespace testing;
@@ -757,7 +976,7 @@ TEST(MultiThreadedCompositor, double_start_or_stop_ignored)
         .Times(1);
     EXPECT_CALL(*mock_scene, remove_observer(_))
         .Times(1);
-    EXPECT_CALL(*mock_scene, scene_elements_for(_))
+    EXPECT_CALL(*mock_scene, scene_elements_for(_, _))
         .Times(AtLeast(0))
         .WillRepeatedly(Return(mc::SceneElementSequence{}));
 
@@ -871,6 +1090,158 @@ TEST(MultiThreadedCompositor, registers_and_unregisters_with_scene)
     compositor.stop();
 }
 
+TEST(MultiThreadedCompositor, stopping_compositing_to_one_group_leaves_the_others_compositing)
+{
+    using namespace testing;
+    unsigned int const nbuffers{3};
+    auto display = std::make_shared<StubDisplayWithMockBuffers>(nbuffers);
+    auto mock_scene = std::make_shared<NiceMock<mtd::MockScene>>();
+    auto db_compositor_factory = std::make_shared<mtd::NullDisplayBufferCompositorFactory>();
+    auto mock_report = std::make_shared<testing::NiceMock<mtd::MockCompositorReport>>();
+
+    mc::MultiThreadedCompositor compositor{
+        display, mock_scene, db_compositor_factory, null_display_listener, mock_report, default_delay, true};
+
+    compositor.start();
+
+    mg::DisplaySyncGroup* first_group{nullptr};
+    display->for_each_display_sync_group(
+        [&](mg::DisplaySyncGroup& group) { if (!first_group) first_group = &group; });
+
+    EXPECT_CALL(*mock_scene, unregister_compositor(_)).Times(1);
+    compositor.stop_compositing(*first_group);
+    Mock::VerifyAndClearExpectations(mock_scene.get());
+
+    EXPECT_CALL(*mock_scene, register_compositor(_)).Times(1);
+    compositor.start_compositing_new_groups();
+    Mock::VerifyAndClearExpectations(mock_scene.get());
+
+    EXPECT_CALL(*mock_scene, unregister_compositor(_)).Times(nbuffers);
+    compositor.stop();
+}
+
+TEST(MultiThreadedCompositor, pausing_keeps_compositors_for_resume)
+{
+    using namespace testing;
+    unsigned int const nbuffers{3};
+    auto display = std::make_shared<StubDisplayWithMockBuffers>(nbuffers);
+    auto mock_scene = std::make_shared<NiceMock<mtd::MockScene>>();
+    auto db_compositor_factory = std::make_shared<mtd::NullDisplayBufferCompositorFactory>();
+    auto mock_report = std::make_shared<testing::NiceMock<mtd::MockCompositorReport>>();
+
+    mc::MultiThreadedCompositor compositor{
+        display, mock_scene, db_compositor_factory, null_display_listener, mock_report, default_delay, true};
+
+    compositor.start();
+
+    EXPECT_CALL(*mock_scene, unregister_compositor(_)).Times(0);
+    EXPECT_CALL(*mock_scene, register_compositor(_)).Times(0);
+    compositor.pause();
+    compositor.resume();
+    Mock::VerifyAndClearExpectations(mock_scene.get());
+
+    EXPECT_CALL(*mock_scene, unregister_compositor(_)).Times(nbuffers);
+    compositor.stop();
+}
+
+TEST(MultiThreadedCompositor, resuming_repaints_an_unchanged_scene)
+{
+    using namespace testing;
+
+    unsigned int const nbuffers = 3;
+
+    auto display = std::make_shared<mtd::StubDisplay>(nbuffers);
+    auto scene = std::make_shared<UnchangingScene>();
+    auto factory = std::make_shared<RecordingDisplayBufferCompositorFactory>();
+    mc::MultiThreadedCompositor compositor{display, scene, factory,
+                                           null_display_listener, null_report, default_delay, true};
+
+    compositor.start();
+
+    while (!factory->check_record_count_for_each_buffer(nbuffers, 1))
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    compositor.pause();
+    scene->emit_change_event();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_TRUE(factory->check_record_count_for_each_buffer(nbuffers, 1, 1));
+
+    compositor.resume();
+
+    auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+    while (!factory->check_record_count_for_each_buffer(nbuffers, 2) && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    EXPECT_TRUE(factory->check_record_count_for_each_buffer(nbuffers, 2, 2));
+
+    compositor.stop();
+}
+
+TEST(MultiThreadedCompositor, suspended_group_leaves_the_scene_until_resumed)
+{
+    using namespace testing;
+    unsigned int const nbuffers{3};
+    auto display = std::make_shared<StubDisplayWithMockBuffers>(nbuffers);
+    auto mock_scene = std::make_shared<NiceMock<mtd::MockScene>>();
+    auto db_compositor_factory = std::make_shared<mtd::NullDisplayBufferCompositorFactory>();
+    auto mock_report = std::make_shared<testing::NiceMock<mtd::MockCompositorReport>>();
+
+    mc::MultiThreadedCompositor compositor{
+        display, mock_scene, db_compositor_factory, null_display_listener, mock_report, default_delay, true};
+
+    compositor.start();
+
+    mg::DisplaySyncGroup* suspended{nullptr};
+    display->for_each_display_sync_group([&](mg::DisplaySyncGroup& group) { if (!suspended) suspended = &group; });
+
+    EXPECT_CALL(*mock_scene, unregister_compositor(_)).Times(1);
+    compositor.suspend_compositing(*suspended);
+    Mock::VerifyAndClearExpectations(mock_scene.get());
+
+    EXPECT_CALL(*mock_scene, register_compositor(_)).Times(1);
+    compositor.resume_compositing(*suspended);
+    Mock::VerifyAndClearExpectations(mock_scene.get());
+
+    EXPECT_CALL(*mock_scene, unregister_compositor(_)).Times(nbuffers);
+    compositor.stop();
+}
+
+TEST(MultiThreadedCompositor, resumed_group_gets_a_fresh_frame)
+{
+    using namespace testing;
+
+    unsigned int const nbuffers = 1;
+
+    auto display = std::make_shared<mtd::StubDisplay>(nbuffers);
+    auto scene = std::make_shared<UnchangingScene>();
+    auto factory = std::make_shared<RecordingDisplayBufferCompositorFactory>();
+    mc::MultiThreadedCompositor compositor{display, scene, factory,
+                                           null_display_listener, null_report, default_delay, true};
+
+    compositor.start();
+
+    while (!factory->check_record_count_for_each_buffer(nbuffers, 1))
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    mg::DisplaySyncGroup* suspended{nullptr};
+    display->for_each_display_sync_group([&](mg::DisplaySyncGroup& group) { suspended = &group; });
+
+    compositor.suspend_compositing(*suspended);
+    scene->emit_change_event();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_TRUE(factory->check_record_count_for_each_buffer(nbuffers, 1, 1));
+
+    compositor.resume_compositing(*suspended);
+
+    auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+    while (!factory->check_record_count_for_each_buffer(nbuffers, 2) && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    EXPECT_TRUE(factory->check_record_count_for_each_buffer(nbuffers, 2, 2));
+
+    compositor.stop();
+}
+
 TEST(MultiThreadedCompositor, notifies_about_display_additions_and_removals)
 {
     using namespace testing;
@@ -948,3 +1319,41 @@ TEST(MultiThreadedCompositor, can_schedule_from_display_observer_when_removing_d
         display, stub_scene, db_compositor_factory, mock_display_listener, mock_report, default_delay, true};
     compositor.start();
 }
+
+TEST(MultiThreadedCompositor, composites_the_outputs_of_a_group_concurrently_before_posting)
+{
+    using namespace testing;
+
+    unsigned int const noutputs = 3;
+
+    auto display = std::make_shared<StubDisplayWithOneGroup>(noutputs);
+    auto scene = std::make_shared<UnchangingScene>();
+    auto factory = std::make_shared<ConcurrentDisplayBufferCompositorFactory>(noutputs);
+
+    std::atomic<unsigned int> composited_when_posted{0};
+    std::atomic<bool> posted{false};
+    display->on_post([&]
+        {
+            std::lock_guard<std::mutex> lock{factory->mutex};
+            composited_when_posted = factory->composited;
+            posted = true;
+        });
+
+    {
+        mc::MultiThreadedCompositor compositor{display, scene, factory,
+                                               null_display_listener, null_report, default_delay, true};
+        compositor.start();
+
+        auto const deadline = std::chrono::steady_clock::now() + 10s;
+        while (!posted && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::sleep_for(10ms);
+
+        compositor.stop();
+    }
+
+    std::lock_guard<std::mutex> lock{factory->mutex};
+    EXPECT_THAT(factory->overlapping, Eq(noutputs));
+    EXPECT_THAT(factory->threads.size(), Eq(noutputs));
+    EXPECT_TRUE(factory->stayed_on_their_threads);
+    EXPECT_THAT(composited_when_posted.load(), Eq(noutputs));
+}
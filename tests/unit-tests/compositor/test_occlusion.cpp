@@ -202,3 +202,56 @@ TEST_F(OcclusionFilterTest,
     EXPECT_THAT(renderables_from(occlusions), ElementsAre(partially_onscreen));
     EXPECT_THAT(renderables_from(elements), ElementsAre(covering));
 }
+
+TEST_F(OcclusionFilterTest, window_covered_by_several_windows_together_is_occluded)
+{
+    auto const bottom = std::make_shared<mtd::FakeRenderable>(50, 20, 100, 50);
+    auto const left = std::make_shared<mtd::FakeRenderable>(0, 0, 100, 100);
+    auto const right = std::make_shared<mtd::FakeRenderable>(100, 0, 100, 100);
+    auto elements = scene_elements_from({bottom, left, right});
+
+    auto const& occlusions = filter_occlusions_from(elements, monitor_rect);
+
+    EXPECT_THAT(renderables_from(occlusions), ElementsAre(bottom));
+    EXPECT_THAT(renderables_from(elements), ElementsAre(left, right));
+}
+
+TEST_F(OcclusionFilterTest, window_only_partly_covered_by_several_windows_is_not_occluded)
+{
+    auto const bottom = std::make_shared<mtd::FakeRenderable>(50, 20, 100, 50);
+    auto const left = std::make_shared<mtd::FakeRenderable>(0, 0, 100, 100);
+    auto const right = std::make_shared<mtd::FakeRenderable>(101, 0, 100, 100);
+    auto elements = scene_elements_from({bottom, left, right});
+
+    auto const& occlusions = filter_occlusions_from(elements, monitor_rect);
+
+    EXPECT_THAT(renderables_from(occlusions), IsEmpty());
+    EXPECT_THAT(renderables_from(elements), ElementsAre(bottom, left, right));
+}
+
+TEST_F(OcclusionFilterTest, shaped_window_occludes_with_its_opaque_region)
+{
+    auto const top = std::make_shared<mtd::FakeRenderable>(Rectangle{{10, 10}, {100, 100}}, 1.0f, false);
+    top->set_opaque_region({{{20, 20}, {80, 80}}});
+    auto const hidden = std::make_shared<mtd::FakeRenderable>(30, 30, 50, 50);
+    auto const visible = std::make_shared<mtd::FakeRenderable>(12, 12, 5, 5);
+    auto elements = scene_elements_from({visible, hidden, top});
+
+    auto const& occlusions = filter_occlusions_from(elements, monitor_rect);
+
+    EXPECT_THAT(renderables_from(occlusions), ElementsAre(hidden));
+    EXPECT_THAT(renderables_from(elements), ElementsAre(visible, top));
+}
+
+TEST_F(OcclusionFilterTest, translucent_window_ignores_its_opaque_region)
+{
+    auto const top = std::make_shared<mtd::FakeRenderable>(Rectangle{{10, 10}, {100, 100}}, 0.5f, false);
+    top->set_opaque_region({{{10, 10}, {100, 100}}});
+    auto const bottom = std::make_shared<mtd::FakeRenderable>(30, 30, 50, 50);
+    auto elements = scene_elements_from({bottom, top});
+
+    auto const& occlusions = filter_occlusions_from(elements, monitor_rect);
+
+    EXPECT_THAT(renderables_from(occlusions), IsEmpty());
+    EXPECT_THAT(renderables_from(elements), ElementsAre(bottom, top));
+}
@@ -0,0 +1,158 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/compositor/screen_capture.h"
+
+#include "mir/test/doubles/mock_renderer.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <vector>
+
+namespace mc = mir::compositor;
+namespace mr = mir::renderer;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+
+using namespace ::testing;
+
+namespace
+{
+struct ScreenCapture : Test
+{
+    int frames_scheduled{0};
+    mc::ScreenCapture capture{[this] { ++frames_scheduled; }};
+    NiceMock<mtd::MockRenderer> renderer;
+
+    geom::Rectangle const output{{0, 0}, {640, 480}};
+    geom::Rectangle const other_output{{640, 0}, {640, 480}};
+
+    std::vector<mc::ScreenCapture::Frame> frames;
+
+    auto record_frames() -> mc::ScreenCapture::Callback
+    {
+        return [this](mc::ScreenCapture::Frame const& frame) { frames.push_back(frame); };
+    }
+
+    /// Has the renderer deliver some pixels to whatever it is asked to read
+    void renderer_reads_frames()
+    {
+        ON_CALL(renderer, read_next_frame(_, _))
+            .WillByDefault(Invoke([this](geom::Rectangle const& area, mr::Renderer::FrameReader const& reader)
+                {
+                    pixels.resize(area.size.width.as_int() * area.size.height.as_int());
+                    reader(area.size, geom::Stride{area.size.width.as_int() * 4}, pixels.data());
+                }));
+    }
+
+    std::vector<uint32_t> pixels;
+};
+}
+
+TEST_F(ScreenCapture, capture_asks_for_a_frame)
+{
+    auto const request = capture.capture(output, false, record_frames());
+
+    EXPECT_THAT(frames_scheduled, Eq(1));
+    EXPECT_TRUE(capture.wants_frame_of(output));
+    EXPECT_FALSE(capture.wants_frame_of(other_output));
+}
+
+TEST_F(ScreenCapture, capture_with_damage_waits_for_the_scene_to_change)
+{
+    auto const request = capture.capture(output, true, record_frames());
+
+    EXPECT_THAT(frames_scheduled, Eq(0));
+}
+
+TEST_F(ScreenCapture, frame_is_read_from_the_output_that_shows_it)
+{
+    geom::Rectangle const area{{10, 20}, {100, 50}};
+    auto const request = capture.capture(area, false, record_frames());
+
+    EXPECT_CALL(renderer, read_next_frame(_, _)).Times(0);
+    capture.prepare_frame(other_output, {}, renderer);
+    Mock::VerifyAndClearExpectations(&renderer);
+
+    EXPECT_CALL(renderer, read_next_frame(area, _));
+    capture.prepare_frame(output, {}, renderer);
+}
+
+TEST_F(ScreenCapture, callback_receives_what_the_renderer_reads)
+{
+    renderer_reads_frames();
+    auto const request = capture.capture(output, false, record_frames());
+
+    capture.prepare_frame(output, {}, renderer);
+
+    ASSERT_THAT(frames.size(), Eq(1u));
+    EXPECT_THAT(frames[0].size, Eq(output.size));
+    EXPECT_THAT(frames[0].pixels, Eq(pixels.data()));
+    EXPECT_THAT(frames[0].damage, Eq(geom::Rectangles{{{0, 0}, output.size}}));
+}
+
+TEST_F(ScreenCapture, each_capture_is_delivered_once)
+{
+    renderer_reads_frames();
+    auto const request = capture.capture(output, false, record_frames());
+
+    capture.prepare_frame(output, {}, renderer);
+    capture.prepare_frame(output, {}, renderer);
+
+    EXPECT_THAT(frames.size(), Eq(1u));
+    EXPECT_FALSE(capture.wants_frame_of(output));
+}
+
+TEST_F(ScreenCapture, capture_with_damage_skips_frames_that_do_not_change_it)
+{
+    renderer_reads_frames();
+    geom::Rectangle const area{{100, 100}, {100, 100}};
+    auto const request = capture.capture(area, true, record_frames());
+
+    capture.prepare_frame(output, geom::Rectangles{{{0, 0}, {50, 50}}}, renderer);
+    EXPECT_THAT(frames.size(), Eq(0u));
+
+    capture.prepare_frame(output, geom::Rectangles{{{150, 150}, {100, 100}}}, renderer);
+    ASSERT_THAT(frames.size(), Eq(1u));
+    EXPECT_THAT(frames[0].damage, Eq(geom::Rectangles{{{50, 50}, {50, 50}}}));
+}
+
+TEST_F(ScreenCapture, cancelled_capture_is_not_delivered)
+{
+    renderer_reads_frames();
+    auto request = capture.capture(output, false, record_frames());
+
+    request.reset();
+    capture.prepare_frame(output, {}, renderer);
+
+    EXPECT_THAT(frames.size(), Eq(0u));
+    EXPECT_FALSE(capture.wants_frame_of(output));
+}
+
+TEST_F(ScreenCapture, capture_cancelled_before_the_read_is_not_delivered)
+{
+    mr::Renderer::FrameReader reader;
+    EXPECT_CALL(renderer, read_next_frame(_, _)).WillOnce(SaveArg<1>(&reader));
+    auto request = capture.capture(output, false, record_frames());
+
+    capture.prepare_frame(output, {}, renderer);
+    request.reset();
+    pixels.resize(output.size.width.as_int() * output.size.height.as_int());
+    reader(output.size, geom::Stride{output.size.width.as_int() * 4}, pixels.data());
+
+    EXPECT_THAT(frames.size(), Eq(0u));
+}
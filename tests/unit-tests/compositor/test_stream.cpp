@@ -21,6 +21,7 @@
 #include "mir/test/doubles/mock_event_sink.h"
 #include "mir/test/fake_shared.h"
 #include "src/server/compositor/stream.h"
+#include "mir/compositor/presentation.h"
 #include "mir/scene/null_surface_observer.h"
 
 #include <gmock/gmock.h>
@@ -156,6 +157,18 @@ TEST_F(Stream, frame_callback_is_called_without_scheduling_lock)
     stream.submit_buffer(buffers[0]);
 }
 
+TEST_F(Stream, passes_presentations_to_the_frame_presented_callback)
+{
+    std::vector<mg::BufferID> presented;
+    stream.set_frame_presented_callback(
+        [&presented](mc::Presentation const& presentation) { presented.push_back(presentation.buffer); });
+
+    stream.frame_presented({buffers[0]->id(), {}, {{0, 0}, {640, 480}}, false, {{0, 0}, {100, 100}}});
+    stream.frame_presented({buffers[1]->id(), {}, {{0, 0}, {640, 480}}, true, {{0, 0}, {640, 480}}});
+
+    EXPECT_THAT(presented, ElementsAre(buffers[0]->id(), buffers[1]->id()));
+}
+
 TEST_F(Stream, flattens_queue_out_when_told_to_drop)
 {
     for(auto& buffer : buffers)
@@ -241,3 +254,95 @@ TEST_F(Stream, stream_remembers_scale_when_buffer_added)
     stream.submit_buffer(buffers[0]);
     ASSERT_THAT(stream.stream_size(), Eq(initial_size / 2));
 }
+
+TEST_F(Stream, viewport_destination_sets_stream_size)
+{
+    stream.submit_buffer(buffers[0]);
+    stream.set_viewport(geom::RectangleF{{1, 0}, {20, 1}}, geom::Size{100, 50});
+    EXPECT_THAT(stream.stream_size(), Eq(geom::Size{100, 50}));
+}
+
+TEST_F(Stream, viewport_source_without_destination_sets_stream_size)
+{
+    stream.submit_buffer(buffers[0]);
+    stream.set_viewport(geom::RectangleF{{1, 0}, {20, 1}}, std::experimental::nullopt);
+    EXPECT_THAT(stream.stream_size(), Eq(geom::Size{20, 1}));
+}
+
+TEST_F(Stream, source_bounds_are_whole_buffer_without_viewport)
+{
+    EXPECT_THAT(stream.source_bounds(initial_size), Eq(geom::RectangleF{{}, geom::SizeF{initial_size}}));
+}
+
+TEST_F(Stream, source_bounds_are_viewport_source_in_buffer_pixels)
+{
+    stream.set_scale(2.0f);
+    stream.set_viewport(geom::RectangleF{{1.5f, 0}, {20, 1}}, std::experimental::nullopt);
+    EXPECT_THAT(stream.source_bounds(initial_size), Eq(geom::RectangleF{{3, 0}, {40, 2}}));
+}
+
+TEST_F(Stream, buffer_damage_is_unknown_on_first_acquisition)
+{
+    stream.add_damage({{{0, 0}, {1, 1}}});
+    stream.submit_buffer(buffers[0]);
+    stream.lock_compositor_buffer(this);
+
+    EXPECT_FALSE(stream.buffer_damage(this));
+}
+
+TEST_F(Stream, reports_damage_submitted_since_last_acquisition)
+{
+    geom::Rectangle const damage{{1, 0}, {3, 1}};
+
+    stream.submit_buffer(buffers[0]);
+    stream.lock_compositor_buffer(this);
+    stream.add_damage({damage});
+    stream.submit_buffer(buffers[1]);
+    stream.lock_compositor_buffer(this);
+
+    ASSERT_TRUE(stream.buffer_damage(this));
+    EXPECT_THAT(stream.buffer_damage(this).value(), Eq(geom::Rectangles{damage}));
+}
+
+TEST_F(Stream, accumulates_damage_of_dropped_submissions)
+{
+    geom::Rectangle const first{{1, 0}, {3, 1}};
+    geom::Rectangle const second{{10, 1}, {2, 1}};
+
+    stream.allow_framedropping(true);
+    stream.submit_buffer(buffers[0]);
+    stream.lock_compositor_buffer(this);
+    stream.add_damage({first});
+    stream.submit_buffer(buffers[1]);
+    stream.add_damage({second});
+    stream.submit_buffer(buffers[2]);
+    stream.lock_compositor_buffer(this);
+
+    ASSERT_TRUE(stream.buffer_damage(this));
+    EXPECT_THAT(stream.buffer_damage(this).value(), Eq(geom::Rectangles{first, second}));
+}
+
+TEST_F(Stream, submission_without_damage_makes_buffer_damage_unknown)
+{
+    stream.submit_buffer(buffers[0]);
+    stream.lock_compositor_buffer(this);
+    stream.submit_buffer(buffers[1]);
+    stream.lock_compositor_buffer(this);
+
+    EXPECT_FALSE(stream.buffer_damage(this));
+}
+
+TEST_F(Stream, relocking_the_same_buffer_keeps_its_damage)
+{
+    geom::Rectangle const damage{{1, 0}, {3, 1}};
+
+    stream.submit_buffer(buffers[0]);
+    stream.lock_compositor_buffer(this);
+    stream.add_damage({damage});
+    stream.submit_buffer(buffers[1]);
+    stream.lock_compositor_buffer(this);
+    stream.lock_compositor_buffer(this);
+
+    ASSERT_TRUE(stream.buffer_damage(this));
+    EXPECT_THAT(stream.buffer_damage(this).value(), Eq(geom::Rectangles{damage}));
+}
@@ -1649,6 +1649,31 @@ TEST_F(LogindConsoleServices, can_acquire_device_without_running_main_loop)
     stop_mainloop();
 }
 
+/*
+ * Devices acquired during startup shouldn't each wait on logind in turn
+ */
+TEST_F(LogindConsoleServices, acquiring_device_without_running_main_loop_does_not_wait_for_logind)
+{
+    ensure_mock_logind();
+    auto const session_path = add_any_active_session();
+
+    add_take_device_to_session(
+        session_path.c_str(),
+        "__import__('time').sleep(0.5); ret = (os.open('/dev/zero', os.O_RDONLY), False)");
+    add_release_device_to_session(session_path.c_str());
+
+    auto not_running_main_loop =
+        std::make_shared<mir::GLibMainLoop>(std::make_shared<mir::time::SteadyClock>());
+
+    mir::LogindConsoleServices services{not_running_main_loop};
+
+    auto device = services.acquire_device(42, 22, std::make_unique<mtd::NullDeviceObserver>());
+
+    EXPECT_THAT(device.wait_for(0s), Eq(std::future_status::timeout));
+    EXPECT_THAT(device.get(), NotNull());
+    stop_mainloop();
+}
+
 TEST_F(LogindConsoleServices, creates_vt_switcher_when_vt_switching_possible)
 {
     ensure_mock_logind();
@@ -23,6 +23,8 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <stdexcept>
+
 namespace mt = mir::test;
 namespace md = mir::dispatch;
 using namespace ::testing;
@@ -79,3 +81,59 @@ TEST(ActionQueue, executes_action_only_once)
 }
 
 
+
+TEST(ActionQueue, executes_all_queued_actions_in_order_on_one_dispatch)
+{
+    md::ActionQueue queue;
+
+    std::vector<int> executed;
+
+    queue.enqueue([&](){executed.push_back(1);});
+    queue.enqueue([&](){executed.push_back(2);});
+    queue.enqueue([&](){executed.push_back(3);});
+    queue.dispatch(md::FdEvent::readable);
+
+    EXPECT_THAT(executed, ElementsAre(1, 2, 3));
+    EXPECT_FALSE(mt::fd_is_readable(queue.watch_fd()));
+}
+
+TEST(ActionQueue, executes_actions_enqueued_by_an_action_on_next_dispatch)
+{
+    md::ActionQueue queue;
+
+    auto executed = false;
+
+    queue.enqueue([&](){ queue.enqueue([&](){executed = true;}); });
+    queue.dispatch(md::FdEvent::readable);
+
+    EXPECT_FALSE(executed);
+    EXPECT_TRUE(mt::fd_is_readable(queue.watch_fd()));
+
+    queue.dispatch(md::FdEvent::readable);
+    EXPECT_TRUE(executed);
+}
+
+TEST(ActionQueue, actions_left_by_a_throwing_action_run_before_those_it_enqueued)
+{
+    md::ActionQueue queue;
+
+    std::vector<int> executed;
+
+    queue.enqueue([&]()
+        {
+            executed.push_back(1);
+            queue.enqueue([&](){executed.push_back(4);});
+            throw std::runtime_error{"Oops"};
+        });
+    queue.enqueue([&](){executed.push_back(2);});
+    queue.enqueue([&](){executed.push_back(3);});
+
+    EXPECT_THROW(queue.dispatch(md::FdEvent::readable), std::runtime_error);
+    EXPECT_THAT(executed, ElementsAre(1));
+    EXPECT_TRUE(mt::fd_is_readable(queue.watch_fd()));
+
+    queue.dispatch(md::FdEvent::readable);
+
+    EXPECT_THAT(executed, ElementsAre(1, 2, 3, 4));
+    EXPECT_FALSE(mt::fd_is_readable(queue.watch_fd()));
+}
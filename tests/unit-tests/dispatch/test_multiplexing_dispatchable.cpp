@@ -116,6 +116,50 @@ TEST(MultiplexingDispatchableTest, dispatching_without_pending_event_is_harmless
     EXPECT_FALSE(dispatched);
 }
 
+TEST(MultiplexingDispatchableTest, dispatches_all_ready_dispatchees_in_one_call)
+{
+    int dispatch_count{0};
+    auto dispatchee_a = std::make_shared<mt::TestDispatchable>([&dispatch_count]() { ++dispatch_count; });
+    auto dispatchee_b = std::make_shared<mt::TestDispatchable>([&dispatch_count]() { ++dispatch_count; });
+    auto dispatchee_c = std::make_shared<mt::TestDispatchable>([&dispatch_count]() { ++dispatch_count; });
+    md::MultiplexingDispatchable dispatcher{dispatchee_a, dispatchee_b, dispatchee_c};
+
+    dispatchee_a->trigger();
+    dispatchee_b->trigger();
+    dispatchee_c->trigger();
+
+    ASSERT_TRUE(mt::fd_is_readable(dispatcher.watch_fd()));
+    dispatcher.dispatch(md::FdEvent::readable);
+
+    EXPECT_EQ(3, dispatch_count);
+    EXPECT_FALSE(mt::fd_is_readable(dispatcher.watch_fd()));
+}
+
+TEST(MultiplexingDispatchableTest, dispatchee_removed_by_earlier_dispatchee_in_same_call_is_not_dispatched)
+{
+    md::MultiplexingDispatchable dispatcher;
+    std::shared_ptr<mt::TestDispatchable> dispatchee_a, dispatchee_b;
+    int dispatch_count{0};
+
+    // Whichever is dispatched first removes the other
+    dispatchee_a = std::make_shared<mt::TestDispatchable>(
+        [&]() { ++dispatch_count; dispatcher.remove_watch(dispatchee_b); });
+    dispatchee_b = std::make_shared<mt::TestDispatchable>(
+        [&]() { ++dispatch_count; dispatcher.remove_watch(dispatchee_a); });
+    dispatcher.add_watch(dispatchee_a);
+    dispatcher.add_watch(dispatchee_b);
+
+    dispatchee_a->trigger();
+    dispatchee_b->trigger();
+
+    while (mt::fd_is_readable(dispatcher.watch_fd()))
+    {
+        dispatcher.dispatch(md::FdEvent::readable);
+    }
+
+    EXPECT_EQ(1, dispatch_count);
+}
+
 TEST(MultiplexingDispatchableTest, keeps_dispatchees_alive)
 {
     bool dispatched{false};
@@ -0,0 +1,199 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/frontend/socket_messenger.h"
+
+#include "mir/fd.h"
+#include "mir/fd_socket_transmission.h"
+
+#include <boost/asio.hpp>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+namespace mf = mir::frontend;
+namespace mfd = mf::detail;
+namespace ba = boost::asio;
+
+using namespace testing;
+
+namespace
+{
+/// Big enough that a few of them fill the socket, small enough for the two byte length header
+size_t const large_message_size{60000};
+
+struct SocketMessenger : Test
+{
+    SocketMessenger()
+    {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+            throw std::system_error{errno, std::system_category(), "Failed to create socket pair"};
+
+        client = mir::Fd{fds[1]};
+        auto const socket = std::make_shared<ba::local::stream_protocol::socket>(
+            io_service, ba::local::stream_protocol{}, fds[0]);
+        messenger = std::make_shared<mfd::SocketMessenger>(socket);
+    }
+
+    void send(std::vector<char> const& message, mf::FdSets const& fds = {})
+    {
+        messenger->send(message.data(), message.size(), fds);
+    }
+
+    /// Runs \a read on a thread of its own, running the server's io_service until it is done
+    void client_reads(std::function<void()> const& read)
+    {
+        std::atomic<bool> done{false};
+        std::exception_ptr failure;
+
+        std::thread reader{[&]
+            {
+                try
+                {
+                    read();
+                }
+                catch (...)
+                {
+                    failure = std::current_exception();
+                }
+                done = true;
+            }};
+
+        while (!done)
+        {
+            io_service.poll();
+            io_service.restart();
+            std::this_thread::yield();
+        }
+        reader.join();
+
+        if (failure)
+            std::rethrow_exception(failure);
+    }
+
+    /// The next message the client gets
+    auto receive() -> std::vector<char>
+    {
+        std::vector<char> message;
+        client_reads([&]
+            {
+                unsigned char header[2];
+                std::vector<mir::Fd> no_fds;
+                mir::receive_data(client, header, sizeof header, no_fds);
+                message.resize((header[0] << 8) | header[1]);
+                if (!message.empty())
+                    mir::receive_data(client, message.data(), message.size(), no_fds);
+            });
+        return message;
+    }
+
+    /// The next set of \a count fds the client gets
+    auto receive_fds(size_t count) -> std::vector<mir::Fd>
+    {
+        std::vector<mir::Fd> fds(count);
+        client_reads([&]
+            {
+                char carrier;
+                mir::receive_data(client, &carrier, 1, fds);
+            });
+        return fds;
+    }
+
+    static auto filled(char value, size_t size) -> std::vector<char>
+    {
+        return std::vector<char>(size, value);
+    }
+
+    ba::io_service io_service;
+    mir::Fd client;
+    std::shared_ptr<mfd::SocketMessenger> messenger;
+};
+
+auto same_file(int lhs, int rhs) -> bool
+{
+    struct stat lhs_stat, rhs_stat;
+    return fstat(lhs, &lhs_stat) == 0 && fstat(rhs, &rhs_stat) == 0 &&
+           lhs_stat.st_dev == rhs_stat.st_dev && lhs_stat.st_ino == rhs_stat.st_ino;
+}
+}
+
+TEST_F(SocketMessenger, client_receives_message)
+{
+    send({'h', 'e', 'l', 'l', 'o'});
+
+    EXPECT_THAT(receive(), ElementsAre('h', 'e', 'l', 'l', 'o'));
+}
+
+TEST_F(SocketMessenger, send_does_not_wait_for_a_client_that_is_not_reading)
+{
+    auto const messages = 10;
+
+    // More than the socket holds: if send() waited for the client to read, this would never return
+    for (auto i = 0; i != messages; ++i)
+        send(filled('a' + i, large_message_size));
+
+    for (auto i = 0; i != messages; ++i)
+        EXPECT_THAT(receive(), Eq(filled('a' + i, large_message_size))) << "message " << i;
+}
+
+TEST_F(SocketMessenger, fds_arrive_after_the_messages_queued_before_them)
+{
+    int pipe_fds[2];
+    ASSERT_THAT(pipe(pipe_fds), Eq(0));
+    mir::Fd const read_end{pipe_fds[0]};
+    mir::Fd const write_end{pipe_fds[1]};
+
+    auto const messages = 5;
+    for (auto i = 0; i != messages; ++i)
+        send(filled('a' + i, large_message_size));
+    send({'f', 'd'}, {{read_end}});
+
+    for (auto i = 0; i != messages; ++i)
+        EXPECT_THAT(receive(), Eq(filled('a' + i, large_message_size))) << "message " << i;
+    EXPECT_THAT(receive(), ElementsAre('f', 'd'));
+
+    auto const fds = receive_fds(1);
+    EXPECT_TRUE(same_file(fds[0], read_end));
+}
+
+TEST_F(SocketMessenger, client_that_lets_too_much_queue_up_is_disconnected)
+{
+    auto const too_many = mfd::SocketMessenger::max_pending_bytes / large_message_size + 10;
+
+    EXPECT_THROW(
+        for (auto i = 0u; i != too_many; ++i)
+            send(filled('x', large_message_size)),
+        std::runtime_error);
+
+    // Once the client has read what the socket held, it sees the connection has gone
+    char buffer[4096];
+    ssize_t result;
+    while ((result = read(client, buffer, sizeof buffer)) > 0)
+        ;
+    EXPECT_THAT(result, Eq(0));
+}
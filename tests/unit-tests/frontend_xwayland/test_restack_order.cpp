@@ -0,0 +1,91 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/frontend_xwayland/restack_order.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace mf = mir::frontend;
+
+using namespace testing;
+
+TEST(RestackOrder, nothing_to_keep_when_there_are_no_windows)
+{
+    EXPECT_THAT(mf::windows_that_keep_their_order({}, {}), IsEmpty());
+    EXPECT_THAT(mf::windows_that_keep_their_order({1, 2, 3}, {}), IsEmpty());
+}
+
+TEST(RestackOrder, windows_never_stacked_before_all_move)
+{
+    EXPECT_THAT(mf::windows_that_keep_their_order({}, {1, 2, 3}), ElementsAre(false, false, false));
+    EXPECT_THAT(mf::windows_that_keep_their_order({4, 5}, {1, 2, 3}), ElementsAre(false, false, false));
+}
+
+TEST(RestackOrder, unchanged_order_keeps_every_window)
+{
+    EXPECT_THAT(mf::windows_that_keep_their_order({1, 2, 3, 4}, {1, 2, 3, 4}), ElementsAre(true, true, true, true));
+}
+
+TEST(RestackOrder, reversed_order_keeps_only_one_window)
+{
+    auto const stays = mf::windows_that_keep_their_order({1, 2, 3, 4}, {4, 3, 2, 1});
+
+    ASSERT_THAT(stays.size(), Eq(4u));
+    EXPECT_THAT(std::count(stays.begin(), stays.end(), true), Eq(1));
+}
+
+TEST(RestackOrder, raising_one_window_moves_only_that_window)
+{
+    EXPECT_THAT(mf::windows_that_keep_their_order({1, 2, 3, 4}, {1, 3, 4, 2}), ElementsAre(true, true, true, false));
+}
+
+TEST(RestackOrder, lowering_one_window_moves_only_that_window)
+{
+    EXPECT_THAT(mf::windows_that_keep_their_order({1, 2, 3, 4}, {3, 1, 2, 4}), ElementsAre(false, true, true, true));
+}
+
+TEST(RestackOrder, new_windows_move_and_known_ones_keep_their_order)
+{
+    EXPECT_THAT(mf::windows_that_keep_their_order({1, 2, 3}, {1, 7, 2, 3, 8}), ElementsAre(true, false, true, true, false));
+}
+
+TEST(RestackOrder, windows_no_longer_stacked_are_ignored)
+{
+    EXPECT_THAT(mf::windows_that_keep_their_order({1, 2, 3, 4}, {1, 4}), ElementsAre(true, true));
+}
+
+TEST(RestackOrder, a_window_listed_twice_is_kept_at_most_once)
+{
+    auto const stays = mf::windows_that_keep_their_order({1, 2}, {1, 1, 2});
+
+    ASSERT_THAT(stays.size(), Eq(3u));
+    EXPECT_THAT(std::count(stays.begin(), stays.end(), true), Eq(2));
+    EXPECT_TRUE(stays[2]);
+}
+
+TEST(RestackOrder, a_window_stacked_twice_before_uses_its_upper_position)
+{
+    EXPECT_THAT(mf::windows_that_keep_their_order({1, 2, 1, 3}, {2, 1, 3}), ElementsAre(true, true, true));
+}
+
+TEST(RestackOrder, mixed_reorder_keeps_a_longest_run)
+{
+    auto const stays = mf::windows_that_keep_their_order({1, 2, 3, 4, 5, 6}, {3, 1, 6, 2, 4, 5});
+
+    // 1, 2, 4, 5 are still in order; nothing longer is
+    EXPECT_THAT(stays, ElementsAre(false, true, false, true, true, true));
+}
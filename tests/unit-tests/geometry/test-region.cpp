@@ -0,0 +1,191 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/geometry/region.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <random>
+#include <set>
+#include <utility>
+
+using namespace mir::geometry;
+using namespace testing;
+
+namespace
+{
+using Pixels = std::set<std::pair<int, int>>;
+
+auto pixels_of(std::vector<Rectangle> const& rects) -> Pixels
+{
+    Pixels pixels;
+    for (auto const& rect : rects)
+    {
+        for (auto x = rect.left().as_int(); x < rect.right().as_int(); ++x)
+            for (auto y = rect.top().as_int(); y < rect.bottom().as_int(); ++y)
+                pixels.insert({x, y});
+    }
+    return pixels;
+}
+
+auto random_rectangles(std::mt19937& rng, int count) -> std::vector<Rectangle>
+{
+    std::uniform_int_distribution<int> position{-10, 30};
+    std::uniform_int_distribution<int> extent{0, 15};
+    std::vector<Rectangle> rects;
+    for (int i = 0; i != count; ++i)
+        rects.push_back({{position(rng), position(rng)}, {extent(rng), extent(rng)}});
+    return rects;
+}
+
+/// The banding invariants: no box empty, bands in order, boxes in a band in order and apart
+void expect_banded(Region const& region)
+{
+    auto const& boxes = region.boxes();
+    for (size_t i = 0; i != boxes.size(); ++i)
+    {
+        auto const& box = boxes[i];
+        EXPECT_THAT(box.x1, Lt(box.x2));
+        EXPECT_THAT(box.y1, Lt(box.y2));
+        if (i == 0)
+            continue;
+
+        auto const& before = boxes[i - 1];
+        if (before.y1 == box.y1)
+        {
+            EXPECT_THAT(before.y2, Eq(box.y2));
+            EXPECT_THAT(before.x2, Lt(box.x1));
+        }
+        else
+        {
+            EXPECT_THAT(before.y2, Le(box.y1));
+        }
+    }
+}
+}
+
+TEST(Region, is_empty_by_default)
+{
+    Region const region;
+
+    EXPECT_TRUE(region.empty());
+    EXPECT_THAT(region.bounding_rectangle(), Eq(Rectangle{}));
+    EXPECT_FALSE(region.contains(Point{0, 0}));
+}
+
+TEST(Region, of_an_empty_rectangle_is_empty)
+{
+    EXPECT_TRUE((Region{Rectangle{{5, 5}, {0, 10}}}.empty()));
+    EXPECT_TRUE(Region{Rectangle{}}.empty());
+}
+
+TEST(Region, contains_the_points_of_its_rectangles)
+{
+    Region const region{{{0, 0}, {10, 10}}, {{20, 0}, {10, 10}}};
+
+    EXPECT_TRUE(region.contains(Point{0, 0}));
+    EXPECT_TRUE(region.contains(Point{29, 9}));
+    EXPECT_FALSE(region.contains(Point{15, 5}));
+    EXPECT_FALSE(region.contains(Point{10, 0}));
+    EXPECT_FALSE(region.contains(Point{0, 10}));
+}
+
+TEST(Region, overlapping_rectangles_are_merged)
+{
+    Region const region{{{0, 0}, {10, 10}}, {{5, 0}, {10, 10}}};
+
+    EXPECT_THAT(region.rectangles(), ElementsAre(Rectangle{{0, 0}, {15, 10}}));
+}
+
+TEST(Region, alike_bands_that_touch_are_merged)
+{
+    Region const region{{{0, 0}, {10, 10}}, {{0, 10}, {10, 10}}};
+
+    EXPECT_THAT(region.rectangles(), ElementsAre(Rectangle{{0, 0}, {10, 20}}));
+}
+
+TEST(Region, subtracting_a_hole_leaves_a_frame)
+{
+    auto const frame = Region{Rectangle{{0, 0}, {30, 30}}} - Region{Rectangle{{10, 10}, {10, 10}}};
+
+    EXPECT_THAT(frame.rectangles(), ElementsAre(
+        Rectangle{{0, 0}, {30, 10}},
+        Rectangle{{0, 10}, {10, 10}},
+        Rectangle{{20, 10}, {10, 10}},
+        Rectangle{{0, 20}, {30, 10}}));
+    EXPECT_FALSE(frame.contains(Point{15, 15}));
+    EXPECT_TRUE(frame.overlaps(Rectangle{{5, 5}, {10, 10}}));
+    EXPECT_FALSE(frame.overlaps(Rectangle{{12, 12}, {5, 5}}));
+    EXPECT_FALSE(frame.contains(Rectangle{{5, 5}, {10, 10}}));
+    EXPECT_TRUE(frame.contains(Rectangle{{0, 0}, {30, 10}}));
+}
+
+TEST(Region, equal_areas_are_equal_however_they_were_built)
+{
+    Region const whole{Rectangle{{0, 0}, {20, 20}}};
+    Region const pieces{
+        {{0, 0}, {20, 5}},
+        {{0, 5}, {7, 15}},
+        {{7, 5}, {13, 15}}};
+
+    EXPECT_THAT(pieces, Eq(whole));
+}
+
+TEST(Region, translates)
+{
+    Region region{Rectangle{{0, 0}, {10, 10}}};
+
+    region.translate({5, -5});
+
+    EXPECT_THAT(region.bounding_rectangle(), Eq(Rectangle{{5, -5}, {10, 10}}));
+}
+
+TEST(Region, operations_match_those_on_pixels)
+{
+    std::mt19937 rng{42};
+
+    for (int i = 0; i != 200; ++i)
+    {
+        auto const a_rects = random_rectangles(rng, 1 + i % 7);
+        auto const b_rects = random_rectangles(rng, 1 + i % 5);
+        auto const a_pixels = pixels_of(a_rects);
+        auto const b_pixels = pixels_of(b_rects);
+        Region const a{a_rects};
+        Region const b{b_rects};
+
+        Pixels united, intersected, subtracted;
+        std::set_union(a_pixels.begin(), a_pixels.end(), b_pixels.begin(), b_pixels.end(),
+                       std::inserter(united, united.end()));
+        std::set_intersection(a_pixels.begin(), a_pixels.end(), b_pixels.begin(), b_pixels.end(),
+                              std::inserter(intersected, intersected.end()));
+        std::set_difference(a_pixels.begin(), a_pixels.end(), b_pixels.begin(), b_pixels.end(),
+                            std::inserter(subtracted, subtracted.end()));
+
+        EXPECT_THAT(pixels_of(a.rectangles()), Eq(a_pixels));
+        EXPECT_THAT(pixels_of((a | b).rectangles()), Eq(united));
+        EXPECT_THAT(pixels_of((a & b).rectangles()), Eq(intersected));
+        EXPECT_THAT(pixels_of((a - b).rectangles()), Eq(subtracted));
+        expect_banded(a | b);
+        expect_banded(a & b);
+        expect_banded(a - b);
+
+        auto const subtracted_region = a - b;
+        for (int x = -12; x != 48; ++x)
+            for (int y = -12; y != 48; ++y)
+                EXPECT_THAT(subtracted_region.contains(Point{x, y}), Eq(subtracted.count({x, y}) > 0));
+    }
+}
@@ -2,11 +2,14 @@
 
 #include "src/server/graphics/offscreen/display.h"
 #include "mir/graphics/default_display_configuration_policy.h"
+#include "mir/graphics/display_configuration.h"
+#include "mir/graphics/virtual_output.h"
 #include "mir/renderer/gl/render_target.h"
 #include "src/server/report/null_report_factory.h"
 
 #include "mir/test/doubles/mock_egl.h"
 #include "mir/test/doubles/mock_gl.h"
+#include "mir/test/doubles/mock_event_handler_register.h"
 #include "mir/test/as_render_target.h"
 
 #include <gmock/gmock.h>
@@ -19,6 +22,7 @@ namespace mgo=mir::graphics::offscreen;
 namespace mtd=mir::test::doubles;
 namespace mr = mir::report;
 namespace mt = mir::test;
+namespace geom = mir::geometry;
 
 namespace
 {
@@ -44,8 +48,19 @@ public:
     ::testing::NiceMock<mtd::MockEGL> mock_egl;
     ::testing::NiceMock<mtd::MockGL> mock_gl;
     EGLNativeDisplayType const native_display{reinterpret_cast<EGLNativeDisplayType>(0x12345)};
+    double const unthrottled{0};
 };
 
+auto output_sizes(mg::Display const& display) -> std::vector<geom::Size>
+{
+    std::vector<geom::Size> sizes;
+    display.configuration()->for_each_output([&](mg::DisplayConfigurationOutput const& output)
+        {
+            sizes.push_back(output.modes[output.current_mode_index].size);
+        });
+    return sizes;
+}
+
 }
 
 TEST_F(OffscreenDisplayTest, uses_basic_platform_egl_native_display)
@@ -59,7 +74,8 @@ TEST_F(OffscreenDisplayTest, uses_basic_platform_egl_native_display)
     mgo::Display display{
         native_display,
         std::make_shared<mg::CloneDisplayConfigurationPolicy>(),
-        mr::null_display_report()};
+        mr::null_display_report(),
+        unthrottled};
 }
 
 TEST_F(OffscreenDisplayTest, orientation_normal)
@@ -68,7 +84,8 @@ TEST_F(OffscreenDisplayTest, orientation_normal)
     mgo::Display display{
         native_display,
         std::make_shared<mg::CloneDisplayConfigurationPolicy>(),
-        mr::null_display_report()};
+        mr::null_display_report(),
+        unthrottled};
 
     int count = 0;
     display.for_each_display_sync_group([&](mg::DisplaySyncGroup& group) {
@@ -86,7 +103,8 @@ TEST_F(OffscreenDisplayTest, never_enables_predictive_bypass)
     mgo::Display display{
         native_display,
         std::make_shared<mg::CloneDisplayConfigurationPolicy>(),
-        mr::null_display_report()};
+        mr::null_display_report(),
+        unthrottled};
 
     int groups = 0;
     display.for_each_display_sync_group([&](mg::DisplaySyncGroup& group){
@@ -121,7 +139,8 @@ TEST_F(OffscreenDisplayTest, makes_fbo_current_rendering_target)
     mgo::Display display{
         native_display,
         std::make_shared<mg::CloneDisplayConfigurationPolicy>(),
-        mr::null_display_report()};
+        mr::null_display_report(),
+        unthrottled};
 
     Mock::VerifyAndClearExpectations(&mock_gl);
 
@@ -170,6 +189,172 @@ TEST_F(OffscreenDisplayTest, restores_previous_state_on_fbo_setup_failure)
         mgo::Display display(
             native_display,
             std::make_shared<mg::CloneDisplayConfigurationPolicy>(),
-            mr::null_display_report());
+            mr::null_display_report(),
+            unthrottled);
     }, std::runtime_error);
 }
+
+TEST_F(OffscreenDisplayTest, waits_for_the_gpu_on_swap_without_fence_sync)
+{
+    using namespace ::testing;
+
+    mgo::Display display{
+        native_display,
+        std::make_shared<mg::CloneDisplayConfigurationPolicy>(),
+        mr::null_display_report(),
+        unthrottled};
+
+    display.for_each_display_sync_group([&](mg::DisplaySyncGroup& group) {
+        group.for_each_display_buffer([&](mg::DisplayBuffer& db) {
+            EXPECT_CALL(mock_gl, glFinish());
+            mt::as_render_target(db)->swap_buffers();
+            Mock::VerifyAndClearExpectations(&mock_gl);
+        });
+    });
+}
+
+TEST_F(OffscreenDisplayTest, swap_with_fence_sync_only_waits_for_the_oldest_frame_in_flight)
+{
+    using namespace ::testing;
+
+    ON_CALL(mock_egl, eglQueryString(_, EGL_EXTENSIONS))
+        .WillByDefault(Return("EGL_KHR_image_base EGL_KHR_fence_sync"));
+
+    int fence_storage[3];
+    EGLSyncKHR const fences[] = {&fence_storage[0], &fence_storage[1], &fence_storage[2]};
+    EXPECT_CALL(mock_egl, eglCreateSyncKHR(_, EGL_SYNC_FENCE_KHR, _))
+        .WillOnce(Return(fences[0]))
+        .WillOnce(Return(fences[1]))
+        .WillOnce(Return(fences[2]));
+
+    mgo::Display display{
+        native_display,
+        std::make_shared<mg::CloneDisplayConfigurationPolicy>(),
+        mr::null_display_report(),
+        unthrottled};
+
+    display.for_each_display_sync_group([&](mg::DisplaySyncGroup& group) {
+        group.for_each_display_buffer([&](mg::DisplayBuffer& db) {
+            EXPECT_CALL(mock_gl, glFinish()).Times(0);
+            EXPECT_CALL(mock_egl, eglClientWaitSyncKHR(_, _, _, _)).Times(0);
+
+            mt::as_render_target(db)->swap_buffers();
+            mt::as_render_target(db)->swap_buffers();
+            Mock::VerifyAndClearExpectations(&mock_egl);
+
+            EXPECT_CALL(mock_egl, eglClientWaitSyncKHR(_, fences[0], _, _));
+            mt::as_render_target(db)->swap_buffers();
+            Mock::VerifyAndClearExpectations(&mock_egl);
+            Mock::VerifyAndClearExpectations(&mock_gl);
+        });
+    });
+}
+
+TEST_F(OffscreenDisplayTest, each_post_is_a_frame_on_its_output)
+{
+    mgo::Display display{
+        native_display,
+        std::make_shared<mg::CloneDisplayConfigurationPolicy>(),
+        mr::null_display_report(),
+        unthrottled};
+
+    auto const conf = display.configuration();
+    unsigned output_id{0};
+    conf->for_each_output([&](mg::DisplayConfigurationOutput const& output)
+        {
+            if (output.used)
+                output_id = output.id.as_value();
+        });
+
+    auto const before = display.last_frame_on(output_id);
+    display.for_each_display_sync_group([](mg::DisplaySyncGroup& group) { group.post(); });
+
+    EXPECT_THAT(display.last_frame_on(output_id).msc, testing::Eq(before.msc + 1));
+}
+
+TEST_F(OffscreenDisplayTest, enabling_a_virtual_output_hotplugs_an_output_of_its_size)
+{
+    using namespace ::testing;
+
+    auto const display = std::make_shared<mgo::Display>(
+        native_display,
+        std::make_shared<mg::CloneDisplayConfigurationPolicy>(),
+        mr::null_display_report(),
+        unthrottled);
+
+    NiceMock<mtd::MockEventHandlerRegister> handler_register;
+    int changes{0};
+    display->register_configuration_change_handler(handler_register, [&changes] { ++changes; });
+
+    auto const virtual_output = display->create_virtual_output(1920, 1080);
+    ASSERT_THAT(virtual_output, NotNull());
+    virtual_output->enable();
+
+    EXPECT_THAT(changes, Eq(1));
+    EXPECT_THAT(output_sizes(*display), Contains(geom::Size{1920, 1080}));
+}
+
+TEST_F(OffscreenDisplayTest, disabling_a_virtual_output_unplugs_it)
+{
+    using namespace ::testing;
+
+    auto const display = std::make_shared<mgo::Display>(
+        native_display,
+        std::make_shared<mg::CloneDisplayConfigurationPolicy>(),
+        mr::null_display_report(),
+        unthrottled);
+    auto const initial_sizes = output_sizes(*display);
+
+    NiceMock<mtd::MockEventHandlerRegister> handler_register;
+    int changes{0};
+    display->register_configuration_change_handler(handler_register, [&changes] { ++changes; });
+
+    auto const virtual_output = display->create_virtual_output(1920, 1080);
+    virtual_output->enable();
+    virtual_output->disable();
+
+    EXPECT_THAT(changes, Eq(2));
+    EXPECT_THAT(output_sizes(*display), Eq(initial_sizes));
+}
+
+TEST_F(OffscreenDisplayTest, a_virtual_output_can_outlive_its_display)
+{
+    auto display = std::make_shared<mgo::Display>(
+        native_display,
+        std::make_shared<mg::CloneDisplayConfigurationPolicy>(),
+        mr::null_display_report(),
+        unthrottled);
+
+    auto const virtual_output = display->create_virtual_output(1920, 1080);
+    virtual_output->enable();
+    display.reset();
+
+    virtual_output->disable();
+    virtual_output->enable();
+}
+
+TEST_F(OffscreenDisplayTest, configure_incrementally_releases_every_group_before_replacing_it)
+{
+    using namespace ::testing;
+
+    mgo::Display display{
+        native_display,
+        std::make_shared<mg::CloneDisplayConfigurationPolicy>(),
+        mr::null_display_report(),
+        unthrottled};
+
+    std::vector<mg::DisplaySyncGroup*> groups_before;
+    display.for_each_display_sync_group([&](mg::DisplaySyncGroup& group) { groups_before.push_back(&group); });
+    ASSERT_THAT(groups_before, Not(IsEmpty()));
+
+    std::vector<mg::DisplaySyncGroup*> released;
+    display.configure_incrementally(
+        *display.configuration(),
+        [&](mg::DisplaySyncGroup& group) { released.push_back(&group); });
+
+    EXPECT_THAT(released, UnorderedElementsAreArray(groups_before));
+
+    int groups_after{0};
+    display.for_each_display_sync_group([&](mg::DisplaySyncGroup&) { ++groups_after; });
+    EXPECT_THAT(groups_after, Eq(static_cast<int>(groups_before.size())));
+}
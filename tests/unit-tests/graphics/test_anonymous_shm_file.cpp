@@ -19,6 +19,11 @@
 #include "mir/anonymous_shm_file.h"
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
+
 TEST(AnonymousShmFile, is_created)
 {
     size_t const file_size{100};
@@ -63,3 +68,43 @@ TEST(AnonymousShmFile, writing_to_base_ptr_writes_to_file)
         EXPECT_EQ(base_ptr[i], buffer[i]) << "i=" << i;
     }
 }
+
+TEST(AnonymousShmFile, with_huge_pages_and_prefaulting_is_zeroed)
+{
+    size_t const file_size{4 * 1024 * 1024};
+    mir::AnonymousShmFile::Options options;
+    options.huge_pages = true;
+    options.prefault = true;
+
+    mir::AnonymousShmFile shm_file{file_size, options};
+
+    auto const base_ptr = static_cast<uint8_t const*>(shm_file.base_ptr());
+    EXPECT_TRUE(std::all_of(base_ptr, base_ptr + file_size, [](uint8_t byte) { return byte == 0; }));
+}
+
+TEST(AnonymousShmFile, cannot_be_sealed_unless_sealable)
+{
+    mir::AnonymousShmFile shm_file{100};
+
+    EXPECT_FALSE(shm_file.seal());
+}
+
+TEST(AnonymousShmFile, sealed_file_keeps_its_content_and_refuses_writes)
+{
+    size_t const file_size{100};
+    mir::AnonymousShmFile::Options options;
+    options.sealable = true;
+
+    mir::AnonymousShmFile shm_file{file_size, options};
+    memset(shm_file.base_ptr(), 0x5a, file_size);
+
+    ASSERT_TRUE(shm_file.seal());
+
+    auto const base_ptr = static_cast<uint8_t const*>(shm_file.base_ptr());
+    EXPECT_TRUE(std::all_of(base_ptr, base_ptr + file_size, [](uint8_t byte) { return byte == 0x5a; }));
+
+    uint8_t const byte{0};
+    EXPECT_EQ(-1, pwrite(shm_file.fd(), &byte, 1, 0));
+    EXPECT_EQ(-1, ftruncate(shm_file.fd(), 2 * file_size));
+    EXPECT_EQ(MAP_FAILED, mmap(nullptr, file_size, PROT_READ|PROT_WRITE, MAP_SHARED, shm_file.fd(), 0));
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/graphics/buffer_pool.h"
+
+#include "mir/test/doubles/stub_buffer_allocator.h"
+#include "mir/test/doubles/advanceable_clock.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace mg = mir::graphics;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+using namespace testing;
+
+namespace
+{
+struct BufferPool : Test
+{
+    std::shared_ptr<mtd::AdvanceableClock> const clock{std::make_shared<mtd::AdvanceableClock>()};
+    mg::BufferPool pool{std::make_shared<mtd::StubBufferAllocator>(), clock};
+
+    geom::Size const size{64, 32};
+    MirPixelFormat const format{mir_pixel_format_argb_8888};
+};
+}
+
+TEST_F(BufferPool, released_buffer_is_given_out_again_with_a_new_id)
+{
+    auto first = pool.alloc_software_buffer(size, format);
+    auto const first_id = first->id();
+    auto const first_native = first->native_buffer_base();
+    first.reset();
+
+    auto const second = pool.alloc_software_buffer(size, format);
+
+    EXPECT_THAT(second->native_buffer_base(), Eq(first_native));
+    EXPECT_THAT(second->id(), Ne(first_id));
+    EXPECT_THAT(second->size(), Eq(size));
+    EXPECT_THAT(pool.idle_buffers(), Eq(0));
+}
+
+TEST_F(BufferPool, buffer_in_use_is_not_given_out_again)
+{
+    auto const first = pool.alloc_software_buffer(size, format);
+    auto const second = pool.alloc_software_buffer(size, format);
+
+    EXPECT_THAT(second->native_buffer_base(), Ne(first->native_buffer_base()));
+}
+
+TEST_F(BufferPool, released_buffer_is_not_given_out_for_another_size_or_format)
+{
+    auto first = pool.alloc_software_buffer(size, format);
+    auto const first_native = first->native_buffer_base();
+    first.reset();
+
+    auto const other_size = pool.alloc_software_buffer(geom::Size{32, 64}, format);
+    auto const other_format = pool.alloc_software_buffer(size, mir_pixel_format_abgr_8888);
+
+    EXPECT_THAT(other_size->native_buffer_base(), Ne(first_native));
+    EXPECT_THAT(other_format->native_buffer_base(), Ne(first_native));
+    EXPECT_THAT(pool.idle_buffers(), Eq(1));
+}
+
+TEST_F(BufferPool, keeps_no_more_than_max_idle_buffers)
+{
+    std::vector<std::shared_ptr<mg::Buffer>> buffers;
+    for (int i = 0; i != mg::BufferPool::max_idle_buffers + 5; ++i)
+        buffers.push_back(pool.alloc_software_buffer(size, format));
+
+    buffers.clear();
+
+    EXPECT_THAT(pool.idle_buffers(), Eq(mg::BufferPool::max_idle_buffers));
+}
+
+TEST_F(BufferPool, drops_buffers_idle_for_longer_than_max_idle_time)
+{
+    pool.alloc_software_buffer(size, format);
+    ASSERT_THAT(pool.idle_buffers(), Eq(1));
+
+    clock->advance_by(mg::BufferPool::max_idle_time + std::chrono::seconds{1});
+    pool.alloc_software_buffer(geom::Size{1, 1}, format);
+
+    // Only the buffer just released remains
+    EXPECT_THAT(pool.idle_buffers(), Eq(1));
+}
+
+TEST_F(BufferPool, buffers_can_outlive_the_pool)
+{
+    auto short_lived = std::make_unique<mg::BufferPool>(std::make_shared<mtd::StubBufferAllocator>(), clock);
+    auto buffer = short_lived->alloc_software_buffer(size, format);
+
+    short_lived.reset();
+
+    EXPECT_NO_THROW(buffer.reset());
+}
@@ -0,0 +1,200 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/platform/graphics/dmabuf_format_cache.h"
+
+#include "mir_test_framework/temporary_environment_value.h"
+
+#include <boost/filesystem.hpp>
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <fstream>
+#include <system_error>
+
+#include <drm_fourcc.h>
+#include <stdlib.h>
+
+namespace mg = mir::graphics;
+namespace mtf = mir_test_framework;
+
+using namespace testing;
+
+namespace
+{
+struct DmaBufFormatCache : Test
+{
+    DmaBufFormatCache()
+    {
+        char tmp_name[] = "/tmp/mir_dmabuf_format_cache_XXXXXX";
+        if (!mkdtemp(tmp_name))
+            throw std::system_error{errno, std::system_category(), "Failed to create temporary directory"};
+        home = tmp_name;
+        directory = home + "/mir";
+    }
+
+    ~DmaBufFormatCache()
+    {
+        boost::system::error_code ec;
+        boost::filesystem::remove_all(home, ec);
+    }
+
+    std::string home;
+    std::string directory;
+
+    std::string const driver{"Vendor\n1.5\nEGL_EXT_image_dma_buf_import\n"};
+    mg::DmaBufFormatTable const table{
+        {DRM_FORMAT_ARGB8888, DRM_FORMAT_NV12},
+        {{DRM_FORMAT_MOD_LINEAR, I915_FORMAT_MOD_X_TILED}, {DRM_FORMAT_MOD_INVALID}},
+        {{EGL_FALSE, EGL_FALSE}, {EGL_TRUE}}};
+};
+
+MATCHER_P(IsTable, expected, "")
+{
+    return arg.formats == expected.formats &&
+           arg.modifiers_for_format == expected.modifiers_for_format &&
+           arg.external_only_for_format == expected.external_only_for_format;
+}
+}
+
+TEST_F(DmaBufFormatCache, loads_a_stored_table)
+{
+    mg::DmaBufFormatCache const cache{directory, driver};
+
+    ASSERT_TRUE(cache.store(table));
+
+    auto const loaded = cache.load();
+    ASSERT_TRUE(loaded);
+    EXPECT_THAT(*loaded, IsTable(table));
+}
+
+TEST_F(DmaBufFormatCache, a_later_instance_for_the_same_driver_loads_the_table)
+{
+    ASSERT_TRUE((mg::DmaBufFormatCache{directory, driver}.store(table)));
+
+    auto const loaded = mg::DmaBufFormatCache{directory, driver}.load();
+    ASSERT_TRUE(loaded);
+    EXPECT_THAT(*loaded, IsTable(table));
+}
+
+TEST_F(DmaBufFormatCache, loads_nothing_before_a_table_is_stored)
+{
+    mg::DmaBufFormatCache const cache{directory, driver};
+
+    EXPECT_FALSE(cache.load());
+}
+
+TEST_F(DmaBufFormatCache, different_drivers_are_cached_apart)
+{
+    mg::DmaBufFormatCache const cache{directory, driver};
+    mg::DmaBufFormatCache const other_driver_cache{directory, driver + "device 226\n"};
+
+    ASSERT_TRUE(cache.store(table));
+
+    EXPECT_THAT(other_driver_cache.path(), Ne(cache.path()));
+    EXPECT_FALSE(other_driver_cache.load());
+}
+
+TEST_F(DmaBufFormatCache, cache_for_another_driver_is_not_loaded)
+{
+    mg::DmaBufFormatCache const cache{directory, driver};
+    ASSERT_TRUE(cache.store(table));
+
+    // As if another driver's identity hashed to the same file
+    boost::filesystem::create_directories(directory + "/other");
+    mg::DmaBufFormatCache const other{directory + "/other", driver + "upgraded\n"};
+    ASSERT_TRUE(other.store(table));
+    boost::filesystem::rename(other.path(), cache.path());
+
+    EXPECT_FALSE(cache.load());
+}
+
+TEST_F(DmaBufFormatCache, truncated_cache_is_not_loaded)
+{
+    mg::DmaBufFormatCache const cache{directory, driver};
+    ASSERT_TRUE(cache.store(table));
+
+    auto const size = boost::filesystem::file_size(cache.path());
+    for (auto length : {size - 1, size / 2, decltype(size){4}, decltype(size){0}})
+    {
+        ASSERT_TRUE(cache.store(table));
+        boost::filesystem::resize_file(cache.path(), length);
+        EXPECT_FALSE(cache.load()) << "truncated to " << length << " bytes";
+    }
+}
+
+TEST_F(DmaBufFormatCache, garbage_is_not_loaded)
+{
+    mg::DmaBufFormatCache const cache{directory, driver};
+    ASSERT_TRUE(cache.store(table));
+
+    std::ofstream{cache.path(), std::ios::binary | std::ios::trunc} << std::string(4096, '\xff');
+
+    EXPECT_FALSE(cache.load());
+}
+
+TEST_F(DmaBufFormatCache, store_creates_the_cache_directory)
+{
+    mg::DmaBufFormatCache const cache{directory, driver};
+    ASSERT_FALSE(boost::filesystem::exists(directory));
+
+    EXPECT_TRUE(cache.store(table));
+    EXPECT_TRUE(boost::filesystem::is_directory(directory));
+}
+
+TEST_F(DmaBufFormatCache, store_reports_failure_to_write)
+{
+    // A file where the directory should be
+    std::ofstream{directory};
+    mg::DmaBufFormatCache const cache{directory, driver};
+
+    EXPECT_FALSE(cache.store(table));
+}
+
+TEST_F(DmaBufFormatCache, default_directory_is_under_xdg_cache_home)
+{
+    mtf::TemporaryEnvironmentValue const disable{"MIR_DMABUF_DISABLE_FORMAT_CACHE", nullptr};
+    mtf::TemporaryEnvironmentValue const cache_home{"XDG_CACHE_HOME", "/xdg/cache"};
+    mtf::TemporaryEnvironmentValue const home{"HOME", "/home/user"};
+
+    EXPECT_THAT(mg::DmaBufFormatCache::default_directory(), Eq("/xdg/cache/mir"));
+}
+
+TEST_F(DmaBufFormatCache, default_directory_falls_back_to_home)
+{
+    mtf::TemporaryEnvironmentValue const disable{"MIR_DMABUF_DISABLE_FORMAT_CACHE", nullptr};
+    mtf::TemporaryEnvironmentValue const cache_home{"XDG_CACHE_HOME", nullptr};
+    mtf::TemporaryEnvironmentValue const home{"HOME", "/home/user"};
+
+    EXPECT_THAT(mg::DmaBufFormatCache::default_directory(), Eq("/home/user/.cache/mir"));
+}
+
+TEST_F(DmaBufFormatCache, default_directory_is_empty_without_anywhere_to_cache)
+{
+    mtf::TemporaryEnvironmentValue const disable{"MIR_DMABUF_DISABLE_FORMAT_CACHE", nullptr};
+    mtf::TemporaryEnvironmentValue const cache_home{"XDG_CACHE_HOME", nullptr};
+    mtf::TemporaryEnvironmentValue const home{"HOME", nullptr};
+
+    EXPECT_THAT(mg::DmaBufFormatCache::default_directory(), IsEmpty());
+}
+
+TEST_F(DmaBufFormatCache, default_directory_is_empty_when_caching_is_disabled)
+{
+    mtf::TemporaryEnvironmentValue const disable{"MIR_DMABUF_DISABLE_FORMAT_CACHE", "1"};
+    mtf::TemporaryEnvironmentValue const cache_home{"XDG_CACHE_HOME", "/xdg/cache"};
+
+    EXPECT_THAT(mg::DmaBufFormatCache::default_directory(), IsEmpty());
+}
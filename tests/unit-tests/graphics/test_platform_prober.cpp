@@ -17,6 +17,7 @@
  */
 
 #include <gtest/gtest.h>
+#include <gmock/gmock.h>
 #include <fcntl.h>
 #include <boost/throw_exception.hpp>
 
@@ -39,6 +40,9 @@
 #include "mir_test_framework/udev_environment.h"
 #include "mir_test_framework/executable_path.h"
 
+#include <atomic>
+#include <thread>
+
 namespace mtd = mir::test::doubles;
 namespace mtf = mir_test_framework;
 
@@ -149,6 +153,44 @@ public:
     }
 };
 
+/// Counts the devices it has handed out that are still held
+class CountingConsoleServices : public StubConsoleServices
+{
+public:
+    std::future<std::unique_ptr<mir::Device>> acquire_device(
+        int, int,
+        std::unique_ptr<mir::Device::Observer>) override
+    {
+        std::promise<std::unique_ptr<mir::Device>> promise;
+        promise.set_value(std::make_unique<CountedDevice>(*this));
+        return promise.get_future();
+    }
+
+    std::atomic<int> held{0};
+    std::atomic<int> most_held{0};
+
+private:
+    struct CountedDevice : mir::Device
+    {
+        CountedDevice(CountingConsoleServices& console)
+            : console{console}
+        {
+            auto const now_held = ++console.held;
+            auto most = console.most_held.load();
+            while (now_held > most && !console.most_held.compare_exchange_weak(most, now_held))
+            {
+            }
+        }
+
+        ~CountedDevice()
+        {
+            --console.held;
+        }
+
+        CountingConsoleServices& console;
+    };
+};
+
 class ServerPlatformProbeMockDRM : public ::testing::Test
 {
 #if defined(MIR_BUILD_PLATFORM_GBM_KMS)
@@ -274,3 +316,96 @@ TEST_F(ServerPlatformProbeMockDRM, IgnoresNonPlatformModules)
         std::make_shared<StubConsoleServices>());
     EXPECT_NE(nullptr, module);
 }
+
+TEST(ProbeConsoleServices, concurrent_probes_hold_a_device_one_at_a_time)
+{
+    using namespace testing;
+    auto const console = std::make_shared<CountingConsoleServices>();
+    mir::graphics::ProbeConsoleServices probe_console{console};
+
+    std::vector<std::thread> probes;
+    for (auto i = 0; i != 4; ++i)
+    {
+        probes.emplace_back(
+            [&probe_console]
+            {
+                for (auto j = 0; j != 20; ++j)
+                {
+                    auto const device = probe_console.acquire_device(226, 0, nullptr).get();
+                    std::this_thread::yield();
+                }
+            });
+    }
+    for (auto& probe : probes)
+        probe.join();
+
+    EXPECT_THAT(console->most_held.load(), Eq(1));
+    EXPECT_THAT(console->held.load(), Eq(0));
+}
+
+TEST(ProbeConsoleServices, probes_hold_different_devices_at_once)
+{
+    using namespace testing;
+    auto const console = std::make_shared<CountingConsoleServices>();
+    mir::graphics::ProbeConsoleServices probe_console{console};
+
+    auto const first = probe_console.acquire_device(226, 0, nullptr).get();
+    auto second = std::async(
+        std::launch::async,
+        [&probe_console] { return probe_console.acquire_device(226, 1, nullptr).get(); });
+
+    ASSERT_THAT(second.wait_for(std::chrono::seconds{5}), Eq(std::future_status::ready));
+    EXPECT_THAT(console->held.load(), Eq(2));
+}
+
+TEST(ProbeConsoleServices, a_probe_can_take_a_device_it_holds_again)
+{
+    using namespace testing;
+    auto const console = std::make_shared<CountingConsoleServices>();
+    mir::graphics::ProbeConsoleServices probe_console{console};
+
+    auto again = std::async(
+        std::launch::async,
+        [&probe_console]
+        {
+            auto const first = probe_console.acquire_device(226, 0, nullptr).get();
+            auto const second = probe_console.acquire_device(226, 0, nullptr).get();
+        });
+
+    EXPECT_THAT(again.wait_for(std::chrono::seconds{5}), Eq(std::future_status::ready));
+}
+
+TEST(ProbeConsoleServices, a_device_destroyed_on_another_thread_is_free_for_other_probes)
+{
+    using namespace testing;
+    auto const console = std::make_shared<CountingConsoleServices>();
+    mir::graphics::ProbeConsoleServices probe_console{console};
+
+    auto device = std::async(
+        std::launch::async,
+        [&probe_console] { return probe_console.acquire_device(226, 0, nullptr).get(); }).get();
+    device.reset();
+
+    auto other = std::async(
+        std::launch::async,
+        [&probe_console] { return probe_console.acquire_device(226, 0, nullptr).get(); });
+
+    EXPECT_THAT(other.wait_for(std::chrono::seconds{5}), Eq(std::future_status::ready));
+}
+
+TEST(ProbeConsoleServices, a_device_the_probe_never_gets_is_free_for_other_probes)
+{
+    using namespace testing;
+    auto const console = std::make_shared<CountingConsoleServices>();
+    mir::graphics::ProbeConsoleServices probe_console{console};
+
+    std::async(
+        std::launch::async,
+        [&probe_console] { probe_console.acquire_device(226, 0, nullptr); }).get();
+
+    auto other = std::async(
+        std::launch::async,
+        [&probe_console] { return probe_console.acquire_device(226, 0, nullptr).get(); });
+
+    EXPECT_THAT(other.wait_for(std::chrono::seconds{5}), Eq(std::future_status::ready));
+}
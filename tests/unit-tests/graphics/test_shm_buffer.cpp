@@ -31,6 +31,8 @@
 #include <EGL/egl.h>
 #include <endian.h>
 #include <boost/throw_exception.hpp>
+#include <chrono>
+#include <future>
 
 namespace mg = mir::graphics;
 namespace mgc = mir::graphics::common;
@@ -362,3 +364,417 @@ TEST_F(ShmBufferTest, texture_is_destroyed_on_thread_with_current_context)
         eglMakeCurrent(dummy_dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
     }
 }
+
+namespace
+{
+struct ReplacingShmBuffer : mgc::ShmBuffer
+{
+    ReplacingShmBuffer(
+        geom::Size const& size,
+        std::shared_ptr<mgc::EGLContextExecutor> egl_delegate,
+        std::shared_ptr<mg::Buffer> const& previous,
+        std::experimental::optional<geom::Rectangles> const& damage)
+        : ShmBuffer(size, mir_pixel_format_rgb_565, std::move(egl_delegate), previous, damage),
+          pixels(new unsigned char[stride().as_int() * size.height.as_int()])
+    {
+    }
+
+    void bind() override
+    {
+        ShmBuffer::bind();
+        upload_damage_to_texture(pixels.get(), stride());
+    }
+
+    auto stride() const -> geom::Stride
+    {
+        return geom::Stride{MIR_BYTES_PER_PIXEL(mir_pixel_format_rgb_565) * size().width.as_int()};
+    }
+
+    std::shared_ptr<mg::NativeBuffer> native_buffer_handle() const override
+    {
+        return nullptr;
+    }
+
+    std::unique_ptr<unsigned char[]> const pixels;
+};
+}
+
+TEST_F(ShmBufferTest, replacing_buffer_uploads_only_damage)
+{
+    geom::Rectangle const damage{{10, 20}, {30, 40}};
+
+    auto const first = std::make_shared<ReplacingShmBuffer>(
+        size, egl_delegate, nullptr, std::experimental::nullopt);
+    auto const second = std::make_shared<ReplacingShmBuffer>(
+        size, egl_delegate, first, geom::Rectangles{damage});
+
+    EXPECT_CALL(mock_gl, glGenTextures(1, _)).WillOnce(SetArgPointee<1>(1));
+    EXPECT_CALL(mock_gl, glTexImage2D(_, _, _, _, _, _, _, _, first->pixels.get())).Times(1);
+    EXPECT_CALL(mock_gl, glTexImage2D(_, _, _, _, _, _, _, _, second->pixels.get())).Times(0);
+    EXPECT_CALL(mock_gl, glTexSubImage2D(
+        GL_TEXTURE_2D, 0,
+        10, 20, 30, 40,
+        GL_RGB, GL_UNSIGNED_SHORT_5_6_5,
+        second->pixels.get() + 20 * second->stride().as_int() + 10 * 2));
+
+    first->bind();
+    second->bind();
+}
+
+TEST_F(ShmBufferTest, replacing_buffer_with_unknown_damage_uploads_everything)
+{
+    auto const first = std::make_shared<ReplacingShmBuffer>(
+        size, egl_delegate, nullptr, std::experimental::nullopt);
+    auto const second = std::make_shared<ReplacingShmBuffer>(
+        size, egl_delegate, first, std::experimental::nullopt);
+
+    ON_CALL(mock_gl, glGenTextures(1, _)).WillByDefault(SetArgPointee<1>(1));
+    EXPECT_CALL(mock_gl, glTexSubImage2D(_, _, _, _, _, _, _, _, _)).Times(0);
+    EXPECT_CALL(mock_gl, glTexImage2D(_, _, _, _, _, _, _, _, first->pixels.get())).Times(1);
+    EXPECT_CALL(mock_gl, glTexImage2D(_, _, _, _, _, _, _, _, second->pixels.get())).Times(1);
+
+    first->bind();
+    second->bind();
+}
+
+TEST_F(ShmBufferTest, replacing_buffer_accumulates_damage_of_skipped_buffers)
+{
+    geom::Rectangle const first_damage{{10, 20}, {30, 40}};
+    geom::Rectangle const second_damage{{0, 0}, {1, 1}};
+
+    auto const first = std::make_shared<ReplacingShmBuffer>(
+        size, egl_delegate, nullptr, std::experimental::nullopt);
+    auto const skipped = std::make_shared<ReplacingShmBuffer>(
+        size, egl_delegate, first, geom::Rectangles{first_damage});
+    auto const third = std::make_shared<ReplacingShmBuffer>(
+        size, egl_delegate, skipped, geom::Rectangles{second_damage});
+
+    EXPECT_CALL(mock_gl, glTexSubImage2D(_, _, 10, 20, 30, 40, _, _, _)).Times(1);
+    EXPECT_CALL(mock_gl, glTexSubImage2D(_, _, 0, 0, 1, 1, _, _, _)).Times(1);
+
+    first->bind();
+    third->bind();
+}
+
+TEST_F(ShmBufferTest, replacing_buffer_of_different_size_gets_its_own_texture)
+{
+    auto const first = std::make_shared<ReplacingShmBuffer>(
+        size, egl_delegate, nullptr, std::experimental::nullopt);
+    auto const second = std::make_shared<ReplacingShmBuffer>(
+        geom::Size{size.width.as_int(), size.height.as_int() * 2}, egl_delegate, first, geom::Rectangles{{{0, 0}, {1, 1}}});
+
+    EXPECT_CALL(mock_gl, glGenTextures(1, _)).Times(2);
+    EXPECT_CALL(mock_gl, glTexSubImage2D(_, _, _, _, _, _, _, _, _)).Times(0);
+
+    first->bind();
+    second->bind();
+}
+
+TEST_F(ShmBufferTest, egl_delegate_work_can_spawn_more_work)
+{
+    std::promise<void> nested_work_ran;
+
+    egl_delegate->spawn(
+        [this, &nested_work_ran]()
+        {
+            egl_delegate->spawn([&nested_work_ran]() { nested_work_ran.set_value(); });
+        });
+
+    EXPECT_THAT(
+        nested_work_ran.get_future().wait_for(std::chrono::seconds{30}),
+        Eq(std::future_status::ready));
+}
+
+TEST_F(ShmBufferTest, compositor_syncpoints_need_no_fences_without_shared_context_uploads)
+{
+    EXPECT_CALL(mock_egl, eglCreateSyncKHR(_, _, _)).Times(0);
+
+    shm_buffer.bind();
+    shm_buffer.add_syncpoint();
+}
+
+namespace
+{
+struct TextureBudget
+{
+    explicit TextureBudget(size_t bytes)
+    {
+        mgc::ShmBuffer::set_texture_budget(bytes);
+    }
+
+    ~TextureBudget()
+    {
+        mgc::ShmBuffer::set_texture_budget(0);
+    }
+};
+
+size_t const bytes_per_abgr_pixel{4};
+}
+
+TEST_F(ShmBufferTest, released_texture_is_uploaded_again_when_next_bound)
+{
+    TextureBudget const budget{1024 * 1024 * 1024};
+    PlatformlessShmBuffer buffer{size, mir_pixel_format_abgr_8888, egl_delegate};
+
+    EXPECT_CALL(mock_gl, glTexImage2D(_, _, _, _, _, _, _, _, buffer.pixel_buffer())).Times(2);
+
+    buffer.bind();
+    buffer.release_texture();
+    buffer.bind();
+}
+
+TEST_F(ShmBufferTest, texture_is_kept_without_a_budget)
+{
+    PlatformlessShmBuffer buffer{size, mir_pixel_format_abgr_8888, egl_delegate};
+
+    EXPECT_CALL(mock_gl, glTexImage2D(_, _, _, _, _, _, _, _, buffer.pixel_buffer())).Times(1);
+
+    buffer.bind();
+    buffer.release_texture();
+    buffer.bind();
+}
+
+TEST_F(ShmBufferTest, least_recently_bound_texture_is_released_when_over_budget)
+{
+    TextureBudget const budget{bytes_per_abgr_pixel * size.width.as_int() * size.height.as_int()};
+    PlatformlessShmBuffer least_recent{size, mir_pixel_format_abgr_8888, egl_delegate};
+    PlatformlessShmBuffer most_recent{size, mir_pixel_format_abgr_8888, egl_delegate};
+
+    EXPECT_CALL(mock_gl, glTexImage2D(_, _, _, _, _, _, _, _, least_recent.pixel_buffer())).Times(2);
+    EXPECT_CALL(mock_gl, glTexImage2D(_, _, _, _, _, _, _, _, most_recent.pixel_buffer())).Times(1);
+
+    least_recent.bind();
+    most_recent.bind();
+    most_recent.bind();
+    least_recent.bind();
+}
+
+TEST_F(ShmBufferTest, writeable_mapping_is_of_the_buffers_own_pixels)
+{
+    PlatformlessShmBuffer buffer{size, mir_pixel_format_abgr_8888, egl_delegate};
+
+    auto const mapping = buffer.map_writeable();
+
+    EXPECT_THAT(mapping->data(), Eq(buffer.pixel_buffer()));
+    EXPECT_THAT(mapping->len(), Eq(bytes_per_abgr_pixel * size.width.as_int() * size.height.as_int()));
+}
+
+TEST_F(ShmBufferTest, content_written_through_a_mapping_is_uploaded_on_next_bind)
+{
+    PlatformlessShmBuffer buffer{size, mir_pixel_format_abgr_8888, egl_delegate};
+
+    EXPECT_CALL(mock_gl, glTexImage2D(_, _, _, _, _, _, _, _, buffer.pixel_buffer())).Times(2);
+
+    buffer.bind();
+    buffer.bind();
+    {
+        auto const mapping = buffer.map_writeable();
+        mapping->data()[0] = 0xff;
+    }
+    buffer.bind();
+}
+
+namespace
+{
+struct SharedContextUploadingShmBuffer : ReplacingShmBuffer
+{
+    using ReplacingShmBuffer::ReplacingShmBuffer;
+    using ShmBuffer::shared_context_uploads_supported;
+
+    void upload_from_shared_context()
+    {
+        upload_damage_from_shared_context(pixels.get(), stride());
+    }
+};
+
+// Fence support is looked up once per display, so each test uses a display of its own
+auto fake_display(uintptr_t id) -> EGLDisplay
+{
+    return reinterpret_cast<EGLDisplay>(id);
+}
+}
+
+TEST_F(ShmBufferTest, shared_context_uploads_are_supported_per_display)
+{
+    auto const fenced = fake_display(0xfe11ce);
+    auto const unfenced = fake_display(0xfe11cf);
+    ON_CALL(mock_egl, eglQueryString(fenced, EGL_EXTENSIONS)).WillByDefault(Return("EGL_KHR_fence_sync"));
+    ON_CALL(mock_egl, eglQueryString(unfenced, EGL_EXTENSIONS)).WillByDefault(Return("EGL_KHR_image_base"));
+
+    ON_CALL(mock_egl, eglGetCurrentDisplay()).WillByDefault(Return(fenced));
+    EXPECT_TRUE(SharedContextUploadingShmBuffer::shared_context_uploads_supported());
+
+    ON_CALL(mock_egl, eglGetCurrentDisplay()).WillByDefault(Return(unfenced));
+    EXPECT_FALSE(SharedContextUploadingShmBuffer::shared_context_uploads_supported());
+}
+
+TEST_F(ShmBufferTest, compositor_read_fences_are_flushed)
+{
+    auto const dpy = fake_display(0xfe11d0);
+    ON_CALL(mock_egl, eglQueryString(dpy, EGL_EXTENSIONS)).WillByDefault(Return("EGL_KHR_fence_sync"));
+    ON_CALL(mock_egl, eglGetCurrentDisplay()).WillByDefault(Return(dpy));
+
+    SharedContextUploadingShmBuffer buffer{size, egl_delegate, nullptr, std::experimental::nullopt};
+    buffer.upload_from_shared_context();
+    buffer.bind();
+
+    {
+        // An upload from another context can only wait on the GPU for a fence that has been flushed
+        InSequence seq;
+        EXPECT_CALL(mock_egl, eglCreateSyncKHR(dpy, EGL_SYNC_FENCE_KHR, _));
+        EXPECT_CALL(mock_gl, glFlush());
+    }
+
+    buffer.add_syncpoint();
+}
+
+TEST_F(ShmBufferTest, shared_context_upload_waits_for_compositor_reads_on_the_gpu)
+{
+    auto const dpy = fake_display(0xfe11d1);
+    EGLContext const compositor{reinterpret_cast<EGLContext>(0xc0)};
+    EGLContext const uploader{reinterpret_cast<EGLContext>(0xc1)};
+    EGLSyncKHR const upload_fence{reinterpret_cast<EGLSyncKHR>(0x5e1)};
+    EGLSyncKHR const read_fence{reinterpret_cast<EGLSyncKHR>(0x5e2)};
+    ON_CALL(mock_egl, eglQueryString(dpy, EGL_EXTENSIONS))
+        .WillByDefault(Return("EGL_KHR_fence_sync EGL_KHR_wait_sync"));
+    ON_CALL(mock_egl, eglGetCurrentDisplay()).WillByDefault(Return(dpy));
+
+    auto const first = std::make_shared<SharedContextUploadingShmBuffer>(
+        size, egl_delegate, nullptr, std::experimental::nullopt);
+    auto const second = std::make_shared<SharedContextUploadingShmBuffer>(
+        size, egl_delegate, first, geom::Rectangles{{{0, 0}, {1, 1}}});
+
+    ON_CALL(mock_egl, eglGetCurrentContext()).WillByDefault(Return(uploader));
+    EXPECT_CALL(mock_egl, eglCreateSyncKHR(dpy, _, _)).WillOnce(Return(upload_fence));
+    first->upload_from_shared_context();
+
+    ON_CALL(mock_egl, eglGetCurrentContext()).WillByDefault(Return(compositor));
+    ON_CALL(mock_egl, eglClientWaitSyncKHR(dpy, upload_fence, _, _))
+        .WillByDefault(Return(EGL_CONDITION_SATISFIED_KHR));
+    EXPECT_CALL(mock_egl, eglCreateSyncKHR(dpy, _, _)).WillOnce(Return(read_fence));
+    first->bind();
+    first->add_syncpoint();
+    Mock::VerifyAndClearExpectations(&mock_egl);
+
+    ON_CALL(mock_egl, eglGetCurrentContext()).WillByDefault(Return(uploader));
+    EXPECT_CALL(mock_egl, eglWaitSyncKHR(dpy, read_fence, 0));
+    EXPECT_CALL(mock_egl, eglClientWaitSyncKHR(dpy, read_fence, _, _)).Times(0);
+    second->upload_from_shared_context();
+}
+
+TEST_F(ShmBufferTest, each_compositor_fences_its_reads_once_several_draw_from_a_texture)
+{
+    auto const dpy = fake_display(0xfe11d2);
+    EGLContext const left_output{reinterpret_cast<EGLContext>(0xc2)};
+    EGLContext const right_output{reinterpret_cast<EGLContext>(0xc3)};
+    EGLSyncKHR const left_read{reinterpret_cast<EGLSyncKHR>(0x5e3)};
+    EGLSyncKHR const right_read{reinterpret_cast<EGLSyncKHR>(0x5e4)};
+    ON_CALL(mock_egl, eglQueryString(dpy, EGL_EXTENSIONS))
+        .WillByDefault(Return("EGL_KHR_fence_sync EGL_KHR_wait_sync"));
+    ON_CALL(mock_egl, eglGetCurrentDisplay()).WillByDefault(Return(dpy));
+
+    ReplacingShmBuffer buffer{size, egl_delegate, nullptr, std::experimental::nullopt};
+
+    // Drawn by a single compositor, nothing else needs to know when it's done
+    ON_CALL(mock_egl, eglGetCurrentContext()).WillByDefault(Return(left_output));
+    EXPECT_CALL(mock_egl, eglCreateSyncKHR(_, _, _)).Times(0);
+    buffer.bind();
+    buffer.add_syncpoint();
+    Mock::VerifyAndClearExpectations(&mock_egl);
+
+    ON_CALL(mock_egl, eglGetCurrentContext()).WillByDefault(Return(right_output));
+    EXPECT_CALL(mock_egl, eglCreateSyncKHR(dpy, EGL_SYNC_FENCE_KHR, _)).WillOnce(Return(right_read));
+    buffer.bind();
+    buffer.add_syncpoint();
+    Mock::VerifyAndClearExpectations(&mock_egl);
+
+    // The other compositor's fence is kept alongside, rather than replacing it
+    ON_CALL(mock_egl, eglGetCurrentContext()).WillByDefault(Return(left_output));
+    EXPECT_CALL(mock_egl, eglCreateSyncKHR(dpy, EGL_SYNC_FENCE_KHR, _)).WillOnce(Return(left_read));
+    EXPECT_CALL(mock_egl, eglDestroySyncKHR(dpy, right_read)).Times(0);
+    buffer.bind();
+    buffer.add_syncpoint();
+    // (Before the buffer's destruction cleans up both)
+    Mock::VerifyAndClearExpectations(&mock_egl);
+}
+
+TEST_F(ShmBufferTest, upload_from_one_compositor_waits_for_the_others_reads_and_is_fenced)
+{
+    auto const dpy = fake_display(0xfe11d3);
+    EGLContext const left_output{reinterpret_cast<EGLContext>(0xc4)};
+    EGLContext const right_output{reinterpret_cast<EGLContext>(0xc5)};
+    EGLSyncKHR const left_read{reinterpret_cast<EGLSyncKHR>(0x5e5)};
+    EGLSyncKHR const right_read{reinterpret_cast<EGLSyncKHR>(0x5e6)};
+    EGLSyncKHR const upload{reinterpret_cast<EGLSyncKHR>(0x5e7)};
+    ON_CALL(mock_egl, eglQueryString(dpy, EGL_EXTENSIONS))
+        .WillByDefault(Return("EGL_KHR_fence_sync EGL_KHR_wait_sync"));
+    ON_CALL(mock_egl, eglGetCurrentDisplay()).WillByDefault(Return(dpy));
+
+    auto const first = std::make_shared<ReplacingShmBuffer>(
+        size, egl_delegate, nullptr, std::experimental::nullopt);
+    auto const second = std::make_shared<ReplacingShmBuffer>(
+        size, egl_delegate, first, geom::Rectangles{{{0, 0}, {1, 1}}});
+
+    ON_CALL(mock_egl, eglGetCurrentContext()).WillByDefault(Return(left_output));
+    first->bind();
+    ON_CALL(mock_egl, eglGetCurrentContext()).WillByDefault(Return(right_output));
+    EXPECT_CALL(mock_egl, eglCreateSyncKHR(dpy, _, _)).WillOnce(Return(right_read));
+    first->bind();
+    first->add_syncpoint();
+    ON_CALL(mock_egl, eglGetCurrentContext()).WillByDefault(Return(left_output));
+    EXPECT_CALL(mock_egl, eglCreateSyncKHR(dpy, _, _)).WillOnce(Return(left_read));
+    first->add_syncpoint();
+    Mock::VerifyAndClearExpectations(&mock_egl);
+
+    // Uploading from the left output's context waits (on the GPU) for the right's reads, but not its own
+    {
+        InSequence seq;
+        EXPECT_CALL(mock_egl, eglWaitSyncKHR(dpy, right_read, 0));
+        EXPECT_CALL(mock_gl, glTexSubImage2D(_, _, 0, 0, 1, 1, _, _, _));
+        EXPECT_CALL(mock_egl, eglCreateSyncKHR(dpy, EGL_SYNC_FENCE_KHR, _)).WillOnce(Return(upload));
+        EXPECT_CALL(mock_gl, glFlush());
+    }
+    EXPECT_CALL(mock_egl, eglWaitSyncKHR(dpy, left_read, _)).Times(0);
+    EXPECT_CALL(mock_egl, eglClientWaitSyncKHR(dpy, right_read, _, _)).Times(0);
+    second->bind();
+}
+
+TEST_F(ShmBufferTest, every_compositor_waits_for_an_upload_until_it_has_signalled)
+{
+    auto const dpy = fake_display(0xfe11d4);
+    EGLContext const left_output{reinterpret_cast<EGLContext>(0xc6)};
+    EGLContext const middle_output{reinterpret_cast<EGLContext>(0xc7)};
+    EGLContext const right_output{reinterpret_cast<EGLContext>(0xc8)};
+    EGLSyncKHR const upload{reinterpret_cast<EGLSyncKHR>(0x5e8)};
+    ON_CALL(mock_egl, eglQueryString(dpy, EGL_EXTENSIONS))
+        .WillByDefault(Return("EGL_KHR_fence_sync EGL_KHR_wait_sync"));
+    ON_CALL(mock_egl, eglGetCurrentDisplay()).WillByDefault(Return(dpy));
+    ON_CALL(mock_egl, eglCreateSyncKHR(dpy, _, _)).WillByDefault(Return(upload));
+
+    auto const first = std::make_shared<ReplacingShmBuffer>(
+        size, egl_delegate, nullptr, std::experimental::nullopt);
+    auto const second = std::make_shared<ReplacingShmBuffer>(
+        size, egl_delegate, first, geom::Rectangles{{{0, 0}, {1, 1}}});
+
+    ON_CALL(mock_egl, eglGetCurrentContext()).WillByDefault(Return(right_output));
+    first->bind();
+    ON_CALL(mock_egl, eglGetCurrentContext()).WillByDefault(Return(left_output));
+    first->bind();
+    second->bind();
+
+    // Not yet signalled: each other compositor waits for it on the GPU, and it's kept for the next
+    ON_CALL(mock_egl, eglClientWaitSyncKHR(dpy, upload, 0, 0)).WillByDefault(Return(EGL_TIMEOUT_EXPIRED_KHR));
+    EXPECT_CALL(mock_egl, eglWaitSyncKHR(dpy, upload, 0)).Times(2);
+    EXPECT_CALL(mock_egl, eglDestroySyncKHR(dpy, upload)).Times(0);
+    ON_CALL(mock_egl, eglGetCurrentContext()).WillByDefault(Return(middle_output));
+    second->bind();
+    ON_CALL(mock_egl, eglGetCurrentContext()).WillByDefault(Return(right_output));
+    second->bind();
+    Mock::VerifyAndClearExpectations(&mock_egl);
+
+    // Once signalled, nobody need wait for it
+    ON_CALL(mock_egl, eglClientWaitSyncKHR(dpy, upload, 0, 0)).WillByDefault(Return(EGL_CONDITION_SATISFIED_KHR));
+    EXPECT_CALL(mock_egl, eglDestroySyncKHR(dpy, upload));
+    EXPECT_CALL(mock_egl, eglWaitSyncKHR(_, _, _)).Times(0);
+    second->bind();
+}
@@ -0,0 +1,513 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/graphics/wayland_shm.h"
+#include "mir/fd.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <wayland-server-core.h>
+#include <wayland-client.h>
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace mg = mir::graphics;
+namespace geom = mir::geometry;
+
+using namespace testing;
+
+namespace
+{
+int const width{4};
+int const height{4};
+int const stride{width * 4};
+size_t const buffer_bytes{stride * height};
+
+/// A client of an in-process wl_display offering only Mir's wl_shm, both driven from the test thread
+struct WaylandShm : Test
+{
+    WaylandShm()
+        : server{wl_display_create()}
+    {
+    }
+
+    ~WaylandShm()
+    {
+        if (client)
+            wl_display_disconnect(client);
+        // Dispatching notices the hang-up and destroys the server's end of the client
+        wl_event_loop_dispatch(wl_display_get_event_loop(server), 0);
+        shm.reset();
+        wl_display_destroy(server);
+    }
+
+    void connect(size_t client_limit = 0)
+    {
+        shm = mg::create_wl_shm(server, client_limit);
+
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0)
+            throw std::system_error{errno, std::system_category(), "Failed to create socket pair"};
+        server_client = wl_client_create(server, fds[0]);
+        client = wl_display_connect_to_fd(fds[1]);
+        ASSERT_THAT(client, NotNull());
+
+        auto const registry = wl_display_get_registry(client);
+        wl_registry_add_listener(registry, &registry_listener, this);
+        roundtrip();
+        wl_registry_destroy(registry);
+        ASSERT_THAT(client_shm, NotNull());
+    }
+
+    /// Like wl_display_roundtrip(), but with the server dispatched while we wait
+    void roundtrip()
+    {
+        bool done{false};
+        auto const callback = wl_display_sync(client);
+        wl_callback_add_listener(callback, &sync_listener, &done);
+
+        for (auto i = 0; i != 100 && !done && wl_display_get_error(client) == 0; ++i)
+        {
+            wl_display_flush(client);
+            wl_event_loop_dispatch(wl_display_get_event_loop(server), 0);
+            wl_display_flush_clients(server);
+
+            if (wl_display_prepare_read(client) == 0)
+            {
+                pollfd readable{wl_display_get_fd(client), POLLIN, 0};
+                if (poll(&readable, 1, 100) > 0)
+                    wl_display_read_events(client);
+                else
+                    wl_display_cancel_read(client);
+            }
+            wl_display_dispatch_pending(client);
+        }
+        wl_callback_destroy(callback);
+    }
+
+    /// The code of the protocol error the server sent, or 0 if it hasn't sent one
+    auto protocol_error() -> uint32_t
+    {
+        roundtrip();
+        if (wl_display_get_error(client) != EPROTO)
+            return 0;
+        return wl_display_get_protocol_error(client, nullptr, nullptr);
+    }
+
+    /// A file for a pool of size bytes, mapped so the test can draw into it
+    struct PoolFile
+    {
+        explicit PoolFile(size_t size)
+            : fd{memfd_create("wayland-shm-test", MFD_CLOEXEC)},
+              size{size}
+        {
+            if (fd < 0 || ftruncate(fd, size) != 0)
+                throw std::system_error{errno, std::system_category(), "Failed to create pool file"};
+            map();
+        }
+
+        ~PoolFile()
+        {
+            munmap(data, size);
+        }
+
+        void grow_to(size_t new_size)
+        {
+            munmap(data, size);
+            size = new_size;
+            if (ftruncate(fd, size) != 0)
+                throw std::system_error{errno, std::system_category(), "Failed to grow pool file"};
+            map();
+        }
+
+        void map()
+        {
+            data = static_cast<unsigned char*>(mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+            if (data == MAP_FAILED)
+                throw std::system_error{errno, std::system_category(), "Failed to map pool file"};
+        }
+
+        mir::Fd const fd;
+        size_t size;
+        unsigned char* data;
+    };
+
+    auto create_pool(PoolFile const& file) -> wl_shm_pool*
+    {
+        return wl_shm_create_pool(client_shm, file.fd, file.size);
+    }
+
+    /// The server's view of a client's buffer
+    auto content_of(wl_buffer* buffer) -> std::shared_ptr<mg::WlShmBufferContent const>
+    {
+        roundtrip();
+        auto const resource = wl_client_get_object(server_client, wl_proxy_get_id(reinterpret_cast<wl_proxy*>(buffer)));
+        if (!resource)
+            return nullptr;
+        return mg::wl_shm_buffer_content(resource);
+    }
+
+    static auto pixels_of(mg::WlShmBufferContent const& content) -> std::vector<unsigned char>
+    {
+        std::vector<unsigned char> pixels(content.stride().as_int() * content.size().height.as_int());
+        content.read([&](unsigned char const* data) { memcpy(pixels.data(), data, pixels.size()); });
+        return pixels;
+    }
+
+    static void fill(unsigned char* data, size_t size, unsigned char first)
+    {
+        for (auto i = 0u; i < size; ++i)
+            data[i] = static_cast<unsigned char>(first + i);
+    }
+
+    static void new_global(void* data, wl_registry* registry, uint32_t id, char const* interface, uint32_t)
+    {
+        auto const self = static_cast<WaylandShm*>(data);
+        if (strcmp(interface, wl_shm_interface.name) == 0)
+        {
+            self->client_shm = static_cast<wl_shm*>(wl_registry_bind(registry, id, &wl_shm_interface, 1));
+        }
+    }
+
+    static void global_remove(void*, wl_registry*, uint32_t) {}
+
+    static constexpr wl_registry_listener registry_listener{&new_global, &global_remove};
+    static constexpr wl_callback_listener sync_listener{
+        [](void* data, wl_callback*, uint32_t) { *static_cast<bool*>(data) = true; }};
+
+    wl_display* const server;
+    std::shared_ptr<void> shm;
+    wl_client* server_client{nullptr};
+    struct wl_display* client{nullptr};
+    wl_shm* client_shm{nullptr};
+};
+}
+
+TEST_F(WaylandShm, buffer_reads_as_the_client_drew_it)
+{
+    connect();
+    PoolFile file{buffer_bytes};
+    fill(file.data, file.size, 0);
+
+    auto const pool = create_pool(file);
+    auto const buffer = wl_shm_pool_create_buffer(pool, 0, width, height, stride, WL_SHM_FORMAT_ARGB8888);
+    auto const content = content_of(buffer);
+
+    ASSERT_THAT(content, NotNull());
+    EXPECT_THAT(content->size(), Eq(geom::Size{width, height}));
+    EXPECT_THAT(content->stride(), Eq(geom::Stride{stride}));
+    EXPECT_THAT(content->format(), Eq(uint32_t{WL_SHM_FORMAT_ARGB8888}));
+    EXPECT_THAT(pixels_of(*content), ElementsAreArray(file.data, buffer_bytes));
+}
+
+TEST_F(WaylandShm, buffer_at_an_offset_reads_from_there)
+{
+    connect();
+    PoolFile file{2 * buffer_bytes};
+    fill(file.data, file.size, 0);
+
+    auto const pool = create_pool(file);
+    auto const buffer = wl_shm_pool_create_buffer(pool, buffer_bytes, width, height, stride, WL_SHM_FORMAT_XRGB8888);
+    auto const content = content_of(buffer);
+
+    ASSERT_THAT(content, NotNull());
+    EXPECT_THAT(pixels_of(*content), ElementsAreArray(file.data + buffer_bytes, buffer_bytes));
+}
+
+TEST_F(WaylandShm, pixels_written_to_a_buffer_are_seen_by_the_client)
+{
+    connect();
+    PoolFile file{2 * buffer_bytes};
+    auto const pool = create_pool(file);
+    auto const buffer = wl_shm_pool_create_buffer(pool, buffer_bytes, width, height, stride, WL_SHM_FORMAT_XRGB8888);
+    auto const content = content_of(buffer);
+    ASSERT_THAT(content, NotNull());
+    ASSERT_TRUE(content->writable());
+
+    std::vector<unsigned char> copied(buffer_bytes);
+    fill(copied.data(), copied.size(), 5);
+    content->write([&](unsigned char* data) { memcpy(data, copied.data(), copied.size()); });
+
+    EXPECT_THAT(std::vector<unsigned char>(file.data, file.data + buffer_bytes), Each(Eq(0)));
+    EXPECT_THAT(std::vector<unsigned char>(file.data + buffer_bytes, file.data + 2 * buffer_bytes), ElementsAreArray(copied));
+}
+
+TEST_F(WaylandShm, pool_from_a_read_only_file_reads_but_is_not_writable)
+{
+    connect();
+    PoolFile file{buffer_bytes};
+    fill(file.data, file.size, 7);
+    mir::Fd const read_only{open(("/proc/self/fd/" + std::to_string(file.fd)).c_str(), O_RDONLY | O_CLOEXEC)};
+    ASSERT_THAT(read_only, Ge(0));
+
+    auto const pool = wl_shm_create_pool(client_shm, read_only, buffer_bytes);
+    auto const buffer = wl_shm_pool_create_buffer(pool, 0, width, height, stride, WL_SHM_FORMAT_ARGB8888);
+    auto const content = content_of(buffer);
+
+    ASSERT_THAT(content, NotNull());
+    EXPECT_FALSE(content->writable());
+    EXPECT_THAT(pixels_of(*content), ElementsAreArray(file.data, buffer_bytes));
+    EXPECT_THROW(content->write([](unsigned char*) {}), std::logic_error);
+}
+
+TEST_F(WaylandShm, pool_with_no_bytes_is_a_protocol_error)
+{
+    connect();
+    PoolFile file{buffer_bytes};
+
+    wl_shm_create_pool(client_shm, file.fd, 0);
+
+    EXPECT_THAT(protocol_error(), Eq(uint32_t{WL_SHM_ERROR_INVALID_STRIDE}));
+}
+
+TEST_F(WaylandShm, buffer_past_the_end_of_the_pool_is_a_protocol_error)
+{
+    connect();
+    PoolFile file{buffer_bytes};
+
+    auto const pool = create_pool(file);
+    wl_shm_pool_create_buffer(pool, 4, width, height, stride, WL_SHM_FORMAT_ARGB8888);
+
+    EXPECT_THAT(protocol_error(), Eq(uint32_t{WL_SHM_ERROR_INVALID_STRIDE}));
+}
+
+TEST_F(WaylandShm, buffer_at_a_negative_offset_is_a_protocol_error)
+{
+    connect();
+    PoolFile file{buffer_bytes};
+
+    auto const pool = create_pool(file);
+    wl_shm_pool_create_buffer(pool, -stride, width, height, stride, WL_SHM_FORMAT_ARGB8888);
+
+    EXPECT_THAT(protocol_error(), Eq(uint32_t{WL_SHM_ERROR_INVALID_STRIDE}));
+}
+
+TEST_F(WaylandShm, stride_too_short_for_the_width_is_a_protocol_error)
+{
+    connect();
+    PoolFile file{buffer_bytes};
+
+    // Enough bytes for the rows, but not for the pixels in them
+    auto const pool = create_pool(file);
+    wl_shm_pool_create_buffer(pool, 0, width, height, width, WL_SHM_FORMAT_ARGB8888);
+
+    EXPECT_THAT(protocol_error(), Eq(uint32_t{WL_SHM_ERROR_INVALID_STRIDE}));
+}
+
+TEST_F(WaylandShm, buffer_so_large_its_size_overflows_is_a_protocol_error)
+{
+    connect();
+    PoolFile file{buffer_bytes};
+
+    auto const pool = create_pool(file);
+    wl_shm_pool_create_buffer(pool, 0, 0x40000000, 4, 0x40000000, WL_SHM_FORMAT_ARGB8888);
+
+    EXPECT_THAT(protocol_error(), Eq(uint32_t{WL_SHM_ERROR_INVALID_STRIDE}));
+}
+
+TEST_F(WaylandShm, format_we_didnt_offer_is_a_protocol_error)
+{
+    connect();
+    PoolFile file{buffer_bytes};
+
+    auto const pool = create_pool(file);
+    wl_shm_pool_create_buffer(pool, 0, width, height, stride, WL_SHM_FORMAT_RGB565);
+
+    EXPECT_THAT(protocol_error(), Eq(uint32_t{WL_SHM_ERROR_INVALID_FORMAT}));
+}
+
+TEST_F(WaylandShm, resized_pool_holds_larger_buffers)
+{
+    connect();
+    PoolFile file{buffer_bytes};
+    auto const pool = create_pool(file);
+
+    file.grow_to(2 * buffer_bytes);
+    fill(file.data, file.size, 7);
+    wl_shm_pool_resize(pool, file.size);
+    auto const buffer = wl_shm_pool_create_buffer(pool, 0, width, 2 * height, stride, WL_SHM_FORMAT_ARGB8888);
+    auto const content = content_of(buffer);
+
+    ASSERT_THAT(content, NotNull());
+    EXPECT_THAT(protocol_error(), Eq(0u));
+    EXPECT_THAT(pixels_of(*content), ElementsAreArray(file.data, file.size));
+}
+
+TEST_F(WaylandShm, buffers_from_before_a_resize_still_read)
+{
+    connect();
+    PoolFile file{buffer_bytes};
+    fill(file.data, file.size, 0);
+    auto const pool = create_pool(file);
+    auto const buffer = wl_shm_pool_create_buffer(pool, 0, width, height, stride, WL_SHM_FORMAT_ARGB8888);
+    auto const content = content_of(buffer);
+
+    file.grow_to(2 * buffer_bytes);
+    wl_shm_pool_resize(pool, file.size);
+    roundtrip();
+
+    ASSERT_THAT(content, NotNull());
+    EXPECT_THAT(pixels_of(*content), ElementsAreArray(file.data, buffer_bytes));
+}
+
+TEST_F(WaylandShm, shrinking_a_pool_is_a_protocol_error)
+{
+    connect();
+    PoolFile file{buffer_bytes};
+
+    auto const pool = create_pool(file);
+    wl_shm_pool_resize(pool, buffer_bytes / 2);
+
+    EXPECT_THAT(protocol_error(), Eq(uint32_t{WL_SHM_ERROR_INVALID_FD}));
+}
+
+TEST_F(WaylandShm, pool_over_the_client_limit_is_a_protocol_error)
+{
+    connect(buffer_bytes);
+    PoolFile file{2 * buffer_bytes};
+
+    create_pool(file);
+
+    EXPECT_THAT(protocol_error(), Eq(uint32_t{WL_SHM_ERROR_INVALID_FD}));
+}
+
+TEST_F(WaylandShm, pools_within_the_client_limit_are_fine)
+{
+    connect(2 * buffer_bytes);
+    PoolFile first{buffer_bytes};
+    PoolFile second{buffer_bytes};
+
+    create_pool(first);
+    create_pool(second);
+
+    EXPECT_THAT(protocol_error(), Eq(0u));
+}
+
+TEST_F(WaylandShm, growing_a_pool_over_the_client_limit_is_a_protocol_error)
+{
+    connect(buffer_bytes);
+    PoolFile file{buffer_bytes};
+    auto const pool = create_pool(file);
+
+    file.grow_to(2 * buffer_bytes);
+    wl_shm_pool_resize(pool, file.size);
+
+    EXPECT_THAT(protocol_error(), Eq(uint32_t{WL_SHM_ERROR_INVALID_FD}));
+}
+
+TEST_F(WaylandShm, destroyed_pool_frees_its_share_of_the_client_limit)
+{
+    connect(buffer_bytes);
+    PoolFile file{buffer_bytes};
+
+    wl_shm_pool_destroy(create_pool(file));
+    roundtrip();
+    create_pool(file);
+
+    EXPECT_THAT(protocol_error(), Eq(0u));
+}
+
+TEST_F(WaylandShm, pool_truncated_by_the_client_reads_as_zeros_rather_than_crashing)
+{
+    connect();
+    auto const page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    PoolFile file{page};
+    fill(file.data, buffer_bytes, 1);
+    auto const pool = create_pool(file);
+    auto const buffer = wl_shm_pool_create_buffer(pool, 0, width, height, stride, WL_SHM_FORMAT_ARGB8888);
+    auto const content = content_of(buffer);
+    ASSERT_THAT(content, NotNull());
+
+    ASSERT_THAT(ftruncate(file.fd, 0), Eq(0));
+
+    EXPECT_THAT(pixels_of(*content), Each(Eq(0)));
+}
+
+TEST_F(WaylandShm, writing_to_a_pool_truncated_by_the_client_does_not_crash)
+{
+    connect();
+    auto const page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    PoolFile file{page};
+    auto const pool = create_pool(file);
+    auto const buffer = wl_shm_pool_create_buffer(pool, 0, width, height, stride, WL_SHM_FORMAT_ARGB8888);
+    auto const content = content_of(buffer);
+    ASSERT_THAT(content, NotNull());
+
+    ASSERT_THAT(ftruncate(file.fd, 0), Eq(0));
+
+    content->write([](unsigned char* data) { memset(data, 0xff, buffer_bytes); });
+    EXPECT_THAT(pixels_of(*content), Each(Eq(0xff)));
+}
+
+TEST_F(WaylandShm, buffer_from_a_truncated_pool_is_a_protocol_error)
+{
+    connect();
+    auto const page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    PoolFile file{page};
+    auto const pool = create_pool(file);
+    auto const buffer = wl_shm_pool_create_buffer(pool, 0, width, height, stride, WL_SHM_FORMAT_ARGB8888);
+    auto const content = content_of(buffer);
+    ASSERT_THAT(content, NotNull());
+    ASSERT_THAT(ftruncate(file.fd, 0), Eq(0));
+    pixels_of(*content);
+
+    wl_shm_pool_create_buffer(pool, 0, width, height, stride, WL_SHM_FORMAT_ARGB8888);
+
+    EXPECT_THAT(protocol_error(), Eq(uint32_t{WL_SHM_ERROR_INVALID_FD}));
+}
+
+TEST_F(WaylandShm, sealed_pool_reads_as_the_client_drew_it)
+{
+    connect();
+    mir::Fd const fd{memfd_create("wayland-shm-test", MFD_CLOEXEC | MFD_ALLOW_SEALING)};
+    ASSERT_THAT(ftruncate(fd, buffer_bytes), Eq(0));
+    std::vector<unsigned char> drawn(buffer_bytes);
+    fill(drawn.data(), drawn.size(), 3);
+    ASSERT_THAT(write(fd, drawn.data(), drawn.size()), Eq(static_cast<ssize_t>(drawn.size())));
+    ASSERT_THAT(fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK), Eq(0));
+
+    auto const pool = wl_shm_create_pool(client_shm, fd, buffer_bytes);
+    auto const buffer = wl_shm_pool_create_buffer(pool, 0, width, height, stride, WL_SHM_FORMAT_ARGB8888);
+    auto const content = content_of(buffer);
+
+    ASSERT_THAT(content, NotNull());
+    EXPECT_THAT(pixels_of(*content), ElementsAreArray(drawn));
+}
+
+TEST_F(WaylandShm, buffer_from_elsewhere_has_no_shm_content)
+{
+    connect();
+
+    // A wl_shm_pool is no wl_buffer
+    PoolFile file{buffer_bytes};
+    auto const pool = create_pool(file);
+    roundtrip();
+    auto const resource = wl_client_get_object(server_client, wl_proxy_get_id(reinterpret_cast<wl_proxy*>(pool)));
+
+    ASSERT_THAT(resource, NotNull());
+    EXPECT_THAT(mg::wl_shm_buffer_content(resource), IsNull());
+}
@@ -132,14 +132,15 @@ struct EvdevInputPlatform : public ::testing::TestWithParam<std::string>
 
     }
 
-    auto create_input_platform()
+    auto create_input_platform(std::string const& seat = "seat0")
     {
         auto ctx = std::make_unique<mu::Context>();
         return std::make_unique<mie::Platform>(
             mt::fake_shared(mock_registry),
             mr::null_input_report(),
             std::move(ctx),
-            std::make_shared<mtd::StubConsoleServices>());
+            std::make_shared<mtd::StubConsoleServices>(),
+            seat);
     }
 
     void remove_all_devices()
@@ -251,6 +252,20 @@ TEST_F(EvdevInputPlatform, register_ungrouped_devices)
     run_dispatchable(*platform);
 }
 
+TEST_F(EvdevInputPlatform, ignores_devices_of_other_seats)
+{
+    using namespace ::testing;
+    // Devices udev hasn't assigned a seat are on seat0
+    auto platform = create_input_platform("seat1");
+
+    EXPECT_CALL(mock_registry, add_device(_)).Times(0);
+
+    udev.add_standard_device("usb-keyboard");
+    platform->start();
+
+    run_dispatchable(*platform);
+}
+
 TEST_F(EvdevInputPlatform, devices_from_same_group)
 {
     auto platform = create_input_platform();
@@ -388,6 +388,19 @@ TEST_F(LibInputDeviceOnLaptopKeyboard, process_event_accumulates_key_state)
     process_events(keyboard);
 }
 
+TEST_F(LibInputDeviceOnLaptopKeyboard, process_events_hands_sink_a_single_batch)
+{
+    EXPECT_CALL(mock_sink, handle_input(_)).Times(0);
+    EXPECT_CALL(mock_sink, handle_input_batch(ElementsAre(
+        AllOf(mt::KeyOfScanCode(KEY_A), mt::KeyDownEvent()),
+        AllOf(mt::KeyOfScanCode(KEY_A), mt::KeyUpEvent()))));
+
+    keyboard.start(&mock_sink, &mock_builder);
+    env.mock_libinput.setup_key_event(fake_device, event_time_1, KEY_A, LIBINPUT_KEY_STATE_PRESSED);
+    env.mock_libinput.setup_key_event(fake_device, event_time_2, KEY_A, LIBINPUT_KEY_STATE_RELEASED);
+    keyboard.process_events(env.mock_libinput.events);
+}
+
 TEST_F(LibInputDeviceOnMouse, process_event_converts_pointer_event)
 {
     float x_movement_1 = 15;
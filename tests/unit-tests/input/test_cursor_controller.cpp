@@ -429,6 +429,22 @@ TEST_F(TestCursorController, change_in_cursor_request_triggers_image_update_with
     surface.set_cursor_image(std::make_shared<NamedCursorImage>(cursor_name_2));
 }
 
+TEST_F(TestCursorController, change_in_cursor_request_of_surface_not_under_cursor_is_ignored)
+{
+    StubInputSurface surface{rect_1_1_1_1, std::make_shared<NamedCursorImage>(cursor_name_1)};
+    StubInputSurface other_surface{rect_0_0_1_1, std::make_shared<NamedCursorImage>(cursor_name_1)};
+    StubScene targets({mt::fake_shared(surface), mt::fake_shared(other_surface)});
+
+    TestController controller{targets, cursor, default_cursor_image};
+
+    EXPECT_CALL(cursor, move_to(_)).Times(AtLeast(1));
+    EXPECT_CALL(cursor, show(CursorNamed(cursor_name_1))).Times(1);
+    EXPECT_CALL(cursor, show(CursorNamed(cursor_name_2))).Times(0);
+
+    controller.cursor_moved_to(1.0f, 1.0f);
+    other_surface.set_cursor_image(std::make_shared<NamedCursorImage>(cursor_name_2));
+}
+
 TEST_F(TestCursorController, change_in_scene_triggers_image_update)
 {
     // Here we also demonstrate that the cursor begins at 0,0.
@@ -223,6 +223,23 @@ TEST_F(InputDeviceHubTest, observers_receive_device_changes)
     expect_and_execute_multiplexer();
 }
 
+TEST_F(InputDeviceHubTest, observers_receive_a_burst_of_device_changes_as_one_change)
+{
+    hub.add_observer(mt::fake_shared(mock_observer));
+    expect_and_execute_multiplexer();
+
+    InSequence seq;
+    EXPECT_CALL(mock_observer, device_added(WithName("device")));
+    EXPECT_CALL(mock_observer, device_added(WithName("another_device")));
+    EXPECT_CALL(mock_observer, device_removed(WithName("device")));
+    EXPECT_CALL(mock_observer, changes_complete()).Times(1);
+
+    hub.add_device(mt::fake_shared(device));
+    hub.add_device(mt::fake_shared(another_device));
+    hub.remove_device(mt::fake_shared(device));
+    expect_and_execute_multiplexer();
+}
+
 TEST_F(InputDeviceHubTest, emit_ready_to_receive_input_after_first_device_added)
 {
     EXPECT_CALL(mock_server_status_listener, ready_for_user_input()).Times(1);
@@ -108,6 +108,23 @@ TEST_F(EventFilterChainDispatcher, does_not_own_event_filters)
     EXPECT_FALSE(filter_chain.handle(*event));
 }
 
+TEST_F(EventFilterChainDispatcher, filter_can_change_chain_while_handling_event)
+{
+    auto filter1 = mock_filter();
+    auto filter2 = mock_filter();
+
+    mi::EventFilterChainDispatcher filter_chain({filter1}, std::make_shared<mi::NullInputDispatcher>());
+
+    EXPECT_CALL(*filter1, handle(_)).WillOnce(InvokeWithoutArgs(
+        [&]{ filter_chain.append(filter2); return false; }));
+    EXPECT_FALSE(filter_chain.handle(*event));
+
+    // The new filter applies from the next event
+    EXPECT_CALL(*filter1, handle(_)).WillOnce(Return(false));
+    EXPECT_CALL(*filter2, handle(_)).WillOnce(Return(true));
+    EXPECT_TRUE(filter_chain.handle(*event));
+}
+
 TEST_F(EventFilterChainDispatcher, forwards_start_and_stop)
 {
     auto mock_next_dispatcher = std::make_shared<mtd::MockInputDispatcher>();
@@ -0,0 +1,134 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/input/resampling_dispatcher.h"
+
+#include "mir/events/event_builders.h"
+
+#include "mir/test/event_matchers.h"
+#include "mir/test/doubles/fake_alarm_factory.h"
+#include "mir/test/doubles/mock_input_dispatcher.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace mi = mir::input;
+namespace mev = mir::events;
+namespace mt = mir::test;
+namespace mtd = mt::doubles;
+
+using namespace ::testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+struct ResamplingDispatcher : Test
+{
+    MirInputDeviceId const device{3};
+    std::shared_ptr<mtd::MockInputDispatcher> const next_dispatcher{std::make_shared<NiceMock<mtd::MockInputDispatcher>>()};
+    mi::ResamplingDispatcher dispatcher{next_dispatcher, std::make_shared<mtd::FakeAlarmFactory>(), 10ms};
+
+    auto pointer_motion(std::chrono::nanoseconds time, float x, float y) -> mir::EventUPtr
+    {
+        return mev::make_event(
+            device, time, std::vector<uint8_t>{}, mir_input_event_modifier_none, mir_pointer_action_motion, 0,
+            x, y, 0, 0, 0, 0);
+    }
+
+    auto pointer_button_down(std::chrono::nanoseconds time, float x, float y) -> mir::EventUPtr
+    {
+        return mev::make_event(
+            device, time, std::vector<uint8_t>{}, mir_input_event_modifier_none, mir_pointer_action_button_down,
+            mir_pointer_button_primary, x, y, 0, 0, 0, 0);
+    }
+
+    auto touch(std::chrono::nanoseconds time, MirTouchAction action, float x, float y) -> mir::EventUPtr
+    {
+        auto event = mev::make_event(device, time, std::vector<uint8_t>{}, mir_input_event_modifier_none);
+        mev::add_touch(*event, 0, action, mir_touch_tooltype_finger, x, y, 1, 1, 1, 1);
+        return event;
+    }
+};
+}
+
+TEST_F(ResamplingDispatcher, passes_on_the_start_of_motion)
+{
+    EXPECT_CALL(*next_dispatcher, dispatch(mt::PointerEventWithPosition(0, 0)));
+
+    dispatcher.dispatch(pointer_motion(0ms, 0, 0));
+}
+
+TEST_F(ResamplingDispatcher, holds_back_further_motion_until_the_frame)
+{
+    dispatcher.dispatch(pointer_motion(0ms, 0, 0));
+
+    EXPECT_CALL(*next_dispatcher, dispatch(_)).Times(0);
+
+    dispatcher.dispatch(pointer_motion(10ms, 100, 0));
+}
+
+TEST_F(ResamplingDispatcher, frame_delivers_interpolated_pointer_motion)
+{
+    dispatcher.dispatch(pointer_motion(0ms, 0, 0));
+    dispatcher.dispatch(pointer_motion(10ms, 100, 0));
+
+    EXPECT_CALL(*next_dispatcher, dispatch(mt::PointerEventWithPosition(50, 0)));
+
+    dispatcher.resample_for_frame(10ms);
+}
+
+TEST_F(ResamplingDispatcher, frame_delivers_interpolated_touch_motion)
+{
+    dispatcher.dispatch(touch(0ms, mir_touch_action_down, 0, 0));
+    dispatcher.dispatch(touch(0ms, mir_touch_action_change, 0, 0));
+    dispatcher.dispatch(touch(10ms, mir_touch_action_change, 0, 100));
+
+    EXPECT_CALL(*next_dispatcher, dispatch(mt::TouchContact(0, mir_touch_action_change, 0, 50)));
+
+    dispatcher.resample_for_frame(10ms);
+}
+
+TEST_F(ResamplingDispatcher, extrapolation_is_limited)
+{
+    dispatcher.dispatch(pointer_motion(0ms, 0, 0));
+    dispatcher.dispatch(pointer_motion(10ms, 100, 0));
+
+    // No further than half the interval between the samples
+    EXPECT_CALL(*next_dispatcher, dispatch(mt::PointerEventWithPosition(150, 0)));
+
+    dispatcher.resample_for_frame(30ms);
+}
+
+TEST_F(ResamplingDispatcher, other_events_follow_the_motion_held_back)
+{
+    dispatcher.dispatch(pointer_motion(0ms, 0, 0));
+    dispatcher.dispatch(pointer_motion(10ms, 100, 0));
+
+    InSequence seq;
+    EXPECT_CALL(*next_dispatcher, dispatch(mt::PointerEventWithPosition(100, 0)));
+    EXPECT_CALL(*next_dispatcher, dispatch(mt::ButtonDownEvent(100, 0)));
+
+    dispatcher.dispatch(pointer_button_down(12ms, 100, 0));
+}
+
+TEST_F(ResamplingDispatcher, frame_without_motion_delivers_nothing)
+{
+    dispatcher.dispatch(pointer_motion(0ms, 0, 0));
+
+    EXPECT_CALL(*next_dispatcher, dispatch(_)).Times(0);
+
+    dispatcher.resample_for_frame(10ms);
+}
@@ -20,6 +20,7 @@
 #include "src/server/input/default_event_builder.h"
 
 #include "mir/input/xkb_mapper.h"
+#include "mir/input/input_report.h"
 #include "mir/test/doubles/mock_input_device.h"
 #include "mir/test/doubles/mock_input_dispatcher.h"
 #include "mir/test/doubles/mock_cursor_listener.h"
@@ -37,6 +38,9 @@
 #include <gtest/gtest.h>
 #include <linux/input.h>
 
+#include <atomic>
+#include <thread>
+
 namespace mt = mir::test;
 namespace mtd = mt::doubles;
 namespace mi = mir::input;
@@ -48,6 +52,17 @@ template<typename Type>
 using Nice = ::testing::NiceMock<Type>;
 using namespace ::testing;
 
+struct MockInputReport : mi::InputReport
+{
+    MOCK_METHOD4(received_event_from_kernel, void(int64_t, int, int, int));
+    MOCK_METHOD3(published_key_event, void(int, uint32_t, int64_t));
+    MOCK_METHOD3(published_motion_event, void(int, uint32_t, int64_t));
+    MOCK_METHOD2(opened_input_device, void(char const*, char const*));
+    MOCK_METHOD2(failed_to_open_input_device, void(char const*, char const*));
+    MOCK_METHOD2(event_reached_stage, void(Stage, int64_t));
+    MOCK_METHOD2(event_dropped, void(Stage, int64_t));
+};
+
 struct SeatInputDeviceTracker : ::testing::Test
 {
     mi::EventBuilder* builder;
@@ -56,6 +71,7 @@ struct SeatInputDeviceTracker : ::testing::Test
     Nice<mtd::MockTouchVisualizer> mock_visualizer;
     Nice<mtd::MockInputSeat> mock_seat;
     Nice<mtd::MockSeatObserver> mock_seat_report;
+    Nice<MockInputReport> mock_input_report;
     MirInputDeviceId some_device{8712};
     MirInputDeviceId another_device{1246};
     MirInputDeviceId third_device{86};
@@ -68,7 +84,8 @@ struct SeatInputDeviceTracker : ::testing::Test
     mi::receiver::XKBMapper mapper;
     mi::SeatInputDeviceTracker tracker{
         mt::fake_shared(mock_dispatcher), mt::fake_shared(mock_visualizer), mt::fake_shared(mock_cursor_listener),
-        mt::fake_shared(mapper),          mt::fake_shared(clock),           mt::fake_shared(mock_seat_report)};
+        mt::fake_shared(mapper),          mt::fake_shared(clock),           mt::fake_shared(mock_seat_report),
+        mt::fake_shared(mock_input_report)};
 
     std::chrono::nanoseconds arbitrary_timestamp;
 };
@@ -262,6 +279,31 @@ TEST_F(SeatInputDeviceTracker, inconsistent_key_up_dropped)
     tracker.dispatch(some_device_builder.key_event(arbitrary_timestamp, mir_keyboard_action_up, 0, KEY_A));
 }
 
+TEST_F(SeatInputDeviceTracker, reports_events_reaching_the_dispatcher)
+{
+    using Stage = mi::InputReport::Stage;
+    std::chrono::nanoseconds const event_time{42};
+    tracker.add_device(some_device);
+    ON_CALL(mock_dispatcher, dispatch(_)).WillByDefault(Return(true));
+
+    EXPECT_CALL(mock_input_report, event_reached_stage(Stage::seat, event_time.count()));
+    EXPECT_CALL(mock_input_report, event_reached_stage(Stage::dispatcher, event_time.count()));
+
+    tracker.dispatch(some_device_builder.key_event(event_time, mir_keyboard_action_down, 0, KEY_A));
+}
+
+TEST_F(SeatInputDeviceTracker, reports_events_dropped_by_the_seat)
+{
+    using Stage = mi::InputReport::Stage;
+    std::chrono::nanoseconds const event_time{42};
+    tracker.add_device(some_device);
+
+    EXPECT_CALL(mock_input_report, event_dropped(Stage::seat, event_time.count()));
+    EXPECT_CALL(mock_input_report, event_reached_stage(_, _)).Times(0);
+
+    tracker.dispatch(some_device_builder.key_event(event_time, mir_keyboard_action_up, 0, KEY_A));
+}
+
 TEST_F(SeatInputDeviceTracker, pointer_confinement_bounds_mouse_inside)
 {
     auto const move_x = 20.0f, move_y = 40.0f;
@@ -296,3 +338,85 @@ TEST_F(SeatInputDeviceTracker, reset_pointer_confinement_allows_movement_past)
     tracker.dispatch(some_device_builder.pointer_event(arbitrary_timestamp, mir_pointer_action_motion, 0, 0.0f, 0.0f,
                                                     max_w_h * 2, max_w_h * 2));
 }
+
+TEST_F(SeatInputDeviceTracker, cursor_position_and_button_state_follow_pointer_events)
+{
+    tracker.add_device(some_device);
+    tracker.dispatch(some_device_builder.pointer_event(arbitrary_timestamp, mir_pointer_action_motion, 0, 0.0f, 0.0f,
+                                                    20.0f, 40.0f));
+    tracker.dispatch(some_device_builder.pointer_event(arbitrary_timestamp, mir_pointer_action_button_down,
+                                                    mir_pointer_button_primary, 0.0f, 0.0f, 0.0f, 0.0f));
+
+    EXPECT_THAT(tracker.cursor_position(), Eq(geom::Point{20, 40}));
+    EXPECT_THAT(tracker.button_state(), Eq(mir_pointer_button_primary));
+
+    tracker.dispatch(some_device_builder.pointer_event(arbitrary_timestamp, mir_pointer_action_button_up,
+                                                    0, 0.0f, 0.0f, 0.0f, 0.0f));
+
+    EXPECT_THAT(tracker.button_state(), Eq(MirPointerButtons{0}));
+}
+
+TEST_F(SeatInputDeviceTracker, set_cursor_position_is_seen_by_cursor_position)
+{
+    tracker.set_cursor_position(12.0f, 34.0f);
+
+    EXPECT_THAT(tracker.cursor_position(), Eq(geom::Point{12, 34}));
+}
+
+TEST_F(SeatInputDeviceTracker, updating_outputs_keeps_pointer_confinement)
+{
+    auto const max_w_h = 100;
+    EXPECT_CALL(mock_cursor_listener, cursor_moved_to(max_w_h - 1, max_w_h - 1)).Times(1);
+
+    tracker.set_confinement_regions({geom::Rectangle{{0, 0}, {max_w_h, max_w_h}}});
+    tracker.update_outputs({geom::Rectangle{{0, 0}, {max_w_h * 4, max_w_h * 4}}});
+    tracker.add_device(some_device);
+    tracker.dispatch(some_device_builder.pointer_event(arbitrary_timestamp, mir_pointer_action_motion, 0, 0.0f, 0.0f,
+                                                    max_w_h * 2, max_w_h * 2));
+
+    EXPECT_THAT(tracker.cursor_position(), Eq(geom::Point{max_w_h - 1, max_w_h - 1}));
+}
+
+TEST_F(SeatInputDeviceTracker, setting_pointer_confinement_keeps_output_bounds)
+{
+    auto const max_w_h = 100;
+    EXPECT_CALL(mock_cursor_listener, cursor_moved_to(max_w_h - 1, max_w_h - 1)).Times(1);
+
+    tracker.update_outputs({geom::Rectangle{{0, 0}, {max_w_h, max_w_h}}});
+    tracker.set_confinement_regions({geom::Rectangle{{0, 0}, {max_w_h * 4, max_w_h * 4}}});
+    tracker.add_device(some_device);
+    tracker.dispatch(some_device_builder.pointer_event(arbitrary_timestamp, mir_pointer_action_motion, 0, 0.0f, 0.0f,
+                                                    max_w_h * 2, max_w_h * 2));
+
+    EXPECT_THAT(tracker.cursor_position(), Eq(geom::Point{max_w_h - 1, max_w_h - 1}));
+}
+
+TEST_F(SeatInputDeviceTracker, cursor_position_read_during_confinement_changes_is_always_confined)
+{
+    auto const max_w_h = 100;
+    geom::Rectangle const small{{0, 0}, {max_w_h, max_w_h}};
+    geom::Rectangle const large{{0, 0}, {max_w_h * 2, max_w_h * 2}};
+    tracker.set_confinement_regions({large});
+    tracker.add_device(some_device);
+
+    std::atomic<bool> done{false};
+    std::thread reader{[&]
+        {
+            while (!done)
+            {
+                auto const position = tracker.cursor_position();
+                EXPECT_TRUE(large.contains(position)) << position;
+            }
+        }};
+
+    for (auto i = 0; i != 1000; ++i)
+    {
+        tracker.set_confinement_regions({i % 2 ? small : large});
+        auto const step = i % 2 ? max_w_h : -max_w_h;
+        tracker.dispatch(some_device_builder.pointer_event(arbitrary_timestamp, mir_pointer_action_motion, 0,
+                                                        0.0f, 0.0f, step, step));
+    }
+
+    done = true;
+    reader.join();
+}
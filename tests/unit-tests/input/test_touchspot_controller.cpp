@@ -258,13 +258,25 @@ TEST_F(TestTouchspotControllerSceneUpdates, does_not_emit_damage_if_nothing_happ
     controller.visualize_touches({});
 }
 
-TEST_F(TestTouchspotControllerSceneUpdates, emits_scene_damage)
+TEST_F(TestTouchspotControllerSceneUpdates, emits_scene_damage_when_spot_moves)
 {
-    EXPECT_CALL(*scene, emit_scene_changed()).Times(2);
-
     mi::TouchspotController controller(allocator, scene);
 
     controller.enable();
+    // Adding the visualization is left to the scene to report
     controller.visualize_touches({ {{0,0}, 1} });
+
+    EXPECT_CALL(*scene, emit_scene_changed()).Times(1);
     controller.visualize_touches({ {{1,1}, 1}});
 }
+
+TEST_F(TestTouchspotControllerSceneUpdates, does_not_emit_damage_if_spots_stay_still)
+{
+    mi::TouchspotController controller(allocator, scene);
+
+    controller.enable();
+    controller.visualize_touches({ {{1,1}, 1} });
+
+    EXPECT_CALL(*scene, emit_scene_changed()).Times(0);
+    controller.visualize_touches({ {{1,1}, 0.5}});
+}
@@ -0,0 +1,193 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/report/logging/async_logger.h"
+#include "mir/test/pipe.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <fcntl.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mrl = mir::report::logging;
+namespace ml = mir::logging;
+namespace mt = mir::test;
+
+using namespace testing;
+
+namespace
+{
+struct AsyncLogger : Test
+{
+    AsyncLogger()
+    {
+        for (auto fd : {out.read_fd(), err.read_fd()})
+            fcntl(fd, F_SETFL, O_NONBLOCK);
+    }
+
+    static auto read_all(int fd) -> std::string
+    {
+        std::string result;
+        char buffer[4096];
+        ssize_t n;
+        while ((n = read(fd, buffer, sizeof buffer)) > 0)
+            result.append(buffer, n);
+        return result;
+    }
+
+    static auto lines_of(std::string const& text) -> std::vector<std::string>
+    {
+        std::vector<std::string> result;
+        std::string::size_type start = 0, end;
+        while ((end = text.find('\n', start)) != std::string::npos)
+        {
+            result.push_back(text.substr(start, end - start));
+            start = end + 1;
+        }
+        return result;
+    }
+
+    mt::Pipe out;
+    mt::Pipe err;
+};
+}
+
+TEST_F(AsyncLogger, writes_messages_in_dumb_console_logger_format)
+{
+    mrl::AsyncLogger logger{0, out.write_fd(), err.write_fd()};
+
+    logger.log(ml::Severity::informational, "Hello", "test");
+    logger.log("test", ml::Severity::debug, "formatted %d", 42);
+    logger.flush();
+
+    auto const lines = lines_of(read_all(out.read_fd()));
+    ASSERT_THAT(lines.size(), Eq(2u));
+    EXPECT_THAT(lines[0], MatchesRegex(R"(\[[-0-9]+ [:0-9]+\.[0-9]{6}\] <information> test: Hello)"));
+    EXPECT_THAT(lines[1], EndsWith("< - debug - > test: formatted 42"));
+}
+
+TEST_F(AsyncLogger, writes_warnings_and_worse_to_error_fd)
+{
+    mrl::AsyncLogger logger{0, out.write_fd(), err.write_fd()};
+
+    logger.log(ml::Severity::warning, "careful", "test");
+    logger.log(ml::Severity::informational, "fine", "test");
+    logger.flush();
+
+    EXPECT_THAT(read_all(err.read_fd()), HasSubstr("careful"));
+    EXPECT_THAT(read_all(out.read_fd()), Not(HasSubstr("careful")));
+}
+
+TEST_F(AsyncLogger, preserves_the_order_of_each_threads_messages)
+{
+    int const per_thread = 20;
+    mrl::AsyncLogger logger{0, out.write_fd(), err.write_fd()};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t != 4; ++t)
+    {
+        threads.emplace_back([&, t]
+            {
+                for (int i = 0; i != per_thread; ++i)
+                    logger.log("test", ml::Severity::informational, "thread %d message %d", t, i);
+            });
+    }
+    for (auto& thread : threads)
+        thread.join();
+    logger.flush();
+
+    std::vector<int> next(4, 0);
+    for (auto const& line : lines_of(read_all(out.read_fd())))
+    {
+        int t, i;
+        ASSERT_THAT(sscanf(line.c_str(), "%*[^:]:%*[^:]:%*[^:]: thread %d message %d", &t, &i), Eq(2)) << line;
+        EXPECT_THAT(i, Eq(next[t]));
+        next[t] = i + 1;
+    }
+    EXPECT_THAT(next, Each(Eq(per_thread)));
+}
+
+TEST_F(AsyncLogger, truncates_long_messages)
+{
+    mrl::AsyncLogger logger{0, out.write_fd(), err.write_fd()};
+
+    logger.log(ml::Severity::informational, std::string(5000, 'x'), "test");
+    logger.log("test", ml::Severity::informational, "%s", std::string(5000, 'y').c_str());
+    logger.flush();
+
+    auto const lines = lines_of(read_all(out.read_fd()));
+    ASSERT_THAT(lines.size(), Eq(2u));
+    EXPECT_THAT(lines[0], EndsWith("xxx..."));
+    EXPECT_THAT(lines[0].size(), Lt(1100u));
+    EXPECT_THAT(lines[1], EndsWith("yyy..."));
+    EXPECT_THAT(lines[1].size(), Lt(1100u));
+}
+
+TEST_F(AsyncLogger, drops_and_counts_messages_beyond_the_rate_limit)
+{
+    mrl::AsyncLogger logger{5, out.write_fd(), err.write_fd()};
+
+    // Even if a second boundary falls mid-loop, at most 10 of these can be let through
+    for (int i = 0; i != 20; ++i)
+        logger.log(ml::Severity::informational, "spam", "test");
+    logger.flush();
+
+    auto const logged = lines_of(read_all(out.read_fd())).size();
+    EXPECT_THAT(logged, Le(10u));
+    EXPECT_THAT(logger.dropped().rate_limited, Eq(20u - logged));
+    EXPECT_THAT(read_all(err.read_fd()), HasSubstr("messages dropped (rate limited)"));
+}
+
+TEST_F(AsyncLogger, drops_and_counts_messages_that_do_not_fit_in_the_ring)
+{
+    mrl::AsyncLogger logger{0, out.write_fd(), err.write_fd()};
+
+    int const attempts = 500;
+    for (int i = 0; i != attempts; ++i)
+        logger.log(ml::Severity::informational, "burst", "test");
+    logger.flush();
+
+    auto const logged = lines_of(read_all(out.read_fd())).size();
+    EXPECT_THAT(logger.dropped().ring_full, Eq(attempts - logged));
+}
+
+TEST_F(AsyncLogger, writes_pending_messages_on_destruction)
+{
+    {
+        mrl::AsyncLogger logger{0, out.write_fd(), err.write_fd()};
+        logger.log(ml::Severity::informational, "last words", "test");
+    }
+
+    EXPECT_THAT(read_all(out.read_fd()), HasSubstr("last words"));
+}
+
+TEST_F(AsyncLogger, keeps_counting_drops_of_threads_that_have_exited)
+{
+    mrl::AsyncLogger logger{1, out.write_fd(), err.write_fd()};
+
+    std::thread{[&]
+        {
+            for (int i = 0; i != 10; ++i)
+                logger.log(ml::Severity::informational, "spam", "test");
+        }}.join();
+    logger.flush();
+    logger.flush();
+
+    EXPECT_THAT(logger.dropped().rate_limited, Ge(8u));
+}
@@ -189,3 +189,33 @@ TEST_F(LoggingCompositorReport, bypass_has_no_render_time)
 
     report.stopped();
 }
+
+TEST_F(LoggingCompositorReport, includes_gpu_time_only_when_measured)
+{
+    const void* const id = "My Screen";
+
+    report.started();
+
+    for (int f = 0; f < 3; ++f)
+    {
+        report.began_frame(id);
+        report.rendered_frame(id);
+        report.finished_frame(id);
+        clock->advance_by(chrono::microseconds(12345678));
+    }
+    EXPECT_FALSE(recorder->last_message_contains("GPU"))
+        << recorder->last_message();
+
+    for (int f = 0; f < 3; ++f)
+    {
+        report.began_frame(id);
+        report.rendered_frame(id);
+        report.measured_gpu_render_time(id, chrono::microseconds(2500));
+        report.finished_frame(id);
+        clock->advance_by(chrono::microseconds(12345678));
+    }
+    EXPECT_TRUE(recorder->last_message_contains("GPU 2.500 ms/frame"))
+        << recorder->last_message();
+
+    report.stopped();
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/report/logging/compositor_statistics_report.h"
+#include "mir/logging/logger.h"
+#include "mir/test/doubles/advanceable_clock.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace mtd = mir::test::doubles;
+namespace mrl = mir::report::logging;
+namespace ml = mir::logging;
+
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+class Recorder : public ml::Logger
+{
+public:
+    void log(ml::Severity, std::string const& message, std::string const&) override
+    {
+        messages.push_back(message);
+    }
+
+    std::vector<std::string> messages;
+};
+
+struct CompositorStatisticsReport : Test
+{
+    void frame(std::chrono::microseconds render_time, std::chrono::microseconds wait_for_display)
+    {
+        report.scheduled();
+        report.began_frame(display_id);
+        clock->advance_by(render_time);
+        report.rendered_frame(display_id);
+        report.finished_frame(display_id);
+        clock->advance_by(wait_for_display);
+    }
+
+    std::shared_ptr<mtd::AdvanceableClock> const clock{std::make_shared<mtd::AdvanceableClock>()};
+    std::shared_ptr<Recorder> const recorder{std::make_shared<Recorder>()};
+    mrl::CompositorStatisticsReport report{recorder, clock, 10s};
+    void const* const display_id{"display"};
+};
+}
+
+TEST(DurationHistogram, percentiles_are_bucket_upper_bounds)
+{
+    mrl::DurationHistogram histogram;
+
+    for (int i = 0; i != 99; ++i)
+        histogram.add(1050us);
+    histogram.add(20ms);
+
+    EXPECT_THAT(histogram.count(), Eq(100));
+    EXPECT_THAT(histogram.percentile(50), Eq(1100us));
+    EXPECT_THAT(histogram.percentile(99), Eq(1100us));
+    EXPECT_THAT(histogram.percentile(100), Eq(20100us));
+}
+
+TEST(DurationHistogram, long_durations_are_counted_in_the_last_bucket)
+{
+    mrl::DurationHistogram histogram;
+
+    histogram.add(10s);
+
+    EXPECT_THAT(histogram.percentile(50), Eq(100ms));
+}
+
+TEST(DurationHistogram, empty_histogram_has_zero_percentiles)
+{
+    mrl::DurationHistogram histogram;
+
+    EXPECT_THAT(histogram.percentile(99), Eq(0us));
+}
+
+TEST_F(CompositorStatisticsReport, occasional_slow_frames_show_in_the_tail)
+{
+    for (int i = 0; i != 98; ++i)
+        frame(4ms, 12ms);
+    frame(30ms, 2ms);
+    frame(30ms, 2ms);
+
+    auto const stats = report.statistics().at(display_id);
+
+    EXPECT_THAT(stats.render_time.percentile(50), Eq(4100us));
+    EXPECT_THAT(stats.render_time.percentile(99), Eq(30100us));
+    EXPECT_THAT(stats.frame_interval.percentile(50), Eq(16100us));
+}
+
+TEST_F(CompositorStatisticsReport, logs_percentiles_each_interval_and_starts_afresh)
+{
+    for (int i = 0; i != 700; ++i)
+        frame(4ms, 12ms);
+
+    ASSERT_THAT(recorder->messages, Not(IsEmpty()));
+    EXPECT_THAT(recorder->messages.back(), HasSubstr("p50/p95/p99"));
+    EXPECT_THAT(report.statistics().at(display_id).frame_time.count(), Lt(700));
+}
+
+TEST_F(CompositorStatisticsReport, bypassed_frames_have_no_render_time)
+{
+    report.began_frame(display_id);
+    clock->advance_by(1ms);
+    report.finished_frame(display_id);
+
+    auto const stats = report.statistics().at(display_id);
+
+    EXPECT_THAT(stats.frame_time.count(), Eq(1));
+    EXPECT_THAT(stats.render_time.count(), Eq(0));
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "src/server/report/logging/memory_report.h"
+#include "mir/logging/logger.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace mr = mir::report;
+namespace ml = mir::logging;
+
+using namespace testing;
+
+namespace
+{
+class Recorder : public ml::Logger
+{
+public:
+    void log(ml::Severity, std::string const& message, std::string const&) override
+    {
+        messages.push_back(message);
+    }
+
+    std::vector<std::string> messages;
+};
+
+struct MemoryReport : Test
+{
+    std::shared_ptr<Recorder> const recorder{std::make_shared<Recorder>()};
+    mr::logging::MemoryReport report{recorder};
+};
+}
+
+TEST_F(MemoryReport, logs_each_account_with_its_share_per_client)
+{
+    report.memory_sampled(
+        {
+            {"wayland", "clients", 4, 400},
+            {"buffers", "shm", 8, 8000},
+        },
+        100000);
+
+    EXPECT_THAT(recorder->messages, ElementsAre(
+        "Memory: 100000 bytes resident, 8400 bytes accounted, 4 clients",
+        "Memory: wayland/clients: 4 objects, 400 bytes (1.0 objects, 100 bytes per client)",
+        "Memory: buffers/shm: 8 objects, 8000 bytes (2.0 objects, 2000 bytes per client)"));
+}
+
+TEST_F(MemoryReport, leaves_out_empty_accounts_and_per_client_shares_without_clients)
+{
+    report.memory_sampled(
+        {
+            {"buffers", "dmabuf", 0, 0},
+            {"keymaps", "compiled", 1, 1000},
+        },
+        100000);
+
+    EXPECT_THAT(recorder->messages, ElementsAre(
+        "Memory: 100000 bytes resident, 1000 bytes accounted, 0 clients",
+        "Memory: keymaps/compiled: 1 objects, 1000 bytes"));
+}
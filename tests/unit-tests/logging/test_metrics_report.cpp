@@ -0,0 +1,225 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/report/metrics/registry.h"
+#include "src/server/report/metrics/endpoint.h"
+#include "src/server/report/metrics/compositor_report.h"
+#include "mir/test/doubles/advanceable_clock.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cstring>
+
+namespace mrm = mir::report::metrics;
+namespace mtd = mir::test::doubles;
+
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+auto fetch(std::string const& path, std::string const& request) -> std::string
+{
+    mir::Fd client{socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, path.c_str(), sizeof address.sun_path - 1);
+    if (connect(client, reinterpret_cast<sockaddr*>(&address), sizeof address) < 0)
+        return "connect failed";
+
+    if (!request.empty() && write(client, request.data(), request.size()) != static_cast<ssize_t>(request.size()))
+        return "write failed";
+
+    std::string response;
+    char buffer[1024];
+    ssize_t n;
+    while ((n = read(client, buffer, sizeof buffer)) > 0)
+        response.append(buffer, n);
+    return response;
+}
+}
+
+TEST(MetricsRegistry, exposes_counters_and_gauges_in_openmetrics_format)
+{
+    mrm::Registry registry;
+
+    registry.counter("mir_things", "Things counted", {{"kind", "a"}}).increment(3);
+    registry.gauge("mir_level", "A level").set(-2);
+
+    EXPECT_THAT(registry.exposition(), Eq(
+        "# TYPE mir_level gauge\n"
+        "# HELP mir_level A level\n"
+        "mir_level -2\n"
+        "# TYPE mir_things counter\n"
+        "# HELP mir_things Things counted\n"
+        "mir_things_total{kind=\"a\"} 3\n"
+        "# EOF\n"));
+}
+
+TEST(MetricsRegistry, returns_the_same_metric_for_the_same_name_and_labels)
+{
+    mrm::Registry registry;
+
+    auto& a = registry.counter("mir_things", "Things", {{"kind", "a"}});
+    auto& b = registry.counter("mir_things", "Things", {{"kind", "b"}});
+
+    EXPECT_THAT(&registry.counter("mir_things", "Things", {{"kind", "a"}}), Eq(&a));
+    EXPECT_THAT(&b, Ne(&a));
+}
+
+TEST(MetricsRegistry, rejects_a_name_reused_for_another_type)
+{
+    mrm::Registry registry;
+    registry.counter("mir_things", "Things");
+
+    EXPECT_THROW(registry.gauge("mir_things", "Things"), std::logic_error);
+}
+
+TEST(MetricsRegistry, escapes_label_values)
+{
+    mrm::Registry registry;
+    registry.counter("mir_things", "Things", {{"client", "a \"quoted\\\" name\n"}}).increment();
+
+    EXPECT_THAT(registry.exposition(), HasSubstr(R"(mir_things_total{client="a \"quoted\\\" name\n"} 1)"));
+}
+
+TEST(MetricsRegistry, exposes_cumulative_histogram_buckets)
+{
+    mrm::Registry registry;
+    auto& histogram = registry.histogram("mir_time_seconds", "Time", {0.5, 1}, {{"display", "0"}});
+
+    histogram.observe(0.25);
+    histogram.observe(0.75);
+    histogram.observe(1);
+    histogram.observe(5);
+
+    EXPECT_THAT(histogram.count(), Eq(4u));
+    EXPECT_THAT(registry.exposition(), HasSubstr(
+        "mir_time_seconds_bucket{display=\"0\",le=\"0.5\"} 1\n"
+        "mir_time_seconds_bucket{display=\"0\",le=\"1\"} 3\n"
+        "mir_time_seconds_bucket{display=\"0\",le=\"+Inf\"} 4\n"
+        "mir_time_seconds_count{display=\"0\"} 4\n"
+        "mir_time_seconds_sum{display=\"0\"} 7\n"));
+}
+
+TEST(MetricsCompositorReport, counts_frames_and_bypassed_frames_per_display)
+{
+    auto const registry = std::make_shared<mrm::Registry>();
+    auto const clock = std::make_shared<mtd::AdvanceableClock>();
+    mrm::CompositorReport report{registry, clock};
+    void const* const id = "display";
+
+    report.added_display(1920, 1080, 0, 0, id);
+    for (int frame = 0; frame != 3; ++frame)
+    {
+        report.began_frame(id);
+        clock->advance_by(5ms);
+        if (frame != 1)
+            report.rendered_frame(id);
+        report.finished_frame(id);
+    }
+
+    auto const labels = mrm::Labels{{"display", "1920x1080+0+0"}};
+    EXPECT_THAT(registry->counter("mir_compositor_frames", "", labels).value(), Eq(3u));
+    EXPECT_THAT(registry->counter("mir_compositor_bypassed_frames", "", labels).value(), Eq(1u));
+    EXPECT_THAT(registry->histogram("mir_compositor_frame_time_seconds", "", {}, labels).count(), Eq(3u));
+    EXPECT_THAT(registry->histogram("mir_compositor_frame_time_seconds", "", {}, labels).sum(), DoubleNear(0.015, 1e-9));
+}
+
+struct MetricsEndpoint : Test
+{
+    MetricsEndpoint()
+    {
+        char dir_template[] = "/tmp/mir-metrics-test-XXXXXX";
+        dir = mkdtemp(dir_template);
+        path = dir + "/metrics";
+        registry->counter("mir_things", "Things").increment();
+    }
+
+    ~MetricsEndpoint()
+    {
+        rmdir(dir.c_str());
+    }
+
+    std::string dir;
+    std::string path;
+    std::shared_ptr<mrm::Registry> const registry = std::make_shared<mrm::Registry>();
+};
+
+TEST_F(MetricsEndpoint, serves_the_exposition_to_a_plain_client)
+{
+    mrm::Endpoint endpoint{registry, path};
+
+    EXPECT_THAT(fetch(path, ""), Eq(registry->exposition()));
+}
+
+TEST_F(MetricsEndpoint, serves_the_exposition_over_http)
+{
+    mrm::Endpoint endpoint{registry, path};
+
+    auto const response = fetch(path, "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n");
+
+    EXPECT_THAT(response, StartsWith("HTTP/1.0 200 OK\r\n"));
+    EXPECT_THAT(response, HasSubstr("Content-Type: application/openmetrics-text"));
+    EXPECT_THAT(response, EndsWith("\r\n\r\n" + registry->exposition()));
+}
+
+TEST_F(MetricsEndpoint, socket_is_only_accessible_to_its_user)
+{
+    mrm::Endpoint endpoint{registry, path};
+
+    struct stat socket_info;
+    ASSERT_THAT(stat(path.c_str(), &socket_info), Eq(0));
+    EXPECT_THAT(socket_info.st_mode & 0777, Eq(0600u));
+}
+
+TEST_F(MetricsEndpoint, removes_its_socket_when_destroyed)
+{
+    {
+        mrm::Endpoint endpoint{registry, path};
+        ASSERT_THAT(access(path.c_str(), F_OK), Eq(0));
+    }
+
+    EXPECT_THAT(access(path.c_str(), F_OK), Ne(0));
+}
+
+TEST_F(MetricsEndpoint, replaces_a_stale_socket)
+{
+    {
+        mir::Fd stale{socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        strncpy(address.sun_path, path.c_str(), sizeof address.sun_path - 1);
+        ASSERT_THAT(bind(stale, reinterpret_cast<sockaddr*>(&address), sizeof address), Eq(0));
+    }
+
+    mrm::Endpoint endpoint{registry, path};
+
+    EXPECT_THAT(fetch(path, ""), Eq(registry->exposition()));
+}
+
+TEST_F(MetricsEndpoint, refuses_a_socket_in_use)
+{
+    mrm::Endpoint endpoint{registry, path};
+
+    EXPECT_THROW((mrm::Endpoint{registry, path}), std::runtime_error);
+}
@@ -0,0 +1,180 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/report/performance_hud.h"
+#include "src/server/report/null/compositor_report.h"
+#include "src/server/report/null/display_report.h"
+#include "mir/graphics/frame.h"
+#include "mir/test/doubles/advanceable_clock.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace mtd = mir::test::doubles;
+namespace mr = mir::report;
+namespace mg = mir::graphics;
+namespace geom = mir::geometry;
+
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+struct PerformanceHud : Test
+{
+    void frame(void const* display, std::chrono::microseconds frame_time, bool rendered = true)
+    {
+        compositor_report->scheduled();
+        compositor_report->began_frame(display);
+        clock->advance_by(frame_time);
+        if (rendered)
+            compositor_report->rendered_frame(display);
+        compositor_report->finished_frame(display);
+    }
+
+    void vsync(int64_t msc, mir::time::PosixTimestamp ust)
+    {
+        display_report->report_vsync(output_id, mg::Frame{msc, ust});
+    }
+
+    std::shared_ptr<mtd::AdvanceableClock> const clock{std::make_shared<mtd::AdvanceableClock>()};
+    std::shared_ptr<mr::PerformanceHud> const hud{std::make_shared<mr::PerformanceHud>(clock)};
+    std::shared_ptr<mir::compositor::CompositorReport> const compositor_report{
+        hud->compositor_report(std::make_shared<mr::null::CompositorReport>())};
+    std::shared_ptr<mg::DisplayReport> const display_report{
+        hud->display_report(std::make_shared<mr::null::DisplayReport>())};
+    void const* const display_id{"display"};
+    unsigned int const output_id{1};
+};
+}
+
+TEST_F(PerformanceHud, shows_each_displays_frame_rate_and_frame_times)
+{
+    compositor_report->added_display(1920, 1080, 0, 0, display_id);
+
+    for (int i = 0; i != 60; ++i)
+    {
+        frame(display_id, 2ms);
+        clock->advance_by(14ms);
+    }
+    clock->advance_by(40ms);
+
+    auto const summary = hud->summary();
+
+    ASSERT_THAT(summary.displays.size(), Eq(1u));
+    EXPECT_THAT(summary.displays[0].area, Eq(geom::Rectangle{{0, 0}, {1920, 1080}}));
+    EXPECT_THAT(summary.displays[0].frames_per_second, Eq(60));
+    EXPECT_THAT(summary.displays[0].frame_times.size(), Eq(60u));
+    EXPECT_THAT(summary.displays[0].frame_times.back(), Eq(2ms));
+}
+
+TEST_F(PerformanceHud, keeps_only_the_latest_frame_times)
+{
+    compositor_report->added_display(1920, 1080, 0, 0, display_id);
+
+    for (int i = 0; i != 2 * mr::PerformanceHud::max_frame_times; ++i)
+        frame(display_id, std::chrono::microseconds{i});
+
+    auto const summary = hud->summary();
+
+    ASSERT_THAT(summary.displays.size(), Eq(1u));
+    EXPECT_THAT(summary.displays[0].frame_times.size(), Eq(size_t(mr::PerformanceHud::max_frame_times)));
+    EXPECT_THAT(
+        summary.displays[0].frame_times.back(),
+        Eq(std::chrono::microseconds{2 * mr::PerformanceHud::max_frame_times - 1}));
+}
+
+TEST_F(PerformanceHud, shows_whether_the_last_frame_was_composited)
+{
+    compositor_report->added_display(1920, 1080, 0, 0, display_id);
+
+    frame(display_id, 2ms, true);
+    EXPECT_TRUE(hud->summary().displays[0].composited);
+
+    frame(display_id, 2ms, false);
+    EXPECT_FALSE(hud->summary().displays[0].composited);
+}
+
+TEST_F(PerformanceHud, forgets_displays_whose_compositor_is_replaced)
+{
+    void const* const replacement{"replacement"};
+    void const* const beside{"beside"};
+
+    compositor_report->added_display(1920, 1080, 0, 0, display_id);
+    compositor_report->added_display(1280, 1024, 1920, 0, beside);
+    compositor_report->added_display(1920, 1080, 0, 0, replacement);
+
+    auto const summary = hud->summary();
+
+    ASSERT_THAT(summary.displays.size(), Eq(2u));
+    EXPECT_THAT(summary.displays[0].area.top_left, Eq(geom::Point{1920, 0}));
+    EXPECT_THAT(summary.displays[1].area.top_left, Eq(geom::Point{0, 0}));
+}
+
+TEST_F(PerformanceHud, counts_vblanks_missed_while_a_frame_was_wanted)
+{
+    compositor_report->added_display(1920, 1080, 0, 0, display_id);
+    auto const now = mir::time::PosixTimestamp::now(CLOCK_MONOTONIC);
+
+    // The frame is asked for before the vblank at 100, but shown only at 103
+    vsync(100, now + 1s);
+    frame(display_id, 2ms);
+    vsync(103, now + 1s + 50ms);
+    clock->advance_by(1s);
+
+    EXPECT_THAT(hud->summary().missed_vblanks_per_second, Eq(2));
+}
+
+TEST_F(PerformanceHud, doesnt_count_vblanks_that_passed_while_idle)
+{
+    compositor_report->added_display(1920, 1080, 0, 0, display_id);
+    auto const now = mir::time::PosixTimestamp::now(CLOCK_MONOTONIC);
+
+    vsync(100, now - 1s);
+    frame(display_id, 2ms);
+    vsync(160, now + 16ms);
+    clock->advance_by(1s);
+
+    EXPECT_THAT(hud->summary().missed_vblanks_per_second, Eq(0));
+}
+
+TEST_F(PerformanceHud, shows_the_busiest_clients_first)
+{
+    for (int i = 0; i != 10; ++i)
+        hud->committed("quiet");
+    for (int i = 0; i != 120; ++i)
+        hud->committed("busy");
+    for (int i = 0; i != 60; ++i)
+        hud->committed("steady");
+    hud->committed("idle");
+    clock->advance_by(1s);
+
+    EXPECT_THAT(hud->summary().commits_per_second, ElementsAre(
+        std::make_pair(std::string{"busy"}, 120),
+        std::make_pair(std::string{"steady"}, 60),
+        std::make_pair(std::string{"quiet"}, 10)));
+}
+
+TEST_F(PerformanceHud, counts_frames_for_telling_whether_there_is_anything_new)
+{
+    compositor_report->added_display(1920, 1080, 0, 0, display_id);
+    auto const before = hud->frames_finished();
+
+    frame(display_id, 2ms);
+    frame(display_id, 2ms);
+
+    EXPECT_THAT(hud->frames_finished(), Eq(before + 2));
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/report/logging/startup_report.h"
+#include "src/server/report/startup_compositor_report.h"
+#include "src/server/report/null/compositor_report.h"
+#include "mir/logging/logger.h"
+#include "mir/test/doubles/advanceable_clock.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace mtd = mir::test::doubles;
+namespace mr = mir::report;
+namespace ml = mir::logging;
+
+using namespace testing;
+using namespace std::chrono_literals;
+using Phase = mir::StartupReport::Phase;
+
+namespace
+{
+class Recorder : public ml::Logger
+{
+public:
+    void log(ml::Severity, std::string const& message, std::string const&) override
+    {
+        messages.push_back(message);
+    }
+
+    std::vector<std::string> messages;
+};
+
+struct StartupReport : Test
+{
+    std::shared_ptr<mtd::AdvanceableClock> const clock{std::make_shared<mtd::AdvanceableClock>()};
+    std::shared_ptr<Recorder> const recorder{std::make_shared<Recorder>()};
+    std::shared_ptr<mr::logging::StartupReport> const report{
+        std::make_shared<mr::logging::StartupReport>(recorder, clock, clock->now() - 100ms)};
+};
+}
+
+TEST_F(StartupReport, logs_phases_after_process_start_and_previous_phase)
+{
+    report->phase_completed(Phase::platform_probed);
+    clock->advance_by(50ms);
+    report->phase_completed(Phase::display_configured);
+
+    EXPECT_THAT(recorder->messages, ElementsAre(
+        "Startup: platform_probed after 100.0 ms (+100.0 ms)",
+        "Startup: display_configured after 150.0 ms (+50.0 ms)"));
+}
+
+TEST_F(StartupReport, logs_only_the_first_completion_of_a_phase)
+{
+    report->phase_completed(Phase::xwayland_running);
+    clock->advance_by(1s);
+    report->phase_completed(Phase::xwayland_running);
+
+    EXPECT_THAT(recorder->messages, ElementsAre("Startup: xwayland_running after 100.0 ms (+100.0 ms)"));
+}
+
+TEST_F(StartupReport, compositor_marks_renderer_created_and_first_frame)
+{
+    mr::StartupCompositorReport compositor_report{std::make_shared<mr::null::CompositorReport>(), report};
+    void const* const display_id{"display"};
+
+    compositor_report.added_display(1920, 1080, 0, 0, display_id);
+    compositor_report.added_display(1920, 1080, 1920, 0, display_id);
+    compositor_report.began_frame(display_id);
+    compositor_report.finished_frame(display_id);
+    compositor_report.began_frame(display_id);
+    compositor_report.finished_frame(display_id);
+
+    EXPECT_THAT(recorder->messages, ElementsAre(
+        HasSubstr("renderer_created"),
+        HasSubstr("first_frame")));
+}
@@ -146,10 +146,10 @@ TEST_F(ThreadedDRMEventHandlerTest, calls_frame_callback_on_flip_completion)
 
     auto completion_handle = handler.expect_flip_event(
         crtc_id,
-        [frame_sec, frame_usec](unsigned int frame_no, std::chrono::milliseconds frame_time)
+        [frame_sec, frame_usec](unsigned int frame_no, std::chrono::nanoseconds frame_time)
         {
             EXPECT_THAT(frame_no, Eq(expected_frame_no));
-            EXPECT_THAT(frame_time, Eq(std::chrono::seconds{frame_sec} + std::chrono::milliseconds{frame_usec}));
+            EXPECT_THAT(frame_time, Eq(std::chrono::seconds{frame_sec} + std::chrono::microseconds{frame_usec}));
         });
 
     add_flip_event(expected_frame_no, frame_sec, frame_usec, crtc_id, handler.drm_event_data());
@@ -168,10 +168,10 @@ TEST_F(ThreadedDRMEventHandlerTest, handles_spurious_drm_events)
 
     auto completion_handle = handler.expect_flip_event(
         crtc_id,
-        [frame_sec, frame_usec](unsigned int frame_no, std::chrono::milliseconds frame_time)
+        [frame_sec, frame_usec](unsigned int frame_no, std::chrono::nanoseconds frame_time)
         {
             EXPECT_THAT(frame_no, Eq(expected_frame_no));
-            EXPECT_THAT(frame_time, Eq(std::chrono::seconds{frame_sec} + std::chrono::milliseconds{frame_usec}));
+            EXPECT_THAT(frame_time, Eq(std::chrono::seconds{frame_sec} + std::chrono::microseconds{frame_usec}));
         });
 
     add_flip_event(23, 10, 10, 5, handler.drm_event_data());
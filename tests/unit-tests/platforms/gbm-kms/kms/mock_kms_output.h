@@ -57,7 +57,20 @@ struct MockKMSOutput : public graphics::gbm::KMSOutput
         return schedule_page_flip_thunk(&fb);
     }
     MOCK_METHOD1(schedule_page_flip_thunk, bool(graphics::gbm::FBHandle const*));
+
+    bool schedule_async_page_flip(graphics::gbm::FBHandle const& fb) override
+    {
+        return schedule_async_page_flip_thunk(&fb);
+    }
+    MOCK_METHOD1(schedule_async_page_flip_thunk, bool(graphics::gbm::FBHandle const*));
     MOCK_METHOD0(wait_for_page_flip, void());
+    MOCK_METHOD1(assign_overlays, bool(std::vector<graphics::gbm::Overlay> const&));
+
+    bool rotate_scanout(graphics::gbm::FBHandle const& fb, uint32_t rotation) override
+    {
+        return rotate_scanout_thunk(&fb, rotation);
+    }
+    MOCK_METHOD2(rotate_scanout_thunk, bool(graphics::gbm::FBHandle const*, uint32_t));
 
     MOCK_CONST_METHOD0(last_frame, graphics::Frame());
 
@@ -75,6 +88,11 @@ struct MockKMSOutput : public graphics::gbm::KMSOutput
     MOCK_CONST_METHOD1(fb_for, std::shared_ptr<graphics::gbm::FBHandle const>(gbm_bo*));
     MOCK_CONST_METHOD1(fb_for, std::shared_ptr<graphics::gbm::FBHandle const>(graphics::DMABufBuffer const&));
     MOCK_CONST_METHOD1(buffer_requires_migration, bool(gbm_bo*));
+    MOCK_METHOD1(scanout_modifiers, std::vector<uint64_t>(uint32_t));
+    MOCK_METHOD1(overlay_modifiers, std::vector<uint64_t>(uint32_t));
+    MOCK_METHOD1(set_adaptive_sync, bool(bool));
+    MOCK_CONST_METHOD0(adaptive_sync, bool());
+    MOCK_METHOD1(set_idle_refresh, bool(bool));
     MOCK_CONST_METHOD0(drm_fd, int());
 };
 
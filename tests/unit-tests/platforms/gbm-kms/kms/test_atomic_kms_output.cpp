@@ -0,0 +1,552 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/platforms/gbm-kms/server/kms/atomic_kms_output.h"
+#include "src/platforms/gbm-kms/server/kms/page_flipper.h"
+
+#include "mir/test/fake_shared.h"
+
+#include "mir/test/doubles/mock_drm.h"
+#include "mir/test/doubles/mock_gbm.h"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <unordered_map>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <fcntl.h>
+#include <drm_fourcc.h>
+
+namespace mg = mir::graphics;
+namespace mgg = mir::graphics::gbm;
+namespace geom = mir::geometry;
+namespace mt = mir::test;
+namespace mtd = mir::test::doubles;
+
+using namespace ::testing;
+
+namespace
+{
+class MockPageFlipper : public mgg::PageFlipper
+{
+public:
+    MOCK_METHOD3(schedule_flip, bool(uint32_t,uint32_t,uint32_t));
+    MOCK_METHOD3(schedule_async_flip, bool(uint32_t,uint32_t,uint32_t));
+    MOCK_METHOD3(schedule_atomic_flip, bool(drmModeAtomicReq*,uint32_t,uint32_t));
+    MOCK_METHOD3(schedule_async_atomic_flip, bool(drmModeAtomicReq*,uint32_t,uint32_t));
+    MOCK_METHOD1(wait_for_flip, mg::Frame(uint32_t));
+    MOCK_METHOD3(schedule_atomic_cursor_update, bool(drmModeAtomicReq*,uint32_t,std::function<void()> const&));
+    MOCK_METHOD1(cancel_cursor_update, void(uint32_t));
+};
+
+/// A device with one CRTC, which has a primary, a cursor and an overlay plane
+class AtomicKMSOutputTest : public ::testing::Test
+{
+public:
+    AtomicKMSOutputTest()
+        : drm_fd{open(drm_device, 0, 0)}
+    {
+        mock_drm.reset(drm_device);
+        mock_drm.add_crtc(drm_device, crtc_id, drmModeModeInfo());
+        mock_drm.add_encoder(drm_device, encoder_id, crtc_id, 0x1);
+        mock_drm.add_connector(
+            drm_device,
+            connector_id,
+            DRM_MODE_CONNECTOR_HDMIA,
+            DRM_MODE_CONNECTED,
+            encoder_id,
+            modes,
+            possible_encoder_ids,
+            geom::Size());
+        mock_drm.prepare(drm_device);
+
+        for (auto i = 0u; i != property_names.size(); ++i)
+        {
+            drmModePropertyRes property;
+            memset(&property, 0, sizeof(property));
+            property.prop_id = first_property_id + i;
+            strncpy(property.name, property_names[i], sizeof(property.name) - 1);
+            properties.push_back(property);
+        }
+        add_object(crtc_id, 0);
+        add_object(connector_id, 0);
+        add_object(primary_plane_id, DRM_PLANE_TYPE_PRIMARY);
+        add_object(cursor_plane_id, DRM_PLANE_TYPE_CURSOR);
+        add_object(overlay_plane_id, DRM_PLANE_TYPE_OVERLAY);
+
+        for (auto plane : {&primary_plane, &cursor_plane, &overlay_plane})
+        {
+            memset(plane, 0, sizeof(*plane));
+            plane->possible_crtcs = 0x1;
+        }
+        primary_plane.plane_id = primary_plane_id;
+        cursor_plane.plane_id = cursor_plane_id;
+        overlay_plane.plane_id = overlay_plane_id;
+        plane_resources.count_planes = plane_ids.size();
+        plane_resources.planes = plane_ids.data();
+
+        ON_CALL(mock_drm, drmModeGetProperty(_, _))
+            .WillByDefault(Invoke(
+                [this](int, uint32_t id) { return &properties.at(id - first_property_id); }));
+        ON_CALL(mock_drm, drmModeObjectGetProperties(_, _, _))
+            .WillByDefault(Invoke(
+                [this](int, uint32_t id, uint32_t) { return &objects.at(id).props; }));
+        ON_CALL(mock_drm, drmModeGetPlaneResources(_))
+            .WillByDefault(Return(&plane_resources));
+        ON_CALL(mock_drm, drmModeGetPlane(_, primary_plane_id))
+            .WillByDefault(Return(&primary_plane));
+        ON_CALL(mock_drm, drmModeGetPlane(_, cursor_plane_id))
+            .WillByDefault(Return(&cursor_plane));
+        ON_CALL(mock_drm, drmModeGetPlane(_, overlay_plane_id))
+            .WillByDefault(Return(&overlay_plane));
+
+        ON_CALL(mock_drm, drmModeAddFB2(_,_,_,_,_,_,_,_,_))
+            .WillByDefault(DoAll(SetArgPointee<7>(fb_id), Return(0)));
+        ON_CALL(mock_page_flipper, wait_for_flip(_))
+            .WillByDefault(Return(mg::Frame{}));
+        ON_CALL(mock_page_flipper, schedule_atomic_flip(_, _, _))
+            .WillByDefault(Return(true));
+        ON_CALL(mock_gbm, gbm_bo_get_handle(_))
+            .WillByDefault(Return(gbm_bo_handle{0}));
+        ON_CALL(mock_gbm, gbm_bo_get_width(_))
+            .WillByDefault(Return(64));
+        ON_CALL(mock_gbm, gbm_bo_get_height(_))
+            .WillByDefault(Return(64));
+    }
+
+    auto property_id(char const* name) const -> uint32_t
+    {
+        for (auto const& property : properties)
+        {
+            if (strcmp(property.name, name) == 0)
+                return property.prop_id;
+        }
+        throw std::logic_error{std::string{"No such property: "} + name};
+    }
+
+    auto make_output() -> std::unique_ptr<mgg::AtomicKMSOutput>
+    {
+        return std::make_unique<mgg::AtomicKMSOutput>(
+            drm_fd,
+            mg::kms::get_connector(drm_fd, connector_id),
+            mt::fake_shared(mock_page_flipper));
+    }
+
+    NiceMock<mtd::MockDRM> mock_drm;
+    NiceMock<mtd::MockGBM> mock_gbm;
+    NiceMock<MockPageFlipper> mock_page_flipper;
+
+    char const* const drm_device = "/dev/dri/card0";
+    int const drm_fd;
+
+    uint32_t const crtc_id{10};
+    uint32_t const encoder_id{20};
+    uint32_t const connector_id{30};
+    uint32_t const primary_plane_id{40};
+    uint32_t const cursor_plane_id{41};
+    uint32_t const overlay_plane_id{42};
+    uint32_t const fb_id{66};
+    uint32_t const in_formats_blob_id{77};
+    gbm_bo* const fake_bo{reinterpret_cast<gbm_bo*>(0x123ba)};
+    gbm_bo* const fake_cursor_bo{reinterpret_cast<gbm_bo*>(0xc0de)};
+
+private:
+    void add_object(uint32_t id, uint64_t type)
+    {
+        auto& object = objects[id];
+        for (auto const& property : properties)
+        {
+            object.ids.push_back(property.prop_id);
+            if (strcmp(property.name, "type") == 0)
+                object.values.push_back(type);
+            else if (strcmp(property.name, "IN_FORMATS") == 0)
+                object.values.push_back(in_formats_blob_id);
+            else if (strcmp(property.name, "vrr_capable") == 0)
+                object.values.push_back(1);
+            else
+                object.values.push_back(0);
+        }
+        memset(&object.props, 0, sizeof(object.props));
+        object.props.count_props = object.ids.size();
+        object.props.props = object.ids.data();
+        object.props.prop_values = object.values.data();
+    }
+
+    struct Object
+    {
+        std::vector<uint32_t> ids;
+        std::vector<uint64_t> values;
+        drmModeObjectProperties props;
+    };
+
+    std::vector<drmModeModeInfo> modes{
+        mtd::FakeDRMResources::create_mode(1920, 1080, 138500, 2080, 1111, mtd::FakeDRMResources::PreferredMode)};
+    std::vector<uint32_t> possible_encoder_ids{encoder_id};
+    std::vector<char const*> const property_names{
+        "type", "FB_ID", "CRTC_ID", "SRC_X", "SRC_Y", "SRC_W", "SRC_H",
+        "CRTC_X", "CRTC_Y", "CRTC_W", "CRTC_H", "MODE_ID", "ACTIVE", "IN_FORMATS",
+        "vrr_capable", "VRR_ENABLED", "rotation"};
+    uint32_t const first_property_id{100};
+    std::vector<drmModePropertyRes> properties;
+    std::unordered_map<uint32_t, Object> objects;
+    std::vector<uint32_t> plane_ids{primary_plane_id, cursor_plane_id, overlay_plane_id};
+    drmModePlaneRes plane_resources{};
+    drmModePlane primary_plane;
+    drmModePlane cursor_plane;
+    drmModePlane overlay_plane;
+};
+}
+
+TEST_F(AtomicKMSOutputTest, set_crtc_tests_the_configuration_before_committing_it)
+{
+    {
+        InSequence s;
+        EXPECT_CALL(mock_drm, drmModeAtomicCommit(_, _, DRM_MODE_ATOMIC_TEST_ONLY | DRM_MODE_ATOMIC_ALLOW_MODESET, _))
+            .WillOnce(Return(0));
+        EXPECT_CALL(mock_drm, drmModeAtomicCommit(_, _, DRM_MODE_ATOMIC_ALLOW_MODESET, _))
+            .WillOnce(Return(0));
+    }
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, _, _, _))
+        .Times(AnyNumber());
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, primary_plane_id, property_id("FB_ID"), fb_id));
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, connector_id, property_id("CRTC_ID"), crtc_id));
+
+    auto const output = make_output();
+    auto const fb = output->fb_for(fake_bo);
+
+    EXPECT_TRUE(output->set_crtc(*fb));
+}
+
+TEST_F(AtomicKMSOutputTest, set_crtc_leaves_the_hardware_alone_if_the_test_commit_fails)
+{
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(_, _, DRM_MODE_ATOMIC_TEST_ONLY | DRM_MODE_ATOMIC_ALLOW_MODESET, _))
+        .WillOnce(Return(-EINVAL));
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(_, _, DRM_MODE_ATOMIC_ALLOW_MODESET, _))
+        .Times(0);
+
+    auto const output = make_output();
+    auto const fb = output->fb_for(fake_bo);
+
+    EXPECT_FALSE(output->set_crtc(*fb));
+}
+
+TEST_F(AtomicKMSOutputTest, page_flips_are_committed_through_the_page_flipper)
+{
+    auto const output = make_output();
+    auto const fb = output->fb_for(fake_bo);
+    ASSERT_TRUE(output->set_crtc(*fb));
+
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, _, _, _))
+        .Times(AnyNumber());
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, primary_plane_id, property_id("FB_ID"), fb_id));
+    EXPECT_CALL(mock_page_flipper, schedule_atomic_flip(_, crtc_id, connector_id))
+        .WillOnce(Return(true));
+    EXPECT_CALL(mock_page_flipper, schedule_flip(_, _, _))
+        .Times(0);
+    EXPECT_CALL(mock_page_flipper, wait_for_flip(crtc_id));
+
+    EXPECT_TRUE(output->schedule_page_flip(*fb));
+    output->wait_for_page_flip();
+}
+
+TEST_F(AtomicKMSOutputTest, cursor_uses_the_cursor_plane_rather_than_legacy_ioctls)
+{
+    EXPECT_CALL(mock_drm, drmModeSetCursor(_, _, _, _, _))
+        .Times(0);
+    EXPECT_CALL(mock_drm, drmModeMoveCursor(_, _, _, _))
+        .Times(0);
+
+    auto const output = make_output();
+    auto const fb = output->fb_for(fake_bo);
+    ASSERT_TRUE(output->set_crtc(*fb));
+
+    std::function<void()> on_vblank;
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, _, _, _))
+        .Times(AnyNumber());
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, cursor_plane_id, property_id("CRTC_X"), 5))
+        .Times(AtLeast(1));
+    EXPECT_CALL(mock_page_flipper, schedule_atomic_cursor_update(_, crtc_id, _))
+        .Times(2)
+        .WillRepeatedly(DoAll(SaveArg<2>(&on_vblank), Return(true)));
+
+    EXPECT_TRUE(output->set_cursor(fake_cursor_bo));
+    on_vblank();
+    output->move_cursor({5, 7});
+    EXPECT_TRUE(output->has_cursor());
+}
+
+TEST_F(AtomicKMSOutputTest, cursor_moves_before_the_vblank_coalesce_into_one_update)
+{
+    auto const output = make_output();
+    auto const fb = output->fb_for(fake_bo);
+    ASSERT_TRUE(output->set_crtc(*fb));
+
+    std::function<void()> on_vblank;
+    EXPECT_CALL(mock_page_flipper, schedule_atomic_cursor_update(_, crtc_id, _))
+        .WillOnce(DoAll(SaveArg<2>(&on_vblank), Return(true)));
+    ASSERT_TRUE(output->set_cursor(fake_cursor_bo));
+    Mock::VerifyAndClearExpectations(&mock_page_flipper);
+
+    EXPECT_CALL(mock_page_flipper, schedule_atomic_cursor_update(_, _, _))
+        .Times(0);
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(_, _, _, _))
+        .Times(0);
+    for (int x = 0; x != 100; ++x)
+        output->move_cursor({x, 7});
+    Mock::VerifyAndClearExpectations(&mock_page_flipper);
+    Mock::VerifyAndClearExpectations(&mock_drm);
+
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, _, _, _))
+        .Times(AnyNumber());
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, cursor_plane_id, property_id("CRTC_X"), 99));
+    EXPECT_CALL(mock_page_flipper, schedule_atomic_cursor_update(_, crtc_id, _))
+        .WillOnce(Return(true));
+    on_vblank();
+}
+
+TEST_F(AtomicKMSOutputTest, cursor_changes_during_a_page_flip_wait_for_it_to_complete)
+{
+    auto const output = make_output();
+    auto const fb = output->fb_for(fake_bo);
+    ASSERT_TRUE(output->set_crtc(*fb));
+    ASSERT_TRUE(output->set_cursor(fake_cursor_bo));
+    ASSERT_TRUE(output->schedule_page_flip(*fb));
+
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(_, _, _, _))
+        .Times(0);
+    EXPECT_CALL(mock_page_flipper, schedule_atomic_cursor_update(_, _, _))
+        .Times(0);
+    output->move_cursor({100, 200});
+    Mock::VerifyAndClearExpectations(&mock_drm);
+    Mock::VerifyAndClearExpectations(&mock_page_flipper);
+
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, _, _, _))
+        .Times(AnyNumber());
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, cursor_plane_id, property_id("CRTC_Y"), 200));
+    EXPECT_CALL(mock_page_flipper, schedule_atomic_cursor_update(_, crtc_id, _))
+        .WillOnce(Return(true));
+    output->wait_for_page_flip();
+}
+
+TEST_F(AtomicKMSOutputTest, destroying_the_output_cancels_its_cursor_update_in_flight)
+{
+    auto output = make_output();
+    auto const fb = output->fb_for(fake_bo);
+    ASSERT_TRUE(output->set_crtc(*fb));
+
+    EXPECT_CALL(mock_page_flipper, schedule_atomic_cursor_update(_, crtc_id, _))
+        .WillOnce(Return(true));
+    ASSERT_TRUE(output->set_cursor(fake_cursor_bo));
+
+    EXPECT_CALL(mock_page_flipper, cancel_cursor_update(crtc_id));
+    output.reset();
+}
+
+TEST_F(AtomicKMSOutputTest, overlays_are_tested_then_shown_with_the_next_page_flip)
+{
+    auto const output = make_output();
+    auto const fb = output->fb_for(fake_bo);
+    ASSERT_TRUE(output->set_crtc(*fb));
+
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, _, _, _))
+        .Times(AnyNumber());
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, overlay_plane_id, property_id("FB_ID"), fb_id))
+        .Times(2);
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, overlay_plane_id, property_id("CRTC_X"), 10))
+        .Times(2);
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(_, _, DRM_MODE_ATOMIC_TEST_ONLY, _))
+        .WillOnce(Return(0));
+    EXPECT_CALL(mock_page_flipper, schedule_atomic_flip(_, crtc_id, connector_id))
+        .WillOnce(Return(true));
+
+    EXPECT_TRUE(output->assign_overlays({{fb, {{}, {64, 64}}, {{10, 20}, {64, 64}}}}));
+    EXPECT_TRUE(output->schedule_page_flip(*fb));
+}
+
+TEST_F(AtomicKMSOutputTest, overlays_the_hardware_rejects_are_not_shown)
+{
+    auto const output = make_output();
+    auto const fb = output->fb_for(fake_bo);
+    ASSERT_TRUE(output->set_crtc(*fb));
+
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, _, _, _))
+        .Times(AnyNumber());
+    // Only in the test commit
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, overlay_plane_id, property_id("FB_ID"), fb_id))
+        .Times(1);
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(_, _, DRM_MODE_ATOMIC_TEST_ONLY, _))
+        .WillOnce(Return(-EINVAL));
+
+    EXPECT_FALSE(output->assign_overlays({{fb, {{}, {64, 64}}, {{10, 20}, {128, 128}}}}));
+    EXPECT_TRUE(output->schedule_page_flip(*fb));
+}
+
+TEST_F(AtomicKMSOutputTest, refuses_more_overlays_than_it_has_planes)
+{
+    auto const output = make_output();
+    auto const fb = output->fb_for(fake_bo);
+    ASSERT_TRUE(output->set_crtc(*fb));
+
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(_, _, _, _))
+        .Times(0);
+
+    EXPECT_FALSE(output->assign_overlays({
+        {fb, {{}, {64, 64}}, {{10, 20}, {64, 64}}},
+        {fb, {{}, {64, 64}}, {{100, 20}, {64, 64}}}}));
+    EXPECT_TRUE(output->assign_overlays({}));
+}
+
+TEST_F(AtomicKMSOutputTest, scanout_rotation_is_tested_then_shown_with_the_next_page_flip)
+{
+    auto const output = make_output();
+    auto const fb = output->fb_for(fake_bo);
+    ASSERT_TRUE(output->set_crtc(*fb));
+
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, _, _, _))
+        .Times(AnyNumber());
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, primary_plane_id, property_id("rotation"), DRM_MODE_ROTATE_90))
+        .Times(2);
+    // The 1920x1080 mode scans out a 1080x1920 buffer
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, primary_plane_id, property_id("SRC_W"), uint64_t{1080} << 16))
+        .Times(2);
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(_, _, DRM_MODE_ATOMIC_TEST_ONLY, _))
+        .WillOnce(Return(0));
+
+    EXPECT_TRUE(output->rotate_scanout(*fb, DRM_MODE_ROTATE_90));
+    EXPECT_TRUE(output->schedule_page_flip(*fb));
+}
+
+TEST_F(AtomicKMSOutputTest, scanout_rotation_the_hardware_rejects_is_not_shown)
+{
+    auto const output = make_output();
+    auto const fb = output->fb_for(fake_bo);
+    ASSERT_TRUE(output->set_crtc(*fb));
+
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, _, _, _))
+        .Times(AnyNumber());
+    // Only in the test commit
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, primary_plane_id, property_id("rotation"), DRM_MODE_ROTATE_90))
+        .Times(1);
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(_, _, DRM_MODE_ATOMIC_TEST_ONLY, _))
+        .WillOnce(Return(-EINVAL));
+
+    EXPECT_FALSE(output->rotate_scanout(*fb, DRM_MODE_ROTATE_90));
+    EXPECT_TRUE(output->schedule_page_flip(*fb));
+}
+
+TEST_F(AtomicKMSOutputTest, scanout_modifiers_are_those_the_primary_plane_accepts_for_the_format)
+{
+    // An IN_FORMATS blob: the formats, then each modifier with a bitmask of the formats it applies to
+    struct
+    {
+        drm_format_modifier_blob header;
+        uint32_t formats[2];
+        drm_format_modifier modifiers[3];
+    } in_formats;
+    memset(&in_formats, 0, sizeof(in_formats));
+    in_formats.header.version = FORMAT_BLOB_CURRENT;
+    in_formats.header.count_formats = 2;
+    in_formats.header.formats_offset = offsetof(decltype(in_formats), formats);
+    in_formats.header.count_modifiers = 3;
+    in_formats.header.modifiers_offset = offsetof(decltype(in_formats), modifiers);
+    in_formats.formats[0] = DRM_FORMAT_ARGB8888;
+    in_formats.formats[1] = DRM_FORMAT_XRGB8888;
+    in_formats.modifiers[0] = {0b11, 0, 0, DRM_FORMAT_MOD_LINEAR};
+    in_formats.modifiers[1] = {0b01, 0, 0, I915_FORMAT_MOD_X_TILED};
+    in_formats.modifiers[2] = {0b10, 0, 0, I915_FORMAT_MOD_Y_TILED_CCS};
+
+    drmModePropertyBlobRes blob;
+    blob.id = in_formats_blob_id;
+    blob.length = sizeof(in_formats);
+    blob.data = &in_formats;
+    ON_CALL(mock_drm, drmModeGetPropertyBlob(_, in_formats_blob_id))
+        .WillByDefault(Return(&blob));
+
+    auto const output = make_output();
+    auto const fb = output->fb_for(fake_bo);
+    ASSERT_TRUE(output->set_crtc(*fb));
+
+    EXPECT_THAT(
+        output->scanout_modifiers(DRM_FORMAT_XRGB8888),
+        ElementsAre(DRM_FORMAT_MOD_LINEAR, I915_FORMAT_MOD_Y_TILED_CCS));
+    EXPECT_THAT(output->scanout_modifiers(DRM_FORMAT_RGB565), IsEmpty());
+}
+
+TEST_F(AtomicKMSOutputTest, overlay_modifiers_are_those_the_overlay_planes_accept_for_the_format)
+{
+    struct
+    {
+        drm_format_modifier_blob header;
+        uint32_t formats[1];
+        drm_format_modifier modifiers[2];
+    } in_formats;
+    memset(&in_formats, 0, sizeof(in_formats));
+    in_formats.header.version = FORMAT_BLOB_CURRENT;
+    in_formats.header.count_formats = 1;
+    in_formats.header.formats_offset = offsetof(decltype(in_formats), formats);
+    in_formats.header.count_modifiers = 2;
+    in_formats.header.modifiers_offset = offsetof(decltype(in_formats), modifiers);
+    in_formats.formats[0] = DRM_FORMAT_ARGB8888;
+    in_formats.modifiers[0] = {0b1, 0, 0, DRM_FORMAT_MOD_LINEAR};
+    in_formats.modifiers[1] = {0b1, 0, 0, I915_FORMAT_MOD_X_TILED};
+
+    drmModePropertyBlobRes blob;
+    blob.id = in_formats_blob_id;
+    blob.length = sizeof(in_formats);
+    blob.data = &in_formats;
+    ON_CALL(mock_drm, drmModeGetPropertyBlob(_, in_formats_blob_id))
+        .WillByDefault(Return(&blob));
+
+    auto const output = make_output();
+    auto const fb = output->fb_for(fake_bo);
+    ASSERT_TRUE(output->set_crtc(*fb));
+
+    // Nothing is on the overlay planes yet, and clients need the modifiers to put something there
+    EXPECT_THAT(
+        output->overlay_modifiers(DRM_FORMAT_ARGB8888),
+        ElementsAre(DRM_FORMAT_MOD_LINEAR, I915_FORMAT_MOD_X_TILED));
+    EXPECT_THAT(output->overlay_modifiers(DRM_FORMAT_XRGB8888), IsEmpty());
+}
+
+TEST_F(AtomicKMSOutputTest, asking_for_modifiers_leaves_an_unconfigured_output_alone)
+{
+    auto const output = make_output();
+
+    // The CRTC belongs to the compositor thread; the Wayland thread asking mustn't choose one
+    EXPECT_CALL(mock_drm, drmModeGetResources(_)).Times(0);
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(_, _, _, _)).Times(0);
+
+    EXPECT_THAT(output->scanout_modifiers(DRM_FORMAT_XRGB8888), IsEmpty());
+    EXPECT_THAT(output->overlay_modifiers(DRM_FORMAT_ARGB8888), IsEmpty());
+}
+
+TEST_F(AtomicKMSOutputTest, adaptive_sync_is_enabled_on_the_crtc_with_the_next_page_flip)
+{
+    auto const output = make_output();
+    auto const fb = output->fb_for(fake_bo);
+    ASSERT_TRUE(output->set_crtc(*fb));
+
+    EXPECT_TRUE(output->set_adaptive_sync(true));
+    EXPECT_TRUE(output->adaptive_sync());
+
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, _, _, _))
+        .Times(AnyNumber());
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, crtc_id, property_id("VRR_ENABLED"), 1));
+
+    EXPECT_TRUE(output->schedule_page_flip(*fb));
+}
@@ -83,7 +83,11 @@ protected:
                 mir::report::null_display_report(),
                 std::make_shared<mtd::StubConsoleServices>(),
                 *std::make_shared<mtd::NullEmergencyCleanup>(),
-                mgg::BypassOption::allowed);
+                mgg::BypassOption::allowed,
+                std::chrono::milliseconds{3},
+                mgg::FramePipelining::disabled,
+                mgg::AdaptiveSync::disabled,
+                std::chrono::milliseconds{0});
         display = platform->create_display(
             std::make_shared<mtd::NullDisplayConfigurationPolicy>(),
             std::make_shared<mtd::NullGLConfig>());
@@ -801,3 +801,25 @@ TEST_F(MesaCursorTest, show_cursor_sets_cursor_with_hotspot)
     cursor.move_to(cursor_location_2);
 }
 
+TEST_F(MesaCursorTest, reshowing_an_image_does_not_rewrite_the_bo)
+{
+    using namespace testing;
+
+    EXPECT_CALL(mock_gbm, gbm_bo_write(_, _, _)).Times(1);
+
+    cursor.show(stub_image);
+    cursor.show(StubCursorImage{});
+}
+
+TEST_F(MesaCursorTest, cycling_through_frames_writes_each_frame_once)
+{
+    using namespace testing;
+
+    EXPECT_CALL(mock_gbm, gbm_bo_write(_, _, _)).Times(2);
+
+    for (auto i = 0; i != 3; ++i)
+    {
+        cursor.show(stub_image);
+        cursor.show(SinglePixelCursorImage{});
+    }
+}
@@ -121,7 +121,11 @@ public:
                mir::report::null_display_report(),
                std::make_shared<mtd::StubConsoleServices>(),
                *std::make_shared<mtd::NullEmergencyCleanup>(),
-               mgg::BypassOption::allowed);
+               mgg::BypassOption::allowed,
+               std::chrono::milliseconds{3},
+               mgg::FramePipelining::disabled,
+               mgg::AdaptiveSync::disabled,
+               std::chrono::milliseconds{0});
     }
 
     std::shared_ptr<mgg::Display> create_display(
@@ -132,6 +136,10 @@ public:
             platform->gbm,
             platform->vt,
             platform->bypass_option(),
+            platform->frame_deadline_margin(),
+            platform->frame_pipelining(),
+            platform->adaptive_sync(),
+            platform->idle_refresh_timeout(),
             std::make_shared<mg::CloneDisplayConfigurationPolicy>(),
             std::make_shared<mtd::StubGLConfig>(),
             null_report);
@@ -542,6 +550,41 @@ TEST_F(MesaDisplayTest, post_update)
     });
 }
 
+TEST_F(MesaDisplayTest, post_polls_the_render_fence_without_waiting_on_it)
+{
+    using namespace testing;
+
+    auto const fake_fence = reinterpret_cast<EGLSyncKHR>(0x5ec);
+    ON_CALL(mock_egl, eglQueryString(_, EGL_EXTENSIONS))
+        .WillByDefault(Return("EGL_KHR_fence_sync EGL_EXT_platform_base"));
+    ON_CALL(mock_egl, eglCreateSyncKHR(_, EGL_SYNC_FENCE_KHR, _))
+        .WillByDefault(Return(fake_fence));
+
+    void* user_data{nullptr};
+    setup_post_update_expectations();
+    EXPECT_CALL(mock_drm, drmModePageFlip(drm_fd, _, _, _, _))
+        .WillOnce(DoAll(QueuePageFlipEvent(std::ref(mock_drm)), SaveArg<4>(&user_data), Return(0)));
+    EXPECT_CALL(mock_drm, drmHandleEvent(drm_fd, _))
+        .WillOnce(DoAll(InvokePageFlipHandler(&user_data), Return(0)));
+
+    EXPECT_CALL(mock_egl, eglClientWaitSyncKHR(_, fake_fence, _, Ne(0)))
+        .Times(0);
+    EXPECT_CALL(mock_egl, eglClientWaitSyncKHR(_, fake_fence, EGL_SYNC_FLUSH_COMMANDS_BIT_KHR, 0))
+        .Times(AtLeast(1))
+        .WillRepeatedly(Return(EGL_TIMEOUT_EXPIRED_KHR));
+
+    auto display = create_display(create_platform());
+
+    display->for_each_display_sync_group([](mg::DisplaySyncGroup& group) {
+        group.for_each_display_buffer([](mg::DisplayBuffer& db) {
+            auto const target = mt::as_render_target(db);
+            target->make_current();
+            target->swap_buffers();
+        });
+        group.post();
+    });
+}
+
 TEST_F(MesaDisplayTest, post_update_flip_failure)
 {
     mir::FatalErrorStrategy on_error{mir::fatal_error_except};
@@ -635,6 +678,10 @@ TEST_F(MesaDisplayTest, successful_creation_of_display_reports_successful_setup_
                         platform->gbm,
                         platform->vt,
                         platform->bypass_option(),
+                        platform->frame_deadline_margin(),
+                        platform->frame_pipelining(),
+                        platform->adaptive_sync(),
+                        platform->idle_refresh_timeout(),
                         std::make_shared<mg::CloneDisplayConfigurationPolicy>(),
                         std::make_shared<mtd::StubGLConfig>(),
                         mock_report);
@@ -737,19 +784,19 @@ TEST_F(MesaDisplayTest, for_each_display_buffer_calls_callback)
     EXPECT_NE(0, callback_count);
 }
 
-TEST_F(MesaDisplayTest, configuration_change_registers_video_devices_handler)
+TEST_F(MesaDisplayTest, configuration_change_registers_video_devices_and_hotplug_timer_handlers)
 {
     using namespace testing;
 
     auto display = create_display(create_platform());
     mtd::MockEventHandlerRegister mock_register;
 
-    EXPECT_CALL(mock_register, register_fd_handler_module_ptr(_,_,_));
+    EXPECT_CALL(mock_register, register_fd_handler_module_ptr(_,_,_)).Times(2);
 
     display->register_configuration_change_handler(mock_register, []{});
 }
 
-TEST_F(MesaDisplayTest, drm_device_change_event_triggers_handler)
+TEST_F(MesaDisplayTest, burst_of_drm_device_change_events_triggers_handler_once)
 {
     using namespace testing;
     using namespace std::chrono_literals;
@@ -759,19 +806,15 @@ TEST_F(MesaDisplayTest, drm_device_change_event_triggers_handler)
     mir::GLibMainLoop ml{std::make_shared<mir::time::SteadyClock>()};
     mir::test::Signal done;
 
-    int const device_add_count{1};
     int const device_change_count{10};
-    int const expected_call_count{device_add_count + device_change_count};
     std::atomic<int> call_count{0};
 
     display->register_configuration_change_handler(
         ml,
         [&call_count, &done]()
         {
-            if (++call_count == expected_call_count)
-            {
-                done.raise();
-            }
+            ++call_count;
+            done.raise();
         });
 
 
@@ -801,8 +844,11 @@ TEST_F(MesaDisplayTest, drm_device_change_event_triggers_handler)
         fake_devices.emit_device_changed(syspath);
     }
 
-    done.wait_for(20s);
-    EXPECT_EQ(expected_call_count, call_count);
+    EXPECT_TRUE(done.wait_for(20s));
+
+    // Give a straggling reconfiguration every chance to show up
+    std::this_thread::sleep_for(500ms);
+    EXPECT_EQ(1, call_count);
 }
 
 TEST_F(MesaDisplayTest, respects_gl_config)
@@ -846,6 +892,10 @@ TEST_F(MesaDisplayTest, respects_gl_config)
         platform->gbm,
         platform->vt,
         platform->bypass_option(),
+        platform->frame_deadline_margin(),
+        platform->frame_pipelining(),
+        platform->adaptive_sync(),
+        platform->idle_refresh_timeout(),
         std::make_shared<mg::CloneDisplayConfigurationPolicy>(),
         mir::test::fake_shared(mock_gl_config),
         null_report};
@@ -883,6 +933,10 @@ TEST_F(MesaDisplayTest, DISABLED_supports_as_low_as_15bit_colour)
         platform->gbm,
         platform->vt,
         platform->bypass_option(),
+        platform->frame_deadline_margin(),
+        platform->frame_pipelining(),
+        platform->adaptive_sync(),
+        platform->idle_refresh_timeout(),
         std::make_shared<mg::CloneDisplayConfigurationPolicy>(),
         mir::test::fake_shared(stub_gl_config),
         null_report};
@@ -39,6 +39,8 @@
 #include <gmock/gmock.h>
 #include <gbm.h>
 
+#include <algorithm>
+
 using namespace testing;
 using namespace mir;
 using namespace std;
@@ -131,13 +133,18 @@ public:
 
 protected:
     GBMOutputSurface make_output_surface()
+    {
+        return make_output_surface(width, height);
+    }
+
+    GBMOutputSurface make_output_surface(int surface_width, int surface_height)
     {
         helpers::EGLHelper egl{gl_config};
         return GBMOutputSurface{
             mir::Fd{} ,
             GBMSurfaceUPtr{nullptr},
-            static_cast<uint32_t>(width),
-            static_cast<uint32_t>(height),
+            static_cast<uint32_t>(surface_width),
+            static_cast<uint32_t>(surface_height),
             std::move(egl)
         };
     }
@@ -160,13 +167,15 @@ protected:
     UdevEnvironment   fake_devices;
     std::shared_ptr<MockKMSOutput> mock_kms_output;
     StubGLConfig gl_config;
-    mir::graphics::RenderableList const bypassable_list;
+    mir::graphics::RenderableList bypassable_list;
 };
 
 TEST_F(MesaDisplayBufferTest, unrotated_view_area_is_untouched)
 {
     graphics::gbm::DisplayBuffer db(
         graphics::gbm::BypassOption::allowed,
+        std::chrono::milliseconds{3},
+        graphics::gbm::FramePipelining::disabled,
         null_display_report(),
         {mock_kms_output},
         make_output_surface(),
@@ -180,6 +189,8 @@ TEST_F(MesaDisplayBufferTest, bypass_buffer_is_held_for_full_frame)
 {
     graphics::gbm::DisplayBuffer db(
         graphics::gbm::BypassOption::allowed,
+        std::chrono::milliseconds{3},
+        graphics::gbm::FramePipelining::disabled,
         null_display_report(),
         {mock_kms_output},
         make_output_surface(),
@@ -204,6 +215,8 @@ TEST_F(MesaDisplayBufferTest, predictive_bypass_is_throttled)
 {
     graphics::gbm::DisplayBuffer db(
         graphics::gbm::BypassOption::allowed,
+        std::chrono::milliseconds{3},
+        graphics::gbm::FramePipelining::disabled,
         null_display_report(),
         {mock_kms_output},
         make_output_surface(),
@@ -230,6 +243,8 @@ TEST_F(MesaDisplayBufferTest, frames_requiring_gl_are_not_throttled)
 
     graphics::gbm::DisplayBuffer db(
         graphics::gbm::BypassOption::allowed,
+        std::chrono::milliseconds{3},
+        graphics::gbm::FramePipelining::disabled,
         null_display_report(),
         {mock_kms_output},
         make_output_surface(),
@@ -250,6 +265,8 @@ TEST_F(MesaDisplayBufferTest, bypass_buffer_only_referenced_once_by_db)
 {
     graphics::gbm::DisplayBuffer db(
         graphics::gbm::BypassOption::allowed,
+        std::chrono::milliseconds{3},
+        graphics::gbm::FramePipelining::disabled,
         null_display_report(),
         {mock_kms_output},
         make_output_surface(),
@@ -271,6 +288,8 @@ TEST_F(MesaDisplayBufferTest, untransformed_with_bypassable_list_can_bypass)
 {
     graphics::gbm::DisplayBuffer db(
         graphics::gbm::BypassOption::allowed,
+        std::chrono::milliseconds{3},
+        graphics::gbm::FramePipelining::disabled,
         null_display_report(),
         {mock_kms_output},
         make_output_surface(),
@@ -299,6 +318,8 @@ TEST_F(MesaDisplayBufferTest, failed_bypass_falls_back_gracefully)
 
     graphics::gbm::DisplayBuffer db(
         graphics::gbm::BypassOption::allowed,
+        std::chrono::milliseconds{3},
+        graphics::gbm::FramePipelining::disabled,
         null_display_report(),
         {mock_kms_output},
         make_output_surface(),
@@ -324,6 +345,8 @@ TEST_F(MesaDisplayBufferTest, skips_bypass_because_of_lagging_resize)
 
     graphics::gbm::DisplayBuffer db(
         graphics::gbm::BypassOption::allowed,
+        std::chrono::milliseconds{3},
+        graphics::gbm::FramePipelining::disabled,
         null_display_report(),
         {mock_kms_output},
         make_output_surface(),
@@ -333,28 +356,80 @@ TEST_F(MesaDisplayBufferTest, skips_bypass_because_of_lagging_resize)
     EXPECT_FALSE(db.overlay(list));
 }
 
-TEST_F(MesaDisplayBufferTest, rotated_cannot_bypass)
+TEST_F(MesaDisplayBufferTest, rotated_cannot_bypass_if_the_hardware_cannot_rotate)
 {
+    ON_CALL(*mock_kms_output, rotate_scanout_thunk(_, Ne(uint32_t{DRM_MODE_ROTATE_0})))
+        .WillByDefault(Return(false));
+
     graphics::gbm::DisplayBuffer db(
         graphics::gbm::BypassOption::allowed,
+        std::chrono::milliseconds{3},
+        graphics::gbm::FramePipelining::disabled,
         null_display_report(),
         {mock_kms_output},
-        make_output_surface(),
+        make_output_surface(height, width),
         display_area,
         transformation(mir_orientation_right));
 
     EXPECT_FALSE(db.overlay(bypassable_list));
 }
 
+TEST_F(MesaDisplayBufferTest, rotated_can_bypass_by_rotating_the_scanout)
+{
+    // Mir's right is the buffer turned clockwise, which KMS calls 270 degrees
+    EXPECT_CALL(*mock_kms_output, rotate_scanout_thunk(_, uint32_t{DRM_MODE_ROTATE_0}))
+        .Times(AnyNumber());
+    EXPECT_CALL(*mock_kms_output, rotate_scanout_thunk(_, uint32_t{DRM_MODE_ROTATE_270}))
+        .WillOnce(Return(true));
+
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        std::chrono::milliseconds{3},
+        graphics::gbm::FramePipelining::disabled,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(height, width),
+        display_area,
+        transformation(mir_orientation_right));
+
+    EXPECT_TRUE(db.overlay(bypassable_list));
+}
+
+TEST_F(MesaDisplayBufferTest, composited_frame_is_scanned_out_unrotated)
+{
+    EXPECT_CALL(*mock_kms_output, rotate_scanout_thunk(_, uint32_t{DRM_MODE_ROTATE_0}))
+        .Times(AtLeast(1));
+
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        std::chrono::milliseconds{3},
+        graphics::gbm::FramePipelining::disabled,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(height, width),
+        display_area,
+        transformation(mir_orientation_right));
+
+    Mock::VerifyAndClearExpectations(mock_kms_output.get());
+    EXPECT_CALL(*mock_kms_output, rotate_scanout_thunk(_, uint32_t{DRM_MODE_ROTATE_0}));
+
+    graphics::RenderableList list{fake_software_renderable};
+    EXPECT_FALSE(db.overlay(list));
+    db.swap_buffers();
+    db.post();
+}
+
 TEST_F(MesaDisplayBufferTest, fullscreen_software_buffer_cannot_bypass)
 {
-    graphics::RenderableList const list{fake_software_renderable};
+    graphics::RenderableList list{fake_software_renderable};
 
     // Passes the bypass candidate test:
     EXPECT_EQ(fake_software_renderable->buffer()->size(), display_area.size);
 
     graphics::gbm::DisplayBuffer db(
         graphics::gbm::BypassOption::allowed,
+        std::chrono::milliseconds{3},
+        graphics::gbm::FramePipelining::disabled,
         null_display_report(),
         {mock_kms_output},
         make_output_surface(),
@@ -366,13 +441,15 @@ TEST_F(MesaDisplayBufferTest, fullscreen_software_buffer_cannot_bypass)
 
 TEST_F(MesaDisplayBufferTest, fullscreen_software_buffer_not_used_as_gbm_bo)
 {   // Also checks it doesn't crash (LP: #1493721)
-    graphics::RenderableList const list{fake_software_renderable};
+    graphics::RenderableList list{fake_software_renderable};
 
     // Passes the bypass candidate test:
     EXPECT_EQ(fake_software_renderable->buffer()->size(), display_area.size);
 
     graphics::gbm::DisplayBuffer db(
         graphics::gbm::BypassOption::allowed,
+        std::chrono::milliseconds{3},
+        graphics::gbm::FramePipelining::disabled,
         null_display_report(),
         {mock_kms_output},
         make_output_surface(),
@@ -391,6 +468,8 @@ TEST_F(MesaDisplayBufferTest, transformation_not_implemented_internally)
 
     graphics::gbm::DisplayBuffer db(
         graphics::gbm::BypassOption::allowed,
+        std::chrono::milliseconds{3},
+        graphics::gbm::FramePipelining::disabled,
         null_display_report(),
         {mock_kms_output},
         make_output_surface(),
@@ -411,6 +490,8 @@ TEST_F(MesaDisplayBufferTest, clone_mode_first_flip_flips_but_no_wait)
 
     graphics::gbm::DisplayBuffer db(
         graphics::gbm::BypassOption::allowed,
+        std::chrono::milliseconds{3},
+        graphics::gbm::FramePipelining::disabled,
         null_display_report(),
         {mock_kms_output, mock_kms_output},
         make_output_surface(),
@@ -421,6 +502,122 @@ TEST_F(MesaDisplayBufferTest, clone_mode_first_flip_flips_but_no_wait)
     db.post();
 }
 
+TEST_F(MesaDisplayBufferTest, bypassed_renderable_allowing_tearing_flips_without_vblank)
+{
+    using namespace testing;
+
+    fake_bypassable_renderable->set_tearing_allowed(true);
+
+    EXPECT_CALL(*mock_kms_output, schedule_async_page_flip_thunk(_))
+        .WillOnce(Return(true));
+    EXPECT_CALL(*mock_kms_output, schedule_page_flip_thunk(_))
+        .Times(0);
+
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        std::chrono::milliseconds{3},
+        graphics::gbm::FramePipelining::disabled,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    ASSERT_TRUE(db.overlay(bypassable_list));
+    db.post();
+
+    EXPECT_THAT(db.recommended_sleep(), Eq(std::chrono::milliseconds{0}));
+}
+
+TEST_F(MesaDisplayBufferTest, tearing_falls_back_on_a_vblank_flip_if_the_output_cant)
+{
+    using namespace testing;
+
+    fake_bypassable_renderable->set_tearing_allowed(true);
+
+    EXPECT_CALL(*mock_kms_output, schedule_async_page_flip_thunk(_))
+        .WillOnce(Return(false));
+    EXPECT_CALL(*mock_kms_output, schedule_page_flip_thunk(_))
+        .Times(1);
+
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        std::chrono::milliseconds{3},
+        graphics::gbm::FramePipelining::disabled,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    ASSERT_TRUE(db.overlay(bypassable_list));
+    db.post();
+}
+
+TEST_F(MesaDisplayBufferTest, idle_output_drops_refresh_until_the_next_post)
+{
+    using namespace testing;
+
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        std::chrono::milliseconds{3},
+        graphics::gbm::FramePipelining::disabled,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    db.swap_buffers();
+    db.post();
+
+    {
+        InSequence seq;
+        EXPECT_CALL(*mock_kms_output, set_idle_refresh(true))
+            .WillOnce(Return(true));
+        EXPECT_CALL(*mock_kms_output, set_crtc_thunk(_))
+            .WillOnce(Return(true));
+        EXPECT_CALL(*mock_kms_output, set_idle_refresh(false))
+            .WillOnce(Return(true));
+        EXPECT_CALL(*mock_kms_output, set_crtc_thunk(_))
+            .WillOnce(Return(true));
+    }
+    EXPECT_CALL(*mock_kms_output, schedule_page_flip_thunk(_))
+        .Times(0);
+
+    db.drop_refresh_if_idle_since(std::chrono::steady_clock::now());
+    // Already idle, so nothing more to do
+    db.drop_refresh_if_idle_since(std::chrono::steady_clock::now());
+
+    db.swap_buffers();
+    db.post();
+}
+
+TEST_F(MesaDisplayBufferTest, recently_posted_output_keeps_its_refresh)
+{
+    using namespace testing;
+
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        std::chrono::milliseconds{3},
+        graphics::gbm::FramePipelining::disabled,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    db.swap_buffers();
+    db.post();
+
+    EXPECT_CALL(*mock_kms_output, set_idle_refresh(_))
+        .Times(0);
+    EXPECT_CALL(*mock_kms_output, set_crtc_thunk(_))
+        .Times(0);
+
+    db.drop_refresh_if_idle_since(std::chrono::steady_clock::now() - std::chrono::hours{1});
+}
+
 TEST_F(MesaDisplayBufferTest, single_mode_first_post_flips_with_wait)
 {
     EXPECT_CALL(*mock_kms_output, schedule_page_flip_thunk(_))
@@ -430,6 +627,35 @@ TEST_F(MesaDisplayBufferTest, single_mode_first_post_flips_with_wait)
 
     graphics::gbm::DisplayBuffer db(
         graphics::gbm::BypassOption::allowed,
+        std::chrono::milliseconds{3},
+        graphics::gbm::FramePipelining::disabled,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    db.swap_buffers();
+    db.post();
+}
+
+TEST_F(MesaDisplayBufferTest, pipelined_post_leaves_the_flip_pending_until_the_next_post)
+{
+    InSequence seq;
+
+    EXPECT_CALL(*mock_kms_output, schedule_page_flip_thunk(_))
+        .Times(1);
+    EXPECT_CALL(*mock_kms_output, wait_for_page_flip())
+        .Times(1);
+    EXPECT_CALL(*mock_kms_output, schedule_page_flip_thunk(_))
+        .Times(1);
+    EXPECT_CALL(*mock_kms_output, wait_for_page_flip())
+        .Times(0);
+
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        std::chrono::milliseconds{3},
+        graphics::gbm::FramePipelining::enabled,
         null_display_report(),
         {mock_kms_output},
         make_output_surface(),
@@ -438,6 +664,9 @@ TEST_F(MesaDisplayBufferTest, single_mode_first_post_flips_with_wait)
 
     db.swap_buffers();
     db.post();
+
+    db.swap_buffers();
+    db.post();
 }
 
 TEST_F(MesaDisplayBufferTest, clone_mode_waits_for_page_flip_on_second_flip)
@@ -457,6 +686,8 @@ TEST_F(MesaDisplayBufferTest, clone_mode_waits_for_page_flip_on_second_flip)
 
     graphics::gbm::DisplayBuffer db(
         graphics::gbm::BypassOption::allowed,
+        std::chrono::milliseconds{3},
+        graphics::gbm::FramePipelining::disabled,
         null_display_report(),
         {mock_kms_output, mock_kms_output},
         make_output_surface(),
@@ -479,6 +710,8 @@ TEST_F(MesaDisplayBufferTest, skips_bypass_because_of_incompatible_list)
 
     graphics::gbm::DisplayBuffer db(
         graphics::gbm::BypassOption::allowed,
+        std::chrono::milliseconds{3},
+        graphics::gbm::FramePipelining::disabled,
         null_display_report(),
         {mock_kms_output},
         make_output_surface(),
@@ -504,6 +737,95 @@ TEST_F(MesaDisplayBufferTest, skips_bypass_because_of_incompatible_bypass_buffer
 
     graphics::gbm::DisplayBuffer db(
         graphics::gbm::BypassOption::allowed,
+        std::chrono::milliseconds{3},
+        graphics::gbm::FramePipelining::disabled,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    EXPECT_FALSE(db.overlay(list));
+}
+
+namespace
+{
+MATCHER_P(OverlaysAt, destinations, "")
+{
+    std::vector<geometry::Rectangle> actual;
+    for (auto const& overlay : arg)
+        actual.push_back(overlay.destination);
+    return actual == destinations;
+}
+}
+
+TEST_F(MesaDisplayBufferTest, composites_only_what_is_not_overlaid)
+{
+    auto const window = std::make_shared<FakeRenderable>(geometry::Rectangle{{32, 44}, {10, 10}});
+    window->set_buffer(mock_bypassable_buffer);
+    graphics::RenderableList list{fake_software_renderable, window};
+
+    // In output coordinates
+    EXPECT_CALL(*mock_kms_output, assign_overlays(_))
+        .Times(AnyNumber());
+    EXPECT_CALL(*mock_kms_output, assign_overlays(OverlaysAt(std::vector<geometry::Rectangle>{{{20, 10}, {10, 10}}})))
+        .WillOnce(Return(true));
+
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        std::chrono::milliseconds{3},
+        graphics::gbm::FramePipelining::disabled,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    EXPECT_FALSE(db.overlay(list));
+    EXPECT_THAT(list, ElementsAre(fake_software_renderable));
+}
+
+TEST_F(MesaDisplayBufferTest, can_bypass_beneath_an_overlay)
+{
+    auto const osd = std::make_shared<FakeRenderable>(geometry::Rectangle{{32, 44}, {10, 10}});
+    auto const osd_buffer = std::make_shared<NiceMock<MockBuffer>>();
+    ON_CALL(*osd_buffer, native_buffer_base())
+        .WillByDefault(Return(&mock_dmabuf_buffer));
+    osd->set_buffer(osd_buffer);
+    graphics::RenderableList list{fake_bypassable_renderable, osd};
+
+    ON_CALL(*mock_kms_output, assign_overlays(_))
+        .WillByDefault(Return(true));
+
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        std::chrono::milliseconds{3},
+        graphics::gbm::FramePipelining::disabled,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    auto const original_count = osd_buffer.use_count();
+
+    EXPECT_TRUE(db.overlay(list));
+    db.post();
+
+    // Held until it's replaced on screen
+    EXPECT_EQ(original_count + 1, osd_buffer.use_count());
+}
+
+TEST_F(MesaDisplayBufferTest, composites_everything_if_the_hardware_cannot_overlay)
+{
+    auto const window = std::make_shared<FakeRenderable>(geometry::Rectangle{{32, 44}, {10, 10}});
+    window->set_buffer(mock_bypassable_buffer);
+    graphics::RenderableList list{fake_software_renderable, window};
+
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        std::chrono::milliseconds{3},
+        graphics::gbm::FramePipelining::disabled,
         null_display_report(),
         {mock_kms_output},
         make_output_surface(),
@@ -511,4 +833,117 @@ TEST_F(MesaDisplayBufferTest, skips_bypass_because_of_incompatible_bypass_buffer
         identity);
 
     EXPECT_FALSE(db.overlay(list));
+    EXPECT_THAT(list, ElementsAre(fake_software_renderable, window));
+}
+
+namespace
+{
+/// A CPU-side stand-in for a linear scanout buffer
+struct FakeScanoutPixels
+{
+    FakeScanoutPixels(int width, int height)
+        : stride{static_cast<uint32_t>(width) * 4},
+          pixels(width * height, 0)
+    {
+    }
+
+    uint32_t const stride;
+    std::vector<uint32_t> pixels;
+};
+
+ACTION_P(MapFakeScanoutPixels, fake)
+{
+    *arg6 = fake->stride;
+    return fake->pixels.data();
+}
+}
+
+TEST_F(MesaDisplayBufferTest, software_frame_is_scanned_out_from_its_own_buffer)
+{
+    auto const software_bo_a = reinterpret_cast<gbm_bo*>(0xa);
+    auto const software_bo_b = reinterpret_cast<gbm_bo*>(0xb);
+    FakeScanoutPixels pixels_a{width, height}, pixels_b{width, height};
+    std::shared_ptr<FBHandle const> const software_fb{reinterpret_cast<FBHandle const*>(0x5f7), [](auto) {}};
+
+    EXPECT_CALL(mock_gbm, gbm_bo_create(_, width, height, GBM_FORMAT_XRGB8888, GBM_BO_USE_SCANOUT | GBM_BO_USE_LINEAR))
+        .WillOnce(Return(software_bo_a))
+        .WillOnce(Return(software_bo_b));
+    ON_CALL(mock_gbm, gbm_bo_map(software_bo_a, _, _, _, _, _, _, _))
+        .WillByDefault(MapFakeScanoutPixels(&pixels_a));
+    ON_CALL(mock_gbm, gbm_bo_map(software_bo_b, _, _, _, _, _, _, _))
+        .WillByDefault(MapFakeScanoutPixels(&pixels_b));
+    ON_CALL(*mock_kms_output, fb_for(software_bo_a))
+        .WillByDefault(Return(software_fb));
+    EXPECT_CALL(*mock_kms_output, schedule_page_flip_thunk(software_fb.get()))
+        .Times(1);
+    EXPECT_CALL(mock_gbm, gbm_bo_destroy(software_bo_a));
+    EXPECT_CALL(mock_gbm, gbm_bo_destroy(software_bo_b));
+
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        std::chrono::milliseconds{3},
+        graphics::gbm::FramePipelining::disabled,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    auto const target = dynamic_cast<renderer::software::RenderTarget*>(db.native_display_buffer());
+    ASSERT_THAT(target, NotNull());
+
+    {
+        auto const framebuffer = target->map_framebuffer();
+        EXPECT_THAT(framebuffer->size(), Eq(geometry::Size{width, height}));
+        EXPECT_THAT(framebuffer->data(), Eq(reinterpret_cast<unsigned char*>(pixels_a.pixels.data())));
+    }
+    target->post(geometry::Rectangles{{{0, 0}, {width, height}}});
+    db.post();
+}
+
+TEST_F(MesaDisplayBufferTest, software_frame_starts_from_the_last_one_posted)
+{
+    auto const software_bo_a = reinterpret_cast<gbm_bo*>(0xa);
+    auto const software_bo_b = reinterpret_cast<gbm_bo*>(0xb);
+    FakeScanoutPixels pixels_a{width, height}, pixels_b{width, height};
+    geometry::Rectangle const damage{{3, 4}, {5, 6}};
+    uint32_t const drawn{0xff123456};
+
+    EXPECT_CALL(mock_gbm, gbm_bo_create(_, _, _, _, _))
+        .WillOnce(Return(software_bo_a))
+        .WillOnce(Return(software_bo_b));
+    ON_CALL(mock_gbm, gbm_bo_map(software_bo_a, _, _, _, _, _, _, _))
+        .WillByDefault(MapFakeScanoutPixels(&pixels_a));
+    ON_CALL(mock_gbm, gbm_bo_map(software_bo_b, _, _, _, _, _, _, _))
+        .WillByDefault(MapFakeScanoutPixels(&pixels_b));
+
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        std::chrono::milliseconds{3},
+        graphics::gbm::FramePipelining::disabled,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    auto const target = dynamic_cast<renderer::software::RenderTarget*>(db.native_display_buffer());
+    ASSERT_THAT(target, NotNull());
+
+    {
+        auto const framebuffer = target->map_framebuffer();
+        for (auto y = damage.top().as_int(); y < damage.bottom().as_int(); ++y)
+            for (auto x = damage.left().as_int(); x < damage.right().as_int(); ++x)
+                pixels_a.pixels[y * width + x] = drawn;
+    }
+    target->post(geometry::Rectangles{damage});
+    db.post();
+
+    // Only the damage is copied into the other buffer
+    target->map_framebuffer();
+    EXPECT_THAT(pixels_b.pixels[damage.top().as_int() * width + damage.left().as_int()], Eq(drawn));
+    EXPECT_THAT(pixels_b.pixels[(damage.bottom().as_int() - 1) * width + damage.right().as_int() - 1], Eq(drawn));
+    EXPECT_THAT(
+        std::count(pixels_b.pixels.begin(), pixels_b.pixels.end(), drawn),
+        Eq(damage.size.width.as_int() * damage.size.height.as_int()));
 }
@@ -80,7 +80,11 @@ public:
                 mir::report::null_display_report(),
                 std::make_shared<mtd::StubConsoleServices>(),
                 *std::make_shared<mtd::NullEmergencyCleanup>(),
-                mgg::BypassOption::allowed);
+                mgg::BypassOption::allowed,
+                std::chrono::milliseconds{3},
+                mgg::FramePipelining::disabled,
+                mgg::AdaptiveSync::disabled,
+                std::chrono::milliseconds{0});
         return platform->create_display(
             std::make_shared<mg::CloneDisplayConfigurationPolicy>(),
             std::make_shared<mtd::StubGLConfig>());
@@ -152,7 +152,11 @@ public:
                mir::report::null_display_report(),
                std::make_shared<mtd::StubConsoleServices>(),
                *std::make_shared<mtd::NullEmergencyCleanup>(),
-               mgg::BypassOption::allowed);
+               mgg::BypassOption::allowed,
+               std::chrono::milliseconds{3},
+               mgg::FramePipelining::disabled,
+               mgg::AdaptiveSync::disabled,
+               std::chrono::milliseconds{0});
     }
 
     std::shared_ptr<mg::Display> create_display_cloned(
@@ -375,13 +379,14 @@ TEST_F(MesaDisplayMultiMonitorTest, flip_flips_all_connected_crtcs)
                                               crtc_ids[i], fb_id,
                                               _, _))
             .Times(2)
-            .WillRepeatedly(DoAll(SaveArg<4>(&user_data[i]), Return(0)));
-
-        /* Emit fake DRM page-flip events */
-        mock_drm.generate_event_on(drm_device);
+            /* Emit a fake DRM page-flip event for the first flip only */
+            .WillOnce(DoAll(SaveArg<4>(&user_data[i]),
+                            InvokeWithoutArgs([&]() { mock_drm.generate_event_on(drm_device); }),
+                            Return(0)))
+            .WillOnce(DoAll(SaveArg<4>(&user_data[i]), Return(0)));
     }
 
-    /* Handle the events properly */
+    /* Handle the events properly, as they arrive */
     EXPECT_CALL(mock_drm, drmHandleEvent(mtd::IsFdOfDevice(drm_device), _))
         .Times(num_connected_outputs)
         .WillOnce(DoAll(InvokePageFlipHandler(&user_data[0]), Return(0)))
@@ -594,3 +599,92 @@ TEST_F(MesaDisplayMultiMonitorTest, resume_clears_unused_connected_outputs)
                         .Times(1);
     }
 }
+
+TEST_F(MesaDisplayMultiMonitorTest, configure_incrementally_keeps_the_groups_of_unchanged_outputs)
+{
+    using namespace testing;
+
+    int const num_connected_outputs{2};
+    int const num_disconnected_outputs{0};
+
+    setup_outputs(num_connected_outputs, num_disconnected_outputs);
+
+    auto display = create_display_side_by_side(create_platform());
+
+    std::vector<mg::DisplaySyncGroup*> groups_before;
+    display->for_each_display_sync_group([&](mg::DisplaySyncGroup& group) { groups_before.push_back(&group); });
+    ASSERT_THAT(groups_before.size(), Eq(2u));
+
+    Mock::VerifyAndClearExpectations(&mock_drm);
+
+    /* Only the changed output is modeset */
+    EXPECT_CALL(mock_drm, drmModeSetCrtc(mtd::IsFdOfDevice(drm_device), crtc_ids[0], _, _, _, _, _, _))
+        .Times(AtLeast(1));
+    EXPECT_CALL(mock_drm, drmModeSetCrtc(mtd::IsFdOfDevice(drm_device), crtc_ids[1], _, _, _, _, _, _))
+        .Times(0);
+
+    /* Change the mode of the first output, keeping it clear of the second */
+    auto conf = display->configuration();
+    bool first{true};
+    conf->for_each_output(
+        [&](mg::UserDisplayConfigurationOutput& output)
+        {
+            if (first)
+                output.current_mode_index = 2;
+            first = false;
+        });
+
+    std::vector<mg::DisplaySyncGroup*> released;
+    display->configure_incrementally(
+        *conf,
+        [&](mg::DisplaySyncGroup& group) { released.push_back(&group); });
+
+    Mock::VerifyAndClearExpectations(&mock_drm);
+
+    std::vector<mg::DisplaySyncGroup*> groups_after;
+    display->for_each_display_sync_group([&](mg::DisplaySyncGroup& group) { groups_after.push_back(&group); });
+
+    ASSERT_THAT(released.size(), Eq(1u));
+    EXPECT_THAT(groups_after.size(), Eq(2u));
+    EXPECT_THAT(groups_after, Not(Contains(released.front())));
+
+    auto const kept = std::find_if(groups_before.begin(), groups_before.end(),
+        [&](auto group) { return group != released.front(); });
+    EXPECT_THAT(groups_after, Contains(*kept));
+}
+
+TEST_F(MesaDisplayMultiMonitorTest, configure_incrementally_with_every_output_changed_releases_every_group)
+{
+    using namespace testing;
+
+    int const num_connected_outputs{2};
+    int const num_disconnected_outputs{0};
+
+    setup_outputs(num_connected_outputs, num_disconnected_outputs);
+
+    auto display = create_display_side_by_side(create_platform());
+
+    std::vector<mg::DisplaySyncGroup*> groups_before;
+    display->for_each_display_sync_group([&](mg::DisplaySyncGroup& group) { groups_before.push_back(&group); });
+
+    auto conf = display->configuration();
+    int x{0};
+    conf->for_each_output(
+        [&](mg::UserDisplayConfigurationOutput& output)
+        {
+            output.current_mode_index = 3;
+            output.top_left = geom::Point{x, 0};
+            x += output.modes[3].size.width.as_int();
+        });
+
+    std::vector<mg::DisplaySyncGroup*> released;
+    display->configure_incrementally(
+        *conf,
+        [&](mg::DisplaySyncGroup& group) { released.push_back(&group); });
+
+    EXPECT_THAT(released, UnorderedElementsAreArray(groups_before));
+
+    int groups_after{0};
+    display->for_each_display_sync_group([&](mg::DisplaySyncGroup&) { ++groups_after; });
+    EXPECT_THAT(groups_after, Eq(2));
+}
@@ -0,0 +1,156 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/platforms/common/server/frame_scheduler.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace mg = mir::graphics;
+namespace mgc = mir::graphics::common;
+
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+struct FrameScheduler : Test
+{
+    static auto at(std::chrono::nanoseconds t) -> mir::time::PosixTimestamp
+    {
+        return {CLOCK_MONOTONIC, t};
+    }
+
+    static auto output(
+        std::chrono::nanoseconds last_vblank,
+        std::chrono::nanoseconds interval,
+        bool adaptive_sync = false) -> mgc::FrameScheduler::OutputTiming
+    {
+        mg::Frame frame;
+        frame.msc = 1;
+        frame.ust = at(last_vblank);
+        return {frame, interval, adaptive_sync};
+    }
+
+    std::chrono::nanoseconds const interval{16ms};
+    mgc::FrameScheduler scheduler{2ms};
+};
+}
+
+TEST_F(FrameScheduler, composites_immediately_until_render_time_is_known)
+{
+    auto const delay = scheduler.delay_before_next_frame(at(1s), {output(1s, interval)}, false, true);
+
+    EXPECT_THAT(delay, Eq(0ms));
+}
+
+TEST_F(FrameScheduler, starts_rendering_in_time_for_the_next_vblank)
+{
+    scheduler.record_render_time(5ms);
+
+    auto const delay = scheduler.delay_before_next_frame(at(1s + 1ms), {output(1s, interval)}, false, true);
+
+    // Next vblank at 1s + 16ms, less 5ms rendering and 2ms margin
+    EXPECT_THAT(delay, Eq(8ms));
+}
+
+TEST_F(FrameScheduler, extrapolates_vblanks_from_an_old_frame)
+{
+    scheduler.record_render_time(5ms);
+
+    auto const delay = scheduler.delay_before_next_frame(at(1s + 33ms), {output(1s, interval)}, false, true);
+
+    // Next vblank at 1s + 48ms
+    EXPECT_THAT(delay, Eq(8ms));
+}
+
+TEST_F(FrameScheduler, waits_for_the_vblank_after_a_pending_flip)
+{
+    scheduler.record_render_time(5ms);
+
+    auto const delay = scheduler.delay_before_next_frame(at(1s + 1ms), {output(1s, interval)}, true, true);
+
+    EXPECT_THAT(delay, Eq(24ms));
+}
+
+TEST_F(FrameScheduler, plans_for_the_slowest_recent_frame)
+{
+    scheduler.record_render_time(10ms);
+    scheduler.record_render_time(1ms);
+
+    auto const delay = scheduler.delay_before_next_frame(at(1s), {output(1s, interval)}, false, true);
+
+    EXPECT_THAT(delay, Eq(4ms));
+}
+
+TEST_F(FrameScheduler, bypassed_frames_need_no_render_time)
+{
+    scheduler.record_render_time(10ms);
+
+    auto const delay = scheduler.delay_before_next_frame(at(1s), {output(1s, interval)}, false, false);
+
+    EXPECT_THAT(delay, Eq(14ms));
+}
+
+TEST_F(FrameScheduler, meets_the_earliest_vblank_of_several_outputs)
+{
+    scheduler.record_render_time(5ms);
+
+    auto const delay = scheduler.delay_before_next_frame(
+        at(1s),
+        {output(1s - 2ms, interval), output(1s - 10ms, interval)},
+        false,
+        true);
+
+    // The second output's next vblank is at 1s + 6ms, so we're already late for it
+    EXPECT_THAT(delay, Eq(0ms));
+}
+
+TEST_F(FrameScheduler, assumes_a_vblank_just_happened_without_timestamps)
+{
+    auto const delay = scheduler.delay_before_next_frame(at(1s), {{mg::Frame{}, interval, false}}, false, false);
+
+    EXPECT_THAT(delay, Eq(14ms));
+}
+
+TEST_F(FrameScheduler, bypassed_frames_are_shown_as_soon_as_ready_with_adaptive_sync)
+{
+    scheduler.record_render_time(5ms);
+
+    auto const delay = scheduler.delay_before_next_frame(at(1s + 1ms), {output(1s, interval, true)}, false, false);
+
+    EXPECT_THAT(delay, Eq(0ms));
+}
+
+TEST_F(FrameScheduler, composited_frames_stay_vblank_paced_with_adaptive_sync)
+{
+    scheduler.record_render_time(5ms);
+
+    auto const delay = scheduler.delay_before_next_frame(at(1s + 1ms), {output(1s, interval, true)}, false, true);
+
+    EXPECT_THAT(delay, Eq(8ms));
+}
+
+TEST_F(FrameScheduler, bypassed_frames_are_vblank_paced_unless_every_output_has_adaptive_sync)
+{
+    auto const delay = scheduler.delay_before_next_frame(
+        at(1s),
+        {output(1s, interval, true), output(1s, interval, false)},
+        false,
+        false);
+
+    EXPECT_THAT(delay, Eq(14ms));
+}
@@ -85,7 +85,11 @@ public:
               mir::report::null_display_report(),
               std::make_shared<mtd::StubConsoleServices>(),
               *std::make_shared<mtd::NullEmergencyCleanup>(),
-              mgg::BypassOption::allowed);
+              mgg::BypassOption::allowed,
+              std::chrono::milliseconds{3},
+              mgg::FramePipelining::disabled,
+              mgg::AdaptiveSync::disabled,
+              std::chrono::milliseconds{0});
     }
 
     std::shared_ptr<ml::Logger> logger;
@@ -28,6 +28,7 @@
 
 #include <stdexcept>
 #include <atomic>
+#include <cerrno>
 #include <thread>
 #include <unordered_set>
 
@@ -85,6 +86,21 @@ TEST_F(KMSPageFlipperTest, schedule_flip_calls_drm_page_flip)
     page_flipper.schedule_flip(crtc_id, fb_id, connector_id);
 }
 
+TEST_F(KMSPageFlipperTest, schedule_async_flip_asks_drm_not_to_wait_for_vblank)
+{
+    using namespace testing;
+
+    uint32_t const crtc_id{10};
+    uint32_t const fb_id{101};
+    uint32_t const connector_id{345};
+
+    EXPECT_CALL(mock_drm, drmModePageFlip(drm_fd, crtc_id, fb_id,
+                                          DRM_MODE_PAGE_FLIP_EVENT | DRM_MODE_PAGE_FLIP_ASYNC, NotNull()))
+        .WillOnce(Return(0));
+
+    EXPECT_TRUE(page_flipper.schedule_async_flip(crtc_id, fb_id, connector_id));
+}
+
 TEST_F(KMSPageFlipperTest, double_schedule_flip_throws)
 {
     using namespace testing;
@@ -103,6 +119,41 @@ TEST_F(KMSPageFlipperTest, double_schedule_flip_throws)
     }, std::logic_error);
 }
 
+TEST_F(KMSPageFlipperTest, schedule_atomic_flip_commits_without_blocking)
+{
+    using namespace testing;
+
+    uint32_t const crtc_id{10};
+    uint32_t const connector_id{345};
+    auto const request = reinterpret_cast<drmModeAtomicReq*>(0xa70);
+
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(drm_fd, request,
+                                              DRM_MODE_ATOMIC_NONBLOCK | DRM_MODE_PAGE_FLIP_EVENT, NotNull()))
+        .WillOnce(Return(0));
+    EXPECT_CALL(mock_drm, drmModePageFlip(_, _, _, _, _))
+        .Times(0);
+
+    EXPECT_TRUE(page_flipper.schedule_atomic_flip(request, crtc_id, connector_id));
+}
+
+TEST_F(KMSPageFlipperTest, schedule_atomic_flip_waits_for_a_busy_crtc)
+{
+    using namespace testing;
+
+    uint32_t const crtc_id{10};
+    uint32_t const connector_id{345};
+    auto const request = reinterpret_cast<drmModeAtomicReq*>(0xa70);
+
+    InSequence seq;
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(drm_fd, request,
+                                              DRM_MODE_ATOMIC_NONBLOCK | DRM_MODE_PAGE_FLIP_EVENT, _))
+        .WillOnce(Return(-EBUSY));
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(drm_fd, request, DRM_MODE_PAGE_FLIP_EVENT, _))
+        .WillOnce(Return(0));
+
+    EXPECT_TRUE(page_flipper.schedule_atomic_flip(request, crtc_id, connector_id));
+}
+
 TEST_F(KMSPageFlipperTest, wait_for_flip_handles_drm_event)
 {
     using namespace testing;
@@ -149,6 +200,24 @@ TEST_F(KMSPageFlipperTest, wait_for_flip_reports_vsync)
     page_flipper.wait_for_flip(crtc_id);
 }
 
+TEST_F(KMSPageFlipperTest, frame_of_a_completed_flip_comes_from_the_hardware)
+{
+    using namespace testing;
+    uint32_t const crtc_id{10};
+    uint32_t const fb_id{101};
+    uint32_t const connector_id{345};
+    void* user_data{nullptr};
+    ON_CALL(mock_drm, drmModePageFlip(_, _, _, _, _))
+        .WillByDefault(DoAll(SaveArg<4>(&user_data), Return(0)));
+    ON_CALL(mock_drm, drmHandleEvent(_, _))
+        .WillByDefault(DoAll(InvokePageFlipHandler(&user_data), Return(0)));
+
+    page_flipper.schedule_flip(crtc_id, fb_id, connector_id);
+    mock_drm.generate_event_on(drm_device);
+
+    EXPECT_TRUE(page_flipper.wait_for_flip(crtc_id).hardware);
+}
+
 TEST_F(KMSPageFlipperTest, wait_for_non_scheduled_page_flip_doesnt_block)
 {
     using namespace testing;
@@ -171,25 +240,92 @@ TEST_F(KMSPageFlipperTest, failure_in_wait_for_flip_throws)
     uint32_t const crtc_id{10};
     uint32_t const fb_id{101};
     uint32_t const connector_id{345};
-    void* user_data{nullptr};
 
     EXPECT_CALL(mock_drm, drmModePageFlip(drm_fd, crtc_id, fb_id, _, _))
         .Times(1)
-        .WillOnce(DoAll(SaveArg<4>(&user_data), Return(0)));
+        .WillOnce(Return(0));
 
-    EXPECT_CALL(mock_drm, drmHandleEvent(_, _))
-        .Times(0);
+    /* Cause a failure in handling the event */
+    EXPECT_CALL(mock_drm, drmHandleEvent(drm_fd, _))
+        .WillOnce(Return(-1));
 
     page_flipper.schedule_flip(crtc_id, fb_id, connector_id);
-
-    /* Cause a failure in wait_for_flip */
-    close(drm_fd);
+    mock_drm.generate_event_on(drm_device);
 
     EXPECT_THROW({
         page_flipper.wait_for_flip(crtc_id);
     }, std::runtime_error);
 }
 
+TEST_F(KMSPageFlipperTest, flips_complete_without_anyone_waiting_for_them)
+{
+    using namespace testing;
+
+    uint32_t const crtc_id{10};
+    uint32_t const fb_id{101};
+    uint32_t const connector_id{345};
+    void* user_data{nullptr};
+    std::atomic<bool> reported{false};
+
+    EXPECT_CALL(mock_drm, drmModePageFlip(drm_fd, crtc_id, fb_id, _, _))
+        .WillOnce(DoAll(SaveArg<4>(&user_data), Return(0)));
+    EXPECT_CALL(mock_drm, drmHandleEvent(drm_fd, _))
+        .WillOnce(DoAll(InvokePageFlipHandler(&user_data), Return(0)));
+    EXPECT_CALL(report, report_vsync(connector_id, _))
+        .WillOnce(InvokeWithoutArgs([&reported]() { reported = true; }));
+
+    page_flipper.schedule_flip(crtc_id, fb_id, connector_id);
+    mock_drm.generate_event_on(drm_device);
+
+    auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds{10};
+    while (!reported && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+
+    EXPECT_TRUE(reported);
+}
+
+TEST_F(KMSPageFlipperTest, cursor_updates_call_back_once_they_reach_the_screen)
+{
+    using namespace testing;
+
+    uint32_t const crtc_id{10};
+    auto const request = reinterpret_cast<drmModeAtomicReq*>(0xa70);
+    void* user_data{nullptr};
+    std::atomic<bool> called_back{false};
+
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(drm_fd, request,
+                                              DRM_MODE_ATOMIC_NONBLOCK | DRM_MODE_PAGE_FLIP_EVENT, NotNull()))
+        .WillOnce(DoAll(SaveArg<3>(&user_data), Return(0)));
+    EXPECT_CALL(mock_drm, drmHandleEvent(drm_fd, _))
+        .WillOnce(DoAll(InvokePageFlipHandler(&user_data), Return(0)));
+    EXPECT_CALL(report, report_vsync(_, _))
+        .Times(0);
+
+    EXPECT_TRUE(page_flipper.schedule_atomic_cursor_update(
+        request, crtc_id, [&called_back]() { called_back = true; }));
+    mock_drm.generate_event_on(drm_device);
+
+    auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds{10};
+    while (!called_back && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+
+    EXPECT_TRUE(called_back);
+}
+
+TEST_F(KMSPageFlipperTest, cursor_update_is_refused_while_another_is_in_flight)
+{
+    using namespace testing;
+
+    uint32_t const crtc_id{10};
+    auto const request = reinterpret_cast<drmModeAtomicReq*>(0xa70);
+
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(_, _, _, _))
+        .WillOnce(Return(0));
+
+    EXPECT_TRUE(page_flipper.schedule_atomic_cursor_update(request, crtc_id, []{}));
+    EXPECT_FALSE(page_flipper.schedule_atomic_cursor_update(request, crtc_id, []{}));
+}
+
 TEST_F(KMSPageFlipperTest, wait_for_flips_interleaved)
 {
     using namespace testing;
@@ -274,136 +410,6 @@ private:
 
 }
 
-TEST_F(KMSPageFlipperTest, threads_switch_worker)
-{
-    using namespace testing;
-
-    size_t const worker_index{0};
-    size_t const other_index{1};
-    std::vector<uint32_t> const crtc_ids{10, 11};
-    std::vector<void*> user_data{nullptr, nullptr};
-    std::vector<std::unique_ptr<PageFlippingFunctor>> page_flipping_functors;
-    std::vector<std::thread> page_flipping_threads;
-    std::thread::id tid;
-
-    EXPECT_CALL(mock_drm, drmModePageFlip(drm_fd, _, _, _, _))
-        .Times(2)
-        .WillOnce(DoAll(SaveArg<4>(&user_data[worker_index]), Return(0)))
-        .WillOnce(DoAll(SaveArg<4>(&user_data[other_index]), Return(0)));
-
-    /*
-     * The first event releases the original worker, hence we expect that
-     * then the other thread will become the worker.
-     */
-    EXPECT_CALL(mock_drm, drmHandleEvent(drm_fd, _))
-        .Times(2)
-        .WillOnce(DoAll(InvokePageFlipHandler(&user_data[worker_index]), Return(0)))
-        .WillOnce(DoAll(InvokePageFlipHandler(&user_data[other_index]), Return(0)));
-
-    /* Start the page-flipping threads */
-    for (auto crtc_id : crtc_ids)
-    {
-        auto pf = std::unique_ptr<PageFlippingFunctor>(new PageFlippingFunctor{page_flipper, crtc_id});
-        page_flipping_functors.push_back(std::move(pf));
-        page_flipping_threads.push_back(std::thread{std::ref(*page_flipping_functors.back())});
-
-        /* Wait for page-flip request and tell flipper to stop after this iteration */
-        while (page_flipping_functors.back()->page_flip_count() == 0)
-            std::this_thread::sleep_for(std::chrono::milliseconds{1});
-        page_flipping_functors.back()->stop();
-
-        /* Wait until the (first) thread has become the worker */
-        while (tid == std::thread::id())
-        {
-            std::this_thread::sleep_for(std::chrono::milliseconds{1});
-            tid = page_flipper.debug_get_worker_tid();
-        }
-    }
-
-    EXPECT_EQ(page_flipping_threads[worker_index].get_id(), tid);
-
-    /* Fake a DRM event */
-    mock_drm.generate_event_on(drm_device);
-
-    page_flipping_threads[worker_index].join();
-
-    /* Wait for the worker to switch */
-    while (tid != page_flipping_threads[other_index].get_id())
-    {
-        std::this_thread::sleep_for(std::chrono::milliseconds{1});
-        tid = page_flipper.debug_get_worker_tid();
-    }
-
-    /* Fake another DRM event to unblock the remaining thread */
-    mock_drm.generate_event_on(drm_device);
-
-    page_flipping_threads[other_index].join();
-}
-
-TEST_F(KMSPageFlipperTest, threads_worker_notifies_non_worker)
-{
-    using namespace testing;
-
-    size_t const worker_index{0};
-    size_t const other_index{1};
-    std::vector<uint32_t> const crtc_ids{10, 11};
-    std::vector<void*> user_data{nullptr, nullptr};
-    std::vector<std::unique_ptr<PageFlippingFunctor>> page_flipping_functors;
-    std::vector<std::thread> page_flipping_threads;
-    std::thread::id tid;
-
-    EXPECT_CALL(mock_drm, drmModePageFlip(drm_fd, _, _, _, _))
-        .Times(2)
-        .WillOnce(DoAll(SaveArg<4>(&user_data[worker_index]), Return(0)))
-        .WillOnce(DoAll(SaveArg<4>(&user_data[other_index]), Return(0)));
-
-    /*
-     * The first event releases the non-worker thread, hence we expect that
-     * original worker not change.
-     */
-    EXPECT_CALL(mock_drm, drmHandleEvent(drm_fd, _))
-        .Times(2)
-        .WillOnce(DoAll(InvokePageFlipHandler(&user_data[other_index]), Return(0)))
-        .WillOnce(DoAll(InvokePageFlipHandler(&user_data[worker_index]), Return(0)));
-
-    /* Start the page-flipping threads */
-    for (auto crtc_id : crtc_ids)
-    {
-        auto pf = std::unique_ptr<PageFlippingFunctor>(new PageFlippingFunctor{page_flipper, crtc_id});
-        page_flipping_functors.push_back(std::move(pf));
-        page_flipping_threads.push_back(std::thread{std::ref(*page_flipping_functors.back())});
-
-        /* Wait for page-flip request and tell flipper to stop after this iteration */
-        while (page_flipping_functors.back()->page_flip_count() == 0)
-            std::this_thread::sleep_for(std::chrono::milliseconds{1});
-        page_flipping_functors.back()->stop();
-
-        /* Wait until the (first) thread has become the worker */
-        while (tid == std::thread::id())
-        {
-            std::this_thread::sleep_for(std::chrono::milliseconds{1});
-            tid = page_flipper.debug_get_worker_tid();
-        }
-    }
-
-    EXPECT_EQ(page_flipping_threads[worker_index].get_id(), tid);
-
-    /* Fake a DRM event */
-    mock_drm.generate_event_on(drm_device);
-
-    /* Wait for the non-worker thread to exit */
-    page_flipping_threads[other_index].join();
-
-    /* Check that the worker hasn't changed */
-    EXPECT_EQ(page_flipping_threads[worker_index].get_id(),
-              page_flipper.debug_get_worker_tid());
-
-    /* Fake another DRM event to unblock the remaining thread */
-    mock_drm.generate_event_on(drm_device);
-
-    page_flipping_threads[worker_index].join();
-}
-
 namespace
 {
 
@@ -82,13 +82,18 @@ public:
         fake_devices.add_standard_device("standard-drm-devices");
     }
 
-    std::shared_ptr<mgg::Platform> create_platform()
+    std::shared_ptr<mgg::Platform> create_platform(std::string const& render_device = {})
     {
         return std::make_shared<mgg::Platform>(
                 mir::report::null_display_report(),
                 std::make_shared<mtd::StubConsoleServices>(),
                 *std::make_shared<mtd::NullEmergencyCleanup>(),
-                mgg::BypassOption::allowed);
+                mgg::BypassOption::allowed,
+                std::chrono::milliseconds{3},
+                mgg::FramePipelining::disabled,
+                mgg::AdaptiveSync::disabled,
+                std::chrono::milliseconds{0},
+                render_device);
     }
 
     EGLDisplay fake_display{reinterpret_cast<EGLDisplay>(0xabcd)};
@@ -124,6 +129,17 @@ TEST_F(MesaGraphicsPlatform, egl_native_display_is_gbm_device)
     EXPECT_EQ(mock_gbm.fake_gbm.device, platform->egl_native_display());
 }
 
+TEST_F(MesaGraphicsPlatform, rendering_on_a_device_not_in_use_is_an_error)
+{
+    EXPECT_THROW(create_platform("/dev/dri/card9"), std::exception);
+}
+
+TEST_F(MesaGraphicsPlatform, renders_on_the_boot_gpu_by_default)
+{
+    auto platform = create_platform();
+    EXPECT_EQ(platform->drm.front(), platform->render_drm);
+}
+
 TEST_F(MesaGraphicsPlatform, probe_returns_unsupported_when_no_drm_udev_devices)
 {
     mtf::UdevEnvironment udev_environment;
@@ -26,10 +26,12 @@
 #include "mir/test/doubles/mock_gbm.h"
 
 #include <stdexcept>
+#include <cstring>
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 #include <fcntl.h>
+#include <drm_fourcc.h>
 
 namespace mg = mir::graphics;
 namespace mgg = mir::graphics::gbm;
@@ -46,14 +48,24 @@ class NullPageFlipper : public mgg::PageFlipper
 {
 public:
     bool schedule_flip(uint32_t,uint32_t,uint32_t) override { return true; }
+    bool schedule_async_flip(uint32_t,uint32_t,uint32_t) override { return true; }
+    bool schedule_atomic_flip(drmModeAtomicReq*,uint32_t,uint32_t) override { return true; }
+    bool schedule_async_atomic_flip(drmModeAtomicReq*,uint32_t,uint32_t) override { return true; }
     mg::Frame wait_for_flip(uint32_t) override { return {}; }
+    bool schedule_atomic_cursor_update(drmModeAtomicReq*,uint32_t,std::function<void()> const&) override { return true; }
+    void cancel_cursor_update(uint32_t) override {}
 };
 
 class MockPageFlipper : public mgg::PageFlipper
 {
 public:
     MOCK_METHOD3(schedule_flip, bool(uint32_t,uint32_t,uint32_t));
+    MOCK_METHOD3(schedule_async_flip, bool(uint32_t,uint32_t,uint32_t));
+    MOCK_METHOD3(schedule_atomic_flip, bool(drmModeAtomicReq*,uint32_t,uint32_t));
+    MOCK_METHOD3(schedule_async_atomic_flip, bool(drmModeAtomicReq*,uint32_t,uint32_t));
     MOCK_METHOD1(wait_for_flip, mg::Frame(uint32_t));
+    MOCK_METHOD3(schedule_atomic_cursor_update, bool(drmModeAtomicReq*,uint32_t,std::function<void()> const&));
+    MOCK_METHOD1(cancel_cursor_update, void(uint32_t));
 };
 
 class RealKMSOutputTest : public ::testing::Test
@@ -74,6 +86,11 @@ public:
     }
 
     void setup_outputs_connected_crtc()
+    {
+        setup_outputs_connected_crtc(modes_empty);
+    }
+
+    void setup_outputs_connected_crtc(std::vector<drmModeModeInfo>& modes)
     {
         uint32_t const possible_crtcs_mask{0x1};
 
@@ -94,7 +111,7 @@ public:
             DRM_MODE_CONNECTOR_VGA,
             DRM_MODE_CONNECTED,
             encoder_ids[0],
-            modes_empty,
+            modes,
             possible_encoder_ids1,
             geom::Size());
 
@@ -148,6 +165,20 @@ public:
         mock_drm.prepare(drm_device);
     }
 
+    void make_fake_bo_foreign()
+    {
+        ON_CALL(mock_gbm, gbm_bo_get_device(fake_bo))
+            .WillByDefault(Return(fake_foreign_device));
+        ON_CALL(mock_gbm, gbm_device_get_fd(fake_foreign_device))
+            .WillByDefault(Return(foreign_device_fd));
+        ON_CALL(mock_drm, drmGetPrimaryDeviceNameFromFd(foreign_device_fd))
+            .WillByDefault(InvokeWithoutArgs([]() { return strdup("/dev/dri/card1"); }));
+        ON_CALL(mock_gbm, gbm_bo_get_fd(fake_bo))
+            .WillByDefault(InvokeWithoutArgs([]() { return open("/dev/null", O_RDONLY); }));
+        ON_CALL(mock_drm, drmPrimeFDToHandle(_, _, _))
+            .WillByDefault(DoAll(SetArgPointee<2>(imported_handle), Return(0)));
+    }
+
     void append_fb_id(uint32_t fb_id)
     {
         EXPECT_CALL(mock_drm, drmModeAddFB2(_,_,_,_,_,_,_,_,_))
@@ -167,6 +198,9 @@ public:
     int const drm_fd;
 
     gbm_bo* const fake_bo{reinterpret_cast<gbm_bo*>(0x123ba)};
+    gbm_device* const fake_foreign_device{reinterpret_cast<gbm_device*>(0xdec1ce)};
+    int const foreign_device_fd{0xf0f0};
+    uint32_t const imported_handle{0xcafe};
     uint32_t const invalid_id;
     std::vector<uint32_t> const crtc_ids;
     std::vector<uint32_t> const encoder_ids;
@@ -218,6 +252,115 @@ TEST_F(RealKMSOutputTest, operations_use_existing_crtc)
     output.wait_for_page_flip();
 }
 
+TEST_F(RealKMSOutputTest, async_page_flip_is_scheduled_if_the_driver_supports_it)
+{
+    using namespace testing;
+
+    setup_outputs_connected_crtc();
+
+    uint32_t const fb_id{42};
+    append_fb_id(fb_id);
+
+    ON_CALL(mock_drm, drmGetCap(_, DRM_CAP_ASYNC_PAGE_FLIP, _))
+        .WillByDefault(DoAll(SetArgPointee<2>(1), Return(0)));
+    EXPECT_CALL(mock_page_flipper, schedule_async_flip(crtc_ids[0], fb_id, connector_ids[0]))
+        .WillOnce(Return(true));
+
+    mgg::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(mock_page_flipper)};
+
+    auto fb = output.fb_for(fake_bo);
+
+    EXPECT_TRUE(output.set_crtc(*fb));
+    EXPECT_TRUE(output.schedule_async_page_flip(*fb));
+}
+
+TEST_F(RealKMSOutputTest, async_page_flip_is_refused_if_the_driver_doesnt_support_it)
+{
+    using namespace testing;
+
+    setup_outputs_connected_crtc();
+
+    uint32_t const fb_id{42};
+    append_fb_id(fb_id);
+
+    ON_CALL(mock_drm, drmGetCap(_, DRM_CAP_ASYNC_PAGE_FLIP, _))
+        .WillByDefault(DoAll(SetArgPointee<2>(0), Return(0)));
+    EXPECT_CALL(mock_page_flipper, schedule_async_flip(_, _, _))
+        .Times(0);
+
+    mgg::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(mock_page_flipper)};
+
+    auto fb = output.fb_for(fake_bo);
+
+    EXPECT_TRUE(output.set_crtc(*fb));
+    EXPECT_FALSE(output.schedule_async_page_flip(*fb));
+}
+
+TEST_F(RealKMSOutputTest, idle_refresh_sets_the_slowest_mode_of_the_same_resolution)
+{
+    using namespace testing;
+
+    auto mode = [](uint16_t width, uint16_t height, uint32_t refresh)
+        {
+            drmModeModeInfo info{};
+            info.hdisplay = width;
+            info.vdisplay = height;
+            info.vrefresh = refresh;
+            return info;
+        };
+    std::vector<drmModeModeInfo> modes{
+        mode(1920, 1080, 60), mode(1920, 1080, 48), mode(1280, 720, 30), mode(1920, 1080, 50)};
+    setup_outputs_connected_crtc(modes);
+
+    uint32_t const fb_id{42};
+    append_fb_id(fb_id);
+
+    {
+        InSequence s;
+        EXPECT_CALL(mock_drm, drmModeSetCrtc(_, crtc_ids[0], fb_id, _, _, _, _,
+                                             Pointee(Field(&drmModeModeInfo::vrefresh, 48u))));
+        EXPECT_CALL(mock_drm, drmModeSetCrtc(_, crtc_ids[0], fb_id, _, _, _, _,
+                                             Pointee(Field(&drmModeModeInfo::vrefresh, 60u))));
+    }
+
+    mgg::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(null_page_flipper)};
+    output.configure({0, 0}, 0);
+
+    auto fb = output.fb_for(fake_bo);
+
+    EXPECT_TRUE(output.set_idle_refresh(true));
+    EXPECT_TRUE(output.set_crtc(*fb));
+    EXPECT_TRUE(output.set_idle_refresh(false));
+    EXPECT_TRUE(output.set_crtc(*fb));
+}
+
+TEST_F(RealKMSOutputTest, idle_refresh_is_refused_without_a_slower_mode)
+{
+    drmModeModeInfo only_mode{};
+    only_mode.hdisplay = 1920;
+    only_mode.vdisplay = 1080;
+    only_mode.vrefresh = 60;
+    std::vector<drmModeModeInfo> modes{only_mode};
+    setup_outputs_connected_crtc(modes);
+
+    mgg::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(null_page_flipper)};
+    output.configure({0, 0}, 0);
+
+    EXPECT_FALSE(output.set_idle_refresh(true));
+}
+
 TEST_F(RealKMSOutputTest, operations_use_possible_crtc)
 {
     using namespace testing;
@@ -548,3 +691,67 @@ TEST_F(RealKMSOutputTest, drm_set_gamma_failure_does_not_throw)
 
     EXPECT_NO_THROW(output.set_gamma(gamma););
 }
+
+TEST_F(RealKMSOutputTest, buffer_from_another_gpu_is_scanned_out_directly_if_importable)
+{
+    setup_outputs_connected_crtc();
+    make_fake_bo_foreign();
+
+    mgg::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(mock_page_flipper)};
+
+    // Once to probe, once for real; the answer for the GPU is then remembered
+    EXPECT_CALL(mock_drm, drmPrimeFDToHandle(drm_fd, _, _))
+        .Times(2);
+    EXPECT_CALL(mock_drm, drmModeAddFB2(drm_fd, _, _, _, Pointee(imported_handle), _, _, _, _))
+        .Times(2);
+
+    EXPECT_FALSE(output.buffer_requires_migration(fake_bo));
+    EXPECT_FALSE(output.buffer_requires_migration(fake_bo));
+    EXPECT_THAT(output.fb_for(fake_bo), NotNull());
+}
+
+TEST_F(RealKMSOutputTest, buffer_from_another_gpu_requires_migration_if_not_importable)
+{
+    setup_outputs_connected_crtc();
+    make_fake_bo_foreign();
+
+    ON_CALL(mock_drm, drmModeAddFB2(drm_fd, _, _, _, _, _, _, _, _))
+        .WillByDefault(Return(-EINVAL));
+
+    mgg::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(mock_page_flipper)};
+
+    EXPECT_TRUE(output.buffer_requires_migration(fake_bo));
+}
+
+#ifndef MIR_NO_GBM_MODIFIERS
+TEST_F(RealKMSOutputTest, buffer_with_a_modifier_is_added_with_all_its_planes)
+{
+    setup_outputs_connected_crtc();
+
+    uint64_t const modifier{I915_FORMAT_MOD_Y_TILED_CCS};
+    ON_CALL(mock_gbm, gbm_bo_get_modifier(fake_bo))
+        .WillByDefault(Return(modifier));
+    ON_CALL(mock_gbm, gbm_bo_get_plane_count(fake_bo))
+        .WillByDefault(Return(2));
+
+    mgg::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(mock_page_flipper)};
+
+    EXPECT_CALL(mock_drm, drmModeAddFB2WithModifiers(
+        drm_fd, _, _, _, _, _, _, Truly([&](uint64_t const* m) { return m[0] == modifier && m[1] == modifier; }),
+        _, DRM_MODE_FB_MODIFIERS))
+        .WillOnce(Return(0));
+    EXPECT_CALL(mock_drm, drmModeAddFB2(_, _, _, _, _, _, _, _, _))
+        .Times(0);
+
+    EXPECT_THAT(output.fb_for(fake_bo), NotNull());
+}
+#endif
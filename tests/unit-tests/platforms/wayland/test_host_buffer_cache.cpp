@@ -0,0 +1,128 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/platforms/wayland/host_buffer_cache.h"
+
+#include "mir/test/doubles/stub_buffer.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace mg = mir::graphics;
+namespace mgw = mir::graphics::wayland;
+namespace mtd = mir::test::doubles;
+
+using namespace testing;
+
+namespace
+{
+struct FakeHostBuffer
+{
+    mg::BufferID client_buffer;
+};
+
+struct HostBufferCache : Test
+{
+    mgw::HostBufferCache<FakeHostBuffer> cache{
+        [this](std::shared_ptr<mg::Buffer> const& buffer) -> std::shared_ptr<FakeHostBuffer>
+        {
+            imported.push_back(buffer->id());
+            if (buffer == unimportable)
+                return nullptr;
+            return std::make_shared<FakeHostBuffer>(FakeHostBuffer{buffer->id()});
+        }};
+
+    std::vector<mg::BufferID> imported;
+    std::shared_ptr<mg::Buffer> unimportable;
+};
+}
+
+TEST_F(HostBufferCache, imports_a_buffer_new_to_the_frame)
+{
+    auto const buffer = std::make_shared<mtd::StubBuffer>();
+
+    auto const host_buffer = cache.host_buffer_for(buffer);
+
+    ASSERT_THAT(host_buffer, NotNull());
+    EXPECT_THAT(host_buffer->client_buffer, Eq(buffer->id()));
+    EXPECT_THAT(imported, ElementsAre(buffer->id()));
+}
+
+TEST_F(HostBufferCache, reuses_what_it_imported_while_the_buffer_is_shown)
+{
+    auto const buffer = std::make_shared<mtd::StubBuffer>();
+
+    auto const first = cache.host_buffer_for(buffer);
+    cache.end_frame();
+    auto const second = cache.host_buffer_for(buffer);
+    cache.end_frame();
+    auto const third = cache.host_buffer_for(buffer);
+
+    EXPECT_THAT(second, Eq(first));
+    EXPECT_THAT(third, Eq(first));
+    EXPECT_THAT(imported.size(), Eq(1u));
+}
+
+TEST_F(HostBufferCache, reuses_what_it_imported_within_a_frame)
+{
+    auto const buffer = std::make_shared<mtd::StubBuffer>();
+
+    auto const first = cache.host_buffer_for(buffer);
+    auto const second = cache.host_buffer_for(buffer);
+
+    EXPECT_THAT(second, Eq(first));
+    EXPECT_THAT(imported.size(), Eq(1u));
+}
+
+TEST_F(HostBufferCache, forgets_buffers_missing_from_a_frame)
+{
+    auto const shown = std::make_shared<mtd::StubBuffer>();
+    auto const hidden = std::make_shared<mtd::StubBuffer>();
+
+    cache.host_buffer_for(shown);
+    std::weak_ptr<FakeHostBuffer> const hidden_host_buffer = cache.host_buffer_for(hidden);
+    cache.end_frame();
+
+    cache.host_buffer_for(shown);
+    cache.end_frame();
+
+    EXPECT_TRUE(hidden_host_buffer.expired());
+    EXPECT_THAT(cache.size(), Eq(1u));
+}
+
+TEST_F(HostBufferCache, imports_a_buffer_again_once_it_has_been_forgotten)
+{
+    auto const buffer = std::make_shared<mtd::StubBuffer>();
+
+    cache.host_buffer_for(buffer);
+    cache.end_frame();
+    cache.end_frame();
+    cache.host_buffer_for(buffer);
+
+    EXPECT_THAT(imported, ElementsAre(buffer->id(), buffer->id()));
+}
+
+TEST_F(HostBufferCache, keeps_nothing_for_a_buffer_it_cant_import)
+{
+    unimportable = std::make_shared<mtd::StubBuffer>();
+
+    EXPECT_THAT(cache.host_buffer_for(unimportable), IsNull());
+    cache.end_frame();
+    EXPECT_THAT(cache.host_buffer_for(unimportable), IsNull());
+
+    EXPECT_THAT(imported.size(), Eq(2u));
+    EXPECT_THAT(cache.size(), Eq(0u));
+}
@@ -21,6 +21,7 @@
 
 #include "src/platforms/x11/graphics/display.h"
 #include "src/platforms/x11/graphics/platform.h"
+#include "src/platforms/x11/X11_resources.h"
 #include "src/server/report/null/display_report.h"
 
 #include "mir/graphics/display_configuration.h"
@@ -31,6 +32,7 @@
 #include "mir/test/doubles/mock_gl_config.h"
 #include "mir/test/fake_shared.h"
 
+#include <X11/extensions/Xpresent.h>
 
 namespace mg=mir::graphics;
 namespace mgx=mg::X;
@@ -320,3 +322,34 @@ TEST_F(X11DisplayTest, updates_scale_property_correctly)
 
     EXPECT_THAT(new_scale, Eq(scale));
 }
+
+TEST_F(X11DisplayTest, asks_for_present_completion_events_on_each_window)
+{
+    ON_CALL(mock_x11, XPresentQueryExtension(mock_x11.fake_x11.display, _, _, _))
+        .WillByDefault(Return(True));
+
+    EXPECT_CALL(
+        mock_x11,
+        XPresentSelectInput(mock_x11.fake_x11.display, mock_x11.fake_x11.window, PresentCompleteNotifyMask));
+
+    auto display = create_display();
+}
+
+TEST_F(X11DisplayTest, last_frame_is_the_one_present_reported_complete)
+{
+    auto display = create_display();
+    int64_t const msc{1234};
+    std::chrono::microseconds const ust{5678};
+
+    mir::X::X11Resources::instance.with_output_for_window(
+        mock_x11.fake_x11.window,
+        [&](std::optional<mir::X::X11Resources::VirtualOutput*> output)
+        {
+            ASSERT_TRUE(output);
+            output.value()->frame_presented(msc, ust);
+        });
+
+    auto const frame = display->last_frame_on(0);
+    EXPECT_THAT(frame.msc, Eq(msc));
+    EXPECT_THAT(frame.ust.nanoseconds, Eq(ust));
+}
@@ -26,6 +26,8 @@
 #include <mir/test/doubles/mock_renderable.h>
 #include <mir/test/doubles/mock_buffer_stream.h>
 #include <mir/compositor/buffer_stream.h>
+#include <mir/graphics/buffer_basic.h>
+#include <mir/graphics/solid_color_buffer.h>
 #include <mir/test/doubles/mock_gl.h>
 #include <mir/test/doubles/mock_egl.h>
 #include <src/renderers/gl/renderer.h>
@@ -39,6 +41,7 @@ using testing::ReturnRef;
 using testing::Pointee;
 using testing::AnyNumber;
 using testing::AtLeast;
+using testing::AtMost;
 using testing::DoAll;
 using testing::_;
 
@@ -62,6 +65,49 @@ const GLint tex_uniform_location = 6;
 const GLint display_transform_uniform_location = 7;
 const GLint centre_uniform_location = 8;
 
+GLuint64 const stub_gpu_time_ns{2345678};
+
+void stub_glGenQueriesEXT(GLsizei n, GLuint* ids)
+{
+    for (GLsizei i = 0; i != n; ++i)
+        ids[i] = i + 1;
+}
+
+void stub_glQueryEXT(GLenum, GLuint)
+{
+}
+
+void stub_glEndQueryEXT(GLenum)
+{
+}
+
+void stub_glDeleteQueriesEXT(GLsizei, GLuint const*)
+{
+}
+
+void stub_glGetQueryObjectuivEXT(GLuint, GLenum, GLuint* available)
+{
+    *available = GL_TRUE;
+}
+
+void stub_glGetQueryObjectui64vEXT(GLuint, GLenum, GLuint64* result)
+{
+    *result = stub_gpu_time_ns;
+}
+
+struct StubSolidColorBuffer : mg::BufferBasic, mg::SolidColorBuffer
+{
+    explicit StubSolidColorBuffer(std::array<float, 4> const& color) : color_{color} {}
+
+    auto native_buffer_handle() const -> std::shared_ptr<mg::NativeBuffer> override { return nullptr; }
+    auto size() const -> mir::geometry::Size override { return {1, 1}; }
+    auto pixel_format() const -> MirPixelFormat override { return mir_pixel_format_xrgb_8888; }
+    auto native_buffer_base() -> mg::NativeBufferBase* override { return this; }
+    auto color() const -> std::array<float, 4> override { return color_; }
+
+    std::array<float, 4> const color_;
+};
+
 void SetUpMockProgramData(mtd::MockGL &mock_gl)
 {
     /* Uniforms and Attributes */
@@ -315,6 +361,79 @@ TEST_F(GLRenderer, dont_set_scissor_test_when_unnecessary)
     renderer.render(renderable_list);
 }
 
+TEST_F(GLRenderer, uploads_all_vertices_of_a_frame_at_once)
+{
+    renderable_list.push_back(renderable);
+
+    mrg::Renderer renderer(display_buffer);
+
+    EXPECT_CALL(mock_gl, glBufferData(GL_ARRAY_BUFFER, 8 * sizeof(mir::gl::Vertex), _, GL_STREAM_DRAW))
+        .Times(1);
+    EXPECT_CALL(mock_gl, glDrawArrays(GL_TRIANGLE_FAN, 0, 4));
+    EXPECT_CALL(mock_gl, glDrawArrays(GL_TRIANGLE_FAN, 4, 4));
+
+    renderer.render(renderable_list);
+}
+
+TEST_F(GLRenderer, does_not_reupload_vertices_of_an_unchanged_scene)
+{
+    mrg::Renderer renderer(display_buffer);
+
+    EXPECT_CALL(mock_gl, glBufferData(GL_ARRAY_BUFFER, _, _, _)).Times(1);
+
+    renderer.render(renderable_list);
+    renderer.render(renderable_list);
+}
+
+TEST_F(GLRenderer, reuploads_vertices_when_a_renderable_moves)
+{
+    mrg::Renderer renderer(display_buffer);
+
+    EXPECT_CALL(mock_gl, glBufferData(GL_ARRAY_BUFFER, _, _, _)).Times(2);
+
+    renderer.render(renderable_list);
+    EXPECT_CALL(*renderable, screen_position())
+        .WillRepeatedly(Return(mir::geometry::Rectangle{{5,6},{3,4}}));
+    renderer.render(renderable_list);
+}
+
+TEST_F(GLRenderer, reuploads_vertices_when_the_scene_changes)
+{
+    mrg::Renderer renderer(display_buffer);
+
+    EXPECT_CALL(mock_gl, glBufferData(GL_ARRAY_BUFFER, _, _, _)).Times(2);
+
+    renderer.render(renderable_list);
+    renderer.render({});
+}
+
+TEST_F(GLRenderer, does_not_reload_unchanged_renderable_uniforms)
+{
+    renderable_list.push_back(renderable);
+
+    mrg::Renderer renderer(display_buffer);
+
+    EXPECT_CALL(mock_gl, glUniform2f(_, _, _)).Times(1);
+    EXPECT_CALL(mock_gl, glUniform1f(_, _)).Times(AtMost(1));
+
+    renderer.render(renderable_list);
+    renderer.render(renderable_list);
+}
+
+TEST_F(GLRenderer, consecutive_renderables_reuse_gl_state)
+{
+    renderable_list.push_back(renderable);
+    renderable_list.push_back(renderable);
+
+    mrg::Renderer renderer(display_buffer);
+
+    EXPECT_CALL(mock_gl, glUseProgram(_)).Times(1);
+    EXPECT_CALL(mock_gl, glDisable(GL_BLEND)).Times(1);
+    EXPECT_CALL(mock_gl, glVertexAttribPointer(_, _, _, _, _, _)).Times(2);
+
+    renderer.render(renderable_list);
+}
+
 
 TEST_F(GLRenderer, unchanged_viewport_avoids_gl_calls)
 {
@@ -466,3 +585,278 @@ TEST_F(GLRenderer, sets_viewport_downscaled_wide)
 
     mrg::Renderer renderer(mock_display_buffer);
 }
+
+TEST_F(GLRenderer, swaps_buffers_with_damage_when_damage_is_set)
+{
+    int const screen_width = 1920;
+    int const screen_height = 1080;
+    mir::geometry::Rectangle const view_area{{1920,0}, {1920,1080}};
+
+    ON_CALL(mock_egl, eglQuerySurface(_,_,EGL_WIDTH,_))
+        .WillByDefault(DoAll(SetArgPointee<3>(screen_width),
+                             Return(EGL_TRUE)));
+    ON_CALL(mock_egl, eglQuerySurface(_,_,EGL_HEIGHT,_))
+        .WillByDefault(DoAll(SetArgPointee<3>(screen_height),
+                             Return(EGL_TRUE)));
+    ON_CALL(mock_display_buffer, view_area())
+        .WillByDefault(Return(view_area));
+
+    mrg::Renderer renderer(mock_display_buffer);
+
+    EXPECT_CALL(mock_display_buffer, swap_buffers()).Times(0);
+    EXPECT_CALL(mock_display_buffer,
+        swap_buffers_with_damage(mir::geometry::Rectangles{{{10, 20}, {30, 40}}}));
+
+    renderer.set_damage({{{1930, 20}, {30, 40}}});
+    renderer.render(renderable_list);
+}
+
+TEST_F(GLRenderer, scissors_repaint_to_damage_when_buffer_age_is_known)
+{
+    int const screen_width = 1920;
+    int const screen_height = 1080;
+    mir::geometry::Rectangle const view_area{{0,0}, {1920,1080}};
+
+    ON_CALL(mock_egl, eglQueryString(_,EGL_EXTENSIONS))
+        .WillByDefault(Return("EGL_KHR_image EGL_EXT_buffer_age"));
+    ON_CALL(mock_egl, eglQuerySurface(_,_,EGL_WIDTH,_))
+        .WillByDefault(DoAll(SetArgPointee<3>(screen_width),
+                             Return(EGL_TRUE)));
+    ON_CALL(mock_egl, eglQuerySurface(_,_,EGL_HEIGHT,_))
+        .WillByDefault(DoAll(SetArgPointee<3>(screen_height),
+                             Return(EGL_TRUE)));
+    ON_CALL(mock_egl, eglQuerySurface(_,_,EGL_BUFFER_AGE_EXT,_))
+        .WillByDefault(DoAll(SetArgPointee<3>(1),
+                             Return(EGL_TRUE)));
+    ON_CALL(mock_display_buffer, view_area())
+        .WillByDefault(Return(view_area));
+
+    mrg::Renderer renderer(mock_display_buffer);
+
+    EXPECT_CALL(mock_gl, glEnable(GL_SCISSOR_TEST));
+    EXPECT_CALL(mock_gl, glScissor(10, 1020, 30, 40));
+
+    renderer.set_damage({{{10, 20}, {30, 40}}});
+    renderer.render(renderable_list);
+}
+
+TEST_F(GLRenderer, draws_opaque_renderables_front_to_back_when_asked)
+{
+    ON_CALL(mock_gl, glGetIntegerv(GL_DEPTH_BITS, _))
+        .WillByDefault(SetArgPointee<1>(24));
+
+    EXPECT_CALL(*renderable, transformation()).WillRepeatedly(Return(glm::mat4(1)));
+    auto const translucent = std::make_shared<testing::NiceMock<mtd::MockRenderable>>();
+    ON_CALL(*translucent, buffer()).WillByDefault(Return(mock_buffer));
+    ON_CALL(*translucent, shaped()).WillByDefault(Return(true));
+    auto const top = std::make_shared<testing::NiceMock<mtd::MockRenderable>>();
+    ON_CALL(*top, buffer()).WillByDefault(Return(mock_buffer));
+    ON_CALL(*top, shaped()).WillByDefault(Return(false));
+    ON_CALL(*top, transformation()).WillByDefault(Return(glm::mat4(1)));
+
+    mrg::Renderer renderer(display_buffer, true);
+
+    EXPECT_CALL(mock_gl, glEnable(_)).Times(AnyNumber());
+    EXPECT_CALL(mock_gl, glDepthMask(_)).Times(AnyNumber());
+
+    // Stacked bottom to top: renderable, translucent, top
+    InSequence seq;
+    EXPECT_CALL(mock_gl, glEnable(GL_DEPTH_TEST));
+    EXPECT_CALL(mock_gl, glDepthRangef(testing::FloatEq(0.25f), testing::FloatEq(0.25f)));
+    EXPECT_CALL(mock_gl, glDepthRangef(testing::FloatEq(0.75f), testing::FloatEq(0.75f)));
+    EXPECT_CALL(mock_gl, glDepthMask(GL_FALSE));
+    EXPECT_CALL(mock_gl, glDepthRangef(testing::FloatEq(0.5f), testing::FloatEq(0.5f)));
+    EXPECT_CALL(mock_gl, glDepthMask(GL_TRUE));
+    EXPECT_CALL(mock_gl, glDepthRangef(0.0f, 1.0f));
+    EXPECT_CALL(mock_gl, glDisable(GL_DEPTH_TEST));
+
+    renderer.render({renderable, translucent, top});
+}
+
+TEST_F(GLRenderer, draws_back_to_front_without_a_depth_buffer)
+{
+    EXPECT_CALL(mock_gl, glEnable(GL_DEPTH_TEST)).Times(0);
+    EXPECT_CALL(mock_gl, glClear(GL_COLOR_BUFFER_BIT));
+
+    mrg::Renderer renderer(display_buffer, true);
+    renderer.render(renderable_list);
+}
+
+TEST_F(GLRenderer, skips_colour_clear_when_opaque_renderables_cover_the_viewport)
+{
+    int const screen_width = 1920;
+    int const screen_height = 1080;
+    mir::geometry::Rectangle const view_area{{0,0}, {1920,1080}};
+
+    ON_CALL(mock_gl, glGetIntegerv(GL_DEPTH_BITS, _))
+        .WillByDefault(SetArgPointee<1>(24));
+    ON_CALL(mock_egl, eglQuerySurface(_,_,EGL_WIDTH,_))
+        .WillByDefault(DoAll(SetArgPointee<3>(screen_width),
+                             Return(EGL_TRUE)));
+    ON_CALL(mock_egl, eglQuerySurface(_,_,EGL_HEIGHT,_))
+        .WillByDefault(DoAll(SetArgPointee<3>(screen_height),
+                             Return(EGL_TRUE)));
+    ON_CALL(mock_display_buffer, view_area())
+        .WillByDefault(Return(view_area));
+
+    auto const left = std::make_shared<testing::NiceMock<mtd::MockRenderable>>();
+    ON_CALL(*left, buffer()).WillByDefault(Return(mock_buffer));
+    ON_CALL(*left, shaped()).WillByDefault(Return(false));
+    ON_CALL(*left, transformation()).WillByDefault(Return(glm::mat4(1)));
+    ON_CALL(*left, screen_position()).WillByDefault(Return(mir::geometry::Rectangle{{0,0}, {1000,1080}}));
+    auto const right = std::make_shared<testing::NiceMock<mtd::MockRenderable>>();
+    ON_CALL(*right, buffer()).WillByDefault(Return(mock_buffer));
+    ON_CALL(*right, shaped()).WillByDefault(Return(true));
+    ON_CALL(*right, transformation()).WillByDefault(Return(glm::mat4(1)));
+    ON_CALL(*right, screen_position()).WillByDefault(Return(mir::geometry::Rectangle{{900,0}, {1020,1080}}));
+    ON_CALL(*right, opaque_region()).WillByDefault(Return(mir::geometry::Rectangles{{{900,0}, {1020,1080}}}));
+
+    mrg::Renderer renderer(mock_display_buffer, true);
+
+    EXPECT_CALL(mock_gl, glClear(GL_DEPTH_BUFFER_BIT));
+    renderer.render({left, right});
+
+    EXPECT_CALL(mock_gl, glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT));
+    renderer.render({left});
+}
+
+TEST_F(GLRenderer, skips_clear_when_an_opaque_renderable_covers_the_viewport)
+{
+    int const screen_width = 1920;
+    int const screen_height = 1080;
+    mir::geometry::Rectangle const view_area{{0,0}, {1920,1080}};
+
+    ON_CALL(mock_egl, eglQuerySurface(_,_,EGL_WIDTH,_))
+        .WillByDefault(DoAll(SetArgPointee<3>(screen_width),
+                             Return(EGL_TRUE)));
+    ON_CALL(mock_egl, eglQuerySurface(_,_,EGL_HEIGHT,_))
+        .WillByDefault(DoAll(SetArgPointee<3>(screen_height),
+                             Return(EGL_TRUE)));
+    ON_CALL(mock_display_buffer, view_area())
+        .WillByDefault(Return(view_area));
+
+    auto const fullscreen = std::make_shared<testing::NiceMock<mtd::MockRenderable>>();
+    ON_CALL(*fullscreen, buffer()).WillByDefault(Return(mock_buffer));
+    ON_CALL(*fullscreen, transformation()).WillByDefault(Return(glm::mat4(1)));
+    ON_CALL(*fullscreen, screen_position()).WillByDefault(Return(view_area));
+    EXPECT_CALL(*fullscreen, shaped()).WillOnce(Return(false));
+
+    mrg::Renderer renderer(mock_display_buffer);
+
+    EXPECT_CALL(mock_gl, glClear(_)).Times(0);
+    renderer.render({fullscreen});
+}
+
+TEST_F(GLRenderer, clears_only_what_opaque_renderables_leave_uncovered)
+{
+    int const screen_width = 1920;
+    int const screen_height = 1080;
+    mir::geometry::Rectangle const view_area{{0,0}, {1920,1080}};
+
+    ON_CALL(mock_egl, eglQuerySurface(_,_,EGL_WIDTH,_))
+        .WillByDefault(DoAll(SetArgPointee<3>(screen_width),
+                             Return(EGL_TRUE)));
+    ON_CALL(mock_egl, eglQuerySurface(_,_,EGL_HEIGHT,_))
+        .WillByDefault(DoAll(SetArgPointee<3>(screen_height),
+                             Return(EGL_TRUE)));
+    ON_CALL(mock_display_buffer, view_area())
+        .WillByDefault(Return(view_area));
+
+    auto const left = std::make_shared<testing::NiceMock<mtd::MockRenderable>>();
+    ON_CALL(*left, buffer()).WillByDefault(Return(mock_buffer));
+    ON_CALL(*left, shaped()).WillByDefault(Return(false));
+    ON_CALL(*left, transformation()).WillByDefault(Return(glm::mat4(1)));
+    ON_CALL(*left, screen_position()).WillByDefault(Return(mir::geometry::Rectangle{{0,0}, {1000,1080}}));
+
+    mrg::Renderer renderer(mock_display_buffer);
+
+    {
+        InSequence seq;
+        EXPECT_CALL(mock_gl, glEnable(GL_SCISSOR_TEST));
+        EXPECT_CALL(mock_gl, glScissor(1000, 0, 920, 1080));
+        EXPECT_CALL(mock_gl, glClear(GL_COLOR_BUFFER_BIT));
+        EXPECT_CALL(mock_gl, glDisable(GL_SCISSOR_TEST));
+    }
+    renderer.render({left});
+}
+
+TEST_F(GLRenderer, skips_clear_when_an_opaque_region_covers_the_viewport_in_pieces)
+{
+    int const screen_width = 1920;
+    int const screen_height = 1080;
+    mir::geometry::Rectangle const view_area{{0,0}, {1920,1080}};
+
+    ON_CALL(mock_egl, eglQuerySurface(_,_,EGL_WIDTH,_))
+        .WillByDefault(DoAll(SetArgPointee<3>(screen_width),
+                             Return(EGL_TRUE)));
+    ON_CALL(mock_egl, eglQuerySurface(_,_,EGL_HEIGHT,_))
+        .WillByDefault(DoAll(SetArgPointee<3>(screen_height),
+                             Return(EGL_TRUE)));
+    ON_CALL(mock_display_buffer, view_area())
+        .WillByDefault(Return(view_area));
+
+    auto const shaped = std::make_shared<testing::NiceMock<mtd::MockRenderable>>();
+    ON_CALL(*shaped, buffer()).WillByDefault(Return(mock_buffer));
+    ON_CALL(*shaped, shaped()).WillByDefault(Return(true));
+    ON_CALL(*shaped, transformation()).WillByDefault(Return(glm::mat4(1)));
+    ON_CALL(*shaped, screen_position()).WillByDefault(Return(view_area));
+    ON_CALL(*shaped, opaque_region()).WillByDefault(Return(mir::geometry::Rectangles{
+        {{0,0}, {1000,1080}},
+        {{900,0}, {1020,1080}}}));
+
+    mrg::Renderer renderer(mock_display_buffer);
+
+    EXPECT_CALL(mock_gl, glClear(_)).Times(0);
+    renderer.render({shaped});
+}
+
+TEST_F(GLRenderer, reports_gpu_time_once_the_gpu_has_measured_it)
+{
+    using func_ptr_t = mtd::MockEGL::generic_function_pointer_t;
+    ON_CALL(mock_gl, glGetString(GL_EXTENSIONS))
+        .WillByDefault(Return(reinterpret_cast<GLubyte const*>("GL_OES_EGL_image GL_EXT_disjoint_timer_query")));
+    ON_CALL(mock_egl, eglGetProcAddress(testing::StrEq("glGenQueriesEXT")))
+        .WillByDefault(Return(reinterpret_cast<func_ptr_t>(&stub_glGenQueriesEXT)));
+    ON_CALL(mock_egl, eglGetProcAddress(testing::StrEq("glDeleteQueriesEXT")))
+        .WillByDefault(Return(reinterpret_cast<func_ptr_t>(&stub_glDeleteQueriesEXT)));
+    ON_CALL(mock_egl, eglGetProcAddress(testing::StrEq("glBeginQueryEXT")))
+        .WillByDefault(Return(reinterpret_cast<func_ptr_t>(&stub_glQueryEXT)));
+    ON_CALL(mock_egl, eglGetProcAddress(testing::StrEq("glEndQueryEXT")))
+        .WillByDefault(Return(reinterpret_cast<func_ptr_t>(&stub_glEndQueryEXT)));
+    ON_CALL(mock_egl, eglGetProcAddress(testing::StrEq("glGetQueryObjectuivEXT")))
+        .WillByDefault(Return(reinterpret_cast<func_ptr_t>(&stub_glGetQueryObjectuivEXT)));
+    ON_CALL(mock_egl, eglGetProcAddress(testing::StrEq("glGetQueryObjectui64vEXT")))
+        .WillByDefault(Return(reinterpret_cast<func_ptr_t>(&stub_glGetQueryObjectui64vEXT)));
+
+    mrg::Renderer renderer(display_buffer);
+
+    renderer.render(renderable_list);
+    // The first frame's query is only read when the next frame starts
+    EXPECT_FALSE(renderer.gpu_render_time());
+
+    renderer.render(renderable_list);
+    EXPECT_THAT(renderer.gpu_render_time(), testing::Eq(std::chrono::nanoseconds{stub_gpu_time_ns}));
+    EXPECT_FALSE(renderer.gpu_render_time());
+}
+
+TEST_F(GLRenderer, has_no_gpu_time_without_timer_queries)
+{
+    mrg::Renderer renderer(display_buffer);
+
+    renderer.render(renderable_list);
+    renderer.render(renderable_list);
+
+    EXPECT_FALSE(renderer.gpu_render_time());
+}
+
+TEST_F(GLRenderer, draws_solid_color_buffers_from_a_uniform)
+{
+    auto const solid = std::make_shared<StubSolidColorBuffer>(std::array<float, 4>{0.25f, 0.5f, 0.75f, 1.0f});
+    EXPECT_CALL(*renderable, buffer()).WillRepeatedly(Return(solid));
+
+    EXPECT_CALL(mock_gl, glUniform4f(_, 0.25f, 0.5f, 0.75f, 1.0f));
+    EXPECT_CALL(mock_gl, glDrawArrays(_, _, _)).Times(AtLeast(1));
+
+    mrg::Renderer renderer(display_buffer);
+    renderer.render(renderable_list);
+}
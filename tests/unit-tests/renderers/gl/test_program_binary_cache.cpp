@@ -0,0 +1,174 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/renderers/gl/program_binary_cache.h"
+
+#include <mir/test/doubles/mock_gl.h>
+#include <mir/test/doubles/mock_egl.h>
+
+#include <boost/filesystem.hpp>
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <cstring>
+#include <system_error>
+#include <vector>
+
+namespace mtd = mir::test::doubles;
+namespace mrg = mir::renderer::gl;
+
+using namespace testing;
+
+namespace
+{
+GLenum const binary_format{0x1234};
+GLint const binary_length{4};
+char const binary[binary_length] = {'m', 'i', 'r', '!'};
+GLuint const loaded_program{7};
+
+std::vector<char> loaded_binary;
+GLenum loaded_format{0};
+
+void fake_glGetProgramBinaryOES(GLuint, GLsizei buf_size, GLsizei* length, GLenum* format, void* data)
+{
+    auto const size = std::min<GLsizei>(buf_size, binary_length);
+    std::memcpy(data, binary, size);
+    *length = size;
+    *format = binary_format;
+}
+
+void fake_glProgramBinaryOES(GLuint, GLenum format, void const* data, GLint length)
+{
+    auto const bytes = static_cast<char const*>(data);
+    loaded_binary.assign(bytes, bytes + length);
+    loaded_format = format;
+}
+
+char const* const vertex_shader{"vertex shader"};
+char const* const fragment_shader{"fragment shader"};
+
+struct ProgramBinaryCache : Test
+{
+    ProgramBinaryCache()
+    {
+        char tmp_name[] = "/tmp/mir_program_cache_XXXXXX";
+        if (!mkdtemp(tmp_name))
+            throw std::system_error{errno, std::system_category(), "Failed to create temporary directory"};
+        directory = tmp_name;
+
+        loaded_binary.clear();
+        loaded_format = 0;
+
+        using func_ptr_t = mtd::MockEGL::generic_function_pointer_t;
+        ON_CALL(mock_egl, eglGetProcAddress(StrEq("glGetProgramBinaryOES")))
+            .WillByDefault(Return(reinterpret_cast<func_ptr_t>(&fake_glGetProgramBinaryOES)));
+        ON_CALL(mock_egl, eglGetProcAddress(StrEq("glProgramBinaryOES")))
+            .WillByDefault(Return(reinterpret_cast<func_ptr_t>(&fake_glProgramBinaryOES)));
+
+        ON_CALL(mock_gl, glGetString(GL_EXTENSIONS))
+            .WillByDefault(Return(reinterpret_cast<GLubyte const*>("GL_OES_EGL_image GL_OES_get_program_binary")));
+        ON_CALL(mock_gl, glGetString(GL_VERSION))
+            .WillByDefault(Return(reinterpret_cast<GLubyte const*>("OpenGL ES 3.2 Mesa 21.0.0")));
+        ON_CALL(mock_gl, glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS_OES, _))
+            .WillByDefault(SetArgPointee<1>(1));
+        ON_CALL(mock_gl, glGetProgramiv(_, GL_PROGRAM_BINARY_LENGTH_OES, _))
+            .WillByDefault(SetArgPointee<2>(binary_length));
+        ON_CALL(mock_gl, glGetProgramiv(_, GL_LINK_STATUS, _))
+            .WillByDefault(SetArgPointee<2>(GL_TRUE));
+        ON_CALL(mock_gl, glCreateProgram())
+            .WillByDefault(Return(loaded_program));
+    }
+
+    ~ProgramBinaryCache()
+    {
+        boost::system::error_code ec;
+        boost::filesystem::remove_all(directory, ec);
+    }
+
+    NiceMock<mtd::MockGL> mock_gl;
+    NiceMock<mtd::MockEGL> mock_egl;
+    std::string directory;
+};
+}
+
+TEST_F(ProgramBinaryCache, loads_a_stored_program)
+{
+    mrg::ProgramBinaryCache const cache{directory};
+
+    cache.store(vertex_shader, fragment_shader, 3);
+
+    EXPECT_THAT(cache.load(vertex_shader, fragment_shader), Eq(loaded_program));
+    EXPECT_THAT(loaded_binary, ElementsAreArray(binary));
+    EXPECT_THAT(loaded_format, Eq(binary_format));
+}
+
+TEST_F(ProgramBinaryCache, keeps_programs_across_instances)
+{
+    mrg::ProgramBinaryCache{directory}.store(vertex_shader, fragment_shader, 3);
+
+    EXPECT_THAT(mrg::ProgramBinaryCache{directory}.load(vertex_shader, fragment_shader), Eq(loaded_program));
+}
+
+TEST_F(ProgramBinaryCache, misses_for_other_sources)
+{
+    mrg::ProgramBinaryCache const cache{directory};
+
+    cache.store(vertex_shader, fragment_shader, 3);
+
+    EXPECT_THAT(cache.load(vertex_shader, "another fragment shader"), Eq(0u));
+}
+
+TEST_F(ProgramBinaryCache, misses_after_a_driver_change)
+{
+    mrg::ProgramBinaryCache const cache{directory};
+
+    cache.store(vertex_shader, fragment_shader, 3);
+
+    ON_CALL(mock_gl, glGetString(GL_VERSION))
+        .WillByDefault(Return(reinterpret_cast<GLubyte const*>("OpenGL ES 3.2 Mesa 21.1.0")));
+
+    EXPECT_THAT(cache.load(vertex_shader, fragment_shader), Eq(0u));
+}
+
+TEST_F(ProgramBinaryCache, discards_binaries_the_driver_rejects)
+{
+    mrg::ProgramBinaryCache const cache{directory};
+
+    cache.store(vertex_shader, fragment_shader, 3);
+
+    EXPECT_CALL(mock_gl, glGetProgramiv(loaded_program, GL_LINK_STATUS, _))
+        .WillOnce(SetArgPointee<2>(GL_FALSE))
+        .WillRepeatedly(SetArgPointee<2>(GL_TRUE));
+    EXPECT_CALL(mock_gl, glDeleteProgram(loaded_program));
+
+    EXPECT_THAT(cache.load(vertex_shader, fragment_shader), Eq(0u));
+    EXPECT_THAT(cache.load(vertex_shader, fragment_shader), Eq(0u));
+}
+
+TEST_F(ProgramBinaryCache, does_nothing_without_driver_support)
+{
+    ON_CALL(mock_gl, glGetString(GL_EXTENSIONS))
+        .WillByDefault(Return(reinterpret_cast<GLubyte const*>("GL_OES_EGL_image")));
+
+    mrg::ProgramBinaryCache const cache{directory};
+
+    EXPECT_CALL(mock_gl, glGetProgramiv(_, GL_PROGRAM_BINARY_LENGTH_OES, _)).Times(0);
+    EXPECT_CALL(mock_gl, glCreateProgram()).Times(0);
+
+    cache.store(vertex_shader, fragment_shader, 3);
+    EXPECT_THAT(cache.load(vertex_shader, fragment_shader), Eq(0u));
+}
@@ -0,0 +1,240 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/renderers/software/renderer.h"
+#include "src/renderers/software/blend.h"
+#include "mir/renderer/sw/render_target.h"
+#include "mir/graphics/display_buffer.h"
+#include "mir/graphics/buffer_properties.h"
+#include "mir/geometry/region.h"
+
+#include "mir/test/doubles/fake_renderable.h"
+#include "mir/test/doubles/mock_display_buffer.h"
+#include "mir/test/doubles/stub_buffer.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <cstring>
+#include <vector>
+
+namespace mg = mir::graphics;
+namespace mrs = mir::renderer::software;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+
+using namespace testing;
+
+namespace
+{
+class MemoryDisplayBuffer :
+    public mg::DisplayBuffer,
+    public mg::NativeDisplayBuffer,
+    public mrs::RenderTarget
+{
+public:
+    explicit MemoryDisplayBuffer(geom::Rectangle const& area)
+        : area{area},
+          pixels(area.size.width.as_int() * area.size.height.as_int(), 0xdeadbeef)
+    {
+    }
+
+    auto view_area() const -> geom::Rectangle override { return area; }
+    bool overlay(mg::RenderableList&) override { return false; }
+    auto transformation() const -> glm::mat2 override { return glm::mat2{1}; }
+    auto native_display_buffer() -> mg::NativeDisplayBuffer* override { return this; }
+
+    auto map_framebuffer() -> std::unique_ptr<mrs::Mapping<unsigned char>> override
+    {
+        class PixelMapping : public mrs::Mapping<unsigned char>
+        {
+        public:
+            explicit PixelMapping(MemoryDisplayBuffer& owner) : owner{owner} {}
+
+            auto format() const -> MirPixelFormat override { return mir_pixel_format_xrgb_8888; }
+            auto stride() const -> geom::Stride override
+            {
+                return geom::Stride{owner.area.size.width.as_int() * 4};
+            }
+            auto size() const -> geom::Size override { return owner.area.size; }
+            auto data() -> unsigned char* override
+            {
+                return reinterpret_cast<unsigned char*>(owner.pixels.data());
+            }
+            auto len() const -> size_t override { return owner.pixels.size() * 4; }
+
+        private:
+            MemoryDisplayBuffer& owner;
+        };
+        return std::make_unique<PixelMapping>(*this);
+    }
+
+    void post(geom::Rectangles const& damage) override
+    {
+        posted_damage.push_back(damage);
+    }
+
+    auto pixel(int x, int y) const -> std::uint32_t
+    {
+        return pixels[y * area.size.width.as_int() + x];
+    }
+
+    geom::Rectangle const area;
+    std::vector<std::uint32_t> pixels;
+    std::vector<geom::Rectangles> posted_damage;
+};
+
+auto solid_buffer(geom::Size size, MirPixelFormat format, std::uint32_t colour) -> std::shared_ptr<mtd::StubBuffer>
+{
+    auto const buffer = std::make_shared<mtd::StubBuffer>(
+        mg::BufferProperties{size, format, mg::BufferUsage::software});
+    std::vector<std::uint32_t> content(size.width.as_int() * size.height.as_int(), colour);
+    buffer->write(reinterpret_cast<unsigned char const*>(content.data()), content.size() * 4);
+    return buffer;
+}
+
+auto renderable(geom::Rectangle position, std::shared_ptr<mg::Buffer> const& buffer, float alpha = 1.0f)
+    -> std::shared_ptr<mtd::FakeRenderable>
+{
+    auto const result = std::make_shared<mtd::FakeRenderable>(position, alpha);
+    result->set_buffer(buffer);
+    return result;
+}
+
+struct SoftwareRenderer : Test
+{
+    MemoryDisplayBuffer display_buffer{{{0, 0}, {8, 8}}};
+    mrs::Renderer renderer{display_buffer};
+};
+}
+
+TEST_F(SoftwareRenderer, clears_and_draws_buffers_at_their_screen_position)
+{
+    renderer.render({renderable({{2, 3}, {4, 2}}, solid_buffer({4, 2}, mir_pixel_format_xrgb_8888, 0x00112233))});
+
+    EXPECT_THAT(display_buffer.pixel(0, 0), Eq(0x00000000u));
+    EXPECT_THAT(display_buffer.pixel(2, 3), Eq(0xff112233u));
+    EXPECT_THAT(display_buffer.pixel(5, 4), Eq(0xff112233u));
+    EXPECT_THAT(display_buffer.pixel(6, 4), Eq(0x00000000u));
+    EXPECT_THAT(display_buffer.pixel(2, 5), Eq(0x00000000u));
+}
+
+TEST_F(SoftwareRenderer, blends_translucent_buffers_over_those_below)
+{
+    renderer.render({
+        renderable({{0, 0}, {8, 8}}, solid_buffer({8, 8}, mir_pixel_format_xrgb_8888, 0x000000ff)),
+        renderable({{0, 0}, {8, 8}}, solid_buffer({8, 8}, mir_pixel_format_argb_8888, 0x80800000)),
+        renderable({{0, 0}, {1, 1}}, solid_buffer({1, 1}, mir_pixel_format_xrgb_8888, 0x00ffffff), 0.0f)});
+
+    EXPECT_THAT(display_buffer.pixel(0, 0), Eq(0xff80007fu));
+    EXPECT_THAT(display_buffer.pixel(7, 7), Eq(0xff80007fu));
+}
+
+TEST_F(SoftwareRenderer, applies_renderable_alpha)
+{
+    renderer.render({renderable({{0, 0}, {8, 8}}, solid_buffer({8, 8}, mir_pixel_format_xrgb_8888, 0x00ffffff), 0.5f)});
+
+    EXPECT_THAT(display_buffer.pixel(3, 3), Eq(0x80808080u));
+}
+
+TEST_F(SoftwareRenderer, only_repaints_and_posts_damage)
+{
+    renderer.render({});
+    display_buffer.pixels.assign(display_buffer.pixels.size(), 0xdeadbeef);
+
+    renderer.set_damage(geom::Rectangles{{{1, 1}, {2, 2}}});
+    renderer.render({renderable({{0, 0}, {8, 8}}, solid_buffer({8, 8}, mir_pixel_format_xrgb_8888, 0x00123456))});
+
+    EXPECT_THAT(display_buffer.pixel(1, 1), Eq(0xff123456u));
+    EXPECT_THAT(display_buffer.pixel(2, 2), Eq(0xff123456u));
+    EXPECT_THAT(display_buffer.pixel(0, 0), Eq(0xdeadbeefu));
+    EXPECT_THAT(display_buffer.pixel(3, 3), Eq(0xdeadbeefu));
+    ASSERT_THAT(display_buffer.posted_damage.size(), Eq(2u));
+    EXPECT_THAT(display_buffer.posted_damage.back(), Eq(geom::Rectangles{{{1, 1}, {2, 2}}}));
+
+    // Damage applies to a single frame
+    renderer.render({});
+    EXPECT_THAT(display_buffer.pixel(0, 0), Eq(0x00000000u));
+}
+
+TEST_F(SoftwareRenderer, repaints_separate_damage_separately)
+{
+    renderer.render({});
+    display_buffer.pixels.assign(display_buffer.pixels.size(), 0xdeadbeef);
+
+    renderer.set_damage(geom::Rectangles{{{0, 0}, {2, 2}}, {{1, 1}, {2, 2}}, {{6, 6}, {2, 2}}});
+    renderer.render({renderable({{0, 0}, {8, 8}}, solid_buffer({8, 8}, mir_pixel_format_argb_8888, 0x80800000))});
+
+    // Overlapping damage is blended only once
+    EXPECT_THAT(display_buffer.pixel(1, 1), Eq(0x80800000u));
+    EXPECT_THAT(display_buffer.pixel(2, 2), Eq(0x80800000u));
+    EXPECT_THAT(display_buffer.pixel(7, 7), Eq(0x80800000u));
+    // ...and nothing between the damaged areas is repainted
+    EXPECT_THAT(display_buffer.pixel(4, 4), Eq(0xdeadbeefu));
+    EXPECT_THAT(display_buffer.pixel(2, 0), Eq(0xdeadbeefu));
+
+    EXPECT_THAT(
+        geom::Region{display_buffer.posted_damage.back()},
+        Eq(geom::Region{{{0, 0}, {2, 2}}, {{1, 1}, {2, 2}}, {{6, 6}, {2, 2}}}));
+}
+
+TEST_F(SoftwareRenderer, draws_relative_to_the_viewport)
+{
+    renderer.set_viewport({{100, 100}, {8, 8}});
+    renderer.render({renderable({{101, 102}, {1, 1}}, solid_buffer({1, 1}, mir_pixel_format_xrgb_8888, 0x00abcdef))});
+
+    EXPECT_THAT(display_buffer.pixel(1, 2), Eq(0xffabcdefu));
+    EXPECT_THAT(display_buffer.pixel(0, 0), Eq(0x00000000u));
+}
+
+TEST_F(SoftwareRenderer, scales_buffers_to_their_screen_size)
+{
+    auto const buffer = std::make_shared<mtd::StubBuffer>(
+        mg::BufferProperties{{2, 1}, mir_pixel_format_xrgb_8888, mg::BufferUsage::software});
+    std::uint32_t const content[]{0x00000011, 0x00000022};
+    buffer->write(reinterpret_cast<unsigned char const*>(content), sizeof content);
+
+    renderer.render({renderable({{0, 0}, {4, 2}}, buffer)});
+
+    EXPECT_THAT(display_buffer.pixel(1, 1), Eq(0xff000011u));
+    EXPECT_THAT(display_buffer.pixel(2, 0), Eq(0xff000022u));
+    EXPECT_THAT(display_buffer.pixel(3, 1), Eq(0xff000022u));
+}
+
+TEST_F(SoftwareRenderer, throws_for_display_buffers_the_cpu_cannot_draw_into)
+{
+    NiceMock<mtd::MockDisplayBuffer> gpu_only_display_buffer;
+
+    EXPECT_THROW({ mrs::Renderer{gpu_only_display_buffer}; }, std::runtime_error);
+}
+
+TEST(SoftwareBlend, vector_and_scalar_paths_agree)
+{
+    // Long enough to use any vector path, with a remainder for the scalar one
+    std::vector<std::uint32_t> src(11), dst_vector(11), dst_scalar(11);
+    for (auto i = 0u; i != src.size(); ++i)
+    {
+        auto const a = (i * 37) & 0xff;
+        src[i] = a << 24 | (a / 2) << 16 | (a / 3) << 8 | (a / 4);
+        dst_vector[i] = dst_scalar[i] = 0xff000000 | (i * 0x00152637);
+    }
+
+    mrs::blend_span(dst_vector.data(), src.data(), src.size(), 200, false);
+    for (auto i = 0u; i != src.size(); ++i)
+        mrs::blend_span(&dst_scalar[i], &src[i], 1, 200, false);
+
+    EXPECT_THAT(dst_vector, ContainerEq(dst_scalar));
+}
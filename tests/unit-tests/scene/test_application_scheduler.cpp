@@ -0,0 +1,177 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "src/server/scene/application_scheduler.h"
+
+#include "mir/scene/surface_observer.h"
+#include "mir/test/doubles/mock_scene_session.h"
+#include "mir/test/doubles/mock_surface.h"
+#include "mir/test/fake_shared.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+namespace ms = mir::scene;
+namespace mt = mir::test;
+namespace mtd = mir::test::doubles;
+
+using namespace testing;
+
+namespace
+{
+std::string const focused_cgroup{"/sys/fs/cgroup/focused"};
+std::string const visible_cgroup{"/sys/fs/cgroup/visible"};
+std::string const hidden_cgroup{"/sys/fs/cgroup/hidden"};
+
+struct MockMoveProcess
+{
+    MOCK_METHOD2(move, void(pid_t pid, std::string const& cgroup));
+};
+
+struct ApplicationScheduler : Test
+{
+    ApplicationScheduler()
+    {
+        ON_CALL(session_one, process_id()).WillByDefault(Return(pid_one));
+        ON_CALL(session_two, process_id()).WillByDefault(Return(pid_two));
+        ON_CALL(surface, add_observer(_)).WillByDefault(SaveArg<0>(&surface_observer));
+    }
+
+    void expose(bool exposed)
+    {
+        surface_observer->attrib_changed(
+            &surface,
+            mir_window_attrib_visibility,
+            exposed ? mir_window_visibility_exposed : mir_window_visibility_occluded);
+    }
+
+    pid_t const pid_one{1001};
+    pid_t const pid_two{1002};
+    NiceMock<mtd::MockSceneSession> session_one;
+    NiceMock<mtd::MockSceneSession> session_two;
+    NiceMock<mtd::MockSurface> surface;
+    std::shared_ptr<ms::SurfaceObserver> surface_observer;
+    NiceMock<MockMoveProcess> mover;
+
+    ms::ApplicationScheduler scheduler{
+        {focused_cgroup, visible_cgroup, hidden_cgroup},
+        [this](pid_t pid, std::string const& cgroup) { mover.move(pid, cgroup); }};
+};
+}
+
+TEST(ApplicationScheduling, parses_cgroups_for_each_kind_of_client)
+{
+    auto const scheduling = ms::parse_application_scheduling("focused=/a visible=/b  hidden=/c");
+
+    EXPECT_THAT(scheduling.focused, Eq("/a"));
+    EXPECT_THAT(scheduling.visible, Eq("/b"));
+    EXPECT_THAT(scheduling.hidden, Eq("/c"));
+    EXPECT_THAT(ms::parse_application_scheduling("hidden=/c").focused, IsEmpty());
+}
+
+TEST(ApplicationScheduling, rejects_malformed_settings)
+{
+    EXPECT_THROW(ms::parse_application_scheduling("focused"), std::invalid_argument);
+    EXPECT_THROW(ms::parse_application_scheduling("focused=relative"), std::invalid_argument);
+    EXPECT_THROW(ms::parse_application_scheduling("minimised=/a"), std::invalid_argument);
+}
+
+TEST_F(ApplicationScheduler, starting_client_is_hidden)
+{
+    EXPECT_CALL(mover, move(pid_one, hidden_cgroup));
+
+    scheduler.starting(mt::fake_shared(session_one));
+}
+
+TEST_F(ApplicationScheduler, focus_moves_client_into_focused_cgroup_and_back_out)
+{
+    scheduler.starting(mt::fake_shared(session_one));
+    scheduler.starting(mt::fake_shared(session_two));
+
+    InSequence seq;
+    EXPECT_CALL(mover, move(pid_one, focused_cgroup));
+    EXPECT_CALL(mover, move(pid_one, hidden_cgroup));
+    EXPECT_CALL(mover, move(pid_two, focused_cgroup));
+    EXPECT_CALL(mover, move(pid_two, hidden_cgroup));
+
+    scheduler.focused(mt::fake_shared(session_one));
+    scheduler.focused(mt::fake_shared(session_two));
+    scheduler.unfocused();
+}
+
+TEST_F(ApplicationScheduler, client_with_exposed_surface_is_visible_until_occluded)
+{
+    scheduler.starting(mt::fake_shared(session_one));
+    scheduler.surface_created(session_one, mt::fake_shared(surface));
+    ASSERT_THAT(surface_observer, NotNull());
+
+    InSequence seq;
+    EXPECT_CALL(mover, move(pid_one, visible_cgroup));
+    EXPECT_CALL(mover, move(pid_one, hidden_cgroup));
+
+    expose(true);
+    expose(false);
+}
+
+TEST_F(ApplicationScheduler, only_moves_client_when_its_kind_changes)
+{
+    scheduler.starting(mt::fake_shared(session_one));
+    scheduler.surface_created(session_one, mt::fake_shared(surface));
+    scheduler.focused(mt::fake_shared(session_one));
+
+    EXPECT_CALL(mover, move(_, _)).Times(0);
+
+    expose(true);
+    scheduler.focused(mt::fake_shared(session_one));
+    expose(false);
+}
+
+TEST_F(ApplicationScheduler, destroying_last_exposed_surface_hides_client)
+{
+    scheduler.starting(mt::fake_shared(session_one));
+    scheduler.surface_created(session_one, mt::fake_shared(surface));
+    expose(true);
+
+    EXPECT_CALL(mover, move(pid_one, hidden_cgroup));
+
+    scheduler.destroying_surface(session_one, mt::fake_shared(surface));
+}
+
+TEST_F(ApplicationScheduler, never_moves_the_server_itself)
+{
+    ON_CALL(session_one, process_id()).WillByDefault(Return(getpid()));
+
+    EXPECT_CALL(mover, move(_, _)).Times(0);
+
+    scheduler.starting(mt::fake_shared(session_one));
+    scheduler.focused(mt::fake_shared(session_one));
+}
+
+TEST_F(ApplicationScheduler, leaves_client_where_it_is_when_its_kind_has_no_cgroup)
+{
+    ms::ApplicationScheduler focus_only{
+        {focused_cgroup, {}, {}},
+        [this](pid_t pid, std::string const& cgroup) { mover.move(pid, cgroup); }};
+
+    InSequence seq;
+    EXPECT_CALL(mover, move(pid_one, focused_cgroup));
+    EXPECT_CALL(mover, move(_, _)).Times(0);
+
+    focus_only.starting(mt::fake_shared(session_one));
+    focus_only.focused(mt::fake_shared(session_one));
+    focus_only.unfocused();
+}
@@ -82,6 +82,10 @@ public:
     MOCK_METHOD2(take_snapshot_of,
                 void(std::shared_ptr<mc::BufferStream> const&,
                      ms::SnapshotCallback const&));
+    MOCK_METHOD3(take_thumbnail_of,
+                void(std::shared_ptr<mc::BufferStream> const&,
+                     geom::Size const&,
+                     ms::SnapshotCallback const&));
 };
 
 struct MockSnapshotCallback
@@ -127,6 +131,12 @@ struct StubSurfaceStack : public msh::SurfaceStack
     {
         return std::shared_ptr<ms::Surface>{};
     }
+    void begin_transaction() override
+    {
+    }
+    void end_transaction() override
+    {
+    }
 };
 
 struct ApplicationSession : public testing::Test
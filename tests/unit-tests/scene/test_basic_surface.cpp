@@ -274,6 +274,63 @@ TEST_F(BasicSurfaceTest, resize_notifications_only_sent_when_size_changed)
     surface.resize(new_size);
 }
 
+TEST_F(BasicSurfaceTest, batched_changes_notify_only_the_final_value_at_the_end)
+{
+    using namespace testing;
+
+    geom::Size const first_size{34, 56};
+    geom::Size const final_size{78, 90};
+    NiceMock<MockSurfaceObserver> mock_surface_observer;
+    surface.add_observer(mt::fake_shared(mock_surface_observer));
+
+    surface.begin_batched_changes();
+
+    EXPECT_CALL(mock_surface_observer, window_resized_to(_, _)).Times(0);
+    surface.resize(first_size);
+    surface.resize(final_size);
+    Mock::VerifyAndClearExpectations(&mock_surface_observer);
+
+    EXPECT_CALL(mock_surface_observer, window_resized_to(_, final_size)).Times(1);
+    surface.end_batched_changes();
+}
+
+TEST_F(BasicSurfaceTest, batched_changes_are_notified_in_the_order_first_made)
+{
+    using namespace testing;
+
+    NiceMock<MockSurfaceObserver> mock_surface_observer;
+    surface.add_observer(mt::fake_shared(mock_surface_observer));
+
+    InSequence seq;
+    EXPECT_CALL(mock_surface_observer, renamed(_, StrEq("second")));
+    EXPECT_CALL(mock_surface_observer, hidden_set_to(_, true));
+
+    surface.begin_batched_changes();
+    surface.rename("first");
+    surface.hide();
+    surface.rename("second");
+    surface.end_batched_changes();
+}
+
+TEST_F(BasicSurfaceTest, nested_batches_notify_at_the_outermost_end)
+{
+    using namespace testing;
+
+    NiceMock<MockSurfaceObserver> mock_surface_observer;
+    surface.add_observer(mt::fake_shared(mock_surface_observer));
+
+    surface.begin_batched_changes();
+    surface.begin_batched_changes();
+    surface.hide();
+
+    EXPECT_CALL(mock_surface_observer, hidden_set_to(_, _)).Times(0);
+    surface.end_batched_changes();
+    Mock::VerifyAndClearExpectations(&mock_surface_observer);
+
+    EXPECT_CALL(mock_surface_observer, hidden_set_to(_, true)).Times(1);
+    surface.end_batched_changes();
+}
+
 TEST_F(BasicSurfaceTest, only_content_is_notified_of_resize_when_frame_geometry_set)
 {
     using namespace testing;
@@ -659,6 +716,28 @@ TEST_F(BasicSurfaceTest, disables_input_when_setting_input_region_with_empty_rec
     EXPECT_FALSE(surface.input_area_contains(rect.top_left));
 }
 
+TEST_F(BasicSurfaceTest, input_region_outside_surface_is_hit)
+{
+    // As with a subsurface that sticks out past its parent
+    geom::Rectangle const local_input_region{{-10, -10}, {5, 5}};
+    surface.set_input_region({local_input_region});
+
+    EXPECT_TRUE(surface.input_area_contains(rect.top_left + geom::Displacement{-8, -8}));
+    EXPECT_FALSE(surface.input_area_contains(rect.top_left));
+}
+
+TEST_F(BasicSurfaceTest, input_area_follows_surface_when_moved)
+{
+    geom::Point const new_top_left{100, 200};
+
+    surface.move_to(new_top_left);
+
+    EXPECT_FALSE(surface.input_area_contains(rect.top_left));
+    EXPECT_TRUE(surface.input_area_contains(new_top_left));
+    EXPECT_TRUE(surface.input_area_contains(new_top_left + as_displacement(rect.size) - geom::Displacement{1, 1}));
+    EXPECT_FALSE(surface.input_area_contains(new_top_left + as_displacement(rect.size)));
+}
+
 TEST_F(BasicSurfaceTest, adjusts_default_input_region_for_frame_geometry)
 {
     geom::DeltaY const top{3};
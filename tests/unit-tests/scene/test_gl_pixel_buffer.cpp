@@ -225,3 +225,73 @@ TEST_F(GLPixelBufferTest, returns_data_from_rgba_buffer_texture)
     EXPECT_EQ(width - 1,
               static_cast<uint32_t const*>(data)[width * height - 1]);
 }
+
+TEST_F(GLPixelBufferTest, converts_every_pixel_from_rgba_buffer_texture)
+{
+    using namespace testing;
+    uint32_t const width{mock_buffer.size().width.as_uint32_t()};
+    uint32_t const height{mock_buffer.size().height.as_uint32_t()};
+
+    EXPECT_CALL(mock_gl, glGetError())
+        .WillOnce(Return(GL_NO_ERROR))
+        .WillOnce(Return(GL_INVALID_ENUM));
+    EXPECT_CALL(mock_gl, glReadPixels(0, 0, width, height, GL_BGRA_EXT, GL_UNSIGNED_BYTE, _));
+    EXPECT_CALL(mock_gl, glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, _))
+        .WillOnce(FillPixelsRGBA());
+
+    ms::GLPixelBuffer pixels{std::move(context)};
+
+    pixels.fill_from(mock_buffer);
+    auto const data = static_cast<uint32_t const*>(pixels.as_argb_8888());
+
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            ASSERT_THAT(data[(height - y - 1) * width + x], Eq(y * width + x)) << "x=" << x << ", y=" << y;
+        }
+    }
+}
+
+TEST_F(GLPixelBufferTest, does_not_retry_bgra_once_found_unsupported)
+{
+    using namespace testing;
+
+    EXPECT_CALL(mock_gl, glGetError())
+        .WillOnce(Return(GL_NO_ERROR))
+        .WillOnce(Return(GL_INVALID_ENUM))
+        .WillRepeatedly(Return(GL_NO_ERROR));
+    EXPECT_CALL(mock_gl, glReadPixels(_, _, _, _, GL_BGRA_EXT, _, _))
+        .Times(1);
+    EXPECT_CALL(mock_gl, glReadPixels(_, _, _, _, GL_RGBA, _, _))
+        .Times(2);
+
+    ms::GLPixelBuffer pixels{std::move(context)};
+
+    pixels.fill_from(mock_buffer);
+    pixels.fill_from(mock_buffer);
+}
+
+TEST_F(GLPixelBufferTest, scaled_fill_reads_back_only_the_requested_size)
+{
+    using namespace testing;
+    geom::Size const thumbnail_size{17, 23};
+
+    ON_CALL(mock_gl, glGetShaderiv(_, GL_COMPILE_STATUS, _))
+        .WillByDefault(SetArgPointee<2>(GL_TRUE));
+    ON_CALL(mock_gl, glGetProgramiv(_, GL_LINK_STATUS, _))
+        .WillByDefault(SetArgPointee<2>(GL_TRUE));
+
+    EXPECT_CALL(mock_gl, glDrawArrays(GL_TRIANGLE_STRIP, 0, 4));
+    EXPECT_CALL(mock_gl, glReadPixels(0, 0, 17, 23, GL_BGRA_EXT, GL_UNSIGNED_BYTE, _))
+        .WillOnce(FillPixels());
+    EXPECT_CALL(mock_gl, glReadPixels(_, _, 51, 71, _, _, _))
+        .Times(0);
+
+    ms::GLPixelBuffer pixels{std::move(context)};
+
+    pixels.fill_scaled_from(mock_buffer, thumbnail_size);
+
+    EXPECT_EQ(thumbnail_size, pixels.size());
+    EXPECT_EQ(geom::Stride{17 * 4}, pixels.stride());
+}
@@ -39,6 +39,10 @@ struct MockBufferCallback
 {
     MOCK_METHOD1(invoke, void(int));
 };
+struct MockDamageCallback
+{
+    MOCK_METHOD2(invoke, void(int, mir::geometry::Rectangle const&));
+};
 
 struct LegacySceneChangeNotificationTest : public testing::Test
 {
@@ -49,8 +53,11 @@ struct LegacySceneChangeNotificationTest : public testing::Test
     }
     testing::NiceMock<MockSceneCallback> scene_callback;
     testing::NiceMock<MockBufferCallback> buffer_callback;
+    testing::NiceMock<MockDamageCallback> damage_callback;
     std::function<void(int)> buffer_change_callback{[this](int arg){buffer_callback.invoke(arg);}};
     std::function<void()> scene_change_callback{[this](){scene_callback.invoke();}};
+    std::function<void(int, mir::geometry::Rectangle const&)> damage_change_callback{
+        [this](int frames, mir::geometry::Rectangle const& damage){damage_callback.invoke(frames, damage);}};
     std::shared_ptr<testing::NiceMock<mtd::MockSurface>> surface;
 }; 
 }
@@ -144,3 +151,63 @@ TEST_F(LegacySceneChangeNotificationTest, ending_observation_unregisters_observe
     // Verify that its not simply the destruction removing the observer...
     ::testing::Mock::VerifyAndClearExpectations(&observer);
 }
+
+TEST_F(LegacySceneChangeNotificationTest, reports_moves_as_damage_to_the_old_and_new_areas)
+{
+    using namespace ::testing;
+    using namespace mir::geometry;
+
+    std::shared_ptr<ms::SurfaceObserver> surface_observer;
+    EXPECT_CALL(*surface, add_observer(_)).Times(1)
+        .WillOnce(SaveArg<0>(&surface_observer));
+
+    surface->resize({100, 50});
+    surface->move_to({10, 10});
+
+    ms::LegacySceneChangeNotification observer(scene_change_callback, damage_change_callback);
+    observer.surface_added(surface);
+    Mock::VerifyAndClearExpectations(&scene_callback);
+
+    EXPECT_CALL(scene_callback, invoke()).Times(0);
+    EXPECT_CALL(damage_callback, invoke(1, Rectangle{{10, 10}, {100, 50}}));
+    EXPECT_CALL(damage_callback, invoke(1, Rectangle{{500, 10}, {100, 50}}));
+
+    surface_observer->moved_to(surface.get(), {500, 10});
+}
+
+TEST_F(LegacySceneChangeNotificationTest, reports_frames_as_damage_to_the_surface_area)
+{
+    using namespace ::testing;
+    using namespace mir::geometry;
+
+    std::shared_ptr<ms::SurfaceObserver> surface_observer;
+    EXPECT_CALL(*surface, add_observer(_)).Times(1)
+        .WillOnce(SaveArg<0>(&surface_observer));
+
+    surface->move_to({10, 10});
+
+    ms::LegacySceneChangeNotification observer(scene_change_callback, damage_change_callback);
+    observer.surface_added(surface);
+
+    EXPECT_CALL(damage_callback, invoke(2, Rectangle{{10, 10}, {64, 32}}));
+
+    surface_observer->frame_posted(surface.get(), 2, {64, 32});
+}
+
+TEST_F(LegacySceneChangeNotificationTest, moving_an_invisible_surface_damages_nothing)
+{
+    using namespace ::testing;
+
+    std::shared_ptr<ms::SurfaceObserver> surface_observer;
+    EXPECT_CALL(*surface, add_observer(_)).Times(1)
+        .WillOnce(SaveArg<0>(&surface_observer));
+    ON_CALL(*surface, visible()).WillByDefault(Return(false));
+
+    ms::LegacySceneChangeNotification observer(scene_change_callback, damage_change_callback);
+    observer.surface_added(surface);
+
+    EXPECT_CALL(scene_callback, invoke()).Times(0);
+    EXPECT_CALL(damage_callback, invoke(_, _)).Times(0);
+
+    surface_observer->moved_to(surface.get(), {500, 10});
+}
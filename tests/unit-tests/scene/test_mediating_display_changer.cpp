@@ -29,6 +29,7 @@
 #include "mir/test/doubles/stub_display_configuration.h"
 #include "mir/test/doubles/mock_scene_session.h"
 #include "mir/test/doubles/stub_session.h"
+#include "mir/test/doubles/null_display_sync_group.h"
 #include "mir/test/fake_shared.h"
 #include "mir/test/display_config_matchers.h"
 #include "mir/test/doubles/fake_alarm_factory.h"
@@ -74,6 +75,14 @@ struct MockDisplay : public mtd::MockDisplay
         return config->clone();
     }
 
+    void configure_incrementally(
+        mg::DisplayConfiguration const& conf,
+        std::function<void(mg::DisplaySyncGroup&)> const& release) override
+    {
+        for_each_display_sync_group(release);
+        configure(conf);
+    }
+
     std::unique_ptr<mg::DisplayConfiguration> config;
 };
 
@@ -144,7 +153,7 @@ TEST_F(MediatingDisplayChangerTest, returns_base_configuration_from_display_at_s
     EXPECT_THAT(*base_conf, mt::DisplayConfigMatches(std::ref(*mock_display.configuration())));
 }
 
-TEST_F(MediatingDisplayChangerTest, pauses_system_when_applying_new_configuration_for_focused_session_would_invalidate_display_buffers)
+TEST_F(MediatingDisplayChangerTest, recomposites_changed_outputs_when_applying_new_configuration_for_focused_session_would_invalidate_display_buffers)
 {
     using namespace testing;
     mtd::NullDisplayConfiguration conf;
@@ -153,12 +162,36 @@ TEST_F(MediatingDisplayChangerTest, pauses_system_when_applying_new_configuratio
     ON_CALL(mock_display, apply_if_configuration_preserves_display_buffers(_))
         .WillByDefault(Return(false));
 
+    EXPECT_CALL(mock_compositor, stop()).Times(0);
+    EXPECT_CALL(mock_compositor, start()).Times(0);
+
     InSequence s;
-    EXPECT_CALL(mock_compositor, stop());
 
     EXPECT_CALL(mock_display, configure(Ref(conf)));
 
-    EXPECT_CALL(mock_compositor, start());
+    EXPECT_CALL(mock_compositor, start_compositing_new_groups());
+
+    session_event_sink.handle_focus_change(session);
+    changer->configure(session,
+                       mt::fake_shared(conf));
+}
+
+TEST_F(MediatingDisplayChangerTest, stops_compositing_to_the_display_sync_groups_the_display_replaces)
+{
+    using namespace testing;
+    mtd::NullDisplayConfiguration conf;
+    mtd::StubDisplaySyncGroup replaced_group{geom::Size{1920, 1080}};
+    auto session = std::make_shared<mtd::StubSession>();
+
+    ON_CALL(mock_display, apply_if_configuration_preserves_display_buffers(_))
+        .WillByDefault(Return(false));
+    ON_CALL(mock_display, for_each_display_sync_group(_))
+        .WillByDefault(InvokeArgument<0>(ByRef(replaced_group)));
+
+    InSequence s;
+    EXPECT_CALL(mock_compositor, stop_compositing(Ref(replaced_group)));
+    EXPECT_CALL(mock_display, configure(Ref(conf)));
+    EXPECT_CALL(mock_compositor, start_compositing_new_groups());
 
     session_event_sink.handle_focus_change(session);
     changer->configure(session,
@@ -183,6 +216,35 @@ TEST_F(MediatingDisplayChangerTest, does_not_pause_system_when_applying_new_conf
                        mt::fake_shared(conf));
 }
 
+TEST_F(MediatingDisplayChangerTest, suspends_rather_than_stops_compositing_to_the_groups_the_display_powers_off)
+{
+    using namespace testing;
+    mtd::NullDisplayConfiguration conf;
+    mtd::StubDisplaySyncGroup powered_off{geom::Size{1920, 1080}};
+    mtd::StubDisplaySyncGroup powered_on{geom::Size{1280, 1024}};
+    auto session = std::make_shared<mtd::StubSession>();
+
+    EXPECT_CALL(mock_display, apply_if_configuration_only_changes_power_modes(Ref(conf), _, _))
+        .WillOnce(DoAll(
+            InvokeArgument<1>(ByRef(powered_off)),
+            InvokeArgument<2>(ByRef(powered_on)),
+            Return(true)));
+
+    EXPECT_CALL(mock_compositor, stop()).Times(0);
+    EXPECT_CALL(mock_compositor, stop_compositing(_)).Times(0);
+    EXPECT_CALL(mock_display, configure(_)).Times(0);
+    EXPECT_CALL(mock_display, apply_if_configuration_preserves_display_buffers(_)).Times(0);
+
+    InSequence s;
+    EXPECT_CALL(mock_compositor, suspend_compositing(Ref(powered_off)));
+    EXPECT_CALL(mock_compositor, resume_compositing(Ref(powered_on)));
+    EXPECT_CALL(mock_compositor, start_compositing_new_groups());
+
+    session_event_sink.handle_focus_change(session);
+    changer->configure(session,
+                       mt::fake_shared(conf));
+}
+
 TEST_F(MediatingDisplayChangerTest, sends_error_when_applying_new_configuration_for_focused_session_fails)
 {
     using namespace testing;
@@ -251,10 +313,9 @@ TEST_F(MediatingDisplayChangerTest, handles_hardware_change_when_display_buffers
 
     InSequence s;
     EXPECT_CALL(mock_conf_policy, apply_to(Ref(conf)));
-
-    EXPECT_CALL(mock_compositor, stop());
     EXPECT_CALL(mock_display, configure(Ref(conf)));
-    EXPECT_CALL(mock_compositor, start());
+
+    EXPECT_CALL(mock_compositor, start_compositing_new_groups());
 
     changer->configure_for_hardware_change(mt::fake_shared(conf));
 }
@@ -322,13 +383,9 @@ TEST_F(MediatingDisplayChangerTest, handles_hardware_change_when_display_buffers
     InSequence s;
     EXPECT_CALL(mock_conf_policy, apply_to(Ref(*conf)));
 
-    /*
-     * Currently we have to tear down and recreate the compositor in order to add
-     * a new output. This is not an inherent limitation, and we might do better later.
-     */
-    EXPECT_CALL(mock_compositor, stop()).Times(1);
+    // The compositor picks up the new output's display buffers once they're there
     EXPECT_CALL(mock_display, configure(Ref(*conf)));
-    EXPECT_CALL(mock_compositor, start()).Times(1);
+    EXPECT_CALL(mock_compositor, start_compositing_new_groups());
 
     changer->configure_for_hardware_change(conf);
 }
@@ -450,14 +507,10 @@ TEST_F(MediatingDisplayChangerTest, focusing_a_session_with_db_preserving_but_ou
     session_container.insert_session(session1);
     changer->configure(session1, conf);
 
-    /*
-     * Currently we have to tear down and recreate the compositor in order to add
-     * a new output. This is not an inherent limitation, and we might do better later.
-     */
+    // The compositor picks up the new output's display buffers once they're there
     InSequence s;
-    EXPECT_CALL(mock_compositor, stop()).Times(1);
     EXPECT_CALL(mock_display, configure(Ref(*conf)));
-    EXPECT_CALL(mock_compositor, start()).Times(1);
+    EXPECT_CALL(mock_compositor, start_compositing_new_groups());
 
     session_event_sink.handle_focus_change(session1);
 }
@@ -475,9 +528,8 @@ TEST_F(MediatingDisplayChangerTest, focusing_a_session_with_db_invalidating_atta
     changer->configure(session1, conf);
 
     InSequence s;
-    EXPECT_CALL(mock_compositor, stop());
     EXPECT_CALL(mock_display, configure(Ref(*conf)));
-    EXPECT_CALL(mock_compositor, start());
+    EXPECT_CALL(mock_compositor, start_compositing_new_groups());
 
     session_event_sink.handle_focus_change(session1);
 }
@@ -504,7 +556,7 @@ TEST_F(MediatingDisplayChangerTest, failure_to_apply_session_config_on_focus_sen
     session_event_sink.handle_focus_change(session1);
 }
 
-TEST_F(MediatingDisplayChangerTest, focusing_a_session_without_attached_config_applies_base_config_pausing_if_db_invalidated)
+TEST_F(MediatingDisplayChangerTest, focusing_a_session_without_attached_config_applies_base_config_recompositing_if_db_invalidated)
 {
     using namespace testing;
     auto conf = std::make_shared<mtd::NullDisplayConfiguration>();
@@ -523,9 +575,8 @@ TEST_F(MediatingDisplayChangerTest, focusing_a_session_without_attached_config_a
     Mock::VerifyAndClearExpectations(&mock_display);
 
     InSequence s;
-    EXPECT_CALL(mock_compositor, stop());
     EXPECT_CALL(mock_display, configure(mt::DisplayConfigMatches(std::cref(base_config))));
-    EXPECT_CALL(mock_compositor, start());
+    EXPECT_CALL(mock_compositor, start_compositing_new_groups());
 
     session_event_sink.handle_focus_change(session2);
 }
@@ -582,9 +633,8 @@ TEST_F(MediatingDisplayChangerTest, losing_focus_applies_base_config)
     Mock::VerifyAndClearExpectations(&mock_display);
 
     InSequence s;
-    EXPECT_CALL(mock_compositor, stop());
     EXPECT_CALL(mock_display, configure(mt::DisplayConfigMatches(std::cref(base_config))));
-    EXPECT_CALL(mock_compositor, start());
+    EXPECT_CALL(mock_compositor, start_compositing_new_groups());
 
     session_event_sink.handle_no_focus();
 }
@@ -1043,3 +1093,19 @@ TEST_F(MediatingDisplayChangerTest, all_sessions_get_notified_on_configuration_c
     EXPECT_THAT(*received_configuration, mt::DisplayConfigMatches(std::cref(*new_config)));
 }
 
+
+TEST_F(MediatingDisplayChangerTest, reports_the_last_frame_on_an_output_from_the_display)
+{
+    using namespace testing;
+
+    mg::Frame frame;
+    frame.msc = 42;
+    frame.ust = {CLOCK_MONOTONIC, std::chrono::nanoseconds{123456789}};
+
+    EXPECT_CALL(mock_display, last_frame_on(3u)).WillOnce(Return(frame));
+
+    auto const reported = changer->last_frame_on(3u);
+
+    EXPECT_THAT(reported.msc, Eq(42));
+    EXPECT_THAT(reported.ust, Eq(frame.ust));
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/scene/output_properties_cache.h"
+#include "mir/test/doubles/stub_display_configuration.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace ms = mir::scene;
+namespace mg = mir::graphics;
+namespace geom = mir::geometry;
+namespace mtd = mir::test::doubles;
+
+using namespace testing;
+
+namespace
+{
+geom::Rectangle const left_output{{0, 0}, {1920, 1080}};
+geom::Rectangle const right_output{{1920, 0}, {1920, 1080}};
+
+struct OutputPropertiesCache : Test
+{
+    OutputPropertiesCache()
+    {
+        cache.update_from(side_by_side);
+    }
+
+    mtd::StubDisplayConfig side_by_side{{left_output, right_output}};
+    ms::OutputPropertiesCache cache;
+};
+}
+
+TEST_F(OutputPropertiesCache, finds_nothing_before_the_first_configuration)
+{
+    ms::OutputPropertiesCache const empty;
+
+    EXPECT_THAT(empty.properties_for({{0, 0}, {100, 100}}), IsNull());
+}
+
+TEST_F(OutputPropertiesCache, finds_the_output_a_surface_is_on)
+{
+    auto const properties = cache.properties_for({{2000, 100}, {100, 100}});
+
+    ASSERT_THAT(properties, NotNull());
+    EXPECT_THAT(properties->extents, Eq(right_output));
+}
+
+TEST_F(OutputPropertiesCache, prefers_the_output_of_greatest_scale)
+{
+    side_by_side.outputs[1].scale = 2.0f;
+    cache.update_from(side_by_side);
+
+    auto const properties = cache.properties_for({{1900, 100}, {100, 100}});
+
+    ASSERT_THAT(properties, NotNull());
+    EXPECT_THAT(properties->scale, Eq(2.0f));
+}
+
+TEST_F(OutputPropertiesCache, keeps_the_previous_output_while_a_surface_moves_within_it)
+{
+    auto const previous = cache.properties_for({{100, 100}, {100, 100}});
+
+    EXPECT_THAT(cache.properties_for({{500, 500}, {100, 100}}, previous), Eq(previous));
+}
+
+TEST_F(OutputPropertiesCache, looks_again_when_a_surface_leaves_the_previous_output)
+{
+    auto const previous = cache.properties_for({{100, 100}, {100, 100}});
+
+    auto const properties = cache.properties_for({{1900, 100}, {100, 100}}, previous);
+    ASSERT_THAT(properties, NotNull());
+    EXPECT_THAT(properties->extents, Eq(left_output));
+
+    auto const moved = cache.properties_for({{2000, 100}, {100, 100}}, properties);
+    ASSERT_THAT(moved, NotNull());
+    EXPECT_THAT(moved->extents, Eq(right_output));
+}
+
+TEST_F(OutputPropertiesCache, looks_again_once_the_configuration_changes)
+{
+    auto const previous = cache.properties_for({{100, 100}, {100, 100}});
+
+    side_by_side.outputs[0].scale = 1.5f;
+    cache.update_from(side_by_side);
+
+    auto const properties = cache.properties_for({{500, 500}, {100, 100}}, previous);
+    ASSERT_THAT(properties, NotNull());
+    EXPECT_THAT(properties, Ne(previous));
+    EXPECT_THAT(properties->scale, Eq(1.5f));
+}
+
+TEST_F(OutputPropertiesCache, looks_again_within_an_output_that_overlaps_another)
+{
+    geom::Rectangle const overlapping_output{{1000, 0}, {1920, 1080}};
+    mtd::StubDisplayConfig overlapping{{left_output, overlapping_output}};
+    overlapping.outputs[1].scale = 2.0f;
+    cache.update_from(overlapping);
+
+    auto const previous = cache.properties_for({{100, 100}, {100, 100}});
+    ASSERT_THAT(previous, NotNull());
+    ASSERT_THAT(previous->extents, Eq(left_output));
+
+    auto const properties = cache.properties_for({{1500, 100}, {100, 100}}, previous);
+    ASSERT_THAT(properties, NotNull());
+    EXPECT_THAT(properties->extents, Eq(overlapping_output));
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/scene/scene_element_pool.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace ms = mir::scene;
+
+using namespace testing;
+
+namespace
+{
+struct Element
+{
+    explicit Element(int value) : value{value} {}
+    int value;
+};
+
+struct SceneElementPool : Test
+{
+    auto make_element(int value) -> std::shared_ptr<Element>
+    {
+        return std::allocate_shared<Element>(ms::SceneElementAllocator<Element>{pool}, value);
+    }
+
+    std::shared_ptr<ms::SceneElementPool> const pool{std::make_shared<ms::SceneElementPool>()};
+};
+}
+
+TEST_F(SceneElementPool, reuses_the_memory_of_released_elements)
+{
+    Element const* first_address;
+    {
+        auto const first = make_element(1);
+        first_address = first.get();
+    }
+
+    auto const second = make_element(2);
+
+    EXPECT_THAT(second.get(), Eq(first_address));
+    EXPECT_THAT(second->value, Eq(2));
+}
+
+TEST_F(SceneElementPool, live_elements_are_distinct)
+{
+    auto const first = make_element(1);
+    auto const second = make_element(2);
+
+    EXPECT_THAT(first.get(), Ne(second.get()));
+    EXPECT_THAT(first->value, Eq(1));
+    EXPECT_THAT(second->value, Eq(2));
+}
+
+TEST_F(SceneElementPool, elements_can_outlive_the_callers_reference_to_the_pool)
+{
+    auto pool_ref = std::make_shared<ms::SceneElementPool>();
+    auto const element = std::allocate_shared<Element>(ms::SceneElementAllocator<Element>{pool_ref}, 3);
+    pool_ref.reset();
+
+    EXPECT_THAT(element->value, Eq(3));
+}
+
+TEST_F(SceneElementPool, blocks_are_only_recycled_for_allocations_of_the_same_size)
+{
+    void const* recycled_block;
+    {
+        auto const element = make_element(1);
+        recycled_block = element.get();
+    }
+
+    auto const other = pool->allocate(1024);
+    EXPECT_THAT(other, Ne(recycled_block));
+    pool->deallocate(other, 1024);
+
+    EXPECT_THAT(make_element(2).get(), Eq(recycled_block));
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/scene/scene_trace.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <stdexcept>
+
+using namespace testing;
+
+namespace ms = mir::scene;
+namespace geom = mir::geometry;
+
+using Type = ms::SceneTraceEvent::Type;
+
+namespace
+{
+auto round_trip(ms::SceneTraceEvent const& event) -> ms::SceneTraceEvent
+{
+    return ms::parse_scene_trace_event(ms::to_string(event));
+}
+}
+
+TEST(SceneTrace, add_round_trips)
+{
+    ms::SceneTraceEvent event;
+    event.time = std::chrono::microseconds{1234};
+    event.type = Type::add;
+    event.surface = 3;
+    event.depth_layer = mir_depth_layer_above;
+    event.area = {{-10, 20}, {640, 480}};
+    event.format = mir_pixel_format_xrgb_8888;
+
+    auto const parsed = round_trip(event);
+
+    EXPECT_THAT(parsed.time, Eq(event.time));
+    EXPECT_THAT(parsed.type, Eq(Type::add));
+    EXPECT_THAT(parsed.surface, Eq(3));
+    EXPECT_THAT(parsed.depth_layer, Eq(mir_depth_layer_above));
+    EXPECT_THAT(parsed.area, Eq(event.area));
+    EXPECT_THAT(parsed.format, Eq(mir_pixel_format_xrgb_8888));
+}
+
+TEST(SceneTrace, order_round_trips_without_a_surface)
+{
+    ms::SceneTraceEvent event;
+    event.type = Type::order;
+    event.order = {4, 1, 7};
+
+    EXPECT_THAT(ms::to_string(event), Eq("0 order 4 1 7"));
+    EXPECT_THAT(round_trip(event).order, ElementsAre(4, 1, 7));
+}
+
+TEST(SceneTrace, frame_damage_round_trips)
+{
+    ms::SceneTraceEvent event;
+    event.type = Type::frame;
+    event.surface = 1;
+    event.area.size = {100, 50};
+    event.format = mir_pixel_format_argb_8888;
+    event.damage = geom::Rectangles{{{0, 0}, {10, 10}}, {{20, 30}, {5, 6}}};
+
+    auto const parsed = round_trip(event);
+
+    EXPECT_THAT(parsed.area.size, Eq(event.area.size));
+    ASSERT_TRUE(parsed.damage);
+    EXPECT_THAT(parsed.damage.value(), Eq(event.damage.value()));
+}
+
+TEST(SceneTrace, frame_without_damage_is_fully_damaged)
+{
+    ms::SceneTraceEvent event;
+    event.type = Type::frame;
+    event.surface = 1;
+    event.area.size = {100, 50};
+
+    EXPECT_FALSE(round_trip(event).damage);
+}
+
+TEST(SceneTrace, empty_damage_differs_from_no_damage)
+{
+    ms::SceneTraceEvent event;
+    event.type = Type::frame;
+    event.surface = 1;
+    event.damage = geom::Rectangles{};
+
+    auto const parsed = round_trip(event);
+
+    ASSERT_TRUE(parsed.damage);
+    EXPECT_THAT(parsed.damage.value().size(), Eq(0u));
+}
+
+TEST(SceneTrace, unknown_event_throws)
+{
+    EXPECT_THROW(ms::parse_scene_trace_event("10 explode 1"), std::runtime_error);
+}
+
+TEST(SceneTrace, truncated_event_throws)
+{
+    EXPECT_THROW(ms::parse_scene_trace_event("10 move 1 5"), std::runtime_error);
+    EXPECT_THROW(ms::parse_scene_trace_event("10 frame 1 5 5 0 2 0 0 1 1"), std::runtime_error);
+}
+
+TEST(SceneTrace, reads_trace_skipping_comments_and_blank_lines)
+{
+    std::istringstream in{
+        std::string{ms::scene_trace_header} + "\n"
+        "# recorded on a laptop\n"
+        "0 add 1 0 0 0 10 10 0\n"
+        "\n"
+        "5 visible 1 0\n"};
+
+    auto const events = ms::read_scene_trace(in);
+
+    ASSERT_THAT(events.size(), Eq(2u));
+    EXPECT_THAT(events[0].type, Eq(Type::add));
+    EXPECT_THAT(events[1].type, Eq(Type::visible));
+    EXPECT_FALSE(events[1].visible);
+}
+
+TEST(SceneTrace, rejects_trace_without_header)
+{
+    std::istringstream in{"0 add 1 0 0 0 10 10 0\n"};
+
+    EXPECT_THROW(ms::read_scene_trace(in), std::runtime_error);
+}
+
+TEST(SceneTrace, malformed_line_error_names_the_line)
+{
+    std::istringstream in{
+        std::string{ms::scene_trace_header} + "\n"
+        "0 add 1 0 0 0 10 10 0\n"
+        "5 resize 1\n"};
+
+    try
+    {
+        ms::read_scene_trace(in);
+        FAIL() << "Expected a malformed trace to throw";
+    }
+    catch (std::runtime_error const& error)
+    {
+        EXPECT_THAT(error.what(), HasSubstr("line 3"));
+    }
+}
@@ -149,6 +149,7 @@ struct SurfaceStack : public ::testing::Test
     std::shared_ptr<ms::SceneReport> const report = mr::null_scene_report();
     ms::SurfaceStack stack{report};
     void const* compositor_id{&default_params};
+    geom::Rectangle const everywhere{{-10000, -10000}, {20000, 20000}};
 };
 
 }
@@ -177,7 +178,7 @@ TEST_F(SurfaceStack, stacking_order)
     stack.add_surface(stub_surface3, default_params.input_mode);
 
     EXPECT_THAT(
-        stack.scene_elements_for(compositor_id),
+        stack.scene_elements_for(compositor_id, everywhere),
         ElementsAre(
             SceneElementForStream(stub_buffer_stream1),
             SceneElementForStream(stub_buffer_stream2),
@@ -208,7 +209,7 @@ TEST_F(SurfaceStack, stacking_order_with_multiple_buffer_streams)
     stack.add_surface(stub_surface3, default_params.input_mode);
 
     EXPECT_THAT(
-        stack.scene_elements_for(compositor_id),
+        stack.scene_elements_for(compositor_id, everywhere),
         ElementsAre(
             SceneElementForStream(stub_buffer_stream1),
             SceneElementForStream(stub_stream0),
@@ -228,12 +229,46 @@ TEST_F(SurfaceStack, scene_snapshot_omits_invisible_surfaces)
     stack.add_surface(stub_surface2, default_params.input_mode);
 
     EXPECT_THAT(
-        stack.scene_elements_for(compositor_id),
+        stack.scene_elements_for(compositor_id, everywhere),
         ElementsAre(
             SceneElementForStream(stub_buffer_stream1),
             SceneElementForStream(stub_buffer_stream2)));
 }
 
+TEST_F(SurfaceStack, scene_snapshot_follows_changes_to_the_stack)
+{
+    using namespace testing;
+
+    stack.add_surface(stub_surface1, default_params.input_mode);
+    stack.add_surface(stub_surface2, default_params.input_mode);
+    stack.scene_elements_for(compositor_id, everywhere);
+
+    stack.add_surface(stub_surface3, default_params.input_mode);
+    stack.raise(stub_surface1);
+    stack.remove_surface(stub_surface2);
+
+    EXPECT_THAT(
+        stack.scene_elements_for(compositor_id, everywhere),
+        ElementsAre(
+            SceneElementForStream(stub_buffer_stream3),
+            SceneElementForStream(stub_buffer_stream1)));
+}
+
+TEST_F(SurfaceStack, scene_snapshot_follows_changes_to_surface_visibility)
+{
+    using namespace testing;
+
+    stack.add_surface(stub_surface1, default_params.input_mode);
+    stack.add_surface(stub_surface2, default_params.input_mode);
+    stack.scene_elements_for(compositor_id, everywhere);
+
+    stub_surface1->hide();
+
+    EXPECT_THAT(
+        stack.scene_elements_for(compositor_id, everywhere),
+        ElementsAre(SceneElementForStream(stub_buffer_stream2)));
+}
+
 TEST_F(SurfaceStack, scene_counts_pending_accurately)
 {
     using namespace testing;
@@ -264,7 +299,7 @@ TEST_F(SurfaceStack, scene_counts_pending_accurately)
     for (auto expect = 0u; expect != num_posts; expect++)
     {
         ASSERT_EQ(expect >= num_posts ? 0 : 1, stack.frames_pending(this));
-        for (auto& element : stack.scene_elements_for(compositor_id))
+        for (auto& element : stack.scene_elements_for(compositor_id, everywhere))
             element->renderable()->buffer();
     }
 }
@@ -286,7 +321,7 @@ TEST_F(SurfaceStack, scene_doesnt_count_pending_frames_from_occluded_surfaces)
         report);
 
     stack.add_surface(surface, default_params.input_mode);
-    auto elements = stack.scene_elements_for(this);
+    auto elements = stack.scene_elements_for(this, everywhere);
     for (auto const& elem : elements)
         elem->occluded();
 
@@ -326,13 +361,13 @@ TEST_F(SurfaceStack, scene_doesnt_count_pending_frames_from_partially_exposed_su
     EXPECT_EQ(3, stack.frames_pending(comp1));
     EXPECT_EQ(3, stack.frames_pending(comp2));
 
-    auto elements = stack.scene_elements_for(comp1);
+    auto elements = stack.scene_elements_for(comp1, everywhere);
     for (auto const& elem : elements)
     {
         elem->rendered();
     }
 
-    elements = stack.scene_elements_for(comp2);
+    elements = stack.scene_elements_for(comp2, everywhere);
     for (auto const& elem : elements)
     {
         elem->occluded();
@@ -342,6 +377,32 @@ TEST_F(SurfaceStack, scene_doesnt_count_pending_frames_from_partially_exposed_su
     EXPECT_EQ(0, stack.frames_pending(comp2));
 }
 
+TEST_F(SurfaceStack, leaves_surfaces_outside_the_area_out_and_counts_them_occluded)
+{
+    using namespace testing;
+
+    stack.register_compositor(compositor_id);
+    auto stream = std::make_shared<mtd::StubBufferStream>();
+    auto surface = std::make_shared<ms::BasicSurface>(
+        nullptr /* session */,
+        std::string("stub"),
+        geom::Rectangle{{0, 0}, {100, 100}},
+        mir_pointer_unconfined,
+        std::list<ms::StreamInfo> { { stream, {}, geom::Size{100, 100} } },
+        std::shared_ptr<mg::CursorImage>(),
+        report);
+
+    stack.add_surface(surface, default_params.input_mode);
+
+    EXPECT_THAT(stack.scene_elements_for(compositor_id, {{640, 0}, {640, 480}}), IsEmpty());
+
+    post_a_frame(*stream);
+    post_a_frame(*stream);
+    EXPECT_EQ(0, stack.frames_pending(compositor_id));
+
+    EXPECT_THAT(stack.scene_elements_for(compositor_id, {{0, 0}, {640, 480}}), SizeIs(1));
+}
+
 TEST_F(SurfaceStack, surfaces_are_emitted_by_layer)
 {
     using namespace testing;
@@ -351,7 +412,7 @@ TEST_F(SurfaceStack, surfaces_are_emitted_by_layer)
     stack.add_surface(stub_surface2, default_params.input_mode);
 
     EXPECT_THAT(
-        stack.scene_elements_for(compositor_id),
+        stack.scene_elements_for(compositor_id, everywhere),
         ElementsAre(
             SceneElementForStream(stub_buffer_stream1),
             SceneElementForStream(stub_buffer_stream3),
@@ -386,7 +447,7 @@ TEST_F(SurfaceStack, raise_to_top_alters_render_ordering)
     stack.add_surface(stub_surface3, default_params.input_mode);
 
     EXPECT_THAT(
-        stack.scene_elements_for(compositor_id),
+        stack.scene_elements_for(compositor_id, everywhere),
         ElementsAre(
             SceneElementForStream(stub_buffer_stream1),
             SceneElementForStream(stub_buffer_stream2),
@@ -395,7 +456,7 @@ TEST_F(SurfaceStack, raise_to_top_alters_render_ordering)
     stack.raise(stub_surface1);
 
     EXPECT_THAT(
-        stack.scene_elements_for(compositor_id),
+        stack.scene_elements_for(compositor_id, everywhere),
         ElementsAre(
             SceneElementForStream(stub_buffer_stream2),
             SceneElementForStream(stub_buffer_stream3),
@@ -434,7 +495,7 @@ TEST_F(SurfaceStack, generate_elementelements)
         stack.add_surface(surface, default_params.input_mode);
     }
 
-    auto const elements = stack.scene_elements_for(compositor_id);
+    auto const elements = stack.scene_elements_for(compositor_id, everywhere);
 
     ASSERT_THAT(elements.size(), Eq(num_surfaces));
 
@@ -601,6 +662,78 @@ TEST_F(SurfaceStack, surfaces_reordered)
     stack.raise(stub_surface1);
 }
 
+TEST_F(SurfaceStack, transaction_notifies_observers_once_at_its_end)
+{
+    using namespace ::testing;
+
+    NiceMock<MockSceneObserver> observer;
+    stack.add_observer(mt::fake_shared(observer));
+    stack.add_surface(stub_surface1, default_params.input_mode);
+    stack.add_surface(stub_surface2, default_params.input_mode);
+    stack.add_surface(stub_surface3, default_params.input_mode);
+
+    stack.begin_transaction();
+
+    EXPECT_CALL(observer, surfaces_reordered(_)).Times(0);
+    EXPECT_CALL(observer, scene_changed()).Times(0);
+    stack.raise(stub_surface1);
+    stack.raise(stub_surface2);
+    stack.emit_scene_changed();
+    Mock::VerifyAndClearExpectations(&observer);
+
+    EXPECT_CALL(
+        observer,
+        surfaces_reordered(UnorderedElementsAre(LockedEq(stub_surface1), LockedEq(stub_surface2))))
+        .Times(1);
+    EXPECT_CALL(observer, scene_changed()).Times(1);
+    stack.end_transaction();
+}
+
+TEST_F(SurfaceStack, nested_transactions_end_with_the_outermost)
+{
+    using namespace ::testing;
+
+    NiceMock<MockSceneObserver> observer;
+    stack.add_observer(mt::fake_shared(observer));
+
+    stack.begin_transaction();
+    stack.begin_transaction();
+
+    EXPECT_CALL(observer, scene_changed()).Times(0);
+    stack.end_transaction();
+    Mock::VerifyAndClearExpectations(&observer);
+
+    EXPECT_CALL(observer, scene_changed()).Times(1);
+    stack.end_transaction();
+}
+
+TEST_F(SurfaceStack, compositor_waits_for_transaction_to_end)
+{
+    using namespace ::testing;
+
+    stack.add_surface(stub_surface1, default_params.input_mode);
+    stack.add_surface(stub_surface2, default_params.input_mode);
+
+    stack.begin_transaction();
+    stack.raise(stub_surface1);
+
+    auto elements = std::async(std::launch::async, [&] { return stack.scene_elements_for(compositor_id, everywhere); });
+    EXPECT_THAT(elements.wait_for(std::chrono::milliseconds{20}), Eq(std::future_status::timeout));
+
+    stack.end_transaction();
+
+    EXPECT_THAT(
+        elements.get(),
+        ElementsAre(
+            SceneElementForStream(stub_buffer_stream2),
+            SceneElementForStream(stub_buffer_stream1)));
+}
+
+TEST_F(SurfaceStack, ending_a_transaction_not_begun_throws)
+{
+    EXPECT_THROW(stack.end_transaction(), std::logic_error);
+}
+
 TEST_F(SurfaceStack, surface_stacking_order)
 {
     using namespace ::testing;
@@ -635,7 +768,7 @@ TEST_F(SurfaceStack, scene_elements_hold_snapshot_of_positioning_info)
         stack.add_surface(surface, default_params.input_mode);
     }
 
-    auto const elements = stack.scene_elements_for(compositor_id);
+    auto const elements = stack.scene_elements_for(compositor_id, everywhere);
 
     auto const changed_position = geom::Point{43,44};
     for(auto const& surface : surfaces)
@@ -664,7 +797,7 @@ TEST_F(SurfaceStack, generates_scene_elements_that_delay_buffer_acquisition)
         report);
         stack.add_surface(surface, default_params.input_mode);
 
-    auto const elements = stack.scene_elements_for(compositor_id);
+    auto const elements = stack.scene_elements_for(compositor_id, everywhere);
 
     Mock::VerifyAndClearExpectations(mock_stream.get());
     EXPECT_CALL(*mock_stream, lock_compositor_buffer(compositor_id))
@@ -693,7 +826,7 @@ TEST_F(SurfaceStack, generates_scene_elements_that_allow_only_one_buffer_acquisi
         report);
         stack.add_surface(surface, default_params.input_mode);
 
-    auto const elements = stack.scene_elements_for(compositor_id);
+    auto const elements = stack.scene_elements_for(compositor_id, everywhere);
     ASSERT_THAT(elements.size(), Eq(1u));
     elements.front()->renderable()->buffer();
     elements.front()->renderable()->buffer();
@@ -733,9 +866,9 @@ TEST_F(SurfaceStack, occludes_not_rendered_surface)
     
     stack.add_surface(mock_surface, default_params.input_mode);
 
-    auto const elements = stack.scene_elements_for(compositor_id);
+    auto const elements = stack.scene_elements_for(compositor_id, everywhere);
     ASSERT_THAT(elements.size(), Eq(1u));
-    auto const elements2 = stack.scene_elements_for(compositor_id2);
+    auto const elements2 = stack.scene_elements_for(compositor_id2, everywhere);
     ASSERT_THAT(elements2.size(), Eq(1u));
 
     EXPECT_CALL(*mock_surface, configure(mir_window_attrib_visibility, mir_window_visibility_occluded));
@@ -756,9 +889,9 @@ TEST_F(SurfaceStack, exposes_rendered_surface)
     auto const mock_surface = std::make_shared<MockConfigureSurface>();
         stack.add_surface(mock_surface, default_params.input_mode);
 
-    auto const elements = stack.scene_elements_for(compositor_id);
+    auto const elements = stack.scene_elements_for(compositor_id, everywhere);
     ASSERT_THAT(elements.size(), Eq(1u));
-    auto const elements2 = stack.scene_elements_for(compositor_id2);
+    auto const elements2 = stack.scene_elements_for(compositor_id2, everywhere);
     ASSERT_THAT(elements2.size(), Eq(1u));
 
     EXPECT_CALL(*mock_surface, configure(mir_window_attrib_visibility, mir_window_visibility_exposed));
@@ -781,11 +914,11 @@ TEST_F(SurfaceStack, occludes_surface_when_unregistering_all_compositors_that_re
     auto const mock_surface = std::make_shared<MockConfigureSurface>();
     stack.add_surface(mock_surface, default_params.input_mode);
 
-    auto const elements = stack.scene_elements_for(compositor_id);
+    auto const elements = stack.scene_elements_for(compositor_id, everywhere);
     ASSERT_THAT(elements.size(), Eq(1u));
-    auto const elements2 = stack.scene_elements_for(compositor_id2);
+    auto const elements2 = stack.scene_elements_for(compositor_id2, everywhere);
     ASSERT_THAT(elements2.size(), Eq(1u));
-    auto const elements3 = stack.scene_elements_for(compositor_id3);
+    auto const elements3 = stack.scene_elements_for(compositor_id3, everywhere);
     ASSERT_THAT(elements3.size(), Eq(1u));
 
     EXPECT_CALL(*mock_surface, configure(mir_window_attrib_visibility, mir_window_visibility_exposed))
@@ -906,7 +1039,7 @@ TEST_F(SurfaceStack, overlays_appear_at_top_of_renderlist)
     stack.add_surface(stub_surface2, default_params.input_mode);
 
     EXPECT_THAT(
-        stack.scene_elements_for(compositor_id),
+        stack.scene_elements_for(compositor_id, everywhere),
         ElementsAre(
             SceneElementForStream(stub_buffer_stream1),
             SceneElementForStream(stub_buffer_stream2),
@@ -924,7 +1057,7 @@ TEST_F(SurfaceStack, removed_overlays_are_removed)
     stack.add_surface(stub_surface2, default_params.input_mode);
 
     EXPECT_THAT(
-        stack.scene_elements_for(compositor_id),
+        stack.scene_elements_for(compositor_id, everywhere),
         ElementsAre(
             SceneElementForStream(stub_buffer_stream1),
             SceneElementForStream(stub_buffer_stream2),
@@ -933,7 +1066,7 @@ TEST_F(SurfaceStack, removed_overlays_are_removed)
     stack.remove_input_visualization(mt::fake_shared(r));
 
     EXPECT_THAT(
-        stack.scene_elements_for(compositor_id),
+        stack.scene_elements_for(compositor_id, everywhere),
         ElementsAre(
             SceneElementForStream(stub_buffer_stream1),
             SceneElementForStream(stub_buffer_stream2)));
@@ -1035,7 +1168,7 @@ TEST_F(SurfaceStack, raise_surfaces_to_top)
 
     stack.raise({stub_surface1, stub_surface3});
     EXPECT_THAT(
-        stack.scene_elements_for(compositor_id),
+        stack.scene_elements_for(compositor_id, everywhere),
         ElementsAre(
             SceneElementForStream(stub_buffer_stream2),
             SceneElementForStream(stub_buffer_stream1),
@@ -1049,7 +1182,7 @@ TEST_F(SurfaceStack, raise_surfaces_to_top)
 
     stack.raise({stub_surface2, stub_surface3});
     EXPECT_THAT(
-        stack.scene_elements_for(compositor_id),
+        stack.scene_elements_for(compositor_id, everywhere),
         ElementsAre(
             SceneElementForStream(stub_buffer_stream1),
             SceneElementForStream(stub_buffer_stream2),
@@ -1060,7 +1193,7 @@ TEST_F(SurfaceStack, raise_surfaces_to_top)
 
     stack.raise({stub_surface2, stub_surface1, stub_surface3});
     EXPECT_THAT(
-        stack.scene_elements_for(compositor_id),
+        stack.scene_elements_for(compositor_id, everywhere),
         ElementsAre(
             SceneElementForStream(stub_buffer_stream1),
             SceneElementForStream(stub_buffer_stream2),
@@ -1076,7 +1209,7 @@ TEST_F(SurfaceStack, new_surface_is_placed_under_old_according_to_depth_layer)
     stack.add_surface(stub_surface2, default_params.input_mode);
 
     EXPECT_THAT(
-        stack.scene_elements_for(compositor_id),
+        stack.scene_elements_for(compositor_id, everywhere),
         ElementsAre(
             SceneElementForStream(stub_buffer_stream2),
             SceneElementForStream(stub_buffer_stream1)));
@@ -1099,7 +1232,7 @@ TEST_F(SurfaceStack, raise_does_not_reorder_surfaces_when_depth_layers_are_diffe
 
     stack.raise({stub_surface1, stub_surface3});
     EXPECT_THAT(
-        stack.scene_elements_for(compositor_id),
+        stack.scene_elements_for(compositor_id, everywhere),
         ElementsAre(
             SceneElementForStream(stub_buffer_stream1),
             SceneElementForStream(stub_buffer_stream2),
@@ -1117,7 +1250,7 @@ TEST_F(SurfaceStack, changing_depth_layer_causes_reorder)
     stack.add_surface(stub_surface2, default_params.input_mode);
 
     EXPECT_THAT(
-        stack.scene_elements_for(compositor_id),
+        stack.scene_elements_for(compositor_id, everywhere),
         ElementsAre(
             SceneElementForStream(stub_buffer_stream1),
             SceneElementForStream(stub_buffer_stream2)));
@@ -1131,7 +1264,7 @@ TEST_F(SurfaceStack, changing_depth_layer_causes_reorder)
     stub_surface1->set_depth_layer(mir_depth_layer_above);
 
     EXPECT_THAT(
-        stack.scene_elements_for(compositor_id),
+        stack.scene_elements_for(compositor_id, everywhere),
         ElementsAre(
             SceneElementForStream(stub_buffer_stream2),
             SceneElementForStream(stub_buffer_stream1)));
@@ -1143,7 +1276,7 @@ TEST_F(SurfaceStack, changing_depth_layer_does_not_cause_reorder_when_it_shouldn
     stack.add_surface(stub_surface2, default_params.input_mode);
 
     EXPECT_THAT(
-        stack.scene_elements_for(compositor_id),
+        stack.scene_elements_for(compositor_id, everywhere),
         ElementsAre(
             SceneElementForStream(stub_buffer_stream1),
             SceneElementForStream(stub_buffer_stream2)));
@@ -1151,7 +1284,7 @@ TEST_F(SurfaceStack, changing_depth_layer_does_not_cause_reorder_when_it_shouldn
     stub_surface1->set_depth_layer(mir_depth_layer_below);
 
     EXPECT_THAT(
-        stack.scene_elements_for(compositor_id),
+        stack.scene_elements_for(compositor_id, everywhere),
         ElementsAre(
             SceneElementForStream(stub_buffer_stream1),
             SceneElementForStream(stub_buffer_stream2)));
@@ -1168,7 +1301,7 @@ TEST_F(SurfaceStack, raising_surface_set_respects_depth_layers)
     stack.add_surface(stub_surface3, default_params.input_mode);
 
     EXPECT_THAT(
-        stack.scene_elements_for(compositor_id),
+        stack.scene_elements_for(compositor_id, everywhere),
         ElementsAre(
             SceneElementForStream(stub_buffer_stream1),
             SceneElementForStream(stub_buffer_stream2),
@@ -1185,7 +1318,7 @@ TEST_F(SurfaceStack, raising_surface_set_respects_depth_layers)
     stack.raise({stub_surface1, stub_surface2});
 
     EXPECT_THAT(
-        stack.scene_elements_for(compositor_id),
+        stack.scene_elements_for(compositor_id, everywhere),
         ElementsAre(
             SceneElementForStream(stub_buffer_stream1),
             SceneElementForStream(stub_buffer_stream3),
@@ -1244,7 +1377,7 @@ TEST_F(SurfaceStack, all_depth_layers_are_handled)
         stack.raise(stub_surface2);
 
         EXPECT_THAT(
-            stack.scene_elements_for(compositor_id),
+            stack.scene_elements_for(compositor_id, everywhere),
             ElementsAre(
                 SceneElementForStream(stub_buffer_stream2),
                 SceneElementForStream(stub_buffer_stream1)))
@@ -1253,7 +1386,7 @@ TEST_F(SurfaceStack, all_depth_layers_are_handled)
         stub_surface2->set_depth_layer(depth_layers_in_order[i]);
 
         EXPECT_THAT(
-            stack.scene_elements_for(compositor_id),
+            stack.scene_elements_for(compositor_id, everywhere),
             ElementsAre(
                 SceneElementForStream(stub_buffer_stream1),
                 SceneElementForStream(stub_buffer_stream2)))
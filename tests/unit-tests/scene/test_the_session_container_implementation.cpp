@@ -85,3 +85,50 @@ TEST(SessionContainer, invalid_session_throw_behavior)
         container.remove_session(std::make_shared<mtd::StubSession>());
     }, std::logic_error);
 }
+
+TEST(SessionContainer, predecessor_of)
+{
+    using namespace ::testing;
+    ms::SessionContainer container;
+
+    auto session1 = std::make_shared<mtd::StubSession>();
+    auto session2 = std::make_shared<mtd::StubSession>();
+    auto session3 = std::make_shared<mtd::StubSession>();
+
+    container.insert_session(session1);
+    container.insert_session(session2);
+    container.insert_session(session3);
+    container.remove_session(session2);
+
+    EXPECT_EQ(session3, container.predecessor_of(session1));
+    EXPECT_EQ(session1, container.predecessor_of(session3));
+    EXPECT_THROW(container.predecessor_of(session2), std::logic_error);
+
+    // Predecessor of no session is the first session.
+    EXPECT_EQ(session1, container.predecessor_of(std::shared_ptr<ms::Session>()));
+}
+
+TEST(SessionContainer, for_each_callback_can_change_the_container)
+{
+    using namespace ::testing;
+    ms::SessionContainer container;
+
+    auto session1 = std::make_shared<mtd::StubSession>();
+    auto session2 = std::make_shared<mtd::StubSession>();
+    auto session3 = std::make_shared<mtd::StubSession>();
+
+    container.insert_session(session1);
+    container.insert_session(session2);
+
+    std::vector<std::shared_ptr<ms::Session>> seen;
+    container.for_each([&](std::shared_ptr<ms::Session> const& session)
+        {
+            seen.push_back(session);
+            container.remove_session(session);
+            if (session == session1)
+                container.insert_session(session3);
+        });
+
+    EXPECT_THAT(seen, ElementsAre(session1, session2));
+    EXPECT_EQ(session3, container.successor_of(session3));
+}
@@ -33,6 +33,7 @@
 #include <chrono>
 #include <thread>
 #include <atomic>
+#include <vector>
 
 namespace mg = mir::graphics;
 namespace ms = mir::scene;
@@ -49,6 +50,7 @@ public:
     ~MockPixelBuffer() noexcept {}
 
     MOCK_METHOD1(fill_from, void(mg::Buffer& buffer));
+    MOCK_METHOD2(fill_scaled_from, void(mg::Buffer& buffer, geom::Size const& size));
     MOCK_METHOD0(as_argb_8888, void const*());
     MOCK_CONST_METHOD0(size, geom::Size());
     MOCK_CONST_METHOD0(stride, geom::Stride());
@@ -112,6 +114,66 @@ TEST_F(ThreadedSnapshotStrategyTest, takes_snapshot)
     EXPECT_EQ(pixels, snapshot.pixels);
 }
 
+TEST_F(ThreadedSnapshotStrategyTest, thumbnail_is_scaled_to_fit_preserving_aspect_ratio)
+{
+    using namespace testing;
+
+    std::vector<char> pixels(100 * 75 * 4);
+    buffer_access.stub_compositor_buffer = std::make_shared<mtd::StubBuffer>(geom::Size{400, 300});
+
+    MockPixelBuffer pixel_buffer;
+
+    EXPECT_CALL(pixel_buffer, fill_scaled_from(_, Eq(geom::Size{100, 75})));
+    ON_CALL(pixel_buffer, as_argb_8888()).WillByDefault(Return(pixels.data()));
+    ON_CALL(pixel_buffer, size()).WillByDefault(Return(geom::Size{100, 75}));
+    ON_CALL(pixel_buffer, stride()).WillByDefault(Return(geom::Stride{100 * 4}));
+
+    ms::ThreadedSnapshotStrategy strategy{mt::fake_shared(pixel_buffer)};
+
+    mt::Signal thumbnail_taken;
+    geom::Size size;
+
+    strategy.take_thumbnail_of(
+        mt::fake_shared(buffer_access),
+        geom::Size{100, 100},
+        [&](ms::Snapshot const& s)
+        {
+            size = s.size;
+            thumbnail_taken.raise();
+        });
+
+    thumbnail_taken.wait_for(std::chrono::seconds{5});
+
+    EXPECT_THAT(size, Eq(geom::Size{100, 75}));
+}
+
+TEST_F(ThreadedSnapshotStrategyTest, thumbnail_of_an_unchanged_buffer_is_reused)
+{
+    using namespace testing;
+
+    std::vector<char> pixels(100 * 75 * 4);
+    buffer_access.stub_compositor_buffer = std::make_shared<mtd::StubBuffer>(geom::Size{400, 300});
+    auto const stream = mt::fake_shared(buffer_access);
+
+    NiceMock<MockPixelBuffer> pixel_buffer;
+
+    EXPECT_CALL(pixel_buffer, fill_scaled_from(_, _)).Times(1);
+    ON_CALL(pixel_buffer, as_argb_8888()).WillByDefault(Return(pixels.data()));
+    ON_CALL(pixel_buffer, size()).WillByDefault(Return(geom::Size{100, 75}));
+    ON_CALL(pixel_buffer, stride()).WillByDefault(Return(geom::Stride{100 * 4}));
+
+    ms::ThreadedSnapshotStrategy strategy{mt::fake_shared(pixel_buffer)};
+
+    mt::Signal first_taken;
+    mt::Signal second_taken;
+
+    strategy.take_thumbnail_of(stream, geom::Size{100, 100}, [&](ms::Snapshot const&) { first_taken.raise(); });
+    strategy.take_thumbnail_of(stream, geom::Size{100, 100}, [&](ms::Snapshot const&) { second_taken.raise(); });
+
+    EXPECT_TRUE(first_taken.wait_for(std::chrono::seconds{5}));
+    EXPECT_TRUE(second_taken.wait_for(std::chrono::seconds{5}));
+}
+
 #ifndef MIR_DONT_USE_PTHREAD_GETNAME_NP
 TEST_F(ThreadedSnapshotStrategyTest, names_snapshot_thread)
 {
@@ -19,6 +19,7 @@
 #include "src/server/scene/timeout_application_not_responding_detector.h"
 
 #include "mir/test/doubles/mock_scene_session.h"
+#include "mir/test/doubles/mock_surface.h"
 #include "mir/test/doubles/fake_alarm_factory.h"
 
 #include <gmock/gmock.h>
@@ -469,3 +470,56 @@ TEST(TimeoutApplicationNotRespondingDetector, sends_pings_on_schedule_as_session
 
     EXPECT_THAT(ping_count, Ge(duration / cycle_time));
 }
+
+TEST(TimeoutApplicationNotRespondingDetector, pings_hidden_sessions_less_often)
+{
+    using namespace testing;
+    using namespace std::literals::chrono_literals;
+
+    mtd::FakeAlarmFactory fake_alarms;
+
+    ms::TimeoutApplicationNotRespondingDetector detector{fake_alarms, 1s};
+
+    NiceMock<mtd::MockSceneSession> shown_session, hidden_session;
+    auto const hidden_surface = std::make_shared<NiceMock<mtd::MockSurface>>();
+    ON_CALL(*hidden_surface, visible()).WillByDefault(Return(false));
+    ON_CALL(hidden_session, default_surface()).WillByDefault(Return(hidden_surface));
+
+    int shown_session_pinged{0}, hidden_session_pinged{0};
+    detector.register_session(&shown_session, [&shown_session_pinged]() { shown_session_pinged++; });
+    detector.register_session(&hidden_session, [&hidden_session_pinged]() { hidden_session_pinged++; });
+
+    for (int i = 0; i != 8; ++i)
+    {
+        fake_alarms.advance_by(1001ms);
+        detector.pong_received(&shown_session);
+        detector.pong_received(&hidden_session);
+    }
+
+    EXPECT_THAT(shown_session_pinged, Eq(8));
+    EXPECT_THAT(hidden_session_pinged, Eq(2));
+}
+
+TEST(TimeoutApplicationNotRespondingDetector, finds_a_hidden_session_unresponsive)
+{
+    using namespace testing;
+    using namespace std::literals::chrono_literals;
+
+    mtd::FakeAlarmFactory fake_alarms;
+
+    ms::TimeoutApplicationNotRespondingDetector detector{fake_alarms, 1s};
+
+    auto observer = std::make_shared<NiceMock<MockObserver>>();
+    detector.register_observer(observer);
+
+    NiceMock<mtd::MockSceneSession> hidden_session;
+    auto const hidden_surface = std::make_shared<NiceMock<mtd::MockSurface>>();
+    ON_CALL(*hidden_surface, visible()).WillByDefault(Return(false));
+    ON_CALL(hidden_session, default_surface()).WillByDefault(Return(hidden_surface));
+
+    detector.register_session(&hidden_session, [](){});
+
+    EXPECT_CALL(*observer, session_unresponsive(&hidden_session));
+
+    fake_alarms.advance_smoothly_by(10s);
+}
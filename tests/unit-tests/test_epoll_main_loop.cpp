@@ -0,0 +1,225 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/epoll_main_loop.h"
+#include "mir/time/alarm.h"
+
+#include "mir/test/signal.h"
+#include "mir/test/pipe.h"
+#include "mir/test/auto_unblock_thread.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <csignal>
+#include <unistd.h>
+
+namespace mt = mir::test;
+
+using namespace ::testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+struct EpollMainLoopTest : Test
+{
+    mir::EpollMainLoop ml;
+};
+}
+
+TEST_F(EpollMainLoopTest, stops_from_within_handler)
+{
+    mt::Signal loop_finished;
+
+    mt::AutoJoinThread t{
+        [&]
+        {
+            int const owner{0};
+            ml.enqueue(&owner, [&] { ml.stop(); });
+            ml.run();
+            loop_finished.raise();
+        }};
+
+    EXPECT_TRUE(loop_finished.wait_for(5s));
+}
+
+TEST_F(EpollMainLoopTest, stops_from_outside_handler)
+{
+    mt::Signal loop_running;
+    mt::Signal loop_finished;
+
+    mt::AutoJoinThread t{
+        [&]
+        {
+            int const owner{0};
+            ml.enqueue(&owner, [&] { loop_running.raise(); });
+            ml.run();
+            loop_finished.raise();
+        }};
+
+    ASSERT_TRUE(loop_running.wait_for(5s));
+
+    ml.stop();
+
+    EXPECT_TRUE(loop_finished.wait_for(5s));
+}
+
+TEST_F(EpollMainLoopTest, handles_signal)
+{
+    int const signum{SIGUSR1};
+    int handled_signum{0};
+
+    ml.register_signal_handler(
+        {signum},
+        [&](int sig)
+        {
+           handled_signum = sig;
+           ml.stop();
+        });
+
+    kill(getpid(), signum);
+
+    ml.run();
+
+    EXPECT_THAT(handled_signum, Eq(signum));
+}
+
+TEST_F(EpollMainLoopTest, handles_fd)
+{
+    mt::Pipe p;
+    char const data_to_write{'a'};
+    char data_read{0};
+
+    ml.register_fd_handler(
+        {p.read_fd()},
+        this,
+        [&](int fd)
+        {
+            EXPECT_THAT(read(fd, &data_read, 1), Eq(1));
+            ml.stop();
+        });
+
+    EXPECT_THAT(write(p.write_fd(), &data_to_write, 1), Eq(1));
+
+    ml.run();
+
+    EXPECT_THAT(data_read, Eq(data_to_write));
+}
+
+TEST_F(EpollMainLoopTest, unregistered_fd_handler_is_not_called)
+{
+    mt::Pipe p;
+    int const owner{0};
+    int handled{0};
+    char const data_to_write{'a'};
+
+    ml.register_fd_handler(
+        {p.read_fd()},
+        &owner,
+        [&](int fd)
+        {
+            char data;
+            EXPECT_THAT(read(fd, &data, 1), Eq(1));
+            ++handled;
+            ml.unregister_fd_handler(&owner);
+            EXPECT_THAT(write(p.write_fd(), &data_to_write, 1), Eq(1));
+        });
+
+    EXPECT_THAT(write(p.write_fd(), &data_to_write, 1), Eq(1));
+
+    auto const alarm = ml.create_alarm([&] { ml.stop(); });
+    alarm->reschedule_in(50ms);
+
+    ml.run();
+
+    EXPECT_THAT(handled, Eq(1));
+}
+
+TEST_F(EpollMainLoopTest, dispatches_actions_in_order)
+{
+    int const owner{0};
+    std::vector<int> actions;
+
+    for (int i = 0; i != 5; ++i)
+        ml.enqueue(&owner, [&, i] { actions.push_back(i); });
+    ml.enqueue(&owner, [&] { ml.stop(); });
+
+    ml.run();
+
+    EXPECT_THAT(actions, ElementsAre(0, 1, 2, 3, 4));
+}
+
+TEST_F(EpollMainLoopTest, holds_back_actions_of_paused_owner_until_resumed)
+{
+    int const paused_owner{0};
+    int const other_owner{0};
+    std::vector<int> actions;
+
+    ml.pause_processing_for(&paused_owner);
+    ml.enqueue(&paused_owner, [&] { actions.push_back(1); ml.stop(); });
+    ml.enqueue(&other_owner, [&] { actions.push_back(2); ml.resume_processing_for(&paused_owner); });
+
+    ml.run();
+
+    EXPECT_THAT(actions, ElementsAre(2, 1));
+}
+
+TEST_F(EpollMainLoopTest, fires_alarm)
+{
+    bool fired{false};
+
+    auto const alarm = ml.create_alarm([&] { fired = true; ml.stop(); });
+    alarm->reschedule_in(10ms);
+
+    ml.run();
+
+    EXPECT_TRUE(fired);
+    EXPECT_THAT(alarm->state(), Eq(mir::time::Alarm::triggered));
+}
+
+TEST_F(EpollMainLoopTest, propagates_exception_from_action)
+{
+    int const owner{0};
+    ml.enqueue(&owner, [] { throw std::runtime_error("action error"); });
+
+    EXPECT_THROW({ ml.run(); }, std::runtime_error);
+}
+
+TEST_F(EpollMainLoopTest, runs_guaranteed_actions_when_stopped)
+{
+    int const owner{0};
+    bool executed{false};
+
+    ml.enqueue(&owner,
+        [&]
+        {
+            ml.stop();
+            ml.enqueue_with_guaranteed_execution([&] { executed = true; });
+        });
+
+    ml.run();
+
+    EXPECT_TRUE(executed);
+}
+
+TEST_F(EpollMainLoopTest, runs_guaranteed_action_immediately_when_not_running)
+{
+    bool executed{false};
+
+    ml.enqueue_with_guaranteed_execution([&] { executed = true; });
+
+    EXPECT_TRUE(executed);
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/event_ring.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <poll.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+using namespace testing;
+
+namespace
+{
+bool doorbell_ringing(mir::EventRing const& ring)
+{
+    pollfd fd{ring.doorbell(), POLLIN, 0};
+    return poll(&fd, 1, 0) == 1;
+}
+
+struct EventRing : Test
+{
+    auto read_all() -> std::vector<std::string>
+    {
+        std::vector<std::string> records;
+        reader.read([&](void const* data, size_t size)
+            {
+                EXPECT_THAT(reinterpret_cast<uintptr_t>(data) % 8, Eq(0u));
+                records.emplace_back(static_cast<char const*>(data), size);
+            });
+        return records;
+    }
+
+    bool write(std::string const& record)
+    {
+        return writer.write(record.data(), record.size());
+    }
+
+    mir::EventRing writer{256};
+    mir::EventRing reader{writer.memory(), writer.doorbell()};
+};
+}
+
+TEST_F(EventRing, delivers_records_in_order)
+{
+    ASSERT_TRUE(write("one"));
+    ASSERT_TRUE(write("two"));
+    ASSERT_TRUE(write("three"));
+
+    EXPECT_THAT(read_all(), ElementsAre("one", "two", "three"));
+    EXPECT_THAT(read_all(), IsEmpty());
+}
+
+TEST_F(EventRing, rings_the_doorbell_once_for_a_burst)
+{
+    EXPECT_FALSE(doorbell_ringing(reader));
+
+    write("one");
+    EXPECT_TRUE(doorbell_ringing(reader));
+
+    uint64_t rings{0};
+    ASSERT_THAT(::read(writer.doorbell(), &rings, sizeof rings), Eq(static_cast<ssize_t>(sizeof rings)));
+    write("two");
+    write("three");
+
+    EXPECT_THAT(rings, Eq(1u));
+    EXPECT_FALSE(doorbell_ringing(reader));
+}
+
+TEST_F(EventRing, reading_clears_the_doorbell)
+{
+    write("one");
+    read_all();
+
+    EXPECT_FALSE(doorbell_ringing(reader));
+
+    write("two");
+    EXPECT_TRUE(doorbell_ringing(reader));
+}
+
+TEST_F(EventRing, refuses_a_record_when_full)
+{
+    std::string const record(100, 'x');
+
+    EXPECT_TRUE(write(record));
+    EXPECT_TRUE(write(record));
+    EXPECT_FALSE(write(record));
+
+    EXPECT_THAT(read_all(), ElementsAre(record, record));
+    EXPECT_TRUE(write(record));
+}
+
+TEST_F(EventRing, wraps_records_around_its_end)
+{
+    std::vector<std::string> written;
+
+    for (int i = 0; i != 100; ++i)
+    {
+        auto const record = std::string(i % 40, 'a' + i % 26) + std::to_string(i);
+        ASSERT_TRUE(write(record));
+        written.push_back(record);
+
+        if (i % 3 == 2)
+        {
+            EXPECT_THAT(read_all(), ElementsAreArray(written));
+            written.clear();
+        }
+    }
+
+    EXPECT_THAT(read_all(), ElementsAreArray(written));
+}
+
+TEST_F(EventRing, refuses_a_record_larger_than_the_ring)
+{
+    EXPECT_FALSE(write(std::string(300, 'x')));
+    EXPECT_TRUE(write("one"));
+}
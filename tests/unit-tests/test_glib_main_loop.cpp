@@ -32,7 +32,10 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <mutex>
+#include <set>
 #include <thread>
+#include <vector>
 
 namespace mt = mir::test;
 namespace mtd = mir::test::doubles;
@@ -792,6 +795,181 @@ TEST_F(GLibMainLoopTest, dispatches_actions_resumed_externally)
     EXPECT_THAT(actions, ElementsAre(1, 0));
 }
 
+TEST_F(GLibMainLoopTest, resumed_actions_keep_their_place_in_the_queue)
+{
+    using namespace testing;
+
+    std::vector<int> actions;
+    void const* const owner1_ptr{&actions};
+    int const owner2{0};
+
+    ml.enqueue(owner1_ptr, [&] { actions.push_back(0); });
+    ml.enqueue(
+        &owner2,
+        [&]
+        {
+            actions.push_back(1);
+            ml.resume_processing_for(owner1_ptr);
+            ml.enqueue(
+                &owner2,
+                [&]
+                {
+                    actions.push_back(3);
+                    ml.stop();
+                });
+        });
+    ml.enqueue(owner1_ptr, [&] { actions.push_back(2); });
+
+    ml.pause_processing_for(owner1_ptr);
+
+    ml.run();
+
+    EXPECT_THAT(actions, ElementsAre(1, 0, 2, 3));
+}
+
+TEST_F(GLibMainLoopTest, does_not_dispatch_actions_paused_after_they_were_queued)
+{
+    using namespace testing;
+
+    std::vector<int> actions;
+    int const owner1{0};
+    int const owner2{0};
+
+    ml.enqueue(&owner1, [&] { actions.push_back(0); });
+    ml.pause_processing_for(&owner1);
+    ml.enqueue(
+        &owner2,
+        [&]
+        {
+            actions.push_back(1);
+            ml.stop();
+        });
+
+    ml.run();
+
+    EXPECT_THAT(actions, ElementsAre(1));
+}
+
+TEST_F(GLibMainLoopTest, owner_paused_twice_is_resumed_by_one_resume)
+{
+    using namespace testing;
+
+    std::vector<int> actions;
+    void const* const owner1_ptr{&actions};
+    int const owner2{0};
+
+    ml.pause_processing_for(owner1_ptr);
+    ml.pause_processing_for(owner1_ptr);
+
+    ml.enqueue(
+        owner1_ptr,
+        [&]
+        {
+            actions.push_back(0);
+            ml.stop();
+        });
+    ml.enqueue(
+        &owner2,
+        [&]
+        {
+            actions.push_back(1);
+            ml.resume_processing_for(owner1_ptr);
+        });
+
+    ml.run();
+
+    EXPECT_THAT(actions, ElementsAre(1, 0));
+}
+
+TEST_F(GLibMainLoopTest, resuming_an_owner_leaves_other_owners_paused)
+{
+    using namespace testing;
+
+    std::vector<int> actions;
+    int const owner1{0};
+    int const owner2{0};
+    int const owner3{0};
+
+    ml.pause_processing_for(&owner1);
+    ml.pause_processing_for(&owner3);
+    ml.enqueue(&owner1, [&] { actions.push_back(0); });
+    ml.enqueue(&owner3, [&] { actions.push_back(1); });
+    ml.resume_processing_for(&owner3);
+    ml.resume_processing_for(&owner2);
+    ml.enqueue(
+        &owner2,
+        [&]
+        {
+            actions.push_back(2);
+            ml.stop();
+        });
+
+    ml.run();
+
+    EXPECT_THAT(actions, ElementsAre(1, 2));
+}
+
+TEST_F(GLibMainLoopTest, guaranteed_actions_are_not_held_back_by_a_paused_owner)
+{
+    using namespace testing;
+
+    std::vector<int> actions;
+    int const owner{0};
+
+    ml.pause_processing_for(&owner);
+    ml.enqueue(&owner, [&] { actions.push_back(0); });
+    ml.enqueue_with_guaranteed_execution(
+        [&]
+        {
+            actions.push_back(1);
+            ml.stop();
+        });
+
+    ml.run();
+
+    EXPECT_THAT(actions, ElementsAre(1));
+}
+
+TEST_F(GLibMainLoopTest, dispatches_actions_enqueued_from_other_threads_in_order)
+{
+    using namespace testing;
+
+    int const num_threads{4};
+    int const num_actions{250};
+    std::mutex mutex;
+    std::vector<std::vector<int>> actions(num_threads);
+    int total{0};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t)
+    {
+        threads.emplace_back(
+            [&, t]
+            {
+                for (int i = 0; i < num_actions; ++i)
+                {
+                    ml.enqueue(
+                        &actions[t],
+                        [&, t, i]
+                        {
+                            std::lock_guard<std::mutex> lock{mutex};
+                            actions[t].push_back(i);
+                            if (++total == num_threads * num_actions)
+                                ml.stop();
+                        });
+                }
+            });
+    }
+
+    ml.run();
+
+    for (auto& thread : threads)
+        thread.join();
+
+    for (auto const& thread_actions : actions)
+        EXPECT_THAT(thread_actions, ContainerEq(values_from_to(0, num_actions - 1)));
+}
+
 TEST_F(GLibMainLoopTest, propagates_exception_from_server_action)
 {
     // Execute in forked process to work around
@@ -1395,6 +1573,92 @@ TEST_F(GLibMainLoopAlarmTest, reschedule_returns_false_when_it_didnt_reset_a_pre
     EXPECT_FALSE(alarm->reschedule_in(10s));
 }
 
+namespace
+{
+struct WakeRecordingClock : mtd::AdvanceableClock
+{
+    mir::time::Duration min_wait_until(mir::time::Timestamp t) const override
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        wake_times.insert(t);
+        return std::max(t - now(), mir::time::Duration{0});
+    }
+
+    bool wait_for_wake_times(std::set<mir::time::Timestamp> const& expected) const
+    {
+        for (auto i = 0; i != 500; ++i)
+        {
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                if (wake_times == expected)
+                    return true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        }
+        return false;
+    }
+
+    std::mutex mutable mutex;
+    std::set<mir::time::Timestamp> mutable wake_times;
+};
+}
+
+TEST(GLibMainLoopTimerSlack, alarms_due_in_the_same_window_wake_the_loop_together)
+{
+    using namespace std::literals::chrono_literals;
+
+    auto const clock = std::make_shared<WakeRecordingClock>();
+    mir::GLibMainLoop ml{clock, 50ms};
+
+    auto const now = clock->now();
+    mir::time::Timestamp const window_start{(now.time_since_epoch() / 50ms) * 50ms};
+
+    auto const first = ml.create_alarm([]{});
+    auto const second = ml.create_alarm([]{});
+    first->reschedule_for(window_start + 1060ms);
+    second->reschedule_for(window_start + 1090ms);
+
+    UnblockMainLoop unblocker{ml};
+
+    EXPECT_TRUE(clock->wait_for_wake_times({window_start + 1100ms}));
+}
+
+TEST(GLibMainLoopTimerSlack, short_alarms_are_not_delayed)
+{
+    using namespace std::literals::chrono_literals;
+
+    auto const clock = std::make_shared<WakeRecordingClock>();
+    mir::GLibMainLoop ml{clock, 50ms};
+
+    mir::time::Timestamp const window_start{(clock->now().time_since_epoch() / 50ms) * 50ms};
+    auto const due = window_start + 60ms;
+    auto const alarm = ml.create_alarm([]{});
+    alarm->reschedule_for(due);
+
+    UnblockMainLoop unblocker{ml};
+
+    EXPECT_TRUE(clock->wait_for_wake_times({due}));
+}
+
+TEST(GLibMainLoopTimerSlack, alarm_fires_when_due_if_the_loop_is_woken)
+{
+    using namespace std::literals::chrono_literals;
+
+    auto const clock = std::make_shared<AdvanceableClock>();
+    mir::GLibMainLoop ml{clock, 50ms};
+
+    auto const alarm = ml.create_alarm([]{});
+    alarm->reschedule_in(1010ms);
+
+    UnblockMainLoop unblocker{ml};
+
+    clock->advance_by(1009ms, ml);
+    EXPECT_EQ(mir::time::Alarm::pending, alarm->state());
+
+    clock->advance_by(1ms, ml);
+    EXPECT_EQ(mir::time::Alarm::triggered, alarm->state());
+}
+
 // More targeted regression test for LP: #1381925
 TEST_F(GLibMainLoopTest, stress_emits_alarm_notification_with_zero_timeout)
 {
@@ -0,0 +1,158 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/lock_profile.h"
+#include "mir/profiled_mutex.h"
+#include "mir/recursive_read_write_mutex.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <condition_variable>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+struct LockProfile : Test
+{
+    LockProfile() { mir::LockProfile::enable(true); }
+    ~LockProfile() { mir::LockProfile::enable(false); }
+
+    mir::LockProfile profile{"test"};
+};
+
+auto listed_profiles() -> std::vector<std::string>
+{
+    std::vector<std::string> names;
+    mir::for_each_lock_profile([&](mir::LockProfile const& profile) { names.push_back(profile.name); });
+    return names;
+}
+
+/// Holds \a mutex on another thread, for \a hold, once we're waiting for it
+template<typename Lock, typename Unlock>
+void contend(Lock lock, Unlock unlock, std::chrono::milliseconds hold)
+{
+    std::mutex m;
+    std::condition_variable cv;
+    bool locked{false};
+
+    std::thread holder{[&]
+        {
+            lock();
+            {
+                std::lock_guard<std::mutex> guard{m};
+                locked = true;
+            }
+            cv.notify_all();
+            std::this_thread::sleep_for(hold);
+            unlock();
+        }};
+
+    {
+        std::unique_lock<std::mutex> guard{m};
+        cv.wait(guard, [&] { return locked; });
+    }
+
+    lock();
+    unlock();
+    holder.join();
+}
+}
+
+TEST_F(LockProfile, profiles_are_listed_while_they_exist)
+{
+    {
+        mir::LockProfile const other{"other"};
+        EXPECT_THAT(listed_profiles(), IsSupersetOf({"test", "other"}));
+    }
+
+    EXPECT_THAT(listed_profiles(), Not(Contains("other")));
+}
+
+TEST_F(LockProfile, uncontended_locks_are_counted)
+{
+    mir::ProfiledMutex mutex{profile};
+
+    for (int i = 0; i != 3; ++i)
+    {
+        std::lock_guard<mir::ProfiledMutex> lock{mutex};
+    }
+
+    EXPECT_THAT(profile.totals().acquisitions, Eq(3u));
+    EXPECT_THAT(profile.totals().contended, Eq(0u));
+    EXPECT_THAT(profile.totals().waited, Eq(0ns));
+}
+
+TEST_F(LockProfile, nothing_is_recorded_while_disabled)
+{
+    mir::ProfiledMutex mutex{profile};
+    mir::LockProfile::enable(false);
+
+    {
+        std::lock_guard<mir::ProfiledMutex> lock{mutex};
+    }
+
+    EXPECT_THAT(profile.totals().acquisitions, Eq(0u));
+    EXPECT_THAT(profile.totals().held, Eq(0ns));
+}
+
+TEST_F(LockProfile, waits_for_a_held_mutex_are_recorded)
+{
+    mir::ProfiledMutex mutex{profile};
+
+    contend([&] { mutex.lock(); }, [&] { mutex.unlock(); }, 20ms);
+
+    auto const totals = profile.totals();
+    EXPECT_THAT(totals.acquisitions, Eq(2u));
+    EXPECT_THAT(totals.contended, Eq(1u));
+    EXPECT_THAT(totals.waited, Gt(0ns));
+    EXPECT_THAT(totals.longest_wait, Eq(totals.waited));
+    EXPECT_THAT(totals.longest_hold, Ge(20ms));
+    EXPECT_THAT(totals.held, Ge(totals.longest_hold));
+}
+
+TEST_F(LockProfile, shared_locks_record_waits_but_not_holds)
+{
+    mir::ProfiledSharedMutex mutex{profile};
+
+    {
+        std::shared_lock<mir::ProfiledSharedMutex> first{mutex};
+        std::shared_lock<mir::ProfiledSharedMutex> second{mutex};
+    }
+
+    EXPECT_THAT(profile.totals().acquisitions, Eq(2u));
+    EXPECT_THAT(profile.totals().held, Eq(0ns));
+}
+
+TEST_F(LockProfile, recursive_read_write_mutex_records_the_outermost_write_lock)
+{
+    mir::RecursiveReadWriteMutex mutex{profile};
+
+    contend(
+        [&] { mutex.write_lock(); mutex.write_lock(); },
+        [&] { mutex.write_unlock(); mutex.write_unlock(); },
+        20ms);
+
+    auto const totals = profile.totals();
+    EXPECT_THAT(totals.acquisitions, Eq(4u));
+    EXPECT_THAT(totals.contended, Eq(1u));
+    EXPECT_THAT(totals.longest_hold, Ge(20ms));
+}
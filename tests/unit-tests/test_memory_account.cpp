@@ -0,0 +1,83 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/memory_account.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace testing;
+
+namespace
+{
+auto listed_accounts() -> std::vector<std::string>
+{
+    std::vector<std::string> names;
+    mir::for_each_memory_account(
+        [&](mir::MemoryAccount const& account)
+        {
+            names.push_back(std::string{account.subsystem} + "/" + account.kind);
+        });
+    return names;
+}
+}
+
+TEST(MemoryAccount, charges_are_refunded_when_their_objects_go)
+{
+    mir::MemoryAccount account{"test", "things"};
+
+    {
+        mir::MemoryCharge const first{account, 100};
+        mir::MemoryCharge const second{account, 20};
+
+        EXPECT_THAT(account.objects(), Eq(2));
+        EXPECT_THAT(account.bytes(), Eq(120));
+    }
+
+    EXPECT_THAT(account.objects(), Eq(0));
+    EXPECT_THAT(account.bytes(), Eq(0));
+}
+
+TEST(MemoryAccount, resizing_a_charge_changes_only_the_bytes)
+{
+    mir::MemoryAccount account{"test", "things"};
+
+    {
+        mir::MemoryCharge charge{account, 100};
+        charge.resize(40);
+
+        EXPECT_THAT(account.objects(), Eq(1));
+        EXPECT_THAT(account.bytes(), Eq(40));
+
+        charge.resize(400);
+        EXPECT_THAT(account.bytes(), Eq(400));
+    }
+
+    EXPECT_THAT(account.bytes(), Eq(0));
+}
+
+TEST(MemoryAccount, accounts_are_listed_while_they_exist)
+{
+    auto account = std::make_unique<mir::MemoryAccount>("test", "listed");
+    EXPECT_THAT(listed_accounts(), Contains("test/listed"));
+
+    account.reset();
+    EXPECT_THAT(listed_accounts(), Not(Contains("test/listed")));
+}
@@ -53,6 +53,33 @@ TEST(MirCookieAuthority, attests_real_timestamp)
     });
 }
 
+TEST(MirCookieAuthority, attests_the_cookies_it_serializes)
+{
+    using namespace testing;
+    std::vector<uint8_t> secret{ 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff, 0xde, 0x01 };
+    auto authority = mir::cookie::Authority::create_from(secret);
+
+    uint64_t mock_timestamp{0x322322322332};
+    auto const raw_cookie = authority->make_cookie(mock_timestamp)->serialize();
+
+    auto const attested = authority->make_cookie(raw_cookie);
+    EXPECT_THAT(attested->timestamp(), Eq(mock_timestamp));
+    EXPECT_THAT(attested->serialize(), Eq(raw_cookie));
+}
+
+TEST(MirCookieAuthority, doesnt_attest_a_cookie_with_a_changed_timestamp)
+{
+    std::vector<uint8_t> secret{ 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff, 0xde, 0x01 };
+    auto authority = mir::cookie::Authority::create_from(secret);
+
+    auto raw_cookie = authority->make_cookie(0x322322322332)->serialize();
+    raw_cookie[1] ^= 1;
+
+    EXPECT_THROW({
+        authority->make_cookie(raw_cookie);
+    }, mir::cookie::SecurityCheckError);
+}
+
 TEST(MirCookieAuthority, doesnt_attest_faked_mac)
 {
     std::vector<uint8_t> secret{ 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff, 0xde, 0x01 };
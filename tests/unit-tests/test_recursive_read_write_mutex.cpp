@@ -174,3 +174,89 @@ TEST_F(RecursiveReadWriteMutex, read_lock_waits_for_write_locks_on_other_threads
 
     threads.push_back(std::thread{writer_function});
 }
+
+TEST_F(RecursiveReadWriteMutex, waiting_writer_holds_off_new_readers)
+{
+    InSequence seq;
+
+    EXPECT_CALL(*this, notify_read_locked()).Times(1);
+    EXPECT_CALL(*this, notify_read_unlocking()).Times(1);
+    EXPECT_CALL(*this, notify_write_locked()).Times(1);
+    EXPECT_CALL(*this, notify_write_unlocking()).Times(1);
+    EXPECT_CALL(*this, notify_read_locked()).Times(1);
+
+    mutex.read_lock();
+    notify_read_locked();
+
+    threads.push_back(std::thread{[&]
+        {
+            mutex.write_lock();
+            notify_write_locked();
+            std::this_thread::sleep_for(std::chrono::milliseconds{10});
+            notify_write_unlocking();
+            mutex.write_unlock();
+        }});
+
+    // Give the writer time to start waiting
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+
+    threads.push_back(std::thread{[&]
+        {
+            mutex.read_lock();
+            notify_read_locked();
+            mutex.read_unlock();
+        }});
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+
+    notify_read_unlocking();
+    mutex.read_unlock();
+}
+
+TEST_F(RecursiveReadWriteMutex, waiting_writer_doesnt_hold_off_recursive_readers)
+{
+    EXPECT_CALL(*this, notify_write_locked()).Times(1);
+
+    mutex.read_lock();
+
+    threads.push_back(std::thread{[&]
+        {
+            mutex.write_lock();
+            notify_write_locked();
+            mutex.write_unlock();
+        }});
+
+    // Give the writer time to start waiting
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+
+    mutex.read_lock();
+    mutex.read_unlock();
+    mutex.read_unlock();
+}
+
+TEST_F(RecursiveReadWriteMutex, reader_can_be_write_locked_while_another_writer_waits)
+{
+    InSequence seq;
+
+    EXPECT_CALL(*this, notify_write_locked()).Times(1);
+    EXPECT_CALL(*this, notify_write_unlocking()).Times(1);
+    EXPECT_CALL(*this, notify_write_locked()).Times(1);
+
+    mutex.read_lock();
+
+    threads.push_back(std::thread{[&]
+        {
+            mutex.write_lock();
+            notify_write_locked();
+            mutex.write_unlock();
+        }});
+
+    // Give the other writer time to start waiting
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+
+    mutex.write_lock();
+    notify_write_locked();
+    notify_write_unlocking();
+    mutex.write_unlock();
+    mutex.read_unlock();
+}
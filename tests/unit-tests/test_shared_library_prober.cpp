@@ -24,6 +24,7 @@
 #include <errno.h>
 #include <unistd.h>
 #include <cstring>
+#include <fstream>
 #include <unordered_map>
 
 #include <system_error>
@@ -41,6 +42,7 @@ public:
     MOCK_METHOD2(probing_failed, void(boost::filesystem::path const&, std::exception const&));
     MOCK_METHOD1(loading_library, void(boost::filesystem::path const&));
     MOCK_METHOD2(loading_failed, void(boost::filesystem::path const&, std::exception const&));
+    MOCK_METHOD2(library_skipped, void(boost::filesystem::path const&, std::string const&));
 };
 
 class SharedLibraryProber : public testing::Test
@@ -246,3 +248,83 @@ TEST_F(SharedLibraryProber, does_not_log_failure_on_success)
     // libthis-arch should always be loadable...
     EXPECT_TRUE(probing_map.at("libthis-arch.so"));
 }
+
+namespace
+{
+// A loadable module in its own directory, beside the manifest the test writes
+struct ModuleWithManifest
+{
+    ModuleWithManifest(std::string const& library_path, std::string const& directory)
+        : module{boost::filesystem::path{directory} / "libthis-arch.so"},
+          manifest{boost::filesystem::path{directory} / "libthis-arch.manifest"}
+    {
+        boost::filesystem::create_symlink(boost::filesystem::path{library_path} / "libthis-arch.so", module);
+    }
+
+    ~ModuleWithManifest()
+    {
+        boost::filesystem::remove(manifest);
+        boost::filesystem::remove(module);
+    }
+
+    void set_requirements(std::string const& lines)
+    {
+        std::ofstream{manifest.string()} << lines;
+    }
+
+    boost::filesystem::path const module;
+    boost::filesystem::path const manifest;
+};
+}
+
+TEST_F(SharedLibraryProber, loads_module_whose_manifest_requirements_are_met)
+{
+    using namespace testing;
+    ModuleWithManifest module{library_path, temporary_directory};
+    module.set_requirements("# Always there\ndevice /dev/null\nenv PATH\n");
+
+    EXPECT_CALL(null_report, library_skipped(_, _)).Times(0);
+
+    EXPECT_THAT(mir::libraries_for_path(temporary_directory, null_report).size(), Eq(1u));
+}
+
+TEST_F(SharedLibraryProber, skips_module_without_a_required_device)
+{
+    using namespace testing;
+    ModuleWithManifest module{library_path, temporary_directory};
+    module.set_requirements("device /dev/a-device-that-certainly-doesnt-exist*\n");
+
+    EXPECT_CALL(null_report, loading_library(_)).Times(0);
+    EXPECT_CALL(null_report, library_skipped(Eq(module.module), HasSubstr("a-device-that-certainly-doesnt-exist")));
+
+    EXPECT_THAT(mir::libraries_for_path(temporary_directory, null_report), IsEmpty());
+}
+
+TEST_F(SharedLibraryProber, skips_module_without_a_required_environment_variable)
+{
+    using namespace testing;
+    ModuleWithManifest module{library_path, temporary_directory};
+    module.set_requirements("env MIR_TEST_A_VARIABLE_THAT_CERTAINLY_ISNT_SET\n");
+
+    EXPECT_CALL(null_report, library_skipped(Eq(module.module), _));
+
+    EXPECT_THAT(mir::libraries_for_path(temporary_directory, null_report), IsEmpty());
+}
+
+TEST_F(SharedLibraryProber, any_alternative_meets_a_requirement)
+{
+    using namespace testing;
+    ModuleWithManifest module{library_path, temporary_directory};
+    module.set_requirements("device /dev/a-device-that-certainly-doesnt-exist /dev/null\n");
+
+    EXPECT_THAT(mir::libraries_for_path(temporary_directory, null_report).size(), Eq(1u));
+}
+
+TEST_F(SharedLibraryProber, ignores_requirements_it_doesnt_understand)
+{
+    using namespace testing;
+    ModuleWithManifest module{library_path, temporary_directory};
+    module.set_requirements("a-future-requirement that-isnt-met\n");
+
+    EXPECT_THAT(mir::libraries_for_path(temporary_directory, null_report).size(), Eq(1u));
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/thread_scheduling.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <stdexcept>
+#include <thread>
+
+#include <sys/resource.h>
+
+using namespace ::testing;
+
+TEST(ThreadScheduling, parses_cpu_list)
+{
+    EXPECT_THAT(mir::parse_cpu_list("0,2-4,7"), ElementsAre(0, 2, 3, 4, 7));
+    EXPECT_THAT(mir::parse_cpu_list(""), IsEmpty());
+}
+
+TEST(ThreadScheduling, rejects_malformed_cpu_list)
+{
+    EXPECT_THROW(mir::parse_cpu_list("3-1"), std::invalid_argument);
+    EXPECT_THROW(mir::parse_cpu_list("1:2"), std::invalid_argument);
+}
+
+TEST(ThreadScheduling, parses_rules)
+{
+    auto const rules = mir::parse_thread_scheduling_rules(
+        "Mir/Comp:cpus=4-5 rt=10; Mir/Input* : nice=-5 ;*:cgroup=/sys/fs/cgroup/mir");
+
+    ASSERT_THAT(rules.size(), Eq(3u));
+
+    EXPECT_THAT(rules[0].name_pattern, Eq("Mir/Comp"));
+    EXPECT_THAT(rules[0].scheduling.cpus, ElementsAre(4, 5));
+    EXPECT_THAT(rules[0].scheduling.realtime_priority, Eq(10));
+    EXPECT_FALSE(rules[0].scheduling.nice.is_set());
+
+    EXPECT_THAT(rules[1].name_pattern, Eq("Mir/Input*"));
+    ASSERT_TRUE(rules[1].scheduling.nice.is_set());
+    EXPECT_THAT(rules[1].scheduling.nice.value(), Eq(-5));
+
+    EXPECT_THAT(rules[2].name_pattern, Eq("*"));
+    EXPECT_THAT(rules[2].scheduling.cgroup, Eq("/sys/fs/cgroup/mir"));
+}
+
+TEST(ThreadScheduling, parses_stack_prefault_in_kib)
+{
+    auto const rules = mir::parse_thread_scheduling_rules("Mir/Comp:stack=64");
+
+    ASSERT_THAT(rules.size(), Eq(1u));
+    EXPECT_THAT(rules[0].scheduling.prefault_stack, Eq(64u * 1024u));
+}
+
+TEST(ThreadScheduling, empty_rules_are_ignored)
+{
+    EXPECT_THAT(mir::parse_thread_scheduling_rules(""), IsEmpty());
+    EXPECT_THAT(mir::parse_thread_scheduling_rules(" ; "), IsEmpty());
+}
+
+TEST(ThreadScheduling, rejects_malformed_rules)
+{
+    EXPECT_THROW(mir::parse_thread_scheduling_rules("Mir/Comp"), std::invalid_argument);
+    EXPECT_THROW(mir::parse_thread_scheduling_rules(":rt=10"), std::invalid_argument);
+    EXPECT_THROW(mir::parse_thread_scheduling_rules("Mir/Comp:rt=100"), std::invalid_argument);
+    EXPECT_THROW(mir::parse_thread_scheduling_rules("Mir/Comp:nice=-21"), std::invalid_argument);
+    EXPECT_THROW(mir::parse_thread_scheduling_rules("Mir/Comp:nice=high"), std::invalid_argument);
+    EXPECT_THROW(mir::parse_thread_scheduling_rules("Mir/Comp:cgroup=relative"), std::invalid_argument);
+    EXPECT_THROW(mir::parse_thread_scheduling_rules("Mir/Comp:colour=blue"), std::invalid_argument);
+    EXPECT_THROW(mir::parse_thread_scheduling_rules("Mir/Comp:stack=0"), std::invalid_argument);
+}
+
+TEST(ThreadScheduling, applies_first_matching_rule)
+{
+    mir::ThreadSchedulingRule first;
+    first.name_pattern = "test/*";
+    first.scheduling.nice = 5;
+    mir::ThreadSchedulingRule second;
+    second.name_pattern = "*";
+    second.scheduling.cgroup = "/nonexistent";
+
+    int nice{0};
+
+    // On a thread of its own, as this can't be undone without privileges
+    std::thread{[&]
+        {
+            // Raising our own nice value is always allowed, and the non-matching cgroup isn't attempted
+            mir::apply_thread_scheduling({first, second}, "test/thread");
+            nice = getpriority(PRIO_PROCESS, 0);
+        }}.join();
+
+    EXPECT_THAT(nice, Eq(5));
+}
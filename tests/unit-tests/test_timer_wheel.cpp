@@ -0,0 +1,195 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/time/timer_wheel.h"
+#include "mir/time/alarm.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <poll.h>
+
+#include <chrono>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+using namespace ::testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+struct TimerWheel : Test
+{
+    mir::time::TimerWheel wheel;
+
+    /// Dispatches the wheel as the input thread would, until done() or the timeout
+    void dispatch_until(std::function<bool()> const& done, std::chrono::milliseconds timeout = 2s)
+    {
+        auto const deadline = std::chrono::steady_clock::now() + timeout;
+        while (!done())
+        {
+            auto const remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now());
+            if (remaining <= 0ms)
+                return;
+
+            pollfd fd{wheel.watch_fd(), POLLIN, 0};
+            if (poll(&fd, 1, remaining.count()) > 0)
+                wheel.dispatch(mir::dispatch::FdEvent::readable);
+        }
+    }
+
+    void dispatch_for(std::chrono::milliseconds duration)
+    {
+        dispatch_until([] { return false; }, duration);
+    }
+};
+}
+
+TEST_F(TimerWheel, alarm_fires_no_earlier_than_scheduled)
+{
+    std::chrono::steady_clock::time_point fired_at;
+    auto const alarm = wheel.create_alarm([&] { fired_at = std::chrono::steady_clock::now(); });
+
+    auto const scheduled_at = std::chrono::steady_clock::now();
+    alarm->reschedule_in(20ms);
+    dispatch_until([&] { return alarm->state() == mir::time::Alarm::triggered; });
+
+    EXPECT_THAT(alarm->state(), Eq(mir::time::Alarm::triggered));
+    EXPECT_THAT(fired_at - scheduled_at, Ge(20ms));
+}
+
+TEST_F(TimerWheel, alarm_beyond_the_first_level_fires)
+{
+    std::chrono::steady_clock::time_point fired_at;
+    auto const alarm = wheel.create_alarm([&] { fired_at = std::chrono::steady_clock::now(); });
+
+    auto const scheduled_at = std::chrono::steady_clock::now();
+    alarm->reschedule_in(150ms);
+    dispatch_until([&] { return alarm->state() == mir::time::Alarm::triggered; });
+
+    EXPECT_THAT(alarm->state(), Eq(mir::time::Alarm::triggered));
+    EXPECT_THAT(fired_at - scheduled_at, Ge(150ms));
+}
+
+TEST_F(TimerWheel, alarms_fire_in_order)
+{
+    std::vector<int> fired;
+    auto const first = wheel.create_alarm([&] { fired.push_back(1); });
+    auto const second = wheel.create_alarm([&] { fired.push_back(2); });
+    auto const third = wheel.create_alarm([&] { fired.push_back(3); });
+
+    third->reschedule_in(90ms);
+    first->reschedule_in(10ms);
+    second->reschedule_in(40ms);
+    dispatch_until([&] { return fired.size() == 3; });
+
+    EXPECT_THAT(fired, ElementsAre(1, 2, 3));
+}
+
+TEST_F(TimerWheel, cancelled_alarm_does_not_fire)
+{
+    bool fired{false};
+    auto const alarm = wheel.create_alarm([&] { fired = true; });
+
+    alarm->reschedule_in(10ms);
+    EXPECT_TRUE(alarm->cancel());
+    dispatch_for(50ms);
+
+    EXPECT_FALSE(fired);
+    EXPECT_THAT(alarm->state(), Eq(mir::time::Alarm::cancelled));
+}
+
+TEST_F(TimerWheel, destroyed_alarm_does_not_fire)
+{
+    bool fired{false};
+    auto alarm = wheel.create_alarm([&] { fired = true; });
+
+    alarm->reschedule_in(10ms);
+    alarm.reset();
+    dispatch_for(50ms);
+
+    EXPECT_FALSE(fired);
+}
+
+TEST_F(TimerWheel, reschedule_supersedes_pending_timeout)
+{
+    int fired{0};
+    auto const alarm = wheel.create_alarm([&] { ++fired; });
+
+    EXPECT_FALSE(alarm->reschedule_in(10ms));
+    EXPECT_TRUE(alarm->reschedule_in(60ms));
+    dispatch_for(30ms);
+
+    EXPECT_THAT(fired, Eq(0));
+
+    dispatch_until([&] { return fired > 0; });
+    dispatch_for(20ms);
+
+    EXPECT_THAT(fired, Eq(1));
+}
+
+TEST_F(TimerWheel, alarm_can_reschedule_itself_from_its_callback)
+{
+    int fired{0};
+    std::unique_ptr<mir::time::Alarm> alarm;
+    alarm = wheel.create_alarm([&]
+        {
+            if (++fired < 3)
+                alarm->reschedule_in(5ms);
+        });
+
+    alarm->reschedule_in(5ms);
+    dispatch_until([&] { return fired == 3; });
+
+    EXPECT_THAT(fired, Eq(3));
+}
+
+TEST_F(TimerWheel, alarms_due_together_all_fire_when_one_throws)
+{
+    bool first_fired{false}, last_fired{false};
+    auto const first = wheel.create_alarm([&] { first_fired = true; });
+    auto const throwing = wheel.create_alarm([] { throw std::runtime_error{"Alarm failed"}; });
+    auto const last = wheel.create_alarm([&] { last_fired = true; });
+
+    auto const deadline = std::chrono::steady_clock::now() + 10ms;
+    first->reschedule_for(deadline);
+    throwing->reschedule_for(deadline);
+    last->reschedule_for(deadline);
+
+    bool threw{false};
+    while (!threw && std::chrono::steady_clock::now() < deadline + 2s)
+    {
+        pollfd fd{wheel.watch_fd(), POLLIN, 0};
+        if (poll(&fd, 1, 100) > 0)
+        {
+            try
+            {
+                wheel.dispatch(mir::dispatch::FdEvent::readable);
+            }
+            catch (std::runtime_error const&)
+            {
+                threw = true;
+            }
+        }
+    }
+
+    EXPECT_TRUE(threw);
+    EXPECT_TRUE(first_fired);
+    EXPECT_TRUE(last_fired);
+    EXPECT_THAT(throwing->state(), Eq(mir::time::Alarm::triggered));
+}
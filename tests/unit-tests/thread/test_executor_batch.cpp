@@ -0,0 +1,132 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/thread/executor_batch.h"
+#include "mir/executor.h"
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace mth = mir::thread;
+
+using namespace testing;
+
+namespace
+{
+class QueueingExecutor : public mir::Executor
+{
+public:
+    void spawn(std::function<void()>&& work) override
+    {
+        work_items.push_back(std::move(work));
+    }
+
+    void execute()
+    {
+        auto const items = std::move(work_items);
+        work_items.clear();
+        for (auto const& work : items)
+            work();
+    }
+
+    std::vector<std::function<void()>> work_items;
+};
+}
+
+TEST(ExecutorBatch, without_a_batch_work_is_spawned_directly)
+{
+    auto const executor = std::make_shared<QueueingExecutor>();
+
+    mth::ExecutorBatch::spawn(executor, []{});
+    mth::ExecutorBatch::spawn(executor, []{});
+
+    EXPECT_THAT(executor->work_items.size(), Eq(2u));
+}
+
+TEST(ExecutorBatch, work_is_held_until_the_batch_ends)
+{
+    auto const executor = std::make_shared<QueueingExecutor>();
+
+    {
+        mth::ExecutorBatch const batch;
+        mth::ExecutorBatch::spawn(executor, []{});
+
+        EXPECT_THAT(executor->work_items.size(), Eq(0u));
+    }
+
+    EXPECT_THAT(executor->work_items.size(), Eq(1u));
+}
+
+TEST(ExecutorBatch, each_executor_gets_its_work_as_one_item_in_order)
+{
+    auto const first = std::make_shared<QueueingExecutor>();
+    auto const second = std::make_shared<QueueingExecutor>();
+    std::vector<int> order;
+
+    {
+        mth::ExecutorBatch const batch;
+        mth::ExecutorBatch::spawn(first, [&]{ order.push_back(1); });
+        mth::ExecutorBatch::spawn(second, [&]{ order.push_back(10); });
+        mth::ExecutorBatch::spawn(first, [&]{ order.push_back(2); });
+        mth::ExecutorBatch::spawn(first, [&]{ order.push_back(3); });
+    }
+
+    ASSERT_THAT(first->work_items.size(), Eq(1u));
+    ASSERT_THAT(second->work_items.size(), Eq(1u));
+
+    first->execute();
+    second->execute();
+
+    EXPECT_THAT(order, ElementsAre(1, 2, 3, 10));
+}
+
+TEST(ExecutorBatch, nested_batches_are_submitted_by_the_outermost)
+{
+    auto const executor = std::make_shared<QueueingExecutor>();
+
+    {
+        mth::ExecutorBatch const outer;
+        {
+            mth::ExecutorBatch const inner;
+            mth::ExecutorBatch::spawn(executor, []{});
+        }
+        mth::ExecutorBatch::spawn(executor, []{});
+
+        EXPECT_THAT(executor->work_items.size(), Eq(0u));
+    }
+
+    EXPECT_THAT(executor->work_items.size(), Eq(1u));
+}
+
+TEST(ExecutorBatch, a_failing_item_does_not_stop_the_rest_of_the_batch)
+{
+    auto const executor = std::make_shared<QueueingExecutor>();
+    bool executed{false};
+
+    {
+        mth::ExecutorBatch const batch;
+        mth::ExecutorBatch::spawn(executor, []{ throw std::runtime_error{"Oops"}; });
+        mth::ExecutorBatch::spawn(executor, [&]{ executed = true; });
+    }
+
+    executor->execute();
+
+    EXPECT_TRUE(executed);
+}
@@ -0,0 +1,221 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/frontend_wayland/commit_queue.h"
+
+#include "mir/fd.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <wayland-server-core.h>
+
+#include <unistd.h>
+
+namespace mf = mir::frontend;
+namespace mt = mir::time;
+
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+struct TestState
+{
+    int id;
+    std::experimental::optional<mir::Fd> acquire_fence;
+    std::experimental::optional<mt::PosixTimestamp> hold_until;
+};
+
+/// A fence the test signals by writing to the other end of a pipe
+struct Fence
+{
+    Fence()
+    {
+        int fds[2];
+        if (pipe(fds) != 0)
+            throw std::system_error{errno, std::system_category(), "Failed to create pipe"};
+        read_end = mir::Fd{fds[0]};
+        write_end = mir::Fd{fds[1]};
+    }
+
+    void signal()
+    {
+        char const byte{0};
+        ASSERT_THAT(write(write_end, &byte, 1), Eq(1));
+    }
+
+    mir::Fd read_end;
+    mir::Fd write_end;
+};
+
+struct CommitQueueTest : Test
+{
+    CommitQueueTest()
+        : loop{wl_event_loop_create()}
+    {
+    }
+
+    ~CommitQueueTest()
+    {
+        queue.reset();
+        wl_event_loop_destroy(loop);
+    }
+
+    void create_queue()
+    {
+        queue = std::make_unique<mf::CommitQueue<TestState>>(
+            loop,
+            [](TestState const& state) -> std::experimental::optional<mt::PosixTimestamp>
+            {
+                if (state.hold_until && mt::PosixTimestamp::now(CLOCK_MONOTONIC) < state.hold_until.value())
+                    return state.hold_until;
+                return std::experimental::nullopt;
+            },
+            [this](TestState const& state) { applied.push_back(state.id); });
+    }
+
+    void dispatch(std::chrono::milliseconds timeout = 0ms)
+    {
+        wl_event_loop_dispatch(loop, timeout.count());
+    }
+
+    TestState fenced(int id, Fence const& fence)
+    {
+        return TestState{id, fence.read_end, std::experimental::nullopt};
+    }
+
+    wl_event_loop* const loop;
+    std::vector<int> applied;
+    std::unique_ptr<mf::CommitQueue<TestState>> queue;
+};
+}
+
+TEST_F(CommitQueueTest, commits_with_nothing_to_wait_for_apply_at_once)
+{
+    create_queue();
+
+    queue->push({1, {}, {}});
+    queue->push({2, {}, {}});
+
+    EXPECT_THAT(applied, ElementsAre(1, 2));
+    EXPECT_TRUE(queue->empty());
+}
+
+TEST_F(CommitQueueTest, commit_with_a_signalled_fence_applies_at_once)
+{
+    create_queue();
+    Fence fence;
+    fence.signal();
+
+    queue->push(fenced(1, fence));
+
+    EXPECT_THAT(applied, ElementsAre(1));
+}
+
+TEST_F(CommitQueueTest, unsignalled_fence_holds_back_later_commits)
+{
+    create_queue();
+    Fence fence;
+
+    queue->push(fenced(1, fence));
+    queue->push({2, {}, {}});
+    dispatch();
+
+    EXPECT_THAT(applied, IsEmpty());
+    EXPECT_THAT(queue->queued().size(), Eq(2u));
+}
+
+TEST_F(CommitQueueTest, commits_apply_in_order_once_the_fence_signals)
+{
+    create_queue();
+    Fence fence;
+
+    queue->push(fenced(1, fence));
+    queue->push({2, {}, {}});
+    queue->push({3, {}, {}});
+
+    fence.signal();
+    dispatch();
+
+    EXPECT_THAT(applied, ElementsAre(1, 2, 3));
+    EXPECT_TRUE(queue->empty());
+}
+
+TEST_F(CommitQueueTest, commits_apply_in_order_when_fences_signal_out_of_order)
+{
+    create_queue();
+    Fence first, second;
+
+    queue->push(fenced(1, first));
+    queue->push(fenced(2, second));
+    queue->push({3, {}, {}});
+
+    second.signal();
+    dispatch();
+    EXPECT_THAT(applied, IsEmpty());
+
+    first.signal();
+    dispatch();
+    EXPECT_THAT(applied, ElementsAre(1, 2, 3));
+}
+
+TEST_F(CommitQueueTest, each_fence_is_waited_for_in_turn)
+{
+    create_queue();
+    Fence first, second;
+
+    queue->push(fenced(1, first));
+    queue->push(fenced(2, second));
+
+    first.signal();
+    dispatch();
+    EXPECT_THAT(applied, ElementsAre(1));
+
+    second.signal();
+    dispatch();
+    EXPECT_THAT(applied, ElementsAre(1, 2));
+}
+
+TEST_F(CommitQueueTest, held_commit_applies_when_its_time_comes)
+{
+    create_queue();
+    auto const hold_until = mt::PosixTimestamp::now(CLOCK_MONOTONIC) + 20ms;
+
+    queue->push({1, {}, hold_until});
+    queue->push({2, {}, {}});
+    EXPECT_THAT(applied, IsEmpty());
+
+    while (applied.empty() && mt::PosixTimestamp::now(CLOCK_MONOTONIC) < hold_until + 1s)
+        dispatch(100ms);
+
+    EXPECT_THAT(mt::PosixTimestamp::now(CLOCK_MONOTONIC), Ge(hold_until));
+    EXPECT_THAT(applied, ElementsAre(1, 2));
+}
+
+TEST_F(CommitQueueTest, nothing_applies_after_the_queue_is_destroyed)
+{
+    create_queue();
+    Fence fence;
+
+    queue->push(fenced(1, fence));
+    queue.reset();
+
+    fence.signal();
+    dispatch();
+
+    EXPECT_THAT(applied, IsEmpty());
+}
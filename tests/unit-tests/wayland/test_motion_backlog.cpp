@@ -0,0 +1,237 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/frontend_wayland/motion_backlog.h"
+#include "src/server/frontend_wayland/client_backlog.h"
+
+#include "mir/fd.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <wayland-server-core.h>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <memory>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace mf = mir::frontend;
+
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+using Sent = std::pair<int, int>;
+
+struct MotionBacklogTest : Test
+{
+    MotionBacklogTest()
+        : loop{wl_event_loop_create()},
+          backlog{std::make_unique<mf::MotionBacklog<int, int>>(
+              loop,
+              [this]() { return backlogged; },
+              [this](int key, int motion) { sent.emplace_back(key, motion); },
+              [this]() { ++times_caught; })}
+    {
+    }
+
+    ~MotionBacklogTest()
+    {
+        backlog.reset();
+        wl_event_loop_destroy(loop);
+    }
+
+    /// Waits long enough for the backlogged client to be looked at again
+    void dispatch()
+    {
+        wl_event_loop_dispatch(loop, (mf::backlog_retry_interval + 50ms).count());
+    }
+
+    wl_event_loop* const loop;
+    bool backlogged{false};
+    std::vector<Sent> sent;
+    int times_caught{0};
+    std::unique_ptr<mf::MotionBacklog<int, int>> backlog;
+};
+
+struct SocketBacklog : Test
+{
+    SocketBacklog()
+    {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+            throw std::system_error{errno, std::system_category(), "Failed to create socket pair"};
+        server = mir::Fd{fds[0]};
+        client = mir::Fd{fds[1]};
+        fcntl(server, F_SETFL, fcntl(server, F_GETFL) | O_NONBLOCK);
+        fcntl(client, F_SETFL, fcntl(client, F_GETFL) | O_NONBLOCK);
+    }
+
+    /// Writes until the socket will take no more
+    void fill()
+    {
+        char const buffer[4096]{};
+        while (write(server, buffer, sizeof buffer) > 0)
+            ;
+    }
+
+    void client_reads_everything()
+    {
+        char buffer[4096];
+        while (read(client, buffer, sizeof buffer) > 0)
+            ;
+    }
+
+    mir::Fd server;
+    mir::Fd client;
+};
+}
+
+TEST_F(MotionBacklogTest, motion_is_sent_at_once_while_the_client_keeps_up)
+{
+    backlog->motion(1, 10);
+    backlog->motion(1, 11);
+
+    EXPECT_THAT(sent, ElementsAre(Sent{1, 10}, Sent{1, 11}));
+    EXPECT_THAT(backlog->held_back(), IsEmpty());
+}
+
+TEST_F(MotionBacklogTest, only_the_latest_motion_of_each_key_is_held_back_while_the_client_is_backlogged)
+{
+    backlogged = true;
+
+    backlog->motion(1, 10);
+    backlog->motion(2, 20);
+    backlog->motion(1, 11);
+    backlog->motion(1, 12);
+
+    EXPECT_THAT(sent, IsEmpty());
+    EXPECT_THAT(backlog->held_back(), ElementsAre(Pair(1, 12), Pair(2, 20)));
+}
+
+TEST_F(MotionBacklogTest, held_back_motion_is_sent_once_the_client_catches_up)
+{
+    backlogged = true;
+    backlog->motion(1, 10);
+    backlog->motion(1, 11);
+
+    backlogged = false;
+    dispatch();
+
+    EXPECT_THAT(sent, ElementsAre(Sent{1, 11}));
+    EXPECT_THAT(times_caught, Eq(1));
+    EXPECT_THAT(backlog->held_back(), IsEmpty());
+}
+
+TEST_F(MotionBacklogTest, motion_is_held_back_for_as_long_as_the_client_is_backlogged)
+{
+    backlogged = true;
+    backlog->motion(1, 10);
+
+    dispatch();
+    dispatch();
+    backlog->motion(1, 11);
+
+    EXPECT_THAT(sent, IsEmpty());
+    EXPECT_THAT(times_caught, Eq(0));
+
+    backlogged = false;
+    dispatch();
+
+    EXPECT_THAT(sent, ElementsAre(Sent{1, 11}));
+}
+
+TEST_F(MotionBacklogTest, motion_after_a_catch_up_is_sent_at_once)
+{
+    backlogged = true;
+    backlog->motion(1, 10);
+    backlogged = false;
+    dispatch();
+
+    backlog->motion(1, 11);
+
+    EXPECT_THAT(sent, ElementsAre(Sent{1, 10}, Sent{1, 11}));
+}
+
+TEST_F(MotionBacklogTest, motion_is_not_sent_ahead_of_motion_already_held_back)
+{
+    backlogged = true;
+    backlog->motion(1, 10);
+
+    // The client has caught up, but nothing has looked yet
+    backlogged = false;
+    backlog->motion(2, 20);
+
+    EXPECT_THAT(sent, IsEmpty());
+    EXPECT_THAT(backlog->held_back(), ElementsAre(Pair(1, 10), Pair(2, 20)));
+}
+
+TEST_F(MotionBacklogTest, flush_sends_what_is_held_back_even_while_the_client_is_backlogged)
+{
+    backlogged = true;
+    backlog->motion(1, 10);
+    backlog->motion(2, 20);
+
+    backlog->flush();
+
+    EXPECT_THAT(sent, UnorderedElementsAre(Sent{1, 10}, Sent{2, 20}));
+    EXPECT_THAT(backlog->held_back(), IsEmpty());
+}
+
+TEST_F(MotionBacklogTest, nothing_is_sent_again_after_a_flush)
+{
+    backlogged = true;
+    backlog->motion(1, 10);
+    backlog->flush();
+
+    backlogged = false;
+    dispatch();
+
+    EXPECT_THAT(sent, ElementsAre(Sent{1, 10}));
+    EXPECT_THAT(times_caught, Eq(0));
+}
+
+TEST_F(SocketBacklog, socket_with_nothing_unread_is_not_backlogged)
+{
+    EXPECT_FALSE(mf::socket_is_backlogged(server));
+}
+
+TEST_F(SocketBacklog, socket_whose_peer_does_not_read_is_backlogged)
+{
+    fill();
+
+    EXPECT_TRUE(mf::socket_is_backlogged(server));
+}
+
+TEST_F(SocketBacklog, socket_is_no_longer_backlogged_once_its_peer_reads)
+{
+    fill();
+
+    client_reads_everything();
+
+    EXPECT_FALSE(mf::socket_is_backlogged(server));
+}
+
+TEST_F(SocketBacklog, invalid_socket_is_not_backlogged)
+{
+    EXPECT_FALSE(mf::socket_is_backlogged(-1));
+}
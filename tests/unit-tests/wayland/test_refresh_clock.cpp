@@ -0,0 +1,113 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/frontend_wayland/refresh_clock.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace mf = mir::frontend;
+namespace mg = mir::graphics;
+namespace geom = mir::geometry;
+
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+geom::Rectangle const left_output{{0, 0}, {1920, 1080}};
+geom::Rectangle const right_output{{1920, 0}, {1920, 1080}};
+
+auto frame(int64_t msc, std::chrono::nanoseconds ust) -> mg::Frame
+{
+    return mg::Frame{msc, {CLOCK_MONOTONIC, ust}, true};
+}
+}
+
+TEST(RefreshClock, assumes_60hz_until_it_has_measured)
+{
+    mf::RefreshClock clock;
+    clock.presented(frame(10, 1s), left_output);
+
+    EXPECT_THAT(clock.interval(), Eq(mf::RefreshClock::default_interval));
+    EXPECT_THAT(clock.fallback(), Eq(51ms));
+}
+
+TEST(RefreshClock, fallback_follows_the_measured_refresh_rate)
+{
+    mf::RefreshClock clock;
+
+    // 144Hz
+    clock.presented(frame(100, 1s), left_output);
+    clock.presented(frame(244, 2s), left_output);
+
+    EXPECT_THAT(clock.interval(), Eq(1'000'000'000ns / 144));
+    EXPECT_THAT(clock.fallback(), Eq(21ms));
+
+    // 30Hz
+    clock.presented(frame(274, 3s), left_output);
+
+    EXPECT_THAT(clock.interval(), Eq(1'000'000'000ns / 30));
+    EXPECT_THAT(clock.fallback(), Eq(100ms));
+}
+
+TEST(RefreshClock, skipped_refreshes_are_accounted_for)
+{
+    mf::RefreshClock clock;
+
+    clock.presented(frame(1, 1s), left_output);
+    clock.presented(frame(5, 1s + 4 * 10ms), left_output);
+
+    EXPECT_THAT(clock.interval(), Eq(10ms));
+}
+
+TEST(RefreshClock, frames_on_different_outputs_are_not_compared)
+{
+    mf::RefreshClock clock;
+
+    clock.presented(frame(1, 1s), left_output);
+    clock.presented(frame(2, 1s + 5ms), right_output);
+
+    EXPECT_THAT(clock.interval(), Eq(mf::RefreshClock::default_interval));
+
+    clock.presented(frame(3, 1s + 5ms + 10ms), right_output);
+
+    EXPECT_THAT(clock.interval(), Eq(10ms));
+}
+
+TEST(RefreshClock, implausible_measurements_are_clamped)
+{
+    mf::RefreshClock clock;
+
+    clock.presented(frame(1, 1s), left_output);
+    clock.presented(frame(2, 1s + 1ms), left_output);
+    EXPECT_THAT(clock.interval(), Eq(mf::RefreshClock::shortest_interval));
+
+    clock.presented(frame(3, 3s), left_output);
+    EXPECT_THAT(clock.interval(), Eq(mf::RefreshClock::longest_interval));
+    EXPECT_THAT(clock.fallback(), Eq(300ms));
+}
+
+TEST(RefreshClock, frames_that_dont_advance_are_ignored)
+{
+    mf::RefreshClock clock;
+
+    clock.presented(frame(1, 1s), left_output);
+    clock.presented(frame(2, 1s + 10ms), left_output);
+    clock.presented(frame(2, 1s + 20ms), left_output);
+
+    EXPECT_THAT(clock.interval(), Eq(10ms));
+}
@@ -82,6 +82,22 @@ TEST_F(WaylandExecutorTest, dispatching_the_event_loop_dispatches_spawned_task)
     EXPECT_TRUE(executed);
 }
 
+TEST_F(WaylandExecutorTest, one_dispatch_runs_every_task_spawned_before_it)
+{
+    mf::WaylandExecutor executor{the_event_loop};
+
+    int executed{0};
+    for (auto i = 0; i != 3; ++i)
+    {
+        executor.spawn([&executed]() { ++executed; });
+    }
+
+    wl_event_loop_dispatch(the_event_loop, 0);
+
+    EXPECT_THAT(executed, Eq(3));
+    EXPECT_THAT(event_loop_fd, Not(FdIsReadable()));
+}
+
 TEST_F(WaylandExecutorTest, can_spawn_more_tasks_from_a_task)
 {
     using namespace std::literals::chrono_literals;